@@ -3,6 +3,7 @@
 #include "../providers/async_query_provider.h"
 #include "../providers/connection_provider.h"
 #include "../providers/export_provider.h"
+#include "../providers/import_provider.h"
 #include "../providers/io_provider.h"
 #include "../providers/query_provider.h"
 #include "../providers/schema_provider.h"
@@ -10,6 +11,7 @@
 #include "../providers/settings_provider.h"
 #include "../providers/transaction_provider.h"
 #include "../providers/utility_provider.h"
+#include "../utils/startup_profiler.h"
 
 namespace velocitydb {
 
@@ -18,15 +20,28 @@ SystemContext::SystemContext()
     , m_queries(std::make_unique<QueryProvider>(*m_connections))
     , m_asyncQueries(std::make_unique<AsyncQueryProvider>(*m_connections))
     , m_schema(std::make_unique<SchemaProvider>(*m_connections))
-    , m_transactions(std::make_unique<TransactionProvider>(*m_connections))
-    , m_exports(std::make_unique<ExportProvider>(*m_connections))
-    , m_search(std::make_unique<SearchProvider>(*m_connections))
+    , m_transactions(std::make_unique<TransactionProvider>(*m_connections, *m_queries))
+    , m_exports(std::make_unique<ExportProvider>(*m_connections, *m_queries))
+    , m_imports(std::make_unique<ImportProvider>(*m_connections))
+    , m_search(std::make_unique<SearchProvider>(*m_connections, *m_schema, *m_queries))
     , m_utility(std::make_unique<UtilityProvider>())
     , m_settings(std::make_unique<SettingsProvider>())
     , m_io(std::make_unique<IOProvider>()) {}
 
 SystemContext::~SystemContext() = default;
 
+void SystemContext::warmUp() {
+    auto start = [&](std::string_view phase, auto load) {
+        m_warmUp.emplace_back([phase, load] {
+            auto timer = StartupProfiler::instance().phase(phase);
+            load();
+        });
+    };
+    start("warmup.settings", [this] { m_settings->warmUp(); });
+    start("warmup.formatter", [this] { m_utility->warmUp(); });
+    start("warmup.history", [this] { m_queries->warmUp(); });
+}
+
 IConnectionProvider& SystemContext::connections() noexcept {
     return *m_connections;
 }
@@ -45,6 +60,9 @@ ITransactionProvider& SystemContext::transactions() noexcept {
 IExportProvider& SystemContext::exports() noexcept {
     return *m_exports;
 }
+IImportProvider& SystemContext::imports() noexcept {
+    return *m_imports;
+}
 ISearchProvider& SystemContext::search() noexcept {
     return *m_search;
 }
@@ -3,6 +3,8 @@
 #include "../interfaces/system_context.h"
 
 #include <memory>
+#include <thread>
+#include <vector>
 
 namespace velocitydb {
 
@@ -23,11 +25,16 @@ public:
     [[nodiscard]] ISchemaProvider& schema() noexcept override;
     [[nodiscard]] ITransactionProvider& transactions() noexcept override;
     [[nodiscard]] IExportProvider& exports() noexcept override;
+    [[nodiscard]] IImportProvider& imports() noexcept override;
     [[nodiscard]] ISearchProvider& search() noexcept override;
     [[nodiscard]] IUtilityProvider& utility() noexcept override;
     [[nodiscard]] ISettingsProvider& settings() noexcept override;
     [[nodiscard]] IIOProvider& io() noexcept override;
 
+    /// Load the providers' lazily initialized state (settings, session, history, formatter keywords) on
+    /// background threads while the window is being created. Anything not yet loaded when first used loads then.
+    void warmUp();
+
 private:
     std::unique_ptr<IConnectionProvider> m_connections;
     std::unique_ptr<IQueryProvider> m_queries;
@@ -35,10 +42,14 @@ private:
     std::unique_ptr<ISchemaProvider> m_schema;
     std::unique_ptr<ITransactionProvider> m_transactions;
     std::unique_ptr<IExportProvider> m_exports;
+    std::unique_ptr<IImportProvider> m_imports;
     std::unique_ptr<ISearchProvider> m_search;
     std::unique_ptr<IUtilityProvider> m_utility;
     std::unique_ptr<ISettingsProvider> m_settings;
     std::unique_ptr<IIOProvider> m_io;
+
+    // Declared last: joined before the providers they touch are destroyed
+    std::vector<std::jthread> m_warmUp;
 };
 
 }  // namespace velocitydb
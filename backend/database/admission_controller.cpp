@@ -0,0 +1,286 @@
+#include "admission_controller.h"
+
+#include "../utils/metrics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <memory>
+#include <utility>
+
+namespace velocitydb {
+
+namespace {
+
+/// How often a blocked acquire() checks whether its caller gave up
+constexpr auto CANCEL_POLL_INTERVAL = std::chrono::milliseconds{50};
+
+/// Text after the login of "login@host"; logins may contain '@' themselves, hosts never do
+[[nodiscard]] std::string_view afterLogin(std::string_view text) noexcept {
+    const auto at = text.rfind('@');
+    return at == std::string_view::npos ? text : text.substr(at + 1);
+}
+
+}  // namespace
+
+AdmissionTicket::AdmissionTicket(AdmissionTicket&& other) noexcept
+    : m_controller(std::exchange(other.m_controller, nullptr)), m_server(std::move(other.m_server)), m_weight(std::exchange(other.m_weight, 0)) {}
+
+AdmissionTicket& AdmissionTicket::operator=(AdmissionTicket&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_controller = std::exchange(other.m_controller, nullptr);
+        m_server = std::move(other.m_server);
+        m_weight = std::exchange(other.m_weight, 0);
+    }
+    return *this;
+}
+
+void AdmissionTicket::release() {
+    if (auto* controller = std::exchange(m_controller, nullptr)) {
+        // Grants run inside; one of them may own (and drop) this ticket
+        const auto server = std::move(m_server);
+        controller->release(server, std::exchange(m_weight, 0));
+    }
+}
+
+AdmissionController& AdmissionController::instance() {
+    static AdmissionController controller;
+    return controller;
+}
+
+std::string AdmissionController::serverKey(std::string_view cacheIdentity) {
+    std::string key;
+    if (const auto via = cacheIdentity.find(" via "); via != std::string_view::npos) {
+        // Behind a tunnel the server name is relative to the SSH host, which is what tells servers apart
+        key = std::string(afterLogin(cacheIdentity.substr(0, via))) + " via " + std::string(afterLogin(cacheIdentity.substr(via + 5)));
+    } else {
+        key = afterLogin(cacheIdentity);
+    }
+    std::ranges::transform(key, key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return key;
+}
+
+void AdmissionController::setDefaultLimits(AdmissionLimits limits) {
+    limits.maxConcurrent = (std::max)(limits.maxConcurrent, size_t{1});
+    limits.budget = (std::max)(limits.budget, size_t{1});
+    Granted granted;
+    {
+        std::lock_guard lock(m_mutex);
+        m_defaultLimits = limits;
+        for (auto& [key, server] : m_servers) {
+            admitQueued(key, server, granted);
+        }
+    }
+    for (auto& [grant, ticket] : granted) {
+        grant(std::move(ticket));
+    }
+}
+
+void AdmissionController::setLimits(std::string_view server, AdmissionLimits limits) {
+    limits.maxConcurrent = (std::max)(limits.maxConcurrent, size_t{1});
+    limits.budget = (std::max)(limits.budget, size_t{1});
+    Granted granted;
+    {
+        std::lock_guard lock(m_mutex);
+        auto [it, inserted] = m_servers.try_emplace(std::string(server));
+        it->second.limits = limits;
+        admitQueued(it->first, it->second, granted);
+    }
+    for (auto& [grant, ticket] : granted) {
+        grant(std::move(ticket));
+    }
+}
+
+AdmissionLimits AdmissionController::limits(std::string_view server) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_servers.find(std::string(server));
+    return it == m_servers.end() ? m_defaultLimits : limitsOf(it->second);
+}
+
+bool AdmissionController::fits(const Server& server, size_t weight) const noexcept {
+    // An idle server takes anything, so a request heavier than the whole budget still runs eventually
+    const auto limits = limitsOf(server);
+    return server.running == 0 || (server.running < limits.maxConcurrent && server.weightInUse + weight <= limits.budget);
+}
+
+uint64_t AdmissionController::enqueue(const AdmissionRequest& request, Grant grant) {
+    if (request.server.empty()) {
+        grant(AdmissionTicket{});
+        return 0;
+    }
+    const size_t weight = AdmissionController::weight(request.kind);
+    uint64_t waiterId = 0;
+    Granted granted;
+    {
+        std::lock_guard lock(m_mutex);
+        auto& server = m_servers[request.server];
+        // Nobody may overtake requests already queued, however light
+        if (server.turns.empty() && fits(server, weight)) {
+            ++server.running;
+            server.weightInUse += weight;
+            ++server.admitted;
+            granted.emplace_back(std::move(grant), AdmissionTicket(this, request.server, weight));
+        } else {
+            waiterId = m_nextWaiterId++;
+            auto& queue = server.queues[request.owner];
+            if (queue.empty()) {
+                server.turns.push_back(request.owner);
+            }
+            queue.push_back(Waiter{.id = waiterId, .weight = weight, .grant = std::move(grant), .queuedAt = std::chrono::steady_clock::now()});
+        }
+    }
+    for (auto& [admit, ticket] : granted) {
+        admit(std::move(ticket));
+    }
+    return waiterId;
+}
+
+bool AdmissionController::withdraw(std::string_view server, uint64_t waiterId) {
+    Granted granted;
+    Grant dropped;  // Destroyed after the lock is released: it may own a ticket of its own
+    bool found = false;
+    {
+        std::lock_guard lock(m_mutex);
+        const auto serverIt = m_servers.find(std::string(server));
+        if (serverIt == m_servers.end()) {
+            return false;
+        }
+        auto& state = serverIt->second;
+        for (auto queueIt = state.queues.begin(); queueIt != state.queues.end(); ++queueIt) {
+            auto& queue = queueIt->second;
+            const auto waiter = std::ranges::find(queue, waiterId, &Waiter::id);
+            if (waiter == queue.end()) {
+                continue;
+            }
+            found = true;
+            dropped = std::move(waiter->grant);
+            queue.erase(waiter);
+            if (queue.empty()) {
+                std::erase(state.turns, queueIt->first);
+                state.queues.erase(queueIt);
+            }
+            // The withdrawn request may have been the head holding lighter ones back
+            admitQueued(serverIt->first, state, granted);
+            break;
+        }
+    }
+    for (auto& [grant, ticket] : granted) {
+        grant(std::move(ticket));
+    }
+    return found;
+}
+
+void AdmissionController::release(const std::string& server, size_t weight) {
+    Granted granted;
+    {
+        std::lock_guard lock(m_mutex);
+        auto& state = m_servers[server];
+        --state.running;
+        state.weightInUse -= weight;
+        admitQueued(server, state, granted);
+    }
+    for (auto& [grant, ticket] : granted) {
+        grant(std::move(ticket));
+    }
+}
+
+void AdmissionController::admitQueued(const std::string& key, Server& server, Granted& granted) {
+    static auto& waitHistogram = MetricsRegistry::instance().histogram("admission.wait_us");
+    const auto now = std::chrono::steady_clock::now();
+    while (!server.turns.empty()) {
+        const auto queueIt = server.queues.find(server.turns.front());
+        auto& queue = queueIt->second;
+        if (!fits(server, queue.front().weight)) {
+            break;
+        }
+        Waiter waiter = std::move(queue.front());
+        queue.pop_front();
+        server.turns.pop_front();
+        if (queue.empty()) {
+            server.queues.erase(queueIt);
+        } else {
+            // Served one request; the owner goes to the back of the line
+            server.turns.push_back(queueIt->first);
+        }
+
+        ++server.running;
+        server.weightInUse += waiter.weight;
+        ++server.admitted;
+        ++server.delayed;
+        const auto waited = now - waiter.queuedAt;
+        server.maxWaitMs = (std::max)(server.maxWaitMs, std::chrono::duration<double, std::milli>(waited).count());
+        waitHistogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(waited).count()));
+        granted.emplace_back(std::move(waiter.grant), AdmissionTicket(this, key, waiter.weight));
+    }
+}
+
+std::optional<AdmissionTicket> AdmissionController::acquire(const AdmissionRequest& request, std::chrono::milliseconds timeout, const std::function<bool()>& cancelled) {
+    struct Slot {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::optional<AdmissionTicket> ticket;
+    };
+    auto slot = std::make_shared<Slot>();
+    const uint64_t waiterId = enqueue(request, [slot](AdmissionTicket ticket) {
+        {
+            std::lock_guard lock(slot->mutex);
+            slot->ticket = std::move(ticket);
+        }
+        slot->ready.notify_all();
+    });
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock lock(slot->mutex);
+    while (!slot->ticket) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || (cancelled && cancelled())) {
+            lock.unlock();
+            // When the withdrawal loses the race, the grant lands in the slot and is released along with it
+            (void)withdraw(request.server, waiterId);
+            return std::nullopt;
+        }
+        slot->ready.wait_until(lock, (std::min)(deadline, now + CANCEL_POLL_INTERVAL));
+    }
+    return std::move(slot->ticket);
+}
+
+AdmissionStats AdmissionController::statsOf(const std::string& key, const Server& server) const {
+    size_t queued = 0;
+    for (const auto& [owner, queue] : server.queues) {
+        queued += queue.size();
+    }
+    return AdmissionStats{.server = key,
+                          .limits = limitsOf(server),
+                          .running = server.running,
+                          .weightInUse = server.weightInUse,
+                          .queued = queued,
+                          .queuedOwners = server.queues.size(),
+                          .admitted = server.admitted,
+                          .delayed = server.delayed,
+                          .maxWaitMs = server.maxWaitMs};
+}
+
+std::vector<AdmissionStats> AdmissionController::stats() const {
+    std::vector<AdmissionStats> result;
+    {
+        std::lock_guard lock(m_mutex);
+        result.reserve(m_servers.size());
+        for (const auto& [key, server] : m_servers) {
+            result.push_back(statsOf(key, server));
+        }
+    }
+    std::ranges::sort(result, {}, &AdmissionStats::server);
+    return result;
+}
+
+std::optional<AdmissionStats> AdmissionController::stats(std::string_view server) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_servers.find(std::string(server));
+    if (it == m_servers.end()) {
+        return std::nullopt;
+    }
+    return statsOf(it->first, it->second);
+}
+
+}  // namespace velocitydb
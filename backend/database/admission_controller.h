@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// What a request costs against its server's budget; heavier kinds hold a connection and the server busy for longer
+enum class AdmissionClass : uint8_t {
+    Interactive,  ///< Query run from an editor tab
+    Background,   ///< Row counts, scheduled queries, replays
+    Broadcast,    ///< One target of a query broadcast to many servers
+    Export,       ///< Streaming export of a whole result to a file
+};
+
+struct AdmissionLimits {
+    size_t maxConcurrent = 8;  ///< Requests running on the server at once
+    size_t budget = 16;        ///< Sum of the running requests' weights
+};
+
+struct AdmissionRequest {
+    std::string server;  ///< AdmissionController::serverKey of the target; empty = not throttled
+    std::string owner;   ///< Who is waiting (a tab, an export job): owners take turns while requests queue
+    AdmissionClass kind = AdmissionClass::Interactive;
+};
+
+/// One server's load, for the UI
+struct AdmissionStats {
+    std::string server;
+    AdmissionLimits limits;
+    size_t running = 0;
+    size_t weightInUse = 0;
+    size_t queued = 0;
+    size_t queuedOwners = 0;  ///< Owners with at least one queued request
+    uint64_t admitted = 0;
+    uint64_t delayed = 0;  ///< Admissions that had to queue first
+    double maxWaitMs = 0.0;
+};
+
+class AdmissionController;
+
+/// A running request's share of its server; giving it back (release() or destruction) admits whoever is next.
+/// A default-constructed ticket is the share of an unthrottled request and releases nothing.
+class AdmissionTicket {
+public:
+    AdmissionTicket() noexcept = default;
+    ~AdmissionTicket() { release(); }
+
+    AdmissionTicket(AdmissionTicket&& other) noexcept;
+    AdmissionTicket& operator=(AdmissionTicket&& other) noexcept;
+    AdmissionTicket(const AdmissionTicket&) = delete;
+    AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+
+    void release();
+    [[nodiscard]] size_t weight() const noexcept { return m_weight; }
+
+private:
+    friend class AdmissionController;
+    AdmissionTicket(AdmissionController* controller, std::string server, size_t weight) noexcept : m_controller(controller), m_server(std::move(server)), m_weight(weight) {}
+
+    AdmissionController* m_controller = nullptr;
+    std::string m_server;
+    size_t m_weight = 0;
+};
+
+/// Per-server throttle in front of everything that runs work on a database server.
+///
+/// Each server (login and SSH hop stripped, so every connection to it shares the limit) runs at most
+/// maxConcurrent requests whose weights add up to at most budget; a request heavier than the whole budget is
+/// admitted once the server is idle. Requests over the limit queue per owner, and owners are served
+/// round-robin, so one tab starting a dozen exports does not starve another tab's single query. The queue head
+/// is never skipped for a lighter request behind it: a heavy export waits its turn rather than forever.
+///
+/// Grant callbacks run on the thread that freed the capacity (or the enqueuing one), outside the controller's
+/// lock, and may enqueue or release in turn.
+class AdmissionController {
+public:
+    /// Grants `ticket` to a queued request
+    using Grant = std::function<void(AdmissionTicket ticket)>;
+
+    static constexpr std::array<size_t, 4> WEIGHTS{1, 1, 2, 4};  // indexed by AdmissionClass
+
+    AdmissionController() = default;
+    ~AdmissionController() = default;
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    [[nodiscard]] static AdmissionController& instance();
+
+    [[nodiscard]] static constexpr size_t weight(AdmissionClass kind) noexcept { return WEIGHTS[static_cast<size_t>(kind)]; }
+
+    /// Server part of a connection's cache identity ("login@server[ via user@host:port]"), lowercased
+    [[nodiscard]] static std::string serverKey(std::string_view cacheIdentity);
+
+    /// Limits for servers without their own
+    void setDefaultLimits(AdmissionLimits limits);
+    /// Limits for one server; takes effect for the requests queued behind the running ones
+    void setLimits(std::string_view server, AdmissionLimits limits);
+    [[nodiscard]] AdmissionLimits limits(std::string_view server) const;
+
+    /// Admit `request` now (grant is called before returning; 0 is returned) or queue it and return the waiter id
+    /// that withdraw() takes. Unthrottled requests are always admitted with an empty ticket.
+    uint64_t enqueue(const AdmissionRequest& request, Grant grant);
+
+    /// Remove a queued request; false when it was already granted (or never queued)
+    bool withdraw(std::string_view server, uint64_t waiterId);
+
+    /// Blocking enqueue for callers on their own thread: waits up to `timeout`, checking `cancelled` while it does.
+    /// nullopt when the wait timed out or was cancelled.
+    [[nodiscard]] std::optional<AdmissionTicket> acquire(const AdmissionRequest& request, std::chrono::milliseconds timeout, const std::function<bool()>& cancelled = {});
+
+    [[nodiscard]] std::vector<AdmissionStats> stats() const;
+    [[nodiscard]] std::optional<AdmissionStats> stats(std::string_view server) const;
+
+private:
+    friend class AdmissionTicket;
+
+    struct Waiter {
+        uint64_t id = 0;
+        size_t weight = 0;
+        Grant grant;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    struct Server {
+        std::optional<AdmissionLimits> limits;
+        size_t running = 0;
+        size_t weightInUse = 0;
+        std::deque<std::string> turns;  // Owners with queued requests, next to be served first
+        std::unordered_map<std::string, std::deque<Waiter>> queues;
+        uint64_t admitted = 0;
+        uint64_t delayed = 0;
+        double maxWaitMs = 0.0;
+    };
+
+    using Granted = std::vector<std::pair<Grant, AdmissionTicket>>;
+
+    void release(const std::string& server, size_t weight);
+    [[nodiscard]] AdmissionLimits limitsOf(const Server& server) const noexcept { return server.limits.value_or(m_defaultLimits); }
+    [[nodiscard]] bool fits(const Server& server, size_t weight) const noexcept;
+    /// Admit queued requests in turn while they fit (m_mutex held); the grants are called by the caller after unlocking
+    void admitQueued(const std::string& key, Server& server, Granted& granted);
+    [[nodiscard]] AdmissionStats statsOf(const std::string& key, const Server& server) const;
+
+    mutable std::mutex m_mutex;  // guards everything below
+    AdmissionLimits m_defaultLimits;
+    std::unordered_map<std::string, Server> m_servers;  // never erased: tickets and waiters refer to them by key
+    uint64_t m_nextWaiterId = 1;
+};
+
+}  // namespace velocitydb
@@ -1,127 +1,487 @@
 #include "async_query_executor.h"
 
 #include "../parsers/sql_parser.h"
+#include "../utils/logger.h"
+#include "../utils/metrics.h"
+#include "../utils/query_trace.h"
+#include "result_registry.h"
+#include "statement_waves.h"
 
+#include <algorithm>
 #include <format>
+#include <stdexcept>
+#include <unordered_set>
 
 namespace velocitydb {
 
+namespace {
+
+/// Jobs waiting for a worker, across every executor
+MetricGauge& queueDepthGauge() {
+    static auto& gauge = MetricsRegistry::instance().gauge("async.queue_depth");
+    return gauge;
+}
+
+[[nodiscard]] size_t resultBytes(const QueryResultVariant& result) noexcept {
+    if (const auto* single = std::get_if<ResultSet>(&result)) {
+        return single->memoryBytes();
+    }
+    size_t bytes = 0;
+    for (const auto& statement : std::get<std::vector<StatementResult>>(result)) {
+        bytes += statement.statement.capacity() + statement.result.memoryBytes();
+    }
+    return bytes;
+}
+
+}  // namespace
+
+AsyncQueryExecutor::AsyncQueryExecutor(size_t workerCount, size_t perConnectionLimit, AdmissionController& admission, std::filesystem::path spillRoot)
+    : m_workerCount((std::max)(workerCount, size_t{1}))
+    , m_perConnectionLimit((std::max)(perConnectionLimit, size_t{1}))
+    , m_admission(admission)
+    , m_admissionGate(std::make_shared<AdmissionGate>()) {
+    static std::atomic<uint64_t> sequence{0};
+    m_admissionGate->executor = this;
+    m_spillDirectory = (spillRoot.empty() ? ResultRegistry::defaultSpillRoot() : spillRoot) /
+                       std::format("async-{}-{}", std::chrono::system_clock::now().time_since_epoch().count(), sequence.fetch_add(1));
+    m_reclaimerId = MemoryGovernor::instance().addReclaimer(MemoryPool::InFlight, [this](size_t wanted) { return reclaimRetained(wanted); });
+}
+
 AsyncQueryExecutor::~AsyncQueryExecutor() {
+    MemoryGovernor::instance().removeReclaimer(m_reclaimerId);
+    {
+        // Grants arriving from now on only release their ticket again
+        std::lock_guard gateLock(m_admissionGate->mutex);
+        m_admissionGate->executor = nullptr;
+    }
+
     std::vector<std::shared_ptr<QueryTask>> tasks;
+    m_tasks.forEach([&](uint64_t, const std::shared_ptr<QueryTask>& task) { tasks.push_back(task); });
+
+    // Queued tasks are marked cancelled so a worker picking one up skips it; running ones are interrupted
+    for (auto& task : tasks) {
+        auto expected = QueryStatus::Pending;
+        task->cancellation.cancel();
+        if (!task->status.compare_exchange_strong(expected, QueryStatus::Cancelled) && expected == QueryStatus::Running && task->driver) {
+            task->driver->cancel();
+            std::lock_guard resultLock(task->resultMutex);
+            for (const auto& laneDriver : task->laneDrivers) {
+                laneDriver->cancel();
+            }
+        }
+    }
 
-    // Lock only to copy the task list
+    std::vector<std::thread> workers;
     {
-        std::lock_guard lock(m_mutex);
-        tasks.reserve(m_queries.size());
-        for (auto& [id, task] : m_queries) {
-            tasks.push_back(task);
+        std::lock_guard lock(m_queueMutex);
+        m_stopping = true;
+        workers = std::move(m_workers);
+    }
+    m_queueCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    // Jobs still queued are dropped with the executor, giving up their place in the admission queue
+    queueDepthGauge().add(-static_cast<int64_t>(m_queues[0].size() + m_queues[1].size()));
+    for (const auto& queue : m_queues) {
+        for (const auto& job : queue) {
+            if (job.admission) {
+                (void)m_admission.withdraw(job.admission->server, job.admission->waiterId);
+            }
         }
     }
+    // Tasks still referring to spill files only try to remove them again
+    std::error_code ec;
+    std::filesystem::remove_all(m_spillDirectory, ec);
+}
 
-    // Cancel and wait WITHOUT holding the mutex
-    for (auto& task : tasks) {
-        if (task->future.valid()) {
-            // Cancel if still running
-            if (task->status == QueryStatus::Running && task->driver) {
-                task->driver->cancel();
+void AsyncQueryExecutor::growPoolIfNeeded() {
+    size_t queued = m_queues[0].size() + m_queues[1].size();
+    if (m_workers.size() < m_workerCount && m_busyWorkers + queued > m_workers.size()) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+std::optional<AsyncQueryExecutor::Job> AsyncQueryExecutor::takeRunnableJob() {
+    for (auto& queue : m_queues) {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->admission && !it->admission->ticket && it->task->status.load(std::memory_order_acquire) == QueryStatus::Pending) {
+                continue;  // Still waiting for its server
+            }
+            if (it->connectionId.empty()) {
+                Job job = std::move(*it);
+                queue.erase(it);
+                queueDepthGauge().add(-1);
+                return job;
+            }
+            auto& running = m_runningPerConnection[it->connectionId];
+            if (running < m_perConnectionLimit) {
+                ++running;
+                Job job = std::move(*it);
+                queue.erase(it);
+                queueDepthGauge().add(-1);
+                return job;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void AsyncQueryExecutor::workerLoop() {
+    std::unique_lock lock(m_queueMutex);
+    while (true) {
+        std::optional<Job> job;
+        m_queueCondition.wait(lock, [&] { return m_stopping || (job = takeRunnableJob()).has_value(); });
+        if (!job) {
+            return;
+        }
+
+        ++m_busyWorkers;
+        lock.unlock();
+        bool started = job->task->status.load(std::memory_order_acquire) == QueryStatus::Pending;
+        job->run();
+        if (job->admission) {
+            // Only a query cancelled while queued can still be waiting; either way its share goes back right away
+            if (!started) {
+                (void)m_admission.withdraw(job->admission->server, job->admission->waiterId);
+            }
+            job->admission.reset();
+        }
+        // Reported once the result is published, so a listener reacting to it can fetch the result right away.
+        // Tasks cancelled while queued were already reported by cancelQuery.
+        if (started) {
+            notify(*job->task);
+        }
+        retire(job->task->handle);
+        job->task.reset();
+        lock.lock();
+        --m_busyWorkers;
+
+        if (!job->connectionId.empty()) {
+            if (auto it = m_runningPerConnection.find(job->connectionId); it != m_runningPerConnection.end() && --it->second == 0) {
+                m_runningPerConnection.erase(it);
+            }
+            // A job held back by the per-connection limit may be runnable now
+            m_queueCondition.notify_all();
+        }
+    }
+}
+
+void AsyncQueryExecutor::setStatusListener(StatusListener listener) {
+    std::lock_guard lock(m_listenerMutex);
+    m_statusListener = std::move(listener);
+}
+
+void AsyncQueryExecutor::notify(const QueryTask& task) {
+    // Held across the call so setStatusListener(nullptr) is a barrier for whoever owns the listener's target
+    std::lock_guard lock(m_listenerMutex);
+    if (m_statusListener) {
+        m_statusListener(task.id, task.status.load(std::memory_order_acquire), task.rowsFetched.load(std::memory_order_relaxed));
+    }
+}
+
+void AsyncQueryExecutor::executeTracked(IDatabaseDriver& driver, const std::string& sql, size_t index, QueryTask& task) {
+    // Batches are appended straight into the statement's partial result, where getQueryRows can page through them
+    struct TaskSink final : RowBatchSink {
+        AsyncQueryExecutor& executor;
+        QueryTask& task;
+        size_t index;
+        size_t rowLimit = 0;     // Enforced here for drivers that take no ExecuteOptions (0 = none)
+        bool truncated = false;  // Rows past rowLimit were dropped
+
+        TaskSink(AsyncQueryExecutor& owner, QueryTask& target, size_t statement) : executor(owner), task(target), index(statement) {}
+
+        void onColumns(const std::vector<ColumnInfo>& columns) override {
+            std::lock_guard lock(task.resultMutex);
+            task.partial[index].result.columns = columns;
+        }
+
+        bool onBatch(const ResultSet& batch) override {
+            if (task.status.load(std::memory_order_acquire) == QueryStatus::Cancelled) {
+                return false;
+            }
+            bool notifyNow = false;
+            size_t appended = batch.rowCount();
+            {
+                std::lock_guard lock(task.resultMutex);
+                auto& result = task.partial[index].result;
+                const size_t before = result.memoryBytes();
+                if (rowLimit != 0 && result.rowCount() + batch.rowCount() > rowLimit) [[unlikely]] {
+                    appended = rowLimit - result.rowCount();
+                    for (size_t row = 0; row < appended; ++row) {
+                        result.appendRowFrom(batch, row);
+                    }
+                    result.updateStats();
+                    truncated = true;
+                } else {
+                    result.appendBatch(batch);
+                }
+                task.heldBytes.set(task.heldBytes.bytes() + result.memoryBytes() - before);
+                if (auto now = std::chrono::steady_clock::now(); now - task.lastProgressNotify >= PROGRESS_NOTIFY_INTERVAL) {
+                    task.lastProgressNotify = now;
+                    notifyNow = true;
+                }
+            }
+            task.rowsFetched.fetch_add(appended, std::memory_order_relaxed);
+            // Streaming rows cannot be given back, so a growing fetch makes room by evicting and spilling elsewhere
+            task.heldBytes.governor().reclaimIfNeeded();
+            if (notifyNow) {
+                executor.notify(task);
+            }
+            return !truncated;
+        }
+    } sink(*this, task, index);
+
+    // The limit is also sent as SQL_ATTR_MAX_ROWS, which must not reach DML
+    const ExecuteOptions limits{.maxRows = SQLParser::isReadOnlyQuery(sql) ? task.maxRows : 0, .cancelRequested = task.cancellation.flag()};
+    StreamSummary summary;
+    if (auto* sqlServer = dynamic_cast<SQLServerDriver*>(&driver)) {
+        summary = sqlServer->executeStreaming(sql, sink, STREAM_BATCH_ROWS, limits);
+    } else {
+        // Cancellation reaches these through cancel(); the row limit is applied by the sink
+        sink.rowLimit = limits.maxRows;
+        summary = driver.executeStreaming(sql, sink, STREAM_BATCH_ROWS);
+        summary.truncated = sink.truncated;
+    }
+    std::lock_guard lock(task.resultMutex);
+    auto& result = task.partial[index].result;
+    result.affectedRows = summary.affectedRows;
+    result.executionTimeMs = summary.executionTimeMs;
+    result.fetchStats = summary.fetchStats;
+    result.messages = std::move(summary.messages);
+    result.truncated = summary.truncated;
+}
+
+void AsyncQueryExecutor::runStatement(IDatabaseDriver& driver, const std::string& stmt, size_t index, QueryTask& task) {
+    {
+        std::lock_guard lock(task.resultMutex);
+        if (task.partial.size() <= index) {
+            task.partial.resize(index + 1);
+            task.statementDone.resize(index + 1);
+        }
+        task.partial[index].statement = stmt;
+    }
+
+    if (task.multipleResults && SQLParser::isUseStatement(stmt)) {
+        // Execute USE statement
+        [[maybe_unused]] auto _ = driver.execute(stmt);
+        std::string dbName = SQLParser::extractDatabaseName(stmt);
+        if (task.onDatabaseChange) {
+            task.onDatabaseChange(dbName);
+        }
+
+        // Create result for USE statement
+        std::lock_guard lock(task.resultMutex);
+        auto& currentResult = task.partial[index].result;
+        currentResult.columns.push_back({.name = "Message", .type = "VARCHAR", .size = 255, .nullable = false, .isPrimaryKey = false});
+        currentResult.appendRow({std::format("Database changed to {}", dbName)});
+    } else {
+        executeTracked(driver, stmt, index, task);
+    }
+
+    std::lock_guard lock(task.resultMutex);
+    task.statementDone[index] = true;
+}
+
+void AsyncQueryExecutor::runTask(IDatabaseDriver& driver, const std::vector<std::string>& statements, QueryTask& task) {
+    if (!startTask(task)) {
+        return;
+    }
+    if (task.onRunningChange) {
+        task.onRunningChange(task.id, driver, true);
+    }
+    struct RunningScope {
+        QueryTask& task;
+        IDatabaseDriver& driver;
+        ~RunningScope() {
+            if (task.onRunningChange) {
+                task.onRunningChange(task.id, driver, false);
             }
-            // Wait for completion (this can block, but we're not holding the mutex)
-            task->future.wait();
         }
+    } runningScope{task, driver};
+    size_t failedIndex = 0;
+    try {
+        const size_t maxParallel = task.checkoutLane ? MAX_PARALLEL_STATEMENTS : 1;
+        runStatementWaves(statements, maxParallel, [&](size_t index, bool concurrent) {
+            if (task.status.load(std::memory_order_acquire) == QueryStatus::Cancelled) {
+                return;
+            }
+            if (!concurrent) {
+                runStatement(driver, statements[index], index, task);
+                return;
+            }
+            auto lane = task.checkoutLane();
+            if (!lane) [[unlikely]] {
+                throw std::runtime_error("Connection is no longer open");
+            }
+            auto laneDriver = lane.driver();
+            {
+                std::lock_guard lock(task.resultMutex);
+                task.laneDrivers.push_back(laneDriver);
+            }
+            // A cancel that landed before the driver was registered would otherwise miss it
+            if (task.status.load(std::memory_order_acquire) == QueryStatus::Cancelled) {
+                laneDriver->cancel();
+            }
+            try {
+                runStatement(*laneDriver, statements[index], index, task);
+            } catch (...) {
+                std::lock_guard lock(task.resultMutex);
+                std::erase(task.laneDrivers, laneDriver);
+                throw;
+            }
+            std::lock_guard lock(task.resultMutex);
+            std::erase(task.laneDrivers, laneDriver);
+        }, failedIndex);
+        publishResult(task, QueryStatus::Completed);
+    } catch (const std::exception& e) {
+        task.errorMessage = statements.size() > 1 && task.checkoutLane ? std::format("Statement {} of {}: {}", failedIndex + 1, statements.size(), e.what()) : e.what();
+        // Earlier statements of a script may have applied, so only a lone statement is safe to resend
+        task.retriable = statements.size() == 1 && isConnectionLost(e);
+        publishResult(task, QueryStatus::Failed);
+    }
+}
+
+void AsyncQueryExecutor::publishResult(QueryTask& task, QueryStatus status) {
+    std::lock_guard lock(task.resultMutex);
+    if (status == QueryStatus::Failed) {
+        task.partial.clear();
     }
+    if (task.multipleResults) {
+        task.finalResult = std::move(task.partial);
+    } else {
+        task.finalResult = task.partial.empty() ? ResultSet{} : std::move(task.partial.front().result);
+    }
+    task.partial.clear();
+    task.lastRead = std::chrono::steady_clock::now();
+    // The result is in place before the status turns terminal, so readers seeing Completed always find it
+    finishTask(task, status);
+}
+
+bool AsyncQueryExecutor::startTask(QueryTask& task) {
+    auto expected = QueryStatus::Pending;
+    if (!task.status.compare_exchange_strong(expected, QueryStatus::Running, std::memory_order_acq_rel)) {
+        return false;
+    }
+    task.lastProgressNotify = std::chrono::steady_clock::now();
+    notify(task);
+    return true;
 }
 
-std::string AsyncQueryExecutor::submitQuery(std::shared_ptr<SQLServerDriver> driver, std::string_view sql) {
-    auto queryId = std::format("query_{}", m_queryIdCounter++);
+void AsyncQueryExecutor::finishTask(QueryTask& task, QueryStatus status) {
+    task.endTime = std::chrono::steady_clock::now();
+    auto expected = QueryStatus::Running;
+    task.status.compare_exchange_strong(expected, status, std::memory_order_acq_rel);
+}
 
+std::string AsyncQueryExecutor::submitQuery(std::shared_ptr<IDatabaseDriver> driver, std::string_view sql, QueryLane lane, QuerySubmitOptions options) {
     auto task = std::make_shared<QueryTask>();
     task->driver = driver;  // shared_ptr ensures driver lifetime
     task->sql = std::string(sql);
     task->startTime = std::chrono::steady_clock::now();
-    task->status = QueryStatus::Running;
+    // Sharing the lane's token lets a cancel of the whole connection reach this query as well
+    task->cancellation = lane.cancellation() ? lane.cancellation() : CancellationToken::create();
 
-    // Split SQL into multiple statements
+    // Split SQL into multiple statements; a single statement runs as written
     auto statements = SQLParser::splitStatements(sql);
     task->multipleResults = statements.size() > 1;
-
-    // Capture shared_ptr by value to ensure driver and task lifetime extends through async execution
-    if (statements.size() > 1) {
-        // Multiple statements: execute sequentially and collect all results
-        task->future = std::async(std::launch::async, [driver, statements, task]() -> QueryResultVariant {
-            try {
-                std::vector<StatementResult> allResults;
-                allResults.reserve(statements.size());
-
-                for (const auto& stmt : statements) {
-                    ResultSet currentResult;
-
-                    if (SQLParser::isUseStatement(stmt)) {
-                        // Execute USE statement
-                        [[maybe_unused]] auto _ = driver->execute(stmt);
-                        std::string dbName = SQLParser::extractDatabaseName(stmt);
-
-                        // Create result for USE statement
-                        currentResult.columns.push_back({.name = "Message", .type = "VARCHAR", .size = 255, .nullable = false, .isPrimaryKey = false});
-                        ResultRow messageRow;
-                        messageRow.values.push_back(std::format("Database changed to {}", dbName));
-                        currentResult.rows.push_back(messageRow);
-                        currentResult.affectedRows = 0;
-                        currentResult.executionTimeMs = 0.0;
-                    } else {
-                        currentResult = driver->execute(stmt);
-                    }
-
-                    allResults.push_back(StatementResult{.statement = stmt, .result = std::move(currentResult)});
-                }
-
-                task->endTime = std::chrono::steady_clock::now();
-                task->status = QueryStatus::Completed;
-                return allResults;
-            } catch (const std::exception& e) {
-                task->endTime = std::chrono::steady_clock::now();
-                task->errorMessage = e.what();
-                task->status = QueryStatus::Failed;
-                return std::vector<StatementResult>{};
-            }
-        });
+    if (!task->multipleResults) {
+        statements.assign(1, std::string(sql));
     } else {
-        // Single statement
-        std::string sqlCopy(sql);
-        task->future = std::async(std::launch::async, [driver, sqlCopy, task]() -> QueryResultVariant {
-            try {
-                auto result = driver->execute(sqlCopy);
-                task->endTime = std::chrono::steady_clock::now();
-                task->status = QueryStatus::Completed;
-                return result;
-            } catch (const std::exception& e) {
-                task->endTime = std::chrono::steady_clock::now();
-                task->errorMessage = e.what();
-                task->status = QueryStatus::Failed;
-                return ResultSet{};
+        task->checkoutLane = std::move(options.checkoutLane);
+        task->onDatabaseChange = std::move(options.onDatabaseChange);
+    }
+    task->onRunningChange = std::move(options.onRunningChange);
+    task->maxRows = options.maxRows;
+
+    Job job;
+    job.connectionId = std::move(options.connectionId);
+    job.task = task;
+    if (!options.admission.server.empty()) {
+        // Queued before the job is visible to workers; the grant may arrive right away, even before the push below
+        job.admission = std::make_shared<AdmissionSlot>();
+        job.admission->server = options.admission.server;
+        job.admission->waiterId = m_admission.enqueue(options.admission, [gate = m_admissionGate, slot = job.admission](AdmissionTicket ticket) {
+            std::lock_guard gateLock(gate->mutex);
+            if (auto* executor = gate->executor) {
+                {
+                    std::lock_guard lock(executor->m_queueMutex);
+                    slot->ticket = std::move(ticket);
+                }
+                executor->m_queueCondition.notify_all();
             }
         });
     }
+    // Capture shared_ptr by value to ensure driver and task lifetime extends through async execution
+    job.run = std::packaged_task<void()>([this, driver, statements = std::move(statements), task, lane = std::move(lane), traceId = QueryTracer::currentTraceId()]() mutable {
+        // The lane frees up as soon as execution ends, while the task (and its driver) sticks around for the result
+        auto heldLane = std::move(lane);
+        static auto& queueWait = MetricsRegistry::instance().histogram("async.queue_wait_us");
+        queueWait.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - task->startTime).count()));
+        TraceContext trace(traceId);
+        TraceScope span("async.run");
+        runTask(*driver, statements, *task);
+    });
 
-    std::lock_guard lock(m_mutex);
-    m_queries[queryId] = task;
+    const auto admission = job.admission;
+    try {
+        std::lock_guard lock(m_queueMutex);
+        size_t queued = m_queues[0].size() + m_queues[1].size();
+        if (queued >= MAX_QUEUED_QUERIES) {
+            ++m_rejected;
+            throw std::runtime_error(std::format("Too many queued queries ({}); wait for running queries to finish", queued));
+        }
+        // Registered under the queue lock, so a rejected submission never shows up in the table
+        const uint64_t handle = m_tasks.insert(
+            [&](uint64_t next) {
+                task->handle = next;
+                task->id = TaskTable::formatId(next);
+                return task;
+            },
+            isLive);
+        if (handle == 0) [[unlikely]] {
+            ++m_rejected;
+            throw std::runtime_error("Too many tracked queries; wait for running queries to finish");
+        }
+        {
+            std::lock_guard activeLock(m_mutex);
+            m_active.push_back(handle);
+        }
+        m_queues[static_cast<size_t>(options.priority)].push_back(std::move(job));
+        m_peakQueueDepth = (std::max)(m_peakQueueDepth, queued + 1);
+        queueDepthGauge().add(1);
+        ++m_submitted;
+        growPoolIfNeeded();
+    } catch (...) {
+        // Rejected: give up the place in the admission queue (a ticket already granted goes with the job)
+        if (admission) {
+            (void)m_admission.withdraw(admission->server, admission->waiterId);
+        }
+        throw;
+    }
 
-    return queryId;
+    m_queueCondition.notify_one();
+
+    return task->id;
 }
 
-AsyncQueryResult AsyncQueryExecutor::getQueryResult(std::string_view queryId) {
-    std::shared_ptr<QueryTask> task;
+QueryQueueStats AsyncQueryExecutor::queueStats() const {
+    std::lock_guard lock(m_queueMutex);
+    return QueryQueueStats{.workers = m_workers.size(),
+                           .busyWorkers = m_busyWorkers,
+                           .queuedInteractive = m_queues[static_cast<size_t>(QueryPriority::Interactive)].size(),
+                           .queuedBackground = m_queues[static_cast<size_t>(QueryPriority::Background)].size(),
+                           .peakQueueDepth = m_peakQueueDepth,
+                           .submitted = m_submitted,
+                           .rejected = m_rejected};
+}
 
-    // Lock only to find and copy the task pointer
-    {
-        std::lock_guard lock(m_mutex);
-        auto iter = m_queries.find(std::string(queryId));
-        if (iter == m_queries.end()) {
-            return AsyncQueryResult{.queryId = std::string(queryId), .status = QueryStatus::Failed, .errorMessage = "Query not found"};
-        }
-        task = iter->second;
+AsyncQueryResult AsyncQueryExecutor::getQueryResult(std::string_view queryId) {
+    auto task = findTask(queryId);
+    if (!task) {
+        return AsyncQueryResult{.queryId = std::string(queryId), .status = QueryStatus::Failed, .errorMessage = "Query not found"};
     }
 
-    // Now operate on the task WITHOUT holding the mutex
     AsyncQueryResult result;
     result.queryId = std::string(queryId);
     result.status = task->status.load();
@@ -129,51 +489,168 @@ AsyncQueryResult AsyncQueryExecutor::getQueryResult(std::string_view queryId) {
     result.startTime = task->startTime;
     result.endTime = task->endTime;
     result.errorMessage = task->errorMessage;
+    result.retriable = task->retriable;
+    result.rowsFetched = task->rowsFetched.load(std::memory_order_relaxed);
 
-    // If completed, get the result (cache it to avoid double future.get() call)
-    // Use wait_for(0) to avoid blocking the UI thread when status is set before future is ready
+    bool restored = false;
     if (result.status == QueryStatus::Completed || result.status == QueryStatus::Failed) {
-        if (!task->cachedResult.has_value() && task->future.valid()) {
-            if (task->future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-                try {
-                    task->cachedResult = task->future.get();
-                } catch (...) {
-                    result.status = QueryStatus::Failed;
-                    result.errorMessage = "Failed to retrieve result";
-                }
-            } else {
-                // Future not ready yet despite status - report as still running
-                result.status = QueryStatus::Running;
-                return result;
-            }
+        std::lock_guard lock(task->resultMutex);
+        task->lastRead = std::chrono::steady_clock::now();
+        try {
+            restored = restoreResult(*task);
+        } catch (const std::exception& e) {
+            result.status = QueryStatus::Failed;
+            result.errorMessage = e.what();
         }
-        if (task->cachedResult.has_value()) {
+        if (task->finalResult.has_value()) {
             if (task->multipleResults) {
                 // Multiple results
-                result.results = std::get<std::vector<StatementResult>>(*task->cachedResult);
+                result.results = std::get<std::vector<StatementResult>>(*task->finalResult);
             } else {
                 // Single result
-                result.result = std::get<ResultSet>(*task->cachedResult);
+                result.result = std::get<ResultSet>(*task->finalResult);
             }
         }
     }
+    if (restored) {
+        afterRestore(task->handle);
+    }
 
     return result;
 }
 
-bool AsyncQueryExecutor::cancelQuery(std::string_view queryId) {
-    std::lock_guard lock(m_mutex);
+AsyncQueryRows AsyncQueryExecutor::getQueryRows(std::string_view queryId, size_t statementIndex, size_t offset, size_t limit) {
+    return readStatement(
+        queryId, statementIndex,
+        [&](const ResultSet& source, size_t firstRow, AsyncQueryRows& page) {
+            page.offset = offset;
+            const size_t end = offset + (std::min)(limit, page.totalRows - (std::min)(offset, page.totalRows));
+            for (size_t row = offset; row < end; ++row) {
+                page.rows.appendRowFrom(source, row - firstRow);
+            }
+        },
+        std::pair{offset, limit});
+}
+
+AsyncQueryRows AsyncQueryExecutor::filterQueryRows(std::string_view queryId, size_t statementIndex, const RowSelector& select, size_t offset, size_t limit) {
+    return readStatement(queryId, statementIndex, [&](const ResultSet& source, size_t, AsyncQueryRows& page) {
+        const auto matches = select(source);
+        page.offset = offset;
+        page.matchedRows = matches.size();
+        const size_t end = offset + (std::min)(limit, matches.size() - (std::min)(offset, matches.size()));
+        for (size_t i = offset; i < end; ++i) {
+            page.rows.appendRowFrom(source, matches[i]);
+        }
+    });
+}
+
+AsyncQueryRows AsyncQueryExecutor::readStatement(std::string_view queryId, size_t statementIndex, const StatementReader& read, std::optional<std::pair<size_t, size_t>> rows) {
+    auto task = findTask(queryId);
+    if (!task) {
+        return AsyncQueryRows{.queryId = std::string(queryId), .status = QueryStatus::Failed, .errorMessage = "Query not found"};
+    }
+
+    AsyncQueryRows page;
+    page.queryId = std::string(queryId);
+    page.status = task->status.load(std::memory_order_acquire);
+    if (page.status == QueryStatus::Failed) {
+        page.errorMessage = task->errorMessage;
+        page.retriable = task->retriable;
+    }
+
+    bool restored = false;
+    {
+        std::lock_guard lock(task->resultMutex);
+        task->lastRead = std::chrono::steady_clock::now();
+        try {
+            if (!rows) {
+                restored = restoreResult(*task);
+            }
+            readLocked(*task, statementIndex, read, rows, page);
+        } catch (const std::exception& e) {
+            page.status = QueryStatus::Failed;
+            page.errorMessage = e.what();
+        }
+    }
+    if (restored) {
+        afterRestore(task->handle);
+    }
+    return page;
+}
+
+void AsyncQueryExecutor::readLocked(const QueryTask& task, size_t statementIndex, const StatementReader& read, std::optional<std::pair<size_t, size_t>> rows,
+                                    AsyncQueryRows& page) {
+    std::optional<ResultSet> window;
+    size_t firstRow = 0;
+    size_t totalRows = 0;
+    const ResultSet* source = nullptr;
+    if (!task.retained.empty()) {
+        // Compressed: only the windows covering the requested rows are decompressed
+        page.statementComplete = true;
+        page.statementCount = task.retained.size();
+        if (statementIndex >= task.retained.size()) {
+            return;
+        }
+        const auto& stored = task.retained[statementIndex].result;
+        window = stored.window(rows->first, rows->second);
+        firstRow = rows->first;
+        totalRows = stored.rowCount();
+        source = &*window;
+    } else if (task.finalResult.has_value()) {
+        page.statementComplete = true;
+        if (auto* single = std::get_if<ResultSet>(&*task.finalResult)) {
+            page.statementCount = 1;
+            source = statementIndex == 0 ? single : nullptr;
+        } else {
+            const auto& all = std::get<std::vector<StatementResult>>(*task.finalResult);
+            page.statementCount = all.size();
+            source = statementIndex < all.size() ? &all[statementIndex].result : nullptr;
+        }
+    } else {
+        page.statementCount = task.partial.size();
+        page.statementComplete = statementIndex < task.statementDone.size() && task.statementDone[statementIndex];
+        source = statementIndex < task.partial.size() ? &task.partial[statementIndex].result : nullptr;
+    }
+    if (!source) {
+        return;
+    }
+
+    page.totalRows = window ? totalRows : source->rowCount();
+    page.rows.columns = source->columns;
+    page.rows.affectedRows = source->affectedRows;
+    page.rows.executionTimeMs = source->executionTimeMs;
+    read(*source, firstRow, page);
+}
 
-    auto iter = m_queries.find(std::string(queryId));
-    if (iter == m_queries.end()) {
+bool AsyncQueryExecutor::cancelQuery(std::string_view queryId) {
+    auto task = findTask(queryId);
+    if (!task) {
         return false;
     }
 
-    auto& task = iter->second;
-    if (task->status == QueryStatus::Running && task->driver) {
-        task->driver->cancel();
-        task->status = QueryStatus::Cancelled;
+    // Raised either way: a statement about to start sees it before reaching the server
+    task->cancellation.cancel();
+    auto expected = QueryStatus::Pending;
+    if (task->status.compare_exchange_strong(expected, QueryStatus::Cancelled)) {
+        // Still queued: the worker that dequeues it will skip it
         task->endTime = std::chrono::steady_clock::now();
+        notify(*task);
+        // One still waiting for admission becomes takeable only now
+        m_queueCondition.notify_all();
+        return true;
+    }
+    if (expected == QueryStatus::Running && task->driver) {
+        // Status first: a parallel statement registering its lane after the loop below sees it and cancels itself.
+        // Losing the exchange means the worker finished meanwhile, and its result stands.
+        if (!task->status.compare_exchange_strong(expected, QueryStatus::Cancelled, std::memory_order_acq_rel)) {
+            return false;
+        }
+        task->endTime = std::chrono::steady_clock::now();
+        task->driver->cancel();
+        std::lock_guard resultLock(task->resultMutex);
+        for (const auto& laneDriver : task->laneDrivers) {
+            laneDriver->cancel();
+        }
         return true;
     }
 
@@ -181,66 +658,266 @@ bool AsyncQueryExecutor::cancelQuery(std::string_view queryId) {
 }
 
 bool AsyncQueryExecutor::isQueryRunning(std::string_view queryId) const {
-    std::lock_guard lock(m_mutex);
-
-    auto iter = m_queries.find(std::string(queryId));
-    if (iter == m_queries.end()) {
-        return false;
-    }
-
-    return iter->second->status == QueryStatus::Running;
+    auto task = findTask(queryId);
+    return task && task->status == QueryStatus::Running;
 }
 
 bool AsyncQueryExecutor::removeQuery(std::string_view queryId) {
-    std::lock_guard lock(m_mutex);
-    auto it = m_queries.find(std::string(queryId));
-    if (it == m_queries.end()) {
-        return false;
-    }
-    auto status = it->second->status.load();
-    if (status == QueryStatus::Pending || status == QueryStatus::Running) {
-        return false;
-    }
-    m_queries.erase(it);
-    return true;
+    auto handle = TaskTable::parseId(queryId);
+    // Its expiry entry stays behind and is skipped once it comes due
+    return handle && m_tasks.erase(*handle, [](const QueryTask& task) { return !isLive(task); });
 }
 
 std::vector<std::string> AsyncQueryExecutor::getActiveQueryIds() const {
-    std::lock_guard lock(m_mutex);
+    std::vector<uint64_t> handles;
+    {
+        std::lock_guard lock(m_mutex);
+        handles = m_active;
+    }
 
     std::vector<std::string> ids;
-    ids.reserve(m_queries.size());
-
-    for (const auto& [id, task] : m_queries) {
-        if (task->status == QueryStatus::Pending || task->status == QueryStatus::Running) {
-            ids.push_back(id);
+    ids.reserve(handles.size());
+    for (uint64_t handle : handles) {
+        // A task cancelled while queued stays on the list until a worker drops it
+        if (auto task = m_tasks.find(handle); task && isLive(*task)) {
+            ids.push_back(task->id);
         }
     }
-
     return ids;
 }
 
 size_t AsyncQueryExecutor::evictStaleQueries(std::chrono::seconds maxAge) {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<QueryTask>> expired;
+    std::vector<std::shared_ptr<QueryTask>> idle;
+    {
+        std::lock_guard lock(m_mutex);
+        while (!m_expiry.empty() && now - m_expiry.front().first > maxAge) {
+            if (auto task = m_tasks.find(m_expiry.front().second); task && !isLive(*task)) {
+                expired.push_back(std::move(task));
+            }
+            m_expiry.pop_front();
+        }
+        while (!m_idle.empty() && m_idle.front().first <= now) {
+            if (auto task = m_tasks.find(m_idle.front().second)) {
+                idle.push_back(std::move(task));
+            }
+            m_idle.pop_front();
+        }
+    }
+
+    // Compressing and writing files happens outside m_mutex, one task at a time
+    std::vector<uint64_t> dropped;
+    std::vector<uint64_t> spilled;
+    std::vector<std::pair<std::chrono::steady_clock::time_point, uint64_t>> stillRead;
+    for (const auto& task : expired) {
+        std::lock_guard lock(task->resultMutex);
+        (spillResult(*task) ? spilled : dropped).push_back(task->handle);
+    }
+    for (const auto& task : idle) {
+        std::lock_guard lock(task->resultMutex);
+        if (const auto due = task->lastRead + RESULT_IDLE_COMPRESS; due > now) {
+            stillRead.emplace_back(due, task->handle);
+        } else if (now - task->endTime > maxAge) {
+            // Restored after it expired: straight back to disk
+            (spillResult(*task) ? spilled : dropped).push_back(task->handle);
+        } else {
+            (void)compressResult(*task);
+        }
+    }
+
     std::lock_guard lock(m_mutex);
-    if (m_queries.empty()) {
+    size_t evicted = 0;
+    for (uint64_t handle : dropped) {
+        if (m_tasks.erase(handle, [](const QueryTask& task) { return !isLive(task); })) {
+            ++evicted;
+        }
+    }
+    evicted += spilled.size();
+    // Read since it was queued: look again once it has been idle long enough. Queued slightly out of order,
+    // which only delays its compression by up to RESULT_IDLE_COMPRESS.
+    m_idle.insert(m_idle.end(), stillRead.begin(), stillRead.end());
+    m_spilled.insert(m_spilled.end(), spilled.begin(), spilled.end());
+    if (!spilled.empty()) {
+        evicted += trimSpilled();
+    }
+    return evicted;
+}
+
+size_t AsyncQueryExecutor::compressResult(QueryTask& task) {
+    if (!task.finalResult.has_value()) {
         return 0;
     }
-    auto now = std::chrono::steady_clock::now();
-    if (now - m_lastEvictTime < EVICT_INTERVAL) {
+    std::vector<RetainedStatement> retained;
+    try {
+        if (const auto* single = std::get_if<ResultSet>(&*task.finalResult)) {
+            retained.push_back({.statement = {}, .result = CompressedResult::compress(*single)});
+        } else {
+            for (const auto& statement : std::get<std::vector<StatementResult>>(*task.finalResult)) {
+                retained.push_back({.statement = statement.statement, .result = CompressedResult::compress(statement.result)});
+            }
+        }
+    } catch (const std::exception& e) {
+        log<LogLevel::WARNING>(std::format("Cannot compress result of {}: {}", task.id, e.what()));
         return 0;
     }
-    m_lastEvictTime = now;
+    size_t bytes = 0;
+    for (const auto& statement : retained) {
+        bytes += statement.statement.capacity() + statement.result.memoryBytes();
+    }
+    task.retained = std::move(retained);
+    task.finalResult.reset();
+    const size_t before = task.heldBytes.bytes();
+    task.heldBytes.set(bytes);
+    return before - (std::min)(before, bytes);
+}
+
+bool AsyncQueryExecutor::restoreResult(QueryTask& task) {
+    if (task.retained.empty()) {
+        return false;
+    }
+    if (task.multipleResults) {
+        std::vector<StatementResult> all;
+        all.reserve(task.retained.size());
+        for (const auto& statement : task.retained) {
+            all.push_back({.statement = statement.statement, .result = statement.result.decompress()});
+        }
+        task.finalResult = std::move(all);
+    } else {
+        task.finalResult = task.retained.front().result.decompress();
+    }
+    // Dropping the compressed copy removes its spill files
+    task.retained.clear();
+    task.heldBytes.set(resultBytes(*task.finalResult));
+    return true;
+}
 
-    auto sizeBefore = m_queries.size();
-    std::erase_if(m_queries, [&](const auto& pair) {
-        const auto& task = pair.second;
-        auto status = task->status.load();
-        if (status == QueryStatus::Pending || status == QueryStatus::Running) {
+bool AsyncQueryExecutor::spillResult(QueryTask& task) {
+    (void)compressResult(task);
+    size_t rows = 0;
+    for (const auto& statement : task.retained) {
+        rows += statement.result.rowCount();
+    }
+    if (rows == 0) {
+        return false;
+    }
+    size_t bytes = 0;
+    for (size_t i = 0; i < task.retained.size(); ++i) {
+        auto& result = task.retained[i].result;
+        if (result.rowCount() > 0 && !result.spill(m_spillDirectory / std::format("{}_{}.lz4", task.id, i))) [[unlikely]] {
+            log<LogLevel::WARNING>(std::format("Cannot spill result of {} to {}", task.id, m_spillDirectory.string()));
             return false;
         }
-        return (now - task->endTime) > maxAge;
-    });
-    return sizeBefore - m_queries.size();
+        bytes += task.retained[i].statement.capacity() + result.memoryBytes();
+    }
+    task.heldBytes.set(bytes);
+    return true;
+}
+
+void AsyncQueryExecutor::afterRestore(uint64_t handle) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_idle.emplace_back(std::chrono::steady_clock::now() + RESULT_IDLE_COMPRESS, handle);
+    }
+    MemoryGovernor::instance().reclaimIfNeeded();
+}
+
+size_t AsyncQueryExecutor::trimSpilled() {
+    // Newest first, so what goes over the cap is the oldest; a handle spilled twice counts once
+    std::unordered_set<uint64_t> seen;
+    size_t diskBytes = 0;
+    std::deque<uint64_t> kept;
+    std::vector<uint64_t> over;
+    for (auto it = m_spilled.rbegin(); it != m_spilled.rend(); ++it) {
+        if (!seen.insert(*it).second) {
+            continue;
+        }
+        auto task = m_tasks.find(*it);
+        if (!task) {
+            continue;
+        }
+        size_t taskBytes = 0;
+        {
+            std::lock_guard lock(task->resultMutex);
+            for (const auto& statement : task->retained) {
+                taskBytes += statement.result.spilled() ? statement.result.storedBytes() : 0;
+            }
+        }
+        if (taskBytes == 0) {
+            continue;  // Restored meanwhile; queued again once it is spilled again
+        }
+        diskBytes += taskBytes;
+        if (diskBytes > MAX_SPILLED_BYTES) {
+            over.push_back(*it);
+        } else {
+            kept.push_front(*it);
+        }
+    }
+    m_spilled = std::move(kept);
+    size_t dropped = 0;
+    for (uint64_t handle : over) {
+        if (m_tasks.erase(handle, [](const QueryTask& task) { return !isLive(task); })) {
+            ++dropped;
+        }
+    }
+    return dropped;
+}
+
+size_t AsyncQueryExecutor::reclaimRetained(size_t wanted) {
+    std::vector<std::shared_ptr<QueryTask>> retired;
+    {
+        std::lock_guard lock(m_mutex);
+        std::unordered_set<uint64_t> seen;
+        for (const auto& queue : {std::cref(m_expiry), std::cref(m_idle)}) {
+            for (const auto& [due, handle] : queue.get()) {
+                if (auto task = m_tasks.find(handle); task && seen.insert(handle).second && !isLive(*task)) {
+                    retired.push_back(std::move(task));
+                }
+            }
+        }
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    size_t freed = 0;
+    std::vector<uint64_t> spilled;
+    for (const auto& task : retired) {
+        if (freed >= wanted) {
+            break;
+        }
+        std::lock_guard lock(task->resultMutex);
+        if (now - task->lastRead < RESULT_IDLE_COMPRESS) {
+            continue;  // Someone is paging through it
+        }
+        const size_t before = task->heldBytes.bytes();
+        if (spillResult(*task)) {
+            spilled.push_back(task->handle);
+        }
+        freed += before - (std::min)(before, task->heldBytes.bytes());
+    }
+    if (!spilled.empty()) {
+        std::lock_guard lock(m_mutex);
+        m_spilled.insert(m_spilled.end(), spilled.begin(), spilled.end());
+        (void)trimSpilled();
+    }
+    return freed;
+}
+
+std::shared_ptr<AsyncQueryExecutor::QueryTask> AsyncQueryExecutor::findTask(std::string_view queryId) const {
+    auto handle = TaskTable::parseId(queryId);
+    return handle ? m_tasks.find(*handle) : nullptr;
+}
+
+void AsyncQueryExecutor::retire(uint64_t handle) {
+    std::lock_guard lock(m_mutex);
+    std::erase(m_active, handle);
+    const auto now = std::chrono::steady_clock::now();
+    m_expiry.emplace_back(now, handle);
+    m_idle.emplace_back(now + RESULT_IDLE_COMPRESS, handle);
+}
+
+bool AsyncQueryExecutor::isLive(const QueryTask& task) noexcept {
+    const auto status = task.status.load(std::memory_order_acquire);
+    return status == QueryStatus::Pending || status == QueryStatus::Running;
 }
 
 }  // namespace velocitydb
@@ -1,15 +1,27 @@
 #pragma once
 
+#include "../utils/memory_governor.h"
+#include "admission_controller.h"
+#include "compressed_result.h"
+#include "query_handle_table.h"
+#include "query_lane.h"
 #include "sqlserver_driver.h"
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -32,13 +44,82 @@ struct AsyncQueryResult {
     std::optional<ResultSet> result;
     std::vector<StatementResult> results;
     std::string errorMessage;
+    bool retriable = false;  // Failed only because the connection dropped; running it again may succeed
+    size_t rowsFetched = 0;  // Rows streamed so far (progress while Running)
     std::chrono::steady_clock::time_point startTime;
     std::chrono::steady_clock::time_point endTime;
 };
 
+/// One page of the rows an async query has produced so far
+struct AsyncQueryRows {
+    std::string queryId;
+    QueryStatus status = QueryStatus::Pending;
+    size_t statementCount = 0;       ///< Statements started so far (all of them once the query finished)
+    bool statementComplete = false;  ///< No more rows will be appended to the requested statement
+    size_t offset = 0;
+    size_t totalRows = 0;    ///< Rows buffered for the statement so far
+    size_t matchedRows = 0;  ///< filterQueryRows only: buffered rows the selector kept
+    ResultSet rows;          ///< Columns plus rows [offset, offset + limit) (of the matches, when filtering)
+    std::string errorMessage;
+    bool retriable = false;
+};
+
+/// Interactive queries are always dequeued before background ones
+enum class QueryPriority { Interactive, Background };
+
+struct QuerySubmitOptions {
+    std::string connectionId;  ///< Queries with the same id share the per-connection limit (empty = no limit)
+    QueryPriority priority = QueryPriority::Interactive;
+    /// Opt-in parallel scripts: checks out a lane for one session-independent statement. When set, each run of
+    /// consecutive such statements executes concurrently (see runStatementWaves); results keep script order.
+    std::function<QueryLane()> checkoutLane;
+    /// Called once a USE statement ran, so lanes checked out afterwards follow the database (parallel scripts)
+    std::function<void(std::string_view database)> onDatabaseChange;
+    /// Called on the worker with true right before the first statement runs (on the query's own driver) and with
+    /// false once the query finished; never called for a query cancelled while queued
+    std::function<void(std::string_view queryId, IDatabaseDriver& driver, bool running)> onRunningChange;
+    /// Stop each read-only statement after this many rows (0 = no limit); its result then reports `truncated`.
+    /// SQLServerDriver stops the server early; other drivers are cut off at the limit as their batches arrive
+    size_t maxRows = 0;
+    /// Server share the query waits for in the queue before a worker picks it up (empty server = not throttled)
+    AdmissionRequest admission;
+};
+
+struct QueryQueueStats {
+    size_t workers = 0;      ///< Worker threads started so far (grows on demand up to the pool size)
+    size_t busyWorkers = 0;  ///< Workers currently executing a query
+    size_t queuedInteractive = 0;
+    size_t queuedBackground = 0;
+    size_t peakQueueDepth = 0;
+    uint64_t submitted = 0;
+    uint64_t rejected = 0;  ///< Submissions refused because the queue was full
+};
+
+/// Runs queries on a bounded pool of worker threads.
+///
+/// Submissions wait in a two-level priority queue; a worker takes the oldest interactive query that was admitted
+/// to its server (see AdmissionController) and whose connection is under its concurrency limit, then background ones. When the queue is full submitQuery
+/// throws, so bursts of scripted calls get an error instead of an unbounded backlog.
+///
+/// Queries are tracked by integer handle in a QueryHandleTable; the "query_N" string exists only for callers.
+/// Status and row polls find their task without taking the table's write mutex. Finished queries wait for
+/// eviction in a FIFO, so evictStaleQueries only touches the ones that expired.
+///
+/// A finished result nobody read for RESULT_IDLE_COMPRESS is kept as a CompressedResult per statement; row
+/// pages then decompress only the windows they cover, and a full read (getQueryResult, filterQueryRows) restores
+/// it. Results past their age, or taken back by the MemoryGovernor, are spilled to disk rather than dropped; the
+/// oldest spilled ones go once their files pass MAX_SPILLED_BYTES.
 class AsyncQueryExecutor {
 public:
-    AsyncQueryExecutor() = default;
+    static constexpr size_t DEFAULT_WORKER_COUNT = 8;
+    static constexpr size_t DEFAULT_PER_CONNECTION_LIMIT = 4;
+    static constexpr size_t MAX_QUEUED_QUERIES = 256;
+    static constexpr auto RESULT_IDLE_COMPRESS = std::chrono::seconds{30};
+    static constexpr size_t MAX_SPILLED_BYTES = size_t{4} * 1024 * 1024 * 1024;
+
+    /// @param spillRoot Directory this executor spills results under (empty = ResultRegistry::defaultSpillRoot())
+    explicit AsyncQueryExecutor(size_t workerCount = DEFAULT_WORKER_COUNT, size_t perConnectionLimit = DEFAULT_PER_CONNECTION_LIMIT,
+                                AdmissionController& admission = AdmissionController::instance(), std::filesystem::path spillRoot = {});
     ~AsyncQueryExecutor();
 
     AsyncQueryExecutor(const AsyncQueryExecutor&) = delete;
@@ -46,14 +127,39 @@ public:
     AsyncQueryExecutor(AsyncQueryExecutor&&) = delete;
     AsyncQueryExecutor& operator=(AsyncQueryExecutor&&) = delete;
 
+    /// Called on status changes and, at most every PROGRESS_NOTIFY_INTERVAL, while rows stream in.
+    /// Runs on worker threads (or the cancelling thread) and must not block.
+    using StatusListener = std::function<void(std::string_view queryId, QueryStatus status, size_t rowsFetched)>;
+
+    static constexpr auto PROGRESS_NOTIFY_INTERVAL = std::chrono::milliseconds{100};
+    /// Smaller than the driver default so the first rows become readable through getQueryRows early
+    static constexpr size_t STREAM_BATCH_ROWS = 512;
+
+    /// Install (or with nullptr, remove) the status listener; returns once no call to the previous one is in flight
+    void setStatusListener(StatusListener listener);
+
     /// Submits a query for asynchronous execution, returns a unique query ID
     /// Uses shared_ptr to ensure driver lifetime extends through async execution
-    [[nodiscard]] std::string submitQuery(std::shared_ptr<SQLServerDriver> driver, std::string_view sql);
+    /// @param lane Query lane the driver was checked out from; held until execution finishes
+    /// @throws std::runtime_error when MAX_QUEUED_QUERIES are already waiting
+    [[nodiscard]] std::string submitQuery(std::shared_ptr<IDatabaseDriver> driver, std::string_view sql, QueryLane lane = {}, QuerySubmitOptions options = {});
 
     /// Gets the current status and result of a query
     [[nodiscard]] AsyncQueryResult getQueryResult(std::string_view queryId);
 
-    /// Cancels a running query
+    /// Rows [offset, offset + limit) of statement `statementIndex`, readable while the query is still streaming
+    [[nodiscard]] AsyncQueryRows getQueryRows(std::string_view queryId, size_t statementIndex, size_t offset, size_t limit);
+
+    /// Picks row indices (ascending) out of a buffered statement result
+    using RowSelector = std::function<std::vector<size_t>(const ResultSet&)>;
+
+    /// getQueryRows over the rows `select` keeps, evaluated against the buffered result without re-running the query
+    [[nodiscard]] AsyncQueryRows filterQueryRows(std::string_view queryId, size_t statementIndex, const RowSelector& select, size_t offset, size_t limit);
+
+    /// Queue depth and worker utilisation
+    [[nodiscard]] QueryQueueStats queueStats() const;
+
+    /// Cancels a queued or running query
     bool cancelQuery(std::string_view queryId);
 
     /// Checks if a query is still running
@@ -65,28 +171,155 @@ public:
     /// Gets all active query IDs
     [[nodiscard]] std::vector<std::string> getActiveQueryIds() const;
 
-    /// Evicts completed/failed/cancelled queries older than maxAge. Returns number evicted.
+    /// Compresses results idle for RESULT_IDLE_COMPRESS, then spills those of queries finished more than maxAge
+    /// ago (queries without rows are dropped). Returns the number spilled or dropped.
     [[nodiscard]] size_t evictStaleQueries(std::chrono::seconds maxAge = std::chrono::seconds{300});
 
 private:
+    /// One statement of a compressed result
+    struct RetainedStatement {
+        std::string statement;
+        CompressedResult result;
+    };
+
     struct QueryTask {
-        std::future<QueryResultVariant> future;
-        std::optional<QueryResultVariant> cachedResult;  // Cache result after first get()
+        mutable std::mutex resultMutex;                  // guards partial and finalResult
+        std::vector<StatementResult> partial;            // Statements started so far; a running one grows while rows stream in
+        std::vector<bool> statementDone;                 // Per partial entry: no more rows will be appended
+        std::vector<std::shared_ptr<SQLServerDriver>> laneDrivers;  // Extra lanes running statements right now (cancelled with the task)
+        std::optional<QueryResultVariant> finalResult;   // partial moved into place just before the terminal status is set
+        std::vector<RetainedStatement> retained;         // finalResult once compressed (one entry per statement); empty while resident
+        std::chrono::steady_clock::time_point lastRead;  // guarded by resultMutex
         bool multipleResults = false;
         std::atomic<QueryStatus> status{QueryStatus::Pending};
-        std::shared_ptr<SQLServerDriver> driver;  // shared_ptr to prevent use-after-free
+        std::atomic<size_t> rowsFetched{0};
+        MemoryCharge heldBytes{MemoryGovernor::instance(), MemoryPool::InFlight};  // Rows buffered in partial, held until the task goes
+        std::shared_ptr<IDatabaseDriver> driver;  // shared_ptr to prevent use-after-free
+        CancellationToken cancellation;           // The lane's when it has one; raised by cancelQuery, polled by the fetch
         std::string sql;
         std::string errorMessage;
+        bool retriable = false;  // Single statement lost to a dropped connection (set before the Failed status)
         std::chrono::steady_clock::time_point startTime;
         std::chrono::steady_clock::time_point endTime;
+        uint64_t handle = 0;
+        std::string id;  // TaskTable::formatId(handle)
+        std::chrono::steady_clock::time_point lastProgressNotify;  // guarded by resultMutex
+        std::function<QueryLane()> checkoutLane;
+        std::function<void(std::string_view)> onDatabaseChange;
+        std::function<void(std::string_view, IDatabaseDriver&, bool)> onRunningChange;
+        size_t maxRows = 0;
+    };
+
+    /// A queued job's admission: the waiter until granted, then the ticket (held until the job finished)
+    struct AdmissionSlot {
+        std::string server;
+        uint64_t waiterId = 0;
+        std::optional<AdmissionTicket> ticket;  // guarded by m_queueMutex
+    };
+
+    /// Lets grant callbacks reach the executor while it exists; the destructor clears `executor`
+    struct AdmissionGate {
+        std::mutex mutex;
+        AsyncQueryExecutor* executor = nullptr;
     };
 
-    static constexpr auto EVICT_INTERVAL = std::chrono::seconds{60};
+    struct Job {
+        std::packaged_task<void()> run;
+        std::string connectionId;
+        std::shared_ptr<QueryTask> task;
+        std::shared_ptr<AdmissionSlot> admission;  // null when not throttled
+    };
+
+    /// Start another worker if every started one is busy and the pool is not full (m_queueMutex held)
+    void growPoolIfNeeded();
+    void workerLoop();
+    /// Oldest admitted job of the highest priority whose connection is under its limit; a job cancelled while it
+    /// waits for admission is taken as well, to be withdrawn and skipped (m_queueMutex held)
+    [[nodiscard]] std::optional<Job> takeRunnableJob();
+
+    /// Worker body: runs every statement, then publishes the result
+    void runTask(IDatabaseDriver& driver, const std::vector<std::string>& statements, QueryTask& task);
+
+    /// Runs statement `index` (USE included) on `driver` into partial[index]
+    void runStatement(IDatabaseDriver& driver, const std::string& stmt, size_t index, QueryTask& task);
+
+    /// Streams one statement into partial[index], publishing progress and stopping between batches once the task is cancelled
+    void executeTracked(IDatabaseDriver& driver, const std::string& sql, size_t index, QueryTask& task);
+
+    /// Move the partial results into finalResult and set the terminal status
+    static void publishResult(QueryTask& task, QueryStatus status);
+
+    void notify(const QueryTask& task);
+
+    /// Reads a buffered statement: `source` holds its rows from `firstRow` on
+    using StatementReader = std::function<void(const ResultSet& source, size_t firstRow, AsyncQueryRows& page)>;
+
+    /// Status fields of `queryId` plus `read` applied to the buffered result of its statement `statementIndex` (resultMutex held while reading).
+    /// With `rows` (offset, count), a compressed statement only decompresses those rows; without, it is restored first.
+    [[nodiscard]] AsyncQueryRows readStatement(std::string_view queryId, size_t statementIndex, const StatementReader& read,
+                                               std::optional<std::pair<size_t, size_t>> rows = std::nullopt);
+    /// readStatement's part under resultMutex
+    static void readLocked(const QueryTask& task, size_t statementIndex, const StatementReader& read, std::optional<std::pair<size_t, size_t>> rows,
+                           AsyncQueryRows& page);
+
+    /// Pending -> Running transition on a worker; false if the task was cancelled while queued
+    bool startTask(QueryTask& task);
+
+    /// Running -> terminal transition that never overwrites a cancellation
+    static void finishTask(QueryTask& task, QueryStatus status);
+
+    /// Task of a "query_N" id; nullptr when unknown or evicted
+    [[nodiscard]] std::shared_ptr<QueryTask> findTask(std::string_view queryId) const;
+
+    /// A worker is done with `handle`: it leaves the active list and starts aging towards eviction
+    void retire(uint64_t handle);
+
+    /// Tasks a new submission must not displace
+    [[nodiscard]] static bool isLive(const QueryTask& task) noexcept;
+
+    /// finalResult -> retained; returns the heap bytes freed (resultMutex held)
+    static size_t compressResult(QueryTask& task);
+    /// retained -> finalResult; false when the result was resident (resultMutex held)
+    /// @throws std::runtime_error if a spill file cannot be read back
+    static bool restoreResult(QueryTask& task);
+    /// Compress if needed and write the blocks to disk; false when there are no rows to keep or writing
+    /// failed (resultMutex held)
+    bool spillResult(QueryTask& task);
+    /// A restored result starts idling again and may push the process over budget
+    void afterRestore(uint64_t handle);
+    /// Drop the oldest spilled tasks past MAX_SPILLED_BYTES; returns how many (m_mutex held)
+    size_t trimSpilled();
+    /// Governor reclaimer: spills retired results not read lately, oldest first
+    size_t reclaimRetained(size_t wanted);
+
+    using TaskTable = QueryHandleTable<QueryTask>;
+    TaskTable m_tasks;
+
+    mutable std::mutex m_mutex;  // guards m_active, m_expiry, m_idle and m_spilled
+    std::vector<uint64_t> m_active;  // Submitted and not yet retired, in submission order
+    std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>> m_expiry;  // Retired handles, oldest first
+    std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>> m_idle;    // Resident results by when to compress them
+    std::deque<uint64_t> m_spilled;                                                    // Spilled handles, oldest first
+    std::filesystem::path m_spillDirectory;
+    uint64_t m_reclaimerId = 0;
+
+    std::mutex m_listenerMutex;
+    StatusListener m_statusListener;  // guarded by m_listenerMutex
 
-    mutable std::mutex m_mutex;
-    std::unordered_map<std::string, std::shared_ptr<QueryTask>> m_queries;
-    std::chrono::steady_clock::time_point m_lastEvictTime{};  // guarded by m_mutex
-    std::atomic<int> m_queryIdCounter{1};
+    const size_t m_workerCount;
+    const size_t m_perConnectionLimit;
+    AdmissionController& m_admission;
+    std::shared_ptr<AdmissionGate> m_admissionGate;
+    mutable std::mutex m_queueMutex;  // guards everything below
+    std::condition_variable m_queueCondition;
+    std::array<std::deque<Job>, 2> m_queues;  // indexed by QueryPriority
+    std::unordered_map<std::string, size_t> m_runningPerConnection;
+    std::vector<std::thread> m_workers;
+    size_t m_busyWorkers = 0;
+    size_t m_peakQueueDepth = 0;
+    uint64_t m_submitted = 0;
+    uint64_t m_rejected = 0;
+    bool m_stopping = false;
 };
 
 }  // namespace velocitydb
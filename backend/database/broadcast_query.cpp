@@ -0,0 +1,277 @@
+#include "broadcast_query.h"
+
+#include <algorithm>
+#include <exception>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+/// Feeds one server's rows to its broadcast; `onRows` returns false to stop the fetch
+template <typename OnRows>
+class BroadcastSink final : public RowBatchSink {
+public:
+    explicit BroadcastSink(OnRows onRows) : m_onRows(std::move(onRows)) {}
+
+    void onColumns(const std::vector<ColumnInfo>& columns) override {
+        ResultSet header;
+        header.columns = columns;
+        (void)m_onRows(header);
+    }
+    [[nodiscard]] bool onBatch(const ResultSet& batch) override { return m_onRows(batch); }
+
+private:
+    OnRows m_onRows;
+};
+
+}  // namespace
+
+ResultMerger::ResultMerger() {
+    m_result.columns.push_back(ColumnInfo{.name = std::string(SERVER_COLUMN), .type = "nvarchar", .nullable = false});
+    m_result.columnData.emplace_back(ColumnDataType::Text);
+    m_typed.push_back(true);
+}
+
+void ResultMerger::append(std::string_view server, const ResultSet& batch) {
+    const size_t before = m_result.rowCount();
+
+    // The n-th batch column of a name goes to the n-th merged column of that name (column 0 is ours)
+    m_mapping.assign(batch.columns.size(), 0);
+    for (size_t i = 0; i < batch.columns.size(); ++i) {
+        const auto& name = batch.columns[i].name;
+        size_t occurrence = static_cast<size_t>(std::count_if(batch.columns.begin(), batch.columns.begin() + static_cast<std::ptrdiff_t>(i), [&](const ColumnInfo& c) { return c.name == name; }));
+        for (size_t col = 1; col < m_result.columns.size(); ++col) {
+            if (m_result.columns[col].name == name && occurrence-- == 0) {
+                m_mapping[i] = col;
+                break;
+            }
+        }
+        if (m_mapping[i] == 0) {
+            m_mapping[i] = m_result.columns.size();
+            m_result.columns.push_back(batch.columns[i]);
+            auto& column = m_result.columnData.emplace_back(ColumnDataType::Text);
+            for (size_t row = 0; row < before; ++row) {
+                column.appendNull();
+            }
+            m_typed.push_back(false);
+        }
+    }
+
+    const size_t rows = batch.rowCount();
+    if (rows == 0) {
+        return;
+    }
+    for (size_t row = 0; row < rows; ++row) {
+        m_result.columnData.front().appendText(server);
+    }
+    std::vector<bool> filled(m_result.columns.size(), false);
+    filled.front() = true;
+    for (size_t i = 0; i < batch.columnData.size(); ++i) {
+        const auto& source = batch.columnData[i];
+        const size_t target = m_mapping[i];
+        if (!m_typed[target]) {
+            // Only NULLs so far: take the storage type of the first server that has rows in it
+            ColumnData typed(source.type(), source.fractionDigits());
+            for (size_t row = 0; row < before; ++row) {
+                typed.appendNull();
+            }
+            m_result.columnData[target] = std::move(typed);
+            m_typed[target] = true;
+        }
+        m_result.columnData[target].appendAll(source);
+        filled[target] = true;
+    }
+    for (size_t col = 0; col < filled.size(); ++col) {
+        for (size_t row = 0; !filled[col] && row < rows; ++row) {
+            m_result.columnData[col].appendNull();
+        }
+    }
+
+    for (const auto& preview : batch.lobPreviews) {
+        m_result.lobPreviews.push_back(LobPreview{.row = preview.row + before, .column = m_mapping[preview.column], .totalBytes = preview.totalBytes});
+    }
+    m_result.truncated = m_result.truncated || batch.truncated;
+}
+
+ResultSet ResultMerger::take() {
+    auto result = std::move(m_result);
+    *this = ResultMerger();
+    return result;
+}
+
+BroadcastQuery::BroadcastQuery(std::string sql, std::vector<Target> targets, size_t parallelism, std::chrono::milliseconds timeout, size_t maxRows)
+    : m_sql(std::move(sql))
+    , m_targets(std::move(targets))
+    , m_timeout(timeout)
+    , m_maxRows(maxRows)
+    , m_startTime(std::chrono::steady_clock::now())
+    , m_endTime(m_startTime) {
+    if (m_targets.empty()) {
+        m_result = std::make_shared<const ResultSet>(m_merger.take());
+        return;
+    }
+    const size_t workers = std::clamp<size_t>(parallelism, 1, MAX_PARALLELISM);
+    for (size_t i = 0; i < (std::min)(workers, m_targets.size()); ++i) {
+        m_workers.emplace_back([this] { work(); });
+    }
+    m_watchdog = std::thread([this] { watch(); });
+}
+
+BroadcastQuery::~BroadcastQuery() {
+    cancel();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    if (m_watchdog.joinable()) {
+        m_watchdog.join();
+    }
+}
+
+void BroadcastQuery::cancel() {
+    m_cancelRequested.store(true, std::memory_order_release);
+    std::lock_guard lock(m_mutex);
+    m_changed.notify_all();
+}
+
+BroadcastProgress BroadcastQuery::progress(size_t since) const {
+    std::lock_guard lock(m_mutex);
+    BroadcastProgress progress{.total = m_targets.size(), .completed = m_results.size(), .rows = m_result ? m_result->rowCount() : m_merger.rowCount(), .done = m_result != nullptr};
+    const auto endTime = progress.done ? m_endTime : std::chrono::steady_clock::now();
+    progress.elapsedMs = std::chrono::duration<double, std::milli>(endTime - m_startTime).count();
+    if (since < m_results.size()) {
+        progress.results.assign(m_results.begin() + static_cast<std::ptrdiff_t>(since), m_results.end());
+    }
+    progress.result = m_result;
+    return progress;
+}
+
+bool BroadcastQuery::done() const {
+    std::lock_guard lock(m_mutex);
+    return m_result != nullptr;
+}
+
+std::chrono::steady_clock::time_point BroadcastQuery::endTime() const {
+    std::lock_guard lock(m_mutex);
+    return m_endTime;
+}
+
+void BroadcastQuery::wait() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_result != nullptr; });
+}
+
+void BroadcastQuery::work() {
+    for (size_t index = m_next.fetch_add(1, std::memory_order_relaxed); index < m_targets.size(); index = m_next.fetch_add(1, std::memory_order_relaxed)) {
+        runTarget(index);
+    }
+}
+
+void BroadcastQuery::runTarget(size_t index) {
+    const auto& target = m_targets[index];
+    BroadcastServerResult outcome{.index = index, .server = target.server};
+    const auto started = std::chrono::steady_clock::now();
+    auto finish = [&] {
+        outcome.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        std::lock_guard lock(m_mutex);
+        complete(std::move(outcome));
+    };
+
+    if (m_cancelRequested.load(std::memory_order_acquire)) {
+        outcome.message = "Cancelled";
+        finish();
+        return;
+    }
+    std::expected<BroadcastSession, std::string> session;
+    try {
+        session = target.open();
+    } catch (const std::exception& e) {
+        session = std::unexpected(e.what());
+    }
+    if (!session || !session->driver) [[unlikely]] {
+        outcome.message = session ? "No driver for this server" : session.error();
+        finish();
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_running[index] = Running{.driver = session->driver, .deadline = started + m_timeout};
+    }
+    BroadcastSink sink([&](const ResultSet& batch) {
+        std::lock_guard lock(m_mutex);
+        if (m_merger.rowCount() >= m_maxRows && batch.rowCount() > 0) {
+            outcome.truncated = true;
+            return false;
+        }
+        m_merger.append(target.server, batch);
+        outcome.rows += batch.rowCount();
+        return true;
+    });
+    try {
+        auto summary = session->driver->executeStreaming(m_sql, sink);
+        outcome.success = true;
+        outcome.truncated = outcome.truncated || summary.truncated;
+    } catch (const std::exception& e) {
+        outcome.message = e.what();
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto it = m_running.find(index); it != m_running.end()) {
+            if (it->second.timedOut) {
+                outcome.success = false;
+                outcome.timedOut = true;
+                outcome.message = std::format("Timed out after {} ms", m_timeout.count());
+            } else if (it->second.cancelled && !outcome.success) {
+                outcome.message = "Cancelled";
+            }
+            m_running.erase(it);
+        }
+    }
+    if (session->release) {
+        session->release();
+    }
+    finish();
+}
+
+void BroadcastQuery::watch() {
+    std::unique_lock lock(m_mutex);
+    while (!m_result) {
+        m_changed.wait_for(lock, WATCHDOG_TICK);
+        const auto now = std::chrono::steady_clock::now();
+        const bool cancelling = m_cancelRequested.load(std::memory_order_acquire);
+        std::vector<std::shared_ptr<IDatabaseDriver>> overdue;
+        for (auto& [index, running] : m_running) {
+            if (running.timedOut || running.cancelled) {
+                continue;
+            }
+            if (now >= running.deadline) {
+                running.timedOut = true;
+                overdue.push_back(running.driver);
+            } else if (cancelling) {
+                running.cancelled = true;
+                overdue.push_back(running.driver);
+            }
+        }
+        if (overdue.empty()) {
+            continue;
+        }
+        // SQLCancel can wait on the network; the workers need the lock meanwhile
+        lock.unlock();
+        for (const auto& driver : overdue) {
+            driver->cancel();
+        }
+        lock.lock();
+    }
+}
+
+void BroadcastQuery::complete(BroadcastServerResult outcome) {
+    m_results.push_back(std::move(outcome));
+    if (m_results.size() == m_targets.size()) {
+        m_result = std::make_shared<const ResultSet>(m_merger.take());
+        m_endTime = std::chrono::steady_clock::now();
+        m_changed.notify_all();
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Results of one query from many servers folded into one, led by a `server` column.
+///
+/// Columns are matched by name (the n-th column of a name to the n-th merged column of that name). The first result
+/// fixes the order; columns only later servers return are added at the end, NULL for the rows before them, and a
+/// server without a column gets NULL in it. A column fetched as different types on different servers becomes text.
+class ResultMerger {
+public:
+    static constexpr std::string_view SERVER_COLUMN = "server";
+
+    ResultMerger();
+
+    /// Append the rows of `batch` as rows of `server`; a batch without rows only registers its columns
+    void append(std::string_view server, const ResultSet& batch);
+
+    [[nodiscard]] size_t rowCount() const noexcept { return m_result.rowCount(); }
+    [[nodiscard]] const ResultSet& result() const noexcept { return m_result; }
+    /// The merged result, leaving the merger empty
+    [[nodiscard]] ResultSet take();
+
+private:
+    ResultSet m_result;
+    std::vector<bool> m_typed;     ///< Per column: storage type taken from a row that had it (else NULLs only so far)
+    std::vector<size_t> m_mapping;  ///< Scratch: batch column -> merged column
+};
+
+/// A driver checked out for one server of a broadcast; `release` hands it back (or logs it out)
+struct BroadcastSession {
+    std::shared_ptr<IDatabaseDriver> driver;
+    std::function<void()> release;
+};
+
+/// Outcome of one server of a broadcast
+struct BroadcastServerResult {
+    size_t index = 0;  ///< Position in the target list
+    std::string server;
+    bool success = false;
+    bool timedOut = false;
+    bool truncated = false;  ///< Stopped at the broadcast's row limit
+    size_t rows = 0;
+    double elapsedMs = 0.0;
+    std::string message;  ///< Why it failed
+};
+
+struct BroadcastProgress {
+    size_t total = 0;
+    size_t completed = 0;
+    size_t rows = 0;  ///< Merged so far
+    bool done = false;
+    double elapsedMs = 0.0;
+    std::vector<BroadcastServerResult> results;  ///< Completed since the caller's last poll
+    std::shared_ptr<const ResultSet> result;      ///< The merged result, once done
+};
+
+/// The same statement run on many servers by a bounded pool of workers, merged into one result as rows arrive.
+///
+/// Each worker takes the next target until none are left: it opens the target's session, streams the statement's
+/// rows into a ResultMerger and records the server's outcome, so a failure or a timeout is reported for that server
+/// alone. Rows a server sent before it failed stay in the result. A watchdog cancels statements still running
+/// `timeout` after their server was started (a login in progress is left to the driver's own login timeout).
+class BroadcastQuery {
+public:
+    using Opener = std::function<std::expected<BroadcastSession, std::string>()>;
+
+    struct Target {
+        std::string server;  ///< Value of the server column
+        Opener open;
+    };
+
+    static constexpr size_t DEFAULT_PARALLELISM = 8;
+    static constexpr size_t MAX_PARALLELISM = 64;
+    static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT{std::chrono::seconds(60)};
+    /// Rows merged over all servers; servers still streaming past it stop and report `truncated`
+    static constexpr size_t DEFAULT_MAX_ROWS = 1'000'000;
+
+    /// Starts the workers right away
+    BroadcastQuery(std::string sql, std::vector<Target> targets, size_t parallelism = DEFAULT_PARALLELISM, std::chrono::milliseconds timeout = DEFAULT_TIMEOUT,
+                   size_t maxRows = DEFAULT_MAX_ROWS);
+    /// Cancels and waits for the workers
+    ~BroadcastQuery();
+
+    BroadcastQuery(const BroadcastQuery&) = delete;
+    BroadcastQuery& operator=(const BroadcastQuery&) = delete;
+    BroadcastQuery(BroadcastQuery&&) = delete;
+    BroadcastQuery& operator=(BroadcastQuery&&) = delete;
+
+    /// Cancel running statements; servers not started yet are reported as cancelled without being tried
+    void cancel();
+
+    /// Outcomes from the `since`-th completed one on, in completion order
+    [[nodiscard]] BroadcastProgress progress(size_t since = 0) const;
+    [[nodiscard]] bool done() const;
+    /// When done() last became true (construction time while still running)
+    [[nodiscard]] std::chrono::steady_clock::time_point endTime() const;
+
+    /// Block until every server has completed
+    void wait();
+
+private:
+    struct Running {
+        std::shared_ptr<IDatabaseDriver> driver;
+        std::chrono::steady_clock::time_point deadline;
+        bool timedOut = false;
+        bool cancelled = false;  ///< cancel() already reached it
+    };
+
+    void work();
+    void runTarget(size_t index);
+    void watch();
+    /// Record `outcome`; the last one publishes the merged result (m_mutex held)
+    void complete(BroadcastServerResult outcome);
+
+    static constexpr auto WATCHDOG_TICK = std::chrono::milliseconds{100};
+
+    const std::string m_sql;
+    const std::vector<Target> m_targets;
+    const std::chrono::milliseconds m_timeout;
+    const size_t m_maxRows;
+    const std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<size_t> m_next{0};
+    std::atomic<bool> m_cancelRequested{false};
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_changed;
+    ResultMerger m_merger;
+    std::unordered_map<size_t, Running> m_running;  ///< By target index
+    std::vector<BroadcastServerResult> m_results;  ///< In completion order
+    std::shared_ptr<const ResultSet> m_result;
+    std::chrono::steady_clock::time_point m_endTime;
+
+    std::vector<std::thread> m_workers;
+    std::thread m_watchdog;
+};
+
+}  // namespace velocitydb
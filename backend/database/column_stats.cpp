@@ -0,0 +1,168 @@
+#include "column_stats.h"
+
+#include "result_set.h"
+
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <string_view>
+#include <tuple>
+
+namespace velocitydb {
+
+namespace {
+
+/// splitmix64 finalizer: spreads std::hash (identity for integers, FNV-1a for strings on MSVC) over all 64 bits
+[[nodiscard]] uint64_t mix(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+[[nodiscard]] auto dateTimeKey(const DateTimeValue& v) noexcept {
+    return std::tie(v.year, v.month, v.day, v.hour, v.minute, v.second, v.fraction);
+}
+
+[[nodiscard]] uint64_t dateTimeHash(const DateTimeValue& v) noexcept {
+    const auto seconds = ((((static_cast<uint64_t>(static_cast<uint16_t>(v.year)) * 13 + v.month) * 32 + v.day) * 24 + v.hour) * 60 + v.minute) * 60 + v.second;
+    return mix(seconds * 1'000'000'000ULL + v.fraction);
+}
+
+}  // namespace
+
+void DistinctSketch::add(uint64_t hash) {
+    if (m_registers.empty()) {
+        m_registers.resize(REGISTERS);
+    }
+    // Top PRECISION bits pick the register; it keeps the longest run of leading zeros seen in the rest
+    const size_t index = static_cast<size_t>(hash >> (64 - PRECISION));
+    const uint64_t rest = (hash << PRECISION) | (uint64_t{1} << (PRECISION - 1));
+    const auto rank = static_cast<uint8_t>(std::countl_zero(rest) + 1);
+    m_registers[index] = (std::max)(m_registers[index], rank);
+}
+
+uint64_t DistinctSketch::estimate() const noexcept {
+    if (m_registers.empty()) {
+        return 0;
+    }
+    constexpr double m = static_cast<double>(REGISTERS);
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t rank : m_registers) {
+        sum += std::ldexp(1.0, -rank);
+        zeros += rank == 0 ? 1 : 0;
+    }
+    double estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+    // Small cardinalities: linear counting over the empty registers is far more accurate
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+void ColumnStats::reset() noexcept {
+    m_rows = 0;
+    m_nullCount = 0;
+    m_zones.clear();
+    m_minRow.reset();
+    m_maxRow.reset();
+    m_distinct.clear();
+}
+
+void ColumnStats::update(const ColumnData& column) {
+    const size_t end = column.size();
+    if (end < m_rows) [[unlikely]] {
+        reset();
+    }
+
+    // `fold(row, zone)` sees each non-null row and returns false for a value without an order (NaN); `less`
+    // orders the column's values
+    auto foldRows = [&](auto&& fold, auto&& less) {
+        for (size_t begin = m_rows; begin < end;) {
+            if (begin % ZONE_ROWS == 0) {
+                m_zones.emplace_back();
+            }
+            auto& zone = m_zones.back();
+            const size_t stop = (std::min)(end, (begin / ZONE_ROWS + 1) * ZONE_ROWS);
+            uint32_t nulls = 0;
+            for (size_t row = begin; row < stop; ++row) {
+                if (column.isNull(row)) {
+                    ++nulls;
+                    continue;
+                }
+                if (!fold(row, zone)) {
+                    continue;
+                }
+                if (!m_minRow || less(row, *m_minRow)) {
+                    m_minRow = row;
+                }
+                if (!m_maxRow || less(*m_maxRow, row)) {
+                    m_maxRow = row;
+                }
+            }
+            zone.rows += static_cast<uint32_t>(stop - begin);
+            zone.nullCount += nulls;
+            m_nullCount += nulls;
+            begin = stop;
+        }
+    };
+
+    switch (column.type()) {
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit: {
+            const auto values = column.int64Values();
+            foldRows(
+                [&](size_t row, ZoneStats& zone) {
+                    const int64_t value = values[row];
+                    zone.minInt = (std::min)(zone.minInt, value);
+                    zone.maxInt = (std::max)(zone.maxInt, value);
+                    m_distinct.add(mix(static_cast<uint64_t>(value)));
+                    return true;
+                },
+                [&](size_t a, size_t b) { return values[a] < values[b]; });
+            break;
+        }
+        case ColumnDataType::Double: {
+            const auto values = column.doubleValues();
+            foldRows(
+                [&](size_t row, ZoneStats& zone) {
+                    const double value = values[row];
+                    m_distinct.add(mix(std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value)));
+                    if (std::isnan(value)) {
+                        return false;
+                    }
+                    zone.minDouble = (std::min)(zone.minDouble, value);
+                    zone.maxDouble = (std::max)(zone.maxDouble, value);
+                    return true;
+                },
+                [&](size_t a, size_t b) { return values[a] < values[b]; });
+            break;
+        }
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp: {
+            const auto values = column.dateTimeValues();
+            foldRows(
+                [&](size_t row, ZoneStats&) {
+                    m_distinct.add(dateTimeHash(values[row]));
+                    return true;
+                },
+                [&](size_t a, size_t b) { return dateTimeKey(values[a]) < dateTimeKey(values[b]); });
+            break;
+        }
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary:  // Raw bytes order as their hex text does
+            foldRows(
+                [&](size_t row, ZoneStats&) {
+                    m_distinct.add(mix(std::hash<std::string_view>{}(column.textAt(row))));
+                    return true;
+                },
+                [&](size_t a, size_t b) { return column.textAt(a) < column.textAt(b); });
+            break;
+    }
+    m_rows = end;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace velocitydb {
+
+class ColumnData;
+
+/// HyperLogLog distinct-count sketch: 2^PRECISION one-byte registers (~2.3% standard error), allocated on the
+/// first add so empty and never-profiled columns carry none
+class DistinctSketch {
+public:
+    static constexpr unsigned PRECISION = 11;
+    static constexpr size_t REGISTERS = size_t{1} << PRECISION;
+
+    /// Record one value by its 64-bit hash (already well mixed)
+    void add(uint64_t hash);
+    [[nodiscard]] uint64_t estimate() const noexcept;
+    void clear() noexcept { std::ranges::fill(m_registers, uint8_t{0}); }
+    [[nodiscard]] size_t memoryBytes() const noexcept { return m_registers.capacity(); }
+
+private:
+    std::vector<uint8_t> m_registers;
+};
+
+/// Summary of one ZONE_ROWS block of a column. The bounds are only kept for Int64/Bit (minInt/maxInt) and
+/// Double (minDouble/maxDouble, NaN ignored) columns; a zone without a non-null value has min > max.
+struct ZoneStats {
+    uint32_t rows = 0;
+    uint32_t nullCount = 0;
+    int64_t minInt = (std::numeric_limits<int64_t>::max)();
+    int64_t maxInt = (std::numeric_limits<int64_t>::min)();
+    double minDouble = std::numeric_limits<double>::infinity();
+    double maxDouble = -std::numeric_limits<double>::infinity();
+
+    /// Whether a value in [lo, hi] may be in the zone; false means no row of it can match
+    [[nodiscard]] bool mayContain(int64_t lo, int64_t hi) const noexcept { return minInt <= hi && maxInt >= lo; }
+    [[nodiscard]] bool mayContain(double lo, double hi) const noexcept { return minDouble <= hi && maxDouble >= lo; }
+    /// Whether every row of the zone is non-null and in [lo, hi]
+    [[nodiscard]] bool allWithin(int64_t lo, int64_t hi) const noexcept { return nullCount == 0 && minInt >= lo && maxInt <= hi; }
+    [[nodiscard]] bool allWithin(double lo, double hi) const noexcept { return nullCount == 0 && minDouble >= lo && maxDouble <= hi; }
+};
+
+/// Column statistics folded in as rows are fetched: per-zone min/max and null counts (zone maps that let range and
+/// equality filters skip whole blocks), plus the column's null count, smallest and largest value and a distinct
+/// estimate for the grid's header tooltips.
+///
+/// Folding is incremental: update() reads only the rows appended since the last call, so fetch paths call it once
+/// per batch while the batch is still in cache. Rows that were never folded are simply not covered yet.
+class ColumnStats {
+public:
+    /// Rows per zone; a multiple of 64 so a zone covers whole words of a filter's row mask
+    static constexpr size_t ZONE_ROWS = 4096;
+
+    /// Fold rows [rows(), column.size()) of `column` in. The column must only have grown since the last call
+    /// (ColumnData resets its stats whenever it rewrites rows).
+    void update(const ColumnData& column);
+    void reset() noexcept;
+
+    /// Rows folded so far
+    [[nodiscard]] size_t rows() const noexcept { return m_rows; }
+    [[nodiscard]] size_t nullCount() const noexcept { return m_nullCount; }
+    [[nodiscard]] uint64_t distinctEstimate() const noexcept { return m_distinct.estimate(); }
+    /// One entry per ZONE_ROWS rows folded; the last may be partial
+    [[nodiscard]] std::span<const ZoneStats> zones() const noexcept { return m_zones; }
+    /// Row holding the smallest / largest non-null value folded (text by bytes, date/time chronologically,
+    /// numbers by value, NaN skipped); nullopt while every folded row is NULL
+    [[nodiscard]] std::optional<size_t> minRow() const noexcept { return m_minRow; }
+    [[nodiscard]] std::optional<size_t> maxRow() const noexcept { return m_maxRow; }
+
+    [[nodiscard]] size_t memoryBytes() const noexcept { return m_zones.capacity() * sizeof(ZoneStats) + m_distinct.memoryBytes(); }
+
+private:
+    size_t m_rows = 0;
+    size_t m_nullCount = 0;
+    std::vector<ZoneStats> m_zones;
+    std::optional<size_t> m_minRow;
+    std::optional<size_t> m_maxRow;
+    DistinctSketch m_distinct;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,214 @@
+#include "compressed_result.h"
+
+#include "../utils/binary_result.h"
+#include "../utils/buffered_file_writer.h"
+#include "../utils/lz4_codec.h"
+#include "../utils/mapped_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace velocitydb {
+
+namespace {
+
+std::string pathToUtf8(const std::filesystem::path& path) {
+    auto utf8 = path.u8string();
+    return std::string(utf8.begin(), utf8.end());
+}
+
+}  // namespace
+
+CompressedResult::~CompressedResult() {
+    removeSpill();
+}
+
+CompressedResult::CompressedResult(CompressedResult&& other) noexcept
+    : m_shell(std::move(other.m_shell))
+    , m_blocks(std::move(other.m_blocks))
+    , m_rowCount(std::exchange(other.m_rowCount, 0))
+    , m_storedBytes(std::exchange(other.m_storedBytes, 0))
+    , m_spillPath(std::move(other.m_spillPath)) {
+    other.m_spillPath.clear();
+}
+
+CompressedResult& CompressedResult::operator=(CompressedResult&& other) noexcept {
+    if (this != &other) {
+        removeSpill();
+        m_shell = std::move(other.m_shell);
+        m_blocks = std::move(other.m_blocks);
+        m_rowCount = std::exchange(other.m_rowCount, 0);
+        m_storedBytes = std::exchange(other.m_storedBytes, 0);
+        m_spillPath = std::move(other.m_spillPath);
+        other.m_spillPath.clear();
+    }
+    return *this;
+}
+
+CompressedResult CompressedResult::compress(const ResultSet& result) {
+    CompressedResult out;
+    out.m_shell.columns = result.columns;
+    out.m_shell.affectedRows = result.affectedRows;
+    out.m_shell.executionTimeMs = result.executionTimeMs;
+    out.m_shell.fetchStats = result.fetchStats;
+    out.m_shell.truncated = result.truncated;
+    out.m_shell.lobPreviews = result.lobPreviews;
+    out.m_shell.messages = result.messages;
+    for (const auto& column : result.columnData) {
+        out.m_shell.columnData.emplace_back(column.type(), column.fractionDigits());
+    }
+    out.m_rowCount = result.rowCount();
+
+    std::string raw;
+    std::string scratch;
+    for (size_t first = 0; first < out.m_rowCount; first += WINDOW_ROWS) {
+        Block block;
+        block.rows = (std::min)(WINDOW_ROWS, out.m_rowCount - first);
+        raw.clear();
+        for (const auto& column : result.columnData) {
+            if (block.rows == column.size()) {
+                BinaryResultEncoder::encodeColumn(column, block.rows, raw);
+            } else {
+                ColumnData slice(column.type(), column.fractionDigits());
+                slice.reserve(block.rows);
+                for (size_t row = first; row < first + block.rows; ++row) {
+                    slice.appendFrom(column, row);
+                }
+                BinaryResultEncoder::encodeColumn(slice, block.rows, raw);
+            }
+            block.columnEnds.push_back(raw.size());
+        }
+
+        block.rawBytes = raw.size();
+        size_t compressed = 0;
+        if (raw.size() <= Lz4Codec::MAX_INPUT_BYTES) {
+            scratch.resize(Lz4Codec::compressBound(raw.size()));
+            compressed = Lz4Codec::compress(raw, scratch.data(), scratch.size());
+        }
+        // Incompressible windows stay raw, so reading them back is a copy
+        if (compressed == 0 || compressed >= raw.size()) {
+            block.stored = raw;
+        } else {
+            block.stored.assign(scratch.data(), compressed);
+        }
+        block.storedBytes = block.stored.size();
+        out.m_storedBytes += block.storedBytes;
+        out.m_blocks.push_back(std::move(block));
+    }
+    return out;
+}
+
+std::string CompressedResult::inflate(const Block& block, std::string_view file) {
+    std::string_view stored = block.stored;
+    if (stored.size() != block.storedBytes) {
+        if (block.fileOffset > file.size() || block.storedBytes > file.size() - block.fileOffset) [[unlikely]] {
+            throw std::runtime_error("Compressed result spill file is truncated");
+        }
+        stored = file.substr(block.fileOffset, block.storedBytes);
+    }
+    std::string raw(block.rawBytes, '\0');
+    if (block.storedBytes == block.rawBytes) {
+        std::memcpy(raw.data(), stored.data(), raw.size());
+    } else if (!Lz4Codec::decompress(stored, raw.data(), raw.size())) [[unlikely]] {
+        throw std::runtime_error("Compressed result block is corrupt");
+    }
+    return raw;
+}
+
+ResultSet CompressedResult::window(size_t offset, size_t limit) const {
+    ResultSet out;
+    out.columns = m_shell.columns;
+    out.columnData = m_shell.columnData;
+    out.affectedRows = m_shell.affectedRows;
+    out.executionTimeMs = m_shell.executionTimeMs;
+    out.fetchStats = m_shell.fetchStats;
+    out.truncated = m_shell.truncated;
+    out.messages = m_shell.messages;
+    if (offset >= m_rowCount || limit == 0) {
+        return out;
+    }
+    const size_t end = offset + (std::min)(limit, m_rowCount - offset);
+
+    MappedFile file;
+    if (spilled() && !file.open(pathToUtf8(m_spillPath))) [[unlikely]] {
+        throw std::runtime_error(std::format("Cannot map spill file {}", pathToUtf8(m_spillPath)));
+    }
+    for (size_t index = offset / WINDOW_ROWS; index * WINDOW_ROWS < end; ++index) {
+        const auto& block = m_blocks[index];
+        const size_t blockStart = index * WINDOW_ROWS;
+        const size_t from = (std::max)(offset, blockStart) - blockStart;
+        const size_t to = (std::min)(end, blockStart + block.rows) - blockStart;
+        const std::string raw = inflate(block, file.view());
+        size_t columnStart = 0;
+        for (size_t col = 0; col < out.columnData.size(); ++col) {
+            auto& target = out.columnData[col];
+            const auto decoded = BinaryResultDecoder::decodeColumn(std::string_view(raw).substr(columnStart, block.columnEnds[col] - columnStart), target.type(),
+                                                                   target.fractionDigits(), block.rows);
+            columnStart = block.columnEnds[col];
+            if (from == 0 && to == block.rows) {
+                target.appendAll(decoded);
+            } else {
+                for (size_t row = from; row < to; ++row) {
+                    target.appendFrom(decoded, row);
+                }
+            }
+        }
+    }
+    out.updateStats();
+    for (const auto& preview : m_shell.lobPreviews) {
+        if (preview.row >= offset && preview.row < end) {
+            out.lobPreviews.push_back({.row = preview.row - offset, .column = preview.column, .totalBytes = preview.totalBytes});
+        }
+    }
+    return out;
+}
+
+bool CompressedResult::spill(const std::filesystem::path& path) {
+    if (spilled()) {
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    BufferedFileWriter writer;
+    if (!writer.open(pathToUtf8(path))) [[unlikely]] {
+        return false;
+    }
+    std::vector<size_t> offsets;
+    offsets.reserve(m_blocks.size());
+    for (const auto& block : m_blocks) {
+        offsets.push_back(writer.bytesWritten());
+        writer.append(block.stored);
+    }
+    if (!writer.close()) [[unlikely]] {
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+        m_blocks[i].fileOffset = offsets[i];
+        std::string().swap(m_blocks[i].stored);
+    }
+    m_spillPath = path;
+    return true;
+}
+
+size_t CompressedResult::memoryBytes() const noexcept {
+    size_t bytes = m_shell.memoryBytes() + m_blocks.capacity() * sizeof(Block);
+    for (const auto& block : m_blocks) {
+        bytes += block.columnEnds.capacity() * sizeof(size_t) + block.stored.capacity();
+    }
+    return bytes;
+}
+
+void CompressedResult::removeSpill() noexcept {
+    if (!m_spillPath.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(m_spillPath, ec);
+        m_spillPath.clear();
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "result_set.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+/// A finished ResultSet kept as LZ4-compressed columnar blocks, for results that are retained but not being read.
+///
+/// Rows are cut into windows of WINDOW_ROWS; each window stores every column's BinaryResultEncoder data[]
+/// section back to back as one LZ4 block (kept raw when it does not shrink). Reading rows decompresses only the
+/// windows they fall in. spill() moves the blocks to a file and leaves only the block table on the heap; the
+/// file is removed with the object.
+class CompressedResult {
+public:
+    static constexpr size_t WINDOW_ROWS = 16384;
+
+    CompressedResult() = default;
+    ~CompressedResult();
+
+    CompressedResult(const CompressedResult&) = delete;
+    CompressedResult& operator=(const CompressedResult&) = delete;
+    CompressedResult(CompressedResult&& other) noexcept;
+    CompressedResult& operator=(CompressedResult&& other) noexcept;
+
+    /// @throws std::length_error if a window's text column exceeds the 4 GB offset range
+    [[nodiscard]] static CompressedResult compress(const ResultSet& result);
+
+    [[nodiscard]] size_t rowCount() const noexcept { return m_rowCount; }
+    [[nodiscard]] const std::vector<ColumnInfo>& columns() const noexcept { return m_shell.columns; }
+
+    /// Columns, statement details and rows [offset, offset + limit) (LOB previews shifted to match)
+    /// @throws std::runtime_error if a block is corrupt or the spill file cannot be read
+    [[nodiscard]] ResultSet window(size_t offset, size_t limit) const;
+    /// Every row: the result as it was compressed
+    [[nodiscard]] ResultSet decompress() const { return window(0, m_rowCount); }
+
+    /// Write the blocks to `path` and drop them from the heap; false (nothing changed) if the file cannot be written
+    bool spill(const std::filesystem::path& path);
+    [[nodiscard]] bool spilled() const noexcept { return !m_spillPath.empty(); }
+
+    /// Heap bytes: block table, statement details and the blocks unless spilled
+    [[nodiscard]] size_t memoryBytes() const noexcept;
+    /// Bytes of the blocks as stored (in memory or in the spill file)
+    [[nodiscard]] size_t storedBytes() const noexcept { return m_storedBytes; }
+
+private:
+    struct Block {
+        size_t rows = 0;
+        size_t rawBytes = 0;
+        std::vector<size_t> columnEnds;  ///< End of each column's section within the raw block
+        std::string stored;              ///< LZ4 block, or the raw bytes when rawBytes == storedBytes; empty once spilled
+        size_t storedBytes = 0;
+        size_t fileOffset = 0;  ///< Where `stored` starts in the spill file
+    };
+
+    /// Raw bytes of `block`, from memory or from the mapped spill file `file` (empty while not spilled)
+    [[nodiscard]] static std::string inflate(const Block& block, std::string_view file);
+
+    void removeSpill() noexcept;
+
+    ResultSet m_shell;  ///< Columns, statement details and LOB previews; no rows
+    std::vector<Block> m_blocks;
+    size_t m_rowCount = 0;
+    size_t m_storedBytes = 0;
+    std::filesystem::path m_spillPath;
+};
+
+}  // namespace velocitydb
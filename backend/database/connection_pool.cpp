@@ -5,7 +5,7 @@
 
 #include <algorithm>
 #include <format>
-#include <ranges>
+#include <exception>
 
 namespace velocitydb {
 
@@ -27,55 +27,224 @@ std::string escapeOdbcValue(std::string_view value) {
 }
 }  // namespace
 
+ConnectionPool::ConnectionPool(size_t poolSize, size_t minIdle, std::chrono::seconds idleTimeout)
+    : m_poolSize((std::max)(poolSize, size_t{1})), m_minIdle((std::min)(minIdle, m_poolSize)), m_idleTimeout(idleTimeout) {}
+
 ConnectionPool::~ConnectionPool() {
     std::lock_guard lock(m_mutex);
-    while (!m_available.empty()) {
-        m_available.pop();
+    for (auto& [id, pool] : m_pools) {
+        pool->removed = true;
+        pool->idle.clear();
     }
+    m_pools.clear();
 }
 
 bool ConnectionPool::addConnection(const ConnectionInfo& info) {
-    std::lock_guard lock(m_mutex);
-
-    auto driver = std::make_shared<SQLServerDriver>();
-    auto connStr = buildConnectionString(info);
+    auto pool = std::make_shared<Pool>();
+    pool->info = info;
+    pool->connectionString = buildConnectionString(info);
 
-    if (!driver->connect(connStr)) [[unlikely]] {
-        return false;
+    // Logins happen outside the lock; the test login becomes the first idle driver
+    const size_t warmCount = (std::max)(m_minIdle, size_t{1});
+    for (size_t i = 0; i < warmCount; ++i) {
+        auto driver = std::make_shared<SQLServerDriver>();
+        if (!driver->connect(pool->connectionString)) [[unlikely]] {
+            if (i == 0) {
+                return false;
+            }
+            break;
+        }
+        pool->idle.push_back({.driver = std::move(driver), .idleSince = Clock::now()});
     }
+    pool->open = pool->idle.size();
 
-    driver->disconnect();
-    m_connections.push_back(info);
+    std::shared_ptr<Pool> replaced;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stats.created += pool->open;
+        if (auto it = m_pools.find(info.id); it != m_pools.end()) {
+            replaced = std::move(it->second);
+            replaced->removed = true;
+            it->second = std::move(pool);
+        } else {
+            m_pools.emplace(info.id, std::move(pool));
+        }
+        std::erase_if(m_connections, [&info](const ConnectionInfo& existing) { return existing.id == info.id; });
+        m_connections.push_back(info);
+    }
+    m_condition.notify_all();
     return true;
 }
 
 void ConnectionPool::removeConnection(std::string_view id) {
-    std::lock_guard lock(m_mutex);
-    std::erase_if(m_connections, [id](const ConnectionInfo& info) { return info.id == id; });
+    std::shared_ptr<Pool> removed;
+    {
+        std::lock_guard lock(m_mutex);
+        std::erase_if(m_connections, [id](const ConnectionInfo& info) { return info.id == id; });
+        if (auto it = m_pools.find(id); it != m_pools.end()) {
+            removed = std::move(it->second);
+            removed->removed = true;
+            removed->open -= removed->idle.size();
+            m_pools.erase(it);
+        }
+    }
+    // Waiters for this id give up instead of sleeping until their timeout
+    m_condition.notify_all();
+    // Idle drivers disconnect as `removed` goes out of scope, outside the lock
 }
 
-std::shared_ptr<SQLServerDriver> ConnectionPool::acquire(std::string_view connectionId) {
+std::shared_ptr<SQLServerDriver> ConnectionPool::acquire(std::string_view connectionId, std::chrono::milliseconds timeout) {
+    const auto deadline = Clock::now() + timeout;
+    std::vector<std::shared_ptr<SQLServerDriver>> closed;  // disconnected after the lock is released
     std::unique_lock lock(m_mutex);
+    bool waited = false;
 
-    auto it = std::ranges::find_if(m_connections, [connectionId](const ConnectionInfo& info) { return info.id == connectionId; });
+    while (true) {
+        auto it = m_pools.find(connectionId);
+        if (it == m_pools.end()) [[unlikely]] {
+            return nullptr;
+        }
+        auto pool = it->second;
+        collectExpired(*pool, Clock::now(), closed);
 
-    if (it == m_connections.end()) [[unlikely]] {
-        return nullptr;
-    }
+        // Most recently returned first: it is the warmest, and the oldest ones are left to age out
+        while (!pool->idle.empty()) {
+            auto candidate = std::move(pool->idle.back().driver);
+            pool->idle.pop_back();
+            if (candidate->isAlive()) [[likely]] {
+                m_checkedOut.emplace(candidate.get(), pool);
+                ++m_stats.checkouts;
+                ++m_stats.reused;
+                return candidate;
+            }
+            --pool->open;
+            ++m_stats.validationFailures;
+            closed.push_back(std::move(candidate));
+        }
 
-    auto driver = std::make_shared<SQLServerDriver>();
-    std::string connStr = buildConnectionString(*it);
+        if (pool->open < m_poolSize) {
+            // Reserve the slot, then log in without holding the lock
+            ++pool->open;
+            lock.unlock();
+            closed.clear();
+            auto driver = std::make_shared<SQLServerDriver>();
+            bool connected = driver->connect(pool->connectionString);
+            lock.lock();
+            if (!connected || pool->removed) [[unlikely]] {
+                --pool->open;
+                lock.unlock();
+                m_condition.notify_all();
+                return nullptr;
+            }
+            m_checkedOut.emplace(driver.get(), pool);
+            ++m_stats.checkouts;
+            ++m_stats.created;
+            return driver;
+        }
 
-    if (!driver->connect(connStr)) [[unlikely]] {
-        return nullptr;
+        if (!waited) {
+            waited = true;
+            ++m_stats.waits;
+        }
+        if (m_condition.wait_until(lock, deadline) == std::cv_status::timeout) {
+            // One last look in case a driver came back right at the deadline
+            if (auto again = m_pools.find(connectionId); again == m_pools.end() || (again->second->idle.empty() && again->second->open >= m_poolSize)) {
+                ++m_stats.waitTimeouts;
+                return nullptr;
+            }
+        }
     }
-
-    return driver;
 }
 
 void ConnectionPool::release(std::shared_ptr<SQLServerDriver> connection) {
-    if (connection) {
+    if (!connection) {
+        return;
+    }
+
+    std::shared_ptr<Pool> pool;
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto it = m_checkedOut.find(connection.get()); it != m_checkedOut.end()) {
+            pool = std::move(it->second);
+            m_checkedOut.erase(it);
+        }
+    }
+    if (!pool) {
+        // Not from this pool: keep the old behaviour of simply closing it
         connection->disconnect();
+        return;
+    }
+
+    // The reset runs on the caller's thread, before the driver is visible to other borrowers
+    bool reusable = connection->isAlive() && resetSession(*connection, pool->info);
+
+    std::vector<std::shared_ptr<SQLServerDriver>> closed;
+    {
+        std::lock_guard lock(m_mutex);
+        if (reusable && !pool->removed) {
+            pool->idle.push_back({.driver = std::move(connection), .idleSince = Clock::now()});
+        } else {
+            --pool->open;
+            if (!pool->removed) {
+                ++m_stats.validationFailures;
+            }
+            closed.push_back(std::move(connection));
+        }
+        collectExpired(*pool, Clock::now(), closed);
+    }
+    // Waiters may be blocked on other connection ids, so wake them all
+    m_condition.notify_all();
+}
+
+size_t ConnectionPool::evictIdle() {
+    std::vector<std::shared_ptr<SQLServerDriver>> closed;
+    {
+        std::lock_guard lock(m_mutex);
+        const auto now = Clock::now();
+        for (auto& [id, pool] : m_pools) {
+            collectExpired(*pool, now, closed);
+        }
+    }
+    if (!closed.empty()) {
+        m_condition.notify_all();
+    }
+    return closed.size();
+}
+
+void ConnectionPool::collectExpired(Pool& pool, Clock::time_point now, std::vector<std::shared_ptr<SQLServerDriver>>& closed) {
+    while (!pool.idle.empty() && pool.open > m_minIdle && now - pool.idle.front().idleSince >= m_idleTimeout) {
+        closed.push_back(std::move(pool.idle.front().driver));
+        pool.idle.pop_front();
+        --pool.open;
+        ++m_stats.evictions;
+    }
+}
+
+bool ConnectionPool::resetSession(SQLServerDriver& driver, const ConnectionInfo& info) {
+    // sp_reset_connection is only reachable through the driver manager's own pooling, so the pieces of it that
+    // leak between borrowers are undone explicitly
+    std::string sql;
+    if (info.dbType == DbType::SQLServer) {
+        sql = "IF @@TRANCOUNT > 0 ROLLBACK TRANSACTION; SET IMPLICIT_TRANSACTIONS OFF; SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SET LOCK_TIMEOUT -1; SET NOCOUNT OFF;";
+        if (!info.database.empty()) {
+            std::string quoted;
+            for (char c : info.database) {
+                quoted += c;
+                if (c == ']') {
+                    quoted += ']';
+                }
+            }
+            sql += std::format(" USE [{}];", quoted);
+        }
+    } else {
+        sql = "ROLLBACK";
+    }
+
+    try {
+        [[maybe_unused]] auto _ = driver.execute(sql);
+        return true;
+    } catch (const std::exception&) {
+        return false;
     }
 }
 
@@ -96,6 +265,16 @@ bool ConnectionPool::testConnection(const ConnectionInfo& info) {
     return success;
 }
 
+ConnectionPool::Stats ConnectionPool::stats() const {
+    std::lock_guard lock(m_mutex);
+    Stats result = m_stats;
+    for (const auto& [id, pool] : m_pools) {
+        result.idle += pool->idle.size();
+    }
+    result.inUse = m_checkedOut.size();
+    return result;
+}
+
 std::string ConnectionPool::buildConnectionString(const ConnectionInfo& info) const {
     std::string connStr;
 
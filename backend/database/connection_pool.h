@@ -1,11 +1,16 @@
 #pragma once
 
+#include "../utils/string_hash.h"
+
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace velocitydb {
@@ -26,31 +31,83 @@ struct ConnectionInfo {
     DbType dbType = DbType::SQLServer;
 };
 
+/// Keeps logged-in drivers per registered connection so acquire() only pays a login when the pool is empty.
+///
+/// Each connection holds at most `maxSize` drivers (idle plus checked out); acquire() blocks up to its timeout
+/// when all of them are busy. Idle drivers are validated on borrow, reset on release (open transaction rolled
+/// back, session options and database restored) and closed after `idleTimeout`, keeping at least `minIdle` open.
 class ConnectionPool {
 public:
-    explicit ConnectionPool(size_t poolSize = 5) : m_poolSize(poolSize) {}
+    static constexpr std::chrono::seconds DEFAULT_IDLE_TIMEOUT = std::chrono::minutes(5);
+    static constexpr std::chrono::milliseconds DEFAULT_ACQUIRE_TIMEOUT = std::chrono::seconds(30);
+
+    struct Stats {
+        uint64_t checkouts = 0;           ///< Successful acquire() calls
+        uint64_t reused = 0;              ///< Checkouts served by an idle driver
+        uint64_t created = 0;             ///< Logins performed (including addConnection and minIdle warm-up)
+        uint64_t waits = 0;               ///< acquire() calls that blocked because the pool was exhausted
+        uint64_t waitTimeouts = 0;        ///< Waits that gave up
+        uint64_t validationFailures = 0;  ///< Idle drivers found dead on borrow or failing their reset
+        uint64_t evictions = 0;           ///< Idle drivers closed after idleTimeout
+        size_t idle = 0;
+        size_t inUse = 0;
+    };
+
+    explicit ConnectionPool(size_t poolSize = 5, size_t minIdle = 0, std::chrono::seconds idleTimeout = DEFAULT_IDLE_TIMEOUT);
     ~ConnectionPool();
 
     ConnectionPool(const ConnectionPool&) = delete;
     ConnectionPool& operator=(const ConnectionPool&) = delete;
 
+    /// Register `info` after a test login; the test driver (and up to minIdle more) stays in the pool
     [[nodiscard]] bool addConnection(const ConnectionInfo& info);
+    /// Unregister `id`, closing its idle drivers; checked-out drivers are closed when released
     void removeConnection(std::string_view id);
 
-    [[nodiscard]] std::shared_ptr<SQLServerDriver> acquire(std::string_view connectionId);
+    /// Idle driver for `connectionId`, or a new login while under the size limit.
+    /// Returns nullptr for unknown ids, failed logins, or when no driver frees up within `timeout`.
+    [[nodiscard]] std::shared_ptr<SQLServerDriver> acquire(std::string_view connectionId, std::chrono::milliseconds timeout = DEFAULT_ACQUIRE_TIMEOUT);
+    /// Return a driver obtained from acquire(); drivers that are dead or fail their reset are closed instead
     void release(std::shared_ptr<SQLServerDriver> connection);
 
+    /// Close idle drivers unused for longer than idleTimeout; returns the number closed
+    size_t evictIdle();
+
     [[nodiscard]] std::vector<ConnectionInfo> getConnections() const;
     [[nodiscard]] bool testConnection(const ConnectionInfo& info);
+    [[nodiscard]] Stats stats() const;
 
 private:
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleDriver {
+        std::shared_ptr<SQLServerDriver> driver;
+        Clock::time_point idleSince;
+    };
+
+    struct Pool {
+        ConnectionInfo info;
+        std::string connectionString;
+        std::deque<IdleDriver> idle;  ///< Oldest first; borrowed from the back
+        size_t open = 0;              ///< Idle plus checked out
+        bool removed = false;
+    };
+
     [[nodiscard]] std::string buildConnectionString(const ConnectionInfo& info) const;
+    /// Move idle drivers past their timeout from `pool` into `closed` (lock held)
+    void collectExpired(Pool& pool, Clock::time_point now, std::vector<std::shared_ptr<SQLServerDriver>>& closed);
+    /// Return a released session to its initial state; false if it should be closed instead
+    [[nodiscard]] static bool resetSession(SQLServerDriver& driver, const ConnectionInfo& info);
 
     size_t m_poolSize;
+    size_t m_minIdle;
+    std::chrono::seconds m_idleTimeout;
     mutable std::mutex m_mutex;
     std::condition_variable m_condition;
     std::vector<ConnectionInfo> m_connections;
-    std::queue<std::shared_ptr<SQLServerDriver>> m_available;
+    std::unordered_map<std::string, std::shared_ptr<Pool>, StringHash, std::equal_to<>> m_pools;
+    std::unordered_map<const SQLServerDriver*, std::shared_ptr<Pool>> m_checkedOut;
+    Stats m_stats;
 };
 
 }  // namespace velocitydb
@@ -1,21 +1,70 @@
 #include "connection_registry.h"
 
 #include "../network/ssh_tunnel.h"
+#include "../utils/logger.h"
 #include "driver_interface.h"
 
+#include <algorithm>
+#include <exception>
 #include <format>
 
 namespace velocitydb {
 
+namespace {
+
+std::string useStatement(std::string_view database) {
+    std::string sql = "USE [";
+    for (char c : database) {
+        sql += c;
+        if (c == ']') {
+            sql += ']';
+        }
+    }
+    sql += ']';
+    return sql;
+}
+
+/// One cheap round trip; false when the link is gone
+[[nodiscard]] bool ping(IDatabaseDriver& driver) {
+    if (!driver.isConnected()) {
+        return false;
+    }
+    try {
+        [[maybe_unused]] auto _ = driver.execute("SELECT 1");
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+}  // namespace
+
 ConnectionRegistry::~ConnectionRegistry() {
+    {
+        std::lock_guard lock(m_keepaliveMutex);
+        m_stopKeepalive = true;
+    }
+    m_keepaliveWake.notify_all();
+    if (m_keepalive.joinable()) {
+        m_keepalive.join();
+    }
     clear();
 }
 
-std::string ConnectionRegistry::add(DriverPtr queryDriver, DriverPtr metadataDriver) {
+std::string ConnectionRegistry::add(DriverPtr queryDriver, DriverPtr metadataDriver, std::string cacheIdentity, LaneFactory laneFactory, size_t maxLanes) {
+    auto lanes = std::make_shared<LaneSet>();
+    lanes->lanes.push_back(std::make_unique<Lane>(Lane{.driver = queryDriver}));
+    lanes->factory = std::move(laneFactory);
+    lanes->maxLanes = lanes->factory ? (std::max)(maxLanes, size_t{1}) : 1;
+
     std::lock_guard lock(m_mutex);
     auto id = std::format("conn_{}", m_counter.fetch_add(1));
+    m_lanes[id] = std::move(lanes);
     m_queryConnections[id] = std::move(queryDriver);
     m_metadataConnections[id] = std::move(metadataDriver);
+    if (!cacheIdentity.empty()) {
+        m_cacheIdentities[id] = std::move(cacheIdentity);
+    }
     return id;
 }
 
@@ -27,6 +76,23 @@ void ConnectionRegistry::remove(std::string_view id) {
     if (auto tunnelIt = m_tunnels.find(idStr); tunnelIt != m_tunnels.end()) {
         m_tunnels.erase(tunnelIt);
     }
+    m_cacheIdentities.erase(idStr);
+
+    // Disconnect extra lanes; lane 0 is the query driver below. Checked-out lanes keep the set alive until returned.
+    if (auto it = m_lanes.find(idStr); it != m_lanes.end()) {
+        std::lock_guard laneLock(it->second->mutex);
+        for (size_t i = 1; i < it->second->lanes.size(); ++i) {
+            if (auto& driver = it->second->lanes[i]->driver; driver && driver->isConnected()) {
+                driver->disconnect();
+            }
+        }
+        for (const auto& lane : it->second->readLanes) {
+            if (lane->driver && lane->driver->isConnected()) {
+                lane->driver->disconnect();
+            }
+        }
+        m_lanes.erase(it);
+    }
 
     // Disconnect and remove query driver
     if (auto it = m_queryConnections.find(idStr); it != m_queryConnections.end()) {
@@ -43,21 +109,55 @@ void ConnectionRegistry::remove(std::string_view id) {
         }
         m_metadataConnections.erase(it);
     }
+
+    if (auto it = m_schemaConnections.find(idStr); it != m_schemaConnections.end()) {
+        if (it->second && it->second->isConnected()) {
+            it->second->disconnect();
+        }
+        m_schemaConnections.erase(it);
+    }
 }
 
 std::expected<ConnectionRegistry::DriverPtr, std::string> ConnectionRegistry::getQueryDriver(std::string_view id) const {
+    reviveAfterTunnelReconnect(id);
     std::shared_lock lock(m_mutex);
 
-    if (auto it = m_queryConnections.find(std::string(id)); it != m_queryConnections.end()) {
+    const auto idStr = std::string(id);
+    if (auto it = m_queryConnections.find(idStr); it != m_queryConnections.end()) {
+        if (auto lanes = m_lanes.find(idStr); lanes != m_lanes.end()) {
+            lanes->second->touch();
+        }
         return it->second;
     }
     return std::unexpected(std::format("Connection '{}' not found", id));
 }
 
 std::expected<ConnectionRegistry::DriverPtr, std::string> ConnectionRegistry::getMetadataDriver(std::string_view id) const {
+    reviveAfterTunnelReconnect(id);
     std::shared_lock lock(m_mutex);
 
-    if (auto it = m_metadataConnections.find(std::string(id)); it != m_metadataConnections.end()) {
+    const auto idStr = std::string(id);
+    if (auto it = m_metadataConnections.find(idStr); it != m_metadataConnections.end()) {
+        if (auto lanes = m_lanes.find(idStr); lanes != m_lanes.end()) {
+            lanes->second->touch();
+        }
+        return it->second;
+    }
+    return std::unexpected(std::format("Connection '{}' not found", id));
+}
+
+std::expected<ConnectionRegistry::DriverPtr, std::string> ConnectionRegistry::getSchemaDriver(std::string_view id) const {
+    reviveAfterTunnelReconnect(id);
+    std::shared_lock lock(m_mutex);
+
+    const auto idStr = std::string(id);
+    if (auto lanes = m_lanes.find(idStr); lanes != m_lanes.end()) {
+        lanes->second->touch();
+    }
+    if (auto it = m_schemaConnections.find(idStr); it != m_schemaConnections.end()) {
+        return it->second;
+    }
+    if (auto it = m_metadataConnections.find(idStr); it != m_metadataConnections.end()) {
         return it->second;
     }
     return std::unexpected(std::format("Connection '{}' not found", id));
@@ -67,6 +167,290 @@ std::expected<ConnectionRegistry::DriverPtr, std::string> ConnectionRegistry::ge
     return getQueryDriver(id);
 }
 
+std::shared_ptr<ConnectionRegistry::LaneSet> ConnectionRegistry::findLanes(std::string_view id) const {
+    std::shared_lock lock(m_mutex);
+    if (auto it = m_lanes.find(std::string(id)); it != m_lanes.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+ConnectionRegistry::Lane& ConnectionRegistry::pickLane(LaneSet& set, std::unique_lock<std::mutex>& lock, bool sessionIndependent) {
+    Lane* session = set.lanes.front().get();
+    if (!sessionIndependent || set.pinned) {
+        ++session->users;
+        return *session;
+    }
+
+    // Preferring the session lane when idle; it always has a driver, so a lane is always found
+    return *pickPooled(set.lanes, set.factory, set.maxLanes, lock);
+}
+
+ConnectionRegistry::Lane* ConnectionRegistry::pickPooled(std::vector<std::unique_ptr<Lane>>& pool, const LaneFactory& factory, size_t maxLanes, std::unique_lock<std::mutex>& lock) {
+    Lane* best = nullptr;
+    for (const auto& candidate : pool) {
+        if (candidate->driver && (!best || candidate->users < best->users)) {
+            best = candidate.get();
+            if (best->users == 0) {
+                break;
+            }
+        }
+    }
+
+    if ((!best || best->users > 0) && factory && pool.size() < maxLanes) {
+        // Reserve the slot so concurrent checkouts do not overshoot maxLanes, then log in unlocked
+        auto* fresh = pool.emplace_back(std::make_unique<Lane>()).get();
+        fresh->users = 1;
+        lock.unlock();
+        DriverPtr driver;
+        try {
+            driver = factory();
+        } catch (const std::exception&) {
+            driver = nullptr;
+        }
+        lock.lock();
+        if (driver) [[likely]] {
+            fresh->driver = std::move(driver);
+            return fresh;
+        }
+        std::erase_if(pool, [fresh](const std::unique_ptr<Lane>& lane) { return lane.get() == fresh; });
+    }
+
+    if (best) {
+        ++best->users;
+    }
+    return best;
+}
+
+bool ConnectionRegistry::syncDatabase(LaneSet& set, Lane& lane, std::unique_lock<std::mutex>& lock) {
+    if (lane.databaseEpoch == set.databaseEpoch) {
+        return true;
+    }
+    const auto epoch = set.databaseEpoch;
+    const auto sql = useStatement(set.database);
+    lock.unlock();
+    bool synced = true;
+    try {
+        [[maybe_unused]] auto _ = lane.driver->execute(sql);
+    } catch (const std::exception&) {
+        synced = false;
+    }
+    lock.lock();
+    if (synced) {
+        lane.databaseEpoch = (std::max)(lane.databaseEpoch, epoch);
+    }
+    return synced;
+}
+
+std::expected<ConnectionRegistry::LaneCheckout, std::string> ConnectionRegistry::checkoutLane(std::string_view id, bool sessionIndependent) {
+    reviveAfterTunnelReconnect(id);
+    auto set = findLanes(id);
+    if (!set) {
+        return std::unexpected(std::format("Connection '{}' not found", id));
+    }
+    set->touch();
+
+    std::unique_lock lock(set->mutex);
+    Lane* lane = &pickLane(*set, lock, sessionIndependent);
+    Lane* session = set->lanes.front().get();
+
+    if (lane != session && !syncDatabase(*set, *lane, lock)) {
+        // Better to queue behind the session lane than to read from the wrong database
+        --lane->users;
+        lane = session;
+        ++lane->users;
+    }
+
+    return checkedOut(set, lane);
+}
+
+ConnectionRegistry::LaneCheckout ConnectionRegistry::checkedOut(const std::shared_ptr<LaneSet>& set, Lane* lane) {
+    auto cancellation = CancellationToken::create();
+    set->checkouts.push_back(cancellation);
+    return LaneCheckout{.driver = lane->driver,
+                        .release =
+                            [set, lane, cancellation] {
+                                std::lock_guard guard(set->mutex);
+                                --lane->users;
+                                std::erase(set->checkouts, cancellation);
+                            },
+                        .cancellation = cancellation};
+}
+
+std::expected<ConnectionRegistry::LaneCheckout, std::string> ConnectionRegistry::checkoutReadLane(std::string_view id) {
+    reviveAfterTunnelReconnect(id);
+    auto set = findLanes(id);
+    if (!set) {
+        return std::unexpected(std::format("Connection '{}' not found", id));
+    }
+    set->touch();
+
+    {
+        std::unique_lock lock(set->mutex);
+        // A transaction reads its own uncommitted writes, which only the primary session has
+        if (set->readFactory && !set->pinned) {
+            if (Lane* lane = pickPooled(set->readLanes, set->readFactory, set->maxLanes, lock)) {
+                if (syncDatabase(*set, *lane, lock)) [[likely]] {
+                    return checkedOut(set, lane);
+                }
+                // The database may not be in the availability group; read it from the primary
+                --lane->users;
+            }
+        }
+    }
+    return checkoutLane(id, true);
+}
+
+void ConnectionRegistry::attachReadIntent(std::string_view id, DriverPtr schemaDriver, LaneFactory readFactory) {
+    std::lock_guard lock(m_mutex);
+    const auto idStr = std::string(id);
+    auto it = m_lanes.find(idStr);
+    if (it == m_lanes.end()) {
+        return;
+    }
+    if (schemaDriver) {
+        m_schemaConnections[idStr] = std::move(schemaDriver);
+    }
+    std::lock_guard laneLock(it->second->mutex);
+    it->second->readFactory = std::move(readFactory);
+}
+
+size_t ConnectionRegistry::readLaneCount(std::string_view id) const {
+    auto set = findLanes(id);
+    if (!set) {
+        return 0;
+    }
+    std::lock_guard lock(set->mutex);
+    return static_cast<size_t>(std::ranges::count_if(set->readLanes, [](const std::unique_ptr<Lane>& lane) { return lane->driver != nullptr; }));
+}
+
+void ConnectionRegistry::reviveAfterTunnelReconnect(std::string_view id) const {
+    const auto idStr = std::string(id);
+    std::vector<DriverPtr> drivers;
+    std::string database;
+    {
+        std::shared_lock lock(m_mutex);
+        auto tunnelIt = m_tunnels.find(idStr);
+        auto laneIt = m_lanes.find(idStr);
+        if (tunnelIt == m_tunnels.end() || !tunnelIt->second || laneIt == m_lanes.end()) {
+            return;
+        }
+        auto& set = *laneIt->second;
+        std::lock_guard laneLock(set.mutex);
+        const auto generation = tunnelIt->second->generation();
+        if (set.tunnelGeneration == generation) [[likely]] {
+            return;
+        }
+        // Claimed here so concurrent lookups do not reconnect too; they see the link failure until this one is done
+        set.tunnelGeneration = generation;
+        set.pinned = false;
+        for (const auto* pool : {&set.lanes, &set.readLanes}) {
+            for (const auto& lane : *pool) {
+                lane->databaseEpoch = 0;
+                if (lane->driver) {
+                    drivers.push_back(lane->driver);
+                }
+            }
+        }
+        if (auto it = m_metadataConnections.find(idStr); it != m_metadataConnections.end() && it->second) {
+            drivers.push_back(it->second);
+        }
+        if (auto it = m_schemaConnections.find(idStr); it != m_schemaConnections.end() && it->second) {
+            drivers.push_back(it->second);
+        }
+        database = set.database;
+    }
+
+    // Lane 0 is the query driver; the others start from the connection default and re-issue USE on checkout
+    for (size_t i = 0; i < drivers.size(); ++i) {
+        if (!drivers[i]->reconnect() || i != 0 || database.empty()) {
+            continue;
+        }
+        try {
+            [[maybe_unused]] auto _ = drivers[i]->execute(useStatement(database));
+        } catch (const std::exception&) {
+            // The database may be gone; lane 0 stays on the connection default like a fresh connect
+        }
+    }
+}
+
+void ConnectionRegistry::setSessionPinned(std::string_view id, bool pinned) {
+    if (auto set = findLanes(id)) {
+        std::lock_guard lock(set->mutex);
+        set->pinned = pinned;
+    }
+}
+
+void ConnectionRegistry::noteDatabaseChange(std::string_view id, std::string database) {
+    if (database.empty()) {
+        return;
+    }
+    if (auto set = findLanes(id)) {
+        std::lock_guard lock(set->mutex);
+        set->database = std::move(database);
+        set->lanes.front()->databaseEpoch = ++set->databaseEpoch;
+    }
+}
+
+ConnectionRegistry::DriverPtr ConnectionRegistry::openDedicatedDriver(std::string_view id) const {
+    auto set = findLanes(id);
+    if (!set) {
+        return nullptr;
+    }
+    LaneFactory factory;
+    {
+        std::lock_guard lock(set->mutex);
+        factory = set->factory;
+    }
+    // Logged in without the lock: a login takes a round trip or more
+    return factory ? factory() : nullptr;
+}
+
+void ConnectionRegistry::cancelAll(std::string_view id) {
+    auto set = findLanes(id);
+    if (!set) {
+        return;
+    }
+    std::vector<DriverPtr> running;
+    {
+        std::lock_guard lock(set->mutex);
+        for (const auto& lane : set->lanes) {
+            // The session lane is also used outside checkouts (transactions), so it is always cancelled
+            if (lane->driver && (lane->users > 0 || lane == set->lanes.front())) {
+                running.push_back(lane->driver);
+            }
+        }
+        for (const auto& lane : set->readLanes) {
+            if (lane->driver && lane->users > 0) {
+                running.push_back(lane->driver);
+            }
+        }
+        for (const auto& cancellation : set->checkouts) {
+            cancellation.cancel();
+        }
+    }
+    for (const auto& driver : running) {
+        driver->cancel();
+    }
+}
+
+size_t ConnectionRegistry::laneCount(std::string_view id) const {
+    auto set = findLanes(id);
+    if (!set) {
+        return 0;
+    }
+    std::lock_guard lock(set->mutex);
+    return static_cast<size_t>(std::ranges::count_if(set->lanes, [](const std::unique_ptr<Lane>& lane) { return lane->driver != nullptr; }));
+}
+
+std::string ConnectionRegistry::getCacheIdentity(std::string_view id) const {
+    std::shared_lock lock(m_mutex);
+    if (auto it = m_cacheIdentities.find(std::string(id)); it != m_cacheIdentities.end()) {
+        return it->second;
+    }
+    return {};
+}
+
 bool ConnectionRegistry::exists(std::string_view id) const {
     std::shared_lock lock(m_mutex);
     return m_queryConnections.contains(std::string(id));
@@ -79,6 +463,10 @@ size_t ConnectionRegistry::count() const {
 
 void ConnectionRegistry::attachTunnel(std::string_view connectionId, std::unique_ptr<SshTunnel> tunnel) {
     std::lock_guard lock(m_mutex);
+    if (auto it = m_lanes.find(std::string(connectionId)); it != m_lanes.end() && tunnel) {
+        std::lock_guard laneLock(it->second->mutex);
+        it->second->tunnelGeneration = tunnel->generation();
+    }
     m_tunnels[std::string(connectionId)] = std::move(tunnel);
 }
 
@@ -96,6 +484,22 @@ void ConnectionRegistry::clear() {
 
     // Close all tunnels
     m_tunnels.clear();
+    m_cacheIdentities.clear();
+
+    for (auto& [id, set] : m_lanes) {
+        std::lock_guard laneLock(set->mutex);
+        for (size_t i = 1; i < set->lanes.size(); ++i) {
+            if (auto& driver = set->lanes[i]->driver; driver && driver->isConnected()) {
+                driver->disconnect();
+            }
+        }
+        for (const auto& lane : set->readLanes) {
+            if (lane->driver && lane->driver->isConnected()) {
+                lane->driver->disconnect();
+            }
+        }
+    }
+    m_lanes.clear();
 
     // Disconnect all query connections
     for (auto& [id, driver] : m_queryConnections) {
@@ -112,6 +516,109 @@ void ConnectionRegistry::clear() {
         }
     }
     m_metadataConnections.clear();
+
+    for (auto& [id, driver] : m_schemaConnections) {
+        if (driver && driver->isConnected()) {
+            driver->disconnect();
+        }
+    }
+    m_schemaConnections.clear();
+}
+
+size_t ConnectionRegistry::keepAlive(std::chrono::steady_clock::duration idleFor) {
+    const auto idleSince = (std::chrono::steady_clock::now() - idleFor).time_since_epoch().count();
+    std::vector<std::pair<std::string, std::shared_ptr<LaneSet>>> idle;
+    {
+        std::shared_lock lock(m_mutex);
+        for (const auto& [id, set] : m_lanes) {
+            if (set->lastActivity.load(std::memory_order_relaxed) <= idleSince) {
+                idle.emplace_back(id, set);
+            }
+        }
+    }
+
+    size_t reconnected = 0;
+    for (const auto& [id, set] : idle) {
+        reviveAfterTunnelReconnect(id);  // A tunnel that came back already tells us the drivers need a new session
+        set->touch();
+
+        // Claim the idle lanes like a checkout would, so no query lands on one while it is pinged
+        std::vector<Lane*> claimed;
+        std::string database;
+        {
+            std::lock_guard lock(set->mutex);
+            if (set->pinned) {
+                continue;  // A reconnect would silently drop the open transaction
+            }
+            for (const auto* pool : {&set->lanes, &set->readLanes}) {
+                for (const auto& lane : *pool) {
+                    if (lane->driver && lane->users == 0) {
+                        ++lane->users;
+                        claimed.push_back(lane.get());
+                    }
+                }
+            }
+            database = set->database;
+        }
+        std::vector<DriverPtr> sideDrivers;  // Metadata and schema drivers are not checked out, so are pinged as they are
+        {
+            std::shared_lock lock(m_mutex);
+            for (const auto* connections : {&m_metadataConnections, &m_schemaConnections}) {
+                if (auto it = connections->find(id); it != connections->end() && it->second) {
+                    sideDrivers.push_back(it->second);
+                }
+            }
+        }
+
+        const Lane* session = set->lanes.front().get();  // Entries never move
+        std::vector<Lane*> resynced;
+        for (auto* lane : claimed) {
+            if (ping(*lane->driver) || !lane->driver->reconnect()) {
+                continue;
+            }
+            ++reconnected;
+            if (lane == session && !database.empty()) {
+                try {
+                    [[maybe_unused]] auto _ = lane->driver->execute(useStatement(database));
+                } catch (const std::exception&) {
+                    // The database may be gone; the session stays on the connection default like a fresh connect
+                }
+            } else if (lane != session) {
+                resynced.push_back(lane);
+            }
+        }
+        for (const auto& driver : sideDrivers) {
+            if (!ping(*driver) && driver->reconnect()) {
+                ++reconnected;
+            }
+        }
+
+        std::lock_guard lock(set->mutex);
+        for (auto* lane : resynced) {
+            lane->databaseEpoch = 0;  // Issues the current USE on its next checkout
+        }
+        for (auto* lane : claimed) {
+            --lane->users;
+        }
+    }
+    if (reconnected > 0) {
+        log<LogLevel::INFO>(std::format("[DB] Keepalive reconnected {} idle driver(s) whose link had dropped", reconnected));
+    }
+    return reconnected;
+}
+
+void ConnectionRegistry::startKeepalive(std::chrono::steady_clock::duration interval) {
+    if (m_keepalive.joinable()) {
+        return;
+    }
+    m_keepalive = std::thread([this, interval] {
+        std::unique_lock lock(m_keepaliveMutex);
+        while (!m_keepaliveWake.wait_for(lock, interval, [this] { return m_stopKeepalive; })) {
+            lock.unlock();
+            keepAlive(interval);
+            lock.lock();
+        }
+    });
 }
 
 }  // namespace velocitydb
@@ -1,23 +1,61 @@
 #pragma once
 
 #include "../network/ssh_tunnel.h"
+#include "../utils/cancellation_token.h"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <expected>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace velocitydb {
 
 class IDatabaseDriver;
 
 /// Manages active database connections and their associated resources
+///
+/// Each connection has one or more query lanes. Lane 0 is the query driver passed to add() and owns the
+/// session state (transactions, temp tables, SET options). Work that does not depend on that state may be
+/// spread over up to `maxLanes` drivers, opened on demand through the connection's LaneFactory, so a long
+/// report does not block a quick lookup. Extra lanes follow USE changes recorded with noteDatabaseChange().
+///
+/// For connections through an SSH tunnel, the drivers are reconnected on the next lookup after the tunnel
+/// re-established a dropped SSH connection (lane 0 returns to the last recorded database; a pinned session's
+/// transaction is lost with the old session).
+///
+/// A connection to an Availability Group listener may also get read-intent drivers (attachReadIntent): a schema
+/// driver and a pool of read lanes, logged in with ApplicationIntent=ReadOnly so the listener routes them to a
+/// readable secondary. checkoutReadLane() hands those out for statements that neither write nor depend on the
+/// session; everything else, and all work while a transaction is pinned, stays on the primary.
+///
+/// keepAlive() pings the drivers of connections nobody has touched for a while and reconnects the ones whose link
+/// broke, the same way; startKeepalive() runs it in the background. The traffic also keeps NATs and firewalls from
+/// dropping idle sessions, so the first query after a long pause does not hang until a TCP timeout.
 class ConnectionRegistry {
 public:
     using DriverPtr = std::shared_ptr<IDatabaseDriver>;
+    /// Opens another driver on the connection's login for an extra lane (nullptr on failure)
+    using LaneFactory = std::function<DriverPtr()>;
+
+    static constexpr size_t DEFAULT_MAX_LANES = 4;
+    /// Idle time after which startKeepalive() pings a connection, and the interval between its pings
+    static constexpr std::chrono::seconds KEEPALIVE_INTERVAL{120};
+
+    struct LaneCheckout {
+        DriverPtr driver;
+        std::function<void()> release;  ///< Must be called exactly once when the work is done
+        CancellationToken cancellation;  ///< Raised by cancelAll() until released
+    };
 
     ConnectionRegistry() = default;
     ~ConnectionRegistry();
@@ -28,7 +66,9 @@ public:
     ConnectionRegistry& operator=(ConnectionRegistry&&) = delete;
 
     /// Add a new connection pair (query + metadata) and return its unique ID
-    [[nodiscard]] std::string add(DriverPtr queryDriver, DriverPtr metadataDriver);
+    /// @param cacheIdentity Server/login identity that stays stable across sessions (keys the persistent result cache)
+    /// @param laneFactory Opens extra query lanes; without one the connection keeps a single lane
+    [[nodiscard]] std::string add(DriverPtr queryDriver, DriverPtr metadataDriver, std::string cacheIdentity = {}, LaneFactory laneFactory = {}, size_t maxLanes = DEFAULT_MAX_LANES);
 
     /// Remove a connection by ID (disconnects both query and metadata drivers)
     void remove(std::string_view id);
@@ -39,16 +79,56 @@ public:
     /// Get the metadata driver by ID
     [[nodiscard]] std::expected<DriverPtr, std::string> getMetadataDriver(std::string_view id) const;
 
+    /// Driver for catalog reads: the read-intent schema driver when attached, else the metadata driver
+    [[nodiscard]] std::expected<DriverPtr, std::string> getSchemaDriver(std::string_view id) const;
+
     /// Get a connection by ID (alias for getQueryDriver, for backwards compatibility)
     [[nodiscard]] std::expected<DriverPtr, std::string> get(std::string_view id) const;
 
+    /// Check out a query lane. `sessionIndependent` work takes an idle lane (opening one if allowed) or else the least
+    /// busy one; everything else, and all work while the session is pinned, runs on lane 0.
+    [[nodiscard]] std::expected<LaneCheckout, std::string> checkoutLane(std::string_view id, bool sessionIndependent);
+
+    /// Check out a read-intent lane for a read-only, session-independent statement (up to the connection's lane limit,
+    /// opened on demand). Falls back to checkoutLane(id, true) without read intent, while the session is pinned, or
+    /// when no read lane can be opened or follow the current database.
+    [[nodiscard]] std::expected<LaneCheckout, std::string> checkoutReadLane(std::string_view id);
+
+    /// Route the connection's catalog reads to `schemaDriver` (may be nullptr) and its read lanes to drivers from
+    /// `readFactory`, both logged in with read intent
+    void attachReadIntent(std::string_view id, DriverPtr schemaDriver, LaneFactory readFactory);
+
+    /// Number of open read-intent lanes (0 if unknown)
+    [[nodiscard]] size_t readLaneCount(std::string_view id) const;
+
+    /// Keep all work on lane 0 while a transaction is open there
+    void setSessionPinned(std::string_view id, bool pinned);
+
+    /// Record that lane 0 switched database, so other lanes issue the same USE before their next checkout
+    void noteDatabaseChange(std::string_view id, std::string database);
+
+    /// Cancel whatever runs on the connection's lanes and raise the token of every checkout not yet released
+    void cancelAll(std::string_view id);
+
+    /// Log in one more driver on the connection's login, owned by the caller and never handed out as a lane (for
+    /// background work that must not compete with queries). nullptr if the connection is unknown, keeps a single
+    /// lane or the login failed.
+    [[nodiscard]] DriverPtr openDedicatedDriver(std::string_view id) const;
+
+    /// Number of open query lanes (0 if unknown)
+    [[nodiscard]] size_t laneCount(std::string_view id) const;
+
+    /// Get the cache identity recorded for a connection (empty if unknown)
+    [[nodiscard]] std::string getCacheIdentity(std::string_view id) const;
+
     /// Check if a connection exists
     [[nodiscard]] bool exists(std::string_view id) const;
 
     /// Get the number of active connections
     [[nodiscard]] size_t count() const;
 
-    /// Attach an SSH tunnel to a connection
+    /// Attach an SSH tunnel to a connection. The registry owns one reference to the tunnel's shared SSH session and
+    /// forward, released by remove() or clear(). The connection's drivers must already be connected through it.
     void attachTunnel(std::string_view connectionId, std::unique_ptr<SshTunnel> tunnel);
 
     /// Get the SSH tunnel for a connection (may be nullptr)
@@ -57,12 +137,65 @@ public:
     /// Remove and close all connections
     void clear();
 
+    /// Ping (SELECT 1) the idle lanes and metadata driver of every connection unused for at least `idleFor`, and
+    /// reconnect those that fail. Connections pinned to a transaction are left alone; lanes checked out are skipped.
+    /// @return Drivers reconnected
+    size_t keepAlive(std::chrono::steady_clock::duration idleFor);
+
+    /// Call keepAlive(interval) every `interval` on a background thread until the registry is destroyed
+    void startKeepalive(std::chrono::steady_clock::duration interval = KEEPALIVE_INTERVAL);
+
 private:
+    struct Lane {
+        DriverPtr driver;  ///< nullptr while the lane is being opened
+        size_t users = 0;
+        uint64_t databaseEpoch = 0;
+    };
+
+    struct LaneSet {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Lane>> lanes;  ///< lanes[0] is the session lane; entries never move
+        LaneFactory factory;
+        std::vector<std::unique_ptr<Lane>> readLanes;  ///< Read-intent lanes; entries never move
+        LaneFactory readFactory;                       ///< Empty without read intent
+        size_t maxLanes = 1;
+        bool pinned = false;
+        std::string database;        ///< Last database recorded by noteDatabaseChange (empty = connection default)
+        uint64_t databaseEpoch = 0;  ///< Bumped on every database change
+        uint64_t tunnelGeneration = 0;  ///< SshTunnel::generation() the drivers were connected at
+        std::vector<CancellationToken> checkouts;  ///< Tokens of the checkouts not released yet
+        /// steady_clock ticks of the last lookup or keepalive ping (read without the lock)
+        std::atomic<std::chrono::steady_clock::rep> lastActivity{std::chrono::steady_clock::now().time_since_epoch().count()};
+
+        void touch() noexcept { lastActivity.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed); }
+    };
+
+    /// Pick a lane and count its user (set lock held through `lock`, which may be released while opening a lane)
+    [[nodiscard]] static Lane& pickLane(LaneSet& set, std::unique_lock<std::mutex>& lock, bool sessionIndependent);
+    /// First idle lane of `pool`, else one opened through `factory` while under `maxLanes`, else the least busy;
+    /// its user is counted. nullptr when the pool is empty and no lane could be opened. Same locking as pickLane().
+    [[nodiscard]] static Lane* pickPooled(std::vector<std::unique_ptr<Lane>>& pool, const LaneFactory& factory, size_t maxLanes, std::unique_lock<std::mutex>& lock);
+    /// Issue the connection's current USE on `lane` if it is behind (may release `lock` meanwhile); false if that failed
+    [[nodiscard]] static bool syncDatabase(LaneSet& set, Lane& lane, std::unique_lock<std::mutex>& lock);
+    /// Checkout of `lane`, whose user is already counted, with a token of its own (set lock held)
+    [[nodiscard]] static LaneCheckout checkedOut(const std::shared_ptr<LaneSet>& set, Lane* lane);
+    [[nodiscard]] std::shared_ptr<LaneSet> findLanes(std::string_view id) const;
+    /// Reconnect the connection's drivers if its SSH tunnel re-established the SSH connection since they connected
+    void reviveAfterTunnelReconnect(std::string_view id) const;
+
     mutable std::shared_mutex m_mutex;
     std::unordered_map<std::string, DriverPtr> m_queryConnections;
     std::unordered_map<std::string, DriverPtr> m_metadataConnections;
+    std::unordered_map<std::string, DriverPtr> m_schemaConnections;  ///< Read-intent catalog drivers
     std::unordered_map<std::string, std::unique_ptr<SshTunnel>> m_tunnels;
+    std::unordered_map<std::string, std::string> m_cacheIdentities;
+    std::unordered_map<std::string, std::shared_ptr<LaneSet>> m_lanes;
     std::atomic<int> m_counter{1};
+
+    std::mutex m_keepaliveMutex;  // guards m_stopKeepalive
+    std::condition_variable m_keepaliveWake;
+    bool m_stopKeepalive = false;
+    std::thread m_keepalive;
 };
 
 }  // namespace velocitydb
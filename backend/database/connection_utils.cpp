@@ -4,6 +4,7 @@
 #include "odbc_driver_detector.h"
 #include "simdjson.h"
 
+#include <algorithm>
 #include <format>
 
 namespace velocitydb {
@@ -47,36 +48,74 @@ std::string buildODBCConnectionString(const DatabaseConnectionParams& params) {
             } else {
                 connectionString += std::format("Uid={};Pwd={};", escapeOdbcValue(params.username), escapeOdbcValue(params.password));
             }
+            // Packet size is a connection attribute (SQLServerDriver::setPacketSize), not a keyword
+            if (params.tuning.mars) {
+                connectionString += "MARS_Connection=yes;";
+            }
+            if (params.tuning.multiSubnetFailover) {
+                connectionString += "MultiSubnetFailover=yes;";
+            }
+            if (params.tuning.readOnlyIntent) {
+                connectionString += "ApplicationIntent=ReadOnly;";
+            }
             break;
     }
 
     return connectionString;
 }
 
-std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(std::string_view jsonParams) {
-    try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(jsonParams);
+OdbcTuningParams extractOdbcTuning(const simdjson::dom::element& params) {
+    OdbcTuningParams tuning;
+    auto tuningObj = params["tuning"];
+    if (tuningObj.error()) {
+        return tuning;
+    }
+    if (auto packetSize = tuningObj["packetSize"].get_uint64(); !packetSize.error()) {
+        tuning.packetSize = static_cast<uint32_t>(std::min<uint64_t>(packetSize.value(), 32767));
+    }
+    if (auto mars = tuningObj["mars"].get_bool(); !mars.error()) {
+        tuning.mars = mars.value();
+    }
+    if (auto failover = tuningObj["multiSubnetFailover"].get_bool(); !failover.error()) {
+        tuning.multiSubnetFailover = failover.value();
+    }
+    if (auto readOnly = tuningObj["readOnlyIntent"].get_bool(); !readOnly.error()) {
+        tuning.readOnlyIntent = readOnly.value();
+    }
+    if (auto readRouting = tuningObj["readRouting"].get_bool(); !readRouting.error()) {
+        tuning.readRouting = readRouting.value();
+    }
+    return tuning;
+}
 
+std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(const simdjson::dom::element& params) {
+    try {
         DatabaseConnectionParams result;
-        auto serverResult = doc["server"].get_string();
-        auto databaseResult = doc["database"].get_string();
+        auto serverResult = params["server"].get_string();
+        auto databaseResult = params["database"].get_string();
         if (serverResult.error() || databaseResult.error()) {
             return std::unexpected("Missing required fields: server or database");
         }
         result.server = std::string(serverResult.value());
         result.database = std::string(databaseResult.value());
 
-        if (auto username = doc["username"].get_string(); !username.error()) {
+        if (auto username = params["username"].get_string(); !username.error()) {
             result.username = std::string(username.value());
         }
-        if (auto password = doc["password"].get_string(); !password.error()) {
+        if (auto password = params["password"].get_string(); !password.error()) {
             result.password = std::string(password.value());
         }
-        if (auto auth = doc["useWindowsAuth"].get_bool(); !auth.error()) {
+        if (auto auth = params["useWindowsAuth"].get_bool(); !auth.error()) {
             result.useWindowsAuth = auth.value();
         }
-        if (auto dbTypeStr = doc["dbType"].get_string(); !dbTypeStr.error()) {
+        if (auto rowsetSize = params["fetchRowsetSize"].get_uint64(); !rowsetSize.error()) {
+            result.fetchRowsetSize = static_cast<size_t>(rowsetSize.value());
+        }
+        if (auto maxLanes = params["maxQueryLanes"].get_uint64(); !maxLanes.error()) {
+            result.maxQueryLanes = static_cast<size_t>(maxLanes.value());
+        }
+        result.tuning = extractOdbcTuning(params);
+        if (auto dbTypeStr = params["dbType"].get_string(); !dbTypeStr.error()) {
             std::string_view typeVal = dbTypeStr.value();
             if (typeVal == "postgresql") {
                 result.dbType = DbType::PostgreSQL;
@@ -88,7 +127,7 @@ std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(std
         }
 
         // Extract SSH settings
-        auto sshObj = doc["ssh"];
+        auto sshObj = params["ssh"];
         if (!sshObj.error()) {
             if (auto enabled = sshObj["enabled"].get_bool(); !enabled.error()) {
                 result.ssh.enabled = enabled.value();
@@ -115,6 +154,15 @@ std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(std
                 if (auto passphrase = sshObj["keyPassphrase"].get_string(); !passphrase.error()) {
                     result.ssh.keyPassphrase = std::string(passphrase.value());
                 }
+                if (auto windowKb = sshObj["channelWindowKb"].get_uint64(); !windowKb.error()) {
+                    result.ssh.channelWindowKb = static_cast<uint32_t>(std::min<uint64_t>(windowKb.value(), 1024 * 1024));
+                }
+                if (auto compression = sshObj["compression"].get_bool(); !compression.error()) {
+                    result.ssh.compression = compression.value();
+                }
+                if (auto ciphers = sshObj["ciphers"].get_string(); !ciphers.error()) {
+                    result.ssh.ciphers = std::string(ciphers.value());
+                }
             }
         }
 
@@ -124,11 +172,9 @@ std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(std
     }
 }
 
-std::expected<std::string, std::string> extractConnectionId(std::string_view jsonParams) {
+std::expected<std::string, std::string> extractConnectionId(const simdjson::dom::element& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(jsonParams);
-        auto result = doc["connectionId"].get_string();
+        auto result = params["connectionId"].get_string();
         if (result.error()) {
             return std::unexpected("Missing connectionId field");
         }
@@ -151,6 +197,13 @@ SshTunnelConfig buildSshTunnelConfig(const SshConnectionParams& ssh, const std::
     config.keyPassphrase = ssh.keyPassphrase;
     config.remoteHost = std::move(host);
     config.remotePort = port;
+    if (ssh.channelWindowKb != 0) {
+        config.channelWindowBytes = ssh.channelWindowKb * 1024;
+    }
+    config.compression = ssh.compression;
+    if (!ssh.ciphers.empty()) {
+        config.ciphers = ssh.ciphers;
+    }
     return config;
 }
 
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "simdjson.h"
+
 #include <charconv>
+#include <cstdint>
 #include <expected>
 #include <memory>
 #include <string>
@@ -52,6 +55,18 @@ struct SshConnectionParams {
     std::string password;
     std::string privateKeyPath;
     std::string keyPassphrase;
+    uint32_t channelWindowKb = 0;  // Per-connection receive window (0 = SshTunnelConfig default)
+    bool compression = false;
+    std::string ciphers;  // Cipher preference list (empty = SshTunnelConfig default)
+};
+
+/// SQL Server network settings; the defaults leave the connection string as it always was
+struct OdbcTuningParams {
+    uint32_t packetSize = 0;           // TDS packet size in bytes (0 = driver default, else 512-32767)
+    bool mars = false;                 // MARS_Connection=yes
+    bool multiSubnetFailover = false;  // MultiSubnetFailover=yes, for Availability Group listeners
+    bool readOnlyIntent = false;       // ApplicationIntent=ReadOnly, routed to a readable secondary
+    bool readRouting = false;          // Keep the primary, but send reads, schema and export to a read-intent login
 };
 
 struct DatabaseConnectionParams {
@@ -61,20 +76,26 @@ struct DatabaseConnectionParams {
     std::string password;
     bool useWindowsAuth = true;
     DbType dbType = DbType::SQLServer;
+    size_t fetchRowsetSize = 0;  // Rows per block-cursor fetch (0 = driver default)
+    size_t maxQueryLanes = 0;    // Concurrent query drivers for session-independent reads (0 = registry default)
     SshConnectionParams ssh;
+    OdbcTuningParams tuning;   // SQL Server only
 };
 
+/// Reads the optional `tuning` object of a connection or profile request
+[[nodiscard]] OdbcTuningParams extractOdbcTuning(const simdjson::dom::element& params);
+
 /// Escapes special characters in ODBC connection string values.
 [[nodiscard]] std::string escapeOdbcValue(std::string_view value);
 
 /// Builds ODBC connection string from parameters.
 [[nodiscard]] std::string buildODBCConnectionString(const DatabaseConnectionParams& params);
 
-/// Parses JSON into DatabaseConnectionParams.
-[[nodiscard]] std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(std::string_view jsonParams);
+/// Reads DatabaseConnectionParams from parsed IPC params.
+[[nodiscard]] std::expected<DatabaseConnectionParams, std::string> extractConnectionParams(const simdjson::dom::element& params);
 
-/// Extracts connectionId from JSON params.
-[[nodiscard]] std::expected<std::string, std::string> extractConnectionId(std::string_view jsonParams);
+/// Extracts connectionId from parsed IPC params.
+[[nodiscard]] std::expected<std::string, std::string> extractConnectionId(const simdjson::dom::element& params);
 
 /// Builds SSH tunnel config from parameters.
 [[nodiscard]] SshTunnelConfig buildSshTunnelConfig(const SshConnectionParams& ssh, const std::string& server, DbType dbType = DbType::SQLServer);
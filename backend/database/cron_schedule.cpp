@@ -0,0 +1,200 @@
+#include "cron_schedule.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
+#include <vector>
+
+namespace velocitydb {
+
+namespace {
+
+using namespace std::chrono;
+
+constexpr int MINUTES_PER_DAY = 24 * 60;
+
+struct Shorthand {
+    std::string_view name;
+    std::string_view expansion;
+};
+
+constexpr std::array SHORTHANDS = {
+    Shorthand{"@hourly", "0 * * * *"},
+    Shorthand{"@daily", "0 0 * * *"},
+    Shorthand{"@midnight", "0 0 * * *"},
+    Shorthand{"@weekly", "0 0 * * 0"},
+    Shorthand{"@monthly", "0 0 1 * *"},
+};
+
+[[nodiscard]] std::optional<int> parseNumber(std::string_view text) noexcept {
+    int value = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size() || text.empty()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/// Set the bits of field `text` into `bits`, whose values range over [lo, hi]. False on a syntax or range error.
+template <size_t N>
+[[nodiscard]] bool parseField(std::string_view text, int lo, int hi, std::bitset<N>& bits) {
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+        if (item.empty() || (comma != std::string_view::npos && text.empty())) {
+            return false;
+        }
+
+        int step = 1;
+        if (const size_t slash = item.find('/'); slash != std::string_view::npos) {
+            auto parsed = parseNumber(item.substr(slash + 1));
+            if (!parsed || *parsed <= 0) {
+                return false;
+            }
+            step = *parsed;
+            item = item.substr(0, slash);
+        }
+        int first = lo;
+        int last = hi;
+        if (item != "*") {
+            const size_t dash = item.find('-');
+            auto from = parseNumber(item.substr(0, dash));
+            auto to = dash == std::string_view::npos ? from : parseNumber(item.substr(dash + 1));
+            if (!from || !to || *from > *to) {
+                return false;
+            }
+            first = *from;
+            // "a/n" means "a-hi/n"
+            last = dash == std::string_view::npos && step > 1 ? hi : *to;
+        }
+        if (first < lo || last > hi) {
+            return false;
+        }
+        for (int value = first; value <= last; value += step) {
+            bits.set(static_cast<size_t>(value));
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] std::optional<int> parseClock(std::string_view text) noexcept {
+    const size_t colon = text.find(':');
+    if (colon == std::string_view::npos) {
+        return std::nullopt;
+    }
+    auto hours = parseNumber(text.substr(0, colon));
+    auto minutes = parseNumber(text.substr(colon + 1));
+    if (!hours || !minutes || *hours < 0 || *hours > 23 || *minutes < 0 || *minutes > 59) {
+        return std::nullopt;
+    }
+    return *hours * 60 + *minutes;
+}
+
+[[nodiscard]] int minuteOfDay(local_seconds time) noexcept {
+    return static_cast<int>(duration_cast<minutes>(time - floor<days>(time)).count());
+}
+
+}  // namespace
+
+std::expected<CronSchedule, std::string> CronSchedule::parse(std::string_view expression) {
+    CronSchedule schedule;
+    schedule.m_text = std::string(expression);
+    for (const auto& shorthand : SHORTHANDS) {
+        if (expression == shorthand.name) {
+            expression = shorthand.expansion;
+            break;
+        }
+    }
+
+    std::vector<std::string_view> fields;
+    for (size_t pos = 0; pos < expression.size();) {
+        const size_t start = expression.find_first_not_of(" \t", pos);
+        if (start == std::string_view::npos) {
+            break;
+        }
+        const size_t end = (std::min)(expression.find_first_of(" \t", start), expression.size());
+        fields.push_back(expression.substr(start, end - start));
+        pos = end;
+    }
+    if (fields.size() != 5) [[unlikely]] {
+        return std::unexpected(std::format("A cron expression has five fields (minute hour day month weekday): {}", schedule.m_text));
+    }
+
+    std::bitset<8> weekdays;
+    if (!parseField(fields[0], 0, 59, schedule.m_minutes) || !parseField(fields[1], 0, 23, schedule.m_hours) || !parseField(fields[2], 1, 31, schedule.m_days) ||
+        !parseField(fields[3], 1, 12, schedule.m_months) || !parseField(fields[4], 0, 7, weekdays)) [[unlikely]] {
+        return std::unexpected(std::format("Invalid cron expression: {}", schedule.m_text));
+    }
+    for (size_t day = 0; day < 7; ++day) {
+        schedule.m_weekdays[day] = weekdays[day] || (day == 0 && weekdays[7]);
+    }
+    schedule.m_anyDay = fields[2].starts_with('*');
+    schedule.m_anyWeekday = fields[4].starts_with('*');
+    return schedule;
+}
+
+bool CronSchedule::dayMatches(const year_month_day& date, weekday weekday) const noexcept {
+    if (!m_months[static_cast<unsigned>(date.month())]) {
+        return false;
+    }
+    const bool dayOfMonth = m_days[static_cast<unsigned>(date.day())];
+    const bool dayOfWeek = m_weekdays[weekday.c_encoding()];
+    if (m_anyDay || m_anyWeekday) {
+        return dayOfMonth && dayOfWeek;
+    }
+    return dayOfMonth || dayOfWeek;
+}
+
+std::optional<local_seconds> CronSchedule::next(local_seconds after) const {
+    const auto start = floor<minutes>(after) + minutes{1};
+    auto day = floor<days>(start);
+    int firstMinute = minuteOfDay(start);
+    for (int i = 0; i < MAX_SEARCH_DAYS; ++i, day += days{1}, firstMinute = 0) {
+        if (!dayMatches(year_month_day{day}, weekday{day})) {
+            continue;
+        }
+        for (int minute = firstMinute; minute < MINUTES_PER_DAY; ++minute) {
+            if (!m_hours[static_cast<size_t>(minute / 60)]) {
+                minute = (minute / 60) * 60 + 59;  // skip the rest of the hour
+                continue;
+            }
+            if (m_minutes[static_cast<size_t>(minute % 60)]) {
+                return local_seconds{day} + minutes{minute};
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::expected<TimeWindow, std::string> TimeWindow::parse(std::string_view start, std::string_view end) {
+    auto startMinute = parseClock(start);
+    auto endMinute = parseClock(end);
+    if (!startMinute || !endMinute) [[unlikely]] {
+        return std::unexpected(std::format("Window bounds must be HH:MM times: {} - {}", start, end));
+    }
+    return TimeWindow{.startMinute = *startMinute, .endMinute = *endMinute};
+}
+
+bool TimeWindow::contains(local_seconds time) const noexcept {
+    const int minute = minuteOfDay(time);
+    if (startMinute == endMinute) {
+        return true;
+    }
+    if (startMinute < endMinute) {
+        return minute >= startMinute && minute < endMinute;
+    }
+    return minute >= startMinute || minute < endMinute;
+}
+
+local_seconds TimeWindow::nextOpening(local_seconds time) const noexcept {
+    if (contains(time)) {
+        return time;
+    }
+    const auto day = floor<days>(time);
+    const auto opening = local_seconds{day} + minutes{startMinute};
+    return opening > time ? opening : opening + days{1};
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <bitset>
+#include <chrono>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Five-field cron expression: minute (0-59), hour (0-23), day of month (1-31), month (1-12) and day of week
+/// (0-7, 0 and 7 both Sunday). A field is `*` or a comma list of values and `a-b` ranges, each optionally
+/// stepped with `/n`. When both day fields are restricted, a day matching either one qualifies, as in cron.
+/// `@hourly`, `@daily`, `@weekly` and `@monthly` are accepted as shorthands.
+///
+/// Times are local wall-clock times; converting them is up to the caller.
+class CronSchedule {
+public:
+    /// Days searched for a matching minute before next() gives up (covers leap days)
+    static constexpr int MAX_SEARCH_DAYS = 366 * 8;
+
+    [[nodiscard]] static std::expected<CronSchedule, std::string> parse(std::string_view expression);
+
+    /// First matching minute strictly after `after`; nullopt when no date ever matches (e.g. "0 0 30 2 *")
+    [[nodiscard]] std::optional<std::chrono::local_seconds> next(std::chrono::local_seconds after) const;
+
+    /// The expression as given
+    [[nodiscard]] const std::string& text() const noexcept { return m_text; }
+
+private:
+    CronSchedule() = default;
+
+    [[nodiscard]] bool dayMatches(const std::chrono::year_month_day& date, std::chrono::weekday weekday) const noexcept;
+
+    std::string m_text;
+    std::bitset<60> m_minutes;
+    std::bitset<24> m_hours;
+    std::bitset<32> m_days;  ///< Bit 0 unused
+    std::bitset<13> m_months;  ///< Bit 0 unused
+    std::bitset<7> m_weekdays;  ///< 0 = Sunday
+    bool m_anyDay = false;      ///< Day of month was `*`
+    bool m_anyWeekday = false;  ///< Day of week was `*`
+};
+
+/// Daily window of local time [start, end), in minutes after midnight; it spans midnight when end < start and
+/// covers the whole day when both are equal
+struct TimeWindow {
+    int startMinute = 0;
+    int endMinute = 0;
+
+    /// Window from "HH:MM" bounds
+    [[nodiscard]] static std::expected<TimeWindow, std::string> parse(std::string_view start, std::string_view end);
+
+    [[nodiscard]] bool contains(std::chrono::local_seconds time) const noexcept;
+    /// `time` when it is inside the window, otherwise the next time the window opens
+    [[nodiscard]] std::chrono::local_seconds nextOpening(std::chrono::local_seconds time) const noexcept;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,372 @@
+#include "disk_result_cache.h"
+
+#include "../utils/binary_result.h"
+#include "../utils/buffered_file_writer.h"
+#include "../utils/encoding.h"
+#include "../utils/file_utils.h"
+#include "../utils/logger.h"
+#include "../utils/lz4_codec.h"
+#include "../utils/mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <optional>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr std::string_view SEGMENT_MAGIC = "VDBS";
+constexpr std::string_view SEGMENT_EXTENSION = ".vdbs";
+constexpr size_t BLOCK_ENTRY_BYTES = 8;
+
+constexpr size_t alignUp(size_t value) noexcept {
+    return (value + 7) & ~size_t{7};
+}
+
+template <typename T>
+void appendLe(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T readLe(std::string_view data, size_t offset) noexcept {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+std::string pathToUtf8(const std::filesystem::path& path) {
+    auto utf8 = path.u8string();
+    return std::string(utf8.begin(), utf8.end());
+}
+
+std::string_view scopeOf(std::string_view key) noexcept {
+    return key.substr(0, key.find('\0'));
+}
+
+struct SegmentView {
+    std::string_view key;
+    std::vector<std::string> tables;
+    int64_t createdAt = 0;
+    uint64_t payloadBytes = 0;
+    std::string_view blockTable;
+    std::string_view blockData;
+};
+
+/// Validate the header and block table of a mapped segment
+std::optional<SegmentView> parseSegment(std::string_view data) {
+    if (data.size() < DiskResultCache::HEADER_BYTES || data.substr(0, 4) != SEGMENT_MAGIC || readLe<uint16_t>(data, 4) != DiskResultCache::VERSION) {
+        return std::nullopt;
+    }
+    const auto keyBytes = readLe<uint32_t>(data, 8);
+    const auto tableBytes = readLe<uint32_t>(data, 12);
+    const auto blockCount = readLe<uint32_t>(data, 16);
+
+    SegmentView segment;
+    segment.createdAt = readLe<int64_t>(data, 24);
+    segment.payloadBytes = readLe<uint64_t>(data, 32);
+
+    const size_t tablesStart = DiskResultCache::HEADER_BYTES + size_t{keyBytes};
+    const size_t blockTableStart = alignUp(tablesStart + tableBytes);
+    const size_t dataStart = blockTableStart + size_t{blockCount} * BLOCK_ENTRY_BYTES;
+    if (dataStart > data.size()) {
+        return std::nullopt;
+    }
+    segment.key = data.substr(DiskResultCache::HEADER_BYTES, keyBytes);
+    for (auto names = data.substr(tablesStart, tableBytes); !names.empty();) {
+        auto end = names.find('\0');
+        if (end == std::string_view::npos) {
+            return std::nullopt;
+        }
+        segment.tables.emplace_back(names.substr(0, end));
+        names.remove_prefix(end + 1);
+    }
+    segment.blockTable = data.substr(blockTableStart, size_t{blockCount} * BLOCK_ENTRY_BYTES);
+    segment.blockData = data.substr(dataStart);
+    return segment;
+}
+
+/// Reassemble the BinaryResultEncoder payload from a segment's blocks
+std::optional<std::string> readPayload(const SegmentView& segment) {
+    std::string payload(segment.payloadBytes, '\0');
+    size_t written = 0;
+    size_t read = 0;
+    for (size_t offset = 0; offset < segment.blockTable.size(); offset += BLOCK_ENTRY_BYTES) {
+        const auto rawBytes = readLe<uint32_t>(segment.blockTable, offset);
+        const auto storedBytes = readLe<uint32_t>(segment.blockTable, offset + 4);
+        if (rawBytes > payload.size() - written || storedBytes > segment.blockData.size() - read) {
+            return std::nullopt;
+        }
+        auto stored = segment.blockData.substr(read, storedBytes);
+        if (storedBytes == rawBytes) {
+            std::memcpy(payload.data() + written, stored.data(), rawBytes);
+        } else if (!Lz4Codec::decompress(stored, payload.data() + written, rawBytes)) {
+            return std::nullopt;
+        }
+        written += rawBytes;
+        read += storedBytes;
+    }
+    if (written != payload.size()) {
+        return std::nullopt;
+    }
+    return payload;
+}
+
+std::string buildSegment(std::string_view key, std::span<const std::string> tables, int64_t createdAt, std::string_view payload) {
+    std::string tableNames;
+    for (const auto& table : tables) {
+        tableNames.append(table);
+        tableNames.push_back('\0');
+    }
+
+    const size_t blockCount = (payload.size() + DiskResultCache::BLOCK_BYTES - 1) / DiskResultCache::BLOCK_BYTES;
+    std::string segment;
+    segment.reserve(alignUp(DiskResultCache::HEADER_BYTES + key.size() + tableNames.size()) + blockCount * BLOCK_ENTRY_BYTES + payload.size() / 2);
+
+    segment.append(SEGMENT_MAGIC);
+    appendLe(segment, DiskResultCache::VERSION);
+    appendLe(segment, uint16_t{0});
+    appendLe(segment, static_cast<uint32_t>(key.size()));
+    appendLe(segment, static_cast<uint32_t>(tableNames.size()));
+    appendLe(segment, static_cast<uint32_t>(blockCount));
+    appendLe(segment, uint32_t{0});
+    appendLe(segment, createdAt);
+    appendLe(segment, static_cast<uint64_t>(payload.size()));
+    segment.append(key);
+    segment.append(tableNames);
+    segment.append(alignUp(segment.size()) - segment.size(), '\0');
+
+    const size_t blockTableStart = segment.size();
+    segment.append(blockCount * BLOCK_ENTRY_BYTES, '\0');
+
+    std::string scratch(Lz4Codec::compressBound(DiskResultCache::BLOCK_BYTES), '\0');
+    for (size_t block = 0; block < blockCount; ++block) {
+        auto raw = payload.substr(block * DiskResultCache::BLOCK_BYTES, DiskResultCache::BLOCK_BYTES);
+        const size_t compressed = Lz4Codec::compress(raw, scratch.data(), scratch.size());
+        // Keep incompressible blocks raw so reads can skip decompression
+        const bool storeRaw = compressed == 0 || compressed >= raw.size();
+        const size_t storedBytes = storeRaw ? raw.size() : compressed;
+        segment.append(storeRaw ? raw.data() : scratch.data(), storedBytes);
+
+        const auto rawBytes = static_cast<uint32_t>(raw.size());
+        const auto stored = static_cast<uint32_t>(storedBytes);
+        std::memcpy(segment.data() + blockTableStart + block * BLOCK_ENTRY_BYTES, &rawBytes, 4);
+        std::memcpy(segment.data() + blockTableStart + block * BLOCK_ENTRY_BYTES + 4, &stored, 4);
+    }
+    return segment;
+}
+
+}  // namespace
+
+DiskResultCache::DiskResultCache(std::filesystem::path directory, size_t maxBytes, std::chrono::seconds ttl) : m_directory(std::move(directory)), m_maxBytes(maxBytes), m_ttl(ttl) {
+    loadIndex();
+}
+
+std::filesystem::path DiskResultCache::defaultDirectory() {
+    return std::filesystem::path(utf8ToWide(FileUtils::getAppDataPath())) / "result_cache";
+}
+
+uint64_t DiskResultCache::keyHash(std::string_view key) noexcept {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::filesystem::path DiskResultCache::segmentPath(uint64_t hash) const {
+    return m_directory / std::format("{:016x}{}", hash, SEGMENT_EXTENSION);
+}
+
+int64_t DiskResultCache::now() noexcept {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool DiskResultCache::expired(int64_t createdAt) const noexcept {
+    return now() - createdAt >= m_ttl.count();
+}
+
+void DiskResultCache::loadIndex() {
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    std::lock_guard lock(m_mutex);
+    for (const auto& entry : std::filesystem::directory_iterator(m_directory, ec)) {
+        if (!entry.is_regular_file(ec)) {
+            continue;
+        }
+        const auto& path = entry.path();
+        if (path.extension() != SEGMENT_EXTENSION) {
+            // Leftover temp file from an interrupted write
+            if (path.extension() == ".tmp") {
+                std::filesystem::remove(path, ec);
+            }
+            continue;
+        }
+
+        MappedFile file;
+        std::optional<SegmentView> segment;
+        if (file.open(pathToUtf8(path))) {
+            segment = parseSegment(file.view());
+        }
+        if (!segment || expired(segment->createdAt) || segmentPath(keyHash(segment->key)) != path) {
+            file.close();
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+
+        const uint64_t hash = keyHash(segment->key);
+        const size_t fileBytes = file.view().size();
+        m_segments[hash] = Segment{.scope = std::string(scopeOf(segment->key)), .tables = std::move(segment->tables), .createdAt = segment->createdAt, .fileBytes = fileBytes};
+        m_byAge.emplace(segment->createdAt, hash);
+        m_totalBytes += fileBytes;
+    }
+    evict(0);
+    log<LogLevel::INFO>(std::format("Disk result cache: {} segments, {} bytes", m_segments.size(), m_totalBytes));
+}
+
+std::shared_ptr<const ResultSet> DiskResultCache::get(std::string_view key) {
+    const uint64_t hash = keyHash(key);
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_segments.find(hash);
+        if (it == m_segments.end()) {
+            return nullptr;
+        }
+        if (expired(it->second.createdAt)) {
+            dropSegment(hash);
+            return nullptr;
+        }
+    }
+
+    // Decode outside the lock; a concurrent replace or drop only unlinks the file we have mapped
+    MappedFile file;
+    if (!file.open(pathToUtf8(segmentPath(hash)))) {
+        return nullptr;
+    }
+    auto segment = parseSegment(file.view());
+    if (!segment || segment->key != key) {
+        return nullptr;
+    }
+    auto payload = readPayload(*segment);
+    if (!payload) {
+        log<LogLevel::WARNING>(std::format("Disk result cache: corrupt segment {:016x}", hash));
+        std::lock_guard lock(m_mutex);
+        dropSegment(hash);
+        return nullptr;
+    }
+    try {
+        return std::make_shared<const ResultSet>(BinaryResultDecoder::decode(*payload));
+    } catch (const std::exception& e) {
+        log<LogLevel::WARNING>(std::format("Disk result cache: {} in segment {:016x}", e.what(), hash));
+        std::lock_guard lock(m_mutex);
+        dropSegment(hash);
+        return nullptr;
+    }
+}
+
+bool DiskResultCache::put(std::string_view key, const ResultSet& result, std::span<const std::string> tables) {
+    static std::atomic<uint64_t> tempSequence{0};
+
+    const uint64_t hash = keyHash(key);
+    const int64_t createdAt = now();
+    auto segment = buildSegment(key, tables, createdAt, BinaryResultEncoder::encode(result));
+    if (segment.size() > m_maxBytes) {
+        return false;
+    }
+
+    std::error_code ec;
+    const auto finalPath = segmentPath(hash);
+    const auto tempPath = m_directory / std::format("{:016x}.{}.tmp", hash, tempSequence.fetch_add(1));
+    {
+        BufferedFileWriter writer(64 * 1024);
+        if (!writer.open(pathToUtf8(tempPath))) {
+            return false;
+        }
+        writer.append(segment);
+        if (!writer.close()) {
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+    if (m_segments.contains(hash)) {
+        dropSegment(hash);
+    }
+    evict(segment.size());
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    m_segments[hash] = Segment{.scope = std::string(scopeOf(key)), .tables = {tables.begin(), tables.end()}, .createdAt = createdAt, .fileBytes = segment.size()};
+    m_byAge.emplace(createdAt, hash);
+    m_totalBytes += segment.size();
+    return true;
+}
+
+template <typename Pred>
+size_t DiskResultCache::dropMatching(std::string_view scopePrefix, Pred pred) {
+    std::lock_guard lock(m_mutex);
+    std::vector<uint64_t> matches;
+    for (const auto& [hash, segment] : m_segments) {
+        if (segment.scope.starts_with(scopePrefix) && pred(segment)) {
+            matches.push_back(hash);
+        }
+    }
+    for (auto hash : matches) {
+        dropSegment(hash);
+    }
+    return matches.size();
+}
+
+size_t DiskResultCache::invalidateTables(std::string_view scopePrefix, std::span<const std::string> tables) {
+    if (tables.empty()) {
+        return 0;
+    }
+    return dropMatching(scopePrefix, [&](const Segment& segment) { return std::ranges::any_of(tables, [&](const auto& table) { return std::ranges::binary_search(segment.tables, table); }); });
+}
+
+size_t DiskResultCache::invalidateScope(std::string_view scopePrefix) {
+    return dropMatching(scopePrefix, [](const Segment&) { return true; });
+}
+
+void DiskResultCache::clear() {
+    dropMatching("", [](const Segment&) { return true; });
+}
+
+size_t DiskResultCache::totalBytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_totalBytes;
+}
+
+size_t DiskResultCache::entryCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_segments.size();
+}
+
+void DiskResultCache::dropSegment(uint64_t hash) {
+    auto it = m_segments.find(hash);
+    if (it == m_segments.end()) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::remove(segmentPath(hash), ec);
+    m_byAge.erase({it->second.createdAt, hash});
+    m_totalBytes -= it->second.fileBytes;
+    m_segments.erase(it);
+}
+
+void DiskResultCache::evict(size_t incoming) {
+    while (!m_byAge.empty() && m_totalBytes + incoming > m_maxBytes) {
+        dropSegment(m_byAge.begin()->second);
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "result_set.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace velocitydb {
+
+/// Persistent second cache tier: one memory-mapped segment file per cached query.
+///
+/// Keys use the ResultCache::makeKey layout (`scope\0sql`). The scope must stay stable across
+/// restarts, so callers build it from the server identity rather than the per-session connection id.
+/// Segment layout (little-endian):
+///   header   "VDBS" u16 version, u16 reserved, u32 keyBytes, u32 tableBytes, u32 blockCount,
+///            u32 reserved, i64 createdAt (unix seconds), u64 payloadBytes
+///   key, dependent table names ('\0'-terminated each), padding to 8
+///   blocks[] u32 rawBytes, u32 storedBytes (stored == raw means the block is not compressed)
+///   data     LZ4-compressed blocks of the BinaryResultEncoder payload, back to back
+/// Entries expire after the TTL; the total size is capped by evicting the oldest segments.
+class DiskResultCache {
+public:
+    static constexpr uint16_t VERSION = 2;  ///< 2: keys hold the query fingerprint instead of the raw SQL
+    static constexpr size_t HEADER_BYTES = 40;
+    static constexpr size_t BLOCK_BYTES = 4 * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_BYTES = size_t{2} * 1024 * 1024 * 1024;
+    static constexpr std::chrono::seconds DEFAULT_TTL = std::chrono::hours(24);
+
+    /// Open (creating if needed) `directory` and index its segments, deleting expired or unreadable ones
+    explicit DiskResultCache(std::filesystem::path directory, size_t maxBytes = DEFAULT_MAX_BYTES, std::chrono::seconds ttl = DEFAULT_TTL);
+    ~DiskResultCache() = default;
+
+    DiskResultCache(const DiskResultCache&) = delete;
+    DiskResultCache& operator=(const DiskResultCache&) = delete;
+    DiskResultCache(DiskResultCache&&) = delete;
+    DiskResultCache& operator=(DiskResultCache&&) = delete;
+
+    /// <app data>\result_cache
+    [[nodiscard]] static std::filesystem::path defaultDirectory();
+
+    /// Decoded result for `key`, or nullptr when absent, expired or unreadable
+    [[nodiscard]] std::shared_ptr<const ResultSet> get(std::string_view key);
+
+    /// Write `result` as a new segment (replacing any previous one for `key`)
+    /// @param tables Sorted, unique table names the query depends on
+    /// @return false if the segment could not be written
+    bool put(std::string_view key, const ResultSet& result, std::span<const std::string> tables);
+
+    /// Drop entries whose scope starts with `scopePrefix` and that depend on any of `tables` (sorted, unique)
+    size_t invalidateTables(std::string_view scopePrefix, std::span<const std::string> tables);
+    /// Drop every entry whose scope starts with `scopePrefix`
+    size_t invalidateScope(std::string_view scopePrefix);
+    void clear();
+
+    [[nodiscard]] size_t totalBytes() const;
+    [[nodiscard]] size_t entryCount() const;
+
+private:
+    struct Segment {
+        std::string scope;
+        std::vector<std::string> tables;
+        int64_t createdAt = 0;
+        size_t fileBytes = 0;
+    };
+
+    /// Stable 64-bit FNV-1a hash of the key; names the segment file
+    [[nodiscard]] static uint64_t keyHash(std::string_view key) noexcept;
+    [[nodiscard]] std::filesystem::path segmentPath(uint64_t hash) const;
+    [[nodiscard]] bool expired(int64_t createdAt) const noexcept;
+    [[nodiscard]] static int64_t now() noexcept;
+
+    void loadIndex();
+    /// Remove a segment from the index and disk (lock held)
+    void dropSegment(uint64_t hash);
+    /// Evict oldest segments until `incoming` more bytes fit (lock held)
+    void evict(size_t incoming);
+    template <typename Pred>
+    size_t dropMatching(std::string_view scopePrefix, Pred pred);
+
+    std::filesystem::path m_directory;
+    size_t m_maxBytes;
+    std::chrono::seconds m_ttl;
+
+    mutable std::mutex m_mutex;
+    size_t m_totalBytes = 0;
+    std::unordered_map<uint64_t, Segment> m_segments;
+    std::set<std::pair<int64_t, uint64_t>> m_byAge;  ///< (createdAt, hash), oldest first
+};
+
+}  // namespace velocitydb
@@ -1,4 +1,11 @@
 #include "driver_interface.h"
+#include "replay_driver.h"
+#ifdef POSTGRESQL_ENABLED
+#include "postgresql_driver.h"
+#endif
+#ifdef MYSQL_ENABLED
+#include "mysql_driver.h"
+#endif
 #include "schema_inspector.h"
 #include "sqlserver_driver.h"
 
@@ -11,9 +18,19 @@ std::unique_ptr<IDatabaseDriver> DriverFactory::createDriver(DriverType type) {
         case DriverType::SQLServer:
             return std::make_unique<SQLServerDriver>();
         case DriverType::PostgreSQL:
-            throw std::runtime_error("PostgreSQL driver not yet implemented");
+#ifdef POSTGRESQL_ENABLED
+            return std::make_unique<PostgreSQLDriver>();
+#else
+            throw std::runtime_error("PostgreSQL support was not built (libpq not found)");
+#endif
         case DriverType::MySQL:
-            throw std::runtime_error("MySQL driver not yet implemented");
+#ifdef MYSQL_ENABLED
+            return std::make_unique<MySQLDriver>();
+#else
+            throw std::runtime_error("MySQL support was not built (libmysql not found)");
+#endif
+        case DriverType::Replay:
+            return std::make_unique<ReplayDriver>();
     }
     throw std::runtime_error("Unknown driver type");
 }
@@ -33,6 +50,8 @@ std::unique_ptr<ISchemaInspector> DriverFactory::createSchemaInspector(DriverTyp
             throw std::runtime_error("PostgreSQL schema provider not yet implemented");
         case DriverType::MySQL:
             throw std::runtime_error("MySQL schema provider not yet implemented");
+        case DriverType::Replay:
+            throw std::runtime_error("Replay driver has no schema provider");
     }
     throw std::runtime_error("Unknown driver type");
 }
@@ -1,16 +1,18 @@
 #pragma once
 
+#include "result_set.h"
+
 #include <expected>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace velocitydb {
 
 // Forward declarations
-struct ColumnInfo;
-struct ResultSet;
 struct TableInfo;
 struct IndexInfo;
 struct ForeignKeyInfo;
@@ -20,8 +22,9 @@ struct FunctionInfo;
 // Database driver type enumeration
 enum class DriverType {
     SQLServer,
-    PostgreSQL,  // Future support
-    MySQL        // Future support
+    PostgreSQL,  // PostgreSQLDriver, when built with libpq
+    MySQL,       // MySQLDriver, when built with libmysql
+    Replay       // Canned/recorded results without a server (ReplayDriver), for load tests
 };
 
 // Convert driver type to string
@@ -33,10 +36,65 @@ enum class DriverType {
             return "PostgreSQL";
         case DriverType::MySQL:
             return "MySQL";
+        case DriverType::Replay:
+            return "Replay";
     }
     return "Unknown";
 }
 
+// Thrown when the link to the server broke during a request (ODBC SQLSTATE class 08, e.g. a dropped SSH tunnel).
+// The request did not complete and can be retried once the connection is back.
+class ConnectionLostError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+[[nodiscard]] inline bool isConnectionLost(const std::exception& e) noexcept {
+    return dynamic_cast<const ConnectionLostError*>(&e) != nullptr;
+}
+
+// Receives the rows of a streamed query in fixed-size batches
+class RowBatchSink {
+public:
+    virtual ~RowBatchSink() = default;
+
+    // Called once, before the first batch (also for queries that return no rows)
+    virtual void onColumns(const std::vector<ColumnInfo>& columns) { (void)columns; }
+
+    // The batch is only valid for the duration of the call (its buffers are reused).
+    // Return false to stop fetching; the remaining rows are discarded.
+    [[nodiscard]] virtual bool onBatch(const ResultSet& batch) = 0;
+
+protected:
+    RowBatchSink() = default;
+    RowBatchSink(const RowBatchSink&) = default;
+    RowBatchSink& operator=(const RowBatchSink&) = default;
+};
+
+// Adapts a callable `bool(const ResultSet& batch)` to RowBatchSink
+template <typename Callback>
+class CallbackBatchSink final : public RowBatchSink {
+public:
+    explicit CallbackBatchSink(Callback callback) : m_callback(std::move(callback)) {}
+
+    [[nodiscard]] bool onBatch(const ResultSet& batch) override { return m_callback(batch); }
+
+private:
+    Callback m_callback;
+};
+
+// Outcome of a streamed query (the rows themselves went to the sink)
+struct StreamSummary {
+    std::vector<ColumnInfo> columns;
+    size_t totalRows = 0;
+    int64_t affectedRows = 0;
+    double executionTimeMs = 0.0;
+    FetchStats fetchStats;
+    ServerMessages messages;
+    bool stopped = false;    // Sink returned false before the result was exhausted
+    bool truncated = false;  // Stopped at a row limit with more rows left on the server
+};
+
 // Abstract interface for database drivers
 class IDatabaseDriver {
 public:
@@ -53,7 +111,20 @@ public:
 
     // Query execution
     [[nodiscard]] virtual ResultSet execute(std::string_view sql) = 0;
+    // Execute and deliver rows to `sink` in batches of at most `batchRows`, so memory stays bounded by the batch size
+    virtual StreamSummary executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows = DEFAULT_STREAM_BATCH_ROWS) = 0;
+    // Execute a batch and return each of its result sets; drivers without multi-result support return just the first
+    [[nodiscard]] virtual std::vector<ResultSet> executeMultiple(std::string_view sql) {
+        std::vector<ResultSet> results;
+        results.push_back(execute(sql));
+        return results;
+    }
     virtual void cancel() = 0;
+    // Open a fresh session with the last connection string (after the link broke); false if unsupported or failed.
+    // Session state (open transactions, temp tables, SET options, the current database) does not survive.
+    [[nodiscard]] virtual bool reconnect() { return false; }
+
+    static constexpr size_t DEFAULT_STREAM_BATCH_ROWS = 4096;
 
     // Error handling
     [[nodiscard]] virtual std::string getLastError() const = 0;
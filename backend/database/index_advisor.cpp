@@ -0,0 +1,283 @@
+#include "index_advisor.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <map>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] int64_t cellInt(const ResultSet& result, size_t row, size_t column) {
+    const auto text = result.cellText(row, column);
+    int64_t value = 0;
+    (void)std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+[[nodiscard]] double cellDouble(const ResultSet& result, size_t row, size_t column) {
+    const auto text = result.cellText(row, column);
+    double value = 0;
+    (void)std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+/// An existing index, as read by the third statement of the batch
+struct ExistingIndex {
+    int64_t indexId = 0;
+    std::string name;
+    bool unique = false;  ///< Unique index, primary key or unique constraint
+    std::string filter;
+    std::vector<std::string> keys;  ///< "[col]" or "[col] DESC", in key order
+    std::vector<std::string> included;
+    int64_t reads = 0;
+    int64_t writes = 0;
+    int64_t pages = 0;
+};
+
+/// Key column without its sort direction
+[[nodiscard]] std::string_view keyColumn(std::string_view key) noexcept {
+    if (key.ends_with(" DESC")) {
+        key.remove_suffix(5);
+    }
+    return key;
+}
+
+[[nodiscard]] bool startsWith(const std::vector<std::string>& columns, const std::vector<std::string>& prefix) {
+    return prefix.size() <= columns.size() && std::ranges::equal(prefix, columns | std::views::take(prefix.size()), {}, keyColumn, keyColumn);
+}
+
+/// Every column of `needed` is a key or included column of `index`
+[[nodiscard]] bool covers(const ExistingIndex& index, const std::vector<std::string>& needed) {
+    return std::ranges::all_of(needed, [&index](const std::string& column) {
+        return std::ranges::find(index.included, column) != index.included.end() || std::ranges::any_of(index.keys, [&column](const std::string& key) { return keyColumn(key) == column; });
+    });
+}
+
+[[nodiscard]] std::string qualifiedTable(std::string_view schema, std::string_view table) {
+    return std::format("{}.{}", detail::quoteSinglePart(schema), detail::quoteSinglePart(table));
+}
+
+[[nodiscard]] std::string joinColumns(const std::vector<std::string>& columns) {
+    std::string joined;
+    for (const auto& column : columns) {
+        if (!joined.empty()) {
+            joined += ", ";
+        }
+        joined += column;
+    }
+    return joined;
+}
+
+void appendUnique(std::vector<std::string>& columns, const std::vector<std::string>& more) {
+    for (const auto& column : more) {
+        if (std::ranges::find(columns, column) == columns.end()) {
+            columns.push_back(column);
+        }
+    }
+}
+
+[[nodiscard]] std::string createStatement(const MissingIndexSuggestion& suggestion) {
+    std::string name = "IX_" + suggestion.table;
+    for (const auto* list : {&suggestion.equalityColumns, &suggestion.inequalityColumns}) {
+        for (const auto& column : *list) {
+            name += '_' + detail::unquoteSinglePart(column);
+        }
+    }
+    if (name.size() > IndexAdvisor::MAX_INDEX_NAME) {
+        name.resize(IndexAdvisor::MAX_INDEX_NAME);
+    }
+    auto keys = suggestion.equalityColumns;
+    keys.insert(keys.end(), suggestion.inequalityColumns.begin(), suggestion.inequalityColumns.end());
+    std::string sql = std::format("CREATE NONCLUSTERED INDEX {} ON {} ({})", detail::quoteSinglePart(name), qualifiedTable(suggestion.schema, suggestion.table), joinColumns(keys));
+    if (!suggestion.includedColumns.empty()) {
+        sql += std::format(" INCLUDE ({})", joinColumns(suggestion.includedColumns));
+    }
+    sql += ';';
+    return sql;
+}
+
+}  // namespace
+
+std::vector<std::string> IndexAdvisor::splitColumnList(std::string_view list) {
+    std::vector<std::string> columns;
+    std::string current;
+    bool quoted = false;
+    for (size_t i = 0; i < list.size(); ++i) {
+        const char c = list[i];
+        if (quoted) {
+            current += c;
+            if (c == ']') {
+                if (i + 1 < list.size() && list[i + 1] == ']') {
+                    current += ']';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            }
+        } else if (c == ',') {
+            columns.push_back(std::move(current));
+            current.clear();
+        } else if (c != ' ' || !current.empty()) {
+            quoted = c == '[';
+            current += c;
+        }
+    }
+    if (!current.empty()) {
+        columns.push_back(std::move(current));
+    }
+    return columns;
+}
+
+std::string IndexAdvisor::buildQuery(std::string_view database) {
+    const auto db = database.empty() ? std::string() : detail::quoteSinglePart(database) + ".";
+    const auto dbId = database.empty() ? std::string("DB_ID()") : std::format("DB_ID(N'{}')", escapeSqlString(database));
+    return std::format(
+        "SELECT DATEDIFF(HOUR, sqlserver_start_time, SYSDATETIME()) AS uptime_hours FROM sys.dm_os_sys_info;\n"
+        "SELECT OBJECT_SCHEMA_NAME(d.object_id, d.database_id) AS schema_name, OBJECT_NAME(d.object_id, d.database_id) AS table_name,\n"
+        "  d.equality_columns, d.inequality_columns, d.included_columns, s.user_seeks, s.user_scans, s.avg_total_user_cost, s.avg_user_impact\n"
+        "FROM sys.dm_db_missing_index_details d\n"
+        "JOIN sys.dm_db_missing_index_groups g ON g.index_handle = d.index_handle\n"
+        "JOIN sys.dm_db_missing_index_group_stats s ON s.group_handle = g.index_group_handle\n"
+        "WHERE d.database_id = {};\n"
+        "WITH sizes AS (SELECT object_id, index_id, SUM(page_count) AS pages FROM sys.dm_db_index_physical_stats({}, NULL, NULL, NULL, 'LIMITED') GROUP BY object_id, index_id)\n"
+        "SELECT sc.name AS schema_name, o.name AS table_name, i.index_id, i.name AS index_name,\n"
+        "  CAST(i.is_unique | i.is_primary_key | i.is_unique_constraint AS int) AS is_unique, ISNULL(i.filter_definition, N'') AS filter_definition,\n"
+        "  (SELECT STRING_AGG(CAST(QUOTENAME(c.name) AS nvarchar(max)) + CASE WHEN ic.is_descending_key = 1 THEN N' DESC' ELSE N'' END, N', ') WITHIN GROUP (ORDER BY ic.key_ordinal)\n"
+        "   FROM {}sys.index_columns ic JOIN {}sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id\n"
+        "   WHERE ic.object_id = i.object_id AND ic.index_id = i.index_id AND ic.is_included_column = 0) AS key_columns,\n"
+        "  (SELECT STRING_AGG(CAST(QUOTENAME(c.name) AS nvarchar(max)), N', ') WITHIN GROUP (ORDER BY c.name)\n"
+        "   FROM {}sys.index_columns ic JOIN {}sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id\n"
+        "   WHERE ic.object_id = i.object_id AND ic.index_id = i.index_id AND ic.is_included_column = 1) AS included_columns,\n"
+        "  ISNULL(u.user_seeks + u.user_scans + u.user_lookups, 0) AS reads, ISNULL(u.user_updates, 0) AS writes, ISNULL(z.pages, 0) AS pages\n"
+        "FROM {}sys.indexes i\n"
+        "JOIN {}sys.objects o ON o.object_id = i.object_id AND o.type = 'U' AND o.is_ms_shipped = 0\n"
+        "JOIN {}sys.schemas sc ON sc.schema_id = o.schema_id\n"
+        "LEFT JOIN sys.dm_db_index_usage_stats u ON u.database_id = {} AND u.object_id = i.object_id AND u.index_id = i.index_id\n"
+        "LEFT JOIN sizes z ON z.object_id = i.object_id AND z.index_id = i.index_id\n"
+        "WHERE i.index_id > 0 AND i.is_hypothetical = 0\n"
+        "ORDER BY sc.name, o.name, i.index_id",
+        dbId, dbId, db, db, db, db, db, db, db, dbId);
+}
+
+IndexAdvice IndexAdvisor::analyze(const std::vector<ResultSet>& results) {
+    if (results.size() < 3) [[unlikely]] {
+        throw std::runtime_error("Index advisor: the server returned an incomplete result");
+    }
+    IndexAdvice advice;
+    if (!results[0].empty()) {
+        advice.uptimeHours = cellInt(results[0], 0, 0);
+    }
+
+    // Existing indexes by table
+    std::map<std::pair<std::string, std::string>, std::vector<ExistingIndex>> tables;
+    const auto& indexes = results[2];
+    for (size_t row = 0; row < indexes.rowCount(); ++row) {
+        tables[{indexes.cellText(row, 0), indexes.cellText(row, 1)}].push_back(ExistingIndex{.indexId = cellInt(indexes, row, 2),
+                                                                                           .name = indexes.cellText(row, 3),
+                                                                                           .unique = cellInt(indexes, row, 4) != 0,
+                                                                                           .filter = indexes.cellText(row, 5),
+                                                                                           .keys = splitColumnList(indexes.cellText(row, 6)),
+                                                                                           .included = splitColumnList(indexes.cellText(row, 7)),
+                                                                                           .reads = cellInt(indexes, row, 8),
+                                                                                           .writes = cellInt(indexes, row, 9),
+                                                                                           .pages = cellInt(indexes, row, 10)});
+    }
+
+    // Missing-index requests, merged when they ask for the same keys on the same table
+    std::map<std::tuple<std::string, std::string, std::string, std::string>, MissingIndexSuggestion> merged;
+    const auto& missing = results[1];
+    for (size_t row = 0; row < missing.rowCount(); ++row) {
+        if (missing.isNull(row, 0) || missing.isNull(row, 1)) {
+            continue;  // Dropped since the request was recorded
+        }
+        auto schema = missing.cellText(row, 0);
+        auto table = missing.cellText(row, 1);
+        auto equality = missing.cellText(row, 2);
+        auto inequality = missing.cellText(row, 3);
+        auto& suggestion = merged[{schema, table, equality, inequality}];
+        if (suggestion.table.empty()) {
+            suggestion.schema = std::move(schema);
+            suggestion.table = std::move(table);
+            suggestion.equalityColumns = splitColumnList(equality);
+            suggestion.inequalityColumns = splitColumnList(inequality);
+        }
+        appendUnique(suggestion.includedColumns, splitColumnList(missing.cellText(row, 4)));
+        const int64_t seeks = cellInt(missing, row, 5);
+        const int64_t scans = cellInt(missing, row, 6);
+        const double impact = cellDouble(missing, row, 8);
+        suggestion.seeks += seeks;
+        suggestion.scans += scans;
+        suggestion.avgUserImpact = (std::max)(suggestion.avgUserImpact, impact);
+        suggestion.improvement += cellDouble(missing, row, 7) * impact / 100.0 * static_cast<double>(seeks + scans);
+    }
+    for (auto& [key, suggestion] : merged) {
+        auto keys = suggestion.equalityColumns;
+        keys.insert(keys.end(), suggestion.inequalityColumns.begin(), suggestion.inequalityColumns.end());
+        if (auto found = tables.find({suggestion.schema, suggestion.table}); found != tables.end()) {
+            for (const auto& index : found->second) {
+                if (index.filter.empty() && !index.keys.empty() && (startsWith(index.keys, keys) || startsWith(keys, index.keys))) {
+                    suggestion.extends = index.name;
+                    break;
+                }
+            }
+        }
+        suggestion.createStatement = createStatement(suggestion);
+        advice.suggestions.push_back(std::move(suggestion));
+    }
+    std::ranges::sort(advice.suggestions, [](const auto& a, const auto& b) { return a.improvement > b.improvement; });
+
+    // Nonclustered, non-unique indexes that another index makes unnecessary, or that nothing reads
+    for (const auto& [table, list] : tables) {
+        for (const auto& index : list) {
+            if (index.indexId <= 1 || index.unique) {
+                continue;
+            }
+            IndexFinding finding{.schema = table.first, .table = table.second, .index = index.name, .reads = index.reads, .writes = index.writes, .sizeKb = index.pages * 8};
+            bool found = false;
+            for (const auto& other : list) {
+                if (other.indexId == index.indexId || other.filter != index.filter || !covers(other, index.included)) {
+                    continue;
+                }
+                if (other.keys == index.keys) {
+                    // Of two identical indexes, keep the older one
+                    if (!covers(index, other.included) || other.indexId < index.indexId) {
+                        finding.kind = IndexFinding::Kind::Duplicate;
+                        finding.coveredBy = other.name;
+                        found = true;
+                        break;
+                    }
+                } else if (other.indexId > 1 && other.keys.size() > index.keys.size() && std::ranges::equal(index.keys, other.keys | std::views::take(index.keys.size()))) {
+                    finding.kind = IndexFinding::Kind::Redundant;
+                    finding.coveredBy = other.name;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found && index.reads == 0) {
+                finding.kind = IndexFinding::Kind::Unused;
+                found = true;
+            }
+            if (found) {
+                finding.dropStatement = std::format("DROP INDEX {} ON {};", detail::quoteSinglePart(index.name), qualifiedTable(table.first, table.second));
+                advice.findings.push_back(std::move(finding));
+            }
+        }
+    }
+    std::ranges::sort(advice.findings, [](const auto& a, const auto& b) {
+        return std::tie(a.kind, b.sizeKb, b.writes) < std::tie(b.kind, a.sizeKb, a.writes);
+    });
+    return advice;
+}
+
+IndexAdvice IndexAdvisor::advise(IDatabaseDriver& driver, std::string_view database) {
+    return analyze(driver.executeMultiple(buildQuery(database)));
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// A CREATE INDEX the optimizer asked for (sys.dm_db_missing_index_*), with requests for the same keys merged
+struct MissingIndexSuggestion {
+    std::string schema;
+    std::string table;
+    std::vector<std::string> equalityColumns;  ///< Bracket-quoted, in the DMV's order
+    std::vector<std::string> inequalityColumns;
+    std::vector<std::string> includedColumns;
+    int64_t seeks = 0;
+    int64_t scans = 0;
+    double avgUserImpact = 0;  ///< Percent of the query cost the index would save
+    /// avg_total_user_cost * avg_user_impact% * (seeks + scans): the usual ranking of missing-index requests
+    double improvement = 0;
+    /// An existing index whose keys start with the suggested ones; extending it may beat adding another
+    std::string extends;
+    std::string createStatement;
+};
+
+/// An existing index that looks like dead weight
+struct IndexFinding {
+    enum class Kind : uint8_t {
+        Duplicate,  ///< Same keys (and filter) as another index whose included columns cover its own
+        Redundant,  ///< Keys are a leading prefix of another index's keys, which also covers its included columns
+        Unused,     ///< No seeks, scans or lookups since the server started, but maintained on every write
+    };
+    Kind kind = Kind::Duplicate;
+    std::string schema;
+    std::string table;
+    std::string index;
+    std::string coveredBy;  ///< The index that makes this one unnecessary (Duplicate, Redundant)
+    int64_t reads = 0;      ///< user_seeks + user_scans + user_lookups
+    int64_t writes = 0;     ///< user_updates
+    int64_t sizeKb = 0;     ///< Leaf pages * 8 (dm_db_index_physical_stats, LIMITED)
+    std::string dropStatement;
+};
+
+struct IndexAdvice {
+    int64_t uptimeHours = 0;  ///< Usage statistics only cover this long; judge "unused" against it
+    std::vector<MissingIndexSuggestion> suggestions;  ///< Highest improvement first
+    std::vector<IndexFinding> findings;               ///< Duplicates, then redundant, then unused; larger first
+};
+
+/// Index tuning hints from the server's DMVs: missing-index requests turned into CREATE INDEX statements,
+/// and unused, duplicate or redundant nonclustered indexes. Everything is read in one batch (one round trip per
+/// database); dm_db_index_physical_stats runs in LIMITED mode, which only reads allocation pages, so the advisor
+/// is cheap enough for production servers.
+///
+/// Primary keys, unique indexes and constraints, clustered indexes and heaps are never reported, since dropping
+/// them changes behaviour or storage rather than just write cost.
+class IndexAdvisor {
+public:
+    static constexpr size_t MAX_INDEX_NAME = 128;
+
+    /// Batch of three result sets: server uptime, missing-index requests, existing indexes with usage and size
+    [[nodiscard]] static std::string buildQuery(std::string_view database);
+    [[nodiscard]] static IndexAdvice analyze(const std::vector<ResultSet>& results);
+    /// Run buildQuery() on `driver` and analyze it
+    [[nodiscard]] static IndexAdvice advise(IDatabaseDriver& driver, std::string_view database);
+
+    /// "[a], [b]" (the DMV's column lists) into its bracket-quoted parts
+    [[nodiscard]] static std::vector<std::string> splitColumnList(std::string_view list);
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,204 @@
+#include "instance_search.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <exception>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+/// One-part bracket quoting; database names may contain dots
+std::string quoteDatabase(std::string_view name) {
+    std::string quoted = "[";
+    for (char c : name) {
+        quoted += c;
+        if (c == ']') {
+            quoted += ']';
+        }
+    }
+    quoted += ']';
+    return quoted;
+}
+
+char foldAscii(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+int matchPosition(std::string_view name, std::string_view pattern, bool caseSensitive) {
+    auto it = std::search(name.begin(), name.end(), pattern.begin(), pattern.end(), [caseSensitive](char a, char b) { return caseSensitive ? a == b : foldAscii(a) == foldAscii(b); });
+    return it == name.end() ? 0 : static_cast<int>(it - name.begin());
+}
+
+}  // namespace
+
+InstanceSearch::InstanceSearch(std::vector<DatabaseSearchOutcome> answered, std::vector<std::string> databases, Searcher search, size_t maxResults, size_t parallelism)
+    : m_databases(std::move(databases))
+    , m_search(std::move(search))
+    , m_maxResults(maxResults)
+    , m_total(answered.size() + m_databases.size())
+    , m_startTime(std::chrono::steady_clock::now())
+    , m_endTime(m_startTime) {
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto& outcome : answered) {
+            complete(std::move(outcome));
+        }
+    }
+    const size_t workers = std::clamp<size_t>(parallelism, 1, MAX_PARALLELISM);
+    for (size_t i = 0; i < (std::min)(workers, m_databases.size()); ++i) {
+        m_workers.emplace_back([this] { work(); });
+    }
+}
+
+InstanceSearch::~InstanceSearch() {
+    cancel();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void InstanceSearch::cancel() {
+    m_stopRequested.store(true, std::memory_order_release);
+}
+
+InstanceSearchProgress InstanceSearch::progress(size_t since) const {
+    std::lock_guard lock(m_mutex);
+    InstanceSearchProgress progress{.total = m_total, .completed = m_outcomes.size(), .matches = m_matches, .done = m_outcomes.size() == m_total, .truncated = m_truncated};
+    const auto endTime = progress.done ? m_endTime : std::chrono::steady_clock::now();
+    progress.elapsedMs = std::chrono::duration<double, std::milli>(endTime - m_startTime).count();
+    if (since < m_outcomes.size()) {
+        progress.databases.assign(m_outcomes.begin() + static_cast<std::ptrdiff_t>(since), m_outcomes.end());
+    }
+    return progress;
+}
+
+bool InstanceSearch::done() const {
+    std::lock_guard lock(m_mutex);
+    return m_outcomes.size() == m_total;
+}
+
+std::chrono::steady_clock::time_point InstanceSearch::endTime() const {
+    std::lock_guard lock(m_mutex);
+    return m_endTime;
+}
+
+void InstanceSearch::wait() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_outcomes.size() == m_total; });
+}
+
+void InstanceSearch::work() {
+    for (size_t index = m_next.fetch_add(1, std::memory_order_relaxed); index < m_databases.size(); index = m_next.fetch_add(1, std::memory_order_relaxed)) {
+        DatabaseSearchOutcome outcome{.database = m_databases[index]};
+        size_t remaining = 0;
+        {
+            std::lock_guard lock(m_mutex);
+            remaining = m_maxResults - (std::min)(m_matches, m_maxResults);
+        }
+        const auto started = std::chrono::steady_clock::now();
+        if (m_stopRequested.load(std::memory_order_acquire)) {
+            outcome.message = "Cancelled";
+        } else if (remaining == 0) {
+            outcome.message = "Skipped: result limit reached";
+        } else {
+            try {
+                outcome.matches = m_search(outcome.database, remaining);
+                outcome.success = true;
+            } catch (const std::exception& e) {
+                outcome.message = e.what();
+            }
+        }
+        outcome.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        // Hitting the limit it was given means this database may have had more
+        const bool full = outcome.success && outcome.matches.size() >= remaining;
+        std::lock_guard lock(m_mutex);
+        m_truncated = m_truncated || full;
+        complete(std::move(outcome));
+    }
+}
+
+void InstanceSearch::complete(DatabaseSearchOutcome outcome) {
+    const size_t remaining = m_maxResults - (std::min)(m_matches, m_maxResults);
+    if (outcome.matches.size() > remaining) {
+        outcome.matches.resize(remaining);
+        m_truncated = true;
+    }
+    m_matches += outcome.matches.size();
+    m_outcomes.push_back(std::move(outcome));
+    if (m_outcomes.size() == m_total) {
+        m_endTime = std::chrono::steady_clock::now();
+        m_changed.notify_all();
+    }
+}
+
+std::string_view InstanceSearch::databasesQuery() noexcept {
+    return "SELECT name, CASE WHEN name = DB_NAME() THEN 1 ELSE 0 END AS is_current FROM sys.databases WHERE state = 0 AND HAS_DBACCESS(name) = 1 ORDER BY name";
+}
+
+std::string InstanceSearch::buildQuery(std::string_view database, std::string_view pattern, const SearchOptions& options, size_t limit) {
+    std::string objectTypes;
+    auto addTypes = [&](bool enabled, std::string_view types) {
+        if (enabled) {
+            objectTypes += objectTypes.empty() ? "" : ",";
+            objectTypes += types;
+        }
+    };
+    addTypes(options.searchTables, "'U'");
+    addTypes(options.searchViews, "'V'");
+    addTypes(options.searchProcedures, "'P','PC'");
+    addTypes(options.searchFunctions, "'FN','IF','TF','FS','FT'");
+    if (pattern.empty() || limit == 0 || (objectTypes.empty() && !options.searchColumns && !options.searchIndexes)) {
+        return {};
+    }
+
+    const auto db = quoteDatabase(database);
+    const auto like = std::format("COLLATE {} LIKE N'%{}%'", options.caseSensitive ? "Latin1_General_CS_AS" : "Latin1_General_CI_AS", escapeSqlString(escapeLikePattern(pattern)));
+    std::vector<std::string> parts;
+    if (!objectTypes.empty()) {
+        parts.push_back(std::format("SELECT CASE WHEN o.type = 'U' THEN 'TABLE' WHEN o.type = 'V' THEN 'VIEW' WHEN o.type IN ('P','PC') THEN 'PROCEDURE' ELSE 'FUNCTION' END AS kind, "
+                                    "s.name AS schema_name, o.name AS object_name, CAST(N'' AS sysname) AS parent_name "
+                                    "FROM {0}.sys.objects o JOIN {0}.sys.schemas s ON s.schema_id = o.schema_id "
+                                    "WHERE o.is_ms_shipped = 0 AND o.type IN ({1}) AND o.name {2}",
+                                    db, objectTypes, like));
+    }
+    if (options.searchColumns) {
+        parts.push_back(std::format("SELECT 'COLUMN', s.name, c.name, o.name "
+                                    "FROM {0}.sys.columns c JOIN {0}.sys.objects o ON o.object_id = c.object_id JOIN {0}.sys.schemas s ON s.schema_id = o.schema_id "
+                                    "WHERE o.is_ms_shipped = 0 AND o.type IN ('U','V') AND c.name {1}",
+                                    db, like));
+    }
+    if (options.searchIndexes) {
+        parts.push_back(std::format("SELECT 'INDEX', s.name, i.name, o.name "
+                                    "FROM {0}.sys.indexes i JOIN {0}.sys.objects o ON o.object_id = i.object_id JOIN {0}.sys.schemas s ON s.schema_id = o.schema_id "
+                                    "WHERE i.name IS NOT NULL AND o.is_ms_shipped = 0 AND o.type IN ('U','V') AND i.name {1}",
+                                    db, like));
+    }
+
+    std::string sql = std::format("SELECT TOP ({}) kind, schema_name, object_name, parent_name FROM (", limit);
+    for (size_t i = 0; i < parts.size(); ++i) {
+        sql += i == 0 ? "" : " UNION ALL ";
+        sql += parts[i];
+    }
+    sql += ") AS found ORDER BY kind, object_name";
+    return sql;
+}
+
+std::vector<SearchResult> InstanceSearch::parseResults(const ResultSet& result, std::string_view pattern, bool caseSensitive) {
+    std::vector<SearchResult> matches;
+    if (result.columns.size() < 4) {
+        return matches;
+    }
+    matches.reserve(result.rowCount());
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        auto name = result.cellText(row, 2);
+        const int position = matchPosition(name, pattern, caseSensitive);
+        matches.push_back(SearchResult{.objectType = std::string(result.cellText(row, 0)), .schemaName = std::string(result.cellText(row, 1)), .objectName = std::string(name),
+                                       .parentName = std::string(result.cellText(row, 3)), .matchedText = std::string(name), .matchPosition = position});
+    }
+    return matches;
+}
+
+}  // namespace velocitydb
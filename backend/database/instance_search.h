@@ -0,0 +1,106 @@
+#pragma once
+
+#include "../utils/object_name_index.h"
+#include "driver_interface.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+
+/// Outcome of one database of an instance-wide object search
+struct DatabaseSearchOutcome {
+    std::string database;
+    bool success = false;
+    bool fromIndex = false;  ///< Answered from the schema cache's name index instead of the server
+    std::vector<SearchResult> matches;
+    double elapsedMs = 0.0;
+    std::string message;  ///< Why it failed or was skipped
+};
+
+struct InstanceSearchProgress {
+    size_t total = 0;
+    size_t completed = 0;
+    size_t matches = 0;
+    bool done = false;
+    bool truncated = false;  ///< Stopped at maxResults; databases not searched by then are reported as skipped
+    double elapsedMs = 0.0;
+    std::vector<DatabaseSearchOutcome> databases;  ///< Completed since the caller's last poll
+};
+
+/// Object search across every database of an instance, by a bounded pool of workers.
+///
+/// Each worker takes the next database and runs `search` on it, which reads that database's catalog through
+/// three-part names, so any pooled session serves any database. Databases already answered (e.g. the current one,
+/// from a warm name index) are passed in and reported first. Outcomes stream out per database as they complete;
+/// once maxResults matches are in, the databases not started yet are skipped.
+class InstanceSearch {
+public:
+    /// Matches in `database`, at most `limit`; throws when the database cannot be searched
+    using Searcher = std::function<std::vector<SearchResult>(const std::string& database, size_t limit)>;
+
+    static constexpr size_t DEFAULT_PARALLELISM = 4;
+    static constexpr size_t MAX_PARALLELISM = 16;
+
+    /// Starts the workers right away
+    InstanceSearch(std::vector<DatabaseSearchOutcome> answered, std::vector<std::string> databases, Searcher search, size_t maxResults, size_t parallelism = DEFAULT_PARALLELISM);
+    /// Cancels and waits for the workers
+    ~InstanceSearch();
+
+    InstanceSearch(const InstanceSearch&) = delete;
+    InstanceSearch& operator=(const InstanceSearch&) = delete;
+    InstanceSearch(InstanceSearch&&) = delete;
+    InstanceSearch& operator=(InstanceSearch&&) = delete;
+
+    /// Databases not started yet are reported as cancelled; searches in flight finish
+    void cancel();
+
+    /// Outcomes from the `since`-th completed one on, in completion order
+    [[nodiscard]] InstanceSearchProgress progress(size_t since = 0) const;
+    [[nodiscard]] bool done() const;
+    /// When done() last became true (construction time while still running)
+    [[nodiscard]] std::chrono::steady_clock::time_point endTime() const;
+
+    /// Block until every database has completed
+    void wait();
+
+    /// Online databases the login can open, by name, with a flag on the session's current one
+    [[nodiscard]] static std::string_view databasesQuery() noexcept;
+    /// Catalog search of `database` for names containing `pattern` (LIKE, with the options' object kinds and case
+    /// sensitivity); rows are (kind, schema, name, parent) ordered like ObjectNameIndex::search
+    [[nodiscard]] static std::string buildQuery(std::string_view database, std::string_view pattern, const SearchOptions& options, size_t limit);
+    /// Matches of a buildQuery() result
+    [[nodiscard]] static std::vector<SearchResult> parseResults(const ResultSet& result, std::string_view pattern, bool caseSensitive);
+
+private:
+    void work();
+    /// Record `outcome`, trimmed to what is left of maxResults (m_mutex held)
+    void complete(DatabaseSearchOutcome outcome);
+
+    const std::vector<std::string> m_databases;
+    const Searcher m_search;
+    const size_t m_maxResults;
+    const size_t m_total;
+    const std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<size_t> m_next{0};
+    std::atomic<bool> m_stopRequested{false};
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_changed;
+    std::vector<DatabaseSearchOutcome> m_outcomes;  ///< In completion order
+    size_t m_matches = 0;
+    bool m_truncated = false;
+    std::chrono::steady_clock::time_point m_endTime;
+
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,190 @@
+#include "live_query_stats.h"
+
+#include "../utils/logger.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+/// Numeric cell whatever the storage type the driver picked (smallint/bigint/real arrive as Int64/Double, the rest as text)
+double numericCell(const ResultSet& result, size_t row, size_t col) {
+    const auto& column = result.columnData[col];
+    if (column.isNull(row)) {
+        return 0;
+    }
+    if (column.isNumeric()) {
+        return column.numericAt(row);
+    }
+    const auto text = column.textAt(row);
+    double value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+int64_t integerCell(const ResultSet& result, size_t row, size_t col) {
+    return static_cast<int64_t>(numericCell(result, row, col));
+}
+
+enum Column : size_t { SESSION_ID, PERCENT_COMPLETE, ELAPSED, CPU, READS, WAIT_TYPE, NODE_ID, OPERATOR, ROWS, ESTIMATED_ROWS, COLUMN_COUNT };
+
+}  // namespace
+
+LiveQueryStatsPoller::LiveQueryStatsPoller(Listener listener, std::chrono::milliseconds interval) : m_listener(std::move(listener)), m_interval(interval) {}
+
+LiveQueryStatsPoller::~LiveQueryStatsPoller() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void LiveQueryStatsPoller::watch(std::string queryId, int sessionId, std::shared_ptr<IDatabaseDriver> monitor) {
+    if (!monitor) [[unlikely]] {
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_watches.insert_or_assign(std::move(queryId), Watch{.sessionId = sessionId, .monitor = std::move(monitor)});
+        if (!m_thread.joinable()) {
+            m_thread = std::thread([this] { run(); });
+        }
+    }
+    m_wake.notify_all();
+}
+
+void LiveQueryStatsPoller::unwatch(std::string_view queryId) {
+    std::lock_guard lock(m_mutex);
+    m_watches.erase(std::string(queryId));
+}
+
+size_t LiveQueryStatsPoller::watchedCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_watches.size();
+}
+
+std::string LiveQueryStatsPoller::buildQuery(std::span<const int> sessionIds) {
+    std::string ids;
+    for (int id : sessionIds) {
+        if (!ids.empty()) {
+            ids += ',';
+        }
+        ids += std::to_string(id);
+    }
+    // Per-thread profile rows are folded into one row per operator on the server
+    return std::format(R"(SELECT r.session_id, r.percent_complete, r.total_elapsed_time, r.cpu_time, r.logical_reads, r.wait_type,
+       p.node_id, p.physical_operator_name, p.row_count, p.estimate_row_count
+FROM sys.dm_exec_requests r
+OUTER APPLY (
+    SELECT q.node_id, MAX(q.physical_operator_name) AS physical_operator_name, SUM(q.row_count) AS row_count, MAX(q.estimate_row_count) AS estimate_row_count
+    FROM sys.dm_exec_query_profiles q
+    WHERE q.session_id = r.session_id AND q.request_id = r.request_id
+    GROUP BY q.node_id
+) p
+WHERE r.session_id IN ({})
+ORDER BY r.session_id, p.node_id)",
+                       ids);
+}
+
+std::vector<LiveQueryStats> LiveQueryStatsPoller::parseSamples(const ResultSet& result) {
+    std::vector<LiveQueryStats> samples;
+    if (result.columnData.size() < COLUMN_COUNT) [[unlikely]] {
+        return samples;
+    }
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        const auto sessionId = static_cast<int>(integerCell(result, row, SESSION_ID));
+        if (samples.empty() || samples.back().sessionId != sessionId) {
+            auto& sample = samples.emplace_back();
+            sample.sessionId = sessionId;
+            sample.percentComplete = numericCell(result, row, PERCENT_COMPLETE);
+            sample.elapsedMs = integerCell(result, row, ELAPSED);
+            sample.cpuMs = integerCell(result, row, CPU);
+            sample.logicalReads = integerCell(result, row, READS);
+            sample.waitType = result.columnData[WAIT_TYPE].displayText(row);
+        }
+        // OUTER APPLY leaves the profile columns NULL for sessions the server does not profile
+        if (!result.isNull(row, NODE_ID)) {
+            samples.back().operators.push_back(LiveOperatorStats{.nodeId = static_cast<int32_t>(integerCell(result, row, NODE_ID)),
+                                                                 .physicalOp = result.columnData[OPERATOR].displayText(row),
+                                                                 .rows = integerCell(result, row, ROWS),
+                                                                 .estimatedRows = integerCell(result, row, ESTIMATED_ROWS)});
+        }
+    }
+    return samples;
+}
+
+void LiveQueryStatsPoller::run() {
+    std::unique_lock lock(m_mutex);
+    while (!m_stopping) {
+        if (m_watches.empty()) {
+            m_wake.wait(lock, [this] { return m_stopping || !m_watches.empty(); });
+            continue;
+        }
+        if (m_wake.wait_for(lock, m_interval, [this] { return m_stopping; })) {
+            break;
+        }
+        lock.unlock();
+        pollOnce();
+        lock.lock();
+    }
+}
+
+void LiveQueryStatsPoller::pollOnce() {
+    struct Target {
+        std::shared_ptr<IDatabaseDriver> monitor;
+        std::vector<int> sessionIds;
+    };
+    std::unordered_map<IDatabaseDriver*, Target> targets;
+    {
+        std::lock_guard lock(m_mutex);
+        for (const auto& [queryId, watch] : m_watches) {
+            auto& target = targets[watch.monitor.get()];
+            target.monitor = watch.monitor;
+            target.sessionIds.push_back(watch.sessionId);
+        }
+    }
+
+    for (auto& [key, target] : targets) {
+        std::ranges::sort(target.sessionIds);
+        const auto [first, last] = std::ranges::unique(target.sessionIds);
+        target.sessionIds.erase(first, last);
+
+        std::vector<LiveQueryStats> samples;
+        try {
+            samples = parseSamples(target.monitor->execute(buildQuery(target.sessionIds)));
+        } catch (const std::exception& e) {
+            // Usually a missing VIEW SERVER STATE permission, which the next tick would hit again: stop sampling
+            // through this monitor. The queries themselves are unaffected.
+            log<LogLevel::WARNING>(std::format("Live query statistics unavailable: {}", e.what()));
+            std::lock_guard lock(m_mutex);
+            std::erase_if(m_watches, [&](const auto& entry) { return entry.second.monitor.get() == key; });
+            continue;
+        }
+
+        for (auto& sample : samples) {
+            // Resolved again so a query that finished during the round trip gets no late sample
+            std::vector<std::string> queryIds;
+            {
+                std::lock_guard lock(m_mutex);
+                for (const auto& [queryId, watch] : m_watches) {
+                    if (watch.sessionId == sample.sessionId && watch.monitor.get() == key) {
+                        queryIds.push_back(queryId);
+                    }
+                }
+            }
+            for (auto& queryId : queryIds) {
+                sample.queryId = std::move(queryId);
+                m_listener(sample);
+            }
+        }
+    }
+}
+
+}  // namespace velocitydb
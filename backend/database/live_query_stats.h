@@ -0,0 +1,91 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Rows one plan operator has produced so far (summed over its threads)
+struct LiveOperatorStats {
+    int32_t nodeId = 0;
+    std::string physicalOp;
+    int64_t rows = 0;
+    int64_t estimatedRows = 0;
+};
+
+/// One sys.dm_exec_requests / sys.dm_exec_query_profiles sample of a running query
+struct LiveQueryStats {
+    std::string queryId;
+    int sessionId = 0;
+    double percentComplete = 0;  ///< Only reported by some commands (index builds, backups, DBCC, ...)
+    int64_t elapsedMs = 0;
+    int64_t cpuMs = 0;
+    int64_t logicalReads = 0;
+    std::string waitType;
+    /// Empty unless the server profiles the session (lightweight profiling: on by default from SQL Server 2019)
+    std::vector<LiveOperatorStats> operators;
+};
+
+/// Samples every watched query from one background thread.
+///
+/// Each tick runs a single DMV query per monitor connection covering all of that connection's watched
+/// sessions, so the cost does not grow with the number of running queries. The thread starts with the first
+/// watch and idles without waking while nothing is watched.
+class LiveQueryStatsPoller {
+public:
+    using Listener = std::function<void(const LiveQueryStats& stats)>;
+
+    static constexpr auto DEFAULT_INTERVAL = std::chrono::milliseconds{1000};
+
+    /// @param listener Called on the poller thread for every sample; must not block
+    explicit LiveQueryStatsPoller(Listener listener, std::chrono::milliseconds interval = DEFAULT_INTERVAL);
+    ~LiveQueryStatsPoller();
+
+    LiveQueryStatsPoller(const LiveQueryStatsPoller&) = delete;
+    LiveQueryStatsPoller& operator=(const LiveQueryStatsPoller&) = delete;
+    LiveQueryStatsPoller(LiveQueryStatsPoller&&) = delete;
+    LiveQueryStatsPoller& operator=(LiveQueryStatsPoller&&) = delete;
+
+    /// Sample server session `sessionId` on behalf of `queryId`. `monitor` runs the DMV query and must be a
+    /// different connection than the one executing the query (typically the metadata connection).
+    void watch(std::string queryId, int sessionId, std::shared_ptr<IDatabaseDriver> monitor);
+    void unwatch(std::string_view queryId);
+    [[nodiscard]] size_t watchedCount() const;
+
+    /// The DMV query sampling `sessionIds`
+    [[nodiscard]] static std::string buildQuery(std::span<const int> sessionIds);
+    /// One LiveQueryStats per session in a buildQuery() result (queryId left empty), in result order
+    [[nodiscard]] static std::vector<LiveQueryStats> parseSamples(const ResultSet& result);
+
+private:
+    struct Watch {
+        int sessionId = 0;
+        std::shared_ptr<IDatabaseDriver> monitor;
+    };
+
+    void run();
+    void pollOnce();
+
+    const Listener m_listener;
+    const std::chrono::milliseconds m_interval;
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_wake;
+    std::unordered_map<std::string, Watch> m_watches;
+    std::thread m_thread;
+    bool m_stopping = false;
+};
+
+}  // namespace velocitydb
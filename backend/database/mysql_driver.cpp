@@ -0,0 +1,484 @@
+#include "mysql_driver.h"
+
+#include <chrono>
+#include <format>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr unsigned int CR_SERVER_GONE_ERROR = 2006;
+constexpr unsigned int CR_SERVER_LOST = 2013;
+constexpr size_t INITIAL_TEXT_BYTES = 256;
+
+// MySQL declares these as bool, MariaDB and older MySQL as my_bool
+using BindFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
+std::once_flag libraryInit;
+
+[[nodiscard]] double elapsedMs(std::chrono::steady_clock::time_point start) noexcept {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+[[nodiscard]] MySqlField fieldOf(const MYSQL_FIELD& field) noexcept {
+    return {.type = static_cast<uint32_t>(field.type), .flags = field.flags, .charset = field.charsetnr, .decimals = field.decimals, .length = field.length};
+}
+
+/// Open a session with `params`; nullptr (and `error` set) on failure
+[[nodiscard]] MYSQL* openSession(const MySqlConnectParams& params, std::string& error) {
+    std::call_once(libraryInit, [] { mysql_library_init(0, nullptr, nullptr); });
+    MYSQL* mysql = mysql_init(nullptr);
+    if (!mysql) [[unlikely]] {
+        error = "Out of memory";
+        return nullptr;
+    }
+    mysql_options(mysql, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+    if (!mysql_real_connect(mysql, params.host.c_str(), params.user.c_str(), params.password.c_str(), params.database.empty() ? nullptr : params.database.c_str(), params.port, nullptr,
+                            CLIENT_MULTI_STATEMENTS | CLIENT_MULTI_RESULTS)) [[unlikely]] {
+        error = mysql_error(mysql);
+        mysql_close(mysql);
+        return nullptr;
+    }
+    return mysql;
+}
+
+/// Output buffer of one result column of a prepared statement
+struct BindSlot {
+    int64_t integer = 0;
+    float real = 0.0f;
+    double doubleValue = 0.0;
+    MYSQL_TIME time{};
+    std::string text;
+    unsigned long length = 0;
+    BindFlag isNull = 0;
+    BindFlag error = 0;
+};
+
+enum class BindKind : uint8_t { Integer, Float, Double, Temporal, Text };
+
+[[nodiscard]] BindKind bindKindFor(const MySqlField& field) noexcept {
+    const auto storage = mysqlColumnType(field).storage;
+    if (field.type == mysql_type::BIT) {
+        return BindKind::Text;  // Raw bytes; decoded like the text protocol's
+    }
+    switch (storage) {
+        case ColumnDataType::Int64:
+            return BindKind::Integer;
+        case ColumnDataType::Double:
+            return field.type == mysql_type::FLOAT ? BindKind::Float : BindKind::Double;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            return BindKind::Temporal;
+        default:
+            return BindKind::Text;
+    }
+}
+
+void appendTemporal(ColumnData& column, const MySqlField& field, const MYSQL_TIME& time) {
+    DateTimeValue value;
+    value.year = static_cast<int16_t>(time.year);
+    value.month = static_cast<uint8_t>(time.month);
+    value.day = static_cast<uint8_t>(time.day);
+    value.hour = static_cast<uint8_t>(time.hour);
+    value.minute = static_cast<uint8_t>(time.minute);
+    value.second = static_cast<uint8_t>(time.second);
+    value.fraction = static_cast<uint32_t>(time.second_part * 1000);
+    const bool timeOnly = field.type == mysql_type::TIME;
+    const bool zeroDate = !timeOnly && time.year == 0 && time.month == 0 && time.day == 0;
+    if (time.neg || (timeOnly && time.hour > 23) || zeroDate) [[unlikely]] {
+        // Outside what the typed column holds: keep MySQL's own text for it
+        std::string text;
+        if (timeOnly) {
+            text = std::format("{}{:02}:{:02}:{:02}", time.neg ? "-" : "", time.hour, time.minute, time.second);
+        } else {
+            text = std::format("{:04}-{:02}-{:02}", time.year, time.month, time.day);
+            if (field.type != mysql_type::DATE && field.type != mysql_type::NEWDATE) {
+                text += std::format(" {:02}:{:02}:{:02}", time.hour, time.minute, time.second);
+            }
+        }
+        column.appendText(text);
+        return;
+    }
+    column.appendDateTime(value);
+}
+
+}  // namespace
+
+MySQLDriver::~MySQLDriver() {
+    disconnect();
+}
+
+bool MySQLDriver::connect(std::string_view connectionString) {
+    disconnect();
+    std::scoped_lock lock(m_executeMutex);
+    auto params = mysqlConnectParams(connectionString);
+    std::string error;
+    MYSQL* mysql = openSession(params, error);
+    if (!mysql) [[unlikely]] {
+        std::scoped_lock errorLock(m_errorMutex);
+        m_lastError = std::move(error);
+        return false;
+    }
+    m_mysql = mysql;
+    m_connectionString = std::string(connectionString);
+    {
+        std::scoped_lock paramsLock(m_paramsMutex);
+        m_params = std::move(params);
+    }
+    m_threadId.store(mysql_thread_id(mysql), std::memory_order_release);
+    m_connected.store(true, std::memory_order_release);
+    return true;
+}
+
+void MySQLDriver::disconnect() {
+    std::scoped_lock lock(m_executeMutex);
+    if (m_mysql) {
+        mysql_close(m_mysql);
+        m_mysql = nullptr;
+    }
+    m_threadId.store(0, std::memory_order_release);
+    m_connected.store(false, std::memory_order_release);
+}
+
+bool MySQLDriver::reconnect() {
+    std::string connectionString;
+    {
+        std::scoped_lock lock(m_executeMutex);
+        connectionString = m_connectionString;
+    }
+    return !connectionString.empty() && connect(connectionString);
+}
+
+void MySQLDriver::cancel() {
+    const unsigned long threadId = m_threadId.load(std::memory_order_acquire);
+    if (threadId == 0) {
+        return;
+    }
+    MySqlConnectParams params;
+    {
+        std::scoped_lock lock(m_paramsMutex);
+        params = m_params;
+    }
+    params.database.clear();
+    std::string error;
+    if (MYSQL* killer = openSession(params, error)) {
+        m_killed.store(true, std::memory_order_release);
+        const auto kill = std::format("KILL QUERY {}", threadId);
+        (void)mysql_real_query(killer, kill.c_str(), static_cast<unsigned long>(kill.size()));
+        mysql_close(killer);
+    }
+}
+
+std::string MySQLDriver::getLastError() const {
+    std::scoped_lock lock(m_errorMutex);
+    return m_lastError;
+}
+
+void MySQLDriver::fail(std::string message, unsigned int errorCode) {
+    const bool lost = errorCode == CR_SERVER_GONE_ERROR || errorCode == CR_SERVER_LOST;
+    if (lost) {
+        m_connected.store(false, std::memory_order_release);
+    }
+    {
+        std::scoped_lock lock(m_errorMutex);
+        m_lastError = message;
+    }
+    if (lost) {
+        throw ConnectionLostError(message);
+    }
+    throw std::runtime_error(message);
+}
+
+std::vector<ColumnInfo> MySQLDriver::describe(const std::vector<MySqlField>& fields, const std::vector<std::string>& names, ResultSet& batch) {
+    std::vector<ColumnInfo> columns;
+    columns.reserve(fields.size());
+    batch.columnData.clear();
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const auto type = mysqlColumnType(fields[i]);
+        columns.push_back(ColumnInfo{.name = names[i], .type = std::string(type.name), .size = static_cast<int>((std::min)(fields[i].length, uint64_t{(std::numeric_limits<int>::max)()}))});
+        batch.columnData.emplace_back(type.storage, type.fractionDigits);
+    }
+    batch.columns = columns;
+    return columns;
+}
+
+bool MySQLDriver::executePrepared(const std::string& sql, RowBatchSink& sink, size_t batchRows, StreamSummary& summary) {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<MYSQL_STMT, decltype(&mysql_stmt_close)> stmt(mysql_stmt_init(m_mysql), &mysql_stmt_close);
+    if (!stmt) [[unlikely]] {
+        fail(mysql_error(m_mysql), mysql_errno(m_mysql));
+    }
+    if (mysql_stmt_prepare(stmt.get(), sql.c_str(), static_cast<unsigned long>(sql.size())) != 0) {
+        const unsigned int code = mysql_stmt_errno(stmt.get());
+        if (code == CR_SERVER_GONE_ERROR || code == CR_SERVER_LOST) [[unlikely]] {
+            fail(mysql_stmt_error(stmt.get()), code);
+        }
+        // Not preparable (ER_UNSUPPORTED_PS, several statements, ...): the text protocol reports any real error
+        return false;
+    }
+
+    std::vector<MySqlField> fields;
+    std::vector<std::string> names;
+    if (MYSQL_RES* metadata = mysql_stmt_result_metadata(stmt.get())) {
+        const unsigned int count = mysql_num_fields(metadata);
+        const MYSQL_FIELD* described = mysql_fetch_fields(metadata);
+        for (unsigned int i = 0; i < count; ++i) {
+            fields.push_back(fieldOf(described[i]));
+            names.emplace_back(described[i].name, described[i].name_length);
+        }
+        mysql_free_result(metadata);
+    }
+
+    if (mysql_stmt_execute(stmt.get()) != 0) [[unlikely]] {
+        fail(mysql_stmt_error(stmt.get()), mysql_stmt_errno(stmt.get()));
+    }
+    summary.executionTimeMs = elapsedMs(start);
+    if (fields.empty()) {
+        summary.affectedRows = static_cast<int64_t>(mysql_stmt_affected_rows(stmt.get()));
+        sink.onColumns(summary.columns);
+        return true;
+    }
+
+    ResultSet batch;
+    summary.columns = describe(fields, names, batch);
+    sink.onColumns(summary.columns);
+
+    std::vector<BindSlot> slots(fields.size());
+    std::vector<BindKind> kinds(fields.size());
+    std::vector<MYSQL_BIND> binds(fields.size());
+    const auto bindSlot = [&](size_t i) {
+        auto& bind = binds[i];
+        auto& slot = slots[i];
+        bind = MYSQL_BIND{};
+        bind.length = &slot.length;
+        bind.is_null = &slot.isNull;
+        bind.error = &slot.error;
+        switch (kinds[i]) {
+            case BindKind::Integer:
+                bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                bind.buffer = &slot.integer;
+                break;
+            case BindKind::Float:
+                bind.buffer_type = MYSQL_TYPE_FLOAT;
+                bind.buffer = &slot.real;
+                break;
+            case BindKind::Double:
+                bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                bind.buffer = &slot.doubleValue;
+                break;
+            case BindKind::Temporal:
+                bind.buffer_type = MYSQL_TYPE_DATETIME;
+                bind.buffer = &slot.time;
+                break;
+            case BindKind::Text:
+                bind.buffer_type = MYSQL_TYPE_STRING;
+                bind.buffer = slot.text.data();
+                bind.buffer_length = static_cast<unsigned long>(slot.text.size());
+                break;
+        }
+    };
+    for (size_t i = 0; i < fields.size(); ++i) {
+        kinds[i] = bindKindFor(fields[i]);
+        if (kinds[i] == BindKind::Text) {
+            slots[i].text.resize((std::min)(static_cast<size_t>(fields[i].length), INITIAL_TEXT_BYTES) + 1);
+        }
+        bindSlot(i);
+    }
+    if (mysql_stmt_bind_result(stmt.get(), binds.data())) [[unlikely]] {
+        fail(mysql_stmt_error(stmt.get()), mysql_stmt_errno(stmt.get()));
+    }
+
+    m_killed.store(false, std::memory_order_release);
+    const auto fetchStart = std::chrono::steady_clock::now();
+    int status = 0;
+    while ((status = mysql_stmt_fetch(stmt.get())) == 0 || status == MYSQL_DATA_TRUNCATED) {
+        bool rebind = false;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            auto& slot = slots[i];
+            auto& column = batch.columnData[i];
+            if (slot.isNull) {
+                column.appendNull();
+                continue;
+            }
+            switch (kinds[i]) {
+                case BindKind::Integer:
+                    column.appendInt64(slot.integer);
+                    break;
+                case BindKind::Float:
+                    column.appendDouble(slot.real);
+                    break;
+                case BindKind::Double:
+                    column.appendDouble(slot.doubleValue);
+                    break;
+                case BindKind::Temporal:
+                    appendTemporal(column, fields[i], slot.time);
+                    break;
+                case BindKind::Text: {
+                    if (slot.length > slot.text.size()) {
+                        // Longer than the buffer: fetch the whole value, and bind a buffer that fits from now on
+                        slot.text.resize(static_cast<size_t>(slot.length) + 1);
+                        MYSQL_BIND whole{};
+                        whole.buffer_type = MYSQL_TYPE_STRING;
+                        whole.buffer = slot.text.data();
+                        whole.buffer_length = static_cast<unsigned long>(slot.text.size());
+                        unsigned long length = 0;
+                        whole.length = &length;
+                        if (mysql_stmt_fetch_column(stmt.get(), &whole, static_cast<unsigned int>(i), 0) != 0) [[unlikely]] {
+                            fail(mysql_stmt_error(stmt.get()), mysql_stmt_errno(stmt.get()));
+                        }
+                        bindSlot(i);
+                        rebind = true;
+                    }
+                    appendMySqlText(column, fields[i], std::string_view(slot.text.data(), slot.length));
+                    break;
+                }
+            }
+        }
+        if (rebind && mysql_stmt_bind_result(stmt.get(), binds.data())) [[unlikely]] {
+            fail(mysql_stmt_error(stmt.get()), mysql_stmt_errno(stmt.get()));
+        }
+        if (batch.rowCount() >= batchRows) {
+            summary.totalRows += batch.rowCount();
+            if (!sink.onBatch(batch)) {
+                summary.stopped = true;
+                cancel();
+                break;
+            }
+            batch.clearRows();
+        }
+    }
+    if (status == 1 && !m_killed.load(std::memory_order_acquire)) [[unlikely]] {
+        fail(mysql_stmt_error(stmt.get()), mysql_stmt_errno(stmt.get()));
+    }
+    if (!summary.stopped && !batch.empty()) {
+        summary.totalRows += batch.rowCount();
+        summary.stopped = !sink.onBatch(batch);
+    }
+    // Reads off whatever is left of an unbuffered result so the connection is usable again
+    mysql_stmt_free_result(stmt.get());
+
+    const double fetchMs = elapsedMs(fetchStart);
+    summary.fetchStats.rowsetSize = 1;
+    summary.fetchStats.fetchTimeMs = fetchMs;
+    summary.fetchStats.rowsPerSecond = fetchMs > 0.0 ? static_cast<double>(summary.totalRows) * 1000.0 / fetchMs : 0.0;
+    return true;
+}
+
+void MySQLDriver::executeText(const std::string& sql, RowBatchSink& sink, size_t batchRows, StreamSummary& summary) {
+    const auto start = std::chrono::steady_clock::now();
+    m_killed.store(false, std::memory_order_release);
+    if (mysql_real_query(m_mysql, sql.c_str(), static_cast<unsigned long>(sql.size())) != 0) [[unlikely]] {
+        fail(mysql_error(m_mysql), mysql_errno(m_mysql));
+    }
+    summary.executionTimeMs = elapsedMs(start);
+
+    bool streamed = false;
+    double fetchMs = 0.0;
+    int next = 0;
+    do {
+        MYSQL_RES* result = mysql_use_result(m_mysql);
+        if (!result) {
+            if (mysql_field_count(m_mysql) != 0) [[unlikely]] {
+                fail(mysql_error(m_mysql), mysql_errno(m_mysql));
+            }
+            summary.affectedRows += static_cast<int64_t>(mysql_affected_rows(m_mysql));
+        } else if (streamed || summary.stopped) {
+            // Only the first result set is returned; read past the others
+            while (mysql_fetch_row(result)) {
+            }
+            mysql_free_result(result);
+        } else {
+            streamed = true;
+            const auto fetchStart = std::chrono::steady_clock::now();
+            const unsigned int count = mysql_num_fields(result);
+            const MYSQL_FIELD* described = mysql_fetch_fields(result);
+            std::vector<MySqlField> fields;
+            std::vector<std::string> names;
+            for (unsigned int i = 0; i < count; ++i) {
+                fields.push_back(fieldOf(described[i]));
+                names.emplace_back(described[i].name, described[i].name_length);
+            }
+            ResultSet batch;
+            summary.columns = describe(fields, names, batch);
+            sink.onColumns(summary.columns);
+
+            while (MYSQL_ROW row = mysql_fetch_row(result)) {
+                if (summary.stopped) {
+                    continue;
+                }
+                const unsigned long* lengths = mysql_fetch_lengths(result);
+                for (unsigned int i = 0; i < count; ++i) {
+                    if (!row[i]) {
+                        batch.columnData[i].appendNull();
+                    } else {
+                        appendMySqlText(batch.columnData[i], fields[i], std::string_view(row[i], lengths[i]));
+                    }
+                }
+                if (batch.rowCount() >= batchRows) {
+                    summary.totalRows += batch.rowCount();
+                    if (!sink.onBatch(batch)) {
+                        summary.stopped = true;
+                        cancel();
+                    }
+                    batch.clearRows();
+                }
+            }
+            const unsigned int code = mysql_errno(m_mysql);
+            if (code != 0 && !m_killed.load(std::memory_order_acquire)) [[unlikely]] {
+                std::string message = mysql_error(m_mysql);
+                mysql_free_result(result);
+                fail(std::move(message), code);
+            }
+            if (!summary.stopped && !batch.empty()) {
+                summary.totalRows += batch.rowCount();
+                summary.stopped = !sink.onBatch(batch);
+            }
+            mysql_free_result(result);
+            fetchMs = elapsedMs(fetchStart);
+        }
+        next = mysql_next_result(m_mysql);
+    } while (next == 0);
+    if (next > 0 && !m_killed.load(std::memory_order_acquire)) [[unlikely]] {
+        fail(mysql_error(m_mysql), mysql_errno(m_mysql));
+    }
+    if (!streamed) {
+        sink.onColumns(summary.columns);
+    }
+    summary.fetchStats.rowsetSize = 1;
+    summary.fetchStats.fetchTimeMs = fetchMs;
+    summary.fetchStats.rowsPerSecond = fetchMs > 0.0 ? static_cast<double>(summary.totalRows) * 1000.0 / fetchMs : 0.0;
+}
+
+StreamSummary MySQLDriver::executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows) {
+    std::scoped_lock lock(m_executeMutex);
+    if (!m_mysql) [[unlikely]] {
+        fail("Not connected to database", 0);
+    }
+    batchRows = (std::max)(batchRows, size_t{1});
+    const std::string query(sql);
+    StreamSummary summary;
+    if (!executePrepared(query, sink, batchRows, summary)) {
+        executeText(query, sink, batchRows, summary);
+    }
+    return summary;
+}
+
+ResultSet MySQLDriver::execute(std::string_view sql) {
+    ResultSet result;
+    CallbackBatchSink sink([&result](const ResultSet& batch) {
+        result.appendBatch(batch);
+        return true;
+    });
+    auto summary = executeStreaming(sql, sink);
+    result.columns = std::move(summary.columns);
+    result.affectedRows = summary.affectedRows;
+    result.executionTimeMs = summary.executionTimeMs;
+    result.fetchStats = summary.fetchStats;
+    return result;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "driver_interface.h"
+#include "mysql_wire.h"
+#include "result_set.h"
+
+#include <mysql.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// IDatabaseDriver for MySQL and MariaDB over the C client library (built when it is found; see MYSQL_ENABLED).
+///
+/// A query is first prepared: statements the server can prepare run over the binary protocol, so integers,
+/// floats and date/time values are fetched into typed binds and go straight into ColumnData. Rows are read
+/// unbuffered (no mysql_stmt_store_result), i.e. straight off the socket as the sink consumes batches, so a large
+/// result never sits in client memory. Anything the server will not prepare (multi-statement batches, some
+/// administrative commands) runs through mysql_real_query + mysql_use_result, which streams the same way but
+/// in text.
+///
+/// The protocol cannot cancel a query in flight on its own connection; cancel() and a sink that stops early
+/// send KILL QUERY for this session over a short-lived second connection.
+class MySQLDriver final : public IDatabaseDriver {
+public:
+    MySQLDriver() = default;
+    ~MySQLDriver() override;
+
+    MySQLDriver(const MySQLDriver&) = delete;
+    MySQLDriver& operator=(const MySQLDriver&) = delete;
+    MySQLDriver(MySQLDriver&&) = delete;
+    MySQLDriver& operator=(MySQLDriver&&) = delete;
+
+    // IDatabaseDriver interface
+    [[nodiscard]] bool connect(std::string_view connectionString) override;
+    void disconnect() override;
+    [[nodiscard]] bool isConnected() const noexcept override { return m_connected.load(std::memory_order_acquire); }
+    [[nodiscard]] ResultSet execute(std::string_view sql) override;
+    StreamSummary executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows = DEFAULT_STREAM_BATCH_ROWS) override;
+    void cancel() override;
+    [[nodiscard]] bool reconnect() override;
+    [[nodiscard]] std::string getLastError() const override;
+    [[nodiscard]] DriverType getType() const noexcept override { return DriverType::MySQL; }
+
+private:
+    /// Run `sql` as a prepared statement; false (nothing sent to the sink) if the server would not prepare it
+    [[nodiscard]] bool executePrepared(const std::string& sql, RowBatchSink& sink, size_t batchRows, StreamSummary& summary);
+    /// Run `sql` over the text protocol, streaming the first result set and counting the others' affected rows
+    void executeText(const std::string& sql, RowBatchSink& sink, size_t batchRows, StreamSummary& summary);
+    /// Columns and column storage for `fields`
+    [[nodiscard]] static std::vector<ColumnInfo> describe(const std::vector<MySqlField>& fields, const std::vector<std::string>& names, ResultSet& batch);
+    /// Record `message` and throw; ConnectionLostError when the server has gone away
+    [[noreturn]] void fail(std::string message, unsigned int errorCode);
+
+    std::mutex m_executeMutex;  ///< One query at a time per connection
+    MYSQL* m_mysql = nullptr;
+    std::string m_connectionString;
+    MySqlConnectParams m_params;  ///< Kept for the KILL QUERY connection
+    std::atomic<unsigned long> m_threadId{0};
+    std::atomic<bool> m_killed{false};  ///< KILL QUERY sent for the running query
+    mutable std::mutex m_errorMutex;
+    std::string m_lastError;
+    std::mutex m_paramsMutex;  ///< Guards m_params against cancel() from other threads
+    std::atomic<bool> m_connected{false};
+};
+
+}  // namespace velocitydb
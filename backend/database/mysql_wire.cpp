@@ -0,0 +1,142 @@
+#include "mysql_wire.h"
+
+#include "odbc_attributes.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] bool isStringType(uint32_t type) noexcept {
+    switch (type) {
+        case mysql_type::VARCHAR:
+        case mysql_type::VAR_STRING:
+        case mysql_type::STRING:
+        case mysql_type::TINY_BLOB:
+        case mysql_type::MEDIUM_BLOB:
+        case mysql_type::LONG_BLOB:
+        case mysql_type::BLOB:
+            return true;
+        default:
+            return false;
+    }
+}
+
+[[nodiscard]] uint8_t temporalDigits(uint32_t decimals) noexcept {
+    return static_cast<uint8_t>((std::min)(decimals, uint32_t{6}));
+}
+
+}  // namespace
+
+bool isMySqlBinary(const MySqlField& field) noexcept {
+    return field.type == mysql_type::GEOMETRY || (isStringType(field.type) && field.charset == mysql_type::BINARY_CHARSET);
+}
+
+MySqlColumnType mysqlColumnType(const MySqlField& field) noexcept {
+    const bool isUnsigned = (field.flags & mysql_type::UNSIGNED_FLAG) != 0;
+    switch (field.type) {
+        case mysql_type::TINY:
+            return {ColumnDataType::Int64, "tinyint"};
+        case mysql_type::SHORT:
+        case mysql_type::YEAR:
+            return {ColumnDataType::Int64, "smallint"};
+        case mysql_type::INT24:
+            return {ColumnDataType::Int64, "int"};
+        case mysql_type::LONG:
+            return {ColumnDataType::Int64, isUnsigned ? "bigint" : "int"};
+        case mysql_type::LONGLONG:
+            // BIGINT UNSIGNED does not fit in int64; keep its digits
+            return isUnsigned ? MySqlColumnType{ColumnDataType::Text, "decimal"} : MySqlColumnType{ColumnDataType::Int64, "bigint"};
+        case mysql_type::FLOAT:
+            return {ColumnDataType::Double, "real"};
+        case mysql_type::DOUBLE:
+            return {ColumnDataType::Double, "float"};
+        case mysql_type::DECIMAL:
+        case mysql_type::NEWDECIMAL:
+            return {ColumnDataType::Text, "decimal"};
+        case mysql_type::BIT:
+            return field.length == 1 ? MySqlColumnType{ColumnDataType::Bit, "bit"} : MySqlColumnType{ColumnDataType::Int64, "bigint"};
+        case mysql_type::DATE:
+        case mysql_type::NEWDATE:
+            return {ColumnDataType::Date, "date"};
+        case mysql_type::TIME:
+            return {ColumnDataType::Time, "time", temporalDigits(field.decimals)};
+        case mysql_type::DATETIME:
+        case mysql_type::TIMESTAMP:
+            return {ColumnDataType::Timestamp, "datetime2", temporalDigits(field.decimals)};
+        case mysql_type::JSON:
+            return {ColumnDataType::Text, "json"};
+        case mysql_type::ENUM:
+        case mysql_type::SET:
+        case mysql_type::VARCHAR:
+        case mysql_type::VAR_STRING:
+            return {ColumnDataType::Text, field.charset == mysql_type::BINARY_CHARSET ? "varbinary" : "varchar"};
+        case mysql_type::STRING:
+            return {ColumnDataType::Text, field.charset == mysql_type::BINARY_CHARSET ? "binary" : "char"};
+        case mysql_type::TINY_BLOB:
+        case mysql_type::MEDIUM_BLOB:
+        case mysql_type::LONG_BLOB:
+        case mysql_type::BLOB:
+            return {ColumnDataType::Text, field.charset == mysql_type::BINARY_CHARSET ? "varbinary" : "text"};
+        case mysql_type::GEOMETRY:
+            return {ColumnDataType::Text, "geometry"};
+        default:
+            return {ColumnDataType::Text, "sql_variant"};
+    }
+}
+
+void appendMySqlText(ColumnData& column, const MySqlField& field, std::string_view value) {
+    if (field.type == mysql_type::BIT) {
+        uint64_t bits = 0;
+        for (unsigned char byte : value) {
+            bits = (bits << 8) | byte;
+        }
+        if (column.type() == ColumnDataType::Bit) {
+            column.appendBit(bits != 0);
+        } else if (column.type() == ColumnDataType::Int64) {
+            column.appendInt64(static_cast<int64_t>(bits));
+        } else {
+            column.appendText(std::to_string(bits));
+        }
+        return;
+    }
+    if (isMySqlBinary(field)) {
+        static constexpr char DIGITS[] = "0123456789ABCDEF";
+        std::string hex = "0x";
+        hex.reserve(2 + value.size() * 2);
+        for (unsigned char byte : value) {
+            hex += DIGITS[byte >> 4];
+            hex += DIGITS[byte & 0xF];
+        }
+        column.appendText(hex);
+        return;
+    }
+    column.appendFromText(value);
+}
+
+MySqlConnectParams mysqlConnectParams(std::string_view connectionString) {
+    MySqlConnectParams params;
+    for (const auto& [key, value] : parseOdbcAttributes(connectionString)) {
+        if (odbcKeyIs(key, {"Server", "Host"})) {
+            if (!value.empty()) {
+                params.host = value;
+            }
+        } else if (odbcKeyIs(key, {"Port"})) {
+            unsigned int port = 0;
+            if (std::from_chars(value.data(), value.data() + value.size(), port).ec == std::errc{} && port > 0 && port <= 65535) {
+                params.port = port;
+            }
+        } else if (odbcKeyIs(key, {"Database"})) {
+            params.database = value;
+        } else if (odbcKeyIs(key, {"Uid", "User", "Username"})) {
+            params.user = value;
+        } else if (odbcKeyIs(key, {"Pwd", "Password"})) {
+            params.password = value;
+        }
+    }
+    return params;
+}
+
+}  // namespace velocitydb
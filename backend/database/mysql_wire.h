@@ -0,0 +1,86 @@
+#pragma once
+
+#include "result_set.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// MySQL column type codes (enum_field_types) and field flags, as found in MYSQL_FIELD
+namespace mysql_type {
+inline constexpr uint32_t DECIMAL = 0;
+inline constexpr uint32_t TINY = 1;
+inline constexpr uint32_t SHORT = 2;
+inline constexpr uint32_t LONG = 3;
+inline constexpr uint32_t FLOAT = 4;
+inline constexpr uint32_t DOUBLE = 5;
+inline constexpr uint32_t NULL_TYPE = 6;
+inline constexpr uint32_t TIMESTAMP = 7;
+inline constexpr uint32_t LONGLONG = 8;
+inline constexpr uint32_t INT24 = 9;
+inline constexpr uint32_t DATE = 10;
+inline constexpr uint32_t TIME = 11;
+inline constexpr uint32_t DATETIME = 12;
+inline constexpr uint32_t YEAR = 13;
+inline constexpr uint32_t NEWDATE = 14;
+inline constexpr uint32_t VARCHAR = 15;
+inline constexpr uint32_t BIT = 16;
+inline constexpr uint32_t JSON = 245;
+inline constexpr uint32_t NEWDECIMAL = 246;
+inline constexpr uint32_t ENUM = 247;
+inline constexpr uint32_t SET = 248;
+inline constexpr uint32_t TINY_BLOB = 249;
+inline constexpr uint32_t MEDIUM_BLOB = 250;
+inline constexpr uint32_t LONG_BLOB = 251;
+inline constexpr uint32_t BLOB = 252;
+inline constexpr uint32_t VAR_STRING = 253;
+inline constexpr uint32_t STRING = 254;
+inline constexpr uint32_t GEOMETRY = 255;
+
+inline constexpr uint32_t UNSIGNED_FLAG = 32;
+inline constexpr uint32_t BINARY_CHARSET = 63;  ///< charsetnr of BINARY, VARBINARY and BLOB columns
+}  // namespace mysql_type
+
+/// What the driver needs to know about one result column (the MYSQL_FIELD members it reads)
+struct MySqlField {
+    uint32_t type = mysql_type::VAR_STRING;
+    uint32_t flags = 0;
+    uint32_t charset = 0;
+    uint32_t decimals = 0;
+    uint64_t length = 0;
+};
+
+/// How a MySQL column is stored and what it is called. Names are those of the SQL Server equivalent
+/// (DATETIME is "datetime2", VARBINARY stays "varbinary", ...) so exporters and the grid treat every server alike.
+struct MySqlColumnType {
+    ColumnDataType storage = ColumnDataType::Text;
+    std::string_view name;
+    uint8_t fractionDigits = 0;
+};
+
+[[nodiscard]] MySqlColumnType mysqlColumnType(const MySqlField& field) noexcept;
+
+/// The column is fetched as bytes and shown as 0x... hex (binary strings, BLOBs, GEOMETRY)
+[[nodiscard]] bool isMySqlBinary(const MySqlField& field) noexcept;
+
+/// Append one value as the server sends it in text-protocol rows (and as the binary protocol returns strings):
+/// numbers and dates as text, BIT as big-endian bytes, binary strings as raw bytes. Zero dates
+/// ("0000-00-00") and TIME values beyond 24 hours keep their text.
+void appendMySqlText(ColumnData& column, const MySqlField& field, std::string_view value);
+
+/// Host, port and credentials for mysql_real_connect
+struct MySqlConnectParams {
+    std::string host = "localhost";
+    unsigned int port = 3306;
+    std::string user;
+    std::string password;
+    std::string database;
+};
+
+/// Connection parameters from the ODBC-style string built by buildODBCConnectionString
+/// (Server=...;Port=...;Database=...;Uid=...;Pwd=...) or the same keys without a Driver attribute
+[[nodiscard]] MySqlConnectParams mysqlConnectParams(std::string_view connectionString);
+
+}  // namespace velocitydb
@@ -0,0 +1,61 @@
+#include "odbc_attributes.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace velocitydb {
+
+std::vector<OdbcAttribute> parseOdbcAttributes(std::string_view connectionString) {
+    std::vector<OdbcAttribute> attributes;
+    size_t pos = 0;
+    while (pos < connectionString.size()) {
+        const auto equals = connectionString.find('=', pos);
+        if (equals == std::string_view::npos) {
+            break;
+        }
+        auto key = connectionString.substr(pos, equals - pos);
+        while (!key.empty() && std::isspace(static_cast<unsigned char>(key.front()))) {
+            key.remove_prefix(1);
+        }
+        std::string value;
+        pos = equals + 1;
+        if (pos < connectionString.size() && connectionString[pos] == '{') {
+            // Braced value; }} stands for }
+            for (++pos; pos < connectionString.size(); ++pos) {
+                if (connectionString[pos] == '}') {
+                    if (pos + 1 < connectionString.size() && connectionString[pos + 1] == '}') {
+                        value += '}';
+                        ++pos;
+                        continue;
+                    }
+                    ++pos;
+                    break;
+                }
+                value += connectionString[pos];
+            }
+            pos = connectionString.find(';', pos);
+        } else {
+            const auto end = connectionString.find(';', pos);
+            value = std::string(connectionString.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos));
+            pos = end;
+        }
+        attributes.push_back({std::string(key), std::move(value)});
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        ++pos;
+    }
+    return attributes;
+}
+
+bool odbcKeyIs(std::string_view key, std::initializer_list<std::string_view> names) noexcept {
+    return std::ranges::any_of(names, [key](std::string_view name) {
+        return std::ranges::equal(key, name, [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+    });
+}
+
+bool isOdbcConnectionString(const std::vector<OdbcAttribute>& attributes) noexcept {
+    return std::ranges::any_of(attributes, [](const OdbcAttribute& attribute) { return odbcKeyIs(attribute.key, {"Driver", "Server"}); });
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+struct OdbcAttribute {
+    std::string key;
+    std::string value;  ///< Braces removed and `}}` unescaped
+};
+
+/// Split an ODBC connection string ("Key=value;Key={braced;value};...") into its attributes, in order
+[[nodiscard]] std::vector<OdbcAttribute> parseOdbcAttributes(std::string_view connectionString);
+
+/// `key` equals one of `names`, ignoring case (ODBC keywords are case-insensitive)
+[[nodiscard]] bool odbcKeyIs(std::string_view key, std::initializer_list<std::string_view> names) noexcept;
+
+/// The string came from buildODBCConnectionString (it has a Driver= or Server= attribute) rather than being in
+/// a native client's own syntax
+[[nodiscard]] bool isOdbcConnectionString(const std::vector<OdbcAttribute>& attributes) noexcept;
+
+}  // namespace velocitydb
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../utils/encoding.h"
+#include "../utils/utf16_transcode.h"
 
 #include <sql.h>
 
@@ -11,6 +12,7 @@
 namespace velocitydb {
 
 static_assert(sizeof(SQLWCHAR) == sizeof(wchar_t), "SQLWCHAR and wchar_t must have the same size");
+static_assert(sizeof(SQLWCHAR) == sizeof(char16_t), "SQLWCHAR must be a UTF-16 code unit");
 
 inline SQLWCHAR* toSqlWchar(wchar_t* p) {
     return reinterpret_cast<SQLWCHAR*>(p);
@@ -19,9 +21,22 @@ inline const wchar_t* toWchar(const SQLWCHAR* p) {
     return reinterpret_cast<const wchar_t*>(p);
 }
 
+// SQLWCHAR buffer of `len` code units as UTF-16 text (the length comes from the indicator, not a NUL scan)
+inline std::u16string_view toUtf16(const SQLWCHAR* buf, size_t len) {
+    return buf == nullptr ? std::u16string_view{} : std::u16string_view(reinterpret_cast<const char16_t*>(buf), len);
+}
+
 // SQLWCHAR buffer → UTF-8 string (convenience wrapper)
 inline std::string sqlWcharToUtf8(const SQLWCHAR* buf, size_t len) {
-    return wideToUtf8(toWchar(buf), len);
+    std::string out;
+    appendUtf16AsUtf8(out, toUtf16(buf, len));
+    return out;
+}
+
+// SQLWCHAR buffer → UTF-8 into a reusable output string (no allocation once capacity is reached)
+inline void sqlWcharToUtf8(const SQLWCHAR* buf, size_t len, std::string& out) {
+    out.clear();
+    appendUtf16AsUtf8(out, toUtf16(buf, len));
 }
 
 // UTF-8 string → std::wstring, ready for ODBC W APIs via toSqlWchar(result.data())
@@ -0,0 +1,97 @@
+#include "paged_result_spill.h"
+
+#include "../parsers/sql_parser.h"
+#include "../utils/logger.h"
+#include "plan_estimate.h"
+
+#include <format>
+#include <utility>
+
+namespace velocitydb {
+
+PagedResultSpill::PagedResultSpill(ResultCache& cache, size_t maxRows) : m_cache(cache), m_maxRows(maxRows) {}
+
+PagedResultSpill::Outcome PagedResultSpill::fetch(std::string_view connectionId, IDatabaseDriver& driver, const std::string& sql) {
+    auto key = ResultCache::makeKey(connectionId, sql);
+    if (auto cached = m_cache.get(key)) {
+        return {.rows = std::move(cached), .complete = true};
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_unspillable.contains(key)) {
+            return {};
+        }
+    }
+
+    // Compiling the plan costs a fraction of streaming rows that would only be dropped
+    Outcome outcome;
+    outcome.estimatedRows = estimate(key, driver, sql);
+    if (outcome.estimatedRows && static_cast<uint64_t>(*outcome.estimatedRows) > m_maxRows) {
+        log<LogLevel::DEBUG>(std::format("Paged result estimated at {} rows; paging on the server", *outcome.estimatedRows));
+        remember(std::move(key));
+        return outcome;
+    }
+
+    // Half the cache budget at most, so one big grid cannot flush everything else
+    const size_t maxBytes = m_cache.getMaxSize() / 2;
+    auto spill = std::make_shared<ResultSet>();
+    bool oversized = false;
+    CallbackBatchSink sink([&](const ResultSet& batch) {
+        spill->appendBatch(batch);
+        if (spill->rowCount() > m_maxRows || spill->memoryBytes() > maxBytes) {
+            oversized = true;
+            return false;
+        }
+        return true;
+    });
+    auto summary = driver.executeStreaming(sql, sink);
+
+    spill->columns = std::move(summary.columns);
+    spill->affectedRows = summary.affectedRows;
+    spill->executionTimeMs = summary.executionTimeMs;
+    spill->fetchStats = summary.fetchStats;
+    spill->messages = std::move(summary.messages);
+    outcome.rows = spill;
+    if (oversized) {
+        log<LogLevel::DEBUG>(std::format("Paged result too large to materialize ({}+ rows); later pages use OFFSET/FETCH", spill->rowCount()));
+        remember(std::move(key));
+        return outcome;
+    }
+
+    // Cached like any other result, so writes to the tables it read drop it
+    m_cache.put(key, std::move(spill), ResultCache::EntryOptions{.tables = SQLParser::extractTableReferences(sql)});
+    outcome.complete = true;
+    return outcome;
+}
+
+bool PagedResultSpill::isUnspillable(std::string_view connectionId, std::string_view sql) const {
+    const auto key = ResultCache::makeKey(connectionId, sql);
+    std::lock_guard lock(m_mutex);
+    return m_unspillable.contains(key);
+}
+
+void PagedResultSpill::remember(std::string key) {
+    std::lock_guard lock(m_mutex);
+    if (m_unspillable.size() >= MAX_REMEMBERED) {
+        m_unspillable.clear();
+    }
+    m_unspillable.insert(std::move(key));
+}
+
+std::optional<int64_t> PagedResultSpill::estimate(const std::string& key, IDatabaseDriver& driver, std::string_view sql) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto found = m_estimates.find(key); found != m_estimates.end()) {
+            return found->second;
+        }
+    }
+    auto estimated = estimateRowCount(driver, sql);
+    std::lock_guard lock(m_mutex);
+    if (m_estimates.size() >= MAX_REMEMBERED) {
+        m_estimates.clear();
+    }
+    m_estimates.insert_or_assign(key, estimated);
+    return estimated;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "driver_interface.h"
+#include "result_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace velocitydb {
+
+/// Read-only grid results materialized once into the ResultCache, so every page, filter and aggregate is served
+/// from the same fetch instead of re-running OFFSET/FETCH.
+///
+/// A result is materialized only while it stays under the row limit and half the cache budget. Before fetching,
+/// the optimizer's estimate (estimateRowCount, taken once per query and remembered) screens out results that would
+/// obviously exceed the limit; when the estimate was wrong, the fetch stops at the limit and hands back the rows it got, so the caller still serves the
+/// pages they cover. Either way the query is remembered as unspillable and later requests go straight to the server.
+class PagedResultSpill {
+public:
+    static constexpr size_t MAX_ROWS = 500000;
+    static constexpr size_t MAX_REMEMBERED = 256;
+
+    struct Outcome {
+        /// Every row when `complete`; otherwise the rows fetched before the limit was hit (nullptr when nothing was fetched)
+        std::shared_ptr<const ResultSet> rows;
+        bool complete = false;
+        std::optional<int64_t> estimatedRows;  ///< The plan estimate, when the fetch needed one and the server gave it
+    };
+
+    explicit PagedResultSpill(ResultCache& cache, size_t maxRows = MAX_ROWS);
+
+    /// `sql`'s result for `connectionId`: from the cache, or fetched on `driver` and cached now
+    /// @throws whatever the driver throws while fetching
+    [[nodiscard]] Outcome fetch(std::string_view connectionId, IDatabaseDriver& driver, const std::string& sql);
+
+    /// Whether `sql` is known to be too large and is paged on the server
+    [[nodiscard]] bool isUnspillable(std::string_view connectionId, std::string_view sql) const;
+
+private:
+    void remember(std::string key);
+    /// estimateRowCount for `sql`, from the memo when this query was estimated before
+    [[nodiscard]] std::optional<int64_t> estimate(const std::string& key, IDatabaseDriver& driver, std::string_view sql);
+
+    ResultCache& m_cache;
+    size_t m_maxRows;
+    mutable std::mutex m_mutex;
+    std::unordered_set<std::string> m_unspillable;                        // guarded by m_mutex
+    std::unordered_map<std::string, std::optional<int64_t>> m_estimates;  // guarded by m_mutex; failed estimates too
+};
+
+}  // namespace velocitydb
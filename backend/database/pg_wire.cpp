@@ -0,0 +1,446 @@
+#include "pg_wire.h"
+
+#include "../utils/civil_date.h"
+#include "odbc_attributes.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <limits>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr int64_t MICROS_PER_DAY = int64_t{86400} * 1000000;
+constexpr int64_t UNIX_DAYS_AT_PG_EPOCH = 10957;  ///< 2000-01-01, PostgreSQL's date/time epoch
+
+template <typename T>
+[[nodiscard]] T readBigEndian(const char* data) noexcept {
+    using Unsigned = std::make_unsigned_t<T>;
+    Unsigned value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    if constexpr (std::endian::native == std::endian::little && sizeof(T) > 1) {
+        value = std::byteswap(value);
+    }
+    return static_cast<T>(value);
+}
+
+void timeFromMicros(int64_t micros, DateTimeValue& out) noexcept {
+    out.hour = static_cast<uint8_t>(micros / 3600000000);
+    out.minute = static_cast<uint8_t>(micros / 60000000 % 60);
+    out.second = static_cast<uint8_t>(micros / 1000000 % 60);
+    out.fraction = static_cast<uint32_t>(micros % 1000000 * 1000);
+}
+
+void appendHex(std::string& out, std::string_view bytes) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    for (unsigned char c : bytes) {
+        out += DIGITS[c >> 4];
+        out += DIGITS[c & 0xF];
+    }
+}
+
+[[nodiscard]] std::string byteaText(std::string_view bytes) {
+    std::string text = "\\x";
+    text.reserve(2 + bytes.size() * 2);
+    appendHex(text, bytes);
+    return text;
+}
+
+/// NUMERIC in binary format: ndigits, weight, sign, dscale, then base-10000 digits
+[[nodiscard]] std::string numericText(std::string_view value) {
+    if (value.size() < 8) [[unlikely]] {
+        return byteaText(value);
+    }
+    const auto digitCount = readBigEndian<int16_t>(value.data());
+    const auto weight = readBigEndian<int16_t>(value.data() + 2);
+    const auto sign = readBigEndian<uint16_t>(value.data() + 4);
+    const auto scale = readBigEndian<int16_t>(value.data() + 6);
+    if (digitCount < 0 || value.size() < 8 + static_cast<size_t>(digitCount) * 2) [[unlikely]] {
+        return byteaText(value);
+    }
+    switch (sign) {
+        case 0xC000:
+            return "NaN";
+        case 0xD000:
+            return "Infinity";
+        case 0xF000:
+            return "-Infinity";
+        default:
+            break;
+    }
+    const auto digit = [&](int index) { return index >= 0 && index < digitCount ? readBigEndian<int16_t>(value.data() + 8 + index * 2) : int16_t{0}; };
+
+    std::string text = sign == 0x4000 ? "-" : "";
+    if (weight < 0) {
+        text += '0';
+    } else {
+        text += std::to_string(digit(0));
+        for (int index = 1; index <= weight; ++index) {
+            text += std::format("{:04}", digit(index));
+        }
+    }
+    if (scale > 0) {
+        text += '.';
+        int written = 0;
+        for (int index = weight + 1; written < scale; ++index) {
+            const auto group = std::format("{:04}", digit(index));
+            const int take = (std::min)(4, scale - written);
+            text.append(group, 0, static_cast<size_t>(take));
+            written += take;
+        }
+    }
+    return text;
+}
+
+/// INTERVAL in binary format: microseconds, days, months; written like PostgreSQL's default style
+[[nodiscard]] std::string intervalText(std::string_view value) {
+    if (value.size() != 16) [[unlikely]] {
+        return byteaText(value);
+    }
+    int64_t micros = readBigEndian<int64_t>(value.data());
+    const auto days = readBigEndian<int32_t>(value.data() + 8);
+    const auto months = readBigEndian<int32_t>(value.data() + 12);
+    std::string text;
+    const auto part = [&](int64_t count, std::string_view unit) {
+        if (count != 0) {
+            text += std::format("{}{} {}{}", text.empty() ? "" : " ", count, unit, count == 1 || count == -1 ? "" : "s");
+        }
+    };
+    part(months / 12, "year");
+    part(months % 12, "mon");
+    part(days, "day");
+    if (micros != 0 || text.empty()) {
+        const bool negative = micros < 0;
+        micros = negative ? -micros : micros;
+        text += std::format("{}{}{:02}:{:02}:{:02}", text.empty() ? "" : " ", negative ? "-" : "", micros / 3600000000, micros / 60000000 % 60, micros / 1000000 % 60);
+        if (micros % 1000000 != 0) {
+            auto fraction = std::format("{:06}", micros % 1000000);
+            fraction.erase(fraction.find_last_not_of('0') + 1);
+            text += '.' + fraction;
+        }
+    }
+    return text;
+}
+
+[[nodiscard]] std::string uuidText(std::string_view value) {
+    std::string text;
+    text.reserve(36);
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            text += '-';
+        }
+        appendHex(text, value.substr(i, 1));
+    }
+    return text;
+}
+
+/// libpq keyword/value quoting: single quotes, with \ and ' backslash-escaped
+void appendConninfoValue(std::string& out, std::string_view keyword, std::string_view value) {
+    if (!out.empty()) {
+        out += ' ';
+    }
+    out += keyword;
+    out += "='";
+    for (char c : value) {
+        if (c == '\\' || c == '\'') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '\'';
+}
+
+}  // namespace
+
+PgColumnType pgColumnType(uint32_t oid) noexcept {
+    switch (oid) {
+        case pg_oid::BOOL:
+            return {ColumnDataType::Bit, "bit"};
+        case pg_oid::INT2:
+            return {ColumnDataType::Int64, "smallint"};
+        case pg_oid::INT4:
+            return {ColumnDataType::Int64, "int"};
+        case pg_oid::INT8:
+        case pg_oid::OID:
+            return {ColumnDataType::Int64, "bigint"};
+        case pg_oid::FLOAT4:
+            return {ColumnDataType::Double, "real"};
+        case pg_oid::FLOAT8:
+            return {ColumnDataType::Double, "float"};
+        case pg_oid::NUMERIC:
+            return {ColumnDataType::Text, "numeric"};
+        case pg_oid::MONEY:
+            return {ColumnDataType::Text, "money"};
+        case pg_oid::DATE:
+            return {ColumnDataType::Date, "date"};
+        case pg_oid::TIME:
+            return {ColumnDataType::Time, "time", 6};
+        case pg_oid::TIMESTAMP:
+            return {ColumnDataType::Timestamp, "datetime2", 6};
+        case pg_oid::TIMESTAMPTZ:
+            return {ColumnDataType::Timestamp, "datetimeoffset", 6};
+        case pg_oid::CHAR:
+        case pg_oid::BPCHAR:
+            return {ColumnDataType::Text, "char"};
+        case pg_oid::VARCHAR:
+            return {ColumnDataType::Text, "varchar"};
+        case pg_oid::NAME:
+            return {ColumnDataType::Text, "sysname"};
+        case pg_oid::TEXT:
+            return {ColumnDataType::Text, "text"};
+        case pg_oid::JSON:
+        case pg_oid::JSONB:
+            return {ColumnDataType::Text, "json"};
+        case pg_oid::XML:
+            return {ColumnDataType::Text, "xml"};
+        case pg_oid::UUID:
+            return {ColumnDataType::Text, "uniqueidentifier"};
+        case pg_oid::BYTEA:
+            return {ColumnDataType::Text, "varbinary"};
+        case pg_oid::INTERVAL:
+            return {ColumnDataType::Text, "interval"};
+        default:
+            return {ColumnDataType::Text, "sql_variant"};
+    }
+}
+
+void appendPgBinary(ColumnData& column, uint32_t oid, std::string_view value) {
+    if (const auto type = pgColumnType(oid); column.type() != type.storage) [[unlikely]] {
+        // The column already fell back to text (an infinite date, say): decode, then append the display text
+        ColumnData typed(type.storage, type.fractionDigits);
+        appendPgBinary(typed, oid, value);
+        std::string text;
+        typed.appendDisplayText(text, 0);
+        column.appendText(text);
+        return;
+    }
+    const char* data = value.data();
+    switch (oid) {
+        case pg_oid::BOOL:
+            if (value.size() == 1) {
+                column.appendBit(data[0] != 0);
+                return;
+            }
+            break;
+        case pg_oid::INT2:
+            if (value.size() == 2) {
+                column.appendInt64(readBigEndian<int16_t>(data));
+                return;
+            }
+            break;
+        case pg_oid::INT4:
+            if (value.size() == 4) {
+                column.appendInt64(readBigEndian<int32_t>(data));
+                return;
+            }
+            break;
+        case pg_oid::OID:
+            if (value.size() == 4) {
+                column.appendInt64(readBigEndian<uint32_t>(data));
+                return;
+            }
+            break;
+        case pg_oid::INT8:
+            if (value.size() == 8) {
+                column.appendInt64(readBigEndian<int64_t>(data));
+                return;
+            }
+            break;
+        case pg_oid::FLOAT4:
+            if (value.size() == 4) {
+                column.appendDouble(std::bit_cast<float>(readBigEndian<uint32_t>(data)));
+                return;
+            }
+            break;
+        case pg_oid::FLOAT8:
+            if (value.size() == 8) {
+                column.appendDouble(std::bit_cast<double>(readBigEndian<uint64_t>(data)));
+                return;
+            }
+            break;
+        case pg_oid::NUMERIC:
+            column.appendText(numericText(value));
+            return;
+        case pg_oid::MONEY:
+            if (value.size() == 8) {
+                // Cents, assuming the usual two fraction digits of lc_monetary
+                const auto cents = readBigEndian<int64_t>(data);
+                const auto magnitude = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+                column.appendText(std::format("{}{}.{:02}", cents < 0 ? "-" : "", magnitude / 100, magnitude % 100));
+                return;
+            }
+            break;
+        case pg_oid::DATE:
+            if (value.size() == 4) {
+                const auto days = readBigEndian<int32_t>(data);
+                if (days == (std::numeric_limits<int32_t>::max)() || days == (std::numeric_limits<int32_t>::min)()) [[unlikely]] {
+                    column.appendText(days > 0 ? "infinity" : "-infinity");
+                    return;
+                }
+                DateTimeValue date;
+                civilFromDays(days + UNIX_DAYS_AT_PG_EPOCH, date);
+                column.appendDateTime(date);
+                return;
+            }
+            break;
+        case pg_oid::TIME:
+            if (value.size() == 8) {
+                DateTimeValue time;
+                timeFromMicros(readBigEndian<int64_t>(data), time);
+                column.appendDateTime(time);
+                return;
+            }
+            break;
+        case pg_oid::TIMESTAMP:
+        case pg_oid::TIMESTAMPTZ:
+            if (value.size() == 8) {
+                const auto micros = readBigEndian<int64_t>(data);
+                if (micros == (std::numeric_limits<int64_t>::max)() || micros == (std::numeric_limits<int64_t>::min)()) [[unlikely]] {
+                    column.appendText(micros > 0 ? "infinity" : "-infinity");
+                    return;
+                }
+                const int64_t days = micros >= 0 ? micros / MICROS_PER_DAY : (micros - MICROS_PER_DAY + 1) / MICROS_PER_DAY;
+                DateTimeValue timestamp;
+                civilFromDays(days + UNIX_DAYS_AT_PG_EPOCH, timestamp);
+                timeFromMicros(micros - days * MICROS_PER_DAY, timestamp);
+                column.appendDateTime(timestamp);
+                return;
+            }
+            break;
+        case pg_oid::UUID:
+            if (value.size() == 16) {
+                column.appendText(uuidText(value));
+                return;
+            }
+            break;
+        case pg_oid::INTERVAL:
+            column.appendText(intervalText(value));
+            return;
+        case pg_oid::JSONB:
+            // Version byte (1), then the JSON text
+            if (!value.empty() && value.front() == 1) {
+                column.appendText(value.substr(1));
+                return;
+            }
+            break;
+        case pg_oid::CHAR:
+        case pg_oid::BPCHAR:
+        case pg_oid::VARCHAR:
+        case pg_oid::NAME:
+        case pg_oid::TEXT:
+        case pg_oid::JSON:
+        case pg_oid::XML:
+            column.appendText(value);
+            return;
+        default:
+            break;
+    }
+    column.appendText(byteaText(value));
+}
+
+void appendPgText(ColumnData& column, uint32_t oid, std::string_view value) {
+    if (oid == pg_oid::BOOL && column.type() == ColumnDataType::Bit && (value == "t" || value == "f")) {
+        column.appendBit(value == "t");
+        return;
+    }
+    column.appendFromText(value);
+}
+
+bool PgCopyBinaryParser::feed(std::string_view data, ResultSet& batch) {
+    static constexpr std::string_view SIGNATURE("PGCOPY\n\xff\r\n\0", 11);
+    m_pending += data;
+    std::string_view input(m_pending);
+    size_t consumed = 0;
+
+    if (!m_headerDone) {
+        if (input.size() < SIGNATURE.size() + 8) {
+            return true;
+        }
+        if (input.substr(0, SIGNATURE.size()) != SIGNATURE) [[unlikely]] {
+            return false;
+        }
+        const auto extension = readBigEndian<uint32_t>(input.data() + SIGNATURE.size() + 4);
+        if (input.size() < SIGNATURE.size() + 8 + extension) {
+            return true;
+        }
+        consumed = SIGNATURE.size() + 8 + extension;
+        m_headerDone = true;
+    }
+
+    while (!m_finished && input.size() - consumed >= 2) {
+        const char* tuple = input.data() + consumed;
+        const auto fields = readBigEndian<int16_t>(tuple);
+        if (fields == -1) {
+            m_finished = true;
+            consumed += 2;
+            break;
+        }
+        if (static_cast<size_t>(fields) != m_oids.size() || batch.columnData.size() != m_oids.size()) [[unlikely]] {
+            return false;
+        }
+        // Measure the whole tuple first so a partial one is left for the next chunk
+        size_t offset = 2;
+        bool complete = true;
+        for (int16_t field = 0; field < fields; ++field) {
+            if (input.size() - consumed < offset + 4) {
+                complete = false;
+                break;
+            }
+            const auto length = readBigEndian<int32_t>(tuple + offset);
+            offset += 4 + (length > 0 ? static_cast<size_t>(length) : 0);
+            if (input.size() - consumed < offset) {
+                complete = false;
+                break;
+            }
+        }
+        if (!complete) {
+            break;
+        }
+        offset = 2;
+        for (size_t field = 0; field < m_oids.size(); ++field) {
+            const auto length = readBigEndian<int32_t>(tuple + offset);
+            offset += 4;
+            if (length < 0) {
+                batch.columnData[field].appendNull();
+                continue;
+            }
+            appendPgBinary(batch.columnData[field], m_oids[field], std::string_view(tuple + offset, static_cast<size_t>(length)));
+            offset += static_cast<size_t>(length);
+        }
+        consumed += offset;
+    }
+    m_pending.erase(0, consumed);
+    return true;
+}
+
+std::string pgConninfo(std::string_view connectionString) {
+    const auto attributes = parseOdbcAttributes(connectionString);
+    if (!isOdbcConnectionString(attributes)) {
+        return std::string(connectionString);
+    }
+
+    std::string conninfo;
+    for (const auto& [key, value] : attributes) {
+        if (odbcKeyIs(key, {"Server", "Host"})) {
+            appendConninfoValue(conninfo, "host", value);
+        } else if (odbcKeyIs(key, {"Port"})) {
+            appendConninfoValue(conninfo, "port", value);
+        } else if (odbcKeyIs(key, {"Database"})) {
+            if (!value.empty()) {
+                appendConninfoValue(conninfo, "dbname", value);
+            }
+        } else if (odbcKeyIs(key, {"Uid", "User", "Username"})) {
+            appendConninfoValue(conninfo, "user", value);
+        } else if (odbcKeyIs(key, {"Pwd", "Password"})) {
+            appendConninfoValue(conninfo, "password", value);
+        } else if (odbcKeyIs(key, {"SSLMode"})) {
+            appendConninfoValue(conninfo, "sslmode", value);
+        }
+    }
+    return conninfo;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "result_set.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Type OIDs (pg_type.oid) of the built-in PostgreSQL types the decoder knows
+namespace pg_oid {
+inline constexpr uint32_t BOOL = 16;
+inline constexpr uint32_t BYTEA = 17;
+inline constexpr uint32_t CHAR = 18;
+inline constexpr uint32_t NAME = 19;
+inline constexpr uint32_t INT8 = 20;
+inline constexpr uint32_t INT2 = 21;
+inline constexpr uint32_t INT4 = 23;
+inline constexpr uint32_t TEXT = 25;
+inline constexpr uint32_t OID = 26;
+inline constexpr uint32_t JSON = 114;
+inline constexpr uint32_t XML = 142;
+inline constexpr uint32_t FLOAT4 = 700;
+inline constexpr uint32_t FLOAT8 = 701;
+inline constexpr uint32_t MONEY = 790;
+inline constexpr uint32_t BPCHAR = 1042;
+inline constexpr uint32_t VARCHAR = 1043;
+inline constexpr uint32_t DATE = 1082;
+inline constexpr uint32_t TIME = 1083;
+inline constexpr uint32_t TIMESTAMP = 1114;
+inline constexpr uint32_t TIMESTAMPTZ = 1184;
+inline constexpr uint32_t INTERVAL = 1186;
+inline constexpr uint32_t NUMERIC = 1700;
+inline constexpr uint32_t UUID = 2950;
+inline constexpr uint32_t JSONB = 3802;
+}  // namespace pg_oid
+
+/// How a PostgreSQL column is stored and what it is called. Names are those of the SQL Server equivalent
+/// (int4 is "int", timestamp is "datetime2", ...) so exporters and the grid treat both servers' columns alike.
+struct PgColumnType {
+    ColumnDataType storage = ColumnDataType::Text;
+    std::string_view name;
+    uint8_t fractionDigits = 0;
+};
+
+[[nodiscard]] PgColumnType pgColumnType(uint32_t oid) noexcept;
+
+/// Append one value in binary transfer format (as sent for result format 1 and by COPY BINARY). NUMERIC and
+/// MONEY keep their exact digits as text, timestamptz is shown in UTC, and types without a decoder are shown
+/// as their raw bytes in hex (`\x...`, like bytea).
+void appendPgBinary(ColumnData& column, uint32_t oid, std::string_view value);
+
+/// Append one value in text transfer format (simple-protocol results)
+void appendPgText(ColumnData& column, uint32_t oid, std::string_view value);
+
+/// Incremental decoder of `COPY ... TO STDOUT (FORMAT binary)` output. Data may arrive split anywhere; each
+/// complete tuple is appended to the batch.
+class PgCopyBinaryParser {
+public:
+    explicit PgCopyBinaryParser(std::vector<uint32_t> oids) : m_oids(std::move(oids)) {}
+
+    /// Decode `data` into `batch` (whose columnData must match the OIDs). Returns false on malformed input.
+    [[nodiscard]] bool feed(std::string_view data, ResultSet& batch);
+    /// The end-of-data marker has been read
+    [[nodiscard]] bool finished() const noexcept { return m_finished; }
+
+private:
+    std::vector<uint32_t> m_oids;
+    std::string m_pending;  ///< Bytes of a tuple (or the header) not yet complete
+    bool m_headerDone = false;
+    bool m_finished = false;
+};
+
+/// libpq connection string for `connectionString`. Keyword/value strings and postgresql:// URIs are used as
+/// they are; the psqlODBC form built by buildODBCConnectionString (Server=...;Port=...;Uid=...) is translated.
+[[nodiscard]] std::string pgConninfo(std::string_view connectionString);
+
+}  // namespace velocitydb
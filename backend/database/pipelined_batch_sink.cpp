@@ -0,0 +1,124 @@
+#include "pipelined_batch_sink.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace velocitydb {
+
+PipelinedBatchSink::PipelinedBatchSink(RowBatchSink& downstream, size_t depth)
+    : m_downstream(downstream), m_depth((std::max)(depth, size_t{1})), m_thread([this] { run(); }) {}
+
+PipelinedBatchSink::~PipelinedBatchSink() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_closed = true;
+        m_discard = true;
+    }
+    m_changed.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void PipelinedBatchSink::onColumns(const std::vector<ColumnInfo>& columns) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_stopped || m_closed) [[unlikely]] {
+            return;
+        }
+        m_queue.push_back({.columnsOnly = true, .columns = columns, .batch = nullptr});
+    }
+    m_changed.notify_all();
+}
+
+bool PipelinedBatchSink::onBatch(const ResultSet& batch) {
+    std::unique_ptr<ResultSet> slot;
+    {
+        std::unique_lock lock(m_mutex);
+        const auto ready = [this] { return m_stopped || !m_free.empty() || m_slots < m_depth; };
+        if (!ready()) {
+            ++m_stalls;
+            m_changed.wait(lock, ready);
+        }
+        if (m_stopped || m_closed) {
+            return false;
+        }
+        if (m_free.empty()) {
+            slot = std::make_unique<ResultSet>();
+            ++m_slots;
+        } else {
+            slot = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    // The slot is ours until queued; copying outside the lock keeps the consumer running meanwhile.
+    // Assignment reuses the slot's column buffers from an earlier batch.
+    *slot = batch;
+    {
+        std::lock_guard lock(m_mutex);
+        m_queue.push_back({.columnsOnly = false, .columns = {}, .batch = std::move(slot)});
+    }
+    m_changed.notify_all();
+    return true;
+}
+
+bool PipelinedBatchSink::finish() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_closed = true;
+    }
+    m_changed.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    std::lock_guard lock(m_mutex);
+    if (m_error) [[unlikely]] {
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+    return !m_stopped;
+}
+
+size_t PipelinedBatchSink::producerStalls() const noexcept {
+    std::lock_guard lock(m_mutex);
+    return m_stalls;
+}
+
+void PipelinedBatchSink::run() {
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        m_changed.wait(lock, [this] { return !m_queue.empty() || m_closed; });
+        if (m_queue.empty()) {
+            return;
+        }
+        Item item = std::move(m_queue.front());
+        m_queue.pop_front();
+
+        if (!m_stopped && !m_discard) {
+            lock.unlock();
+            bool accepted = true;
+            std::exception_ptr error;
+            try {
+                if (item.columnsOnly) {
+                    m_downstream.onColumns(item.columns);
+                } else {
+                    accepted = m_downstream.onBatch(*item.batch);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error) [[unlikely]] {
+                m_error = std::move(error);
+                m_stopped = true;
+            } else if (!accepted) {
+                m_stopped = true;
+            }
+        }
+        if (item.batch) {
+            m_free.push_back(std::move(item.batch));
+        }
+        m_changed.notify_all();
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+
+/// Runs another sink on a thread of its own, so the driver goes back to SQLFetch and UTF-16 transcoding while the
+/// previous batch is still being formatted, compressed or written by `downstream`.
+///
+/// Batches are copied into at most `depth` recycled slots; when all are taken, onBatch waits for the downstream
+/// thread, which bounds memory to `depth` batches. Once `downstream` returns false or throws, the next onBatch
+/// returns false and the driver stops fetching.
+class PipelinedBatchSink final : public RowBatchSink {
+public:
+    static constexpr size_t DEFAULT_DEPTH = 2;
+
+    explicit PipelinedBatchSink(RowBatchSink& downstream, size_t depth = DEFAULT_DEPTH);
+    /// Drops batches not yet handed on; call finish() to deliver them
+    ~PipelinedBatchSink() override;
+
+    PipelinedBatchSink(const PipelinedBatchSink&) = delete;
+    PipelinedBatchSink& operator=(const PipelinedBatchSink&) = delete;
+    PipelinedBatchSink(PipelinedBatchSink&&) = delete;
+    PipelinedBatchSink& operator=(PipelinedBatchSink&&) = delete;
+
+    void onColumns(const std::vector<ColumnInfo>& columns) override;
+    [[nodiscard]] bool onBatch(const ResultSet& batch) override;
+
+    /// Wait until `downstream` has taken every queued batch. Rethrows what `downstream` threw; false if it
+    /// stopped the stream.
+    [[nodiscard]] bool finish();
+
+    /// Times onBatch had to wait for a free slot: the consumer, not the server, was the bottleneck
+    [[nodiscard]] size_t producerStalls() const noexcept;
+
+private:
+    struct Item {
+        bool columnsOnly = false;
+        std::vector<ColumnInfo> columns;
+        std::unique_ptr<ResultSet> batch;
+    };
+
+    void run();
+
+    RowBatchSink& m_downstream;
+    const size_t m_depth;
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_changed;
+    std::deque<Item> m_queue;
+    std::vector<std::unique_ptr<ResultSet>> m_free;  ///< Slots handed back by the consumer, capacity kept
+    size_t m_slots = 0;                               ///< Slots allocated so far, at most m_depth
+    bool m_closed = false;                            ///< No more items will be queued
+    bool m_discard = false;                           ///< Consumer drops what is left (destructor without finish)
+    bool m_stopped = false;                           ///< Downstream returned false or threw
+    size_t m_stalls = 0;
+    std::exception_ptr m_error;
+
+    std::thread m_thread;  // last, so it starts after the state above is ready
+};
+
+}  // namespace velocitydb
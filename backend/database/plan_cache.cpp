@@ -0,0 +1,122 @@
+#include "plan_cache.h"
+
+#include "../parsers/sql_parser.h"
+
+#include <algorithm>
+#include <format>
+
+namespace velocitydb {
+
+PlanCache::PlanCache(size_t maxQueries) : m_maxQueries((std::max)(maxQueries, size_t{1})) {}
+
+uint64_t PlanCache::queryHash(std::string_view sql) {
+    return SQLParser::fingerprintHash(SQLParser::fingerprint(sql, false));
+}
+
+std::string PlanCache::keyOf(std::string_view connectionId, uint64_t queryHash) {
+    return std::format("{}\n{:016x}", connectionId, queryHash);
+}
+
+std::shared_ptr<const CachedPlan> PlanCache::lookup(std::string_view connectionId, uint64_t queryHash, std::string_view schemaStamp, size_t hotspotCount) {
+    std::lock_guard lock(m_mutex);
+    const auto it = schemaStamp.empty() ? m_queries.end() : m_queries.find(keyOf(connectionId, queryHash));
+    if (it != m_queries.end()) {
+        for (const auto& cached : it->second.plans) {
+            if (!cached->actual && cached->schemaStamp == schemaStamp && cached->hotspotCount == hotspotCount) {
+                m_recency.splice(m_recency.begin(), m_recency, it->second.recency);
+                ++m_hits;
+                return cached;
+            }
+        }
+    }
+    ++m_misses;
+    return nullptr;
+}
+
+std::shared_ptr<const CachedPlan> PlanCache::store(CachedPlan plan) {
+    std::lock_guard lock(m_mutex);
+    plan.id = std::format("plan_{}", m_nextId++);
+    plan.capturedAt = std::chrono::system_clock::now();
+    auto stored = std::make_shared<const CachedPlan>(std::move(plan));
+
+    auto key = keyOf(stored->connectionId, stored->queryHash);
+    auto [it, inserted] = m_queries.try_emplace(key);
+    auto& query = it->second;
+    if (inserted) {
+        query.connectionId = stored->connectionId;
+        m_recency.push_front(key);
+        query.recency = m_recency.begin();
+    } else {
+        m_recency.splice(m_recency.begin(), m_recency, query.recency);
+    }
+    query.plans.push_front(stored);
+    m_byId.emplace(stored->id, stored);
+    if (query.plans.size() > HISTORY_PER_QUERY) {
+        m_byId.erase(query.plans.back()->id);
+        query.plans.pop_back();
+    }
+
+    while (m_queries.size() > m_maxQueries) {
+        erase(std::string(m_recency.back()));
+    }
+    return stored;
+}
+
+void PlanCache::erase(const std::string& key) {
+    const auto it = m_queries.find(key);
+    if (it == m_queries.end())
+        return;
+    for (const auto& cached : it->second.plans) {
+        m_byId.erase(cached->id);
+    }
+    m_recency.erase(it->second.recency);
+    m_queries.erase(it);
+}
+
+std::shared_ptr<const CachedPlan> PlanCache::find(std::string_view planId) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_byId.find(std::string(planId));
+    return it == m_byId.end() ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<const CachedPlan>> PlanCache::history(std::string_view connectionId, uint64_t queryHash) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_queries.find(keyOf(connectionId, queryHash));
+    if (it == m_queries.end())
+        return {};
+    return {it->second.plans.begin(), it->second.plans.end()};
+}
+
+std::string PlanCache::previousId(std::string_view planId) const {
+    std::lock_guard lock(m_mutex);
+    const auto planIt = m_byId.find(std::string(planId));
+    if (planIt == m_byId.end())
+        return {};
+    const auto queryIt = m_queries.find(keyOf(planIt->second->connectionId, planIt->second->queryHash));
+    if (queryIt == m_queries.end())
+        return {};
+    const auto& plans = queryIt->second.plans;
+    const auto current = std::ranges::find(plans, planIt->second);
+    if (current == plans.end() || std::next(current) == plans.end())
+        return {};
+    return (*std::next(current))->id;
+}
+
+void PlanCache::dropConnection(std::string_view connectionId) {
+    std::lock_guard lock(m_mutex);
+    std::vector<std::string> keys;
+    for (const auto& [key, query] : m_queries) {
+        if (query.connectionId == connectionId)
+            keys.push_back(key);
+    }
+    for (const auto& key : keys) {
+        erase(key);
+    }
+}
+
+PlanCache::Stats PlanCache::stats() const {
+    std::lock_guard lock(m_mutex);
+    return Stats{.hits = m_hits, .misses = m_misses, .queries = m_queries.size(), .plans = m_byId.size()};
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../parsers/showplan_parser.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// One execution plan as it was fetched
+struct CachedPlan {
+    std::string id;  ///< "plan_N", assigned by PlanCache::store
+    std::string connectionId;
+    uint64_t queryHash = 0;  ///< PlanCache::queryHash of sql
+    std::string sql;
+    bool actual = false;
+    size_t hotspotCount = 0;
+    std::string schemaStamp;  ///< PlanCache::STAMP_QUERY's answer before the plan was fetched; empty = unknown
+    std::chrono::system_clock::time_point capturedAt;
+    std::shared_ptr<const ExecutionPlan> plan;
+    std::string json;  ///< ShowplanParser::toJson(*plan)
+};
+
+/// Recent execution plans per connection and query fingerprint.
+///
+/// An estimated plan only depends on the query and on what the optimizer knows about the schema, so a repeated
+/// explain of the same query is answered from here while the schema stamp (object and index counts plus the
+/// newest modify_date, which CREATE/DROP/ALTER INDEX move too) is unchanged. Actual plans are never served from
+/// the cache, but every plan fetched is kept in its query's history so the last few can be diffed against each
+/// other. Queries are evicted least recently used first.
+class PlanCache {
+public:
+    static constexpr size_t DEFAULT_MAX_QUERIES = 256;
+    static constexpr size_t HISTORY_PER_QUERY = 8;
+
+    /// One row, one column per part of the schema stamp; run on the connection the plan is fetched on
+    static constexpr std::string_view STAMP_QUERY =
+        "SELECT DB_NAME(), (SELECT COUNT_BIG(*) FROM sys.objects), (SELECT COUNT_BIG(*) FROM sys.indexes), "
+        "(SELECT CONVERT(varchar(23), MAX(modify_date), 121) FROM sys.objects)";
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t queries = 0;
+        size_t plans = 0;
+    };
+
+    explicit PlanCache(size_t maxQueries = DEFAULT_MAX_QUERIES);
+
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    /// SQLParser::fingerprintHash of the query's fingerprint with literals kept, like ResultCache keys
+    [[nodiscard]] static uint64_t queryHash(std::string_view sql);
+
+    /// Newest estimated plan of the query fetched under `schemaStamp` with the same hotspot count; nullptr on a miss
+    /// (always, when the stamp is empty)
+    [[nodiscard]] std::shared_ptr<const CachedPlan> lookup(std::string_view connectionId, uint64_t queryHash, std::string_view schemaStamp, size_t hotspotCount);
+
+    /// Add `plan` to its query's history, assigning its id and capture time
+    std::shared_ptr<const CachedPlan> store(CachedPlan plan);
+
+    [[nodiscard]] std::shared_ptr<const CachedPlan> find(std::string_view planId) const;
+    /// The query's plans, newest first
+    [[nodiscard]] std::vector<std::shared_ptr<const CachedPlan>> history(std::string_view connectionId, uint64_t queryHash) const;
+    /// Id of the plan fetched for the same query just before `planId`; empty when there is none
+    [[nodiscard]] std::string previousId(std::string_view planId) const;
+
+    void dropConnection(std::string_view connectionId);
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Query {
+        std::string connectionId;
+        std::deque<std::shared_ptr<const CachedPlan>> plans;  // newest first, at most HISTORY_PER_QUERY
+        std::list<std::string>::iterator recency;
+    };
+
+    [[nodiscard]] static std::string keyOf(std::string_view connectionId, uint64_t queryHash);
+    /// Remove the query under `key` and its plans (m_mutex held)
+    void erase(const std::string& key);
+
+    size_t m_maxQueries;
+    mutable std::mutex m_mutex;  // guards everything below
+    std::unordered_map<std::string, Query> m_queries;
+    std::list<std::string> m_recency;  // keys, most recently used first
+    std::unordered_map<std::string, std::shared_ptr<const CachedPlan>> m_byId;
+    uint64_t m_nextId = 1;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
+
+}  // namespace velocitydb
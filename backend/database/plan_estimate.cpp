@@ -0,0 +1,66 @@
+#include "plan_estimate.h"
+
+#include "../parsers/showplan_parser.h"
+#include "../utils/logger.h"
+
+#include <cmath>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+ShowplanSession::ShowplanSession(IDatabaseDriver& driver) : m_driver(driver) {
+    // SET SHOWPLAN_XML must be alone in its batch
+    (void)m_driver.execute("SET SHOWPLAN_XML ON");
+}
+
+ShowplanSession::~ShowplanSession() {
+    try {
+        (void)m_driver.execute("SET SHOWPLAN_XML OFF");
+        return;
+    } catch (const std::exception& e) {
+        log<LogLevel::WARNING>(std::format("Cannot turn SHOWPLAN_XML off, replacing the session: {}", e.what()));
+    }
+    try {
+        if (m_driver.reconnect()) {
+            return;
+        }
+    } catch (const std::exception& e) {
+        log<LogLevel::WARNING>(std::format("Reconnect after SHOWPLAN_XML failed: {}", e.what()));
+    }
+    try {
+        m_driver.disconnect();
+    } catch (...) {
+        // Nothing more can be done for this session
+    }
+}
+
+std::optional<int64_t> estimateRowCount(IDatabaseDriver& driver, std::string_view sql) {
+    try {
+        std::vector<ResultSet> results;
+        {
+            ShowplanSession showplan(driver);
+            results = driver.executeMultiple(sql);
+        }
+        std::vector<std::string_view> documents;
+        for (const auto& result : results) {
+            if (result.columnData.size() == 1 && result.columnData.front().type() == ColumnDataType::Text && !result.empty() && !result.isNull(0, 0)) {
+                documents.push_back(result.columnData.front().textAt(0));
+            }
+        }
+        if (documents.empty()) {
+            return std::nullopt;
+        }
+        const auto plan = ShowplanParser::parse(documents, 0);
+        if (plan.statements.empty() || !plan.statements.front().estimatedRows) {
+            return std::nullopt;
+        }
+        return static_cast<int64_t>(std::llround(*plan.statements.front().estimatedRows));
+    } catch (const std::exception& e) {
+        log<LogLevel::DEBUG>(std::format("Row count estimate unavailable: {}", e.what()));
+        return std::nullopt;
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace velocitydb {
+
+/// SET SHOWPLAN_XML ON for the lifetime of the object on a driver's session, and back OFF however the scope is left.
+///
+/// While the option is on, every batch on the session returns its plan instead of running, so a shared lane left
+/// in that mode would answer later queries with plan XML. If SET SHOWPLAN_XML OFF fails, the session is replaced
+/// with reconnect() (a new session starts with the option off) or, when that fails too, disconnected, so later
+/// queries fail loudly instead.
+class ShowplanSession {
+public:
+    /// @throws std::runtime_error if the option cannot be set (e.g. without SHOWPLAN permission)
+    explicit ShowplanSession(IDatabaseDriver& driver);
+    ~ShowplanSession();
+
+    ShowplanSession(const ShowplanSession&) = delete;
+    ShowplanSession& operator=(const ShowplanSession&) = delete;
+    ShowplanSession(ShowplanSession&&) = delete;
+    ShowplanSession& operator=(ShowplanSession&&) = delete;
+
+private:
+    IDatabaseDriver& m_driver;
+};
+
+/// Row count the optimizer expects `sql` to return: StatementEstRows of the first statement of its estimated plan
+/// (compiled, not executed). nullopt when the plan cannot be produced or carries no estimate.
+[[nodiscard]] std::optional<int64_t> estimateRowCount(IDatabaseDriver& driver, std::string_view sql);
+
+}  // namespace velocitydb
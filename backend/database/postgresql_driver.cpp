@@ -0,0 +1,397 @@
+#include "postgresql_driver.h"
+
+#include "pg_wire.h"
+
+#include <libpq-fe.h>
+
+#include <charconv>
+#include <chrono>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr std::string_view SYNTAX_ERROR = "42601";
+
+[[nodiscard]] double elapsedMs(std::chrono::steady_clock::time_point start) noexcept {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+[[nodiscard]] std::string_view trimTrailing(std::string_view sql) noexcept {
+    while (!sql.empty() && (sql.back() == ';' || sql.back() == ' ' || sql.back() == '\t' || sql.back() == '\r' || sql.back() == '\n')) {
+        sql.remove_suffix(1);
+    }
+    return sql;
+}
+
+[[nodiscard]] std::string resultError(const PGresult* result) {
+    std::string message = PQresultErrorMessage(result);
+    while (!message.empty() && (message.back() == '\n' || message.back() == ' ')) {
+        message.pop_back();
+    }
+    return message;
+}
+
+}  // namespace
+
+void PostgreSQLDriver::ResultDeleter::operator()(pg_result* result) const noexcept {
+    PQclear(result);
+}
+
+PostgreSQLDriver::~PostgreSQLDriver() {
+    disconnect();
+}
+
+bool PostgreSQLDriver::connect(std::string_view connectionString) {
+    disconnect();
+    std::scoped_lock lock(m_executeMutex);
+    m_connectionString = std::string(connectionString);
+
+    PGconn* conn = PQconnectdb(pgConninfo(connectionString).c_str());
+    if (PQstatus(conn) != CONNECTION_OK) [[unlikely]] {
+        std::string message = conn ? PQerrorMessage(conn) : "Out of memory";
+        PQfinish(conn);
+        std::scoped_lock errorLock(m_errorMutex);
+        m_lastError = std::move(message);
+        return false;
+    }
+    PQsetClientEncoding(conn, "UTF8");
+    m_conn = conn;
+    {
+        std::scoped_lock cancelLock(m_cancelMutex);
+        m_cancel = PQgetCancel(conn);
+    }
+    m_connected.store(true, std::memory_order_release);
+    return true;
+}
+
+void PostgreSQLDriver::disconnect() {
+    {
+        std::scoped_lock cancelLock(m_cancelMutex);
+        if (m_cancel) {
+            PQfreeCancel(m_cancel);
+            m_cancel = nullptr;
+        }
+    }
+    std::scoped_lock lock(m_executeMutex);
+    if (m_conn) {
+        PQfinish(m_conn);
+        m_conn = nullptr;
+    }
+    m_connected.store(false, std::memory_order_release);
+}
+
+bool PostgreSQLDriver::reconnect() {
+    std::string connectionString;
+    {
+        std::scoped_lock lock(m_executeMutex);
+        connectionString = m_connectionString;
+    }
+    return !connectionString.empty() && connect(connectionString);
+}
+
+void PostgreSQLDriver::cancel() {
+    std::scoped_lock lock(m_cancelMutex);
+    if (m_cancel) {
+        char error[256] = {};
+        PQcancel(m_cancel, error, static_cast<int>(sizeof(error)));
+    }
+}
+
+std::string PostgreSQLDriver::getLastError() const {
+    std::scoped_lock lock(m_errorMutex);
+    return m_lastError;
+}
+
+void PostgreSQLDriver::fail(std::string message) {
+    const bool lost = m_conn == nullptr || PQstatus(m_conn) == CONNECTION_BAD;
+    if (lost) {
+        m_connected.store(false, std::memory_order_release);
+    }
+    {
+        std::scoped_lock lock(m_errorMutex);
+        m_lastError = message;
+    }
+    if (lost) {
+        throw ConnectionLostError(message);
+    }
+    throw std::runtime_error(message);
+}
+
+void PostgreSQLDriver::drain() noexcept {
+    while (PGresult* result = PQgetResult(m_conn)) {
+        const auto status = PQresultStatus(result);
+        PQclear(result);
+        if (status == PGRES_COPY_OUT) {
+            char* buffer = nullptr;
+            while (PQgetCopyData(m_conn, &buffer, 0) > 0) {
+                PQfreemem(buffer);
+            }
+        }
+        if (PQstatus(m_conn) == CONNECTION_BAD) {
+            break;
+        }
+    }
+}
+
+std::vector<ColumnInfo> PostgreSQLDriver::describe(const pg_result* result, std::vector<uint32_t>& oids, ResultSet& batch) {
+    const int fields = PQnfields(result);
+    std::vector<ColumnInfo> columns;
+    columns.reserve(static_cast<size_t>(fields));
+    oids.clear();
+    batch.columnData.clear();
+    for (int field = 0; field < fields; ++field) {
+        const uint32_t oid = PQftype(result, field);
+        const auto type = pgColumnType(oid);
+        const int modifier = PQfmod(result, field);
+        // varchar(n)/bpchar(n) carry n + 4 (the varlena header) as their type modifier
+        const bool sized = (oid == pg_oid::VARCHAR || oid == pg_oid::BPCHAR) && modifier > 4;
+        columns.push_back(ColumnInfo{.name = PQfname(result, field), .type = std::string(type.name), .size = sized ? modifier - 4 : PQfsize(result, field)});
+        oids.push_back(oid);
+        batch.columnData.emplace_back(type.storage, type.fractionDigits);
+    }
+    batch.columns = columns;
+    return columns;
+}
+
+bool PostgreSQLDriver::readResults(RowBatchSink& sink, size_t batchRows, bool binary, StreamSummary& summary) {
+    const auto start = std::chrono::steady_clock::now();
+    ResultSet batch;
+    std::vector<uint32_t> oids;
+    bool described = false;     // Row description of the streamed (first) row-returning result seen
+    bool streamDone = false;    // That result is complete; later ones are only drained
+    std::string error;
+    double firstRowMs = -1.0;
+
+    const auto flush = [&] {
+        if (batch.empty() || summary.stopped) {
+            return;
+        }
+        summary.totalRows += batch.rowCount();
+        if (!sink.onBatch(batch)) {
+            summary.stopped = true;
+            cancel();
+        }
+        batch.clearRows();
+    };
+
+    while (ResultPtr result{PQgetResult(m_conn)}) {
+        const auto status = PQresultStatus(result.get());
+        switch (status) {
+            case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+            case PGRES_TUPLES_CHUNK:
+#endif
+            case PGRES_TUPLES_OK: {
+                if (streamDone || summary.stopped) {
+                    break;
+                }
+                if (!described) {
+                    summary.columns = describe(result.get(), oids, batch);
+                    summary.executionTimeMs = elapsedMs(start);
+                    sink.onColumns(summary.columns);
+                    described = true;
+                }
+                const int rows = PQntuples(result.get());
+                if (rows > 0 && firstRowMs < 0.0) {
+                    firstRowMs = elapsedMs(start);
+                }
+                for (int row = 0; row < rows && !summary.stopped; ++row) {
+                    for (size_t column = 0; column < oids.size(); ++column) {
+                        const int field = static_cast<int>(column);
+                        auto& data = batch.columnData[column];
+                        if (PQgetisnull(result.get(), row, field)) {
+                            data.appendNull();
+                            continue;
+                        }
+                        const std::string_view value(PQgetvalue(result.get(), row, field), static_cast<size_t>(PQgetlength(result.get(), row, field)));
+                        if (binary) {
+                            appendPgBinary(data, oids[column], value);
+                        } else {
+                            appendPgText(data, oids[column], value);
+                        }
+                    }
+                    if (batch.rowCount() >= batchRows) {
+                        flush();
+                    }
+                }
+                if (status == PGRES_TUPLES_OK) {
+                    flush();
+                    streamDone = true;
+                }
+                break;
+            }
+            case PGRES_COMMAND_OK: {
+                const std::string_view tuples = PQcmdTuples(result.get());
+                int64_t affected = 0;
+                if (std::from_chars(tuples.data(), tuples.data() + tuples.size(), affected).ec == std::errc{}) {
+                    summary.affectedRows += affected;
+                }
+                break;
+            }
+            case PGRES_EMPTY_QUERY:
+                break;
+            default: {
+                const char* sqlState = PQresultErrorField(result.get(), PG_DIAG_SQLSTATE);
+                if (binary && !described && sqlState && sqlState == SYNTAX_ERROR && resultError(result.get()).find("multiple commands") != std::string::npos) {
+                    drain();
+                    return false;
+                }
+                // A cancel we sent after the sink stopped reads as an error; that is the expected end
+                if (error.empty() && !summary.stopped) {
+                    error = resultError(result.get());
+                }
+                break;
+            }
+        }
+    }
+    if (!error.empty()) [[unlikely]] {
+        fail(std::move(error));
+    }
+    if (PQstatus(m_conn) == CONNECTION_BAD) [[unlikely]] {
+        fail(PQerrorMessage(m_conn));
+    }
+    if (!described) {
+        summary.executionTimeMs = elapsedMs(start);
+        sink.onColumns(summary.columns);
+    }
+
+    const double fetchMs = elapsedMs(start) - (firstRowMs < 0.0 ? summary.executionTimeMs : firstRowMs);
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    summary.fetchStats.bulkFetch = true;
+    summary.fetchStats.rowsetSize = batchRows;
+#else
+    summary.fetchStats.rowsetSize = 1;
+#endif
+    summary.fetchStats.fetchTimeMs = fetchMs;
+    summary.fetchStats.rowsPerSecond = fetchMs > 0.0 ? static_cast<double>(summary.totalRows) * 1000.0 / fetchMs : 0.0;
+    return true;
+}
+
+StreamSummary PostgreSQLDriver::executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows) {
+    std::scoped_lock lock(m_executeMutex);
+    if (!m_conn) [[unlikely]] {
+        fail("Not connected to database");
+    }
+    batchRows = (std::max)(batchRows, size_t{1});
+    const std::string query(sql);
+
+    StreamSummary summary;
+    const auto setRowMode = [&] {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        PQsetChunkedRowsMode(m_conn, static_cast<int>((std::min)(batchRows, size_t{1} << 20)));
+#else
+        PQsetSingleRowMode(m_conn);
+#endif
+    };
+
+    if (!PQsendQueryParams(m_conn, query.c_str(), 0, nullptr, nullptr, nullptr, nullptr, 1)) [[unlikely]] {
+        fail(PQerrorMessage(m_conn));
+    }
+    setRowMode();
+    if (readResults(sink, batchRows, true, summary)) {
+        return summary;
+    }
+
+    // Several statements: only the simple protocol accepts them, and it returns text
+    summary = {};
+    if (!PQsendQuery(m_conn, query.c_str())) [[unlikely]] {
+        fail(PQerrorMessage(m_conn));
+    }
+    setRowMode();
+    (void)readResults(sink, batchRows, false, summary);
+    return summary;
+}
+
+ResultSet PostgreSQLDriver::execute(std::string_view sql) {
+    ResultSet result;
+    CallbackBatchSink sink([&result](const ResultSet& batch) {
+        result.appendBatch(batch);
+        return true;
+    });
+    auto summary = executeStreaming(sql, sink);
+    result.columns = std::move(summary.columns);
+    result.affectedRows = summary.affectedRows;
+    result.executionTimeMs = summary.executionTimeMs;
+    result.fetchStats = summary.fetchStats;
+    return result;
+}
+
+StreamSummary PostgreSQLDriver::copyOut(std::string_view query, RowBatchSink& sink, size_t batchRows) {
+    std::scoped_lock lock(m_executeMutex);
+    if (!m_conn) [[unlikely]] {
+        fail("Not connected to database");
+    }
+    batchRows = (std::max)(batchRows, size_t{1});
+    const auto start = std::chrono::steady_clock::now();
+    const std::string select(trimTrailing(query));
+
+    // COPY sends no row description, so take the column names and types from an unnamed prepared statement
+    ResultPtr prepared{PQprepare(m_conn, "", select.c_str(), 0, nullptr)};
+    if (PQresultStatus(prepared.get()) != PGRES_COMMAND_OK) [[unlikely]] {
+        fail(resultError(prepared.get()));
+    }
+    ResultPtr description{PQdescribePrepared(m_conn, "")};
+    if (PQresultStatus(description.get()) != PGRES_COMMAND_OK) [[unlikely]] {
+        fail(resultError(description.get()));
+    }
+
+    StreamSummary summary;
+    ResultSet batch;
+    std::vector<uint32_t> oids;
+    summary.columns = describe(description.get(), oids, batch);
+    sink.onColumns(summary.columns);
+
+    const std::string copy = std::format("COPY ({}) TO STDOUT (FORMAT binary)", select);
+    ResultPtr started{PQexec(m_conn, copy.c_str())};
+    if (PQresultStatus(started.get()) != PGRES_COPY_OUT) [[unlikely]] {
+        fail(resultError(started.get()));
+    }
+    summary.executionTimeMs = elapsedMs(start);
+
+    PgCopyBinaryParser parser(oids);
+    bool malformed = false;
+    char* buffer = nullptr;
+    int length = 0;
+    while ((length = PQgetCopyData(m_conn, &buffer, 0)) > 0) {
+        if (!summary.stopped && !malformed) {
+            malformed = !parser.feed(std::string_view(buffer, static_cast<size_t>(length)), batch);
+            if (batch.rowCount() >= batchRows) {
+                summary.totalRows += batch.rowCount();
+                if (!sink.onBatch(batch)) {
+                    summary.stopped = true;
+                    cancel();
+                }
+                batch.clearRows();
+            }
+        }
+        PQfreemem(buffer);
+    }
+    if (!batch.empty() && !summary.stopped) {
+        summary.totalRows += batch.rowCount();
+        summary.stopped = !sink.onBatch(batch);
+    }
+
+    std::string error = length == -2 && !summary.stopped ? PQerrorMessage(m_conn) : "";
+    while (ResultPtr result{PQgetResult(m_conn)}) {
+        if (PQresultStatus(result.get()) != PGRES_COMMAND_OK && error.empty() && !summary.stopped) {
+            error = resultError(result.get());
+        }
+    }
+    if (!error.empty()) [[unlikely]] {
+        fail(std::move(error));
+    }
+    if (malformed) [[unlikely]] {
+        fail("Malformed COPY BINARY data from server");
+    }
+
+    const double fetchMs = elapsedMs(start) - summary.executionTimeMs;
+    summary.fetchStats.bulkFetch = true;
+    summary.fetchStats.rowsetSize = batchRows;
+    summary.fetchStats.fetchTimeMs = fetchMs;
+    summary.fetchStats.rowsPerSecond = fetchMs > 0.0 ? static_cast<double>(summary.totalRows) * 1000.0 / fetchMs : 0.0;
+    return summary;
+}
+
+}  // namespace velocitydb
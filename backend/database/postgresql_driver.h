@@ -0,0 +1,80 @@
+#pragma once
+
+#include "driver_interface.h"
+#include "result_set.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+struct pg_conn;
+struct pg_result;
+struct pg_cancel;
+
+namespace velocitydb {
+
+/// IDatabaseDriver for PostgreSQL over libpq (built when libpq is found; see POSTGRESQL_ENABLED).
+///
+/// Queries are sent with the extended protocol asking for binary results, so integers, floats, dates and
+/// timestamps arrive in fixed-width network order and go straight into typed ColumnData without text parsing
+/// (see appendPgBinary). Rows are streamed: with libpq 17+ in chunks of `batchRows` (PQsetChunkedRowsMode),
+/// otherwise one row at a time (PQsetSingleRowMode), so memory stays bounded by the batch either way. Batches
+/// with several statements, which the extended protocol rejects, are re-sent over the simple protocol and read
+/// as text. copyOut() uses COPY ... TO STDOUT (FORMAT binary) for bulk reads such as exports.
+///
+/// connect() takes a libpq connection string or URI, or the ODBC-style string built by the connection dialog
+/// (translated by pgConninfo).
+class PostgreSQLDriver final : public IDatabaseDriver {
+public:
+    PostgreSQLDriver() = default;
+    ~PostgreSQLDriver() override;
+
+    PostgreSQLDriver(const PostgreSQLDriver&) = delete;
+    PostgreSQLDriver& operator=(const PostgreSQLDriver&) = delete;
+    PostgreSQLDriver(PostgreSQLDriver&&) = delete;
+    PostgreSQLDriver& operator=(PostgreSQLDriver&&) = delete;
+
+    // IDatabaseDriver interface
+    [[nodiscard]] bool connect(std::string_view connectionString) override;
+    void disconnect() override;
+    [[nodiscard]] bool isConnected() const noexcept override { return m_connected.load(std::memory_order_acquire); }
+    [[nodiscard]] ResultSet execute(std::string_view sql) override;
+    StreamSummary executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows = DEFAULT_STREAM_BATCH_ROWS) override;
+    void cancel() override;
+    [[nodiscard]] bool reconnect() override;
+    [[nodiscard]] std::string getLastError() const override;
+    [[nodiscard]] DriverType getType() const noexcept override { return DriverType::PostgreSQL; }
+
+    /// Stream the rows of `query` (a SELECT) through COPY in binary format: no per-row protocol messages,
+    /// which makes it the fastest way to read a whole table or large result
+    StreamSummary copyOut(std::string_view query, RowBatchSink& sink, size_t batchRows = DEFAULT_STREAM_BATCH_ROWS);
+
+private:
+    struct ResultDeleter {
+        void operator()(pg_result* result) const noexcept;
+    };
+    using ResultPtr = std::unique_ptr<pg_result, ResultDeleter>;
+
+    /// Column names and storage for the row description of `result`; fills `oids`
+    [[nodiscard]] static std::vector<ColumnInfo> describe(const pg_result* result, std::vector<uint32_t>& oids, ResultSet& batch);
+    /// Read the results of the query just sent; false if the server rejected it as a multi-statement batch
+    /// before any row arrived (only asked for when `binary`, i.e. over the extended protocol)
+    [[nodiscard]] bool readResults(RowBatchSink& sink, size_t batchRows, bool binary, StreamSummary& summary);
+    /// Read and drop every pending result so the connection is ready for the next query
+    void drain() noexcept;
+    /// Record `message` (and the connection state) and throw; ConnectionLostError when the link is gone
+    [[noreturn]] void fail(std::string message);
+
+    std::mutex m_executeMutex;  ///< One query at a time per connection
+    pg_conn* m_conn = nullptr;
+    std::mutex m_cancelMutex;  ///< Guards m_cancel, which cancel() uses from other threads
+    pg_cancel* m_cancel = nullptr;
+    std::string m_connectionString;
+    mutable std::mutex m_errorMutex;
+    std::string m_lastError;
+    std::atomic<bool> m_connected{false};
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Fixed ring of slots mapping integer query handles to tasks, read without the table's write mutex.
+///
+/// Handles are increasing integers, and a handle lives in slot `handle % CAPACITY`. Lookups load that slot
+/// atomically and check its handle, so status polls never queue behind a whole submit or erase. The loads are
+/// not lock-free: std::atomic<std::shared_ptr> guards each slot with a short spinlock on MSVC and libstdc++, so
+/// a lookup can briefly spin against a store to the same slot, and only that. Inserts, erases and iteration are
+/// serialized among themselves. An insert skips handles whose slot holds a task that `keep` still wants.
+/// Otherwise it takes the slot over: that task is CAPACITY handles old and finished.
+template <typename T, size_t CAPACITY = 4096>
+class QueryHandleTable {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    static constexpr std::string_view ID_PREFIX = "query_";
+
+    /// String form of a handle, as the IPC layer and status listeners see it
+    [[nodiscard]] static std::string formatId(uint64_t handle) { return std::format("query_{}", handle); }
+
+    /// Handle of a formatId() string; nullopt for anything else
+    [[nodiscard]] static std::optional<uint64_t> parseId(std::string_view id) noexcept {
+        if (!id.starts_with(ID_PREFIX)) {
+            return std::nullopt;
+        }
+        id.remove_prefix(ID_PREFIX.size());
+        uint64_t handle = 0;
+        auto [end, error] = std::from_chars(id.data(), id.data() + id.size(), handle);
+        if (error != std::errc{} || end != id.data() + id.size() || handle == 0) {
+            return std::nullopt;
+        }
+        return handle;
+    }
+
+    /// Store `make(handle)` under the next free handle; 0 if every slot is kept. `keep(const T&)` returns true
+    /// for tasks that must not be displaced (still queued or running); such a slot is skipped.
+    template <typename Make, typename Keep>
+    uint64_t insert(Make&& make, Keep&& keep) {
+        std::lock_guard lock(m_writeMutex);
+        // Each skip passes a slot kept busy by a live task, so a free one comes up unless all CAPACITY are live
+        for (size_t attempt = 0; attempt < CAPACITY; ++attempt) {
+            const uint64_t handle = m_nextHandle++;
+            auto& slot = m_slots[handle & (CAPACITY - 1)];
+            if (auto current = slot.load(std::memory_order_acquire); current && keep(*current->value)) {
+                continue;
+            }
+            slot.store(std::make_shared<const Node>(handle, make(handle)), std::memory_order_release);
+            return handle;
+        }
+        return 0;
+    }
+
+    /// The task stored under `handle`, or nullptr once it was erased or displaced. Takes no mutex; it contends
+    /// only with a store to the same slot.
+    [[nodiscard]] std::shared_ptr<T> find(uint64_t handle) const {
+        auto node = m_slots[handle & (CAPACITY - 1)].load(std::memory_order_acquire);
+        return node && node->handle == handle ? node->value : nullptr;
+    }
+
+    /// Remove `handle` if `erasable(const T&)` agrees; false when it is gone already or was refused
+    template <typename Erasable>
+    bool erase(uint64_t handle, Erasable&& erasable) {
+        std::lock_guard lock(m_writeMutex);
+        auto& slot = m_slots[handle & (CAPACITY - 1)];
+        auto node = slot.load(std::memory_order_acquire);
+        if (!node || node->handle != handle || !erasable(*node->value)) {
+            return false;
+        }
+        slot.store(nullptr, std::memory_order_release);
+        return true;
+    }
+
+    /// Call `visit(handle, const std::shared_ptr<T>&)` for every stored task, in slot order
+    template <typename Visit>
+    void forEach(Visit&& visit) const {
+        std::lock_guard lock(m_writeMutex);
+        for (const auto& slot : m_slots) {
+            if (auto node = slot.load(std::memory_order_acquire)) {
+                visit(node->handle, node->value);
+            }
+        }
+    }
+
+private:
+    struct Node {
+        Node(uint64_t h, std::shared_ptr<T> v) : handle(h), value(std::move(v)) {}
+        uint64_t handle;
+        std::shared_ptr<T> value;
+    };
+
+    std::array<std::atomic<std::shared_ptr<const Node>>, CAPACITY> m_slots{};
+    mutable std::mutex m_writeMutex;  // serializes insert, erase and forEach
+    uint64_t m_nextHandle = 1;  // guarded by m_writeMutex; 0 is never handed out
+};
+
+}  // namespace velocitydb
@@ -1,58 +1,338 @@
 #include "query_history.h"
 
+#include "../parsers/sql_parser.h"
+#include "../utils/encoding.h"
+#include "../utils/file_utils.h"
+#include "../utils/json_utils.h"
+#include "../utils/logger.h"
 #include "simdjson.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <format>
-#include <fstream>
+#include <iterator>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
 
 namespace velocitydb {
 
+namespace {
+
+/// Tombstones tolerated before a compaction is considered at all
+constexpr size_t MIN_COMPACT_DEAD = 1024;
+
+[[nodiscard]] bool isTokenChar(unsigned char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+[[nodiscard]] char foldChar(unsigned char c) noexcept {
+    return static_cast<char>(std::tolower(c));
+}
+
+/// Distinct case-folded word tokens of `sql`
+[[nodiscard]] std::vector<std::string> tokensOf(std::string_view sql) {
+    std::vector<std::string> tokens;
+    std::string current;
+    for (unsigned char c : sql) {
+        if (isTokenChar(c)) {
+            current += foldChar(c);
+        } else if (!current.empty()) {
+            tokens.push_back(std::move(current));
+            current.clear();
+        }
+    }
+    if (!current.empty()) {
+        tokens.push_back(std::move(current));
+    }
+    std::ranges::sort(tokens);
+    auto [first, last] = std::ranges::unique(tokens);
+    tokens.erase(first, last);
+    return tokens;
+}
+
+/// Nearest-rank percentile; reorders `values`
+[[nodiscard]] double percentile(std::vector<double>& values, double fraction) {
+    const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+    const auto at = values.begin() + static_cast<std::ptrdiff_t>((std::max)(rank, size_t{1}) - 1);
+    std::ranges::nth_element(values, at);
+    return *at;
+}
+
+// Case-insensitive search without creating lowercase copies of entire strings
+[[nodiscard]] bool caseInsensitiveFind(std::string_view haystack, std::string_view needle) {
+    if (needle.size() > haystack.size()) {
+        return false;
+    }
+    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), [](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); });
+    return it != haystack.end();
+}
+
+[[nodiscard]] std::string itemJson(const HistoryItem& item) {
+    return std::format(R"({{"id":"{}","sql":"{}","connectionId":"{}","timestamp":{},"executionTimeMs":{},"success":{},"errorMessage":"{}","affectedRows":{},"isFavorite":{}}})",
+                       JsonUtils::escapeString(item.id), JsonUtils::escapeString(item.sql), JsonUtils::escapeString(item.connectionId), std::chrono::system_clock::to_time_t(item.timestamp),
+                       item.executionTimeMs, item.success ? "true" : "false", JsonUtils::escapeString(item.errorMessage), item.affectedRows, item.isFavorite ? "true" : "false");
+}
+
+/// Log record adding `item`: the item object with an "op" member in front
+[[nodiscard]] std::string addRecord(const HistoryItem& item) {
+    auto json = itemJson(item);
+    json.insert(1, R"("op":"add",)");
+    return json;
+}
+
+[[nodiscard]] HistoryItem parseItem(simdjson::dom::element item) {
+    HistoryItem historyItem;
+    if (auto id = item["id"].get_string(); !id.error()) {
+        historyItem.id = std::string(id.value());
+    }
+    if (auto sql = item["sql"].get_string(); !sql.error()) {
+        historyItem.sql = std::string(sql.value());
+    }
+    if (auto connId = item["connectionId"].get_string(); !connId.error()) {
+        historyItem.connectionId = std::string(connId.value());
+    }
+    if (auto timestamp = item["timestamp"].get_int64(); !timestamp.error()) {
+        historyItem.timestamp = std::chrono::system_clock::from_time_t(timestamp.value());
+    }
+    if (auto execTime = item["executionTimeMs"].get_double(); !execTime.error()) {
+        historyItem.executionTimeMs = execTime.value();
+    } else if (auto wholeTime = item["executionTimeMs"].get_int64(); !wholeTime.error()) {
+        historyItem.executionTimeMs = static_cast<double>(wholeTime.value());
+    }
+    if (auto success = item["success"].get_bool(); !success.error()) {
+        historyItem.success = success.value();
+    }
+    if (auto errorMsg = item["errorMessage"].get_string(); !errorMsg.error()) {
+        historyItem.errorMessage = std::string(errorMsg.value());
+    }
+    if (auto affected = item["affectedRows"].get_int64(); !affected.error()) {
+        historyItem.affectedRows = affected.value();
+    }
+    if (auto favorite = item["isFavorite"].get_bool(); !favorite.error()) {
+        historyItem.isFavorite = favorite.value();
+    }
+    return historyItem;
+}
+
+}  // namespace
+
+std::filesystem::path QueryHistory::defaultPath() {
+    return std::filesystem::path(utf8ToWide(FileUtils::getAppDataPath())) / "query_history.jsonl";
+}
+
 void QueryHistory::add(const HistoryItem& item) {
     std::lock_guard lock(m_mutex);
 
-    m_history.insert(m_history.begin(), item);
+    HistoryItem copy = item;
+    if (copy.id.empty()) {
+        copy.id = std::format("hist_{}", std::chrono::system_clock::now().time_since_epoch().count());
+        for (size_t suffix = 1; m_byId.contains(copy.id); ++suffix) {
+            copy.id = std::format("hist_{}_{}", std::chrono::system_clock::now().time_since_epoch().count(), suffix);
+        }
+    }
+    auto record = addRecord(copy);
+    addItem(std::move(copy));
+    appendRecord(record);
+}
 
-    while (m_history.size() > m_maxItems) {
-        auto it = std::ranges::find_if(m_history | std::views::reverse, [](const HistoryItem& h) { return !h.isFavorite; });
+void QueryHistory::addItem(HistoryItem item) {
+    // An id names one item: re-adding it replaces the older one
+    if (auto existing = find(item.id)) {
+        kill(*existing);
+    }
+    insert(std::move(item));
+    evictOverflow();
+    compactIfSparse();
+}
 
-        if (it != (m_history | std::views::reverse).end()) {
-            m_history.erase(std::next(it).base());
-        } else {
-            break;
+void QueryHistory::insert(HistoryItem item) {
+    const auto slot = static_cast<uint32_t>(m_slots.size());
+    for (auto& token : tokensOf(item.sql)) {
+        ++m_tokenUses[token];
+        m_tokens[std::move(token)].push_back(slot);
+    }
+    m_byId[item.id] = slot;
+    auto byTime = m_byTime.emplace(item.timestamp, slot);
+    const auto fingerprint = SQLParser::fingerprintHash(SQLParser::fingerprint(item.sql, true));
+    m_slots.push_back(Slot{.item = std::move(item), .byTime = byTime, .fingerprint = fingerprint});
+}
+
+void QueryHistory::evictOverflow() {
+    while (m_slots.size() - m_dead > m_maxItems) {
+        while (m_oldest < m_slots.size() && !m_slots[m_oldest].alive) {
+            ++m_oldest;
+        }
+        auto victim = m_oldest;
+        while (victim < m_slots.size() && (!m_slots[victim].alive || m_slots[victim].item.isFavorite)) {
+            ++victim;
+        }
+        if (victim == m_slots.size()) {
+            break;  // Only favorites left
+        }
+        kill(static_cast<uint32_t>(victim));
+    }
+}
+
+void QueryHistory::kill(uint32_t slot) {
+    auto& entry = m_slots[slot];
+    m_byTime.erase(entry.byTime);
+    if (auto found = m_byId.find(entry.item.id); found != m_byId.end() && found->second == slot) {
+        m_byId.erase(found);
+    }
+    for (const auto& token : tokensOf(entry.item.sql)) {
+        if (auto found = m_tokenUses.find(token); found != m_tokenUses.end() && --found->second == 0) {
+            m_tokenUses.erase(found);
+        }
+    }
+    entry.alive = false;
+    entry.item = HistoryItem{};
+    ++m_dead;
+}
+
+void QueryHistory::compactIfSparse() {
+    if (m_dead <= MIN_COMPACT_DEAD || m_dead <= m_slots.size() - m_dead) {
+        return;
+    }
+    auto slots = std::move(m_slots);
+    m_slots.clear();
+    m_tokens.clear();
+    m_tokenUses.clear();
+    m_byId.clear();
+    m_byTime.clear();
+    m_dead = 0;
+    m_oldest = 0;
+    for (auto& slot : slots) {
+        if (slot.alive) {
+            insert(std::move(slot.item));
         }
     }
 }
 
+std::optional<uint32_t> QueryHistory::find(std::string_view id) const {
+    if (auto found = m_byId.find(std::string(id)); found != m_byId.end()) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+std::vector<HistoryItem> QueryHistory::collectNewestFirst(const std::function<bool(const HistoryItem&)>& keep) const {
+    std::vector<HistoryItem> results;
+    for (const auto& slot : m_slots | std::views::reverse) {
+        if (slot.alive && keep(slot.item)) {
+            results.push_back(slot.item);
+        }
+    }
+    return results;
+}
+
 std::vector<HistoryItem> QueryHistory::getAll() const {
     std::lock_guard lock(m_mutex);
-    return m_history;
+    return collectNewestFirst([](const HistoryItem&) { return true; });
+}
+
+std::vector<size_t> QueryHistory::wordUses(std::span<const std::string> folded) const {
+    std::vector<size_t> uses(folded.size(), 0);
+    std::lock_guard lock(m_mutex);
+    for (size_t i = 0; i < folded.size(); ++i) {
+        if (auto found = m_tokenUses.find(folded[i]); found != m_tokenUses.end()) {
+            uses[i] = found->second;
+        }
+    }
+    return uses;
+}
+
+size_t QueryHistory::size() const {
+    std::lock_guard lock(m_mutex);
+    return m_slots.size() - m_dead;
+}
+
+std::vector<uint32_t> QueryHistory::candidates(std::string_view folded) const {
+    // A keyword token must match a whole SQL token, unless it touches an end of the keyword: then the SQL token may
+    // run on past it on that side ("ord" in "orders", "ers o" in "users order by")
+    struct Term {
+        std::string_view text;
+        bool openLeft;
+        bool openRight;
+    };
+    std::vector<Term> terms;
+    for (size_t i = 0; i < folded.size();) {
+        if (!isTokenChar(static_cast<unsigned char>(folded[i]))) {
+            ++i;
+            continue;
+        }
+        auto end = i;
+        while (end < folded.size() && isTokenChar(static_cast<unsigned char>(folded[end]))) {
+            ++end;
+        }
+        terms.push_back(Term{.text = folded.substr(i, end - i), .openLeft = i == 0, .openRight = end == folded.size()});
+        i = end;
+    }
+
+    std::vector<uint32_t> result;
+    if (terms.empty()) {
+        // Only punctuation: every item is a candidate
+        result.resize(m_slots.size());
+        for (uint32_t slot = 0; slot < result.size(); ++slot) {
+            result[slot] = slot;
+        }
+        return result;
+    }
+
+    for (size_t t = 0; t < terms.size(); ++t) {
+        const auto& term = terms[t];
+        std::vector<uint32_t> matches;
+        const auto take = [&](const std::vector<uint32_t>& postings) { matches.insert(matches.end(), postings.begin(), postings.end()); };
+        if (!term.openLeft && !term.openRight) {
+            if (auto found = m_tokens.find(term.text); found != m_tokens.end()) {
+                take(found->second);
+            }
+        } else if (!term.openLeft) {
+            for (auto it = m_tokens.lower_bound(term.text); it != m_tokens.end() && it->first.starts_with(term.text); ++it) {
+                take(it->second);
+            }
+        } else {
+            for (const auto& [token, postings] : m_tokens) {
+                if (term.openRight ? token.find(term.text) != std::string::npos : token.ends_with(term.text)) {
+                    take(postings);
+                }
+            }
+        }
+        std::ranges::sort(matches);
+        auto [first, last] = std::ranges::unique(matches);
+        matches.erase(first, last);
+
+        if (t == 0) {
+            result = std::move(matches);
+        } else {
+            std::vector<uint32_t> both;
+            std::ranges::set_intersection(result, matches, std::back_inserter(both));
+            result = std::move(both);
+        }
+        if (result.empty()) {
+            break;
+        }
+    }
+    return result;
 }
 
 std::vector<HistoryItem> QueryHistory::search(std::string_view keyword) const {
     std::lock_guard lock(m_mutex);
 
     if (keyword.empty()) {
-        return m_history;
+        return collectNewestFirst([](const HistoryItem&) { return true; });
     }
 
-    // Case-insensitive search without creating lowercase copies of entire strings
-    auto caseInsensitiveFind = [](std::string_view haystack, std::string_view needle) -> bool {
-        if (needle.size() > haystack.size()) {
-            return false;
-        }
-        auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), [](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); });
-        return it != haystack.end();
-    };
+    std::string folded(keyword);
+    std::ranges::transform(folded, folded.begin(), [](unsigned char c) { return foldChar(c); });
 
+    // The token index narrows the candidates; the substring check keeps the results exact
     std::vector<HistoryItem> results;
-    results.reserve(m_history.size() / 4);  // Estimate ~25% match rate
-
-    for (const auto& item : m_history) {
-        if (caseInsensitiveFind(item.sql, keyword)) {
-            results.push_back(item);
+    for (const auto slot : candidates(folded) | std::views::reverse) {
+        const auto& entry = m_slots[slot];
+        if (entry.alive && caseInsensitiveFind(entry.item.sql, keyword)) {
+            results.push_back(entry.item);
         }
     }
 
@@ -62,39 +342,225 @@ std::vector<HistoryItem> QueryHistory::search(std::string_view keyword) const {
 std::vector<HistoryItem> QueryHistory::getByDate(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const {
     std::lock_guard lock(m_mutex);
 
+    std::vector<uint32_t> slots;
+    if (from <= to) {
+        for (auto it = m_byTime.lower_bound(from); it != m_byTime.end() && it->first <= to; ++it) {
+            slots.push_back(it->second);
+        }
+    }
+    std::ranges::sort(slots, std::greater<>{});
+
     std::vector<HistoryItem> results;
-    std::ranges::copy_if(m_history, std::back_inserter(results), [from, to](const HistoryItem& item) { return item.timestamp >= from && item.timestamp <= to; });
+    results.reserve(slots.size());
+    for (const auto slot : slots) {
+        results.push_back(m_slots[slot].item);
+    }
 
     return results;
 }
 
+std::vector<HistoryAggregate> QueryHistory::aggregateByFingerprint(size_t minCount) const {
+    struct Group {
+        HistoryAggregate aggregate;
+        std::vector<double> times;
+        uint32_t newest = 0;
+    };
+    std::unordered_map<uint64_t, Group> groups;
+    {
+        std::lock_guard lock(m_mutex);
+        for (uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+            const auto& entry = m_slots[slot];
+            if (!entry.alive) {
+                continue;
+            }
+            auto& group = groups[entry.fingerprint];
+            auto& aggregate = group.aggregate;
+            if (group.times.empty() || entry.item.timestamp >= aggregate.lastRun) {
+                aggregate.lastRun = entry.item.timestamp;
+                group.newest = slot;
+            }
+            group.times.push_back(entry.item.executionTimeMs);
+            aggregate.totalExecutionTimeMs += entry.item.executionTimeMs;
+            aggregate.failures += entry.item.success ? 0 : 1;
+        }
+        std::erase_if(groups, [&](const auto& group) { return group.second.times.size() < minCount; });
+        for (auto& [fingerprint, group] : groups) {
+            group.aggregate.sql = m_slots[group.newest].item.sql;
+        }
+    }
+
+    // Percentiles and the readable fingerprint are worked out without holding the lock
+    std::vector<HistoryAggregate> aggregates;
+    aggregates.reserve(groups.size());
+    for (auto& [fingerprint, group] : groups) {
+        auto& aggregate = group.aggregate;
+        aggregate.fingerprintHash = fingerprint;
+        aggregate.fingerprint = SQLParser::fingerprint(aggregate.sql, true);
+        aggregate.count = group.times.size();
+        aggregate.p50ExecutionTimeMs = percentile(group.times, 0.5);
+        aggregate.p95ExecutionTimeMs = percentile(group.times, 0.95);
+        aggregates.push_back(std::move(aggregate));
+    }
+    std::ranges::sort(aggregates, [](const HistoryAggregate& a, const HistoryAggregate& b) {
+        return a.p95ExecutionTimeMs != b.p95ExecutionTimeMs ? a.p95ExecutionTimeMs > b.p95ExecutionTimeMs : a.count > b.count;
+    });
+    return aggregates;
+}
+
 void QueryHistory::setFavorite(std::string_view id, bool favorite) {
     std::lock_guard lock(m_mutex);
 
-    if (auto it = std::ranges::find_if(m_history, [id](const HistoryItem& h) { return h.id == id; }); it != m_history.end()) {
-        it->isFavorite = favorite;
+    if (auto slot = find(id)) {
+        m_slots[*slot].item.isFavorite = favorite;
+        appendRecord(std::format(R"({{"op":"favorite","id":"{}","isFavorite":{}}})", JsonUtils::escapeString(id), favorite ? "true" : "false"));
     }
 }
 
 std::vector<HistoryItem> QueryHistory::getFavorites() const {
     std::lock_guard lock(m_mutex);
-
-    std::vector<HistoryItem> results;
-    std::ranges::copy_if(m_history, std::back_inserter(results), [](const HistoryItem& item) { return item.isFavorite; });
-
-    return results;
+    return collectNewestFirst([](const HistoryItem& item) { return item.isFavorite; });
 }
 
 void QueryHistory::remove(std::string_view id) {
     std::lock_guard lock(m_mutex);
 
-    std::erase_if(m_history, [id](const HistoryItem& h) { return h.id == id; });
+    if (auto slot = find(id)) {
+        kill(*slot);
+        compactIfSparse();
+        appendRecord(std::format(R"({{"op":"remove","id":"{}"}})", JsonUtils::escapeString(id)));
+    }
 }
 
 void QueryHistory::clear() {
     std::lock_guard lock(m_mutex);
 
-    std::erase_if(m_history, [](const HistoryItem& h) { return !h.isFavorite; });
+    clearItems();
+    appendRecord(R"({"op":"clear"})");
+}
+
+void QueryHistory::clearItems() {
+    for (uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot].alive && !m_slots[slot].item.isFavorite) {
+            kill(slot);
+        }
+    }
+    compactIfSparse();
+}
+
+void QueryHistory::replay(std::string_view op, HistoryItem item) {
+    if (op == "add") {
+        addItem(std::move(item));
+    } else if (op == "favorite") {
+        if (auto slot = find(item.id)) {
+            m_slots[*slot].item.isFavorite = item.isFavorite;
+        }
+    } else if (op == "remove") {
+        if (auto slot = find(item.id)) {
+            kill(*slot);
+            compactIfSparse();
+        }
+    } else if (op == "clear") {
+        clearItems();
+    }
+}
+
+void QueryHistory::appendRecord(const std::string& record) {
+    if (!m_log.is_open()) {
+        return;
+    }
+    // One write per record; a crash can only tear the last line, which open() drops
+    m_log << record << '\n';
+    m_log.flush();
+    ++m_logRecords;
+
+    const auto live = m_slots.size() - m_dead;
+    if (m_logRecords > MIN_LOG_COMPACT_RECORDS && m_logRecords > 2 * live) {
+        rewriteLog();
+    }
+}
+
+void QueryHistory::rewriteLog() {
+    auto temporary = m_logPath;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        for (const auto& slot : m_slots) {
+            if (slot.alive) {
+                out << addRecord(slot.item) << '\n';
+            }
+        }
+        out.flush();
+        if (!out) [[unlikely]] {
+            log<LogLevel::WARNING>(std::format("Query history: could not write {}", temporary.string()));
+            return;
+        }
+    }
+
+    // Rename over the old log, so a crash leaves one complete log or the other
+    m_log.close();
+    std::error_code ec;
+    std::filesystem::rename(temporary, m_logPath, ec);
+    if (ec) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Query history: could not replace the log: {}", ec.message()));
+    } else {
+        m_logRecords = m_slots.size() - m_dead;
+    }
+    m_log.open(m_logPath, std::ios::binary | std::ios::app);
+}
+
+bool QueryHistory::open(const std::filesystem::path& filepath) {
+    std::lock_guard lock(m_mutex);
+
+    m_log.close();
+    std::error_code ec;
+    if (filepath.has_parent_path()) {
+        std::filesystem::create_directories(filepath.parent_path(), ec);
+    }
+
+    size_t records = 0;
+    uintmax_t complete = 0;  ///< Bytes up to the end of the last newline-terminated record
+    {
+        std::ifstream inFile(filepath, std::ios::binary);
+        simdjson::dom::parser parser;
+        std::string line;
+        while (std::getline(inFile, line)) {
+            if (inFile.eof()) {
+                break;  // No newline: an append the process did not finish
+            }
+            complete += line.size() + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            try {
+                auto record = parser.parse(line);
+                auto op = record["op"].get_string();
+                if (record.error() || op.error()) {
+                    throw std::runtime_error("not a history record");
+                }
+                replay(op.value(), parseItem(record.value()));
+                ++records;
+            } catch (const std::exception& e) {
+                log<LogLevel::WARNING>(std::format("Query history: skipping unreadable record: {}", e.what()));
+            }
+        }
+    }
+    if (std::filesystem::exists(filepath, ec) && std::filesystem::file_size(filepath, ec) > complete) {
+        std::filesystem::resize_file(filepath, complete, ec);
+    }
+
+    m_logPath = filepath;
+    m_logRecords = records;
+    m_log.open(filepath, std::ios::binary | std::ios::app);
+    if (!m_log.is_open()) [[unlikely]] {
+        return false;
+    }
+    if (m_logRecords > MIN_LOG_COMPACT_RECORDS && m_logRecords > 2 * (m_slots.size() - m_dead)) {
+        rewriteLog();
+    }
+    return true;
 }
 
 bool QueryHistory::save(std::string_view filepath) const {
@@ -102,39 +568,27 @@ bool QueryHistory::save(std::string_view filepath) const {
 
     auto path = std::string(filepath);
     std::ofstream outFile;
-    outFile.open(path);
+    outFile.open(path, std::ios::binary);
     if (!outFile.is_open()) [[unlikely]] {
         return false;
     }
 
+    // Newest first, one item per line
     outFile << "[\n";
-    for (size_t i = 0; i < m_history.size(); ++i) {
-        const auto& item = m_history[i];
-        auto time = std::chrono::system_clock::to_time_t(item.timestamp);
-
-        auto jsonEntry =
-            std::format(R"(  {{
-    "id": "{}",
-    "sql": "{}",
-    "connectionId": "{}",
-    "timestamp": {},
-    "executionTimeMs": {},
-    "success": {},
-    "errorMessage": "{}",
-    "affectedRows": {},
-    "isFavorite": {}
-  }})",
-                        item.id, item.sql, item.connectionId, time, item.executionTimeMs, item.success ? "true" : "false", item.errorMessage, item.affectedRows, item.isFavorite ? "true" : "false");
-        outFile << jsonEntry;
-
-        if (i < m_history.size() - 1) {
-            outFile << ",";
-        }
-        outFile << "\n";
-    }
-    outFile << "]\n";
+    bool first = true;
+    for (const auto& slot : m_slots | std::views::reverse) {
+        if (!slot.alive) {
+            continue;
+        }
+        if (!first) {
+            outFile << ",\n";
+        }
+        outFile << "  " << itemJson(slot.item);
+        first = false;
+    }
+    outFile << "\n]\n";
 
-    return true;
+    return static_cast<bool>(outFile);
 }
 
 bool QueryHistory::load(std::string_view filepath) {
@@ -162,40 +616,24 @@ bool QueryHistory::load(std::string_view filepath) {
             return false;
         }
 
-        m_history.clear();
-
+        std::vector<HistoryItem> items;
         for (auto item : doc.get_array()) {
-            HistoryItem historyItem;
-
-            if (auto id = item["id"].get_string(); !id.error()) {
-                historyItem.id = std::string(id.value());
-            }
-            if (auto sql = item["sql"].get_string(); !sql.error()) {
-                historyItem.sql = std::string(sql.value());
-            }
-            if (auto connId = item["connectionId"].get_string(); !connId.error()) {
-                historyItem.connectionId = std::string(connId.value());
-            }
-            if (auto timestamp = item["timestamp"].get_int64(); !timestamp.error()) {
-                historyItem.timestamp = std::chrono::system_clock::from_time_t(timestamp.value());
-            }
-            if (auto execTime = item["executionTimeMs"].get_double(); !execTime.error()) {
-                historyItem.executionTimeMs = execTime.value();
-            }
-            if (auto success = item["success"].get_bool(); !success.error()) {
-                historyItem.success = success.value();
-            }
-            if (auto errorMsg = item["errorMessage"].get_string(); !errorMsg.error()) {
-                historyItem.errorMessage = std::string(errorMsg.value());
-            }
-            if (auto affected = item["affectedRows"].get_int64(); !affected.error()) {
-                historyItem.affectedRows = affected.value();
-            }
-            if (auto favorite = item["isFavorite"].get_bool(); !favorite.error()) {
-                historyItem.isFavorite = favorite.value();
-            }
+            items.push_back(parseItem(item));
+        }
 
-            m_history.push_back(std::move(historyItem));
+        m_slots.clear();
+        m_tokens.clear();
+        m_tokenUses.clear();
+        m_byId.clear();
+        m_byTime.clear();
+        m_dead = 0;
+        m_oldest = 0;
+        // The file lists the newest first
+        for (auto& item : items | std::views::reverse) {
+            addItem(std::move(item));
+        }
+        if (m_log.is_open()) {
+            rewriteLog();
         }
 
         return true;
@@ -1,10 +1,17 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace velocitydb {
@@ -21,18 +28,48 @@ struct HistoryItem {
     bool isFavorite = false;
 };
 
+/// Executions of one query shape: items whose SQL has the same SQLParser::fingerprint with literals parameterized
+struct HistoryAggregate {
+    uint64_t fingerprintHash = 0;
+    std::string fingerprint;
+    std::string sql;  ///< Text of the newest execution
+    size_t count = 0;
+    size_t failures = 0;
+    double p50ExecutionTimeMs = 0.0;
+    double p95ExecutionTimeMs = 0.0;
+    double totalExecutionTimeMs = 0.0;
+    std::chrono::system_clock::time_point lastRun;
+};
+
+/// Executed-query history, newest first.
+///
+/// Items live in slots in insertion order; removals leave tombstones that are compacted once they outnumber live
+/// items. search() narrows candidates through an inverted index of the SQL's case-folded word tokens before the
+/// substring check, getByDate() walks a timestamp index, and id lookups are hashed.
+///
+/// open() makes the history persistent as an append-only JSON Lines log: every change is one flushed line, a torn
+/// last line left by a crash is dropped on the next open, and the log is rewritten (to a temporary file, then
+/// renamed over the old one) once superseded records outnumber live items.
 class QueryHistory {
 public:
+    /// Log records tolerated before a rewrite is considered at all
+    static constexpr size_t MIN_LOG_COMPACT_RECORDS = 4096;
+
     explicit QueryHistory(size_t maxItems = 10000) : m_maxItems(maxItems) {}
     ~QueryHistory() = default;
 
     QueryHistory(const QueryHistory&) = delete;
     QueryHistory& operator=(const QueryHistory&) = delete;
 
+    /// Items without an id get a generated one
     void add(const HistoryItem& item);
     [[nodiscard]] std::vector<HistoryItem> getAll() const;
     [[nodiscard]] std::vector<HistoryItem> search(std::string_view keyword) const;
     [[nodiscard]] std::vector<HistoryItem> getByDate(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const;
+    /// Items rolled up per query shape, slowest p95 first; shapes run fewer than `minCount` times are left out
+    [[nodiscard]] std::vector<HistoryAggregate> aggregateByFingerprint(size_t minCount = 1) const;
+    /// Number of items whose SQL uses each case-folded word of `folded`, in the same order
+    [[nodiscard]] std::vector<size_t> wordUses(std::span<const std::string> folded) const;
 
     void setFavorite(std::string_view id, bool favorite);
     [[nodiscard]] std::vector<HistoryItem> getFavorites() const;
@@ -40,13 +77,59 @@ public:
     void remove(std::string_view id);
     void clear();
 
+    [[nodiscard]] size_t size() const;
+
+    /// Replay the log at `filepath` (created when missing) into this history, then append every change to it
+    [[nodiscard]] bool open(const std::filesystem::path& filepath);
+
+    /// Write a JSON array snapshot / replace the history with one
     [[nodiscard]] bool save(std::string_view filepath) const;
     [[nodiscard]] bool load(std::string_view filepath);
 
+    /// query_history.jsonl in the app data directory
+    [[nodiscard]] static std::filesystem::path defaultPath();
+
 private:
+    using TimeIndex = std::multimap<std::chrono::system_clock::time_point, uint32_t>;
+
+    struct Slot {
+        HistoryItem item;
+        TimeIndex::iterator byTime;
+        uint64_t fingerprint = 0;  ///< SQLParser::fingerprintHash of the item's parameterized fingerprint
+        bool alive = true;
+    };
+
+    // All with m_mutex held
+    void addItem(HistoryItem item);
+    void insert(HistoryItem item);
+    /// Drop the oldest non-favorites beyond m_maxItems
+    void evictOverflow();
+    void kill(uint32_t slot);
+    void clearItems();
+    void compactIfSparse();
+    [[nodiscard]] std::optional<uint32_t> find(std::string_view id) const;
+    /// Slots (dead ones included) whose SQL may contain `folded`, ascending; a superset of the matches
+    [[nodiscard]] std::vector<uint32_t> candidates(std::string_view folded) const;
+    [[nodiscard]] std::vector<HistoryItem> collectNewestFirst(const std::function<bool(const HistoryItem&)>& keep) const;
+
+    /// Apply one log record ("add", "favorite", "remove" or "clear"); `item` carries its fields
+    void replay(std::string_view op, HistoryItem item);
+    void appendRecord(const std::string& record);
+    void rewriteLog();
+
     size_t m_maxItems;
     mutable std::mutex m_mutex;
-    std::vector<HistoryItem> m_history;
+    std::vector<Slot> m_slots;
+    size_t m_dead = 0;
+    size_t m_oldest = 0;  ///< Every slot below this one is dead
+    std::unordered_map<std::string, uint32_t> m_byId;
+    std::map<std::string, std::vector<uint32_t>, std::less<>> m_tokens;  ///< Folded token -> ascending slots
+    std::unordered_map<std::string, size_t> m_tokenUses;                ///< Folded token -> live items using it
+    TimeIndex m_byTime;
+
+    std::filesystem::path m_logPath;
+    std::ofstream m_log;
+    size_t m_logRecords = 0;
 };
 
 }  // namespace velocitydb
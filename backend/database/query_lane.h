@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../utils/cancellation_token.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace velocitydb {
+
+class SQLServerDriver;
+
+/// A query driver checked out of a connection's lanes (see ConnectionRegistry::checkoutLane).
+/// The lane counts as busy until the handle is destroyed or released; the handle is move-only.
+/// Its cancellation token is raised when the connection's queries are cancelled, so the work done with the lane
+/// after the fetch (serializing, filtering, writing a file) stops too.
+class QueryLane {
+public:
+    QueryLane() = default;
+    QueryLane(std::shared_ptr<SQLServerDriver> driver, std::function<void()> onRelease, CancellationToken cancellation = {}) noexcept
+        : m_driver(std::move(driver)), m_onRelease(std::move(onRelease)), m_cancellation(std::move(cancellation)) {}
+    ~QueryLane() { release(); }
+
+    QueryLane(const QueryLane&) = delete;
+    QueryLane& operator=(const QueryLane&) = delete;
+    QueryLane(QueryLane&& other) noexcept
+        : m_driver(std::move(other.m_driver)), m_onRelease(std::exchange(other.m_onRelease, nullptr)), m_cancellation(std::move(other.m_cancellation)) {}
+    QueryLane& operator=(QueryLane&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_driver = std::move(other.m_driver);
+            m_onRelease = std::exchange(other.m_onRelease, nullptr);
+            m_cancellation = std::move(other.m_cancellation);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] const std::shared_ptr<SQLServerDriver>& driver() const noexcept { return m_driver; }
+    [[nodiscard]] explicit operator bool() const noexcept { return m_driver != nullptr; }
+    /// Inert for lanes not checked out of a connection (standalone lanes)
+    [[nodiscard]] const CancellationToken& cancellation() const noexcept { return m_cancellation; }
+
+    /// Hand the lane back early; driver() stays valid
+    void release() noexcept {
+        if (auto onRelease = std::exchange(m_onRelease, nullptr)) {
+            onRelease();
+        }
+    }
+
+private:
+    std::shared_ptr<SQLServerDriver> m_driver;
+    std::function<void()> m_onRelease;
+    CancellationToken m_cancellation;
+};
+
+}  // namespace velocitydb
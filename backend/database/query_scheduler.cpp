@@ -0,0 +1,205 @@
+#include "query_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace velocitydb {
+
+namespace {
+
+using namespace std::chrono;
+
+[[nodiscard]] local_seconds systemLocalTime() {
+    return current_zone()->to_local(floor<seconds>(system_clock::now()));
+}
+
+}  // namespace
+
+QueryScheduler::QueryScheduler(Start start, Collect collect, size_t maxConcurrent, LocalClock clock)
+    : m_start(std::move(start)), m_collect(std::move(collect)), m_maxConcurrent((std::max)(maxConcurrent, size_t{1})), m_clock(clock ? std::move(clock) : LocalClock(systemLocalTime)),
+      m_thread([this](std::stop_token stop) { run(stop); }) {}
+
+QueryScheduler::~QueryScheduler() {
+    m_thread.request_stop();
+}
+
+std::optional<local_seconds> QueryScheduler::nextRun(const ScheduledQuery& query, local_seconds after) {
+    auto next = query.schedule.next(after);
+    if (next && query.window) {
+        next = query.window->nextOpening(*next);
+    }
+    return next;
+}
+
+std::optional<local_seconds> QueryScheduler::add(ScheduledQuery query) {
+    std::optional<local_seconds> next;
+    {
+        std::lock_guard lock(m_mutex);
+        next = nextRun(query, m_clock());
+        auto existing = std::ranges::find(m_entries, query.id, [](const Entry& entry) { return entry.state.query.id; });
+        if (existing != m_entries.end()) {
+            existing->state.query = std::move(query);
+            existing->state.nextRun = next;
+        } else {
+            m_entries.push_back(Entry{.state = {.query = std::move(query), .nextRun = next}});
+        }
+        m_woken = true;
+    }
+    m_wake.notify_all();
+    return next;
+}
+
+bool QueryScheduler::remove(const std::string& id) {
+    std::lock_guard lock(m_mutex);
+    return std::erase_if(m_entries, [&](const Entry& entry) { return entry.state.query.id == id; }) > 0;
+}
+
+bool QueryScheduler::runNow(const std::string& id) {
+    {
+        std::lock_guard lock(m_mutex);
+        auto entry = std::ranges::find(m_entries, id, [](const Entry& e) { return e.state.query.id; });
+        if (entry == m_entries.end()) {
+            return false;
+        }
+        // Due now and past any window: a manual run is not held back to off-peak hours
+        entry->state.nextRun = m_clock();
+        entry->state.query.window.reset();
+        m_woken = true;
+    }
+    m_wake.notify_all();
+    return true;
+}
+
+std::vector<ScheduledQueryState> QueryScheduler::list() const {
+    std::lock_guard lock(m_mutex);
+    std::vector<ScheduledQueryState> states;
+    states.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        states.push_back(entry.state);
+    }
+    return states;
+}
+
+void QueryScheduler::wake() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_woken = true;
+    }
+    m_wake.notify_all();
+}
+
+void QueryScheduler::run(std::stop_token stop) {
+    struct Pending {
+        ScheduledQuery query;
+        std::string ticket;
+    };
+    struct Started {
+        std::string id;
+        std::string ticket;  ///< Empty when the start failed with `error`
+        std::string error;
+    };
+    auto findRun = [this](const std::string& id) {
+        return std::ranges::find_if(m_entries, [&](const Entry& entry) { return entry.state.query.id == id && entry.state.running; });
+    };
+
+    std::unique_lock lock(m_mutex);
+    while (!stop.stop_requested()) {
+        // Collect finished runs; start and collect go to the executor, so they are called without the lock
+        std::vector<Pending> running;
+        for (const auto& entry : m_entries) {
+            if (entry.state.running && !entry.ticket.empty()) {
+                running.push_back({entry.state.query, entry.ticket});
+            }
+        }
+        lock.unlock();
+        std::vector<std::pair<std::string, ScheduledRunOutcome>> finished;
+        for (const auto& run : running) {
+            try {
+                if (auto outcome = m_collect(run.query, run.ticket)) {
+                    finished.emplace_back(run.ticket, std::move(*outcome));
+                }
+            } catch (const std::exception& e) {
+                finished.emplace_back(run.ticket, ScheduledRunOutcome{.error = e.what()});
+            }
+        }
+        lock.lock();
+        for (auto& [ticket, outcome] : finished) {
+            auto entry = std::ranges::find(m_entries, ticket, &Entry::ticket);
+            if (entry == m_entries.end()) {
+                continue;
+            }
+            entry->state.running = false;
+            entry->state.lastDurationMs = duration<double, std::milli>(steady_clock::now() - entry->startedAt).count();
+            entry->state.lastOutcome = std::move(outcome);
+            entry->ticket.clear();
+        }
+
+        // Start due runs, earliest first, into the free slots
+        const auto now = m_clock();
+        size_t active = static_cast<size_t>(std::ranges::count_if(m_entries, [](const Entry& entry) { return entry.state.running; }));
+        std::vector<Entry*> due;
+        for (auto& entry : m_entries) {
+            auto& state = entry.state;
+            if (!state.nextRun || *state.nextRun > now) {
+                continue;
+            }
+            if (state.running) {
+                ++state.skipped;
+                state.nextRun = nextRun(state.query, now);
+            } else if (state.query.window && !state.query.window->contains(now)) {
+                state.nextRun = state.query.window->nextOpening(now);
+            } else {
+                due.push_back(&entry);
+            }
+        }
+        std::ranges::sort(due, {}, [](const Entry* entry) { return *entry->state.nextRun; });
+        std::vector<ScheduledQuery> starting;
+        for (auto* entry : due) {
+            if (active == m_maxConcurrent) {
+                break;  // Stays due and starts once a slot frees up
+            }
+            ++active;
+            auto& state = entry->state;
+            state.running = true;
+            state.lastStart = now;
+            ++state.runs;
+            state.nextRun = nextRun(state.query, now);
+            entry->startedAt = steady_clock::now();
+            starting.push_back(state.query);
+        }
+        lock.unlock();
+        std::vector<Started> started;
+        for (const auto& query : starting) {
+            try {
+                started.push_back({.id = query.id, .ticket = m_start(query)});
+            } catch (const std::exception& e) {
+                started.push_back({.id = query.id, .error = e.what()});
+            }
+        }
+        lock.lock();
+        for (auto& run : started) {
+            auto entry = findRun(run.id);
+            if (entry == m_entries.end() || !entry->ticket.empty()) {
+                continue;
+            }
+            if (run.ticket.empty()) {
+                entry->state.running = false;
+                entry->state.lastOutcome = ScheduledRunOutcome{.error = std::move(run.error)};
+            } else {
+                entry->ticket = std::move(run.ticket);
+            }
+        }
+
+        // Sleep until the next run is due, a run finishes or the schedule changes
+        auto sleep = duration_cast<seconds>(MAX_SLEEP);
+        for (const auto& entry : m_entries) {
+            if (entry.state.nextRun && !entry.state.running && *entry.state.nextRun > now) {
+                sleep = (std::min)(sleep, duration_cast<seconds>(*entry.state.nextRun - now));
+            }
+        }
+        (void)m_wake.wait_for(lock, stop, sleep, [this] { return m_woken; });
+        m_woken = false;
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "cron_schedule.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+
+/// A query run on a cron schedule to warm the result caches ahead of the people who read it
+struct ScheduledQuery {
+    std::string id;
+    std::string connectionId;
+    std::string sql;
+    CronSchedule schedule;
+    std::optional<TimeWindow> window;  ///< Runs only start inside it; a run due outside waits for it to open
+};
+
+/// How one run ended
+struct ScheduledRunOutcome {
+    bool success = false;
+    std::string error;
+    size_t rows = 0;
+};
+
+/// A scheduled query with what happened to it so far
+struct ScheduledQueryState {
+    ScheduledQuery query;
+    std::optional<std::chrono::local_seconds> nextRun;  ///< nullopt when the schedule never matches again
+    bool running = false;
+    uint64_t runs = 0;
+    uint64_t skipped = 0;  ///< Runs not started because the previous one was still going
+    std::optional<std::chrono::local_seconds> lastStart;
+    double lastDurationMs = 0.0;
+    std::optional<ScheduledRunOutcome> lastOutcome;
+};
+
+/// Starts scheduled queries when they come due, at most `maxConcurrent` at a time.
+///
+/// The scheduler only decides when: `start` submits a run (to the async query executor) and returns a ticket;
+/// `collect` turns a finished ticket into its outcome. Both are called on the scheduler's own thread, which
+/// collects after every wake() and at least once a minute. Due runs wait for a free slot; a run that comes due
+/// while the previous one of the same query is still going is skipped rather than queued behind it.
+class QueryScheduler {
+public:
+    static constexpr size_t DEFAULT_MAX_CONCURRENT = 2;
+    /// Longest sleep between checks, so clock changes, daylight saving and resume from standby are noticed
+    static constexpr auto MAX_SLEEP = std::chrono::seconds{60};
+
+    /// Submit a run of the query; returns a ticket, throws when the run could not be started
+    using Start = std::function<std::string(const ScheduledQuery& query)>;
+    /// The outcome of the run under `ticket`, nullopt while it is still going
+    using Collect = std::function<std::optional<ScheduledRunOutcome>(const ScheduledQuery& query, const std::string& ticket)>;
+    /// Current local wall-clock time
+    using LocalClock = std::function<std::chrono::local_seconds()>;
+
+    /// `clock` defaults to the system clock in the current time zone
+    QueryScheduler(Start start, Collect collect, size_t maxConcurrent = DEFAULT_MAX_CONCURRENT, LocalClock clock = {});
+    ~QueryScheduler();
+
+    QueryScheduler(const QueryScheduler&) = delete;
+    QueryScheduler& operator=(const QueryScheduler&) = delete;
+    QueryScheduler(QueryScheduler&&) = delete;
+    QueryScheduler& operator=(QueryScheduler&&) = delete;
+
+    /// Add `query`, or replace the one with its id (a run in progress is still collected); returns its next run
+    std::optional<std::chrono::local_seconds> add(ScheduledQuery query);
+    /// Drop a query; a run in progress finishes but is not collected. False when there was none.
+    bool remove(const std::string& id);
+    /// Make a query due now; false when there is none
+    bool runNow(const std::string& id);
+    /// Every query in the order added
+    [[nodiscard]] std::vector<ScheduledQueryState> list() const;
+
+    /// A run may have finished: collect before the next timed check
+    void wake();
+
+private:
+    struct Entry {
+        ScheduledQueryState state;
+        std::string ticket;  ///< Of the run in progress
+        std::chrono::steady_clock::time_point startedAt;
+    };
+
+    void run(std::stop_token stop);
+    /// Next run of `query` after `after`, moved into its window
+    [[nodiscard]] static std::optional<std::chrono::local_seconds> nextRun(const ScheduledQuery& query, std::chrono::local_seconds after);
+
+    const Start m_start;
+    const Collect m_collect;
+    const size_t m_maxConcurrent;
+    const LocalClock m_clock;
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable_any m_wake;
+    std::vector<Entry> m_entries;
+    bool m_woken = false;
+
+    std::jthread m_thread;  // Last member: stopped and joined before the rest goes
+};
+
+}  // namespace velocitydb
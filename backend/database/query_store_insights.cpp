@@ -0,0 +1,275 @@
+#include "query_store_insights.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] int64_t cellInt(const ResultSet& result, size_t row, size_t column) {
+    const auto text = result.cellText(row, column);
+    int64_t value = 0;
+    (void)std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+[[nodiscard]] double cellDouble(const ResultSet& result, size_t row, size_t column) {
+    const auto text = result.cellText(row, column);
+    double value = 0;
+    (void)std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+/// "[db]." for three-part names, or nothing for the current database
+[[nodiscard]] std::string databasePrefix(std::string_view database) {
+    return database.empty() ? std::string() : detail::quoteSinglePart(database) + ".";
+}
+
+/// Plan totals while aggregating one query
+struct PlanTotals {
+    int64_t executions = 0;
+    double durationUs = 0;
+    int64_t lastIntervalId = -1;
+};
+
+}  // namespace
+
+std::optional<QueryStoreRanking> QueryStoreInsights::parseRanking(std::string_view name) noexcept {
+    if (name == "duration")
+        return QueryStoreRanking::Duration;
+    if (name == "cpu")
+        return QueryStoreRanking::Cpu;
+    if (name == "reads")
+        return QueryStoreRanking::Reads;
+    if (name == "executions")
+        return QueryStoreRanking::Executions;
+    if (name == "regression")
+        return QueryStoreRanking::Regression;
+    return std::nullopt;
+}
+
+std::string QueryStoreInsights::buildStatsQuery(std::string_view database, int64_t windowMinutes, int64_t fromIntervalId) {
+    const auto db = databasePrefix(database);
+    // Runtime stats hold one row per plan, interval and execution type; averages are weighted back into totals.
+    // Times are minutes since 2000-01-01 UTC so the window can be applied to cached rows without date parsing.
+    return std::format(
+        "SELECT actual_state_desc, DATEDIFF_BIG(MINUTE, '20000101', SYSUTCDATETIME()) AS now_minute FROM {}sys.database_query_store_options;\n"
+        "SELECT p.query_id, rs.plan_id, rs.runtime_stats_interval_id, DATEDIFF_BIG(MINUTE, '20000101', MAX(i.end_time)) AS end_minute,\n"
+        "  SUM(rs.count_executions) AS executions, SUM(rs.avg_duration * rs.count_executions) AS duration_us, MAX(rs.max_duration) AS max_duration_us,\n"
+        "  SUM(rs.avg_cpu_time * rs.count_executions) AS cpu_us, SUM(rs.avg_logical_io_reads * rs.count_executions) AS logical_reads\n"
+        "FROM {}sys.query_store_runtime_stats rs\n"
+        "JOIN {}sys.query_store_runtime_stats_interval i ON i.runtime_stats_interval_id = rs.runtime_stats_interval_id\n"
+        "JOIN {}sys.query_store_plan p ON p.plan_id = rs.plan_id\n"
+        "WHERE rs.runtime_stats_interval_id >= {} AND i.end_time > DATEADD(MINUTE, -{}, SYSUTCDATETIME())\n"
+        "GROUP BY p.query_id, rs.plan_id, rs.runtime_stats_interval_id",
+        db, db, db, db, fromIntervalId, windowMinutes);
+}
+
+std::string QueryStoreInsights::buildTextQuery(std::string_view database, std::span<const int64_t> queryIds) {
+    const auto db = databasePrefix(database);
+    // OBJECT_NAME resolves in the current database unless given the id of the inspected one
+    const auto dbId = database.empty() ? std::string() : std::format(", DB_ID(N'{}')", escapeSqlString(database));
+    std::string ids;
+    for (const int64_t id : queryIds) {
+        if (!ids.empty()) {
+            ids += ',';
+        }
+        ids += std::to_string(id);
+    }
+    return std::format(
+        "SELECT q.query_id, LEFT(t.query_sql_text, {}) AS query_text, ISNULL(OBJECT_SCHEMA_NAME(q.object_id{}) + '.' + OBJECT_NAME(q.object_id{}), '') AS object_name\n"
+        "FROM {}sys.query_store_query q JOIN {}sys.query_store_query_text t ON t.query_text_id = q.query_text_id\n"
+        "WHERE q.query_id IN ({})",
+        QUERY_TEXT_CHARS, dbId, dbId, db, db, ids);
+}
+
+std::shared_ptr<QueryStoreInsights::State> QueryStoreInsights::stateFor(std::string_view connectionId, std::string_view database) {
+    std::string key = std::format("{}\n{}", connectionId, database);
+    std::lock_guard lock(m_mutex);
+    auto& state = m_states[std::move(key)];
+    if (!state) {
+        state = std::make_shared<State>();
+    }
+    return state;
+}
+
+void QueryStoreInsights::forget(std::string_view connectionId) {
+    const std::string prefix = std::format("{}\n", connectionId);
+    std::lock_guard lock(m_mutex);
+    std::erase_if(m_states, [&prefix](const auto& entry) { return entry.first.starts_with(prefix); });
+}
+
+QueryStoreReport QueryStoreInsights::report(std::string_view connectionId, IDatabaseDriver& driver, const Request& request) {
+    const int64_t window = std::clamp<int64_t>(request.windowMinutes, 1, MAX_WINDOW_MINUTES);
+    auto state = stateFor(connectionId, request.database);
+    std::lock_guard lock(state->mutex);
+
+    // A wider window than the cached one needs intervals that were never read
+    const bool incremental = !request.fullRefresh && state->lastIntervalId >= 0 && window <= state->windowMinutes;
+    if (!incremental) {
+        state->samples.clear();
+        state->lastIntervalId = -1;
+    }
+    state->windowMinutes = window;
+
+    auto results = driver.executeMultiple(buildStatsQuery(request.database, window, (std::max)(state->lastIntervalId, int64_t{0})));
+    if (results.size() < 2 || results[0].empty()) [[unlikely]] {
+        throw std::runtime_error("Query Store is not available on this database");
+    }
+    const auto& options = results[0];
+    const auto queryStoreState = options.cellText(0, 0);
+    if (queryStoreState == "OFF" || queryStoreState == "ERROR") [[unlikely]] {
+        throw std::runtime_error(std::format("Query Store is {} for database {}", queryStoreState, request.database.empty() ? "(current)" : request.database));
+    }
+    const int64_t nowMinute = cellInt(options, 0, 1);
+
+    const auto& stats = results[1];
+    for (size_t row = 0; row < stats.rowCount(); ++row) {
+        const int64_t planId = cellInt(stats, row, 1);
+        const int64_t intervalId = cellInt(stats, row, 2);
+        state->samples[{planId, intervalId}] = Sample{.queryId = cellInt(stats, row, 0),
+                                                      .endMinute = cellInt(stats, row, 3),
+                                                      .executions = cellInt(stats, row, 4),
+                                                      .durationUs = cellDouble(stats, row, 5),
+                                                      .maxDurationUs = cellDouble(stats, row, 6),
+                                                      .cpuUs = cellDouble(stats, row, 7),
+                                                      .reads = cellDouble(stats, row, 8)};
+        state->lastIntervalId = (std::max)(state->lastIntervalId, intervalId);
+    }
+    std::erase_if(state->samples, [cutoff = nowMinute - window](const auto& entry) { return entry.second.endMinute <= cutoff; });
+
+    // Texts for queries seen for the first time; those that left the window are dropped
+    std::unordered_set<int64_t> live;
+    std::unordered_set<int64_t> intervals;
+    for (const auto& [key, sample] : state->samples) {
+        live.insert(sample.queryId);
+        intervals.insert(key.second);
+    }
+    std::erase_if(state->texts, [&live](const auto& entry) { return !live.contains(entry.first); });
+    std::vector<int64_t> missing;
+    for (const int64_t queryId : live) {
+        if (!state->texts.contains(queryId)) {
+            missing.push_back(queryId);
+        }
+    }
+    std::ranges::sort(missing);
+    for (size_t begin = 0; begin < missing.size(); begin += TEXT_LOOKUP_BATCH) {
+        const auto batch = std::span(missing).subspan(begin, (std::min)(TEXT_LOOKUP_BATCH, missing.size() - begin));
+        const auto texts = driver.execute(buildTextQuery(request.database, batch));
+        for (size_t row = 0; row < texts.rowCount(); ++row) {
+            state->texts[cellInt(texts, row, 0)] = QueryText{.text = texts.cellText(row, 1), .objectName = texts.cellText(row, 2)};
+        }
+    }
+
+    QueryStoreReport report;
+    report.database = request.database;
+    report.windowMinutes = window;
+    report.intervals = intervals.size();
+    report.incremental = incremental;
+    report.queries = rank(*state, request.rankBy);
+    report.trackedQueries = report.queries.size();
+    if (report.queries.size() > request.top) {
+        report.queries.resize(request.top);
+    }
+    for (auto& query : report.queries) {
+        if (auto found = state->texts.find(query.queryId); found != state->texts.end()) {
+            query.text = found->second.text;
+            query.objectName = found->second.objectName;
+        }
+    }
+    return report;
+}
+
+std::vector<QueryStoreQuery> QueryStoreInsights::rank(const State& state, QueryStoreRanking rankBy) {
+    struct Totals {
+        QueryStoreQuery query;
+        double cpuUs = 0;
+        double reads = 0;
+        std::unordered_map<int64_t, PlanTotals> plans;
+    };
+    std::unordered_map<int64_t, Totals> byQuery;
+    for (const auto& [key, sample] : state.samples) {
+        auto& totals = byQuery[sample.queryId];
+        totals.query.queryId = sample.queryId;
+        totals.query.executions += sample.executions;
+        totals.query.totalDurationMs += sample.durationUs / 1000.0;
+        totals.query.maxDurationMs = (std::max)(totals.query.maxDurationMs, sample.maxDurationUs / 1000.0);
+        totals.cpuUs += sample.cpuUs;
+        totals.reads += sample.reads;
+        auto& plan = totals.plans[key.first];
+        plan.executions += sample.executions;
+        plan.durationUs += sample.durationUs;
+        plan.lastIntervalId = (std::max)(plan.lastIntervalId, key.second);
+    }
+
+    std::vector<QueryStoreQuery> queries;
+    queries.reserve(byQuery.size());
+    for (auto& [queryId, totals] : byQuery) {
+        auto& query = totals.query;
+        if (query.executions <= 0) {
+            continue;
+        }
+        const auto executions = static_cast<double>(query.executions);
+        query.avgDurationMs = query.totalDurationMs / executions;
+        query.avgCpuMs = totals.cpuUs / 1000.0 / executions;
+        query.avgLogicalReads = totals.reads / executions;
+        query.planCount = totals.plans.size();
+
+        // Latest plan against the one used before it: a plan change that made the query slower
+        const auto newer = [](const auto& a, const auto& b) {
+            return a.second.lastIntervalId != b.second.lastIntervalId ? a.second.lastIntervalId < b.second.lastIntervalId : a.first < b.first;
+        };
+        const auto latest = std::ranges::max_element(totals.plans, newer);
+        query.planId = latest->first;
+        auto previous = totals.plans.end();
+        for (auto it = totals.plans.begin(); it != totals.plans.end(); ++it) {
+            if (it != latest && (previous == totals.plans.end() || newer(*previous, *it))) {
+                previous = it;
+            }
+        }
+        if (previous != totals.plans.end() && previous->second.executions > 0 && latest->second.executions > 0) {
+            query.previousPlanId = previous->first;
+            const double latestAvg = latest->second.durationUs / static_cast<double>(latest->second.executions);
+            query.previousAvgDurationMs = previous->second.durationUs / static_cast<double>(previous->second.executions) / 1000.0;
+            if (query.previousAvgDurationMs > 0) {
+                query.regressionRatio = latestAvg / 1000.0 / query.previousAvgDurationMs;
+                query.regressed = query.regressionRatio >= REGRESSION_RATIO;
+            }
+        }
+        queries.push_back(std::move(query));
+    }
+
+    if (rankBy == QueryStoreRanking::Regression) {
+        std::erase_if(queries, [](const QueryStoreQuery& query) { return !query.regressed; });
+    }
+    const auto score = [rankBy](const QueryStoreQuery& query) {
+        const auto executions = static_cast<double>(query.executions);
+        switch (rankBy) {
+            case QueryStoreRanking::Cpu:
+                return query.avgCpuMs * executions;
+            case QueryStoreRanking::Reads:
+                return query.avgLogicalReads * executions;
+            case QueryStoreRanking::Executions:
+                return executions;
+            case QueryStoreRanking::Regression:
+                return query.regressionRatio;
+            case QueryStoreRanking::Duration:
+                break;
+        }
+        return query.totalDurationMs;
+    };
+    std::ranges::sort(queries, [&score](const QueryStoreQuery& a, const QueryStoreQuery& b) {
+        const double left = score(a);
+        const double right = score(b);
+        return left != right ? left > right : a.queryId < b.queryId;
+    });
+    return queries;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace velocitydb {
+
+/// One query's Query Store aggregates over the report window
+struct QueryStoreQuery {
+    int64_t queryId = 0;
+    std::string text;        ///< First QUERY_TEXT_CHARS characters
+    std::string objectName;  ///< Procedure/function the query belongs to (empty for ad hoc SQL)
+    int64_t executions = 0;
+    double totalDurationMs = 0;
+    double avgDurationMs = 0;
+    double maxDurationMs = 0;
+    double avgCpuMs = 0;
+    double avgLogicalReads = 0;
+    size_t planCount = 0;
+    int64_t planId = 0;  ///< Most recently used plan
+    /// Set when the latest plan replaced another one and runs at least REGRESSION_RATIO times slower
+    bool regressed = false;
+    int64_t previousPlanId = 0;
+    double previousAvgDurationMs = 0;
+    double regressionRatio = 0;  ///< Latest plan's average duration over the previous plan's (0 with one plan)
+};
+
+enum class QueryStoreRanking : uint8_t { Duration, Cpu, Reads, Executions, Regression };
+
+struct QueryStoreReport {
+    std::string database;
+    int64_t windowMinutes = 0;
+    size_t intervals = 0;      ///< Query Store aggregation intervals in the window
+    size_t trackedQueries = 0; ///< Queries with executions in the window (before ranking cut them to `top`)
+    bool incremental = false;  ///< Only the newest intervals were read from the server
+    std::vector<QueryStoreQuery> queries;
+};
+
+/// Top resource-consuming and regressed queries from a database's Query Store
+/// (sys.query_store_runtime_stats per plan and interval, sys.query_store_plan for the query of each plan).
+///
+/// The per-plan, per-interval aggregates of a connection/database are kept between calls. A later report only
+/// reads intervals from the newest one already held (which may still have been open) onwards and drops those that
+/// left the window, so refreshing a dashboard costs one small DMV query. Query texts are fetched once per query.
+class QueryStoreInsights {
+public:
+    static constexpr int64_t DEFAULT_WINDOW_MINUTES = 24 * 60;
+    static constexpr int64_t MAX_WINDOW_MINUTES = 90 * 24 * 60;
+    static constexpr size_t DEFAULT_TOP = 25;
+    static constexpr double REGRESSION_RATIO = 1.5;
+    static constexpr size_t QUERY_TEXT_CHARS = 400;
+    static constexpr size_t TEXT_LOOKUP_BATCH = 500;  ///< Query ids per text lookup
+
+    struct Request {
+        std::string database;  ///< Empty: the connection's current database
+        int64_t windowMinutes = DEFAULT_WINDOW_MINUTES;
+        QueryStoreRanking rankBy = QueryStoreRanking::Duration;
+        size_t top = DEFAULT_TOP;
+        bool fullRefresh = false;  ///< Discard what is cached and read the whole window again
+    };
+
+    QueryStoreInsights() = default;
+    QueryStoreInsights(const QueryStoreInsights&) = delete;
+    QueryStoreInsights& operator=(const QueryStoreInsights&) = delete;
+
+    /// Refresh the cache for `connectionId` through `driver` (a metadata connection) and rank its queries
+    /// @throws std::runtime_error when Query Store is off for the database, or on driver errors
+    [[nodiscard]] QueryStoreReport report(std::string_view connectionId, IDatabaseDriver& driver, const Request& request);
+
+    /// Drop everything cached for `connectionId`
+    void forget(std::string_view connectionId);
+
+    [[nodiscard]] static std::optional<QueryStoreRanking> parseRanking(std::string_view name) noexcept;
+
+    /// Batch returning the Query Store state and the server's clock, then the aggregates of every plan for each
+    /// interval from `fromIntervalId` on that ended within the window
+    [[nodiscard]] static std::string buildStatsQuery(std::string_view database, int64_t windowMinutes, int64_t fromIntervalId);
+    [[nodiscard]] static std::string buildTextQuery(std::string_view database, std::span<const int64_t> queryIds);
+
+private:
+    struct Sample {
+        int64_t queryId = 0;
+        int64_t endMinute = 0;  ///< Interval end, minutes since 2000-01-01 UTC
+        int64_t executions = 0;
+        double durationUs = 0;  ///< Totals over the interval's executions
+        double maxDurationUs = 0;
+        double cpuUs = 0;
+        double reads = 0;
+    };
+
+    struct QueryText {
+        std::string text;
+        std::string objectName;
+    };
+
+    struct State {
+        std::mutex mutex;  ///< Held for a whole refresh, so one connection's refreshes do not overlap
+        int64_t windowMinutes = 0;
+        int64_t lastIntervalId = -1;
+        std::map<std::pair<int64_t, int64_t>, Sample> samples;  ///< By (plan_id, runtime_stats_interval_id)
+        std::unordered_map<int64_t, QueryText> texts;            ///< By query_id
+    };
+
+    [[nodiscard]] std::shared_ptr<State> stateFor(std::string_view connectionId, std::string_view database);
+    /// Aggregate the cached samples per query and order them by `rankBy`
+    [[nodiscard]] static std::vector<QueryStoreQuery> rank(const State& state, QueryStoreRanking rankBy);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<State>> m_states;  ///< By connection id + '\n' + database
+};
+
+}  // namespace velocitydb
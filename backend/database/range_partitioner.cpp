@@ -0,0 +1,160 @@
+#include "range_partitioner.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] bool equalsIgnoreCase(std::string_view a, std::string_view b) noexcept {
+    return std::ranges::equal(a, b, [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+}
+
+[[nodiscard]] bool isTypeIn(std::string_view sqlType, std::initializer_list<std::string_view> names) noexcept {
+    return std::ranges::any_of(names, [&](std::string_view name) { return equalsIgnoreCase(sqlType, name); });
+}
+
+[[nodiscard]] bool isIntegerType(std::string_view sqlType) noexcept {
+    return isTypeIn(sqlType, {"tinyint", "smallint", "int", "bigint"});
+}
+
+/// SQL literal for a boundary key; integer keys are checked so nothing but digits reaches the statement
+[[nodiscard]] std::string keyLiteral(const PartitionPlan& plan, std::string_view key) {
+    if (isIntegerType(plan.type)) {
+        int64_t value = 0;
+        auto [end, ec] = std::from_chars(key.data(), key.data() + key.size(), value);
+        if (ec != std::errc{} || end != key.data() + key.size()) [[unlikely]] {
+            throw std::runtime_error(std::format("Unexpected histogram key for {}: {}", plan.column, key));
+        }
+        return std::to_string(value);
+    }
+    return std::format("'{}'", escapeSqlString(key));
+}
+
+[[nodiscard]] double parseRows(std::string_view text) noexcept {
+    double value = 0.0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+[[nodiscard]] int64_t parseKey(std::string_view text) noexcept {
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+}  // namespace
+
+bool isPartitionableType(std::string_view sqlType) noexcept {
+    return isIntegerType(sqlType) || isTypeIn(sqlType, {"date", "datetime", "datetime2", "smalldatetime"});
+}
+
+std::vector<KeyRange> splitHistogram(const std::vector<HistogramStep>& steps, size_t partitions) {
+    partitions = std::clamp(partitions, size_t{1}, MAX_KEY_RANGES);
+    double total = 0.0;
+    for (const auto& step : steps) {
+        total += step.rows;
+    }
+
+    std::vector<std::string> boundaries;
+    double cumulative = 0.0;
+    // The last step closes the last range, so it never becomes a boundary
+    for (size_t i = 0; i + 1 < steps.size() && boundaries.size() + 1 < partitions; ++i) {
+        cumulative += steps[i].rows;
+        if (cumulative >= total * static_cast<double>(boundaries.size() + 1) / static_cast<double>(partitions) && (boundaries.empty() || boundaries.back() != steps[i].highKey)) {
+            boundaries.push_back(steps[i].highKey);
+        }
+    }
+
+    std::vector<KeyRange> ranges;
+    std::optional<std::string> low;
+    for (auto& boundary : boundaries) {
+        ranges.push_back({.low = low, .high = boundary});
+        low = std::move(boundary);
+    }
+    ranges.push_back({.low = std::move(low), .high = std::nullopt});
+    return ranges;
+}
+
+PartitionPlan planKeyRanges(IDatabaseDriver& driver, std::string_view table, std::string_view column, size_t partitions) {
+    const auto [schemaName, tableName] = splitSchemaTable(table);
+    PartitionPlan plan;
+    plan.table = std::format("{}.{}", detail::quoteSinglePart(schemaName), detail::quoteSinglePart(tableName));
+    const auto object = std::format("N'{}'", escapeSqlString(plan.table));
+
+    // Index 1 is always the clustered index; its first key column is the default partitioning key
+    const auto keyFilter = column.empty() ? std::string("ic.index_id IS NOT NULL") : std::format("c.name = N'{}'", escapeSqlString(detail::unquoteSinglePart(column)));
+    const auto key = driver.execute(std::format(R"(
+        SELECT TOP 1 c.name, TYPE_NAME(c.system_type_id)
+        FROM sys.columns c
+        LEFT JOIN sys.index_columns ic ON ic.object_id = c.object_id AND ic.column_id = c.column_id AND ic.index_id = 1 AND ic.key_ordinal = 1
+        WHERE c.object_id = OBJECT_ID({}) AND {})",
+                                                object, keyFilter));
+    if (key.rowCount() == 0) [[unlikely]] {
+        throw std::runtime_error(column.empty() ? std::format("{} has no clustered index; choose a key column", plan.table) : std::format("Column not found: {}", column));
+    }
+    const auto name = key.cellText(0, 0);
+    plan.type = key.cellText(0, 1);
+    plan.column = detail::quoteSinglePart(name);
+    if (!isPartitionableType(plan.type)) [[unlikely]] {
+        throw std::runtime_error(std::format("Cannot partition on {} ({}): choose an integer or date column", plan.column, plan.type));
+    }
+
+    const auto keyType = isIntegerType(plan.type) ? "BIGINT" : equalsIgnoreCase(plan.type, "date") ? "DATE" : "DATETIME2";
+    const auto histogram = driver.execute(std::format(R"(
+        SELECT CONVERT(NVARCHAR(64), CAST(h.range_high_key AS {}), 126), h.range_rows + h.equal_rows
+        FROM (SELECT TOP 1 s.object_id, s.stats_id
+              FROM sys.stats s
+              JOIN sys.stats_columns sc ON sc.object_id = s.object_id AND sc.stats_id = s.stats_id AND sc.stats_column_id = 1
+              WHERE s.object_id = OBJECT_ID({}) AND sc.column_id = COLUMNPROPERTY(s.object_id, N'{}', 'ColumnId')
+              ORDER BY s.stats_id) st
+        CROSS APPLY sys.dm_db_stats_histogram(st.object_id, st.stats_id) h
+        WHERE h.range_high_key IS NOT NULL
+        ORDER BY h.step_number)",
+                                                      keyType, object, escapeSqlString(name)));
+
+    std::vector<HistogramStep> steps;
+    for (size_t row = 0; row < histogram.rowCount(); ++row) {
+        steps.push_back({.highKey = histogram.cellText(row, 0), .rows = parseRows(histogram.cellText(row, 1))});
+    }
+
+    if (steps.empty() && isIntegerType(plan.type) && partitions > 1) {
+        // No statistics yet (or a server without dm_db_stats_histogram): assume keys spread evenly
+        const auto bounds = driver.execute(std::format("SELECT CAST(MIN({}) AS BIGINT), CAST(MAX({}) AS BIGINT) FROM {}", plan.column, plan.column, plan.table));
+        if (bounds.rowCount() == 1 && !bounds.isNull(0, 0) && !bounds.isNull(0, 1)) {
+            const auto low = static_cast<long double>(parseKey(bounds.cellText(0, 0)));
+            const auto high = static_cast<long double>(parseKey(bounds.cellText(0, 1)));
+            for (size_t part = 1; part <= partitions; ++part) {
+                const auto boundary = static_cast<int64_t>(low + (high - low) * static_cast<long double>(part) / static_cast<long double>(partitions));
+                steps.push_back({.highKey = std::to_string(boundary), .rows = 1.0});
+            }
+        }
+    }
+    plan.ranges = splitHistogram(steps, partitions);
+    return plan;
+}
+
+std::string keyRangeQuery(const PartitionPlan& plan, size_t index, bool ordered) {
+    const auto& range = plan.ranges.at(index);
+    std::string sql = std::format("SELECT * FROM {}", plan.table);
+    if (range.low && range.high) {
+        sql += std::format(" WHERE {} > {} AND {} <= {}", plan.column, keyLiteral(plan, *range.low), plan.column, keyLiteral(plan, *range.high));
+    } else if (range.high) {
+        sql += std::format(" WHERE {} <= {} OR {} IS NULL", plan.column, keyLiteral(plan, *range.high), plan.column);
+    } else if (range.low) {
+        sql += std::format(" WHERE {} > {}", plan.column, keyLiteral(plan, *range.low));
+    }
+    if (ordered) {
+        sql += std::format(" ORDER BY {}", plan.column);
+    }
+    return sql;
+}
+
+}  // namespace velocitydb
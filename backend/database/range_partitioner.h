@@ -0,0 +1,51 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// One step of a statistics histogram (sys.dm_db_stats_histogram)
+struct HistogramStep {
+    std::string highKey;  ///< RANGE_HI_KEY as text (ISO 8601 for dates)
+    double rows = 0.0;    ///< RANGE_ROWS + EQ_ROWS
+};
+
+/// Keys in (low, high]; a missing end is unbounded. The first range of a plan also takes the NULL keys.
+struct KeyRange {
+    std::optional<std::string> low;
+    std::optional<std::string> high;
+};
+
+/// How to read a table as independent key ranges
+struct PartitionPlan {
+    std::string table;   ///< Quoted [schema].[table]
+    std::string column;  ///< Quoted key column
+    std::string type;    ///< Its system type name
+    std::vector<KeyRange> ranges;
+};
+
+inline constexpr size_t MAX_KEY_RANGES = 256;
+
+/// Whether a column of this system type can be range-partitioned (integers and dates)
+[[nodiscard]] bool isPartitionableType(std::string_view sqlType) noexcept;
+
+/// Cut `steps` into at most `partitions` ranges of roughly equal row counts. Boundaries fall on step keys, so
+/// a single step heavier than the target stays whole and fewer ranges may come back.
+[[nodiscard]] std::vector<KeyRange> splitHistogram(const std::vector<HistogramStep>& steps, size_t partitions);
+
+/// Plan `partitions` key ranges for `table` (schema.table, optionally bracket-quoted) on `column`, or on the
+/// leading key of the clustered index when `column` is empty. Boundaries come from the column's statistics
+/// histogram; without one, integer keys are split evenly between MIN and MAX and anything else is one range.
+/// @throws std::runtime_error when the table or column is missing or the column is not an integer or date
+[[nodiscard]] PartitionPlan planKeyRanges(IDatabaseDriver& driver, std::string_view table, std::string_view column, size_t partitions);
+
+/// SELECT of the rows in range `index` of `plan`; with `ordered`, in key order
+[[nodiscard]] std::string keyRangeQuery(const PartitionPlan& plan, size_t index, bool ordered);
+
+}  // namespace velocitydb
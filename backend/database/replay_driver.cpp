@@ -0,0 +1,497 @@
+#include "replay_driver.h"
+
+#include "../utils/binary_result.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "replay recording format is little-endian");
+
+constexpr std::string_view MAGIC = "VDBP";
+
+[[nodiscard]] std::string_view trimSql(std::string_view sql) noexcept {
+    constexpr std::string_view whitespace = " \t\r\n;";
+    const auto first = sql.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return sql.substr(first, sql.find_last_not_of(whitespace) - first + 1);
+}
+
+template <typename T>
+void putValue(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+/// Bounds-checked reader over a loaded recording
+class Reader {
+public:
+    explicit Reader(std::string_view data) noexcept : m_data(data) {}
+
+    template <typename T>
+    [[nodiscard]] T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] std::string_view take(size_t size) {
+        if (size > m_data.size() - m_pos) [[unlikely]] {
+            throw std::runtime_error("Replay recording is truncated");
+        }
+        auto bytes = m_data.substr(m_pos, size);
+        m_pos += size;
+        return bytes;
+    }
+
+private:
+    std::string_view m_data;
+    size_t m_pos = 0;
+};
+
+/// splitmix64: cheap, stateless and identical on every platform, so synthetic cells are reproducible
+[[nodiscard]] constexpr uint64_t mix(uint64_t value) noexcept {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+constexpr std::array<std::string_view, 12> SYNTHETIC_WORDS = {
+    "alpha", "bravo", "charlie", "delta", "東京", "大阪", "say \"hi\"", "comma,separated", "O'Brien", "customer", "order", "ünïcödé",
+};
+
+/// FNV-1a of the SQL text seeds the synthetic result, so each query has its own stable data
+[[nodiscard]] uint64_t sqlSeed(std::string_view sql) noexcept {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char c : sql) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+[[nodiscard]] bool equalsIgnoreCase(std::string_view a, std::string_view b) noexcept {
+    return std::ranges::equal(a, b, [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+}
+
+template <typename T>
+[[nodiscard]] bool parseNumber(std::string_view text, T& value) noexcept {
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc{} && ptr == text.data() + text.size();
+}
+
+/// Copy rows [first, first + count) of `source` into `batch`, reusing the batch's storage
+void fillBatch(ResultSet& batch, const ResultSet& source, size_t first, size_t count) {
+    batch.clearRows();
+    for (size_t row = first; row < first + count; ++row) {
+        batch.appendRowFrom(source, row);
+    }
+}
+
+}  // namespace
+
+ReplayDriver::ReplayDriver(ReplayTiming timing) : m_timing(timing) {}
+
+bool ReplayDriver::connect(std::string_view connectionString) {
+    ReplayTiming timing = this->timing();
+    std::optional<SyntheticResultShape> synthetic;
+    std::string file;
+
+    while (!connectionString.empty()) {
+        const auto end = connectionString.find(';');
+        const auto pair = connectionString.substr(0, end);
+        connectionString = end == std::string_view::npos ? std::string_view{} : connectionString.substr(end + 1);
+
+        const auto eq = pair.find('=');
+        if (eq == std::string_view::npos) {
+            continue;
+        }
+        const auto key = trimSql(pair.substr(0, eq));
+        const auto value = pair.substr(eq + 1);
+        bool valid = true;
+        if (equalsIgnoreCase(key, "File")) {
+            file = value;
+        } else if (equalsIgnoreCase(key, "LatencyMs") || equalsIgnoreCase(key, "ConnectLatencyMs")) {
+            int64_t ms = 0;
+            valid = parseNumber(value, ms) && ms >= 0;
+            (equalsIgnoreCase(key, "LatencyMs") ? timing.executeLatency : timing.connectLatency) = std::chrono::milliseconds(ms);
+        } else if (equalsIgnoreCase(key, "RowsPerSecond")) {
+            valid = parseNumber(value, timing.rowsPerSecond) && timing.rowsPerSecond >= 0.0;
+        } else if (equalsIgnoreCase(key, "SyntheticRows")) {
+            synthetic.emplace();
+            valid = parseNumber(value, synthetic->rows);
+        }
+        if (!valid) [[unlikely]] {
+            std::lock_guard lock(m_mutex);
+            m_lastError = std::format("Invalid replay connection value: {}", pair);
+            return false;
+        }
+    }
+
+    if (!file.empty() && !load(file)) {
+        return false;
+    }
+    setTiming(timing);
+    if (synthetic) {
+        setSyntheticFallback(synthetic);
+    }
+    if (timing.connectLatency.count() > 0 && !waitUntil(std::chrono::steady_clock::now() + timing.connectLatency)) {
+        return false;
+    }
+    m_connected.store(true, std::memory_order_release);
+    return true;
+}
+
+void ReplayDriver::disconnect() {
+    cancel();
+    m_connected.store(false, std::memory_order_release);
+}
+
+void ReplayDriver::cancel() {
+    {
+        std::lock_guard lock(m_waitMutex);
+        m_cancelled.store(true, std::memory_order_release);
+    }
+    m_waitCv.notify_all();
+
+    std::shared_ptr<IDatabaseDriver> source;
+    {
+        std::lock_guard lock(m_mutex);
+        source = m_source;
+    }
+    if (source) {
+        source->cancel();
+    }
+}
+
+std::string ReplayDriver::getLastError() const {
+    std::lock_guard lock(m_mutex);
+    return m_lastError;
+}
+
+void ReplayDriver::setTiming(const ReplayTiming& timing) {
+    std::lock_guard lock(m_mutex);
+    m_timing = timing;
+}
+
+ReplayTiming ReplayDriver::timing() const {
+    std::lock_guard lock(m_mutex);
+    return m_timing;
+}
+
+void ReplayDriver::addResult(std::string_view sql, ResultSet result) {
+    std::vector<ResultSet> results;
+    results.push_back(std::move(result));
+    addResults(sql, std::move(results));
+}
+
+void ReplayDriver::addResults(std::string_view sql, std::vector<ResultSet> results) {
+    auto entry = std::make_shared<const std::vector<ResultSet>>(std::move(results));
+    std::lock_guard lock(m_mutex);
+    m_entries.insert_or_assign(std::string(trimSql(sql)), std::move(entry));
+}
+
+void ReplayDriver::setSyntheticFallback(std::optional<SyntheticResultShape> shape) {
+    std::lock_guard lock(m_mutex);
+    m_synthetic = shape;
+}
+
+void ReplayDriver::recordFrom(std::shared_ptr<IDatabaseDriver> source) {
+    std::lock_guard lock(m_mutex);
+    m_source = std::move(source);
+}
+
+size_t ReplayDriver::entryCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+ResultSet ReplayDriver::makeSyntheticResult(const SyntheticResultShape& shape, uint64_t seed) {
+    ResultSet result;
+    for (size_t c = 0; c < shape.textColumns; ++c) {
+        result.columns.push_back({.name = std::format("text_{}", c), .type = "NVARCHAR", .size = static_cast<int>(shape.textBytes * 2), .nullable = true, .isPrimaryKey = false});
+        result.columnData.emplace_back(ColumnDataType::Text);
+    }
+    for (size_t c = 0; c < shape.intColumns; ++c) {
+        result.columns.push_back({.name = std::format("int_{}", c), .type = "BIGINT", .size = 19, .nullable = c != 0, .isPrimaryKey = c == 0});
+        result.columnData.emplace_back(ColumnDataType::Int64);
+    }
+    for (size_t c = 0; c < shape.doubleColumns; ++c) {
+        result.columns.push_back({.name = std::format("double_{}", c), .type = "FLOAT", .size = 53, .nullable = true, .isPrimaryKey = false});
+        result.columnData.emplace_back(ColumnDataType::Double);
+    }
+    for (size_t c = 0; c < result.columnData.size(); ++c) {
+        result.columnData[c].reserve(shape.rows, c < shape.textColumns ? shape.rows * shape.textBytes : 0);
+    }
+
+    std::string text;
+    for (size_t row = 0; row < shape.rows; ++row) {
+        for (size_t col = 0; col < result.columnData.size(); ++col) {
+            auto& column = result.columnData[col];
+            const bool isKey = col == shape.textColumns;  // int_0 is the primary key and never NULL
+            if (!isKey && shape.nullEvery != 0 && (row + col) % shape.nullEvery == 0) {
+                column.appendNull();
+                continue;
+            }
+            const uint64_t random = mix(seed ^ (row * 0x1000193ull + col));
+            switch (column.type()) {
+                case ColumnDataType::Text:
+                    text.clear();
+                    for (uint64_t bits = random; text.size() < shape.textBytes; bits = mix(bits)) {
+                        text += SYNTHETIC_WORDS[bits % SYNTHETIC_WORDS.size()];
+                        text += ' ';
+                    }
+                    text += std::to_string(row);
+                    column.appendText(text);
+                    break;
+                case ColumnDataType::Int64:
+                    column.appendInt64(isKey ? static_cast<int64_t>(row) + 1 : static_cast<int64_t>(random % 2'000'001) - 1'000'000);
+                    break;
+                default:
+                    column.appendDouble(static_cast<double>(random >> 11) * 0x1.0p-53 * 2e6 - 1e6);
+                    break;
+            }
+        }
+    }
+    return result;
+}
+
+void ReplayDriver::fail(std::string message) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_lastError = message;
+    }
+    throw std::runtime_error(message);
+}
+
+bool ReplayDriver::waitUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock lock(m_waitMutex);
+    return !m_waitCv.wait_until(lock, deadline, [this] { return m_cancelled.load(std::memory_order_acquire); });
+}
+
+std::chrono::steady_clock::time_point ReplayDriver::paceDeadline(std::chrono::steady_clock::time_point start, size_t rows, double rowsPerSecond) noexcept {
+    if (rowsPerSecond <= 0.0) {
+        return start;
+    }
+    return start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(static_cast<double>(rows) / rowsPerSecond));
+}
+
+ReplayDriver::Entry ReplayDriver::resolve(std::string_view sql) {
+    if (!isConnected()) [[unlikely]] {
+        fail("Not connected to database");
+    }
+    m_cancelled.store(false, std::memory_order_release);
+    m_executeCount.fetch_add(1, std::memory_order_relaxed);
+
+    const auto key = trimSql(sql);
+    const auto start = std::chrono::steady_clock::now();
+    Entry entry;
+    std::shared_ptr<IDatabaseDriver> source;
+    std::optional<SyntheticResultShape> synthetic;
+    std::chrono::microseconds latency{};
+    {
+        std::lock_guard lock(m_mutex);
+        m_lastError.clear();
+        latency = m_timing.executeLatency;
+        source = m_source;
+        synthetic = m_synthetic;
+        if (auto it = m_entries.find(std::string(key)); it != m_entries.end()) {
+            entry = it->second;
+        }
+    }
+
+    if (source) {
+        // Recording: the real driver supplies both the result and the latency
+        try {
+            entry = std::make_shared<const std::vector<ResultSet>>(source->executeMultiple(sql));
+        } catch (const std::exception& e) {
+            fail(e.what());
+        }
+        std::lock_guard lock(m_mutex);
+        m_entries.insert_or_assign(std::string(key), entry);
+        return entry;
+    }
+
+    if (!entry) {
+        if (!synthetic) [[unlikely]] {
+            fail(std::format("No replay recording for query: {}", key.substr(0, 200)));
+        }
+        std::vector<ResultSet> results;
+        results.push_back(makeSyntheticResult(*synthetic, sqlSeed(key)));
+        entry = std::make_shared<const std::vector<ResultSet>>(std::move(results));
+        std::lock_guard lock(m_mutex);
+        m_entries.emplace(std::string(key), entry);
+    }
+
+    if (!waitUntil(start + latency)) [[unlikely]] {
+        fail("Operation canceled");
+    }
+    return entry;
+}
+
+ResultSet ReplayDriver::execute(std::string_view sql) {
+    return executeMultiple(sql).front();
+}
+
+std::vector<ResultSet> ReplayDriver::executeMultiple(std::string_view sql) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto entry = resolve(sql);
+    const double rowsPerSecond = timing().rowsPerSecond;
+
+    const auto fetchStart = std::chrono::steady_clock::now();
+    std::vector<ResultSet> results = entry->empty() ? std::vector<ResultSet>(1) : *entry;
+    size_t totalRows = 0;
+    for (const auto& result : results) {
+        totalRows += result.rowCount();
+    }
+    if (!waitUntil(paceDeadline(fetchStart, totalRows, rowsPerSecond))) [[unlikely]] {
+        fail("Operation canceled");
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const double fetchMs = std::chrono::duration<double, std::milli>(end - fetchStart).count();
+    for (auto& result : results) {
+        result.executionTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+        result.fetchStats = FetchStats{.bulkFetch = true,
+                                       .rowsetSize = result.rowCount(),
+                                       .fetchTimeMs = fetchMs,
+                                       .rowsPerSecond = fetchMs > 0.0 ? static_cast<double>(result.rowCount()) * 1000.0 / fetchMs : 0.0};
+    }
+    return results;
+}
+
+StreamSummary ReplayDriver::executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto entry = resolve(sql);
+    const double rowsPerSecond = timing().rowsPerSecond;
+    batchRows = (std::max)(batchRows, size_t{1});
+
+    static const ResultSet emptyResult;
+    const ResultSet& source = entry->empty() ? emptyResult : entry->front();
+
+    StreamSummary summary;
+    summary.columns = source.columns;
+    summary.affectedRows = source.affectedRows;
+    sink.onColumns(summary.columns);
+
+    ResultSet batch;
+    batch.columns = source.columns;
+    for (const auto& column : source.columnData) {
+        batch.columnData.emplace_back(column.type(), column.fractionDigits());
+    }
+
+    const auto fetchStart = std::chrono::steady_clock::now();
+    const size_t rows = source.rowCount();
+    while (summary.totalRows < rows) {
+        const size_t count = (std::min)(batchRows, rows - summary.totalRows);
+        if (!waitUntil(paceDeadline(fetchStart, summary.totalRows + count, rowsPerSecond))) [[unlikely]] {
+            fail("Operation canceled");
+        }
+        fillBatch(batch, source, summary.totalRows, count);
+        summary.totalRows += count;
+        if (!sink.onBatch(batch)) {
+            summary.stopped = summary.totalRows < rows;
+            break;
+        }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const double fetchMs = std::chrono::duration<double, std::milli>(end - fetchStart).count();
+    summary.executionTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    summary.fetchStats = FetchStats{.bulkFetch = true,
+                                    .rowsetSize = batchRows,
+                                    .fetchTimeMs = fetchMs,
+                                    .rowsPerSecond = fetchMs > 0.0 ? static_cast<double>(summary.totalRows) * 1000.0 / fetchMs : 0.0};
+    return summary;
+}
+
+bool ReplayDriver::save(const std::filesystem::path& path) const {
+    std::string data(MAGIC);
+    putValue<uint16_t>(data, VERSION);
+    putValue<uint16_t>(data, 0);
+    {
+        std::lock_guard lock(m_mutex);
+        putValue<uint32_t>(data, static_cast<uint32_t>(m_entries.size()));
+        try {
+            for (const auto& [sql, results] : m_entries) {
+                putValue<uint32_t>(data, static_cast<uint32_t>(sql.size()));
+                data += sql;
+                putValue<uint32_t>(data, static_cast<uint32_t>(results->size()));
+                for (const auto& result : *results) {
+                    auto payload = BinaryResultEncoder::encode(result);
+                    putValue<uint64_t>(data, payload.size());
+                    data += payload;
+                }
+            }
+        } catch (const std::exception& e) {
+            m_lastError = e.what();
+            return false;
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) [[unlikely]] {
+        std::lock_guard lock(m_mutex);
+        m_lastError = std::format("Failed to write replay recording: {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+bool ReplayDriver::load(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) [[unlikely]] {
+        std::lock_guard lock(m_mutex);
+        m_lastError = std::format("Failed to open replay recording: {}", path.string());
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<std::pair<std::string, Entry>> loaded;
+    try {
+        Reader reader(data);
+        if (reader.take(MAGIC.size()) != MAGIC || reader.get<uint16_t>() != VERSION) [[unlikely]] {
+            throw std::runtime_error("Not a supported replay recording");
+        }
+        (void)reader.get<uint16_t>();
+        const auto entries = reader.get<uint32_t>();
+        loaded.reserve(entries);
+        for (uint32_t i = 0; i < entries; ++i) {
+            std::string sql(reader.take(reader.get<uint32_t>()));
+            const auto resultCount = reader.get<uint32_t>();
+            std::vector<ResultSet> results;
+            results.reserve(resultCount);
+            for (uint32_t r = 0; r < resultCount; ++r) {
+                results.push_back(BinaryResultDecoder::decode(reader.take(static_cast<size_t>(reader.get<uint64_t>()))));
+            }
+            loaded.emplace_back(std::move(sql), std::make_shared<const std::vector<ResultSet>>(std::move(results)));
+        }
+    } catch (const std::exception& e) {
+        std::lock_guard lock(m_mutex);
+        m_lastError = std::format("{}: {}", path.string(), e.what());
+        return false;
+    }
+
+    std::lock_guard lock(m_mutex);
+    for (auto& [sql, entry] : loaded) {
+        m_entries.insert_or_assign(std::move(sql), std::move(entry));
+    }
+    return true;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "driver_interface.h"
+#include "result_set.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Server behaviour the replay driver imitates
+struct ReplayTiming {
+    std::chrono::microseconds connectLatency{0};
+    std::chrono::microseconds executeLatency{0};  ///< Server time before the first row
+    double rowsPerSecond = 0.0;                   ///< Fetch throughput cap (0 = as fast as the consumer takes rows)
+};
+
+/// Column mix of the results generated for SQL without a recording. The same shape and SQL always produce the same cells.
+struct SyntheticResultShape {
+    size_t rows = 10000;
+    size_t textColumns = 4;
+    size_t intColumns = 2;
+    size_t doubleColumns = 1;
+    size_t textBytes = 24;  ///< Approximate length of a text cell
+    size_t nullEvery = 17;  ///< Every Nth cell of a column is NULL (0 = never)
+};
+
+/// IDatabaseDriver without a server, for load-testing the query pipeline on machines without SQL Server.
+///
+/// Results come from, in order: canned results registered with addResult(), results recorded from a real driver
+/// (recordFrom(), then save() and later load()), and the synthetic fallback. Execution waits executeLatency and
+/// rows are released no faster than rowsPerSecond, so providers, executors and exporters see realistic pacing;
+/// cancel() interrupts both waits. DriverFactory::createDriver(DriverType::Replay) returns one of these;
+/// its connect() takes "File=<recording>;LatencyMs=..;RowsPerSecond=..;SyntheticRows=..".
+///
+/// Recording file layout (little-endian): "VDBP" u16 version, u16 reserved, u32 entryCount, then per entry
+/// u32 sqlBytes, sql, u32 resultCount, and per result u64 payloadBytes plus a BinaryResultEncoder payload.
+class ReplayDriver final : public IDatabaseDriver {
+public:
+    static constexpr uint16_t VERSION = 1;
+
+    explicit ReplayDriver(ReplayTiming timing = {});
+    ~ReplayDriver() override = default;
+
+    ReplayDriver(const ReplayDriver&) = delete;
+    ReplayDriver& operator=(const ReplayDriver&) = delete;
+    ReplayDriver(ReplayDriver&&) = delete;
+    ReplayDriver& operator=(ReplayDriver&&) = delete;
+
+    // IDatabaseDriver interface
+    [[nodiscard]] bool connect(std::string_view connectionString) override;
+    void disconnect() override;
+    [[nodiscard]] bool isConnected() const noexcept override { return m_connected.load(std::memory_order_acquire); }
+    [[nodiscard]] ResultSet execute(std::string_view sql) override;
+    StreamSummary executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows = DEFAULT_STREAM_BATCH_ROWS) override;
+    [[nodiscard]] std::vector<ResultSet> executeMultiple(std::string_view sql) override;
+    void cancel() override;
+    [[nodiscard]] std::string getLastError() const override;
+    [[nodiscard]] DriverType getType() const noexcept override { return DriverType::Replay; }
+
+    void setTiming(const ReplayTiming& timing);
+    [[nodiscard]] ReplayTiming timing() const;
+
+    /// Serve `results` for `sql` (compared with surrounding whitespace trimmed), replacing any earlier entry
+    void addResult(std::string_view sql, ResultSet result);
+    void addResults(std::string_view sql, std::vector<ResultSet> results);
+
+    /// Generate results for unknown SQL instead of failing; std::nullopt restores failing
+    void setSyntheticFallback(std::optional<SyntheticResultShape> shape);
+    [[nodiscard]] static ResultSet makeSyntheticResult(const SyntheticResultShape& shape, uint64_t seed = 0);
+
+    /// Forward every query to `source` and keep what it returns (nullptr stops recording)
+    void recordFrom(std::shared_ptr<IDatabaseDriver> source);
+
+    /// Write every known result to `path` / merge the results stored in `path`
+    /// @return false (with getLastError() set) on I/O or format errors
+    bool save(const std::filesystem::path& path) const;
+    bool load(const std::filesystem::path& path);
+
+    [[nodiscard]] size_t entryCount() const;
+    /// Queries served since construction
+    [[nodiscard]] uint64_t executeCount() const noexcept { return m_executeCount.load(std::memory_order_relaxed); }
+
+private:
+    using Entry = std::shared_ptr<const std::vector<ResultSet>>;
+
+    /// Results for `sql`, waiting out executeLatency first
+    /// @throws std::runtime_error when not connected, cancelled, or nothing can serve the SQL
+    [[nodiscard]] Entry resolve(std::string_view sql);
+    /// Sleep until `deadline`; false if cancel() was called meanwhile
+    [[nodiscard]] bool waitUntil(std::chrono::steady_clock::time_point deadline);
+    /// Time at which `rows` rows may have been delivered since `start` at `rowsPerSecond`
+    [[nodiscard]] static std::chrono::steady_clock::time_point paceDeadline(std::chrono::steady_clock::time_point start, size_t rows, double rowsPerSecond) noexcept;
+    [[noreturn]] void fail(std::string message);
+
+    mutable std::mutex m_mutex;
+    ReplayTiming m_timing;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::optional<SyntheticResultShape> m_synthetic;
+    std::shared_ptr<IDatabaseDriver> m_source;
+    mutable std::string m_lastError;  ///< Guarded by m_mutex
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCv;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<bool> m_connected{false};
+    std::atomic<uint64_t> m_executeCount{0};
+};
+
+}  // namespace velocitydb
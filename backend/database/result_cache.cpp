@@ -1,89 +1,319 @@
 #include "result_cache.h"
 
-#include <ranges>
+#include "../parsers/sql_parser.h"
 
 namespace velocitydb {
 
-void ResultCache::put(std::string_view key, const ResultSet& result) {
-    std::lock_guard lock(m_mutex);
+ResultCache::ResultCache(size_t maxSizeBytes, std::chrono::seconds defaultTtl, MemoryGovernor& governor) : m_governor(governor), m_maxSizeBytes(maxSizeBytes), m_defaultTtl(defaultTtl) {
+    m_reclaimerId = m_governor.addReclaimer(MemoryPool::ResultCache, [this](size_t wanted) { return shed(wanted); });
+}
+
+ResultCache::~ResultCache() {
+    m_governor.removeReclaimer(m_reclaimerId);
+    m_governor.release(MemoryPool::ResultCache, m_currentSizeBytes.load(std::memory_order_relaxed));
+}
+
+void ResultCache::Shard::link(Entry& entry) noexcept {
+    entry.prev = nullptr;
+    entry.next = head;
+    if (head) {
+        head->prev = &entry;
+    } else {
+        tail = &entry;
+    }
+    head = &entry;
+}
+
+void ResultCache::Shard::unlink(Entry& entry) noexcept {
+    (entry.prev ? entry.prev->next : head) = entry.next;
+    (entry.next ? entry.next->prev : tail) = entry.prev;
+    entry.prev = entry.next = nullptr;
+}
 
-    auto resultSize = estimateSize(result);
+size_t ResultCache::Shard::evictTail() {
+    return erase(*tail);
+}
+
+size_t ResultCache::Shard::erase(Entry& entry) {
+    unlink(entry);
+    size_t freed = entry.sizeBytes;
+    entries.erase(entries.find(*entry.key));
+    return freed;
+}
+
+ResultCache::Entry* ResultCache::Shard::touch(std::string_view key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    if (head != &it->second) {
+        unlink(it->second);
+        link(it->second);
+    }
+    return &it->second;
+}
+
+ResultCache::Shard& ResultCache::shardFor(std::string_view key, size_t& index) noexcept {
+    index = StringHash{}(key) % SHARD_COUNT;
+    return m_shards[index];
+}
+
+std::string ResultCache::makeKey(std::string_view connectionId, std::string_view sql, std::string_view variant) {
+    const auto normalized = SQLParser::fingerprint(sql);
+    std::string key;
+    key.reserve(connectionId.size() + normalized.size() + variant.size() + 2);
+    key.append(connectionId);
+    key.push_back('\0');
+    key.append(normalized);
+    if (!variant.empty()) {
+        key.push_back('\0');
+        key.append(variant);
+    }
+    return key;
+}
+
+void ResultCache::put(std::string_view key, std::shared_ptr<const ResultSet> result, EntryOptions options) {
+    if (!result) [[unlikely]] {
+        return;
+    }
+
+    auto resultSize = estimateSize(*result);
 
     // Skip caching if result is larger than max cache size to prevent exceeding limits
     if (resultSize > m_maxSizeBytes) {
         return;
     }
 
-    std::string keyStr(key);
+    size_t shardIndex = 0;
+    auto& shard = shardFor(key, shardIndex);
+    {
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            shard.unlink(it->second);
+            subBytes(it->second.sizeBytes);
+        } else {
+            it = shard.entries.emplace(std::string(key), Entry{}).first;
+            it->second.key = &it->first;
+        }
+        it->second.data = std::move(result);
+        it->second.response.reset();
+        it->second.tables = std::move(options.tables);
+        it->second.freshnessToken = std::move(options.freshnessToken);
+        it->second.expiresAt = std::chrono::steady_clock::now() + (options.ttl.count() > 0 ? options.ttl : m_defaultTtl);
+        it->second.sizeBytes = resultSize;
+        shard.link(it->second);
+        addBytes(resultSize);
+        shrinkShard(shard, it->second);
+    }
+
+    // Own shard is visited last so the entry just inserted is the final candidate
+    evictIfNeeded((shardIndex + 1) % SHARD_COUNT);
+    m_governor.reclaimIfNeeded();
+}
 
-    if (auto it = m_cache.find(keyStr); it != m_cache.end()) {
-        m_currentSizeBytes -= it->second.sizeBytes;
-        m_cache.erase(it);
+ResultCache::Lookup ResultCache::lookup(std::string_view key, const FreshnessProbe& probe) {
+    size_t shardIndex = 0;
+    auto& shard = shardFor(key, shardIndex);
+
+    Lookup found;
+    size_t savedBytes = 0;
+    std::vector<std::string> tables;
+    std::string token;
+    {
+        std::lock_guard lock(shard.mutex);
+        auto* entry = shard.touch(key);
+        if (!entry) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        if (std::chrono::steady_clock::now() >= entry->expiresAt) {
+            subBytes(shard.erase(*entry));
+            m_staleRejections.fetch_add(1, std::memory_order_relaxed);
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        found = Lookup{.result = entry->data, .response = entry->response};
+        savedBytes = entry->sizeBytes;
+        if (probe && !entry->freshnessToken.empty()) {
+            tables = entry->tables;
+            token = entry->freshnessToken;
+        }
     }
 
-    evictIfNeeded(resultSize);
+    // The probe usually costs a server round trip, so it runs without the shard lock
+    if (!token.empty()) {
+        if (auto current = probe(tables); current && *current != token) {
+            std::lock_guard lock(shard.mutex);
+            // Only drop the entry that was validated; a concurrent put may have replaced it already
+            if (auto it = shard.entries.find(key); it != shard.entries.end() && it->second.data == found.result) {
+                subBytes(shard.erase(it->second));
+            }
+            m_staleRejections.fetch_add(1, std::memory_order_relaxed);
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+    }
 
-    m_cache[keyStr] = CachedResult{.data = result, .timestamp = std::chrono::steady_clock::now(), .sizeBytes = resultSize};
-    m_currentSizeBytes += resultSize;
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    m_bytesSaved.fetch_add(savedBytes, std::memory_order_relaxed);
+    return found;
 }
 
-std::optional<ResultSet> ResultCache::get(std::string_view key) {
-    std::lock_guard lock(m_mutex);
+void ResultCache::putResponse(std::string_view key, std::shared_ptr<const std::string> response) {
+    if (!response) [[unlikely]] {
+        return;
+    }
 
-    std::string keyStr(key);
-    if (auto it = m_cache.find(keyStr); it != m_cache.end()) {
-        it->second.timestamp = std::chrono::steady_clock::now();
-        return it->second.data;
+    size_t shardIndex = 0;
+    auto& shard = shardFor(key, shardIndex);
+    {
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end() || it->second.response || it->second.sizeBytes + response->size() > m_maxSizeBytes) {
+            return;
+        }
+        it->second.sizeBytes += response->size();
+        addBytes(response->size());
+        it->second.response = std::move(response);
+        shrinkShard(shard, it->second);
     }
 
-    return std::nullopt;
+    evictIfNeeded((shardIndex + 1) % SHARD_COUNT);
+    m_governor.reclaimIfNeeded();
 }
 
 void ResultCache::invalidate(std::string_view key) {
-    std::lock_guard lock(m_mutex);
+    size_t shardIndex = 0;
+    auto& shard = shardFor(key, shardIndex);
+    std::lock_guard lock(shard.mutex);
 
-    std::string keyStr(key);
-    if (auto it = m_cache.find(keyStr); it != m_cache.end()) {
-        m_currentSizeBytes -= it->second.sizeBytes;
-        m_cache.erase(it);
+    if (auto it = shard.entries.find(key); it != shard.entries.end()) {
+        shard.unlink(it->second);
+        subBytes(it->second.sizeBytes);
+        shard.entries.erase(it);
     }
 }
 
-void ResultCache::clear() {
-    std::lock_guard lock(m_mutex);
-    m_cache.clear();
-    m_currentSizeBytes = 0;
+template <typename Pred>
+size_t ResultCache::eraseForConnection(std::string_view connectionId, Pred pred) {
+    size_t erased = 0;
+    for (auto& shard : m_shards) {
+        std::lock_guard lock(shard.mutex);
+        for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+            const std::string_view key = it->first;
+            if (key.size() > connectionId.size() && key[connectionId.size()] == '\0' && key.starts_with(connectionId) && pred(it->second)) {
+                shard.unlink(it->second);
+                subBytes(it->second.sizeBytes);
+                it = shard.entries.erase(it);
+                ++erased;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return erased;
 }
 
-size_t ResultCache::getCurrentSize() const {
-    std::lock_guard lock(m_mutex);
-    return m_currentSizeBytes;
+size_t ResultCache::invalidateTables(std::string_view connectionId, std::span<const std::string> tables) {
+    if (tables.empty()) {
+        return 0;
+    }
+    return eraseForConnection(connectionId, [&](const Entry& entry) {
+        // Both lists are sorted: walk them together looking for a shared table
+        auto a = entry.tables.begin();
+        auto b = tables.begin();
+        while (a != entry.tables.end() && b != tables.end()) {
+            if (*a < *b) {
+                ++a;
+            } else if (*b < *a) {
+                ++b;
+            } else {
+                return true;
+            }
+        }
+        return false;
+    });
 }
 
-void ResultCache::evictIfNeeded(size_t requiredSize) {
-    while (m_currentSizeBytes + requiredSize > m_maxSizeBytes && !m_cache.empty()) {
-        auto oldest = std::ranges::min_element(m_cache, [](const auto& a, const auto& b) { return a.second.timestamp < b.second.timestamp; });
+size_t ResultCache::invalidateConnection(std::string_view connectionId) {
+    return eraseForConnection(connectionId, [](const Entry&) { return true; });
+}
 
-        m_currentSizeBytes -= oldest->second.sizeBytes;
-        m_cache.erase(oldest);
+void ResultCache::clear() {
+    for (auto& shard : m_shards) {
+        std::lock_guard lock(shard.mutex);
+        size_t freed = 0;
+        for (const auto& [key, entry] : shard.entries) {
+            freed += entry.sizeBytes;
+        }
+        shard.entries.clear();
+        shard.head = shard.tail = nullptr;
+        subBytes(freed);
     }
 }
 
-size_t ResultCache::estimateSize(const ResultSet& result) {
-    size_t size = sizeof(ResultSet);
+ResultCache::Stats ResultCache::stats() const noexcept {
+    return Stats{.hits = m_hits.load(std::memory_order_relaxed),
+                 .misses = m_misses.load(std::memory_order_relaxed),
+                 .staleRejections = m_staleRejections.load(std::memory_order_relaxed),
+                 .bytesSaved = m_bytesSaved.load(std::memory_order_relaxed)};
+}
 
-    for (const auto& col : result.columns) {
-        size += col.name.size() + col.type.size() + sizeof(ColumnInfo);
+size_t ResultCache::entryCount() const {
+    size_t count = 0;
+    for (const auto& shard : m_shards) {
+        std::lock_guard lock(shard.mutex);
+        count += shard.entries.size();
     }
+    return count;
+}
+
+void ResultCache::shrinkShard(Shard& shard, const Entry& keep) {
+    while (shard.tail && shard.tail != &keep && m_currentSizeBytes.load(std::memory_order_relaxed) > m_maxSizeBytes) {
+        subBytes(shard.evictTail());
+    }
+}
 
-    for (const auto& row : result.rows) {
-        size += sizeof(ResultRow);
-        for (const auto& val : row.values) {
-            size += val.size();
+void ResultCache::evictIfNeeded(size_t startShard) {
+    // Only one shard lock is held at a time, so concurrent inserts never deadlock
+    for (size_t visited = 0; visited < SHARD_COUNT && m_currentSizeBytes.load(std::memory_order_relaxed) > m_maxSizeBytes; ++visited) {
+        auto& shard = m_shards[(startShard + visited) % SHARD_COUNT];
+        std::lock_guard lock(shard.mutex);
+        while (shard.tail && m_currentSizeBytes.load(std::memory_order_relaxed) > m_maxSizeBytes) {
+            subBytes(shard.evictTail());
         }
     }
+}
+
+size_t ResultCache::shed(size_t wanted) {
+    size_t freed = 0;
+    for (auto& shard : m_shards) {
+        std::lock_guard lock(shard.mutex);
+        while (shard.tail && freed < wanted) {
+            const size_t bytes = shard.evictTail();
+            subBytes(bytes);
+            freed += bytes;
+        }
+        if (freed >= wanted) {
+            break;
+        }
+    }
+    return freed;
+}
+
+size_t ResultCache::estimateSize(const ResultSet& result) {
+    return result.memoryBytes();
+}
+
+void ResultCache::addBytes(size_t bytes) noexcept {
+    m_currentSizeBytes.fetch_add(bytes, std::memory_order_relaxed);
+    m_governor.charge(MemoryPool::ResultCache, bytes);
+}
 
-    return size;
+void ResultCache::subBytes(size_t bytes) noexcept {
+    m_currentSizeBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    m_governor.release(MemoryPool::ResultCache, bytes);
 }
 
 }  // namespace velocitydb
@@ -1,46 +1,161 @@
 #pragma once
 
+#include "../utils/memory_governor.h"
+#include "../utils/string_hash.h"
 #include "sqlserver_driver.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace velocitydb {
 
-struct CachedResult {
-    ResultSet data;
-    std::chrono::steady_clock::time_point timestamp;
-    size_t sizeBytes = 0;
-};
-
+/// Size-bounded LRU cache of query results.
+///
+/// Keys are spread over SHARD_COUNT independently locked shards; each shard keeps its entries on an
+/// intrusive recency list so lookups, promotion and eviction are all O(1). The byte budget is global:
+/// an insert evicts least recently used entries starting with its own shard, so recency is exact
+/// within a shard and approximate across shards.
+///
+/// An entry can also carry the final serialized response for its result, attached on the first
+/// JSON hit, so later hits skip serialization and just copy the bytes. It counts towards the budget.
+///
+/// Keys are built by makeKey(connectionId, sql) from the query's fingerprint, so the same query typed with other
+/// spacing, comments or keyword case finds the same entry. Each entry records the tables its query read, so a
+/// write on a connection only drops the entries that depend on the tables it touched.
+///
+/// Entries expire after their TTL. An entry may also carry a freshness token (a server-side change
+/// marker for its tables taken before the query ran); lookups given a probe re-read the marker and
+/// reject the entry when it moved.
+///
+/// Cached bytes are charged to the MemoryGovernor's ResultCache pool, and the cache registers itself as
+/// that pool's reclaimer: when results overall exceed the process budget it evicts beyond its own cap.
 class ResultCache {
 public:
-    explicit ResultCache(size_t maxSizeBytes = 100 * 1024 * 1024) : m_maxSizeBytes(maxSizeBytes) {}
-    ~ResultCache() = default;
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr std::chrono::seconds DEFAULT_TTL = std::chrono::minutes(30);
+
+    /// Computes the current freshness token for `tables`; nullopt when the server cannot tell
+    using FreshnessProbe = std::function<std::optional<std::string>(std::span<const std::string> tables)>;
+
+    struct EntryOptions {
+        std::vector<std::string> tables;  ///< Sorted, unique dependent tables (SQLParser::extractTableReferences)
+        std::string freshnessToken;       ///< Empty = no server-side validation
+        std::chrono::seconds ttl{0};      ///< 0 = cache default
+    };
+
+    struct Lookup {
+        std::shared_ptr<const ResultSet> result;
+        std::shared_ptr<const std::string> response;  ///< Serialized response attached by putResponse, if any
+        explicit operator bool() const noexcept { return result != nullptr; }
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t staleRejections = 0;  ///< Expired entries plus entries rejected by a freshness probe
+        uint64_t bytesSaved = 0;       ///< Result bytes served from cache instead of the server
+    };
+
+    explicit ResultCache(size_t maxSizeBytes = 100 * 1024 * 1024, std::chrono::seconds defaultTtl = DEFAULT_TTL, MemoryGovernor& governor = MemoryGovernor::instance());
+    ~ResultCache();
 
     ResultCache(const ResultCache&) = delete;
     ResultCache& operator=(const ResultCache&) = delete;
+    ResultCache(ResultCache&&) = delete;
+    ResultCache& operator=(ResultCache&&) = delete;
+
+    /// Cache key for `sql` executed on `connectionId`: SQLParser::fingerprint with literals kept. `variant` keeps
+    /// apart results of one query fetched differently (row limit, LOB previews)
+    [[nodiscard]] static std::string makeKey(std::string_view connectionId, std::string_view sql, std::string_view variant = {});
+
+    void put(std::string_view key, std::shared_ptr<const ResultSet> result, EntryOptions options);
+    void put(std::string_view key, std::shared_ptr<const ResultSet> result) { put(key, std::move(result), EntryOptions{}); }
+
+    /// Shared, immutable view of a live entry; promotes it to most recently used and updates the hit/miss counters.
+    /// With a probe, entries carrying a freshness token are re-validated (outside the shard lock) first.
+    [[nodiscard]] Lookup lookup(std::string_view key, const FreshnessProbe& probe = nullptr);
+    /// lookup() without validation, returning only the result (nullptr on miss)
+    [[nodiscard]] std::shared_ptr<const ResultSet> get(std::string_view key) { return lookup(key).result; }
+
+    /// Attach a serialized response to an existing entry; no-op if the key was evicted meanwhile
+    void putResponse(std::string_view key, std::shared_ptr<const std::string> response);
 
-    void put(std::string_view key, const ResultSet& result);
-    [[nodiscard]] std::optional<ResultSet> get(std::string_view key);
     void invalidate(std::string_view key);
+    /// Drop entries on `connectionId` that depend on any of `tables` (sorted, unique); returns the number dropped
+    size_t invalidateTables(std::string_view connectionId, std::span<const std::string> tables);
+    /// Drop every entry cached for `connectionId`; returns the number dropped
+    size_t invalidateConnection(std::string_view connectionId);
     void clear();
 
-    [[nodiscard]] size_t getCurrentSize() const;
+    [[nodiscard]] size_t getCurrentSize() const noexcept { return m_currentSizeBytes.load(std::memory_order_relaxed); }
     [[nodiscard]] size_t getMaxSize() const noexcept { return m_maxSizeBytes; }
+    [[nodiscard]] size_t entryCount() const;
+    [[nodiscard]] Stats stats() const noexcept;
 
 private:
-    void evictIfNeeded(size_t requiredSize);
+    /// Map node doubling as a recency-list link; unordered_map never moves its nodes, so the links stay valid
+    struct Entry {
+        std::shared_ptr<const ResultSet> data;
+        std::shared_ptr<const std::string> response;
+        std::vector<std::string> tables;
+        std::string freshnessToken;
+        std::chrono::steady_clock::time_point expiresAt;
+        size_t sizeBytes = 0;
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+        const std::string* key = nullptr;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry, StringHash, std::equal_to<>> entries;
+        Entry* head = nullptr;  ///< most recently used
+        Entry* tail = nullptr;  ///< least recently used
+
+        void link(Entry& entry) noexcept;
+        void unlink(Entry& entry) noexcept;
+        /// Drop the least recently used entry and return its size (lock held)
+        size_t evictTail();
+        /// Entry for `key` moved to the front of the recency list, or nullptr (lock held)
+        Entry* touch(std::string_view key);
+        /// Unlink and erase `entry`, returning its size (lock held)
+        size_t erase(Entry& entry);
+    };
+
+    [[nodiscard]] Shard& shardFor(std::string_view key, size_t& index) noexcept;
+    /// Evict from `shard` until within budget, never evicting `keep` (shard lock held)
+    void shrinkShard(Shard& shard, const Entry& keep);
+    void evictIfNeeded(size_t startShard);
+    /// Erase every entry whose key belongs to `connectionId` and satisfies `pred`
+    template <typename Pred>
+    size_t eraseForConnection(std::string_view connectionId, Pred pred);
     [[nodiscard]] static size_t estimateSize(const ResultSet& result);
+    void addBytes(size_t bytes) noexcept;
+    void subBytes(size_t bytes) noexcept;
+    /// Governor reclaimer: evict least recently used entries until `wanted` bytes are freed
+    size_t shed(size_t wanted);
 
+    MemoryGovernor& m_governor;
+    uint64_t m_reclaimerId = 0;
     size_t m_maxSizeBytes;
-    size_t m_currentSizeBytes = 0;
-    mutable std::mutex m_mutex;
-    std::unordered_map<std::string, CachedResult> m_cache;
+    std::chrono::seconds m_defaultTtl;
+    std::atomic<size_t> m_currentSizeBytes{0};
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_staleRejections{0};
+    std::atomic<uint64_t> m_bytesSaved{0};
+    std::array<Shard, SHARD_COUNT> m_shards;
 };
 
 }  // namespace velocitydb
@@ -0,0 +1,518 @@
+#include "result_registry.h"
+
+#include "../utils/binary_result.h"
+#include "../utils/buffered_file_writer.h"
+#include "../utils/logger.h"
+#include "../utils/mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] size_t rowsBytes(const std::shared_ptr<const std::vector<size_t>>& rows) noexcept {
+    return rows ? rows->size() * sizeof(size_t) : 0;
+}
+
+/// `result` with `patches` applied: removed rows left out, replaced ones taken from their patch, appended ones last
+ResultSet applyPatches(const ResultSet& result, std::span<const RowPatch> patches) {
+    std::vector<const RowPatch*> byRow(result.rowCount(), nullptr);
+    for (const auto& patch : patches) {
+        if (patch.kind != RowPatch::Kind::Append && patch.row < byRow.size()) {
+            byRow[patch.row] = &patch;
+        }
+    }
+
+    ResultSet out;
+    out.columns = result.columns;
+    out.affectedRows = result.affectedRows;
+    out.executionTimeMs = result.executionTimeMs;
+    out.fetchStats = result.fetchStats;
+    out.truncated = result.truncated;
+    out.messages = result.messages;
+    for (const auto& column : result.columnData) {
+        out.columnData.emplace_back(column.type(), column.fractionDigits());
+        out.columnData.back().reserve(result.rowCount());
+    }
+    // A patch row without the held result's columns is not used: the stored row stays (Replace) or is not added (Append)
+    auto appendPatched = [&](const RowPatch& patch) {
+        if (patch.values.rowCount() == 0 || patch.values.columnData.size() != out.columnData.size()) [[unlikely]] {
+            return false;
+        }
+        for (const auto& preview : patch.values.lobPreviews) {
+            if (preview.row == 0) {
+                out.lobPreviews.push_back({.row = out.rowCount(), .column = preview.column, .totalBytes = preview.totalBytes});
+            }
+        }
+        out.appendRowFrom(patch.values, 0);
+        return true;
+    };
+
+    size_t nextPreview = 0;
+    for (size_t row = 0; row < byRow.size(); ++row) {
+        // Previews are in row order: those of this row move with it, or go with the old value
+        while (nextPreview < result.lobPreviews.size() && result.lobPreviews[nextPreview].row < row) {
+            ++nextPreview;
+        }
+        if (!byRow[row] || (byRow[row]->kind == RowPatch::Kind::Replace && !appendPatched(*byRow[row]))) {
+            for (size_t p = nextPreview; p < result.lobPreviews.size() && result.lobPreviews[p].row == row; ++p) {
+                out.lobPreviews.push_back({.row = out.rowCount(), .column = result.lobPreviews[p].column, .totalBytes = result.lobPreviews[p].totalBytes});
+            }
+            out.appendRowFrom(result, row);
+        }
+    }
+    for (const auto& patch : patches) {
+        if (patch.kind == RowPatch::Kind::Append) {
+            appendPatched(patch);
+        }
+    }
+    out.updateStats();
+    return out;
+}
+
+std::string pathToUtf8(const std::filesystem::path& path) {
+    auto utf8 = path.u8string();
+    return std::string(utf8.begin(), utf8.end());
+}
+
+/// Remove spill directories older than `maxAge` (left by a process that crashed)
+void sweepStaleSpills(const std::filesystem::path& root, std::chrono::hours maxAge) {
+    std::error_code ec;
+    const auto cutoff = std::filesystem::file_time_type::clock::now() - maxAge;
+    for (std::filesystem::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code entryEc;
+        if (it->is_directory(entryEc) && it->last_write_time(entryEc) < cutoff && !entryEc) {
+            std::filesystem::remove_all(it->path(), entryEc);
+        }
+    }
+}
+
+}  // namespace
+
+ResultRegistry::ResultRegistry(size_t maxBytes, std::chrono::seconds idleTtl, std::filesystem::path spillRoot, MemoryGovernor& governor)
+    : m_maxBytes(maxBytes), m_idleTtl(idleTtl), m_charge(governor, MemoryPool::HeldResults) {
+    static std::atomic<uint64_t> sequence{0};
+    sweepStaleSpills(spillRoot, STALE_SPILL_AGE);
+    m_spillDirectory = spillRoot / std::format("{}-{}", std::chrono::system_clock::now().time_since_epoch().count(), sequence.fetch_add(1));
+    m_reclaimerId = governor.addReclaimer(MemoryPool::HeldResults, [this](size_t wanted) { return spill(wanted); });
+}
+
+ResultRegistry::~ResultRegistry() {
+    m_charge.governor().removeReclaimer(m_reclaimerId);
+    std::error_code ec;
+    std::filesystem::remove_all(m_spillDirectory, ec);
+}
+
+std::filesystem::path ResultRegistry::defaultSpillRoot() {
+    std::error_code ec;
+    auto temp = std::filesystem::temp_directory_path(ec);
+    return (ec ? std::filesystem::path(".") : temp) / "velocitydb_spill";
+}
+
+std::string ResultRegistry::put(std::string_view connectionId, std::shared_ptr<const ResultSet> result, std::string sourceTable) {
+    const size_t bytes = result->memoryBytes();
+    std::string handle;
+    {
+        std::lock_guard lock(m_mutex);
+        if (bytes > m_maxBytes) [[unlikely]] {
+            return {};
+        }
+        evict(bytes);
+
+        handle = std::format("rh{}", m_nextId++);
+        m_totalBytes += bytes;
+        m_entries.emplace(handle, Entry{.connectionId = std::string(connectionId),
+                                        .sourceTable = std::move(sourceTable),
+                                        .result = std::move(result),
+                                        .resultBytes = bytes,
+                                        .sizeBytes = bytes,
+                                        .lastUsed = std::chrono::steady_clock::now()});
+        m_charge.set(m_totalBytes);
+    }
+    m_charge.governor().reclaimIfNeeded();
+    return handle;
+}
+
+std::shared_ptr<const ResultSet> ResultRegistry::find(std::string_view handle) {
+    return acquire(handle);
+}
+
+std::shared_ptr<const ResultSet> ResultRegistry::acquire(std::string_view handle) {
+    std::filesystem::path spillPath;
+    std::vector<LobPreview> lobPreviews;
+    {
+        std::lock_guard lock(m_mutex);
+        auto* entry = touch(handle);
+        if (!entry) {
+            return nullptr;
+        }
+        if (entry->result) {
+            return entry->result;
+        }
+        spillPath = entry->spillPath;
+        lobPreviews = entry->lobPreviews;
+    }
+
+    // Decoding a large result takes a while; read it back without holding up the other handles
+    auto restored = readSpill(spillPath);
+    if (restored) {
+        restored->lobPreviews = std::move(lobPreviews);
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(handle);
+        if (it == m_entries.end()) {
+            return restored;  // Released meanwhile: answer this request, keep nothing
+        }
+        auto& entry = it->second;
+        if (entry.result) {
+            return entry.result;  // Another request read it back first
+        }
+        if (!restored) [[unlikely]] {
+            erase(it);
+            return nullptr;
+        }
+        entry.result = restored;
+        entry.resultBytes = restored->memoryBytes();
+        entry.sizeBytes += entry.resultBytes;
+        m_totalBytes += entry.resultBytes;
+        --m_spilledCount;
+        evict(0, &entry);
+        m_charge.set(m_totalBytes);
+    }
+    m_charge.governor().reclaimIfNeeded();
+    return restored;
+}
+
+HeldResult ResultRegistry::view(std::string_view handle, std::string_view viewKey, const std::function<std::vector<size_t>(const ResultSet&)>& order) {
+    HeldResult held;
+    held.result = acquire(handle);
+    if (!held.result || viewKey.empty()) {
+        return held;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(handle);
+        if (it != m_entries.end() && it->second.viewRows && it->second.viewKey == viewKey) {
+            held.rows = it->second.viewRows;
+            return held;
+        }
+    }
+
+    // Sorting a large result takes a while; other requests on the registry must not wait for it
+    held.rows = std::make_shared<const std::vector<size_t>>(order(*held.result));
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end() || it->second.result != held.result) {
+        return held;  // Released meanwhile: answer this request, remember nothing
+    }
+    auto& entry = it->second;
+    const size_t previous = rowsBytes(entry.viewRows);
+    entry.viewKey = std::string(viewKey);
+    entry.viewRows = held.rows;
+    recharge(entry, previous, rowsBytes(held.rows));
+    return held;
+}
+
+std::shared_ptr<const std::vector<size_t>> ResultRegistry::derivedRows(std::string_view handle, std::string_view key, const std::function<std::vector<size_t>(const ResultSet&)>& compute) {
+    auto result = acquire(handle);
+    if (!result) {
+        return nullptr;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(handle);
+        if (it != m_entries.end()) {
+            auto& derived = it->second.derived;
+            if (auto hit = std::ranges::find(derived, key, &DerivedRows::key); hit != derived.end()) {
+                std::rotate(hit, hit + 1, derived.end());
+                return derived.back().rows;
+            }
+        }
+    }
+
+    auto rows = std::make_shared<const std::vector<size_t>>(compute(*result));
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end() || it->second.result != result) {
+        return rows;  // Released or spilled meanwhile: answer this request, remember nothing
+    }
+    auto& entry = it->second;
+    size_t previous = 0;
+    if (entry.derived.size() == MAX_DERIVED_ROWS) {
+        previous = rowsBytes(entry.derived.front().rows);
+        entry.derived.erase(entry.derived.begin());
+    }
+    entry.derived.push_back({.key = std::string(key), .rows = rows});
+    recharge(entry, previous, rowsBytes(rows));
+    return rows;
+}
+
+void ResultRegistry::recharge(Entry& entry, size_t previous, size_t incoming) {
+    entry.sizeBytes = entry.sizeBytes - previous + incoming;
+    m_totalBytes = m_totalBytes - previous + incoming;
+    evict(0, &entry);
+    m_charge.set(m_totalBytes);
+}
+
+bool ResultRegistry::patch(std::string_view handle, std::span<const RowPatch> patches) {
+    auto result = acquire(handle);
+    if (!result) {
+        return false;
+    }
+    // Copied outside the lock, like a view; readers still holding the old result keep seeing it
+    std::shared_ptr<const ResultSet> patched = std::make_shared<ResultSet>(applyPatches(*result, patches));
+    const size_t bytes = patched->memoryBytes();
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end() || it->second.result != result) {
+        return false;
+    }
+    auto& entry = it->second;
+    entry.result = std::move(patched);
+    entry.resultBytes = bytes;
+    entry.viewKey.clear();
+    entry.viewRows.reset();
+    entry.derived.clear();
+    if (!entry.spillPath.empty()) {
+        // The copy on disk no longer matches
+        std::error_code ec;
+        std::filesystem::remove(entry.spillPath, ec);
+        m_spilledBytes -= entry.spillBytes;
+        entry.spillPath.clear();
+        entry.spillBytes = 0;
+    }
+    recharge(entry, entry.sizeBytes, bytes);
+    return true;
+}
+
+std::optional<HeldOrigin> ResultRegistry::origin(std::string_view handle) const {
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    return HeldOrigin{.connectionId = it->second.connectionId, .sourceTable = it->second.sourceTable};
+}
+
+bool ResultRegistry::release(std::string_view handle) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    erase(it);
+    m_charge.set(m_totalBytes);
+    return true;
+}
+
+size_t ResultRegistry::releaseConnection(std::string_view connectionId) {
+    std::lock_guard lock(m_mutex);
+    size_t dropped = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->second.connectionId == connectionId) {
+            erase(it++);
+            ++dropped;
+        } else {
+            ++it;
+        }
+    }
+    m_charge.set(m_totalBytes);
+    return dropped;
+}
+
+size_t ResultRegistry::spill(size_t wanted) {
+    struct Victim {
+        std::string handle;
+        std::shared_ptr<const ResultSet> result;
+        std::filesystem::path spillPath;  ///< Already on disk when not empty
+    };
+    std::vector<Victim> victims;
+    {
+        std::lock_guard lock(m_mutex);
+        std::vector<Entries::iterator> resident;
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.result) {
+                resident.push_back(it);
+            }
+        }
+        std::ranges::sort(resident, {}, [](Entries::iterator it) { return it->second.lastUsed; });
+        size_t planned = 0;
+        for (auto it : resident) {
+            if (planned >= wanted) {
+                break;
+            }
+            victims.push_back(Victim{.handle = it->first, .result = it->second.result, .spillPath = it->second.spillPath});
+            planned += it->second.resultBytes;
+        }
+    }
+
+    size_t freed = 0;
+    size_t spilled = 0;
+    for (auto& victim : victims) {
+        size_t fileBytes = 0;
+        const bool written = victim.spillPath.empty();
+        if (written) {
+            // Written outside the lock; an entry released or read back meanwhile just discards the file
+            victim.spillPath = m_spillDirectory / std::format("{}.vdbr", victim.handle);
+            if (!writeSpill(victim.spillPath, *victim.result, fileBytes)) {
+                continue;
+            }
+        }
+
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(victim.handle);
+        if (it == m_entries.end() || it->second.result != victim.result) {
+            if (written) {
+                std::error_code ec;
+                std::filesystem::remove(victim.spillPath, ec);
+            }
+            continue;
+        }
+        auto& entry = it->second;
+        if (written) {
+            entry.spillPath = victim.spillPath;
+            entry.spillBytes = fileBytes;
+            m_spilledBytes += fileBytes;
+        }
+        entry.lobPreviews = entry.result->lobPreviews;
+        entry.result.reset();
+        // Derived row lists only speed up toggles on a result nobody used lately; the last view stays for paging
+        size_t released = entry.resultBytes;
+        for (const auto& derived : entry.derived) {
+            released += rowsBytes(derived.rows);
+        }
+        entry.derived.clear();
+        entry.sizeBytes -= released;
+        m_totalBytes -= released;
+        freed += released;
+        ++spilled;
+        ++m_spilledCount;
+        m_charge.set(m_totalBytes);
+    }
+    if (freed > 0) {
+        log<LogLevel::INFO>(std::format("Spilled {} held results ({} bytes) to {}", spilled, freed, pathToUtf8(m_spillDirectory)));
+    }
+    return freed;
+}
+
+bool ResultRegistry::writeSpill(const std::filesystem::path& path, const ResultSet& result, size_t& fileBytes) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    BufferedFileWriter writer;
+    if (!writer.open(pathToUtf8(path))) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Cannot create spill file {}", pathToUtf8(path)));
+        return false;
+    }
+    try {
+        BinaryResultEncoder::encode(result, [&](std::string_view chunk) { writer.append(chunk); });
+    } catch (const std::exception& e) {
+        log<LogLevel::WARNING>(std::format("Cannot spill result: {}", e.what()));
+        writer.close();
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+    fileBytes = writer.bytesWritten();
+    if (!writer.close()) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Writing spill file {} failed", pathToUtf8(path)));
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<ResultSet> ResultRegistry::readSpill(const std::filesystem::path& path) {
+    MappedFile file;
+    if (!file.open(pathToUtf8(path))) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Cannot map spill file {}", pathToUtf8(path)));
+        return nullptr;
+    }
+    try {
+        return std::make_shared<ResultSet>(BinaryResultDecoder::decode(file.view()));
+    } catch (const std::exception& e) {
+        log<LogLevel::WARNING>(std::format("Spill file {} unreadable: {}", pathToUtf8(path), e.what()));
+        return nullptr;
+    }
+}
+
+size_t ResultRegistry::totalBytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_totalBytes;
+}
+
+size_t ResultRegistry::entryCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t ResultRegistry::spilledCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_spilledCount;
+}
+
+size_t ResultRegistry::spilledBytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_spilledBytes;
+}
+
+void ResultRegistry::evict(size_t incoming, const Entry* keep) {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (&it->second != keep && now - it->second.lastUsed >= m_idleTtl) {
+            erase(it++);
+        } else {
+            ++it;
+        }
+    }
+
+    while (m_totalBytes + incoming > m_maxBytes) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            // Spilled entries without a view hold no heap; dropping them would not make room
+            if (&it->second != keep && it->second.sizeBytes > 0 && (oldest == m_entries.end() || it->second.lastUsed < oldest->second.lastUsed)) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_entries.end()) {
+            return;
+        }
+        erase(oldest);
+    }
+}
+
+ResultRegistry::Entry* ResultRegistry::touch(std::string_view handle) {
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - it->second.lastUsed >= m_idleTtl) {
+        erase(it);
+        m_charge.set(m_totalBytes);
+        return nullptr;
+    }
+    it->second.lastUsed = now;
+    return &it->second;
+}
+
+void ResultRegistry::erase(Entries::iterator it) {
+    auto& entry = it->second;
+    m_totalBytes -= entry.sizeBytes;
+    if (!entry.result) {
+        --m_spilledCount;
+    }
+    if (!entry.spillPath.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(entry.spillPath, ec);
+        m_spilledBytes -= entry.spillBytes;
+    }
+    m_entries.erase(it);
+}
+
+}  // namespace velocitydb
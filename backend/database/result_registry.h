@@ -0,0 +1,171 @@
+#pragma once
+
+#include "../utils/memory_governor.h"
+#include "../utils/string_hash.h"
+#include "result_set.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Rows of a held result in display order
+struct HeldResult {
+    std::shared_ptr<const ResultSet> result;
+    std::shared_ptr<const std::vector<size_t>> rows;  ///< Row indices in display order; nullptr = every row in fetch order
+
+    [[nodiscard]] size_t size() const noexcept { return rows ? rows->size() : result->rowCount(); }
+    [[nodiscard]] size_t rowAt(size_t position) const noexcept { return rows ? (*rows)[position] : position; }
+};
+
+/// A row change saved from the grid, applied to a held result by ResultRegistry::patch
+struct RowPatch {
+    enum class Kind : uint8_t { Replace, Remove, Append };
+
+    Kind kind = Kind::Replace;
+    size_t row = 0;    ///< Fetch-order row (Replace, Remove)
+    ResultSet values;  ///< The row as stored, with the held result's columns (Replace, Append); row 0 is used
+};
+
+/// Where a held result came from
+struct HeldOrigin {
+    std::string connectionId;
+    std::string sourceTable;  ///< The one table the query read (LOB previews are re-read from it); empty when unknown
+};
+
+/// Fetched results held on the backend under an opaque handle, so grid operations (sort, filter, paging,
+/// export) run on rows already fetched instead of sending the SQL back to the server.
+///
+/// Unlike ResultCache, an entry is owned by the grid that asked for it: it is never shared between
+/// identical queries and never invalidated by writes, so the grid keeps showing what it fetched.
+/// Entries expire after going unused for their idle TTL and are dropped with their connection; the
+/// total size is bounded, evicting the least recently used entries first.
+///
+/// Each entry also remembers the row order of the last sort/filter view computed over it, so paging
+/// through a sorted or filtered grid slices that order instead of recomputing it. Below that, the sort
+/// permutations and filter selections the views were built from are cached per entry (derivedRows), so
+/// toggling a sort or a filter back merges cached row lists in O(n) instead of sorting again. Views and
+/// cached row lists count towards the budget like the results themselves.
+///
+/// Resident results are charged to the MemoryGovernor's HeldResults pool. When results overall exceed the
+/// process budget, the registry spills the least recently used ones to temp files (BinaryResultEncoder
+/// layout) and drops them from the heap; the next use maps the file and decodes it back. A spill file is
+/// kept until its entry goes, so spilling the same result again costs no write.
+class ResultRegistry {
+public:
+    static constexpr std::chrono::seconds DEFAULT_IDLE_TTL = std::chrono::minutes(15);
+    /// Spill directories left behind by a process that did not exit cleanly are removed after this long
+    static constexpr std::chrono::hours STALE_SPILL_AGE{24};
+    /// Sort permutations and filter selections cached per held result
+    static constexpr size_t MAX_DERIVED_ROWS = 8;
+
+    explicit ResultRegistry(size_t maxBytes = 512 * 1024 * 1024, std::chrono::seconds idleTtl = DEFAULT_IDLE_TTL, std::filesystem::path spillRoot = defaultSpillRoot(),
+                            MemoryGovernor& governor = MemoryGovernor::instance());
+    ~ResultRegistry();
+
+    ResultRegistry(const ResultRegistry&) = delete;
+    ResultRegistry& operator=(const ResultRegistry&) = delete;
+    ResultRegistry(ResultRegistry&&) = delete;
+    ResultRegistry& operator=(ResultRegistry&&) = delete;
+
+    /// Hold `result`, fetched on `connectionId`, and return its handle; empty when the result alone exceeds the budget
+    [[nodiscard]] std::string put(std::string_view connectionId, std::shared_ptr<const ResultSet> result, std::string sourceTable = {});
+
+    /// Result held under `handle` (nullptr when unknown, released or expired); restarts its idle TTL
+    [[nodiscard]] std::shared_ptr<const ResultSet> find(std::string_view handle);
+
+    /// `handle` viewed as `viewKey`: the remembered row order when the last view was `viewKey`, else one computed
+    /// by `order` (outside the lock) and remembered in place of the previous view. `viewKey` empty = fetch order.
+    /// HeldResult::result is nullptr when the handle is unknown.
+    [[nodiscard]] HeldResult view(std::string_view handle, std::string_view viewKey, const std::function<std::vector<size_t>(const ResultSet&)>& order);
+
+    /// Row list derived from `handle`'s result under `key` (e.g. a sort permutation or a filter selection): the cached
+    /// one, else one computed by `compute` (outside the lock) and cached with the entry, the least recently used of
+    /// more than MAX_DERIVED_ROWS dropped first. nullptr when the handle is unknown.
+    [[nodiscard]] std::shared_ptr<const std::vector<size_t>> derivedRows(std::string_view handle, std::string_view key, const std::function<std::vector<size_t>(const ResultSet&)>& compute);
+
+    /// Replace `handle`'s result with a copy that has `patches` applied (appended rows last), so a grid shows saved
+    /// edits without running its query again. Views and derived row lists are dropped, since row numbers move.
+    /// false when the handle is unknown or its result changed while the copy was built.
+    bool patch(std::string_view handle, std::span<const RowPatch> patches);
+
+    /// Connection and source table of `handle`; nullopt when unknown. Does not restart the idle TTL.
+    [[nodiscard]] std::optional<HeldOrigin> origin(std::string_view handle) const;
+
+    /// Drop one held result; false when the handle is unknown
+    bool release(std::string_view handle);
+    /// Drop every result held for `connectionId`; returns the number dropped
+    size_t releaseConnection(std::string_view connectionId);
+
+    /// Spill the least recently used resident results until `wanted` heap bytes are freed; returns the bytes freed
+    size_t spill(size_t wanted);
+
+    /// %TEMP%\velocitydb_spill; each registry works in its own subdirectory
+    [[nodiscard]] static std::filesystem::path defaultSpillRoot();
+
+    /// Heap bytes of resident results, views and derived row lists
+    [[nodiscard]] size_t totalBytes() const;
+    [[nodiscard]] size_t entryCount() const;
+    [[nodiscard]] size_t spilledCount() const;
+    /// Bytes of spill files on disk
+    [[nodiscard]] size_t spilledBytes() const;
+
+private:
+    struct DerivedRows {
+        std::string key;
+        std::shared_ptr<const std::vector<size_t>> rows;
+    };
+
+    struct Entry {
+        std::string connectionId;
+        std::string sourceTable;
+        std::shared_ptr<const ResultSet> result;  ///< nullptr while spilled
+        std::string viewKey;
+        std::shared_ptr<const std::vector<size_t>> viewRows;
+        std::vector<DerivedRows> derived;  ///< Most recently used last
+        size_t resultBytes = 0;  ///< Heap bytes of the result when resident
+        size_t sizeBytes = 0;    ///< Resident result plus remembered view and derived row lists
+        std::filesystem::path spillPath;  ///< Copy on disk; empty until first spilled
+        size_t spillBytes = 0;
+        std::vector<LobPreview> lobPreviews;  ///< Kept here while spilled: the binary layout does not carry them
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    using Entries = std::unordered_map<std::string, Entry, StringHash, std::equal_to<>>;
+
+    /// Drop idle entries, then the least recently used ones (never `keep`) until `incoming` more bytes fit (lock held)
+    void evict(size_t incoming, const Entry* keep = nullptr);
+    /// Live entry for `handle` with its idle TTL restarted, or nullptr (lock held)
+    [[nodiscard]] Entry* touch(std::string_view handle);
+    void erase(Entries::iterator it);  // lock held
+    /// Swap `previous` bytes held beside `entry`'s result for `incoming`, then evict to the budget (lock held)
+    void recharge(Entry& entry, size_t previous, size_t incoming);
+    /// Resident result for `handle`, read back from its spill file if needed; nullptr when unknown
+    [[nodiscard]] std::shared_ptr<const ResultSet> acquire(std::string_view handle);
+    [[nodiscard]] static bool writeSpill(const std::filesystem::path& path, const ResultSet& result, size_t& fileBytes);
+    [[nodiscard]] static std::shared_ptr<ResultSet> readSpill(const std::filesystem::path& path);
+
+    size_t m_maxBytes;
+    std::chrono::seconds m_idleTtl;
+    std::filesystem::path m_spillDirectory;
+    MemoryCharge m_charge;
+    uint64_t m_reclaimerId = 0;
+    mutable std::mutex m_mutex;  // guards everything below
+    Entries m_entries;
+    size_t m_totalBytes = 0;
+    size_t m_spilledCount = 0;
+    size_t m_spilledBytes = 0;
+    uint64_t m_nextId = 1;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,797 @@
+#include "result_set.h"
+
+#include "../utils/hex_codec.h"
+#include "../utils/utf16_transcode.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <functional>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr size_t INITIAL_DICTIONARY_SLOTS = 64;
+
+/// Heap block behind a string; short strings live inside the object (SSO) and own none
+[[nodiscard]] size_t heapBytes(const std::string& text) noexcept {
+    static const size_t inlineCapacity = std::string().capacity();
+    return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+}
+
+template <typename T>
+[[nodiscard]] size_t heapBytes(const std::vector<T>& values) noexcept {
+    return values.capacity() * sizeof(T);
+}
+
+constexpr std::array<uint32_t, 10> POW10 = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+void appendPadded(std::string& out, uint32_t value, int width) {
+    std::array<char, 10> digits{};
+    for (int i = width - 1; i >= 0; --i) {
+        digits[static_cast<size_t>(i)] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    out.append(digits.data(), static_cast<size_t>(width));
+}
+
+void appendDate(std::string& out, const DateTimeValue& v) {
+    appendPadded(out, static_cast<uint32_t>(v.year), 4);
+    out += '-';
+    appendPadded(out, v.month, 2);
+    out += '-';
+    appendPadded(out, v.day, 2);
+}
+
+void appendTime(std::string& out, const DateTimeValue& v, uint8_t fractionDigits) {
+    appendPadded(out, v.hour, 2);
+    out += ':';
+    appendPadded(out, v.minute, 2);
+    out += ':';
+    appendPadded(out, v.second, 2);
+    if (fractionDigits > 0) {
+        out += '.';
+        appendPadded(out, v.fraction / POW10[9 - fractionDigits], fractionDigits);
+    }
+}
+
+[[nodiscard]] bool parseFixed(std::string_view text, size_t pos, size_t width, uint32_t& out) {
+    if (pos + width > text.size())
+        return false;
+    uint32_t value = 0;
+    for (size_t i = pos; i < pos + width; ++i) {
+        char c = text[i];
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    out = value;
+    return true;
+}
+
+/// "YYYY-MM-DD"
+[[nodiscard]] bool parseDate(std::string_view text, DateTimeValue& v) {
+    uint32_t year = 0, month = 0, day = 0;
+    if (text.size() < 10 || text[4] != '-' || text[7] != '-')
+        return false;
+    if (!parseFixed(text, 0, 4, year) || !parseFixed(text, 5, 2, month) || !parseFixed(text, 8, 2, day))
+        return false;
+    v.year = static_cast<int16_t>(year);
+    v.month = static_cast<uint8_t>(month);
+    v.day = static_cast<uint8_t>(day);
+    return true;
+}
+
+/// "hh:mm:ss[.fffffff]" - the number of fraction digits must match the column scale exactly
+/// so the value round-trips to the same text.
+[[nodiscard]] bool parseTime(std::string_view text, uint8_t fractionDigits, DateTimeValue& v) {
+    uint32_t hour = 0, minute = 0, second = 0, fraction = 0;
+    if (text.size() < 8 || text[2] != ':' || text[5] != ':')
+        return false;
+    if (!parseFixed(text, 0, 2, hour) || !parseFixed(text, 3, 2, minute) || !parseFixed(text, 6, 2, second))
+        return false;
+    if (fractionDigits == 0) {
+        if (text.size() != 8)
+            return false;
+    } else {
+        if (fractionDigits > 9 || text.size() != 9u + fractionDigits || text[8] != '.' || !parseFixed(text, 9, fractionDigits, fraction))
+            return false;
+        fraction *= POW10[9 - fractionDigits];
+    }
+    v.hour = static_cast<uint8_t>(hour);
+    v.minute = static_cast<uint8_t>(minute);
+    v.second = static_cast<uint8_t>(second);
+    v.fraction = fraction;
+    return true;
+}
+
+// Indexed by SqlType
+constexpr std::array<std::string_view, 25> SQL_TYPE_NAMES = {"UNKNOWN", "CHAR", "VARCHAR", "NCHAR", "NVARCHAR", "BINARY", "VARBINARY", "UNIQUEIDENTIFIER", "XML", "SQL_VARIANT", "TINYINT",
+                                                             "SMALLINT", "INT", "BIGINT", "REAL", "FLOAT", "DECIMAL", "MONEY", "BIT", "DATE", "TIME", "DATETIME", "SMALLDATETIME",
+                                                             "DATETIME2", "DATETIMEOFFSET"};
+static_assert(SQL_TYPE_NAMES.size() == static_cast<size_t>(SqlType::DateTimeOffset) + 1);
+
+struct SqlTypeAlias {
+    std::string_view name;  // lower case
+    SqlType type;
+};
+
+// Names and aliases of SQL Server, PostgreSQL, MySQL and the file importers
+constexpr std::array<SqlTypeAlias, 54> SQL_TYPE_ALIASES = {{
+    {"char", SqlType::Char},
+    {"character", SqlType::Char},
+    {"varchar", SqlType::VarChar},
+    {"character varying", SqlType::VarChar},
+    {"text", SqlType::VarChar},
+    {"tinytext", SqlType::VarChar},
+    {"mediumtext", SqlType::VarChar},
+    {"longtext", SqlType::VarChar},
+    {"nchar", SqlType::NChar},
+    {"nvarchar", SqlType::NVarChar},
+    {"ntext", SqlType::NVarChar},
+    {"sysname", SqlType::NVarChar},
+    {"binary", SqlType::Binary},
+    {"varbinary", SqlType::VarBinary},
+    {"image", SqlType::VarBinary},
+    {"blob", SqlType::VarBinary},
+    {"bytea", SqlType::VarBinary},
+    {"rowversion", SqlType::Binary},
+    {"uniqueidentifier", SqlType::UniqueIdentifier},
+    {"uuid", SqlType::UniqueIdentifier},
+    {"xml", SqlType::Xml},
+    {"sql_variant", SqlType::Variant},
+    {"tinyint", SqlType::TinyInt},
+    {"smallint", SqlType::SmallInt},
+    {"int2", SqlType::SmallInt},
+    {"int", SqlType::Int},
+    {"integer", SqlType::Int},
+    {"int4", SqlType::Int},
+    {"mediumint", SqlType::Int},
+    {"bigint", SqlType::BigInt},
+    {"int8", SqlType::BigInt},
+    {"real", SqlType::Real},
+    {"float4", SqlType::Real},
+    {"float", SqlType::Float},
+    {"double", SqlType::Float},
+    {"double precision", SqlType::Float},
+    {"float8", SqlType::Float},
+    {"decimal", SqlType::Decimal},
+    {"dec", SqlType::Decimal},
+    {"numeric", SqlType::Decimal},
+    {"money", SqlType::Money},
+    {"smallmoney", SqlType::Money},
+    {"bit", SqlType::Bit},
+    {"bool", SqlType::Bit},
+    {"boolean", SqlType::Bit},
+    {"date", SqlType::Date},
+    {"time", SqlType::Time},
+    {"datetime", SqlType::DateTime},
+    {"smalldatetime", SqlType::SmallDateTime},
+    {"datetime2", SqlType::DateTime2},
+    {"timestamp", SqlType::DateTime2},
+    {"datetimeoffset", SqlType::DateTimeOffset},
+    {"timestamptz", SqlType::DateTimeOffset},
+    {"timestamp with time zone", SqlType::DateTimeOffset},
+}};
+
+[[nodiscard]] SqlType lookupSqlType(std::string_view name) noexcept {
+    for (const auto& alias : SQL_TYPE_ALIASES) {
+        if (alias.name.size() == name.size() && std::ranges::equal(alias.name, name, [](char a, char b) { return a == (b >= 'A' && b <= 'Z' ? static_cast<char>(b - 'A' + 'a') : b); })) {
+            return alias.type;
+        }
+    }
+    return SqlType::Unknown;
+}
+
+}  // namespace
+
+std::string_view sqlTypeName(SqlType type) noexcept {
+    const auto index = static_cast<size_t>(type);
+    return index < SQL_TYPE_NAMES.size() ? SQL_TYPE_NAMES[index] : SQL_TYPE_NAMES[0];
+}
+
+SqlType sqlTypeFromName(std::string_view name) noexcept {
+    // "decimal(10, 2)", "nvarchar(50)": the length or precision is not part of the name
+    name = name.substr(0, name.find('('));
+    while (!name.empty() && name.back() == ' ') {
+        name.remove_suffix(1);
+    }
+    while (!name.empty() && name.front() == ' ') {
+        name.remove_prefix(1);
+    }
+    if (auto type = lookupSqlType(name); type != SqlType::Unknown) {
+        return type;
+    }
+    // "int unsigned", "bigint identity"
+    auto space = name.find(' ');
+    return space == std::string_view::npos ? SqlType::Unknown : lookupSqlType(name.substr(0, space));
+}
+
+void ColumnData::reserve(size_t rows, size_t textBytes) {
+    m_nullBits.reserve((rows + 63) / 64);
+    switch (m_type) {
+        case ColumnDataType::Text:
+            // A dictionary only needs the codes up front; its arena holds far less than textBytes
+            if (m_dictionary) {
+                m_codes.reserve(rows);
+            } else {
+                m_offsets.reserve(rows + 1);
+                m_chars.reserve(textBytes);
+            }
+            break;
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            m_ints.reserve(rows);
+            break;
+        case ColumnDataType::Double:
+            m_doubles.reserve(rows);
+            break;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            m_dateTimes.reserve(rows);
+            break;
+        case ColumnDataType::Binary:
+            m_offsets.reserve(rows + 1);
+            m_chars.reserve(textBytes);
+            break;
+    }
+}
+
+size_t ColumnData::rowTextBytes() const noexcept {
+    if (!m_dictionary) {
+        return m_offsets[m_size] - m_offsets[0];
+    }
+    size_t bytes = 0;
+    for (uint32_t code : m_codes) {
+        bytes += m_offsets[code + 1] - m_offsets[code];
+    }
+    return bytes;
+}
+
+std::optional<uint32_t> ColumnData::dictionaryCode(std::string_view value) const noexcept {
+    if (!m_dictionary || m_slots.empty()) {
+        return std::nullopt;
+    }
+    const uint32_t slot = m_slots[findSlot(value, std::hash<std::string_view>{}(value))];
+    return slot == 0 ? std::nullopt : std::optional<uint32_t>(slot - 1);
+}
+
+size_t ColumnData::findSlot(std::string_view value, size_t hash) const noexcept {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        if (m_slots[slot] == 0 || arenaText(m_slots[slot] - 1) == value) {
+            return slot;
+        }
+    }
+}
+
+uint32_t ColumnData::internTail(size_t start) {
+    if (m_slots.empty()) {
+        m_slots.assign(INITIAL_DICTIONARY_SLOTS, 0);
+    }
+    const std::string_view value(m_chars.data() + start, m_chars.size() - start);
+    const size_t slot = findSlot(value, std::hash<std::string_view>{}(value));
+    if (m_slots[slot] != 0) {
+        m_chars.resize(start);
+        return m_slots[slot] - 1;
+    }
+
+    const auto code = static_cast<uint32_t>(m_offsets.size() - 1);
+    m_offsets.push_back(m_chars.size());
+    m_slots[slot] = code + 1;
+    // Keep the index at most half full
+    if (m_offsets.size() * 2 > m_slots.size()) {
+        std::vector<uint32_t> slots(m_slots.size() * 2, 0);
+        m_slots.swap(slots);
+        for (uint32_t entry = 0; entry <= code; ++entry) {
+            const auto text = arenaText(entry);
+            m_slots[findSlot(text, std::hash<std::string_view>{}(text))] = entry + 1;
+        }
+    }
+    return code;
+}
+
+uint32_t ColumnData::intern(std::string_view value) {
+    const size_t start = m_chars.size();
+    m_chars.append(value);
+    return internTail(start);
+}
+
+void ColumnData::checkCardinality() {
+    const size_t entries = m_offsets.size() - 1;
+    if (entries > DICTIONARY_MAX_ENTRIES || (m_size >= DICTIONARY_PROBE_ROWS && entries * DICTIONARY_MIN_REPEAT > m_size)) {
+        decodeDictionary();
+    }
+}
+
+void ColumnData::decodeDictionary() {
+    std::string chars;
+    chars.reserve(rowTextBytes());
+    std::vector<size_t> offsets;
+    offsets.reserve(m_size + 1);
+    offsets.push_back(0);
+    for (size_t row = 0; row < m_size; ++row) {
+        chars.append(textAt(row));
+        offsets.push_back(chars.size());
+    }
+
+    m_dictionary = false;
+    m_chars = std::move(chars);
+    m_offsets = std::move(offsets);
+    m_codes = {};
+    m_slots = {};
+}
+
+void ColumnData::pushSlot(bool isNull) {
+    if ((m_size & 63) == 0) {
+        m_nullBits.push_back(0);
+    }
+    if (isNull) {
+        m_nullBits.back() |= uint64_t{1} << (m_size & 63);
+    }
+    ++m_size;
+}
+
+void ColumnData::appendNull() {
+    switch (m_type) {
+        case ColumnDataType::Text:
+            if (m_dictionary) {
+                m_codes.push_back(internTail(m_chars.size()));
+            } else {
+                m_offsets.push_back(m_chars.size());
+            }
+            break;
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            m_ints.push_back(0);
+            break;
+        case ColumnDataType::Double:
+            m_doubles.push_back(0.0);
+            break;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            m_dateTimes.emplace_back();
+            break;
+        case ColumnDataType::Binary:
+            m_offsets.push_back(m_chars.size());
+            break;
+    }
+    pushSlot(true);
+}
+
+void ColumnData::appendText(std::string_view value) {
+    if (m_type != ColumnDataType::Text) [[unlikely]] {
+        convertToText();
+    }
+    if (m_dictionary) {
+        const size_t entries = m_offsets.size();
+        m_codes.push_back(intern(value));
+        pushSlot(false);
+        if (m_offsets.size() != entries) {
+            checkCardinality();
+        }
+        return;
+    }
+    m_chars.append(value);
+    m_offsets.push_back(m_chars.size());
+    pushSlot(false);
+}
+
+void ColumnData::appendInt64(int64_t value) {
+    m_ints.push_back(value);
+    pushSlot(false);
+}
+
+void ColumnData::appendDouble(double value) {
+    m_doubles.push_back(value);
+    pushSlot(false);
+}
+
+void ColumnData::appendBit(bool value) {
+    m_ints.push_back(value ? 1 : 0);
+    pushSlot(false);
+}
+
+void ColumnData::appendDateTime(const DateTimeValue& value) {
+    m_dateTimes.push_back(value);
+    pushSlot(false);
+}
+
+void ColumnData::appendBinary(std::string_view bytes) {
+    if (m_type != ColumnDataType::Binary) [[unlikely]] {
+        thread_local std::string hex;
+        hex.clear();
+        appendHex(hex, bytes);
+        appendFromText(hex);
+        return;
+    }
+    m_chars.append(bytes);
+    m_offsets.push_back(m_chars.size());
+    pushSlot(false);
+}
+
+void ColumnData::appendFromText(std::string_view value) {
+    const char* first = value.data();
+    const char* last = value.data() + value.size();
+
+    switch (m_type) {
+        case ColumnDataType::Text:
+            break;
+        case ColumnDataType::Int64: {
+            int64_t parsed = 0;
+            auto [ptr, ec] = std::from_chars(first, last, parsed);
+            if (ec == std::errc{} && ptr == last && !value.empty()) [[likely]] {
+                appendInt64(parsed);
+                return;
+            }
+            break;
+        }
+        case ColumnDataType::Double: {
+            double parsed = 0.0;
+            auto [ptr, ec] = std::from_chars(first, last, parsed);
+            if (ec == std::errc{} && ptr == last && !value.empty()) [[likely]] {
+                appendDouble(parsed);
+                return;
+            }
+            break;
+        }
+        case ColumnDataType::Bit:
+            if (value == "1" || value == "0") [[likely]] {
+                appendBit(value == "1");
+                return;
+            }
+            break;
+        case ColumnDataType::Date: {
+            DateTimeValue parsed;
+            if (value.size() == 10 && parseDate(value, parsed)) [[likely]] {
+                appendDateTime(parsed);
+                return;
+            }
+            break;
+        }
+        case ColumnDataType::Time: {
+            DateTimeValue parsed;
+            if (parseTime(value, m_fractionDigits, parsed)) [[likely]] {
+                appendDateTime(parsed);
+                return;
+            }
+            break;
+        }
+        case ColumnDataType::Timestamp: {
+            DateTimeValue parsed;
+            if (value.size() > 11 && value[10] == ' ' && parseDate(value, parsed) && parseTime(value.substr(11), m_fractionDigits, parsed)) [[likely]] {
+                appendDateTime(parsed);
+                return;
+            }
+            break;
+        }
+        case ColumnDataType::Binary:
+            // Hex straight onto the arena tail
+            if (appendHexDecoded(m_chars, value)) [[likely]] {
+                m_offsets.push_back(m_chars.size());
+                pushSlot(false);
+                return;
+            }
+            break;
+    }
+    appendText(value);
+}
+
+size_t ColumnData::appendUtf16(std::u16string_view value) {
+    if (m_type == ColumnDataType::Text) {
+        const size_t before = m_chars.size();
+        appendUtf16AsUtf8(m_chars, value);
+        const size_t converted = m_chars.size() - before;
+        if (m_dictionary) {
+            // Transcoded straight onto the arena tail; a repeated value is trimmed off again
+            const size_t entries = m_offsets.size();
+            m_codes.push_back(internTail(before));
+            pushSlot(false);
+            if (m_offsets.size() != entries) {
+                checkCardinality();
+            }
+            return converted;
+        }
+        m_offsets.push_back(m_chars.size());
+        pushSlot(false);
+        return converted;
+    }
+    thread_local std::string scratch;
+    scratch.clear();
+    appendUtf16AsUtf8(scratch, value);
+    appendFromText(scratch);
+    return scratch.size();
+}
+
+void ColumnData::appendDisplayText(std::string& out, size_t row) const {
+    if (isNull(row)) {
+        return;
+    }
+    switch (m_type) {
+        case ColumnDataType::Text:
+            out.append(textAt(row));
+            break;
+        case ColumnDataType::Int64: {
+            std::array<char, 24> buf{};
+            auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), m_ints[row]);
+            out.append(buf.data(), ptr);
+            break;
+        }
+        case ColumnDataType::Bit:
+            out += m_ints[row] != 0 ? '1' : '0';
+            break;
+        case ColumnDataType::Double: {
+            std::array<char, 32> buf{};
+            auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), m_doubles[row]);
+            out.append(buf.data(), ptr);
+            break;
+        }
+        case ColumnDataType::Date:
+            appendDate(out, m_dateTimes[row]);
+            break;
+        case ColumnDataType::Time:
+            appendTime(out, m_dateTimes[row], m_fractionDigits);
+            break;
+        case ColumnDataType::Timestamp:
+            appendDate(out, m_dateTimes[row]);
+            out += ' ';
+            appendTime(out, m_dateTimes[row], m_fractionDigits);
+            break;
+        case ColumnDataType::Binary:
+            // Encoded only here, for the cells actually shown or serialized
+            appendHex(out, arenaText(row));
+            break;
+    }
+}
+
+std::string ColumnData::displayText(size_t row) const {
+    if (m_type == ColumnDataType::Text) {
+        return std::string(textAt(row));
+    }
+    std::string out;
+    appendDisplayText(out, row);
+    return out;
+}
+
+void ColumnData::appendFrom(const ColumnData& source, size_t row) {
+    if (source.isNull(row)) {
+        appendNull();
+        return;
+    }
+    if (source.m_type != m_type) [[unlikely]] {
+        appendFromText(source.displayText(row));
+        return;
+    }
+    switch (m_type) {
+        case ColumnDataType::Text:
+            appendText(source.textAt(row));
+            break;
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            appendInt64(source.m_ints[row]);
+            break;
+        case ColumnDataType::Double:
+            appendDouble(source.m_doubles[row]);
+            break;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            appendDateTime(source.m_dateTimes[row]);
+            break;
+        case ColumnDataType::Binary:
+            appendBinary(source.arenaText(row));
+            break;
+    }
+}
+
+void ColumnData::appendAll(const ColumnData& source) {
+    if (source.m_type != m_type || source.m_fractionDigits != m_fractionDigits) {
+        if (m_type != ColumnDataType::Text && source.m_type == ColumnDataType::Text) {
+            convertToText();
+        }
+        for (size_t row = 0; row < source.m_size; ++row) {
+            appendFrom(source, row);
+        }
+        return;
+    }
+
+    switch (m_type) {
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary: {
+            // Binary columns are never dictionary-encoded and take the plain arena copy below
+            if (m_dictionary && !source.m_dictionary && source.m_size > 0) {
+                // The source already gave up on its dictionary (or was converted from another type)
+                decodeDictionary();
+            }
+            if (m_dictionary) {
+                // A dictionary source is merged once per distinct value, then its codes are translated
+                std::vector<uint32_t> remap;
+                remap.reserve(source.dictionarySize());
+                for (uint32_t code = 0; code < source.dictionarySize(); ++code) {
+                    remap.push_back(intern(source.dictionaryValue(code)));
+                }
+                m_codes.reserve(m_codes.size() + source.m_size);
+                for (size_t row = 0; row < source.m_size; ++row) {
+                    m_codes.push_back(remap[source.m_codes[row]]);
+                }
+                break;
+            }
+            m_offsets.reserve(m_offsets.size() + source.m_size);
+            if (source.m_dictionary) {
+                m_chars.reserve(m_chars.size() + source.rowTextBytes());
+                for (size_t row = 0; row < source.m_size; ++row) {
+                    m_chars.append(source.textAt(row));
+                    m_offsets.push_back(m_chars.size());
+                }
+                break;
+            }
+            const size_t base = m_chars.size();
+            m_chars.append(source.m_chars);
+            for (size_t row = 1; row <= source.m_size; ++row) {
+                m_offsets.push_back(base + source.m_offsets[row]);
+            }
+            break;
+        }
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            m_ints.insert(m_ints.end(), source.m_ints.begin(), source.m_ints.end());
+            break;
+        case ColumnDataType::Double:
+            m_doubles.insert(m_doubles.end(), source.m_doubles.begin(), source.m_doubles.end());
+            break;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            m_dateTimes.insert(m_dateTimes.end(), source.m_dateTimes.begin(), source.m_dateTimes.end());
+            break;
+    }
+    for (size_t row = 0; row < source.m_size; ++row) {
+        pushSlot(source.isNull(row));
+    }
+    if (m_dictionary) {
+        checkCardinality();
+    }
+}
+
+void ColumnData::clear() noexcept {
+    m_size = 0;
+    m_nullBits.clear();
+    m_offsets.resize(1);
+    m_chars.clear();
+    m_codes.clear();
+    std::fill(m_slots.begin(), m_slots.end(), 0);
+    m_ints.clear();
+    m_doubles.clear();
+    m_dateTimes.clear();
+    m_stats.reset();
+}
+
+void ColumnData::convertToText() {
+    if (m_type == ColumnDataType::Text) {
+        return;
+    }
+
+    std::string chars;
+    std::vector<size_t> offsets;
+    offsets.reserve(m_size + 1);
+    offsets.push_back(0);
+    for (size_t row = 0; row < m_size; ++row) {
+        appendDisplayText(chars, row);
+        offsets.push_back(chars.size());
+    }
+
+    m_type = ColumnDataType::Text;
+    m_dictionary = false;
+    m_chars = std::move(chars);
+    m_offsets = std::move(offsets);
+    m_ints = {};
+    m_doubles = {};
+    m_dateTimes = {};
+    m_stats.reset();
+}
+
+size_t ColumnData::memoryBytes() const noexcept {
+    // Allocated capacity, not just the bytes in use: growth headroom is memory held all the same
+    return sizeof(ColumnData) + heapBytes(m_nullBits) + heapBytes(m_offsets) + heapBytes(m_chars) + heapBytes(m_codes) + heapBytes(m_slots) + heapBytes(m_ints) + heapBytes(m_doubles) +
+           heapBytes(m_dateTimes) + m_stats.memoryBytes();
+}
+
+void ResultSet::ensureColumnStorage(size_t count) {
+    count = (std::max)(count, columns.size());
+    const size_t rows = rowCount();
+    while (columnData.size() < count) {
+        auto& column = columnData.emplace_back(ColumnDataType::Text);
+        for (size_t i = 0; i < rows; ++i) {
+            column.appendNull();
+        }
+    }
+}
+
+void ResultSet::appendRow(std::initializer_list<std::string_view> values) {
+    ensureColumnStorage(values.size());
+    size_t col = 0;
+    for (auto value : values) {
+        columnData[col++].appendFromText(value);
+    }
+    for (; col < columnData.size(); ++col) {
+        columnData[col].appendNull();
+    }
+}
+
+void ResultSet::appendRow(const std::vector<std::string>& values) {
+    ensureColumnStorage(values.size());
+    size_t col = 0;
+    for (const auto& value : values) {
+        columnData[col++].appendFromText(value);
+    }
+    for (; col < columnData.size(); ++col) {
+        columnData[col].appendNull();
+    }
+}
+
+void ResultSet::appendRowFrom(const ResultSet& source, size_t row) {
+    if (columnData.empty()) {
+        for (const auto& column : source.columnData) {
+            columnData.emplace_back(column.type(), column.fractionDigits());
+        }
+    }
+    for (size_t col = 0; col < columnData.size() && col < source.columnData.size(); ++col) {
+        columnData[col].appendFrom(source.columnData[col], row);
+    }
+}
+
+void ResultSet::appendBatch(const ResultSet& batch) {
+    if (columnData.empty()) {
+        for (const auto& column : batch.columnData) {
+            columnData.emplace_back(column.type(), column.fractionDigits());
+        }
+    }
+    const size_t firstRow = rowCount();
+    for (size_t col = 0; col < columnData.size() && col < batch.columnData.size(); ++col) {
+        columnData[col].appendAll(batch.columnData[col]);
+        columnData[col].updateStats();
+    }
+    for (const auto& preview : batch.lobPreviews) {
+        lobPreviews.push_back({.row = firstRow + preview.row, .column = preview.column, .totalBytes = preview.totalBytes});
+    }
+}
+
+void ResultSet::clearRows() noexcept {
+    for (auto& column : columnData) {
+        column.clear();
+    }
+    lobPreviews.clear();
+}
+
+void ResultSet::updateStats() {
+    for (auto& column : columnData) {
+        column.updateStats();
+    }
+}
+
+const LobPreview* ResultSet::lobPreview(size_t row, size_t col) const noexcept {
+    auto it = std::ranges::lower_bound(lobPreviews, row, {}, &LobPreview::row);
+    for (; it != lobPreviews.end() && it->row == row; ++it) {
+        if (it->column == col) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+size_t ResultSet::memoryBytes() const noexcept {
+    // ColumnData::memoryBytes counts its own object; only unused vector slots are added here
+    size_t size = sizeof(ResultSet) + heapBytes(columns) + heapBytes(lobPreviews) + messages.memoryBytes() + (columnData.capacity() - columnData.size()) * sizeof(ColumnData);
+    for (const auto& col : columns) {
+        size += heapBytes(col.name) + heapBytes(col.type) + heapBytes(col.comment);
+    }
+    for (const auto& data : columnData) {
+        size += data.memoryBytes();
+    }
+    return size;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,316 @@
+#pragma once
+
+#include "column_stats.h"
+#include "server_messages.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// SQL type of a column. Drivers set it from the column description, so code that picks a path per column
+/// switches on it instead of comparing type names.
+enum class SqlType : uint8_t {
+    Unknown,
+    Char,
+    VarChar,
+    NChar,
+    NVarChar,
+    Binary,
+    VarBinary,
+    UniqueIdentifier,
+    Xml,
+    Variant,
+    TinyInt,
+    SmallInt,
+    Int,
+    BigInt,
+    Real,
+    Float,
+    Decimal,  ///< DECIMAL and NUMERIC
+    Money,    ///< MONEY and SMALLMONEY
+    Bit,
+    Date,
+    Time,
+    DateTime,
+    SmallDateTime,
+    DateTime2,
+    DateTimeOffset,
+};
+
+/// Upper-case display name ("NVARCHAR", "DATETIME2", ...); "UNKNOWN" for SqlType::Unknown
+[[nodiscard]] std::string_view sqlTypeName(SqlType type) noexcept;
+/// SqlType of a type name from any driver or catalog, case-insensitive, with common aliases
+/// ("integer", "double", "numeric", "smallmoney", "ntext", ...); Unknown when unrecognized
+[[nodiscard]] SqlType sqlTypeFromName(std::string_view name) noexcept;
+
+[[nodiscard]] constexpr bool isIntegerType(SqlType type) noexcept {
+    return type == SqlType::TinyInt || type == SqlType::SmallInt || type == SqlType::Int || type == SqlType::BigInt;
+}
+[[nodiscard]] constexpr bool isNumericType(SqlType type) noexcept {
+    return isIntegerType(type) || type == SqlType::Real || type == SqlType::Float || type == SqlType::Decimal || type == SqlType::Money;
+}
+[[nodiscard]] constexpr bool isDateTimeType(SqlType type) noexcept {
+    return type == SqlType::DateTime || type == SqlType::SmallDateTime || type == SqlType::DateTime2;
+}
+
+struct ColumnInfo {
+    std::string name;
+    std::string type;  ///< Display name; sqlTypeName(sqlType) for driver results
+    int size = 0;      ///< Length in characters or bytes (column size as described by the driver)
+    bool nullable = true;
+    bool isPrimaryKey = false;
+    std::string comment;
+    SqlType sqlType = SqlType::Unknown;
+    int precision = 0;  ///< Total digits of DECIMAL/NUMERIC; 0 when not applicable
+    int scale = 0;      ///< Fractional digits of DECIMAL/NUMERIC and of fractional-second types
+
+    /// sqlType, or for columns that only carry a type name (catalogs, other drivers, snapshots) the type it names
+    [[nodiscard]] SqlType typeCode() const noexcept { return sqlType != SqlType::Unknown ? sqlType : sqlTypeFromName(type); }
+};
+
+/// Physical storage type of a result column.
+enum class ColumnDataType : uint8_t {
+    Text,  ///< UTF-8 text (offsets + one character arena)
+    Int64,
+    Double,
+    Bit,
+    Date,
+    Time,
+    Timestamp,
+    Binary,  ///< Raw bytes (offsets + arena, never dictionary-encoded); displayed as upper-case hex
+};
+
+/// Broken-down date/time value. Mirrors SQL_TIMESTAMP_STRUCT; fraction is in nanoseconds.
+struct DateTimeValue {
+    int16_t year = 0;
+    uint8_t month = 0;
+    uint8_t day = 0;
+    uint8_t hour = 0;
+    uint8_t minute = 0;
+    uint8_t second = 0;
+    uint32_t fraction = 0;
+};
+
+/// Column-major storage for one result column.
+/// Text values share a single character arena addressed by an offsets array, fixed-width
+/// values live in a typed vector (null rows keep a zeroed slot), and nulls are tracked in a bitmap.
+///
+/// Text columns start dictionary-encoded: the arena holds each distinct value once and every row stores a
+/// 32-bit code into it, found through a hash index as the value is appended. Once the column turns out to
+/// hold mostly distinct values it is expanded to plain per-row offsets and stays plain.
+class ColumnData {
+public:
+    /// Dictionary encoding gives up past this many distinct values...
+    static constexpr size_t DICTIONARY_MAX_ENTRIES = size_t{1} << 16;
+    /// ...or, once this many rows are in, when fewer than DICTIONARY_MIN_REPEAT rows share each value on average
+    static constexpr size_t DICTIONARY_PROBE_ROWS = 1024;
+    static constexpr size_t DICTIONARY_MIN_REPEAT = 4;
+
+    ColumnData() = default;
+    explicit ColumnData(ColumnDataType type, uint8_t fractionDigits = 0) : m_type(type), m_fractionDigits(fractionDigits), m_dictionary(type == ColumnDataType::Text) {}
+
+    [[nodiscard]] ColumnDataType type() const noexcept { return m_type; }
+    [[nodiscard]] uint8_t fractionDigits() const noexcept { return m_fractionDigits; }
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    /// Bytes in the character arena (each distinct value once while dictionary-encoded)
+    [[nodiscard]] size_t textBytes() const noexcept { return m_chars.size(); }
+    /// Text bytes summed over every row, as a plain encoding would store them
+    [[nodiscard]] size_t rowTextBytes() const noexcept;
+    [[nodiscard]] bool isNumeric() const noexcept { return m_type == ColumnDataType::Int64 || m_type == ColumnDataType::Double || m_type == ColumnDataType::Bit; }
+
+    void reserve(size_t rows, size_t textBytes = 0);
+
+    void appendNull();
+    void appendText(std::string_view value);
+    void appendInt64(int64_t value);
+    void appendDouble(double value);
+    void appendBit(bool value);
+    void appendDateTime(const DateTimeValue& value);
+    /// Raw bytes of a Binary column; other columns store the hex text
+    void appendBinary(std::string_view bytes);
+
+    /// Parse a textual value according to the column type.
+    /// If the value does not parse, the column is converted to Text and the value stored verbatim.
+    void appendFromText(std::string_view value);
+    /// appendFromText of UTF-16 text (ODBC SQL_C_WCHAR). Text columns transcode straight into the character
+    /// arena; other types go through a per-thread scratch buffer. Returns the UTF-8 size of the value.
+    size_t appendUtf16(std::u16string_view value);
+
+    [[nodiscard]] bool isNull(size_t row) const noexcept { return (m_nullBits[row >> 6] >> (row & 63)) & 1; }
+    /// UTF-8 value of a Text cell, or the raw bytes of a Binary one
+    [[nodiscard]] std::string_view textAt(size_t row) const noexcept { return arenaText(m_dictionary ? m_codes[row] : row); }
+    [[nodiscard]] int64_t int64At(size_t row) const noexcept { return m_ints[row]; }
+    [[nodiscard]] double doubleAt(size_t row) const noexcept { return m_doubles[row]; }
+    [[nodiscard]] const DateTimeValue& dateTimeAt(size_t row) const noexcept { return m_dateTimes[row]; }
+
+    /// Raw column storage (one 64-bit null word per 64 rows; only the vector matching type() is populated).
+    /// textOffsets() has one entry per row plus one, or per dictionary entry plus one while dictionary-encoded.
+    /// Binary columns keep their bytes in the same offsets and arena.
+    [[nodiscard]] std::span<const uint64_t> nullWords() const noexcept { return m_nullBits; }
+    [[nodiscard]] std::span<const size_t> textOffsets() const noexcept { return m_offsets; }
+    [[nodiscard]] std::string_view textChars() const noexcept { return m_chars; }
+    [[nodiscard]] std::span<const int64_t> int64Values() const noexcept { return m_ints; }
+    [[nodiscard]] std::span<const double> doubleValues() const noexcept { return m_doubles; }
+    [[nodiscard]] std::span<const DateTimeValue> dateTimeValues() const noexcept { return m_dateTimes; }
+
+    /// Dictionary encoding (Text columns only). NULL rows carry the code of the empty string.
+    [[nodiscard]] bool isDictionaryEncoded() const noexcept { return m_dictionary; }
+    [[nodiscard]] size_t dictionarySize() const noexcept { return m_dictionary ? m_offsets.size() - 1 : 0; }
+    [[nodiscard]] std::string_view dictionaryValue(uint32_t code) const noexcept { return arenaText(code); }
+    [[nodiscard]] std::span<const uint32_t> dictionaryCodes() const noexcept { return m_codes; }
+    /// Code of `value`, or nullopt when no row holds it (or the column is not dictionary-encoded)
+    [[nodiscard]] std::optional<uint32_t> dictionaryCode(std::string_view value) const noexcept;
+
+    /// Zone maps, null count, min/max and distinct estimate of the rows folded in by updateStats() so far
+    [[nodiscard]] const ColumnStats& stats() const noexcept { return m_stats; }
+    /// Fold the rows appended since the last call into stats(). Fetch paths call it once per batch, while the
+    /// batch's values are still in cache; rewriting rows (clear, convertToText) starts the stats over.
+    void updateStats() { m_stats.update(*this); }
+
+    /// Int64/Bit/Double value widened to double (numeric columns only).
+    [[nodiscard]] double numericAt(size_t row) const noexcept { return m_type == ColumnDataType::Double ? m_doubles[row] : static_cast<double>(m_ints[row]); }
+
+    /// Append the display text of a cell (NULL appends nothing).
+    void appendDisplayText(std::string& out, size_t row) const;
+    [[nodiscard]] std::string displayText(size_t row) const;
+
+    /// Append one cell copied from another column (typed copy when the storage types match).
+    void appendFrom(const ColumnData& source, size_t row);
+    /// Append every cell of another column.
+    void appendAll(const ColumnData& source);
+
+    /// Drop all rows but keep the storage type, text encoding and allocated capacity (batch reuse).
+    void clear() noexcept;
+
+    /// Rewrite the column as Text, preserving values and nulls.
+    void convertToText();
+
+    /// Bytes held, counting allocated capacity rather than the part in use
+    [[nodiscard]] size_t memoryBytes() const noexcept;
+
+private:
+    [[nodiscard]] std::string_view arenaText(size_t index) const noexcept { return std::string_view(m_chars).substr(m_offsets[index], m_offsets[index + 1] - m_offsets[index]); }
+
+    void pushSlot(bool isNull);
+    /// Hash slot holding `value`'s code, or the empty slot where it belongs
+    [[nodiscard]] size_t findSlot(std::string_view value, size_t hash) const noexcept;
+    /// Code of the value appended to the arena at `start`; a repeat is trimmed off the arena again
+    [[nodiscard]] uint32_t internTail(size_t start);
+    [[nodiscard]] uint32_t intern(std::string_view value);
+    /// Expand to plain offsets if the dictionary no longer pays for itself
+    void checkCardinality();
+    void decodeDictionary();
+
+    ColumnDataType m_type = ColumnDataType::Text;
+    uint8_t m_fractionDigits = 0;
+    bool m_dictionary = true;
+    size_t m_size = 0;
+    std::vector<uint64_t> m_nullBits;
+    std::vector<size_t> m_offsets{0};
+    std::string m_chars;
+    std::vector<uint32_t> m_codes;  ///< Per-row dictionary code
+    std::vector<uint32_t> m_slots;  ///< Open-addressing index: code + 1, or 0 for an empty slot
+    std::vector<int64_t> m_ints;
+    std::vector<double> m_doubles;
+    std::vector<DateTimeValue> m_dateTimes;
+    ColumnStats m_stats;
+};
+
+struct ResultSet;
+
+/// Lightweight row accessor over a columnar ResultSet (cells are materialized as display text).
+class RowView {
+public:
+    RowView(const ResultSet& result, size_t row) noexcept : m_result(&result), m_row(row) {}
+
+    [[nodiscard]] size_t index() const noexcept { return m_row; }
+    [[nodiscard]] size_t size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] bool isNull(size_t col) const noexcept;
+    [[nodiscard]] std::string operator[](size_t col) const;
+
+private:
+    const ResultSet* m_result;
+    size_t m_row;
+};
+
+/// A LOB cell that holds only the start of its value (see ExecuteOptions::lobPreviewBytes)
+struct LobPreview {
+    size_t row = 0;
+    size_t column = 0;
+    int64_t totalBytes = -1;  ///< Full length as the server sent it (UTF-16 bytes); -1 when the driver did not say
+};
+
+/// Fetch-path diagnostics reported next to executionTimeMs.
+struct FetchStats {
+    bool bulkFetch = false;  ///< Bound row-array (block cursor) path vs per-cell SQLGetData
+    size_t rowsetSize = 0;   ///< Rows per SQLFetch call (0 = not fetched by a driver)
+    double fetchTimeMs = 0.0;
+    double rowsPerSecond = 0.0;
+};
+
+struct ResultSet {
+    std::vector<ColumnInfo> columns;
+    std::vector<ColumnData> columnData;  // One entry per column, all of equal length
+    int64_t affectedRows = 0;
+    double executionTimeMs = 0.0;
+    FetchStats fetchStats;
+    bool truncated = false;  // Fetch stopped at a row limit with more rows left on the server
+    std::vector<LobPreview> lobPreviews;  // Cells cut to a preview, in row order
+    ServerMessages messages;              // PRINT, STATISTICS IO/TIME and other informational output of the statement
+
+    [[nodiscard]] size_t rowCount() const noexcept { return columnData.empty() ? 0 : columnData.front().size(); }
+    [[nodiscard]] bool empty() const noexcept { return rowCount() == 0; }
+    [[nodiscard]] bool isNull(size_t row, size_t col) const noexcept { return columnData[col].isNull(row); }
+    [[nodiscard]] std::string cellText(size_t row, size_t col) const { return columnData[col].displayText(row); }
+    /// The preview record of a cell, or nullptr when the cell holds its whole value
+    [[nodiscard]] const LobPreview* lobPreview(size_t row, size_t col) const noexcept;
+
+    [[nodiscard]] RowView row(size_t index) const noexcept { return RowView(*this, index); }
+    [[nodiscard]] auto rows() const {
+        return std::views::iota(size_t{0}, rowCount()) | std::views::transform([this](size_t i) { return RowView(*this, i); });
+    }
+
+    /// Append a row of text cells (convenience for small synthetic results such as status messages).
+    /// Missing column storage is created as Text and padded with nulls.
+    void appendRow(std::initializer_list<std::string_view> values);
+    void appendRow(const std::vector<std::string>& values);
+
+    /// Append row `row` of another result with the same column layout.
+    void appendRowFrom(const ResultSet& source, size_t row);
+    /// Append all rows of a batch with the same column layout (column storage is created on first use) and fold
+    /// them into the column stats. Its LOB previews follow, shifted to the rows they land on.
+    void appendBatch(const ResultSet& batch);
+    /// Drop all rows and LOB previews, keeping columns, column storage types and capacity.
+    void clearRows() noexcept;
+    /// ColumnData::updateStats() of every column
+    void updateStats();
+
+    /// Bytes held, including column metadata strings that outgrew the small-string buffer
+    [[nodiscard]] size_t memoryBytes() const noexcept;
+
+private:
+    void ensureColumnStorage(size_t count);
+};
+
+inline size_t RowView::size() const noexcept {
+    return m_result->columnData.size();
+}
+
+inline bool RowView::isNull(size_t col) const noexcept {
+    return m_result->isNull(m_row, col);
+}
+
+inline std::string RowView::operator[](size_t col) const {
+    return m_result->cellText(m_row, col);
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,457 @@
+#include "schema_cache.h"
+
+#include "../utils/json_utils.h"
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <unordered_set>
+
+namespace velocitydb {
+
+namespace {
+
+/// Above this many changed tables one full read of the list is cheaper than an IN list
+constexpr size_t MAX_INCREMENTAL_TABLES = 500;
+
+constexpr auto PROBE_QUERY = "SELECT DB_NAME(), COUNT_BIG(*), CONVERT(varchar(27), MAX(modify_date), 121) FROM sys.objects WHERE is_ms_shipped = 0";
+
+constexpr auto TABLE_QUERY = R"(
+    SELECT
+        o.object_id,
+        s.name,
+        o.name,
+        CASE o.type WHEN 'U' THEN 'BASE TABLE' ELSE 'VIEW' END,
+        CAST(ep.value AS NVARCHAR(MAX))
+    FROM sys.objects o
+    INNER JOIN sys.schemas s ON o.schema_id = s.schema_id
+    LEFT JOIN sys.extended_properties ep ON ep.major_id = o.object_id
+        AND ep.minor_id = 0
+        AND ep.class = 1
+        AND ep.name = 'MS_Description'
+    WHERE o.type IN ('U', 'V') AND o.is_ms_shipped = 0)";
+
+constexpr auto ROUTINE_QUERY = R"(
+    SELECT o.object_id, s.name, o.name, RTRIM(o.type)
+    FROM sys.objects o
+    INNER JOIN sys.schemas s ON o.schema_id = s.schema_id
+    WHERE o.type IN ('P', 'FN', 'IF', 'TF') AND o.is_ms_shipped = 0)";
+
+[[nodiscard]] bool isRoutine(std::string_view type) noexcept {
+    return type == "P" || type == "FN" || type == "IF" || type == "TF";
+}
+
+/// Name index owners: a table's (or routine's) own name, and the columns and indexes it contributes
+[[nodiscard]] uint64_t objectOwner(int64_t objectId) noexcept {
+    return static_cast<uint64_t>(objectId) << 1;
+}
+[[nodiscard]] uint64_t childOwner(int64_t objectId) noexcept {
+    return (static_cast<uint64_t>(objectId) << 1) | 1;
+}
+
+void nameTable(ObjectNameIndex& names, const auto& table) {
+    std::vector<ObjectName> own;
+    own.push_back(ObjectName{.kind = table.type == "VIEW" ? ObjectKind::View : ObjectKind::Table, .schema = table.schema, .name = table.name});
+    names.replace(objectOwner(table.objectId), std::move(own));
+}
+
+/// Opens the table's JSON object; the caller closes it
+void appendTable(std::string& out, const auto& table) {
+    out += std::format(R"({{"schema":"{}","name":"{}","type":"{}","comment":"{}")", JsonUtils::escapeString(table.schema), JsonUtils::escapeString(table.name), JsonUtils::escapeString(table.type),
+                       JsonUtils::escapeString(table.comment));
+}
+
+[[nodiscard]] int64_t parseId(const std::string& text) noexcept {
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+[[nodiscard]] std::string lowerKey(std::string_view schema, std::string_view name) {
+    std::string key;
+    key.reserve(schema.size() + name.size() + 1);
+    for (char c : schema) {
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    key += '.';
+    for (char c : name) {
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+}  // namespace
+
+std::shared_ptr<SchemaCache::Entry> SchemaCache::entryFor(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver) {
+    std::lock_guard lock(m_mutex);
+    std::erase_if(m_entries, [](const auto& item) { return item.second->driver.expired(); });
+    auto& entry = m_entries[std::string(connectionId)];
+    if (!entry || entry->driver.lock() != driver) {
+        entry = std::make_shared<Entry>();
+        entry->driver = driver;
+    }
+    return entry;
+}
+
+SchemaCache::Stats SchemaCache::stats() const {
+    std::lock_guard lock(m_mutex);
+    return m_stats;
+}
+
+std::string SchemaCache::databases(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, bool refresh) {
+    auto entry = entryFor(connectionId, driver);
+    std::lock_guard lock(entry->mutex);
+    if (!entry->databases || refresh) {
+        auto result = driver->execute("SELECT name FROM sys.databases ORDER BY name");
+        std::string json = "[";
+        for (size_t row = 0; row < result.rowCount(); ++row) {
+            if (row > 0) {
+                json += ',';
+            }
+            json += std::format(R"("{}")", JsonUtils::escapeString(result.cellText(row, 0)));
+        }
+        json += ']';
+        entry->databases = std::move(json);
+    }
+    return *entry->databases;
+}
+
+std::string SchemaCache::tables(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, bool refresh) {
+    auto entry = entryFor(connectionId, driver);
+    std::lock_guard lock(entry->mutex);
+    synchronize(*entry, *driver, refresh);
+
+    std::string json = "[";
+    for (size_t i = 0; i < entry->tables.size(); ++i) {
+        if (i > 0) {
+            json += ',';
+        }
+        appendTable(json, entry->tables[i]);
+        json += '}';
+    }
+    json += ']';
+    return json;
+}
+
+std::string SchemaCache::snapshot(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, bool refresh) {
+    auto entry = entryFor(connectionId, driver);
+    std::lock_guard lock(entry->mutex);
+    synchronize(*entry, *driver, refresh);
+
+    loadMissing(*entry, *driver);
+
+    std::string json = "[";
+    for (size_t i = 0; i < entry->tables.size(); ++i) {
+        const auto& table = entry->tables[i];
+        if (i > 0) {
+            json += ',';
+        }
+        appendTable(json, table);
+        const auto& columns = entry->fragments[table.objectId][static_cast<size_t>(Fragment::Columns)];
+        json += R"(,"columns":)";
+        json += columns ? *columns : "[]";  // Created after the list was read: the next refresh picks it up
+        json += '}';
+    }
+    json += ']';
+    return json;
+}
+
+void SchemaCache::loadMissing(Entry& entry, IDatabaseDriver& driver, const std::vector<int64_t>* candidates) {
+    std::vector<int64_t> missing;
+    const auto consider = [&](int64_t objectId) {
+        // Seeding names a table; invalidating its fragments un-names it
+        if (!entry.named.contains(objectId)) {
+            missing.push_back(objectId);
+        }
+    };
+    if (candidates != nullptr) {
+        std::ranges::for_each(*candidates, consider);
+    } else {
+        std::ranges::for_each(entry.tables, consider, &Table::objectId);
+    }
+    if (missing.empty()) {
+        return;
+    }
+    const bool everything = missing.size() == entry.tables.size() || missing.size() > MAX_INCREMENTAL_TABLES;
+    seed(entry, SchemaSnapshot::load(driver, everything ? nullptr : &missing));
+}
+
+void SchemaCache::prefetch(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, const std::vector<std::string>& priorityNodes, const std::function<bool()>& stopRequested) {
+    (void)databases(connectionId, driver);
+    if (stopRequested()) {
+        return;
+    }
+
+    auto entry = entryFor(connectionId, driver);
+    {
+        std::lock_guard lock(entry->mutex);
+        synchronize(*entry, *driver, false);
+        std::vector<int64_t> expanded;
+        for (const auto& table : entry->tables) {
+            const auto suffix = std::format("-{}-{}", table.schema, table.name);
+            if (std::ranges::any_of(priorityNodes, [&](const std::string& node) { return node.ends_with(suffix); })) {
+                expanded.push_back(table.objectId);
+            }
+        }
+        if (!expanded.empty()) {
+            loadMissing(*entry, *driver, &expanded);
+        }
+    }
+    if (stopRequested()) {
+        return;
+    }
+
+    std::lock_guard lock(entry->mutex);
+    synchronize(*entry, *driver, false);
+    loadMissing(*entry, *driver);
+    if (!entry->routinesNamed) {
+        reloadRoutines(*entry, *driver);
+    }
+}
+
+void SchemaCache::seed(Entry& entry, const SchemaSnapshot& snapshot) {
+    for (const auto& table : snapshot.tables) {
+        auto& slots = entry.fragments[table.objectId];
+        slots[static_cast<size_t>(Fragment::Columns)] = snapshot.columnsJson(table);
+        slots[static_cast<size_t>(Fragment::Indexes)] = snapshot.indexesJson(table);
+        slots[static_cast<size_t>(Fragment::ForeignKeys)] = snapshot.foreignKeysJson(table);
+        slots[static_cast<size_t>(Fragment::ReferencingForeignKeys)] = snapshot.referencingForeignKeysJson(table);
+        slots[static_cast<size_t>(Fragment::Triggers)] = snapshot.triggersJson(table);
+
+        std::vector<ObjectName> children;
+        children.reserve(table.columns.end - table.columns.begin + table.indexes.end - table.indexes.begin);
+        for (auto i = table.columns.begin; i < table.columns.end; ++i) {
+            children.push_back(ObjectName{.kind = ObjectKind::Column, .schema = table.schema, .name = snapshot.columns[i].name, .parent = table.name});
+        }
+        for (auto i = table.indexes.begin; i < table.indexes.end; ++i) {
+            children.push_back(ObjectName{.kind = ObjectKind::Index, .schema = table.schema, .name = snapshot.indexes[i].name, .parent = table.name});
+        }
+        entry.names.replace(childOwner(table.objectId), std::move(children));
+        entry.named.insert(table.objectId);
+    }
+    std::lock_guard statsLock(m_mutex);
+    ++m_stats.bulkLoads;
+}
+
+void SchemaCache::names(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, const std::function<void(const ObjectNameIndex&)>& use) {
+    auto entry = entryFor(connectionId, driver);
+    std::lock_guard lock(entry->mutex);
+    synchronize(*entry, *driver, false);
+
+    if (!entry->routinesNamed) {
+        reloadRoutines(*entry, *driver);
+    }
+    loadMissing(*entry, *driver);
+    use(entry->names);
+}
+
+void SchemaCache::reloadRoutines(Entry& entry, IDatabaseDriver& driver) {
+    auto result = driver.execute(ROUTINE_QUERY);
+    for (const auto objectId : entry.routines) {
+        entry.names.remove(objectOwner(objectId));
+    }
+    entry.routines.clear();
+    entry.routines.reserve(result.rowCount());
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        const auto objectId = parseId(result.cellText(row, 0));
+        std::vector<ObjectName> own;
+        own.push_back(ObjectName{.kind = result.cellText(row, 3) == "P" ? ObjectKind::Procedure : ObjectKind::Function, .schema = result.cellText(row, 1), .name = result.cellText(row, 2)});
+        entry.names.replace(objectOwner(objectId), std::move(own));
+        entry.routines.push_back(objectId);
+    }
+    entry.routinesNamed = true;
+}
+
+std::string SchemaCache::fragment(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, std::string_view table, Fragment kind, const Loader& load, bool refresh) {
+    auto entry = entryFor(connectionId, driver);
+    std::lock_guard lock(entry->mutex);
+    synchronize(*entry, *driver, refresh);
+
+    auto [schema, name] = splitSchemaTable(table);
+    auto found = entry->byName.find(lowerKey(schema, name));
+    if (found == entry->byName.end()) {
+        return load();
+    }
+    auto& slot = entry->fragments[found->second][static_cast<size_t>(kind)];
+    if (slot) {
+        std::lock_guard statsLock(m_mutex);
+        ++m_stats.hits;
+        return *slot;
+    }
+    slot = load();
+    {
+        std::lock_guard statsLock(m_mutex);
+        ++m_stats.loads;
+    }
+    return *slot;
+}
+
+void SchemaCache::synchronize(Entry& entry, IDatabaseDriver& driver, bool refresh) {
+    const auto now = std::chrono::steady_clock::now();
+    if (entry.loaded && !refresh && now - entry.lastProbe < m_probeInterval) {
+        return;
+    }
+
+    auto probe = driver.execute(PROBE_QUERY);
+    entry.lastProbe = now;
+    std::string database = probe.rowCount() > 0 ? probe.cellText(0, 0) : std::string{};
+    std::string objectCount = probe.rowCount() > 0 ? probe.cellText(0, 1) : std::string{};
+    std::string lastModified = probe.rowCount() > 0 ? probe.cellText(0, 2) : std::string{};
+
+    if (!entry.loaded || refresh || database != entry.database) {
+        entry.fragments.clear();
+        entry.names.clear();
+        entry.named.clear();
+        entry.routines.clear();
+        entry.routinesNamed = false;
+        reloadTables(entry, driver);
+    } else if (objectCount != entry.objectCount) {
+        // Something was created or dropped; drops leave nothing to diff, so read the list again
+        const bool dropped = parseId(objectCount) < parseId(entry.objectCount);
+        [[maybe_unused]] auto changedTables = invalidateChanged(entry, driver);
+        reloadTables(entry, driver);
+        entry.routinesNamed = false;
+        if (dropped) {
+            // A dropped trigger does not touch its table's modify_date
+            for (auto& [objectId, slots] : entry.fragments) {
+                slots[static_cast<size_t>(Fragment::Triggers)].reset();
+            }
+        }
+    } else if (lastModified != entry.lastModified) {
+        if (auto changedTables = invalidateChanged(entry, driver); changedTables.size() > MAX_INCREMENTAL_TABLES) {
+            reloadTables(entry, driver);
+        } else if (!changedTables.empty()) {
+            refreshTables(entry, driver, changedTables);
+        }
+    }
+
+    entry.loaded = true;
+    entry.database = std::move(database);
+    entry.objectCount = std::move(objectCount);
+    entry.lastModified = std::move(lastModified);
+}
+
+void SchemaCache::reloadTables(Entry& entry, IDatabaseDriver& driver) {
+    auto result = driver.execute(TABLE_QUERY);
+    const auto previous = std::move(entry.tables);
+    entry.tables.clear();
+    entry.tables.reserve(result.rowCount());
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        entry.tables.push_back(Table{.objectId = parseId(result.cellText(row, 0)),
+                                     .schema = result.cellText(row, 1),
+                                     .name = result.cellText(row, 2),
+                                     .type = result.cellText(row, 3),
+                                     .comment = result.cellText(row, 4)});
+    }
+    indexTables(entry);
+
+    // Fragments of tables that vanished
+    std::unordered_set<int64_t> present;
+    present.reserve(entry.tables.size());
+    for (const auto& table : entry.tables) {
+        present.insert(table.objectId);
+        nameTable(entry.names, table);
+    }
+    std::erase_if(entry.fragments, [&](const auto& item) { return !present.contains(item.first); });
+    for (const auto& table : previous) {
+        if (!present.contains(table.objectId)) {
+            entry.names.remove(objectOwner(table.objectId));
+            entry.names.remove(childOwner(table.objectId));
+            entry.named.erase(table.objectId);
+        }
+    }
+    std::lock_guard statsLock(m_mutex);
+    ++m_stats.fullReloads;
+}
+
+std::vector<int64_t> SchemaCache::invalidateChanged(Entry& entry, IDatabaseDriver& driver) {
+    if (entry.lastModified.empty()) {
+        // There were no objects to compare against
+        entry.fragments.clear();
+        entry.named.clear();
+        entry.routinesNamed = false;
+        return {};
+    }
+    // >= rather than >: objects modified within the same tick as the last probe are read again
+    auto changes = driver.execute(std::format(R"(
+        SELECT o.object_id, RTRIM(o.type), o.parent_object_id, ISNULL(fk.referenced_object_id, 0)
+        FROM sys.objects o
+        LEFT JOIN sys.foreign_keys fk ON fk.object_id = o.object_id
+        WHERE o.is_ms_shipped = 0 AND o.modify_date >= CONVERT(datetime2, '{}', 121))",
+                                              escapeSqlString(entry.lastModified)));
+
+    std::vector<int64_t> changedTables;
+    for (size_t row = 0; row < changes.rowCount(); ++row) {
+        const auto objectId = parseId(changes.cellText(row, 0));
+        const auto type = changes.cellText(row, 1);
+        if (type == "U" || type == "V") {
+            entry.fragments.erase(objectId);
+            entry.named.erase(objectId);
+            changedTables.push_back(objectId);
+            continue;
+        }
+        if (isRoutine(type)) {
+            entry.routinesNamed = false;
+            continue;
+        }
+        // Triggers, constraints and keys belong to their parent; a foreign key also changes what references its target
+        for (const auto related : {parseId(changes.cellText(row, 2)), parseId(changes.cellText(row, 3))}) {
+            if (related != 0) {
+                entry.fragments.erase(related);
+                entry.named.erase(related);
+            }
+        }
+    }
+    {
+        std::lock_guard statsLock(m_mutex);
+        m_stats.objectsRefreshed += changes.rowCount();
+    }
+    return changedTables;
+}
+
+void SchemaCache::refreshTables(Entry& entry, IDatabaseDriver& driver, const std::vector<int64_t>& changedTables) {
+    std::string ids;
+    for (const auto objectId : changedTables) {
+        if (!ids.empty()) {
+            ids += ',';
+        }
+        ids += std::to_string(objectId);
+    }
+    auto result = driver.execute(std::format("{} AND o.object_id IN ({})", TABLE_QUERY, ids));
+    std::unordered_set<int64_t> changed(changedTables.begin(), changedTables.end());
+    std::erase_if(entry.tables, [&](const Table& table) { return changed.contains(table.objectId); });
+    for (const auto objectId : changedTables) {
+        entry.names.remove(objectOwner(objectId));
+    }
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        entry.tables.push_back(Table{.objectId = parseId(result.cellText(row, 0)),
+                                     .schema = result.cellText(row, 1),
+                                     .name = result.cellText(row, 2),
+                                     .type = result.cellText(row, 3),
+                                     .comment = result.cellText(row, 4)});
+        nameTable(entry.names, entry.tables.back());
+    }
+    indexTables(entry);
+}
+
+void SchemaCache::indexTables(Entry& entry) {
+    // Case-insensitive, like the default server collations the tree used to be ordered by
+    constexpr auto lessIgnoreCase = [](std::string_view a, std::string_view b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](unsigned char x, unsigned char y) { return std::tolower(x) < std::tolower(y); });
+    };
+    std::ranges::sort(entry.tables, [&](const Table& a, const Table& b) {
+        if (lessIgnoreCase(a.schema, b.schema) || lessIgnoreCase(b.schema, a.schema)) {
+            return lessIgnoreCase(a.schema, b.schema);
+        }
+        return lessIgnoreCase(a.name, b.name);
+    });
+    entry.byName.clear();
+    entry.byName.reserve(entry.tables.size());
+    for (const auto& table : entry.tables) {
+        entry.byName.emplace(lowerKey(table.schema, table.name), table.objectId);
+    }
+}
+
+}  // namespace velocitydb
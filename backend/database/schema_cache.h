@@ -0,0 +1,138 @@
+#pragma once
+
+#include "../utils/object_name_index.h"
+#include "driver_interface.h"
+#include "schema_snapshot.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace velocitydb {
+
+/// Per-connection cache of the object tree's metadata (fragment introspection).
+///
+/// The table list is loaded in one query; per-table fragments (columns, indexes, ...) are kept as the JSON payloads
+/// the schema handlers return. Before answering, the cache probes `sys.objects` (object count and newest
+/// modify_date, at most once per probe interval). When that moved, only the objects modified since the last probe
+/// are re-read: their tables' fragments are invalidated (a changed trigger or constraint invalidates its parent, a
+/// changed foreign key also the table it references) and their rows in the table list replaced. Drops, which leave
+/// no modify_date behind, reload the table list. Comments (extended properties) do not touch modify_date; callers
+/// pass `refresh` to reload everything. An entry lives as long as the metadata driver it was read through.
+///
+/// Each entry also keeps an ObjectNameIndex of its tables, views, procedures and functions, plus the columns and
+/// indexes of every table a SchemaSnapshot covered, updated table by table as the cache learns about changes.
+class SchemaCache {
+public:
+    enum class Fragment : uint8_t { Columns, Indexes, Constraints, ForeignKeys, ReferencingForeignKeys, Triggers, DDL };
+    static constexpr size_t FRAGMENT_KINDS = 7;
+
+    /// Builds the JSON payload of one fragment with the caller's own query
+    using Loader = std::function<std::string()>;
+
+    static constexpr std::chrono::milliseconds PROBE_INTERVAL{1000};
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t loads = 0;           ///< Fragments built by a Loader
+        uint64_t fullReloads = 0;     ///< Table list read in full
+        uint64_t objectsRefreshed = 0;  ///< Changed objects picked up incrementally
+        uint64_t bulkLoads = 0;       ///< SchemaSnapshot batches that seeded fragments
+    };
+
+    /// @param probeInterval Minimum time between two sys.objects probes of one connection
+    explicit SchemaCache(std::chrono::milliseconds probeInterval = PROBE_INTERVAL) noexcept : m_probeInterval(probeInterval) {}
+    ~SchemaCache() = default;
+
+    SchemaCache(const SchemaCache&) = delete;
+    SchemaCache& operator=(const SchemaCache&) = delete;
+    SchemaCache(SchemaCache&&) = delete;
+    SchemaCache& operator=(SchemaCache&&) = delete;
+
+    /// JSON array of the server's database names (sys.databases changes are not probed; pass `refresh`)
+    [[nodiscard]] std::string databases(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, bool refresh = false);
+
+    /// JSON array of the connection's tables and views: {"schema","name","type","comment"}
+    [[nodiscard]] std::string tables(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, bool refresh = false);
+
+    /// Cached `kind` payload of `table` ("schema.table" or "table" for dbo); `load` runs only when it is missing or
+    /// the table changed. Tables the list does not know (e.g. created a moment ago on another session) bypass the cache.
+    [[nodiscard]] std::string fragment(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, std::string_view table, Fragment kind, const Loader& load, bool refresh = false);
+
+    /// JSON array of the tables with their columns ({"schema","name","type","comment","columns":[...]}) for the tree and
+    /// autocomplete. Tables without cached columns are read in one SchemaSnapshot batch, which also seeds their
+    /// indexes, foreign keys and triggers
+    [[nodiscard]] std::string snapshot(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, bool refresh = false);
+
+    /// Warm everything a fresh connection is about to ask for: databases, the current database's tables, then the
+    /// columns, indexes, keys and triggers of the tables behind `priorityNodes` (tree node ids ending in
+    /// "-schema-name"), then those of every other table and the routine names. The entry is unlocked between steps
+    /// so interactive requests interleave; `stopRequested` is polled there too
+    void prefetch(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, const std::vector<std::string>& priorityNodes, const std::function<bool()>& stopRequested);
+
+    /// Run `use` on the connection's name index, with the entry locked. Tables whose columns and indexes are not
+    /// indexed yet are read in one SchemaSnapshot batch first; later calls answer from memory until something changes
+    void names(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver, const std::function<void(const ObjectNameIndex&)>& use);
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Table {
+        int64_t objectId = 0;
+        std::string schema;
+        std::string name;
+        std::string type;
+        std::string comment;
+    };
+
+    struct Entry {
+        std::mutex mutex;  // held across the metadata queries of one request
+        std::weak_ptr<IDatabaseDriver> driver;  ///< Metadata driver the entry describes; the entry dies with it
+        bool loaded = false;
+        std::string database;
+        std::string objectCount;
+        std::string lastModified;  ///< Newest sys.objects.modify_date seen, as CONVERT(..., 121) text
+        std::chrono::steady_clock::time_point lastProbe{};
+        std::vector<Table> tables;                         ///< Ordered by schema, name
+        std::unordered_map<std::string, int64_t> byName;   ///< Lower-cased "schema.name"
+        std::unordered_map<int64_t, std::array<std::optional<std::string>, FRAGMENT_KINDS>> fragments;
+        std::optional<std::string> databases;
+        ObjectNameIndex names;
+        std::unordered_set<int64_t> named;  ///< Tables whose columns and indexes `names` holds
+        std::vector<int64_t> routines;      ///< Procedures and functions in `names`
+        bool routinesNamed = false;
+    };
+
+    /// The connection's entry, fresh when `driver` is not the one it was built from; sweeps entries of closed connections
+    [[nodiscard]] std::shared_ptr<Entry> entryFor(std::string_view connectionId, const std::shared_ptr<IDatabaseDriver>& driver);
+    /// Bring `entry` up to date with the server (entry mutex held)
+    void synchronize(Entry& entry, IDatabaseDriver& driver, bool refresh);
+    void reloadTables(Entry& entry, IDatabaseDriver& driver);
+    /// Drop the fragments of tables touched since the last probe; returns the tables and views that changed themselves
+    [[nodiscard]] std::vector<int64_t> invalidateChanged(Entry& entry, IDatabaseDriver& driver);
+    /// Re-read the table list rows of `changedTables`
+    void refreshTables(Entry& entry, IDatabaseDriver& driver, const std::vector<int64_t>& changedTables);
+    static void indexTables(Entry& entry);
+    /// Store the fragments `snapshot` covers (everything but constraints and DDL)
+    void seed(Entry& entry, const SchemaSnapshot& snapshot);
+    /// Re-read the procedure and function names
+    static void reloadRoutines(Entry& entry, IDatabaseDriver& driver);
+    /// Bulk-load the listed tables (all tables when null) that were not seeded from a snapshot yet
+    void loadMissing(Entry& entry, IDatabaseDriver& driver, const std::vector<int64_t>* candidates = nullptr);
+
+    const std::chrono::milliseconds m_probeInterval;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> m_entries;
+    Stats m_stats;  // guarded by m_mutex
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,543 @@
+#include "schema_diff.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <format>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace velocitydb {
+
+namespace {
+
+using Kind = SchemaChange::Kind;
+using Table = SchemaSnapshot::Table;
+using Column = SchemaSnapshot::Column;
+using Index = SchemaSnapshot::Index;
+using ForeignKey = SchemaSnapshot::ForeignKey;
+
+constexpr size_t KIND_COUNT = static_cast<size_t>(Kind::DisableTrigger) + 1;
+
+[[nodiscard]] std::string lowerKey(std::string_view text) {
+    std::string key(text);
+    std::ranges::transform(key, key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return key;
+}
+
+[[nodiscard]] bool sameName(std::string_view a, std::string_view b) noexcept {
+    return std::ranges::equal(a, b, [](unsigned char x, unsigned char y) { return std::tolower(x) == std::tolower(y); });
+}
+
+[[nodiscard]] bool isBaseTable(const Table& table) noexcept {
+    return table.type == "BASE TABLE";
+}
+
+[[nodiscard]] std::string tableKey(const Table& table) {
+    return lowerKey(std::format("{}.{}", table.schema, table.name));
+}
+
+[[nodiscard]] std::string displayName(const Table& table) {
+    return std::format("{}.{}", table.schema, table.name);
+}
+
+[[nodiscard]] std::string qualify(const Table& table) {
+    return std::format("{}.{}", detail::quoteSinglePart(table.schema), detail::quoteSinglePart(table.name));
+}
+
+[[nodiscard]] std::span<const Column> columnsOf(const SchemaSnapshot& snapshot, const Table& table) {
+    return std::span(snapshot.columns).subspan(table.columns.begin, table.columns.end - table.columns.begin);
+}
+
+[[nodiscard]] std::span<const Index> indexesOf(const SchemaSnapshot& snapshot, const Table& table) {
+    return std::span(snapshot.indexes).subspan(table.indexes.begin, table.indexes.end - table.indexes.begin);
+}
+
+[[nodiscard]] std::span<const std::string> keyColumnsOf(const SchemaSnapshot& snapshot, const Index& index) {
+    return std::span(snapshot.indexColumns).subspan(index.columns.begin, index.columns.end - index.columns.begin);
+}
+
+[[nodiscard]] std::span<const SchemaSnapshot::ForeignKeyColumn> keyColumnsOf(const SchemaSnapshot& snapshot, const ForeignKey& key) {
+    return std::span(snapshot.foreignKeyColumns).subspan(key.columns.begin, key.columns.end - key.columns.begin);
+}
+
+[[nodiscard]] std::string columnDefinition(const Column& column) {
+    return std::format("{} {} {}", detail::quoteSinglePart(column.name), SchemaSnapshot::declaredType(column), column.nullable ? "NULL" : "NOT NULL");
+}
+
+[[nodiscard]] std::string quotedList(auto&& names) {
+    std::string out;
+    for (const auto& name : names) {
+        if (!out.empty()) {
+            out += ", ";
+        }
+        out += detail::quoteSinglePart(name);
+    }
+    return out;
+}
+
+[[nodiscard]] std::string primaryKeyClause(const SchemaSnapshot& snapshot, const Index& index) {
+    const auto clustered = sameName(index.type, "NONCLUSTERED") ? "NONCLUSTERED" : "CLUSTERED";
+    return std::format("CONSTRAINT {} PRIMARY KEY {} ({})", detail::quoteSinglePart(index.name), clustered, quotedList(keyColumnsOf(snapshot, index)));
+}
+
+/// CREATE INDEX for the index kinds a name and key columns describe; others are left as a comment
+[[nodiscard]] std::string createIndexSql(const SchemaSnapshot& snapshot, const Table& table, const Index& index) {
+    const auto name = detail::quoteSinglePart(index.name);
+    const auto type = lowerKey(index.type);
+    if (type == "clustered" || type == "nonclustered") {
+        return std::format("CREATE {}{} INDEX {} ON {} ({});", index.isUnique ? "UNIQUE " : "", index.type, name, qualify(table), quotedList(keyColumnsOf(snapshot, index)));
+    }
+    if (type == "clustered columnstore") {
+        return std::format("CREATE CLUSTERED COLUMNSTORE INDEX {} ON {};", name, qualify(table));
+    }
+    if (type == "nonclustered columnstore") {
+        return std::format("CREATE NONCLUSTERED COLUMNSTORE INDEX {} ON {} ({});", name, qualify(table), quotedList(keyColumnsOf(snapshot, index)));
+    }
+    return std::format("-- {} index {} on {} must be scripted by hand", index.type, name, qualify(table));
+}
+
+[[nodiscard]] std::string createTableSql(const SchemaSnapshot& snapshot, const Table& table) {
+    std::string sql = std::format("CREATE TABLE {} (", qualify(table));
+    bool first = true;
+    for (const auto& column : columnsOf(snapshot, table)) {
+        sql += first ? "\n    " : ",\n    ";
+        sql += columnDefinition(column);
+        first = false;
+    }
+    for (const auto& index : indexesOf(snapshot, table)) {
+        if (index.isPrimaryKey) {
+            sql += std::format(",\n    {}", primaryKeyClause(snapshot, index));
+        }
+    }
+    sql += "\n);";
+    return sql;
+}
+
+[[nodiscard]] std::string addForeignKeySql(const SchemaSnapshot& snapshot, const ForeignKey& key) {
+    const auto columns = keyColumnsOf(snapshot, key);
+    auto sql = std::format("ALTER TABLE {} ADD CONSTRAINT {} FOREIGN KEY ({}) REFERENCES {} ({})", quoteBracketIdentifier(key.table), detail::quoteSinglePart(key.name),
+                           quotedList(columns | std::views::transform(&SchemaSnapshot::ForeignKeyColumn::column)), quoteBracketIdentifier(key.referencedTable),
+                           quotedList(columns | std::views::transform(&SchemaSnapshot::ForeignKeyColumn::referencedColumn)));
+    if (!key.onDelete.empty() && !sameName(key.onDelete, "NO_ACTION")) {
+        sql += " ON DELETE " + SchemaSnapshot::referentialAction(key.onDelete);
+    }
+    if (!key.onUpdate.empty() && !sameName(key.onUpdate, "NO_ACTION")) {
+        sql += " ON UPDATE " + SchemaSnapshot::referentialAction(key.onUpdate);
+    }
+    sql += ';';
+    return sql;
+}
+
+[[nodiscard]] bool sameIndex(const SchemaSnapshot& left, const Index& a, const SchemaSnapshot& right, const Index& b) {
+    return sameName(a.type, b.type) && a.isUnique == b.isUnique && std::ranges::equal(keyColumnsOf(left, a), keyColumnsOf(right, b), sameName);
+}
+
+[[nodiscard]] bool sameForeignKey(const SchemaSnapshot& left, const ForeignKey& a, const SchemaSnapshot& right, const ForeignKey& b) {
+    return sameName(a.referencedTable, b.referencedTable) && sameName(a.onDelete, b.onDelete) && sameName(a.onUpdate, b.onUpdate) &&
+           std::ranges::equal(keyColumnsOf(left, a), keyColumnsOf(right, b),
+                              [](const auto& x, const auto& y) { return sameName(x.column, y.column) && sameName(x.referencedColumn, y.referencedColumn); });
+}
+
+[[nodiscard]] std::string_view trimmed(std::string_view text) noexcept {
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+[[nodiscard]] std::unordered_map<std::string, const Table*> baseTables(const SchemaSnapshot& snapshot) {
+    std::unordered_map<std::string, const Table*> tables;
+    tables.reserve(snapshot.tables.size());
+    for (const auto& table : snapshot.tables) {
+        if (isBaseTable(table)) {
+            tables.emplace(tableKey(table), &table);
+        }
+    }
+    return tables;
+}
+
+/// What happened to a table that its dependents (indexes, foreign keys) must follow
+struct TableDelta {
+    bool replaced = false;                              ///< Created or dropped as a whole
+    std::unordered_set<std::string> changedColumns;     ///< Lowercased; altered or dropped
+    std::unordered_set<std::string> rebuiltKeyColumns;  ///< Lowercased columns of a dropped primary key or unique index
+};
+
+class SchemaDiffer {
+public:
+    SchemaDiffer(const SchemaSnapshot& current, const SchemaSnapshot& desired, const SchemaDiffOptions& options)
+        : m_current(current), m_desired(desired), m_options(options), m_currentTables(baseTables(current)), m_desiredTables(baseTables(desired)) {}
+
+    std::vector<SchemaChange> run() {
+        for (const auto& table : m_current.tables) {
+            if (isBaseTable(table) && m_options.drops && !m_desiredTables.contains(tableKey(table))) {
+                m_deltas[tableKey(table)].replaced = true;
+                add(Kind::DropTable, displayName(table), std::format("DROP TABLE {};", qualify(table)));
+            }
+        }
+        for (const auto& table : m_desired.tables) {
+            if (!isBaseTable(table)) {
+                continue;
+            }
+            auto& delta = m_deltas[tableKey(table)];
+            auto found = m_currentTables.find(tableKey(table));
+            if (found == m_currentTables.end()) {
+                delta.replaced = true;
+                add(Kind::CreateTable, displayName(table), createTableSql(m_desired, table));
+                for (const auto& index : indexesOf(m_desired, table)) {
+                    if (!index.isPrimaryKey) {
+                        createIndex(table, index);
+                    }
+                }
+                continue;
+            }
+            diffColumns(*found->second, table, delta);
+            diffIndexes(*found->second, table, delta);
+        }
+        diffForeignKeys();
+        if (m_options.triggers) {
+            diffTriggers();
+        }
+
+        std::vector<SchemaChange> changes;
+        for (auto& phase : m_phases) {
+            std::ranges::move(phase, std::back_inserter(changes));
+        }
+        return changes;
+    }
+
+private:
+    void add(Kind kind, std::string object, std::string sql) { m_phases[static_cast<size_t>(kind)].push_back(SchemaChange{.kind = kind, .object = std::move(object), .sql = std::move(sql)}); }
+
+    void diffColumns(const Table& current, const Table& desired, TableDelta& delta) {
+        std::unordered_map<std::string, const Column*> desiredColumns;
+        for (const auto& column : columnsOf(m_desired, desired)) {
+            desiredColumns.emplace(lowerKey(column.name), &column);
+        }
+        std::unordered_set<std::string> currentNames;
+        for (const auto& column : columnsOf(m_current, current)) {
+            auto key = lowerKey(column.name);
+            auto found = desiredColumns.find(key);
+            const auto object = std::format("{}.{}", displayName(current), column.name);
+            if (found == desiredColumns.end()) {
+                if (m_options.drops) {
+                    add(Kind::DropColumn, object, std::format("ALTER TABLE {} DROP COLUMN {};", qualify(current), detail::quoteSinglePart(column.name)));
+                    delta.changedColumns.insert(key);
+                }
+            } else if (SchemaSnapshot::declaredType(column) != SchemaSnapshot::declaredType(*found->second) || column.nullable != found->second->nullable) {
+                add(Kind::AlterColumn, object, std::format("ALTER TABLE {} ALTER COLUMN {};", qualify(current), columnDefinition(*found->second)));
+                delta.changedColumns.insert(key);
+            }
+            currentNames.insert(std::move(key));
+        }
+        for (const auto& column : columnsOf(m_desired, desired)) {
+            if (!currentNames.contains(lowerKey(column.name))) {
+                add(Kind::AddColumn, std::format("{}.{}", displayName(current), column.name), std::format("ALTER TABLE {} ADD {};", qualify(current), columnDefinition(column)));
+            }
+        }
+    }
+
+    void diffIndexes(const Table& current, const Table& desired, TableDelta& delta) {
+        const Index* currentKey = nullptr;
+        const Index* desiredKey = nullptr;
+        std::unordered_map<std::string, const Index*> desiredIndexes;
+        for (const auto& index : indexesOf(m_desired, desired)) {
+            if (index.isPrimaryKey) {
+                desiredKey = &index;
+            } else {
+                desiredIndexes.emplace(lowerKey(index.name), &index);
+            }
+        }
+
+        const auto touched = [&](const Index& index) {
+            return std::ranges::any_of(keyColumnsOf(m_current, index), [&](const auto& column) { return delta.changedColumns.contains(lowerKey(column)); });
+        };
+        const auto drop = [&](const Index& index) {
+            const auto object = std::format("{}.{}", displayName(current), index.name);
+            if (index.isPrimaryKey) {
+                add(Kind::DropPrimaryKey, object, std::format("ALTER TABLE {} DROP CONSTRAINT {};", qualify(current), detail::quoteSinglePart(index.name)));
+            } else {
+                add(Kind::DropIndex, object, std::format("DROP INDEX {} ON {};", detail::quoteSinglePart(index.name), qualify(current)));
+            }
+            if (index.isPrimaryKey || index.isUnique) {
+                for (const auto& column : keyColumnsOf(m_current, index)) {
+                    delta.rebuiltKeyColumns.insert(lowerKey(column));
+                }
+            }
+        };
+        // Altering or dropping a key column fails while an index covers it, so touched indexes go even when unchanged
+        const auto reconcile = [&](const Index* before, const Index* after) {
+            if (before != nullptr && after != nullptr) {
+                if (sameIndex(m_current, *before, m_desired, *after) && !touched(*before)) {
+                    return;
+                }
+                drop(*before);
+            } else if (before != nullptr) {
+                if (m_options.drops || touched(*before)) {
+                    drop(*before);
+                }
+                return;
+            }
+            if (after != nullptr) {
+                createIndex(current, *after);
+            }
+        };
+
+        std::unordered_set<std::string> matched;
+        for (const auto& index : indexesOf(m_current, current)) {
+            if (index.isPrimaryKey) {
+                currentKey = &index;
+                continue;
+            }
+            auto key = lowerKey(index.name);
+            auto found = desiredIndexes.find(key);
+            reconcile(&index, found == desiredIndexes.end() ? nullptr : found->second);
+            matched.insert(std::move(key));
+        }
+        reconcile(currentKey, desiredKey);
+        for (const auto& index : indexesOf(m_desired, desired)) {
+            if (!index.isPrimaryKey && !matched.contains(lowerKey(index.name))) {
+                createIndex(current, index);
+            }
+        }
+    }
+
+    /// `table` names the target on the current side, which may differ in case from the desired side
+    void createIndex(const Table& table, const Index& index) {
+        const auto object = std::format("{}.{}", displayName(table), index.name);
+        if (index.isPrimaryKey) {
+            add(Kind::AddPrimaryKey, object, std::format("ALTER TABLE {} ADD {};", qualify(table), primaryKeyClause(m_desired, index)));
+        } else {
+            add(Kind::CreateIndex, object, createIndexSql(m_desired, table, index));
+        }
+    }
+
+    /// A foreign key must be recreated when its table was replaced, one of its columns changed, or the
+    /// primary key / unique index it references was rebuilt
+    [[nodiscard]] bool foreignKeyTouched(const ForeignKey& key) const {
+        const auto columns = keyColumnsOf(m_current, key);
+        if (auto found = m_deltas.find(lowerKey(key.table)); found != m_deltas.end()) {
+            const auto& delta = found->second;
+            if (delta.replaced || std::ranges::any_of(columns, [&](const auto& column) { return delta.changedColumns.contains(lowerKey(column.column)); })) {
+                return true;
+            }
+        }
+        if (auto found = m_deltas.find(lowerKey(key.referencedTable)); found != m_deltas.end()) {
+            const auto& delta = found->second;
+            return delta.replaced || std::ranges::any_of(columns, [&](const auto& column) {
+                       const auto name = lowerKey(column.referencedColumn);
+                       return delta.changedColumns.contains(name) || delta.rebuiltKeyColumns.contains(name);
+                   });
+        }
+        return false;
+    }
+
+    void diffForeignKeys() {
+        std::unordered_map<std::string, size_t> currentKeys;
+        for (size_t i = 0; i < m_current.foreignKeys.size(); ++i) {
+            const auto& key = m_current.foreignKeys[i];
+            currentKeys.emplace(lowerKey(std::format("{}.{}", key.table, key.name)), i);
+        }
+        std::vector<bool> handled(m_current.foreignKeys.size(), false);
+        const auto drop = [&](size_t at) {
+            const auto& key = m_current.foreignKeys[at];
+            handled[at] = true;
+            add(Kind::DropForeignKey, std::format("{}.{}", key.table, key.name),
+                std::format("ALTER TABLE {} DROP CONSTRAINT {};", quoteBracketIdentifier(key.table), detail::quoteSinglePart(key.name)));
+        };
+
+        for (const auto& key : m_desired.foreignKeys) {
+            auto found = currentKeys.find(lowerKey(std::format("{}.{}", key.table, key.name)));
+            if (found != currentKeys.end()) {
+                const auto& before = m_current.foreignKeys[found->second];
+                if (sameForeignKey(m_current, before, m_desired, key) && !foreignKeyTouched(before)) {
+                    handled[found->second] = true;
+                    continue;
+                }
+                drop(found->second);
+            }
+            add(Kind::AddForeignKey, std::format("{}.{}", key.table, key.name), addForeignKeySql(m_desired, key));
+        }
+        for (size_t i = 0; i < m_current.foreignKeys.size(); ++i) {
+            if (!handled[i] && (m_options.drops || foreignKeyTouched(m_current.foreignKeys[i]))) {
+                drop(i);
+            }
+        }
+    }
+
+    void diffTriggers() {
+        for (const auto& table : m_desired.tables) {
+            if (!isBaseTable(table)) {
+                continue;
+            }
+            auto found = m_currentTables.find(tableKey(table));
+            const Table* current = found == m_currentTables.end() ? nullptr : found->second;
+            std::unordered_map<std::string, const SchemaSnapshot::Trigger*> currentTriggers;
+            if (current != nullptr) {
+                for (const auto at : current->triggers) {
+                    currentTriggers.emplace(lowerKey(m_current.triggers[at].name), &m_current.triggers[at]);
+                }
+            }
+            const auto& target = current != nullptr ? *current : table;
+
+            for (const auto at : table.triggers) {
+                const auto& trigger = m_desired.triggers[at];
+                const auto object = std::format("{}.{}", displayName(target), trigger.name);
+                const auto qualified = std::format("{}.{}", detail::quoteSinglePart(target.schema), detail::quoteSinglePart(trigger.name));
+                auto before = currentTriggers.find(lowerKey(trigger.name));
+                if (before != currentTriggers.end()) {
+                    const auto& existing = *before->second;
+                    currentTriggers.erase(before);
+                    if (trimmed(existing.definition) == trimmed(trigger.definition)) {
+                        if (existing.isEnabled != trigger.isEnabled) {
+                            add(trigger.isEnabled ? Kind::EnableTrigger : Kind::DisableTrigger, object,
+                                std::format("{} TRIGGER {} ON {};", trigger.isEnabled ? "ENABLE" : "DISABLE", qualified, qualify(target)));
+                        }
+                        continue;
+                    }
+                    add(Kind::DropTrigger, object, std::format("DROP TRIGGER {};", qualified));
+                }
+                add(Kind::CreateTrigger, object, std::string(trimmed(trigger.definition)));
+                if (!trigger.isEnabled) {
+                    add(Kind::DisableTrigger, object, std::format("DISABLE TRIGGER {} ON {};", qualified, qualify(target)));
+                }
+            }
+            if (m_options.drops) {
+                for (const auto& [name, trigger] : currentTriggers) {
+                    add(Kind::DropTrigger, std::format("{}.{}", displayName(target), trigger->name),
+                        std::format("DROP TRIGGER {}.{};", detail::quoteSinglePart(target.schema), detail::quoteSinglePart(trigger->name)));
+                }
+            }
+        }
+    }
+
+    const SchemaSnapshot& m_current;
+    const SchemaSnapshot& m_desired;
+    const SchemaDiffOptions& m_options;
+    std::unordered_map<std::string, const Table*> m_currentTables;
+    std::unordered_map<std::string, const Table*> m_desiredTables;
+    std::unordered_map<std::string, TableDelta> m_deltas;  // By lowercased "schema.name"
+    std::array<std::vector<SchemaChange>, KIND_COUNT> m_phases;
+};
+
+}  // namespace
+
+std::string_view schemaChangeKindName(SchemaChange::Kind kind) noexcept {
+    switch (kind) {
+        case Kind::DropForeignKey:
+            return "dropForeignKey";
+        case Kind::DropTrigger:
+            return "dropTrigger";
+        case Kind::DropIndex:
+            return "dropIndex";
+        case Kind::DropPrimaryKey:
+            return "dropPrimaryKey";
+        case Kind::DropTable:
+            return "dropTable";
+        case Kind::CreateTable:
+            return "createTable";
+        case Kind::DropColumn:
+            return "dropColumn";
+        case Kind::AlterColumn:
+            return "alterColumn";
+        case Kind::AddColumn:
+            return "addColumn";
+        case Kind::AddPrimaryKey:
+            return "addPrimaryKey";
+        case Kind::CreateIndex:
+            return "createIndex";
+        case Kind::AddForeignKey:
+            return "addForeignKey";
+        case Kind::CreateTrigger:
+            return "createTrigger";
+        case Kind::EnableTrigger:
+            return "enableTrigger";
+        case Kind::DisableTrigger:
+            return "disableTrigger";
+    }
+    return "unknown";
+}
+
+std::vector<SchemaChange> diffSchemas(const SchemaSnapshot& current, const SchemaSnapshot& desired, const SchemaDiffOptions& options) {
+    return SchemaDiffer(current, desired, options).run();
+}
+
+std::string migrationScript(const std::vector<SchemaChange>& changes) {
+    std::string script;
+    for (const auto& change : changes) {
+        script += change.sql;
+        script += "\nGO\n\n";
+    }
+    return script;
+}
+
+void writeSchemaScript(const SchemaSnapshot& snapshot, const TextSink& sink, const SchemaDiffOptions& options) {
+    std::vector<const Table*> tables;
+    std::unordered_map<std::string, size_t> tableIndex;
+    for (const auto& table : snapshot.tables) {
+        if (isBaseTable(table)) {
+            tableIndex.emplace(tableKey(table), tables.size());
+            tables.push_back(&table);
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> references;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        for (const auto at : tables[i]->foreignKeys) {
+            if (auto referenced = tableIndex.find(lowerKey(snapshot.foreignKeys[at].referencedTable)); referenced != tableIndex.end()) {
+                references.emplace_back(i, referenced->second);
+            }
+        }
+    }
+    const auto order = dependencyOrder(tables.size(), references);
+
+    auto batch = [](std::string& out, std::string_view sql) {
+        out += sql;
+        out += "\nGO\n\n";
+    };
+    renderOrdered(
+        order.size(),
+        [&](size_t position, std::string& out) {
+            const auto& table = *tables[order[position]];
+            batch(out, createTableSql(snapshot, table));
+            for (const auto& index : indexesOf(snapshot, table)) {
+                if (!index.isPrimaryKey) {
+                    batch(out, createIndexSql(snapshot, table, index));
+                }
+            }
+            if (!options.triggers) {
+                return;
+            }
+            for (const auto at : table.triggers) {
+                const auto& trigger = snapshot.triggers[at];
+                batch(out, trimmed(trigger.definition));
+                if (!trigger.isEnabled) {
+                    batch(out, std::format("DISABLE TRIGGER {}.{} ON {};", detail::quoteSinglePart(table.schema), detail::quoteSinglePart(trigger.name), qualify(table)));
+                }
+            }
+        },
+        sink);
+    // Every table exists by now, so keys between tables of a cycle resolve too
+    renderOrdered(
+        order.size(),
+        [&](size_t position, std::string& out) {
+            for (const auto at : tables[order[position]]->foreignKeys) {
+                batch(out, addForeignKeySql(snapshot, snapshot.foreignKeys[at]));
+            }
+        },
+        sink);
+}
+
+std::string schemaScript(const SchemaSnapshot& snapshot, const SchemaDiffOptions& options) {
+    std::string script;
+    writeSchemaScript(snapshot, [&script](std::string_view chunk) { script += chunk; }, options);
+    return script;
+}
+
+}  // namespace velocitydb
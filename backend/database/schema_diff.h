@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../utils/ordered_render.h"
+#include "schema_snapshot.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// One DDL batch of a migration
+struct SchemaChange {
+    /// Declared in script order: everything depending on an object is dropped before it and created after it
+    enum class Kind : uint8_t {
+        DropForeignKey,
+        DropTrigger,
+        DropIndex,
+        DropPrimaryKey,
+        DropTable,
+        CreateTable,
+        DropColumn,
+        AlterColumn,
+        AddColumn,
+        AddPrimaryKey,
+        CreateIndex,
+        AddForeignKey,
+        CreateTrigger,
+        EnableTrigger,
+        DisableTrigger,
+    };
+
+    Kind kind = Kind::CreateTable;
+    std::string object;  ///< "schema.table", or "schema.table.child" for columns, keys, indexes and triggers
+    std::string sql;     ///< One batch, without GO
+};
+
+struct SchemaDiffOptions {
+    bool triggers = true;  ///< Off when one side cannot know triggers (an ER diagram)
+    bool drops = true;     ///< Off to keep objects missing from the desired side; rebuilt objects are still dropped
+};
+
+/// camelCase name of `kind` for JSON payloads
+[[nodiscard]] std::string_view schemaChangeKindName(SchemaChange::Kind kind) noexcept;
+
+/// DDL that turns the base tables of `current` into those of `desired`, ordered by Kind.
+///
+/// Tables, columns, indexes, foreign keys and triggers are matched by name, case-insensitively; primary keys
+/// are matched by role since their generated names differ between servers. A column counts as changed when its
+/// rendered type or nullability differs. Indexes and foreign keys over a changed or dropped column, and keys
+/// referencing a rebuilt primary key or unique index, are dropped and recreated around the change.
+/// Views, defaults, identity and comments are not compared.
+[[nodiscard]] std::vector<SchemaChange> diffSchemas(const SchemaSnapshot& current, const SchemaSnapshot& desired, const SchemaDiffOptions& options = {});
+
+/// The changes as one script, each batch followed by GO
+[[nodiscard]] std::string migrationScript(const std::vector<SchemaChange>& changes);
+
+/// Script creating the base tables of `snapshot` from nothing, handed to `sink` piece by piece: each table with its
+/// indexes and (unless options.triggers is off) triggers, tables after the tables they reference, then every
+/// foreign key. Batches are followed by GO like migrationScript(). Tables render in parallel for large schemas and
+/// only a bounded part of the script is held at once, so thousands of tables stream straight to a file.
+void writeSchemaScript(const SchemaSnapshot& snapshot, const TextSink& sink, const SchemaDiffOptions& options = {});
+[[nodiscard]] std::string schemaScript(const SchemaSnapshot& snapshot, const SchemaDiffOptions& options = {});
+
+}  // namespace velocitydb
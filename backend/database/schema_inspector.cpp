@@ -19,10 +19,10 @@ std::vector<std::string> SchemaInspector::getDatabases() {
     }
 
     auto result = m_driver->execute("SELECT name FROM sys.databases ORDER BY name");
-    databases.reserve(result.rows.size());
-    for (const auto& row : result.rows) {
-        if (!row.values.empty()) {
-            databases.push_back(row.values[0]);
+    databases.reserve(result.rowCount());
+    for (const auto& row : result.rows()) {
+        if (!row.empty()) {
+            databases.push_back(row[0]);
         }
     }
 
@@ -68,14 +68,14 @@ std::vector<TableInfo> SchemaInspector::getTables(std::string_view database) {
 
     velocitydb::log<LogLevel::DEBUG>("SchemaInspector::getTables: Executing SQL query"sv);
     auto result = m_driver->execute(sql);
-    velocitydb::log<LogLevel::INFO>(std::format("SchemaInspector::getTables: Query returned {} rows", result.rows.size()));
-
-    tables.reserve(result.rows.size());
-    for (const auto& row : result.rows) {
-        if (row.values.size() >= 3) {
-            std::string comment = row.values.size() >= 4 ? row.values[3] : "";
-            tables.push_back({.schema = row.values[0], .name = row.values[1], .type = row.values[2], .comment = comment});
-            velocitydb::log<LogLevel::DEBUG>(std::format("  Found: {}.{} ({}) - Comment: {}", row.values[0], row.values[1], row.values[2], comment));
+    velocitydb::log<LogLevel::INFO>(std::format("SchemaInspector::getTables: Query returned {} rows", result.rowCount()));
+
+    tables.reserve(result.rowCount());
+    for (const auto& row : result.rows()) {
+        if (row.size() >= 3) {
+            std::string comment = row.size() >= 4 ? row[3] : "";
+            tables.push_back({.schema = row[0], .name = row[1], .type = row[2], .comment = comment});
+            velocitydb::log<LogLevel::DEBUG>(std::format("  Found: {}.{} ({}) - Comment: {}", row[0], row[1], row[2], comment));
         }
     }
 
@@ -120,12 +120,12 @@ std::vector<ColumnInfo> SchemaInspector::getColumns(std::string_view table) {
                            escapeSqlString(tableName), escapeSqlString(schemaName));
 
     auto result = m_driver->execute(sql);
-    columns.reserve(result.rows.size());
-    for (const auto& row : result.rows) {
-        if (row.values.size() >= 5) {
-            std::string comment = row.values.size() >= 6 ? row.values[5] : "";
+    columns.reserve(result.rowCount());
+    for (const auto& row : result.rows()) {
+        if (row.size() >= 5) {
+            std::string comment = row.size() >= 6 ? row[5] : "";
             columns.push_back(
-                {.name = row.values[0], .type = row.values[1], .size = std::stoi(row.values[2]), .nullable = (row.values[3] == "1"), .isPrimaryKey = (row.values[4] == "1"), .comment = comment});
+                {.name = row[0], .type = row[1], .size = std::stoi(row[2]), .nullable = (row[3] == "1"), .isPrimaryKey = (row[4] == "1"), .comment = comment});
         }
     }
 
@@ -161,15 +161,15 @@ std::vector<IndexInfo> SchemaInspector::getIndexes(std::string_view table) {
     std::string currentIndex;
     IndexInfo* currentInfo = nullptr;
 
-    for (const auto& row : result.rows) {
-        if (row.values.size() >= 5) {
-            if (row.values[0] != currentIndex) {
-                indexes.push_back({.name = row.values[0], .type = row.values[1], .isUnique = (row.values[2] == "1"), .isPrimaryKey = (row.values[3] == "1")});
-                currentIndex = row.values[0];
+    for (const auto& row : result.rows()) {
+        if (row.size() >= 5) {
+            if (row[0] != currentIndex) {
+                indexes.push_back({.name = row[0], .type = row[1], .isUnique = (row[2] == "1"), .isPrimaryKey = (row[3] == "1")});
+                currentIndex = row[0];
                 currentInfo = &indexes.back();
             }
             if (currentInfo) {
-                currentInfo->columns.push_back(row.values[4]);
+                currentInfo->columns.push_back(row[4]);
             }
         }
     }
@@ -203,10 +203,10 @@ std::vector<ForeignKeyInfo> SchemaInspector::getForeignKeys(std::string_view tab
                            escapedTable);
 
     auto result = m_driver->execute(sql);
-    fks.reserve(result.rows.size());
-    for (const auto& row : result.rows) {
-        if (row.values.size() >= 4) {
-            fks.push_back({.name = row.values[0], .column = row.values[1], .referencedTable = row.values[2], .referencedColumn = row.values[3]});
+    fks.reserve(result.rowCount());
+    for (const auto& row : result.rows()) {
+        if (row.size() >= 4) {
+            fks.push_back({.name = row[0], .column = row[1], .referencedTable = row[2], .referencedColumn = row[3]});
         }
     }
 
@@ -232,10 +232,10 @@ std::vector<StoredProcedureInfo> SchemaInspector::getStoredProcedures(std::strin
     )";
 
     auto result = m_driver->execute(sql);
-    procs.reserve(result.rows.size());
-    for (const auto& row : result.rows) {
-        if (row.values.size() >= 3) {
-            procs.push_back({.schema = row.values[0], .name = row.values[1], .definition = row.values[2]});
+    procs.reserve(result.rowCount());
+    for (const auto& row : result.rows()) {
+        if (row.size() >= 3) {
+            procs.push_back({.schema = row[0], .name = row[1], .definition = row[2]});
         }
     }
 
@@ -264,10 +264,10 @@ std::vector<FunctionInfo> SchemaInspector::getFunctions(std::string_view) {
     )";
 
     auto result = m_driver->execute(sql);
-    funcs.reserve(result.rows.size());
-    for (const auto& row : result.rows) {
-        if (row.values.size() >= 4) {
-            funcs.push_back({.schema = row.values[0], .name = row.values[1], .returnType = row.values[2], .definition = row.values[3]});
+    funcs.reserve(result.rowCount());
+    for (const auto& row : result.rows()) {
+        if (row.size() >= 4) {
+            funcs.push_back({.schema = row[0], .name = row[1], .returnType = row[2], .definition = row[3]});
         }
     }
 
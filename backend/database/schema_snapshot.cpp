@@ -0,0 +1,870 @@
+#include "schema_snapshot.h"
+
+#include "../interfaces/parsers/er_model.h"
+#include "../parsers/a5er_parser.h"
+#include "../utils/json_utils.h"
+#include "../utils/lz4_codec.h"
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <map>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace velocitydb {
+
+namespace {
+
+/// Result sets of the batch, in order
+enum BatchResult : uint8_t { TABLES, COLUMNS, INDEXES, INDEX_COLUMNS, FOREIGN_KEYS, FOREIGN_KEY_COLUMNS, TRIGGERS, BATCH_RESULTS };
+
+/// `{scope}` narrows each query to the requested objects; empty for the whole database.
+/// Orders match the per-table handlers' ORDER BY clauses so the JSON payloads come out identical.
+constexpr auto BATCH_QUERY = R"(
+SET NOCOUNT ON;
+SELECT o.object_id, s.name, o.name, CASE o.type WHEN 'U' THEN 'BASE TABLE' ELSE 'VIEW' END, CAST(ep.value AS NVARCHAR(MAX))
+FROM sys.objects o
+INNER JOIN sys.schemas s ON o.schema_id = s.schema_id
+LEFT JOIN sys.extended_properties ep ON ep.major_id = o.object_id AND ep.minor_id = 0 AND ep.class = 1 AND ep.name = 'MS_Description'
+WHERE o.type IN ('U', 'V') AND o.is_ms_shipped = 0{scope}
+ORDER BY o.object_id;
+
+SELECT c.object_id, c.name, t.name, c.max_length, c.is_nullable,
+    CASE WHEN EXISTS (
+        SELECT 1 FROM sys.index_columns ic
+        INNER JOIN sys.indexes i ON ic.object_id = i.object_id AND ic.index_id = i.index_id
+        WHERE i.is_primary_key = 1 AND ic.object_id = c.object_id AND ic.column_id = c.column_id
+    ) THEN 1 ELSE 0 END,
+    CAST(ep.value AS NVARCHAR(MAX)), c.precision, c.scale
+FROM sys.columns c
+INNER JOIN sys.types t ON c.user_type_id = t.user_type_id
+INNER JOIN sys.objects o ON c.object_id = o.object_id
+LEFT JOIN sys.extended_properties ep ON ep.major_id = c.object_id AND ep.minor_id = c.column_id AND ep.class = 1 AND ep.name = 'MS_Description'
+WHERE o.type IN ('U', 'V') AND o.is_ms_shipped = 0{scope}
+ORDER BY c.object_id, c.column_id;
+
+SELECT i.object_id, i.index_id, i.name, i.type_desc, i.is_unique, i.is_primary_key
+FROM sys.indexes i
+INNER JOIN sys.objects o ON i.object_id = o.object_id
+WHERE i.name IS NOT NULL AND o.type IN ('U', 'V') AND o.is_ms_shipped = 0{scope}
+ORDER BY i.object_id, i.is_primary_key DESC, i.name;
+
+SELECT ic.object_id, ic.index_id, c.name
+FROM sys.index_columns ic
+INNER JOIN sys.columns c ON ic.object_id = c.object_id AND ic.column_id = c.column_id
+INNER JOIN sys.objects o ON ic.object_id = o.object_id
+WHERE o.type IN ('U', 'V') AND o.is_ms_shipped = 0{scope}
+ORDER BY ic.object_id, ic.index_id, ic.key_ordinal;
+
+SELECT fk.object_id, fk.parent_object_id, fk.referenced_object_id, fk.name,
+    OBJECT_SCHEMA_NAME(fk.parent_object_id) + '.' + OBJECT_NAME(fk.parent_object_id),
+    OBJECT_SCHEMA_NAME(fk.referenced_object_id) + '.' + OBJECT_NAME(fk.referenced_object_id),
+    fk.delete_referential_action_desc, fk.update_referential_action_desc
+FROM sys.foreign_keys fk
+WHERE fk.is_ms_shipped = 0{foreignKeyScope}
+ORDER BY fk.name;
+
+SELECT fkc.constraint_object_id, COL_NAME(fkc.parent_object_id, fkc.parent_column_id), COL_NAME(fkc.referenced_object_id, fkc.referenced_column_id)
+FROM sys.foreign_key_columns fkc
+INNER JOIN sys.foreign_keys fk ON fk.object_id = fkc.constraint_object_id
+WHERE fk.is_ms_shipped = 0{foreignKeyScope}
+ORDER BY fkc.constraint_object_id, fkc.constraint_column_id;
+
+SELECT t.parent_id, t.name,
+    CASE WHEN t.is_instead_of_trigger = 1 THEN 'INSTEAD OF' ELSE 'AFTER' END,
+    STUFF((
+        SELECT ',' + CASE te.type WHEN 1 THEN 'INSERT' WHEN 2 THEN 'UPDATE' WHEN 3 THEN 'DELETE' END
+        FROM sys.trigger_events te
+        WHERE te.object_id = t.object_id
+        FOR XML PATH('')
+    ), 1, 1, ''),
+    CASE WHEN t.is_disabled = 0 THEN 1 ELSE 0 END,
+    OBJECT_DEFINITION(t.object_id)
+FROM sys.triggers t
+INNER JOIN sys.objects o ON t.parent_id = o.object_id
+WHERE t.parent_class = 1 AND o.is_ms_shipped = 0{scope}
+ORDER BY t.name;
+)";
+
+[[nodiscard]] int64_t parseInt(const std::string& text) noexcept {
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+[[nodiscard]] uint64_t childKey(int64_t objectId, int64_t childId) noexcept {
+    return (static_cast<uint64_t>(objectId) << 32) | static_cast<uint32_t>(childId);
+}
+
+[[nodiscard]] uint32_t position(size_t size) {
+    if (size > UINT32_MAX) [[unlikely]] {
+        throw std::runtime_error("Schema snapshot too large");
+    }
+    return static_cast<uint32_t>(size);
+}
+
+void appendStringArray(std::string& out, auto&& values) {
+    out += '[';
+    bool first = true;
+    for (const auto& value : values) {
+        if (!first) {
+            out += ',';
+        }
+        out += std::format("\"{}\"", JsonUtils::escapeString(value));
+        first = false;
+    }
+    out += ']';
+}
+
+/// Same split as the handlers' comma-separated STUFF() columns
+void appendCsvArray(std::string& out, std::string_view csv) {
+    if (csv.empty()) {
+        out += "[]";
+        return;
+    }
+    appendStringArray(out, csv | std::views::split(',') | std::views::transform([](auto part) { return std::string_view(part.begin(), part.end()); }));
+}
+
+constexpr std::string_view SNAPSHOT_MAGIC = "VDSS";
+constexpr uint16_t SNAPSHOT_VERSION = 1;
+constexpr uint16_t SNAPSHOT_COMPRESSED = 1;
+constexpr size_t SNAPSHOT_HEADER_BYTES = 16;  // Magic, version, flags, raw bytes, stored bytes
+
+template <typename T>
+void appendLe(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void appendText(std::string& out, std::string_view text) {
+    appendLe(out, position(text.size()));
+    out.append(text);
+}
+
+void appendRange(std::string& out, SchemaSnapshot::Range range) {
+    appendLe(out, range.begin);
+    appendLe(out, range.end);
+}
+
+void appendList(std::string& out, const std::vector<uint32_t>& list) {
+    appendLe(out, position(list.size()));
+    for (const auto value : list) {
+        appendLe(out, value);
+    }
+}
+
+/// Bounds-checked reads over a serialized body; any overrun means the file is damaged
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::string_view data) noexcept : m_data(data) {}
+
+    template <typename T>
+    [[nodiscard]] T value() {
+        need(sizeof(T));
+        T result;
+        std::memcpy(&result, m_data.data() + m_at, sizeof(T));
+        m_at += sizeof(T);
+        return result;
+    }
+
+    [[nodiscard]] std::string text() {
+        const auto bytes = value<uint32_t>();
+        need(bytes);
+        std::string result(m_data.substr(m_at, bytes));
+        m_at += bytes;
+        return result;
+    }
+
+    [[nodiscard]] SchemaSnapshot::Range range() {
+        SchemaSnapshot::Range result;
+        result.begin = value<uint32_t>();
+        result.end = value<uint32_t>();
+        return result;
+    }
+
+    [[nodiscard]] std::vector<uint32_t> list() {
+        std::vector<uint32_t> result(count(sizeof(uint32_t)));
+        for (auto& item : result) {
+            item = value<uint32_t>();
+        }
+        return result;
+    }
+
+    /// An element count, checked against what is left so a damaged count cannot reserve gigabytes
+    [[nodiscard]] size_t count(size_t minBytesEach) {
+        const auto items = value<uint32_t>();
+        if (items > (m_data.size() - m_at) / minBytesEach) [[unlikely]] {
+            damaged();
+        }
+        return items;
+    }
+
+    [[nodiscard]] bool atEnd() const noexcept { return m_at == m_data.size(); }
+
+    [[noreturn]] static void damaged() { throw std::runtime_error("Schema snapshot file is damaged"); }
+
+private:
+    void need(size_t bytes) const {
+        if (m_data.size() - m_at < bytes) [[unlikely]] {
+            damaged();
+        }
+    }
+
+    std::string_view m_data;
+    size_t m_at = 0;
+};
+
+void checkRange(SchemaSnapshot::Range range, size_t size) {
+    if (range.begin > range.end || range.end > size) [[unlikely]] {
+        SnapshotReader::damaged();
+    }
+}
+
+void checkList(const std::vector<uint32_t>& list, size_t size) {
+    if (std::ranges::any_of(list, [size](uint32_t at) { return at >= size; })) [[unlikely]] {
+        SnapshotReader::damaged();
+    }
+}
+
+[[nodiscard]] std::string lowerKey(std::string_view text) {
+    std::string key(text);
+    std::ranges::transform(key, key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return key;
+}
+
+/// Fill type, size, precision and scale from a declared type such as NVARCHAR(50), DECIMAL(10,2) or DATETIME2
+void applyDeclaredType(SchemaSnapshot::Column& column, std::string_view declared) {
+    const auto open = declared.find('(');
+    column.type = lowerKey(declared.substr(0, open));
+    std::vector<std::string_view> arguments;
+    if (open != std::string_view::npos) {
+        auto inner = declared.substr(open + 1);
+        inner = inner.substr(0, inner.find(')'));
+        for (auto part : inner | std::views::split(',')) {
+            auto argument = std::string_view(part.begin(), part.end());
+            while (!argument.empty() && argument.front() == ' ') {
+                argument.remove_prefix(1);
+            }
+            arguments.push_back(argument);
+        }
+    }
+    const auto number = [&](size_t at, int32_t fallback) {
+        int32_t value = fallback;
+        if (at < arguments.size()) {
+            std::from_chars(arguments[at].data(), arguments[at].data() + arguments[at].size(), value);
+        }
+        return value;
+    };
+    const bool isMax = !arguments.empty() && lowerKey(arguments[0]) == "max";
+
+    const auto& type = column.type;
+    if (type == "nvarchar" || type == "nchar") {
+        column.size = isMax ? -1 : number(0, 1) * 2;
+    } else if (type == "varchar" || type == "char" || type == "varbinary" || type == "binary") {
+        column.size = isMax ? -1 : number(0, 1);
+    } else if (type == "decimal" || type == "numeric") {
+        column.precision = number(0, 18);
+        column.scale = number(1, 0);
+    } else if (type == "datetime2" || type == "time" || type == "datetimeoffset") {
+        column.scale = number(0, 7);
+    }
+}
+
+}  // namespace
+
+SchemaSnapshot SchemaSnapshot::load(IDatabaseDriver& driver, const std::vector<int64_t>* objectIds) {
+    std::string scope;
+    std::string foreignKeyScope;
+    if (objectIds != nullptr) {
+        std::string ids = objectIds->empty() ? "0" : "";
+        for (const auto objectId : *objectIds) {
+            if (!ids.empty()) {
+                ids += ',';
+            }
+            ids += std::to_string(objectId);
+        }
+        scope = std::format(" AND o.object_id IN ({})", ids);
+        foreignKeyScope = std::format(" AND (fk.parent_object_id IN ({0}) OR fk.referenced_object_id IN ({0}))", ids);
+    }
+    std::string sql = BATCH_QUERY;
+    for (const auto& [placeholder, value] : {std::pair<std::string_view, std::string_view>{"{scope}", scope}, {"{foreignKeyScope}", foreignKeyScope}}) {
+        for (auto at = sql.find(placeholder); at != std::string::npos; at = sql.find(placeholder, at + value.size())) {
+            sql.replace(at, placeholder.size(), value);
+        }
+    }
+
+    auto results = driver.executeMultiple(sql);
+    if (results.size() != BATCH_RESULTS) [[unlikely]] {
+        throw std::runtime_error(std::format("Schema introspection returned {} result sets, expected {}", results.size(), static_cast<int>(BATCH_RESULTS)));
+    }
+
+    SchemaSnapshot snapshot;
+    std::unordered_map<int64_t, uint32_t> tableAt;
+
+    const auto& tables = results[TABLES];
+    snapshot.tables.reserve(tables.rowCount());
+    tableAt.reserve(tables.rowCount());
+    for (size_t row = 0; row < tables.rowCount(); ++row) {
+        const auto objectId = parseInt(tables.cellText(row, 0));
+        tableAt.emplace(objectId, position(snapshot.tables.size()));
+        snapshot.tables.push_back(Table{.objectId = objectId, .schema = tables.cellText(row, 1), .name = tables.cellText(row, 2), .type = tables.cellText(row, 3), .comment = tables.cellText(row, 4)});
+    }
+    const auto tableOf = [&](int64_t objectId) -> Table* {
+        auto found = tableAt.find(objectId);
+        return found == tableAt.end() ? nullptr : &snapshot.tables[found->second];
+    };
+
+    // Children arrive grouped by object_id; each group becomes its table's range
+    const auto& columns = results[COLUMNS];
+    snapshot.columns.reserve(columns.rowCount());
+    for (size_t row = 0; row < columns.rowCount(); ++row) {
+        auto* table = tableOf(parseInt(columns.cellText(row, 0)));
+        if (table == nullptr) {
+            continue;
+        }
+        const auto at = position(snapshot.columns.size());
+        if (table->columns.begin == table->columns.end) {
+            table->columns.begin = at;
+        }
+        table->columns.end = at + 1;
+        snapshot.columns.push_back(Column{.name = columns.cellText(row, 1), .type = columns.cellText(row, 2), .comment = columns.cellText(row, 6),
+                                          .size = static_cast<int32_t>(parseInt(columns.cellText(row, 3))), .precision = static_cast<int32_t>(parseInt(columns.cellText(row, 7))),
+                                          .scale = static_cast<int32_t>(parseInt(columns.cellText(row, 8))), .nullable = columns.cellText(row, 4) == "1",
+                                          .isPrimaryKey = columns.cellText(row, 5) == "1"});
+    }
+
+    const auto& indexColumns = results[INDEX_COLUMNS];
+    std::unordered_map<uint64_t, Range> indexColumnRanges;
+    snapshot.indexColumns.reserve(indexColumns.rowCount());
+    for (size_t row = 0; row < indexColumns.rowCount(); ++row) {
+        auto& range = indexColumnRanges[childKey(parseInt(indexColumns.cellText(row, 0)), parseInt(indexColumns.cellText(row, 1)))];
+        const auto at = position(snapshot.indexColumns.size());
+        if (range.begin == range.end) {
+            range.begin = at;
+        }
+        range.end = at + 1;
+        snapshot.indexColumns.push_back(indexColumns.cellText(row, 2));
+    }
+
+    const auto& indexes = results[INDEXES];
+    snapshot.indexes.reserve(indexes.rowCount());
+    for (size_t row = 0; row < indexes.rowCount(); ++row) {
+        const auto objectId = parseInt(indexes.cellText(row, 0));
+        auto* table = tableOf(objectId);
+        if (table == nullptr) {
+            continue;
+        }
+        const auto at = position(snapshot.indexes.size());
+        if (table->indexes.begin == table->indexes.end) {
+            table->indexes.begin = at;
+        }
+        table->indexes.end = at + 1;
+        auto range = indexColumnRanges.find(childKey(objectId, parseInt(indexes.cellText(row, 1))));
+        snapshot.indexes.push_back(Index{.name = indexes.cellText(row, 2), .type = indexes.cellText(row, 3), .columns = range == indexColumnRanges.end() ? Range{} : range->second,
+                                         .isUnique = indexes.cellText(row, 4) == "1", .isPrimaryKey = indexes.cellText(row, 5) == "1"});
+    }
+
+    const auto& keyColumns = results[FOREIGN_KEY_COLUMNS];
+    std::unordered_map<int64_t, Range> keyColumnRanges;
+    snapshot.foreignKeyColumns.reserve(keyColumns.rowCount());
+    for (size_t row = 0; row < keyColumns.rowCount(); ++row) {
+        auto& range = keyColumnRanges[parseInt(keyColumns.cellText(row, 0))];
+        const auto at = position(snapshot.foreignKeyColumns.size());
+        if (range.begin == range.end) {
+            range.begin = at;
+        }
+        range.end = at + 1;
+        snapshot.foreignKeyColumns.push_back(ForeignKeyColumn{.column = keyColumns.cellText(row, 1), .referencedColumn = keyColumns.cellText(row, 2)});
+    }
+
+    const auto& keys = results[FOREIGN_KEYS];
+    snapshot.foreignKeys.reserve(keys.rowCount());
+    for (size_t row = 0; row < keys.rowCount(); ++row) {
+        const auto at = position(snapshot.foreignKeys.size());
+        auto range = keyColumnRanges.find(parseInt(keys.cellText(row, 0)));
+        snapshot.foreignKeys.push_back(ForeignKey{.name = keys.cellText(row, 3), .table = keys.cellText(row, 4), .referencedTable = keys.cellText(row, 5), .onDelete = keys.cellText(row, 6),
+                                                  .onUpdate = keys.cellText(row, 7), .columns = range == keyColumnRanges.end() ? Range{} : range->second});
+        if (auto* parent = tableOf(parseInt(keys.cellText(row, 1)))) {
+            parent->foreignKeys.push_back(at);
+        }
+        if (auto* referenced = tableOf(parseInt(keys.cellText(row, 2)))) {
+            referenced->referencedBy.push_back(at);
+        }
+    }
+
+    const auto& triggers = results[TRIGGERS];
+    snapshot.triggers.reserve(triggers.rowCount());
+    for (size_t row = 0; row < triggers.rowCount(); ++row) {
+        auto* table = tableOf(parseInt(triggers.cellText(row, 0)));
+        if (table == nullptr) {
+            continue;
+        }
+        table->triggers.push_back(position(snapshot.triggers.size()));
+        snapshot.triggers.push_back(Trigger{.name = triggers.cellText(row, 1), .type = triggers.cellText(row, 2), .events = triggers.cellText(row, 3), .definition = triggers.cellText(row, 5),
+                                            .isEnabled = triggers.cellText(row, 4) == "1"});
+    }
+    return snapshot;
+}
+
+SchemaSnapshot SchemaSnapshot::fromERModel(const ERModel& model) {
+    SchemaSnapshot snapshot;
+    std::unordered_map<std::string, uint32_t> tableAt;  // Lowercased "schema.name"
+    snapshot.tables.reserve(model.tables.size());
+    tableAt.reserve(model.tables.size());
+
+    for (const auto& source : model.tables) {
+        auto [schema, name] = splitSchemaTable(source.name);
+        const auto at = position(snapshot.tables.size());
+        if (!tableAt.emplace(lowerKey(std::format("{}.{}", schema, name)), at).second) {
+            continue;  // A diagram may place one table on several pages
+        }
+        Table table{.objectId = at + 1, .schema = std::move(schema), .name = std::move(name), .type = "BASE TABLE", .comment = source.comment};
+
+        table.columns.begin = position(snapshot.columns.size());
+        std::vector<std::string> primaryKey;
+        for (const auto& declared : source.columns) {
+            Column column{.name = declared.name, .comment = declared.comment, .nullable = declared.nullable && !declared.isPrimaryKey, .isPrimaryKey = declared.isPrimaryKey};
+            applyDeclaredType(column, A5ERParser::mapTypeToSQLServer(declared.type, declared.size, declared.scale));
+            if (column.isPrimaryKey) {
+                primaryKey.push_back(column.name);
+            }
+            snapshot.columns.push_back(std::move(column));
+        }
+        table.columns.end = position(snapshot.columns.size());
+
+        table.indexes.begin = position(snapshot.indexes.size());
+        const auto addIndex = [&](std::string indexName, std::string type, const std::vector<std::string>& keyColumns, bool isUnique, bool isPrimaryKey) {
+            Range range{.begin = position(snapshot.indexColumns.size())};
+            snapshot.indexColumns.insert(snapshot.indexColumns.end(), keyColumns.begin(), keyColumns.end());
+            range.end = position(snapshot.indexColumns.size());
+            snapshot.indexes.push_back(Index{.name = std::move(indexName), .type = std::move(type), .columns = range, .isUnique = isUnique, .isPrimaryKey = isPrimaryKey});
+        };
+        if (!primaryKey.empty()) {
+            addIndex(std::format("PK_{}", table.name), "CLUSTERED", primaryKey, true, true);
+        }
+        for (size_t i = 0; i < source.indexes.size(); ++i) {
+            const auto& index = source.indexes[i];
+            addIndex(index.name.empty() ? std::format("IX_{}_{}", table.name, i + 1) : index.name, "NONCLUSTERED", index.columns, index.isUnique, false);
+        }
+        table.indexes.end = position(snapshot.indexes.size());
+        snapshot.tables.push_back(std::move(table));
+    }
+
+    const auto tableOf = [&](std::string_view name) -> Table* {
+        auto [schema, table] = splitSchemaTable(name);
+        auto found = tableAt.find(lowerKey(std::format("{}.{}", schema, table)));
+        return found == tableAt.end() ? nullptr : &snapshot.tables[found->second];
+    };
+
+    // Relations sharing a name are the columns of one composite key; the map keeps keys in name order like load()
+    std::map<std::string, std::vector<const ERModelRelation*>> relations;
+    for (const auto& relation : model.relations) {
+        if (relation.parentColumn.empty() || relation.childColumn.empty()) {
+            continue;
+        }
+        auto name = relation.name.empty() ? std::format("FK_{}_{}", splitSchemaTable(relation.childTable).name, splitSchemaTable(relation.parentTable).name) : relation.name;
+        relations[std::move(name)].push_back(&relation);
+    }
+    for (const auto& [name, parts] : relations) {
+        auto* child = tableOf(parts.front()->childTable);
+        auto* parent = tableOf(parts.front()->parentTable);
+        if (child == nullptr || parent == nullptr) {
+            continue;
+        }
+        Range range{.begin = position(snapshot.foreignKeyColumns.size())};
+        for (const auto* part : parts) {
+            snapshot.foreignKeyColumns.push_back(ForeignKeyColumn{.column = part->childColumn, .referencedColumn = part->parentColumn});
+        }
+        range.end = position(snapshot.foreignKeyColumns.size());
+        const auto at = position(snapshot.foreignKeys.size());
+        snapshot.foreignKeys.push_back(ForeignKey{.name = name, .table = std::format("{}.{}", child->schema, child->name), .referencedTable = std::format("{}.{}", parent->schema, parent->name),
+                                                  .onDelete = "NO_ACTION", .onUpdate = "NO_ACTION", .columns = range});
+        child->foreignKeys.push_back(at);
+        parent->referencedBy.push_back(at);
+    }
+    return snapshot;
+}
+
+ERModel SchemaSnapshot::toERModel() const {
+    ERModel model{.databaseType = "SQLServer"};
+    std::vector<std::string> diagramNames(tables.size());  // Empty for views
+    std::unordered_map<std::string, uint32_t> tableAt;     // Lowercased "schema.name" of base tables
+    model.tables.reserve(tables.size());
+    tableAt.reserve(tables.size());
+    for (size_t at = 0; at < tables.size(); ++at) {
+        const auto& table = tables[at];
+        if (table.type != "BASE TABLE") {
+            continue;
+        }
+        diagramNames[at] = lowerKey(table.schema) == "dbo" ? table.name : std::format("{}.{}", table.schema, table.name);
+        tableAt.emplace(lowerKey(std::format("{}.{}", table.schema, table.name)), position(at));
+
+        ERModelTable diagramTable{.name = diagramNames[at], .comment = table.comment};
+        diagramTable.columns.reserve(table.columns.end - table.columns.begin);
+        for (uint32_t i = table.columns.begin; i < table.columns.end; ++i) {
+            const auto& column = columns[i];
+            const auto type = lowerKey(column.type);
+            int size = column.size == -1 ? 0 : column.size;
+            if (type == "nvarchar" || type == "nchar") {
+                size /= 2;
+            } else if (type == "decimal" || type == "numeric") {
+                size = column.precision;
+            }
+            diagramTable.columns.push_back(ERModelColumn{.name = column.name, .type = declaredType(column), .size = size, .scale = column.scale, .nullable = column.nullable,
+                                                         .isPrimaryKey = column.isPrimaryKey, .comment = column.comment});
+        }
+        for (uint32_t i = table.indexes.begin; i < table.indexes.end; ++i) {
+            const auto& index = indexes[i];
+            if (index.isPrimaryKey) {
+                continue;
+            }
+            diagramTable.indexes.push_back(ERModelIndex{.name = index.name, .columns = {indexColumns.begin() + index.columns.begin, indexColumns.begin() + index.columns.end},
+                                                        .isUnique = index.isUnique});
+        }
+        model.tables.push_back(std::move(diagramTable));
+    }
+
+    // A key whose columns are exactly a unique index of the child (its PK included) allows one child per parent
+    const auto isUniqueIn = [&](const Table& child, const ForeignKey& key) {
+        for (uint32_t i = child.indexes.begin; i < child.indexes.end; ++i) {
+            const auto& index = indexes[i];
+            if (!index.isUnique || index.columns.end - index.columns.begin != key.columns.end - key.columns.begin) {
+                continue;
+            }
+            const bool covered = std::all_of(indexColumns.begin() + index.columns.begin, indexColumns.begin() + index.columns.end, [&](const std::string& indexed) {
+                return std::any_of(foreignKeyColumns.begin() + key.columns.begin, foreignKeyColumns.begin() + key.columns.end,
+                                   [&](const ForeignKeyColumn& part) { return lowerKey(part.column) == lowerKey(indexed); });
+            });
+            if (covered) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (size_t at = 0; at < tables.size(); ++at) {
+        if (diagramNames[at].empty()) {
+            continue;
+        }
+        for (const auto keyAt : tables[at].foreignKeys) {
+            const auto& key = foreignKeys[keyAt];
+            auto [schema, name] = splitSchemaTable(key.referencedTable);
+            auto parent = tableAt.find(lowerKey(std::format("{}.{}", schema, name)));
+            if (parent == tableAt.end()) {
+                continue;
+            }
+            const auto* cardinality = isUniqueIn(tables[at], key) ? "1:1" : "1:N";
+            for (uint32_t i = key.columns.begin; i < key.columns.end; ++i) {
+                model.relations.push_back(ERModelRelation{.name = key.name, .parentTable = diagramNames[parent->second], .childTable = diagramNames[at],
+                                                          .parentColumn = foreignKeyColumns[i].referencedColumn, .childColumn = foreignKeyColumns[i].column, .cardinality = cardinality});
+            }
+        }
+    }
+    return model;
+}
+
+std::string SchemaSnapshot::declaredType(const Column& column) {
+    std::string type = column.type;
+    std::ranges::transform(type, type.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    const auto lower = lowerKey(column.type);
+    const auto length = [&](int32_t units) { return column.size == -1 ? std::string("MAX") : std::to_string(units); };
+    if (lower == "nvarchar" || lower == "nchar") {
+        return std::format("{}({})", type, length(column.size / 2));
+    }
+    if (lower == "varchar" || lower == "char" || lower == "varbinary" || lower == "binary") {
+        return std::format("{}({})", type, length(column.size));
+    }
+    if (lower == "decimal" || lower == "numeric") {
+        return std::format("{}({},{})", type, column.precision, column.scale);
+    }
+    if (lower == "datetime2" || lower == "time" || lower == "datetimeoffset") {
+        return std::format("{}({})", type, column.scale);
+    }
+    return type;
+}
+
+std::string SchemaSnapshot::referentialAction(std::string_view action) {
+    std::string out(action);
+    std::ranges::replace(out, '_', ' ');
+    return out;
+}
+
+std::string SchemaSnapshot::serialize() const {
+    std::string body;
+    appendLe(body, position(tables.size()));
+    for (const auto& table : tables) {
+        appendLe(body, table.objectId);
+        appendText(body, table.schema);
+        appendText(body, table.name);
+        appendText(body, table.type);
+        appendText(body, table.comment);
+        appendRange(body, table.columns);
+        appendRange(body, table.indexes);
+        appendList(body, table.foreignKeys);
+        appendList(body, table.referencedBy);
+        appendList(body, table.triggers);
+    }
+    appendLe(body, position(columns.size()));
+    for (const auto& column : columns) {
+        appendText(body, column.name);
+        appendText(body, column.type);
+        appendText(body, column.comment);
+        appendLe(body, column.size);
+        appendLe(body, column.precision);
+        appendLe(body, column.scale);
+        appendLe(body, static_cast<uint8_t>((column.nullable ? 1 : 0) | (column.isPrimaryKey ? 2 : 0)));
+    }
+    appendLe(body, position(indexes.size()));
+    for (const auto& index : indexes) {
+        appendText(body, index.name);
+        appendText(body, index.type);
+        appendRange(body, index.columns);
+        appendLe(body, static_cast<uint8_t>((index.isUnique ? 1 : 0) | (index.isPrimaryKey ? 2 : 0)));
+    }
+    appendLe(body, position(indexColumns.size()));
+    for (const auto& column : indexColumns) {
+        appendText(body, column);
+    }
+    appendLe(body, position(foreignKeys.size()));
+    for (const auto& key : foreignKeys) {
+        appendText(body, key.name);
+        appendText(body, key.table);
+        appendText(body, key.referencedTable);
+        appendText(body, key.onDelete);
+        appendText(body, key.onUpdate);
+        appendRange(body, key.columns);
+    }
+    appendLe(body, position(foreignKeyColumns.size()));
+    for (const auto& column : foreignKeyColumns) {
+        appendText(body, column.column);
+        appendText(body, column.referencedColumn);
+    }
+    appendLe(body, position(triggers.size()));
+    for (const auto& trigger : triggers) {
+        appendText(body, trigger.name);
+        appendText(body, trigger.type);
+        appendText(body, trigger.events);
+        appendText(body, trigger.definition);
+        appendLe(body, static_cast<uint8_t>(trigger.isEnabled ? 1 : 0));
+    }
+
+    if (body.size() > Lz4Codec::MAX_INPUT_BYTES) [[unlikely]] {
+        throw std::runtime_error("Schema snapshot too large");
+    }
+    std::string out;
+    out.append(SNAPSHOT_MAGIC);
+    appendLe(out, SNAPSHOT_VERSION);
+    out.resize(SNAPSHOT_HEADER_BYTES + Lz4Codec::compressBound(body.size()));
+    const size_t compressed = Lz4Codec::compress(body, out.data() + SNAPSHOT_HEADER_BYTES, out.size() - SNAPSHOT_HEADER_BYTES);
+    const bool stored = compressed == 0 || compressed >= body.size();  // Tiny schemas may not shrink
+    const auto flags = stored ? uint16_t{0} : SNAPSHOT_COMPRESSED;
+    const auto rawBytes = static_cast<uint32_t>(body.size());
+    const auto storedBytes = static_cast<uint32_t>(stored ? body.size() : compressed);
+    std::memcpy(out.data() + 6, &flags, sizeof(flags));
+    std::memcpy(out.data() + 8, &rawBytes, sizeof(rawBytes));
+    std::memcpy(out.data() + 12, &storedBytes, sizeof(storedBytes));
+    if (stored) {
+        std::memcpy(out.data() + SNAPSHOT_HEADER_BYTES, body.data(), body.size());
+    }
+    out.resize(SNAPSHOT_HEADER_BYTES + storedBytes);
+    return out;
+}
+
+SchemaSnapshot SchemaSnapshot::deserialize(std::string_view data) {
+    if (data.size() < SNAPSHOT_HEADER_BYTES || data.substr(0, SNAPSHOT_MAGIC.size()) != SNAPSHOT_MAGIC) [[unlikely]] {
+        throw std::runtime_error("Not a schema snapshot file");
+    }
+    SnapshotReader header(data.substr(SNAPSHOT_MAGIC.size(), SNAPSHOT_HEADER_BYTES - SNAPSHOT_MAGIC.size()));
+    const auto version = header.value<uint16_t>();
+    const auto flags = header.value<uint16_t>();
+    const auto rawBytes = header.value<uint32_t>();
+    const auto storedBytes = header.value<uint32_t>();
+    if (version != SNAPSHOT_VERSION) [[unlikely]] {
+        throw std::runtime_error(std::format("Unsupported schema snapshot version {}", version));
+    }
+    if (data.size() - SNAPSHOT_HEADER_BYTES != storedBytes || rawBytes > Lz4Codec::MAX_INPUT_BYTES) [[unlikely]] {
+        SnapshotReader::damaged();
+    }
+
+    std::string body(rawBytes, '\0');
+    const auto stored = data.substr(SNAPSHOT_HEADER_BYTES);
+    if ((flags & SNAPSHOT_COMPRESSED) == 0) {
+        if (storedBytes != rawBytes) [[unlikely]] {
+            SnapshotReader::damaged();
+        }
+        std::memcpy(body.data(), stored.data(), rawBytes);
+    } else if (!Lz4Codec::decompress(stored, body.data(), rawBytes)) [[unlikely]] {
+        SnapshotReader::damaged();
+    }
+
+    SnapshotReader reader(body);
+    SchemaSnapshot snapshot;
+    snapshot.tables.resize(reader.count(48));
+    for (auto& table : snapshot.tables) {
+        table.objectId = reader.value<int64_t>();
+        table.schema = reader.text();
+        table.name = reader.text();
+        table.type = reader.text();
+        table.comment = reader.text();
+        table.columns = reader.range();
+        table.indexes = reader.range();
+        table.foreignKeys = reader.list();
+        table.referencedBy = reader.list();
+        table.triggers = reader.list();
+    }
+    snapshot.columns.resize(reader.count(25));
+    for (auto& column : snapshot.columns) {
+        column.name = reader.text();
+        column.type = reader.text();
+        column.comment = reader.text();
+        column.size = reader.value<int32_t>();
+        column.precision = reader.value<int32_t>();
+        column.scale = reader.value<int32_t>();
+        const auto bits = reader.value<uint8_t>();
+        column.nullable = (bits & 1) != 0;
+        column.isPrimaryKey = (bits & 2) != 0;
+    }
+    snapshot.indexes.resize(reader.count(17));
+    for (auto& index : snapshot.indexes) {
+        index.name = reader.text();
+        index.type = reader.text();
+        index.columns = reader.range();
+        const auto bits = reader.value<uint8_t>();
+        index.isUnique = (bits & 1) != 0;
+        index.isPrimaryKey = (bits & 2) != 0;
+    }
+    snapshot.indexColumns.resize(reader.count(4));
+    for (auto& column : snapshot.indexColumns) {
+        column = reader.text();
+    }
+    snapshot.foreignKeys.resize(reader.count(28));
+    for (auto& key : snapshot.foreignKeys) {
+        key.name = reader.text();
+        key.table = reader.text();
+        key.referencedTable = reader.text();
+        key.onDelete = reader.text();
+        key.onUpdate = reader.text();
+        key.columns = reader.range();
+    }
+    snapshot.foreignKeyColumns.resize(reader.count(8));
+    for (auto& column : snapshot.foreignKeyColumns) {
+        column.column = reader.text();
+        column.referencedColumn = reader.text();
+    }
+    snapshot.triggers.resize(reader.count(17));
+    for (auto& trigger : snapshot.triggers) {
+        trigger.name = reader.text();
+        trigger.type = reader.text();
+        trigger.events = reader.text();
+        trigger.definition = reader.text();
+        trigger.isEnabled = reader.value<uint8_t>() != 0;
+    }
+    if (!reader.atEnd()) [[unlikely]] {
+        SnapshotReader::damaged();
+    }
+
+    // Every range and index list must stay inside its array before the writers may follow them
+    for (const auto& table : snapshot.tables) {
+        checkRange(table.columns, snapshot.columns.size());
+        checkRange(table.indexes, snapshot.indexes.size());
+        checkList(table.foreignKeys, snapshot.foreignKeys.size());
+        checkList(table.referencedBy, snapshot.foreignKeys.size());
+        checkList(table.triggers, snapshot.triggers.size());
+    }
+    for (const auto& index : snapshot.indexes) {
+        checkRange(index.columns, snapshot.indexColumns.size());
+    }
+    for (const auto& key : snapshot.foreignKeys) {
+        checkRange(key.columns, snapshot.foreignKeyColumns.size());
+    }
+    return snapshot;
+}
+
+std::string SchemaSnapshot::columnsJson(const Table& table) const {
+    std::string out = "[";
+    for (auto i = table.columns.begin; i < table.columns.end; ++i) {
+        const auto& column = columns[i];
+        if (i > table.columns.begin) {
+            out += ',';
+        }
+        out += std::format(R"({{"name":"{}","type":"{}","size":{},"nullable":{},"isPrimaryKey":{},"comment":"{}"}})", JsonUtils::escapeString(column.name), JsonUtils::escapeString(column.type),
+                           column.size, column.nullable ? "true" : "false", column.isPrimaryKey ? "true" : "false", JsonUtils::escapeString(column.comment));
+    }
+    out += ']';
+    return out;
+}
+
+std::string SchemaSnapshot::indexesJson(const Table& table) const {
+    std::string out = "[";
+    for (auto i = table.indexes.begin; i < table.indexes.end; ++i) {
+        const auto& index = indexes[i];
+        if (i > table.indexes.begin) {
+            out += ',';
+        }
+        out += std::format(R"({{"name":"{}","type":"{}","isUnique":{},"isPrimaryKey":{},"columns":)", JsonUtils::escapeString(index.name), JsonUtils::escapeString(index.type),
+                           index.isUnique ? "true" : "false", index.isPrimaryKey ? "true" : "false");
+        appendStringArray(out, std::span(indexColumns).subspan(index.columns.begin, index.columns.end - index.columns.begin));
+        out += '}';
+    }
+    out += ']';
+    return out;
+}
+
+std::string SchemaSnapshot::foreignKeysJson(const Table& table) const {
+    std::string out = "[";
+    for (const auto at : table.foreignKeys) {
+        const auto& key = foreignKeys[at];
+        const auto keyColumns = std::span(foreignKeyColumns).subspan(key.columns.begin, key.columns.end - key.columns.begin);
+        if (out.size() > 1) {
+            out += ',';
+        }
+        out += std::format(R"({{"name":"{}","columns":)", JsonUtils::escapeString(key.name));
+        appendStringArray(out, keyColumns | std::views::transform(&ForeignKeyColumn::column));
+        out += std::format(R"(,"referencedTable":"{}","referencedColumns":)", JsonUtils::escapeString(key.referencedTable));
+        appendStringArray(out, keyColumns | std::views::transform(&ForeignKeyColumn::referencedColumn));
+        out += std::format(R"(,"onDelete":"{}","onUpdate":"{}"}})", JsonUtils::escapeString(key.onDelete), JsonUtils::escapeString(key.onUpdate));
+    }
+    out += ']';
+    return out;
+}
+
+std::string SchemaSnapshot::referencingForeignKeysJson(const Table& table) const {
+    std::string out = "[";
+    for (const auto at : table.referencedBy) {
+        const auto& key = foreignKeys[at];
+        const auto keyColumns = std::span(foreignKeyColumns).subspan(key.columns.begin, key.columns.end - key.columns.begin);
+        if (out.size() > 1) {
+            out += ',';
+        }
+        out += std::format(R"({{"name":"{}","referencingTable":"{}","referencingColumns":)", JsonUtils::escapeString(key.name), JsonUtils::escapeString(key.table));
+        appendStringArray(out, keyColumns | std::views::transform(&ForeignKeyColumn::column));
+        out += R"(,"columns":)";
+        appendStringArray(out, keyColumns | std::views::transform(&ForeignKeyColumn::referencedColumn));
+        out += std::format(R"(,"onDelete":"{}","onUpdate":"{}"}})", JsonUtils::escapeString(key.onDelete), JsonUtils::escapeString(key.onUpdate));
+    }
+    out += ']';
+    return out;
+}
+
+std::string SchemaSnapshot::triggersJson(const Table& table) const {
+    std::string out = "[";
+    for (const auto at : table.triggers) {
+        const auto& trigger = triggers[at];
+        if (out.size() > 1) {
+            out += ',';
+        }
+        out += std::format(R"({{"name":"{}","type":"{}","events":)", JsonUtils::escapeString(trigger.name), JsonUtils::escapeString(trigger.type));
+        appendCsvArray(out, trigger.events);
+        out += std::format(R"(,"isEnabled":{},"definition":"{}"}})", trigger.isEnabled ? "true" : "false", JsonUtils::escapeString(trigger.definition));
+    }
+    out += ']';
+    return out;
+}
+
+}  // namespace velocitydb
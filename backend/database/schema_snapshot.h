@@ -0,0 +1,122 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+struct ERModel;
+
+/// Whole-database metadata read in one multi-result-set batch (tables, columns, indexes, foreign keys, triggers).
+///
+/// Children live in flat arrays ordered by their table; a table addresses its columns and indexes as
+/// [begin, end) ranges and its foreign keys and triggers through index lists, so a database with tens of
+/// thousands of columns costs a handful of allocations per kind instead of one vector per table.
+/// The *Json writers produce exactly the payloads of the per-table schema handlers, so the cache can be
+/// seeded from a snapshot and stay indistinguishable from one-table-at-a-time loading.
+/// serialize() keeps a snapshot on disk as one LZ4 block, so a schema can be compared against later without a server.
+struct SchemaSnapshot {
+    struct Range {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    struct Column {
+        std::string name;
+        std::string type;
+        std::string comment;
+        int32_t size = 0;  ///< sys.columns.max_length
+        int32_t precision = 0;
+        int32_t scale = 0;
+        bool nullable = false;
+        bool isPrimaryKey = false;
+    };
+
+    struct Index {
+        std::string name;
+        std::string type;
+        Range columns;  ///< Into indexColumns, key order
+        bool isUnique = false;
+        bool isPrimaryKey = false;
+    };
+
+    struct ForeignKey {
+        std::string name;
+        std::string table;            ///< "schema.name" of the referencing table
+        std::string referencedTable;  ///< "schema.name"
+        std::string onDelete;
+        std::string onUpdate;
+        Range columns;  ///< Into foreignKeyColumns, constraint order
+    };
+
+    struct ForeignKeyColumn {
+        std::string column;
+        std::string referencedColumn;
+    };
+
+    struct Trigger {
+        std::string name;
+        std::string type;    ///< AFTER or INSTEAD OF
+        std::string events;  ///< Comma separated INSERT/UPDATE/DELETE
+        std::string definition;
+        bool isEnabled = false;
+    };
+
+    struct Table {
+        int64_t objectId = 0;
+        std::string schema;
+        std::string name;
+        std::string type;  ///< BASE TABLE or VIEW
+        std::string comment;
+        Range columns;
+        Range indexes;
+        std::vector<uint32_t> foreignKeys;   ///< Keys this table declares, by name
+        std::vector<uint32_t> referencedBy;  ///< Keys of other tables pointing here, by name
+        std::vector<uint32_t> triggers;      ///< By name
+    };
+
+    std::vector<Table> tables;  ///< Ordered by object_id
+    std::vector<Column> columns;
+    std::vector<Index> indexes;
+    std::vector<std::string> indexColumns;
+    std::vector<ForeignKey> foreignKeys;
+    std::vector<ForeignKeyColumn> foreignKeyColumns;
+    std::vector<Trigger> triggers;
+
+    /// Read the metadata of every user table and view, or only of `objectIds` when given (foreign keys pointing at
+    /// them from elsewhere included). One round trip; @throws std::runtime_error when the batch fails
+    [[nodiscard]] static SchemaSnapshot load(IDatabaseDriver& driver, const std::vector<int64_t>* objectIds = nullptr);
+
+    /// Tables, columns, keys and indexes of an ER diagram as SQL Server would report them once created.
+    /// Tables without a schema go to dbo; the primary key becomes a clustered PK_<table> index and each
+    /// relation a NO_ACTION foreign key (relations sharing a name become one multi-column key)
+    [[nodiscard]] static SchemaSnapshot fromERModel(const ERModel& model);
+
+    /// Base tables as an ER diagram, the inverse of fromERModel: dbo tables keep bare names, columns carry their
+    /// declared types (so DDL generation and fromERModel reproduce them), non-PK indexes become diagram indexes and
+    /// each foreign key column pair a relation named after its key, 1:1 when the key columns are unique in the child.
+    /// Views are left out, as are keys into them. Every table is at (0, 0), i.e. unplaced for layoutERModel
+    [[nodiscard]] ERModel toERModel() const;
+
+    /// Column type as CREATE TABLE spells it, e.g. NVARCHAR(50); size counts bytes, so n-types halve it
+    [[nodiscard]] static std::string declaredType(const Column& column);
+    /// ON DELETE / ON UPDATE action as DDL spells it; sys.foreign_keys writes NO_ACTION for NO ACTION
+    [[nodiscard]] static std::string referentialAction(std::string_view action);
+
+    /// Compact binary form (versioned header, LZ4-compressed body) for saving a snapshot to a file
+    [[nodiscard]] std::string serialize() const;
+    /// @throws std::runtime_error when `data` is not a serialized snapshot of this version or is damaged
+    [[nodiscard]] static SchemaSnapshot deserialize(std::string_view data);
+
+    [[nodiscard]] std::string columnsJson(const Table& table) const;
+    [[nodiscard]] std::string indexesJson(const Table& table) const;
+    [[nodiscard]] std::string foreignKeysJson(const Table& table) const;
+    [[nodiscard]] std::string referencingForeignKeysJson(const Table& table) const;
+    [[nodiscard]] std::string triggersJson(const Table& table) const;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,464 @@
+#include "server_health_monitor.h"
+
+#include "../utils/json_utils.h"
+#include "../utils/logger.h"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <format>
+#include <map>
+#include <thread>
+
+namespace velocitydb {
+
+namespace {
+
+/// Integer cell whatever the storage type the driver picked
+int64_t integerCell(const ResultSet& result, size_t row, size_t col) {
+    const auto& column = result.columnData[col];
+    if (column.isNull(row)) {
+        return 0;
+    }
+    if (column.isNumeric()) {
+        return static_cast<int64_t>(column.numericAt(row));
+    }
+    const auto text = column.textAt(row);
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+std::string textCell(const ResultSet& result, size_t row, size_t col) {
+    return result.isNull(row, col) ? std::string() : result.columnData[col].displayText(row);
+}
+
+enum RequestColumn : size_t {
+    R_SESSION,
+    R_BLOCKED_BY,
+    R_START,
+    R_STATUS,
+    R_COMMAND,
+    R_WAIT_TYPE,
+    R_WAIT_TIME,
+    R_ELAPSED,
+    R_CPU,
+    R_READS,
+    R_OPEN_TRAN,
+    R_DATABASE,
+    R_LOGIN,
+    R_HOST,
+    R_PROGRAM,
+    R_STATEMENT,
+    R_COUNT
+};
+enum BlockerColumn : size_t { B_SESSION, B_LOGIN, B_HOST, B_PROGRAM, B_OPEN_TRAN, B_COUNT };
+enum WaitColumn : size_t { W_TYPE, W_TASKS, W_TIME, W_SIGNAL, W_COUNT };
+
+/// Waits that only mean a background task is idle; they would drown the ones worth looking at
+constexpr std::string_view BENIGN_WAITS =
+    "'BROKER_EVENTHANDLER','BROKER_RECEIVE_WAITFOR','BROKER_TASK_STOP','BROKER_TO_FLUSH','BROKER_TRANSMITTER','CHECKPOINT_QUEUE',"
+    "'CLR_AUTO_EVENT','CLR_MANUAL_EVENT','CLR_SEMAPHORE','DIRTY_PAGE_POLL','DISPATCHER_QUEUE_SEMAPHORE','FT_IFTS_SCHEDULER_IDLE_WAIT',"
+    "'FT_IFTSHC_MUTEX','HADR_CLUSAPI_CALL','HADR_FILESTREAM_IOMGR_IOCOMPLETION','HADR_LOGCAPTURE_WAIT','HADR_NOTIFICATION_DEQUEUE',"
+    "'HADR_TIMER_TASK','HADR_WORK_QUEUE','KSOURCE_WAKEUP','LAZYWRITER_SLEEP','LOGMGR_QUEUE','ONDEMAND_TASK_QUEUE',"
+    "'PREEMPTIVE_XE_DISPATCHER','PWAIT_ALL_COMPONENTS_INITIALIZED','PWAIT_EXTENSIBILITY_CLEANUP_TASK',"
+    "'QDS_ASYNC_QUEUE','QDS_CLEANUP_STALE_QUERIES_TASK_MAIN_LOOP_SLEEP','QDS_PERSIST_TASK_MAIN_LOOP_SLEEP',"
+    "'REQUEST_FOR_DEADLOCK_SEARCH','RESOURCE_QUEUE','SERVER_IDLE_CHECK','SP_SERVER_DIAGNOSTICS_SLEEP','SQLTRACE_BUFFER_FLUSH',"
+    "'SQLTRACE_INCREMENTAL_FLUSH_SLEEP','SQLTRACE_WAIT_ENTRIES','WAIT_FOR_RESULTS','WAITFOR','WAITFOR_TASKSHUTDOWN',"
+    "'WAIT_XTP_CKPT_CLOSE','WAIT_XTP_HOST_WAIT','WAIT_XTP_OFFLINE_CKPT_NEW_LOG','XE_DISPATCHER_JOIN','XE_DISPATCHER_WAIT',"
+    "'XE_LIVE_TARGET_TVF','XE_TIMER_EVENT'";
+
+int64_t millisBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+void appendRequest(std::string& out, const ActiveRequest& request) {
+    out += std::format(R"({{"sessionId":{},"blockedBy":{},"startTime":")", request.sessionId, request.blockedBy);
+    JsonUtils::appendEscaped(out, request.startTime);
+    out += R"(","status":")";
+    JsonUtils::appendEscaped(out, request.status);
+    out += R"(","command":")";
+    JsonUtils::appendEscaped(out, request.command);
+    out += R"(","waitType":")";
+    JsonUtils::appendEscaped(out, request.waitType);
+    out += std::format(R"(","waitTimeMs":{},"elapsedMs":{},"cpuMs":{},"logicalReads":{},"openTransactions":{},"database":")", request.waitTimeMs, request.elapsedMs, request.cpuMs,
+                       request.logicalReads, request.openTransactions);
+    JsonUtils::appendEscaped(out, request.database);
+    out += R"(","loginName":")";
+    JsonUtils::appendEscaped(out, request.loginName);
+    out += R"(","hostName":")";
+    JsonUtils::appendEscaped(out, request.hostName);
+    out += R"(","programName":")";
+    JsonUtils::appendEscaped(out, request.programName);
+    out += R"(","statement":")";
+    JsonUtils::appendEscaped(out, request.statement);
+    out += "\"}";
+}
+
+/// The parts of a request that change while it runs
+void appendRequestUpdate(std::string& out, const ActiveRequest& request) {
+    out += std::format(R"({{"sessionId":{},"blockedBy":{},"status":")", request.sessionId, request.blockedBy);
+    JsonUtils::appendEscaped(out, request.status);
+    out += R"(","waitType":")";
+    JsonUtils::appendEscaped(out, request.waitType);
+    out += std::format(R"(","waitTimeMs":{},"elapsedMs":{},"cpuMs":{},"logicalReads":{},"openTransactions":{}}})", request.waitTimeMs, request.elapsedMs, request.cpuMs,
+                       request.logicalReads, request.openTransactions);
+}
+
+bool sameProgress(const ActiveRequest& a, const ActiveRequest& b) {
+    return a.blockedBy == b.blockedBy && a.status == b.status && a.waitType == b.waitType && a.waitTimeMs == b.waitTimeMs && a.elapsedMs == b.elapsedMs && a.cpuMs == b.cpuMs &&
+           a.logicalReads == b.logicalReads && a.openTransactions == b.openTransactions;
+}
+
+std::string waitsJson(const std::vector<WaitDelta>& waits) {
+    return JsonUtils::buildArray(waits, [](std::string& out, const WaitDelta& wait) {
+        out += R"({"waitType":")";
+        JsonUtils::appendEscaped(out, wait.waitType);
+        out += std::format(R"(","waitingTasks":{},"waitTimeMs":{},"signalWaitMs":{}}})", wait.waitingTasks, wait.waitTimeMs, wait.signalWaitMs);
+    });
+}
+
+std::string blockersJson(const std::vector<HeadBlocker>& blockers) {
+    return JsonUtils::buildArray(blockers, [](std::string& out, const HeadBlocker& blocker) {
+        out += std::format(R"({{"sessionId":{},"idle":{},"loginName":")", blocker.sessionId, blocker.idle ? "true" : "false");
+        JsonUtils::appendEscaped(out, blocker.loginName);
+        out += R"(","hostName":")";
+        JsonUtils::appendEscaped(out, blocker.hostName);
+        out += R"(","programName":")";
+        JsonUtils::appendEscaped(out, blocker.programName);
+        out += std::format(R"(","openTransactions":{},"blockedSessions":{}}})", blocker.openTransactions, blocker.blockedSessions);
+    });
+}
+
+}  // namespace
+
+struct ServerHealthMonitor::Monitor {
+    std::string connectionId;
+    std::shared_ptr<IDatabaseDriver> driver;
+    Options options;
+    std::mutex mutex;  // guards everything below
+    std::condition_variable_any wake;
+    std::deque<ServerHealthSample> samples;
+    bool running = true;
+    std::string error;
+    std::jthread thread;  // Last member: stopped and joined before the rest goes
+};
+
+ServerHealthMonitor::ServerHealthMonitor(Listener listener) : m_listener(std::move(listener)) {}
+
+ServerHealthMonitor::~ServerHealthMonitor() {
+    std::vector<std::string> ids;
+    {
+        std::lock_guard lock(m_mutex);
+        for (const auto& [id, monitor] : m_monitors) {
+            ids.push_back(id);
+        }
+    }
+    for (const auto& id : ids) {
+        stop(id);
+    }
+}
+
+void ServerHealthMonitor::start(std::string connectionId, std::shared_ptr<IDatabaseDriver> driver, Options options) {
+    if (!driver) [[unlikely]] {
+        return;
+    }
+    stop(connectionId);
+    options.interval = (std::max)(options.interval, MIN_INTERVAL);
+    options.history = std::clamp<size_t>(options.history, 1, MAX_HISTORY);
+
+    auto monitor = std::make_shared<Monitor>();
+    monitor->connectionId = connectionId;
+    monitor->driver = std::move(driver);
+    monitor->options = options;
+    // The map (or stop(), which takes the monitor out of it) keeps the monitor alive until its thread is joined
+    monitor->thread = std::jthread([this, raw = monitor.get()](std::stop_token stopToken) { run(*raw, stopToken); });
+    std::lock_guard lock(m_mutex);
+    m_monitors.insert_or_assign(std::move(connectionId), std::move(monitor));
+}
+
+bool ServerHealthMonitor::stop(std::string_view connectionId) {
+    std::shared_ptr<Monitor> monitor;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_monitors.find(std::string(connectionId));
+        if (it == m_monitors.end()) {
+            return false;
+        }
+        monitor = std::move(it->second);
+        m_monitors.erase(it);
+    }
+    monitor->thread.request_stop();
+    monitor->driver->cancel();
+    monitor->thread.join();
+    return true;
+}
+
+std::optional<ServerHealthMonitor::History> ServerHealthMonitor::history(std::string_view connectionId, uint64_t since) const {
+    std::shared_ptr<Monitor> monitor;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_monitors.find(std::string(connectionId));
+        if (it == m_monitors.end()) {
+            return std::nullopt;
+        }
+        monitor = it->second;
+    }
+    std::lock_guard lock(monitor->mutex);
+    History history{.running = monitor->running, .error = monitor->error, .samples = {}};
+    for (const auto& sample : monitor->samples) {
+        if (sample.sequence > since) {
+            history.samples.push_back(sample);
+        }
+    }
+    return history;
+}
+
+std::string_view ServerHealthMonitor::sessionSetup() noexcept {
+    // Never hold or wait long for a lock, and be the one picked if a deadlock ever involves the monitor
+    return "SET TRANSACTION ISOLATION LEVEL READ UNCOMMITTED; SET LOCK_TIMEOUT 1000; SET DEADLOCK_PRIORITY LOW;";
+}
+
+std::string ServerHealthMonitor::buildQuery() {
+    return std::format(R"(SELECT r.session_id, r.blocking_session_id, CONVERT(varchar(27), r.start_time, 121) AS start_time, r.status, r.command, r.wait_type, r.wait_time,
+       r.total_elapsed_time, r.cpu_time, r.logical_reads, r.open_transaction_count, DB_NAME(r.database_id) AS database_name, s.login_name, s.host_name, s.program_name,
+       LEFT(SUBSTRING(t.text, r.statement_start_offset / 2 + 1,
+                      (CASE WHEN r.statement_end_offset = -1 THEN DATALENGTH(t.text) ELSE r.statement_end_offset END - r.statement_start_offset) / 2 + 1), {}) AS statement_text
+FROM sys.dm_exec_requests r
+JOIN sys.dm_exec_sessions s ON s.session_id = r.session_id
+OUTER APPLY sys.dm_exec_sql_text(r.sql_handle) t
+WHERE s.is_user_process = 1 AND r.session_id <> @@SPID
+ORDER BY r.session_id, r.request_id;
+SELECT s.session_id, s.login_name, s.host_name, s.program_name, s.open_transaction_count
+FROM sys.dm_exec_sessions s
+WHERE s.session_id IN (SELECT blocking_session_id FROM sys.dm_exec_requests WHERE blocking_session_id > 0)
+  AND NOT EXISTS (SELECT 1 FROM sys.dm_exec_requests r WHERE r.session_id = s.session_id);
+SELECT wait_type, waiting_tasks_count, wait_time_ms, signal_wait_time_ms
+FROM sys.dm_os_wait_stats
+WHERE wait_time_ms > 0 AND wait_type NOT LIKE 'SLEEP%' AND wait_type NOT IN ({}))",
+                       MAX_STATEMENT_CHARS, BENIGN_WAITS);
+}
+
+ServerHealthSample ServerHealthMonitor::parseSample(const std::vector<ResultSet>& results, WaitTotals& waitTotals, size_t topWaits) {
+    if (results.size() < 3 || results[0].columns.size() < R_COUNT || results[1].columns.size() < B_COUNT || results[2].columns.size() < W_COUNT) [[unlikely]] {
+        throw std::runtime_error("Server health monitor: the server returned an unexpected result");
+    }
+    ServerHealthSample sample;
+    const auto& requests = results[0];
+    for (size_t row = 0; row < requests.rowCount(); ++row) {
+        const auto sessionId = static_cast<int>(integerCell(requests, row, R_SESSION));
+        if (!sample.requests.empty() && sample.requests.back().sessionId == sessionId) {
+            continue;  // MARS: the session's first request stands for it
+        }
+        sample.requests.push_back(ActiveRequest{.sessionId = sessionId,
+                                                .blockedBy = static_cast<int>(integerCell(requests, row, R_BLOCKED_BY)),
+                                                .startTime = textCell(requests, row, R_START),
+                                                .status = textCell(requests, row, R_STATUS),
+                                                .command = textCell(requests, row, R_COMMAND),
+                                                .waitType = textCell(requests, row, R_WAIT_TYPE),
+                                                .waitTimeMs = integerCell(requests, row, R_WAIT_TIME),
+                                                .elapsedMs = integerCell(requests, row, R_ELAPSED),
+                                                .cpuMs = integerCell(requests, row, R_CPU),
+                                                .logicalReads = integerCell(requests, row, R_READS),
+                                                .openTransactions = static_cast<int>(integerCell(requests, row, R_OPEN_TRAN)),
+                                                .database = textCell(requests, row, R_DATABASE),
+                                                .loginName = textCell(requests, row, R_LOGIN),
+                                                .hostName = textCell(requests, row, R_HOST),
+                                                .programName = textCell(requests, row, R_PROGRAM),
+                                                .statement = textCell(requests, row, R_STATEMENT)});
+    }
+
+    // Blocking chains: follow every blocked session up to the session that waits on nobody
+    std::unordered_map<int, int> blockedBy;
+    for (const auto& request : sample.requests) {
+        if (request.blockedBy > 0 && request.blockedBy != request.sessionId) {
+            blockedBy.emplace(request.sessionId, request.blockedBy);
+        }
+    }
+    std::map<int, int> chainSizes;
+    for (const auto& [session, blocker] : blockedBy) {
+        int head = blocker;
+        // Bounded so a deadlock cycle the server has not broken yet cannot loop forever
+        for (size_t hops = 0; hops < blockedBy.size(); ++hops) {
+            auto next = blockedBy.find(head);
+            if (next == blockedBy.end()) {
+                break;
+            }
+            head = next->second;
+        }
+        ++chainSizes[head];
+    }
+    const auto& idleBlockers = results[1];
+    for (const auto& [sessionId, blocked] : chainSizes) {
+        HeadBlocker blocker{.sessionId = sessionId, .blockedSessions = blocked};
+        if (auto request = std::ranges::find(sample.requests, sessionId, &ActiveRequest::sessionId); request != sample.requests.end()) {
+            blocker.loginName = request->loginName;
+            blocker.hostName = request->hostName;
+            blocker.programName = request->programName;
+            blocker.openTransactions = request->openTransactions;
+        } else {
+            blocker.idle = true;
+            for (size_t row = 0; row < idleBlockers.rowCount(); ++row) {
+                if (integerCell(idleBlockers, row, B_SESSION) == sessionId) {
+                    blocker.loginName = textCell(idleBlockers, row, B_LOGIN);
+                    blocker.hostName = textCell(idleBlockers, row, B_HOST);
+                    blocker.programName = textCell(idleBlockers, row, B_PROGRAM);
+                    blocker.openTransactions = static_cast<int>(integerCell(idleBlockers, row, B_OPEN_TRAN));
+                    break;
+                }
+            }
+        }
+        sample.blockers.push_back(std::move(blocker));
+    }
+    std::ranges::stable_sort(sample.blockers, std::ranges::greater{}, &HeadBlocker::blockedSessions);
+
+    // Wait deltas against the previous counters; a counter that went down was cleared (DBCC SQLPERF) and counts from zero
+    const bool baseline = waitTotals.empty();
+    WaitTotals totals;
+    const auto& waits = results[2];
+    for (size_t row = 0; row < waits.rowCount(); ++row) {
+        auto waitType = textCell(waits, row, W_TYPE);
+        const WaitCounters current{.waitingTasks = integerCell(waits, row, W_TASKS), .waitTimeMs = integerCell(waits, row, W_TIME), .signalWaitMs = integerCell(waits, row, W_SIGNAL)};
+        if (!baseline) {
+            WaitCounters before;
+            if (auto it = waitTotals.find(waitType); it != waitTotals.end() && it->second.waitTimeMs <= current.waitTimeMs) {
+                before = it->second;
+            }
+            if (current.waitTimeMs > before.waitTimeMs) {
+                sample.waits.push_back(WaitDelta{.waitType = waitType,
+                                                 .waitingTasks = (std::max<int64_t>)(current.waitingTasks - before.waitingTasks, 0),
+                                                 .waitTimeMs = current.waitTimeMs - before.waitTimeMs,
+                                                 .signalWaitMs = (std::max<int64_t>)(current.signalWaitMs - before.signalWaitMs, 0)});
+            }
+        }
+        totals.emplace(std::move(waitType), current);
+    }
+    waitTotals = std::move(totals);
+    std::ranges::sort(sample.waits, std::ranges::greater{}, &WaitDelta::waitTimeMs);
+    if (sample.waits.size() > topWaits) {
+        sample.waits.resize(topWaits);
+    }
+    return sample;
+}
+
+std::string ServerHealthMonitor::sampleJson(const ServerHealthSample& sample) {
+    std::string json = std::format(R"({{"sequence":{},"timestamp":{},"intervalMs":{},"pollMs":{},"requests":)", sample.sequence, sample.timestampMs, sample.intervalMs, sample.pollMs);
+    json += JsonUtils::buildArray(sample.requests, appendRequest);
+    json += R"(,"waits":)";
+    json += waitsJson(sample.waits);
+    json += R"(,"blockers":)";
+    json += blockersJson(sample.blockers);
+    json += '}';
+    return json;
+}
+
+std::string ServerHealthMonitor::deltaJson(std::string_view connectionId, const ServerHealthSample* previous, const ServerHealthSample& current) {
+    std::string added = "[";
+    std::string updated = "[";
+    std::string removed = "[";
+    std::unordered_map<int, const ActiveRequest*> before;
+    if (previous) {
+        for (const auto& request : previous->requests) {
+            before.emplace(request.sessionId, &request);
+        }
+    }
+    for (const auto& request : current.requests) {
+        auto it = before.find(request.sessionId);
+        if (it == before.end() || it->second->startTime != request.startTime) {
+            if (added.size() > 1) {
+                added += ',';
+            }
+            appendRequest(added, request);
+        } else if (!sameProgress(*it->second, request)) {
+            if (updated.size() > 1) {
+                updated += ',';
+            }
+            appendRequestUpdate(updated, request);
+        }
+        if (it != before.end()) {
+            before.erase(it);
+        }
+    }
+    for (const auto& [sessionId, request] : before) {
+        if (removed.size() > 1) {
+            removed += ',';
+        }
+        removed += std::to_string(sessionId);
+    }
+
+    std::string json = R"({"connectionId":")";
+    JsonUtils::appendEscaped(json, connectionId);
+    json += std::format(R"(","sequence":{},"timestamp":{},"intervalMs":{},"pollMs":{},"added":{}],"updated":{}],"removed":{}],"waits":)", current.sequence, current.timestampMs,
+                        current.intervalMs, current.pollMs, added, updated, removed);
+    json += waitsJson(current.waits);
+    if (!previous || previous->blockers != current.blockers) {
+        json += R"(,"blockers":)";
+        json += blockersJson(current.blockers);
+    }
+    json += '}';
+    return json;
+}
+
+void ServerHealthMonitor::run(Monitor& monitor, std::stop_token stop) {
+    const auto query = buildQuery();
+    WaitTotals waitTotals;
+    std::optional<ServerHealthSample> previous;
+    std::chrono::steady_clock::time_point previousStart;
+    try {
+        (void)monitor.driver->execute(sessionSetup());
+        while (!stop.stop_requested()) {
+            const auto started = std::chrono::steady_clock::now();
+            auto results = monitor.driver->executeMultiple(query);
+            const auto finished = std::chrono::steady_clock::now();
+            if (stop.stop_requested()) {
+                break;
+            }
+
+            auto sample = parseSample(results, waitTotals, monitor.options.topWaits);
+            sample.sequence = previous ? previous->sequence + 1 : 1;
+            sample.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            sample.intervalMs = previous ? millisBetween(previousStart, started) : 0;
+            sample.pollMs = millisBetween(started, finished);
+            auto event = deltaJson(monitor.connectionId, previous ? &*previous : nullptr, sample);
+            {
+                std::lock_guard lock(monitor.mutex);
+                monitor.samples.push_back(sample);
+                while (monitor.samples.size() > monitor.options.history) {
+                    monitor.samples.pop_front();
+                }
+            }
+            if (m_listener) {
+                m_listener(event);
+            }
+            previous = std::move(sample);
+            previousStart = started;
+
+            // A server slow to answer gets polled less often rather than harder
+            const auto pause = (std::max)(std::chrono::duration_cast<std::chrono::steady_clock::duration>(monitor.options.interval), (finished - started) * MAX_DUTY_FACTOR);
+            std::unique_lock lock(monitor.mutex);
+            (void)monitor.wake.wait_until(lock, stop, started + pause, [] { return false; });
+        }
+    } catch (const std::exception& e) {
+        if (!stop.stop_requested()) {
+            // Usually a missing VIEW SERVER STATE permission or a lost connection; the next tick would fail the same way
+            log<LogLevel::WARNING>(std::format("Server health monitor stopped: {}", e.what()));
+            {
+                std::lock_guard lock(monitor.mutex);
+                monitor.running = false;
+                monitor.error = e.what();
+            }
+            if (m_listener) {
+                std::string event = R"({"connectionId":")";
+                JsonUtils::appendEscaped(event, monitor.connectionId);
+                event += R"(","error":")";
+                JsonUtils::appendEscaped(event, e.what());
+                event += "\"}";
+                m_listener(event);
+            }
+        }
+    }
+    monitor.driver->disconnect();
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// One row of sys.dm_exec_requests (user sessions only)
+struct ActiveRequest {
+    int sessionId = 0;
+    int blockedBy = 0;  ///< blocking_session_id; 0 when not blocked
+    std::string startTime;  ///< With sessionId, tells a new request on the same session from a running one
+    std::string status;
+    std::string command;
+    std::string waitType;
+    int64_t waitTimeMs = 0;
+    int64_t elapsedMs = 0;
+    int64_t cpuMs = 0;
+    int64_t logicalReads = 0;
+    int openTransactions = 0;
+    std::string database;
+    std::string loginName;
+    std::string hostName;
+    std::string programName;
+    std::string statement;  ///< The running statement of the batch, cut at ServerHealthMonitor::MAX_STATEMENT_CHARS
+};
+
+/// Growth of one wait type's sys.dm_os_wait_stats counters between two samples
+struct WaitDelta {
+    std::string waitType;
+    int64_t waitingTasks = 0;
+    int64_t waitTimeMs = 0;
+    int64_t signalWaitMs = 0;  ///< Part of waitTimeMs spent waiting for a CPU after the resource was granted
+};
+
+/// A session at the root of a blocking chain
+struct HeadBlocker {
+    int sessionId = 0;
+    bool idle = false;  ///< No running request: typically an open transaction nobody commits
+    std::string loginName;
+    std::string hostName;
+    std::string programName;
+    int openTransactions = 0;
+    int blockedSessions = 0;  ///< Sessions waiting on it, directly or further down the chain
+
+    bool operator==(const HeadBlocker&) const = default;
+};
+
+struct ServerHealthSample {
+    uint64_t sequence = 0;  ///< 1 for the first sample of a monitor
+    int64_t timestampMs = 0;  ///< Unix time
+    int64_t intervalMs = 0;  ///< Since the previous sample; 0 for the first
+    int64_t pollMs = 0;      ///< Round trip of the DMV batch
+    std::vector<ActiveRequest> requests;  ///< By session
+    std::vector<WaitDelta> waits;  ///< Largest wait time first; empty for the first sample, which sets the baseline
+    std::vector<HeadBlocker> blockers;  ///< Most blocked sessions first
+};
+
+/// Polls active requests, wait statistics and blocking chains of SQL Server connections in the background.
+///
+/// Each monitor runs on its own thread and dedicated connection, so it neither waits for a busy query lane nor
+/// blocks one. A tick is one batch of three cheap DMV reads under READ UNCOMMITTED, LOCK_TIMEOUT and low deadlock
+/// priority. The interval stretches while the server is slow to answer, keeping the monitor's share of one session
+/// under 1/MAX_DUTY_FACTOR. Samples go into a ring buffer for history(); the listener gets only what changed
+/// since the previous sample (deltaJson()).
+class ServerHealthMonitor {
+public:
+    /// Receives deltaJson() after every sample and `{"connectionId","error"}` when a monitor stops on an error.
+    /// Called on monitor threads; must not block.
+    using Listener = std::function<void(const std::string& eventJson)>;
+
+    static constexpr auto DEFAULT_INTERVAL = std::chrono::milliseconds{2000};
+    static constexpr auto MIN_INTERVAL = std::chrono::milliseconds{250};
+    static constexpr int64_t MAX_DUTY_FACTOR = 10;
+    static constexpr size_t DEFAULT_TOP_WAITS = 10;
+    static constexpr size_t DEFAULT_HISTORY = 600;
+    static constexpr size_t MAX_HISTORY = 10000;
+    static constexpr size_t MAX_STATEMENT_CHARS = 2000;
+
+    struct Options {
+        std::chrono::milliseconds interval = DEFAULT_INTERVAL;
+        size_t topWaits = DEFAULT_TOP_WAITS;
+        size_t history = DEFAULT_HISTORY;  ///< Samples kept in the ring buffer
+    };
+
+    struct History {
+        bool running = false;
+        std::string error;  ///< Why the monitor stopped by itself
+        std::vector<ServerHealthSample> samples;
+    };
+
+    /// Cumulative sys.dm_os_wait_stats counters of one wait type
+    struct WaitCounters {
+        int64_t waitingTasks = 0;
+        int64_t waitTimeMs = 0;
+        int64_t signalWaitMs = 0;
+    };
+    using WaitTotals = std::unordered_map<std::string, WaitCounters>;
+
+    explicit ServerHealthMonitor(Listener listener);
+    ~ServerHealthMonitor();
+
+    ServerHealthMonitor(const ServerHealthMonitor&) = delete;
+    ServerHealthMonitor& operator=(const ServerHealthMonitor&) = delete;
+    ServerHealthMonitor(ServerHealthMonitor&&) = delete;
+    ServerHealthMonitor& operator=(ServerHealthMonitor&&) = delete;
+
+    /// Start sampling through `driver`, which the monitor takes over and disconnects when it stops. Replaces a
+    /// monitor already running for `connectionId`.
+    void start(std::string connectionId, std::shared_ptr<IDatabaseDriver> driver, Options options);
+    /// Stop the monitor (cancelling a poll in flight) and drop its history; false if there was none
+    bool stop(std::string_view connectionId);
+    /// Samples newer than `since` still in the ring buffer; nullopt if no monitor was started
+    [[nodiscard]] std::optional<History> history(std::string_view connectionId, uint64_t since) const;
+
+    /// Session settings of the dedicated connection
+    [[nodiscard]] static std::string_view sessionSetup() noexcept;
+    /// Batch of three result sets: active requests, idle head blockers, wait statistics
+    [[nodiscard]] static std::string buildQuery();
+    /// Sample from a buildQuery() result. `waitTotals` holds the previous counters and is updated; when empty,
+    /// the sample only sets the baseline and has no waits.
+    [[nodiscard]] static ServerHealthSample parseSample(const std::vector<ResultSet>& results, WaitTotals& waitTotals, size_t topWaits);
+
+    /// `{"sequence","timestamp","intervalMs","pollMs","requests","waits","blockers"}`
+    [[nodiscard]] static std::string sampleJson(const ServerHealthSample& sample);
+    /// `current` relative to `previous`: requests "added" (new, or a new request on the session), "updated"
+    /// (counters or state changed; identity and statement left out) and "removed" (session ids); "waits"; and
+    /// "blockers" only when the chains changed
+    [[nodiscard]] static std::string deltaJson(std::string_view connectionId, const ServerHealthSample* previous, const ServerHealthSample& current);
+
+private:
+    struct Monitor;
+
+    void run(Monitor& monitor, std::stop_token stop);
+
+    const Listener m_listener;
+    mutable std::mutex m_mutex;  // guards m_monitors
+    std::unordered_map<std::string, std::shared_ptr<Monitor>> m_monitors;
+};
+
+}  // namespace velocitydb
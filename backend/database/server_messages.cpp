@@ -0,0 +1,216 @@
+#include "server_messages.h"
+
+#include "../utils/utf16_transcode.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace velocitydb {
+
+namespace {
+
+/// Drop the "[Microsoft][ODBC Driver 18 for SQL Server][SQL Server]" components the driver puts before the text
+template <typename Char>
+[[nodiscard]] std::basic_string_view<Char> stripVendorPrefix(std::basic_string_view<Char> text) noexcept {
+    while (!text.empty() && text.front() == Char('[')) {
+        const auto close = text.find(Char(']'));
+        if (close == std::basic_string_view<Char>::npos) {
+            break;
+        }
+        text.remove_prefix(close + 1);
+    }
+    return text;
+}
+
+[[nodiscard]] std::string_view trim(std::string_view text) noexcept {
+    constexpr std::string_view whitespace = " \t\r\n";
+    const auto first = text.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(whitespace) - first + 1);
+}
+
+/// The number after `label` in `text` ("CPU time = 15 ms" → 15); false when the label or number is absent
+[[nodiscard]] bool numberAfter(std::string_view text, std::string_view label, uint64_t& value) noexcept {
+    const auto at = text.find(label);
+    if (at == std::string_view::npos) {
+        return false;
+    }
+    auto rest = text.substr(at + label.size());
+    rest.remove_prefix((std::min)(rest.find_first_not_of(" ="), rest.size()));
+    return std::from_chars(rest.data(), rest.data() + rest.size(), value).ec == std::errc{};
+}
+
+void addTableIo(std::vector<TableIoStatistics>& tables, const TableIoStatistics& counters) {
+    auto it = std::ranges::find(tables, counters.table, &TableIoStatistics::table);
+    if (it == tables.end()) {
+        tables.push_back({.table = counters.table});
+        it = tables.end() - 1;
+    }
+    it->scanCount += counters.scanCount;
+    it->logicalReads += counters.logicalReads;
+    it->physicalReads += counters.physicalReads;
+    it->readAheadReads += counters.readAheadReads;
+    it->lobLogicalReads += counters.lobLogicalReads;
+    it->lobPhysicalReads += counters.lobPhysicalReads;
+}
+
+/// "Table 'Orders'. Scan count 1, logical reads 12, physical reads 0, page server reads 0, read-ahead reads 0, ..."
+bool parseTableIo(std::string_view text, std::vector<TableIoStatistics>& tables) {
+    constexpr std::string_view head = "Table '";
+    if (!text.starts_with(head)) {
+        return false;
+    }
+    // Names are not escaped; the counters start after the first "'. "
+    const auto nameEnd = text.find("'. ");
+    if (nameEnd == std::string_view::npos) {
+        return false;
+    }
+    const auto name = text.substr(head.size(), nameEnd - head.size());
+
+    TableIoStatistics counters;
+    bool known = false;
+    auto rest = text.substr(nameEnd + 3);
+    while (!rest.empty()) {
+        const auto end = (std::min)(rest.find_first_of(",."), rest.size());
+        const auto pair = trim(rest.substr(0, end));
+        rest.remove_prefix((std::min)(end + 1, rest.size()));
+
+        const auto space = pair.rfind(' ');
+        uint64_t value = 0;
+        if (space == std::string_view::npos || std::from_chars(pair.data() + space + 1, pair.data() + pair.size(), value).ec != std::errc{}) {
+            continue;
+        }
+        const auto key = pair.substr(0, space);
+        uint64_t* field = key == "Scan count"           ? &counters.scanCount
+                          : key == "logical reads"      ? &counters.logicalReads
+                          : key == "physical reads"     ? &counters.physicalReads
+                          : key == "read-ahead reads"   ? &counters.readAheadReads
+                          : key == "lob logical reads"  ? &counters.lobLogicalReads
+                          : key == "lob physical reads" ? &counters.lobPhysicalReads
+                                                        : nullptr;
+        if (field != nullptr) {
+            *field = value;
+            known = true;
+        }
+    }
+    // Columnstore segment lines ("Segment reads 1, segment skipped 0.") carry nothing tracked here
+    if (!known) {
+        return true;
+    }
+
+    counters.table = name;
+    addTableIo(tables, counters);
+    return true;
+}
+
+}  // namespace
+
+bool ExecutionStatistics::parse(std::string_view message) {
+    const auto text = trim(message);
+    if (parseTableIo(text, tables)) {
+        return true;
+    }
+
+    // "SQL Server Execution Times:\n   CPU time = 0 ms,  elapsed time = 1 ms." and the same for "parse and compile time"
+    const bool compile = text.starts_with("SQL Server parse and compile time:");
+    if (!compile && !text.starts_with("SQL Server Execution Times:")) {
+        return false;
+    }
+    uint64_t cpu = 0;
+    uint64_t elapsed = 0;
+    if (!numberAfter(text, "CPU time", cpu) || !numberAfter(text, "elapsed time", elapsed)) {
+        return false;
+    }
+    (compile ? compileCpuTimeMs : cpuTimeMs) += static_cast<double>(cpu);
+    (compile ? compileElapsedTimeMs : elapsedTimeMs) += static_cast<double>(elapsed);
+    hasTime = true;
+    return true;
+}
+
+void ExecutionStatistics::merge(const ExecutionStatistics& other) {
+    for (const auto& table : other.tables) {
+        addTableIo(tables, table);
+    }
+    cpuTimeMs += other.cpuTimeMs;
+    elapsedTimeMs += other.elapsedTimeMs;
+    compileCpuTimeMs += other.compileCpuTimeMs;
+    compileElapsedTimeMs += other.compileElapsedTimeMs;
+    hasTime = hasTime || other.hasTime;
+}
+
+void ExecutionStatistics::clear() noexcept {
+    tables.clear();
+    cpuTimeMs = 0.0;
+    elapsedTimeMs = 0.0;
+    compileCpuTimeMs = 0.0;
+    compileElapsedTimeMs = 0.0;
+    hasTime = false;
+}
+
+void ServerMessages::add(std::string_view text, int32_t nativeError, std::string_view sqlState) {
+    const size_t offset = m_text.size();
+    m_text += stripVendorPrefix(text);
+    commit(offset, nativeError, sqlState);
+}
+
+void ServerMessages::add(std::u16string_view text, int32_t nativeError, std::u16string_view sqlState) {
+    const size_t offset = m_text.size();
+    appendUtf16AsUtf8(m_text, stripVendorPrefix(text));
+    std::array<char, 5> state{};
+    for (size_t i = 0; i < (std::min)(sqlState.size(), state.size()); ++i) {
+        state[i] = static_cast<char>(sqlState[i]);
+    }
+    commit(offset, nativeError, std::string_view(state.data(), sqlState.empty() ? 0 : state.size()));
+}
+
+void ServerMessages::commit(size_t offset, int32_t nativeError, std::string_view sqlState) {
+    m_statistics.parse(std::string_view(m_text).substr(offset));
+    if (m_entries.size() >= MAX_MESSAGES) [[unlikely]] {
+        m_text.resize(offset);
+        ++m_dropped;
+        return;
+    }
+    Entry entry{.offset = static_cast<uint32_t>(offset), .length = static_cast<uint32_t>(m_text.size() - offset), .nativeError = nativeError};
+    std::copy_n(sqlState.begin(), (std::min)(sqlState.size(), entry.sqlState.size()), entry.sqlState.begin());
+    m_entries.push_back(entry);
+}
+
+void ServerMessages::append(const ServerMessages& other) {
+    const size_t kept = (std::min)(other.m_entries.size(), MAX_MESSAGES - (std::min)(m_entries.size(), MAX_MESSAGES));
+    for (size_t i = 0; i < kept; ++i) {
+        auto entry = other.m_entries[i];
+        const auto offset = m_text.size();
+        m_text.append(other.m_text, entry.offset, entry.length);
+        entry.offset = static_cast<uint32_t>(offset);
+        m_entries.push_back(entry);
+    }
+    m_dropped += other.m_dropped + (other.m_entries.size() - kept);
+    m_statistics.merge(other.m_statistics);
+}
+
+void ServerMessages::clear() noexcept {
+    m_text.clear();
+    m_entries.clear();
+    m_dropped = 0;
+    m_statistics.clear();
+}
+
+ServerMessage ServerMessages::operator[](size_t index) const noexcept {
+    const auto& entry = m_entries[index];
+    return {.text = std::string_view(m_text).substr(entry.offset, entry.length),
+            .nativeError = entry.nativeError,
+            .sqlState = std::string_view(entry.sqlState.data(), entry.sqlState[0] == '\0' ? 0 : entry.sqlState.size())};
+}
+
+size_t ServerMessages::memoryBytes() const noexcept {
+    static const size_t inlineCapacity = std::string().capacity();
+    size_t bytes = m_text.capacity() + m_entries.capacity() * sizeof(Entry) + m_statistics.tables.capacity() * sizeof(TableIoStatistics);
+    for (const auto& table : m_statistics.tables) {
+        bytes += table.table.capacity() > inlineCapacity ? table.table.capacity() + 1 : 0;
+    }
+    return bytes;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Reads reported by SET STATISTICS IO ON for one table, summed over every statement of the batch
+struct TableIoStatistics {
+    std::string table;
+    uint64_t scanCount = 0;
+    uint64_t logicalReads = 0;
+    uint64_t physicalReads = 0;
+    uint64_t readAheadReads = 0;
+    uint64_t lobLogicalReads = 0;
+    uint64_t lobPhysicalReads = 0;
+};
+
+/// SET STATISTICS IO / TIME output parsed out of the server's informational messages. Times are summed over
+/// every statement that reported them; `hasTime` tells an all-zero report from none at all.
+struct ExecutionStatistics {
+    std::vector<TableIoStatistics> tables;  ///< In the order the tables were first reported
+    double cpuTimeMs = 0.0;
+    double elapsedTimeMs = 0.0;
+    double compileCpuTimeMs = 0.0;
+    double compileElapsedTimeMs = 0.0;
+    bool hasTime = false;
+
+    [[nodiscard]] bool empty() const noexcept { return tables.empty() && !hasTime; }
+    /// Fold one message in; false when it is not STATISTICS IO or TIME output
+    bool parse(std::string_view message);
+    /// Add another batch's statistics to these
+    void merge(const ExecutionStatistics& other);
+    void clear() noexcept;
+};
+
+/// One informational or error record as the server sent it
+struct ServerMessage {
+    std::string_view text;  ///< Without the driver's "[Vendor][Driver][SQL Server]" prefix
+    int32_t nativeError = 0;
+    std::string_view sqlState;
+};
+
+/// Every diagnostic record a statement produced (PRINT, RAISERROR below severity 11, STATISTICS IO/TIME,
+/// warnings), in arrival order. The text lives in one arena and each record is a fixed-size entry into it, so
+/// collecting messages allocates only when the arena or the entry table grows; clear() keeps both.
+class ServerMessages {
+public:
+    /// Records kept per statement; later ones are counted in dropped() but still feed statistics()
+    static constexpr size_t MAX_MESSAGES = 10'000;
+
+    /// Record a UTF-8 message
+    void add(std::string_view text, int32_t nativeError, std::string_view sqlState);
+    /// Record a UTF-16 message (as SQLGetDiagRecW returns it), transcoded straight into the arena
+    void add(std::u16string_view text, int32_t nativeError, std::u16string_view sqlState);
+    /// Append another log's records (e.g. those of a result that is not kept)
+    void append(const ServerMessages& other);
+    void clear() noexcept;
+
+    [[nodiscard]] size_t size() const noexcept { return m_entries.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_entries.empty() && m_dropped == 0; }
+    [[nodiscard]] ServerMessage operator[](size_t index) const noexcept;
+    [[nodiscard]] size_t dropped() const noexcept { return m_dropped; }
+    [[nodiscard]] const ExecutionStatistics& statistics() const noexcept { return m_statistics; }
+
+    [[nodiscard]] size_t memoryBytes() const noexcept;
+
+private:
+    struct Entry {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        int32_t nativeError = 0;
+        std::array<char, 5> sqlState{};
+    };
+
+    /// Finish the record whose text was appended to the arena from `offset` on
+    void commit(size_t offset, int32_t nativeError, std::string_view sqlState);
+
+    std::string m_text;
+    std::vector<Entry> m_entries;
+    size_t m_dropped = 0;
+    ExecutionStatistics m_statistics;
+};
+
+}  // namespace velocitydb
@@ -1,15 +1,534 @@
 #include "sqlserver_driver.h"
 
+#include "../utils/cancellation_token.h"
+#include "../utils/metrics.h"
+#include "../utils/query_trace.h"
+#include "../utils/scratch_arena.h"
 #include "odbc_unicode.h"
 
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstring>
 #include <stdexcept>
 #include <vector>
 
 namespace velocitydb {
 
+namespace {
+
+// SQL Server specific types (msodbcsql.h) that cannot be bound as fixed-width text
+constexpr SQLSMALLINT SS_TYPE_VARIANT = -150;
+constexpr SQLSMALLINT SS_TYPE_UDT = -151;
+constexpr SQLSMALLINT SS_TYPE_XML = -152;
+constexpr SQLSMALLINT SS_TYPE_TIME2 = -154;
+constexpr SQLSMALLINT SS_TYPE_DATETIMEOFFSET = -155;
+
+// Columns wider than this are fetched via SQLGetData rather than bound
+constexpr SQLLEN MAX_BOUND_COLUMN_CHARS = 4000;
+// Upper bound for all bound column buffers of one rowset
+constexpr size_t MAX_BOUND_BUFFER_BYTES = 32 * 1024 * 1024;
+
+/// How a column is transferred from the driver.
+struct ColumnBinding {
+    SQLSMALLINT cType = SQL_C_WCHAR;
+    size_t elementBytes = 0;  ///< Bytes per row in a bound buffer (0 = unbounded, SQLGetData only)
+};
+
+/// Numeric, temporal and binary columns travel in their binary C types; everything else as UTF-16 text.
+/// REAL stays text (a float widened to double would print spurious digits) and TIME stays text
+/// (SQL_TIME_STRUCT has no fractional seconds). UNIQUEIDENTIFIER comes as a 16-byte SQLGUID and is
+/// formatted here rather than sent as 72 bytes of UTF-16.
+[[nodiscard]] SQLSMALLINT nativeCType(SQLSMALLINT dataType, ColumnDataType storage) noexcept {
+    if (dataType == SQL_GUID) {
+        return SQL_C_GUID;
+    }
+    switch (storage) {
+        case ColumnDataType::Int64:
+            return SQL_C_SBIGINT;
+        case ColumnDataType::Double:
+            return dataType == SQL_REAL ? SQL_C_WCHAR : SQL_C_DOUBLE;
+        case ColumnDataType::Bit:
+            return SQL_C_BIT;
+        case ColumnDataType::Date:
+            return SQL_C_TYPE_DATE;
+        case ColumnDataType::Timestamp:
+            return SQL_C_TYPE_TIMESTAMP;
+        case ColumnDataType::Binary:
+            return SQL_C_BINARY;
+        default:
+            return SQL_C_WCHAR;
+    }
+}
+
+[[nodiscard]] ColumnBinding planColumnBinding(SQLHSTMT stmt, SQLUSMALLINT column, SQLSMALLINT dataType, ColumnDataType storage) {
+    ColumnBinding binding{.cType = nativeCType(dataType, storage)};
+    switch (binding.cType) {
+        case SQL_C_SBIGINT:
+            binding.elementBytes = sizeof(SQLBIGINT);
+            return binding;
+        case SQL_C_DOUBLE:
+            binding.elementBytes = sizeof(SQLDOUBLE);
+            return binding;
+        case SQL_C_BIT:
+            binding.elementBytes = sizeof(SQLCHAR);
+            return binding;
+        case SQL_C_TYPE_DATE:
+            binding.elementBytes = sizeof(SQL_DATE_STRUCT);
+            return binding;
+        case SQL_C_TYPE_TIMESTAMP:
+            binding.elementBytes = sizeof(SQL_TIMESTAMP_STRUCT);
+            return binding;
+        case SQL_C_GUID:
+            binding.elementBytes = sizeof(SQLGUID);
+            return binding;
+        default:
+            break;
+    }
+
+    switch (dataType) {
+        case SQL_LONGVARCHAR:
+        case SQL_WLONGVARCHAR:
+        case SQL_LONGVARBINARY:
+        case SS_TYPE_VARIANT:
+        case SS_TYPE_UDT:
+        case SS_TYPE_XML:
+            return binding;
+        default:
+            break;
+    }
+
+    SQLLEN displaySize = 0;
+    SQLRETURN ret = SQLColAttributeW(stmt, column, SQL_DESC_DISPLAY_SIZE, nullptr, 0, nullptr, &displaySize);
+    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+        return binding;
+    }
+    if (binding.cType == SQL_C_BINARY) {
+        // Two hex digits per byte; bound within the same per-cell byte budget as text
+        const size_t bytes = static_cast<size_t>((std::max)(displaySize, SQLLEN{0})) / 2;
+        if (bytes > 0 && bytes <= MAX_BOUND_COLUMN_CHARS * sizeof(SQLWCHAR)) {
+            binding.elementBytes = bytes;
+        }
+        return binding;
+    }
+    // (MAX) columns report 0 or a huge size
+    if (displaySize <= 0 || displaySize > MAX_BOUND_COLUMN_CHARS) {
+        return binding;
+    }
+    binding.elementBytes = (static_cast<size_t>(displaySize) + 1) * sizeof(SQLWCHAR);
+    return binding;
+}
+
+/// Length of a WCHAR cell: the byte indicator when available, otherwise scan for the terminator.
+[[nodiscard]] size_t wcharCellLength(const SQLWCHAR* cell, size_t capacityChars, SQLLEN indicator) {
+    if (indicator >= 0) {
+        return (std::min)(static_cast<size_t>(indicator) / sizeof(SQLWCHAR), capacityChars - 1);
+    }
+    size_t len = 0;
+    while (len < capacityChars - 1 && cell[len] != 0) {
+        ++len;
+    }
+    return len;
+}
+
+/// Append a UNIQUEIDENTIFIER as the upper-case text SQL Server prints for it (Data1-3 are native integers)
+void appendGuid(ColumnData& column, const SQLGUID& guid) {
+    constexpr char DIGITS[] = "0123456789ABCDEF";
+    std::array<char, 36> text{};
+    size_t pos = 0;
+    const auto put = [&](uint32_t value, int digits) {
+        for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+            text[pos++] = DIGITS[(value >> shift) & 0xF];
+        }
+    };
+    put(guid.Data1, 8);
+    text[pos++] = '-';
+    put(guid.Data2, 4);
+    text[pos++] = '-';
+    put(guid.Data3, 4);
+    text[pos++] = '-';
+    for (size_t i = 0; i < 8; ++i) {
+        if (i == 2) {
+            text[pos++] = '-';
+        }
+        put(guid.Data4[i], 2);
+    }
+    column.appendText({text.data(), text.size()});
+}
+
+/// Append one non-null cell delivered in a binary C type (memcpy: bound buffers are not necessarily aligned).
+void appendNativeCell(ColumnData& column, SQLSMALLINT cType, const unsigned char* cell) {
+    switch (cType) {
+        case SQL_C_SBIGINT: {
+            SQLBIGINT value = 0;
+            std::memcpy(&value, cell, sizeof(value));
+            column.appendInt64(value);
+            break;
+        }
+        case SQL_C_DOUBLE: {
+            SQLDOUBLE value = 0.0;
+            std::memcpy(&value, cell, sizeof(value));
+            column.appendDouble(value);
+            break;
+        }
+        case SQL_C_BIT:
+            column.appendBit(*cell != 0);
+            break;
+        case SQL_C_TYPE_DATE: {
+            SQL_DATE_STRUCT value{};
+            std::memcpy(&value, cell, sizeof(value));
+            column.appendDateTime({.year = value.year, .month = static_cast<uint8_t>(value.month), .day = static_cast<uint8_t>(value.day)});
+            break;
+        }
+        case SQL_C_TYPE_TIMESTAMP: {
+            SQL_TIMESTAMP_STRUCT value{};
+            std::memcpy(&value, cell, sizeof(value));
+            column.appendDateTime({.year = value.year,
+                                   .month = static_cast<uint8_t>(value.month),
+                                   .day = static_cast<uint8_t>(value.day),
+                                   .hour = static_cast<uint8_t>(value.hour),
+                                   .minute = static_cast<uint8_t>(value.minute),
+                                   .second = static_cast<uint8_t>(value.second),
+                                   .fraction = value.fraction});
+            break;
+        }
+        case SQL_C_GUID: {
+            SQLGUID value{};
+            std::memcpy(&value, cell, sizeof(value));
+            appendGuid(column, value);
+            break;
+        }
+        default:
+            column.appendNull();
+            break;
+    }
+}
+
+/// Append every diagnostic record on `handle` to `messages`. The UTF-16 buffer belongs to the thread and grows to the
+/// longest message seen, so collecting allocates only when the message arena grows.
+void collectDiagnostics(SQLSMALLINT handleType, SQLHANDLE handle, ServerMessages& messages) {
+    constexpr size_t INITIAL_MESSAGE_CHARS = 1024;
+    thread_local std::vector<SQLWCHAR> text(INITIAL_MESSAGE_CHARS);
+    std::array<SQLWCHAR, 6> sqlState{};
+    for (SQLSMALLINT record = 1;; ++record) {
+        SQLINTEGER nativeError = 0;
+        SQLSMALLINT length = 0;
+        SQLRETURN ret = SQLGetDiagRecW(handleType, handle, record, sqlState.data(), &nativeError, text.data(), static_cast<SQLSMALLINT>(text.size()), &length);
+        if (ret == SQL_SUCCESS_WITH_INFO && static_cast<size_t>(length) >= text.size()) {
+            // PRINT output runs to 8000 characters; read a longer record again into a buffer that fits it
+            text.resize(static_cast<size_t>(length) + 1);
+            ret = SQLGetDiagRecW(handleType, handle, record, sqlState.data(), &nativeError, text.data(), static_cast<SQLSMALLINT>(text.size()), &length);
+        }
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            return;  // SQL_NO_DATA past the last record
+        }
+        messages.add(toUtf16(text.data(), (std::min)(static_cast<size_t>(length), text.size() - 1)), nativeError, toUtf16(sqlState.data(), 5));
+    }
+}
+
+/// Destination of the fetch loops: either the whole result (execute) or a reusable batch handed to a sink (executeStreaming).
+struct FetchTarget {
+    ResultSet& rows;
+    RowBatchSink* sink = nullptr;
+    size_t batchRows = 0;
+    size_t deliveredRows = 0;
+    size_t maxRows = 0;                                 ///< 0 = no limit
+    size_t lobPreviewChars = 0;                         ///< 0 = read LOB cells whole
+    size_t lobPreviewBytes = 0;                         ///< Same budget for VARBINARY(MAX)/IMAGE cells, in raw bytes
+    const std::atomic<bool>* cancelToken = nullptr;     ///< Caller's token (ExecuteOptions::cancelRequested)
+    const std::atomic<bool>* driverCancel = nullptr;    ///< Raised by SQLServerDriver::cancel()
+    bool stopped = false;
+    bool truncated = false;  ///< Rows past maxRows were left unread
+    bool cancelled = false;
+    std::chrono::steady_clock::duration convertTime{};  ///< Spent copying bound rowsets into columns
+    uint64_t convertedBytes = 0;                         ///< UTF-8 bytes produced from UTF-16 cells
+
+    /// Hand the buffered rows to the sink once a batch is full (or whenever any are buffered with `force`).
+    /// Returns false once the sink has asked to stop.
+    [[nodiscard]] bool flush(bool force) {
+        if (sink == nullptr) {
+            return true;
+        }
+        const size_t buffered = rows.rowCount();
+        if (buffered == 0 || (!force && buffered < batchRows)) {
+            return !stopped;
+        }
+        deliveredRows += buffered;
+        stopped = !sink->onBatch(rows);
+        rows.clearRows();
+        return !stopped;
+    }
+
+    [[nodiscard]] size_t totalRows() const noexcept { return deliveredRows + rows.rowCount(); }
+
+    /// Keep the records a SQL_SUCCESS_WITH_INFO fetch left on the statement; the next call replaces them
+    void collectInfo(SQLHSTMT stmt, SQLRETURN ret) {
+        if (ret == SQL_SUCCESS_WITH_INFO) [[unlikely]] {
+            collectDiagnostics(SQL_HANDLE_STMT, stmt, rows.messages);
+        }
+    }
+
+    /// How many of `fetched` new rows still fit under maxRows; any left over mark the result truncated
+    [[nodiscard]] size_t admit(size_t fetched) noexcept {
+        if (maxRows == 0) {
+            return fetched;
+        }
+        const size_t room = maxRows - (std::min)(maxRows, totalRows());
+        truncated = truncated || fetched > room;
+        return (std::min)(fetched, room);
+    }
+
+    /// Polled before every fetch, so a cancel lands within one rowset even when SQLCancel finds nothing executing
+    [[nodiscard]] bool cancelRequested() noexcept {
+        cancelled = cancelled || (cancelToken != nullptr && cancelToken->load(std::memory_order_acquire)) || (driverCancel != nullptr && driverCancel->load(std::memory_order_acquire));
+        return cancelled;
+    }
+};
+
+/// Block-cursor fetch: bind every column into column-wise arrays (native C types or SQL_C_WCHAR) and fetch a rowset per SQLFetch.
+/// Returns false (without consuming any rows) if the driver rejects the rowset attributes.
+[[nodiscard]] bool fetchRowsBound(SQLHSTMT stmt, const std::vector<ColumnBinding>& bindings, size_t requestedRowsetSize, FetchTarget& target) {
+    ResultSet& result = target.rows;
+    size_t bytesPerRow = 0;
+    for (const auto& binding : bindings) {
+        bytesPerRow += binding.elementBytes + sizeof(SQLLEN);
+    }
+    if (target.sink != nullptr) {
+        // A rowset never spans two batches
+        requestedRowsetSize = (std::min)(requestedRowsetSize, target.batchRows);
+    }
+    if (target.maxRows > 0) {
+        // One row past the limit is enough to tell whether the result was cut short
+        requestedRowsetSize = (std::min)(requestedRowsetSize, target.maxRows + 1);
+    }
+    const size_t rowsetSize = std::clamp<size_t>((std::min)(requestedRowsetSize, MAX_BOUND_BUFFER_BYTES / bytesPerRow), 1, SQLServerDriver::MAX_FETCH_ROWSET_SIZE);
+
+    // Rowset buffers come from the thread's scratch block, already faulted in by earlier queries
+    ScratchArena::Lease scratch;
+    struct BoundColumn {
+        explicit BoundColumn(std::pmr::memory_resource* resource) : buffer(resource), indicators(resource) {}
+        std::pmr::vector<unsigned char> buffer;
+        std::pmr::vector<SQLLEN> indicators;
+    };
+    std::vector<BoundColumn> bound;
+    bound.reserve(bindings.size());
+    for (size_t col = 0; col < bindings.size(); ++col) {
+        bound.emplace_back(scratch.resource());
+    }
+
+    SQLULEN rowsFetched = 0;
+    std::pmr::vector<SQLUSMALLINT> rowStatus(rowsetSize, scratch.resource());
+
+    // Buffers are local: detach them from the statement before returning
+    const auto resetRowset = [stmt] {
+        SQLFreeStmt(stmt, SQL_UNBIND);
+        SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE, toSqlPointer(1), 0);
+        SQLSetStmtAttr(stmt, SQL_ATTR_ROW_STATUS_PTR, nullptr, 0);
+        SQLSetStmtAttr(stmt, SQL_ATTR_ROWS_FETCHED_PTR, nullptr, 0);
+    };
+
+    SQLRETURN ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_BIND_TYPE, toSqlPointer(SQL_BIND_BY_COLUMN), 0);
+    if (ret == SQL_SUCCESS) {
+        ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE, toSqlPointer(rowsetSize), 0);
+    }
+    if (ret != SQL_SUCCESS) {
+        // SQL_SUCCESS_WITH_INFO means the driver substituted another rowset size; fall back to the per-cell path
+        resetRowset();
+        return false;
+    }
+    SQLSetStmtAttr(stmt, SQL_ATTR_ROW_STATUS_PTR, rowStatus.data(), 0);
+    SQLSetStmtAttr(stmt, SQL_ATTR_ROWS_FETCHED_PTR, &rowsFetched, 0);
+
+    for (size_t col = 0; col < bound.size(); ++col) {
+        auto& column = bound[col];
+        const auto& binding = bindings[col];
+        column.buffer.resize(binding.elementBytes * rowsetSize);
+        column.indicators.resize(rowsetSize);
+        ret = SQLBindCol(stmt, static_cast<SQLUSMALLINT>(col + 1), binding.cType, column.buffer.data(), static_cast<SQLLEN>(binding.elementBytes), column.indicators.data());
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            resetRowset();
+            return false;
+        }
+    }
+
+    result.fetchStats.rowsetSize = rowsetSize;
+    // The handle is reused by later executes, so the rowset attributes must not keep pointing at these buffers
+    try {
+        while (!target.cancelRequested() && ((ret = SQLFetch(stmt)) == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO)) {
+            target.collectInfo(stmt, ret);
+            const auto convertStart = std::chrono::steady_clock::now();
+            const size_t admitted = target.admit(rowsFetched);
+            for (size_t col = 0; col < bound.size(); ++col) {
+                const auto& column = bound[col];
+                const auto& binding = bindings[col];
+                auto& data = result.columnData[col];
+                // Column-major copy out of the rowset keeps each destination column hot in cache
+                for (size_t row = 0; row < admitted; ++row) {
+                    const SQLLEN indicator = column.indicators[row];
+                    if (rowStatus[row] == SQL_ROW_ERROR || indicator == SQL_NULL_DATA) {
+                        data.appendNull();
+                        continue;
+                    }
+                    const unsigned char* cell = column.buffer.data() + row * binding.elementBytes;
+                    if (binding.cType == SQL_C_BINARY) {
+                        const size_t length = indicator >= 0 ? (std::min)(static_cast<size_t>(indicator), binding.elementBytes) : binding.elementBytes;
+                        data.appendBinary({reinterpret_cast<const char*>(cell), length});
+                        continue;
+                    }
+                    if (binding.cType != SQL_C_WCHAR) {
+                        appendNativeCell(data, binding.cType, cell);
+                        continue;
+                    }
+                    const auto* text = reinterpret_cast<const SQLWCHAR*>(cell);
+                    target.convertedBytes += data.appendUtf16(toUtf16(text, wcharCellLength(text, binding.elementBytes / sizeof(SQLWCHAR), indicator)));
+                }
+                // Batches handed to a sink are folded where they are appended to a result
+                if (target.sink == nullptr) {
+                    data.updateStats();
+                }
+            }
+            target.convertTime += std::chrono::steady_clock::now() - convertStart;
+            if (!target.flush(false) || target.truncated) {
+                break;
+            }
+        }
+    } catch (...) {
+        resetRowset();
+        throw;
+    }
+
+    resetRowset();
+    return true;
+}
+
+/// Read one SQL_C_BINARY cell with SQLGetData into `buffer`, growing it until the value fits. With `previewBytes` set,
+/// a longer value keeps only its start and is listed in the result's lobPreviews.
+void appendBinaryByGetData(SQLHSTMT stmt, SQLUSMALLINT col, std::pmr::vector<unsigned char>& buffer, size_t previewBytes, FetchTarget& target) {
+    auto& column = target.rows.columnData[col - 1];
+    const size_t firstRead = previewBytes > 0 ? previewBytes : buffer.size();
+    size_t length = 0;
+    SQLLEN indicator = 0;
+    for (size_t room = firstRead;; room = buffer.size() - length) {
+        const SQLRETURN ret = SQLGetData(stmt, col, SQL_C_BINARY, buffer.data() + length, static_cast<SQLLEN>(room), &indicator);
+        if ((ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) || indicator == SQL_NULL_DATA) {
+            if (length == 0) {
+                column.appendNull();
+                return;
+            }
+            break;  // Keep what arrived before a failed continuation read
+        }
+        // Later calls report the bytes left, not the total
+        if (ret == SQL_SUCCESS || (indicator != SQL_NO_TOTAL && static_cast<size_t>(indicator) <= room)) {
+            length += indicator >= 0 ? (std::min)(static_cast<size_t>(indicator), room) : room;
+            break;
+        }
+        length += room;
+        if (previewBytes > 0) {
+            target.rows.lobPreviews.push_back({.row = column.size(), .column = col - 1u, .totalBytes = indicator == SQL_NO_TOTAL ? -1 : static_cast<int64_t>(indicator)});
+            break;
+        }
+        buffer.resize(indicator == SQL_NO_TOTAL ? buffer.size() * 2 : length + static_cast<size_t>(indicator) - room);
+    }
+    column.appendBinary({reinterpret_cast<const char*>(buffer.data()), length});
+}
+
+/// Row-at-a-time fetch with SQLGetData per cell (required for LOB/MAX columns).
+void fetchRowsByGetData(SQLHSTMT stmt, const std::vector<ColumnBinding>& bindings, FetchTarget& target) {
+    ResultSet& result = target.rows;
+    const auto numCols = static_cast<SQLSMALLINT>(result.columnData.size());
+
+    // Dynamic buffer for large column values (Unicode - SQLWCHAR is 2 bytes)
+    constexpr size_t INITIAL_BUFFER_CHARS = 4096;
+    ScratchArena::Lease scratch;
+    std::pmr::vector<SQLWCHAR> buffer(INITIAL_BUFFER_CHARS, scratch.resource());
+    // One read per previewed LOB cell; the rest of the value is skipped by moving on to the next column
+    std::pmr::vector<SQLWCHAR> previewBuffer(target.lobPreviewChars > 0 ? target.lobPreviewChars + 1 : 0, scratch.resource());
+    // Binary cells have no terminator; sized for a preview and grown for whole values
+    std::pmr::vector<unsigned char> binaryBuffer((std::max)(INITIAL_BUFFER_CHARS * sizeof(SQLWCHAR), target.lobPreviewBytes), scratch.resource());
+    // Large enough for any native C type (SQL_TIMESTAMP_STRUCT is the widest)
+    alignas(8) std::array<unsigned char, 32> nativeBuffer{};
+    SQLLEN indicator = 0;
+    SQLRETURN ret = SQL_SUCCESS;
+
+    while (!target.cancelRequested() && ((ret = SQLFetch(stmt)) == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO)) {
+        target.collectInfo(stmt, ret);
+        if (target.admit(1) == 0) {
+            break;
+        }
+        for (SQLSMALLINT i = 1; i <= numCols; ++i) {
+            auto& column = result.columnData[static_cast<size_t>(i - 1)];
+            const auto cType = bindings[static_cast<size_t>(i - 1)].cType;
+
+            if (cType == SQL_C_BINARY) {
+                const bool unbounded = bindings[static_cast<size_t>(i - 1)].elementBytes == 0;
+                appendBinaryByGetData(stmt, static_cast<SQLUSMALLINT>(i), binaryBuffer, unbounded ? target.lobPreviewBytes : 0, target);
+                continue;
+            }
+            if (cType != SQL_C_WCHAR) {
+                ret = SQLGetData(stmt, static_cast<SQLUSMALLINT>(i), cType, nativeBuffer.data(), static_cast<SQLLEN>(nativeBuffer.size()), &indicator);
+                if ((ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) && indicator != SQL_NULL_DATA) {
+                    appendNativeCell(column, cType, nativeBuffer.data());
+                } else {
+                    column.appendNull();
+                }
+                continue;
+            }
+
+            if (!previewBuffer.empty() && bindings[static_cast<size_t>(i - 1)].elementBytes == 0) {
+                ret = SQLGetData(stmt, static_cast<SQLUSMALLINT>(i), SQL_C_WCHAR, previewBuffer.data(), static_cast<SQLLEN>(previewBuffer.size() * sizeof(SQLWCHAR)), &indicator);
+                if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+                    column.appendNull();
+                } else if (indicator == SQL_NULL_DATA) {
+                    column.appendNull();
+                } else if (ret == SQL_SUCCESS_WITH_INFO && (indicator == SQL_NO_TOTAL || indicator > static_cast<SQLLEN>(target.lobPreviewChars * sizeof(SQLWCHAR)))) {
+                    size_t chars = target.lobPreviewChars;
+                    // Never end a preview on the first half of a surrogate pair
+                    if (previewBuffer[chars - 1] >= 0xD800 && previewBuffer[chars - 1] <= 0xDBFF) {
+                        --chars;
+                    }
+                    result.lobPreviews.push_back({.row = column.size(), .column = static_cast<size_t>(i - 1), .totalBytes = indicator == SQL_NO_TOTAL ? -1 : static_cast<int64_t>(indicator)});
+                    target.convertedBytes += column.appendUtf16(toUtf16(previewBuffer.data(), chars));
+                } else {
+                    target.convertedBytes += column.appendUtf16(toUtf16(previewBuffer.data(), wcharCellLength(previewBuffer.data(), previewBuffer.size(), indicator)));
+                }
+                continue;
+            }
+
+            // Use SQL_C_WCHAR to get Unicode data
+            ret = SQLGetData(stmt, static_cast<SQLUSMALLINT>(i), SQL_C_WCHAR, buffer.data(), static_cast<SQLLEN>(buffer.size() * sizeof(SQLWCHAR)), &indicator);
+            if (indicator == SQL_NULL_DATA) {
+                column.appendNull();
+            } else if (ret == SQL_SUCCESS_WITH_INFO && indicator > static_cast<SQLLEN>((buffer.size() - 1) * sizeof(SQLWCHAR))) {
+                // Data was truncated, need a larger buffer
+                // indicator is in bytes for SQL_C_WCHAR
+                size_t requiredChars = (static_cast<size_t>(indicator) / sizeof(SQLWCHAR)) + 1;
+                std::vector<SQLWCHAR> largeBuffer(requiredChars);
+                // Copy already retrieved data
+                size_t alreadyReadChars = buffer.size() - 1;
+                std::copy(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(alreadyReadChars), largeBuffer.begin());
+                // Get remaining data
+                SQLLEN remainingIndicator = 0;
+                ret = SQLGetData(stmt, static_cast<SQLUSMALLINT>(i), SQL_C_WCHAR, largeBuffer.data() + alreadyReadChars, static_cast<SQLLEN>((requiredChars - alreadyReadChars) * sizeof(SQLWCHAR)),
+                                 &remainingIndicator);
+                // The first call's indicator is the full length, so only a failed second read needs the NUL scan
+                const SQLLEN totalBytes = (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) ? indicator : SQL_NO_TOTAL;
+                target.convertedBytes += column.appendUtf16(toUtf16(largeBuffer.data(), wcharCellLength(largeBuffer.data(), largeBuffer.size(), totalBytes)));
+            } else if (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) {
+                // SQL_NO_TOTAL (negative) falls back to the NUL scan
+                target.convertedBytes += column.appendUtf16(toUtf16(buffer.data(), wcharCellLength(buffer.data(), buffer.size(), indicator)));
+            } else {
+                // Error getting data - add empty value and continue
+                column.appendNull();
+            }
+        }
+        if (!target.flush(false)) {
+            break;
+        }
+    }
+}
+
+}  // namespace
+
 SQLServerDriver::SQLServerDriver() {
     SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &m_env);
     if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
@@ -51,111 +570,636 @@ bool SQLServerDriver::connect(std::string_view connectionString) {
     constexpr SQLUINTEGER loginTimeout = 30;
     SQLSetConnectAttr(m_dbc, SQL_ATTR_LOGIN_TIMEOUT, toSqlPointer(loginTimeout), 0);
     SQLSetConnectAttr(m_dbc, SQL_ATTR_CONNECTION_TIMEOUT, toSqlPointer(loginTimeout), 0);
+    if (m_packetSize != 0) {
+        // Only takes effect before the login; larger packets mean fewer round trips for bulk fetches over high latency
+        SQLSetConnectAttr(m_dbc, SQL_ATTR_PACKET_SIZE, toSqlPointer(static_cast<SQLUINTEGER>(m_packetSize)), 0);
+    }
 
     auto wideConnStr = utf8ToWide(connectionString);
     SQLRETURN ret = SQLDriverConnectW(m_dbc, nullptr, toSqlWchar(wideConnStr.data()), SQL_NTS, outConnectionString.data(), static_cast<SQLSMALLINT>(outConnectionString.size()),
                                       &outConnectionStringLen, SQL_DRIVER_NOPROMPT);
 
     if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
+        // getLastError may be reading on another thread
+        std::lock_guard lock(m_executeMutex);
         storeODBCDiagnosticMessage(ret, SQL_HANDLE_DBC, m_dbc);
         return false;
     }
 
+    m_connectionString = connectionString;
     m_connected.store(true, std::memory_order_release);
     return true;
 }
 
+bool SQLServerDriver::reconnect() {
+    if (m_connectionString.empty()) {
+        return false;
+    }
+    const auto connectionString = m_connectionString;
+    disconnect();
+    return connect(connectionString);
+}
+
 void SQLServerDriver::disconnect() {
     std::lock_guard lock(m_executeMutex);
     auto stmt = m_stmt.exchange(SQL_NULL_HSTMT, std::memory_order_acq_rel);
     if (stmt != SQL_NULL_HSTMT) {
         SQLFreeHandle(SQL_HANDLE_STMT, stmt);
     }
+    releasePreparedStatements();
     if (m_connected.exchange(false, std::memory_order_acq_rel)) {
         SQLDisconnect(m_dbc);
     }
 }
 
-std::string SQLServerDriver::convertSQLTypeToDisplayName(SQLSMALLINT dataType) {
+bool SQLServerDriver::isAlive() const noexcept {
+    if (!isConnected()) {
+        return false;
+    }
+    SQLUINTEGER dead = SQL_CD_TRUE;
+    SQLRETURN ret = SQLGetConnectAttr(m_dbc, SQL_ATTR_CONNECTION_DEAD, &dead, 0, nullptr);
+    return (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) && dead == SQL_CD_FALSE;
+}
+
+SqlType SQLServerDriver::describeSqlType(SQLSMALLINT dataType, SQLULEN columnSize, SQLSMALLINT decimalDigits) noexcept {
+    // SMALLDATETIME is described as 16 characters without fractions, DATETIME as 23 with 3; DATETIME2 otherwise
+    constexpr SQLULEN SMALLDATETIME_CHARS = 16;
+    constexpr SQLULEN DATETIME_CHARS = 23;
     switch (dataType) {
         case SQL_CHAR:
+            return SqlType::Char;
         case SQL_VARCHAR:
         case SQL_LONGVARCHAR:
-            return "VARCHAR";
+            return SqlType::VarChar;
         case SQL_WCHAR:
+            return SqlType::NChar;
         case SQL_WVARCHAR:
         case SQL_WLONGVARCHAR:
-            return "NVARCHAR";
+            return SqlType::NVarChar;
+        case SQL_BINARY:
+            return SqlType::Binary;
+        case SQL_VARBINARY:
+        case SQL_LONGVARBINARY:
+            return SqlType::VarBinary;
+        case SQL_GUID:
+            return SqlType::UniqueIdentifier;
+        case SS_TYPE_XML:
+            return SqlType::Xml;
+        case SS_TYPE_VARIANT:
+            return SqlType::Variant;
+        case SQL_TINYINT:
+            return SqlType::TinyInt;
+        case SQL_SMALLINT:
+            return SqlType::SmallInt;
         case SQL_INTEGER:
-            return "INT";
+            return SqlType::Int;
         case SQL_BIGINT:
-            return "BIGINT";
-        case SQL_SMALLINT:
-            return "SMALLINT";
+            return SqlType::BigInt;
+        case SQL_REAL:
+            return SqlType::Real;
         case SQL_FLOAT:
         case SQL_DOUBLE:
-            return "FLOAT";
+            return SqlType::Float;
         case SQL_DECIMAL:
         case SQL_NUMERIC:
-            return "DECIMAL";
+            return SqlType::Decimal;
+        case SQL_BIT:
+            return SqlType::Bit;
         case SQL_TYPE_DATE:
-            return "DATE";
+            return SqlType::Date;
         case SQL_TYPE_TIME:
-            return "TIME";
+        case SS_TYPE_TIME2:
+            return SqlType::Time;
         case SQL_TYPE_TIMESTAMP:
-            return "DATETIME";
+            if (columnSize == SMALLDATETIME_CHARS && decimalDigits == 0) {
+                return SqlType::SmallDateTime;
+            }
+            return columnSize == DATETIME_CHARS && decimalDigits == 3 ? SqlType::DateTime : SqlType::DateTime2;
+        case SS_TYPE_DATETIMEOFFSET:
+            return SqlType::DateTimeOffset;
+        default:
+            return SqlType::Unknown;
+    }
+}
+
+ColumnDataType SQLServerDriver::convertSQLTypeToStorageType(SQLSMALLINT dataType) noexcept {
+    // DECIMAL/NUMERIC stay as text to preserve full precision
+    switch (dataType) {
+        case SQL_TINYINT:
+        case SQL_SMALLINT:
+        case SQL_INTEGER:
+        case SQL_BIGINT:
+            return ColumnDataType::Int64;
+        case SQL_REAL:
+        case SQL_FLOAT:
+        case SQL_DOUBLE:
+            return ColumnDataType::Double;
         case SQL_BIT:
-            return "BIT";
+            return ColumnDataType::Bit;
+        case SQL_TYPE_DATE:
+            return ColumnDataType::Date;
+        case SQL_TYPE_TIME:
+            return ColumnDataType::Time;
+        case SQL_TYPE_TIMESTAMP:
+            return ColumnDataType::Timestamp;
+        case SQL_BINARY:
+        case SQL_VARBINARY:
+        case SQL_LONGVARBINARY:
+            return ColumnDataType::Binary;
         default:
-            return "UNKNOWN";
+            return ColumnDataType::Text;
     }
 }
 
 ResultSet SQLServerDriver::execute(std::string_view sql) {
-    std::lock_guard lock(m_executeMutex);
-    ResultSet result;
+    return execute(sql, ExecuteOptions{});
+}
+
+ResultSet SQLServerDriver::execute(std::string_view sql, const ExecuteOptions& options) {
+    StreamSummary summary;
+    return executeStatement(sql, nullptr, 0, summary, options);
+}
 
+StreamSummary SQLServerDriver::executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows) {
+    return executeStreaming(sql, sink, batchRows, ExecuteOptions{});
+}
+
+StreamSummary SQLServerDriver::executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows, const ExecuteOptions& options) {
+    StreamSummary summary;
+    auto result = executeStatement(sql, &sink, (std::max)(batchRows, size_t{1}), summary, options);
+    summary.columns = std::move(result.columns);
+    summary.affectedRows = result.affectedRows;
+    summary.executionTimeMs = result.executionTimeMs;
+    summary.fetchStats = result.fetchStats;
+    summary.messages = std::move(result.messages);
+    return summary;
+}
+
+SQLHSTMT SQLServerDriver::beginStatement(std::string_view sql, size_t maxRows) {
     if (!m_connected.load(std::memory_order_acquire)) [[unlikely]] {
         throw std::runtime_error("Not connected to database");
     }
+    m_cancelRequested.store(false, std::memory_order_release);
+    m_messages.clear();
 
+    TraceScope prepare("driver.prepare");
+    // The handle outlives each execute: closing its cursor and dropping bindings is much cheaper than
+    // SQLFreeHandle + SQLAllocHandle + attribute setup, which chatty metadata workloads pay hundreds of times.
+    // It stays published in m_stmt throughout, so cancel() always has the current statement.
+    SQLHSTMT stmt = m_stmt.load(std::memory_order_acquire);
+    if (stmt != SQL_NULL_HSTMT) {
+        SQLRETURN ret = SQLFreeStmt(stmt, SQL_CLOSE);
+        if (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) [[likely]] {
+            SQLFreeStmt(stmt, SQL_UNBIND);
+            SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+        } else {
+            // Unusable handle; start over with a fresh one
+            m_stmt.store(SQL_NULL_HSTMT, std::memory_order_release);
+            SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+            stmt = SQL_NULL_HSTMT;
+        }
+    }
+    if (stmt == SQL_NULL_HSTMT) {
+        SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, m_dbc, &stmt);
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
+            storeODBCDiagnosticMessage(ret, SQL_HANDLE_DBC, m_dbc);
+            throwLastError();
+        }
+        static auto& allocations = MetricsRegistry::instance().counter("driver.statement_allocations");
+        allocations.add();
+
+        // Set query timeout to prevent indefinite hangs
+        constexpr SQLULEN queryTimeout = 300;  // 5 minutes
+        SQLSetStmtAttr(stmt, SQL_ATTR_QUERY_TIMEOUT, toSqlPointer(queryTimeout), 0);
+
+        // Publish new stmt so cancel() can see it immediately
+        m_stmt.store(stmt, std::memory_order_release);
+        m_stmtMaxRows = 0;
+    }
+    // Statement attribute, so it sticks to the reused handle until changed. One extra row reveals truncation.
+    if (const SQLULEN cap = maxRows > 0 ? static_cast<SQLULEN>(maxRows) + 1 : 0; cap != m_stmtMaxRows) {
+        // A driver that rejects it is still stopped by the fetch loop
+        SQLRETURN ret = SQLSetStmtAttr(stmt, SQL_ATTR_MAX_ROWS, toSqlPointer(cap), 0);
+        if (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) {
+            m_stmtMaxRows = cap;
+        }
+    }
+
+    auto wideSql = utf8ToWide(sql);
+    prepare.end();
+
+    TraceScope exec("driver.exec");
+    static auto& execLatency = MetricsRegistry::instance().histogram("driver.exec_latency_us");
+    ScopedLatency timed(execLatency);
+    SQLRETURN ret = SQLExecDirectW(stmt, toSqlWchar(wideSql.data()), SQL_NTS);
+    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO && ret != SQL_NO_DATA) [[unlikely]] {
+        storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+        throwLastError();
+    }
+    if (ret != SQL_SUCCESS) {
+        // PRINT and STATISTICS output before the first result; readResult() hands it to that result
+        collectDiagnostics(SQL_HANDLE_STMT, stmt, m_messages);
+    }
+    return stmt;
+}
+
+ResultSet SQLServerDriver::executeStatement(std::string_view sql, RowBatchSink* sink, size_t batchRows, StreamSummary& summary, const ExecuteOptions& options) {
+    std::lock_guard lock(m_executeMutex);
+    // A request cancelled before its statement started never reaches the server (cancel() only covers a running one)
+    if (isCancelRequested(options.cancelRequested)) [[unlikely]] {
+        m_lastError = "Operation canceled";
+        m_lastSqlState = "HY008";
+        throwLastError();
+    }
     const auto startTime = std::chrono::high_resolution_clock::now();
+    auto stmt = beginStatement(sql, options.maxRows);
+    auto result = readResult(stmt, sink, batchRows, summary, startTime, options);
+    if (!summary.stopped && !summary.truncated) {
+        drainMessages(stmt, result.messages);
+    }
+    return result;
+}
 
-    auto oldStmt = m_stmt.exchange(SQL_NULL_HSTMT, std::memory_order_acq_rel);
-    if (oldStmt != SQL_NULL_HSTMT) {
-        SQLFreeHandle(SQL_HANDLE_STMT, oldStmt);
+void SQLServerDriver::drainMessages(SQLHSTMT stmt, ServerMessages& messages) {
+    while (true) {
+        const SQLRETURN ret = SQLMoreResults(stmt);
+        if (ret != SQL_SUCCESS) {
+            // An error in a later statement does not undo the result already read: it is reported with the messages
+            collectDiagnostics(SQL_HANDLE_STMT, stmt, messages);
+        }
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            return;
+        }
+        SQLSMALLINT numCols = 0;
+        if (SQLNumResultCols(stmt, &numCols) != SQL_SUCCESS || numCols > 0) {
+            return;  // Left unread, as execute() always has; the next statement closes it
+        }
     }
+}
+
+std::vector<ResultSet> SQLServerDriver::executeMultiple(std::string_view sql) {
+    return collectResults(sql, false);
+}
+
+std::vector<ResultSet> SQLServerDriver::executeBatch(std::string_view sql) {
+    return collectResults(sql, true);
+}
+
+std::vector<ResultSet> SQLServerDriver::collectResults(std::string_view sql, bool keepRowCounts) {
+    std::lock_guard lock(m_executeMutex);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    auto stmt = beginStatement(sql);
+
+    std::vector<ResultSet> results;
+    while (true) {
+        StreamSummary summary;
+        auto result = readResult(stmt, nullptr, 0, summary, startTime);
+        // Row counts of DML between the SELECTs (absent under SET NOCOUNT ON) are not result sets. Their messages
+        // (including the STATISTICS output of the SELECT before them) stay with the previous result, or the next.
+        if (keepRowCounts || !result.columns.empty()) {
+            results.push_back(std::move(result));
+        } else {
+            (results.empty() ? m_messages : results.back().messages).append(result.messages);
+        }
+        SQLRETURN ret = SQLMoreResults(stmt);
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO && ret != SQL_NO_DATA) [[unlikely]] {
+            storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+            throwLastError();
+        }
+        if (ret != SQL_SUCCESS) {
+            collectDiagnostics(SQL_HANDLE_STMT, stmt, ret == SQL_NO_DATA && !results.empty() ? results.back().messages : m_messages);
+        }
+        if (ret == SQL_NO_DATA) {
+            break;
+        }
+        startTime = std::chrono::high_resolution_clock::now();
+    }
+    return results;
+}
+
+SQLHSTMT SQLServerDriver::preparedStatement(std::string_view sql) {
+    static auto& hits = MetricsRegistry::instance().counter("driver.prepared_hits");
+    static auto& misses = MetricsRegistry::instance().counter("driver.prepared_misses");
+    if (auto it = m_preparedIndex.find(sql); it != m_preparedIndex.end()) {
+        m_prepared.splice(m_prepared.begin(), m_prepared, it->second);
+        hits.add();
+        return it->second->stmt;
+    }
+    misses.add();
 
     SQLHSTMT stmt = SQL_NULL_HSTMT;
     SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, m_dbc, &stmt);
     if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
-        m_stmt.store(SQL_NULL_HSTMT, std::memory_order_release);
         storeODBCDiagnosticMessage(ret, SQL_HANDLE_DBC, m_dbc);
-        throw std::runtime_error(m_lastError);
+        throwLastError();
     }
-
-    // Publish new stmt so cancel() can see it immediately
-    m_stmt.store(stmt, std::memory_order_release);
-
-    // Set query timeout to prevent indefinite hangs
-    constexpr SQLULEN queryTimeout = 300;  // 5 minutes
+    constexpr SQLULEN queryTimeout = 300;  // Same bound as ad-hoc statements
     SQLSetStmtAttr(stmt, SQL_ATTR_QUERY_TIMEOUT, toSqlPointer(queryTimeout), 0);
 
     auto wideSql = utf8ToWide(sql);
-    ret = SQLExecDirectW(stmt, toSqlWchar(wideSql.data()), SQL_NTS);
-    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO && ret != SQL_NO_DATA) [[unlikely]] {
+    ret = SQLPrepareW(stmt, toSqlWchar(wideSql.data()), SQL_NTS);
+    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
         storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
-        throw std::runtime_error(m_lastError);
+        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        throwLastError();
+    }
+
+    if (m_prepared.size() >= PREPARED_CACHE_CAPACITY) {
+        m_preparedIndex.erase(m_prepared.back().sql);
+        SQLFreeHandle(SQL_HANDLE_STMT, m_prepared.back().stmt);
+        m_prepared.pop_back();
+    }
+    m_prepared.push_front(PreparedStatement{.sql = std::string(sql), .stmt = stmt});
+    m_preparedIndex.emplace(m_prepared.front().sql, m_prepared.begin());
+    return stmt;
+}
+
+void SQLServerDriver::releasePreparedStatements() noexcept {
+    m_preparedIndex.clear();
+    for (const auto& prepared : m_prepared) {
+        SQLFreeHandle(SQL_HANDLE_STMT, prepared.stmt);
     }
+    m_prepared.clear();
+}
+
+size_t SQLServerDriver::preparedStatementCount() const {
+    std::lock_guard lock(m_executeMutex);
+    return m_prepared.size();
+}
+
+ResultSet SQLServerDriver::executePrepared(std::string_view sql, const std::vector<SqlParameter>& params) {
+    std::lock_guard lock(m_executeMutex);
+    if (!m_connected.load(std::memory_order_acquire)) [[unlikely]] {
+        throw std::runtime_error("Not connected to database");
+    }
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    m_cancelRequested.store(false, std::memory_order_release);
+    m_messages.clear();
 
+    TraceScope prepare("driver.prepare");
+    SQLHSTMT stmt = preparedStatement(sql);
+
+    // Bound buffers must stay in place until SQLExecute returns
+    std::vector<std::wstring> texts(params.size());
+    std::vector<SQLBIGINT> integers(params.size());
+    std::vector<SQLDOUBLE> doubles(params.size());
+    std::vector<SQLLEN> indicators(params.size());
+    SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+    for (size_t i = 0; i < params.size(); ++i) {
+        const auto number = static_cast<SQLUSMALLINT>(i + 1);
+        SQLRETURN ret = SQL_SUCCESS;
+        if (const auto* text = std::get_if<std::string>(&params[i])) {
+            texts[i] = utf8ToWide(*text);
+            constexpr SQLULEN NVARCHAR_LIMIT = 4000;
+            const SQLULEN chars = texts[i].size();
+            indicators[i] = static_cast<SQLLEN>(chars * sizeof(SQLWCHAR));
+            ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_WCHAR, chars > NVARCHAR_LIMIT ? SQL_WLONGVARCHAR : SQL_WVARCHAR, (std::max)(chars, NVARCHAR_LIMIT), 0,
+                                   toSqlWchar(texts[i].data()), indicators[i], &indicators[i]);
+        } else if (const auto* integer = std::get_if<int64_t>(&params[i])) {
+            integers[i] = *integer;
+            ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_SBIGINT, SQL_BIGINT, 0, 0, &integers[i], 0, nullptr);
+        } else if (const auto* real = std::get_if<double>(&params[i])) {
+            doubles[i] = *real;
+            ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, &doubles[i], 0, nullptr);
+        } else {
+            indicators[i] = SQL_NULL_DATA;
+            ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_WCHAR, SQL_WVARCHAR, 1, 0, nullptr, 0, &indicators[i]);
+        }
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
+            storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+            throwLastError(std::format("Failed to bind parameter {}: ", number));
+        }
+    }
+    prepare.end();
+
+    m_activePrepared.store(stmt, std::memory_order_release);
+    try {
+        {
+            TraceScope exec("driver.exec");
+            static auto& execLatency = MetricsRegistry::instance().histogram("driver.exec_latency_us");
+            ScopedLatency timed(execLatency);
+            SQLRETURN ret = SQLExecute(stmt);
+            if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO && ret != SQL_NO_DATA) [[unlikely]] {
+                storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+                throwLastError();
+            }
+            if (ret != SQL_SUCCESS) {
+                collectDiagnostics(SQL_HANDLE_STMT, stmt, m_messages);
+            }
+        }
+        StreamSummary summary;
+        auto result = readResult(stmt, nullptr, 0, summary, startTime);
+        drainMessages(stmt, result.messages);
+        SQLFreeStmt(stmt, SQL_CLOSE);
+        m_activePrepared.store(SQL_NULL_HSTMT, std::memory_order_release);
+        return result;
+    } catch (...) {
+        // Leave the handle ready for its next execution
+        SQLFreeStmt(stmt, SQL_CLOSE);
+        m_activePrepared.store(SQL_NULL_HSTMT, std::memory_order_release);
+        throw;
+    }
+}
+
+int64_t SQLServerDriver::insertRows(std::string_view sql, const ResultSet& rows) {
+    std::lock_guard lock(m_executeMutex);
+    if (!m_connected.load(std::memory_order_acquire)) [[unlikely]] {
+        throw std::runtime_error("Not connected to database");
+    }
+    static auto& rowsInserted = MetricsRegistry::instance().counter("driver.rows_inserted");
+    const size_t rowCount = rows.rowCount();
+    const size_t columnCount = rows.columnData.size();
+
+    // Text and binary parameters are fixed-width arrays, each sized by its column's longest cell in the chunk, so a
+    // chunk takes as many rows as all of those arrays together fit the budget. Per such column: each row's cell bytes
+    std::vector<size_t> variableColumns;
+    std::vector<std::vector<size_t>> cellBytes(columnCount);
+    for (size_t c = 0; c < columnCount; ++c) {
+        const auto& data = rows.columnData[c];
+        if (data.type() != ColumnDataType::Text && data.type() != ColumnDataType::Binary && data.type() != ColumnDataType::Time) {
+            continue;
+        }
+        variableColumns.push_back(c);
+        auto& bytes = cellBytes[c];
+        bytes.resize(rowCount);
+        for (size_t row = 0; row < rowCount; ++row) {
+            bytes[row] = data.isNull(row) ? 0 : (data.type() != ColumnDataType::Time ? data.textAt(row).size() : 16);
+        }
+    }
+    // Bytes per row of column c's bound array when its widest cell has `widest` bytes (UTF-8 bytes bound the UTF-16 units)
+    const auto boundBytes = [&](size_t c, size_t widest) {
+        return rows.columnData[c].type() == ColumnDataType::Binary ? (std::max)(widest, size_t{1}) : (widest + 1) * sizeof(SQLWCHAR);
+    };
+
+    SQLHSTMT stmt = preparedStatement(sql);
+    int64_t inserted = 0;
+    std::vector<size_t> widest(columnCount, 0);
+    for (size_t first = 0; first < rowCount;) {
+        for (const size_t c : variableColumns) {
+            widest[c] = cellBytes[c][first];
+        }
+        size_t last = first + 1;
+        while (last < rowCount) {
+            size_t rowBytes = 0;
+            for (const size_t c : variableColumns) {
+                rowBytes += boundBytes(c, (std::max)(widest[c], cellBytes[c][last]));
+            }
+            if (rowBytes * (last + 1 - first) > MAX_BOUND_BUFFER_BYTES) {
+                break;
+            }
+            for (const size_t c : variableColumns) {
+                widest[c] = (std::max)(widest[c], cellBytes[c][last]);
+            }
+            ++last;
+        }
+        const size_t count = last - first;
+
+        TraceScope bind("driver.bind_params");
+        // Column-wise parameter arrays; the buffers must stay in place until the execution completes
+        std::vector<std::vector<SQLLEN>> indicators(columnCount, std::vector<SQLLEN>(count, 0));
+        std::vector<std::vector<SQLWCHAR>> texts(columnCount);
+        std::vector<std::vector<SQL_TIMESTAMP_STRUCT>> timestamps(columnCount);
+        std::vector<std::vector<unsigned char>> binaries(columnCount);
+        SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+        for (size_t c = 0; c < columnCount; ++c) {
+            const auto& data = rows.columnData[c];
+            auto& indicator = indicators[c];
+            for (size_t i = 0; i < count; ++i) {
+                if (data.isNull(first + i)) {
+                    indicator[i] = SQL_NULL_DATA;
+                }
+            }
+            const auto number = static_cast<SQLUSMALLINT>(c + 1);
+            SQLRETURN ret = SQL_SUCCESS;
+            switch (data.type()) {
+                case ColumnDataType::Int64:
+                case ColumnDataType::Bit:
+                    ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_SBIGINT, data.type() == ColumnDataType::Bit ? SQL_BIT : SQL_BIGINT, 0, 0,
+                                           const_cast<int64_t*>(data.int64Values().data() + first), sizeof(int64_t), indicator.data());
+                    break;
+                case ColumnDataType::Double:
+                    ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, const_cast<double*>(data.doubleValues().data() + first), sizeof(double), indicator.data());
+                    break;
+                case ColumnDataType::Date:
+                case ColumnDataType::Timestamp: {
+                    auto& values = timestamps[c];
+                    values.resize(count);
+                    for (size_t i = 0; i < count; ++i) {
+                        const auto& value = data.dateTimeValues()[first + i];
+                        values[i] = {.year = value.year, .month = value.month, .day = value.day, .hour = value.hour, .minute = value.minute, .second = value.second, .fraction = value.fraction};
+                    }
+                    // datetime2(7): "YYYY-MM-DD hh:mm:ss.fffffff"
+                    ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_TYPE_TIMESTAMP, SQL_TYPE_TIMESTAMP, 27, 7, values.data(), sizeof(SQL_TIMESTAMP_STRUCT), indicator.data());
+                    break;
+                }
+                case ColumnDataType::Binary: {
+                    // Raw bytes, declared VARBINARY(8000) unless longer for the same reason as the text below
+                    const size_t width = (std::max)(widest[c], size_t{1});
+                    auto& buffer = binaries[c];
+                    buffer.assign(width * count, 0);
+                    for (size_t i = 0; i < count; ++i) {
+                        if (indicator[i] == SQL_NULL_DATA) {
+                            continue;
+                        }
+                        const auto bytes = data.textAt(first + i);
+                        std::memcpy(buffer.data() + i * width, bytes.data(), bytes.size());
+                        indicator[i] = static_cast<SQLLEN>(bytes.size());
+                    }
+                    constexpr SQLULEN VARBINARY_LIMIT = 8000;
+                    ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_BINARY, width > VARBINARY_LIMIT ? SQL_LONGVARBINARY : SQL_VARBINARY,
+                                           (std::max)(static_cast<SQLULEN>(width), VARBINARY_LIMIT), 0, buffer.data(), static_cast<SQLLEN>(width), indicator.data());
+                    break;
+                }
+                default: {
+                    // Text, and TIME as its display text (SQL_TIME_STRUCT has no fractional seconds)
+                    const size_t width = widest[c] + 1;
+                    auto& buffer = texts[c];
+                    buffer.assign(width * count, 0);
+                    std::string cell;
+                    for (size_t i = 0; i < count; ++i) {
+                        if (indicator[i] == SQL_NULL_DATA) {
+                            continue;
+                        }
+                        const auto text = data.type() == ColumnDataType::Text ? data.textAt(first + i) : std::string_view(cell = data.displayText(first + i));
+                        const auto wide = utf8ToWide(text);
+                        std::memcpy(buffer.data() + i * width, wide.data(), wide.size() * sizeof(SQLWCHAR));
+                        indicator[i] = static_cast<SQLLEN>(wide.size() * sizeof(SQLWCHAR));
+                    }
+                    // Declared NVARCHAR(4000) unless longer, so every batch shares one server plan
+                    constexpr SQLULEN NVARCHAR_LIMIT = 4000;
+                    const SQLULEN chars = width - 1;
+                    ret = SQLBindParameter(stmt, number, SQL_PARAM_INPUT, SQL_C_WCHAR, chars > NVARCHAR_LIMIT ? SQL_WLONGVARCHAR : SQL_WVARCHAR, (std::max)(chars, NVARCHAR_LIMIT), 0,
+                                           buffer.data(), static_cast<SQLLEN>(width * sizeof(SQLWCHAR)), indicator.data());
+                    break;
+                }
+            }
+            if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
+                storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+                SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+                throwLastError(std::format("Failed to bind parameter {}: ", number));
+            }
+        }
+        if (SQLRETURN ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, toSqlPointer(static_cast<SQLULEN>(count)), 0); ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
+            storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+            SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+            throwLastError("Failed to set the parameter array size: ");
+        }
+        bind.end();
+
+        m_activePrepared.store(stmt, std::memory_order_release);
+        try {
+            TraceScope exec("driver.exec");
+            static auto& execLatency = MetricsRegistry::instance().histogram("driver.exec_latency_us");
+            ScopedLatency timed(execLatency);
+            SQLRETURN ret = SQLExecute(stmt);
+            // Each parameter set reports its own row count
+            while (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) {
+                SQLLEN affected = 0;
+                const SQLRETURN countRet = SQLRowCount(stmt, &affected);
+                if ((countRet == SQL_SUCCESS || countRet == SQL_SUCCESS_WITH_INFO) && affected > 0) {
+                    inserted += affected;
+                }
+                ret = SQLMoreResults(stmt);
+            }
+            if (ret != SQL_NO_DATA) [[unlikely]] {
+                storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
+                throwLastError();
+            }
+        } catch (...) {
+            // Leave the cached handle ready for single-row use
+            SQLFreeStmt(stmt, SQL_CLOSE);
+            SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+            SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, toSqlPointer(SQLULEN{1}), 0);
+            m_activePrepared.store(SQL_NULL_HSTMT, std::memory_order_release);
+            throw;
+        }
+        SQLFreeStmt(stmt, SQL_CLOSE);
+        SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+        SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, toSqlPointer(SQLULEN{1}), 0);
+        m_activePrepared.store(SQL_NULL_HSTMT, std::memory_order_release);
+        first = last;
+    }
+    rowsInserted.add(static_cast<uint64_t>(inserted));
+    return inserted;
+}
+
+ResultSet SQLServerDriver::readResult(SQLHSTMT stmt, RowBatchSink* sink, size_t batchRows, StreamSummary& summary, std::chrono::high_resolution_clock::time_point startTime,
+                                      const ExecuteOptions& options) {
+    TraceScope describe("driver.describe");
+    ResultSet result;
+    // Messages that arrived with SQLExecute/SQLMoreResults belong to the result about to be read
+    std::swap(result.messages, m_messages);
     SQLSMALLINT numCols = 0;
-    ret = SQLNumResultCols(stmt, &numCols);
+    SQLRETURN ret = SQLNumResultCols(stmt, &numCols);
     if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
         storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
-        throw std::runtime_error(std::string("Failed to get column count: ") + m_lastError);
+        throwLastError("Failed to get column count: ");
     }
 
     result.columns.reserve(static_cast<size_t>(numCols));
+    result.columnData.reserve(static_cast<size_t>(numCols));
+    std::vector<SQLSMALLINT> columnTypes;
+    columnTypes.reserve(static_cast<size_t>(numCols));
     for (SQLSMALLINT i = 1; i <= numCols; ++i) {
         std::array<SQLWCHAR, 256> colName{};
         SQLSMALLINT colNameLen = 0;
@@ -167,7 +1211,7 @@ ResultSet SQLServerDriver::execute(std::string_view sql) {
         ret = SQLDescribeColW(stmt, i, colName.data(), static_cast<SQLSMALLINT>(colName.size()), &colNameLen, &dataType, &colSize, &decimalDigits, &nullable);
         if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) [[unlikely]] {
             storeODBCDiagnosticMessage(ret, SQL_HANDLE_STMT, stmt);
-            throw std::runtime_error(std::string("Failed to describe column: ") + m_lastError);
+            throwLastError("Failed to describe column: ");
         }
 
         // Ensure colNameLen doesn't exceed buffer size (SQLDescribeColW may truncate)
@@ -181,53 +1225,94 @@ ResultSet SQLServerDriver::execute(std::string_view sql) {
             columnName = std::format("Column{}", i);
         }
 
-        result.columns.push_back({.name = columnName, .type = convertSQLTypeToDisplayName(dataType), .size = static_cast<int>(colSize), .nullable = (nullable == SQL_NULLABLE), .isPrimaryKey = false});
+        const SqlType sqlType = describeSqlType(dataType, colSize, decimalDigits);
+        const bool exactNumeric = sqlType == SqlType::Decimal;
+        const bool fractionalSeconds = sqlType == SqlType::Time || sqlType == SqlType::DateTime || sqlType == SqlType::DateTime2 || sqlType == SqlType::DateTimeOffset;
+        result.columns.push_back({.name = columnName,
+                                  .type = std::string(sqlTypeName(sqlType)),
+                                  .size = static_cast<int>(colSize),
+                                  .nullable = (nullable == SQL_NULLABLE),
+                                  .isPrimaryKey = false,
+                                  .comment = {},
+                                  .sqlType = sqlType,
+                                  .precision = exactNumeric ? static_cast<int>(colSize) : 0,
+                                  .scale = exactNumeric || fractionalSeconds ? static_cast<int>(decimalDigits) : 0});
+        result.columnData.emplace_back(convertSQLTypeToStorageType(dataType), static_cast<uint8_t>(std::clamp<SQLSMALLINT>(decimalDigits, 0, 9)));
+        columnTypes.push_back(dataType);
     }
 
-    // Dynamic buffer for large column values (Unicode - SQLWCHAR is 2 bytes)
-    constexpr size_t INITIAL_BUFFER_CHARS = 4096;
-    std::vector<SQLWCHAR> buffer(INITIAL_BUFFER_CHARS);
-    SQLLEN indicator = 0;
+    if (sink != nullptr) {
+        sink->onColumns(result.columns);
+    }
 
-    while ((ret = SQLFetch(stmt)) == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) {
-        ResultRow row;
-        row.values.reserve(static_cast<size_t>(numCols));
+    describe.end();
 
-        for (SQLSMALLINT i = 1; i <= numCols; ++i) {
-            // Use SQL_C_WCHAR to get Unicode data
-            ret = SQLGetData(stmt, i, SQL_C_WCHAR, buffer.data(), buffer.size() * sizeof(SQLWCHAR), &indicator);
-            if (indicator == SQL_NULL_DATA) {
-                row.values.emplace_back();
-            } else if (ret == SQL_SUCCESS_WITH_INFO && indicator > static_cast<SQLLEN>((buffer.size() - 1) * sizeof(SQLWCHAR))) {
-                // Data was truncated, need a larger buffer
-                // indicator is in bytes for SQL_C_WCHAR
-                size_t requiredChars = (static_cast<size_t>(indicator) / sizeof(SQLWCHAR)) + 1;
-                std::vector<SQLWCHAR> largeBuffer(requiredChars);
-                // Copy already retrieved data
-                size_t alreadyReadChars = buffer.size() - 1;
-                std::copy(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(alreadyReadChars), largeBuffer.begin());
-                // Get remaining data
-                SQLLEN remainingIndicator = 0;
-                ret = SQLGetData(stmt, i, SQL_C_WCHAR, largeBuffer.data() + alreadyReadChars, (requiredChars - alreadyReadChars) * sizeof(SQLWCHAR), &remainingIndicator);
-                // Find actual string length
-                size_t strLen = 0;
-                for (size_t j = 0; j < largeBuffer.size() && largeBuffer[j] != 0; ++j) {
-                    strLen = j + 1;
-                }
-                row.values.emplace_back(sqlWcharToUtf8(largeBuffer.data(), strLen));
-            } else if (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) {
-                // Find actual string length
-                size_t strLen = 0;
-                for (size_t j = 0; j < buffer.size() && buffer[j] != 0; ++j) {
-                    strLen = j + 1;
-                }
-                row.values.emplace_back(sqlWcharToUtf8(buffer.data(), strLen));
-            } else {
-                // Error getting data - add empty value and continue
-                row.values.emplace_back();
-            }
+    TraceScope fetch("driver.fetch");
+    const auto fetchStart = std::chrono::high_resolution_clock::now();
+
+    // Bound row-array fetch when every column has a fixed or bounded size, per-cell SQLGetData otherwise (LOB/MAX)
+    std::vector<ColumnBinding> bindings;
+    bindings.reserve(static_cast<size_t>(numCols));
+    for (SQLSMALLINT i = 1; i <= numCols; ++i) {
+        const auto col = static_cast<size_t>(i - 1);
+        bindings.push_back(planColumnBinding(stmt, static_cast<SQLUSMALLINT>(i), columnTypes[col], result.columnData[col].type()));
+    }
+    const bool canBind = std::ranges::none_of(bindings, [](const ColumnBinding& binding) { return binding.elementBytes == 0; });
+
+    FetchTarget target{.rows = result,
+                       .sink = sink,
+                       .batchRows = batchRows,
+                       .maxRows = options.maxRows,
+                       .lobPreviewChars = options.lobPreviewBytes / sizeof(SQLWCHAR),
+                       .lobPreviewBytes = options.lobPreviewBytes,
+                       .cancelToken = options.cancelRequested,
+                       .driverCancel = &m_cancelRequested};
+    if (numCols == 0) {
+        // No result set (DML/DDL) - nothing to fetch
+    } else if (canBind && fetchRowsBound(stmt, bindings, m_fetchRowsetSize.load(std::memory_order_relaxed), target)) {
+        result.fetchStats.bulkFetch = true;
+    } else {
+        fetchRowsByGetData(stmt, bindings, target);
+        result.fetchStats.rowsetSize = 1;
+        if (sink == nullptr) {
+            result.updateStats();
         }
-        result.rows.push_back(std::move(row));
+    }
+    if (target.cancelled) [[unlikely]] {
+        SQLFreeStmt(stmt, SQL_CLOSE);
+        // Same message and state as a statement interrupted by SQLCancel, so callers handle both alike
+        m_lastError = "Operation canceled";
+        m_lastSqlState = "HY008";
+        throwLastError();
+    }
+    if (!target.flush(true) || target.truncated) {
+        // Discard the rest of the result so the statement can be reused
+        SQLFreeStmt(stmt, SQL_CLOSE);
+    }
+    summary.totalRows = target.totalRows();
+    summary.stopped = target.stopped;
+    summary.truncated = target.truncated;
+    result.truncated = target.truncated;
+    // UTF-16 conversion is interleaved with the fetches, so it is reported as one child span summing every rowset.
+    // The per-cell SQLGetData path converts between driver calls and is left inside the fetch span.
+    if (target.convertTime.count() > 0) {
+        QueryTracer::instance().record("driver.convert", std::chrono::steady_clock::now() - target.convertTime, target.convertTime);
+    }
+    fetch.setDetail(std::format("{} rows", summary.totalRows));
+    fetch.end();
+
+    const auto fetchEnd = std::chrono::high_resolution_clock::now();
+    result.fetchStats.fetchTimeMs = std::chrono::duration<double, std::milli>(fetchEnd - fetchStart).count();
+    if (result.fetchStats.fetchTimeMs > 0.0) {
+        result.fetchStats.rowsPerSecond = static_cast<double>(summary.totalRows) * 1000.0 / result.fetchStats.fetchTimeMs;
+    }
+    static auto& rowsFetched = MetricsRegistry::instance().counter("driver.rows_fetched");
+    static auto& bytesConverted = MetricsRegistry::instance().counter("driver.bytes_converted");
+    static auto& fetchRate = MetricsRegistry::instance().histogram("driver.fetch_rows_per_sec");
+    rowsFetched.add(summary.totalRows);
+    bytesConverted.add(target.convertedBytes);
+    if (summary.totalRows > 0) {
+        fetchRate.record(static_cast<uint64_t>(result.fetchStats.rowsPerSecond));
     }
 
     SQLLEN rowCount = 0;
@@ -246,10 +1331,14 @@ ResultSet SQLServerDriver::execute(std::string_view sql) {
 }
 
 void SQLServerDriver::cancel() {
+    m_cancelRequested.store(true, std::memory_order_release);
     auto stmt = m_stmt.load(std::memory_order_acquire);
     if (stmt != SQL_NULL_HSTMT) {
         SQLCancel(stmt);
     }
+    if (auto prepared = m_activePrepared.load(std::memory_order_acquire); prepared != SQL_NULL_HSTMT) {
+        SQLCancel(prepared);
+    }
 }
 
 std::string SQLServerDriver::getLastError() const {
@@ -262,15 +1351,33 @@ void SQLServerDriver::storeODBCDiagnosticMessage(SQLRETURN returnCode, SQLSMALLI
         return;
     }
 
-    std::array<SQLWCHAR, 6> sqlState{};
-    SQLINTEGER nativeErrorCode = 0;
-    std::array<SQLWCHAR, 1024> diagnosticMessage{};
-    SQLSMALLINT messageLength = 0;
-
-    SQLGetDiagRecW(odbcHandleType, odbcHandle, 1, sqlState.data(), &nativeErrorCode, diagnosticMessage.data(), static_cast<SQLSMALLINT>(diagnosticMessage.size()), &messageLength);
+    // Every record, not just the first: a batch that PRINTs before failing reports the PRINT as record 1, and
+    // SQL Server often follows an error with further errors about the same statement
+    ServerMessages records;
+    collectDiagnostics(odbcHandleType, odbcHandle, records);
+    m_lastError.clear();
+    m_lastSqlState.clear();
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto record = records[i];
+        if (record.sqlState.starts_with("01") && (i + 1 < records.size() || !m_lastError.empty())) {
+            continue;  // Warnings and informational output (class 01), unless nothing else was reported
+        }
+        if (!m_lastError.empty()) {
+            m_lastError += '\n';
+        }
+        m_lastError += record.text;
+        if (m_lastSqlState.empty()) {
+            m_lastSqlState = record.sqlState;
+        }
+    }
+}
 
-    // Convert UTF-16 (SQLWCHAR) to UTF-8 (std::string)
-    m_lastError = sqlWcharToUtf8(diagnosticMessage.data(), messageLength);
+void SQLServerDriver::throwLastError(std::string_view context) const {
+    auto message = std::string(context) + m_lastError;
+    if (m_lastSqlState.starts_with("08")) {
+        throw ConnectionLostError(std::move(message));
+    }
+    throw std::runtime_error(std::move(message));
 }
 
 }  // namespace velocitydb
@@ -1,38 +1,39 @@
 #pragma once
 
 #include "driver_interface.h"
+#include "result_set.h"
 
 #include <Windows.h>
 #include <sql.h>
 #include <sqlext.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <expected>
+#include <list>
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <variant>
 #include <vector>
 
 namespace velocitydb {
 
-struct ColumnInfo {
-    std::string name;
-    std::string type;
-    int size = 0;
-    bool nullable = true;
-    bool isPrimaryKey = false;
-    std::string comment;
-};
-
-struct ResultRow {
-    std::vector<std::string> values;
-};
+/// Value bound to a `?` placeholder of SQLServerDriver::executePrepared: NULL, BIGINT, FLOAT or NVARCHAR
+using SqlParameter = std::variant<std::monostate, int64_t, double, std::string>;
 
-struct ResultSet {
-    std::vector<ColumnInfo> columns;
-    std::vector<ResultRow> rows;
-    int64_t affectedRows = 0;
-    double executionTimeMs = 0.0;
+/// Per-call limits of SQLServerDriver::execute and executeStreaming
+struct ExecuteOptions {
+    /// Stop after this many rows (0 = no limit). Also sent as SQL_ATTR_MAX_ROWS, so a driver that honours it stops
+    /// the server early; the result reports `truncated` when more rows were left.
+    size_t maxRows = 0;
+    /// Polled between fetches. Once set the cursor is closed and the call throws "Operation canceled", like SQLCancel.
+    const std::atomic<bool>* cancelRequested = nullptr;
+    /// Read at most this much of each (MAX)/XML/LOB cell (0 = whole values). A longer value keeps only its start and
+    /// is listed in ResultSet::lobPreviews with its full length; the rest never crosses the network.
+    size_t lobPreviewBytes = 0;
 };
 
 class SQLServerDriver : public IDatabaseDriver {
@@ -49,22 +50,100 @@ public:
     [[nodiscard]] bool connect(std::string_view connectionString) override;
     void disconnect() override;
     [[nodiscard]] bool isConnected() const noexcept override { return m_connected.load(std::memory_order_acquire); }
+    /// Connected and not flagged dead by the driver (SQL_ATTR_CONNECTION_DEAD). Reflects the last known state,
+    /// so it costs no round trip; a connection dropped since its last request still reports alive.
+    [[nodiscard]] bool isAlive() const noexcept;
 
     [[nodiscard]] ResultSet execute(std::string_view sql) override;
+    [[nodiscard]] ResultSet execute(std::string_view sql, const ExecuteOptions& options);
+    StreamSummary executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows = DEFAULT_STREAM_BATCH_ROWS) override;
+    StreamSummary executeStreaming(std::string_view sql, RowBatchSink& sink, size_t batchRows, const ExecuteOptions& options);
+    /// Every result set of a multi-statement batch, walked with SQLMoreResults in one round trip
+    [[nodiscard]] std::vector<ResultSet> executeMultiple(std::string_view sql) override;
+    /// executeMultiple() that also keeps the results without columns (DML row counts), so a script sent as one
+    /// batch reports a result for every statement that produced one
+    [[nodiscard]] std::vector<ResultSet> executeBatch(std::string_view sql);
+    /// Run `sql` with its `?` placeholders bound to `params`. The statement is prepared (SQLPrepareW) on first use and
+    /// the handle kept in a per-connection LRU of PREPARED_CACHE_CAPACITY entries, so repeated metadata queries skip
+    /// the compile and values never need escaping. Text binds as NVARCHAR(4000) (NVARCHAR(MAX) when longer) so
+    /// every call shares one server plan.
+    [[nodiscard]] ResultSet executePrepared(std::string_view sql, const std::vector<SqlParameter>& params = {});
+    /// Run the parameterized `sql` (typically INSERT ... VALUES (?, ...)) once per row of `rows`, sending the rows as
+    /// column-wise parameter arrays (SQL_ATTR_PARAMSET_SIZE) so a batch costs one round trip. Int64/Bit/Double and
+    /// date/timestamp columns bind in their binary C types, the rest as UTF-16 text. Rows are split into several
+    /// executions when the text arrays would exceed the bound-buffer budget.
+    /// @return Rows affected
+    int64_t insertRows(std::string_view sql, const ResultSet& rows);
+    /// Prepared statements currently cached
+    [[nodiscard]] size_t preparedStatementCount() const;
+    /// SQLCancel on the running statement. A fetch loop already draining rows also sees it and stops at the next rowset.
     void cancel() override;
+    [[nodiscard]] bool reconnect() override;
 
     [[nodiscard]] std::string getLastError() const override;
     [[nodiscard]] DriverType getType() const noexcept override { return DriverType::SQLServer; }
 
+    /// Rows requested per SQLFetch on the bound (block cursor) path; clamped to [1, MAX_FETCH_ROWSET_SIZE].
+    void setFetchRowsetSize(size_t rows) noexcept { m_fetchRowsetSize.store(std::clamp<size_t>(rows, 1, MAX_FETCH_ROWSET_SIZE), std::memory_order_relaxed); }
+    [[nodiscard]] size_t getFetchRowsetSize() const noexcept { return m_fetchRowsetSize.load(std::memory_order_relaxed); }
+    /// TDS packet size (SQL_ATTR_PACKET_SIZE) requested at the next connect(); 0 keeps the driver default, anything
+    /// else is clamped to [MIN_PACKET_SIZE, MAX_PACKET_SIZE]. The server may still grant a smaller one.
+    void setPacketSize(uint32_t bytes) noexcept { m_packetSize = bytes == 0 ? 0 : std::clamp(bytes, MIN_PACKET_SIZE, MAX_PACKET_SIZE); }
+
+    static constexpr size_t DEFAULT_FETCH_ROWSET_SIZE = 1000;
+    static constexpr size_t MAX_FETCH_ROWSET_SIZE = 10000;
+    static constexpr size_t PREPARED_CACHE_CAPACITY = 32;
+    static constexpr uint32_t MIN_PACKET_SIZE = 512;
+    static constexpr uint32_t MAX_PACKET_SIZE = 32767;
+    /// Grid-sized LOB preview: a screenful of text, far below what XML/JSON columns commonly hold
+    static constexpr size_t DEFAULT_LOB_PREVIEW_BYTES = 64 * 1024;
+
 private:
+    /// Shared execute path. With a sink, rows are delivered in batches of `batchRows` and the returned result holds no rows.
+    [[nodiscard]] ResultSet executeStatement(std::string_view sql, RowBatchSink* sink, size_t batchRows, StreamSummary& summary, const ExecuteOptions& options);
+    /// Run `sql` on the driver's reusable statement handle, allocating and publishing it on first use (m_executeMutex held).
+    /// A non-zero `maxRows` caps the server side with SQL_ATTR_MAX_ROWS.
+    [[nodiscard]] SQLHSTMT beginStatement(std::string_view sql, size_t maxRows = 0);
+    /// Run `sql` and read every result with SQLMoreResults; column-less results are dropped unless `keepRowCounts`
+    [[nodiscard]] std::vector<ResultSet> collectResults(std::string_view sql, bool keepRowCounts);
+    /// Cached prepared handle for `sql`, preparing it (and evicting the least recently used) on a miss (m_executeMutex held)
+    [[nodiscard]] SQLHSTMT preparedStatement(std::string_view sql);
+    /// Free every cached prepared handle (m_executeMutex held)
+    void releasePreparedStatements() noexcept;
+    /// Read the informational records of the message-only results after the one just read (the PRINT and STATISTICS
+    /// output that follows a SELECT arrives this way), stopping at the next result with columns
+    void drainMessages(SQLHSTMT stmt, ServerMessages& messages);
+    /// Describe and fetch the statement's current result set
+    [[nodiscard]] ResultSet readResult(SQLHSTMT stmt, RowBatchSink* sink, size_t batchRows, StreamSummary& summary, std::chrono::high_resolution_clock::time_point startTime,
+                                       const ExecuteOptions& options = {});
+    /// Replace m_lastError / m_lastSqlState with the handle's diagnostic records (m_executeMutex held)
     void storeODBCDiagnosticMessage(SQLRETURN returnCode, SQLSMALLINT odbcHandleType, SQLHANDLE odbcHandle);
-    [[nodiscard]] static std::string convertSQLTypeToDisplayName(SQLSMALLINT dataType);
+    /// Throw the stored diagnostic; ConnectionLostError for SQLSTATE class 08 (communication link failure)
+    [[noreturn]] void throwLastError(std::string_view context = {}) const;
+    /// SqlType of an SQLDescribeCol result; `columnSize` and `decimalDigits` tell DATETIME, SMALLDATETIME and DATETIME2 apart
+    [[nodiscard]] static SqlType describeSqlType(SQLSMALLINT dataType, SQLULEN columnSize, SQLSMALLINT decimalDigits) noexcept;
+    [[nodiscard]] static ColumnDataType convertSQLTypeToStorageType(SQLSMALLINT dataType) noexcept;
 
     SQLHENV m_env = SQL_NULL_HENV;
     SQLHDBC m_dbc = SQL_NULL_HDBC;
-    std::atomic<SQLHSTMT> m_stmt{SQL_NULL_HSTMT};
+    std::atomic<SQLHSTMT> m_stmt{SQL_NULL_HSTMT};  // Reused across executes; freed by disconnect()
+    std::atomic<SQLHSTMT> m_activePrepared{SQL_NULL_HSTMT};  // Cached handle executing right now (cancel() target)
+    SQLULEN m_stmtMaxRows = 0;                                // SQL_ATTR_MAX_ROWS currently set on m_stmt; guarded by m_executeMutex
+    std::atomic<bool> m_cancelRequested{false};               // Raised by cancel(), cleared when the next statement starts
+    ServerMessages m_messages;  // Records collected since the last readResult(), which takes them; guarded by m_executeMutex
+
+    struct PreparedStatement {
+        std::string sql;
+        SQLHSTMT stmt = SQL_NULL_HSTMT;
+    };
+    std::list<PreparedStatement> m_prepared;  // Most recently used first; guarded by m_executeMutex
+    std::unordered_map<std::string_view, std::list<PreparedStatement>::iterator> m_preparedIndex;  // Keys view m_prepared entries
     std::atomic<bool> m_connected{false};
-    std::string m_lastError;
+    std::string m_lastError;         // guarded by m_executeMutex
+    std::string m_lastSqlState;      // guarded by m_executeMutex
+    std::string m_connectionString;  // Kept for reconnect()
+    std::atomic<size_t> m_fetchRowsetSize{DEFAULT_FETCH_ROWSET_SIZE};
+    uint32_t m_packetSize = 0;  // Set before connect()
     mutable std::mutex m_executeMutex;  // Serializes concurrent execute()/disconnect()/getLastError() calls
 };
 
@@ -0,0 +1,69 @@
+#include "statement_waves.h"
+
+#include "../parsers/sql_parser.h"
+#include "../utils/query_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace velocitydb {
+
+namespace {
+
+/// Statements [begin, end) on up to `maxParallel` threads; the earliest failure is rethrown
+void runWave(size_t begin, size_t end, size_t maxParallel, const StatementRunner& run, size_t& failedIndex) {
+    const size_t count = end - begin;
+    std::vector<std::exception_ptr> errors(count);
+    std::atomic<size_t> next{begin};
+    std::atomic<bool> failed{false};
+
+    const auto traceId = QueryTracer::currentTraceId();
+    auto worker = [&] {
+        TraceContext trace(traceId);  // Helper threads report into the caller's trace
+        for (size_t index = next++; index < end && !failed.load(std::memory_order_acquire); index = next++) {
+            try {
+                run(index, true);
+            } catch (...) {
+                errors[index - begin] = std::current_exception();
+                failed.store(true, std::memory_order_release);
+            }
+        }
+    };
+    {
+        std::vector<std::jthread> helpers;
+        for (size_t i = 1; i < (std::min)(count, maxParallel); ++i) {
+            helpers.emplace_back(worker);
+        }
+        worker();
+    }
+
+    if (auto error = std::ranges::find_if(errors, [](const std::exception_ptr& e) { return e != nullptr; }); error != errors.end()) {
+        failedIndex = begin + static_cast<size_t>(error - errors.begin());
+        std::rethrow_exception(*error);
+    }
+}
+
+}  // namespace
+
+void runStatementWaves(const std::vector<std::string>& statements, size_t maxParallel, const StatementRunner& run, size_t& failedIndex) {
+    size_t index = 0;
+    while (index < statements.size()) {
+        size_t end = index;
+        while (end < statements.size() && SQLParser::isSessionIndependent(statements[end])) {
+            ++end;
+        }
+        if (end - index > 1 && maxParallel > 1) {
+            runWave(index, end, maxParallel, run, failedIndex);
+            index = end;
+            continue;
+        }
+        // A lone read or a barrier runs on the calling thread
+        failedIndex = index;
+        run(index, false);
+        ++index;
+    }
+}
+
+}  // namespace velocitydb
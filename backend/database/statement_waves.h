@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+/// Statement `index` of a script; `concurrent` is true when it runs alongside others on its own lane
+using StatementRunner = std::function<void(size_t index, bool concurrent)>;
+
+/// Lanes a parallel script may use at once (ConnectionRegistry::DEFAULT_MAX_LANES)
+inline constexpr size_t MAX_PARALLEL_STATEMENTS = 4;
+
+/// Run `statements` in order, except that each run of consecutive session-independent statements
+/// (SQLParser::isSessionIndependent) is fanned out over up to `maxParallel` threads. Every other statement
+/// (USE, DML, temp tables) is a barrier: it starts once all earlier statements finished and runs alone.
+///
+/// After the first failure no further statement starts. When the running ones are done, the exception of the
+/// earliest failed statement is rethrown with its index stored in `failedIndex`.
+void runStatementWaves(const std::vector<std::string>& statements, size_t maxParallel, const StatementRunner& run, size_t& failedIndex);
+
+}  // namespace velocitydb
@@ -0,0 +1,162 @@
+#include "table_ddl.h"
+
+#include "../utils/sql_validation.h"
+#include "schema_snapshot.h"
+
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+/// Result sets of the batch, in order
+enum BatchResult : uint8_t { COLUMNS, INDEX_COLUMNS, FOREIGN_KEY_COLUMNS, BATCH_RESULTS };
+
+/// `{object}` is the N'...' literal of the quoted table name
+constexpr auto BATCH_QUERY = R"(
+SET NOCOUNT ON;
+DECLARE @id INT = OBJECT_ID({object});
+
+SELECT c.name, t.name, c.max_length, c.precision, c.scale, c.is_nullable, dc.definition, c.is_identity,
+    CAST(ic.seed_value AS NVARCHAR(40)), CAST(ic.increment_value AS NVARCHAR(40)), cc.definition
+FROM sys.columns c
+INNER JOIN sys.types t ON c.user_type_id = t.user_type_id
+LEFT JOIN sys.default_constraints dc ON dc.parent_object_id = c.object_id AND dc.parent_column_id = c.column_id
+LEFT JOIN sys.identity_columns ic ON ic.object_id = c.object_id AND ic.column_id = c.column_id
+LEFT JOIN sys.computed_columns cc ON cc.object_id = c.object_id AND cc.column_id = c.column_id
+WHERE c.object_id = @id
+ORDER BY c.column_id;
+
+SELECT i.index_id, i.name, i.type_desc, i.is_primary_key, i.is_unique, i.is_unique_constraint, i.filter_definition,
+    c.name, ic.is_descending_key, ic.is_included_column
+FROM sys.indexes i
+INNER JOIN sys.index_columns ic ON ic.object_id = i.object_id AND ic.index_id = i.index_id
+INNER JOIN sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id
+WHERE i.object_id = @id AND i.type IN (1, 2)
+ORDER BY i.is_primary_key DESC, i.index_id, ic.is_included_column, ic.key_ordinal, ic.index_column_id;
+
+SELECT fk.name, OBJECT_SCHEMA_NAME(fk.referenced_object_id), OBJECT_NAME(fk.referenced_object_id),
+    COL_NAME(fkc.parent_object_id, fkc.parent_column_id), COL_NAME(fkc.referenced_object_id, fkc.referenced_column_id),
+    fk.delete_referential_action_desc, fk.update_referential_action_desc
+FROM sys.foreign_keys fk
+INNER JOIN sys.foreign_key_columns fkc ON fkc.constraint_object_id = fk.object_id
+WHERE fk.parent_object_id = @id
+ORDER BY fk.name, fkc.constraint_column_id;
+)";
+
+[[nodiscard]] int32_t parseInt(std::string_view text) noexcept {
+    int32_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+}  // namespace
+
+std::string loadTableDDL(IDatabaseDriver& driver, std::string_view schema, std::string_view table) {
+    const auto qualified = std::format("{}.{}", detail::quoteSinglePart(schema), detail::quoteSinglePart(table));
+    std::string sql = BATCH_QUERY;
+    const auto placeholder = sql.find("{object}");
+    sql.replace(placeholder, std::string_view("{object}").size(), std::format("N'{}'", escapeSqlString(qualified)));
+
+    const auto results = driver.executeMultiple(sql);
+    if (results.size() != BATCH_RESULTS) [[unlikely]] {
+        throw std::runtime_error(std::format("Table DDL batch returned {} result sets, expected {}", results.size(), static_cast<int>(BATCH_RESULTS)));
+    }
+    const auto& columns = results[COLUMNS];
+    if (columns.rowCount() == 0) [[unlikely]] {
+        throw std::runtime_error(std::format("Table not found: {}.{}", schema, table));
+    }
+
+    std::string ddl = std::format("CREATE TABLE {} (", qualified);
+    for (size_t row = 0; row < columns.rowCount(); ++row) {
+        ddl += row == 0 ? "\n    " : ",\n    ";
+        ddl += detail::quoteSinglePart(columns.cellText(row, 0));
+        if (auto computed = columns.cellText(row, 10); !computed.empty()) {
+            ddl += " AS " + computed;
+            continue;
+        }
+        ddl += ' ';
+        ddl += SchemaSnapshot::declaredType({.type = columns.cellText(row, 1),
+                                             .size = parseInt(columns.cellText(row, 2)),
+                                             .precision = parseInt(columns.cellText(row, 3)),
+                                             .scale = parseInt(columns.cellText(row, 4))});
+        if (columns.cellText(row, 7) == "1") {
+            ddl += std::format(" IDENTITY({},{})", columns.cellText(row, 8), columns.cellText(row, 9));
+        }
+        ddl += columns.cellText(row, 5) == "1" ? " NULL" : " NOT NULL";
+        if (auto defaultValue = columns.cellText(row, 6); !defaultValue.empty()) {
+            ddl += " DEFAULT " + defaultValue;
+        }
+    }
+
+    // Index rows arrive grouped by index, keys before included columns; the primary key comes first
+    std::string statements;
+    const auto& indexColumns = results[INDEX_COLUMNS];
+    for (size_t row = 0; row < indexColumns.rowCount();) {
+        const auto indexId = indexColumns.cellText(row, 0);
+        const auto name = detail::quoteSinglePart(indexColumns.cellText(row, 1));
+        const auto type = indexColumns.cellText(row, 2);
+        const bool primaryKey = indexColumns.cellText(row, 3) == "1";
+        const bool unique = indexColumns.cellText(row, 4) == "1";
+        const bool constraint = primaryKey || indexColumns.cellText(row, 5) == "1";
+        const auto filter = indexColumns.cellText(row, 6);
+        std::string keys;
+        std::string included;
+        for (; row < indexColumns.rowCount() && indexColumns.cellText(row, 0) == indexId; ++row) {
+            auto& list = indexColumns.cellText(row, 9) == "1" ? included : keys;
+            if (!list.empty()) {
+                list += ", ";
+            }
+            list += detail::quoteSinglePart(indexColumns.cellText(row, 7));
+            if (indexColumns.cellText(row, 8) == "1") {
+                list += " DESC";
+            }
+        }
+        if (constraint) {
+            ddl += std::format(",\n    CONSTRAINT {} {} {} ({})", name, primaryKey ? "PRIMARY KEY" : "UNIQUE", type, keys);
+            continue;
+        }
+        statements += std::format("\n\nCREATE {}{} INDEX {} ON {} ({})", unique ? "UNIQUE " : "", type, name, qualified, keys);
+        if (!included.empty()) {
+            statements += std::format(" INCLUDE ({})", included);
+        }
+        if (!filter.empty()) {
+            statements += " WHERE " + filter;
+        }
+        statements += ';';
+    }
+    ddl += "\n);";
+
+    const auto& keyColumns = results[FOREIGN_KEY_COLUMNS];
+    for (size_t row = 0; row < keyColumns.rowCount();) {
+        const auto name = keyColumns.cellText(row, 0);
+        const auto referenced = std::format("{}.{}", detail::quoteSinglePart(keyColumns.cellText(row, 1)), detail::quoteSinglePart(keyColumns.cellText(row, 2)));
+        const auto onDelete = keyColumns.cellText(row, 5);
+        const auto onUpdate = keyColumns.cellText(row, 6);
+        std::string columnsList;
+        std::string referencedList;
+        for (; row < keyColumns.rowCount() && keyColumns.cellText(row, 0) == name; ++row) {
+            if (!columnsList.empty()) {
+                columnsList += ", ";
+                referencedList += ", ";
+            }
+            columnsList += detail::quoteSinglePart(keyColumns.cellText(row, 3));
+            referencedList += detail::quoteSinglePart(keyColumns.cellText(row, 4));
+        }
+        statements += std::format("\n\nALTER TABLE {} ADD CONSTRAINT {} FOREIGN KEY ({}) REFERENCES {} ({})", qualified, detail::quoteSinglePart(name), columnsList, referenced,
+                                  referencedList);
+        if (!onDelete.empty() && onDelete != "NO_ACTION") {
+            statements += " ON DELETE " + SchemaSnapshot::referentialAction(onDelete);
+        }
+        if (!onUpdate.empty() && onUpdate != "NO_ACTION") {
+            statements += " ON UPDATE " + SchemaSnapshot::referentialAction(onUpdate);
+        }
+        statements += ';';
+    }
+    return ddl + statements;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// CREATE TABLE script of one table, read in a single multi-result-set batch.
+///
+/// Columns carry their defaults, identity and computed expressions; the primary key and unique constraints go
+/// inline, followed by CREATE INDEX for the other rowstore indexes (INCLUDE and filter kept) and ALTER TABLE for
+/// each foreign key. One round trip however many parts the table has, so a preview over a slow link costs one
+/// latency instead of one per component.
+/// @throws std::runtime_error when the batch fails or the table does not exist
+[[nodiscard]] std::string loadTableDDL(IDatabaseDriver& driver, std::string_view schema, std::string_view table);
+
+}  // namespace velocitydb
@@ -0,0 +1,416 @@
+#include "table_tail_monitor.h"
+
+#include "../utils/json_utils.h"
+#include "../utils/logger.h"
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <condition_variable>
+#include <format>
+#include <thread>
+
+namespace velocitydb {
+
+namespace {
+
+/// Trailing columns the tail queries add after the table's own
+constexpr std::string_view KEY_TEXT_COLUMN = "__tail_key";
+constexpr std::string_view OPERATION_COLUMN = "__tail_operation";
+
+/// Primary key types that only grow in practice, so `WHERE key > last` sees every new row
+constexpr std::array<std::string_view, 9> MONOTONIC_TYPES = {"tinyint", "smallint", "int", "bigint", "numeric", "decimal", "date", "datetime", "datetime2"};
+
+enum DetectColumn : size_t { D_OBJECT, D_TRACKED, D_COUNT };
+
+int64_t integerCell(const ResultSet& result, size_t row, size_t col) {
+    const auto& column = result.columnData[col];
+    if (column.isNull(row)) {
+        return 0;
+    }
+    if (column.isNumeric()) {
+        return static_cast<int64_t>(column.numericAt(row));
+    }
+    const auto text = column.textAt(row);
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+std::string textCell(const ResultSet& result, size_t row, size_t col) {
+    return result.isNull(row, col) ? std::string() : result.columnData[col].displayText(row);
+}
+
+std::string_view modeName(TableTailMonitor::Mode mode) {
+    return mode == TableTailMonitor::Mode::ChangeTracking ? "changeTracking" : "key";
+}
+
+/// `[a] DESC, [b] DESC`
+std::string orderByKey(const TableTailMonitor::Plan& plan, std::string_view direction) {
+    std::string clause;
+    for (const auto& column : plan.keyColumns) {
+        clause += std::format("{}{} {}", clause.empty() ? "" : ", ", quoteBracketIdentifier(column), direction);
+    }
+    return clause;
+}
+
+/// Columns [first, first + count) of `source`, without rows
+ResultSet columnsOf(const ResultSet& source, size_t first, size_t count) {
+    ResultSet out;
+    for (size_t col = first; col < first + count; ++col) {
+        out.columns.push_back(source.columns[col]);
+        out.columnData.push_back(col < source.columnData.size() ? ColumnData(source.columnData[col].type(), source.columnData[col].fractionDigits()) : ColumnData());
+    }
+    return out;
+}
+
+/// Append row `row` of `source`, from column `first` on, to `target`
+void appendCells(ResultSet& target, const ResultSet& source, size_t row, size_t first = 0) {
+    for (size_t col = 0; col < target.columnData.size(); ++col) {
+        target.columnData[col].appendFrom(source.columnData[first + col], row);
+    }
+}
+
+void appendRows(std::string& json, const ResultSet& rows) {
+    json += '[';
+    for (size_t row = 0; row < rows.rowCount(); ++row) {
+        if (row > 0) {
+            json += ',';
+        }
+        JsonUtils::appendRow(json, rows, row);
+    }
+    json += ']';
+}
+
+void appendHeader(std::string& json, std::string_view tailId, std::string_view connectionId, uint64_t sequence) {
+    json += R"({"tailId":")";
+    JsonUtils::appendEscaped(json, tailId);
+    json += R"(","connectionId":")";
+    JsonUtils::appendEscaped(json, connectionId);
+    json += std::format(R"(","sequence":{})", sequence);
+}
+
+}  // namespace
+
+struct TableTailMonitor::Tail {
+    std::string id;
+    std::string connectionId;
+    std::string table;
+    std::shared_ptr<IDatabaseDriver> driver;
+    Options options;
+    std::mutex mutex;  // for the interruptible wait between polls
+    std::condition_variable_any wake;
+    std::jthread thread;  // Last member: stopped and joined before the rest goes
+};
+
+TableTailMonitor::TableTailMonitor(Listener listener) : m_listener(std::move(listener)) {}
+
+TableTailMonitor::~TableTailMonitor() {
+    std::vector<std::string> ids;
+    {
+        std::lock_guard lock(m_mutex);
+        for (const auto& [id, tail] : m_tails) {
+            ids.push_back(id);
+        }
+    }
+    for (const auto& id : ids) {
+        stop(id);
+    }
+}
+
+std::string TableTailMonitor::start(std::string connectionId, std::string_view table, std::shared_ptr<IDatabaseDriver> driver, Options options) {
+    if (!driver) [[unlikely]] {
+        return {};
+    }
+    options.interval = (std::max)(options.interval, MIN_INTERVAL);
+    options.snapshotRows = std::clamp<size_t>(options.snapshotRows, 1, MAX_SNAPSHOT_ROWS);
+    auto tail = std::make_shared<Tail>();
+    tail->connectionId = std::move(connectionId);
+    tail->table = quoteBracketIdentifier(unquoteBracketIdentifier(table));
+    tail->driver = std::move(driver);
+    tail->options = std::move(options);
+    std::lock_guard lock(m_mutex);
+    tail->id = std::format("tail_{}", m_nextId++);
+    auto id = tail->id;
+    // The map (or stop(), which takes the tail out of it) keeps the tail alive until its thread is joined
+    tail->thread = std::jthread([this, raw = tail.get()](std::stop_token stopToken) { run(*raw, stopToken); });
+    m_tails.emplace(id, std::move(tail));
+    return id;
+}
+
+bool TableTailMonitor::stop(std::string_view tailId) {
+    std::shared_ptr<Tail> tail;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_tails.find(std::string(tailId));
+        if (it == m_tails.end()) {
+            return false;
+        }
+        tail = std::move(it->second);
+        m_tails.erase(it);
+    }
+    tail->thread.request_stop();
+    tail->driver->cancel();
+    tail->thread.join();
+    return true;
+}
+
+std::string_view TableTailMonitor::sessionSetup() noexcept {
+    // Committed rows only, but never wait long behind a writer, and give way if a deadlock ever involves the tail
+    return "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SET LOCK_TIMEOUT 5000; SET DEADLOCK_PRIORITY LOW;";
+}
+
+std::string TableTailMonitor::buildDetectQuery(std::string_view table) {
+    return std::format(R"(DECLARE @object int = OBJECT_ID(N'{}');
+SELECT @object AS object_id, CASE WHEN EXISTS (SELECT 1 FROM sys.change_tracking_tables WHERE object_id = @object) THEN 1 ELSE 0 END AS tracked;
+SELECT c.name, TYPE_NAME(c.system_type_id) AS type_name
+FROM sys.indexes i
+JOIN sys.index_columns ic ON ic.object_id = i.object_id AND ic.index_id = i.index_id
+JOIN sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id
+WHERE i.object_id = @object AND i.is_primary_key = 1
+ORDER BY ic.key_ordinal;
+SELECT name FROM sys.identity_columns WHERE object_id = @object;)",
+                       escapeSqlString(table));
+}
+
+std::expected<TableTailMonitor::Plan, std::string> TableTailMonitor::makePlan(const std::vector<ResultSet>& detect, std::string_view table, std::string_view keyColumn) {
+    if (detect.size() < 3 || detect[0].columns.size() < D_COUNT || detect[1].columns.size() < 2 || detect[2].columns.empty()) [[unlikely]] {
+        return std::unexpected("Table tail: the server returned an unexpected result");
+    }
+    if (detect[0].empty() || detect[0].isNull(0, D_OBJECT)) [[unlikely]] {
+        return std::unexpected(std::format("Table not found: {}", table));
+    }
+    Plan plan{.table = std::string(table)};
+    if (!keyColumn.empty()) {
+        plan.keyColumns.push_back(unquoteBracketIdentifier(keyColumn));
+        return plan;
+    }
+
+    const auto& primaryKey = detect[1];
+    if (integerCell(detect[0], 0, D_TRACKED) != 0 && !primaryKey.empty()) {
+        plan.mode = Mode::ChangeTracking;
+        for (size_t row = 0; row < primaryKey.rowCount(); ++row) {
+            plan.keyColumns.push_back(textCell(primaryKey, row, 0));
+        }
+        return plan;
+    }
+    if (!detect[2].empty()) {
+        plan.keyColumns.push_back(textCell(detect[2], 0, 0));
+        return plan;
+    }
+    if (primaryKey.rowCount() == 1 && std::ranges::find(MONOTONIC_TYPES, textCell(primaryKey, 0, 1)) != MONOTONIC_TYPES.end()) {
+        plan.keyColumns.push_back(textCell(primaryKey, 0, 0));
+        return plan;
+    }
+    return std::unexpected(std::format("{} has neither Change Tracking nor an identity or ascending primary key; pass keyColumn", table));
+}
+
+std::string TableTailMonitor::buildSnapshotQuery(const Plan& plan, size_t rows) {
+    if (plan.mode == Mode::ChangeTracking) {
+        // The version is read first: changes committed while the rows are read come again in the next poll, which the
+        // grid applies by key, rather than being lost
+        return std::format("SELECT CHANGE_TRACKING_CURRENT_VERSION() AS version;\nSELECT TOP ({}) * FROM {} ORDER BY {};", rows, plan.table, orderByKey(plan, "DESC"));
+    }
+    // Style 126 gives dates as ISO 8601, which converts back to the column's type whatever the session's settings
+    return std::format("SELECT TOP ({}) *, CONVERT(nvarchar(64), {}, 126) AS {} FROM {} ORDER BY {};", rows, quoteBracketIdentifier(plan.keyColumns.front()), KEY_TEXT_COLUMN, plan.table,
+                       orderByKey(plan, "DESC"));
+}
+
+ResultSet TableTailMonitor::parseSnapshot(const std::vector<ResultSet>& results, const Plan& plan, Cursor& cursor) {
+    if (plan.mode == Mode::ChangeTracking) {
+        if (results.size() < 2 || results[0].empty() || results[0].isNull(0, 0)) [[unlikely]] {
+            throw std::runtime_error("Table tail: Change Tracking is not enabled on the database");
+        }
+        cursor.version = integerCell(results[0], 0, 0);
+        return results[1];
+    }
+    if (results.empty() || results[0].columns.empty()) [[unlikely]] {
+        throw std::runtime_error("Table tail: the server returned an unexpected result");
+    }
+    const auto& result = results[0];
+    const size_t keyText = result.columns.size() - 1;
+    // Newest first, so the first row holds the highest key
+    if (!result.empty() && !result.isNull(0, keyText)) {
+        cursor.lastKey = textCell(result, 0, keyText);
+    }
+    auto rows = columnsOf(result, 0, keyText);
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        appendCells(rows, result, row);
+    }
+    return rows;
+}
+
+std::string TableTailMonitor::buildChangesQuery(const Plan& plan, const Cursor& cursor, size_t maxRows) {
+    if (plan.mode == Mode::Key) {
+        const auto key = quoteBracketIdentifier(plan.keyColumns.front());
+        const auto filter = cursor.lastKey ? std::format(" WHERE {} > N'{}'", key, escapeSqlString(*cursor.lastKey)) : std::string();
+        return std::format("SELECT TOP ({}) *, CONVERT(nvarchar(64), {}, 126) AS {} FROM {}{} ORDER BY {};", maxRows + 1, key, KEY_TEXT_COLUMN, plan.table, filter, orderByKey(plan, "ASC"));
+    }
+
+    std::string keys;
+    std::string join;
+    for (size_t i = 0; i < plan.keyColumns.size(); ++i) {
+        const auto column = quoteBracketIdentifier(plan.keyColumns[i]);
+        keys += std::format(", ct.{} AS [{}{}]", column, KEY_TEXT_COLUMN, i + 1);
+        join += std::format("{}t.{} = ct.{}", i > 0 ? " AND " : "", column, column);
+    }
+    // Versions older than the retention period are gone: then only the version row comes back, and a new snapshot follows
+    return std::format(R"(DECLARE @current bigint = CHANGE_TRACKING_CURRENT_VERSION();
+DECLARE @valid bit = CASE WHEN CHANGE_TRACKING_MIN_VALID_VERSION(OBJECT_ID(N'{}')) <= {} THEN 1 ELSE 0 END;
+SELECT @current AS version, @valid AS valid;
+IF @valid = 1
+    SELECT TOP ({}) t.*, ct.SYS_CHANGE_OPERATION AS {}{}
+    FROM CHANGETABLE(CHANGES {}, {}) AS ct
+    LEFT JOIN {} AS t ON {}
+    WHERE ct.SYS_CHANGE_VERSION <= @current
+    ORDER BY ct.SYS_CHANGE_VERSION;)",
+                       escapeSqlString(plan.table), cursor.version, maxRows + 1, OPERATION_COLUMN, keys, plan.table, cursor.version, plan.table, join);
+}
+
+TableTailMonitor::Changes TableTailMonitor::parseChanges(const std::vector<ResultSet>& results, const Plan& plan, Cursor& cursor, size_t maxRows) {
+    Changes changes;
+    if (plan.mode == Mode::Key) {
+        if (results.empty() || results[0].columns.empty()) [[unlikely]] {
+            throw std::runtime_error("Table tail: the server returned an unexpected result");
+        }
+        const auto& result = results[0];
+        if (result.rowCount() > maxRows) {
+            changes.reset = true;
+            return changes;
+        }
+        const size_t keyText = result.columns.size() - 1;
+        changes.inserted = columnsOf(result, 0, keyText);
+        for (size_t row = 0; row < result.rowCount(); ++row) {
+            appendCells(changes.inserted, result, row);
+            if (!result.isNull(row, keyText)) {
+                cursor.lastKey = textCell(result, row, keyText);
+            }
+        }
+        return changes;
+    }
+
+    if (results.empty() || results[0].empty() || results[0].columns.size() < 2) [[unlikely]] {
+        throw std::runtime_error("Table tail: the server returned an unexpected result");
+    }
+    if (integerCell(results[0], 0, 1) == 0 || results.size() < 2 || results[1].rowCount() > maxRows) {
+        changes.reset = true;
+        return changes;
+    }
+    const auto& result = results[1];
+    const size_t keyCount = plan.keyColumns.size();
+    if (result.columns.size() < keyCount + 1) [[unlikely]] {
+        throw std::runtime_error("Table tail: the server returned an unexpected result");
+    }
+    const size_t tableColumns = result.columns.size() - keyCount - 1;
+    changes.inserted = columnsOf(result, 0, tableColumns);
+    changes.updated = columnsOf(result, 0, tableColumns);
+    changes.deleted = columnsOf(result, tableColumns + 1, keyCount);
+    for (size_t i = 0; i < keyCount; ++i) {
+        changes.deleted.columns[i].name = plan.keyColumns[i];
+    }
+    // The joined row is NULL when the row is gone by now, whatever the operation recorded then
+    const size_t firstKey = std::ranges::find(result.columns, plan.keyColumns.front(), &ColumnInfo::name) - result.columns.begin();
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        const auto operation = textCell(result, row, tableColumns);
+        const bool gone = operation == "D" || (firstKey < tableColumns && result.isNull(row, firstKey));
+        if (gone) {
+            appendCells(changes.deleted, result, row, tableColumns + 1);
+        } else {
+            appendCells(operation == "I" ? changes.inserted : changes.updated, result, row);
+        }
+    }
+    cursor.version = integerCell(results[0], 0, 0);
+    return changes;
+}
+
+std::string TableTailMonitor::snapshotJson(std::string_view tailId, std::string_view connectionId, uint64_t sequence, const Plan& plan, const ResultSet& rows) {
+    std::string json;
+    appendHeader(json, tailId, connectionId, sequence);
+    json += std::format(R"(,"snapshot":true,"mode":"{}","keyColumns":)", modeName(plan.mode));
+    json += JsonUtils::buildArray(plan.keyColumns, [](std::string& out, const std::string& column) {
+        out += '"';
+        JsonUtils::appendEscaped(out, column);
+        out += '"';
+    });
+    json += ',';
+    JsonUtils::appendColumns(json, rows.columns);
+    json += R"(,"rows":)";
+    appendRows(json, rows);
+    json += '}';
+    return json;
+}
+
+std::string TableTailMonitor::changesJson(std::string_view tailId, std::string_view connectionId, uint64_t sequence, const Changes& changes) {
+    std::string json;
+    appendHeader(json, tailId, connectionId, sequence);
+    json += R"(,"inserted":)";
+    appendRows(json, changes.inserted);
+    json += R"(,"updated":)";
+    appendRows(json, changes.updated);
+    json += R"(,"deleted":)";
+    appendRows(json, changes.deleted);
+    json += '}';
+    return json;
+}
+
+void TableTailMonitor::run(Tail& tail, std::stop_token stop) {
+    try {
+        (void)tail.driver->execute(sessionSetup());
+        auto plan = makePlan(tail.driver->executeMultiple(buildDetectQuery(tail.table)), tail.table, tail.options.keyColumn);
+        if (!plan) [[unlikely]] {
+            throw std::runtime_error(plan.error());
+        }
+        Cursor cursor;
+        bool snapshot = true;
+        uint64_t sequence = 0;
+        while (!stop.stop_requested()) {
+            const auto started = std::chrono::steady_clock::now();
+            std::string event;
+            if (snapshot) {
+                auto rows = parseSnapshot(tail.driver->executeMultiple(buildSnapshotQuery(*plan, tail.options.snapshotRows)), *plan, cursor);
+                event = snapshotJson(tail.id, tail.connectionId, ++sequence, *plan, rows);
+                snapshot = false;
+            } else {
+                auto changes = parseChanges(tail.driver->executeMultiple(buildChangesQuery(*plan, cursor, MAX_CHANGES_PER_POLL)), *plan, cursor, MAX_CHANGES_PER_POLL);
+                if (changes.reset) {
+                    log<LogLevel::DEBUG>(std::format("Table tail {} on {} starts over from a snapshot", tail.id, tail.table));
+                    snapshot = true;
+                    continue;
+                }
+                if (!changes.empty()) {
+                    event = changesJson(tail.id, tail.connectionId, ++sequence, changes);
+                }
+            }
+            const auto finished = std::chrono::steady_clock::now();
+            if (stop.stop_requested()) {
+                break;
+            }
+            if (!event.empty() && m_listener) {
+                m_listener(event);
+            }
+
+            // A server slow to answer gets polled less often rather than harder
+            const auto pause = (std::max)(std::chrono::duration_cast<std::chrono::steady_clock::duration>(tail.options.interval), (finished - started) * MAX_DUTY_FACTOR);
+            std::unique_lock lock(tail.mutex);
+            (void)tail.wake.wait_until(lock, stop, started + pause, [] { return false; });
+        }
+    } catch (const std::exception& e) {
+        if (!stop.stop_requested()) {
+            log<LogLevel::WARNING>(std::format("Table tail on {} stopped: {}", tail.table, e.what()));
+            if (m_listener) {
+                std::string event = R"({"tailId":")";
+                JsonUtils::appendEscaped(event, tail.id);
+                event += R"(","connectionId":")";
+                JsonUtils::appendEscaped(event, tail.connectionId);
+                event += R"(","error":")";
+                JsonUtils::appendEscaped(event, e.what());
+                event += "\"}";
+                m_listener(event);
+            }
+        }
+    }
+    tail.driver->disconnect();
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "driver_interface.h"
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Follows new and changed rows of a table in the background, instead of re-running `SELECT TOP ... ORDER BY id DESC`.
+///
+/// A tail first sends a snapshot of the newest rows, then polls for what changed since. With Change Tracking on the
+/// table, a poll reads CHANGETABLE(CHANGES ...) from the last version seen and reports inserted, updated and deleted
+/// rows by primary key. Otherwise it reads `WHERE key > last` on a monotonic key (the one given, the identity column,
+/// or an integer or date primary key) and reports inserted rows only. Each tail runs on its own thread and dedicated
+/// session, so it never holds a query lane; a poll that finds nothing pushes nothing.
+class TableTailMonitor {
+public:
+    /// Receives snapshotJson() and changesJson() events, and `{"tailId","connectionId","error"}` when a tail stops
+    /// on an error. Called on tail threads; must not block.
+    using Listener = std::function<void(const std::string& eventJson)>;
+
+    enum class Mode { ChangeTracking, Key };
+
+    static constexpr auto DEFAULT_INTERVAL = std::chrono::milliseconds{2000};
+    static constexpr auto MIN_INTERVAL = std::chrono::milliseconds{500};
+    static constexpr int64_t MAX_DUTY_FACTOR = 10;
+    static constexpr size_t DEFAULT_SNAPSHOT_ROWS = 100;
+    static constexpr size_t MAX_SNAPSHOT_ROWS = 10000;
+    /// More changes than this in one poll send a fresh snapshot instead
+    static constexpr size_t MAX_CHANGES_PER_POLL = 5000;
+
+    struct Options {
+        std::string keyColumn;  ///< Monotonic key to tail on; empty = Change Tracking if enabled, else detected
+        size_t snapshotRows = DEFAULT_SNAPSHOT_ROWS;
+        std::chrono::milliseconds interval = DEFAULT_INTERVAL;
+    };
+
+    /// How a table is tailed
+    struct Plan {
+        Mode mode = Mode::Key;
+        std::string table;                    ///< Bracket-quoted
+        std::vector<std::string> keyColumns;  ///< Unquoted: the monotonic key, or the primary key under Change Tracking
+    };
+
+    /// Where the next poll starts
+    struct Cursor {
+        std::optional<std::string> lastKey;  ///< Key mode: canonical text of the highest key seen; nullopt while the table is empty
+        int64_t version = 0;                 ///< Change Tracking version the rows sent so far are current to
+    };
+
+    /// What one poll found; row sets carry the table's columns, `deleted` only the key columns
+    struct Changes {
+        ResultSet inserted;
+        ResultSet updated;
+        ResultSet deleted;
+        bool reset = false;  ///< The tracked version expired or too much changed: send a fresh snapshot instead
+
+        [[nodiscard]] bool empty() const noexcept { return inserted.rowCount() == 0 && updated.rowCount() == 0 && deleted.rowCount() == 0; }
+    };
+
+    explicit TableTailMonitor(Listener listener);
+    ~TableTailMonitor();
+
+    TableTailMonitor(const TableTailMonitor&) = delete;
+    TableTailMonitor& operator=(const TableTailMonitor&) = delete;
+    TableTailMonitor(TableTailMonitor&&) = delete;
+    TableTailMonitor& operator=(TableTailMonitor&&) = delete;
+
+    /// Start tailing `table` through `driver`, which the tail takes over and disconnects when it stops; returns the
+    /// tail id that tags its events
+    std::string start(std::string connectionId, std::string_view table, std::shared_ptr<IDatabaseDriver> driver, Options options);
+    /// Stop a tail, cancelling a poll in flight; false if there was none
+    bool stop(std::string_view tailId);
+
+    /// Session settings of the dedicated connection
+    [[nodiscard]] static std::string_view sessionSetup() noexcept;
+    /// Batch of three result sets for `table` (bracket-quoted): object id and whether Change Tracking is on, the
+    /// primary key columns with their types, the identity column
+    [[nodiscard]] static std::string buildDetectQuery(std::string_view table);
+    /// How to tail `table` from a buildDetectQuery() result; an explicit `keyColumn` wins over Change Tracking
+    [[nodiscard]] static std::expected<Plan, std::string> makePlan(const std::vector<ResultSet>& detect, std::string_view table, std::string_view keyColumn);
+
+    /// Newest `rows` rows, key descending (Key mode adds the canonical key text as a last column)
+    [[nodiscard]] static std::string buildSnapshotQuery(const Plan& plan, size_t rows);
+    /// The rows of a buildSnapshotQuery() result, with `cursor` moved to the point they are current to
+    [[nodiscard]] static ResultSet parseSnapshot(const std::vector<ResultSet>& results, const Plan& plan, Cursor& cursor);
+    /// What changed after `cursor`, at most `maxRows` + 1 rows so an overflow shows
+    [[nodiscard]] static std::string buildChangesQuery(const Plan& plan, const Cursor& cursor, size_t maxRows);
+    /// The changes in a buildChangesQuery() result, with `cursor` moved past them (left alone on reset)
+    [[nodiscard]] static Changes parseChanges(const std::vector<ResultSet>& results, const Plan& plan, Cursor& cursor, size_t maxRows);
+
+    /// `{"tailId","connectionId","sequence","snapshot":true,"mode","keyColumns","columns","rows"}`
+    [[nodiscard]] static std::string snapshotJson(std::string_view tailId, std::string_view connectionId, uint64_t sequence, const Plan& plan, const ResultSet& rows);
+    /// `{"tailId","connectionId","sequence","inserted","updated","deleted"}`, rows as arrays of cell text
+    [[nodiscard]] static std::string changesJson(std::string_view tailId, std::string_view connectionId, uint64_t sequence, const Changes& changes);
+
+private:
+    struct Tail;
+
+    void run(Tail& tail, std::stop_token stop);
+
+    const Listener m_listener;
+    mutable std::mutex m_mutex;  // guards m_tails and m_nextId
+    std::unordered_map<std::string, std::shared_ptr<Tail>> m_tails;
+    uint64_t m_nextId = 1;
+};
+
+}  // namespace velocitydb
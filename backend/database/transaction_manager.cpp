@@ -2,10 +2,124 @@
 
 #include "sqlserver_driver.h"
 
+#include <algorithm>
+#include <format>
 #include <stdexcept>
 
 namespace velocitydb {
 
+namespace {
+
+/// Savepoint flushEdits() opens inside an explicit transaction
+constexpr std::string_view EDIT_SAVEPOINT = "velocitydb_edits";
+
+/// SQL Server caps a table value constructor at 1000 rows
+constexpr size_t MAX_VALUES_ROWS = 1000;
+
+void appendIdentifier(std::string& sql, std::string_view name) {
+    sql += '[';
+    for (char c : name) {
+        sql += c;
+        if (c == ']')
+            sql += ']';
+    }
+    sql += ']';
+}
+
+void appendTable(std::string& sql, const RowEdit& edit) {
+    if (!edit.schema.empty()) {
+        appendIdentifier(sql, edit.schema);
+        sql += '.';
+    }
+    appendIdentifier(sql, edit.table);
+}
+
+void appendLiteral(std::string& sql, const std::optional<std::string>& value) {
+    if (!value) {
+        sql += "NULL";
+        return;
+    }
+    sql += "N'";
+    for (char c : *value) {
+        sql += c;
+        if (c == '\'')
+            sql += '\'';
+    }
+    sql += '\'';
+}
+
+void appendKeyPredicate(std::string& sql, const RowEdit::Cells& key) {
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (i > 0)
+            sql += " AND ";
+        appendIdentifier(sql, key[i].first);
+        if (key[i].second) {
+            sql += " = ";
+            appendLiteral(sql, key[i].second);
+        } else {
+            sql += " IS NULL";
+        }
+    }
+}
+
+void appendOutput(std::string& sql, std::string_view prefix, std::span<const std::string> columns) {
+    sql += " OUTPUT ";
+    if (columns.empty()) {
+        sql += prefix;
+        sql += ".*";
+        return;
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0)
+            sql += ", ";
+        sql += prefix;
+        sql += '.';
+        appendIdentifier(sql, columns[i]);
+    }
+}
+
+void appendParameterPredicate(std::string& sql, const RowEdit::Cells& key) {
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (i > 0)
+            sql += " AND ";
+        appendIdentifier(sql, key[i].first);
+        sql += key[i].second ? " = ?" : " IS NULL";
+    }
+}
+
+bool sameInsertTarget(const RowEdit& a, const RowEdit& b) {
+    return b.kind == RowEdit::Kind::Insert && a.schema == b.schema && a.table == b.table &&
+           std::ranges::equal(a.values, b.values, [](const auto& x, const auto& y) { return x.first == y.first; });
+}
+
+void validateSavepointName(std::string_view name) {
+    const bool valid = !name.empty() && name.size() <= 32 && std::ranges::all_of(name, [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    });
+    if (!valid) [[unlikely]] {
+        throw std::runtime_error(std::format("Invalid savepoint name: {}", name));
+    }
+}
+
+void validateEdit(const RowEdit& edit) {
+    if (edit.table.empty()) [[unlikely]] {
+        throw std::runtime_error("Edit has no table");
+    }
+    // An update or delete without a key would touch every row
+    if (edit.kind != RowEdit::Kind::Insert && edit.key.empty()) [[unlikely]] {
+        throw std::runtime_error(std::format("Edit of {} has no key columns", edit.table));
+    }
+    if (edit.kind != RowEdit::Kind::Delete && edit.values.empty()) [[unlikely]] {
+        throw std::runtime_error(std::format("Edit of {} has no values", edit.table));
+    }
+}
+
+SqlParameter toParameter(const std::optional<std::string>& value) {
+    return value ? SqlParameter{*value} : SqlParameter{};
+}
+
+}  // namespace
+
 TransactionManager::~TransactionManager() {
     if (m_state == TransactionState::Active && m_driver) {
         try {
@@ -16,61 +130,313 @@ TransactionManager::~TransactionManager() {
     }
 }
 
-void TransactionManager::begin() {
+void TransactionManager::requireConnection() const {
     if (!m_driver) [[unlikely]] {
         throw std::runtime_error("TransactionManager: driver not set. Call setDriver() first.");
     }
     if (!m_driver->isConnected()) [[unlikely]] {
         throw std::runtime_error("Not connected to database");
     }
+}
+
+void TransactionManager::executeChecked(std::string_view sql) {
+    [[maybe_unused]] auto result = m_driver->execute(sql);
+    if (!m_driver->getLastError().empty()) [[unlikely]] {
+        throw std::runtime_error(std::string(m_driver->getLastError()));
+    }
+}
 
+void TransactionManager::begin() {
+    requireConnection();
     if (m_state == TransactionState::Active) [[unlikely]] {
         throw std::runtime_error("Transaction already active");
     }
 
-    [[maybe_unused]] auto result = m_driver->execute("BEGIN TRANSACTION");
-    if (!m_driver->getLastError().empty()) [[unlikely]] {
-        throw std::runtime_error(std::string(m_driver->getLastError()));
-    }
+    executeChecked("BEGIN TRANSACTION");
     m_state = TransactionState::Active;
 }
 
 void TransactionManager::commit() {
-    if (!m_driver) [[unlikely]] {
-        throw std::runtime_error("TransactionManager: driver not set. Call setDriver() first.");
-    }
-    if (!m_driver->isConnected()) [[unlikely]] {
-        throw std::runtime_error("Not connected to database");
-    }
-
+    requireConnection();
     if (m_state != TransactionState::Active) [[unlikely]] {
         throw std::runtime_error("No active transaction");
     }
 
-    [[maybe_unused]] auto result = m_driver->execute("COMMIT TRANSACTION");
-    if (!m_driver->getLastError().empty()) [[unlikely]] {
-        throw std::runtime_error(std::string(m_driver->getLastError()));
-    }
+    executeChecked("COMMIT TRANSACTION");
     m_state = TransactionState::Committed;
 }
 
 void TransactionManager::rollback() {
-    if (!m_driver) [[unlikely]] {
-        throw std::runtime_error("TransactionManager: driver not set. Call setDriver() first.");
+    requireConnection();
+    if (m_state != TransactionState::Active) [[unlikely]] {
+        throw std::runtime_error("No active transaction");
     }
-    if (!m_driver->isConnected()) [[unlikely]] {
-        throw std::runtime_error("Not connected to database");
+
+    executeChecked("ROLLBACK TRANSACTION");
+    m_state = TransactionState::RolledBack;
+}
+
+void TransactionManager::savepoint(std::string_view name) {
+    validateSavepointName(name);
+    requireConnection();
+    if (m_state != TransactionState::Active) [[unlikely]] {
+        throw std::runtime_error("Savepoints need an active transaction");
     }
 
+    executeChecked(std::format("SAVE TRANSACTION {}", name));
+}
+
+void TransactionManager::rollbackToSavepoint(std::string_view name) {
+    validateSavepointName(name);
+    requireConnection();
     if (m_state != TransactionState::Active) [[unlikely]] {
         throw std::runtime_error("No active transaction");
     }
 
-    [[maybe_unused]] auto result = m_driver->execute("ROLLBACK TRANSACTION");
-    if (!m_driver->getLastError().empty()) [[unlikely]] {
-        throw std::runtime_error(std::string(m_driver->getLastError()));
+    // Leaves the transaction open; only the work after the savepoint is undone
+    executeChecked(std::format("ROLLBACK TRANSACTION {}", name));
+}
+
+void TransactionManager::queueEdit(RowEdit edit) {
+    validateEdit(edit);
+    m_pendingEdits.push_back(std::move(edit));
+}
+
+int64_t TransactionManager::flushEdits() {
+    requireConnection();
+    if (m_pendingEdits.empty()) {
+        return 0;
     }
-    m_state = TransactionState::RolledBack;
+
+    const bool inTransaction = m_state == TransactionState::Active;
+    std::vector<ResultSet> results;
+    try {
+        results = m_driver->executeMultiple(buildEditBatch(m_pendingEdits, inTransaction ? EDIT_SAVEPOINT : std::string_view{}));
+    } catch (...) {
+        // An error that dooms the transaction (XACT_STATE() = -1) takes the caller's transaction down with it
+        if (inTransaction) {
+            try {
+                auto open = m_driver->execute("SELECT @@TRANCOUNT");
+                if (!open.empty() && open.cellText(0, 0) == "0") {
+                    m_state = TransactionState::RolledBack;
+                }
+            } catch (...) {
+                // Keep the state; the next commit or rollback reports the problem
+            }
+        }
+        throw;
+    }
+    m_pendingEdits.clear();
+
+    if (results.empty() || results.back().empty()) [[unlikely]] {
+        return 0;
+    }
+    return std::stoll(results.back().cellText(0, 0));
+}
+
+std::string TransactionManager::buildEditBatch(std::span<const RowEdit> edits, std::string_view savepoint) {
+    // NOCOUNT keeps the per-statement row counts off the wire; @affected collects them instead
+    std::string sql = "SET NOCOUNT ON;\nDECLARE @affected bigint = 0;\nBEGIN TRY\n";
+    sql += savepoint.empty() ? "BEGIN TRANSACTION;\n" : std::format("SAVE TRANSACTION {};\n", savepoint);
+
+    for (size_t i = 0; i < edits.size();) {
+        const auto& edit = edits[i];
+        switch (edit.kind) {
+            case RowEdit::Kind::Insert: {
+                sql += "INSERT INTO ";
+                appendTable(sql, edit);
+                sql += " (";
+                for (size_t c = 0; c < edit.values.size(); ++c) {
+                    if (c > 0)
+                        sql += ", ";
+                    appendIdentifier(sql, edit.values[c].first);
+                }
+                sql += ") VALUES ";
+                const size_t first = i;
+                do {
+                    sql += i > first ? ",\n(" : "(";
+                    for (size_t c = 0; c < edits[i].values.size(); ++c) {
+                        if (c > 0)
+                            sql += ", ";
+                        appendLiteral(sql, edits[i].values[c].second);
+                    }
+                    sql += ')';
+                    ++i;
+                } while (i < edits.size() && i - first < MAX_VALUES_ROWS && sameInsertTarget(edit, edits[i]));
+                break;
+            }
+            case RowEdit::Kind::Update:
+                sql += "UPDATE ";
+                appendTable(sql, edit);
+                sql += " SET ";
+                for (size_t c = 0; c < edit.values.size(); ++c) {
+                    if (c > 0)
+                        sql += ", ";
+                    appendIdentifier(sql, edit.values[c].first);
+                    sql += " = ";
+                    appendLiteral(sql, edit.values[c].second);
+                }
+                sql += " WHERE ";
+                appendKeyPredicate(sql, edit.key);
+                ++i;
+                break;
+            case RowEdit::Kind::Delete:
+                sql += "DELETE FROM ";
+                appendTable(sql, edit);
+                sql += " WHERE ";
+                appendKeyPredicate(sql, edit.key);
+                ++i;
+                break;
+        }
+        sql += ";\nSET @affected += @@ROWCOUNT;\n";
+    }
+
+    if (savepoint.empty()) {
+        sql += "COMMIT TRANSACTION;\nEND TRY\nBEGIN CATCH\nIF XACT_STATE() <> 0 ROLLBACK TRANSACTION;\n";
+    } else {
+        sql += std::format("END TRY\nBEGIN CATCH\nIF XACT_STATE() = 1 ROLLBACK TRANSACTION {};\nIF XACT_STATE() = -1 ROLLBACK TRANSACTION;\n", savepoint);
+    }
+    sql += "SET NOCOUNT OFF;\nTHROW;\nEND CATCH;\nSET NOCOUNT OFF;\nSELECT @affected AS affected_rows;";
+    return sql;
+}
+
+std::vector<ResultSet> TransactionManager::applyPreparedEdits(std::span<const RowEdit> edits, std::span<const std::string> outputColumns) {
+    requireConnection();
+    for (const auto& edit : edits) {
+        validateEdit(edit);
+    }
+    std::vector<ResultSet> rows;
+    if (edits.empty()) {
+        return rows;
+    }
+    rows.reserve(edits.size());
+
+    // Each statement is its own round trip, so the set is bracketed explicitly rather than in one batch
+    const bool inTransaction = m_state == TransactionState::Active;
+    executeChecked(inTransaction ? std::format("SAVE TRANSACTION {}", EDIT_SAVEPOINT) : std::string("BEGIN TRANSACTION"));
+    try {
+        std::vector<SqlParameter> parameters;
+        for (const auto& edit : edits) {
+            parameters.clear();
+            for (const auto& [column, value] : edit.values) {
+                parameters.push_back(toParameter(value));
+            }
+            for (const auto& [column, value] : edit.key) {
+                if (value) {
+                    parameters.emplace_back(*value);
+                }
+            }
+            auto row = m_driver->executePrepared(buildPreparedEdit(edit, outputColumns), parameters);
+            if (edit.kind != RowEdit::Kind::Insert && row.rowCount() != 1) [[unlikely]] {
+                throw std::runtime_error(std::format("{} of {} matched {} rows instead of one; no edits were saved",
+                                                     edit.kind == RowEdit::Kind::Update ? "Update" : "Delete", edit.table, row.rowCount()));
+            }
+            rows.push_back(std::move(row));
+        }
+        if (!inTransaction) {
+            executeChecked("COMMIT TRANSACTION");
+        }
+    } catch (...) {
+        abandonEdits(inTransaction);
+        throw;
+    }
+    return rows;
+}
+
+void TransactionManager::abandonEdits(bool inTransaction) noexcept {
+    try {
+        auto state = m_driver->execute("SELECT XACT_STATE()");
+        if (!m_driver->getLastError().empty() || state.empty()) [[unlikely]] {
+            return;  // Keep the state; the next commit or rollback reports the problem
+        }
+        const auto xactState = state.cellText(0, 0);
+        if (xactState == "1" && inTransaction) {
+            executeChecked(std::format("ROLLBACK TRANSACTION {}", EDIT_SAVEPOINT));
+            return;
+        }
+        if (xactState != "0") {
+            executeChecked("ROLLBACK TRANSACTION");
+        }
+        if (inTransaction) {
+            m_state = TransactionState::RolledBack;
+        }
+    } catch (...) {
+        // Same as above
+    }
+}
+
+std::string TransactionManager::buildPreparedEdit(const RowEdit& edit, std::span<const std::string> outputColumns) {
+    std::string sql;
+    switch (edit.kind) {
+        case RowEdit::Kind::Insert:
+            sql = "INSERT INTO ";
+            appendTable(sql, edit);
+            sql += " (";
+            for (size_t c = 0; c < edit.values.size(); ++c) {
+                if (c > 0)
+                    sql += ", ";
+                appendIdentifier(sql, edit.values[c].first);
+            }
+            sql += ')';
+            appendOutput(sql, "inserted", outputColumns);
+            sql += " VALUES (";
+            for (size_t c = 0; c < edit.values.size(); ++c) {
+                sql += c > 0 ? ", ?" : "?";
+            }
+            sql += ')';
+            break;
+        case RowEdit::Kind::Update:
+            sql = "UPDATE ";
+            appendTable(sql, edit);
+            sql += " SET ";
+            for (size_t c = 0; c < edit.values.size(); ++c) {
+                if (c > 0)
+                    sql += ", ";
+                appendIdentifier(sql, edit.values[c].first);
+                sql += " = ?";
+            }
+            appendOutput(sql, "inserted", outputColumns);
+            sql += " WHERE ";
+            appendParameterPredicate(sql, edit.key);
+            break;
+        case RowEdit::Kind::Delete: {
+            std::vector<std::string> keyColumns;
+            keyColumns.reserve(edit.key.size());
+            for (const auto& [column, value] : edit.key) {
+                keyColumns.push_back(column);
+            }
+            sql = "DELETE FROM ";
+            appendTable(sql, edit);
+            appendOutput(sql, "deleted", keyColumns);
+            sql += " WHERE ";
+            appendParameterPredicate(sql, edit.key);
+            break;
+        }
+    }
+    return sql;
+}
+
+std::vector<std::string> TransactionManager::primaryKeyColumns(std::string_view schema, std::string_view table) {
+    requireConnection();
+    static constexpr std::string_view keyQuery = R"(
+        SELECT c.name
+        FROM sys.indexes i
+        JOIN sys.index_columns ic ON ic.object_id = i.object_id AND ic.index_id = i.index_id
+        JOIN sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id
+        WHERE i.object_id = OBJECT_ID(?) AND i.is_primary_key = 1
+        ORDER BY ic.key_ordinal
+    )";
+    RowEdit target{.schema = std::string(schema), .table = std::string(table)};
+    std::string name;
+    appendTable(name, target);
+    auto keys = m_driver->executePrepared(keyQuery, {SqlParameter{std::move(name)}});
+
+    std::vector<std::string> columns;
+    columns.reserve(keys.rowCount());
+    for (size_t i = 0; i < keys.rowCount(); ++i) {
+        columns.push_back(keys.cellText(i, 0));
+    }
+    return columns;
 }
 
 }  // namespace velocitydb
@@ -1,7 +1,15 @@
 #pragma once
 
+#include "result_set.h"
+
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace velocitydb {
 
@@ -9,6 +17,19 @@ class SQLServerDriver;
 
 enum class TransactionState { None, Active, Committed, RolledBack };
 
+/// One grid row edit, queued by TransactionManager::queueEdit
+struct RowEdit {
+    enum class Kind : uint8_t { Insert, Update, Delete };
+    /// Column name and value; nullopt is NULL. Values are sent as N'' literals and converted by the server.
+    using Cells = std::vector<std::pair<std::string, std::optional<std::string>>>;
+
+    Kind kind = Kind::Update;
+    std::string schema;  ///< Empty for the default schema
+    std::string table;
+    Cells values;  ///< Columns written (Insert, Update)
+    Cells key;     ///< Columns identifying the row (Update, Delete)
+};
+
 class TransactionManager {
 public:
     TransactionManager() = default;
@@ -20,6 +41,37 @@ public:
     void commit();
     void rollback();
 
+    /// SAVE TRANSACTION / ROLLBACK TRANSACTION to `name` inside the active transaction.
+    /// Names are limited to 32 letters, digits and underscores.
+    void savepoint(std::string_view name);
+    void rollbackToSavepoint(std::string_view name);
+
+    /// Batched edit mode: edits queue up locally and flushEdits() sends them all in one round trip
+    void queueEdit(RowEdit edit);
+    [[nodiscard]] size_t pendingEditCount() const noexcept { return m_pendingEdits.size(); }
+    void discardEdits() noexcept { m_pendingEdits.clear(); }
+
+    /// Apply the queued edits all-or-nothing and return the rows they affected. Outside a transaction the batch
+    /// commits on its own; inside one it runs under a savepoint, so a failing edit rolls back only this batch and
+    /// the transaction stays open (unless the error dooms it). The queue is kept when the batch fails.
+    int64_t flushEdits();
+
+    /// The T-SQL batch flushEdits() sends. Runs of inserts into the same table and columns share one multi-row
+    /// VALUES list. `savepoint` empty: the batch opens and commits its own transaction.
+    [[nodiscard]] static std::string buildEditBatch(std::span<const RowEdit> edits, std::string_view savepoint);
+
+    /// Grid save fast path: apply `edits` all-or-nothing like flushEdits(), but as one prepared statement each,
+    /// and return each edit's row as stored (OUTPUT inserted.`outputColumns` for inserts and updates, every
+    /// column when empty; the deleted key for deletes), so the caller patches what it shows instead of
+    /// querying again. An update or delete that does not hit exactly one row undoes the whole set.
+    [[nodiscard]] std::vector<ResultSet> applyPreparedEdits(std::span<const RowEdit> edits, std::span<const std::string> outputColumns);
+
+    /// The statement applyPreparedEdits() prepares for `edit`: values are bound first, then the non-NULL key cells
+    [[nodiscard]] static std::string buildPreparedEdit(const RowEdit& edit, std::span<const std::string> outputColumns);
+
+    /// Primary key columns of `table` in key order; empty when it has none
+    [[nodiscard]] std::vector<std::string> primaryKeyColumns(std::string_view schema, std::string_view table);
+
     [[nodiscard]] bool isInTransaction() const noexcept { return m_state == TransactionState::Active; }
     [[nodiscard]] TransactionState getState() const noexcept { return m_state; }
 
@@ -27,7 +79,14 @@ public:
     [[nodiscard]] bool isAutoCommit() const noexcept { return m_autoCommit; }
 
 private:
+    void requireConnection() const;
+    void executeChecked(std::string_view sql);
+    /// After a failed edit set: roll back to EDIT_SAVEPOINT, or the whole transaction when the error doomed it
+    /// or the set opened it, and record a transaction that no longer exists
+    void abandonEdits(bool inTransaction) noexcept;
+
     std::shared_ptr<SQLServerDriver> m_driver;
+    std::vector<RowEdit> m_pendingEdits;
     TransactionState m_state = TransactionState::None;
     bool m_autoCommit = true;
 };
@@ -0,0 +1,262 @@
+#include "workload_replay.h"
+
+#include "../parsers/sql_parser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <numeric>
+#include <unordered_map>
+
+namespace velocitydb {
+
+namespace {
+
+/// Fetches every row and keeps none; the target does the same work as for the original query
+class DiscardSink final : public RowBatchSink {
+public:
+    [[nodiscard]] bool onBatch(const ResultSet&) override { return true; }
+};
+
+/// Nearest-rank percentile of sorted `values`
+[[nodiscard]] double sortedPercentile(const std::vector<double>& values, double fraction) noexcept {
+    const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+    return values[(std::max)(rank, size_t{1}) - 1];
+}
+
+[[nodiscard]] double ratio(double replayed, double original) noexcept {
+    return original > 0.0 ? replayed / original : 0.0;
+}
+
+}  // namespace
+
+LatencySummary LatencySummary::of(std::vector<double>& latencies) {
+    if (latencies.empty()) {
+        return {};
+    }
+    std::ranges::sort(latencies);
+    return LatencySummary{.count = latencies.size(),
+                          .minMs = latencies.front(),
+                          .meanMs = std::accumulate(latencies.begin(), latencies.end(), 0.0) / static_cast<double>(latencies.size()),
+                          .p50Ms = sortedPercentile(latencies, 0.5),
+                          .p95Ms = sortedPercentile(latencies, 0.95),
+                          .p99Ms = sortedPercentile(latencies, 0.99),
+                          .maxMs = latencies.back()};
+}
+
+WorkloadReplay::WorkloadReplay(std::vector<HistoryItem> items, Opener open, Options options)
+    : m_open(std::move(open))
+    , m_options(options)
+    , m_startTime(std::chrono::steady_clock::now())
+    , m_endTime(m_startTime) {
+    std::ranges::stable_sort(items, {}, &HistoryItem::timestamp);
+    std::chrono::system_clock::time_point previous;
+    std::chrono::duration<double> offset{0.0};
+    for (auto& item : items) {
+        // A failed original has no timing to compare with; writes are only replayed when asked for
+        if (!item.success || (!m_options.includeWrites && !SQLParser::isReadOnlyQuery(item.sql))) {
+            ++m_skipped;
+            continue;
+        }
+        if (!m_queries.empty() && m_options.speedFactor > 0.0) {
+            const auto gap = (std::min)(std::chrono::duration<double>(item.timestamp - previous), std::chrono::duration<double>(m_options.maxIdle));
+            offset += (std::max)(gap, std::chrono::duration<double>::zero()) / m_options.speedFactor;
+        }
+        previous = item.timestamp;
+        const auto hash = SQLParser::fingerprintHash(SQLParser::fingerprint(item.sql, true));
+        m_queries.push_back(Query{.sql = std::move(item.sql),
+                                  .fingerprintHash = hash,
+                                  .originalMs = item.executionTimeMs,
+                                  .offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset)});
+    }
+    m_outcomes.resize(m_queries.size());
+    if (m_queries.empty()) {
+        return;
+    }
+    const size_t workers = std::clamp<size_t>(m_options.concurrency, 1, MAX_CONCURRENCY);
+    for (size_t i = 0; i < (std::min)(workers, m_queries.size()); ++i) {
+        m_workers.emplace_back([this] { work(); });
+    }
+}
+
+WorkloadReplay::~WorkloadReplay() {
+    cancel();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void WorkloadReplay::cancel() {
+    m_cancelRequested.store(true, std::memory_order_release);
+    std::lock_guard lock(m_mutex);
+    for (auto& [index, driver] : m_running) {
+        driver->cancel();
+    }
+    m_changed.notify_all();
+}
+
+WorkloadReplayProgress WorkloadReplay::progress() const {
+    std::lock_guard lock(m_mutex);
+    WorkloadReplayProgress progress{.total = m_queries.size(),
+                                    .completed = m_completed,
+                                    .failures = m_failures,
+                                    .skipped = m_skipped,
+                                    .done = m_finished == m_queries.size(),
+                                    .cancelled = m_cancelRequested.load(std::memory_order_acquire),
+                                    .maxScheduleLagMs = m_maxLagMs};
+    const auto endTime = progress.done ? m_endTime : std::chrono::steady_clock::now();
+    progress.elapsedMs = std::chrono::duration<double, std::milli>(endTime - m_startTime).count();
+
+    std::vector<double> original;
+    std::vector<double> replayed;
+    original.reserve(m_completed);
+    replayed.reserve(m_completed);
+    for (size_t i = 0; i < m_queries.size(); ++i) {
+        if (m_outcomes[i].success) {
+            original.push_back(m_queries[i].originalMs);
+            replayed.push_back(m_outcomes[i].latencyMs);
+        }
+    }
+    progress.original = LatencySummary::of(original);
+    progress.replayed = LatencySummary::of(replayed);
+    if (progress.done) {
+        progress.shapes = buildReport();
+    }
+    return progress;
+}
+
+bool WorkloadReplay::done() const {
+    std::lock_guard lock(m_mutex);
+    return m_finished == m_queries.size();
+}
+
+std::chrono::steady_clock::time_point WorkloadReplay::endTime() const {
+    std::lock_guard lock(m_mutex);
+    return m_endTime;
+}
+
+void WorkloadReplay::wait() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_finished == m_queries.size(); });
+}
+
+void WorkloadReplay::work() {
+    for (size_t index = m_next.fetch_add(1, std::memory_order_relaxed); index < m_queries.size(); index = m_next.fetch_add(1, std::memory_order_relaxed)) {
+        run(index);
+    }
+}
+
+void WorkloadReplay::run(size_t index) {
+    const auto& query = m_queries[index];
+    Outcome outcome;
+    auto finish = [&] {
+        std::lock_guard lock(m_mutex);
+        m_running.erase(index);
+        if (outcome.ran) {
+            ++m_completed;
+            m_failures += outcome.success ? 0 : 1;
+        }
+        m_outcomes[index] = std::move(outcome);
+        if (++m_finished == m_queries.size()) {
+            m_endTime = std::chrono::steady_clock::now();
+            m_changed.notify_all();
+        }
+    };
+
+    const auto due = m_startTime + query.offset;
+    {
+        std::unique_lock lock(m_mutex);
+        m_changed.wait_until(lock, due, [this] { return m_cancelRequested.load(std::memory_order_acquire); });
+    }
+    if (m_cancelRequested.load(std::memory_order_acquire)) {
+        finish();
+        return;
+    }
+    const auto started = std::chrono::steady_clock::now();
+    if (m_options.speedFactor > 0.0) {
+        const double lagMs = std::chrono::duration<double, std::milli>(started - due).count();
+        std::lock_guard lock(m_mutex);
+        m_maxLagMs = (std::max)(m_maxLagMs, lagMs);
+    }
+
+    outcome.ran = true;
+    std::expected<BroadcastSession, std::string> session;
+    try {
+        session = m_open(query.sql);
+    } catch (const std::exception& e) {
+        session = std::unexpected(e.what());
+    }
+    if (!session || !session->driver) [[unlikely]] {
+        outcome.error = session ? "No driver for the target" : session.error();
+        finish();
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_running[index] = session->driver;
+    }
+    try {
+        DiscardSink sink;
+        const auto summary = session->driver->executeStreaming(query.sql, sink);
+        // The driver's own timing is what the history recorded; wall time only when it has none
+        outcome.latencyMs = summary.executionTimeMs > 0.0 ? summary.executionTimeMs : std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        outcome.success = true;
+    } catch (const std::exception& e) {
+        outcome.error = e.what();
+    }
+    if (session->release) {
+        session->release();
+    }
+    finish();
+}
+
+std::vector<ReplayShapeReport> WorkloadReplay::buildReport() const {
+    struct Group {
+        size_t first = 0;
+        std::vector<double> original;
+        std::vector<double> replayed;
+        size_t failures = 0;
+        std::string lastError;
+    };
+    std::unordered_map<uint64_t, Group> groups;
+    std::vector<uint64_t> order;
+    for (size_t i = 0; i < m_queries.size(); ++i) {
+        const auto& outcome = m_outcomes[i];
+        if (!outcome.ran) {
+            continue;
+        }
+        auto [it, inserted] = groups.try_emplace(m_queries[i].fingerprintHash);
+        auto& group = it->second;
+        if (inserted) {
+            group.first = i;
+            order.push_back(m_queries[i].fingerprintHash);
+        }
+        if (outcome.success) {
+            group.original.push_back(m_queries[i].originalMs);
+            group.replayed.push_back(outcome.latencyMs);
+        } else {
+            ++group.failures;
+            group.lastError = outcome.error;
+        }
+    }
+
+    std::vector<ReplayShapeReport> shapes;
+    shapes.reserve(order.size());
+    for (const auto hash : order) {
+        auto& group = groups[hash];
+        ReplayShapeReport shape{.fingerprintHash = hash, .sql = m_queries[group.first].sql, .failures = group.failures, .lastError = std::move(group.lastError)};
+        shape.original = LatencySummary::of(group.original);
+        shape.replayed = LatencySummary::of(group.replayed);
+        shape.p50Ratio = ratio(shape.replayed.p50Ms, shape.original.p50Ms);
+        shape.p95Ratio = ratio(shape.replayed.p95Ms, shape.original.p95Ms);
+        shape.regressed = shape.replayed.count > 0 && shape.replayed.p95Ms > shape.original.p95Ms * m_options.regressionRatio &&
+                          shape.replayed.p95Ms - shape.original.p95Ms >= m_options.minRegressionMs;
+        shapes.push_back(std::move(shape));
+    }
+    std::ranges::stable_sort(shapes, [](const ReplayShapeReport& a, const ReplayShapeReport& b) {
+        return a.regressed != b.regressed ? a.regressed : a.replayed.p95Ms > b.replayed.p95Ms;
+    });
+    return shapes;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "broadcast_query.h"
+#include "query_history.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Latency distribution of a set of executions
+struct LatencySummary {
+    size_t count = 0;
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+
+    /// Nearest-rank summary of `latencies`; sorts them
+    [[nodiscard]] static LatencySummary of(std::vector<double>& latencies);
+};
+
+/// One query shape (SQLParser fingerprint with literals parameterized) of a replay: the timings recorded in the
+/// history next to the ones measured on the target
+struct ReplayShapeReport {
+    uint64_t fingerprintHash = 0;
+    std::string sql;  ///< Text of the shape's first replayed execution
+    size_t failures = 0;
+    LatencySummary original;
+    LatencySummary replayed;
+    double p50Ratio = 0.0;  ///< replayed / original p50 (0 when the original is 0)
+    double p95Ratio = 0.0;
+    bool regressed = false;  ///< p95 grew past the regression ratio and the minimum delta
+    std::string lastError;
+};
+
+struct WorkloadReplayProgress {
+    size_t total = 0;  ///< Queries to replay (skipped ones excluded)
+    size_t completed = 0;
+    size_t failures = 0;
+    size_t skipped = 0;  ///< History items left out: failed originally, or writes while writes are not replayed
+    bool done = false;
+    bool cancelled = false;
+    double elapsedMs = 0.0;
+    double maxScheduleLagMs = 0.0;  ///< Worst delay of a query past its scheduled start (workers saturated)
+    LatencySummary original;        ///< Over the completed queries
+    LatencySummary replayed;
+    std::vector<ReplayShapeReport> shapes;  ///< Regressions first, then by replayed p95, slowest first; filled once done
+};
+
+/// Replays a slice of the query history against a target connection and compares the latencies it measures
+/// with the ones the history recorded.
+///
+/// Items run in their original order. With a speed factor, each query starts at its original offset from the first
+/// one divided by the factor (idle gaps capped at maxIdle), so the arrival pattern of the real workload is kept and
+/// a saturated target shows as schedule lag; with speed 0 the workers run the queries back to back. Every query
+/// opens a session through the opener (a pooled lane) and streams its rows to nowhere, so large results cost the
+/// target the same as they did originally without being held here.
+class WorkloadReplay {
+public:
+    /// Session for running `sql`; `release` hands it back
+    using Opener = std::function<std::expected<BroadcastSession, std::string>(std::string_view sql)>;
+
+    static constexpr size_t DEFAULT_CONCURRENCY = 4;
+    static constexpr size_t MAX_CONCURRENCY = 64;
+    static constexpr double DEFAULT_REGRESSION_RATIO = 1.5;
+    static constexpr double DEFAULT_MIN_REGRESSION_MS = 5.0;
+    static constexpr std::chrono::milliseconds DEFAULT_MAX_IDLE{std::chrono::seconds(10)};
+
+    struct Options {
+        size_t concurrency = DEFAULT_CONCURRENCY;
+        double speedFactor = 1.0;  ///< 2.0 replays twice as fast as recorded; 0 runs back to back
+        bool includeWrites = false;
+        double regressionRatio = DEFAULT_REGRESSION_RATIO;
+        double minRegressionMs = DEFAULT_MIN_REGRESSION_MS;  ///< p95 growth below this is noise, whatever the ratio
+        std::chrono::milliseconds maxIdle = DEFAULT_MAX_IDLE;
+    };
+
+    /// Starts the workers right away. `items` may come in any order; only successful ones are replayed.
+    WorkloadReplay(std::vector<HistoryItem> items, Opener open, Options options);
+    /// Cancels and waits for the workers
+    ~WorkloadReplay();
+
+    WorkloadReplay(const WorkloadReplay&) = delete;
+    WorkloadReplay& operator=(const WorkloadReplay&) = delete;
+    WorkloadReplay(WorkloadReplay&&) = delete;
+    WorkloadReplay& operator=(WorkloadReplay&&) = delete;
+
+    /// Stop starting queries and cancel the running ones; the report covers what completed
+    void cancel();
+
+    [[nodiscard]] WorkloadReplayProgress progress() const;
+    [[nodiscard]] bool done() const;
+    /// When done() last became true (construction time while still running)
+    [[nodiscard]] std::chrono::steady_clock::time_point endTime() const;
+    /// Block until every query has run
+    void wait();
+
+private:
+    struct Query {
+        std::string sql;
+        uint64_t fingerprintHash = 0;
+        double originalMs = 0.0;
+        std::chrono::steady_clock::duration offset{};  ///< Scheduled start after m_startTime
+    };
+    struct Outcome {
+        double latencyMs = 0.0;
+        bool ran = false;  ///< Started (not skipped by cancel())
+        bool success = false;
+        std::string error;
+    };
+
+    void work();
+    void run(size_t index);
+    /// Per-shape report over the completed queries (m_mutex held)
+    [[nodiscard]] std::vector<ReplayShapeReport> buildReport() const;
+
+    std::vector<Query> m_queries;
+    const Opener m_open;
+    const Options m_options;
+    size_t m_skipped = 0;
+    const std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<size_t> m_next{0};
+    std::atomic<bool> m_cancelRequested{false};
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_changed;
+    std::vector<Outcome> m_outcomes;  ///< By query index
+    std::unordered_map<size_t, std::shared_ptr<IDatabaseDriver>> m_running;  ///< By query index
+    size_t m_finished = 0;   ///< Queries run or skipped by cancel()
+    size_t m_completed = 0;  ///< Queries run
+    size_t m_failures = 0;
+    double m_maxLagMs = 0.0;
+    std::chrono::steady_clock::time_point m_endTime;
+
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace velocitydb
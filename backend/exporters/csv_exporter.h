@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../utils/buffered_file_writer.h"
 #include "data_exporter.h"
 
 namespace velocitydb {
@@ -12,8 +13,22 @@ public:
     bool exportData(const ResultSet& data, const std::string& filepath) override;
     bool exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) override;
 
+    bool beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) override;
+    bool writeBatch(const ResultSet& batch) override;
+    bool finishExport() override;
+
+    /// Progress of the current incremental export
+    [[nodiscard]] size_t rowsWritten() const noexcept { return m_rowsWritten; }
+    [[nodiscard]] size_t bytesWritten() const noexcept { return m_writer.bytesWritten(); }
+
 private:
-    std::string escapeCSV(const std::string& value, const ExportOptions& options) const;
+    /// Write one field, quoting and doubling quotes as needed, directly into the output buffer.
+    void writeField(std::string_view value);
+
+    BufferedFileWriter m_writer;
+    ExportOptions m_options;
+    std::string m_cell;  // Reused for non-text values
+    size_t m_rowsWritten = 0;
 };
 
 }  // namespace velocitydb
@@ -1,8 +1,10 @@
 #pragma once
 
-#include "../database/sqlserver_driver.h"
+#include "../database/result_set.h"
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 namespace velocitydb {
 
@@ -13,6 +15,9 @@ struct ExportOptions {
     std::string nullValue = "";
     std::string lineEnding = "\r\n";
     bool quoteStrings = true;
+    /// Polled between batches, and every CANCEL_CHECK_ROWS rows by exporters that check within one; once raised the
+    /// export stops and the writing call returns false
+    const std::atomic<bool>* cancelRequested = nullptr;
 };
 
 class DataExporter {
@@ -20,6 +25,11 @@ public:
     virtual ~DataExporter() = default;
     virtual bool exportData(const ResultSet& data, const std::string& filepath) = 0;
     virtual bool exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) = 0;
+
+    // Incremental export for streamed results: beginExport, any number of writeBatch calls, then finishExport
+    virtual bool beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) = 0;
+    virtual bool writeBatch(const ResultSet& batch) = 0;
+    virtual bool finishExport() = 0;
 };
 
 }  // namespace velocitydb
@@ -1,18 +1,419 @@
 #include "excel_exporter.h"
 
-#include <stdexcept>
+#include "../utils/civil_date.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
 
 namespace velocitydb {
 
+namespace {
+
+constexpr std::string_view XML_DECLARATION = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+constexpr std::string_view SPREADSHEET_NS = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+constexpr std::string_view RELATIONSHIP_NS = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+
+// Indices into cellXfs of styles.xml
+constexpr int STYLE_HEADER = 1;
+constexpr int STYLE_DATE = 2;
+constexpr int STYLE_DATETIME = 3;
+constexpr int STYLE_TIME = 4;
+
+constexpr std::string_view STYLES_XML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<styleSheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+    "<numFmts count=\"3\"><numFmt numFmtId=\"164\" formatCode=\"yyyy-mm-dd\"/><numFmt numFmtId=\"165\" formatCode=\"yyyy-mm-dd hh:mm:ss\"/>"
+    "<numFmt numFmtId=\"166\" formatCode=\"hh:mm:ss\"/></numFmts>"
+    "<fonts count=\"2\"><font><sz val=\"11\"/><name val=\"Calibri\"/></font><font><b/><sz val=\"11\"/><name val=\"Calibri\"/></font></fonts>"
+    "<fills count=\"2\"><fill><patternFill patternType=\"none\"/></fill><fill><patternFill patternType=\"gray125\"/></fill></fills>"
+    "<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+    "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+    "<cellXfs count=\"5\">"
+    "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+    "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyFont=\"1\"/>"
+    "<xf numFmtId=\"164\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+    "<xf numFmtId=\"165\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+    "<xf numFmtId=\"166\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+    "</cellXfs>"
+    "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>"
+    "</styleSheet>";
+
+constexpr int64_t EXCEL_EPOCH_DAYS = daysFromCivil(1899, 12, 30);
+constexpr int64_t EXCEL_FIRST_VALID_DAYS = daysFromCivil(1900, 3, 1);  // Earlier serials hit the 1900 leap-year bug
+
+[[nodiscard]] std::string columnLetters(size_t index) {
+    std::string letters;
+    for (size_t n = index + 1; n > 0; n = (n - 1) / 26) {
+        letters.insert(letters.begin(), static_cast<char>('A' + (n - 1) % 26));
+    }
+    return letters;
+}
+
+void appendNumber(std::string& out, auto value) {
+    std::array<char, 32> digits{};
+    auto [ptr, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    out.append(digits.data(), ptr);
+}
+
+[[nodiscard]] bool isNumberText(std::string_view text) noexcept {
+    double parsed = 0.0;
+    const char* last = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), last, parsed);
+    return !text.empty() && ec == std::errc{} && ptr == last;
+}
+
+void appendXmlAttribute(std::string& out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+            case '&':
+                out += "&amp;";
+                break;
+            case '<':
+                out += "&lt;";
+                break;
+            case '>':
+                out += "&gt;";
+                break;
+            case '"':
+                out += "&quot;";
+                break;
+            default:
+                out += c;
+                break;
+        }
+    }
+}
+
+/// Sheet names: at most 31 characters and none of []:*?/\ .
+[[nodiscard]] std::string sheetTitle(std::string_view base, size_t sheetNumber) {
+    std::string name;
+    for (char c : base) {
+        name += std::string_view("[]:*?/\\").contains(c) ? '_' : c;
+    }
+    if (name.empty()) {
+        name = "Sheet";
+    }
+    const std::string suffix = sheetNumber > 1 ? std::format("_{}", sheetNumber) : std::string();
+    constexpr size_t MAX_SHEET_NAME = 31;
+    if (name.size() + suffix.size() > MAX_SHEET_NAME) {
+        name.resize(MAX_SHEET_NAME - suffix.size());
+    }
+    return name + suffix;
+}
+
+}  // namespace
+
+ExcelExporter::CellKind ExcelExporter::cellKindFor(SqlType type) noexcept {
+    if (type == SqlType::Bit)
+        return CellKind::Boolean;
+    if (isNumericType(type))
+        return CellKind::Number;
+    if (type == SqlType::Date)
+        return CellKind::Date;
+    if (type == SqlType::Time)
+        return CellKind::Time;
+    if (isDateTimeType(type))
+        return CellKind::DateTime;
+    return CellKind::String;
+}
+
+std::optional<double> ExcelExporter::toExcelSerial(const DateTimeValue& value, bool hasDate) noexcept {
+    const double dayFraction = (value.hour * 3600.0 + value.minute * 60.0 + value.second + value.fraction / 1e9) / 86400.0;
+    if (!hasDate) {
+        return dayFraction;
+    }
+    const int64_t days = daysFromCivil(value.year, value.month, value.day);
+    if (days < EXCEL_FIRST_VALID_DAYS) {
+        return std::nullopt;
+    }
+    return static_cast<double>(days - EXCEL_EPOCH_DAYS) + dayFraction;
+}
+
 bool ExcelExporter::exportData(const ResultSet& data, const std::string& filepath) {
     return exportData(data, filepath, ExportOptions());
 }
 
-bool ExcelExporter::exportData(const ResultSet& /*data*/, const std::string& /*filepath*/, const ExportOptions& /*options*/) {
-    // Excel export is not yet implemented.
-    // Use CSV or JSON export as alternatives.
-    throw std::runtime_error("Excel export is not yet implemented. Please use CSV or JSON export instead. "
-                             "Excel support will be added in a future release.");
+bool ExcelExporter::exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) {
+    if (!beginExport(data.columns, filepath, options)) {
+        return false;
+    }
+    const bool written = writeBatch(data);
+    return finishExport() && written;
+}
+
+bool ExcelExporter::beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) {
+    if (!m_zip.open(filepath)) {
+        return false;
+    }
+    m_options = options;
+    m_columns = columns;
+    m_kinds.clear();
+    m_columnLetters.clear();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        m_kinds.push_back(cellKindFor(columns[i].typeCode()));
+        m_columnLetters.push_back(columnLetters(i));
+    }
+    m_sharedIndex.clear();
+    m_sharedStrings.clear();
+    m_sharedStringBytes = 0;
+    m_sharedStringRefs = 0;
+    m_sheetCount = 0;
+    m_rowsWritten = 0;
+
+    startSheet();
+    return !m_zip.failed();
+}
+
+void ExcelExporter::startSheet() {
+    ++m_sheetCount;
+    m_sheetRows = 0;
+    m_zip.beginEntry(std::format("xl/worksheets/sheet{}.xml", m_sheetCount));
+    m_xml.clear();
+    m_xml += XML_DECLARATION;
+    m_xml += std::format(R"(<worksheet xmlns="{}"><sheetData>)", SPREADSHEET_NS);
+    m_zip.write(m_xml);
+    if (m_options.includeHeader) {
+        writeHeaderRow();
+    }
+}
+
+void ExcelExporter::endSheet() {
+    m_zip.write("</sheetData></worksheet>");
+    m_zip.endEntry();
+}
+
+void ExcelExporter::writeHeaderRow() {
+    ++m_sheetRows;
+    m_xml.clear();
+    m_xml += R"(<row r="1">)";
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        openCell(m_columnLetters[col] + "1", STYLE_HEADER, "inlineStr");
+        writeEscaped(m_columns[col].name);
+        m_xml += "</t></is></c>";
+    }
+    m_xml += "</row>";
+    m_zip.write(m_xml);
+}
+
+bool ExcelExporter::writeBatch(const ResultSet& data) {
+    const size_t rowCount = data.rowCount();
+    const size_t colCount = (std::min)(data.columnData.size(), m_columns.size());
+    std::string cellRef;
+    std::string text;
+    for (size_t row = 0; row < rowCount; ++row) {
+        if (m_sheetRows >= MAX_SHEET_ROWS || m_zip.entryBytes() >= MAX_SHEET_BYTES) [[unlikely]] {
+            endSheet();
+            startSheet();
+        }
+        ++m_sheetRows;
+
+        m_xml.clear();
+        m_xml += R"(<row r=")";
+        appendNumber(m_xml, m_sheetRows);
+        m_xml += R"(">)";
+        for (size_t col = 0; col < colCount; ++col) {
+            const auto& column = data.columnData[col];
+            cellRef.assign(m_columnLetters[col]);
+            appendNumber(cellRef, m_sheetRows);
+
+            if (column.isNull(row)) {
+                // Empty cell unless a NULL placeholder was requested
+                if (!m_options.nullValue.empty()) {
+                    writeStringCell(cellRef, m_options.nullValue);
+                }
+                continue;
+            }
+
+            const CellKind kind = m_kinds[col];
+            const ColumnDataType storage = column.type();
+            int style = 0;
+            std::optional<double> serial;
+            if (storage == ColumnDataType::Date || storage == ColumnDataType::Time || storage == ColumnDataType::Timestamp) {
+                serial = toExcelSerial(column.dateTimeAt(row), storage != ColumnDataType::Time);
+                style = storage == ColumnDataType::Date ? STYLE_DATE : storage == ColumnDataType::Time ? STYLE_TIME : STYLE_DATETIME;
+            }
+
+            if (serial) {
+                openCell(cellRef, style, {});
+                appendNumber(m_xml, *serial);
+                m_xml += "</v></c>";
+            } else if (storage == ColumnDataType::Bit || (kind == CellKind::Boolean && storage == ColumnDataType::Int64)) {
+                openCell(cellRef, 0, "b");
+                m_xml += column.int64At(row) != 0 ? '1' : '0';
+                m_xml += "</v></c>";
+            } else if (storage == ColumnDataType::Int64 || storage == ColumnDataType::Double) {
+                openCell(cellRef, 0, {});
+                column.appendDisplayText(m_xml, row);
+                m_xml += "</v></c>";
+            } else if (storage == ColumnDataType::Text && kind == CellKind::Number && isNumberText(column.textAt(row))) {
+                // DECIMAL/NUMERIC arrive as text to keep their precision; Excel stores them as doubles anyway
+                openCell(cellRef, 0, {});
+                m_xml += column.textAt(row);
+                m_xml += "</v></c>";
+            } else if (storage == ColumnDataType::Text) {
+                writeStringCell(cellRef, column.textAt(row));
+            } else {
+                // Dates Excel cannot represent (before 1900-03-01) are kept as text
+                text.clear();
+                column.appendDisplayText(text, row);
+                writeStringCell(cellRef, text);
+            }
+        }
+        m_xml += "</row>";
+        m_zip.write(m_xml);
+    }
+    m_rowsWritten += rowCount;
+    return !m_zip.failed();
+}
+
+void ExcelExporter::openCell(std::string_view cellRef, int style, std::string_view type) {
+    m_xml += R"(<c r=")";
+    m_xml += cellRef;
+    if (style != 0) {
+        m_xml += R"(" s=")";
+        appendNumber(m_xml, style);
+    }
+    if (!type.empty()) {
+        m_xml += R"(" t=")";
+        m_xml += type;
+    }
+    m_xml += type == "inlineStr" ? R"("><is><t xml:space="preserve">)" : R"("><v>)";
+}
+
+void ExcelExporter::writeStringCell(std::string_view cellRef, std::string_view value) {
+    if (const int64_t index = sharedStringIndex(value); index >= 0) {
+        openCell(cellRef, 0, "s");
+        appendNumber(m_xml, index);
+        m_xml += "</v></c>";
+        return;
+    }
+    if (value.size() > MAX_CELL_TEXT_BYTES) [[unlikely]] {
+        // Excel rejects cells over 32767 characters; cut on a UTF-8 boundary
+        size_t cut = MAX_CELL_TEXT_BYTES;
+        while (cut > 0 && (static_cast<unsigned char>(value[cut]) & 0xC0) == 0x80) {
+            --cut;
+        }
+        value = value.substr(0, cut);
+    }
+    openCell(cellRef, 0, "inlineStr");
+    writeEscaped(value);
+    m_xml += "</t></is></c>";
+}
+
+int64_t ExcelExporter::sharedStringIndex(std::string_view value) {
+    if (value.size() > MAX_SHARED_STRING_LENGTH) {
+        return -1;
+    }
+    if (auto it = m_sharedIndex.find(value); it != m_sharedIndex.end()) {
+        ++m_sharedStringRefs;
+        return it->second;
+    }
+    // Bound the table so high-cardinality text cannot grow it without limit; the rest goes inline
+    if (m_sharedStrings.size() >= MAX_SHARED_STRINGS || m_sharedStringBytes + value.size() > MAX_SHARED_STRING_BYTES) {
+        return -1;
+    }
+    const auto index = static_cast<uint32_t>(m_sharedStrings.size());
+    auto [it, inserted] = m_sharedIndex.emplace(std::string(value), index);
+    m_sharedStrings.push_back(&it->first);
+    m_sharedStringBytes += value.size();
+    ++m_sharedStringRefs;
+    return index;
+}
+
+void ExcelExporter::writeEscaped(std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+            case '&':
+                m_xml += "&amp;";
+                break;
+            case '<':
+                m_xml += "&lt;";
+                break;
+            case '>':
+                m_xml += "&gt;";
+                break;
+            case '\t':
+            case '\n':
+            case '\r':
+                m_xml += c;
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    // Not allowed in XML 1.0; OOXML escapes them as _xHHHH_
+                    m_xml += std::format("_x{:04X}_", static_cast<unsigned>(c));
+                } else {
+                    m_xml += c;
+                }
+                break;
+        }
+    }
+}
+
+bool ExcelExporter::finishExport() {
+    endSheet();
+    const bool metadataWritten = writeMetadata();
+    return m_zip.close() && metadataWritten;
+}
+
+bool ExcelExporter::writeMetadata() {
+    // Shared strings
+    m_zip.beginEntry("xl/sharedStrings.xml");
+    m_xml.clear();
+    m_xml += XML_DECLARATION;
+    m_xml += std::format(R"(<sst xmlns="{}" count="{}" uniqueCount="{}">)", SPREADSHEET_NS, m_sharedStringRefs, m_sharedStrings.size());
+    for (const std::string* value : m_sharedStrings) {
+        m_xml += R"(<si><t xml:space="preserve">)";
+        writeEscaped(*value);
+        m_xml += "</t></si>";
+        if (m_xml.size() >= 64 * 1024) {
+            m_zip.write(m_xml);
+            m_xml.clear();
+        }
+    }
+    m_xml += "</sst>";
+    m_zip.write(m_xml);
+
+    m_zip.beginEntry("xl/styles.xml");
+    m_zip.write(STYLES_XML);
+
+    // Workbook, its relationships and the content types all list every sheet
+    std::string workbook(XML_DECLARATION);
+    workbook += std::format(R"(<workbook xmlns="{}" xmlns:r="{}"><sheets>)", SPREADSHEET_NS, RELATIONSHIP_NS);
+    std::string workbookRels(XML_DECLARATION);
+    workbookRels += R"(<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">)";
+    std::string contentTypes(XML_DECLARATION);
+    contentTypes += R"(<Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">)"
+                    R"(<Default Extension="rels" ContentType="application/vnd.openxmlformats-package.relationships+xml"/>)"
+                    R"(<Default Extension="xml" ContentType="application/xml"/>)"
+                    R"(<Override PartName="/xl/workbook.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml"/>)"
+                    R"(<Override PartName="/xl/styles.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml"/>)"
+                    R"(<Override PartName="/xl/sharedStrings.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml"/>)";
+    for (size_t sheet = 1; sheet <= m_sheetCount; ++sheet) {
+        workbook += R"(<sheet name=")";
+        appendXmlAttribute(workbook, sheetTitle(m_sheetName, sheet));
+        workbook += std::format(R"(" sheetId="{0}" r:id="rId{0}"/>)", sheet);
+        workbookRels += std::format(R"(<Relationship Id="rId{0}" Type="{1}/worksheet" Target="worksheets/sheet{0}.xml"/>)", sheet, RELATIONSHIP_NS);
+        contentTypes += std::format(R"(<Override PartName="/xl/worksheets/sheet{}.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml"/>)", sheet);
+    }
+    workbook += "</sheets></workbook>";
+    workbookRels += std::format(R"(<Relationship Id="rId{}" Type="{}/styles" Target="styles.xml"/>)", m_sheetCount + 1, RELATIONSHIP_NS);
+    workbookRels += std::format(R"(<Relationship Id="rId{}" Type="{}/sharedStrings" Target="sharedStrings.xml"/>)", m_sheetCount + 2, RELATIONSHIP_NS);
+    workbookRels += "</Relationships>";
+    contentTypes += "</Types>";
+
+    m_zip.beginEntry("xl/workbook.xml");
+    m_zip.write(workbook);
+    m_zip.beginEntry("xl/_rels/workbook.xml.rels");
+    m_zip.write(workbookRels);
+    m_zip.beginEntry("[Content_Types].xml");
+    m_zip.write(contentTypes);
+    m_zip.beginEntry("_rels/.rels");
+    m_zip.write(std::format(R"({}<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">)"
+                            R"(<Relationship Id="rId1" Type="{}/officeDocument" Target="xl/workbook.xml"/></Relationships>)",
+                            XML_DECLARATION, RELATIONSHIP_NS));
+    return m_zip.endEntry();
 }
 
 }  // namespace velocitydb
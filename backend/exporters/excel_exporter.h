@@ -1,9 +1,21 @@
 #pragma once
 
+#include "../utils/string_hash.h"
+#include "../utils/zip_writer.h"
 #include "data_exporter.h"
 
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 namespace velocitydb {
 
+/// Streaming XLSX writer: sheet XML is written row by row into the zip archive, so memory use
+/// is bounded by the shared-string table rather than the row count.
 class ExcelExporter : public DataExporter {
 public:
     ExcelExporter() = default;
@@ -12,10 +24,56 @@ public:
     bool exportData(const ResultSet& data, const std::string& filepath) override;
     bool exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) override;
 
+    bool beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) override;
+    bool writeBatch(const ResultSet& batch) override;
+    bool finishExport() override;
+
     void setSheetName(const std::string& name) { m_sheetName = name; }
 
+    [[nodiscard]] size_t rowsWritten() const noexcept { return m_rowsWritten; }
+    [[nodiscard]] size_t sheetCount() const noexcept { return m_sheetCount; }
+
+    static constexpr size_t MAX_SHEET_ROWS = 1048576;  // Excel's per-sheet row limit
+    static constexpr uint64_t MAX_SHEET_BYTES = 0xF0000000ull;  // Roll over before the 4 GB zip entry limit
+    static constexpr size_t MAX_SHARED_STRINGS = 1 << 20;
+    static constexpr size_t MAX_SHARED_STRING_BYTES = 64 * 1024 * 1024;
+    static constexpr size_t MAX_SHARED_STRING_LENGTH = 256;  // Longer values are written inline
+    static constexpr size_t MAX_CELL_TEXT_BYTES = 32767;
+
+    /// Excel serial date (days since 1899-12-30 plus day fraction); nullopt before 1900-03-01
+    [[nodiscard]] static std::optional<double> toExcelSerial(const DateTimeValue& value, bool hasDate) noexcept;
+
 private:
+    enum class CellKind : uint8_t { String, Number, Boolean, Date, Time, DateTime };
+
+    [[nodiscard]] static CellKind cellKindFor(SqlType type) noexcept;
+
+    void startSheet();
+    void endSheet();
+    void writeHeaderRow();
+    /// Append `<c r=".." [s=".."] [t=".."]>` plus the opening value element
+    void openCell(std::string_view cellRef, int style, std::string_view type);
+    void writeStringCell(std::string_view cellRef, std::string_view value);
+    void writeEscaped(std::string_view value);
+    /// Index into the shared-string table, or -1 when the value should be written inline
+    [[nodiscard]] int64_t sharedStringIndex(std::string_view value);
+    [[nodiscard]] bool writeMetadata();
+
     std::string m_sheetName = "Sheet1";
+
+    ZipWriter m_zip;
+    ExportOptions m_options;
+    std::vector<ColumnInfo> m_columns;
+    std::vector<CellKind> m_kinds;
+    std::vector<std::string> m_columnLetters;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> m_sharedIndex;
+    std::vector<const std::string*> m_sharedStrings;  // Keys of m_sharedIndex in index order
+    size_t m_sharedStringBytes = 0;
+    size_t m_sharedStringRefs = 0;
+    std::string m_xml;  // Row assembly buffer, reused
+    size_t m_sheetCount = 0;
+    size_t m_sheetRows = 0;
+    size_t m_rowsWritten = 0;
 };
 
 }  // namespace velocitydb
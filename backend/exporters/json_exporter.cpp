@@ -1,121 +1,191 @@
 #include "json_exporter.h"
 
-#include <fstream>
-#include <iomanip>
-#include <sstream>
+#include "../utils/json_utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
 
 namespace velocitydb {
 
+namespace {
+
+[[nodiscard]] bool isDigit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+/// Append numeric text from the server (DECIMAL, MONEY) as a JSON number. A missing leading zero (".5") is
+/// supplied; anything else that is not shaped like a number is written as a string instead.
+void appendNumberText(std::string& out, std::string_view value) {
+    const bool negative = !value.empty() && value.front() == '-';
+    const auto digits = value.substr(negative ? 1 : 0);
+    if (digits.empty() || !isDigit(digits.back()) || (!isDigit(digits.front()) && digits.front() != '.')) [[unlikely]] {
+        out += '"';
+        JsonUtils::appendEscaped(out, value);
+        out += '"';
+        return;
+    }
+    if (digits.front() == '.') {
+        out += negative ? "-0" : "0";
+        out += digits;
+        return;
+    }
+    out += value;
+}
+
+}  // namespace
+
+JSONExporter::ValueKind JSONExporter::valueKindFor(std::string_view sqlType) noexcept {
+    return sqlType.empty() ? ValueKind::Auto : valueKindFor(sqlTypeFromName(sqlType));
+}
+
+JSONExporter::ValueKind JSONExporter::valueKindFor(SqlType sqlType) noexcept {
+    if (sqlType == SqlType::Bit) {
+        return ValueKind::Boolean;
+    }
+    return isNumericType(sqlType) ? ValueKind::Number : ValueKind::String;
+}
+
 bool JSONExporter::exportData(const ResultSet& data, const std::string& filepath) {
     return exportData(data, filepath, ExportOptions());
 }
 
 bool JSONExporter::exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) {
-    std::ofstream file(filepath);
-    if (!file.is_open()) {
+    if (!beginExport(data.columns, filepath, options)) {
         return false;
     }
+    const bool written = writeBatch(data);
+    return finishExport() && written;
+}
 
-    std::string indent = m_prettyPrint ? "  " : "";
-    std::string newline = m_prettyPrint ? "\n" : "";
-
-    file << "[" << newline;
-
-    for (size_t rowIdx = 0; rowIdx < data.rows.size(); ++rowIdx) {
-        const auto& row = data.rows[rowIdx];
-
-        file << indent << "{" << newline;
-
-        for (size_t colIdx = 0; colIdx < data.columns.size(); ++colIdx) {
-            const auto& col = data.columns[colIdx];
-            const auto& value = row.values[colIdx];
-
-            file << indent << indent << "\"" << escapeJSON(col.name) << "\": ";
-
-            if (value.empty()) {
-                file << "null";
-            } else {
-                // Try to determine if value is numeric
-                bool isNumeric = true;
-                bool hasDecimal = false;
-                for (size_t i = 0; i < value.length(); ++i) {
-                    char c = value[i];
-                    if (c == '.') {
-                        if (hasDecimal) {
-                            isNumeric = false;
-                            break;
-                        }
-                        hasDecimal = true;
-                    } else if (c == '-' && i == 0) {
-                        continue;
-                    } else if (!std::isdigit(c)) {
-                        isNumeric = false;
-                        break;
-                    }
-                }
-
-                if (isNumeric && !value.empty()) {
-                    file << value;
-                } else if (col.type == "BIT") {
-                    file << (value == "1" ? "true" : "false");
-                } else {
-                    file << "\"" << escapeJSON(value) << "\"";
-                }
-            }
-
-            if (colIdx < data.columns.size() - 1) {
-                file << ",";
-            }
-            file << newline;
+bool JSONExporter::beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& /*options*/) {
+    m_gzip.reset();
+    if (m_gzipEnabled) {
+        m_gzip = std::make_unique<GzipWriter>();
+        if (!m_gzip->open(filepath)) [[unlikely]] {
+            m_gzip.reset();
+            return false;
         }
+    } else if (!m_writer.open(filepath)) [[unlikely]] {
+        return false;
+    }
+    m_columns = columns;
+    m_firstRow = true;
+
+    const bool pretty = m_prettyPrint && m_asArray;
+    m_kinds.clear();
+    m_keys.clear();
+    for (const auto& col : m_columns) {
+        m_kinds.push_back(col.sqlType != SqlType::Unknown ? valueKindFor(col.sqlType) : valueKindFor(col.type));
+        std::string key = pretty ? "    \"" : "\"";
+        JsonUtils::appendEscaped(key, col.name);
+        key += pretty ? "\": " : "\":";
+        m_keys.push_back(std::move(key));
+    }
 
-        file << indent << "}";
-        if (rowIdx < data.rows.size() - 1) {
-            file << ",";
-        }
-        file << newline;
+    if (m_asArray) {
+        write(pretty ? "[\n" : "[");
     }
+    return true;
+}
 
-    file << "]" << newline;
+void JSONExporter::write(std::string_view text) {
+    if (m_gzip) {
+        m_gzip->append(text);
+    } else {
+        m_writer.append(text);
+    }
+}
 
-    return true;
+bool JSONExporter::writeBatch(const ResultSet& data) {
+    // Rows are formatted in chunks (each spread across cores by JsonUtils::appendRows) and written chunk by
+    // chunk, so a whole-result export never holds more than one chunk of text
+    const size_t rowCount = data.rowCount();
+    std::string chunk;
+    for (size_t chunkBegin = 0; chunkBegin < rowCount; chunkBegin += ROWS_PER_CHUNK) {
+        const size_t chunkRows = (std::min)(ROWS_PER_CHUNK, rowCount - chunkBegin);
+        chunk.clear();
+        JsonUtils::appendRows(chunk, chunkRows, [&](std::string& out, size_t row) { appendRow(out, data, chunkBegin + row); });
+        write(chunk);
+        m_firstRow = false;
+    }
+    return m_gzip ? !m_gzip->failed() : !m_writer.failed();
 }
 
-std::string JSONExporter::escapeJSON(const std::string& value) const {
-    std::ostringstream result;
-    for (char c : value) {
-        switch (c) {
-            case '"':
-                result << "\\\"";
-                break;
-            case '\\':
-                result << "\\\\";
-                break;
-            case '\b':
-                result << "\\b";
-                break;
-            case '\f':
-                result << "\\f";
-                break;
-            case '\n':
-                result << "\\n";
-                break;
-            case '\r':
-                result << "\\r";
+void JSONExporter::appendRow(std::string& out, const ResultSet& data, size_t rowIdx) const {
+    const bool pretty = m_prettyPrint && m_asArray;
+
+    // Array rows are separated as they are written so batches can be appended without look-ahead
+    if (m_asArray && (rowIdx > 0 || !m_firstRow)) {
+        out += pretty ? ",\n" : ",";
+    }
+    out += pretty ? "  {\n" : "{";
+
+    for (size_t colIdx = 0; colIdx < m_columns.size(); ++colIdx) {
+        const auto& column = data.columnData[colIdx];
+        if (colIdx > 0) {
+            out += pretty ? ",\n" : ",";
+        }
+        out += m_keys[colIdx];
+
+        if (column.isNull(rowIdx)) {
+            out += "null";
+            continue;
+        }
+        auto kind = m_kinds[colIdx];
+        if (kind == ValueKind::Auto) {
+            kind = column.type() == ColumnDataType::Bit ? ValueKind::Boolean : column.isNumeric() ? ValueKind::Number : ValueKind::String;
+        }
+
+        switch (kind) {
+            case ValueKind::Boolean:
+                if (column.type() == ColumnDataType::Text) {
+                    out += column.textAt(rowIdx) == "1" ? "true" : "false";
+                } else {
+                    out += column.int64At(rowIdx) != 0 ? "true" : "false";
+                }
                 break;
-            case '\t':
-                result << "\\t";
+            case ValueKind::Number:
+                if (column.type() == ColumnDataType::Text) {
+                    appendNumberText(out, column.textAt(rowIdx));
+                } else if (column.type() == ColumnDataType::Double && !std::isfinite(column.doubleAt(rowIdx))) [[unlikely]] {
+                    out += "null";  // JSON has no NaN or infinity
+                } else {
+                    column.appendDisplayText(out, rowIdx);
+                }
                 break;
             default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    result << "\\u" << std::hex << std::setfill('0') << std::setw(4) << static_cast<int>(c);
+                out += '"';
+                if (column.type() == ColumnDataType::Text) {
+                    JsonUtils::appendEscaped(out, column.textAt(rowIdx));
                 } else {
-                    result << c;
+                    column.appendDisplayText(out, rowIdx);
                 }
+                out += '"';
                 break;
         }
     }
-    return result.str();
+
+    out += pretty ? "\n  }" : "}";
+    if (!m_asArray) {
+        out += '\n';
+    }
+}
+
+bool JSONExporter::finishExport() {
+    if (m_asArray) {
+        const bool pretty = m_prettyPrint;
+        if (!m_firstRow && pretty) {
+            write("\n");
+        }
+        write(pretty ? "]\n" : "]");
+    }
+    if (m_gzip) {
+        const bool closed = m_gzip->close();
+        m_gzip.reset();
+        return closed;
+    }
+    return m_writer.close();
 }
 
 }  // namespace velocitydb
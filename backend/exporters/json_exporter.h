@@ -1,26 +1,69 @@
 #pragma once
 
+#include "../utils/buffered_file_writer.h"
+#include "../utils/gzip_writer.h"
 #include "data_exporter.h"
 
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
 namespace velocitydb {
 
+/// Writes rows as a JSON array of objects (pretty-printed or compact) or as NDJSON, one compact object per
+/// line. How each column is written is decided once from ColumnInfo::type: BIT as true/false, integer, float,
+/// DECIMAL and MONEY columns as bare numbers, everything else as strings. Output goes through a
+/// BufferedFileWriter, or through a streaming gzip stage when compression is on.
 class JSONExporter : public DataExporter {
 public:
+    /// How a column's values are written
+    enum class ValueKind : uint8_t {
+        Auto,     ///< Unknown SQL type: follows the storage type of each batch
+        Boolean,  ///< true/false
+        Number,   ///< Bare JSON number
+        String,   ///< Quoted display text
+    };
+
     JSONExporter() = default;
     ~JSONExporter() override = default;
 
     bool exportData(const ResultSet& data, const std::string& filepath) override;
     bool exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) override;
 
+    bool beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) override;
+    bool writeBatch(const ResultSet& batch) override;
+    bool finishExport() override;
+
     // Additional JSON-specific options
     void setPrettyPrint(bool pretty) { m_prettyPrint = pretty; }
+    /// false writes NDJSON (one compact object per line, no enclosing array)
     void setArrayFormat(bool asArray) { m_asArray = asArray; }
+    void setGzip(bool gzip) { m_gzipEnabled = gzip; }
+
+    /// Bytes written to the file so far
+    [[nodiscard]] size_t bytesWritten() const noexcept { return m_gzip ? m_gzip->bytesWritten() : m_writer.bytesWritten(); }
+
+    /// Value kind for a SQL type name (case-insensitive); Auto when the name is empty
+    [[nodiscard]] static ValueKind valueKindFor(std::string_view sqlType) noexcept;
+    [[nodiscard]] static ValueKind valueKindFor(SqlType sqlType) noexcept;
 
 private:
-    std::string escapeJSON(const std::string& value) const;
+    static constexpr size_t ROWS_PER_CHUNK = 262144;
+
+    /// Append row `rowIdx` of `data` as one object, preceded by its separator
+    void appendRow(std::string& out, const ResultSet& data, size_t rowIdx) const;
+    void write(std::string_view text);
 
     bool m_prettyPrint = true;
     bool m_asArray = true;
+    bool m_gzipEnabled = false;
+
+    BufferedFileWriter m_writer;
+    std::unique_ptr<GzipWriter> m_gzip;  ///< Set while a compressed export is open
+    std::vector<ColumnInfo> m_columns;
+    std::vector<ValueKind> m_kinds;
+    std::vector<std::string> m_keys;  ///< Escaped, quoted column names followed by the key separator
+    bool m_firstRow = true;
 };
 
 }  // namespace velocitydb
@@ -0,0 +1,774 @@
+#include "parquet_exporter.h"
+
+#include "../utils/civil_date.h"
+#include "../utils/lz4_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr std::string_view MAGIC = "PAR1";
+constexpr std::string_view CREATED_BY = "VelocityDB";
+
+// parquet.thrift enum values
+constexpr int32_t PAGE_DATA = 0;
+constexpr int32_t PAGE_DICTIONARY = 2;
+constexpr int32_t ENCODING_PLAIN = 0;
+constexpr int32_t ENCODING_RLE = 3;
+constexpr int32_t ENCODING_RLE_DICTIONARY = 8;
+constexpr int32_t CODEC_UNCOMPRESSED = 0;
+constexpr int32_t CODEC_LZ4_RAW = 7;
+constexpr int32_t REPETITION_REQUIRED = 0;
+constexpr int32_t REPETITION_OPTIONAL = 1;
+constexpr int32_t CONVERTED_UTF8 = 0;
+constexpr int32_t CONVERTED_DATE = 6;
+constexpr int32_t CONVERTED_UINT_8 = 11;
+constexpr int32_t CONVERTED_INT_16 = 16;
+
+/// Runs of at least this many equal values are RLE-encoded; shorter ones are bit-packed
+constexpr size_t MIN_RLE_RUN = 8;
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+template <typename T>
+void appendLittleEndian(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+/// Thrift compact protocol, the encoding of every Parquet header and of the footer
+class CompactWriter {
+public:
+    explicit CompactWriter(std::string& out) : m_out(out) {}
+
+    void i32(int16_t id, int32_t value) {
+        header(id, I32);
+        appendVarint(m_out, zigzag(value));
+    }
+    void i64(int16_t id, int64_t value) {
+        header(id, I64);
+        appendVarint(m_out, zigzag(value));
+    }
+    void i8(int16_t id, int8_t value) {
+        header(id, BYTE);
+        m_out += static_cast<char>(value);
+    }
+    void boolean(int16_t id, bool value) { header(id, value ? TRUE : FALSE); }
+    void binary(int16_t id, std::string_view value) {
+        header(id, BINARY);
+        appendBinary(value);
+    }
+    void beginStruct(int16_t id) {
+        header(id, STRUCT);
+        beginElement();
+    }
+    /// A struct inside a list; ended by endStruct()
+    void beginElement() {
+        m_parents.push_back(m_lastId);
+        m_lastId = 0;
+    }
+    void endStruct() {
+        m_out += '\0';
+        m_lastId = m_parents.back();
+        m_parents.pop_back();
+    }
+    void emptyStruct(int16_t id) {
+        beginStruct(id);
+        endStruct();
+    }
+    void beginStructList(int16_t id, size_t size) { listHeader(id, STRUCT, size); }
+    void i32List(int16_t id, std::span<const int32_t> values) {
+        listHeader(id, I32, values.size());
+        for (auto value : values) {
+            appendVarint(m_out, zigzag(value));
+        }
+    }
+    void binaryList(int16_t id, std::span<const std::string_view> values) {
+        listHeader(id, BINARY, values.size());
+        for (auto value : values) {
+            appendBinary(value);
+        }
+    }
+    /// End of the top-level struct
+    void end() { m_out += '\0'; }
+
+private:
+    enum : uint8_t { TRUE = 1, FALSE = 2, BYTE = 3, I32 = 5, I64 = 6, BINARY = 8, LIST = 9, STRUCT = 12 };
+
+    [[nodiscard]] static uint64_t zigzag(int64_t value) noexcept { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+
+    void header(int16_t id, uint8_t type) {
+        if (id > m_lastId && id - m_lastId <= 15) {
+            m_out += static_cast<char>(((id - m_lastId) << 4) | type);
+        } else {
+            m_out += static_cast<char>(type);
+            appendVarint(m_out, zigzag(id));
+        }
+        m_lastId = id;
+    }
+    void listHeader(int16_t id, uint8_t elementType, size_t size) {
+        header(id, LIST);
+        if (size < 15) {
+            m_out += static_cast<char>((size << 4) | elementType);
+        } else {
+            m_out += static_cast<char>(0xF0 | elementType);
+            appendVarint(m_out, size);
+        }
+    }
+    void appendBinary(std::string_view value) {
+        appendVarint(m_out, value.size());
+        m_out += value;
+    }
+
+    std::string& m_out;
+    int16_t m_lastId = 0;
+    std::vector<int16_t> m_parents;
+};
+
+/// RLE/bit-packed hybrid encoding of `values` at `bitWidth` bits each (definition levels, dictionary indices)
+template <typename T>
+void appendHybrid(std::string& out, std::span<const T> values, unsigned bitWidth) {
+    const size_t byteWidth = (bitWidth + 7) / 8;
+    auto runAt = [&](size_t i, size_t limit) {
+        size_t run = 1;
+        while (run < limit && i + run < values.size() && values[i + run] == values[i]) {
+            ++run;
+        }
+        return run;
+    };
+    size_t i = 0;
+    while (i < values.size()) {
+        if (const size_t run = runAt(i, SIZE_MAX); run >= MIN_RLE_RUN) {
+            appendVarint(out, run << 1);
+            for (size_t b = 0; b < byteWidth; ++b) {
+                out += static_cast<char>((static_cast<uint64_t>(values[i]) >> (8 * b)) & 0xFF);
+            }
+            i += run;
+            continue;
+        }
+        // Groups of 8 bit-packed values until a long run starts on a group boundary; the last group is zero-padded
+        size_t end = i + 8;
+        while (end < values.size() && runAt(end, MIN_RLE_RUN) < MIN_RLE_RUN) {
+            end += 8;
+        }
+        appendVarint(out, (((end - i) / 8) << 1) | 1);
+        uint64_t bits = 0;
+        unsigned used = 0;
+        for (size_t k = i; k < end; ++k) {
+            bits |= (k < values.size() ? static_cast<uint64_t>(values[k]) : 0) << used;
+            used += bitWidth;
+            for (; used >= 8; used -= 8) {
+                out += static_cast<char>(bits & 0xFF);
+                bits >>= 8;
+            }
+        }
+        i = (std::min)(end, values.size());
+    }
+}
+
+[[nodiscard]] bool equalsIgnoreCase(std::string_view a, std::string_view b) noexcept {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return (x | 0x20) == (y | 0x20); });
+}
+
+[[nodiscard]] int64_t microsOfDay(const DateTimeValue& value) noexcept {
+    return ((value.hour * 60LL + value.minute) * 60 + value.second) * 1'000'000 + value.fraction / 1000;
+}
+
+/// "YYYY-MM-DD", "hh:mm:ss[.fffffff]" or both separated by ' ' or 'T', as text columns hold them
+[[nodiscard]] std::optional<DateTimeValue> parseDateTime(std::string_view text) noexcept {
+    DateTimeValue value;
+    auto number = [&](size_t pos, size_t digits, auto& field) {
+        unsigned parsed = 0;
+        auto [end, error] = std::from_chars(text.data() + pos, text.data() + (std::min)(pos + digits, text.size()), parsed);
+        field = static_cast<std::remove_reference_t<decltype(field)>>(parsed);
+        return error == std::errc{} && end == text.data() + pos + digits;
+    };
+    size_t pos = 0;
+    if (text.size() >= 10 && text[4] == '-' && text[7] == '-') {
+        if (!number(0, 4, value.year) || !number(5, 2, value.month) || !number(8, 2, value.day)) {
+            return std::nullopt;
+        }
+        if (text.size() == 10) {
+            return value;
+        }
+        if (text[10] != ' ' && text[10] != 'T') {
+            return std::nullopt;
+        }
+        pos = 11;
+    }
+    if (text.size() < pos + 8 || text[pos + 2] != ':' || text[pos + 5] != ':' || !number(pos, 2, value.hour) || !number(pos + 3, 2, value.minute) || !number(pos + 6, 2, value.second)) {
+        return std::nullopt;
+    }
+    pos += 8;
+    if (pos < text.size() && text[pos] == '.') {
+        uint32_t scale = 100'000'000;
+        for (++pos; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos, scale /= 10) {
+            value.fraction += static_cast<uint32_t>(text[pos] - '0') * scale;
+        }
+    }
+    return value;
+}
+
+/// Integer of a cell, from any storage type
+[[nodiscard]] std::optional<int64_t> integerAt(const ColumnData& source, size_t row) noexcept {
+    switch (source.type()) {
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            return source.int64At(row);
+        case ColumnDataType::Double:
+            return std::isfinite(source.doubleAt(row)) ? std::optional(static_cast<int64_t>(source.doubleAt(row))) : std::nullopt;
+        case ColumnDataType::Text: {
+            const auto text = source.textAt(row);
+            int64_t value = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return error == std::errc{} && end == text.data() + text.size() ? std::optional(value) : std::nullopt;
+        }
+        default:
+            return std::nullopt;
+    }
+}
+
+[[nodiscard]] std::optional<double> realAt(const ColumnData& source, size_t row) noexcept {
+    if (source.isNumeric()) {
+        return source.numericAt(row);
+    }
+    if (source.type() == ColumnDataType::Text) {
+        const auto text = source.textAt(row);
+        double value = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size() ? std::optional(value) : std::nullopt;
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] std::optional<DateTimeValue> dateTimeAt(const ColumnData& source, size_t row) noexcept {
+    switch (source.type()) {
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            return source.dateTimeAt(row);
+        case ColumnDataType::Text:
+            return parseDateTime(source.textAt(row));
+        default:
+            return std::nullopt;
+    }
+}
+
+/// Run `work(column)` for every column, spread over the hardware threads
+template <typename Work>
+void forEachColumn(size_t columns, Work&& work) {
+    const size_t threads = (std::min)(columns, size_t{(std::max)(std::thread::hardware_concurrency(), 1u)});
+    std::vector<std::exception_ptr> errors(threads);
+    auto run = [&](size_t thread) {
+        try {
+            for (size_t column = thread; column < columns; column += threads) {
+                work(column);
+            }
+        } catch (...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t thread = 1; thread < threads; ++thread) {
+        workers.emplace_back(run, thread);
+    }
+    if (threads > 0) {
+        run(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace
+
+ParquetExporter::ColumnSpec ParquetExporter::columnSpecFor(std::string_view sqlType) noexcept {
+    return columnSpecFor(sqlTypeFromName(sqlType));
+}
+
+ParquetExporter::ColumnSpec ParquetExporter::columnSpecFor(SqlType sqlType) noexcept {
+    switch (sqlType) {
+        case SqlType::Bit:
+            return {Type::Boolean, Logical::None};
+        case SqlType::TinyInt:
+            return {Type::Int32, Logical::UInt8};
+        case SqlType::SmallInt:
+            return {Type::Int32, Logical::Int16};
+        case SqlType::Int:
+            return {Type::Int32, Logical::None};
+        case SqlType::BigInt:
+            return {Type::Int64, Logical::None};
+        case SqlType::Real:
+            return {Type::Float, Logical::None};
+        case SqlType::Float:
+            return {Type::Double, Logical::None};
+        case SqlType::Date:
+            return {Type::Int32, Logical::Date};
+        case SqlType::Time:
+            return {Type::Int64, Logical::TimeMicros};
+        case SqlType::DateTime:
+        case SqlType::SmallDateTime:
+        case SqlType::DateTime2:
+            return {Type::Int64, Logical::TimestampMicros};
+        default:
+            return {Type::ByteArray, Logical::String};
+    }
+}
+
+bool ParquetExporter::exportData(const ResultSet& data, const std::string& filepath) {
+    return exportData(data, filepath, ExportOptions());
+}
+
+bool ParquetExporter::exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) {
+    if (!beginExport(data.columns, filepath, options)) {
+        return false;
+    }
+    const bool written = writeBatch(data);
+    return finishExport() && written;
+}
+
+bool ParquetExporter::beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& /*options*/) {
+    if (!m_writer.open(filepath)) {
+        return false;
+    }
+    m_columns = columns;
+    m_specs.clear();
+    for (const auto& column : columns) {
+        m_specs.push_back(columnSpecFor(column.typeCode()));
+    }
+    m_buffers.assign(columns.size(), {});
+    m_rowGroups.clear();
+    m_bufferedRows = 0;
+    m_bufferedBytes = 0;
+    m_rowsWritten = 0;
+    m_writer.append(MAGIC);
+    return !m_writer.failed();
+}
+
+bool ParquetExporter::writeBatch(const ResultSet& batch) {
+    const size_t rows = batch.rowCount();
+    for (size_t begin = 0; begin < rows;) {
+        const size_t end = begin + (std::min)(rows - begin, m_rowGroupRows - m_bufferedRows);
+        forEachColumn(m_buffers.size(), [&](size_t col) {
+            if (col < batch.columnData.size()) {
+                appendValues(m_buffers[col], m_specs[col], batch.columnData[col], begin, end);
+            } else {
+                m_buffers[col].defined.resize(m_buffers[col].defined.size() + end - begin, 0);
+            }
+        });
+        m_bufferedRows += end - begin;
+        m_bufferedBytes = 0;
+        for (const auto& buffer : m_buffers) {
+            m_bufferedBytes += buffer.ints.size() * sizeof(int64_t) + buffer.doubles.size() * sizeof(double) + buffer.bytes.size();
+        }
+        if ((m_bufferedRows >= m_rowGroupRows || m_bufferedBytes >= ROW_GROUP_BYTES) && !flushRowGroup()) {
+            return false;
+        }
+        begin = end;
+    }
+    return !m_writer.failed();
+}
+
+void ParquetExporter::appendValues(ColumnBuffer& buffer, const ColumnSpec& spec, const ColumnData& source, size_t begin, size_t end) {
+    std::string text;
+    for (size_t row = begin; row < end; ++row) {
+        bool defined = !source.isNull(row);
+        if (defined) {
+            switch (spec.type) {
+                case Type::Boolean:
+                    if (source.type() == ColumnDataType::Text) {
+                        const auto value = source.textAt(row);
+                        defined = value == "1" || value == "0" || equalsIgnoreCase(value, "true") || equalsIgnoreCase(value, "false");
+                        buffer.ints.push_back(value == "1" || equalsIgnoreCase(value, "true") ? 1 : 0);
+                    } else if (auto value = realAt(source, row)) {
+                        buffer.ints.push_back(*value != 0 ? 1 : 0);
+                    } else {
+                        defined = false;
+                    }
+                    break;
+                case Type::Int32:
+                    if (spec.logical == Logical::Date) {
+                        auto value = dateTimeAt(source, row);
+                        defined = value && value->month != 0;
+                        if (defined) {
+                            buffer.ints.push_back(daysFromCivil(value->year, value->month, value->day));
+                        }
+                        break;
+                    }
+                    [[fallthrough]];
+                case Type::Int64:
+                    if (spec.logical == Logical::TimeMicros || spec.logical == Logical::TimestampMicros) {
+                        auto value = dateTimeAt(source, row);
+                        defined = value.has_value();
+                        if (defined) {
+                            const int64_t days = spec.logical == Logical::TimestampMicros && value->month != 0 ? daysFromCivil(value->year, value->month, value->day) : 0;
+                            buffer.ints.push_back(days * 86'400'000'000LL + microsOfDay(*value));
+                        }
+                    } else if (auto value = integerAt(source, row)) {
+                        buffer.ints.push_back(*value);
+                    } else {
+                        defined = false;
+                    }
+                    break;
+                case Type::Float:
+                case Type::Double:
+                    if (auto value = realAt(source, row)) {
+                        buffer.doubles.push_back(*value);
+                    } else {
+                        defined = false;
+                    }
+                    break;
+                case Type::ByteArray:
+                    if (source.type() == ColumnDataType::Text) {
+                        buffer.bytes += source.textAt(row);
+                    } else {
+                        text.clear();
+                        source.appendDisplayText(text, row);
+                        buffer.bytes += text;
+                    }
+                    buffer.ends.push_back(buffer.bytes.size());
+                    break;
+            }
+        }
+        buffer.defined.push_back(defined ? 1 : 0);
+    }
+}
+
+ParquetExporter::EncodedChunk ParquetExporter::encodeChunk(const ColumnBuffer& buffer, const ColumnSpec& spec) const {
+    EncodedChunk chunk;
+    const size_t rows = buffer.defined.size();
+    const size_t values = spec.type == Type::ByteArray ? buffer.ends.size() : spec.type == Type::Float || spec.type == Type::Double ? buffer.doubles.size() : buffer.ints.size();
+    chunk.values = static_cast<int64_t>(rows);
+    chunk.statistics.nullCount = static_cast<int64_t>(rows - values);
+
+    auto bytesAt = [&](size_t i) {
+        const size_t start = i == 0 ? 0 : buffer.ends[i - 1];
+        return std::string_view(buffer.bytes).substr(start, buffer.ends[i] - start);
+    };
+    auto appendPlain = [&](std::string& out, size_t i) {
+        switch (spec.type) {
+            case Type::Int32:
+                appendLittleEndian(out, static_cast<int32_t>(buffer.ints[i]));
+                break;
+            case Type::Int64:
+                appendLittleEndian(out, buffer.ints[i]);
+                break;
+            case Type::Float:
+                appendLittleEndian(out, static_cast<float>(buffer.doubles[i]));
+                break;
+            case Type::Double:
+                appendLittleEndian(out, buffer.doubles[i]);
+                break;
+            case Type::ByteArray:
+                appendLittleEndian(out, static_cast<uint32_t>(bytesAt(i).size()));
+                out += bytesAt(i);
+                break;
+            case Type::Boolean:
+                break;  // Bit-packed by the caller
+        }
+    };
+
+    // Min/max let readers skip row groups; text is left out, where a single long value would bloat the footer
+    if (values > 0 && spec.type != Type::ByteArray && spec.type != Type::Boolean) {
+        size_t minIndex = SIZE_MAX;
+        size_t maxIndex = SIZE_MAX;
+        for (size_t i = 0; i < values; ++i) {
+            if (spec.type == Type::Int32 || spec.type == Type::Int64) {
+                minIndex = minIndex == SIZE_MAX || buffer.ints[i] < buffer.ints[minIndex] ? i : minIndex;
+                maxIndex = maxIndex == SIZE_MAX || buffer.ints[i] > buffer.ints[maxIndex] ? i : maxIndex;
+            } else if (!std::isnan(buffer.doubles[i])) {
+                minIndex = minIndex == SIZE_MAX || buffer.doubles[i] < buffer.doubles[minIndex] ? i : minIndex;
+                maxIndex = maxIndex == SIZE_MAX || buffer.doubles[i] > buffer.doubles[maxIndex] ? i : maxIndex;
+            }
+        }
+        if (minIndex != SIZE_MAX) {
+            appendPlain(chunk.statistics.min.emplace(), minIndex);
+            appendPlain(chunk.statistics.max.emplace(), maxIndex);
+        }
+    }
+
+    // Dictionary while the column repeats itself: the distinct values once, then bit-packed indices per row
+    std::vector<uint32_t> codes;
+    std::string dictionary;
+    if (spec.type != Type::Boolean && values > 0) {
+        std::unordered_map<std::string_view, uint32_t> textCodes;
+        std::unordered_map<uint64_t, uint32_t> numberCodes;
+        codes.reserve(values);
+        for (size_t i = 0; i < values; ++i) {
+            const size_t entries = spec.type == Type::ByteArray ? textCodes.size() : numberCodes.size();
+            std::pair<uint32_t*, bool> inserted;
+            if (spec.type == Type::ByteArray) {
+                auto [it, added] = textCodes.try_emplace(bytesAt(i), static_cast<uint32_t>(entries));
+                inserted = {&it->second, added};
+            } else {
+                const uint64_t key = spec.type == Type::Float || spec.type == Type::Double ? std::bit_cast<uint64_t>(buffer.doubles[i]) : static_cast<uint64_t>(buffer.ints[i]);
+                auto [it, added] = numberCodes.try_emplace(key, static_cast<uint32_t>(entries));
+                inserted = {&it->second, added};
+            }
+            if (inserted.second) {
+                appendPlain(dictionary, i);
+                if (entries + 1 > MAX_DICTIONARY_ENTRIES || dictionary.size() > MAX_DICTIONARY_BYTES) {
+                    codes.clear();
+                    dictionary.clear();
+                    break;
+                }
+            }
+            codes.push_back(*inserted.first);
+        }
+        // Mostly distinct values: the indices would only add to the plain values
+        if ((spec.type == Type::ByteArray ? textCodes.size() : numberCodes.size()) * 2 > values) {
+            codes.clear();
+            dictionary.clear();
+        }
+    }
+    const bool dictionaryEncoded = !codes.empty();
+    unsigned indexWidth = 1;
+    if (dictionaryEncoded) {
+        const uint32_t maxCode = *std::ranges::max_element(codes);
+        indexWidth = (std::max)(1u, static_cast<unsigned>(std::bit_width(maxCode)));
+        appendPage(chunk, true, dictionary, maxCode + 1, false);
+        chunk.dictionaryPageBytes = chunk.bytes.size();
+    }
+
+    std::string body;
+    size_t valueIndex = 0;
+    for (size_t first = 0; first < rows; first += PAGE_ROWS) {
+        const auto levels = std::span(buffer.defined).subspan(first, (std::min)(PAGE_ROWS, rows - first));
+        const auto pageValues = static_cast<size_t>(std::ranges::count(levels, uint8_t{1}));
+        body.clear();
+        body.append(4, '\0');
+        appendHybrid(body, levels, 1);
+        const auto levelBytes = static_cast<uint32_t>(body.size() - 4);
+        std::memcpy(body.data(), &levelBytes, sizeof(levelBytes));
+        if (dictionaryEncoded) {
+            body += static_cast<char>(indexWidth);
+            appendHybrid(body, std::span<const uint32_t>(codes).subspan(valueIndex, pageValues), indexWidth);
+        } else if (spec.type == Type::Boolean) {
+            uint8_t bits = 0;
+            for (size_t i = 0; i < pageValues; ++i) {
+                bits |= static_cast<uint8_t>((buffer.ints[valueIndex + i] & 1) << (i % 8));
+                if (i % 8 == 7 || i + 1 == pageValues) {
+                    body += static_cast<char>(bits);
+                    bits = 0;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < pageValues; ++i) {
+                appendPlain(body, valueIndex + i);
+            }
+        }
+        valueIndex += pageValues;
+        appendPage(chunk, false, body, levels.size(), dictionaryEncoded);
+    }
+    return chunk;
+}
+
+void ParquetExporter::appendPage(EncodedChunk& chunk, bool dictionaryPage, std::string_view body, size_t values, bool dictionaryEncoded) const {
+    std::string compressed;
+    if (m_compress) {
+        compressed.resize(Lz4Codec::compressBound(body.size()));
+        const size_t size = Lz4Codec::compress(body, compressed.data(), compressed.size());
+        if (size == 0 && !body.empty()) [[unlikely]] {
+            throw std::runtime_error("Parquet page is too large to compress");
+        }
+        compressed.resize(size);
+    }
+    const std::string_view stored = m_compress ? std::string_view(compressed) : body;
+
+    std::string header;
+    CompactWriter writer(header);
+    writer.i32(1, dictionaryPage ? PAGE_DICTIONARY : PAGE_DATA);
+    writer.i32(2, static_cast<int32_t>(body.size()));
+    writer.i32(3, static_cast<int32_t>(stored.size()));
+    if (dictionaryPage) {
+        writer.beginStruct(7);
+        writer.i32(1, static_cast<int32_t>(values));
+        writer.i32(2, ENCODING_PLAIN);
+        writer.endStruct();
+    } else {
+        writer.beginStruct(5);
+        writer.i32(1, static_cast<int32_t>(values));
+        writer.i32(2, dictionaryEncoded ? ENCODING_RLE_DICTIONARY : ENCODING_PLAIN);
+        writer.i32(3, ENCODING_RLE);
+        writer.i32(4, ENCODING_RLE);
+        writer.endStruct();
+    }
+    writer.end();
+
+    chunk.bytes += header;
+    chunk.bytes += stored;
+    chunk.uncompressedBytes += static_cast<int64_t>(header.size() + body.size());
+}
+
+bool ParquetExporter::flushRowGroup() {
+    if (m_bufferedRows == 0) {
+        return true;
+    }
+    // Every column chunk of the row group is encoded and compressed at once; only the writes are serial
+    std::vector<EncodedChunk> chunks(m_buffers.size());
+    forEachColumn(m_buffers.size(), [&](size_t col) {
+        chunks[col] = encodeChunk(m_buffers[col], m_specs[col]);
+        m_buffers[col] = {};
+    });
+
+    RowGroupMeta group{.rows = static_cast<int64_t>(m_bufferedRows)};
+    for (auto& chunk : chunks) {
+        const auto offset = static_cast<int64_t>(m_writer.bytesWritten());
+        m_writer.append(chunk.bytes);
+        group.bytes += chunk.uncompressedBytes;
+        group.columns.push_back(ChunkMeta{.offset = offset,
+                                          .dataPageOffset = offset + static_cast<int64_t>(chunk.dictionaryPageBytes),
+                                          .dictionary = chunk.dictionaryPageBytes > 0,
+                                          .compressedBytes = static_cast<int64_t>(chunk.bytes.size()),
+                                          .uncompressedBytes = chunk.uncompressedBytes,
+                                          .values = chunk.values,
+                                          .statistics = std::move(chunk.statistics)});
+    }
+    m_rowGroups.push_back(std::move(group));
+    m_rowsWritten += m_bufferedRows;
+    m_bufferedRows = 0;
+    m_bufferedBytes = 0;
+    return !m_writer.failed();
+}
+
+std::string ParquetExporter::fileMetadata() const {
+    std::string out;
+    CompactWriter writer(out);
+    writer.i32(1, 1);
+
+    writer.beginStructList(2, m_columns.size() + 1);
+    writer.beginElement();
+    writer.i32(3, REPETITION_REQUIRED);
+    writer.binary(4, "schema");
+    writer.i32(5, static_cast<int32_t>(m_columns.size()));
+    writer.endStruct();
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        const auto& spec = m_specs[col];
+        writer.beginElement();
+        writer.i32(1, static_cast<int32_t>(spec.type));
+        writer.i32(3, REPETITION_OPTIONAL);
+        writer.binary(4, m_columns[col].name);
+        switch (spec.logical) {
+            case Logical::String:
+                writer.i32(6, CONVERTED_UTF8);
+                writer.beginStruct(10);
+                writer.emptyStruct(1);
+                writer.endStruct();
+                break;
+            case Logical::Date:
+                writer.i32(6, CONVERTED_DATE);
+                writer.beginStruct(10);
+                writer.emptyStruct(6);
+                writer.endStruct();
+                break;
+            case Logical::UInt8:
+            case Logical::Int16:
+                writer.i32(6, spec.logical == Logical::UInt8 ? CONVERTED_UINT_8 : CONVERTED_INT_16);
+                writer.beginStruct(10);
+                writer.beginStruct(10);
+                writer.i8(1, spec.logical == Logical::UInt8 ? 8 : 16);
+                writer.boolean(2, spec.logical == Logical::Int16);
+                writer.endStruct();
+                writer.endStruct();
+                break;
+            case Logical::TimeMicros:
+            case Logical::TimestampMicros:
+                // Local wall-clock values: the legacy converted types would claim UTC, so only the logical type is set
+                writer.beginStruct(10);
+                writer.beginStruct(spec.logical == Logical::TimeMicros ? 7 : 8);
+                writer.boolean(1, false);
+                writer.beginStruct(2);
+                writer.emptyStruct(2);
+                writer.endStruct();
+                writer.endStruct();
+                writer.endStruct();
+                break;
+            case Logical::None:
+                break;
+        }
+        writer.endStruct();
+    }
+
+    writer.i64(3, static_cast<int64_t>(m_rowsWritten));
+    writer.beginStructList(4, m_rowGroups.size());
+    for (const auto& group : m_rowGroups) {
+        writer.beginElement();
+        writer.beginStructList(1, group.columns.size());
+        for (size_t col = 0; col < group.columns.size(); ++col) {
+            const auto& chunk = group.columns[col];
+            writer.beginElement();
+            writer.i64(2, chunk.offset);
+            writer.beginStruct(3);
+            writer.i32(1, static_cast<int32_t>(m_specs[col].type));
+            const std::array<int32_t, 3> encodings{ENCODING_PLAIN, ENCODING_RLE, ENCODING_RLE_DICTIONARY};
+            writer.i32List(2, std::span(encodings).first(chunk.dictionary ? 3 : 2));
+            const std::string_view path[] = {m_columns[col].name};
+            writer.binaryList(3, path);
+            writer.i32(4, m_compress ? CODEC_LZ4_RAW : CODEC_UNCOMPRESSED);
+            writer.i64(5, chunk.values);
+            writer.i64(6, chunk.uncompressedBytes);
+            writer.i64(7, chunk.compressedBytes);
+            writer.i64(9, chunk.dataPageOffset);
+            if (chunk.dictionary) {
+                writer.i64(11, chunk.offset);
+            }
+            writer.beginStruct(12);
+            writer.i64(3, chunk.statistics.nullCount);
+            if (chunk.statistics.min) {
+                writer.binary(5, *chunk.statistics.max);
+                writer.binary(6, *chunk.statistics.min);
+            }
+            writer.endStruct();
+            writer.endStruct();
+            writer.endStruct();
+        }
+        writer.i64(2, group.bytes);
+        writer.i64(3, group.rows);
+        writer.endStruct();
+    }
+    writer.binary(6, CREATED_BY);
+    writer.end();
+    return out;
+}
+
+bool ParquetExporter::finishExport() {
+    if (!m_writer.isOpen()) {
+        return false;
+    }
+    bool ok = flushRowGroup();
+    const auto footer = fileMetadata();
+    m_writer.append(footer);
+    std::string trailer;
+    appendLittleEndian(trailer, static_cast<uint32_t>(footer.size()));
+    trailer += MAGIC;
+    m_writer.append(trailer);
+    ok = m_writer.close() && ok;
+    m_buffers.clear();
+    return ok;
+}
+
+}  // namespace velocitydb
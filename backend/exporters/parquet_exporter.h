@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../utils/buffered_file_writer.h"
+#include "data_exporter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Streaming Parquet writer. Rows are buffered per column until a row group is full; the row group's column
+/// chunks are then encoded on worker threads at once (dictionary + RLE/bit-packed indices while a column has few
+/// distinct values, PLAIN otherwise; OPTIONAL definition levels as RLE) and written in column order. Pages are
+/// compressed with LZ4 (Parquet's LZ4_RAW codec) unless compression is turned off.
+///
+/// The Parquet type of a column follows ColumnInfo::type: integers, REAL/FLOAT, BIT, DATE, TIME (micros) and
+/// DATETIME/DATETIME2/SMALLDATETIME (micros, not UTC-adjusted) are typed; everything else, DECIMAL and MONEY
+/// included, is written as UTF-8 text so no precision is lost.
+class ParquetExporter : public DataExporter {
+public:
+    static constexpr size_t DEFAULT_ROW_GROUP_ROWS = 1 << 20;
+    static constexpr size_t ROW_GROUP_BYTES = 128 * 1024 * 1024;  ///< Buffered value bytes that also close a row group
+    static constexpr size_t PAGE_ROWS = 64 * 1024;
+    static constexpr size_t MAX_DICTIONARY_ENTRIES = 1 << 16;
+    static constexpr size_t MAX_DICTIONARY_BYTES = 1024 * 1024;
+
+    enum class Type : uint8_t { Boolean = 0, Int32 = 1, Int64 = 2, Float = 4, Double = 5, ByteArray = 6 };
+    enum class Logical : uint8_t { None, String, Date, TimeMicros, TimestampMicros, UInt8, Int16 };
+    struct ColumnSpec {
+        Type type = Type::ByteArray;
+        Logical logical = Logical::String;
+    };
+
+    ParquetExporter() = default;
+    ~ParquetExporter() override = default;
+
+    bool exportData(const ResultSet& data, const std::string& filepath) override;
+    bool exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) override;
+
+    bool beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) override;
+    bool writeBatch(const ResultSet& batch) override;
+    bool finishExport() override;
+
+    void setCompression(bool lz4) noexcept { m_compress = lz4; }
+    void setRowGroupRows(size_t rows) noexcept { m_rowGroupRows = (std::max)(rows, size_t{1}); }
+
+    [[nodiscard]] size_t rowsWritten() const noexcept { return m_rowsWritten; }
+    [[nodiscard]] size_t rowGroupCount() const noexcept { return m_rowGroups.size(); }
+    [[nodiscard]] size_t bytesWritten() const noexcept { return m_writer.bytesWritten(); }
+
+    /// Parquet type for a SQL type name (case-insensitive)
+    [[nodiscard]] static ColumnSpec columnSpecFor(std::string_view sqlType) noexcept;
+    [[nodiscard]] static ColumnSpec columnSpecFor(SqlType sqlType) noexcept;
+
+private:
+    /// Rows of one column waiting for the next row group; only non-NULL values are stored
+    struct ColumnBuffer {
+        std::vector<uint8_t> defined;  ///< Definition level per row: 1 = value, 0 = NULL
+        std::vector<int64_t> ints;     ///< BOOLEAN, INT32 and INT64
+        std::vector<double> doubles;   ///< FLOAT and DOUBLE
+        std::string bytes;             ///< BYTE_ARRAY values back to back...
+        std::vector<size_t> ends;      ///< ...and where each one ends
+    };
+
+    struct Statistics {
+        int64_t nullCount = 0;
+        std::optional<std::string> min;  ///< PLAIN-encoded
+        std::optional<std::string> max;
+    };
+
+    /// One column chunk, encoded but not yet placed in the file
+    struct EncodedChunk {
+        std::string bytes;  ///< Dictionary page (if any), then the data pages
+        size_t dictionaryPageBytes = 0;
+        int64_t uncompressedBytes = 0;
+        int64_t values = 0;
+        Statistics statistics;
+    };
+
+    struct ChunkMeta {
+        int64_t offset = 0;
+        int64_t dataPageOffset = 0;
+        bool dictionary = false;
+        int64_t compressedBytes = 0;
+        int64_t uncompressedBytes = 0;
+        int64_t values = 0;
+        Statistics statistics;
+    };
+
+    struct RowGroupMeta {
+        int64_t rows = 0;
+        int64_t bytes = 0;
+        std::vector<ChunkMeta> columns;
+    };
+
+    /// Append rows [begin, end) of `source` to `buffer`, converted to the column's Parquet type
+    static void appendValues(ColumnBuffer& buffer, const ColumnSpec& spec, const ColumnData& source, size_t begin, size_t end);
+    [[nodiscard]] EncodedChunk encodeChunk(const ColumnBuffer& buffer, const ColumnSpec& spec) const;
+    /// Compress `body` and append it with its page header
+    void appendPage(EncodedChunk& chunk, bool dictionaryPage, std::string_view body, size_t values, bool dictionaryEncoded) const;
+    bool flushRowGroup();
+    [[nodiscard]] std::string fileMetadata() const;
+
+    BufferedFileWriter m_writer;
+    std::vector<ColumnInfo> m_columns;
+    std::vector<ColumnSpec> m_specs;
+    std::vector<ColumnBuffer> m_buffers;
+    std::vector<RowGroupMeta> m_rowGroups;
+    size_t m_bufferedRows = 0;
+    size_t m_bufferedBytes = 0;
+    size_t m_rowsWritten = 0;
+    size_t m_rowGroupRows = DEFAULT_ROW_GROUP_ROWS;
+    bool m_compress = true;
+};
+
+}  // namespace velocitydb
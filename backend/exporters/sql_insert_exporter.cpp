@@ -0,0 +1,269 @@
+#include "sql_insert_exporter.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] bool isDigit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+/// Numeric text from the server (DECIMAL, MONEY, numbers of other drivers) that can be written bare
+[[nodiscard]] bool isNumberText(std::string_view value) noexcept {
+    if (!value.empty() && (value.front() == '-' || value.front() == '+')) {
+        value.remove_prefix(1);
+    }
+    bool digits = false;
+    bool point = false;
+    bool exponent = false;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const char c = value[i];
+        if (isDigit(c)) {
+            digits = true;
+        } else if (c == '.' && !point && !exponent) {
+            point = true;
+        } else if ((c == 'e' || c == 'E') && digits && !exponent) {
+            exponent = true;
+            digits = false;
+            if (i + 1 < value.size() && (value[i + 1] == '-' || value[i + 1] == '+')) {
+                ++i;
+            }
+        } else {
+            return false;
+        }
+    }
+    return digits;
+}
+
+}  // namespace
+
+SqlInsertExporter::LiteralKind SqlInsertExporter::literalKindFor(SqlType sqlType) noexcept {
+    switch (sqlType) {
+        case SqlType::Unknown:
+            return LiteralKind::Auto;
+        case SqlType::Bit:
+            return LiteralKind::Bit;
+        case SqlType::Binary:
+        case SqlType::VarBinary:
+            return LiteralKind::Binary;
+        case SqlType::Date:
+            return LiteralKind::Date;
+        case SqlType::DateTime:
+        case SqlType::SmallDateTime:
+        case SqlType::DateTime2:
+            return LiteralKind::DateTime;
+        default:
+            return isNumericType(sqlType) ? LiteralKind::Number : LiteralKind::String;
+    }
+}
+
+void SqlInsertExporter::setTable(std::string_view table) {
+    m_table = quoteBracketIdentifier(unquoteBracketIdentifier(table));
+}
+
+void SqlInsertExporter::setRowsPerStatement(size_t rows) noexcept {
+    m_rowsPerStatement = std::clamp<size_t>(rows, 1, MAX_ROWS_PER_STATEMENT);
+}
+
+bool SqlInsertExporter::exportData(const ResultSet& data, const std::string& filepath) {
+    return exportData(data, filepath, ExportOptions());
+}
+
+bool SqlInsertExporter::exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) {
+    if (!beginExport(data.columns, filepath, options)) {
+        return false;
+    }
+    const bool written = writeBatch(data);
+    return finishExport() && written;
+}
+
+bool SqlInsertExporter::beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) {
+    if (!m_writer.open(filepath)) {
+        return false;
+    }
+    m_lineEnding = options.lineEnding;
+    m_rowsInStatement = 0;
+    m_statementsSinceGo = 0;
+    m_rowsWritten = 0;
+
+    m_kinds.clear();
+    m_prefix = "INSERT INTO " + m_table + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        m_kinds.push_back(literalKindFor(columns[i].typeCode()));
+        m_prefix += i > 0 ? ", " : "";
+        m_prefix += detail::quoteSinglePart(columns[i].name);  // Column names may contain dots
+    }
+    m_prefix += ") VALUES";
+    m_prefix += m_lineEnding;
+    return !m_writer.failed();
+}
+
+bool SqlInsertExporter::writeBatch(const ResultSet& data) {
+    const size_t rowCount = data.rowCount();
+    const size_t colCount = (std::min)(data.columnData.size(), m_kinds.size());
+    for (size_t rowIdx = 0; rowIdx < rowCount; ++rowIdx) {
+        if (m_rowsInStatement == 0) {
+            m_writer.append(m_prefix);
+        } else {
+            m_writer.append(',');
+            m_writer.append(m_lineEnding);
+        }
+        m_writer.append('(');
+        for (size_t i = 0; i < colCount; ++i) {
+            if (i > 0) {
+                m_writer.append(", ");
+            }
+            writeValue(data.columnData[i], rowIdx, m_kinds[i]);
+        }
+        m_writer.append(')');
+        if (++m_rowsInStatement == m_rowsPerStatement) {
+            endStatement();
+        }
+    }
+    m_rowsWritten += rowCount;
+    return !m_writer.failed();
+}
+
+bool SqlInsertExporter::finishExport() {
+    if (m_rowsInStatement > 0) {
+        endStatement();
+    }
+    if (m_goEvery > 0 && m_statementsSinceGo > 0) {
+        m_writer.append("GO");
+        m_writer.append(m_lineEnding);
+    }
+    return m_writer.close();
+}
+
+void SqlInsertExporter::endStatement() {
+    m_writer.append(';');
+    m_writer.append(m_lineEnding);
+    m_rowsInStatement = 0;
+    if (++m_statementsSinceGo == m_goEvery) {
+        m_writer.append("GO");
+        m_writer.append(m_lineEnding);
+        m_statementsSinceGo = 0;
+    }
+}
+
+void SqlInsertExporter::writeValue(const ColumnData& column, size_t row, LiteralKind kind) {
+    if (column.isNull(row)) {
+        m_writer.append("NULL");
+        return;
+    }
+    const bool text = column.type() == ColumnDataType::Text;
+    if (kind == LiteralKind::Auto) {
+        switch (column.type()) {
+            case ColumnDataType::Int64:
+            case ColumnDataType::Double:
+                kind = LiteralKind::Number;
+                break;
+            case ColumnDataType::Bit:
+                kind = LiteralKind::Bit;
+                break;
+            case ColumnDataType::Date:
+                kind = LiteralKind::Date;
+                break;
+            case ColumnDataType::Timestamp:
+                kind = LiteralKind::DateTime;
+                break;
+            case ColumnDataType::Binary:
+                kind = LiteralKind::Binary;
+                break;
+            default:
+                kind = LiteralKind::String;
+                break;
+        }
+    }
+
+    switch (kind) {
+        case LiteralKind::Number:
+            if (text) {
+                if (const auto value = column.textAt(row); isNumberText(value)) {
+                    m_writer.append(value);
+                } else {
+                    writeString(value);
+                }
+            } else if (column.type() == ColumnDataType::Double && !std::isfinite(column.doubleAt(row))) [[unlikely]] {
+                m_writer.append("NULL");  // T-SQL has no NaN or infinity literal
+            } else {
+                m_cell.clear();
+                column.appendDisplayText(m_cell, row);
+                m_writer.append(m_cell);
+            }
+            return;
+        case LiteralKind::Bit:
+            if (text) {
+                const auto value = column.textAt(row);
+                m_writer.append(value == "1" || value == "true" || value == "True" ? '1' : '0');
+            } else {
+                m_writer.append(column.int64At(row) != 0 ? '1' : '0');
+            }
+            return;
+        case LiteralKind::Binary: {
+            m_writer.append("0x");
+            if (column.type() == ColumnDataType::Binary) {
+                m_cell.clear();
+                column.appendDisplayText(m_cell, row);
+                m_writer.append(m_cell);
+                return;
+            }
+            // Text fetched as hex digits; some drivers keep the 0x prefix
+            auto hex = text ? column.textAt(row) : std::string_view{};
+            if (hex.starts_with("0x") || hex.starts_with("0X")) {
+                hex.remove_prefix(2);
+            }
+            m_writer.append(hex);
+            return;
+        }
+        case LiteralKind::Date:
+        case LiteralKind::DateTime: {
+            m_cell.clear();
+            column.appendDisplayText(m_cell, row);
+            // 'YYYY-MM-DD hh:mm:ss' is read per SET DATEFORMAT by DATETIME; 'YYYYMMDD' and the T form never are
+            if (kind == LiteralKind::Date && m_cell.size() == 10 && m_cell[4] == '-' && m_cell[7] == '-') {
+                m_cell.erase(7, 1);
+                m_cell.erase(4, 1);
+            } else if (kind == LiteralKind::DateTime && m_cell.size() > 10 && m_cell[4] == '-' && m_cell[10] == ' ') {
+                m_cell[10] = 'T';
+            }
+            m_writer.append('\'');
+            m_writer.append(m_cell);
+            m_writer.append('\'');
+            return;
+        }
+        default:
+            if (text) {
+                writeString(column.textAt(row));
+            } else {
+                m_cell.clear();
+                column.appendDisplayText(m_cell, row);
+                writeString(m_cell);
+            }
+            return;
+    }
+}
+
+void SqlInsertExporter::writeString(std::string_view value) {
+    m_writer.append("N'");
+    while (!value.empty()) {
+        const auto* quote = static_cast<const char*>(std::memchr(value.data(), '\'', value.size()));
+        if (quote == nullptr) {
+            m_writer.append(value);
+            break;
+        }
+        const size_t runLength = static_cast<size_t>(quote - value.data()) + 1;
+        m_writer.append(value.substr(0, runLength));
+        m_writer.append('\'');
+        value.remove_prefix(runLength);
+    }
+    m_writer.append('\'');
+}
+
+}  // namespace velocitydb
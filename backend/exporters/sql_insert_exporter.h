@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../utils/buffered_file_writer.h"
+#include "data_exporter.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Writes rows as a T-SQL seed script: multi-row `INSERT INTO <table> (<columns>) VALUES (...), (...);`
+/// statements of up to rowsPerStatement rows, optionally with a GO line after every goEvery statements.
+/// How each column is written is decided once from ColumnInfo::type: numbers bare, BIT as 0/1, binary as 0x
+/// hex, dates and times as language-independent ISO literals, everything else as N'...'. Rows go straight
+/// into a BufferedFileWriter, so a script of any size is written without building it in memory.
+class SqlInsertExporter : public DataExporter {
+public:
+    /// SQL Server's limit on rows in one VALUES list
+    static constexpr size_t MAX_ROWS_PER_STATEMENT = 1000;
+
+    /// How a column's values are written
+    enum class LiteralKind : uint8_t {
+        Auto,      ///< Unknown SQL type: follows the storage type of each batch
+        Number,    ///< Bare number; NULL for NaN and infinity
+        Bit,       ///< 0/1
+        Binary,    ///< 0x followed by hex digits
+        Date,      ///< 'YYYYMMDD'
+        DateTime,  ///< 'YYYY-MM-DDThh:mm:ss[.fffffff]'
+        String,    ///< N'...' with quotes doubled
+    };
+
+    SqlInsertExporter() = default;
+    ~SqlInsertExporter() override = default;
+
+    bool exportData(const ResultSet& data, const std::string& filepath) override;
+    bool exportData(const ResultSet& data, const std::string& filepath, const ExportOptions& options) override;
+
+    bool beginExport(const std::vector<ColumnInfo>& columns, const std::string& filepath, const ExportOptions& options) override;
+    bool writeBatch(const ResultSet& batch) override;
+    bool finishExport() override;
+
+    /// Target table, e.g. "dbo.Orders" or "[Sales].[Order Lines]"; parts are bracket-quoted
+    void setTable(std::string_view table);
+    /// Clamped to 1..MAX_ROWS_PER_STATEMENT
+    void setRowsPerStatement(size_t rows) noexcept;
+    /// GO after every `statements` statements and at the end; 0 writes no GO
+    void setGoEvery(size_t statements) noexcept { m_goEvery = statements; }
+
+    [[nodiscard]] size_t rowsWritten() const noexcept { return m_rowsWritten; }
+    [[nodiscard]] size_t bytesWritten() const noexcept { return m_writer.bytesWritten(); }
+
+    [[nodiscard]] static LiteralKind literalKindFor(SqlType sqlType) noexcept;
+
+private:
+    void writeValue(const ColumnData& column, size_t row, LiteralKind kind);
+    /// N'...', copying the runs between quotes straight into the buffer
+    void writeString(std::string_view value);
+    void endStatement();
+
+    BufferedFileWriter m_writer;
+    std::string m_table = "[dbo].[ExportedRows]";
+    size_t m_rowsPerStatement = MAX_ROWS_PER_STATEMENT;
+    size_t m_goEvery = 0;
+
+    std::string m_lineEnding;
+    std::string m_prefix;  ///< "INSERT INTO <table> (<columns>) VALUES" and a line break
+    std::vector<LiteralKind> m_kinds;
+    std::string m_cell;  // Reused for non-text values
+    size_t m_rowsInStatement = 0;
+    size_t m_statementsSinceGo = 0;
+    size_t m_rowsWritten = 0;
+};
+
+}  // namespace velocitydb
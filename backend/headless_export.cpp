@@ -0,0 +1,301 @@
+#include "headless_export.h"
+
+#include "ipc_handler.h"
+#include "parsers/sql_script_reader.h"
+#include "utils/file_utils.h"
+#include "utils/json_utils.h"
+#include "simdjson.h"
+
+#include <array>
+#include <chrono>
+#include <format>
+#include <optional>
+#include <utility>
+
+namespace velocitydb {
+
+namespace {
+
+using namespace std::string_view_literals;
+
+constexpr std::string_view USAGE =
+    "usage: VelocityDB.exe --export --out <file> (--sql <query> | --query-file <file.sql>)\n"
+    "                      (--profile <name or id> | --server <host[,port]> --database <db> [--username <user>] [--password <password>])\n"
+    "                      [--format csv|parquet|json|ndjson] [--delimiter <text>] [--no-header] [--null <text>] [--compression none|lz4|gzip]";
+
+constexpr std::array FORMATS{"csv"sv, "parquet"sv, "json"sv, "ndjson"sv};
+
+/// Format implied by the output's extension; a trailing ".gz" asks for compression
+[[nodiscard]] std::pair<std::string_view, bool> formatOfPath(std::string_view path) noexcept {
+    const bool gzip = path.ends_with(".gz");
+    if (gzip) {
+        path.remove_suffix(3);
+    }
+    const auto dot = path.rfind('.');
+    const auto extension = dot == std::string_view::npos ? std::string_view{} : path.substr(dot + 1);
+    if (extension == "jsonl") {
+        return {"ndjson", gzip};
+    }
+    return {std::ranges::find(FORMATS, extension) != FORMATS.end() ? extension : std::string_view{}, gzip};
+}
+
+/// The one batch of a query file, without a BOM or a trailing GO
+[[nodiscard]] std::expected<std::string, std::string> readQueryFile(const std::string& path) {
+    auto content = FileUtils::readFile(path);
+    if (!content) [[unlikely]] {
+        return std::unexpected(std::format("Cannot read query file: {}", path));
+    }
+    std::string_view script = *content;
+    if (script.starts_with("\xEF\xBB\xBF")) {
+        script.remove_prefix(3);
+    }
+    SqlScriptReader reader(script);
+    auto batch = reader.next();
+    if (!batch) [[unlikely]] {
+        return std::unexpected(std::format("Query file has no statement: {}", path));
+    }
+    if (reader.next()) [[unlikely]] {
+        return std::unexpected(std::format("Query file must hold one batch to export: {}", path));
+    }
+    return std::string(batch->text);
+}
+
+[[nodiscard]] std::string_view stringField(simdjson::dom::element object, std::string_view key) {
+    auto value = object[key].get_string();
+    return value.error() ? std::string_view{} : value.value();
+}
+
+[[nodiscard]] bool boolField(simdjson::dom::element object, std::string_view key) {
+    auto value = object[key].get_bool();
+    return !value.error() && value.value();
+}
+
+/// `"name":"value"` with the value escaped, after a comma unless `json` is still empty after its brace
+void appendField(std::string& json, std::string_view name, std::string_view value) {
+    json += std::format(R"({}"{}":"{}")", json.ends_with('{') ? "" : ",", name, JsonUtils::escapeString(value));
+}
+
+}  // namespace
+
+bool HeadlessExportOptions::requested(std::span<const std::string> args) noexcept {
+    return std::ranges::find(args, "--export"sv) != args.end();
+}
+
+std::expected<HeadlessExportOptions, std::string> HeadlessExportOptions::parse(std::span<const std::string> args) {
+    HeadlessExportOptions options;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string_view arg = args[i];
+        if (arg == "--export") {
+            continue;
+        }
+        if (arg == "--no-header") {
+            options.includeHeader = false;
+            continue;
+        }
+        std::string* field = arg == "--profile"       ? &options.profile
+                             : arg == "--server"      ? &options.server
+                             : arg == "--database"    ? &options.database
+                             : arg == "--username"    ? &options.username
+                             : arg == "--password"    ? &options.password
+                             : arg == "--sql"         ? &options.sql
+                             : arg == "--query-file"  ? &options.queryFile
+                             : arg == "--out"         ? &options.output
+                             : arg == "--format"      ? &options.format
+                             : arg == "--delimiter"   ? &options.delimiter
+                             : arg == "--null"        ? &options.nullValue
+                             : arg == "--compression" ? &options.compression
+                                                      : nullptr;
+        if (field == nullptr) [[unlikely]] {
+            return std::unexpected(std::format("Unknown option: {}\n{}", arg, USAGE));
+        }
+        if (i + 1 >= args.size()) [[unlikely]] {
+            return std::unexpected(std::format("Missing value for {}\n{}", arg, USAGE));
+        }
+        *field = args[++i];
+    }
+
+    if (options.output.empty()) [[unlikely]] {
+        return std::unexpected(std::format("Missing --out\n{}", USAGE));
+    }
+    if (options.sql.empty() == options.queryFile.empty()) [[unlikely]] {
+        return std::unexpected(std::format("Give one of --sql or --query-file\n{}", USAGE));
+    }
+    if (options.profile.empty() && (options.server.empty() || options.database.empty())) [[unlikely]] {
+        return std::unexpected(std::format("Give --profile, or --server and --database\n{}", USAGE));
+    }
+    const auto [implied, gzip] = formatOfPath(options.output);
+    if (options.format.empty()) {
+        options.format = implied;
+    }
+    if (std::ranges::find(FORMATS, options.format) == FORMATS.end()) [[unlikely]] {
+        return std::unexpected(std::format("Cannot tell the format of {}; give --format csv, parquet, json or ndjson", options.output));
+    }
+    if (options.compression.empty() && gzip) {
+        options.compression = "gzip";
+    }
+    return options;
+}
+
+HeadlessExport::HeadlessExport(ISystemContext& ctx, std::ostream& log) : m_ipc(std::make_unique<IPCHandler>(ctx)), m_log(log) {}
+
+HeadlessExport::~HeadlessExport() {
+    m_ipc->shutdown();
+}
+
+std::expected<std::string, std::string> HeadlessExport::call(std::string_view method, std::string_view params) {
+    const auto response = m_ipc->dispatchRequest(std::format(R"({{"method":"{}","params":{}}})", method, params));
+    simdjson::dom::parser parser;
+    simdjson::dom::element doc;
+    if (parser.parse(response).get(doc)) [[unlikely]] {
+        return std::unexpected(std::format("{}: malformed response", method));
+    }
+    if (auto success = doc["success"].get_bool(); success.error() || !success.value()) {
+        auto error = doc["error"].get_string();
+        return std::unexpected(std::string(error.error() ? "Unknown error" : error.value()));
+    }
+    simdjson::dom::element data;
+    if (doc["data"].get(data)) [[unlikely]] {
+        return std::string("null");
+    }
+    return simdjson::minify(data);
+}
+
+std::expected<std::string, std::string> HeadlessExport::profileConnectParams(const HeadlessExportOptions& options) {
+    auto profiles = call("getConnectionProfiles", "{}");
+    if (!profiles) [[unlikely]] {
+        return std::unexpected(profiles.error());
+    }
+    simdjson::dom::parser parser;
+    simdjson::dom::array list;
+    if (parser.parse(*profiles)["profiles"].get(list)) [[unlikely]] {
+        return std::unexpected("Cannot read the saved connection profiles");
+    }
+    std::optional<simdjson::dom::element> profile;
+    for (auto candidate : list) {
+        if (stringField(candidate, "id") == options.profile || stringField(candidate, "name") == options.profile) {
+            profile = candidate;
+            break;
+        }
+    }
+    if (!profile) [[unlikely]] {
+        return std::unexpected(std::format("Connection profile not found: {}", options.profile));
+    }
+    // A secret the profile keeps in the credential store; none when it was not saved
+    auto secret = [&](std::string_view method, std::string_view id) -> std::string {
+        auto data = call(method, std::format(R"({{"id":"{}"}})", JsonUtils::escapeString(id)));
+        if (!data) {
+            return {};
+        }
+        simdjson::dom::parser secretParser;
+        simdjson::dom::element secretDoc;
+        return secretParser.parse(*data).get(secretDoc) ? std::string{} : std::string(stringField(secretDoc, "password"));
+    };
+
+    const auto id = stringField(*profile, "id");
+    std::string json = "{";
+    appendField(json, "server", stringField(*profile, "server"));
+    appendField(json, "database", options.database.empty() ? stringField(*profile, "database") : std::string_view(options.database));
+    appendField(json, "username", options.username.empty() ? stringField(*profile, "username") : std::string_view(options.username));
+    appendField(json, "dbType", stringField(*profile, "dbType"));
+    json += std::format(R"(,"useWindowsAuth":{})", boolField(*profile, "useWindowsAuth") && options.username.empty() ? "true" : "false");
+    if (!options.password.empty()) {
+        appendField(json, "password", options.password);
+    } else if (boolField(*profile, "savePassword")) {
+        appendField(json, "password", secret("getProfilePassword", id));
+    }
+    if (auto tuning = (*profile)["tuning"]; !tuning.error()) {
+        json += std::format(R"(,"tuning":{})", simdjson::minify(tuning.value()));
+    }
+    if (auto ssh = (*profile)["ssh"]; !ssh.error() && boolField(ssh.value(), "enabled")) {
+        json += R"(,"ssh":{"enabled":true)";
+        appendField(json, "host", stringField(ssh.value(), "host"));
+        appendField(json, "username", stringField(ssh.value(), "username"));
+        appendField(json, "authType", stringField(ssh.value(), "authType"));
+        appendField(json, "privateKeyPath", stringField(ssh.value(), "privateKeyPath"));
+        if (auto port = ssh.value()["port"].get_int64(); !port.error()) {
+            json += std::format(R"(,"port":{})", port.value());
+        }
+        if (boolField(ssh.value(), "savePassword")) {
+            appendField(json, "password", secret("getSshPassword", id));
+            appendField(json, "keyPassphrase", secret("getSshKeyPassphrase", id));
+        }
+        json += '}';
+    }
+    json += '}';
+    return json;
+}
+
+int HeadlessExport::run(const HeadlessExportOptions& options) {
+    const auto started = std::chrono::steady_clock::now();
+
+    std::string sql = options.sql;
+    if (!options.queryFile.empty()) {
+        auto fileSql = readQueryFile(options.queryFile);
+        if (!fileSql) [[unlikely]] {
+            m_log << fileSql.error() << '\n';
+            return EXIT_USAGE;
+        }
+        sql = std::move(*fileSql);
+    }
+
+    std::string connectParams;
+    if (!options.profile.empty()) {
+        auto params = profileConnectParams(options);
+        if (!params) [[unlikely]] {
+            m_log << params.error() << '\n';
+            return EXIT_FAILED;
+        }
+        connectParams = std::move(*params);
+    } else {
+        connectParams = "{";
+        appendField(connectParams, "server", options.server);
+        appendField(connectParams, "database", options.database);
+        appendField(connectParams, "username", options.username);
+        appendField(connectParams, "password", options.password);
+        connectParams += std::format(R"(,"useWindowsAuth":{}}})", options.username.empty() ? "true" : "false");
+    }
+
+    auto connected = call("connect", connectParams);
+    if (!connected) [[unlikely]] {
+        m_log << "Connect failed: " << connected.error() << '\n';
+        return EXIT_FAILED;
+    }
+    simdjson::dom::parser parser;
+    simdjson::dom::element connectedDoc;
+    const auto connectionId = parser.parse(*connected).get(connectedDoc) ? std::string{} : std::string(stringField(connectedDoc, "connectionId"));
+
+    std::string exportParams = "{";
+    appendField(exportParams, "connectionId", connectionId);
+    appendField(exportParams, "sql", sql);
+    appendField(exportParams, "filepath", options.output);
+    std::string_view method = "exportCSV";
+    if (options.format == "csv") {
+        if (!options.delimiter.empty()) {
+            appendField(exportParams, "delimiter", options.delimiter);
+        }
+        if (!options.nullValue.empty()) {
+            appendField(exportParams, "nullValue", options.nullValue);
+        }
+        exportParams += std::format(R"(,"includeHeader":{})", options.includeHeader ? "true" : "false");
+    } else if (options.format == "parquet") {
+        method = "exportParquet";
+    } else {
+        method = "exportJSON";
+        exportParams += std::format(R"(,"ndjson":{})", options.format == "ndjson" ? "true" : "false");
+    }
+    if (!options.compression.empty()) {
+        appendField(exportParams, "compression", options.compression);
+    }
+    exportParams += '}';
+
+    auto exported = call(method, exportParams);
+    (void)call("disconnect", std::format(R"({{"connectionId":"{}"}})", JsonUtils::escapeString(connectionId)));
+    if (!exported) [[unlikely]] {
+        m_log << "Export failed: " << exported.error() << '\n';
+        return EXIT_FAILED;
+    }
+    m_log << std::format("Exported {} to {} in {:.1f} s\n", options.format, options.output, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    return EXIT_OK;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <expected>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+class ISystemContext;
+class IPCHandler;
+
+/// Command line of a headless export:
+///
+///   VelocityDB.exe --export --out <file> (--sql <query> | --query-file <file.sql>)
+///                  (--profile <name or id> | --server <host[,port]> --database <db> [--username <user>])
+///                  [--format csv|parquet|json|ndjson] [--delimiter <text>] [--no-header] [--null <text>]
+///                  [--compression none|lz4|gzip]
+///
+/// The format defaults to the output's extension (.csv, .parquet, .json, .ndjson/.jsonl; .json.gz compresses).
+/// A password comes from --password, else the VELOCITYDB_PASSWORD environment variable (filled in by wWinMain),
+/// else the profile's saved one.
+struct HeadlessExportOptions {
+    std::string profile;
+    std::string server;
+    std::string database;
+    std::string username;
+    std::string password;
+    std::string sql;
+    std::string queryFile;
+    std::string output;
+    std::string format;
+    std::string delimiter;
+    std::string nullValue;
+    std::string compression;
+    bool includeHeader = true;
+
+    /// True when `args` (without the program name) ask for a headless export rather than the window
+    [[nodiscard]] static bool requested(std::span<const std::string> args) noexcept;
+    /// Options from `args` (without the program name); the error is a usage message
+    [[nodiscard]] static std::expected<HeadlessExportOptions, std::string> parse(std::span<const std::string> args);
+};
+
+/// Runs one export through the same IPC routes the UI uses (connect, exportCSV/exportJSON/exportParquet,
+/// disconnect), so the connection handling and streaming exporters are shared, but never creates a window or
+/// touches the single-instance lock: any number of exports can run side by side on a build agent.
+class HeadlessExport {
+public:
+    static constexpr int EXIT_OK = 0;
+    static constexpr int EXIT_FAILED = 1;  ///< Connect, query or write failed
+    static constexpr int EXIT_USAGE = 2;   ///< Bad command line
+
+    HeadlessExport(ISystemContext& ctx, std::ostream& log);
+    ~HeadlessExport();
+
+    HeadlessExport(const HeadlessExport&) = delete;
+    HeadlessExport& operator=(const HeadlessExport&) = delete;
+    HeadlessExport(HeadlessExport&&) = delete;
+    HeadlessExport& operator=(HeadlessExport&&) = delete;
+
+    /// Connect, export and disconnect; returns the process exit code
+    [[nodiscard]] int run(const HeadlessExportOptions& options);
+
+private:
+    /// `data` of a successful response to `method`, or its error
+    [[nodiscard]] std::expected<std::string, std::string> call(std::string_view method, std::string_view params);
+    /// connect params for the saved profile named (or with the id) `profile`
+    [[nodiscard]] std::expected<std::string, std::string> profileConnectParams(const HeadlessExportOptions& options);
+
+    std::unique_ptr<IPCHandler> m_ipc;
+    std::ostream& m_log;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,127 @@
+#include "bulk_loader.h"
+
+#include "../utils/metrics.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace velocitydb {
+
+void BulkLoader::load(DataImporter& source, const ImportPlan& plan, std::span<const BatchInserter> inserters, BulkLoadProgress& progress, const std::atomic<bool>& cancelRequested, size_t batchRows) {
+    if (inserters.empty()) [[unlikely]] {
+        throw std::invalid_argument("BulkLoader needs at least one connection");
+    }
+    static auto& batchLatency = MetricsRegistry::instance().histogram("import.batch_latency_us");
+    batchRows = (std::max)(batchRows, size_t{1});
+    progress.totalBytes.store(source.totalBytes(), std::memory_order_relaxed);
+
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable drained;
+    std::deque<ResultSet> queue;  // Guarded by mutex, like the two below
+    bool readerDone = false;
+    std::string error;
+    std::atomic<bool> failed{false};
+    const size_t capacity = inserters.size() * QUEUED_BATCHES_PER_WORKER;
+
+    auto fail = [&](std::string message) {
+        {
+            std::lock_guard lock(mutex);
+            if (error.empty()) {
+                error = std::move(message);
+            }
+            failed.store(true, std::memory_order_release);
+        }
+        queued.notify_all();
+        drained.notify_all();
+    };
+    auto stopped = [&] { return failed.load(std::memory_order_acquire) || cancelRequested.load(std::memory_order_acquire); };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(inserters.size());
+        for (const auto& insert : inserters) {
+            workers.emplace_back([&] {
+                while (true) {
+                    ResultSet batch;
+                    {
+                        std::unique_lock lock(mutex);
+                        queued.wait(lock, [&] { return !queue.empty() || readerDone || stopped(); });
+                        if (queue.empty() || stopped()) {
+                            lock.unlock();
+                            // A cancel flips no condition; wake a reader waiting for queue space
+                            drained.notify_all();
+                            return;
+                        }
+                        batch = std::move(queue.front());
+                        queue.pop_front();
+                    }
+                    drained.notify_one();
+                    try {
+                        ScopedLatency timed(batchLatency);
+                        progress.rowsInserted.fetch_add(static_cast<uint64_t>(insert(batch)), std::memory_order_relaxed);
+                    } catch (const std::exception& e) {
+                        fail(e.what());
+                        return;
+                    }
+                }
+            });
+        }
+
+        // Reader: this thread parses and coerces while the workers insert
+        std::vector<std::optional<std::string_view>> fields;
+        ResultSet batch = plan.makeBatch();
+        uint64_t record = 0;
+        auto publish = [&] {
+            progress.recordsRead.store(record, std::memory_order_relaxed);
+            progress.bytesRead.store(source.bytesRead(), std::memory_order_relaxed);
+            std::unique_lock lock(mutex);
+            drained.wait(lock, [&] { return queue.size() < capacity || stopped(); });
+            if (stopped()) {
+                return;
+            }
+            queue.push_back(std::exchange(batch, plan.makeBatch()));
+            lock.unlock();
+            queued.notify_one();
+        };
+        while (!stopped()) {
+            if (!source.nextRecord(fields)) {
+                if (!source.lastError().empty()) {
+                    fail(source.lastError());
+                }
+                break;
+            }
+            ++record;
+            if (auto problem = plan.append(fields, batch)) [[unlikely]] {
+                fail(std::format("Record {}: {}", record, *problem));
+                break;
+            }
+            if (batch.rowCount() >= batchRows) {
+                publish();
+            }
+        }
+        if (!batch.empty() && !stopped()) {
+            publish();
+        }
+        progress.recordsRead.store(record, std::memory_order_relaxed);
+        progress.bytesRead.store(source.bytesRead(), std::memory_order_relaxed);
+        {
+            std::lock_guard lock(mutex);
+            readerDone = true;
+        }
+        queued.notify_all();
+    }  // Workers drain the queue and join here
+
+    if (failed.load(std::memory_order_acquire)) {
+        throw std::runtime_error(error);
+    }
+}
+
+}  // namespace velocitydb
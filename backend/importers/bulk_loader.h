@@ -0,0 +1,42 @@
+#pragma once
+
+#include "data_importer.h"
+#include "import_plan.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace velocitydb {
+
+/// Inserts one coerced batch and returns the rows it added (SQLServerDriver::insertRows on one connection)
+using BatchInserter = std::function<int64_t(const ResultSet& batch)>;
+
+/// Counters of a running load, readable from any thread
+struct BulkLoadProgress {
+    std::atomic<uint64_t> recordsRead{0};
+    std::atomic<uint64_t> rowsInserted{0};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> totalBytes{0};
+};
+
+/// Moves the records of an import file into a table. The calling thread reads records and coerces them into
+/// batches of `batchRows` (ImportPlan::append); one worker per inserter takes batches from a bounded queue, so
+/// parsing overlaps the round trips and the connections insert in parallel.
+///
+/// Every batch commits on its own: after a failure or cancel, rows of the batches already inserted stay in the
+/// table. Batches may land out of file order across connections.
+class BulkLoader {
+public:
+    static constexpr size_t DEFAULT_BATCH_ROWS = 1000;
+    /// Batches waiting per worker; bounds memory when the server is slower than the reader
+    static constexpr size_t QUEUED_BATCHES_PER_WORKER = 2;
+
+    /// Load every remaining record of `source`. Returns early when `cancelRequested` is set.
+    /// @throws std::runtime_error with the first read, coercion or insert error (no new batch starts after it)
+    static void load(DataImporter& source, const ImportPlan& plan, std::span<const BatchInserter> inserters, BulkLoadProgress& progress, const std::atomic<bool>& cancelRequested,
+                     size_t batchRows = DEFAULT_BATCH_ROWS);
+};
+
+}  // namespace velocitydb
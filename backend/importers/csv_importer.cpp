@@ -0,0 +1,179 @@
+#include "csv_importer.h"
+
+#include <bit>
+#include <format>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VELOCITYDB_CSV_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace velocitydb {
+
+namespace {
+
+/// Offset of the first delimiter, CR or LF at or after `pos`, or data.size(). SSE2 is part of x86-64, so the
+/// vector loop needs no CPU check.
+[[nodiscard]] size_t findFieldEnd(std::string_view data, size_t pos, char delimiter) noexcept {
+    const char* base = data.data();
+    const size_t size = data.size();
+#ifdef VELOCITYDB_CSV_SSE2
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + pos));
+        const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, delim), _mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr)));
+        if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)); mask != 0) {
+            return pos + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+    for (; pos < size; ++pos) {
+        const char c = base[pos];
+        if (c == delimiter || c == '\n' || c == '\r') {
+            return pos;
+        }
+    }
+    return size;
+}
+
+}  // namespace
+
+bool CSVImporter::open(const std::string& filepath, const ImportOptions& options) {
+    m_fieldNames.clear();
+    m_lastError.clear();
+    m_pos = 0;
+    m_record = 0;
+    m_delimiter = options.delimiter.empty() ? ',' : options.delimiter.front();
+    m_nullValue = options.nullValue;
+
+    if (!m_file.open(filepath)) [[unlikely]] {
+        m_data = {};
+        m_lastError = std::format("Failed to open {}", filepath);
+        return false;
+    }
+    m_data = m_file.view();
+    if (m_data.starts_with("\xEF\xBB\xBF")) {
+        m_pos = 3;
+    }
+
+    const size_t firstRecord = m_pos;
+    if (!readSpans()) [[unlikely]] {
+        if (m_lastError.empty()) {
+            m_lastError = "The file holds no records";
+        }
+        return false;
+    }
+    m_fieldNames.reserve(m_spans.size());
+    for (size_t i = 0; i < m_spans.size(); ++i) {
+        const auto& span = m_spans[i];
+        if (options.hasHeader) {
+            m_fieldNames.emplace_back((span.unescaped ? std::string_view(m_unescaped) : m_data).substr(span.offset, span.length));
+        } else {
+            m_fieldNames.push_back(std::format("Column{}", i + 1));
+        }
+    }
+    if (!options.hasHeader) {
+        // The first line was only sampled for its field count
+        m_pos = firstRecord;
+        m_record = 0;
+    }
+    return true;
+}
+
+bool CSVImporter::nextRecord(std::vector<std::optional<std::string_view>>& fields) {
+    if (!readSpans()) {
+        return false;
+    }
+    if (m_spans.size() > m_fieldNames.size()) [[unlikely]] {
+        m_lastError = std::format("Record {} has {} fields, expected {}", m_record, m_spans.size(), m_fieldNames.size());
+        return false;
+    }
+    fields.assign(m_fieldNames.size(), std::nullopt);
+    for (size_t i = 0; i < m_spans.size(); ++i) {
+        const auto& span = m_spans[i];
+        if (!span.null) {
+            fields[i] = (span.unescaped ? std::string_view(m_unescaped) : m_data).substr(span.offset, span.length);
+        }
+    }
+    return true;
+}
+
+bool CSVImporter::readSpans() {
+    m_spans.clear();
+    m_unescaped.clear();
+    while (m_pos < m_data.size() && (m_data[m_pos] == '\n' || m_data[m_pos] == '\r')) {
+        ++m_pos;
+    }
+    if (m_pos >= m_data.size()) {
+        return false;
+    }
+    ++m_record;
+
+    while (true) {
+        FieldSpan span;
+        if (m_pos < m_data.size() && m_data[m_pos] == '"') {
+            if (!readQuoted(span)) [[unlikely]] {
+                return false;
+            }
+        } else {
+            const size_t end = findFieldEnd(m_data, m_pos, m_delimiter);
+            span.offset = m_pos;
+            span.length = end - m_pos;
+            span.null = m_data.substr(m_pos, span.length) == m_nullValue;
+            m_pos = end;
+        }
+        m_spans.push_back(span);
+
+        if (m_pos >= m_data.size()) {
+            return true;
+        }
+        const char c = m_data[m_pos++];
+        if (c == m_delimiter) {
+            continue;
+        }
+        if (c == '\r' && m_pos < m_data.size() && m_data[m_pos] == '\n') {
+            ++m_pos;
+        }
+        if (c == '\r' || c == '\n') {
+            return true;
+        }
+        m_lastError = std::format("Record {}: unexpected text after a quoted field", m_record);
+        return false;
+    }
+}
+
+bool CSVImporter::readQuoted(FieldSpan& span) {
+    size_t segment = m_pos + 1;
+    bool copied = false;
+    while (true) {
+        const size_t quote = m_data.find('"', segment);
+        if (quote == std::string_view::npos) [[unlikely]] {
+            m_lastError = std::format("Record {}: unterminated quoted field", m_record);
+            return false;
+        }
+        if (quote + 1 < m_data.size() && m_data[quote + 1] == '"') {
+            // "" stands for one quote, so the field can no longer be a view into the file
+            if (!copied) {
+                span.offset = m_unescaped.size();
+                copied = true;
+            }
+            m_unescaped.append(m_data.substr(segment, quote + 1 - segment));
+            segment = quote + 2;
+            continue;
+        }
+        if (copied) {
+            m_unescaped.append(m_data.substr(segment, quote - segment));
+            span.length = m_unescaped.size() - span.offset;
+            span.unescaped = true;
+        } else {
+            span.offset = m_pos + 1;
+            span.length = quote - span.offset;
+        }
+        m_pos = quote + 1;
+        return true;
+    }
+}
+
+}  // namespace velocitydb
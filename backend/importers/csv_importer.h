@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../utils/mapped_file.h"
+#include "data_importer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace velocitydb {
+
+/// RFC 4180 reader over a memory-mapped file. Unquoted fields are found with a 16-byte SIMD scan for the
+/// delimiter and line breaks and returned as views into the mapping; only quoted fields holding doubled quotes
+/// are copied. Accepts LF and CRLF line ends, skips a UTF-8 BOM and blank lines.
+class CSVImporter : public DataImporter {
+public:
+    CSVImporter() = default;
+    ~CSVImporter() override = default;
+
+    [[nodiscard]] bool open(const std::string& filepath, const ImportOptions& options) override;
+    [[nodiscard]] bool nextRecord(std::vector<std::optional<std::string_view>>& fields) override;
+
+    [[nodiscard]] size_t bytesRead() const noexcept override { return m_pos; }
+    [[nodiscard]] size_t totalBytes() const noexcept override { return m_data.size(); }
+
+    /// Continue reading at byte `offset` of the file, which must be the start of a record (FileDatasource jumps
+    /// to its indexed rows this way)
+    void seek(size_t offset) noexcept { m_pos = (std::min)(offset, m_data.size()); }
+
+private:
+    /// Where a field's text lives until the record is complete (m_unescaped may reallocate meanwhile)
+    struct FieldSpan {
+        size_t offset = 0;
+        size_t length = 0;
+        bool unescaped = false;  ///< offset is into m_unescaped rather than the file
+        bool null = false;
+    };
+
+    /// Split the record at m_pos into m_spans; false at the end of input or on a malformed quoted field
+    [[nodiscard]] bool readSpans();
+    /// Quoted field starting at the opening quote m_pos; leaves m_pos after the closing quote
+    [[nodiscard]] bool readQuoted(FieldSpan& span);
+
+    MappedFile m_file;
+    std::string_view m_data;
+    size_t m_pos = 0;
+    char m_delimiter = ',';
+    std::string m_nullValue;
+    uint64_t m_record = 0;  ///< 1-based number of the last record read, for error messages
+    std::vector<FieldSpan> m_spans;
+    std::string m_unescaped;
+};
+
+}  // namespace velocitydb
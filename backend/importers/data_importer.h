@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+struct ImportOptions {
+    std::string delimiter = ",";  ///< CSV field separator (first byte)
+    bool hasHeader = true;        ///< CSV: the first record names the fields; otherwise fields are named Column1..N
+    std::string nullValue = "";   ///< CSV: unquoted cell text read as NULL
+};
+
+/// Streaming reader of an import file. Records are handed out one at a time as views into the source,
+/// so memory stays flat however large the file is.
+class DataImporter {
+public:
+    virtual ~DataImporter() = default;
+
+    /// Open `filepath` and read the field names; false (with lastError()) when the file cannot be read
+    [[nodiscard]] virtual bool open(const std::string& filepath, const ImportOptions& options) = 0;
+    /// Next record, one entry per field name (std::nullopt for NULL or a missing field). The views stay valid
+    /// until the following call. false at the end of the input or on a format error (lastError() is then set).
+    [[nodiscard]] virtual bool nextRecord(std::vector<std::optional<std::string_view>>& fields) = 0;
+
+    /// Source bytes consumed so far and in total, for progress reporting
+    [[nodiscard]] virtual size_t bytesRead() const noexcept = 0;
+    [[nodiscard]] virtual size_t totalBytes() const noexcept = 0;
+
+    [[nodiscard]] const std::vector<std::string>& fieldNames() const noexcept { return m_fieldNames; }
+    [[nodiscard]] const std::string& lastError() const noexcept { return m_lastError; }
+
+protected:
+    std::vector<std::string> m_fieldNames;
+    std::string m_lastError;
+};
+
+}  // namespace velocitydb
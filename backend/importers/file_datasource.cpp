@@ -0,0 +1,504 @@
+#include "file_datasource.h"
+
+#include "csv_importer.h"
+#include "json_importer.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <exception>
+#include <format>
+#include <map>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VELOCITYDB_INDEX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] bool isLineBreak(char c) noexcept {
+    return c == '\n' || c == '\r';
+}
+
+[[nodiscard]] size_t workerCount(size_t tasks) noexcept {
+    return (std::max)(size_t{1}, (std::min)(tasks, size_t{(std::max)(std::thread::hardware_concurrency(), 1u)}));
+}
+
+/// Offset of the first line break (or quote, when `quotes`) in [pos, end), or end. SSE2 is part of x86-64.
+[[nodiscard]] size_t findSpecial(const char* data, size_t pos, size_t end, bool quotes) noexcept {
+#ifdef VELOCITYDB_INDEX_SSE2
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i quote = _mm_set1_epi8(quotes ? '"' : '\n');
+    for (; pos + 16 <= end; pos += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr)));
+        if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)); mask != 0) {
+            return pos + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+    for (; pos < end; ++pos) {
+        if (isLineBreak(data[pos]) || (quotes && data[pos] == '"')) {
+            return pos;
+        }
+    }
+    return end;
+}
+
+/// Records that start in one index chunk, for each quote state the chunk may start in
+struct ChunkScan {
+    size_t records[2] = {0, 0};
+    std::vector<size_t> checkpoints[2];  ///< Offsets of local records 0, CHECKPOINT_ROWS, ...
+    bool oddQuotes = false;
+};
+
+}  // namespace
+
+class FileDatasource::Cursor {
+public:
+    virtual ~Cursor() = default;
+    /// Continue at byte `offset`, the start of a record
+    virtual void seek(size_t offset) = 0;
+    /// Next record; false at the end of the file
+    /// @throws std::runtime_error when the record cannot be parsed
+    [[nodiscard]] virtual bool next(std::vector<std::optional<std::string_view>>& fields) = 0;
+};
+
+class FileDatasource::CsvCursor final : public Cursor {
+public:
+    CsvCursor(const std::string& filepath, const ImportOptions& options) {
+        if (!m_reader.open(filepath, options)) [[unlikely]] {
+            throw std::runtime_error(m_reader.lastError());
+        }
+    }
+
+    void seek(size_t offset) override { m_reader.seek(offset); }
+
+    bool next(std::vector<std::optional<std::string_view>>& fields) override {
+        if (m_reader.nextRecord(fields)) {
+            return true;
+        }
+        if (!m_reader.lastError().empty()) [[unlikely]] {
+            throw std::runtime_error(m_reader.lastError());
+        }
+        return false;
+    }
+
+    [[nodiscard]] const std::vector<std::string>& fieldNames() const noexcept { return m_reader.fieldNames(); }
+
+private:
+    CSVImporter m_reader;
+};
+
+/// One simdjson On-Demand parse per line, copied into a padded buffer first
+class FileDatasource::JsonLinesCursor final : public Cursor {
+public:
+    JsonLinesCursor(std::string_view data, size_t start, std::vector<std::string> names) : m_data(data), m_pos(start), m_names(std::move(names)) {}
+
+    void seek(size_t offset) override { m_pos = (std::min)(offset, m_data.size()); }
+
+    bool next(std::vector<std::optional<std::string_view>>& fields) override { return read(fields, false); }
+
+    /// Learn the field names from the first object, then rewind
+    [[nodiscard]] const std::vector<std::string>& learnNames() {
+        const size_t start = m_pos;
+        std::vector<std::optional<std::string_view>> fields;
+        (void)read(fields, true);
+        m_pos = start;
+        return m_names;
+    }
+
+private:
+    bool read(std::vector<std::optional<std::string_view>>& fields, bool learn) {
+        while (m_pos < m_data.size()) {
+            const size_t lineStart = m_pos;
+            size_t end = m_data.find_first_of("\r\n", m_pos);
+            if (end == std::string_view::npos) {
+                end = m_data.size();
+            }
+            m_pos = (std::min)(end + 1, m_data.size());
+            const auto line = m_data.substr(lineStart, end - lineStart);
+            if (line.empty()) {
+                continue;
+            }
+            if (line.find_first_not_of(" \t") == std::string_view::npos) {
+                // Indexed as a record; keep the row numbers aligned
+                fields.assign(m_names.size(), std::nullopt);
+                return true;
+            }
+            m_line.reserve(line.size() + simdjson::SIMDJSON_PADDING);
+            m_line.assign(line);
+            try {
+                m_document = m_parser.iterate(simdjson::padded_string_view(m_line.data(), m_line.size(), m_line.capacity()));
+                auto object = m_document.get_object().value();
+                JSONImporter::readFields(object, m_names, fields, learn);
+            } catch (const simdjson::simdjson_error& e) {
+                throw std::runtime_error(std::format("Invalid JSON line at byte {}: {}", lineStart, e.what()));
+            }
+            return true;
+        }
+        return false;
+    }
+
+    std::string_view m_data;
+    size_t m_pos;
+    std::vector<std::string> m_names;
+    simdjson::ondemand::parser m_parser;
+    simdjson::ondemand::document m_document;
+    std::string m_line;
+};
+
+FileDatasource::FileDatasource(std::string filepath, const ImportOptions& options) : m_filepath(std::move(filepath)), m_options(options) {
+    if (!m_file.open(m_filepath)) [[unlikely]] {
+        throw std::runtime_error(std::format("Failed to open {}", m_filepath));
+    }
+    m_data = m_file.view();
+    if (m_data.starts_with("\xEF\xBB\xBF")) {
+        m_dataStart = 3;
+    }
+    const auto first = m_data.find_first_not_of(" \t\r\n", m_dataStart);
+    if (first == std::string_view::npos) [[unlikely]] {
+        throw std::runtime_error("The file holds no records");
+    }
+    if (m_data[first] == '[') [[unlikely]] {
+        throw std::runtime_error("A JSON array cannot be queried in place; import it or convert it to JSON Lines");
+    }
+    m_jsonLines = m_data[first] == '{';
+
+    std::unique_ptr<Cursor> sampler;
+    if (m_jsonLines) {
+        auto cursor = std::make_unique<JsonLinesCursor>(m_data, m_dataStart, std::vector<std::string>{});
+        m_fieldNames = cursor->learnNames();
+        sampler = std::move(cursor);
+    } else {
+        auto cursor = std::make_unique<CsvCursor>(m_filepath, m_options);
+        m_fieldNames = cursor->fieldNames();
+        m_headerRecords = m_options.hasHeader ? 1 : 0;
+        sampler = std::move(cursor);
+    }
+
+    // A column is BIGINT while every sampled value is an integer, then FLOAT while every one is a number
+    enum class Guess : uint8_t { Int, Float, Text };
+    std::vector<Guess> guesses(m_fieldNames.size(), Guess::Int);
+    std::vector<bool> seen(m_fieldNames.size(), false);
+    std::vector<std::optional<std::string_view>> fields;
+    for (size_t sampled = 0; sampled < TYPE_SAMPLE_ROWS && sampler->next(fields); ++sampled) {
+        for (size_t i = 0; i < fields.size() && i < guesses.size(); ++i) {
+            if (!fields[i] || fields[i]->empty()) {
+                continue;
+            }
+            seen[i] = true;
+            const auto text = *fields[i];
+            if (guesses[i] == Guess::Int) {
+                int64_t value;
+                auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if (error != std::errc{} || end != text.data() + text.size()) {
+                    guesses[i] = Guess::Float;
+                }
+            }
+            if (guesses[i] == Guess::Float) {
+                double value;
+                auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if (error != std::errc{} || end != text.data() + text.size()) {
+                    guesses[i] = Guess::Text;
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < m_fieldNames.size(); ++i) {
+        const auto guess = seen[i] ? guesses[i] : Guess::Text;
+        m_types.push_back(guess == Guess::Int ? ColumnDataType::Int64 : guess == Guess::Float ? ColumnDataType::Double : ColumnDataType::Text);
+        m_columns.push_back(ColumnInfo{.name = m_fieldNames[i], .type = guess == Guess::Int ? "bigint" : guess == Guess::Float ? "float" : "nvarchar"});
+    }
+
+    m_indexer = std::thread([this] { buildIndex(); });
+}
+
+FileDatasource::~FileDatasource() {
+    m_stop.store(true, std::memory_order_relaxed);
+    if (m_indexer.joinable()) {
+        m_indexer.join();
+    }
+}
+
+FileDatasource::IndexProgress FileDatasource::indexProgress() const {
+    IndexProgress progress{.bytesIndexed = m_bytesIndexed.load(std::memory_order_relaxed), .totalBytes = m_data.size()};
+    std::lock_guard lock(m_mutex);
+    progress.done = m_indexDone;
+    progress.error = m_indexError;
+    if (m_indexDone && m_indexError.empty()) {
+        progress.rows = m_records - (std::min)(m_records, m_headerRecords);
+    }
+    return progress;
+}
+
+size_t FileDatasource::rowCount() const {
+    waitForIndex();
+    return m_records - (std::min)(m_records, m_headerRecords);
+}
+
+void FileDatasource::waitForIndex() const {
+    std::unique_lock lock(m_mutex);
+    m_indexed.wait(lock, [this] { return m_indexDone; });
+    if (!m_indexError.empty()) [[unlikely]] {
+        throw std::runtime_error(m_indexError);
+    }
+}
+
+void FileDatasource::buildIndex() {
+    std::vector<Checkpoint> checkpoints;
+    size_t records = 0;
+    std::string error;
+    try {
+        const size_t size = m_data.size();
+        const bool quotes = !m_jsonLines;
+        const size_t chunks = (size - m_dataStart + INDEX_CHUNK_BYTES - 1) / INDEX_CHUNK_BYTES;
+        std::vector<ChunkScan> scans(chunks);
+        std::atomic<size_t> nextChunk{0};
+        auto work = [&] {
+            for (size_t chunk = nextChunk.fetch_add(1); chunk < chunks && !m_stop.load(std::memory_order_relaxed); chunk = nextChunk.fetch_add(1)) {
+                auto& scan = scans[chunk];
+                const size_t begin = m_dataStart + chunk * INDEX_CHUNK_BYTES;
+                const size_t end = (std::min)(size, begin + INDEX_CHUNK_BYTES);
+                unsigned parity = 0;
+                for (size_t pos = findSpecial(m_data.data(), begin, end, quotes); pos < end; pos = findSpecial(m_data.data(), pos + 1, end, quotes)) {
+                    if (m_data[pos] == '"') {
+                        parity ^= 1;
+                        continue;
+                    }
+                    // A record starts after a line break that is outside quotes, unless the line is blank
+                    const size_t start = pos + 1;
+                    if (start < size && !isLineBreak(m_data[start])) {
+                        if (scan.records[parity] % CHECKPOINT_ROWS == 0) {
+                            scan.checkpoints[parity].push_back(start);
+                        }
+                        ++scan.records[parity];
+                    }
+                }
+                scan.oddQuotes = parity != 0;
+                m_bytesIndexed.fetch_add(end - begin, std::memory_order_relaxed);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < workerCount(chunks); ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (m_stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // Chain the chunks: each starts in the quote state the ones before it left
+        if (m_dataStart < size && !isLineBreak(m_data[m_dataStart])) {
+            checkpoints.push_back(Checkpoint{.record = 0, .offset = m_dataStart});
+            records = 1;
+        }
+        unsigned state = 0;
+        for (const auto& scan : scans) {
+            for (size_t i = 0; i < scan.checkpoints[state].size(); ++i) {
+                checkpoints.push_back(Checkpoint{.record = records + i * CHECKPOINT_ROWS, .offset = scan.checkpoints[state][i]});
+            }
+            records += scan.records[state];
+            state ^= scan.oddQuotes ? 1 : 0;
+        }
+        if (state != 0) [[unlikely]] {
+            error = "The file ends inside a quoted field";
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_checkpoints = std::move(checkpoints);
+    m_records = records;
+    m_indexError = std::move(error);
+    m_indexDone = true;
+    m_indexed.notify_all();
+}
+
+std::unique_ptr<FileDatasource::Cursor> FileDatasource::openCursor() const {
+    if (m_jsonLines) {
+        return std::make_unique<JsonLinesCursor>(m_data, m_dataStart, m_fieldNames);
+    }
+    return std::make_unique<CsvCursor>(m_filepath, m_options);
+}
+
+ResultSet FileDatasource::emptyBatch() const {
+    ResultSet batch;
+    batch.columns = m_columns;
+    for (auto type : m_types) {
+        batch.columnData.emplace_back(type);
+    }
+    return batch;
+}
+
+void FileDatasource::appendRecord(ResultSet& batch, const std::vector<std::optional<std::string_view>>& fields) const {
+    for (size_t i = 0; i < batch.columnData.size(); ++i) {
+        const auto& field = i < fields.size() ? fields[i] : std::nullopt;
+        // Empty cells of number columns are NULL, as on import
+        if (!field || (m_types[i] != ColumnDataType::Text && field->empty())) {
+            batch.columnData[i].appendNull();
+        } else {
+            batch.columnData[i].appendFromText(*field);
+        }
+    }
+}
+
+void FileDatasource::readRange(Cursor& cursor, size_t firstRecord, size_t endRecord, ResultSet& batch) const {
+    auto checkpoint = std::ranges::upper_bound(m_checkpoints, firstRecord, {}, &Checkpoint::record) - 1;
+    cursor.seek(checkpoint->offset);
+    std::vector<std::optional<std::string_view>> fields;
+    for (size_t record = checkpoint->record; record < endRecord; ++record) {
+        if (!cursor.next(fields)) [[unlikely]] {
+            throw std::runtime_error(std::format("{} ended early; was it changed after opening?", m_filepath));
+        }
+        if (record >= firstRecord) {
+            appendRecord(batch, fields);
+        }
+    }
+}
+
+ResultSet FileDatasource::rowsAt(std::span<const size_t> rows) const {
+    const size_t total = rowCount();
+    auto batch = emptyBatch();
+    auto cursor = openCursor();
+    std::vector<std::optional<std::string_view>> fields;
+    size_t position = SIZE_MAX;  // Record the cursor reads next
+    for (size_t row : rows) {
+        if (row >= total) [[unlikely]] {
+            throw std::out_of_range(std::format("Row {} is past the end of the file ({} rows)", row, total));
+        }
+        const size_t record = row + m_headerRecords;
+        // Jump when going back or when a checkpoint lies between here and the row
+        const auto checkpoint = std::ranges::upper_bound(m_checkpoints, record, {}, &Checkpoint::record) - 1;
+        if (position > record || checkpoint->record > position) {
+            cursor->seek(checkpoint->offset);
+            position = checkpoint->record;
+        }
+        for (; position <= record; ++position) {
+            if (!cursor->next(fields)) [[unlikely]] {
+                throw std::runtime_error(std::format("{} ended early; was it changed after opening?", m_filepath));
+            }
+        }
+        appendRecord(batch, fields);
+    }
+    return batch;
+}
+
+ResultSet FileDatasource::rows(size_t first, size_t count) const {
+    const size_t total = rowCount();
+    auto batch = emptyBatch();
+    first = (std::min)(first, total);
+    count = (std::min)(count, total - first);
+    if (count > 0) {
+        auto cursor = openCursor();
+        readRange(*cursor, first + m_headerRecords, first + count + m_headerRecords, batch);
+    }
+    return batch;
+}
+
+void FileDatasource::scan(const std::function<bool(const ResultSet& batch, size_t firstRow)>& visit) const {
+    const size_t total = rowCount();
+    if (total == 0) {
+        return;
+    }
+    // Batches are runs of checkpoints, so no worker parses records that belong to another
+    std::vector<size_t> bounds{m_headerRecords};
+    for (size_t i = SCAN_BATCH_CHECKPOINTS; i < m_checkpoints.size(); i += SCAN_BATCH_CHECKPOINTS) {
+        if (m_checkpoints[i].record > bounds.back()) {
+            bounds.push_back(m_checkpoints[i].record);
+        }
+    }
+    bounds.push_back(m_records);
+    const size_t batches = bounds.size() - 1;
+    const size_t threads = workerCount(batches);
+    const size_t maxAhead = threads * 2;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<size_t, ResultSet> ready;
+    size_t visited = 0;
+    bool stop = false;
+    std::exception_ptr error;
+    std::atomic<size_t> nextBatch{0};
+    auto work = [&] {
+        try {
+            auto cursor = openCursor();
+            for (size_t index = nextBatch.fetch_add(1); index < batches; index = nextBatch.fetch_add(1)) {
+                {
+                    std::unique_lock lock(mutex);
+                    changed.wait(lock, [&] { return stop || index < visited + maxAhead; });
+                    if (stop) {
+                        return;
+                    }
+                }
+                auto batch = emptyBatch();
+                readRange(*cursor, bounds[index], bounds[index + 1], batch);
+                std::lock_guard lock(mutex);
+                ready.emplace(index, std::move(batch));
+                changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            stop = true;
+            changed.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+
+    try {
+        for (size_t index = 0; index < batches; ++index) {
+            ResultSet batch;
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] { return error || ready.contains(index); });
+                if (error) {
+                    break;
+                }
+                batch = std::move(ready.extract(index).mapped());
+            }
+            const bool more = visit(batch, bounds[index] - m_headerRecords);
+            std::lock_guard lock(mutex);
+            visited = index + 1;
+            stop = stop || !more;
+            changed.notify_all();
+            if (stop) {
+                break;
+            }
+        }
+    } catch (...) {
+        std::lock_guard lock(mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+        stop = true;
+        changed.notify_all();
+    }
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+        changed.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace velocitydb
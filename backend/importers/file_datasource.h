@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../database/result_set.h"
+#include "../utils/mapped_file.h"
+#include "data_importer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+
+/// A CSV or JSON Lines file queried in place, as a result whose rows are parsed only when they are read.
+///
+/// Opening maps the file, reads its field names and infers column types from the first TYPE_SAMPLE_ROWS
+/// records (BIGINT or FLOAT where every value parses as one, else text). A background thread then builds a
+/// sparse index: the file is cut into INDEX_CHUNK_BYTES chunks that worker threads scan for line breaks at once.
+/// A CSV chunk cannot know whether it starts inside a quoted field, so it counts records for both cases and the
+/// chunks are chained afterwards by their quote parity. The index keeps the offset of every CHECKPOINT_ROWS-th
+/// record, so a window of rows is parsed from at most CHECKPOINT_ROWS records before it.
+///
+/// Whole-file work (filters, aggregation) goes through scan(), which parses batches on every core and hands them
+/// over in file order. CSV files must be well-formed RFC 4180: a quote is only special at the start of a field.
+class FileDatasource {
+public:
+    static constexpr size_t CHECKPOINT_ROWS = 4096;
+    static constexpr size_t INDEX_CHUNK_BYTES = 32 * 1024 * 1024;
+    static constexpr size_t TYPE_SAMPLE_ROWS = 1000;
+    /// Checkpoints per scan() batch
+    static constexpr size_t SCAN_BATCH_CHECKPOINTS = 8;
+
+    struct IndexProgress {
+        size_t bytesIndexed = 0;
+        size_t totalBytes = 0;
+        size_t rows = 0;  ///< Known once done
+        bool done = false;
+        std::string error;
+    };
+
+    /// Open `filepath` (UTF-8) and start indexing it. A file whose first non-blank byte is '{' is read as JSON
+    /// Lines (one object per line, fields named by the first one); anything else as CSV per `options`.
+    /// @throws std::runtime_error when the file cannot be read or holds no records
+    FileDatasource(std::string filepath, const ImportOptions& options);
+    /// Stops indexing
+    ~FileDatasource();
+
+    FileDatasource(const FileDatasource&) = delete;
+    FileDatasource& operator=(const FileDatasource&) = delete;
+    FileDatasource(FileDatasource&&) = delete;
+    FileDatasource& operator=(FileDatasource&&) = delete;
+
+    [[nodiscard]] const std::vector<ColumnInfo>& columns() const noexcept { return m_columns; }
+    [[nodiscard]] bool isJsonLines() const noexcept { return m_jsonLines; }
+    [[nodiscard]] size_t totalBytes() const noexcept { return m_data.size(); }
+    [[nodiscard]] IndexProgress indexProgress() const;
+
+    /// Data rows in the file; blocks until the index is built
+    /// @throws std::runtime_error when indexing failed
+    [[nodiscard]] size_t rowCount() const;
+
+    /// The rows numbered `rows` (ascending, below rowCount()), in that order
+    /// @throws std::runtime_error when indexing failed or a record cannot be parsed
+    [[nodiscard]] ResultSet rowsAt(std::span<const size_t> rows) const;
+    /// Rows [first, first + count), clipped to the file
+    [[nodiscard]] ResultSet rows(size_t first, size_t count) const;
+
+    /// Every row, in batches parsed on worker threads and passed to `visit` on the calling thread in file order.
+    /// `visit` returns false to stop early.
+    /// @throws std::runtime_error when indexing failed or a record cannot be parsed
+    void scan(const std::function<bool(const ResultSet& batch, size_t firstRow)>& visit) const;
+
+private:
+    class Cursor;
+    class CsvCursor;
+    class JsonLinesCursor;
+
+    struct Checkpoint {
+        size_t record = 0;  ///< Counting the header record, if any
+        size_t offset = 0;
+    };
+
+    [[nodiscard]] std::unique_ptr<Cursor> openCursor() const;
+    [[nodiscard]] ResultSet emptyBatch() const;
+    void appendRecord(ResultSet& batch, const std::vector<std::optional<std::string_view>>& fields) const;
+    /// Parse records [firstRecord, endRecord) starting from the checkpoint at or before them
+    void readRange(Cursor& cursor, size_t firstRecord, size_t endRecord, ResultSet& batch) const;
+    void buildIndex();
+    void waitForIndex() const;
+
+    const std::string m_filepath;
+    const ImportOptions m_options;
+    MappedFile m_file;
+    std::string_view m_data;
+    size_t m_dataStart = 0;  ///< After a UTF-8 BOM
+    bool m_jsonLines = false;
+    size_t m_headerRecords = 0;
+    std::vector<std::string> m_fieldNames;
+    std::vector<ColumnInfo> m_columns;
+    std::vector<ColumnDataType> m_types;
+
+    std::atomic<bool> m_stop{false};
+    std::atomic<size_t> m_bytesIndexed{0};
+    mutable std::mutex m_mutex;  // guards everything below
+    mutable std::condition_variable m_indexed;
+    bool m_indexDone = false;
+    std::string m_indexError;
+    std::vector<Checkpoint> m_checkpoints;
+    size_t m_records = 0;
+    std::thread m_indexer;
+};
+
+}  // namespace velocitydb
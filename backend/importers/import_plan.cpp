@@ -0,0 +1,199 @@
+#include "import_plan.h"
+
+#include "../utils/sql_validation.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+/// Scale of the datetime2 parameters insertRows binds
+constexpr uint8_t TIMESTAMP_FRACTION_DIGITS = 7;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) noexcept {
+    return std::ranges::equal(a, b, [](unsigned char x, unsigned char y) { return std::tolower(x) == std::tolower(y); });
+}
+
+std::string_view trim(std::string_view value) noexcept {
+    const auto first = value.find_first_not_of(" \t");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return value.substr(first, value.find_last_not_of(" \t") - first + 1);
+}
+
+/// Drop the '+' that from_chars rejects
+std::string_view withoutPlus(std::string_view value) noexcept {
+    return value.starts_with('+') ? value.substr(1) : value;
+}
+
+bool isNumber(std::string_view value) noexcept {
+    double parsed = 0.0;
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    return !value.empty() && ec == std::errc{} && ptr == value.data() + value.size();
+}
+
+}  // namespace
+
+std::optional<ColumnDataType> ImportPlan::storageTypeFor(std::string_view sqlType) noexcept {
+    constexpr std::string_view integers[] = {"tinyint", "smallint", "int", "bigint"};
+    constexpr std::string_view floats[] = {"float", "real"};
+    constexpr std::string_view timestamps[] = {"date", "datetime", "datetime2", "smalldatetime"};
+    constexpr std::string_view unsupported[] = {"binary", "varbinary", "image", "timestamp", "rowversion"};
+    auto isAny = [&](std::span<const std::string_view> names) { return std::ranges::any_of(names, [&](std::string_view name) { return equalsIgnoreCase(sqlType, name); }); };
+
+    if (isAny(integers)) {
+        return ColumnDataType::Int64;
+    }
+    if (isAny(floats)) {
+        return ColumnDataType::Double;
+    }
+    if (equalsIgnoreCase(sqlType, "bit")) {
+        return ColumnDataType::Bit;
+    }
+    if (isAny(timestamps)) {
+        return ColumnDataType::Timestamp;
+    }
+    if (isAny(unsupported)) {
+        return std::nullopt;
+    }
+    // Character types, decimal/money, time, datetimeoffset, uniqueidentifier, xml: the server converts the text
+    return ColumnDataType::Text;
+}
+
+std::expected<ImportPlan, std::string> ImportPlan::create(std::string_view table, std::span<const std::string> fieldNames, std::span<const ColumnInfo> tableColumns, bool byPosition) {
+    ImportPlan plan;
+    for (size_t c = 0; c < tableColumns.size(); ++c) {
+        const auto& column = tableColumns[c];
+        size_t field = c;
+        if (!byPosition) {
+            field = static_cast<size_t>(std::ranges::find_if(fieldNames, [&](const std::string& name) { return equalsIgnoreCase(trim(name), column.name); }) - fieldNames.begin());
+        }
+        if (field >= fieldNames.size()) {
+            continue;
+        }
+        const auto storage = storageTypeFor(column.type);
+        if (!storage) [[unlikely]] {
+            return std::unexpected(std::format("Column {} ({}) cannot be imported from text", column.name, column.type));
+        }
+        const bool numericText = equalsIgnoreCase(column.type, "decimal") || equalsIgnoreCase(column.type, "numeric") || equalsIgnoreCase(column.type, "money") ||
+                                 equalsIgnoreCase(column.type, "smallmoney");
+        plan.m_columns.push_back({.column = column, .field = field, .storage = *storage, .numericText = numericText});
+    }
+    if (plan.m_columns.empty()) [[unlikely]] {
+        return std::unexpected(std::format("No field of the file matches a column of {}", table));
+    }
+
+    std::string columns;
+    std::string placeholders;
+    for (const auto& target : plan.m_columns) {
+        if (!columns.empty()) {
+            columns += ", ";
+            placeholders += ", ";
+        }
+        columns += quoteBracketIdentifier(target.column.name);
+        placeholders += '?';
+    }
+    plan.m_insertStatement = std::format("INSERT INTO {} ({}) VALUES ({})", quoteBracketIdentifier(table), columns, placeholders);
+    return plan;
+}
+
+ResultSet ImportPlan::makeBatch() const {
+    ResultSet batch;
+    batch.columns.reserve(m_columns.size());
+    batch.columnData.reserve(m_columns.size());
+    for (const auto& target : m_columns) {
+        batch.columns.push_back(target.column);
+        // datetime2 carries 7 fraction digits
+        batch.columnData.emplace_back(target.storage, target.storage == ColumnDataType::Timestamp ? TIMESTAMP_FRACTION_DIGITS : 0);
+    }
+    return batch;
+}
+
+std::optional<std::string> ImportPlan::append(std::span<const std::optional<std::string_view>> fields, ResultSet& batch) const {
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        const auto& target = m_columns[i];
+        auto& data = batch.columnData[i];
+        const auto& field = target.field < fields.size() ? fields[target.field] : std::nullopt;
+        if (!field) {
+            data.appendNull();
+            continue;
+        }
+        if (target.storage == ColumnDataType::Text && !target.numericText) {
+            data.appendText(*field);
+            continue;
+        }
+
+        std::string_view value = trim(*field);
+        if (value.empty()) {
+            data.appendNull();
+            continue;
+        }
+        std::array<char, 40> normalized{};
+        switch (target.storage) {
+            case ColumnDataType::Text:
+                value = withoutPlus(value);
+                if (!isNumber(value)) {
+                    return std::format("'{}' is not a valid {} for column {}", *field, target.column.type, target.column.name);
+                }
+                data.appendText(value);
+                continue;
+            case ColumnDataType::Int64:
+            case ColumnDataType::Double:
+                value = withoutPlus(value);
+                break;
+            case ColumnDataType::Bit:
+                if (equalsIgnoreCase(value, "true") || equalsIgnoreCase(value, "yes")) {
+                    value = "1";
+                } else if (equalsIgnoreCase(value, "false") || equalsIgnoreCase(value, "no")) {
+                    value = "0";
+                }
+                break;
+            case ColumnDataType::Timestamp: {
+                // "YYYY-MM-DD" and ISO 8601 "YYYY-MM-DDThh:mm:ss[.f][Z]" into the "YYYY-MM-DD hh:mm:ss.fffffff" the
+                // 7-digit column parses; anything else is left for appendFromText to reject
+                if (value.ends_with('Z') || value.ends_with('z')) {
+                    value.remove_suffix(1);
+                }
+                std::string_view time = "00:00:00";
+                if (value.size() > 10 && (value[10] == ' ' || value[10] == 'T' || value[10] == 't')) {
+                    time = value.substr(11);
+                } else if (value.size() != 10) {
+                    break;
+                }
+                std::string_view fraction;
+                if (time.size() > 8 && time[8] == '.') {
+                    fraction = time.substr(9);
+                    time = time.substr(0, 8);
+                }
+                if (time.size() != 8 || fraction.size() > TIMESTAMP_FRACTION_DIGITS) {
+                    break;
+                }
+                auto* out = normalized.data();
+                out = std::copy_n(value.data(), 10, out);
+                *out++ = ' ';
+                out = std::copy_n(time.data(), time.size(), out);
+                *out++ = '.';
+                out = std::copy_n(fraction.data(), fraction.size(), out);
+                out = std::fill_n(out, TIMESTAMP_FRACTION_DIGITS - fraction.size(), '0');
+                value = std::string_view(normalized.data(), out);
+                break;
+            }
+            default:
+                break;
+        }
+        data.appendFromText(value);
+        // appendFromText falls back to storing text when the value does not parse
+        if (data.type() != target.storage) [[unlikely]] {
+            return std::format("'{}' is not a valid {} for column {}", *field, target.column.type, target.column.name);
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// A target column of an import and the source field that feeds it
+struct ImportColumn {
+    ColumnInfo column;
+    size_t field = 0;
+    ColumnDataType storage = ColumnDataType::Text;
+    bool numericText = false;  ///< decimal/numeric/money: checked to parse as a number, then sent as text so no precision is lost
+};
+
+/// How the fields of an import file load into a table: which column each field fills, the parameterized
+/// INSERT run per batch, and the coercion of text cells into the column types (SchemaInspector::getColumns).
+/// Columns without a field are left out of the INSERT, so identity and default values apply to them.
+class ImportPlan {
+public:
+    /// Pair `fieldNames` with `tableColumns` by case-insensitive name, or the i-th field with the i-th column when
+    /// `byPosition`. Fails when nothing maps or a mapped column cannot be loaded from text (binary, rowversion).
+    [[nodiscard]] static std::expected<ImportPlan, std::string> create(std::string_view table, std::span<const std::string> fieldNames, std::span<const ColumnInfo> tableColumns, bool byPosition);
+
+    [[nodiscard]] const std::vector<ImportColumn>& columns() const noexcept { return m_columns; }
+    /// INSERT INTO <table> (<columns>) VALUES (?, ...), executed once per batch with parameter arrays
+    [[nodiscard]] const std::string& insertStatement() const noexcept { return m_insertStatement; }
+
+    /// Empty batch with one typed column per mapped column
+    [[nodiscard]] ResultSet makeBatch() const;
+    /// Coerce one record into `batch`. Empty cells of non-text columns are NULL; numbers accept a leading '+',
+    /// bit accepts 1/0/true/false/yes/no, and date/time columns ISO 8601 ("2024-01-31", "2024-01-31T12:00:00Z").
+    /// @return the error for a value its column cannot take; the batch must then be discarded
+    [[nodiscard]] std::optional<std::string> append(std::span<const std::optional<std::string_view>> fields, ResultSet& batch) const;
+
+    /// Storage used to bind values of a SQL Server type (sys.types name); nullopt for types text cannot load
+    [[nodiscard]] static std::optional<ColumnDataType> storageTypeFor(std::string_view sqlType) noexcept;
+
+private:
+    ImportPlan() = default;
+
+    std::vector<ImportColumn> m_columns;
+    std::string m_insertStatement;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,147 @@
+#include "json_importer.h"
+
+#include <algorithm>
+#include <format>
+
+using namespace std::literals;
+
+namespace velocitydb {
+
+bool JSONImporter::open(const std::string& filepath, const ImportOptions&) {
+    m_fieldNames.clear();
+    m_lastError.clear();
+    m_firstRecord.clear();
+    m_firstPending = false;
+    m_started = false;
+    m_record = 0;
+    m_bytesRead = 0;
+
+    if (auto error = simdjson::padded_string::load(filepath).get(m_json); error) [[unlikely]] {
+        m_lastError = std::format("Failed to open {}: {}", filepath, simdjson::error_message(error));
+        return false;
+    }
+    try {
+        const std::string_view text(m_json.data(), m_json.size());
+        const auto first = text.find_first_not_of(" \t\r\n");
+        m_lines = first == std::string_view::npos || text[first] != '[';
+        if (m_lines) {
+            if (auto error = m_parser.iterate_many(m_json).get(m_stream); error) [[unlikely]] {
+                throw simdjson::simdjson_error(error);
+            }
+        } else {
+            m_document = m_parser.iterate(m_json);
+            m_array = m_document.get_array();
+            m_arrayIt = m_array.begin();
+            m_arrayEnd = m_array.end();
+        }
+
+        simdjson::ondemand::object object;
+        if (!nextObject(object)) [[unlikely]] {
+            m_lastError = "The file holds no objects";
+            return false;
+        }
+        readFields(object, m_fieldNames, m_firstRecord, true);
+        m_firstPending = true;
+        return true;
+    } catch (const simdjson::simdjson_error& e) {
+        m_lastError = std::format("Invalid JSON: {}", e.what());
+        return false;
+    }
+}
+
+bool JSONImporter::nextRecord(std::vector<std::optional<std::string_view>>& fields) {
+    if (m_firstPending) {
+        m_firstPending = false;
+        fields = m_firstRecord;
+        fields.resize(m_fieldNames.size());
+        return true;
+    }
+    try {
+        simdjson::ondemand::object object;
+        if (!nextObject(object)) {
+            return false;
+        }
+        readFields(object, m_fieldNames, fields, false);
+        return true;
+    } catch (const simdjson::simdjson_error& e) {
+        m_lastError = std::format("Record {}: {}", m_record, e.what());
+        return false;
+    }
+}
+
+bool JSONImporter::nextObject(simdjson::ondemand::object& object) {
+    if (m_lines) {
+        if (!m_started) {
+            m_streamIt = m_stream.begin();
+        } else {
+            ++m_streamIt;
+        }
+        m_started = true;
+        if (m_streamIt == m_stream.end()) {
+            m_bytesRead = m_json.size();
+            return false;
+        }
+        m_bytesRead = m_streamIt.current_index();
+        ++m_record;
+        auto document = *m_streamIt;
+        object = document.get_object();
+        return true;
+    }
+
+    if (m_started) {
+        ++m_arrayIt;
+    }
+    m_started = true;
+    if (m_arrayIt == m_arrayEnd) {
+        m_bytesRead = m_json.size();
+        return false;
+    }
+    if (auto location = m_document.current_location(); !location.error()) {
+        m_bytesRead = static_cast<size_t>(location.value() - m_json.data());
+    }
+    ++m_record;
+    object = (*m_arrayIt).get_object();
+    return true;
+}
+
+void JSONImporter::readFields(simdjson::ondemand::object& object, std::vector<std::string>& names, std::vector<std::optional<std::string_view>>& fields, bool learnNames) {
+    fields.assign(names.size(), std::nullopt);
+    size_t expected = 0;  // Objects usually repeat the key order of the first one
+    for (auto member : object) {
+        const std::string_view key = member.unescaped_key();
+        size_t index = expected;
+        if (index >= names.size() || names[index] != key) {
+            index = static_cast<size_t>(std::ranges::find(names, key) - names.begin());
+        }
+        if (index == names.size()) {
+            if (!learnNames) {
+                continue;
+            }
+            names.emplace_back(key);
+            fields.emplace_back();
+        }
+        expected = index + 1;
+
+        auto value = member.value();
+        switch (value.type()) {
+            case simdjson::ondemand::json_type::null:
+                break;
+            case simdjson::ondemand::json_type::string:
+                fields[index] = std::string_view(value.get_string());
+                break;
+            case simdjson::ondemand::json_type::number: {
+                const std::string_view token = value.raw_json_token();
+                fields[index] = token.substr(0, token.find_last_not_of(" \t\r\n") + 1);
+                break;
+            }
+            case simdjson::ondemand::json_type::boolean:
+                fields[index] = value.get_bool() ? "true"sv : "false"sv;
+                break;
+            default:
+                fields[index] = std::string_view(value.raw_json());
+                break;
+        }
+    }
+}
+
+}  // namespace velocitydb
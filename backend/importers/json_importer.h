@@ -0,0 +1,48 @@
+#pragma once
+
+#include "data_importer.h"
+#include "simdjson.h"
+
+namespace velocitydb {
+
+/// Reads an array of objects (`[{...}, ...]`) or JSON Lines (one object per line) with simdjson On-Demand,
+/// which walks the text without building a DOM. Field names are the keys of the first object; keys missing
+/// from a later object read as NULL and keys it adds are ignored. Numbers keep their source text (no rounding
+/// through double), booleans read as true/false and nested objects or arrays as their raw JSON.
+/// The file is loaded into one padded buffer, so memory use is about the file size.
+class JSONImporter : public DataImporter {
+public:
+    JSONImporter() = default;
+    ~JSONImporter() override = default;
+
+    [[nodiscard]] bool open(const std::string& filepath, const ImportOptions& options) override;
+    [[nodiscard]] bool nextRecord(std::vector<std::optional<std::string_view>>& fields) override;
+
+    [[nodiscard]] size_t bytesRead() const noexcept override { return m_bytesRead; }
+    [[nodiscard]] size_t totalBytes() const noexcept override { return m_json.size(); }
+
+    /// Copy the values of `object` into `fields`, one per name of `names`; with `learnNames`, unknown keys are
+    /// appended to `names`. The views point into the parsed document.
+    static void readFields(simdjson::ondemand::object& object, std::vector<std::string>& names, std::vector<std::optional<std::string_view>>& fields, bool learnNames);
+
+private:
+    /// Next object of the array or stream, or false at the end
+    [[nodiscard]] bool nextObject(simdjson::ondemand::object& object);
+
+    simdjson::padded_string m_json;
+    simdjson::ondemand::parser m_parser;
+    bool m_lines = false;  ///< JSON Lines rather than one top-level array
+    simdjson::ondemand::document m_document;
+    simdjson::ondemand::array m_array;
+    simdjson::ondemand::array_iterator m_arrayIt;
+    simdjson::ondemand::array_iterator m_arrayEnd;
+    simdjson::ondemand::document_stream m_stream;
+    simdjson::ondemand::document_stream::iterator m_streamIt;
+    bool m_started = false;  ///< The first element has been taken
+    std::vector<std::optional<std::string_view>> m_firstRecord;
+    bool m_firstPending = false;
+    uint64_t m_record = 0;
+    size_t m_bytesRead = 0;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,116 @@
+#include "script_runner.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace velocitydb {
+
+void ScriptRunProgress::addError(ScriptRunError error) {
+    std::lock_guard lock(m_mutex);
+    ++m_errorCount;
+    if (m_errors.size() < MAX_ERRORS) {
+        m_errors.push_back(std::move(error));
+    }
+}
+
+std::vector<ScriptRunError> ScriptRunProgress::errorsSince(size_t since) const {
+    std::lock_guard lock(m_mutex);
+    if (since >= m_errors.size()) {
+        return {};
+    }
+    return {m_errors.begin() + static_cast<std::ptrdiff_t>(since), m_errors.end()};
+}
+
+size_t ScriptRunProgress::errorCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_errorCount;
+}
+
+bool ScriptRunner::run(std::string_view script, const ScriptExecutor& execute, ScriptRunProgress& progress, const std::atomic<bool>& cancelRequested, bool continueOnError, size_t maxBatchTokens) {
+    SqlScriptReader reader(script, maxBatchTokens);
+    progress.totalBytes.store(script.size(), std::memory_order_relaxed);
+
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable drained;
+    std::deque<ScriptBatch> queue;  // Guarded by mutex, like readerDone
+    bool readerDone = false;
+    std::atomic<bool> failed{false};
+    auto stopped = [&] { return failed.load(std::memory_order_acquire) || cancelRequested.load(std::memory_order_acquire); };
+
+    std::optional<std::string> readError;
+    {
+        // Batches run in file order on the one connection: they share its session state
+        std::jthread worker([&] {
+            while (true) {
+                ScriptBatch batch;
+                {
+                    std::unique_lock lock(mutex);
+                    queued.wait(lock, [&] { return !queue.empty() || readerDone || stopped(); });
+                    if (queue.empty() || stopped()) {
+                        lock.unlock();
+                        drained.notify_all();
+                        return;
+                    }
+                    batch = queue.front();
+                    queue.pop_front();
+                }
+                drained.notify_one();
+                for (size_t run = 0; run < batch.repeat && !cancelRequested.load(std::memory_order_acquire); ++run) {
+                    try {
+                        const int64_t rows = execute(batch.text);
+                        progress.rowsAffected.fetch_add((std::max)(rows, int64_t{0}), std::memory_order_relaxed);
+                    } catch (const std::exception& e) {
+                        progress.addError({.offset = batch.offset, .line = batch.line, .batch = batch.index, .message = e.what()});
+                        if (!continueOnError) {
+                            failed.store(true, std::memory_order_release);
+                            drained.notify_all();
+                            return;
+                        }
+                        break;
+                    }
+                }
+                progress.batchesRun.fetch_add(1, std::memory_order_relaxed);
+                progress.bytesExecuted.store(batch.offset + batch.text.size(), std::memory_order_relaxed);
+            }
+        });
+
+        // Reader: this thread finds the next batch while the worker runs the current one
+        try {
+            while (!stopped()) {
+                auto batch = reader.next();
+                progress.bytesRead.store(reader.position(), std::memory_order_relaxed);
+                if (!batch) {
+                    break;
+                }
+                std::unique_lock lock(mutex);
+                drained.wait(lock, [&] { return queue.size() < QUEUED_BATCHES || stopped(); });
+                if (stopped()) {
+                    break;
+                }
+                queue.push_back(*batch);
+                lock.unlock();
+                queued.notify_one();
+            }
+        } catch (const std::exception& e) {
+            readError = e.what();
+        }
+        {
+            std::lock_guard lock(mutex);
+            readerDone = true;
+        }
+        queued.notify_all();
+    }  // The worker drains the queue and joins here
+
+    if (readError) [[unlikely]] {
+        throw std::runtime_error(*readError);
+    }
+    return !stopped() && progress.errorCount() == 0;
+}
+
+}  // namespace velocitydb
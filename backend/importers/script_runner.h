@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../parsers/sql_script_reader.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Runs one batch on the script's connection and returns the rows it affected (SQLServerDriver::executeBatch)
+using ScriptExecutor = std::function<int64_t(std::string_view batch)>;
+
+/// A batch of a script that failed, located in the file
+struct ScriptRunError {
+    size_t offset = 0;  ///< Byte offset of the batch in the file
+    size_t line = 1;
+    size_t batch = 0;  ///< GO-separated batch index
+    std::string message;
+};
+
+/// Counters of a running script, readable from any thread
+struct ScriptRunProgress {
+    /// Errors kept for polling; later ones are only counted
+    static constexpr size_t MAX_ERRORS = 1000;
+
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> bytesExecuted{0};  ///< Up to the end of the last batch that finished
+    std::atomic<uint64_t> totalBytes{0};
+    std::atomic<uint64_t> batchesRun{0};
+    std::atomic<int64_t> rowsAffected{0};
+
+    void addError(ScriptRunError error);
+    /// Errors from the `since`-th kept one on
+    [[nodiscard]] std::vector<ScriptRunError> errorsSince(size_t since) const;
+    [[nodiscard]] size_t errorCount() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<ScriptRunError> m_errors;
+    size_t m_errorCount = 0;
+};
+
+/// Runs a T-SQL script file batch by batch without holding it in memory. The calling thread lexes and splits
+/// the (memory-mapped) script with SqlScriptReader while a worker executes the batches in order on one
+/// connection, so batch N+1 is found while batch N runs; at most QUEUED_BATCHES views wait in between.
+class ScriptRunner {
+public:
+    static constexpr size_t QUEUED_BATCHES = 2;
+
+    /// Run every batch of `script`, each as many times as its GO count says. A failed batch is recorded in
+    /// `progress`; the run stops there unless `continueOnError`. Returns early when `cancelRequested` is set.
+    /// @return true when the script ran to its end without a failed batch
+    /// @throws std::runtime_error when the script cannot be split (SqlScriptReader), after the batches before it ran
+    static bool run(std::string_view script, const ScriptExecutor& execute, ScriptRunProgress& progress, const std::atomic<bool>& cancelRequested, bool continueOnError,
+                    size_t maxBatchTokens = SqlScriptReader::DEFAULT_MAX_BATCH_TOKENS);
+};
+
+}  // namespace velocitydb
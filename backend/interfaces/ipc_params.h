@@ -0,0 +1,12 @@
+#pragma once
+
+#include "simdjson.h"
+
+namespace velocitydb {
+
+/// Parsed "params" object of an IPC request.
+/// Points into the dispatcher's thread-local parser: valid only until the handler returns,
+/// so copy out anything that outlives the call (e.g. work handed to another thread).
+using IPCParams = simdjson::dom::element;
+
+}  // namespace velocitydb
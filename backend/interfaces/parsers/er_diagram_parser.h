@@ -3,6 +3,7 @@
 #include "er_model.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace velocitydb {
@@ -12,8 +13,9 @@ public:
     virtual ~IERDiagramParser() = default;
 
     [[nodiscard]] virtual std::vector<std::string> extensions() const = 0;
-    [[nodiscard]] virtual bool canParse(const std::string& content) const = 0;
-    [[nodiscard]] virtual ERModel parse(const std::string& content) const = 0;
+    /// `content` may be a view of a memory-mapped file; parsers must not keep references into it
+    [[nodiscard]] virtual bool canParse(std::string_view content) const = 0;
+    [[nodiscard]] virtual ERModel parse(std::string_view content) const = 0;
 
     [[nodiscard]] virtual std::string generateDDL(const ERModel& model, TargetDatabase target = TargetDatabase::SQLServer) const = 0;
 };
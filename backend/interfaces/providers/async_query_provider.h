@@ -1,7 +1,9 @@
 #pragma once
 
+#include "../ipc_params.h"
+
+#include <functional>
 #include <string>
-#include <string_view>
 
 namespace velocitydb {
 
@@ -10,11 +12,26 @@ class IAsyncQueryProvider {
 public:
     virtual ~IAsyncQueryProvider() = default;
 
-    [[nodiscard]] virtual std::string handleExecuteAsyncQuery(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetAsyncQueryResult(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleCancelAsyncQuery(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetActiveQueries(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleRemoveAsyncQuery(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleExecuteAsyncQuery(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetAsyncQueryResult(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetAsyncQueryRows(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleFilterAsyncQueryRows(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelAsyncQuery(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetActiveQueries(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleRemoveAsyncQuery(const IPCParams& params) = 0;
+    /// First screen of a table without scanning it: catalog row estimate plus a TOP (n) preview in clustered-key
+    /// order (or a TABLESAMPLE), with the exact count submitted as a background async query
+    [[nodiscard]] virtual std::string handleOpenTable(const IPCParams& params) = 0;
+    /// Load and queue of each server behind the admission throttle (only the connection's server with connectionId)
+    [[nodiscard]] virtual std::string handleGetAdmissionStats(const IPCParams& params) = 0;
+    /// maxConcurrent and budget for the connection's server, or the default for every server without connectionId
+    [[nodiscard]] virtual std::string handleSetAdmissionLimits(const IPCParams& params) = 0;
+
+    /// Receives `{"queryId","status","rowsFetched"}` JSON whenever an async query changes state or streams more rows.
+    /// Called from worker threads; must not block.
+    using EventSink = std::function<void(const std::string& eventJson)>;
+    /// Install the event sink; passing nullptr detaches it and waits out any in-flight call
+    virtual void setEventSink(EventSink sink) = 0;
 };
 
 }  // namespace velocitydb
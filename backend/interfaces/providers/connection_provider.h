@@ -1,5 +1,10 @@
 #pragma once
 
+#include "../../database/query_lane.h"
+#include "../ipc_params.h"
+
+#include <expected>
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -7,18 +12,65 @@
 namespace velocitydb {
 
 class SQLServerDriver;
+struct DatabaseConnectionParams;
+struct SqlTokens;
 
 /// Interface for database connection lifecycle and driver access
 class IConnectionProvider {
 public:
     virtual ~IConnectionProvider() = default;
 
-    [[nodiscard]] virtual std::string handleConnect(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleDisconnect(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleTestConnection(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleConnect(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleDisconnect(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleTestConnection(const IPCParams& params) = 0;
+    /// Fetch the same result over a fresh login per TDS packet size and recommend the fastest
+    [[nodiscard]] virtual std::string handleBenchmarkPacketSizes(const IPCParams& params) = 0;
+    /// Test or connect many profiles concurrently; results are collected with handleGetConnectionBatchProgress
+    [[nodiscard]] virtual std::string handleStartConnectionBatch(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetConnectionBatchProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelConnectionBatch(const IPCParams& params) = 0;
+    /// Poll active requests, wait statistics and blocking chains of a connection's server on a dedicated session;
+    /// each sample's changes go to the health event sink
+    [[nodiscard]] virtual std::string handleStartServerMonitor(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleStopServerMonitor(const IPCParams& params) = 0;
+    /// Full samples still in a monitor's ring buffer, after a sequence number
+    [[nodiscard]] virtual std::string handleGetServerHealth(const IPCParams& params) = 0;
+
+    /// Receives ServerHealthMonitor::deltaJson() events. Called from monitor threads; must not block.
+    using EventSink = std::function<void(const std::string& eventJson)>;
+    /// Install the server health event sink; passing nullptr detaches it and waits out any in-flight call
+    virtual void setHealthEventSink(EventSink sink) = 0;
+
+    /// Follow new and changed rows of "table" on a dedicated session: Change Tracking when the table has it, else
+    /// `WHERE key > last` on "keyColumn" or a detected monotonic key. Returns the tailId its events carry.
+    [[nodiscard]] virtual std::string handleStartTableTail(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleStopTableTail(const IPCParams& params) = 0;
+    /// Install the table tail event sink (TableTailMonitor events); same contract as setHealthEventSink
+    virtual void setTailEventSink(EventSink sink) = 0;
 
     [[nodiscard]] virtual std::shared_ptr<SQLServerDriver> getQueryDriver(std::string_view connectionId) = 0;
     [[nodiscard]] virtual std::shared_ptr<SQLServerDriver> getMetadataDriver(std::string_view connectionId) = 0;
+    /// Driver for catalog reads: the read-intent one when the profile routes reads, else the metadata driver
+    [[nodiscard]] virtual std::shared_ptr<SQLServerDriver> getSchemaDriver(std::string_view connectionId) = 0;
+
+    /// Check out a query lane; empty if the connection is unknown. Only `sessionIndependent` work
+    /// (SQLParser::isSessionIndependent) may leave the session lane that getQueryDriver() returns.
+    [[nodiscard]] virtual QueryLane acquireQueryLane(std::string_view connectionId, bool sessionIndependent) = 0;
+    /// Lane for running `script`: session-independent reads go to a read-intent lane when the profile routes reads,
+    /// everything else is acquireQueryLane(connectionId, SQLParser::isSessionIndependent(script))
+    [[nodiscard]] virtual QueryLane acquireLaneFor(std::string_view connectionId, SqlTokens script) = 0;
+    /// Log in to `params` outside the registry, for one-off work on a profile that is not connected. Releasing the
+    /// lane logs out (and closes its SSH tunnel).
+    [[nodiscard]] virtual std::expected<QueryLane, std::string> openStandaloneLane(const DatabaseConnectionParams& params) = 0;
+    /// Keep every query on the session lane while a transaction is open on it
+    virtual void pinSessionLane(std::string_view connectionId, bool pinned) = 0;
+    /// Record a USE executed on the session lane so the other lanes follow it
+    virtual void noteDatabaseChange(std::string_view connectionId, std::string_view database) = 0;
+    /// Cancel the statements running on all lanes of the connection
+    virtual void cancelQueries(std::string_view connectionId) = 0;
+
+    /// Session-independent server/login identity for a connection (empty if unknown)
+    [[nodiscard]] virtual std::string getCacheIdentity(std::string_view connectionId) = 0;
 };
 
 }  // namespace velocitydb
@@ -1,19 +1,37 @@
 #pragma once
 
+#include "../ipc_params.h"
+
+#include <cstdint>
 #include <string>
-#include <string_view>
 #include <vector>
 
 namespace velocitydb {
 
+enum class ExportStatus : uint8_t { Running, Completed, Cancelled, Failed };
+
 /// Interface for data export operations
 class IExportProvider {
 public:
     virtual ~IExportProvider() = default;
 
-    [[nodiscard]] virtual std::string handleExportCSV(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleExportJSON(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleExportExcel(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleExportCSV(const IPCParams& params) = 0;
+    /// A JSON array, or NDJSON with "ndjson": true; "compression": "gzip" compresses the file as it is written
+    [[nodiscard]] virtual std::string handleExportJSON(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleExportExcel(const IPCParams& params) = 0;
+    /// Typed columns in row groups; "compression" is "lz4" (default) or "none"
+    [[nodiscard]] virtual std::string handleExportParquet(const IPCParams& params) = 0;
+    /// A seed script of multi-row INSERT statements into "table" ("rowsPerStatement" up to 1000, the default);
+    /// "goEvery": N adds a GO line after every N statements
+    [[nodiscard]] virtual std::string handleExportSqlInsert(const IPCParams& params) = 0;
+
+    // Background CSV export: returns an exportId whose row/byte progress can be polled or cancelled
+    [[nodiscard]] virtual std::string handleStartCSVExport(const IPCParams& params) = 0;
+    /// Background export of a whole table split into key ranges from its statistics histogram, read concurrently
+    /// on pooled lanes into one key-ordered file or one file per range; polled and cancelled like a CSV export
+    [[nodiscard]] virtual std::string handleStartPartitionedExport(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetExportProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelExport(const IPCParams& params) = 0;
     [[nodiscard]] virtual std::vector<std::string> getSupportedFormats() const = 0;
 };
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../ipc_params.h"
+
+#include <cstdint>
+#include <string>
+
+namespace velocitydb {
+
+enum class ImportStatus : uint8_t { Running, Completed, Cancelled, Failed };
+
+/// Interface for loading CSV/JSON files into tables and running .sql script files
+class IImportProvider {
+public:
+    virtual ~IImportProvider() = default;
+
+    // Background import: returns an importId whose record/row/byte progress can be polled or cancelled
+    [[nodiscard]] virtual std::string handleStartImport(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetImportProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelImport(const IPCParams& params) = 0;
+
+    /// Background run of a .sql file on the session lane, streamed from a memory mapping: returns a runId whose
+    /// byte/batch progress and failed batches (with file offsets) can be polled or cancelled
+    [[nodiscard]] virtual std::string handleStartScriptRun(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetScriptRunProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelScriptRun(const IPCParams& params) = 0;
+};
+
+}  // namespace velocitydb
@@ -1,7 +1,8 @@
 #pragma once
 
+#include "../ipc_params.h"
+
 #include <string>
-#include <string_view>
 
 namespace velocitydb {
 
@@ -10,13 +11,14 @@ class IIOProvider {
 public:
     virtual ~IIOProvider() = default;
 
-    [[nodiscard]] virtual std::string handleWriteFrontendLog(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleSaveQueryToFile(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleLoadQueryFromFile(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleBrowseFile(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetBookmarks(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleSaveBookmark(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleDeleteBookmark(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleWriteFrontendLog(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleWriteFrontendLogs(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleSaveQueryToFile(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleLoadQueryFromFile(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleBrowseFile(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetBookmarks(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleSaveBookmark(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleDeleteBookmark(const IPCParams& params) = 0;
 };
 
 }  // namespace velocitydb
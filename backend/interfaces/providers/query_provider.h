@@ -1,7 +1,14 @@
 #pragma once
 
+#include "../../database/result_registry.h"
+#include "../ipc_params.h"
+
+#include <expected>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace velocitydb {
 
@@ -10,14 +17,94 @@ class IQueryProvider {
 public:
     virtual ~IQueryProvider() = default;
 
-    [[nodiscard]] virtual std::string handleExecuteQuery(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleExecuteQueryPaginated(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetRowCount(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleCancelQuery(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleFilterResultSet(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetCacheStats(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleClearCache(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetQueryHistory(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleExecuteQuery(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleExecuteQueryPaginated(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetRowCount(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelQuery(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleFilterResultSet(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleAggregateResultSet(const IPCParams& params) = 0;
+    /// Rows [startRow, endRow) of the result held under "resultHandle", in the order of "sortModel" (first column) and "filter"
+    [[nodiscard]] virtual std::string handleGetResultWindow(const IPCParams& params) = 0;
+    /// `count` rows from display position `start` of a held result (view as for getResultWindow), only the
+    /// "columns" listed (column indices; all when absent). Cost depends on the window, not the result size.
+    [[nodiscard]] virtual std::string handleGetRows(const IPCParams& params) = 0;
+    /// Full value of cell ("row" display position, "column" index) of a held result. A cell fetched as a LOB
+    /// preview is read again from the query's single source table by its primary key.
+    [[nodiscard]] virtual std::string handleGetCellValue(const IPCParams& params) = 0;
+    /// Per-column null count, distinct estimate, smallest and largest value of the result held under "resultHandle"
+    /// (all rows, whatever the view), from the statistics folded in while it was fetched
+    [[nodiscard]] virtual std::string handleGetColumnStats(const IPCParams& params) = 0;
+    /// Find-in-grid over a held result (view as for getResultWindow): cells whose text contains "needle" (ASCII
+    /// case-insensitive unless "caseInsensitive" is false), as [display row, column] pairs from display row "startRow" on. A page ends after a whole row once "limit"
+    /// cells were found; "nextRow" resumes it.
+    [[nodiscard]] virtual std::string handleSearchResult(const IPCParams& params) = 0;
+    /// Put a selection of a held result (view as for getResultWindow) on the clipboard as "format" tsv, csv or
+    /// markdown: "rowRanges" ([start, end) display positions; all rows when absent) × "columns" (indices; all
+    /// when absent), with column names when "includeHeader" is set and NULLs as "nullText" (empty by default)
+    [[nodiscard]] virtual std::string handleCopyResult(const IPCParams& params) = 0;
+    /// Inserted, deleted and changed rows between "left" and "right" ({connectionId, sql} or {connectionId, table}),
+    /// matched on "keyColumns". Two tables with "chunkChecksums" transfer only the key-hash chunks whose checksums differ.
+    [[nodiscard]] virtual std::string handleCompareData(const IPCParams& params) = 0;
+    /// Run one read-only "sql" on every "targets" entry ({connectionId} or a connection profile, each with an optional
+    /// "key" naming its server) through a bounded worker pool; returns a broadcastId to poll
+    [[nodiscard]] virtual std::string handleStartBroadcastQuery(const IPCParams& params) = 0;
+    /// Per-server outcomes since "since"; once done, a "resultHandle" to the merged result (leading `server` column)
+    [[nodiscard]] virtual std::string handleGetBroadcastProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelBroadcast(const IPCParams& params) = 0;
+    /// Write the result held under "resultHandle" (fetch order) to a .vdbr snapshot at "filepath"; returns its schema and stats
+    [[nodiscard]] virtual std::string handleSaveResultSnapshot(const IPCParams& params) = 0;
+    /// Hold the rows of the snapshot at "filepath" under a new "resultHandle"; "statsOnly" reads just its schema and stats
+    [[nodiscard]] virtual std::string handleOpenResultSnapshot(const IPCParams& params) = 0;
+    /// Hash join of two held results ("leftHandle", "rightHandle", from any connections) on "leftColumns" = "rightColumns"
+    /// (names, pairwise), "joinType" inner or left; the joined rows are held under a new "resultHandle"
+    [[nodiscard]] virtual std::string handleJoinResults(const IPCParams& params) = 0;
+    /// Query the CSV or JSON Lines file at "filepath" in place ("delimiter", "hasHeader", "nullValue" as for import):
+    /// returns a "resultHandle" that getRows, getResultWindow, getCellValue and aggregateResultSet read by parsing only
+    /// the rows they need, while the file is indexed in the background
+    [[nodiscard]] virtual std::string handleOpenFileDatasource(const IPCParams& params) = 0;
+    /// Indexing progress of the file datasource "resultHandle"
+    [[nodiscard]] virtual std::string handleGetFileDatasourceProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleReleaseResult(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetCacheStats(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleClearCache(const IPCParams& params) = 0;
+    /// Run the read-only "sql" on "connectionId" in the background on the five-field "cron" schedule (local time),
+    /// optionally only inside "window" {start, end} ("HH:MM"), so its result is in the memory and disk caches before
+    /// anyone opens it. Replaces the job named "id"; returns the job id and its next run.
+    [[nodiscard]] virtual std::string handleScheduleQuery(const IPCParams& params) = 0;
+    /// Scheduled jobs with their next run, run and skip counts and how the last run ended
+    [[nodiscard]] virtual std::string handleListScheduledQueries(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleUnscheduleQuery(const IPCParams& params) = 0;
+    /// Start the job "id" now, ignoring its window
+    [[nodiscard]] virtual std::string handleRunScheduledQuery(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetQueryHistory(const IPCParams& params) = 0;
+    /// History rolled up per query fingerprint (count, p50/p95 time, last run), slowest first
+    [[nodiscard]] virtual std::string handleGetQueryHistoryStats(const IPCParams& params) = 0;
+    /// Replay the successful history items (between "from" and "to" epoch seconds, matching "keyword", run on
+    /// "sourceConnectionId"; the latest "limit" of them) on "connectionId" with "concurrency" workers at "speedFactor"
+    /// times the recorded pace (0: back to back). Writes only with "includeWrites". Returns a replayId to poll.
+    [[nodiscard]] virtual std::string handleStartWorkloadReplay(const IPCParams& params) = 0;
+    /// Replay counters and latency distributions; once done, the per-shape report with regressions first
+    [[nodiscard]] virtual std::string handleGetWorkloadReplayProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelWorkloadReplay(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetQueryTrace(const IPCParams& params) = 0;
+
+    /// Number of history items whose SQL uses each case-folded word of `folded`, in the same order
+    [[nodiscard]] virtual std::vector<size_t> historyWordUses(std::span<const std::string> folded) = 0;
+
+    /// Hand out (once) an encoded result published by executeQuery with "format":"binary"
+    [[nodiscard]] virtual std::optional<std::string> takeBinaryResult(std::string_view resultId) = 0;
+
+    /// The result executeQuery held for "keepResult" under params "resultHandle", viewed through "sortModel" and "filter"
+    [[nodiscard]] virtual std::expected<HeldResult, std::string> heldResult(const IPCParams& params) = 0;
+    /// Connection and source table of a held result; nullopt when the handle is unknown
+    [[nodiscard]] virtual std::optional<HeldOrigin> heldOrigin(std::string_view handle) const = 0;
+    /// Apply saved grid edits to a held result in place (ResultRegistry::patch); false when it expired or changed
+    virtual bool patchHeldResult(std::string_view handle, std::span<const RowPatch> patches) = 0;
+    /// Drop the results held for a disconnected connection (params = JSON with connectionId)
+    virtual void cleanupConnection(const IPCParams& params) = 0;
+
+    /// Load lazily initialized state now (startup warm-up on a background thread); otherwise it loads on first use
+    virtual void warmUp() = 0;
 };
 
 }  // namespace velocitydb
@@ -1,26 +1,55 @@
 #pragma once
 
+#include "../ipc_params.h"
+
+#include <functional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace velocitydb {
 
+class ObjectNameIndex;
+
 /// Interface for database schema inspection
 class ISchemaProvider {
 public:
     virtual ~ISchemaProvider() = default;
 
-    [[nodiscard]] virtual std::string handleGetDatabases(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetTables(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetColumns(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetIndexes(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetConstraints(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetForeignKeys(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetReferencingForeignKeys(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetTriggers(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetTableMetadata(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetTableDDL(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleGetExecutionPlan(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleGetDatabases(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetTables(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetSchemaSnapshot(const IPCParams& params) = 0;
+    /// Write the connection's whole schema to a file (SchemaSnapshot::serialize) for later comparison
+    [[nodiscard]] virtual std::string handleSaveSchemaSnapshot(const IPCParams& params) = 0;
+    /// Migration DDL from a current to a desired schema, each a connection, snapshot file or ER diagram
+    [[nodiscard]] virtual std::string handleCompareSchemas(const IPCParams& params) = 0;
+    /// The connection's base tables and foreign keys as an ER diagram (the parseERDiagram payload), laid out
+    [[nodiscard]] virtual std::string handleGetERModel(const IPCParams& params) = 0;
+    /// CREATE script of a connection, snapshot file or ER diagram (writeSchemaScript), streamed to `filepath` if given
+    [[nodiscard]] virtual std::string handleExportSchemaDDL(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetColumns(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetIndexes(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetConstraints(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetForeignKeys(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetReferencingForeignKeys(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetTriggers(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetTableMetadata(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetTableDDL(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleGetExecutionPlan(const IPCParams& params) = 0;
+    /// Operator-by-operator comparison of two cached execution plans of the same query
+    [[nodiscard]] virtual std::string handleDiffExecutionPlans(const IPCParams& params) = 0;
+    /// Top resource-consuming and plan-regressed queries of a database's Query Store over a time window
+    [[nodiscard]] virtual std::string handleGetQueryStoreInsights(const IPCParams& params) = 0;
+    /// Missing-index suggestions and unused, duplicate or redundant indexes from the server's DMVs
+    [[nodiscard]] virtual std::string handleGetIndexAdvice(const IPCParams& params) = 0;
+
+    /// Warm the schema cache of a just-opened connection in the background, tables behind `priorityNodes` first
+    virtual void prefetchSchema(std::string_view connectionId, std::vector<std::string> priorityNodes) = 0;
+    /// Stop a disconnected connection's prefetch (params = JSON with connectionId)
+    virtual void cleanupConnection(const IPCParams& params) = 0;
+
+    /// Run `use` on the connection's cached object-name index; false when the connection is not open
+    virtual bool withObjectNames(std::string_view connectionId, const std::function<void(const ObjectNameIndex&)>& use) = 0;
 };
 
 }  // namespace velocitydb
@@ -1,7 +1,8 @@
 #pragma once
 
+#include "../ipc_params.h"
+
 #include <string>
-#include <string_view>
 
 namespace velocitydb {
 
@@ -10,8 +11,16 @@ class ISearchProvider {
 public:
     virtual ~ISearchProvider() = default;
 
-    [[nodiscard]] virtual std::string handleSearchObjects(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleQuickSearch(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleSearchObjects(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleQuickSearch(const IPCParams& params) = 0;
+    /// searchObjects over every database of the instance, searched in parallel; returns a searchId to poll
+    [[nodiscard]] virtual std::string handleStartInstanceSearch(const IPCParams& params) = 0;
+    /// Per-database matches completed since "since", with the overall counts
+    [[nodiscard]] virtual std::string handleGetInstanceSearchProgress(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCancelInstanceSearch(const IPCParams& params) = 0;
+    /// Completions for "sql" at the cursor ("line", "column": 1-based, column in UTF-16 units), ranked by the
+    /// statement's tables and query history
+    [[nodiscard]] virtual std::string handleComplete(const IPCParams& params) = 0;
 };
 
 }  // namespace velocitydb
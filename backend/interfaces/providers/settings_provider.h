@@ -1,7 +1,9 @@
 #pragma once
 
+#include "../ipc_params.h"
+
 #include <string>
-#include <string_view>
+#include <vector>
 
 namespace velocitydb {
 
@@ -11,15 +13,24 @@ public:
     virtual ~ISettingsProvider() = default;
 
     [[nodiscard]] virtual std::string getSettings() = 0;
-    [[nodiscard]] virtual std::string updateSettings(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string updateSettings(const IPCParams& params) = 0;
     [[nodiscard]] virtual std::string getConnectionProfiles() = 0;
-    [[nodiscard]] virtual std::string saveConnectionProfile(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string deleteConnectionProfile(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string getProfilePassword(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string getSshPassword(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string getSshKeyPassphrase(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string saveConnectionProfile(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string deleteConnectionProfile(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string getProfilePassword(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string getSshPassword(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string getSshKeyPassphrase(const IPCParams& params) = 0;
     [[nodiscard]] virtual std::string getSessionState() = 0;
-    [[nodiscard]] virtual std::string saveSessionState(std::string_view params) = 0;
+    /// Tabs without "content" keep what is stored for them (restored tabs not shown yet)
+    [[nodiscard]] virtual std::string saveSessionState(const IPCParams& params) = 0;
+    /// Content of a restored tab ("tabId"), read when it is first shown
+    [[nodiscard]] virtual std::string getSessionTabContent(const IPCParams& params) = 0;
+
+    /// Tree nodes the last session left expanded
+    [[nodiscard]] virtual std::vector<std::string> getExpandedTreeNodes() = 0;
+
+    /// Load lazily initialized state now (startup warm-up on a background thread); otherwise it loads on first use
+    virtual void warmUp() = 0;
 };
 
 }  // namespace velocitydb
@@ -1,7 +1,8 @@
 #pragma once
 
+#include "../ipc_params.h"
+
 #include <string>
-#include <string_view>
 
 namespace velocitydb {
 
@@ -10,12 +11,21 @@ class ITransactionProvider {
 public:
     virtual ~ITransactionProvider() = default;
 
-    [[nodiscard]] virtual std::string handleBeginTransaction(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleCommitTransaction(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string handleRollbackTransaction(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string handleBeginTransaction(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleCommitTransaction(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleRollbackTransaction(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleSavepoint(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string handleRollbackToSavepoint(const IPCParams& params) = 0;
+
+    /// Apply a batch of grid row edits in one round trip (inside the open transaction, if any)
+    [[nodiscard]] virtual std::string handleApplyEdits(const IPCParams& params) = 0;
+
+    /// Save grid edits to a held result's table by primary key, one prepared statement per row, and patch the
+    /// held result with the rows as stored instead of querying again
+    [[nodiscard]] virtual std::string handleSaveGridEdits(const IPCParams& params) = 0;
 
     /// Remove transaction state for a disconnected connection (params = JSON with connectionId)
-    virtual void cleanupConnection(std::string_view params) = 0;
+    virtual void cleanupConnection(const IPCParams& params) = 0;
 };
 
 }  // namespace velocitydb
@@ -1,17 +1,26 @@
 #pragma once
 
+#include "../ipc_params.h"
+
 #include <string>
-#include <string_view>
 
 namespace velocitydb {
 
-/// Interface for utility operations (formatting, parsing)
+/// Interface for utility operations (formatting, parsing, metrics)
 class IUtilityProvider {
 public:
     virtual ~IUtilityProvider() = default;
 
-    [[nodiscard]] virtual std::string uppercaseKeywords(std::string_view params) = 0;
-    [[nodiscard]] virtual std::string parseERDiagram(std::string_view params) = 0;
+    [[nodiscard]] virtual std::string uppercaseKeywords(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string formatSQL(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string parseERDiagram(const IPCParams& params) = 0;
+    /// Positions for the "tables" of an ER model ({name, columns, posX, posY}) linked by "relations"
+    /// ({parentTable, childTable}); tables at (0, 0) are placed, the others kept unless "relayout"
+    [[nodiscard]] virtual std::string layoutERModel(const IPCParams& params) = 0;
+    [[nodiscard]] virtual std::string getMetrics(const IPCParams& params) = 0;
+
+    /// Load lazily initialized state now (startup warm-up on a background thread); otherwise it loads on first use
+    virtual void warmUp() = 0;
 };
 
 }  // namespace velocitydb
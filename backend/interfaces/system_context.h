@@ -8,6 +8,7 @@ class IAsyncQueryProvider;
 class ISchemaProvider;
 class ITransactionProvider;
 class IExportProvider;
+class IImportProvider;
 class ISearchProvider;
 class IUtilityProvider;
 class ISettingsProvider;
@@ -24,6 +25,7 @@ public:
     [[nodiscard]] virtual ISchemaProvider& schema() noexcept = 0;
     [[nodiscard]] virtual ITransactionProvider& transactions() noexcept = 0;
     [[nodiscard]] virtual IExportProvider& exports() noexcept = 0;
+    [[nodiscard]] virtual IImportProvider& imports() noexcept = 0;
     [[nodiscard]] virtual ISearchProvider& search() noexcept = 0;
     [[nodiscard]] virtual IUtilityProvider& utility() noexcept = 0;
     [[nodiscard]] virtual ISettingsProvider& settings() noexcept = 0;
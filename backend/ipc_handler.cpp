@@ -3,6 +3,7 @@
 #include "interfaces/providers/async_query_provider.h"
 #include "interfaces/providers/connection_provider.h"
 #include "interfaces/providers/export_provider.h"
+#include "interfaces/providers/import_provider.h"
 #include "interfaces/providers/io_provider.h"
 #include "interfaces/providers/query_provider.h"
 #include "interfaces/providers/schema_provider.h"
@@ -12,105 +13,424 @@
 #include "interfaces/providers/utility_provider.h"
 #include "interfaces/system_context.h"
 #include "simdjson.h"
+#include "utils/credential_protector.h"
 #include "utils/json_utils.h"
+#include "utils/metrics.h"
+#include "utils/ordered_task_pool.h"
+#include "utils/query_trace.h"
+#include "utils/startup_profiler.h"
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <format>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace std::literals;
 
 namespace velocitydb {
 
-IPCHandler::IPCHandler(ISystemContext& ctx) : m_ctx(ctx) {
-    registerRoutes();
+namespace {
+
+/// connectionId of a successful connect response, empty otherwise
+[[nodiscard]] std::string connectedId(std::string_view response) {
+    simdjson::dom::parser parser;
+    auto connectionId = parser.parse(response)["data"]["connectionId"].get_string();
+    return connectionId.error() ? std::string{} : std::string(connectionId.value());
 }
 
-IPCHandler::~IPCHandler() = default;
+/// Warm the schema cache on the idle metadata driver while the UI builds the tree
+std::string connect(ISystemContext& ctx, const IPCParams& params) {
+    auto response = ctx.connections().handleConnect(params);
+    if (auto connectionId = connectedId(response); !connectionId.empty()) {
+        ctx.schema().prefetchSchema(connectionId, ctx.settings().getExpandedTreeNodes());
+    }
+    return response;
+}
 
-void IPCHandler::registerRoutes() {
-    // Connection lifecycle
-    m_routes["connect"] = [this](auto p) { return m_ctx.connections().handleConnect(p); };
-    m_routes["disconnect"] = [this](auto p) {
-        m_ctx.transactions().cleanupConnection(p);
-        return m_ctx.connections().handleDisconnect(p);
-    };
-    m_routes["testConnection"] = [this](auto p) { return m_ctx.connections().handleTestConnection(p); };
+std::string disconnect(ISystemContext& ctx, const IPCParams& params) {
+    ctx.transactions().cleanupConnection(params);
+    ctx.queries().cleanupConnection(params);
+    ctx.schema().cleanupConnection(params);
+    return ctx.connections().handleDisconnect(params);
+}
+
+struct Route {
+    std::string_view method;
+    IPCLane lane = IPCLane::Control;
+    bool ordered = false;  ///< One at a time per connection, in arrival order
+    std::string (*handler)(ISystemContext&, const IPCParams&) = nullptr;
+};
+
+constexpr size_t LANE_THREADS[] = {2, 2, 4, 2};  // Indexed by IPCLane
+
+// Cheap local calls run unordered on the Control lane
+constexpr Route ROUTES[] = {
+    // Connection lifecycle. A connection's statements, transaction steps and disconnect must reach the server in the order sent.
+    {"connect", IPCLane::Query, true, connect},
+    {"disconnect", IPCLane::Query, true, disconnect},
+    {"testConnection", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.connections().handleTestConnection(p); }},
+    {"benchmarkPacketSizes", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.connections().handleBenchmarkPacketSizes(p); }},
+    {"startConnectionBatch", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.connections().handleStartConnectionBatch(p); }},
+    {"getConnectionBatchProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.connections().handleGetConnectionBatchProgress(p); }},
+    {"cancelConnectionBatch", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.connections().handleCancelConnectionBatch(p); }},
+    // Starting logs in and stopping may wait out a cancelled poll: both stay off the Control lane
+    {"startServerMonitor", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.connections().handleStartServerMonitor(p); }},
+    {"stopServerMonitor", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.connections().handleStopServerMonitor(p); }},
+    {"getServerHealth", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.connections().handleGetServerHealth(p); }},
+    {"startTableTail", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.connections().handleStartTableTail(p); }},
+    {"stopTableTail", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.connections().handleStopTableTail(p); }},
 
     // Query execution
-    m_routes["executeQuery"] = [this](auto p) { return m_ctx.queries().handleExecuteQuery(p); };
-    m_routes["executeQueryPaginated"] = [this](auto p) { return m_ctx.queries().handleExecuteQueryPaginated(p); };
-    m_routes["getRowCount"] = [this](auto p) { return m_ctx.queries().handleGetRowCount(p); };
-    m_routes["cancelQuery"] = [this](auto p) { return m_ctx.queries().handleCancelQuery(p); };
+    {"executeQuery", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.queries().handleExecuteQuery(p); }},
+    {"executeQueryPaginated", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.queries().handleExecuteQueryPaginated(p); }},
+    {"getRowCount", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.queries().handleGetRowCount(p); }},
+    {"cancelQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleCancelQuery(p); }},
 
     // Async queries
-    m_routes["executeAsyncQuery"] = [this](auto p) { return m_ctx.async_queries().handleExecuteAsyncQuery(p); };
-    m_routes["getAsyncQueryResult"] = [this](auto p) { return m_ctx.async_queries().handleGetAsyncQueryResult(p); };
-    m_routes["cancelAsyncQuery"] = [this](auto p) { return m_ctx.async_queries().handleCancelAsyncQuery(p); };
-    m_routes["getActiveQueries"] = [this](auto p) { return m_ctx.async_queries().handleGetActiveQueries(p); };
-    m_routes["removeAsyncQuery"] = [this](auto p) { return m_ctx.async_queries().handleRemoveAsyncQuery(p); };
-
-    // Schema
-    m_routes["getDatabases"] = [this](auto p) { return m_ctx.schema().handleGetDatabases(p); };
-    m_routes["getTables"] = [this](auto p) { return m_ctx.schema().handleGetTables(p); };
-    m_routes["getColumns"] = [this](auto p) { return m_ctx.schema().handleGetColumns(p); };
-    m_routes["getIndexes"] = [this](auto p) { return m_ctx.schema().handleGetIndexes(p); };
-    m_routes["getConstraints"] = [this](auto p) { return m_ctx.schema().handleGetConstraints(p); };
-    m_routes["getForeignKeys"] = [this](auto p) { return m_ctx.schema().handleGetForeignKeys(p); };
-    m_routes["getReferencingForeignKeys"] = [this](auto p) { return m_ctx.schema().handleGetReferencingForeignKeys(p); };
-    m_routes["getTriggers"] = [this](auto p) { return m_ctx.schema().handleGetTriggers(p); };
-    m_routes["getTableMetadata"] = [this](auto p) { return m_ctx.schema().handleGetTableMetadata(p); };
-    m_routes["getTableDDL"] = [this](auto p) { return m_ctx.schema().handleGetTableDDL(p); };
-    m_routes["getExecutionPlan"] = [this](auto p) { return m_ctx.schema().handleGetExecutionPlan(p); };
+    {"executeAsyncQuery", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.async_queries().handleExecuteAsyncQuery(p); }},
+    {"getAsyncQueryResult", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleGetAsyncQueryResult(p); }},
+    {"cancelAsyncQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleCancelAsyncQuery(p); }},
+    {"getActiveQueries", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleGetActiveQueries(p); }},
+    {"getAsyncQueryRows", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleGetAsyncQueryRows(p); }},
+    {"filterAsyncQueryRows", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleFilterAsyncQueryRows(p); }},
+    {"removeAsyncQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleRemoveAsyncQuery(p); }},
+    {"openTable", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleOpenTable(p); }},
+    {"getAdmissionStats", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleGetAdmissionStats(p); }},
+    {"setAdmissionLimits", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.async_queries().handleSetAdmissionLimits(p); }},
+
+    // Schema. One metadata connection per server, so its requests queue behind each other anyway.
+    {"getDatabases", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetDatabases(p); }},
+    {"getTables", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetTables(p); }},
+    {"getSchemaSnapshot", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetSchemaSnapshot(p); }},
+    {"saveSchemaSnapshot", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleSaveSchemaSnapshot(p); }},
+    {"compareSchemas", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.schema().handleCompareSchemas(p); }},
+    {"getERModel", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.schema().handleGetERModel(p); }},
+    {"exportSchemaDDL", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.schema().handleExportSchemaDDL(p); }},
+    {"getColumns", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetColumns(p); }},
+    {"getIndexes", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetIndexes(p); }},
+    {"getConstraints", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetConstraints(p); }},
+    {"getForeignKeys", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetForeignKeys(p); }},
+    {"getReferencingForeignKeys", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetReferencingForeignKeys(p); }},
+    {"getTriggers", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetTriggers(p); }},
+    {"getTableMetadata", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetTableMetadata(p); }},
+    {"getTableDDL", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetTableDDL(p); }},
+    {"getExecutionPlan", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.schema().handleGetExecutionPlan(p); }},
+    {"diffExecutionPlans", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.schema().handleDiffExecutionPlans(p); }},
+    {"getQueryStoreInsights", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.schema().handleGetQueryStoreInsights(p); }},
+    {"getIndexAdvice", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.schema().handleGetIndexAdvice(p); }},
 
     // Transactions
-    m_routes["beginTransaction"] = [this](auto p) { return m_ctx.transactions().handleBeginTransaction(p); };
-    m_routes["commit"] = [this](auto p) { return m_ctx.transactions().handleCommitTransaction(p); };
-    m_routes["rollback"] = [this](auto p) { return m_ctx.transactions().handleRollbackTransaction(p); };
+    {"beginTransaction", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleBeginTransaction(p); }},
+    {"commit", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleCommitTransaction(p); }},
+    {"rollback", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleRollbackTransaction(p); }},
+    {"savepoint", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleSavepoint(p); }},
+    {"rollbackToSavepoint", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleRollbackToSavepoint(p); }},
+    {"applyEdits", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleApplyEdits(p); }},
+    {"saveGridEdits", IPCLane::Query, true, [](auto& ctx, const auto& p) { return ctx.transactions().handleSaveGridEdits(p); }},
 
     // Cache & History
-    m_routes["getCacheStats"] = [this](auto p) { return m_ctx.queries().handleGetCacheStats(p); };
-    m_routes["clearCache"] = [this](auto p) { return m_ctx.queries().handleClearCache(p); };
-    m_routes["getQueryHistory"] = [this](auto p) { return m_ctx.queries().handleGetQueryHistory(p); };
+    {"getCacheStats", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetCacheStats(p); }},
+    {"clearCache", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleClearCache(p); }},
+    {"scheduleQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleScheduleQuery(p); }},
+    {"listScheduledQueries", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleListScheduledQueries(p); }},
+    {"unscheduleQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleUnscheduleQuery(p); }},
+    {"runScheduledQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleRunScheduledQuery(p); }},
+    {"getQueryHistory", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetQueryHistory(p); }},
+    {"getQueryHistoryStats", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetQueryHistoryStats(p); }},
+    {"startWorkloadReplay", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleStartWorkloadReplay(p); }},
+    {"getWorkloadReplayProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetWorkloadReplayProgress(p); }},
+    {"cancelWorkloadReplay", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleCancelWorkloadReplay(p); }},
+    {"getQueryTrace", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetQueryTrace(p); }},
 
     // Filter
-    m_routes["filterResultSet"] = [this](auto p) { return m_ctx.queries().handleFilterResultSet(p); };
+    {"filterResultSet", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleFilterResultSet(p); }},
+    {"aggregateResultSet", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleAggregateResultSet(p); }},
+
+    // Held results
+    {"getResultWindow", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetResultWindow(p); }},
+    {"getRows", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetRows(p); }},
+    {"getCellValue", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetCellValue(p); }},
+    {"getColumnStats", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetColumnStats(p); }},
+    {"searchResult", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleSearchResult(p); }},
+    {"copyResult", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleCopyResult(p); }},
+    {"compareData", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleCompareData(p); }},
+    {"startBroadcastQuery", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleStartBroadcastQuery(p); }},
+    {"getBroadcastProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetBroadcastProgress(p); }},
+    {"cancelBroadcast", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleCancelBroadcast(p); }},
+    {"saveResultSnapshot", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleSaveResultSnapshot(p); }},
+    {"openResultSnapshot", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleOpenResultSnapshot(p); }},
+    {"joinResults", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleJoinResults(p); }},
+    {"openFileDatasource", IPCLane::Query, false, [](auto& ctx, const auto& p) { return ctx.queries().handleOpenFileDatasource(p); }},
+    {"getFileDatasourceProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleGetFileDatasourceProgress(p); }},
+    {"releaseResult", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.queries().handleReleaseResult(p); }},
 
-    // Export
-    m_routes["exportCSV"] = [this](auto p) { return m_ctx.exports().handleExportCSV(p); };
-    m_routes["exportJSON"] = [this](auto p) { return m_ctx.exports().handleExportJSON(p); };
-    m_routes["exportExcel"] = [this](auto p) { return m_ctx.exports().handleExportExcel(p); };
+    // Export. Writers of one file keep their order; without a connection the method name is the ordering key.
+    {"exportCSV", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleExportCSV(p); }},
+    {"exportJSON", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleExportJSON(p); }},
+    {"exportExcel", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleExportExcel(p); }},
+    {"exportParquet", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleExportParquet(p); }},
+    {"exportSqlInsert", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleExportSqlInsert(p); }},
+    {"startCSVExport", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleStartCSVExport(p); }},
+    {"startPartitionedExport", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.exports().handleStartPartitionedExport(p); }},
+    {"getExportProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.exports().handleGetExportProgress(p); }},
+    {"cancelExport", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.exports().handleCancelExport(p); }},
+
+    // Import
+    {"startImport", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.imports().handleStartImport(p); }},
+    {"getImportProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.imports().handleGetImportProgress(p); }},
+    {"cancelImport", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.imports().handleCancelImport(p); }},
+    {"startScriptRun", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.imports().handleStartScriptRun(p); }},
+    {"getScriptRunProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.imports().handleGetScriptRunProgress(p); }},
+    {"cancelScriptRun", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.imports().handleCancelScriptRun(p); }},
 
     // Utility
-    m_routes["uppercaseKeywords"] = [this](auto p) { return m_ctx.utility().uppercaseKeywords(p); };
-    m_routes["parseERDiagram"] = [this](auto p) { return m_ctx.utility().parseERDiagram(p); };
+    {"uppercaseKeywords", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.utility().uppercaseKeywords(p); }},
+    {"formatSQL", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.utility().formatSQL(p); }},
+    {"parseERDiagram", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.utility().parseERDiagram(p); }},
+    {"layoutERModel", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.utility().layoutERModel(p); }},
+    {"getMetrics", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.utility().getMetrics(p); }},
 
     // Search
-    m_routes["searchObjects"] = [this](auto p) { return m_ctx.search().handleSearchObjects(p); };
-    m_routes["quickSearch"] = [this](auto p) { return m_ctx.search().handleQuickSearch(p); };
+    {"searchObjects", IPCLane::Metadata, true, [](auto& ctx, const auto& p) { return ctx.search().handleSearchObjects(p); }},
+    {"startInstanceSearch", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.search().handleStartInstanceSearch(p); }},
+    {"getInstanceSearchProgress", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.search().handleGetInstanceSearchProgress(p); }},
+    {"cancelInstanceSearch", IPCLane::Control, false, [](auto& ctx, const auto& p) { return ctx.search().handleCancelInstanceSearch(p); }},
+    {"quickSearch", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.search().handleQuickSearch(p); }},
+    {"complete", IPCLane::Metadata, false, [](auto& ctx, const auto& p) { return ctx.search().handleComplete(p); }},
 
     // Settings
-    m_routes["getSettings"] = [this](auto) { return m_ctx.settings().getSettings(); };
-    m_routes["updateSettings"] = [this](auto p) { return m_ctx.settings().updateSettings(p); };
-    m_routes["getConnectionProfiles"] = [this](auto) { return m_ctx.settings().getConnectionProfiles(); };
-    m_routes["saveConnectionProfile"] = [this](auto p) { return m_ctx.settings().saveConnectionProfile(p); };
-    m_routes["deleteConnectionProfile"] = [this](auto p) { return m_ctx.settings().deleteConnectionProfile(p); };
-    m_routes["getProfilePassword"] = [this](auto p) { return m_ctx.settings().getProfilePassword(p); };
-    m_routes["getSshPassword"] = [this](auto p) { return m_ctx.settings().getSshPassword(p); };
-    m_routes["getSshKeyPassphrase"] = [this](auto p) { return m_ctx.settings().getSshKeyPassphrase(p); };
-    m_routes["getSessionState"] = [this](auto) { return m_ctx.settings().getSessionState(); };
-    m_routes["saveSessionState"] = [this](auto p) { return m_ctx.settings().saveSessionState(p); };
+    {"getSettings", IPCLane::IO, false, [](auto& ctx, const auto&) { return ctx.settings().getSettings(); }},
+    {"updateSettings", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.settings().updateSettings(p); }},
+    {"getConnectionProfiles", IPCLane::IO, false, [](auto& ctx, const auto&) { return ctx.settings().getConnectionProfiles(); }},
+    {"saveConnectionProfile", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.settings().saveConnectionProfile(p); }},
+    {"deleteConnectionProfile", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.settings().deleteConnectionProfile(p); }},
+    {"getProfilePassword", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.settings().getProfilePassword(p); }},
+    {"getSshPassword", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.settings().getSshPassword(p); }},
+    {"getSshKeyPassphrase", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.settings().getSshKeyPassphrase(p); }},
+    {"getSessionState", IPCLane::IO, false, [](auto& ctx, const auto&) { return ctx.settings().getSessionState(); }},
+    {"saveSessionState", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.settings().saveSessionState(p); }},
+    {"getSessionTabContent", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.settings().getSessionTabContent(p); }},
 
     // IO
-    m_routes["writeFrontendLog"] = [this](auto p) { return m_ctx.io().handleWriteFrontendLog(p); };
-    m_routes["saveQueryToFile"] = [this](auto p) { return m_ctx.io().handleSaveQueryToFile(p); };
-    m_routes["loadQueryFromFile"] = [this](auto p) { return m_ctx.io().handleLoadQueryFromFile(p); };
-    m_routes["browseFile"] = [this](auto p) { return m_ctx.io().handleBrowseFile(p); };
-    m_routes["getBookmarks"] = [this](auto p) { return m_ctx.io().handleGetBookmarks(p); };
-    m_routes["saveBookmark"] = [this](auto p) { return m_ctx.io().handleSaveBookmark(p); };
-    m_routes["deleteBookmark"] = [this](auto p) { return m_ctx.io().handleDeleteBookmark(p); };
+    {"writeFrontendLog", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.io().handleWriteFrontendLog(p); }},
+    {"writeFrontendLogs", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.io().handleWriteFrontendLogs(p); }},
+    {"saveQueryToFile", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.io().handleSaveQueryToFile(p); }},
+    {"loadQueryFromFile", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.io().handleLoadQueryFromFile(p); }},
+    {"browseFile", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.io().handleBrowseFile(p); }},
+    {"getBookmarks", IPCLane::IO, false, [](auto& ctx, const auto& p) { return ctx.io().handleGetBookmarks(p); }},
+    {"saveBookmark", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.io().handleSaveBookmark(p); }},
+    {"deleteBookmark", IPCLane::IO, true, [](auto& ctx, const auto& p) { return ctx.io().handleDeleteBookmark(p); }},
+};
+
+constexpr uint64_t fnv1a(std::string_view text) noexcept {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/// Collision-free multiplicative hash over ROUTES, found at compile time: a lookup is one FNV-1a pass over
+/// the method name, a multiply, a table load and one string compare
+struct RouteIndex {
+    static constexpr unsigned BITS = 10;
+    uint64_t multiplier = 0;
+    std::array<uint8_t, size_t{1} << BITS> slots{};  // Route index + 1; 0 marks an empty slot
+
+    [[nodiscard]] constexpr size_t slotOf(uint64_t hash) const noexcept { return static_cast<size_t>((hash * multiplier) >> (64 - BITS)); }
+};
+
+static_assert(std::size(ROUTES) < 0xFF, "RouteIndex slots hold route indices in a byte");
+
+consteval RouteIndex buildRouteIndex() {
+    std::array<uint64_t, std::size(ROUTES)> hashes{};
+    for (size_t i = 0; i < std::size(ROUTES); ++i) {
+        hashes[i] = fnv1a(ROUTES[i].method);
+        for (size_t j = 0; j < i; ++j) {
+            if (ROUTES[j].method == ROUTES[i].method) {
+                throw "duplicate IPC route";
+            }
+        }
+    }
+    // Odd multipliers from a fixed sequence; with ~80 routes in 1024 slots a few dozen tries are typical
+    for (uint64_t candidate = 0x9E3779B97F4A7C15ull, attempt = 0; attempt < 100000; ++attempt, candidate += 0x5851F42D4C957F2Aull) {
+        RouteIndex index;
+        index.multiplier = candidate | 1;
+        bool collided = false;
+        for (size_t i = 0; i < std::size(ROUTES) && !collided; ++i) {
+            auto& slot = index.slots[index.slotOf(hashes[i])];
+            collided = slot != 0;
+            slot = static_cast<uint8_t>(i + 1);
+        }
+        if (!collided) {
+            return index;
+        }
+    }
+    throw "no collision-free multiplier for the IPC routes";
+}
+
+constexpr RouteIndex ROUTE_INDEX = buildRouteIndex();
+
+[[nodiscard]] constexpr const Route* findRoute(std::string_view method) noexcept {
+    const auto slot = ROUTE_INDEX.slots[ROUTE_INDEX.slotOf(fnv1a(method))];
+    if (slot == 0 || ROUTES[slot - 1].method != method) {
+        return nullptr;
+    }
+    return &ROUTES[slot - 1];
+}
+
+static_assert([] {
+    for (const auto& route : ROUTES) {
+        if (findRoute(route.method) != &route) {
+            return false;
+        }
+    }
+    return findRoute("") == nullptr && findRoute("executeQueryX") == nullptr;
+}());
+
+/// Where one {"method","params"} request runs: its lane, and the ordering key when the route is ordered
+struct Placement {
+    IPCLane lane = IPCLane::Control;
+    std::string key;
+};
+
+[[nodiscard]] Placement placementOf(simdjson::dom::element request) {
+    Placement placement;
+    if (auto method = request["method"].get_string(); !method.error()) {
+        const auto* route = findRoute(method.value());
+        if (route == nullptr) {
+            return placement;
+        }
+        placement.lane = route->lane;
+        if (route->ordered) {
+            auto connectionId = request["params"]["connectionId"].get_string();
+            placement.key = connectionId.error() ? std::string(method.value()) : std::format("connection:{}", connectionId.value());
+        }
+    }
+    return placement;
+}
+
+void post(OrderedTaskPool& pool, std::string key, OrderedTaskPool::Task task) {
+    static auto& queued = MetricsRegistry::instance().gauge("ipc.queued");
+    queued.add(1);
+    auto counted = [task = std::move(task)] {
+        queued.add(-1);
+        task();
+    };
+    if (key.empty()) {
+        pool.post(std::move(counted));
+    } else {
+        pool.post(std::move(key), std::move(counted));
+    }
+}
+
+/// {"success":true,"data":[<response of entry 0>,...]}: each entry keeps its own success/error envelope
+[[nodiscard]] std::string batchResponse(std::span<const std::string> responses) {
+    std::string data = "[";
+    for (size_t i = 0; i < responses.size(); ++i) {
+        if (i > 0) {
+            data += ',';
+        }
+        data += responses[i];
+    }
+    data += ']';
+    return JsonUtils::successResponse(data);
+}
+
+}  // namespace
+
+IPCHandler::IPCHandler(ISystemContext& ctx) : m_ctx(ctx) {
+    // Per-route metrics, resolved once here so dispatch does no registry lookup
+    auto& registry = MetricsRegistry::instance();
+    m_routeMetrics.reserve(std::size(ROUTES));
+    for (const auto& route : ROUTES) {
+        m_routeMetrics.push_back(RouteMetrics{
+            .latency = &registry.histogram(std::format("ipc.latency_us.{}", route.method)),
+            .requestBytes = &registry.histogram(std::format("ipc.request_bytes.{}", route.method)),
+            .responseBytes = &registry.histogram(std::format("ipc.response_bytes.{}", route.method)),
+        });
+    }
+    for (size_t i = 0; i < m_lanes.size(); ++i) {
+        m_lanes[i] = std::make_unique<OrderedTaskPool>(LANE_THREADS[i]);
+    }
+}
+
+IPCHandler::~IPCHandler() = default;
+
+void IPCHandler::dispatchAsync(std::string request, Responder respond) {
+    // Only the envelope is needed to pick the lane; the worker parses the request again for the handler.
+    // Both parses reuse thread-local parsers, and requests are small next to the server round trips saved.
+    thread_local simdjson::dom::parser parser;
+    Placement placement;
+    if (simdjson::dom::element doc; !parser.parse(request).get(doc)) {
+        if (simdjson::dom::array batch; !doc["batch"].get(batch)) {
+            // Each entry runs on its own lane, concurrently with the others (ordered routes still queue per
+            // connection); the combined response goes out when the last entry finishes
+            struct BatchState {
+                std::vector<std::string> responses;
+                std::atomic<size_t> remaining{0};
+                Responder respond;
+            };
+            auto state = std::make_shared<BatchState>();
+            state->respond = std::move(respond);
+            for (auto entry : batch) {
+                state->responses.emplace_back(simdjson::minify(entry));
+            }
+            if (state->responses.empty()) {
+                state->respond(batchResponse({}));
+                return;
+            }
+            state->remaining = state->responses.size();
+            size_t index = 0;
+            for (auto entry : batch) {
+                auto entryPlacement = placementOf(entry);
+                post(lane(entryPlacement.lane), std::move(entryPlacement.key), [this, state, index] {
+                    // Each task owns its slot: the request text goes in, the response comes out
+                    state->responses[index] = dispatchRequest(state->responses[index]);
+                    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        state->respond(batchResponse(state->responses));
+                    }
+                });
+                ++index;
+            }
+            return;
+        }
+        placement = placementOf(doc);
+    }
+
+    post(lane(placement.lane), std::move(placement.key), [this, request = std::move(request), respond = std::move(respond)] { respond(dispatchRequest(request)); });
+}
+
+void IPCHandler::shutdown() {
+    for (auto& pool : m_lanes) {
+        pool->shutdown();
+    }
+    CredentialProtector::clearCache();
 }
 
 std::string IPCHandler::dispatchRequest(std::string_view request) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(request);
+        // Reused per IPC worker thread, so steady-state requests allocate no parser tape or string buffer.
+        // The second parser only serves legacy requests whose params arrive as a JSON-encoded string.
+        thread_local simdjson::dom::parser parser;
+        thread_local simdjson::dom::parser paramsParser;
+        simdjson::dom::element doc = parser.parse(request);
+
+        // {"batch":[{"method":...,"params":...},...]}: run in order here (dispatchAsync runs them concurrently).
+        // Entries are copied out first, since dispatching them reuses this thread's parser.
+        if (simdjson::dom::array batch; !doc["batch"].get(batch)) {
+            std::vector<std::string> responses;
+            for (auto entry : batch) {
+                responses.emplace_back(simdjson::minify(entry));
+            }
+            for (auto& response : responses) {
+                response = dispatchRequest(response);
+            }
+            return batchResponse(responses);
+        }
 
         auto methodResult = doc["method"].get_string();
         if (methodResult.error()) [[unlikely]] {
@@ -118,17 +438,39 @@ std::string IPCHandler::dispatchRequest(std::string_view request) {
         }
         auto method = methodResult.value();
 
-        std::string params;
-        if (auto paramsResult = doc["params"].get_string(); !paramsResult.error()) {
-            params = std::string(paramsResult.value());
+        // Every request is one trace; the spans of the phases below it are recorded against it
+        TraceContext trace;
+        TraceScope span("ipc.dispatch");
+        span.setDetail(std::string(method));
+
+        simdjson::dom::element params;
+        if (auto paramsResult = doc["params"]; paramsResult.error()) {
+            params = paramsParser.parse("{}"sv);
+        } else if (auto paramsString = paramsResult.get_string(); !paramsString.error()) {
+            params = paramsParser.parse(paramsString.value());
+        } else {
+            params = paramsResult.value();
         }
 
-        if (auto route = m_routes.find(std::string(method)); route != m_routes.end()) [[likely]] {
-            return route->second(params);
+        // The page is loaded and talking to the backend: the cold start is over
+        StartupProfiler::instance().reportInteractive();
+
+        if (const auto* route = findRoute(method)) [[likely]] {
+            const auto& metrics = m_routeMetrics[static_cast<size_t>(route - ROUTES)];
+            metrics.requestBytes->record(request.size());
+            std::string response;
+            {
+                ScopedLatency timed(*metrics.latency);
+                response = route->handler(m_ctx, params);
+            }
+            metrics.responseBytes->record(response.size());
+            return response;
         }
 
         return JsonUtils::errorResponse(std::format("Unknown method: {}", method));
     } catch (const std::exception& e) {
+        static auto& failures = MetricsRegistry::instance().counter("ipc.exceptions");
+        failures.add();
         return JsonUtils::errorResponse(e.what());
     }
 }
@@ -1,15 +1,32 @@
 #pragma once
 
+#include "interfaces/ipc_params.h"
+
+#include <array>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 
 namespace velocitydb {
 
 class ISystemContext;
+class MetricHistogram;
+class OrderedTaskPool;
+
+/// Worker pool class a route runs on, so slow server round trips of one kind never queue the others
+enum class IPCLane : uint8_t {
+    Control,   ///< Cheap, local answers: cancellation, progress polls, caches, metrics
+    Metadata,  ///< Schema browsing and object search
+    Query,     ///< Connections, query execution and transactions
+    IO,        ///< Files, export/import, settings and logs
+};
 
 /// Thin dispatcher: routes IPC requests to context methods via ISystemContext.
+/// Routes live in a compile-time table behind a perfect hash; each records ipc.latency_us.<method>,
+/// ipc.request_bytes.<method> and ipc.response_bytes.<method> histograms, reported by getMetrics.
 class IPCHandler {
 public:
     explicit IPCHandler(ISystemContext& ctx);
@@ -20,15 +37,36 @@ public:
     IPCHandler(IPCHandler&&) = delete;
     IPCHandler& operator=(IPCHandler&&) = delete;
 
-    /// Parses and dispatches an IPC request, returning a JSON response
+    /// Parses and dispatches an IPC request, returning a JSON response.
+    /// The envelope {"method":..., "params":{...}} is parsed once into a thread-local parser and
+    /// handlers read the params element in place ("params" given as a JSON string is still accepted).
+    /// {"batch":[request,...]} runs each request and answers {"success":true,"data":[response,...]}.
     [[nodiscard]] std::string dispatchRequest(std::string_view request);
 
+    using Responder = std::function<void(std::string)>;
+
+    /// Runs dispatchRequest on the route's lane and hands the response to `respond` on that worker.
+    /// Returns at once. Ordered routes run one at a time per connection (per method when the request
+    /// names none), in arrival order; everything else runs as soon as a worker of its lane is free.
+    /// The entries of a batch are placed the same way, concurrently, and answered together.
+    void dispatchAsync(std::string request, Responder respond);
+
+    /// Drop queued requests and wait for running ones; later requests are not answered.
+    /// Call before whatever `respond` callbacks point into is destroyed.
+    void shutdown();
+
 private:
-    void registerRoutes();
+    [[nodiscard]] OrderedTaskPool& lane(IPCLane lane) { return *m_lanes[static_cast<size_t>(lane)]; }
+
+    struct RouteMetrics {
+        MetricHistogram* latency;
+        MetricHistogram* requestBytes;
+        MetricHistogram* responseBytes;
+    };
 
-    using Handler = std::function<std::string(std::string_view)>;
-    std::unordered_map<std::string, Handler> m_routes;
     ISystemContext& m_ctx;
+    std::vector<RouteMetrics> m_routeMetrics;  // Indexed like the route table
+    std::array<std::unique_ptr<OrderedTaskPool>, 4> m_lanes;
 };
 
 }  // namespace velocitydb
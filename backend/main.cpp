@@ -1,9 +1,19 @@
+#include "contexts/system_context.h"
+#include "headless_export.h"
+#include "utils/encoding.h"
 #include "utils/logger.h"
+#include "utils/startup_profiler.h"
 #include "webview_app.h"
 
 #include <Windows.h>
 
 #include <objbase.h>
+#include <shellapi.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
 
 // Window title for finding existing instance
 constexpr const wchar_t* WINDOW_TITLE = L"Velocity-DB";
@@ -25,11 +35,67 @@ BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
     return TRUE;  // Continue enumeration
 }
 
+// Command-line arguments after the program name, as UTF-8
+std::vector<std::string> commandLineArguments() {
+    int count = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &count);
+    std::vector<std::string> args;
+    for (int i = 1; argv != nullptr && i < count; ++i) {
+        args.push_back(velocitydb::wideToUtf8(argv[i], wcslen(argv[i])));
+    }
+    LocalFree(argv);
+    return args;
+}
+
+// Headless export: no window, no single-instance lock, exit code for the calling job
+int runHeadlessExport(const std::vector<std::string>& args) {
+    // A GUI-subsystem process has no console; write to the one it was started from unless output is redirected
+    if (GetStdHandle(STD_ERROR_HANDLE) == nullptr && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE* stream = nullptr;
+        freopen_s(&stream, "CONOUT$", "w", stdout);
+        freopen_s(&stream, "CONOUT$", "w", stderr);
+    }
+
+    auto options = velocitydb::HeadlessExportOptions::parse(args);
+    if (!options) {
+        std::cerr << options.error() << '\n';
+        return velocitydb::HeadlessExport::EXIT_USAGE;
+    }
+    // Keeps the password off the command line of scheduled jobs
+    if (options->password.empty()) {
+        std::wstring password(256, L'\0');
+        const DWORD length = GetEnvironmentVariableW(L"VELOCITYDB_PASSWORD", password.data(), static_cast<DWORD>(password.size()));
+        if (length > 0 && length < password.size()) {
+            options->password = velocitydb::wideToUtf8(password.data(), length);
+        }
+    }
+
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    velocitydb::initialize_logger();
+    int result = velocitydb::HeadlessExport::EXIT_FAILED;
+    try {
+        velocitydb::SystemContext context;
+        velocitydb::HeadlessExport exporter(context, std::cerr);
+        result = exporter.run(*options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+    }
+    CoUninitialize();
+    return result;
+}
+
 int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ int nCmdShow) {
     (void)hPrevInstance;
     (void)lpCmdLine;
     (void)nCmdShow;
 
+    if (const auto args = commandLineArguments(); velocitydb::HeadlessExportOptions::requested(args)) {
+        return runHeadlessExport(args);
+    }
+
+    // Origin of the cold-start timeline logged once the page is interactive
+    (void)velocitydb::StartupProfiler::instance();
+
     // Initialize COM (required by WebView2)
     CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
 
@@ -8,18 +8,27 @@
 #pragma comment(lib, "ws2_32.lib")
 #else
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #endif
 
 #include "../utils/logger.h"
+#include "../utils/metrics.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <format>
 #include <fstream>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace velocitydb {
@@ -43,6 +52,16 @@ inline void initWsa() {
 inline int getLastSocketError() {
     return WSAGetLastError();
 }
+inline bool wouldBlock() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+inline int pollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+inline void setNonBlocking(socket_t s) {
+    u_long mode = 1;
+    ioctlsocket(s, FIONBIO, &mode);
+}
 #else
 using socket_t = int;
 constexpr socket_t INVALID_SOCK = -1;
@@ -53,26 +72,142 @@ inline void initWsa() {}
 inline int getLastSocketError() {
     return errno;
 }
+inline bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+inline int pollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+inline void setNonBlocking(socket_t s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    fcntl(s, F_SETFL, flags | O_NONBLOCK);
+}
 #endif
 
-constexpr int BUFFER_SIZE = 16384;
+/// Bytes buffered per direction of each forwarded connection; large enough to keep a TDS stream moving
+/// while the other side is briefly not writable
+constexpr size_t CHANNEL_BUFFER_SIZE = 256 * 1024;
+
+/// Upper bound on an idle poll, only so the proxy thread notices disconnect(); traffic wakes it immediately
+constexpr int IDLE_POLL_MS = 100;
+
+/// Bound on blocking handshake/auth steps, so a jump host that stops answering cannot stall a reconnect forever
+constexpr long HANDSHAKE_TIMEOUT_MS = 15000;
+
+/// Wait between reconnect attempts after the SSH connection dropped, doubling up to the maximum
+constexpr std::chrono::milliseconds RECONNECT_MIN_DELAY{1000};
+constexpr std::chrono::milliseconds RECONNECT_MAX_DELAY{30000};
+
+/// Channel errors that mean the SSH connection itself is gone rather than just one forwarded connection
+inline bool isTransportError(ssize_t rc) {
+    return rc == LIBSSH2_ERROR_SOCKET_SEND || rc == LIBSSH2_ERROR_SOCKET_RECV || rc == LIBSSH2_ERROR_SOCKET_DISCONNECT || rc == LIBSSH2_ERROR_SOCKET_TIMEOUT;
+}
+
+/// Bytes waiting to be forwarded in one direction: filled at the back, drained from the front
+class PendingBytes {
+public:
+    PendingBytes() : m_data(std::make_unique<char[]>(CHANNEL_BUFFER_SIZE)) {}
+
+    [[nodiscard]] bool empty() const noexcept { return m_begin == m_end; }
+    [[nodiscard]] size_t size() const noexcept { return m_end - m_begin; }
+    [[nodiscard]] size_t room() const noexcept { return CHANNEL_BUFFER_SIZE - m_end; }
+    /// Whether makeRoom() would leave space to read into
+    [[nodiscard]] bool canFill() const noexcept { return size() < CHANNEL_BUFFER_SIZE; }
+    [[nodiscard]] const char* head() const noexcept { return m_data.get() + m_begin; }
+    [[nodiscard]] char* tail() noexcept { return m_data.get() + m_end; }
+
+    /// Slide pending bytes to the front when the back is full; returns the free space at the back
+    size_t makeRoom() noexcept {
+        if (room() == 0 && m_begin > 0) {
+            std::memmove(m_data.get(), head(), size());
+            m_end -= m_begin;
+            m_begin = 0;
+        }
+        return room();
+    }
+
+    void produced(size_t bytes) noexcept { m_end += bytes; }
+    void consume(size_t bytes) noexcept {
+        m_begin += bytes;
+        if (m_begin == m_end) {
+            m_begin = m_end = 0;
+        }
+    }
+
+private:
+    std::unique_ptr<char[]> m_data;
+    size_t m_begin = 0;
+    size_t m_end = 0;
+};
+
+/// Payload bytes one tunnel has forwarded (client -> server / server -> client)
+struct TunnelTraffic {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+};
 
 struct ClientSession {
-    socket_t socket;
-    LIBSSH2_CHANNEL* channel;
+    socket_t socket = INVALID_SOCK;
+    LIBSSH2_CHANNEL* channel = nullptr;
+    PendingBytes toServer;  ///< Read from the client, not yet accepted by the channel
+    PendingBytes toClient;  ///< Read from the channel, not yet accepted by the client socket
+    bool clientClosed = false;
+    bool channelClosed = false;
 };
 
+inline void setNoDelay(socket_t s) {
+    int optval = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&optval), sizeof(optval));
+}
+
 }  // namespace
 
-class SshTunnel::Impl {
+/// One authenticated SSH connection and its proxy thread, shared by every SshTunnel to the same jump host
+/// (host, port, user). Each DB target reached through it gets one local listener (a forward), counted by the
+/// tunnels using it; the session closes when the last tunnel lets go of it.
+///
+/// When the SSH connection fails (socket error, hang-up, failed keepalive) the proxy thread drops the forwarded
+/// connections and re-handshakes with backoff. Listeners stay bound meanwhile, so local ports survive the outage;
+/// generation() counts the recoveries so owners of ODBC connections through the forwards know to reopen them.
+class SshSession {
 public:
-    Impl() = default;
-    ~Impl() { disconnect(); }
+    SshSession() = default;
+    ~SshSession() { shutdown(); }
+
+    SshSession(const SshSession&) = delete;
+    SshSession& operator=(const SshSession&) = delete;
+
+    /// The live session for the config's jump host, opening one if there is none
+    [[nodiscard]] static std::expected<std::shared_ptr<SshSession>, SshTunnelError> shared(const SshTunnelConfig& config) {
+        static std::mutex poolMutex;
+        static std::unordered_map<std::string, std::weak_ptr<SshSession>> pool;
+        const auto key = std::format("{}@{}:{}", config.username, config.host, config.port);
+        {
+            std::lock_guard lock(poolMutex);
+            if (auto it = pool.find(key); it != pool.end()) {
+                if (auto session = it->second.lock(); session && session->alive()) {
+                    log<LogLevel::INFO>(std::format("[SSH] Reusing SSH session to {}", key));
+                    return session;
+                }
+                pool.erase(it);
+            }
+        }
 
-    std::expected<void, SshTunnelError> connect(const SshTunnelConfig& config) {
+        // Handshakes run outside the pool lock so one slow jump host does not hold up the others. Two concurrent
+        // first connects to the same host both succeed; the later one becomes the shared session.
+        auto session = std::make_shared<SshSession>();
+        if (auto opened = session->open(config); !opened) {
+            return std::unexpected(opened.error());
+        }
+        std::lock_guard lock(poolMutex);
+        std::erase_if(pool, [](const auto& entry) { return entry.second.expired(); });
+        pool[key] = session;
+        return session;
+    }
+
+    std::expected<void, SshTunnelError> open(const SshTunnelConfig& config) {
         log<LogLevel::INFO>("[SSH] Starting SSH tunnel connection...");
         log<LogLevel::INFO>(std::format("[SSH] SSH Host: {}:{}", config.host, config.port));
-        log<LogLevel::INFO>(std::format("[SSH] Remote target: {}:{}", config.remoteHost, config.remotePort));
         log<LogLevel::INFO>(std::format("[SSH] Username: {}", config.username));
         log<LogLevel::INFO>(std::format("[SSH] Auth method: {}", config.authMethod == SshAuthMethod::Password ? "password" : "publickey"));
         log_flush();
@@ -88,6 +223,23 @@ public:
         m_libssh2Initialized = true;
         log<LogLevel::DEBUG>("[SSH] libssh2 initialized successfully");
 
+        if (auto established = establish(config); !established) {
+            return established;
+        }
+        m_config = config;
+        m_linkUp = true;
+        m_running = true;
+
+        // Start proxy thread
+        log<LogLevel::INFO>("[SSH] Starting proxy thread...");
+        log_flush();
+        m_proxyThread = std::thread(&SshSession::proxyLoop, this);
+        MetricsRegistry::instance().gauge("ssh.sessions").add(1);
+        return {};
+    }
+
+    /// Connect, handshake and authenticate a fresh SSH connection (on failure the caller releases what was created)
+    std::expected<void, SshTunnelError> establish(const SshTunnelConfig& config) {
         // Create socket and connect to SSH server
         log<LogLevel::DEBUG>("[SSH] Creating SSH socket...");
         m_sshSocket = socket(AF_INET, SOCK_STREAM, 0);
@@ -121,6 +273,7 @@ public:
             return std::unexpected(SshTunnelError{SshTunnelError::Code::ConnectionFailed, std::format("Failed to connect to {}:{}", config.host, config.port)});
         }
         log<LogLevel::INFO>("[SSH] Connected to SSH server successfully");
+        setNoDelay(m_sshSocket);
 
         // Create SSH session
         log<LogLevel::DEBUG>("[SSH] Creating SSH session...");
@@ -133,6 +286,21 @@ public:
 
         // Set blocking mode for handshake and auth
         libssh2_session_set_blocking(m_session, 1);
+        libssh2_session_set_timeout(m_session, HANDSHAKE_TIMEOUT_MS);
+
+        // Negotiation preferences must be in place before the handshake
+        if (config.compression) {
+            libssh2_session_flag(m_session, LIBSSH2_FLAG_COMPRESS, 1);
+            log<LogLevel::DEBUG>("[SSH] zlib compression requested");
+        }
+        if (!config.ciphers.empty()) {
+            for (int method : {LIBSSH2_METHOD_CRYPT_CS, LIBSSH2_METHOD_CRYPT_SC}) {
+                if (libssh2_session_method_pref(m_session, method, config.ciphers.c_str()) != 0) {
+                    log<LogLevel::WARNING>(std::format("[SSH] Cipher preference not supported, using defaults: {}", config.ciphers));
+                    break;
+                }
+            }
+        }
 
         // Perform SSH handshake
         log<LogLevel::DEBUG>("[SSH] Performing SSH handshake...");
@@ -144,6 +312,10 @@ public:
             return std::unexpected(SshTunnelError{SshTunnelError::Code::ConnectionFailed, std::format("SSH handshake failed: {}", errMsg ? errMsg : "unknown")});
         }
         log<LogLevel::INFO>("[SSH] SSH handshake completed successfully");
+        if (const char* cipher = libssh2_session_methods(m_session, LIBSSH2_METHOD_CRYPT_SC)) {
+            const char* compression = libssh2_session_methods(m_session, LIBSSH2_METHOD_COMP_SC);
+            log<LogLevel::INFO>(std::format("[SSH] Cipher: {}, compression: {}", cipher, compression ? compression : "none"));
+        }
 
         // Authenticate
         log<LogLevel::DEBUG>("[SSH] Authenticating...");
@@ -154,28 +326,44 @@ public:
             return authResult;
         }
         log<LogLevel::INFO>("[SSH] Authentication successful");
+        libssh2_session_set_timeout(m_session, 0);
 
         // Enable SSH keepalive to prevent server-side idle timeout
         // Many SSH servers have ClientAliveInterval (e.g. 15-60s) that drops
         // connections without keepalive responses, causing ODBC tunnel breakage
         libssh2_keepalive_config(m_session, 1, 15);
         log<LogLevel::DEBUG>("[SSH] Keepalive configured: interval=15s");
+        return {};
+    }
 
-        // Store remote target info
-        m_remoteHost = config.remoteHost;
-        m_remotePort = config.remotePort;
+    /// Local port forwarding to remoteHost:remotePort, shared with other tunnels to the same target.
+    /// The channel window is fixed by whichever tunnel opened the forward first.
+    std::expected<int, SshTunnelError> acquireForward(const std::string& remoteHost, int remotePort, uint32_t channelWindow) {
+        std::lock_guard lock(m_forwardsMutex);
+        for (auto& forward : m_forwards) {
+            if (forward.remotePort == remotePort && forward.remoteHost == remoteHost) {
+                ++forward.refs;
+                log<LogLevel::INFO>(std::format("[SSH] Sharing forward localhost:{} -> {}:{} ({} users)", forward.localPort, remoteHost, remotePort, forward.refs));
+                return forward.localPort;
+            }
+        }
 
         // Create local listener socket
         log<LogLevel::DEBUG>("[SSH] Creating local listener socket...");
-        m_listenerSocket = socket(AF_INET, SOCK_STREAM, 0);
-        if (m_listenerSocket == INVALID_SOCK) {
+        socket_t listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == INVALID_SOCK) {
             log<LogLevel::ERROR_LEVEL>("[SSH] Failed to create listener socket");
             return std::unexpected(SshTunnelError{SshTunnelError::Code::SocketError, "Failed to create listener socket"});
         }
+        const auto fail = [listener](std::string message) {
+            log<LogLevel::ERROR_LEVEL>(std::format("[SSH] {}", message));
+            closeSocket(listener);
+            return std::unexpected(SshTunnelError{SshTunnelError::Code::TunnelFailed, std::move(message)});
+        };
 
         // Allow address reuse
         int optval = 1;
-        setsockopt(m_listenerSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&optval), sizeof(optval));
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&optval), sizeof(optval));
 
         // Bind to localhost with OS-assigned port
         sockaddr_in addr{};
@@ -183,87 +371,155 @@ public:
         addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
         addr.sin_port = 0;
 
-        if (bind(m_listenerSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
-            log<LogLevel::ERROR_LEVEL>("[SSH] Failed to bind listener socket");
-            return std::unexpected(SshTunnelError{SshTunnelError::Code::TunnelFailed, "Failed to bind listener socket"});
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return fail("Failed to bind listener socket");
         }
 
         // Get assigned port
         socklen_t addrLen = sizeof(addr);
-        if (getsockname(m_listenerSocket, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0) {
-            log<LogLevel::ERROR_LEVEL>("[SSH] Failed to get listener port");
-            return std::unexpected(SshTunnelError{SshTunnelError::Code::TunnelFailed, "Failed to get listener port"});
+        if (getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0) {
+            return fail("Failed to get listener port");
         }
-        m_localPort = ntohs(addr.sin_port);
-        log<LogLevel::INFO>(std::format("[SSH] Local listener bound to port {}", m_localPort));
+        const int localPort = ntohs(addr.sin_port);
+        log<LogLevel::INFO>(std::format("[SSH] Local listener bound to port {}", localPort));
 
         // Start listening
-        if (listen(m_listenerSocket, SOMAXCONN) != 0) {
-            log<LogLevel::ERROR_LEVEL>("[SSH] Failed to listen on socket");
-            return std::unexpected(SshTunnelError{SshTunnelError::Code::TunnelFailed, "Failed to listen on socket"});
+        if (listen(listener, SOMAXCONN) != 0) {
+            return fail("Failed to listen on socket");
         }
-        log<LogLevel::DEBUG>("[SSH] Listening on local port");
-
-        m_running = true;
-        m_connected = true;
-
-        // Start proxy thread
-        log<LogLevel::INFO>("[SSH] Starting proxy thread...");
-        log_flush();
-        m_proxyThread = std::thread(&Impl::proxyLoop, this);
-
-        log<LogLevel::INFO>(std::format("[SSH] SSH tunnel established: localhost:{} -> {}:{}", m_localPort, m_remoteHost, m_remotePort));
-        log_flush();
 
-        return {};
+        m_forwards.push_back(Forward{.listener = listener, .localPort = localPort, .remoteHost = remoteHost, .remotePort = remotePort, .channelWindow = channelWindow, .refs = 1});
+        ++m_forwardsVersion;
+        MetricsRegistry::instance().gauge("ssh.forwards").add(1);
+        return localPort;
     }
 
-    void disconnect() {
-        log<LogLevel::DEBUG>("[SSH] Disconnecting SSH tunnel...");
-        m_running = false;
-
-        // Close listener to unblock select()
-        if (m_listenerSocket != INVALID_SOCK) {
-            closeSocket(m_listenerSocket);
-            m_listenerSocket = INVALID_SOCK;
+    /// Drop one user of the forward on `localPort`; the last one closes its listener. Connections already
+    /// accepted through it run until either side closes them.
+    void releaseForward(int localPort) {
+        std::lock_guard lock(m_forwardsMutex);
+        auto it = std::ranges::find(m_forwards, localPort, &Forward::localPort);
+        if (it == m_forwards.end() || --it->refs > 0) {
+            return;
         }
+        // The proxy thread may be polling the listener; it closes retired listeners itself
+        m_retiredListeners.push_back(it->listener);
+        m_forwards.erase(it);
+        ++m_forwardsVersion;
+        MetricsRegistry::instance().gauge("ssh.forwards").add(-1);
+        log<LogLevel::INFO>(std::format("[SSH] Forward on localhost:{} closed", localPort));
+    }
+
+    [[nodiscard]] bool alive() const noexcept { return m_running.load(std::memory_order_acquire); }
+    /// The SSH connection is up (false while the proxy thread is re-establishing it)
+    [[nodiscard]] bool linkUp() const noexcept { return m_linkUp.load(std::memory_order_acquire); }
+    /// Number of times the SSH connection was re-established after failing
+    [[nodiscard]] uint64_t generation() const noexcept { return m_generation.load(std::memory_order_acquire); }
 
-        // Wait for proxy thread — it will clean up all sessions
+private:
+    struct Forward {
+        socket_t listener = INVALID_SOCK;
+        int localPort = 0;
+        std::string remoteHost;
+        int remotePort = 0;
+        uint32_t channelWindow = 0;
+        size_t refs = 0;
+    };
+
+    void shutdown() {
+        log<LogLevel::DEBUG>("[SSH] Disconnecting SSH session...");
+        const bool wasRunning = m_running.exchange(false);
+
+        // Wait for proxy thread (it notices m_running within IDLE_POLL_MS) — it will clean up all sessions
         if (m_proxyThread.joinable()) {
             log<LogLevel::DEBUG>("[SSH] Waiting for proxy thread to finish...");
             m_proxyThread.join();
         }
+        if (wasRunning) {
+            MetricsRegistry::instance().gauge("ssh.sessions").add(-1);
+        }
+
+        {
+            std::lock_guard lock(m_forwardsMutex);
+            for (const auto& forward : m_forwards) {
+                closeSocket(forward.listener);
+            }
+            for (const auto listener : m_retiredListeners) {
+                closeSocket(listener);
+            }
+            MetricsRegistry::instance().gauge("ssh.forwards").add(-static_cast<int64_t>(m_forwards.size()));
+            m_forwards.clear();
+            m_retiredListeners.clear();
+        }
 
         // Clean up SSH session
-        if (m_session) {
+        if (m_session && m_linkUp) {
             libssh2_session_set_blocking(m_session, 1);
             libssh2_session_disconnect(m_session, "Disconnecting");
-            libssh2_session_free(m_session);
-            m_session = nullptr;
-        }
-
-        // Close SSH socket
-        if (m_sshSocket != INVALID_SOCK) {
-            closeSocket(m_sshSocket);
-            m_sshSocket = INVALID_SOCK;
         }
+        dropTransport();
+        m_linkUp = false;
 
         if (m_libssh2Initialized) {
             libssh2_exit();
             m_libssh2Initialized = false;
         }
 
-        m_connected = false;
-        m_localPort = 0;
-        log<LogLevel::INFO>("[SSH] SSH tunnel disconnected");
+        log<LogLevel::INFO>("[SSH] SSH session disconnected");
         log_flush();
     }
 
-    [[nodiscard]] bool isConnected() const { return m_connected; }
+    /// Free the SSH session and close its socket, without the disconnect exchange
+    void dropTransport() {
+        if (m_session) {
+            // Freeing flushes channel closes; do not let a dead link hold that up
+            libssh2_session_set_blocking(m_session, 1);
+            libssh2_session_set_timeout(m_session, IDLE_POLL_MS);
+            libssh2_session_free(m_session);
+            m_session = nullptr;
+        }
+        if (m_sshSocket != INVALID_SOCK) {
+            closeSocket(m_sshSocket);
+            m_sshSocket = INVALID_SOCK;
+        }
+    }
 
-    [[nodiscard]] int getLocalPort() const { return m_localPort; }
+    /// Proxy thread, after the SSH connection failed: drop every forwarded connection (the DB driver behind each
+    /// sees a communication link failure) and re-handshake with backoff until it works or shutdown() is called.
+    /// Connections that arrive on the listeners meanwhile wait in their backlog and are served once the link is back.
+    void recover(std::vector<ClientSession>& sessions) {
+        static auto& reconnects = MetricsRegistry::instance().counter("ssh.reconnects");
+        log<LogLevel::WARNING>(std::format("[SSH] SSH connection to {}:{} lost, dropping {} forwarded connections", m_config.host, m_config.port, sessions.size()));
+        log_flush();
+        m_linkUp = false;
+        for (auto& s : sessions) {
+            closeSocket(s.socket);  // Channels go with the session
+        }
+        sessions.clear();
+        dropTransport();
+
+        auto delay = RECONNECT_MIN_DELAY;
+        while (m_running) {
+            if (auto established = establish(m_config); established) {
+                libssh2_session_set_blocking(m_session, 0);
+                m_transportLost = false;
+                m_generation.fetch_add(1, std::memory_order_acq_rel);
+                m_linkUp = true;
+                reconnects.add();
+                log<LogLevel::INFO>(std::format("[SSH] SSH connection to {}:{} re-established", m_config.host, m_config.port));
+                log_flush();
+                return;
+            }
+            dropTransport();
+            log<LogLevel::WARNING>(std::format("[SSH] Reconnect failed, retrying in {} ms", delay.count()));
+            log_flush();
+            for (auto waited = std::chrono::milliseconds{0}; waited < delay && m_running; waited += std::chrono::milliseconds{IDLE_POLL_MS}) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{IDLE_POLL_MS});
+            }
+            delay = (std::min)(delay * 2, RECONNECT_MAX_DELAY);
+        }
+    }
 
-private:
     void closeSession(ClientSession& s) {
         if (s.channel) {
             constexpr int MAX_CLOSE_RETRIES = 100;
@@ -284,6 +540,136 @@ private:
         }
     }
 
+    /// Move whatever each direction can move without blocking. Returns false once the session is finished.
+    /// `progressed` is set when any byte moved, since libssh2 may then hold more channel data than the socket shows.
+    bool pumpSession(ClientSession& s, bool& progressed, TunnelTraffic& traffic) {
+        // Client -> SSH channel: read what the client has, then write it in as few channel writes as possible
+        while (!s.clientClosed && s.toServer.makeRoom() > 0) {
+            int bytesRead = recv(s.socket, s.toServer.tail(), static_cast<int>(s.toServer.room()), 0);
+            if (bytesRead > 0) {
+                s.toServer.produced(static_cast<size_t>(bytesRead));
+                traffic.sent += static_cast<uint64_t>(bytesRead);
+                progressed = true;
+            } else if (bytesRead == 0) {
+                s.clientClosed = true;
+            } else if (wouldBlock()) {
+                break;
+            } else {
+                return false;
+            }
+        }
+        while (!s.toServer.empty()) {
+            auto rc = libssh2_channel_write(s.channel, s.toServer.head(), s.toServer.size());
+            if (rc > 0) {
+                s.toServer.consume(static_cast<size_t>(rc));
+                progressed = true;
+            } else if (rc == LIBSSH2_ERROR_EAGAIN) {
+                break;
+            } else {
+                m_transportLost = m_transportLost || isTransportError(rc);
+                return false;
+            }
+        }
+
+        // SSH channel -> client
+        while (!s.channelClosed && s.toClient.makeRoom() > 0) {
+            auto rc = libssh2_channel_read(s.channel, s.toClient.tail(), s.toClient.room());
+            if (rc > 0) {
+                s.toClient.produced(static_cast<size_t>(rc));
+                traffic.received += static_cast<uint64_t>(rc);
+                progressed = true;
+            } else if (rc == LIBSSH2_ERROR_EAGAIN) {
+                break;
+            } else if (rc == 0) {
+                s.channelClosed = libssh2_channel_eof(s.channel) != 0;
+                break;
+            } else {
+                m_transportLost = m_transportLost || isTransportError(rc);
+                return false;
+            }
+        }
+        while (!s.toClient.empty()) {
+            int rc = send(s.socket, s.toClient.head(), static_cast<int>(s.toClient.size()), 0);
+            if (rc > 0) {
+                s.toClient.consume(static_cast<size_t>(rc));
+                progressed = true;
+            } else if (rc < 0 && wouldBlock()) {
+                break;
+            } else {
+                return false;
+            }
+        }
+
+        // A side that hung up is finished once what it sent has been delivered
+        return !(s.clientClosed && s.toServer.empty()) && !(s.channelClosed && s.toClient.empty());
+    }
+
+    /// Open a direct-tcpip channel to the DB target with the configured receive window.
+    /// libssh2_channel_direct_tcpip_ex always asks for the 2 MB default, which caps a TDS stream at 2 MB per round
+    /// trip, so the request is built here and opened through libssh2_channel_open_ex. The packet size stays at the
+    /// libssh2 default because libssh2 rejects inbound packets larger than that.
+    LIBSSH2_CHANNEL* openDirectTcpip(const Forward& forward) {
+        if (forward.channelWindow == 0) {
+            return libssh2_channel_direct_tcpip(m_session, forward.remoteHost.c_str(), forward.remotePort);
+        }
+        // RFC 4254 7.2: string host, uint32 port, string originator address, uint32 originator port
+        std::string message;
+        const auto putU32 = [&message](uint32_t value) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                message += static_cast<char>((value >> shift) & 0xFF);
+            }
+        };
+        const auto putString = [&](std::string_view value) {
+            putU32(static_cast<uint32_t>(value.size()));
+            message += value;
+        };
+        putString(forward.remoteHost);
+        putU32(static_cast<uint32_t>(forward.remotePort));
+        putString("127.0.0.1");
+        putU32(22);
+
+        constexpr std::string_view type = "direct-tcpip";
+        return libssh2_channel_open_ex(m_session, type.data(), static_cast<unsigned int>(type.size()), forward.channelWindow, LIBSSH2_CHANNEL_PACKET_DEFAULT, message.data(),
+                                       static_cast<unsigned int>(message.size()));
+    }
+
+    void acceptClient(const Forward& forward, std::vector<ClientSession>& sessions) {
+        sockaddr_in clientAddr{};
+        socklen_t len = sizeof(clientAddr);
+        socket_t client = accept(forward.listener, reinterpret_cast<sockaddr*>(&clientAddr), &len);
+        if (client == INVALID_SOCK) {
+            return;
+        }
+        log<LogLevel::INFO>("[SSH] Client connected to tunnel");
+
+        // Temporarily block for channel open (with 5s timeout to avoid stalling
+        // existing sessions indefinitely if SSH server is slow to respond)
+        libssh2_session_set_blocking(m_session, 1);
+        libssh2_session_set_timeout(m_session, 5000);
+        auto* ch = openDirectTcpip(forward);
+        libssh2_session_set_timeout(m_session, 0);
+        libssh2_session_set_blocking(m_session, 0);
+
+        if (ch) {
+            setNonBlocking(client);
+            setNoDelay(client);
+            auto& session = sessions.emplace_back();
+            session.socket = client;
+            session.channel = ch;
+            log<LogLevel::INFO>(std::format("[SSH] Channel opened, active sessions: {}", sessions.size()));
+        } else {
+            char* errMsg = nullptr;
+            libssh2_session_last_error(m_session, &errMsg, nullptr, 0);
+            log<LogLevel::ERROR_LEVEL>(std::format("[SSH] Channel open failed: {}", errMsg ? errMsg : "unknown"));
+            closeSocket(client);
+        }
+        log_flush();
+    }
+
+    /// Waits on exactly what can unblock progress: the forward listeners, the SSH socket in the directions libssh2 reports
+    /// as blocked (always readable, since any channel's data arrives there), client sockets with buffer room to
+    /// read into and client sockets with data waiting to be sent. After a round that moved bytes the poll does not
+    /// wait, so data libssh2 already buffered is drained without a socket event.
     void proxyLoop() {
         log<LogLevel::DEBUG>("[SSH] Proxy thread started");
         log_flush();
@@ -291,163 +677,124 @@ private:
         libssh2_session_set_blocking(m_session, 0);
 
         std::vector<ClientSession> sessions;
-        char buffer[BUFFER_SIZE];
+        std::vector<Forward> forwards;  // Snapshot of m_forwards, refreshed when it changes
+        uint64_t forwardsVersion = 0;
+        std::vector<pollfd> fds;
+        // Client -> server / server -> client payload through every tunnel
+        auto& bytesSent = MetricsRegistry::instance().counter("ssh.bytes_sent");
+        auto& bytesReceived = MetricsRegistry::instance().counter("ssh.bytes_received");
+        // Sum of every tunnel's rate over its last full second
+        auto& sendRate = MetricsRegistry::instance().gauge("ssh.send_bytes_per_sec");
+        auto& receiveRate = MetricsRegistry::instance().gauge("ssh.receive_bytes_per_sec");
+        TunnelTraffic traffic;
+        TunnelTraffic counted;    // Already added to the counters
+        TunnelTraffic rateStart;  // Totals when the current rate window opened
+        int64_t reportedSendRate = 0;
+        int64_t reportedReceiveRate = 0;
+        auto rateWindowStart = std::chrono::steady_clock::now();
+        bool progressed = false;
+        int secondsToKeepalive = 0;
 
         while (m_running) {
-            fd_set readFds;
-            FD_ZERO(&readFds);
-            socket_t maxFd = 0;  // nfds is ignored on Windows
-
-            // Add listener socket
-            if (m_listenerSocket != INVALID_SOCK) {
-                FD_SET(m_listenerSocket, &readFds);
-                if (m_listenerSocket > maxFd)
-                    maxFd = m_listenerSocket;
+            {
+                std::lock_guard lock(m_forwardsMutex);
+                if (forwardsVersion != m_forwardsVersion) {
+                    forwards = m_forwards;
+                    forwardsVersion = m_forwardsVersion;
+                }
+                for (const auto listener : m_retiredListeners) {
+                    closeSocket(listener);
+                }
+                m_retiredListeners.clear();
             }
 
-            // Add SSH socket (data from server may arrive for any channel)
-            if (m_sshSocket != INVALID_SOCK) {
-                FD_SET(m_sshSocket, &readFds);
-                if (m_sshSocket > maxFd)
-                    maxFd = m_sshSocket;
+            fds.clear();
+            for (const auto& forward : forwards) {
+                fds.push_back(pollfd{.fd = forward.listener, .events = POLLIN, .revents = 0});
             }
-
-            // Add all client sockets
+            short sshEvents = POLLIN;
+            if (libssh2_session_block_directions(m_session) & LIBSSH2_SESSION_BLOCK_OUTBOUND) {
+                sshEvents |= POLLOUT;
+            }
+            fds.push_back(pollfd{.fd = m_sshSocket, .events = sshEvents, .revents = 0});
             for (const auto& s : sessions) {
-                FD_SET(s.socket, &readFds);
-                if (s.socket > maxFd)
-                    maxFd = s.socket;
+                short events = 0;
+                if (!s.clientClosed && s.toServer.canFill()) {
+                    events |= POLLIN;
+                }
+                if (!s.toClient.empty()) {
+                    events |= POLLOUT;
+                }
+                fds.push_back(pollfd{.fd = s.socket, .events = events, .revents = 0});
             }
 
-            // 50ms timeout — allows m_running check and keepalive
-            timeval tv{0, 50000};
-            int ready = select(static_cast<int>(maxFd + 1), &readFds, nullptr, nullptr, &tv);
+            const int timeoutMs = progressed ? 0 : std::min(IDLE_POLL_MS, secondsToKeepalive > 0 ? secondsToKeepalive * 1000 : IDLE_POLL_MS);
+            int ready = pollSockets(fds.data(), fds.size(), timeoutMs);
             if (ready < 0) {
                 if (!m_running)
                     break;
                 continue;
             }
 
-            // Accept new connections
-            if (m_listenerSocket != INVALID_SOCK && FD_ISSET(m_listenerSocket, &readFds)) {
-                sockaddr_in clientAddr{};
-                socklen_t len = sizeof(clientAddr);
-                socket_t client = accept(m_listenerSocket, reinterpret_cast<sockaddr*>(&clientAddr), &len);
-                if (client != INVALID_SOCK) {
-                    log<LogLevel::INFO>("[SSH] Client connected to tunnel");
-
-                    // Temporarily block for channel open (with 5s timeout to avoid stalling
-                    // existing sessions indefinitely if SSH server is slow to respond)
-                    libssh2_session_set_blocking(m_session, 1);
-                    libssh2_session_set_timeout(m_session, 5000);
-                    auto* ch = libssh2_channel_direct_tcpip(m_session, m_remoteHost.c_str(), m_remotePort);
-                    libssh2_session_set_timeout(m_session, 0);
-                    libssh2_session_set_blocking(m_session, 0);
-
-                    if (ch) {
-#ifdef _WIN32
-                        u_long mode = 1;
-                        ioctlsocket(client, FIONBIO, &mode);
-#else
-                        int flags = fcntl(client, F_GETFL, 0);
-                        fcntl(client, F_SETFL, flags | O_NONBLOCK);
-#endif
-                        sessions.push_back({client, ch});
-                        log<LogLevel::INFO>(std::format("[SSH] Channel opened, active sessions: {}", sessions.size()));
-                    } else {
-                        char* errMsg = nullptr;
-                        libssh2_session_last_error(m_session, &errMsg, nullptr, 0);
-                        log<LogLevel::ERROR_LEVEL>(std::format("[SSH] Channel open failed: {}", errMsg ? errMsg : "unknown"));
-                        closeSocket(client);
-                    }
-                    log_flush();
+            // Hang-up or error on the SSH socket: the jump host or the network went away
+            if (fds[forwards.size()].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                m_transportLost = true;
+            }
+            for (size_t i = 0; i < forwards.size() && !m_transportLost; ++i) {
+                if (fds[i].revents & POLLIN) {
+                    acceptClient(forwards[i], sessions);
                 }
             }
 
-            // Process each session
-            std::vector<size_t> toRemove;
+            // Pump every session: libssh2 reads the shared SSH socket on behalf of all channels, so a channel can
+            // have data even when only another session's socket was signalled
+            progressed = false;
+            size_t alive = 0;
             for (size_t i = 0; i < sessions.size(); ++i) {
-                auto& s = sessions[i];
-                bool dead = false;
-
-                // Client → SSH channel
-                if (FD_ISSET(s.socket, &readFds)) {
-                    int bytesRead = recv(s.socket, buffer, BUFFER_SIZE, 0);
-                    if (bytesRead > 0) {
-                        int written = 0;
-                        while (written < bytesRead && m_running) {
-                            int rc = static_cast<int>(libssh2_channel_write(s.channel, buffer + written, bytesRead - written));
-                            if (rc > 0) {
-                                written += rc;
-                            } else if (rc == LIBSSH2_ERROR_EAGAIN) {
-                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                            } else {
-                                dead = true;
-                                break;
-                            }
-                        }
-                    } else if (bytesRead == 0) {
-                        dead = true;
-                    } else {
-#ifdef _WIN32
-                        if (WSAGetLastError() != WSAEWOULDBLOCK)
-                            dead = true;
-#else
-                        if (errno != EAGAIN && errno != EWOULDBLOCK)
-                            dead = true;
-#endif
-                    }
-                }
-
-                // SSH channel → Client
-                if (!dead) {
-                    auto channelRead = libssh2_channel_read(s.channel, buffer, BUFFER_SIZE);
-                    if (channelRead > 0) {
-                        int sent = 0;
-                        while (sent < static_cast<int>(channelRead) && m_running) {
-                            int rc = send(s.socket, buffer + sent, static_cast<int>(channelRead) - sent, 0);
-                            if (rc > 0) {
-                                sent += rc;
-                            } else if (rc < 0) {
-#ifdef _WIN32
-                                if (WSAGetLastError() == WSAEWOULDBLOCK) {
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                                    continue;
-                                }
-#else
-                                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                                    continue;
-                                }
-#endif
-                                dead = true;
-                                break;
-                            }
-                        }
-                    } else if (channelRead == 0 || libssh2_channel_eof(s.channel)) {
-                        dead = true;
-                    } else if (channelRead != LIBSSH2_ERROR_EAGAIN) {
-                        dead = true;
+                if (pumpSession(sessions[i], progressed, traffic)) {
+                    if (alive != i) {
+                        sessions[alive] = std::move(sessions[i]);
                     }
+                    ++alive;
+                } else {
+                    closeSession(sessions[i]);
                 }
-
-                if (dead)
-                    toRemove.push_back(i);
             }
-
-            // Remove dead sessions (reverse order to keep indices valid)
-            for (auto it = toRemove.rbegin(); it != toRemove.rend(); ++it) {
-                closeSession(sessions[*it]);
-                sessions.erase(sessions.begin() + static_cast<ptrdiff_t>(*it));
-                log<LogLevel::INFO>(std::format("[SSH] Session removed, active: {}", sessions.size()));
+            if (alive != sessions.size()) {
+                sessions.resize(alive);
+                log<LogLevel::INFO>(std::format("[SSH] Session removed, active: {}", alive));
                 log_flush();
             }
 
-            // Keepalive
-            int secondsToNext = 0;
-            libssh2_keepalive_send(m_session, &secondsToNext);
+            bytesSent.add(traffic.sent - counted.sent);
+            bytesReceived.add(traffic.received - counted.received);
+            counted = traffic;
+
+            const auto now = std::chrono::steady_clock::now();
+            if (const auto elapsed = std::chrono::duration<double>(now - rateWindowStart).count(); elapsed >= 1.0) {
+                const auto newSendRate = static_cast<int64_t>(static_cast<double>(traffic.sent - rateStart.sent) / elapsed);
+                const auto newReceiveRate = static_cast<int64_t>(static_cast<double>(traffic.received - rateStart.received) / elapsed);
+                sendRate.add(newSendRate - std::exchange(reportedSendRate, newSendRate));
+                receiveRate.add(newReceiveRate - std::exchange(reportedReceiveRate, newReceiveRate));
+                rateStart = traffic;
+                rateWindowStart = now;
+            }
+
+            // Keepalive; a failed send means the connection is gone even when no forwarded connection noticed
+            if (!m_transportLost) {
+                const int rc = libssh2_keepalive_send(m_session, &secondsToKeepalive);
+                m_transportLost = rc != 0 && rc != LIBSSH2_ERROR_EAGAIN;
+            }
+            if (m_transportLost) {
+                recover(sessions);
+                progressed = false;
+                secondsToKeepalive = 0;
+            }
         }
 
+        sendRate.add(-reportedSendRate);
+        receiveRate.add(-reportedReceiveRate);
+
         // Cleanup all remaining sessions
         for (auto& s : sessions) {
             closeSession(s);
@@ -490,16 +837,63 @@ private:
         return {};
     }
 
+    SshTunnelConfig m_config;  ///< Kept for reconnects
     socket_t m_sshSocket = INVALID_SOCK;
-    socket_t m_listenerSocket = INVALID_SOCK;
-    LIBSSH2_SESSION* m_session = nullptr;
+    LIBSSH2_SESSION* m_session = nullptr;  ///< Used only by the proxy thread once it runs
     bool m_libssh2Initialized = false;
-    std::atomic<bool> m_connected{false};
+    bool m_transportLost = false;  ///< Proxy thread only: the SSH connection failed and must be re-established
     std::atomic<bool> m_running{false};
-    int m_localPort = 0;
-    std::string m_remoteHost;
-    int m_remotePort = 0;
+    std::atomic<bool> m_linkUp{false};
+    std::atomic<uint64_t> m_generation{0};
     std::thread m_proxyThread;
+
+    std::mutex m_forwardsMutex;
+    std::vector<Forward> m_forwards;           ///< Guarded by m_forwardsMutex
+    std::vector<socket_t> m_retiredListeners;  ///< Released forwards whose listener the proxy thread closes
+    uint64_t m_forwardsVersion = 0;            ///< Bumped on every m_forwards change
+};
+
+/// One user of a forward on a shared SshSession
+class SshTunnel::Impl {
+public:
+    Impl() = default;
+    ~Impl() { disconnect(); }
+
+    std::expected<void, SshTunnelError> connect(const SshTunnelConfig& config) {
+        disconnect();
+        log<LogLevel::INFO>(std::format("[SSH] Remote target: {}:{}", config.remoteHost, config.remotePort));
+        auto session = SshSession::shared(config);
+        if (!session) {
+            return std::unexpected(session.error());
+        }
+        auto localPort = (*session)->acquireForward(config.remoteHost, config.remotePort, config.channelWindowBytes);
+        if (!localPort) {
+            return std::unexpected(localPort.error());
+        }
+        m_session = std::move(*session);
+        m_localPort = *localPort;
+        log<LogLevel::INFO>(std::format("[SSH] SSH tunnel established: localhost:{} -> {}:{}", m_localPort, config.remoteHost, config.remotePort));
+        log_flush();
+        return {};
+    }
+
+    void disconnect() {
+        if (m_session) {
+            m_session->releaseForward(m_localPort);
+            m_session.reset();
+            m_localPort = 0;
+        }
+    }
+
+    [[nodiscard]] bool isConnected() const { return m_session && m_session->alive() && m_session->linkUp(); }
+
+    [[nodiscard]] int getLocalPort() const { return m_localPort; }
+
+    [[nodiscard]] uint64_t generation() const { return m_session ? m_session->generation() : 0; }
+
+private:
+    std::shared_ptr<SshSession> m_session;
+    int m_localPort = 0;
 };
 
 SshTunnel::SshTunnel() : m_impl(std::make_unique<Impl>()) {}
@@ -526,4 +920,8 @@ int SshTunnel::getLocalPort() const {
     return m_impl->getLocalPort();
 }
 
+uint64_t SshTunnel::generation() const {
+    return m_impl->generation();
+}
+
 }  // namespace velocitydb
@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <expected>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace velocitydb {
 
 enum class SshAuthMethod { Password, PublicKey };
 
+/// AEAD ciphers first (AES-GCM uses AES-NI/PCLMUL, ChaCha20 is fast without them), then CTR for older servers.
+/// libssh2 skips names its crypto backend does not implement.
+inline constexpr std::string_view DEFAULT_SSH_CIPHERS = "aes128-gcm@openssh.com,aes256-gcm@openssh.com,chacha20-poly1305@openssh.com,aes128-ctr,aes256-ctr";
+
 struct SshTunnelConfig {
     std::string host;
     int port = 22;
@@ -20,6 +26,12 @@ struct SshTunnelConfig {
     // Tunnel forwarding
     std::string remoteHost;  // Target DB host (from SSH server's perspective)
     int remotePort = 1433;   // Target DB port
+
+    // Throughput tuning
+    static constexpr uint32_t DEFAULT_CHANNEL_WINDOW = 16 * 1024 * 1024;
+    uint32_t channelWindowBytes = DEFAULT_CHANNEL_WINDOW;  // Receive window per forwarded connection; must cover bandwidth x RTT
+    bool compression = false;                               // zlib; pays off for text-heavy results on slow links only
+    std::string ciphers{DEFAULT_SSH_CIPHERS};               // Comma-separated preference order (empty = libssh2 default)
 };
 
 struct SshTunnelError {
@@ -28,6 +40,12 @@ struct SshTunnelError {
     std::string message;
 };
 
+/// Local port forwarding to a DB server through an SSH jump host.
+/// Tunnels to the same jump host (host, port, user) share one authenticated SSH session and proxy thread, and
+/// tunnels to the same target also share the local port. Each tunnel object holds one reference; the forward
+/// closes with its last tunnel and the session with the last forward.
+/// A dropped SSH connection is re-established in the background on the same local port; connections that were
+/// open through the tunnel at the time are closed and must be reopened (see generation()).
 class SshTunnel {
 public:
     SshTunnel();
@@ -38,18 +56,21 @@ public:
     SshTunnel(SshTunnel&&) noexcept;
     SshTunnel& operator=(SshTunnel&&) noexcept;
 
-    // Establish SSH connection and create tunnel
+    // Establish (or join) the SSH session and create the tunnel
     [[nodiscard]] std::expected<void, SshTunnelError> connect(const SshTunnelConfig& config);
 
-    // Close the tunnel and SSH connection
+    // Release the tunnel; the SSH connection closes once no tunnel uses it
     void disconnect();
 
-    // Check if tunnel is active
+    // Check if tunnel is active (false while a dropped SSH connection is being re-established)
     [[nodiscard]] bool isConnected() const;
 
     // Get local port for DB connection (localhost:localPort -> remoteHost:remotePort)
     [[nodiscard]] int getLocalPort() const;
 
+    // Times the SSH connection was re-established; a change means DB connections through the tunnel were dropped
+    [[nodiscard]] uint64_t generation() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
@@ -1,13 +1,18 @@
 #include "a5er_parser.h"
 
+#include "../utils/mapped_file.h"
 #include "a5er_utils.h"
 
 #include <algorithm>
 #include <charconv>
-#include <fstream>
+#include <exception>
+#include <iterator>
+#include <memory_resource>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 
 #include "pugixml.hpp"
@@ -30,6 +35,19 @@ std::string bracketEscape(const std::string& name) {
     return result;
 }
 
+/// Calls `onPart` with each comma-separated part of `list` (empty parts included, trailing empty part dropped like getline)
+template <typename OnPart>
+void splitCommas(std::string_view list, OnPart&& onPart) {
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        onPart(list.substr(0, comma));
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+}
+
 }  // namespace
 
 // === IERDiagramParser interface ===
@@ -38,82 +56,108 @@ std::vector<std::string> A5ERParser::extensions() const {
     return {".a5er"};
 }
 
-bool A5ERParser::canParse(const std::string& content) const {
-    return isTextFormat(content) || content.find("<A5ER") != std::string::npos;
+bool A5ERParser::canParse(std::string_view content) const {
+    return isTextFormat(content) || content.find("<A5ER") != std::string_view::npos;
 }
 
-ERModel A5ERParser::parse(const std::string& content) const {
+ERModel A5ERParser::parse(std::string_view content) const {
     return toERModel(parseFromString(content));
 }
 
 std::string A5ERParser::generateDDL(const ERModel& model, TargetDatabase target) const {
-    std::string targetDb = "SQLServer";
+    std::string ddl;
+    writeDDL(model, target, [&ddl](std::string_view chunk) { ddl += chunk; });
+    return ddl;
+}
+
+void A5ERParser::writeDDL(const ERModel& model, TargetDatabase target, const TextSink& sink) const {
+    std::string_view targetDb = "SQLServer";
     if (target == TargetDatabase::PostgreSQL)
         targetDb = "PostgreSQL";
     else if (target == TargetDatabase::MySQL)
         targetDb = "MySQL";
 
-    std::ostringstream ddl;
-    ddl << "-- Generated from ER model: " << model.name << "\n";
-    ddl << "-- Target database: " << targetDb << "\n\n";
-
-    for (const auto& table : model.tables) {
-        if (!table.comment.empty())
-            ddl << "-- " << table.comment << "\n";
-
-        ddl << "CREATE TABLE " << bracketEscape(table.name) << " (\n";
-        std::vector<std::string> pkColumns;
-
-        for (size_t i = 0; i < table.columns.size(); ++i) {
-            const auto& col = table.columns[i];
-            ddl << "    " << bracketEscape(col.name) << " ";
-            ddl << mapTypeToSQLServer(col.type, col.size, col.scale);
-            if (!col.nullable)
-                ddl << " NOT NULL";
-            if (!col.defaultValue.empty())
-                ddl << " DEFAULT " << col.defaultValue;
-            if (col.isPrimaryKey)
-                pkColumns.push_back(col.name);
-            if (i + 1 < table.columns.size() || !pkColumns.empty())
-                ddl << ",";
-            if (!col.comment.empty())
-                ddl << " -- " << col.comment;
-            ddl << "\n";
-        }
+    std::string header = "-- Generated from ER model: " + model.name + "\n";
+    header += "-- Target database: ";
+    header += targetDb;
+    header += "\n\n";
+    sink(header);
+
+    // Referenced tables first; relations naming a table the model lacks do not affect the order
+    std::unordered_map<std::string_view, size_t> tableIndex;
+    tableIndex.reserve(model.tables.size());
+    for (size_t i = 0; i < model.tables.size(); ++i)
+        tableIndex.try_emplace(model.tables[i].name, i);
+    std::vector<std::pair<size_t, size_t>> references;
+    references.reserve(model.relations.size());
+    for (const auto& rel : model.relations) {
+        const auto child = tableIndex.find(rel.childTable);
+        const auto parent = tableIndex.find(rel.parentTable);
+        if (child != tableIndex.end() && parent != tableIndex.end())
+            references.emplace_back(child->second, parent->second);
+    }
+    const auto order = dependencyOrder(model.tables.size(), references);
+
+    renderOrdered(
+        order.size(),
+        [&](size_t position, std::string& ddl) {
+            const auto& table = model.tables[order[position]];
+            if (!table.comment.empty())
+                ddl += "-- " + table.comment + "\n";
+
+            ddl += "CREATE TABLE " + bracketEscape(table.name) + " (\n";
+            std::vector<std::string_view> pkColumns;
+            for (size_t i = 0; i < table.columns.size(); ++i) {
+                const auto& col = table.columns[i];
+                ddl += "    " + bracketEscape(col.name) + " ";
+                ddl += mapTypeToSQLServer(col.type, col.size, col.scale);
+                if (!col.nullable)
+                    ddl += " NOT NULL";
+                if (!col.defaultValue.empty())
+                    ddl += " DEFAULT " + col.defaultValue;
+                if (col.isPrimaryKey)
+                    pkColumns.push_back(col.name);
+                if (i + 1 < table.columns.size() || !pkColumns.empty())
+                    ddl += ",";
+                if (!col.comment.empty())
+                    ddl += " -- " + col.comment;
+                ddl += "\n";
+            }
 
-        if (!pkColumns.empty()) {
-            ddl << "    CONSTRAINT " << bracketEscape("PK_" + table.name) << " PRIMARY KEY (";
-            for (size_t i = 0; i < pkColumns.size(); ++i) {
-                ddl << bracketEscape(pkColumns[i]);
-                if (i + 1 < pkColumns.size())
-                    ddl << ", ";
+            if (!pkColumns.empty()) {
+                ddl += "    CONSTRAINT " + bracketEscape("PK_" + table.name) + " PRIMARY KEY (";
+                for (size_t i = 0; i < pkColumns.size(); ++i) {
+                    ddl += bracketEscape(std::string(pkColumns[i]));
+                    if (i + 1 < pkColumns.size())
+                        ddl += ", ";
+                }
+                ddl += ")\n";
             }
-            ddl << ")\n";
-        }
-        ddl << ");\n\n";
-
-        for (const auto& idx : table.indexes) {
-            ddl << "CREATE ";
-            if (idx.isUnique)
-                ddl << "UNIQUE ";
-            ddl << "INDEX " << bracketEscape(idx.name) << " ON " << bracketEscape(table.name) << " (";
-            for (size_t i = 0; i < idx.columns.size(); ++i) {
-                ddl << bracketEscape(idx.columns[i]);
-                if (i + 1 < idx.columns.size())
-                    ddl << ", ";
+            ddl += ");\n\n";
+
+            for (const auto& idx : table.indexes) {
+                ddl += idx.isUnique ? "CREATE UNIQUE INDEX " : "CREATE INDEX ";
+                ddl += bracketEscape(idx.name) + " ON " + bracketEscape(table.name) + " (";
+                for (size_t i = 0; i < idx.columns.size(); ++i) {
+                    ddl += bracketEscape(idx.columns[i]);
+                    if (i + 1 < idx.columns.size())
+                        ddl += ", ";
+                }
+                ddl += ");\n\n";
             }
-            ddl << ");\n\n";
-        }
-    }
-
-    for (const auto& rel : model.relations) {
-        ddl << "ALTER TABLE " << bracketEscape(rel.childTable) << "\n";
-        ddl << "ADD CONSTRAINT " << bracketEscape("FK_" + rel.childTable + "_" + rel.parentTable) << "\n";
-        ddl << "FOREIGN KEY (" << bracketEscape(rel.childColumn) << ")\n";
-        ddl << "REFERENCES " << bracketEscape(rel.parentTable) << " (" << bracketEscape(rel.parentColumn) << ");\n\n";
-    }
-
-    return ddl.str();
+        },
+        sink);
+
+    renderOrdered(
+        model.relations.size(),
+        [&](size_t i, std::string& ddl) {
+            const auto& rel = model.relations[i];
+            ddl += "ALTER TABLE " + bracketEscape(rel.childTable) + "\n";
+            ddl += "ADD CONSTRAINT " + bracketEscape("FK_" + rel.childTable + "_" + rel.parentTable) + "\n";
+            ddl += "FOREIGN KEY (" + bracketEscape(rel.childColumn) + ")\n";
+            ddl += "REFERENCES " + bracketEscape(rel.parentTable) + " (" + bracketEscape(rel.parentColumn) + ");\n\n";
+        },
+        sink);
 }
 
 // === Color conversion ===
@@ -156,41 +200,45 @@ std::string A5ERParser::convertA5erColor(const std::string& raw) {
 
 // === A5ERModel → ERModel conversion ===
 
-ERModel A5ERParser::toERModel(const A5ERModel& a5model) {
+ERModel A5ERParser::toERModel(A5ERModel a5model) {
     ERModel model;
-    model.name = a5model.name;
-    model.databaseType = a5model.databaseType;
+    model.name = std::move(a5model.name);
+    model.databaseType = std::move(a5model.databaseType);
+    model.tables.reserve(a5model.tables.size());
+    model.relations.reserve(a5model.relations.size());
+    model.shapes.reserve(a5model.shapes.size());
 
-    for (const auto& t : a5model.tables) {
+    for (auto& t : a5model.tables) {
         ERModelTable table;
-        table.name = t.name;
-        table.logicalName = t.logicalName;
-        table.comment = t.comment;
-        table.page = t.page;
+        table.name = std::move(t.name);
+        table.logicalName = std::move(t.logicalName);
+        table.comment = std::move(t.comment);
+        table.page = std::move(t.page);
         table.posX = t.posX;
         table.posY = t.posY;
         table.color = convertA5erColor(t.color);
         table.bkColor = convertA5erColor(t.bkColor);
 
-        for (const auto& c : t.columns) {
+        table.columns.reserve(t.columns.size());
+        for (auto& c : t.columns) {
             ERModelColumn col;
-            col.name = c.name;
-            col.logicalName = c.logicalName;
-            col.type = c.type;
+            col.name = std::move(c.name);
+            col.logicalName = std::move(c.logicalName);
+            col.type = std::move(c.type);
             col.size = c.size;
             col.scale = c.scale;
             col.nullable = c.nullable;
             col.isPrimaryKey = c.isPrimaryKey;
-            col.defaultValue = c.defaultValue;
-            col.comment = c.comment;
+            col.defaultValue = std::move(c.defaultValue);
+            col.comment = std::move(c.comment);
             col.color = convertA5erColor(c.color);
             table.columns.push_back(std::move(col));
         }
 
-        for (const auto& idx : t.indexes) {
+        for (auto& idx : t.indexes) {
             ERModelIndex erIdx;
-            erIdx.name = idx.name;
-            erIdx.columns = idx.columns;
+            erIdx.name = std::move(idx.name);
+            erIdx.columns = std::move(idx.columns);
             erIdx.isUnique = idx.isUnique;
             table.indexes.push_back(std::move(erIdx));
         }
@@ -198,23 +246,23 @@ ERModel A5ERParser::toERModel(const A5ERModel& a5model) {
         model.tables.push_back(std::move(table));
     }
 
-    for (const auto& r : a5model.relations) {
+    for (auto& r : a5model.relations) {
         ERModelRelation rel;
-        rel.name = r.name;
-        rel.parentTable = r.parentTable;
-        rel.childTable = r.childTable;
-        rel.parentColumn = r.parentColumn;
-        rel.childColumn = r.childColumn;
-        rel.cardinality = r.cardinality;
+        rel.name = std::move(r.name);
+        rel.parentTable = std::move(r.parentTable);
+        rel.childTable = std::move(r.childTable);
+        rel.parentColumn = std::move(r.parentColumn);
+        rel.childColumn = std::move(r.childColumn);
+        rel.cardinality = std::move(r.cardinality);
         model.relations.push_back(std::move(rel));
     }
 
-    for (const auto& s : a5model.shapes) {
+    for (auto& s : a5model.shapes) {
         ERModelShape shape;
-        shape.shapeType = s.shapeType;
+        shape.shapeType = std::move(s.shapeType);
         // Normalize shapeType to lowercase
         std::ranges::transform(shape.shapeType, shape.shapeType.begin(), [](unsigned char c) { return std::tolower(c); });
-        shape.text = s.text;
+        shape.text = std::move(s.text);
         shape.fillColor = convertA5erColor(s.brushColor);
         shape.fontColor = convertA5erColor(s.fontColor);
         shape.fillAlpha = s.brushAlpha;
@@ -223,7 +271,7 @@ ERModel A5ERParser::toERModel(const A5ERModel& a5model) {
         shape.top = s.top;
         shape.width = s.width;
         shape.height = s.height;
-        shape.page = s.page;
+        shape.page = std::move(s.page);
         model.shapes.push_back(std::move(shape));
     }
 
@@ -232,33 +280,33 @@ ERModel A5ERParser::toERModel(const A5ERModel& a5model) {
 
 // === Legacy API ===
 
-bool A5ERParser::isTextFormat(const std::string& content) const {
+bool A5ERParser::isTextFormat(std::string_view content) const {
     // XML形式は除外
-    std::string_view sv(content);
-    auto pos = sv.find_first_not_of(" \t\r\n\xEF\xBB\xBF");
+    auto pos = content.find_first_not_of(" \t\r\n\xEF\xBB\xBF");
     if (pos != std::string_view::npos) {
-        if (sv.substr(pos).starts_with("<?xml") || sv[pos] == '<') {
+        if (content.substr(pos).starts_with("<?xml") || content[pos] == '<') {
             return false;
         }
     }
     // A5:ERヘッダ必須（[Entity]だけでは他INI形式と誤検知しうる）
-    return content.find("# A5:ER") != std::string::npos;
+    return content.find("# A5:ER") != std::string_view::npos;
 }
 
 A5ERModel A5ERParser::parseFile(const std::string& filepath) const {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filepath)) {
         throw std::runtime_error("Failed to open file: " + filepath);
     }
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    return parseFromString(content);
+    // The model owns copies of every string it keeps, so the mapping can close on return
+    return parseFromString(file.view());
 }
 
-A5ERModel A5ERParser::parseFromString(const std::string& content) const {
-    // UTF-8 BOM除去（BOMなし時はコピー回避）
-    const bool hasBom = content.size() >= 3 && content[0] == '\xEF' && content[1] == '\xBB' && content[2] == '\xBF';
-    const std::string stripped = hasBom ? content.substr(3) : std::string{};
-    const std::string& input = hasBom ? stripped : content;
+A5ERModel A5ERParser::parseFromString(std::string_view content) const {
+    // UTF-8 BOM除去（ビューを進めるだけ）
+    std::string_view input = content;
+    if (input.starts_with("\xEF\xBB\xBF")) {
+        input.remove_prefix(3);
+    }
 
     if (isTextFormat(input)) {
         return parseTextFormat(input);
@@ -266,9 +314,10 @@ A5ERModel A5ERParser::parseFromString(const std::string& content) const {
     return parseXmlFormat(input);
 }
 
-A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
+A5ERModel A5ERParser::parseXmlFormat(std::string_view content) const {
+    // `content` may be a read-only mapping, so pugixml parses its own copy. Default flags minus CDATA, which A5:ER never writes
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_string(content.c_str());
+    pugi::xml_parse_result result = doc.load_buffer(content.data(), content.size(), pugi::parse_escapes | pugi::parse_wconv_attribute | pugi::parse_eol);
 
     if (!result) {
         throw std::runtime_error("Failed to parse A5:ER content: " + std::string(result.description()));
@@ -283,6 +332,10 @@ A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
     model.name = root.attribute("Name").as_string();
     model.databaseType = root.attribute("DatabaseType").as_string();
 
+    const auto countOf = [](auto children) { return static_cast<size_t>(std::distance(children.begin(), children.end())); };
+    model.tables.reserve(countOf(root.children("Entity")));
+    model.relations.reserve(countOf(root.children("Relation")));
+
     for (auto entityNode : root.children("Entity")) {
         A5ERTable table;
         table.name = entityNode.attribute("Name").as_string();
@@ -294,6 +347,7 @@ A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
         table.color = entityNode.attribute("Color").as_string();
         table.bkColor = entityNode.attribute("BkColor").as_string();
 
+        table.columns.reserve(countOf(entityNode.children("Attribute")));
         for (auto attrNode : entityNode.children("Attribute")) {
             A5ERColumn col;
             col.name = attrNode.attribute("Name").as_string();
@@ -305,7 +359,7 @@ A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
             col.isPrimaryKey = attrNode.attribute("PK").as_bool(false);
             col.defaultValue = attrNode.attribute("Default").as_string();
             col.comment = attrNode.attribute("Comment").as_string();
-            table.columns.push_back(col);
+            table.columns.push_back(std::move(col));
         }
 
         for (auto indexNode : entityNode.children("Index")) {
@@ -313,16 +367,11 @@ A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
             idx.name = indexNode.attribute("Name").as_string();
             idx.isUnique = indexNode.attribute("Unique").as_bool(false);
 
-            std::string cols = indexNode.attribute("Columns").as_string();
-            std::istringstream iss(cols);
-            std::string colName;
-            while (std::getline(iss, colName, ',')) {
-                idx.columns.push_back(colName);
-            }
-            table.indexes.push_back(idx);
+            splitCommas(indexNode.attribute("Columns").as_string(), [&](std::string_view colName) { idx.columns.emplace_back(colName); });
+            table.indexes.push_back(std::move(idx));
         }
 
-        model.tables.push_back(table);
+        model.tables.push_back(std::move(table));
     }
 
     for (auto relNode : root.children("Relation")) {
@@ -333,7 +382,7 @@ A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
         rel.parentColumn = relNode.attribute("ParentAttribute").as_string();
         rel.childColumn = relNode.attribute("ChildAttribute").as_string();
         rel.cardinality = relNode.attribute("Cardinality").as_string("1:N");
-        model.relations.push_back(rel);
+        model.relations.push_back(std::move(rel));
     }
 
     return model;
@@ -341,54 +390,211 @@ A5ERModel A5ERParser::parseXmlFormat(const std::string& content) const {
 
 // === テキスト形式パース ===
 
-std::vector<std::string> A5ERParser::parseQuotedCSV(const std::string& raw) {
-    std::vector<std::string> result;
-    size_t i = 0;
-    const size_t len = raw.size();
+namespace {
+
+/// Entity がこの数以上あれば Entity 本文の変換をコア間で分割する
+constexpr size_t PARALLEL_MIN_ENTITIES = 256;
+constexpr size_t MIN_ENTITIES_PER_SLICE = 64;
+
+enum class SectionKind { Other, Entity, Relation, Shape };
+
+/// セクションヘッダと終端（DEL行 / 次のヘッダ / EOF）の間の本文。content へのビュー
+struct Section {
+    SectionKind kind;
+    std::string_view body;
+};
+
+SectionKind sectionKindOf(std::string_view type) {
+    if (type == "Entity")
+        return SectionKind::Entity;
+    if (type == "Relation")
+        return SectionKind::Relation;
+    if (type == "Shape")
+        return SectionKind::Shape;
+    return SectionKind::Other;
+}
 
-    while (i < len) {
-        // 先頭空白スキップ
-        while (i < len && raw[i] == ' ')
-            ++i;
-        if (i >= len)
-            break;
+/// `rest` の先頭行を `line` に取り出す（改行・末尾の \r は除く。getline 同様、最終行の改行は任意）
+bool nextLine(std::string_view& rest, std::string_view& line) {
+    if (rest.empty())
+        return false;
+    const auto newline = rest.find('\n');
+    line = rest.substr(0, newline);
+    rest = newline == std::string_view::npos ? std::string_view{} : rest.substr(newline + 1);
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return true;
+}
 
-        if (raw[i] == '"') {
-            ++i;  // 開始引用符スキップ
-            std::string value;
-            value.reserve(64);
-            while (i < len) {
-                if (raw[i] == '"') {
-                    if (i + 1 < len && raw[i + 1] == '"') {
-                        value += '"';
-                        i += 2;
+/// 1パスで Entity / Relation / Shape セクションの本文範囲だけを記録する（行のコピーなし）
+std::vector<Section> splitSections(std::string_view content) {
+    std::vector<Section> sections;
+    SectionKind kind = SectionKind::Other;
+    bool inSection = false;
+    size_t bodyBegin = 0;
+    auto closeSection = [&](size_t end) {
+        if (inSection && kind != SectionKind::Other)
+            sections.push_back({kind, content.substr(bodyBegin, end - bodyBegin)});
+    };
+
+    std::string_view rest = content;
+    std::string_view line;
+    for (size_t lineBegin = 0; nextLine(rest, line); lineBegin = content.size() - rest.size()) {
+        // セクションヘッダ判定: [Entity], [Relation], [Shape] 等（新ヘッダが暗黙の区切り）
+        if (line.size() >= 3 && line.front() == '[' && line.back() == ']') {
+            closeSection(lineBegin);
+            kind = sectionKindOf(line.substr(1, line.size() - 2));
+            inSection = true;
+            bodyBegin = content.size() - rest.size();
+            continue;
+        }
+        // 明示的セクション終端（DEL行）
+        if (line == "DEL" && inSection) {
+            closeSection(lineBegin);
+            inSection = false;
+        }
+    }
+    // 最終セクション（DELなしファイル対応）
+    closeSection(content.size());
+    return sections;
+}
+
+bool splitProp(std::string_view line, std::string_view& key, std::string_view& value) {
+    const auto eqPos = line.find('=');
+    if (eqPos == std::string_view::npos)
+        return false;
+    key = line.substr(0, eqPos);
+    value = line.substr(eqPos + 1);
+    return true;
+}
+
+int toInt(std::string_view value) {
+    int result = 0;
+    std::from_chars(value.data(), value.data() + value.size(), result);
+    return result;
+}
+
+double toDouble(std::string_view value) {
+    double result = 0.0;
+    std::from_chars(value.data(), value.data() + value.size(), result);
+    return result;
+}
+
+/// パーススレッドごとの作業領域。Field 行の分割結果は使い回し、"" 解除後の値はアリーナに置く
+struct FieldScratch {
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector<std::string_view> fields;
+};
+
+A5ERTable parseEntity(std::string_view body, FieldScratch& scratch) {
+    A5ERTable table{};
+    std::string_view line;
+    std::string_view key;
+    std::string_view value;
+    while (nextLine(body, line)) {
+        if (line.starts_with("Field=")) {
+            a5er::splitQuotedFields(line.substr(6), scratch.fields, scratch.arena);
+            const auto& parts = scratch.fields;
+            A5ERColumn col{};
+            if (!parts.empty())
+                col.name = parts[0];
+            if (parts.size() > 1)
+                col.logicalName = parts[1];
+            if (parts.size() > 2)
+                col.type = parts[2];
+            if (parts.size() > 3)
+                col.nullable = (parts[3] != "NOT NULL");
+            if (parts.size() > 4) {
+                // A5:ER Field[4]: PK順序。数値(0,1,...)=PK、空文字=非PK
+                col.isPrimaryKey = !parts[4].empty();
+            }
+            if (parts.size() > 5)
+                col.defaultValue = a5er::unescape(parts[5]);
+            if (parts.size() > 6)
+                col.comment = a5er::unescape(parts[6]);
+            // Field[7]: column color ($AABBGGRR format)
+            if (parts.size() > 7)
+                col.color = parts[7];
+            table.columns.push_back(std::move(col));
+        } else if (line.starts_with("Index=")) {
+            if (splitProp(line.substr(6), key, value)) {
+                A5ERIndex idx{};
+                idx.name = key;
+                bool first = true;
+                splitCommas(value, [&](std::string_view part) {
+                    if (first) {
+                        idx.isUnique = (part == "1");
+                        first = false;
                     } else {
-                        ++i;
-                        break;
+                        idx.columns.emplace_back(part);
                     }
-                } else {
-                    value += raw[i];
-                    ++i;
-                }
-            }
-            result.push_back(std::move(value));
-        } else {
-            std::string value;
-            while (i < len && raw[i] != ',') {
-                value += raw[i];
-                ++i;
+                });
+                table.indexes.push_back(std::move(idx));
             }
-            result.push_back(std::move(value));
+        } else if (splitProp(line, key, value)) {
+            // 同じキーが複数あれば後勝ち
+            if (key == "PName")
+                table.name = value;
+            else if (key == "LName")
+                table.logicalName = value;
+            else if (key == "Comment")
+                table.comment = value;
+            else if (key == "Page")
+                table.page = value;
+            else if (key == "Left")
+                table.posX = toDouble(value);
+            else if (key == "Top")
+                table.posY = toDouble(value);
+            else if (key == "Color")
+                table.color = value;
+            else if (key == "BkColor")
+                table.bkColor = value;
         }
-
-        // カンマスキップ
-        if (i < len && raw[i] == ',')
-            ++i;
     }
+    return table;
+}
 
-    return result;
+/// Entity 本文を model.tables の同じ位置へ変換する。大きなモデルはスライスに分けて並列に処理
+void parseEntities(std::span<const std::string_view> bodies, std::vector<A5ERTable>& tables) {
+    tables.resize(bodies.size());
+    const size_t hardware = (std::max)(std::thread::hardware_concurrency(), 1u);
+    const size_t slices = bodies.size() >= PARALLEL_MIN_ENTITIES ? (std::min)(hardware, bodies.size() / MIN_ENTITIES_PER_SLICE) : 1;
+
+    std::vector<std::exception_ptr> errors(slices);
+    auto runSlice = [&](size_t slice) {
+        try {
+            FieldScratch scratch;
+            const size_t begin = bodies.size() * slice / slices;
+            const size_t end = bodies.size() * (slice + 1) / slices;
+            for (size_t i = begin; i < end; ++i) {
+                tables[i] = parseEntity(bodies[i], scratch);
+            }
+        } catch (...) {
+            errors[slice] = std::current_exception();
+        }
+    };
+    if (slices == 1) {
+        runSlice(0);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(slices - 1);
+        for (size_t slice = 1; slice < slices; ++slice) {
+            workers.emplace_back(runSlice, slice);
+        }
+        runSlice(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
 }
 
+}  // namespace
+
 std::string A5ERParser::resolveCardinality(int type1, int type2, bool& needsSwap) {
     auto isMany = [](int t) { return t == 3 || t == 4; };
     auto isOne = [](int t) { return t == 1 || t == 2; };
@@ -408,209 +614,87 @@ std::string A5ERParser::resolveCardinality(int type1, int type2, bool& needsSwap
     return "1:N";
 }
 
-A5ERModel A5ERParser::parseTextFormat(const std::string& content) const {
+A5ERModel A5ERParser::parseTextFormat(std::string_view content) const {
     A5ERModel model;
-    std::istringstream stream(content);
-    std::string line;
-
-    struct Section {
-        std::string type;
-        std::vector<std::string> lines;
-    };
-
-    std::vector<Section> sections;
-    std::string currentType;
-    std::vector<std::string> currentLines;
-
-    while (std::getline(stream, line)) {
-        // Remove trailing \r
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-
-        // セクションヘッダ判定: [Entity], [Relation], [Shape] 等
-        if (line.size() >= 3 && line.front() == '[' && line.back() == ']') {
-            // 前セクションを保存（新ヘッダが暗黙の区切り）
-            if (!currentType.empty() && (currentType == "Entity" || currentType == "Relation" || currentType == "Shape")) {
-                sections.push_back({currentType, std::move(currentLines)});
-            }
-            currentType = line.substr(1, line.size() - 2);
-            currentLines.clear();
-            continue;
-        }
-
-        // 明示的セクション終端（DEL行）
-        if (line == "DEL" && !currentType.empty()) {
-            if (currentType == "Entity" || currentType == "Relation" || currentType == "Shape") {
-                sections.push_back({currentType, std::move(currentLines)});
-            }
-            currentType.clear();
-            currentLines.clear();
-            continue;
-        }
-
-        if (!currentType.empty()) {
-            currentLines.push_back(line);
-        }
-    }
-
-    // 最終セクション保存（DELなしファイル対応）
-    if (!currentType.empty() && (currentType == "Entity" || currentType == "Relation" || currentType == "Shape")) {
-        sections.push_back({currentType, std::move(currentLines)});
-    }
-
-    // props から値を取得するヘルパー
-    auto getProp = [](const std::unordered_map<std::string, std::string>& props, const std::string& key) -> std::string {
-        auto it = props.find(key);
-        return it != props.end() ? it->second : "";
-    };
-
-    auto getPropInt = [&getProp](const std::unordered_map<std::string, std::string>& props, const std::string& key) -> int {
-        auto val = getProp(props, key);
-        int result = 0;
-        if (!val.empty()) {
-            std::from_chars(val.data(), val.data() + val.size(), result);
-        }
-        return result;
-    };
-
-    auto getPropDouble = [&getProp](const std::unordered_map<std::string, std::string>& props, const std::string& key) -> double {
-        auto val = getProp(props, key);
-        if (val.empty())
-            return 0.0;
-        double result = 0.0;
-        std::from_chars(val.data(), val.data() + val.size(), result);
-        return result;
-    };
-
-    // セクション解析
-    for (const auto& section : sections) {
-        if (section.type == "Entity") {
-            A5ERTable table{};
-            std::unordered_map<std::string, std::string> props;
-
-            for (const auto& sline : section.lines) {
-                if (sline.starts_with("Field=")) {
-                    auto parts = parseQuotedCSV(sline.substr(6));
-                    A5ERColumn col{};
-                    if (!parts.empty())
-                        col.name = parts[0];
-                    if (parts.size() > 1)
-                        col.logicalName = parts[1];
-                    if (parts.size() > 2)
-                        col.type = parts[2];
-                    if (parts.size() > 3)
-                        col.nullable = (parts[3] != "NOT NULL");
-                    if (parts.size() > 4) {
-                        // A5:ER Field[4]: PK順序。数値(0,1,...)=PK、空文字=非PK
-                        col.isPrimaryKey = !parts[4].empty();
-                    }
-                    if (parts.size() > 5)
-                        col.defaultValue = a5er::unescape(parts[5]);
-                    if (parts.size() > 6)
-                        col.comment = a5er::unescape(parts[6]);
-                    // Field[7]: column color ($AABBGGRR format)
-                    if (parts.size() > 7)
-                        col.color = parts[7];
-                    col.size = 0;
-                    col.scale = 0;
-                    table.columns.push_back(std::move(col));
-                } else if (sline.starts_with("Index=")) {
-                    auto raw = sline.substr(6);
-                    auto eqPos = raw.find('=');
-                    if (eqPos != std::string::npos) {
-                        A5ERIndex idx{};
-                        idx.name = raw.substr(0, eqPos);
-                        auto rest = raw.substr(eqPos + 1);
-                        std::istringstream iss(rest);
-                        std::string part;
-                        bool first = true;
-                        while (std::getline(iss, part, ',')) {
-                            if (first) {
-                                idx.isUnique = (part == "1");
-                                first = false;
-                            } else {
-                                idx.columns.push_back(part);
-                            }
-                        }
-                        table.indexes.push_back(std::move(idx));
-                    }
-                } else {
-                    auto eqPos = sline.find('=');
-                    if (eqPos != std::string::npos) {
-                        props[sline.substr(0, eqPos)] = sline.substr(eqPos + 1);
-                    }
-                }
-            }
-
-            table.name = getProp(props, "PName");
-            table.logicalName = getProp(props, "LName");
-            table.comment = getProp(props, "Comment");
-            table.page = getProp(props, "Page");
-            table.posX = getPropDouble(props, "Left");
-            table.posY = getPropDouble(props, "Top");
-            table.color = getProp(props, "Color");
-            table.bkColor = getProp(props, "BkColor");
-
-            model.tables.push_back(std::move(table));
-        } else if (section.type == "Relation") {
-            std::unordered_map<std::string, std::string> props;
-            for (const auto& sline : section.lines) {
-                auto eqPos = sline.find('=');
-                if (eqPos != std::string::npos) {
-                    props[sline.substr(0, eqPos)] = sline.substr(eqPos + 1);
-                }
-            }
 
+    // Entity は独立しているので後でまとめて（必要なら並列に）変換する
+    std::vector<std::string_view> entityBodies;
+    std::string_view line;
+    std::string_view key;
+    std::string_view value;
+
+    for (const auto& section : splitSections(content)) {
+        std::string_view body = section.body;
+        if (section.kind == SectionKind::Entity) {
+            entityBodies.push_back(body);
+        } else if (section.kind == SectionKind::Relation) {
             A5ERRelation rel{};
-            rel.parentTable = getProp(props, "Entity1");
-            rel.childTable = getProp(props, "Entity2");
-            rel.parentColumn = getProp(props, "Fields1");
-            rel.childColumn = getProp(props, "Fields2");
-            rel.name = rel.parentTable + "_" + rel.childTable;
+            int type1 = 0;
+            int type2 = 0;
+            while (nextLine(body, line)) {
+                if (!splitProp(line, key, value))
+                    continue;
+                if (key == "Entity1")
+                    rel.parentTable = value;
+                else if (key == "Entity2")
+                    rel.childTable = value;
+                else if (key == "Fields1")
+                    rel.parentColumn = value;
+                else if (key == "Fields2")
+                    rel.childColumn = value;
+                else if (key == "RelationType1")
+                    type1 = toInt(value);
+                else if (key == "RelationType2")
+                    type2 = toInt(value);
+            }
 
-            int type1 = getPropInt(props, "RelationType1");
-            int type2 = getPropInt(props, "RelationType2");
             bool needsSwap = false;
             rel.cardinality = resolveCardinality(type1, type2, needsSwap);
             if (needsSwap) {
                 std::swap(rel.parentTable, rel.childTable);
                 std::swap(rel.parentColumn, rel.childColumn);
-                rel.name = rel.parentTable + "_" + rel.childTable;
             }
+            rel.name = rel.parentTable + "_" + rel.childTable;
 
             model.relations.push_back(std::move(rel));
-        } else if (section.type == "Shape") {
-            std::unordered_map<std::string, std::string> props;
-            for (const auto& sline : section.lines) {
-                auto eqPos = sline.find('=');
-                if (eqPos != std::string::npos) {
-                    props[sline.substr(0, eqPos)] = sline.substr(eqPos + 1);
-                }
-            }
-
+        } else if (section.kind == SectionKind::Shape) {
             A5ERShape shape{};
-            shape.shapeType = getProp(props, "ShapeType");
-            shape.text = a5er::unescape(getProp(props, "Text"));
-            shape.brushColor = getProp(props, "BrushColor");
-            shape.fontColor = getProp(props, "FontColor");
-            shape.brushAlpha = getPropInt(props, "BrushAlpha");
-            if (shape.brushAlpha == 0 && getProp(props, "BrushAlpha").empty()) {
-                shape.brushAlpha = 255;
+            std::string_view brushAlpha;
+            while (nextLine(body, line)) {
+                if (!splitProp(line, key, value))
+                    continue;
+                if (key == "ShapeType")
+                    shape.shapeType = value;
+                else if (key == "Text")
+                    shape.text = a5er::unescape(value);
+                else if (key == "BrushColor")
+                    shape.brushColor = value;
+                else if (key == "FontColor")
+                    shape.fontColor = value;
+                else if (key == "BrushAlpha")
+                    brushAlpha = value;
+                else if (key == "FontSize")
+                    shape.fontSize = toInt(value);
+                else if (key == "Left")
+                    shape.left = toDouble(value);
+                else if (key == "Top")
+                    shape.top = toDouble(value);
+                else if (key == "Width")
+                    shape.width = toDouble(value);
+                else if (key == "Height")
+                    shape.height = toDouble(value);
+                else if (key == "Page")
+                    shape.page = value;
             }
-            shape.fontSize = getPropInt(props, "FontSize");
+            shape.brushAlpha = brushAlpha.empty() ? 255 : toInt(brushAlpha);
             if (shape.fontSize == 0)
                 shape.fontSize = 9;
-            shape.left = getPropDouble(props, "Left");
-            shape.top = getPropDouble(props, "Top");
-            shape.width = getPropDouble(props, "Width");
-            shape.height = getPropDouble(props, "Height");
-            shape.page = getProp(props, "Page");
 
             model.shapes.push_back(std::move(shape));
         }
     }
 
+    parseEntities(entityBodies, model.tables);
     return model;
 }
 
@@ -709,7 +793,7 @@ std::string A5ERParser::generateTableDDL(const A5ERTable& table, const std::stri
     return ddl.str();
 }
 
-std::string A5ERParser::mapTypeToSQLServer(const std::string& a5erType, int size, int scale) const {
+std::string A5ERParser::mapTypeToSQLServer(const std::string& a5erType, int size, int scale) {
     if (a5erType == "VARCHAR" || a5erType == "string" || a5erType == "NVARCHAR") {
         if (size <= 0 || size > 8000) {
             return "NVARCHAR(MAX)";
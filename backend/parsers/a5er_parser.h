@@ -1,10 +1,12 @@
 #pragma once
 
 #include "../interfaces/parsers/er_diagram_parser.h"
+#include "../utils/ordered_render.h"
 #include "interfaces/parsers/er_model.h"
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace velocitydb {
@@ -80,28 +82,36 @@ public:
 
     // IERDiagramParser interface
     [[nodiscard]] std::vector<std::string> extensions() const override;
-    [[nodiscard]] bool canParse(const std::string& content) const override;
-    [[nodiscard]] ERModel parse(const std::string& content) const override;
+    [[nodiscard]] bool canParse(std::string_view content) const override;
+    [[nodiscard]] ERModel parse(std::string_view content) const override;
     [[nodiscard]] std::string generateDDL(const ERModel& model, TargetDatabase target = TargetDatabase::SQLServer) const override;
+    /// generateDDL() handed to `sink` piece by piece: tables come after the tables they reference and render in
+    /// parallel for large models, then the foreign keys follow
+    void writeDDL(const ERModel& model, TargetDatabase target, const TextSink& sink) const;
 
     // Legacy API (for tests and backward compat)
+    /// Parses straight from a read-only mapping of the file (no copy of its content)
+    /// @throws std::runtime_error if the file cannot be opened or parsed
     A5ERModel parseFile(const std::string& filepath) const;
-    A5ERModel parseFromString(const std::string& content) const;
+    A5ERModel parseFromString(std::string_view content) const;
     std::string generateA5ERDDL(const A5ERModel& model, const std::string& targetDatabase = "SQLServer") const;
     std::string generateTableDDL(const A5ERTable& table, const std::string& targetDatabase = "SQLServer") const;
 
-    // Conversion
-    [[nodiscard]] static ERModel toERModel(const A5ERModel& a5model);
+    // Conversion (strings are moved out of an rvalue model)
+    [[nodiscard]] static ERModel toERModel(A5ERModel a5model);
+
+    /// SQL Server column type for an A5:ER type, e.g. NVARCHAR(50) or DECIMAL(10,2); unknown types pass through
+    [[nodiscard]] static std::string mapTypeToSQLServer(const std::string& a5erType, int size, int scale);
 
 private:
-    [[nodiscard]] bool isTextFormat(const std::string& content) const;
-    A5ERModel parseTextFormat(const std::string& content) const;
-    A5ERModel parseXmlFormat(const std::string& content) const;
-    static std::vector<std::string> parseQuotedCSV(const std::string& raw);
+    [[nodiscard]] bool isTextFormat(std::string_view content) const;
+    /// Single pass over `content` recording section bodies as views; entities are converted afterwards,
+    /// split across cores for large models. Only strings stored in the model are copied out of `content`.
+    A5ERModel parseTextFormat(std::string_view content) const;
+    A5ERModel parseXmlFormat(std::string_view content) const;
     /// Resolve A5:ER RelationType pair to cardinality string.
     /// Sets needsSwap=true when Entity1 is the Many side (parent/child should be swapped).
     static std::string resolveCardinality(int type1, int type2, bool& needsSwap);
-    std::string mapTypeToSQLServer(const std::string& a5erType, int size, int scale) const;
 
     /// A5:ER $BBGGRR or $AABBGGRR → CSS #RRGGBB (empty if default/transparent)
     static std::string convertA5erColor(const std::string& raw);
@@ -2,7 +2,7 @@
 
 namespace velocitydb::a5er {
 
-std::string unescape(const std::string& s) {
+std::string unescape(std::string_view s) {
     std::string result;
     result.reserve(s.size());
     for (size_t i = 0; i < s.size(); ++i) {
@@ -15,4 +15,60 @@ std::string unescape(const std::string& s) {
     return result;
 }
 
+void splitQuotedFields(std::string_view raw, std::vector<std::string_view>& fields, std::pmr::memory_resource& arena) {
+    fields.clear();
+    size_t i = 0;
+    const size_t len = raw.size();
+
+    while (i < len) {
+        // 先頭空白スキップ
+        while (i < len && raw[i] == ' ')
+            ++i;
+        if (i >= len)
+            break;
+
+        if (raw[i] == '"') {
+            const size_t start = ++i;  // 開始引用符スキップ
+            size_t escapes = 0;
+            while (i < len) {
+                if (raw[i] == '"') {
+                    if (i + 1 < len && raw[i + 1] == '"') {
+                        ++escapes;
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++i;
+            }
+            const auto quoted = raw.substr(start, i - start);
+            if (i < len)
+                ++i;  // 終了引用符スキップ
+
+            if (escapes == 0) {
+                fields.push_back(quoted);
+            } else {
+                // "" → " を解除した値だけアリーナへ
+                auto* out = static_cast<char*>(arena.allocate(quoted.size() - escapes, 1));
+                size_t n = 0;
+                for (size_t k = 0; k < quoted.size(); ++k) {
+                    out[n++] = quoted[k];
+                    if (quoted[k] == '"')
+                        ++k;
+                }
+                fields.emplace_back(out, n);
+            }
+        } else {
+            const size_t start = i;
+            while (i < len && raw[i] != ',')
+                ++i;
+            fields.push_back(raw.substr(start, i - start));
+        }
+
+        // カンマスキップ
+        if (i < len && raw[i] == ',')
+            ++i;
+    }
+}
+
 }  // namespace velocitydb::a5er
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace velocitydb::a5er {
 
@@ -11,6 +14,15 @@ namespace velocitydb::a5er {
  *
  * 将来 \n, \\ 等のエスケープが判明した場合はここに追加する。
  */
-[[nodiscard]] std::string unescape(const std::string& s);
+[[nodiscard]] std::string unescape(std::string_view s);
+
+/**
+ * Field= 行などのカンマ区切り値を分割する（"..." 引用・"" エスケープ対応）。
+ *
+ * 結果は `raw` へのビュー。"" を含む引用値だけは解除後の文字列を `arena` に置き、
+ * そのビューを返すため、`raw` と `arena` が生きている間だけ有効。
+ * `fields` は呼び出し側で使い回す（行ごとの確保を避ける）。
+ */
+void splitQuotedFields(std::string_view raw, std::vector<std::string_view>& fields, std::pmr::memory_resource& arena);
 
 }  // namespace velocitydb::a5er
@@ -1,9 +1,11 @@
 #include "er_diagram_parser_factory.h"
 
 #include "../interfaces/parsers/er_diagram_parser.h"
+#include "../utils/json_utils.h"
 #include "a5er_parser.h"
 
 #include <algorithm>
+#include <format>
 #include <stdexcept>
 
 namespace velocitydb {
@@ -29,7 +31,7 @@ ERDiagramParserFactory::~ERDiagramParserFactory() = default;
 ERDiagramParserFactory::ERDiagramParserFactory(ERDiagramParserFactory&&) noexcept = default;
 ERDiagramParserFactory& ERDiagramParserFactory::operator=(ERDiagramParserFactory&&) noexcept = default;
 
-const IERDiagramParser& ERDiagramParserFactory::findParser(const std::string& content, const std::string& filename) const {
+const IERDiagramParser& ERDiagramParserFactory::findParser(std::string_view content, const std::string& filename) const {
     auto ext = extractExtension(filename);
 
     // 1. Extension match + canParse
@@ -49,21 +51,53 @@ const IERDiagramParser& ERDiagramParserFactory::findParser(const std::string& co
     throw std::runtime_error("No parser found for the given ER diagram format");
 }
 
-ERModel ERDiagramParserFactory::parse(const std::string& content, const std::string& filename) const {
+ERModel ERDiagramParserFactory::parse(std::string_view content, const std::string& filename) const {
     return findParser(content, filename).parse(content);
 }
 
-std::string ERDiagramParserFactory::generateDDL(const std::string& content, const std::string& filename, TargetDatabase target) const {
+std::string ERDiagramParserFactory::generateDDL(std::string_view content, const std::string& filename, TargetDatabase target) const {
     const auto& parser = findParser(content, filename);
     auto model = parser.parse(content);
     return parser.generateDDL(model, target);
 }
 
-ERDiagramParserFactory::ParseResult ERDiagramParserFactory::parseWithDDL(const std::string& content, const std::string& filename, TargetDatabase target) const {
+ERDiagramParserFactory::ParseResult ERDiagramParserFactory::parseWithDDL(std::string_view content, const std::string& filename, TargetDatabase target) const {
     const auto& parser = findParser(content, filename);
     auto model = parser.parse(content);
     auto ddl = parser.generateDDL(model, target);
     return {std::move(model), std::move(ddl)};
 }
 
+std::string ERDiagramParserFactory::toJson(const ERModel& model, std::string_view ddl) {
+    auto tablesJson = JsonUtils::buildArray(model.tables, [](std::string& out, const auto& table) {
+        auto columnsJson = JsonUtils::buildArray(table.columns, [](std::string& out, const auto& col) {
+            out += std::format(R"({{"name":"{}","logicalName":"{}","type":"{}","size":{},"scale":{},"nullable":{},"isPrimaryKey":{},"defaultValue":"{}","comment":"{}","color":"{}"}})",
+                               JsonUtils::escapeString(col.name), JsonUtils::escapeString(col.logicalName), JsonUtils::escapeString(col.type), col.size, col.scale, col.nullable ? "true" : "false",
+                               col.isPrimaryKey ? "true" : "false", JsonUtils::escapeString(col.defaultValue), JsonUtils::escapeString(col.comment), JsonUtils::escapeString(col.color));
+        });
+        auto indexesJson = JsonUtils::buildArray(table.indexes, [](std::string& out, const auto& idx) {
+            auto idxColumnsJson = JsonUtils::buildArray(idx.columns, [](std::string& out, const auto& colName) { out += std::format(R"("{}")", JsonUtils::escapeString(colName)); });
+            out += std::format(R"({{"name":"{}","columns":{},"isUnique":{}}})", JsonUtils::escapeString(idx.name), idxColumnsJson, idx.isUnique ? "true" : "false");
+        });
+        out += std::format(R"({{"name":"{}","logicalName":"{}","comment":"{}","page":"{}","columns":{},"indexes":{},"posX":{},"posY":{},"color":"{}","bkColor":"{}"}})",
+                           JsonUtils::escapeString(table.name), JsonUtils::escapeString(table.logicalName), JsonUtils::escapeString(table.comment), JsonUtils::escapeString(table.page), columnsJson,
+                           indexesJson, table.posX, table.posY, JsonUtils::escapeString(table.color), JsonUtils::escapeString(table.bkColor));
+    });
+
+    auto relationsJson = JsonUtils::buildArray(model.relations, [](std::string& out, const auto& rel) {
+        out += std::format(R"({{"name":"{}","parentTable":"{}","childTable":"{}","parentColumn":"{}","childColumn":"{}","cardinality":"{}"}})", JsonUtils::escapeString(rel.name),
+                           JsonUtils::escapeString(rel.parentTable), JsonUtils::escapeString(rel.childTable), JsonUtils::escapeString(rel.parentColumn), JsonUtils::escapeString(rel.childColumn),
+                           JsonUtils::escapeString(rel.cardinality));
+    });
+
+    auto shapesJson = JsonUtils::buildArray(model.shapes, [](std::string& out, const auto& shape) {
+        out += std::format(R"({{"shapeType":"{}","text":"{}","fillColor":"{}","fontColor":"{}","fillAlpha":{},"fontSize":{},"left":{},"top":{},"width":{},"height":{},"page":"{}"}})",
+                           JsonUtils::escapeString(shape.shapeType), JsonUtils::escapeString(shape.text), JsonUtils::escapeString(shape.fillColor), JsonUtils::escapeString(shape.fontColor),
+                           shape.fillAlpha, shape.fontSize, shape.left, shape.top, shape.width, shape.height, JsonUtils::escapeString(shape.page));
+    });
+
+    return std::format(R"({{"name":"{}","databaseType":"{}","tables":{},"relations":{},"shapes":{},"ddl":"{}"}})", JsonUtils::escapeString(model.name), JsonUtils::escapeString(model.databaseType),
+                       tablesJson, relationsJson, shapesJson, JsonUtils::escapeString(ddl));
+}
+
 }  // namespace velocitydb
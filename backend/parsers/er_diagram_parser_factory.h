@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace velocitydb {
@@ -20,22 +21,25 @@ public:
     ERDiagramParserFactory(ERDiagramParserFactory&&) noexcept;
     ERDiagramParserFactory& operator=(ERDiagramParserFactory&&) noexcept;
 
-    [[nodiscard]] ERModel parse(const std::string& content, const std::string& filename = "") const;
+    [[nodiscard]] ERModel parse(std::string_view content, const std::string& filename = "") const;
 
-    [[nodiscard]] std::string generateDDL(const std::string& content, const std::string& filename = "", TargetDatabase target = TargetDatabase::SQLServer) const;
+    [[nodiscard]] std::string generateDDL(std::string_view content, const std::string& filename = "", TargetDatabase target = TargetDatabase::SQLServer) const;
 
     /// Parse and generate DDL in one findParser call (avoids double lookup)
     struct ParseResult {
         ERModel model;
         std::string ddl;
     };
-    [[nodiscard]] ParseResult parseWithDDL(const std::string& content, const std::string& filename = "", TargetDatabase target = TargetDatabase::SQLServer) const;
+    [[nodiscard]] ParseResult parseWithDDL(std::string_view content, const std::string& filename = "", TargetDatabase target = TargetDatabase::SQLServer) const;
+
+    /// The model as the frontend's ER diagram payload, whatever produced it
+    [[nodiscard]] static std::string toJson(const ERModel& model, std::string_view ddl = "");
 
 private:
     std::vector<std::unique_ptr<IERDiagramParser>> m_parsers;
 
     /// @throws std::runtime_error if no parser matches the given content/filename
-    [[nodiscard]] const IERDiagramParser& findParser(const std::string& content, const std::string& filename) const;
+    [[nodiscard]] const IERDiagramParser& findParser(std::string_view content, const std::string& filename) const;
 };
 
 }  // namespace velocitydb
@@ -0,0 +1,463 @@
+#include "er_model_cache.h"
+
+#include "../utils/buffered_file_writer.h"
+#include "../utils/file_utils.h"
+#include "../utils/lz4_codec.h"
+#include "../utils/mapped_file.h"
+#include "../utils/metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr std::string_view ENTRY_MAGIC = "VDER";
+constexpr std::string_view ENTRY_EXTENSION = ".vder";
+constexpr uint16_t ENTRY_COMPRESSED = 1;
+constexpr size_t ENTRY_HEADER_BYTES = 40;  // Magic, version, flags, raw bytes, stored bytes, content hash, file size, modified at
+
+[[nodiscard]] uint32_t position(size_t value) {
+    if (value > UINT32_MAX) [[unlikely]] {
+        throw std::runtime_error("ER model too large to cache");
+    }
+    return static_cast<uint32_t>(value);
+}
+
+template <typename T>
+void appendLe(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void appendText(std::string& out, std::string_view text) {
+    appendLe(out, position(text.size()));
+    out.append(text);
+}
+
+template <typename T>
+[[nodiscard]] T readLe(std::string_view data, size_t offset) noexcept {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+/// Bounds-checked reads over an entry body; any overrun means the file is damaged
+class EntryReader {
+public:
+    explicit EntryReader(std::string_view data) noexcept : m_data(data) {}
+
+    template <typename T>
+    [[nodiscard]] T value() {
+        need(sizeof(T));
+        const auto result = readLe<T>(m_data, m_at);
+        m_at += sizeof(T);
+        return result;
+    }
+
+    [[nodiscard]] std::string text() {
+        const auto bytes = value<uint32_t>();
+        need(bytes);
+        std::string result(m_data.substr(m_at, bytes));
+        m_at += bytes;
+        return result;
+    }
+
+    /// An element count, checked against what is left so a damaged count cannot reserve gigabytes
+    [[nodiscard]] size_t count(size_t minBytesEach) {
+        const auto items = value<uint32_t>();
+        if (items > (m_data.size() - m_at) / minBytesEach) [[unlikely]] {
+            damaged();
+        }
+        return items;
+    }
+
+    [[nodiscard]] bool atEnd() const noexcept { return m_at == m_data.size(); }
+
+    [[noreturn]] static void damaged() { throw std::runtime_error("ER model cache entry is damaged"); }
+
+private:
+    void need(size_t bytes) const {
+        if (m_data.size() - m_at < bytes) [[unlikely]] {
+            damaged();
+        }
+    }
+
+    std::string_view m_data;
+    size_t m_at = 0;
+};
+
+[[nodiscard]] std::filesystem::path pathFromUtf8(std::string_view utf8) {
+    return std::filesystem::path(std::u8string_view(reinterpret_cast<const char8_t*>(utf8.data()), utf8.size()));
+}
+
+[[nodiscard]] std::string pathToUtf8(const std::filesystem::path& path) {
+    auto utf8 = path.u8string();
+    return std::string(utf8.begin(), utf8.end());
+}
+
+}  // namespace
+
+ERModelCache::ERModelCache(std::filesystem::path directory, size_t maxEntries) : m_directory(std::move(directory)), m_maxEntries((std::max)(maxEntries, size_t{1})) {}
+
+std::filesystem::path ERModelCache::defaultDirectory() {
+    return pathFromUtf8(FileUtils::getAppDataPath()) / "er_cache";
+}
+
+uint64_t ERModelCache::contentHash(std::string_view content) noexcept {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : content) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::shared_ptr<const ERModelCache::ParseResult> ERModelCache::get(const std::string& filepath, const Parser& parse, bool persist) {
+    static auto& memoryHits = MetricsRegistry::instance().counter("cache.er_model.memory_hits");
+    static auto& diskHits = MetricsRegistry::instance().counter("cache.er_model.disk_hits");
+    static auto& parses = MetricsRegistry::instance().counter("cache.er_model.parses");
+
+    const auto path = pathFromUtf8(filepath);
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(path, ec);
+    const auto modifiedAt = ec ? std::filesystem::file_time_type{} : std::filesystem::last_write_time(path, ec);
+    if (ec) [[unlikely]] {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+    Stamp stamp{.fileSize = fileSize, .modifiedAt = static_cast<int64_t>(modifiedAt.time_since_epoch().count())};
+
+    // Unchanged size and time: no need to read the file at all
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto hit = remembered(filepath, stamp, false)) {
+            memoryHits.add();
+            return hit;
+        }
+    }
+    if (auto hit = persist ? stored(filepath, stamp, false) : nullptr) {
+        diskHits.add();
+        remember(filepath, stamp, hit);
+        return hit;
+    }
+
+    MappedFile file;
+    if (!file.open(filepath)) [[unlikely]] {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+    stamp.contentHash = contentHash(file.view());
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto hit = remembered(filepath, stamp, true)) {
+            memoryHits.add();
+            return hit;
+        }
+    }
+    if (auto hit = persist ? stored(filepath, stamp, true) : nullptr) {
+        diskHits.add();
+        remember(filepath, stamp, hit);
+        store(filepath, stamp, *hit);  // Refresh the size and time so the next open skips hashing
+        return hit;
+    }
+
+    parses.add();
+    auto result = std::make_shared<const ParseResult>(parse(file.view()));
+    remember(filepath, stamp, result);
+    if (persist) {
+        store(filepath, stamp, *result);
+    }
+    return result;
+}
+
+void ERModelCache::clear() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_entries.clear();
+    }
+    if (!m_directory.empty()) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(m_directory, ec)) {
+            if (entry.path().extension() == ENTRY_EXTENSION) {
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+    }
+}
+
+size_t ERModelCache::entryCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+std::filesystem::path ERModelCache::entryPath(const std::string& filepath) const {
+    return m_directory / std::format("{:016x}{}", contentHash(filepath), ENTRY_EXTENSION);
+}
+
+std::shared_ptr<const ERModelCache::ParseResult> ERModelCache::remembered(const std::string& filepath, const Stamp& stamp, bool byHash) {
+    auto it = m_entries.find(filepath);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    auto& entry = it->second;
+    if (byHash ? entry.stamp.contentHash != stamp.contentHash : entry.stamp.fileSize != stamp.fileSize || entry.stamp.modifiedAt != stamp.modifiedAt) {
+        return nullptr;
+    }
+    if (byHash) {
+        entry.stamp = stamp;  // Same content under a new size or time
+    }
+    entry.lastUse = ++m_useCounter;
+    return entry.result;
+}
+
+void ERModelCache::remember(const std::string& filepath, const Stamp& stamp, std::shared_ptr<const ParseResult> result) {
+    std::lock_guard lock(m_mutex);
+    m_entries.insert_or_assign(filepath, Entry{.stamp = stamp, .result = std::move(result), .lastUse = ++m_useCounter});
+    if (m_entries.size() > m_maxEntries) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        m_entries.erase(oldest);
+    }
+}
+
+std::shared_ptr<const ERModelCache::ParseResult> ERModelCache::stored(const std::string& filepath, Stamp& stamp, bool byHash) const {
+    if (m_directory.empty()) {
+        return nullptr;
+    }
+    MappedFile file;
+    if (!file.open(pathToUtf8(entryPath(filepath)))) {
+        return nullptr;
+    }
+    const auto found = stampOf(file.view());
+    if (!found || (byHash ? found->contentHash != stamp.contentHash : found->fileSize != stamp.fileSize || found->modifiedAt != stamp.modifiedAt)) {
+        return nullptr;
+    }
+    try {
+        auto result = std::make_shared<const ParseResult>(deserialize(file.view()));
+        if (!byHash) {
+            stamp.contentHash = found->contentHash;
+        }
+        return result;
+    } catch (const std::runtime_error&) {
+        return nullptr;  // Parsed again and overwritten
+    }
+}
+
+void ERModelCache::store(const std::string& filepath, const Stamp& stamp, const ParseResult& result) const {
+    static std::atomic<uint64_t> tempSequence{0};
+    if (m_directory.empty()) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    const auto finalPath = entryPath(filepath);
+    const auto tempPath = m_directory / std::format("{}.{}.tmp", finalPath.stem().string(), tempSequence.fetch_add(1));
+    {
+        BufferedFileWriter writer(64 * 1024);
+        if (!writer.open(pathToUtf8(tempPath))) {
+            return;
+        }
+        writer.append(serialize(result, stamp.contentHash, stamp.fileSize, stamp.modifiedAt));
+        if (!writer.close()) {
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+std::string ERModelCache::serialize(const ParseResult& result, uint64_t contentHash, uint64_t fileSize, int64_t modifiedAt) {
+    const auto& model = result.model;
+    std::string body;
+    appendText(body, model.name);
+    appendText(body, model.databaseType);
+    appendLe(body, position(model.tables.size()));
+    for (const auto& table : model.tables) {
+        appendText(body, table.name);
+        appendText(body, table.logicalName);
+        appendText(body, table.comment);
+        appendText(body, table.page);
+        appendLe(body, table.posX);
+        appendLe(body, table.posY);
+        appendText(body, table.color);
+        appendText(body, table.bkColor);
+        appendLe(body, position(table.columns.size()));
+        for (const auto& column : table.columns) {
+            appendText(body, column.name);
+            appendText(body, column.logicalName);
+            appendText(body, column.type);
+            appendLe(body, static_cast<int32_t>(column.size));
+            appendLe(body, static_cast<int32_t>(column.scale));
+            appendLe(body, static_cast<uint8_t>((column.nullable ? 1 : 0) | (column.isPrimaryKey ? 2 : 0)));
+            appendText(body, column.defaultValue);
+            appendText(body, column.comment);
+            appendText(body, column.color);
+        }
+        appendLe(body, position(table.indexes.size()));
+        for (const auto& index : table.indexes) {
+            appendText(body, index.name);
+            appendLe(body, position(index.columns.size()));
+            for (const auto& column : index.columns) {
+                appendText(body, column);
+            }
+            appendLe(body, static_cast<uint8_t>(index.isUnique ? 1 : 0));
+        }
+    }
+    appendLe(body, position(model.relations.size()));
+    for (const auto& relation : model.relations) {
+        appendText(body, relation.name);
+        appendText(body, relation.parentTable);
+        appendText(body, relation.childTable);
+        appendText(body, relation.parentColumn);
+        appendText(body, relation.childColumn);
+        appendText(body, relation.cardinality);
+    }
+    appendLe(body, position(model.shapes.size()));
+    for (const auto& shape : model.shapes) {
+        appendText(body, shape.shapeType);
+        appendText(body, shape.text);
+        appendText(body, shape.fillColor);
+        appendText(body, shape.fontColor);
+        appendLe(body, static_cast<int32_t>(shape.fillAlpha));
+        appendLe(body, static_cast<int32_t>(shape.fontSize));
+        appendLe(body, shape.left);
+        appendLe(body, shape.top);
+        appendLe(body, shape.width);
+        appendLe(body, shape.height);
+        appendText(body, shape.page);
+    }
+    appendText(body, result.ddl);
+
+    if (body.size() > Lz4Codec::MAX_INPUT_BYTES) [[unlikely]] {
+        throw std::runtime_error("ER model too large to cache");
+    }
+    std::string out;
+    out.append(ENTRY_MAGIC);
+    appendLe(out, VERSION);
+    out.resize(ENTRY_HEADER_BYTES + Lz4Codec::compressBound(body.size()));
+    const size_t compressed = Lz4Codec::compress(body, out.data() + ENTRY_HEADER_BYTES, out.size() - ENTRY_HEADER_BYTES);
+    const bool raw = compressed == 0 || compressed >= body.size();
+    const auto flags = raw ? uint16_t{0} : ENTRY_COMPRESSED;
+    const auto rawBytes = static_cast<uint32_t>(body.size());
+    const auto storedBytes = static_cast<uint32_t>(raw ? body.size() : compressed);
+    std::memcpy(out.data() + 6, &flags, sizeof(flags));
+    std::memcpy(out.data() + 8, &rawBytes, sizeof(rawBytes));
+    std::memcpy(out.data() + 12, &storedBytes, sizeof(storedBytes));
+    std::memcpy(out.data() + 16, &contentHash, sizeof(contentHash));
+    std::memcpy(out.data() + 24, &fileSize, sizeof(fileSize));
+    std::memcpy(out.data() + 32, &modifiedAt, sizeof(modifiedAt));
+    if (raw) {
+        std::memcpy(out.data() + ENTRY_HEADER_BYTES, body.data(), body.size());
+    }
+    out.resize(ENTRY_HEADER_BYTES + storedBytes);
+    return out;
+}
+
+std::optional<ERModelCache::Stamp> ERModelCache::stampOf(std::string_view data) noexcept {
+    if (data.size() < ENTRY_HEADER_BYTES || data.substr(0, ENTRY_MAGIC.size()) != ENTRY_MAGIC || readLe<uint16_t>(data, 4) != VERSION) {
+        return std::nullopt;
+    }
+    return Stamp{.contentHash = readLe<uint64_t>(data, 16), .fileSize = readLe<uint64_t>(data, 24), .modifiedAt = readLe<int64_t>(data, 32)};
+}
+
+ERModelCache::ParseResult ERModelCache::deserialize(std::string_view data) {
+    if (!stampOf(data)) [[unlikely]] {
+        throw std::runtime_error("Not an ER model cache entry of this version");
+    }
+    const auto flags = readLe<uint16_t>(data, 6);
+    const auto rawBytes = readLe<uint32_t>(data, 8);
+    const auto storedBytes = readLe<uint32_t>(data, 12);
+    if (data.size() - ENTRY_HEADER_BYTES != storedBytes || rawBytes > Lz4Codec::MAX_INPUT_BYTES) [[unlikely]] {
+        EntryReader::damaged();
+    }
+    std::string body(rawBytes, '\0');
+    const auto stored = data.substr(ENTRY_HEADER_BYTES);
+    if ((flags & ENTRY_COMPRESSED) == 0) {
+        if (storedBytes != rawBytes) [[unlikely]] {
+            EntryReader::damaged();
+        }
+        std::memcpy(body.data(), stored.data(), rawBytes);
+    } else if (!Lz4Codec::decompress(stored, body.data(), rawBytes)) [[unlikely]] {
+        EntryReader::damaged();
+    }
+
+    EntryReader reader(body);
+    ParseResult result;
+    auto& model = result.model;
+    model.name = reader.text();
+    model.databaseType = reader.text();
+    model.tables.resize(reader.count(48));
+    for (auto& table : model.tables) {
+        table.name = reader.text();
+        table.logicalName = reader.text();
+        table.comment = reader.text();
+        table.page = reader.text();
+        table.posX = reader.value<double>();
+        table.posY = reader.value<double>();
+        table.color = reader.text();
+        table.bkColor = reader.text();
+        table.columns.resize(reader.count(33));
+        for (auto& column : table.columns) {
+            column.name = reader.text();
+            column.logicalName = reader.text();
+            column.type = reader.text();
+            column.size = reader.value<int32_t>();
+            column.scale = reader.value<int32_t>();
+            const auto columnFlags = reader.value<uint8_t>();
+            column.nullable = (columnFlags & 1) != 0;
+            column.isPrimaryKey = (columnFlags & 2) != 0;
+            column.defaultValue = reader.text();
+            column.comment = reader.text();
+            column.color = reader.text();
+        }
+        table.indexes.resize(reader.count(9));
+        for (auto& index : table.indexes) {
+            index.name = reader.text();
+            index.columns.resize(reader.count(4));
+            for (auto& column : index.columns) {
+                column = reader.text();
+            }
+            index.isUnique = reader.value<uint8_t>() != 0;
+        }
+    }
+    model.relations.resize(reader.count(24));
+    for (auto& relation : model.relations) {
+        relation.name = reader.text();
+        relation.parentTable = reader.text();
+        relation.childTable = reader.text();
+        relation.parentColumn = reader.text();
+        relation.childColumn = reader.text();
+        relation.cardinality = reader.text();
+    }
+    model.shapes.resize(reader.count(60));
+    for (auto& shape : model.shapes) {
+        shape.shapeType = reader.text();
+        shape.text = reader.text();
+        shape.fillColor = reader.text();
+        shape.fontColor = reader.text();
+        shape.fillAlpha = reader.value<int32_t>();
+        shape.fontSize = reader.value<int32_t>();
+        shape.left = reader.value<double>();
+        shape.top = reader.value<double>();
+        shape.width = reader.value<double>();
+        shape.height = reader.value<double>();
+        shape.page = reader.text();
+    }
+    result.ddl = reader.text();
+    if (!reader.atEnd()) [[unlikely]] {
+        EntryReader::damaged();
+    }
+    return result;
+}
+
+}  // namespace velocitydb
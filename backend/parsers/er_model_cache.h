@@ -0,0 +1,94 @@
+#pragma once
+
+#include "er_diagram_parser_factory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace velocitydb {
+
+/// Parsed ER diagrams by file path, so re-opening a diagram skips reading and parsing it.
+///
+/// An entry is trusted while the file keeps its size and modification time; when either changed, the content is
+/// hashed (64-bit FNV-1a) and a match still hits, so a touched but unchanged file is not parsed again. Given a
+/// directory, entries also persist there as one LZ4-compressed file per path, named by the path's hash, so a diagram
+/// opened in an earlier session loads without parsing. The memory tier keeps the most recently used entries.
+class ERModelCache {
+public:
+    using ParseResult = ERDiagramParserFactory::ParseResult;
+    using Parser = std::function<ParseResult(std::string_view content)>;
+
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 8;
+
+    /// `directory` empty keeps entries in memory only; otherwise it is created on first store
+    explicit ERModelCache(std::filesystem::path directory = {}, size_t maxEntries = DEFAULT_MAX_ENTRIES);
+    ~ERModelCache() = default;
+
+    ERModelCache(const ERModelCache&) = delete;
+    ERModelCache& operator=(const ERModelCache&) = delete;
+    ERModelCache(ERModelCache&&) = delete;
+    ERModelCache& operator=(ERModelCache&&) = delete;
+
+    /// <app data>\er_cache
+    [[nodiscard]] static std::filesystem::path defaultDirectory();
+
+    /// The diagram at `filepath` (UTF-8), calling `parse` on its content only when no tier holds that content.
+    /// `persist` adds the directory tier. Parsing runs without the lock, so other diagrams load meanwhile
+    /// @throws std::runtime_error when the file cannot be read; whatever `parse` throws
+    [[nodiscard]] std::shared_ptr<const ParseResult> get(const std::string& filepath, const Parser& parse, bool persist = true);
+
+    void clear();
+    [[nodiscard]] size_t entryCount() const;
+
+    [[nodiscard]] static uint64_t contentHash(std::string_view content) noexcept;
+
+    /// Entry file bytes: header (magic, version, flags, raw and stored body bytes, content hash, file size and
+    /// modification time) followed by the model and DDL, LZ4-compressed unless that does not shrink them
+    [[nodiscard]] static std::string serialize(const ParseResult& result, uint64_t contentHash, uint64_t fileSize, int64_t modifiedAt);
+
+    /// Header fields of an entry file, or nullopt when `data` is not one of this version
+    struct Stamp {
+        uint64_t contentHash = 0;
+        uint64_t fileSize = 0;
+        int64_t modifiedAt = 0;
+    };
+    [[nodiscard]] static std::optional<Stamp> stampOf(std::string_view data) noexcept;
+
+    /// @throws std::runtime_error when `data` is damaged or of another version
+    [[nodiscard]] static ParseResult deserialize(std::string_view data);
+
+private:
+    struct Entry {
+        Stamp stamp;
+        std::shared_ptr<const ParseResult> result;
+        uint64_t lastUse = 0;
+    };
+
+    [[nodiscard]] std::filesystem::path entryPath(const std::string& filepath) const;
+    /// Entry for `filepath` if it matches `stamp` by size and time, or by hash when `byHash` (lock held)
+    [[nodiscard]] std::shared_ptr<const ParseResult> remembered(const std::string& filepath, const Stamp& stamp, bool byHash);
+    /// Keep `result` for `filepath`, evicting the least recently used entry beyond the cap
+    void remember(const std::string& filepath, const Stamp& stamp, std::shared_ptr<const ParseResult> result);
+    /// Entry file of `filepath` if it matches `stamp` like remembered(), filling in the stored hash on a size and
+    /// time match; unreadable files are ignored
+    [[nodiscard]] std::shared_ptr<const ParseResult> stored(const std::string& filepath, Stamp& stamp, bool byHash) const;
+    void store(const std::string& filepath, const Stamp& stamp, const ParseResult& result) const;
+
+    std::filesystem::path m_directory;
+    size_t m_maxEntries;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    uint64_t m_useCounter = 0;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,217 @@
+#include "plan_diff.h"
+
+#include "../utils/json_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <string_view>
+
+namespace velocitydb {
+
+namespace {
+
+/// Child lists of every operator plus the roots of every statement
+struct PlanTree {
+    std::vector<std::vector<uint32_t>> children;
+    std::vector<std::vector<uint32_t>> roots;  // indexed by statement
+
+    explicit PlanTree(const ExecutionPlan& plan) : children(plan.operators.size()), roots(plan.statements.size()) {
+        for (uint32_t i = 0; i < plan.operators.size(); ++i) {
+            const auto& op = plan.operators[i];
+            if (op.parent >= 0) {
+                children[static_cast<size_t>(op.parent)].push_back(i);
+            } else {
+                if (roots.size() <= op.statement)
+                    roots.resize(op.statement + 1);
+                roots[op.statement].push_back(i);
+            }
+        }
+    }
+};
+
+[[nodiscard]] bool sameOperator(const PlanOperator& a, const PlanOperator& b) noexcept {
+    return a.physicalOp == b.physicalOp && a.logicalOp == b.logicalOp && a.object == b.object;
+}
+
+[[nodiscard]] std::string_view changeName(PlanChange change) noexcept {
+    switch (change) {
+        case PlanChange::Unchanged:
+            return "unchanged";
+        case PlanChange::Changed:
+            return "changed";
+        case PlanChange::Added:
+            return "added";
+        case PlanChange::Removed:
+            return "removed";
+    }
+    return "unchanged";
+}
+
+/// Warnings in `of` that `other` does not have
+[[nodiscard]] std::vector<std::string> warningsMissingFrom(const std::vector<std::string>& of, const std::vector<std::string>& other) {
+    std::vector<std::string> missing;
+    for (const auto& warning : of) {
+        if (std::ranges::find(other, warning) == other.end())
+            missing.push_back(warning);
+    }
+    return missing;
+}
+
+class Aligner {
+public:
+    Aligner(const ExecutionPlan& before, const ExecutionPlan& after, PlanDiffResult& result)
+        : m_before(before), m_after(after), m_beforeTree(before), m_afterTree(after), m_result(result) {}
+
+    void statement(uint32_t index) {
+        const auto costOf = [index](const ExecutionPlan& plan) { return index < plan.statements.size() ? plan.statements[index].subtreeCost : 0.0; };
+        m_statementCost = (std::max)(costOf(m_before), costOf(m_after));
+        m_statement = index;
+        static const std::vector<uint32_t> none;
+        align(index < m_beforeTree.roots.size() ? m_beforeTree.roots[index] : none, index < m_afterTree.roots.size() ? m_afterTree.roots[index] : none);
+    }
+
+private:
+    /// Line up two sibling lists: LCS on the operator signature, then the gaps between matches in order
+    void align(const std::vector<uint32_t>& before, const std::vector<uint32_t>& after) {
+        const size_t n = before.size();
+        const size_t m = after.size();
+        std::vector<std::vector<uint32_t>> lcs(n + 1, std::vector<uint32_t>(m + 1, 0));
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = m; j-- > 0;) {
+                lcs[i][j] = sameOperator(m_before.operators[before[i]], m_after.operators[after[j]]) ? lcs[i + 1][j + 1] + 1 : (std::max)(lcs[i + 1][j], lcs[i][j + 1]);
+            }
+        }
+
+        size_t i = 0;
+        size_t j = 0;
+        size_t gapBefore = 0;
+        size_t gapAfter = 0;
+        const auto flushGap = [&](size_t endBefore, size_t endAfter) {
+            while (gapBefore < endBefore && gapAfter < endAfter) {
+                pair(before[gapBefore++], after[gapAfter++], PlanChange::Changed);
+            }
+            while (gapBefore < endBefore) {
+                one(before[gapBefore++], PlanChange::Removed);
+            }
+            while (gapAfter < endAfter) {
+                one(after[gapAfter++], PlanChange::Added);
+            }
+        };
+        while (i < n && j < m) {
+            if (sameOperator(m_before.operators[before[i]], m_after.operators[after[j]]) && lcs[i][j] == lcs[i + 1][j + 1] + 1) {
+                flushGap(i, j);
+                pair(before[i], after[j], PlanChange::Unchanged);
+                gapBefore = ++i;
+                gapAfter = ++j;
+            } else if (lcs[i + 1][j] >= lcs[i][j + 1]) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        flushGap(n, m);
+    }
+
+    void pair(uint32_t before, uint32_t after, PlanChange change) {
+        const auto& older = m_before.operators[before];
+        const auto& newer = m_after.operators[after];
+        PlanOperatorDiff diff{.change = change, .before = static_cast<int32_t>(before), .after = static_cast<int32_t>(after), .statement = m_statement};
+        if (older.estimatedRows > 0) {
+            diff.rowsRatio = newer.estimatedRows / older.estimatedRows;
+        }
+        const double lower = (std::min)(older.estimatedRows, newer.estimatedRows);
+        const double higher = (std::max)(older.estimatedRows, newer.estimatedRows);
+        // Below one row the estimates are noise (1 vs 0.3 rows is not a finding)
+        diff.estimateShift = higher >= 1.0 && higher >= lower * PlanDiff::ESTIMATE_SHIFT_RATIO;
+        diff.costDelta = newer.cost - older.cost;
+        record(diff);
+        align(m_beforeTree.children[before], m_afterTree.children[after]);
+    }
+
+    /// An operator on one side only, followed by its whole subtree
+    void one(uint32_t index, PlanChange change) {
+        const bool added = change == PlanChange::Added;
+        const auto& op = (added ? m_after : m_before).operators[index];
+        PlanOperatorDiff diff{.change = change, .statement = m_statement, .costDelta = added ? op.cost : -op.cost};
+        (added ? diff.after : diff.before) = static_cast<int32_t>(index);
+        record(diff);
+        for (const auto child : (added ? m_afterTree : m_beforeTree).children[index]) {
+            one(child, change);
+        }
+    }
+
+    void record(PlanOperatorDiff& diff) {
+        diff.costShift = m_statementCost > 0 && std::abs(diff.costDelta) >= m_statementCost * PlanDiff::COST_SHIFT_SHARE;
+        switch (diff.change) {
+            case PlanChange::Unchanged:
+                ++m_result.unchanged;
+                break;
+            case PlanChange::Changed:
+                ++m_result.changed;
+                break;
+            case PlanChange::Added:
+                ++m_result.added;
+                break;
+            case PlanChange::Removed:
+                ++m_result.removed;
+                break;
+        }
+        m_result.estimateShifts += diff.estimateShift ? 1 : 0;
+        m_result.costShifts += diff.costShift ? 1 : 0;
+        m_result.operators.push_back(diff);
+    }
+
+    const ExecutionPlan& m_before;
+    const ExecutionPlan& m_after;
+    PlanTree m_beforeTree;
+    PlanTree m_afterTree;
+    PlanDiffResult& m_result;
+    uint32_t m_statement = 0;
+    double m_statementCost = 0;
+};
+
+}  // namespace
+
+PlanDiffResult PlanDiff::compare(const ExecutionPlan& before, const ExecutionPlan& after) {
+    PlanDiffResult result;
+    Aligner aligner(before, after, result);
+    const auto statements = static_cast<uint32_t>((std::max)(before.statements.size(), after.statements.size()));
+    for (uint32_t index = 0; index < statements; ++index) {
+        static const PlanStatement none;
+        const auto& older = index < before.statements.size() ? before.statements[index] : none;
+        const auto& newer = index < after.statements.size() ? after.statements[index] : none;
+        result.statements.push_back(PlanStatementDiff{.statement = index,
+                                                      .beforeCost = older.subtreeCost,
+                                                      .afterCost = newer.subtreeCost,
+                                                      .addedWarnings = warningsMissingFrom(newer.warnings, older.warnings),
+                                                      .removedWarnings = warningsMissingFrom(older.warnings, newer.warnings)});
+        aligner.statement(index);
+    }
+    return result;
+}
+
+std::string PlanDiff::toJson(const PlanDiffResult& diff) {
+    const auto strings = [](const std::vector<std::string>& values) {
+        return JsonUtils::buildArray(values, [](std::string& out, const std::string& value) {
+            out += '"';
+            JsonUtils::appendEscaped(out, value);
+            out += '"';
+        });
+    };
+    std::string json = R"({"statements":)";
+    json += JsonUtils::buildArray(diff.statements, [&](std::string& out, const PlanStatementDiff& statement) {
+        out += std::format(R"({{"statement":{},"beforeCost":{},"afterCost":{},"addedWarnings":{},"removedWarnings":{}}})", statement.statement, statement.beforeCost, statement.afterCost,
+                           strings(statement.addedWarnings), strings(statement.removedWarnings));
+    });
+    json += R"(,"operators":)";
+    json += JsonUtils::buildArray(diff.operators, [](std::string& out, const PlanOperatorDiff& op) {
+        out += std::format(R"({{"change":"{}","before":{},"after":{},"statement":{},"rowsRatio":{},"costDelta":{},"estimateShift":{},"costShift":{}}})", changeName(op.change), op.before, op.after,
+                           op.statement, op.rowsRatio, op.costDelta, op.estimateShift ? "true" : "false", op.costShift ? "true" : "false");
+    });
+    json += std::format(R"(,"summary":{{"unchanged":{},"changed":{},"added":{},"removed":{},"estimateShifts":{},"costShifts":{}}}}})", diff.unchanged, diff.changed, diff.added, diff.removed,
+                        diff.estimateShifts, diff.costShifts);
+    return json;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "showplan_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+/// How an operator of the older plan lines up with the newer one
+enum class PlanChange : uint8_t {
+    Unchanged,  ///< Same physical and logical operator on the same object
+    Changed,    ///< Took the place of a different operator (e.g. a scan that became a seek)
+    Added,      ///< Only in the newer plan
+    Removed,    ///< Only in the older plan
+};
+
+struct PlanOperatorDiff {
+    PlanChange change = PlanChange::Unchanged;
+    int32_t before = -1;  ///< Index into the older plan's operators, -1 when added
+    int32_t after = -1;   ///< Index into the newer plan's operators, -1 when removed
+    uint32_t statement = 0;
+    double rowsRatio = 0;  ///< Newer over older estimated rows; 0 unless both sides exist and the older estimate is positive
+    double costDelta = 0;  ///< Newer minus older operator cost; a whole operator's cost when added or removed
+    bool estimateShift = false;  ///< The row estimate moved by ESTIMATE_SHIFT_RATIO or more either way
+    bool costShift = false;      ///< The cost moved by COST_SHIFT_SHARE or more of the statement's cost
+};
+
+struct PlanStatementDiff {
+    uint32_t statement = 0;
+    double beforeCost = 0;
+    double afterCost = 0;
+    std::vector<std::string> addedWarnings;
+    std::vector<std::string> removedWarnings;
+};
+
+struct PlanDiffResult {
+    std::vector<PlanStatementDiff> statements;
+    std::vector<PlanOperatorDiff> operators;  ///< Aligned tree in pre-order, statement by statement
+    size_t unchanged = 0;
+    size_t changed = 0;
+    size_t added = 0;
+    size_t removed = 0;
+    size_t estimateShifts = 0;
+    size_t costShifts = 0;
+};
+
+/// Aligns two plans of the same query, statement by statement and level by level.
+///
+/// Each operator's children are matched on (physical op, logical op, object) by longest common subsequence, so an
+/// extra Compute Scalar does not shift everything after it. The children left between two matches are paired in
+/// order as changed operators, which is how a Clustered Index Scan turning into an Index Seek shows up; whatever
+/// remains on one side is added or removed with its whole subtree.
+class PlanDiff {
+public:
+    static constexpr double ESTIMATE_SHIFT_RATIO = 2.0;
+    static constexpr double COST_SHIFT_SHARE = 0.1;
+
+    [[nodiscard]] static PlanDiffResult compare(const ExecutionPlan& before, const ExecutionPlan& after);
+
+    [[nodiscard]] static std::string toJson(const PlanDiffResult& diff);
+};
+
+}  // namespace velocitydb
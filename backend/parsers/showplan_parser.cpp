@@ -0,0 +1,299 @@
+#include "showplan_parser.h"
+
+#include "../utils/json_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include "pugixml.hpp"
+
+namespace velocitydb {
+
+namespace {
+
+double finiteAttribute(const pugi::xml_node& node, const char* name) {
+    const double value = node.attribute(name).as_double();
+    return std::isfinite(value) ? value : 0.0;
+}
+
+/// "[dbo].[Users].[PK_Users]" from the parts an <Object> carries
+std::string objectName(const pugi::xml_node& object) {
+    std::string name;
+    for (const char* part : {"Schema", "Table", "Index"}) {
+        const std::string_view value = object.attribute(part).as_string();
+        if (value.empty())
+            continue;
+        if (!name.empty())
+            name += '.';
+        name += value;
+    }
+    return name;
+}
+
+/// One line per warning: the element or flag name, then its attributes ("SpillToTempDb (SpillLevel=1)")
+void collectWarnings(const pugi::xml_node& warnings, std::vector<std::string>& out) {
+    for (auto attribute : warnings.attributes()) {
+        if (attribute.as_bool())
+            out.emplace_back(attribute.name());
+    }
+    for (auto warning : warnings.children()) {
+        std::string text = warning.name();
+        std::string details;
+        for (auto attribute : warning.attributes()) {
+            if (!details.empty())
+                details += ", ";
+            details += std::format("{}={}", attribute.name(), attribute.value());
+        }
+        // ColumnsWithNoStatistics lists its columns as children
+        for (auto column : warning.children("ColumnReference")) {
+            if (!details.empty())
+                details += ", ";
+            details += column.attribute("Column").as_string();
+        }
+        if (!details.empty())
+            text += std::format(" ({})", details);
+        out.push_back(std::move(text));
+    }
+}
+
+/// Child RelOps and the first <Object> of `relOp`, found without entering the child RelOps themselves
+void scanOperatorBody(const pugi::xml_node& relOp, std::vector<pugi::xml_node>& children, pugi::xml_node& object) {
+    std::vector<pugi::xml_node> pending;
+    for (auto child : relOp.children())
+        pending.push_back(child);
+    std::ranges::reverse(pending);
+    while (!pending.empty()) {
+        auto node = pending.back();
+        pending.pop_back();
+        const std::string_view name = node.name();
+        if (name == "RelOp") {
+            children.push_back(node);
+            continue;
+        }
+        if (name == "Object" && !object)
+            object = node;
+        if (name == "RunTimeInformation" || name == "Warnings" || name == "OutputList")
+            continue;
+        const size_t mark = pending.size();
+        for (auto child : node.children())
+            pending.push_back(child);
+        std::reverse(pending.begin() + static_cast<std::ptrdiff_t>(mark), pending.end());
+    }
+}
+
+class PlanBuilder {
+public:
+    explicit PlanBuilder(ExecutionPlan& plan) : m_plan(plan) {}
+
+    void addDocument(std::string_view xml) {
+        pugi::xml_document doc;
+        if (auto result = doc.load_buffer(xml.data(), xml.size()); !result) [[unlikely]] {
+            throw std::runtime_error(std::format("Failed to parse showplan XML: {}", result.description()));
+        }
+        auto root = doc.child("ShowPlanXML");
+        if (!root) [[unlikely]] {
+            throw std::runtime_error("Not a showplan document");
+        }
+        addStatements(root);
+    }
+
+private:
+    /// Stmt* elements can nest (StmtCond holds Then/Else statements), so walk everything but the plans themselves
+    void addStatements(const pugi::xml_node& node) {
+        for (auto child : node.children()) {
+            const std::string_view name = child.name();
+            if (name.starts_with("Stmt")) {
+                if (auto queryPlan = child.child("QueryPlan"))
+                    addStatement(child, queryPlan);
+            }
+            if (name != "QueryPlan")
+                addStatements(child);
+        }
+    }
+
+    void addStatement(const pugi::xml_node& statementNode, const pugi::xml_node& queryPlan) {
+        const auto statementIndex = static_cast<uint32_t>(m_plan.statements.size());
+        auto& statement = m_plan.statements.emplace_back();
+        statement.text = statementNode.attribute("StatementText").as_string();
+        statement.subtreeCost = finiteAttribute(statementNode, "StatementSubTreeCost");
+        if (statementNode.attribute("StatementEstRows"))
+            statement.estimatedRows = finiteAttribute(statementNode, "StatementEstRows");
+        if (auto warnings = queryPlan.child("Warnings"))
+            collectWarnings(warnings, statement.warnings);
+
+        for (auto group : queryPlan.child("MissingIndexes").children("MissingIndexGroup")) {
+            for (auto index : group.children("MissingIndex")) {
+                MissingIndex missing;
+                missing.statement = statementIndex;
+                missing.impact = finiteAttribute(group, "Impact");
+                missing.table = std::format("{}.{}.{}", index.attribute("Database").as_string(), index.attribute("Schema").as_string(), index.attribute("Table").as_string());
+                for (auto columnGroup : index.children("ColumnGroup")) {
+                    const std::string_view usage = columnGroup.attribute("Usage").as_string();
+                    auto& columns = usage == "EQUALITY" ? missing.equalityColumns : usage == "INEQUALITY" ? missing.inequalityColumns : missing.includeColumns;
+                    for (auto column : columnGroup.children("Column"))
+                        columns.emplace_back(column.attribute("Name").as_string());
+                }
+                m_plan.missingIndexes.push_back(std::move(missing));
+            }
+        }
+
+        if (auto root = queryPlan.child("RelOp"))
+            addOperators(root, statementIndex);
+    }
+
+    /// Pre-order walk with an explicit stack: plans for big queries nest deeper than is safe to recurse
+    void addOperators(const pugi::xml_node& root, uint32_t statementIndex) {
+        std::vector<std::pair<pugi::xml_node, int32_t>> pending{{root, -1}};
+        std::vector<pugi::xml_node> children;
+        while (!pending.empty()) {
+            auto [node, parent] = pending.back();
+            pending.pop_back();
+
+            const auto index = static_cast<int32_t>(m_plan.operators.size());
+            auto& op = m_plan.operators.emplace_back();
+            op.nodeId = node.attribute("NodeId").as_uint();
+            op.parent = parent;
+            op.statement = statementIndex;
+            op.physicalOp = node.attribute("PhysicalOp").as_string();
+            op.logicalOp = node.attribute("LogicalOp").as_string();
+            op.estimatedRows = finiteAttribute(node, "EstimateRows");
+            op.subtreeCost = finiteAttribute(node, "EstimatedTotalSubtreeCost");
+            op.cost = op.subtreeCost;
+            if (auto runtime = node.child("RunTimeInformation")) {
+                double rows = 0;
+                uint64_t executions = 0;
+                for (auto thread : runtime.children("RunTimeCountersPerThread")) {
+                    rows += finiteAttribute(thread, "ActualRows");
+                    executions += thread.attribute("ActualExecutions").as_ullong();
+                }
+                op.actualRows = rows;
+                op.actualExecutions = executions;
+            }
+            if (auto warnings = node.child("Warnings"))
+                collectWarnings(warnings, op.warnings);
+
+            children.clear();
+            pugi::xml_node object;
+            scanOperatorBody(node, children, object);
+            if (object)
+                op.object = objectName(object);
+            if (parent >= 0) {
+                auto& parentCost = m_plan.operators[static_cast<size_t>(parent)].cost;
+                parentCost = (std::max)(0.0, parentCost - op.subtreeCost);
+            }
+            for (auto it = children.rbegin(); it != children.rend(); ++it)
+                pending.emplace_back(*it, index);
+        }
+    }
+
+    ExecutionPlan& m_plan;
+};
+
+void appendStringArray(std::string& json, const std::vector<std::string>& values) {
+    json += '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0)
+            json += ',';
+        json += '"';
+        JsonUtils::appendEscaped(json, values[i]);
+        json += '"';
+    }
+    json += ']';
+}
+
+}  // namespace
+
+ExecutionPlan ShowplanParser::parse(std::span<const std::string_view> documents, size_t hotspotCount) {
+    ExecutionPlan plan;
+    PlanBuilder builder(plan);
+    for (auto document : documents) {
+        builder.addDocument(document);
+    }
+
+    std::vector<uint32_t> ranked;
+    ranked.reserve(plan.operators.size());
+    for (uint32_t i = 0; i < plan.operators.size(); ++i) {
+        if (plan.operators[i].cost > 0)
+            ranked.push_back(i);
+    }
+    const auto count = (std::min)(hotspotCount, ranked.size());
+    std::ranges::partial_sort(ranked, ranked.begin() + static_cast<std::ptrdiff_t>(count), [&](uint32_t a, uint32_t b) { return plan.operators[a].cost > plan.operators[b].cost; });
+    ranked.resize(count);
+    plan.hotspots = std::move(ranked);
+    return plan;
+}
+
+ExecutionPlan ShowplanParser::parse(std::string_view document, size_t hotspotCount) {
+    return parse(std::span<const std::string_view>(&document, 1), hotspotCount);
+}
+
+std::string ShowplanParser::toJson(const ExecutionPlan& plan) {
+    std::string json = R"({"statements":[)";
+    for (size_t i = 0; i < plan.statements.size(); ++i) {
+        const auto& statement = plan.statements[i];
+        if (i > 0)
+            json += ',';
+        json += R"({"text":")";
+        JsonUtils::appendEscaped(json, statement.text);
+        json += std::format(R"(","cost":{},"warnings":)", statement.subtreeCost);
+        appendStringArray(json, statement.warnings);
+        json += '}';
+    }
+
+    // Optional fields are left out rather than written as null: a large plan has thousands of operators
+    json += R"(],"operators":[)";
+    for (size_t i = 0; i < plan.operators.size(); ++i) {
+        const auto& op = plan.operators[i];
+        if (i > 0)
+            json += ',';
+        json += std::format(R"({{"id":{},"parent":{},"statement":{},"physicalOp":")", op.nodeId, op.parent, op.statement);
+        JsonUtils::appendEscaped(json, op.physicalOp);
+        json += R"(","logicalOp":")";
+        JsonUtils::appendEscaped(json, op.logicalOp);
+        json += '"';
+        if (!op.object.empty()) {
+            json += R"(,"object":")";
+            JsonUtils::appendEscaped(json, op.object);
+            json += '"';
+        }
+        json += std::format(R"(,"estimatedRows":{},"subtreeCost":{},"cost":{})", op.estimatedRows, op.subtreeCost, op.cost);
+        if (op.actualRows) {
+            json += std::format(R"(,"actualRows":{},"actualExecutions":{})", *op.actualRows, op.actualExecutions.value_or(0));
+        }
+        if (!op.warnings.empty()) {
+            json += R"(,"warnings":)";
+            appendStringArray(json, op.warnings);
+        }
+        json += '}';
+    }
+
+    json += R"(],"missingIndexes":[)";
+    for (size_t i = 0; i < plan.missingIndexes.size(); ++i) {
+        const auto& index = plan.missingIndexes[i];
+        if (i > 0)
+            json += ',';
+        json += std::format(R"({{"statement":{},"impact":{},"table":")", index.statement, index.impact);
+        JsonUtils::appendEscaped(json, index.table);
+        json += R"(","equality":)";
+        appendStringArray(json, index.equalityColumns);
+        json += R"(,"inequality":)";
+        appendStringArray(json, index.inequalityColumns);
+        json += R"(,"include":)";
+        appendStringArray(json, index.includeColumns);
+        json += '}';
+    }
+
+    json += R"(],"hotspots":[)";
+    for (size_t i = 0; i < plan.hotspots.size(); ++i) {
+        if (i > 0)
+            json += ',';
+        json += std::to_string(plan.hotspots[i]);
+    }
+    json += "]}";
+    return json;
+}
+
+}  // namespace velocitydb
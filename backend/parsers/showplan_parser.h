@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// One RelOp of a showplan, flattened in pre-order
+struct PlanOperator {
+    uint32_t nodeId = 0;
+    int32_t parent = -1;  ///< Index into ExecutionPlan::operators, -1 for a statement's root
+    uint32_t statement = 0;
+    std::string physicalOp;
+    std::string logicalOp;
+    std::string object;  ///< [schema].[table].[index] the operator reads, if any
+    double estimatedRows = 0;
+    std::optional<double> actualRows;  ///< Summed over threads; only in actual plans
+    std::optional<uint64_t> actualExecutions;
+    double subtreeCost = 0;  ///< EstimatedTotalSubtreeCost
+    double cost = 0;         ///< subtreeCost minus the children's, as SSMS shows it
+    std::vector<std::string> warnings;
+};
+
+struct PlanStatement {
+    std::string text;
+    double subtreeCost = 0;
+    std::optional<double> estimatedRows;  ///< StatementEstRows; absent when the plan does not carry one
+    std::vector<std::string> warnings;  ///< Plan-level warnings (implicit conversions, missing statistics, ...)
+};
+
+struct MissingIndex {
+    uint32_t statement = 0;
+    double impact = 0;  ///< Estimated improvement in percent
+    std::string table;  ///< [db].[schema].[table]
+    std::vector<std::string> equalityColumns;
+    std::vector<std::string> inequalityColumns;
+    std::vector<std::string> includeColumns;
+};
+
+/// Compact operator tree of one or more showplan documents
+struct ExecutionPlan {
+    std::vector<PlanStatement> statements;
+    std::vector<PlanOperator> operators;
+    std::vector<MissingIndex> missingIndexes;
+    std::vector<uint32_t> hotspots;  ///< Indices into operators, costliest first
+};
+
+/// Reads SQL Server showplan XML (SET SHOWPLAN_XML / SET STATISTICS XML) into an ExecutionPlan, keeping only
+/// what a plan view renders so the frontend never sees the XML
+class ShowplanParser {
+public:
+    static constexpr size_t DEFAULT_HOTSPOTS = 5;
+
+    /// Parse the documents of one request (STATISTICS XML returns one per statement) into a single plan
+    /// @throws std::runtime_error on malformed XML or a document that is not a showplan
+    [[nodiscard]] static ExecutionPlan parse(std::span<const std::string_view> documents, size_t hotspotCount = DEFAULT_HOTSPOTS);
+    [[nodiscard]] static ExecutionPlan parse(std::string_view document, size_t hotspotCount = DEFAULT_HOTSPOTS);
+
+    [[nodiscard]] static std::string toJson(const ExecutionPlan& plan);
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,437 @@
+#include "sql_completer.h"
+
+#include "sql_formatter.h"
+#include "sql_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <unordered_set>
+
+namespace velocitydb {
+
+namespace {
+
+/// Offered in Keyword context: what starts a statement, then what follows a table reference
+constexpr auto KEYWORDS = std::to_array<std::string_view>({"SELECT", "INSERT", "UPDATE", "DELETE", "MERGE", "WITH",  "EXEC",  "DECLARE", "SET",    "IF",     "BEGIN",     "CREATE",
+                                                           "ALTER",  "DROP",   "TRUNCATE", "USE",  "PRINT", "WHERE", "INNER", "LEFT",    "RIGHT",  "FULL",   "CROSS",     "OUTER",
+                                                           "JOIN",   "ON",     "AS",       "GROUP", "ORDER", "HAVING", "UNION", "EXCEPT", "INTERSECT", "OPTION"});
+
+/// Keywords a backwards scan stops at to decide what the cursor is in
+constexpr auto CLAUSES = std::to_array<std::string_view>(
+    {"SELECT", "FROM", "JOIN", "APPLY", "WHERE", "ON", "BY", "HAVING", "SET", "INTO", "UPDATE", "VALUES", "DELETE", "EXEC", "EXECUTE", "TABLE", "WHEN"});
+
+/// Keywords after which a table name follows
+constexpr auto TABLE_INTRODUCERS = std::to_array<std::string_view>({"FROM", "JOIN", "UPDATE", "INTO", "TABLE"});
+
+/// Keywords that end a FROM list
+constexpr auto FROM_ENDS = std::to_array<std::string_view>({"WHERE", "GROUP", "ORDER", "HAVING", "UNION", "EXCEPT", "INTERSECT", "SELECT", "SET", "OPTION", "FOR"});
+
+[[nodiscard]] bool isSymbol(SqlTokens tokens, const SqlToken& token, char symbol) noexcept {
+    return token.kind == SqlTokenKind::Symbol && token.length == 1 && tokens.sql[token.offset] == symbol;
+}
+
+/// Word that is not a variable, or a quoted identifier
+[[nodiscard]] bool isName(SqlTokens tokens, const SqlToken& token) noexcept {
+    return token.kind == SqlTokenKind::QuotedIdentifier || (token.kind == SqlTokenKind::Word && tokens.sql[token.offset] != '@');
+}
+
+template <size_t N>
+[[nodiscard]] std::optional<std::string_view> keywordIn(SqlTokens tokens, const SqlToken& token, const std::array<std::string_view, N>& keywords) noexcept {
+    for (const auto keyword : keywords) {
+        if (tokens.isKeyword(token, keyword)) {
+            return keyword;
+        }
+    }
+    return std::nullopt;
+}
+
+/// A quote-delimited token is closed when its quote count is even (doubled quotes escape)
+[[nodiscard]] bool isClosedString(std::string_view text) noexcept {
+    return text.size() >= 2 && std::ranges::count(text, '\'') % 2 == 0;
+}
+
+[[nodiscard]] bool equalsFolded(std::string_view a, std::string_view b) noexcept {
+    return a.size() == b.size() && SqlCompleter::fold(a) == SqlCompleter::fold(b);
+}
+
+/// Table references of the statement `code` (comment-free tokens): FROM lists, JOINs, UPDATE, INSERT INTO
+[[nodiscard]] std::vector<TableReference> tableReferences(SqlTokens tokens, const std::vector<SqlToken>& code) {
+    std::vector<TableReference> references;
+    const auto read = [&](size_t at, bool columnList) {
+        std::vector<std::string_view> parts;
+        while (at < code.size() && isName(tokens, code[at])) {
+            parts.push_back(tokens.name(code[at]));
+            if (at + 2 < code.size() && isSymbol(tokens, code[at + 1], '.') && isName(tokens, code[at + 2])) {
+                at += 2;
+                continue;
+            }
+            ++at;
+            break;
+        }
+        // A subquery, a table variable, or a table-valued function whose columns the index does not know
+        if (parts.empty() || (!columnList && at < code.size() && isSymbol(tokens, code[at], '('))) {
+            return;
+        }
+        TableReference reference;
+        reference.table = parts.back();
+        if (parts.size() >= 2) {
+            reference.schema = parts[parts.size() - 2];
+        }
+        if (at < code.size() && tokens.isKeyword(code[at], "AS")) {
+            ++at;
+        }
+        if (at < code.size() && isName(tokens, code[at]) && (code[at].kind == SqlTokenKind::QuotedIdentifier || !SQLFormatter::isBuiltInKeyword(tokens.text(code[at])))) {
+            reference.alias = tokens.name(code[at]);
+        }
+        references.push_back(std::move(reference));
+    };
+
+    int depth = 0;
+    std::optional<int> fromDepth;  ///< Depth of the FROM list being read
+    for (size_t i = 0; i < code.size(); ++i) {
+        const auto& token = code[i];
+        if (isSymbol(tokens, token, '(')) {
+            ++depth;
+        } else if (isSymbol(tokens, token, ')')) {
+            --depth;
+            if (fromDepth && depth < *fromDepth) {
+                fromDepth.reset();
+            }
+        } else if (isSymbol(tokens, token, ',')) {
+            if (fromDepth == depth) {
+                read(i + 1, false);
+            }
+        } else if (auto introducer = keywordIn(tokens, token, TABLE_INTRODUCERS)) {
+            read(i + 1, *introducer == "INTO");
+            if (*introducer == "FROM") {
+                fromDepth = depth;
+            }
+        } else if (fromDepth == depth && keywordIn(tokens, token, FROM_ENDS)) {
+            fromDepth.reset();
+        }
+    }
+    return references;
+}
+
+}  // namespace
+
+std::string SqlCompleter::fold(std::string_view label) {
+    std::string folded(label);
+    for (auto& c : folded) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return folded;
+}
+
+std::string_view SqlCompleter::kindName(CompletionKind kind) noexcept {
+    switch (kind) {
+        case CompletionKind::Keyword:
+            return "keyword";
+        case CompletionKind::Table:
+            return "table";
+        case CompletionKind::View:
+            return "view";
+        case CompletionKind::Column:
+            return "column";
+        case CompletionKind::Alias:
+            return "alias";
+        case CompletionKind::Procedure:
+            return "procedure";
+    }
+    return "keyword";
+}
+
+std::string_view SqlCompleter::contextName(CompletionContext context) noexcept {
+    switch (context) {
+        case CompletionContext::None:
+            return "none";
+        case CompletionContext::Keyword:
+            return "keyword";
+        case CompletionContext::Table:
+            return "table";
+        case CompletionContext::Column:
+            return "column";
+        case CompletionContext::Member:
+            return "member";
+        case CompletionContext::Procedure:
+            return "procedure";
+    }
+    return "none";
+}
+
+size_t SqlCompleter::offsetOf(std::string_view sql, size_t line, size_t column) noexcept {
+    size_t pos = 0;
+    for (size_t current = 1; current < line; ++current) {
+        const auto newline = sql.find('\n', pos);
+        if (newline == std::string_view::npos) {
+            return sql.size();
+        }
+        pos = newline + 1;
+    }
+    // A code point of 4 UTF-8 bytes is a surrogate pair: 2 UTF-16 units
+    for (size_t units = column > 0 ? column - 1 : 0; units > 0 && pos < sql.size() && sql[pos] != '\n' && sql[pos] != '\r';) {
+        const auto lead = static_cast<unsigned char>(sql[pos]);
+        const size_t bytes = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        const size_t width = bytes == 4 ? 2 : 1;
+        if (width > units) {
+            break;
+        }
+        units -= width;
+        pos = (std::min)(pos + bytes, sql.size());
+    }
+    return pos;
+}
+
+CompletionScope SqlCompleter::analyze(std::string_view sql, size_t offset) {
+    CompletionScope scope;
+    offset = (std::min)(offset, sql.size());
+    const SqlTokenStream stream(sql);
+    const auto all = stream.view();
+    const auto& tokens = all.tokens;
+
+    // Tokens [0, before) end before the word under the cursor
+    auto before = static_cast<size_t>(std::ranges::lower_bound(tokens, offset, {}, [](const SqlToken& token) { return static_cast<size_t>(token.end()); }) - tokens.begin());
+    if (before < tokens.size() && tokens[before].offset < offset) {
+        const auto& token = tokens[before];
+        const auto text = all.text(token);
+        switch (token.kind) {
+            case SqlTokenKind::LineComment:
+            case SqlTokenKind::Number:
+                return scope;
+            case SqlTokenKind::BlockComment:
+                if (offset < token.end() || !text.ends_with("*/") || text.size() < 4) {
+                    return scope;
+                }
+                ++before;
+                break;
+            case SqlTokenKind::String:
+                if (offset < token.end() || !isClosedString(text.substr(text.find('\'')))) {
+                    return scope;
+                }
+                ++before;
+                break;
+            case SqlTokenKind::QuotedIdentifier:
+                if (offset == token.end() && all.name(token).size() + 2 == text.size()) {
+                    ++before;  // Right after the closing delimiter
+                    break;
+                }
+                scope.prefix = text.substr(1, offset - token.offset - 1);
+                break;
+            case SqlTokenKind::Word:
+                if (text.front() == '@') {
+                    return scope;
+                }
+                scope.prefix = text.substr(0, offset - token.offset);
+                break;
+            case SqlTokenKind::Symbol:
+                ++before;
+                break;
+        }
+    }
+
+    // The last code token before the cursor, and the statement it belongs to
+    std::optional<size_t> previous;
+    for (size_t i = before; i-- > 0;) {
+        if (!tokens[i].isComment()) {
+            previous = i;
+            break;
+        }
+    }
+    const auto spans = SQLParser::splitScript(all);
+    const SqlStatementSpan* statement = nullptr;
+    const size_t anchor = previous.value_or(before);
+    for (const auto& span : spans) {
+        if (span.firstToken <= anchor && anchor < span.firstToken + span.tokenCount) {
+            statement = &span;
+            break;
+        }
+    }
+    if (statement == nullptr) {
+        // After a ';' or GO: the cursor starts a statement (which may continue past it)
+        for (const auto& span : spans) {
+            if (span.firstToken == before) {
+                statement = &span;
+                break;
+            }
+        }
+        previous.reset();
+    }
+
+    std::vector<SqlToken> code;
+    if (statement != nullptr) {
+        for (size_t i = statement->firstToken; i < statement->firstToken + statement->tokenCount; ++i) {
+            if (!tokens[i].isComment()) {
+                code.push_back(tokens[i]);
+            }
+        }
+        scope.tables = tableReferences(all, code);
+    }
+    if (!previous || *previous < statement->firstToken) {
+        scope.context = CompletionContext::Keyword;
+        return scope;
+    }
+
+    const auto& last = tokens[*previous];
+    const auto first = statement->firstToken;
+    if (isSymbol(all, last, '.')) {
+        // "qualifier." or "schema.qualifier."; tokens are contiguous within a qualified name
+        const auto at = *previous;
+        if (at == first || !isName(all, tokens[at - 1])) {
+            return scope;
+        }
+        scope.context = CompletionContext::Member;
+        scope.qualifier = all.name(tokens[at - 1]);
+        if (at - 1 >= first + 2 && isSymbol(all, tokens[at - 2], '.') && isName(all, tokens[at - 3])) {
+            scope.qualifierSchema = all.name(tokens[at - 3]);
+        }
+        return scope;
+    }
+    if (all.isKeyword(last, "AS")) {
+        return scope;  // An alias being declared
+    }
+
+    // Nearest clause keyword outside parentheses the cursor is not in
+    std::optional<std::string_view> clause;
+    size_t clauseAt = 0;
+    bool insideParentheses = false;
+    int depth = 0;
+    for (size_t i = *previous + 1; i-- > first;) {
+        const auto& token = tokens[i];
+        if (isSymbol(all, token, ')')) {
+            ++depth;
+        } else if (isSymbol(all, token, '(')) {
+            if (depth > 0) {
+                --depth;
+            } else {
+                insideParentheses = true;
+            }
+        } else if (depth == 0) {
+            if ((clause = keywordIn(all, token, CLAUSES))) {
+                clauseAt = i;
+                break;
+            }
+        }
+    }
+
+    if (!clause) {
+        scope.context = CompletionContext::Keyword;
+    } else if (*clause == "EXEC" || *clause == "EXECUTE") {
+        scope.context = clauseAt == *previous ? CompletionContext::Procedure : CompletionContext::None;
+    } else if (*clause == "INTO" && insideParentheses) {
+        scope.context = CompletionContext::Column;  // INSERT INTO t (column list
+    } else if (keywordIn(all, tokens[clauseAt], TABLE_INTRODUCERS) || *clause == "APPLY" || *clause == "DELETE") {
+        const bool expectsTable = clauseAt == *previous || (*clause == "FROM" && isSymbol(all, last, ','));
+        scope.context = expectsTable ? CompletionContext::Table : CompletionContext::Keyword;
+    } else {
+        scope.context = CompletionContext::Column;
+    }
+    return scope;
+}
+
+std::vector<Completion> SqlCompleter::candidates(const CompletionScope& scope, const ObjectNameIndex& names) {
+    std::vector<Completion> completions;
+    const auto prefix = fold(scope.prefix);
+    std::unordered_set<std::string> seen;
+    const auto add = [&](std::string_view label, CompletionKind kind, std::string detail, bool inScope) {
+        auto folded = fold(label);
+        if (folded.starts_with(prefix) && seen.insert(std::move(folded)).second) {
+            completions.push_back(Completion{.label = std::string(label), .kind = kind, .detail = std::move(detail), .inScope = inScope});
+        }
+    };
+    const auto addColumns = [&](std::string_view schema, std::string_view table, bool inScope) {
+        // An unqualified name resolves to dbo first, like a default schema would
+        auto columns = names.childrenOf(schema.empty() ? "dbo" : schema, table, ObjectKind::Column);
+        if (columns.empty() && schema.empty()) {
+            columns = names.childrenOf({}, table, ObjectKind::Column);
+        }
+        for (const auto* column : columns) {
+            add(column->name, CompletionKind::Column, column->schema + "." + column->parent, inScope);
+        }
+    };
+    const auto addTables = [&](std::string_view schema) {
+        for (const auto kind : {ObjectKind::Table, ObjectKind::View}) {
+            for (const auto* name : names.withPrefix(kind, prefix, MAX_CANDIDATES)) {
+                if (schema.empty() || equalsFolded(name->schema, schema)) {
+                    add(name->name, kind == ObjectKind::View ? CompletionKind::View : CompletionKind::Table, name->schema, false);
+                }
+            }
+        }
+    };
+
+    switch (scope.context) {
+        case CompletionContext::None:
+            break;
+        case CompletionContext::Keyword:
+            for (const auto keyword : KEYWORDS) {
+                add(keyword, CompletionKind::Keyword, {}, false);
+            }
+            break;
+        case CompletionContext::Table:
+            addTables({});
+            break;
+        case CompletionContext::Procedure:
+            for (const auto* name : names.withPrefix(ObjectKind::Procedure, prefix, MAX_CANDIDATES)) {
+                add(name->name, CompletionKind::Procedure, name->schema, false);
+            }
+            break;
+        case CompletionContext::Member: {
+            const auto reference = std::ranges::find_if(scope.tables, [&](const TableReference& table) {
+                return scope.qualifierSchema.empty() ? equalsFolded(table.alias, scope.qualifier) || (table.alias.empty() && equalsFolded(table.table, scope.qualifier))
+                                                     : equalsFolded(table.table, scope.qualifier) && equalsFolded(table.schema, scope.qualifierSchema);
+            });
+            if (reference != scope.tables.end()) {
+                addColumns(reference->schema, reference->table, true);
+            } else {
+                addColumns(scope.qualifierSchema, scope.qualifier, true);
+            }
+            if (scope.qualifierSchema.empty()) {
+                addTables(scope.qualifier);  // "schema."
+            }
+            break;
+        }
+        case CompletionContext::Column:
+            for (const auto& table : scope.tables) {
+                addColumns(table.schema, table.table, true);
+            }
+            for (const auto& table : scope.tables) {
+                if (table.alias.empty()) {
+                    add(table.table, CompletionKind::Table, table.schema, true);
+                } else {
+                    add(table.alias, CompletionKind::Alias, table.schema.empty() ? table.table : table.schema + "." + table.table, true);
+                }
+            }
+            if (scope.tables.empty()) {
+                for (const auto* column : names.withPrefix(ObjectKind::Column, prefix, MAX_CANDIDATES, true)) {
+                    add(column->name, CompletionKind::Column, column->schema + "." + column->parent, false);
+                }
+            }
+            break;
+    }
+    return completions;
+}
+
+void SqlCompleter::rank(std::vector<Completion>& completions, size_t limit) {
+    const auto better = [](const Completion& a, const Completion& b) {
+        if (a.inScope != b.inScope) {
+            return a.inScope;
+        }
+        if (a.uses != b.uses) {
+            return a.uses > b.uses;
+        }
+        if (a.label.size() != b.label.size()) {
+            return a.label.size() < b.label.size();
+        }
+        return fold(a.label) < fold(b.label);
+    };
+    if (completions.size() > limit) {
+        std::ranges::partial_sort(completions, completions.begin() + static_cast<std::ptrdiff_t>(limit), better);
+        completions.resize(limit);
+    } else {
+        std::ranges::sort(completions, better);
+    }
+}
+
+}  // namespace velocitydb
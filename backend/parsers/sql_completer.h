@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../utils/object_name_index.h"
+#include "sql_lexer.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// What the word under the cursor names, judged from the tokens before it
+enum class CompletionContext : uint8_t {
+    None,       ///< Inside a string or comment, a variable, or an alias being declared
+    Keyword,    ///< Start of a statement, or after a table reference
+    Table,      ///< After FROM, JOIN, INTO, UPDATE, ...
+    Column,     ///< Select list, WHERE, ON, GROUP / ORDER BY, SET, ...
+    Member,     ///< After "qualifier." : the columns of that alias or table, or the tables of that schema
+    Procedure,  ///< After EXEC
+};
+
+/// A table the statement reads or writes, as written in its FROM / JOIN / INTO / UPDATE clause
+struct TableReference {
+    std::string schema;  ///< Empty when not qualified
+    std::string table;
+    std::string alias;   ///< Empty when none
+};
+
+struct CompletionScope {
+    CompletionContext context = CompletionContext::None;
+    std::string prefix;           ///< Part of the word before the cursor, without an opening [ or "
+    std::string qualifier;        ///< Member: the name before the '.'
+    std::string qualifierSchema;  ///< Member: the name before that, for "schema.table."
+    std::vector<TableReference> tables;  ///< Of the statement holding the cursor, in text order
+};
+
+enum class CompletionKind : uint8_t { Keyword, Table, View, Column, Alias, Procedure };
+
+struct Completion {
+    std::string label;
+    CompletionKind kind = CompletionKind::Keyword;
+    std::string detail;  ///< "schema.table" owning a column, the schema of a table or procedure
+    bool inScope = false;  ///< Belongs to a table the statement references
+    size_t uses = 0;       ///< History items using the label; filled by the caller before rank()
+};
+
+/// Context-aware completion over a connection's ObjectNameIndex.
+///
+/// analyze() lexes the script once with the shared lexer, finds the statement holding the cursor (as
+/// SQLParser::splitScript splits it) and reads the context from the tokens before the cursor and the table
+/// references of the whole statement, so aliases declared after the cursor ("SELECT u.| FROM Users u") resolve.
+/// candidates() draws from the index only: a table's columns by parent, other names by prefix, each kind capped at
+/// MAX_CANDIDATES so short prefixes on large schemas stay cheap. rank() orders what the caller kept.
+class SqlCompleter {
+public:
+    /// Names drawn per kind from a prefix walk of the index
+    static constexpr size_t MAX_CANDIDATES = 2000;
+
+    /// Context at byte `offset` of `sql`
+    [[nodiscard]] static CompletionScope analyze(std::string_view sql, size_t offset);
+
+    /// Byte offset of 1-based `line` and `column`, the column counted in UTF-16 code units as editors report it;
+    /// clamped to the line's end and the text's end
+    [[nodiscard]] static size_t offsetOf(std::string_view sql, size_t line, size_t column) noexcept;
+
+    /// Unranked completions of `scope.prefix`, case-insensitively, without duplicate labels
+    [[nodiscard]] static std::vector<Completion> candidates(const CompletionScope& scope, const ObjectNameIndex& names);
+
+    /// Order by scope, then uses, then shorter and alphabetically earlier labels; keep the first `limit`
+    static void rank(std::vector<Completion>& completions, size_t limit);
+
+    /// Case-folded label for history lookups
+    [[nodiscard]] static std::string fold(std::string_view label);
+
+    [[nodiscard]] static std::string_view kindName(CompletionKind kind) noexcept;
+    [[nodiscard]] static std::string_view contextName(CompletionContext context) noexcept;
+};
+
+}  // namespace velocitydb
@@ -1,150 +1,303 @@
 #include "sql_formatter.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
-#include <ranges>
-#include <sstream>
-#include <unordered_set>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace velocitydb {
 
 namespace {
 
-enum class TokenType { Keyword, Identifier, Operator, Comma, OpenParen, CloseParen, Semicolon, String, Number };
-
-struct Token {
-    TokenType type;
-    std::string value;
-    std::string upperValue;
-};
+enum class TokenType { Keyword, Identifier, Operator, Comma, OpenParen, CloseParen, Semicolon, String, Number, Comment, LineComment };
+
+// Keyword category flags (SQLFormatter::keywordFlags); 0 = not a keyword
+constexpr uint8_t KEYWORD = 1;
+constexpr uint8_t MAJOR_CLAUSE = 2;
+constexpr uint8_t JOIN_KEYWORD = 4;
+
+/// Words longer than this are never looked up as keywords
+constexpr size_t MAX_KEYWORD_LENGTH = 32;
+
+constexpr std::array<std::string_view, 87> DEFAULT_KEYWORDS{
+    "SELECT",     "FROM",   "WHERE",      "AND",          "OR",     "NOT",     "IN",         "EXISTS",     "JOIN",      "INNER",     "LEFT",   "RIGHT",    "OUTER",
+    "FULL",       "CROSS",  "ON",         "GROUP",        "BY",     "HAVING",  "ORDER",      "ASC",        "DESC",      "NULLS",     "FIRST",  "LAST",     "INSERT",
+    "INTO",       "VALUES", "UPDATE",     "SET",          "DELETE", "CREATE",  "TABLE",      "INDEX",      "VIEW",      "DROP",      "ALTER",  "ADD",      "COLUMN",
+    "PRIMARY",    "KEY",    "FOREIGN",    "UNIQUE",       "CHECK",  "DEFAULT", "NULL",       "AS",         "DISTINCT",  "TOP",       "LIMIT",  "OFFSET",   "FETCH",
+    "NEXT",       "ROWS",   "ONLY",       "UNION",        "ALL",    "CASE",    "WHEN",       "THEN",       "ELSE",      "END",       "LIKE",   "BETWEEN",  "IS",
+    "COUNT",      "SUM",    "AVG",        "MIN",          "MAX",    "OVER",    "PARTITION",  "WITH",       "RECURSIVE", "INTERSECT", "EXCEPT", "COALESCE", "CAST",
+    "ROW_NUMBER", "RANK",   "DENSE_RANK", "PERCENT_RANK", "LAG",    "LEAD",    "STRING_AGG", "DATE_TRUNC", "ROUND"};
+constexpr std::array<std::string_view, 9> MAJOR_CLAUSES{"SELECT", "FROM", "WHERE", "GROUP", "HAVING", "ORDER", "UNION", "INTERSECT", "EXCEPT"};
+constexpr std::array<std::string_view, 7> JOIN_KEYWORDS{"JOIN", "INNER", "LEFT", "RIGHT", "FULL", "CROSS", "OUTER"};
+
+constexpr char toUpperAscii(char c) noexcept {
+    return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
 
-class Tokenizer {
-public:
-    explicit Tokenizer(std::string_view sql, const std::unordered_set<std::string>& keywords) : m_sql(sql), m_keywords(keywords), m_pos(0) {}
+constexpr char toLowerAscii(char c) noexcept {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
 
-    std::vector<Token> tokenize() {
-        std::vector<Token> tokens;
-        while (m_pos < m_sql.length()) {
-            skipWhitespace();
-            if (m_pos >= m_sql.length())
-                break;
+/// Flags of an upper-case keyword, from the fixed clause and join categories
+constexpr uint8_t categoryFlags(std::string_view upper) noexcept {
+    uint8_t flags = KEYWORD;
+    if (std::ranges::find(MAJOR_CLAUSES, upper) != MAJOR_CLAUSES.end())
+        flags |= MAJOR_CLAUSE;
+    if (std::ranges::find(JOIN_KEYWORDS, upper) != JOIN_KEYWORDS.end())
+        flags |= JOIN_KEYWORD;
+    return flags;
+}
 
-            char c = m_sql[m_pos];
+/// FNV-1a over the bytes of an upper-case word, perturbed by `seed`
+constexpr uint32_t keywordHash(std::string_view upper, uint32_t seed) noexcept {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : upper) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
 
-            if (c == '\'' || c == '"') {
-                tokens.push_back(readString());
-            } else if (c == '(') {
-                tokens.push_back({TokenType::OpenParen, "(", "("});
-                ++m_pos;
-            } else if (c == ')') {
-                tokens.push_back({TokenType::CloseParen, ")", ")"});
-                ++m_pos;
-            } else if (c == ',') {
-                tokens.push_back({TokenType::Comma, ",", ","});
-                ++m_pos;
-            } else if (c == ';') {
-                tokens.push_back({TokenType::Semicolon, ";", ";"});
-                ++m_pos;
-            } else if (isOperatorChar(c)) {
-                tokens.push_back(readOperator());
-            } else if (std::isdigit(static_cast<unsigned char>(c))) {
-                tokens.push_back(readNumber());
-            } else {
-                tokens.push_back(readWord());
+/// Perfect hash of DEFAULT_KEYWORDS built at compile time: the constructor searches for a seed under which
+/// every keyword gets its own slot, so a lookup is one hash and one comparison.
+class DefaultKeywordTable {
+public:
+    static constexpr size_t SLOTS = 1024;
+    static_assert(DEFAULT_KEYWORDS.size() < 255, "slot indices are stored as uint8_t");
+
+    consteval DefaultKeywordTable() {
+        for (uint32_t seed = 0; seed < 100000; ++seed) {
+            if (tryBuild(seed)) {
+                m_seed = seed;
+                return;
             }
         }
-        return tokens;
+        throw std::logic_error("No collision-free seed for the keyword table");  // Not a constant expression: fails the build
     }
 
-private:
-    std::string_view m_sql;
-    const std::unordered_set<std::string>& m_keywords;
-    size_t m_pos;
+    [[nodiscard]] constexpr uint8_t flags(std::string_view upper) const noexcept {
+        const uint8_t slot = m_slots[keywordHash(upper, m_seed) & (SLOTS - 1)];
+        return slot != 0 && DEFAULT_KEYWORDS[slot - 1] == upper ? m_flags[slot - 1] : 0;
+    }
 
-    void skipWhitespace() {
-        while (m_pos < m_sql.length() && std::isspace(static_cast<unsigned char>(m_sql[m_pos]))) {
-            ++m_pos;
+private:
+    constexpr bool tryBuild(uint32_t seed) {
+        m_slots.fill(0);
+        for (size_t i = 0; i < DEFAULT_KEYWORDS.size(); ++i) {
+            auto& slot = m_slots[keywordHash(DEFAULT_KEYWORDS[i], seed) & (SLOTS - 1)];
+            if (slot != 0)
+                return false;
+            slot = static_cast<uint8_t>(i + 1);
+            m_flags[i] = categoryFlags(DEFAULT_KEYWORDS[i]);
         }
+        return true;
     }
 
-    Token readString() {
-        char quote = m_sql[m_pos];
-        std::string value;
-        value += quote;
-        ++m_pos;
+    std::array<uint8_t, SLOTS> m_slots{};  ///< 1-based index into DEFAULT_KEYWORDS, 0 = empty
+    std::array<uint8_t, DEFAULT_KEYWORDS.size()> m_flags{};
+    uint32_t m_seed = 0;
+};
 
-        while (m_pos < m_sql.length()) {
-            char c = m_sql[m_pos];
-            value += c;
-            ++m_pos;
+constexpr DefaultKeywordTable DEFAULT_KEYWORD_TABLE;
+static_assert(DEFAULT_KEYWORD_TABLE.flags("SELECT") == (KEYWORD | MAJOR_CLAUSE));
+static_assert(DEFAULT_KEYWORD_TABLE.flags("OUTER") == (KEYWORD | JOIN_KEYWORD));
+static_assert(DEFAULT_KEYWORD_TABLE.flags("ROUND") == KEYWORD);
+static_assert(DEFAULT_KEYWORD_TABLE.flags("USERS") == 0);
 
-            if (c == quote) {
-                if (m_pos < m_sql.length() && m_sql[m_pos] == quote) {
-                    value += quote;
-                    ++m_pos;
-                } else {
-                    break;
-                }
-            }
-        }
+/// A token as an offset/length span of the input; its text is never copied
+struct Token {
+    TokenType type;
+    uint8_t keyword;  ///< Keyword category flags, 0 for everything but keywords
+    uint32_t offset;
+    uint32_t length;
+};
 
-        return {TokenType::String, value, value};
+void appendKeyword(std::string& out, std::string_view word, KeywordCase keywordCase) {
+    switch (keywordCase) {
+        case KeywordCase::Upper:
+            std::ranges::transform(word, std::back_inserter(out), toUpperAscii);
+            break;
+        case KeywordCase::Lower:
+            std::ranges::transform(word, std::back_inserter(out), toLowerAscii);
+            break;
+        case KeywordCase::Unchanged:
+            out += word;
+            break;
     }
+}
 
-    Token readNumber() {
-        std::string value;
-        while (m_pos < m_sql.length() && (std::isdigit(static_cast<unsigned char>(m_sql[m_pos])) || m_sql[m_pos] == '.')) {
-            value += m_sql[m_pos];
-            ++m_pos;
-        }
-        return {TokenType::Number, value, value};
+/// Line comments go out as block comments, since formatting may put more code on the same line; one that
+/// cannot (it contains */) keeps its own line
+void appendLineComment(std::string& out, std::string_view comment) {
+    auto body = comment.substr(2);
+    while (!body.empty() && std::isspace(static_cast<unsigned char>(body.back()))) {
+        body.remove_suffix(1);
+    }
+    if (body.find("*/") != std::string_view::npos) {
+        out += comment;
+        out += '\n';
+        return;
     }
+    out += "/*";
+    out += body;
+    out += " */";
+}
 
-    Token readWord() {
-        std::string value;
-        while (m_pos < m_sql.length() && (std::isalnum(static_cast<unsigned char>(m_sql[m_pos])) || m_sql[m_pos] == '_' || m_sql[m_pos] == '.')) {
-            value += m_sql[m_pos];
-            ++m_pos;
-        }
+/// Parts of a dotted name: words, numbers, [quoted] names and the dots between them
+bool isNamePart(SqlTokens tokens, const SqlToken& token) {
+    return token.kind == SqlTokenKind::Word || token.kind == SqlTokenKind::Number || token.kind == SqlTokenKind::QuotedIdentifier ||
+           (token.kind == SqlTokenKind::Symbol && tokens.sql[token.offset] == '.');
+}
 
-        std::string upper = value;
-        std::ranges::transform(upper, upper.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+/// Formatter tokens from the shared lexer. Adjacent name parts merge into one identifier (o.order_id,
+/// [dbo].[t], t.*'s "t."); `classify(word)` returns the keyword flags of a single word.
+template <typename Classify>
+std::vector<Token> toFormatterTokens(SqlTokens script, Classify classify) {
+    const auto& lexed = script.tokens;
+    std::vector<Token> tokens;
+    tokens.reserve(lexed.size());
+
+    for (size_t i = 0; i < lexed.size(); ++i) {
+        const auto& token = lexed[i];
+        if (isNamePart(script, token)) {
+            size_t last = i;
+            while (last + 1 < lexed.size() && lexed[last + 1].offset == lexed[last].end() && isNamePart(script, lexed[last + 1])) {
+                ++last;
+            }
+            if (last > i) {
+                tokens.push_back({TokenType::Identifier, 0, token.offset, lexed[last].end() - token.offset});
+                i = last;
+                continue;
+            }
+        }
 
-        TokenType type = m_keywords.contains(upper) ? TokenType::Keyword : TokenType::Identifier;
-        return {type, value, upper};
+        TokenType type = TokenType::Operator;
+        uint8_t keyword = 0;
+        switch (token.kind) {
+            case SqlTokenKind::Word:
+                keyword = classify(script.text(token));
+                type = keyword != 0 ? TokenType::Keyword : TokenType::Identifier;
+                break;
+            case SqlTokenKind::Number:
+                type = TokenType::Number;
+                break;
+            case SqlTokenKind::String:
+                type = TokenType::String;
+                break;
+            case SqlTokenKind::QuotedIdentifier:
+                type = TokenType::Identifier;
+                break;
+            case SqlTokenKind::LineComment:
+                type = TokenType::LineComment;
+                break;
+            case SqlTokenKind::BlockComment:
+                type = TokenType::Comment;
+                break;
+            case SqlTokenKind::Symbol:
+                switch (script.sql[token.offset]) {
+                    case '(':
+                        type = TokenType::OpenParen;
+                        break;
+                    case ')':
+                        type = TokenType::CloseParen;
+                        break;
+                    case ',':
+                        type = TokenType::Comma;
+                        break;
+                    case ';':
+                        type = TokenType::Semicolon;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+        }
+        tokens.push_back({type, keyword, token.offset, token.length});
     }
+    return tokens;
+}
 
-    bool isOperatorChar(char c) const { return c == '=' || c == '<' || c == '>' || c == '+' || c == '-' || c == '*' || c == '/' || c == '!'; }
+// Lexer state at a line start (widenLines)
+constexpr uint8_t LINE_CLEAN = 1;            ///< Not inside a string, [identifier] or block comment: lexing can restart here
+constexpr uint8_t LINE_STATEMENT_START = 2;  ///< Clean, with no code since the last ';'
 
-    Token readOperator() {
-        std::string value;
-        value += m_sql[m_pos];
-        ++m_pos;
+struct LineSpan {
+    size_t firstLine;
+    size_t lastLine;
+    std::string_view text;  ///< Lines [firstLine, lastLine] without the final line break
+};
 
-        if (m_pos < m_sql.length()) {
-            char next = m_sql[m_pos];
-            if ((value[0] == '<' && (next == '=' || next == '>')) || (value[0] == '>' && next == '=') || (value[0] == '!' && next == '=')) {
-                value += next;
-                ++m_pos;
+/// Widens lines [firstLine, lastLine] to the nearest line starts whose lexer state has all `required` flags.
+/// Line starts between tokens are clean and the ones inside a multi-line token are not; lexing stops at the
+/// first checkpoint after lastLine, so nothing past the edited region is read.
+LineSpan widenLines(std::string_view sql, size_t firstLine, size_t lastLine, uint8_t required) {
+    if (firstLine > lastLine) {
+        std::swap(firstLine, lastLine);
+    }
+
+    size_t line = 0;
+    size_t begin = 0;
+    size_t beginLine = 0;
+    bool pending = false;  // Code since the last ';'
+
+    // Line starts in the whitespace [from, to) are checkpoints; returns true once one past lastLine is found
+    std::optional<LineSpan> found;
+    auto visitGap = [&](size_t from, size_t to) {
+        const uint8_t flags = pending ? LINE_CLEAN : (LINE_CLEAN | LINE_STATEMENT_START);
+        for (size_t i = sql.find('\n', from); i < to; i = sql.find('\n', i + 1)) {
+            ++line;
+            if ((flags & required) != required) {
+                continue;
+            }
+            if (line <= firstLine) {
+                begin = i + 1;
+                beginLine = line;
+            } else if (line > lastLine) {
+                found = LineSpan{beginLine, line - 1, sql.substr(begin, i - begin)};
+                return true;
             }
         }
-
-        return {TokenType::Operator, value, value};
+        return false;
+    };
+
+    SqlLexer lexer(sql);
+    SqlToken token;
+    size_t previousEnd = 0;
+    while (lexer.next(token)) {
+        if (visitGap(previousEnd, token.offset)) {
+            return *found;
+        }
+        // Lines that start inside the token are never checkpoints
+        const auto text = sql.substr(token.offset, token.length);
+        line += static_cast<size_t>(std::ranges::count(text, '\n'));
+        if (!token.isComment()) {
+            pending = !(token.kind == SqlTokenKind::Symbol && text == ";");
+        }
+        previousEnd = token.end();
     }
-};
+    if (visitGap(previousEnd, sql.size())) {
+        return *found;
+    }
+    return {beginLine, line, sql.substr(begin)};
+}
 
 class SQLFormatterImpl {
 public:
-    explicit SQLFormatterImpl(const SQLFormatter::FormatOptions& options, const std::unordered_set<std::string>& majorClauses, const std::unordered_set<std::string>& joinKeywords)
-        : m_options(options), m_majorClauses(majorClauses), m_joinKeywords(joinKeywords) {}
+    explicit SQLFormatterImpl(const SQLFormatter::FormatOptions& options) : m_options(options) {}
 
-    std::string format(const std::vector<Token>& tokens) {
+    std::string format(std::string_view sql, std::span<const Token> tokens) {
         m_result.clear();
+        m_result.reserve(sql.size() + sql.size() / 4);
         m_indentLevel = 0;
         m_pos = 0;
+        m_sql = sql;
         m_tokens = tokens;
 
         while (m_pos < m_tokens.size()) {
@@ -156,17 +309,28 @@ public:
             m_result.pop_back();
         }
 
-        return m_result;
+        return std::move(m_result);
     }
 
 private:
     const SQLFormatter::FormatOptions& m_options;
-    const std::unordered_set<std::string>& m_majorClauses;
-    const std::unordered_set<std::string>& m_joinKeywords;
     std::string m_result;
     int m_indentLevel;
     size_t m_pos;
-    std::vector<Token> m_tokens;
+    std::string_view m_sql;
+    std::span<const Token> m_tokens;
+
+    std::string_view text(const Token& token) const { return m_sql.substr(token.offset, token.length); }
+
+    /// Case-insensitive match of the token text against an upper-case word
+    bool is(const Token& token, std::string_view upper) const {
+        return token.length == upper.size() && std::ranges::equal(text(token), upper, [](char a, char b) { return toUpperAscii(a) == b; });
+    }
+
+    bool isAt(std::string_view upper) const { return m_pos < m_tokens.size() && is(m_tokens[m_pos], upper); }
+
+    static bool isMajorClause(const Token& token) { return (token.keyword & MAJOR_CLAUSE) != 0; }
+    static bool isJoinKeyword(const Token& token) { return (token.keyword & JOIN_KEYWORD) != 0; }
 
     void formatStatement() {
         if (m_pos >= m_tokens.size())
@@ -174,7 +338,7 @@ private:
 
         const auto& token = m_tokens[m_pos];
 
-        if (token.type == TokenType::Keyword && token.upperValue == "SELECT") {
+        if (token.type == TokenType::Keyword && is(token, "SELECT")) {
             formatSelectStatement();
         } else {
             // Fallback: just output the token
@@ -199,7 +363,7 @@ private:
     }
 
     void formatSelectClause() {
-        if (m_pos >= m_tokens.size() || m_tokens[m_pos].upperValue != "SELECT")
+        if (!isAt("SELECT"))
             return;
 
         appendToken(m_tokens[m_pos]);
@@ -207,7 +371,7 @@ private:
         ++m_pos;
 
         // Handle DISTINCT
-        if (m_pos < m_tokens.size() && m_tokens[m_pos].upperValue == "DISTINCT") {
+        if (isAt("DISTINCT")) {
             appendToken(m_tokens[m_pos]);
             m_result += ' ';
             ++m_pos;
@@ -221,25 +385,25 @@ private:
         while (m_pos < m_tokens.size()) {
             const auto& token = m_tokens[m_pos];
 
-            if (parenDepth == 0 && token.type == TokenType::Keyword && m_majorClauses.contains(token.upperValue)) {
+            if (parenDepth == 0 && isMajorClause(token)) {
                 break;
             }
 
             if (token.type == TokenType::OpenParen) {
                 ++parenDepth;
-                currentItem += token.value;
+                currentItem += text(token);
             } else if (token.type == TokenType::CloseParen) {
                 --parenDepth;
-                currentItem += token.value;
+                currentItem += text(token);
             } else if (parenDepth == 0 && token.type == TokenType::Comma) {
-                selectItems.push_back(currentItem);
+                selectItems.push_back(std::move(currentItem));
                 currentItem.clear();
             } else {
                 // Add space before token if needed (not after '(' or at the start)
                 if (!currentItem.empty() && !std::isspace(static_cast<unsigned char>(currentItem.back())) && currentItem.back() != '(') {
                     currentItem += ' ';
                 }
-                currentItem += formatToken(token);
+                appendToken(currentItem, token);
                 // Add space after keyword (e.g., WITH, UNION, CASE, etc.)
                 // BUT NOT before opening parenthesis (e.g., COUNT(, SUM(, etc.)
                 if (token.type == TokenType::Keyword) {
@@ -255,13 +419,14 @@ private:
         }
 
         if (!currentItem.empty()) {
-            selectItems.push_back(currentItem);
+            selectItems.push_back(std::move(currentItem));
         }
 
         // Output select items with alignment
         for (size_t i = 0; i < selectItems.size(); ++i) {
             if (i > 0) {
-                m_result += ",\n" + getIndent(1);
+                m_result += ",\n";
+                appendIndent(1);
             }
             m_result += trim(selectItems[i]);
         }
@@ -269,7 +434,7 @@ private:
     }
 
     void formatFromClause() {
-        if (m_pos >= m_tokens.size() || m_tokens[m_pos].upperValue != "FROM")
+        if (!isAt("FROM"))
             return;
 
         appendToken(m_tokens[m_pos]);
@@ -280,11 +445,11 @@ private:
         while (m_pos < m_tokens.size()) {
             const auto& token = m_tokens[m_pos];
 
-            if (token.type == TokenType::Keyword && (m_joinKeywords.contains(token.upperValue) || m_majorClauses.contains(token.upperValue))) {
+            if (isJoinKeyword(token) || isMajorClause(token)) {
                 break;
             }
 
-            m_result += formatToken(token);
+            appendToken(token);
             m_result += ' ';
             ++m_pos;
         }
@@ -292,17 +457,12 @@ private:
         m_result += '\n';
 
         // JOINs
-        while (m_pos < m_tokens.size() && m_tokens[m_pos].type == TokenType::Keyword) {
-            const auto& token = m_tokens[m_pos];
-
-            if (!m_joinKeywords.contains(token.upperValue))
-                break;
-
-            m_result += getIndent(1);
+        while (m_pos < m_tokens.size() && isJoinKeyword(m_tokens[m_pos])) {
+            appendIndent(1);
 
             // JOIN keywords (INNER JOIN, LEFT JOIN, etc.)
-            while (m_pos < m_tokens.size() && m_joinKeywords.contains(m_tokens[m_pos].upperValue)) {
-                m_result += formatToken(m_tokens[m_pos]);
+            while (m_pos < m_tokens.size() && isJoinKeyword(m_tokens[m_pos])) {
+                appendToken(m_tokens[m_pos]);
                 m_result += ' ';
                 ++m_pos;
             }
@@ -311,17 +471,17 @@ private:
             while (m_pos < m_tokens.size()) {
                 const auto& t = m_tokens[m_pos];
 
-                if (t.type == TokenType::Keyword && (t.upperValue == "ON" || m_joinKeywords.contains(t.upperValue) || m_majorClauses.contains(t.upperValue))) {
+                if (t.type == TokenType::Keyword && (is(t, "ON") || isJoinKeyword(t) || isMajorClause(t))) {
                     break;
                 }
 
-                m_result += formatToken(t);
+                appendToken(t);
                 m_result += ' ';
                 ++m_pos;
             }
 
             // ON condition
-            if (m_pos < m_tokens.size() && m_tokens[m_pos].upperValue == "ON") {
+            if (isAt("ON")) {
                 appendToken(m_tokens[m_pos]);
                 m_result += ' ';
                 ++m_pos;
@@ -329,11 +489,11 @@ private:
                 while (m_pos < m_tokens.size()) {
                     const auto& t = m_tokens[m_pos];
 
-                    if (t.type == TokenType::Keyword && (m_joinKeywords.contains(t.upperValue) || m_majorClauses.contains(t.upperValue))) {
+                    if (isJoinKeyword(t) || isMajorClause(t)) {
                         break;
                     }
 
-                    m_result += formatToken(t);
+                    appendToken(t);
                     m_result += ' ';
                     ++m_pos;
                 }
@@ -344,34 +504,34 @@ private:
     }
 
     void formatWhereClause() {
-        if (m_pos >= m_tokens.size() || m_tokens[m_pos].upperValue != "WHERE")
+        if (!isAt("WHERE"))
             return;
 
         appendToken(m_tokens[m_pos]);
         m_result += ' ';
         ++m_pos;
 
-        bool firstCondition = true;
         int parenDepth = 0;
 
         while (m_pos < m_tokens.size()) {
             const auto& token = m_tokens[m_pos];
 
-            if (parenDepth == 0 && token.type == TokenType::Keyword && m_majorClauses.contains(token.upperValue)) {
+            if (parenDepth == 0 && isMajorClause(token)) {
                 break;
             }
 
             if (token.type == TokenType::OpenParen) {
                 ++parenDepth;
-                m_result += token.value;
+                m_result += text(token);
             } else if (token.type == TokenType::CloseParen) {
                 --parenDepth;
-                m_result += token.value;
-            } else if (parenDepth == 0 && token.type == TokenType::Keyword && (token.upperValue == "AND" || token.upperValue == "OR")) {
-                m_result += "\n  " + formatToken(token) + ' ';
-                firstCondition = false;
+                m_result += text(token);
+            } else if (parenDepth == 0 && token.type == TokenType::Keyword && (is(token, "AND") || is(token, "OR"))) {
+                m_result += "\n  ";
+                appendToken(token);
+                m_result += ' ';
             } else {
-                m_result += formatToken(token);
+                appendToken(token);
                 m_result += ' ';
             }
 
@@ -382,7 +542,7 @@ private:
     }
 
     void formatGroupByClause() {
-        if (m_pos >= m_tokens.size() || m_tokens[m_pos].upperValue != "GROUP")
+        if (!isAt("GROUP"))
             return;
 
         appendToken(m_tokens[m_pos]);
@@ -390,50 +550,28 @@ private:
         ++m_pos;
 
         // Skip BY
-        if (m_pos < m_tokens.size() && m_tokens[m_pos].upperValue == "BY") {
+        if (isAt("BY")) {
             appendToken(m_tokens[m_pos]);
             m_result += ' ';
             ++m_pos;
         }
 
-        while (m_pos < m_tokens.size()) {
-            const auto& token = m_tokens[m_pos];
-
-            if (token.type == TokenType::Keyword && m_majorClauses.contains(token.upperValue)) {
-                break;
-            }
-
-            appendTokenWithSpace(token);
-            ++m_pos;
-        }
-
-        m_result += '\n';
+        appendUntilMajorClause();
     }
 
     void formatHavingClause() {
-        if (m_pos >= m_tokens.size() || m_tokens[m_pos].upperValue != "HAVING")
+        if (!isAt("HAVING"))
             return;
 
         appendToken(m_tokens[m_pos]);
         m_result += ' ';
         ++m_pos;
 
-        while (m_pos < m_tokens.size()) {
-            const auto& token = m_tokens[m_pos];
-
-            if (token.type == TokenType::Keyword && m_majorClauses.contains(token.upperValue)) {
-                break;
-            }
-
-            appendTokenWithSpace(token);
-            ++m_pos;
-        }
-
-        m_result += '\n';
+        appendUntilMajorClause();
     }
 
     void formatOrderByClause() {
-        if (m_pos >= m_tokens.size() || m_tokens[m_pos].upperValue != "ORDER")
+        if (!isAt("ORDER"))
             return;
 
         appendToken(m_tokens[m_pos]);
@@ -441,16 +579,21 @@ private:
         ++m_pos;
 
         // Skip BY
-        if (m_pos < m_tokens.size() && m_tokens[m_pos].upperValue == "BY") {
+        if (isAt("BY")) {
             appendToken(m_tokens[m_pos]);
             m_result += ' ';
             ++m_pos;
         }
 
+        appendUntilMajorClause();
+    }
+
+    /// Rest of a GROUP BY / HAVING / ORDER BY clause, up to the next major clause
+    void appendUntilMajorClause() {
         while (m_pos < m_tokens.size()) {
             const auto& token = m_tokens[m_pos];
 
-            if (token.type == TokenType::Keyword && m_majorClauses.contains(token.upperValue)) {
+            if (isMajorClause(token)) {
                 break;
             }
 
@@ -461,58 +604,42 @@ private:
         m_result += '\n';
     }
 
-    std::string formatToken(const Token& token) const {
+    void appendToken(std::string& out, const Token& token) const {
         if (token.type == TokenType::Keyword) {
-            return applyKeywordCase(token.value);
+            appendKeyword(out, text(token), m_options.keywordCase);
+        } else if (token.type == TokenType::LineComment) {
+            appendLineComment(out, text(token));
+        } else {
+            out += text(token);
         }
-        return token.value;
     }
 
-    void appendToken(const Token& token) { m_result += formatToken(token); }
+    void appendToken(const Token& token) { appendToken(m_result, token); }
 
     bool needsSpaceAfter(const Token& token) const {
         // Don't add space after open paren or before close paren
         return token.type != TokenType::OpenParen;
     }
 
-    bool needsSpaceBefore(const Token& token) const {
-        // Don't add space before close paren or comma
-        return token.type != TokenType::CloseParen && token.type != TokenType::Comma;
-    }
-
     void appendTokenWithSpace(const Token& token, bool addSpaceAfter = true) {
-        m_result += formatToken(token);
+        appendToken(token);
         if (addSpaceAfter && needsSpaceAfter(token)) {
             m_result += ' ';
         }
     }
 
-    std::string applyKeywordCase(std::string_view word) const {
-        std::string result(word);
-        switch (m_options.keywordCase) {
-            case KeywordCase::Upper:
-                std::ranges::transform(result, result.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
-                break;
-            case KeywordCase::Lower:
-                std::ranges::transform(result, result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-                break;
-            case KeywordCase::Unchanged:
-                break;
-        }
-        return result;
-    }
-
-    std::string getIndent(int level) const {
+    void appendIndent(int level) {
         if (m_options.useTab) {
-            return std::string(static_cast<size_t>(level), '\t');
+            m_result.append(static_cast<size_t>(level), '\t');
+        } else {
+            m_result.append(static_cast<size_t>(level * m_options.indentSize), ' ');
         }
-        return std::string(static_cast<size_t>(level * m_options.indentSize), ' ');
     }
 
-    std::string trim(const std::string& str) const {
+    static std::string_view trim(std::string_view str) {
         auto start = str.find_first_not_of(" \t\n\r");
-        if (start == std::string::npos)
-            return "";
+        if (start == std::string_view::npos)
+            return {};
         auto end = str.find_last_not_of(" \t\n\r");
         return str.substr(start, end - start + 1);
     }
@@ -520,26 +647,34 @@ private:
 
 }  // namespace
 
-SQLFormatter::SQLFormatter() {
-    // Try to load keywords from external file first
-    std::filesystem::path exePath = std::filesystem::current_path();
-    std::filesystem::path configPath = exePath / "config" / "sql_keywords.txt";
+SQLFormatter::SQLFormatter() = default;
 
-    if (!loadKeywordsFromFile(configPath.string())) {
-        // Fallback to default keywords if file doesn't exist
-        loadDefaultKeywords();
-    }
+void SQLFormatter::warmUp() const {
+    std::call_once(m_keywordsOnce, [this] {
+        // Try to load keywords from external file first
+        std::filesystem::path exePath = std::filesystem::current_path();
+        std::filesystem::path configPath = exePath / "config" / "sql_keywords.txt";
+
+        if (!readKeywordsFile(configPath.string())) {
+            // Fallback to default keywords if file doesn't exist
+            loadDefaultKeywords();
+        }
+    });
 }
 
 bool SQLFormatter::loadKeywordsFromFile(const std::string& filePath) {
+    // An explicit load takes the place of the lazy one
+    std::call_once(m_keywordsOnce, [] {});
+    return readKeywordsFile(filePath);
+}
+
+bool SQLFormatter::readKeywordsFile(const std::string& filePath) const {
     std::ifstream file(filePath);
     if (!file.is_open()) {
         return false;
     }
 
-    m_keywords.clear();
-    m_majorClauses.clear();
-    m_joinKeywords.clear();
+    std::unordered_map<std::string, uint8_t, KeywordHash, std::equal_to<>> keywords;
 
     std::string line;
     while (std::getline(file, line)) {
@@ -547,103 +682,119 @@ bool SQLFormatter::loadKeywordsFromFile(const std::string& filePath) {
         line.erase(0, line.find_first_not_of(" \t\r\n"));
         line.erase(line.find_last_not_of(" \t\r\n") + 1);
 
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#') {
+        // Skip empty lines, comments and words too long to be looked up
+        if (line.empty() || line[0] == '#' || line.size() > MAX_KEYWORD_LENGTH) {
             continue;
         }
 
         // Convert to uppercase for storage
-        std::string upper = line;
-        std::ranges::transform(upper, upper.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        std::ranges::transform(line, line.begin(), toUpperAscii);
+        const auto flags = categoryFlags(line);
+        keywords.emplace(std::move(line), flags);
+    }
 
-        m_keywords.insert(upper);
+    if (keywords.empty()) {
+        return false;
+    }
 
-        // Categorize keywords
-        if (upper == "SELECT" || upper == "FROM" || upper == "WHERE" || upper == "GROUP" || upper == "HAVING" || upper == "ORDER" || upper == "UNION" || upper == "INTERSECT" || upper == "EXCEPT") {
-            m_majorClauses.insert(upper);
-        }
+    // A file listing exactly the built-in keywords keeps the perfect-hash lookup
+    const bool builtIn = keywords.size() == DEFAULT_KEYWORDS.size() && std::ranges::all_of(keywords, [](const auto& entry) { return DEFAULT_KEYWORD_TABLE.flags(entry.first) != 0; });
+    m_customKeywords = builtIn ? decltype(keywords){} : std::move(keywords);
+    return true;
+}
 
-        if (upper == "JOIN" || upper == "INNER" || upper == "LEFT" || upper == "RIGHT" || upper == "FULL" || upper == "CROSS" || upper == "OUTER") {
-            m_joinKeywords.insert(upper);
-        }
-    }
+void SQLFormatter::loadDefaultKeywords() const {
+    // Default SQL keywords as fallback (DEFAULT_KEYWORD_TABLE)
+    m_customKeywords.clear();
+}
 
-    return !m_keywords.empty();
+bool SQLFormatter::isBuiltInKeyword(std::string_view word) noexcept {
+    if (word.size() > MAX_KEYWORD_LENGTH) {
+        return false;
+    }
+    std::array<char, MAX_KEYWORD_LENGTH> buffer;
+    std::ranges::transform(word, buffer.begin(), toUpperAscii);
+    return DEFAULT_KEYWORD_TABLE.flags(std::string_view(buffer.data(), word.size())) != 0;
 }
 
-void SQLFormatter::loadDefaultKeywords() {
-    // Default SQL keywords as fallback
-    m_keywords = {"SELECT",     "FROM",   "WHERE",      "AND",          "OR",     "NOT",     "IN",         "EXISTS",     "JOIN",      "INNER",     "LEFT",   "RIGHT",    "OUTER",
-                  "FULL",       "CROSS",  "ON",         "GROUP",        "BY",     "HAVING",  "ORDER",      "ASC",        "DESC",      "NULLS",     "FIRST",  "LAST",     "INSERT",
-                  "INTO",       "VALUES", "UPDATE",     "SET",          "DELETE", "CREATE",  "TABLE",      "INDEX",      "VIEW",      "DROP",      "ALTER",  "ADD",      "COLUMN",
-                  "PRIMARY",    "KEY",    "FOREIGN",    "UNIQUE",       "CHECK",  "DEFAULT", "NULL",       "AS",         "DISTINCT",  "TOP",       "LIMIT",  "OFFSET",   "FETCH",
-                  "NEXT",       "ROWS",   "ONLY",       "UNION",        "ALL",    "CASE",    "WHEN",       "THEN",       "ELSE",      "END",       "LIKE",   "BETWEEN",  "IS",
-                  "COUNT",      "SUM",    "AVG",        "MIN",          "MAX",    "OVER",    "PARTITION",  "WITH",       "RECURSIVE", "INTERSECT", "EXCEPT", "COALESCE", "CAST",
-                  "ROW_NUMBER", "RANK",   "DENSE_RANK", "PERCENT_RANK", "LAG",    "LEAD",    "STRING_AGG", "DATE_TRUNC", "ROUND"};
-
-    m_majorClauses = {"SELECT", "FROM", "WHERE", "GROUP", "HAVING", "ORDER", "UNION", "INTERSECT", "EXCEPT"};
-    m_joinKeywords = {"JOIN", "INNER", "LEFT", "RIGHT", "FULL", "CROSS", "OUTER"};
+uint8_t SQLFormatter::keywordFlags(std::string_view word) const noexcept {
+    if (word.size() > MAX_KEYWORD_LENGTH) {
+        return 0;
+    }
+    std::array<char, MAX_KEYWORD_LENGTH> buffer;
+    std::ranges::transform(word, buffer.begin(), toUpperAscii);
+    const std::string_view upper(buffer.data(), word.size());
+
+    if (m_customKeywords.empty()) {
+        return DEFAULT_KEYWORD_TABLE.flags(upper);
+    }
+    const auto it = m_customKeywords.find(upper);
+    return it != m_customKeywords.end() ? it->second : 0;
 }
 
 std::string SQLFormatter::format(std::string_view sql, const FormatOptions& options) {
-    Tokenizer tokenizer(sql, m_keywords);
-    auto tokens = tokenizer.tokenize();
+    return format(SqlTokenStream(sql), options);
+}
+
+std::string SQLFormatter::format(SqlTokens script, const FormatOptions& options) {
+    warmUp();
+    const auto tokens = toFormatterTokens(script, [this](std::string_view word) { return keywordFlags(word); });
 
-    SQLFormatterImpl formatter(options, m_majorClauses, m_joinKeywords);
-    return formatter.format(tokens);
+    SQLFormatterImpl formatter(options);
+    return formatter.format(script.sql, tokens);
 }
 
-std::string SQLFormatter::applyKeywordCase(std::string_view word, KeywordCase keywordCase) const {
-    std::string result(word);
-    switch (keywordCase) {
-        case KeywordCase::Upper:
-            std::ranges::transform(result, result.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
-            break;
-        case KeywordCase::Lower:
-            std::ranges::transform(result, result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-            break;
-        case KeywordCase::Unchanged:
-            break;
-    }
-    return result;
+size_t SQLFormatter::countTokens(std::string_view sql) const {
+    warmUp();
+    return toFormatterTokens(SqlTokenStream(sql), [this](std::string_view word) { return keywordFlags(word); }).size();
+}
+
+SQLFormatter::LineEdit SQLFormatter::formatLines(std::string_view sql, size_t firstLine, size_t lastLine, const FormatOptions& options) {
+    const auto span = widenLines(sql, firstLine, lastLine, LINE_CLEAN | LINE_STATEMENT_START);
+    return {span.firstLine, span.lastLine, format(span.text, options)};
 }
 
-bool SQLFormatter::isKeyword(std::string_view word) const {
-    std::string upper(word);
-    std::ranges::transform(upper, upper.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
-    return m_keywords.contains(upper);
+SQLFormatter::LineEdit SQLFormatter::uppercaseKeywordsInLines(std::string_view sql, size_t firstLine, size_t lastLine) {
+    const auto span = widenLines(sql, firstLine, lastLine, LINE_CLEAN);
+    warmUp();
+
+    std::string text(span.text);
+    for (const auto& token : toFormatterTokens(SqlTokenStream(span.text), [this](std::string_view word) { return keywordFlags(word); })) {
+        if (token.type == TokenType::Keyword) {
+            const auto first = text.begin() + token.offset;
+            std::transform(first, first + token.length, first, toUpperAscii);
+        }
+    }
+    return {span.firstLine, span.lastLine, std::move(text)};
 }
 
 std::string SQLFormatter::uppercaseKeywords(std::string_view sql) {
-    Tokenizer tokenizer(sql, m_keywords);
-    auto tokens = tokenizer.tokenize();
+    warmUp();
+    const auto tokens = toFormatterTokens(SqlTokenStream(sql), [this](std::string_view word) { return keywordFlags(word); });
 
     std::string result;
+    result.reserve(sql.size());
     for (size_t i = 0; i < tokens.size(); ++i) {
         const auto& token = tokens[i];
 
         // Add space before token if needed (except first token and after open paren)
         if (i > 0) {
             const auto& prevToken = tokens[i - 1];
-            if (prevToken.type != TokenType::OpenParen && token.type != TokenType::CloseParen && token.type != TokenType::Comma && token.type != TokenType::Semicolon) {
+            if (prevToken.type == TokenType::LineComment) {
+                result += '\n';
+            } else if (prevToken.type != TokenType::OpenParen && token.type != TokenType::CloseParen && token.type != TokenType::Comma && token.type != TokenType::Semicolon) {
                 result += ' ';
             }
         }
 
+        const auto text = sql.substr(token.offset, token.length);
         if (token.type == TokenType::Keyword) {
-            result += applyKeywordCase(token.value, KeywordCase::Upper);
+            appendKeyword(result, text, KeywordCase::Upper);
         } else {
-            result += token.value;
+            result += text;
         }
     }
     return result;
 }
 
-std::string SQLFormatter::getIndent(int level, const FormatOptions& options) {
-    if (options.useTab) {
-        return std::string(static_cast<size_t>(level), '\t');
-    }
-    return std::string(static_cast<size_t>(level * options.indentSize), ' ');
-}
-
 }  // namespace velocitydb
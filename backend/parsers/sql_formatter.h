@@ -1,8 +1,13 @@
 #pragma once
 
+#include "sql_lexer.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <string_view>
-#include <unordered_set>
+#include <unordered_map>
 
 namespace velocitydb {
 
@@ -19,24 +24,55 @@ public:
         int maxLineLength = 120;
     };
 
+    /// Replacement text for the whole lines [firstLine, lastLine] (0-based) of the input
+    struct LineEdit {
+        size_t firstLine = 0;
+        size_t lastLine = 0;
+        std::string text;
+    };
+
     SQLFormatter();
     ~SQLFormatter() = default;
 
     [[nodiscard]] std::string format(std::string_view sql, const FormatOptions& options = FormatOptions{});
+    /// format() of an already lexed script (or one statement of it)
+    [[nodiscard]] std::string format(SqlTokens script, const FormatOptions& options);
     [[nodiscard]] std::string uppercaseKeywords(std::string_view sql);
+    /// Formats only the statements on lines [firstLine, lastLine], widened to whole statements and lines;
+    /// the rest of the script is neither tokenized nor re-emitted
+    [[nodiscard]] LineEdit formatLines(std::string_view sql, size_t firstLine, size_t lastLine, const FormatOptions& options);
+    /// Upper-cases keywords in place on lines [firstLine, lastLine] (widened past strings and [identifiers]
+    /// spanning lines), leaving spacing and line breaks as typed
+    [[nodiscard]] LineEdit uppercaseKeywordsInLines(std::string_view sql, size_t firstLine, size_t lastLine);
+    /// Number of tokens the formatter splits `sql` into (tokenizer throughput benchmarks)
+    [[nodiscard]] size_t countTokens(std::string_view sql) const;
+    /// `word` is one of the built-in keywords, ignoring ASCII case (keywords loaded from a file do not count)
+    [[nodiscard]] static bool isBuiltInKeyword(std::string_view word) noexcept;
 
-    // Load keywords from external file (returns true on success)
+    // Load keywords from external file (returns true on success).
+    // Keyword lookups use a compile-time perfect hash of the built-in list; a file that lists other
+    // keywords switches them to a runtime table.
     bool loadKeywordsFromFile(const std::string& filePath);
 
+    /// Read config/sql_keywords.txt now. Otherwise the first call that needs keywords reads it, so
+    /// constructing a formatter never touches the filesystem.
+    void warmUp() const;
+
 private:
-    [[nodiscard]] std::string applyKeywordCase(std::string_view word, KeywordCase keywordCase) const;
-    [[nodiscard]] bool isKeyword(std::string_view word) const;
-    [[nodiscard]] static std::string getIndent(int level, const FormatOptions& options);
-    void loadDefaultKeywords();
-
-    std::unordered_set<std::string> m_keywords;
-    std::unordered_set<std::string> m_majorClauses;
-    std::unordered_set<std::string> m_joinKeywords;
+    struct KeywordHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+    };
+
+    /// Category flags of `word` (case-insensitive); 0 when it is not a keyword
+    [[nodiscard]] uint8_t keywordFlags(std::string_view word) const noexcept;
+    bool readKeywordsFile(const std::string& filePath) const;
+    void loadDefaultKeywords() const;
+
+    mutable std::once_flag m_keywordsOnce;
+    /// Upper-case keyword -> category flags loaded from a file; empty while the built-in list is in use.
+    /// Filled lazily (warmUp()), hence mutable.
+    mutable std::unordered_map<std::string, uint8_t, KeywordHash, std::equal_to<>> m_customKeywords;
 };  // class SQLFormatter
 
 }  // namespace velocitydb
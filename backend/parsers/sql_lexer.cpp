@@ -0,0 +1,155 @@
+#include "sql_lexer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr bool isWordStart(unsigned char c) noexcept {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c == '@' || c == '#' || c == '$' || c >= 0x80;
+}
+
+constexpr bool isWordChar(unsigned char c) noexcept {
+    return isWordStart(c) || (c >= '0' && c <= '9');
+}
+
+constexpr char toUpperAscii(char c) noexcept {
+    return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+}  // namespace
+
+SqlLexer::SqlLexer(std::string_view sql) : m_sql(sql) {
+    if (sql.size() > std::numeric_limits<uint32_t>::max()) [[unlikely]] {
+        throw std::length_error("SQL text is too large to tokenize");
+    }
+}
+
+bool SqlLexer::next(SqlToken& token) noexcept {
+    const size_t n = m_sql.size();
+    while (m_pos < n && std::isspace(static_cast<unsigned char>(m_sql[m_pos]))) {
+        if (m_sql[m_pos] == '\n') {
+            ++m_line;
+            m_lineStart = true;
+        }
+        ++m_pos;
+    }
+    if (m_pos >= n) {
+        return false;
+    }
+
+    const size_t start = m_pos;
+    const uint32_t line = m_line;
+    const auto c = static_cast<unsigned char>(m_sql[m_pos]);
+    const char next = m_pos + 1 < n ? m_sql[m_pos + 1] : '\0';
+    SqlTokenKind kind = SqlTokenKind::Symbol;
+
+    if (c == '-' && next == '-') {
+        kind = SqlTokenKind::LineComment;
+        m_pos = (std::min)(m_sql.find('\n', m_pos), n);
+    } else if (c == '/' && next == '*') {
+        kind = SqlTokenKind::BlockComment;
+        skipBlockComment();
+    } else if (c == '\'' || ((c == 'N' || c == 'n') && next == '\'')) {
+        kind = SqlTokenKind::String;
+        m_pos += c == '\'' ? 0 : 1;
+        skipQuoted('\'');
+    } else if (c == '[' || c == '"') {
+        kind = SqlTokenKind::QuotedIdentifier;
+        skipQuoted(c == '[' ? ']' : '"');
+    } else if (c >= '0' && c <= '9') {
+        kind = SqlTokenKind::Number;
+        while (m_pos < n && (isWordChar(static_cast<unsigned char>(m_sql[m_pos])) || m_sql[m_pos] == '.')) {
+            ++m_pos;
+        }
+    } else if (isWordStart(c)) {
+        kind = SqlTokenKind::Word;
+        while (m_pos < n && isWordChar(static_cast<unsigned char>(m_sql[m_pos]))) {
+            ++m_pos;
+        }
+    } else {
+        ++m_pos;
+        if ((c == '<' && (next == '=' || next == '>')) || (c == '>' && next == '=') || (c == '!' && next == '=')) {
+            ++m_pos;
+        }
+    }
+
+    token = {.offset = static_cast<uint32_t>(start), .length = static_cast<uint32_t>(m_pos - start), .line = line, .kind = kind, .lineStart = m_lineStart};
+    m_lineStart = false;
+    return true;
+}
+
+void SqlLexer::skipQuoted(char close) noexcept {
+    // A doubled `close` is an escaped one
+    const size_t n = m_sql.size();
+    ++m_pos;
+    while (m_pos < n) {
+        const char c = m_sql[m_pos++];
+        if (c == close) {
+            if (m_pos < n && m_sql[m_pos] == close) {
+                ++m_pos;
+                continue;
+            }
+            return;
+        }
+        m_line += c == '\n';
+    }
+}
+
+void SqlLexer::skipBlockComment() noexcept {
+    // T-SQL block comments nest
+    size_t depth = 0;
+    const size_t n = m_sql.size();
+    while (m_pos < n) {
+        if (m_sql[m_pos] == '/' && m_pos + 1 < n && m_sql[m_pos + 1] == '*') {
+            ++depth;
+            m_pos += 2;
+        } else if (m_sql[m_pos] == '*' && m_pos + 1 < n && m_sql[m_pos + 1] == '/') {
+            m_pos += 2;
+            if (--depth == 0) {
+                return;
+            }
+        } else {
+            m_line += m_sql[m_pos] == '\n';
+            ++m_pos;
+        }
+    }
+}
+
+std::string_view SqlTokens::name(const SqlToken& token) const noexcept {
+    auto value = text(token);
+    if (token.kind == SqlTokenKind::QuotedIdentifier && !value.empty()) {
+        const char close = value.front() == '[' ? ']' : '"';
+        value.remove_prefix(1);
+        if (!value.empty() && value.back() == close) {
+            value.remove_suffix(1);
+        }
+    }
+    return value;
+}
+
+bool SqlTokens::isKeyword(const SqlToken& token, std::string_view upper) const noexcept {
+    return token.kind == SqlTokenKind::Word && token.length == upper.size() && std::ranges::equal(text(token), upper, [](char a, char b) { return toUpperAscii(a) == b; });
+}
+
+std::string_view SqlTokens::source() const noexcept {
+    if (tokens.empty()) {
+        return {};
+    }
+    return sql.substr(tokens.front().offset, tokens.back().end() - tokens.front().offset);
+}
+
+SqlTokenStream::SqlTokenStream(std::string_view sql) : m_sql(sql) {
+    SqlLexer lexer(sql);
+    m_tokens.reserve(sql.size() / 4);
+    SqlToken token;
+    while (lexer.next(token)) {
+        m_tokens.push_back(token);
+    }
+}
+
+}  // namespace velocitydb
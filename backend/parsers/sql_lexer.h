@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+enum class SqlTokenKind : uint8_t {
+    Word,              ///< Keyword or bare name, including @variables and #temp tables
+    Number,            ///< Starts with a digit: 42, 1.5, 1e5, 0x1F
+    String,            ///< '...' or N'...', quotes included
+    QuotedIdentifier,  ///< [name] or "name", delimiters included
+    Symbol,            ///< Punctuation and operators; <=, >=, <> and != are one token
+    LineComment,       ///< -- up to (not including) the line break
+    BlockComment,      ///< /* ... */, nested ones included
+};
+
+/// One token as an offset/length span of the lexed text
+struct SqlToken {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    uint32_t line = 1;  ///< 1-based line the token starts on
+    SqlTokenKind kind = SqlTokenKind::Symbol;
+    bool lineStart = false;  ///< Only whitespace before it on its line
+
+    [[nodiscard]] uint32_t end() const noexcept { return offset + length; }
+    [[nodiscard]] bool isComment() const noexcept { return kind == SqlTokenKind::LineComment || kind == SqlTokenKind::BlockComment; }
+};
+
+/// Forward-only T-SQL lexer over a view. Strings, quoted identifiers and comments are single tokens, so
+/// nothing inside them is ever taken for code; tokens never copy text.
+class SqlLexer {
+public:
+    /// @throws std::length_error when `sql` is too large for 32-bit offsets
+    explicit SqlLexer(std::string_view sql);
+
+    /// Read the next token (comments included); false at the end of the text
+    [[nodiscard]] bool next(SqlToken& token) noexcept;
+    /// Bytes consumed so far
+    [[nodiscard]] size_t position() const noexcept { return m_pos; }
+
+private:
+    void skipQuoted(char close) noexcept;
+    void skipBlockComment() noexcept;
+
+    std::string_view m_sql;
+    size_t m_pos = 0;
+    uint32_t m_line = 1;
+    bool m_lineStart = true;
+};
+
+/// Non-owning view of tokens lexed from `sql`; a statement is a sub-range of its script's tokens
+struct SqlTokens {
+    std::string_view sql;
+    std::span<const SqlToken> tokens;
+
+    [[nodiscard]] std::string_view text(const SqlToken& token) const noexcept { return sql.substr(token.offset, token.length); }
+    /// text() without the delimiters of a quoted identifier (escapes are kept)
+    [[nodiscard]] std::string_view name(const SqlToken& token) const noexcept;
+    /// Bare word equal to `upper` ignoring ASCII case
+    [[nodiscard]] bool isKeyword(const SqlToken& token, std::string_view upper) const noexcept;
+    /// Text from the first token to the end of the last
+    [[nodiscard]] std::string_view source() const noexcept;
+    [[nodiscard]] SqlTokens subspan(size_t first, size_t count) const noexcept { return {sql, tokens.subspan(first, count)}; }
+};
+
+/// A script lexed once. SQLParser and SQLFormatter accept it (as SqlTokens) in place of the text, so one request
+/// can split, classify, extract tables and format from the same tokens.
+class SqlTokenStream {
+public:
+    explicit SqlTokenStream(std::string_view sql);
+
+    [[nodiscard]] std::string_view sql() const noexcept { return m_sql; }
+    [[nodiscard]] size_t size() const noexcept { return m_tokens.size(); }
+    [[nodiscard]] SqlTokens view() const noexcept { return {m_sql, m_tokens}; }
+    operator SqlTokens() const noexcept { return view(); }
+
+private:
+    std::string_view m_sql;
+    std::vector<SqlToken> m_tokens;
+};
+
+}  // namespace velocitydb
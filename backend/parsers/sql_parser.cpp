@@ -1,126 +1,505 @@
 #include "sql_parser.h"
 
+#include "sql_formatter.h"
+
 #include <algorithm>
 #include <cctype>
-#include <ranges>
-#include <regex>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
 
 namespace velocitydb {
 
-std::string_view SQLParser::trim(std::string_view str) {
-    constexpr auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
-    auto start = std::ranges::find_if_not(str, isSpace);
-    auto end = std::ranges::find_if_not(str | std::views::reverse, isSpace).base();
-    if (start >= end)
-        return {};
-    return str.substr(start - str.begin(), end - start);
+namespace {
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) noexcept {
+    return std::ranges::equal(a, b, [](unsigned char x, unsigned char y) { return std::toupper(x) == std::toupper(y); });
 }
 
-std::string SQLParser::toUpper(std::string_view str) {
-    std::string result(str);
-    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::toupper(c); });
-    return result;
+bool isIdentifier(const SqlToken& token) noexcept {
+    return token.kind == SqlTokenKind::Word || token.kind == SqlTokenKind::QuotedIdentifier;
 }
 
-ParsedSQL SQLParser::parseSQL(std::string_view sql) {
-    ParsedSQL result;
-    result.originalSQL = std::string(sql);
+bool isSymbol(SqlTokens tokens, const SqlToken& token, char symbol) noexcept {
+    return token.kind == SqlTokenKind::Symbol && token.length == 1 && tokens.sql[token.offset] == symbol;
+}
 
-    // Trim whitespace
-    std::string_view trimmedSQL = trim(sql);
-    if (trimmedSQL.empty()) {
-        result.type = "EMPTY";
-        return result;
+/// The tokens the checks below look at: comments dropped, and string literals as well unless `keepStrings`
+std::vector<SqlToken> codeTokens(SqlTokens tokens, bool keepStrings) {
+    std::vector<SqlToken> code;
+    code.reserve(tokens.tokens.size());
+    std::ranges::copy_if(tokens.tokens, std::back_inserter(code), [&](const SqlToken& token) { return !token.isComment() && (keepStrings || token.kind != SqlTokenKind::String); });
+    return code;
+}
+
+/// Read a possibly multi-part object name at `pos`; returns the last part and advances `pos` past the name
+std::optional<std::string_view> readObjectName(SqlTokens code, size_t& pos) {
+    const auto& tokens = code.tokens;
+    if (pos >= tokens.size() || !isIdentifier(tokens[pos])) {
+        return std::nullopt;
+    }
+    std::string_view last = code.name(tokens[pos++]);
+    // db.schema.table, including the db..table shorthand
+    while (pos + 1 < tokens.size() && isSymbol(code, tokens[pos], '.')) {
+        if (isSymbol(code, tokens[pos + 1], '.')) {
+            ++pos;
+            continue;
+        }
+        if (!isIdentifier(tokens[pos + 1])) {
+            break;
+        }
+        last = code.name(tokens[pos + 1]);
+        pos += 2;
     }
+    return last;
+}
 
-    // Convert to uppercase for case-insensitive matching
-    auto upperSQL = toUpper(trimmedSQL);
+/// USE takes a plain name ([A-Za-z0-9_]) or a bracketed one
+bool isDatabaseName(SqlTokens tokens, const SqlToken& token) noexcept {
+    if (token.kind == SqlTokenKind::QuotedIdentifier) {
+        return tokens.sql[token.offset] == '[' && !tokens.name(token).empty();
+    }
+    return token.kind == SqlTokenKind::Word && std::ranges::all_of(tokens.text(token), [](unsigned char c) { return std::isalnum(c) != 0 || c == '_'; });
+}
 
-    // Check for USE statement using regex
-    // Pattern: USE <database_name> (with optional semicolon)
-    static const std::regex usePattern(R"(^\s*USE\s+(\[?[\w]+\]?)\s*;?\s*$)", std::regex::icase);
+/// Single pass over the tokens of a T-SQL script for SQLParser::splitScript
+class ScriptSplitter {
+public:
+    explicit ScriptSplitter(SqlTokens tokens) noexcept : m_tokens(tokens) {}
 
-    std::smatch match;
-    auto sqlStr = std::string(trimmedSQL);
+    [[nodiscard]] std::vector<SqlStatementSpan> split() {
+        const auto& tokens = m_tokens.tokens;
+        for (m_index = 0; m_index < tokens.size(); ++m_index) {
+            const auto& token = tokens[m_index];
+            if (token.lineStart && token.kind == SqlTokenKind::Word) {
+                if (const size_t goIndex = m_index; const auto go = matchGo()) {
+                    finishStatement(token.offset, goIndex);
+                    finishBatch(go);
+                    continue;
+                }
+            }
+            if (token.isComment()) {
+                continue;
+            }
+            if (isSymbol(m_tokens, token, ';')) {
+                if (m_blockDepth == 0 && !m_wholeBatch) {
+                    finishStatement(token.offset, m_index);
+                }
+                continue;
+            }
+            markCode();
+            if (token.kind == SqlTokenKind::Word || token.kind == SqlTokenKind::Number) {
+                onWord(m_tokens.text(token));
+            }
+        }
+        finishStatement(m_tokens.sql.size(), tokens.size());
+        finishBatch(1);
+        return std::move(m_statements);
+    }
 
-    if (std::regex_match(sqlStr, match, usePattern)) {
-        result.type = "USE";
-        result.database = match[1].str();
+private:
+    void markCode() noexcept {
+        if (m_start == NONE) {
+            m_start = m_index;
+        }
+    }
+
+    /// Close the statement running up to byte `end` and token `endIndex` (both exclusive)
+    void finishStatement(size_t end, size_t endIndex) {
+        if (m_start != NONE) {
+            const auto& first = m_tokens.tokens[m_start];
+            auto text = m_tokens.sql.substr(first.offset, end - first.offset);
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+                text.remove_suffix(1);
+            }
+            m_statements.push_back({.text = text, .offset = first.offset, .line = first.line, .batch = m_batch, .firstToken = m_start, .tokenCount = endIndex - m_start});
+        }
+        m_start = NONE;
+        m_blockDepth = 0;
+        m_ddlPrefix = DdlPrefix::None;
+        m_words = 0;
+    }
+
+    void finishBatch(size_t repeat) {
+        for (size_t i = m_batchFirst; i < m_statements.size(); ++i) {
+            m_statements[i].repeat = repeat;
+        }
+        if (m_batchFirst < m_statements.size()) {
+            ++m_batch;
+        }
+        m_batchFirst = m_statements.size();
+        m_wholeBatch = false;
+    }
+
+    /// If the line at m_index is `GO [count] [-- comment]`, consume it and return the count (else 0)
+    [[nodiscard]] size_t matchGo() noexcept {
+        const auto& tokens = m_tokens.tokens;
+        if (!m_tokens.isKeyword(tokens[m_index], "GO")) {
+            return 0;
+        }
+        // Tokens that follow on the same line are the ones not starting a line
+        size_t i = m_index + 1;
+        auto sameLine = [&] { return i < tokens.size() && !tokens[i].lineStart; };
+        size_t count = 1;
+        if (sameLine() && tokens[i].kind == SqlTokenKind::Number) {
+            const auto digits = m_tokens.text(tokens[i]);
+            if (!std::ranges::all_of(digits, [](unsigned char c) { return std::isdigit(c) != 0; })) {
+                return 0;
+            }
+            count = 0;
+            for (char c : digits) {
+                count = (std::min)(count * 10 + static_cast<size_t>(c - '0'), SQLParser::MAX_BATCH_REPEAT);
+            }
+            ++i;
+        }
+        if (sameLine() && tokens[i].kind == SqlTokenKind::LineComment) {
+            ++i;
+        }
+        if (sameLine()) {
+            return 0;
+        }
+        m_index = i - 1;
+        return (std::max)(count, size_t{1});
+    }
 
-        // Remove brackets if present: [database] -> database
-        if (result.database.front() == '[' && result.database.back() == ']') {
-            result.database = result.database.substr(1, result.database.length() - 2);
+    /// Next token if it is a word, past whitespace only (empty if something else comes first)
+    [[nodiscard]] std::string_view peekWord() const noexcept {
+        const size_t i = m_index + 1;
+        if (i >= m_tokens.tokens.size() || (m_tokens.tokens[i].kind != SqlTokenKind::Word && m_tokens.tokens[i].kind != SqlTokenKind::Number)) {
+            return {};
         }
+        return m_tokens.text(m_tokens.tokens[i]);
+    }
 
+    void onWord(std::string_view word) noexcept {
+        const size_t index = m_words++;
+        if (word.size() < 2 || word.size() > 9) {
+            m_ddlPrefix = DdlPrefix::None;
+            return;
+        }
+        // CREATE [OR ALTER] / ALTER of a module: the body runs to the end of the batch
+        if (index == 0 && (equalsIgnoreCase(word, "CREATE") || equalsIgnoreCase(word, "ALTER"))) {
+            m_ddlPrefix = DdlPrefix::Verb;
+            return;
+        }
+        if (m_ddlPrefix == DdlPrefix::Verb && equalsIgnoreCase(word, "OR")) {
+            m_ddlPrefix = DdlPrefix::Or;
+            return;
+        }
+        if (m_ddlPrefix == DdlPrefix::Or && equalsIgnoreCase(word, "ALTER")) {
+            m_ddlPrefix = DdlPrefix::Verb;
+            return;
+        }
+        if (m_ddlPrefix == DdlPrefix::Verb) {
+            constexpr std::string_view modules[] = {"PROC", "PROCEDURE", "FUNCTION", "TRIGGER", "VIEW"};
+            m_wholeBatch = m_wholeBatch || std::ranges::any_of(modules, [&](std::string_view kind) { return equalsIgnoreCase(word, kind); });
+        }
+        m_ddlPrefix = DdlPrefix::None;
+
+        if (equalsIgnoreCase(word, "BEGIN")) {
+            // BEGIN TRAN[SACTION] / DISTRIBUTED / DIALOG / CONVERSATION are statements, not blocks
+            const auto next = peekWord();
+            constexpr std::string_view statements[] = {"TRAN", "TRANSACTION", "DISTRIBUTED", "DIALOG", "CONVERSATION"};
+            if (!std::ranges::any_of(statements, [&](std::string_view kind) { return equalsIgnoreCase(next, kind); })) {
+                ++m_blockDepth;
+            }
+        } else if (equalsIgnoreCase(word, "CASE")) {
+            ++m_blockDepth;
+        } else if (equalsIgnoreCase(word, "END") && m_blockDepth > 0 && !equalsIgnoreCase(peekWord(), "CONVERSATION")) {
+            --m_blockDepth;
+        }
+    }
+
+    enum class DdlPrefix : uint8_t { None, Verb, Or };
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    SqlTokens m_tokens;
+    std::vector<SqlStatementSpan> m_statements;
+    size_t m_index = 0;
+    size_t m_start = NONE;    ///< First token of the current statement
+    size_t m_blockDepth = 0;  ///< Open BEGIN / CASE blocks
+    size_t m_words = 0;       ///< Words seen in the current statement
+    DdlPrefix m_ddlPrefix = DdlPrefix::None;
+    bool m_wholeBatch = false;  ///< A module body: ';' no longer ends the statement
+    size_t m_batch = 0;
+    size_t m_batchFirst = 0;  ///< First statement of the current batch
+};
+
+}  // namespace
+
+std::string SQLParser::toLower(std::string_view str) {
+    std::string result(str);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+ParsedSQL SQLParser::parseSQL(std::string_view sql) {
+    auto result = parseSQL(SqlTokenStream(sql));
+    result.originalSQL = std::string(sql);
+    return result;
+}
+
+ParsedSQL SQLParser::parseSQL(SqlTokens tokens) {
+    ParsedSQL result;
+    result.originalSQL = std::string(tokens.source());
+
+    const auto code = codeTokens(tokens, true);
+    if (code.empty()) {
+        result.type = "EMPTY";
         return result;
     }
+    const SqlTokens view{tokens.sql, code};
 
-    // Detect other common statement types
-    if (upperSQL.starts_with("SELECT")) {
-        result.type = "SELECT";
-    } else if (upperSQL.starts_with("INSERT")) {
-        result.type = "INSERT";
-    } else if (upperSQL.starts_with("UPDATE")) {
-        result.type = "UPDATE";
-    } else if (upperSQL.starts_with("DELETE")) {
-        result.type = "DELETE";
-    } else if (upperSQL.starts_with("CREATE")) {
-        result.type = "CREATE";
-    } else if (upperSQL.starts_with("ALTER")) {
-        result.type = "ALTER";
-    } else if (upperSQL.starts_with("DROP")) {
-        result.type = "DROP";
-    } else if (upperSQL.starts_with("EXEC") || upperSQL.starts_with("EXECUTE")) {
-        result.type = "EXECUTE";
-    } else if (upperSQL.starts_with("BEGIN")) {
-        result.type = "BEGIN";
-    } else if (upperSQL.starts_with("COMMIT")) {
-        result.type = "COMMIT";
-    } else if (upperSQL.starts_with("ROLLBACK")) {
-        result.type = "ROLLBACK";
-    } else {
-        result.type = "OTHER";
+    // USE <database_name> (with optional semicolon)
+    if (view.isKeyword(code[0], "USE") && code.size() >= 2 && isDatabaseName(view, code[1]) && (code.size() == 2 || (code.size() == 3 && isSymbol(view, code[2], ';')))) {
+        result.type = "USE";
+        // Brackets are dropped: [database] -> database
+        result.database = std::string(view.name(code[1]));
+        return result;
     }
 
+    // Detect other common statement types by the first word
+    constexpr std::pair<std::string_view, std::string_view> statementTypes[] = {
+        {"SELECT", "SELECT"}, {"INSERT", "INSERT"},   {"UPDATE", "UPDATE"}, {"DELETE", "DELETE"}, {"CREATE", "CREATE"},     {"ALTER", "ALTER"},
+        {"DROP", "DROP"},     {"EXEC", "EXECUTE"},    {"EXECUTE", "EXECUTE"}, {"BEGIN", "BEGIN"},   {"COMMIT", "COMMIT"}, {"ROLLBACK", "ROLLBACK"},
+    };
+    const auto match = std::ranges::find_if(statementTypes, [&](const auto& entry) { return view.isKeyword(code[0], entry.first); });
+    result.type = match != std::ranges::end(statementTypes) ? match->second : "OTHER";
     return result;
 }
 
 bool SQLParser::isUseStatement(std::string_view sql) {
-    auto parsed = parseSQL(sql);
-    return parsed.type == "USE";
+    return isUseStatement(SqlTokenStream(sql));
+}
+
+bool SQLParser::isUseStatement(SqlTokens tokens) {
+    return parseSQL(tokens).type == "USE";
 }
 
 std::string SQLParser::extractDatabaseName(std::string_view sql) {
-    auto parsed = parseSQL(sql);
-    return parsed.database;
+    return extractDatabaseName(SqlTokenStream(sql));
+}
+
+std::string SQLParser::extractDatabaseName(SqlTokens tokens) {
+    return parseSQL(tokens).database;
 }
 
 bool SQLParser::isReadOnlyQuery(std::string_view sql) {
-    auto trimmed = trim(sql);
-    constexpr auto ci = [](unsigned char a, unsigned char b) constexpr {
-        constexpr auto lo = [](unsigned char c) constexpr -> unsigned char { return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + 32) : c; };
-        return lo(a) == lo(b);
-    };
-    using namespace std::string_view_literals;
-    if (std::ranges::starts_with(trimmed, "select"sv, ci))
+    return isReadOnlyQuery(SqlTokenStream(sql));
+}
+
+bool SQLParser::isReadOnlyQuery(SqlTokens tokens) {
+    const auto first = std::ranges::find_if(tokens.tokens, [](const SqlToken& token) { return !token.isComment(); });
+    if (first == tokens.tokens.end()) {
+        return false;
+    }
+    if (tokens.isKeyword(*first, "SELECT")) {
         return true;
-    if (!std::ranges::starts_with(trimmed, "with"sv, ci))
+    }
+    if (!tokens.isKeyword(*first, "WITH")) {
         return false;
-    // WITH ... may be CTE + DML. Check that no INSERT/UPDATE/DELETE/MERGE appears outside string literals.
-    // Simple heuristic: find last top-level SELECT/INSERT/UPDATE/DELETE/MERGE keyword.
-    auto upper = toUpper(trimmed);
+    }
+    // WITH ... may be CTE + DML; words are never inside literals or comments, so any DML keyword is real
     constexpr std::string_view dmlKeywords[] = {"INSERT", "UPDATE", "DELETE", "MERGE"};
-    return std::ranges::none_of(dmlKeywords, [&](auto kw) { return upper.find(kw) != std::string::npos; });
+    return std::ranges::none_of(tokens.tokens, [&](const SqlToken& token) { return std::ranges::any_of(dmlKeywords, [&](auto kw) { return tokens.isKeyword(token, kw); }); });
+}
+
+bool SQLParser::isSessionIndependent(std::string_view sql) {
+    return isSessionIndependent(SqlTokenStream(sql));
+}
+
+bool SQLParser::isSessionIndependent(SqlTokens tokens) {
+    const auto statements = splitScript(tokens);
+    if (statements.empty() || !std::ranges::all_of(statements, [&](const SqlStatementSpan& stmt) { return isReadOnlyQuery(tokens.subspan(stmt.firstToken, stmt.tokenCount)); })) {
+        return false;
+    }
+    // Temp tables only exist on the session that created them
+    return std::ranges::none_of(tokens.tokens, [&](const SqlToken& token) { return tokens.isKeyword(token, "INTO") || (isIdentifier(token) && tokens.name(token).starts_with('#')); });
+}
+
+std::vector<SqlStatementSpan> SQLParser::splitScript(std::string_view sql) {
+    return splitScript(SqlTokenStream(sql));
+}
+
+std::vector<SqlStatementSpan> SQLParser::splitScript(SqlTokens tokens) {
+    return ScriptSplitter(tokens).split();
+}
+
+std::vector<SqlTokens> SQLParser::splitStatementTokens(SqlTokens tokens) {
+    const auto spans = splitScript(tokens);
+    std::vector<SqlTokens> statements;
+    statements.reserve(spans.size());
+    for (size_t first = 0; first < spans.size();) {
+        size_t last = first;
+        while (last < spans.size() && spans[last].batch == spans[first].batch) {
+            ++last;
+        }
+        for (size_t run = 0; run < spans[first].repeat; ++run) {
+            for (size_t i = first; i < last; ++i) {
+                statements.push_back(tokens.subspan(spans[i].firstToken, spans[i].tokenCount));
+            }
+        }
+        first = last;
+    }
+    return statements;
 }
 
 std::vector<std::string> SQLParser::splitStatements(std::string_view sql) {
+    return splitStatements(SqlTokenStream(sql));
+}
+
+std::vector<std::string> SQLParser::splitStatements(SqlTokens tokens) {
+    const auto statementTokens = splitStatementTokens(tokens);
     std::vector<std::string> statements;
-    for (auto part : sql | std::views::split(';')) {
-        auto trimmed = trim({part.begin(), part.end()});
-        if (!trimmed.empty())
-            statements.emplace_back(trimmed);
+    statements.reserve(statementTokens.size());
+    for (const auto& statement : statementTokens) {
+        statements.emplace_back(statement.source());
     }
     return statements;
 }
 
+bool SQLParser::fitsSingleBatch(std::string_view sql) {
+    return fitsSingleBatch(SqlTokenStream(sql));
+}
+
+bool SQLParser::fitsSingleBatch(SqlTokens tokens) {
+    const auto spans = splitScript(tokens);
+    for (size_t i = 0; i < spans.size(); ++i) {
+        if (spans[i].batch != spans.front().batch || spans[i].repeat != 1) {
+            return false;
+        }
+        if (i == 0) {
+            continue;
+        }
+        // CREATE [OR ALTER] <kind> / ALTER <kind>
+        const auto code = codeTokens(tokens.subspan(spans[i].firstToken, spans[i].tokenCount), false);
+        const SqlTokens view{tokens.sql, code};
+        size_t pos = 0;
+        if (pos < code.size() && view.isKeyword(code[pos], "CREATE")) {
+            ++pos;
+            if (pos + 1 < code.size() && view.isKeyword(code[pos], "OR") && view.isKeyword(code[pos + 1], "ALTER")) {
+                pos += 2;
+            }
+        } else if (pos < code.size() && view.isKeyword(code[pos], "ALTER")) {
+            ++pos;
+        } else {
+            continue;
+        }
+        constexpr std::string_view batchFirst[] = {"PROC", "PROCEDURE", "FUNCTION", "TRIGGER", "VIEW", "SCHEMA", "DEFAULT", "RULE"};
+        if (pos < code.size() && std::ranges::any_of(batchFirst, [&](std::string_view kind) { return view.isKeyword(code[pos], kind); })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> SQLParser::extractTableReferences(std::string_view sql) {
+    return extractTableReferences(SqlTokenStream(sql));
+}
+
+std::vector<std::string> SQLParser::extractTableReferences(SqlTokens tokens) {
+    constexpr std::string_view tableKeywords[] = {"FROM", "JOIN", "INTO", "UPDATE", "USING", "TABLE"};
+    const auto code = codeTokens(tokens, false);
+    const SqlTokens view{tokens.sql, code};
+
+    std::vector<std::string> tables;
+    auto addTable = [&](std::string_view name) {
+        if (!name.empty() && name.front() != '@') {
+            tables.push_back(toLower(name));
+        }
+    };
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        const auto& token = code[i];
+        const bool tableKeyword = std::ranges::any_of(tableKeywords, [&](auto kw) { return view.isKeyword(token, kw); });
+        // DELETE [FROM] t / INSERT [INTO] t / MERGE [INTO] t; the FROM / INTO forms are handled by the keyword itself
+        const bool dmlKeyword = view.isKeyword(token, "DELETE") || view.isKeyword(token, "INSERT") || view.isKeyword(token, "MERGE");
+        const bool bareTarget = dmlKeyword && i + 1 < code.size() && !view.isKeyword(code[i + 1], "FROM") && !view.isKeyword(code[i + 1], "INTO");
+        if (!tableKeyword && !bareTarget) {
+            continue;
+        }
+
+        size_t pos = i + 1;
+        auto name = readObjectName(view, pos);
+        if (!name) {
+            continue;
+        }
+        addTable(*name);
+
+        // FROM a, b x, c AS y
+        if (!view.isKeyword(token, "FROM")) {
+            continue;
+        }
+        while (true) {
+            size_t next = pos;
+            if (next < code.size() && view.isKeyword(code[next], "AS")) {
+                ++next;
+            }
+            if (next < code.size() && isIdentifier(code[next])) {
+                ++next;
+            }
+            if (next >= code.size() || !isSymbol(view, code[next], ',')) {
+                break;
+            }
+            pos = next + 1;
+            auto listed = readObjectName(view, pos);
+            if (!listed) {
+                break;
+            }
+            addTable(*listed);
+        }
+    }
+
+    std::ranges::sort(tables);
+    auto duplicates = std::ranges::unique(tables);
+    tables.erase(duplicates.begin(), duplicates.end());
+    return tables;
+}
+
+std::string SQLParser::fingerprint(std::string_view sql, bool parameterizeLiterals) {
+    return fingerprint(SqlTokenStream(sql), parameterizeLiterals);
+}
+
+std::string SQLParser::fingerprint(SqlTokens tokens, bool parameterizeLiterals) {
+    std::string out;
+    out.reserve(tokens.sql.size());
+    for (const auto& token : tokens.tokens) {
+        if (token.isComment()) {
+            continue;
+        }
+        if (parameterizeLiterals && (token.kind == SqlTokenKind::Number || token.kind == SqlTokenKind::String)) {
+            // A literal right after "? ," continues the list the ? already stands for
+            if (out.ends_with("? ,")) {
+                out.resize(out.size() - 2);
+                continue;
+            }
+            out += out.empty() ? "?" : " ?";
+            continue;
+        }
+        if (!out.empty()) {
+            out += ' ';
+        }
+        const auto text = tokens.text(token);
+        if (token.kind == SqlTokenKind::Word && SQLFormatter::isBuiltInKeyword(text)) {
+            std::ranges::transform(text, std::back_inserter(out), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        } else {
+            out += text;
+        }
+    }
+    while (out.ends_with(';')) {
+        out.resize(out.size() > 1 ? out.size() - 2 : 0);
+    }
+    return out;
+}
+
+uint64_t SQLParser::fingerprintHash(std::string_view fingerprint) noexcept {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : fingerprint) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 }  // namespace velocitydb
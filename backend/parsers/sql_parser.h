@@ -1,5 +1,8 @@
 #pragma once
 
+#include "sql_lexer.h"
+
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -13,38 +16,97 @@ struct ParsedSQL {
     std::string originalSQL;  ///< Original SQL text
 };
 
-/// Simple SQL parser for detecting statement types and extracting metadata
+/// One statement of a script, viewing into the script text
+struct SqlStatementSpan {
+    std::string_view text;  ///< From the first token to the last, without the terminating ';' or leading comments
+    size_t offset = 0;      ///< Byte offset of `text` in the script
+    size_t line = 1;        ///< 1-based line `text` starts on
+    size_t batch = 0;       ///< Index of the GO-separated batch
+    size_t repeat = 1;      ///< Times the batch runs (GO <count>)
+    size_t firstToken = 0;  ///< Tokens of `text` in the lexed script: [firstToken, firstToken + tokenCount)
+    size_t tokenCount = 0;
+};
+
+/// Simple SQL parser for detecting statement types and extracting metadata.
+/// Every check also takes SqlTokens, so a caller holding a SqlTokenStream lexes a request once; the
+/// string_view forms lex their argument on each call.
 class SQLParser {
 public:
     /// Parse a SQL statement and return its type and metadata
     /// @param sql The SQL statement to parse
     /// @return ParsedSQL containing statement type and extracted metadata
     [[nodiscard]] static ParsedSQL parseSQL(std::string_view sql);
+    /// parseSQL() of lexed tokens; originalSQL is their source text
+    [[nodiscard]] static ParsedSQL parseSQL(SqlTokens tokens);
 
     /// Check if the SQL statement is a USE statement
     /// @param sql The SQL statement to check
     /// @return true if this is a USE statement, false otherwise
     [[nodiscard]] static bool isUseStatement(std::string_view sql);
+    [[nodiscard]] static bool isUseStatement(SqlTokens tokens);
 
     /// Extract the database name from a USE statement
     /// @param sql The USE statement to parse
     /// @return The database name, or empty string if not a valid USE statement
     [[nodiscard]] static std::string extractDatabaseName(std::string_view sql);
+    [[nodiscard]] static std::string extractDatabaseName(SqlTokens tokens);
 
-    /// Check if the SQL starts with SELECT or WITH (i.e. read-only query).
+    /// Check if the SQL starts with SELECT, or with WITH and no INSERT/UPDATE/DELETE/MERGE outside strings and
+    /// comments (i.e. read-only query). Leading comments are skipped.
     [[nodiscard]] static bool isReadOnlyQuery(std::string_view sql);
+    [[nodiscard]] static bool isReadOnlyQuery(SqlTokens tokens);
+
+    /// Check that every statement in `sql` is read-only and touches no session state (temp tables, SELECT INTO),
+    /// so any connection to the same database can run it
+    [[nodiscard]] static bool isSessionIndependent(std::string_view sql);
+    [[nodiscard]] static bool isSessionIndependent(SqlTokens tokens);
+
+    /// GO <count> values above this run the batch this many times
+    static constexpr size_t MAX_BATCH_REPEAT = 1000;
+
+    /// Split a T-SQL script in one pass, without copying. Statements end at a top-level ';' or at a GO line
+    /// (`GO [count]` alone on its line, optionally followed by a comment). Semicolons inside string literals,
+    /// quoted identifiers, comments (nested block comments included) and BEGIN...END / CASE...END blocks do not
+    /// split; CREATE/ALTER PROCEDURE, FUNCTION, TRIGGER and VIEW take the rest of their batch as their body.
+    /// Statements holding only comments are dropped.
+    /// @param sql The script; the returned views point into it
+    [[nodiscard]] static std::vector<SqlStatementSpan> splitScript(std::string_view sql);
+    [[nodiscard]] static std::vector<SqlStatementSpan> splitScript(SqlTokens tokens);
 
-    /// Split SQL text into individual statements separated by semicolons
+    /// splitScript() as the tokens of each statement, with each batch repeated as its GO count says
+    [[nodiscard]] static std::vector<SqlTokens> splitStatementTokens(SqlTokens tokens);
+
+    /// splitScript() as owned strings, with each batch repeated as its GO count says
     /// @param sql The SQL text containing one or more statements
     /// @return Vector of individual SQL statements (trimmed, non-empty)
     [[nodiscard]] static std::vector<std::string> splitStatements(std::string_view sql);
+    [[nodiscard]] static std::vector<std::string> splitStatements(SqlTokens tokens);
 
-private:
-    /// Trim whitespace from both ends of a string view
-    [[nodiscard]] static std::string_view trim(std::string_view str);
+    /// Check that the script can go to the server as one batch: no GO separators or repeat counts, and no
+    /// statement after the first that must start its own batch (CREATE/ALTER of a procedure, function, trigger,
+    /// view, schema, default or rule)
+    [[nodiscard]] static bool fitsSingleBatch(std::string_view sql);
+    [[nodiscard]] static bool fitsSingleBatch(SqlTokens tokens);
+
+    /// Extract the tables a statement reads or writes (names after FROM, JOIN, INTO, UPDATE, DELETE, MERGE, USING, TABLE)
+    /// Comments and string literals are skipped; table variables (@t) and derived tables are ignored.
+    /// @param sql The SQL text to scan
+    /// @return Lower-cased object names without database/schema prefix or brackets, sorted and unique
+    [[nodiscard]] static std::vector<std::string> extractTableReferences(std::string_view sql);
+    [[nodiscard]] static std::vector<std::string> extractTableReferences(SqlTokens tokens);
 
-    /// Convert string to uppercase for case-insensitive comparison
-    [[nodiscard]] static std::string toUpper(std::string_view str);
+    /// Normalized text of a query, equal for queries that differ only in layout: comments dropped, tokens joined
+    /// by single spaces, built-in keywords upper-cased and trailing semicolons removed. Identifiers keep their case,
+    /// since a case-sensitive collation tells them apart. With `parameterizeLiterals`, numbers and strings become ?
+    /// and a comma-separated run of them one ?, so IN (1, 2) and IN (3, 4, 5) share a fingerprint.
+    [[nodiscard]] static std::string fingerprint(std::string_view sql, bool parameterizeLiterals = false);
+    [[nodiscard]] static std::string fingerprint(SqlTokens tokens, bool parameterizeLiterals = false);
+    /// 64-bit FNV-1a of a fingerprint, for grouping by it
+    [[nodiscard]] static uint64_t fingerprintHash(std::string_view fingerprint) noexcept;
+
+private:
+    /// Convert string to lowercase for normalized identifiers
+    [[nodiscard]] static std::string toLower(std::string_view str);
 };
 
 }  // namespace velocitydb
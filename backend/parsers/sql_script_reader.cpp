@@ -0,0 +1,119 @@
+#include "sql_script_reader.h"
+
+#include "sql_parser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <stdexcept>
+
+namespace velocitydb {
+
+SqlScriptReader::SqlScriptReader(std::string_view script, size_t maxBatchTokens)
+    : m_script(script), m_lexer(script), m_maxBatchTokens((std::max)(maxBatchTokens, size_t{2})), m_splitAt(m_maxBatchTokens) {}
+
+bool SqlScriptReader::readToken(SqlToken& token) noexcept {
+    if (m_pending) {
+        token = *m_pending;
+        m_pending.reset();
+        return true;
+    }
+    return m_lexer.next(token);
+}
+
+size_t SqlScriptReader::goCount(const std::vector<SqlToken>& line) const noexcept {
+    const SqlTokens tokens{m_script, line};
+    size_t i = 1;
+    size_t count = 1;
+    if (i < line.size() && line[i].kind == SqlTokenKind::Number) {
+        const auto digits = tokens.text(line[i]);
+        if (!std::ranges::all_of(digits, [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            return 0;
+        }
+        count = 0;
+        for (char c : digits) {
+            count = (std::min)(count * 10 + static_cast<size_t>(c - '0'), SQLParser::MAX_BATCH_REPEAT);
+        }
+        ++i;
+    }
+    if (i < line.size() && line[i].kind == SqlTokenKind::LineComment) {
+        ++i;
+    }
+    return i == line.size() ? (std::max)(count, size_t{1}) : 0;
+}
+
+std::optional<ScriptBatch> SqlScriptReader::next() {
+    SqlToken token;
+    std::vector<SqlToken> line;
+    while (readToken(token)) {
+        if (token.lineStart && SqlTokens{m_script, {&token, 1}}.isKeyword(token, "GO")) {
+            // `GO [count] [-- comment]` has at most three tokens; a fourth on the line rules it out
+            line.assign(1, token);
+            while (line.size() <= 3 && readToken(token)) {
+                if (token.lineStart) {
+                    m_pending = token;
+                    break;
+                }
+                line.push_back(token);
+            }
+            if (const size_t repeat = goCount(line)) {
+                if (auto batch = takeBatch(repeat)) {
+                    return batch;
+                }
+                continue;
+            }
+            m_window.insert(m_window.end(), line.begin(), line.end());
+        } else {
+            m_window.push_back(token);
+        }
+        if (m_window.size() >= m_splitAt) {
+            if (auto part = takePart()) {
+                return part;
+            }
+        }
+    }
+    return takeBatch(1);
+}
+
+std::optional<ScriptBatch> SqlScriptReader::takeBatch(size_t repeat) {
+    const auto first = std::ranges::find_if(m_window, [](const SqlToken& token) { return !token.isComment(); });
+    std::optional<ScriptBatch> batch;
+    if (first != m_window.end()) {
+        batch = ScriptBatch{.text = m_script.substr(first->offset, m_window.back().end() - first->offset),
+                            .offset = first->offset,
+                            .line = first->line,
+                            .index = m_batchIndex,
+                            .repeat = m_batchSplit ? 1 : repeat,
+                            .partial = m_batchSplit};
+    }
+    if (batch || m_batchSplit) {
+        ++m_batchIndex;
+    }
+    m_window.clear();
+    m_splitAt = m_maxBatchTokens;
+    m_batchSplit = false;
+    return batch;
+}
+
+std::optional<ScriptBatch> SqlScriptReader::takePart() {
+    const auto spans = SQLParser::splitScript(SqlTokens{m_script, m_window});
+    if (spans.size() < 2) {
+        // One statement so far (a module body, or a huge INSERT): hold on until it ends
+        if (m_window.size() >= m_maxBatchTokens * MAX_STATEMENT_FACTOR) [[unlikely]] {
+            const auto first = std::ranges::find_if(m_window, [](const SqlToken& token) { return !token.isComment(); });
+            throw std::runtime_error(std::format("Statement at line {} is too large to run from a script file ({} tokens)", first->line, m_window.size()));
+        }
+        m_splitAt = m_window.size() + m_maxBatchTokens;
+        return std::nullopt;
+    }
+    // Every statement but the last, which may still be running on
+    const auto& head = spans.front();
+    const auto& tail = spans[spans.size() - 2];
+    ScriptBatch part{.text = m_script.substr(head.offset, tail.offset + tail.text.size() - head.offset), .offset = head.offset, .line = head.line, .index = m_batchIndex, .partial = true};
+    m_window.erase(m_window.begin(), m_window.begin() + static_cast<std::ptrdiff_t>(spans.back().firstToken));
+    m_splitAt = m_window.size() + m_maxBatchTokens;
+    m_batchSplit = true;
+    return part;
+}
+
+}  // namespace velocitydb
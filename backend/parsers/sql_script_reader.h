@@ -0,0 +1,64 @@
+#pragma once
+
+#include "sql_lexer.h"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// One unit of a streamed script to send to the server
+struct ScriptBatch {
+    std::string_view text;  ///< Into the script: from the first code token to the end of the last token
+    size_t offset = 0;      ///< Byte offset of `text` in the script
+    size_t line = 1;        ///< 1-based line `text` starts on
+    size_t index = 0;       ///< GO-separated batch it belongs to
+    size_t repeat = 1;      ///< Times to run it (GO <count>)
+    bool partial = false;   ///< Some statements of a batch too large to hold at once (see SqlScriptReader)
+};
+
+/// Splits a script into GO batches while lexing it, holding the tokens of one batch at a time, so a script of
+/// any size (e.g. a memory-mapped multi-GB dump) is never tokenized or copied as a whole.
+///
+/// GO lines are recognized as SQLParser::splitScript() does. A batch that grows past `maxBatchTokens` is cut at
+/// statement boundaries (splitScript() on the tokens held) and sent in parts: variables do not carry over from
+/// one part to the next, and the parts run once whatever the GO count. Dumps, which are long runs of INSERTs,
+/// split cleanly; a module body (CREATE PROCEDURE ...) is never cut.
+class SqlScriptReader {
+public:
+    static constexpr size_t DEFAULT_MAX_BATCH_TOKENS = size_t{1} << 20;
+    /// A single statement may hold this many times maxBatchTokens before the script is rejected
+    static constexpr size_t MAX_STATEMENT_FACTOR = 16;
+
+    /// @throws std::length_error when `script` is too large for 32-bit token offsets
+    explicit SqlScriptReader(std::string_view script, size_t maxBatchTokens = DEFAULT_MAX_BATCH_TOKENS);
+
+    /// The next batch or part; nullopt at the end of the script
+    /// @throws std::runtime_error when one statement exceeds the statement limit
+    [[nodiscard]] std::optional<ScriptBatch> next();
+
+    /// Bytes lexed so far
+    [[nodiscard]] size_t position() const noexcept { return m_lexer.position(); }
+
+private:
+    [[nodiscard]] bool readToken(SqlToken& token) noexcept;
+    /// GO count when `line` is a GO line (`GO [count] [-- comment]`), else 0
+    [[nodiscard]] size_t goCount(const std::vector<SqlToken>& line) const noexcept;
+    /// The held tokens as a batch, if they hold any code; starts the next batch
+    [[nodiscard]] std::optional<ScriptBatch> takeBatch(size_t repeat);
+    /// The complete statements held but the last, if there are any
+    [[nodiscard]] std::optional<ScriptBatch> takePart();
+
+    std::string_view m_script;
+    SqlLexer m_lexer;
+    const size_t m_maxBatchTokens;
+    std::vector<SqlToken> m_window;  ///< Tokens of the current batch not sent yet
+    std::optional<SqlToken> m_pending;
+    size_t m_splitAt;
+    size_t m_batchIndex = 0;
+    bool m_batchSplit = false;
+};
+
+}  // namespace velocitydb
@@ -1,50 +1,168 @@
 #include "async_query_provider.h"
 
+#include "../database/admission_controller.h"
 #include "../database/async_query_executor.h"
+#include "../database/live_query_stats.h"
 #include "../database/sqlserver_driver.h"
 #include "../interfaces/providers/connection_provider.h"
+#include "../parsers/sql_parser.h"
 #include "../utils/json_utils.h"
+#include "../utils/filter_expression.h"
+#include "../utils/sql_validation.h"
 #include "simdjson.h"
 
+#include <algorithm>
 #include <format>
 
 namespace velocitydb {
 
-AsyncQueryProvider::AsyncQueryProvider(IConnectionProvider& connections) : m_connections(connections), m_asyncExecutor(std::make_unique<AsyncQueryExecutor>()) {}
+namespace {
 
-AsyncQueryProvider::~AsyncQueryProvider() = default;
+constexpr std::string_view statusName(QueryStatus status) noexcept {
+    switch (status) {
+        case QueryStatus::Pending:
+            return "pending";
+        case QueryStatus::Running:
+            return "running";
+        case QueryStatus::Completed:
+            return "completed";
+        case QueryStatus::Cancelled:
+            return "cancelled";
+        case QueryStatus::Failed:
+            return "failed";
+    }
+    return "failed";
+}
 
-std::string AsyncQueryProvider::handleExecuteAsyncQuery(std::string_view params) {
-    try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+constexpr size_t DEFAULT_ROW_PAGE_SIZE = 1000;
+constexpr size_t MAX_ROW_PAGE_SIZE = 50000;
+
+/// Row estimate (sys.partitions needs no VIEW DATABASE STATE, unlike dm_db_partition_stats), object type and
+/// clustered key of the table named by the parameter
+constexpr std::string_view OPEN_TABLE_INFO_QUERY = R"(SELECT o.type,
+       (SELECT SUM(p.rows) FROM sys.partitions p WHERE p.object_id = o.object_id AND p.index_id IN (0, 1)) AS estimated_rows,
+       (SELECT STRING_AGG(CAST(QUOTENAME(c.name) AS nvarchar(max)) + CASE WHEN ic.is_descending_key = 1 THEN N' DESC' ELSE N'' END, N', ') WITHIN GROUP (ORDER BY ic.key_ordinal)
+        FROM sys.index_columns ic JOIN sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id
+        WHERE ic.object_id = o.object_id AND ic.index_id = 1 AND ic.key_ordinal > 0) AS clustered_key
+FROM sys.objects o
+WHERE o.object_id = OBJECT_ID(?))";
+
+}  // namespace
+
+AsyncQueryProvider::AsyncQueryProvider(IConnectionProvider& connections)
+    : m_connections(connections), m_liveStats(std::make_unique<LiveQueryStatsPoller>([this](const LiveQueryStats& stats) { publishLiveStats(stats); })),
+      m_asyncExecutor(std::make_unique<AsyncQueryExecutor>()) {}
+
+AsyncQueryProvider::~AsyncQueryProvider() {
+    // Samples read the executor, which is destroyed before the poller: none may be published past this point
+    std::lock_guard lock(m_sinkMutex);
+    m_eventSink = nullptr;
+}
+
+void AsyncQueryProvider::setEventSink(EventSink sink) {
+    {
+        std::lock_guard lock(m_sinkMutex);
+        m_eventSink = sink;
+    }
+    if (!sink) {
+        m_asyncExecutor->setStatusListener(nullptr);
+        return;
+    }
+    m_asyncExecutor->setStatusListener([sink = std::move(sink)](std::string_view queryId, QueryStatus status, size_t rowsFetched) {
+        sink(std::format(R"({{"queryId":"{}","status":"{}","rowsFetched":{}}})", queryId, statusName(status), rowsFetched));
+    });
+}
 
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
+void AsyncQueryProvider::publishLiveStats(const LiveQueryStats& stats) {
+    std::lock_guard lock(m_sinkMutex);
+    if (!m_eventSink) {
+        return;
+    }
+    const auto rowsFetched = m_asyncExecutor->getQueryResult(stats.queryId).rowsFetched;
+    std::string json = std::format(R"({{"queryId":"{}","status":"running","rowsFetched":{},"live":{{"sessionId":{},"percentComplete":{},"elapsedMs":{},"cpuMs":{},"logicalReads":{},"waitType":")",
+                                   stats.queryId, rowsFetched, stats.sessionId, stats.percentComplete, stats.elapsedMs, stats.cpuMs, stats.logicalReads);
+    JsonUtils::appendEscaped(json, stats.waitType);
+    json += R"(","operators":)";
+    json += JsonUtils::buildArray(stats.operators, [](std::string& out, const LiveOperatorStats& op) {
+        out += std::format(R"({{"id":{},"physicalOp":")", op.nodeId);
+        JsonUtils::appendEscaped(out, op.physicalOp);
+        out += std::format(R"(","rows":{},"estimatedRows":{}}})", op.rows, op.estimatedRows);
+    });
+    json += "}}";
+    m_eventSink(json);
+}
+
+std::string AsyncQueryProvider::handleExecuteAsyncQuery(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
         if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or sql");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto sqlQuery = std::string(sqlQueryResult.value());
 
-        auto driver = m_connections.getQueryDriver(connectionId);
+        auto lane = m_connections.acquireQueryLane(connectionId, SQLParser::isSessionIndependent(sqlQuery));
+        auto driver = lane.driver();
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
+        QuerySubmitOptions options{.connectionId = connectionId};
+        if (auto priority = params["priority"].get_string(); !priority.error() && priority.value() == "background") {
+            options.priority = QueryPriority::Background;
+        }
+        // Tabs take turns when the server is saturated; without a tab id the connection stands in for one
+        options.admission = AdmissionRequest{.server = AdmissionController::serverKey(m_connections.getCacheIdentity(connectionId)),
+                                             .owner = connectionId,
+                                             .kind = options.priority == QueryPriority::Background ? AdmissionClass::Background : AdmissionClass::Interactive};
+        if (auto tabId = params["tabId"].get_string(); !tabId.error() && !tabId.value().empty()) {
+            options.admission.owner = tabId.value();
+        }
+        if (auto maxRows = params["maxRows"].get_uint64(); !maxRows.error()) {
+            options.maxRows = static_cast<size_t>(maxRows.value());
+        }
+
+        if (auto parallel = params["parallel"].get_bool(); !parallel.error() && parallel.value()) {
+            // Independent reads run on other lanes, so a USE must only take effect for them once it has executed
+            options.checkoutLane = [this, connectionId] { return m_connections.acquireQueryLane(connectionId, true); };
+            options.onDatabaseChange = [this, connectionId](std::string_view database) { m_connections.noteDatabaseChange(connectionId, database); };
+        } else {
+            // Session-lane batches may switch database; record it up front so other lanes follow
+            for (const auto& stmt : SQLParser::splitStatements(sqlQuery)) {
+                if (SQLParser::isUseStatement(stmt)) {
+                    m_connections.noteDatabaseChange(connectionId, SQLParser::extractDatabaseName(stmt));
+                }
+            }
+        }
+
+        if (auto liveStats = params["liveStats"].get_bool(); !liveStats.error() && liveStats.value()) {
+            // The DMVs are sampled from the metadata connection, keyed by the server session of the query's driver
+            options.onRunningChange = [this, connectionId](std::string_view queryId, IDatabaseDriver& queryDriver, bool running) {
+                if (!running) {
+                    m_liveStats->unwatch(queryId);
+                    return;
+                }
+                try {
+                    auto spid = queryDriver.execute("SELECT @@SPID");
+                    if (!spid.empty()) {
+                        m_liveStats->watch(std::string(queryId), std::stoi(spid.cellText(0, 0)), m_connections.getMetadataDriver(connectionId));
+                    }
+                } catch (const std::exception&) {
+                    // Statistics are best-effort; the query runs either way
+                }
+            };
+        }
 
-        std::string queryId = m_asyncExecutor->submitQuery(driver, sqlQuery);
+        std::string queryId = m_asyncExecutor->submitQuery(std::move(driver), sqlQuery, std::move(lane), std::move(options));
         return JsonUtils::successResponse(std::format(R"({{"queryId":"{}"}})", queryId));
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string AsyncQueryProvider::handleGetAsyncQueryResult(std::string_view params) {
+std::string AsyncQueryProvider::handleGetAsyncQueryResult(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto queryIdResult = doc["queryId"].get_string();
+        auto queryIdResult = params["queryId"].get_string();
         if (queryIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: queryId");
         }
@@ -54,30 +172,14 @@ std::string AsyncQueryProvider::handleGetAsyncQueryResult(std::string_view param
 
         AsyncQueryResult asyncResult = m_asyncExecutor->getQueryResult(queryId);
 
-        std::string statusStr;
-        switch (asyncResult.status) {
-            case QueryStatus::Pending:
-                statusStr = "pending";
-                break;
-            case QueryStatus::Running:
-                statusStr = "running";
-                break;
-            case QueryStatus::Completed:
-                statusStr = "completed";
-                break;
-            case QueryStatus::Cancelled:
-                statusStr = "cancelled";
-                break;
-            case QueryStatus::Failed:
-                statusStr = "failed";
-                break;
-        }
-
         std::string jsonResponse = "{";
-        jsonResponse += std::format(R"("queryId":"{}","status":"{}")", asyncResult.queryId, statusStr);
+        jsonResponse += std::format(R"("queryId":"{}","status":"{}","rowsFetched":{})", asyncResult.queryId, statusName(asyncResult.status), asyncResult.rowsFetched);
 
         if (!asyncResult.errorMessage.empty()) {
             jsonResponse += std::format(R"(,"error":"{}")", JsonUtils::escapeString(asyncResult.errorMessage));
+            if (asyncResult.retriable) {
+                jsonResponse += R"(,"retriable":true)";
+            }
         }
 
         if (asyncResult.multipleResults && !asyncResult.results.empty()) {
@@ -87,7 +189,7 @@ std::string AsyncQueryProvider::handleGetAsyncQueryResult(std::string_view param
                     jsonResponse += ",";
                 const auto& stmtResult = asyncResult.results[i];
                 jsonResponse += R"({"statement":")";
-                jsonResponse += JsonUtils::escapeString(stmtResult.statement);
+                JsonUtils::appendEscaped(jsonResponse, stmtResult.statement);
                 jsonResponse += R"(","data":)";
                 jsonResponse += JsonUtils::serializeResultSet(stmtResult.result, false);
                 jsonResponse += "}";
@@ -105,12 +207,74 @@ std::string AsyncQueryProvider::handleGetAsyncQueryResult(std::string_view param
     }
 }
 
-std::string AsyncQueryProvider::handleCancelAsyncQuery(std::string_view params) {
+std::string AsyncQueryProvider::handleGetAsyncQueryRows(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+        auto queryIdResult = params["queryId"].get_string();
+        if (queryIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: queryId");
+        }
+        auto statementIndex = params["statementIndex"].get_uint64();
+        auto offset = params["offset"].get_uint64();
+        auto limit = params["limit"].get_uint64();
+
+        auto page = m_asyncExecutor->getQueryRows(queryIdResult.value(), statementIndex.error() ? 0 : statementIndex.value(), offset.error() ? 0 : offset.value(),
+                                                  limit.error() ? DEFAULT_ROW_PAGE_SIZE : (std::min)(limit.value(), uint64_t{MAX_ROW_PAGE_SIZE}));
+
+        std::string jsonResponse = std::format(R"({{"queryId":"{}","status":"{}","statementCount":{},"statementComplete":{},"offset":{},"totalRows":{})", page.queryId,
+                                               statusName(page.status), page.statementCount, page.statementComplete ? "true" : "false", page.offset, page.totalRows);
+        if (!page.errorMessage.empty()) {
+            jsonResponse += std::format(R"(,"error":"{}")", JsonUtils::escapeString(page.errorMessage));
+            if (page.retriable) {
+                jsonResponse += R"(,"retriable":true)";
+            }
+        }
+        jsonResponse += ',';
+        JsonUtils::appendResultSetFields(jsonResponse, page.rows);
+        jsonResponse += '}';
+        return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
 
-        auto queryIdResult = doc["queryId"].get_string();
+std::string AsyncQueryProvider::handleFilterAsyncQueryRows(const IPCParams& params) {
+    try {
+        auto queryIdResult = params["queryId"].get_string();
+        if (queryIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: queryId");
+        }
+        auto expression = FilterExpression::fromRequest(params);
+        if (!expression) [[unlikely]] {
+            return JsonUtils::errorResponse(expression.error());
+        }
+        auto statementIndex = params["statementIndex"].get_uint64();
+        auto offset = params["offset"].get_uint64();
+        auto limit = params["limit"].get_uint64();
+
+        // The buffered rows are the result handle: filtering never goes back to the server
+        auto page = m_asyncExecutor->filterQueryRows(queryIdResult.value(), statementIndex.error() ? 0 : statementIndex.value(), [&](const ResultSet& rows) { return expression->evaluate(rows); },
+                                                     offset.error() ? 0 : offset.value(), limit.error() ? DEFAULT_ROW_PAGE_SIZE : (std::min)(limit.value(), uint64_t{MAX_ROW_PAGE_SIZE}));
+
+        std::string jsonResponse = std::format(R"({{"queryId":"{}","status":"{}","statementCount":{},"statementComplete":{},"offset":{},"totalRows":{},"filteredRows":{})", page.queryId,
+                                               statusName(page.status), page.statementCount, page.statementComplete ? "true" : "false", page.offset, page.totalRows, page.matchedRows);
+        if (!page.errorMessage.empty()) {
+            jsonResponse += std::format(R"(,"error":"{}")", JsonUtils::escapeString(page.errorMessage));
+            if (page.retriable) {
+                jsonResponse += R"(,"retriable":true)";
+            }
+        }
+        jsonResponse += ',';
+        JsonUtils::appendResultSetFields(jsonResponse, page.rows);
+        jsonResponse += '}';
+        return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string AsyncQueryProvider::handleCancelAsyncQuery(const IPCParams& params) {
+    try {
+        auto queryIdResult = params["queryId"].get_string();
         if (queryIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: queryId");
         }
@@ -121,12 +285,9 @@ std::string AsyncQueryProvider::handleCancelAsyncQuery(std::string_view params)
     }
 }
 
-std::string AsyncQueryProvider::handleRemoveAsyncQuery(std::string_view params) {
+std::string AsyncQueryProvider::handleRemoveAsyncQuery(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto queryIdResult = doc["queryId"].get_string();
+        auto queryIdResult = params["queryId"].get_string();
         if (queryIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: queryId");
         }
@@ -137,10 +298,146 @@ std::string AsyncQueryProvider::handleRemoveAsyncQuery(std::string_view params)
     }
 }
 
-std::string AsyncQueryProvider::handleGetActiveQueries(std::string_view) {
+std::string AsyncQueryProvider::handleOpenTable(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto tableResult = params["table"].get_string();
+        if (connectionIdResult.error() || tableResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId or table");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        const auto table = quoteBracketIdentifier(unquoteBracketIdentifier(tableResult.value()));
+        size_t rows = DEFAULT_ROW_PAGE_SIZE;
+        if (auto rowsResult = params["rows"].get_uint64(); !rowsResult.error() && rowsResult.value() > 0) {
+            rows = static_cast<size_t>((std::min<uint64_t>)(rowsResult.value(), MAX_ROW_PAGE_SIZE));
+        }
+        double samplePercent = 0;
+        if (auto sample = params["samplePercent"].get_double(); !sample.error()) {
+            samplePercent = std::clamp(sample.value(), 0.0, 100.0);
+        }
+        bool exactCount = true;
+        if (auto exact = params["exactCount"].get_bool(); !exact.error()) {
+            exactCount = exact.value();
+        }
+
+        std::string json;
+        {
+            auto lane = m_connections.acquireQueryLane(connectionId, true);
+            const auto& driver = lane.driver();
+            if (!driver) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+            }
+            auto info = driver->executePrepared(OPEN_TABLE_INFO_QUERY, {table});
+            if (info.empty()) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Table not found: {}", table));
+            }
+            const bool isTable = info.cellText(0, 0).starts_with('U');
+            const auto estimatedRows = info.isNull(0, 1) ? std::string("null") : info.cellText(0, 1);
+            const auto clusteredKey = info.isNull(0, 2) ? std::string() : info.cellText(0, 2);
+
+            // TABLESAMPLE picks whole pages, so a small table or percentage may come back empty: then the ordered TOP runs
+            const bool sampled = samplePercent > 0 && samplePercent < 100 && isTable;
+            ResultSet preview;
+            if (sampled) {
+                preview = driver->execute(std::format("SELECT TOP ({}) * FROM {} TABLESAMPLE SYSTEM ({:.4f} PERCENT)", rows, table, samplePercent));
+            }
+            if (!sampled || preview.empty()) {
+                // A clustered-key ORDER BY reads the index in order without sorting; heaps and views come in scan order
+                preview = driver->execute(clusteredKey.empty() ? std::format("SELECT TOP ({}) * FROM {}", rows, table)
+                                                               : std::format("SELECT TOP ({}) * FROM {} ORDER BY {}", rows, table, clusteredKey));
+            }
+            json = JsonUtils::serializeResultSet(preview, false);
+            json.pop_back();
+            json += std::format(R"(,"estimatedRows":{},"orderedBy":"{}","sampled":{})", estimatedRows, JsonUtils::escapeString(sampled && !preview.empty() ? std::string() : clusteredKey),
+                                sampled && !preview.empty() ? "true" : "false");
+        }
+
+        if (exactCount) {
+            // Queued behind interactive work and run on whichever lane is free, so the grid is never held up by the scan
+            auto countLane = m_connections.acquireQueryLane(connectionId, true);
+            auto countDriver = countLane.driver();
+            try {
+                if (countDriver) {
+                    auto queryId = m_asyncExecutor->submitQuery(std::move(countDriver), std::format("SELECT COUNT_BIG(*) AS total_rows FROM {} WITH (NOLOCK)", table),
+                                                                std::move(countLane),
+                                                                QuerySubmitOptions{.connectionId = connectionId,
+                                                                                   .priority = QueryPriority::Background,
+                                                                                   .admission = {.server = AdmissionController::serverKey(m_connections.getCacheIdentity(connectionId)),
+                                                                                                 .owner = connectionId,
+                                                                                                 .kind = AdmissionClass::Background}});
+                    json += std::format(R"(,"countQueryId":"{}")", queryId);
+                }
+            } catch (const std::exception&) {
+                // Queue full: the preview stands on its own and the estimate remains
+            }
+        }
+        json += '}';
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::string AsyncQueryProvider::handleGetActiveQueries(const IPCParams&) {
     auto activeIds = m_asyncExecutor->getActiveQueryIds();
-    auto jsonResponse = JsonUtils::buildArray(activeIds, [](std::string& out, const std::string& id) { out += std::format(R"("{}")", id); });
-    return JsonUtils::successResponse(jsonResponse);
+    auto stats = m_asyncExecutor->queueStats();
+    auto queries = JsonUtils::buildArray(activeIds, [](std::string& out, const std::string& id) { out += std::format(R"("{}")", id); });
+    return JsonUtils::successResponse(std::format(R"({{"queries":{},"workers":{},"busyWorkers":{},"queuedInteractive":{},"queuedBackground":{},"peakQueueDepth":{},"submitted":{},"rejected":{}}})", queries,
+                                                  stats.workers, stats.busyWorkers, stats.queuedInteractive, stats.queuedBackground, stats.peakQueueDepth, stats.submitted, stats.rejected));
+}
+
+std::string AsyncQueryProvider::handleGetAdmissionStats(const IPCParams& params) {
+    try {
+        auto& admission = AdmissionController::instance();
+        std::vector<AdmissionStats> servers;
+        if (auto connectionIdResult = params["connectionId"].get_string(); !connectionIdResult.error()) {
+            const auto server = AdmissionController::serverKey(m_connections.getCacheIdentity(connectionIdResult.value()));
+            // A server nothing has run on yet reports its limits and an empty queue
+            servers.push_back(admission.stats(server).value_or(AdmissionStats{.server = server, .limits = admission.limits(server)}));
+        } else {
+            servers = admission.stats();
+        }
+        auto json = JsonUtils::buildArray(servers, [](std::string& out, const AdmissionStats& stats) {
+            out += R"({"server":")";
+            JsonUtils::appendEscaped(out, stats.server);
+            out += std::format(R"(","maxConcurrent":{},"budget":{},"running":{},"weightInUse":{},"queued":{},"queuedOwners":{},"admitted":{},"delayed":{},"maxWaitMs":{:.1f}}})",
+                               stats.limits.maxConcurrent, stats.limits.budget, stats.running, stats.weightInUse, stats.queued, stats.queuedOwners, stats.admitted, stats.delayed, stats.maxWaitMs);
+        });
+        return JsonUtils::successResponse(std::format(R"({{"servers":{},"weights":{{"interactive":{},"background":{},"broadcast":{},"export":{}}}}})", json,
+                                                      AdmissionController::weight(AdmissionClass::Interactive), AdmissionController::weight(AdmissionClass::Background),
+                                                      AdmissionController::weight(AdmissionClass::Broadcast), AdmissionController::weight(AdmissionClass::Export)));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string AsyncQueryProvider::handleSetAdmissionLimits(const IPCParams& params) {
+    try {
+        auto& admission = AdmissionController::instance();
+        std::string server;
+        if (auto connectionIdResult = params["connectionId"].get_string(); !connectionIdResult.error()) {
+            server = AdmissionController::serverKey(m_connections.getCacheIdentity(connectionIdResult.value()));
+            if (server.empty()) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionIdResult.value()));
+            }
+        }
+        auto limits = admission.limits(server);
+        if (auto maxConcurrent = params["maxConcurrent"].get_uint64(); !maxConcurrent.error()) {
+            limits.maxConcurrent = static_cast<size_t>(maxConcurrent.value());
+        }
+        if (auto budget = params["budget"].get_uint64(); !budget.error()) {
+            limits.budget = static_cast<size_t>(budget.value());
+        }
+        if (server.empty()) {
+            admission.setDefaultLimits(limits);
+        } else {
+            admission.setLimits(server, limits);
+        }
+        limits = admission.limits(server);
+        return JsonUtils::successResponse(std::format(R"({{"maxConcurrent":{},"budget":{}}})", limits.maxConcurrent, limits.budget));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
 }
 
 }  // namespace velocitydb
@@ -3,6 +3,7 @@
 #include "../interfaces/providers/async_query_provider.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 
@@ -10,6 +11,8 @@ namespace velocitydb {
 
 class IConnectionProvider;
 class AsyncQueryExecutor;
+class LiveQueryStatsPoller;
+struct LiveQueryStats;
 
 /// Provider for asynchronous query execution
 class AsyncQueryProvider : public IAsyncQueryProvider {
@@ -22,14 +25,30 @@ public:
     AsyncQueryProvider(AsyncQueryProvider&&) = delete;
     AsyncQueryProvider& operator=(AsyncQueryProvider&&) = delete;
 
-    [[nodiscard]] std::string handleExecuteAsyncQuery(std::string_view params) override;
-    [[nodiscard]] std::string handleGetAsyncQueryResult(std::string_view params) override;
-    [[nodiscard]] std::string handleCancelAsyncQuery(std::string_view params) override;
-    [[nodiscard]] std::string handleGetActiveQueries(std::string_view params) override;
-    [[nodiscard]] std::string handleRemoveAsyncQuery(std::string_view params) override;
+    [[nodiscard]] std::string handleExecuteAsyncQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetAsyncQueryResult(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetAsyncQueryRows(const IPCParams& params) override;
+    [[nodiscard]] std::string handleFilterAsyncQueryRows(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelAsyncQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetActiveQueries(const IPCParams& params) override;
+    [[nodiscard]] std::string handleRemoveAsyncQuery(const IPCParams& params) override;
+    /// Params: connectionId, table, rows (default 1000), samplePercent (TABLESAMPLE SYSTEM; tables only),
+    /// exactCount (default true: COUNT_BIG(*) queued at background priority, reported as countQueryId)
+    [[nodiscard]] std::string handleOpenTable(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetAdmissionStats(const IPCParams& params) override;
+    /// Params: connectionId (optional), maxConcurrent, budget (each optional; the current value stays)
+    [[nodiscard]] std::string handleSetAdmissionLimits(const IPCParams& params) override;
+
+    void setEventSink(EventSink sink) override;
 
 private:
+    /// Push one live-statistics sample as an asyncQuery event
+    void publishLiveStats(const LiveQueryStats& stats);
+
     IConnectionProvider& m_connections;
+    std::mutex m_sinkMutex;
+    EventSink m_eventSink;  // guarded by m_sinkMutex; for live statistics (status events go through the executor)
+    std::unique_ptr<LiveQueryStatsPoller> m_liveStats;  // Outlives the executor, whose workers unwatch finished queries
     std::unique_ptr<AsyncQueryExecutor> m_asyncExecutor;
 };
 
@@ -2,12 +2,19 @@
 
 #include "../database/connection_registry.h"
 #include "../database/connection_utils.h"
+#include "../database/server_health_monitor.h"
+#include "../database/table_tail_monitor.h"
 #include "../database/sqlserver_driver.h"
 #include "../network/ssh_tunnel.h"
+#include "../parsers/sql_parser.h"
 #include "../utils/json_utils.h"
 #include "../utils/logger.h"
 
+#include <algorithm>
+#include <atomic>
 #include <format>
+#include <future>
+#include <vector>
 
 namespace velocitydb {
 
@@ -27,8 +34,21 @@ namespace {
     return std::dynamic_pointer_cast<SQLServerDriver>(*driverResult);
 }
 
+[[nodiscard]] QueryLane toQueryLane(std::expected<ConnectionRegistry::LaneCheckout, std::string> checkout) {
+    if (!checkout) {
+        return {};
+    }
+    auto driver = std::dynamic_pointer_cast<SQLServerDriver>(checkout->driver);
+    if (!driver) [[unlikely]] {
+        checkout->release();
+        return {};
+    }
+    return QueryLane(std::move(driver), std::move(checkout->release), std::move(checkout->cancellation));
+}
+
 struct PreparedConnection {
     std::string odbcString;
+    std::string readIntentString;  ///< Same target with ApplicationIntent=ReadOnly; empty unless reads are routed
     std::unique_ptr<SshTunnel> tunnel;
 };
 
@@ -47,18 +67,112 @@ struct PreparedConnection {
     }
 
     auto odbcString = buildODBCConnectionString(effectiveParams);
+    std::string readIntentString;
+    if (params.tuning.readRouting && !params.tuning.readOnlyIntent && params.dbType == DbType::SQLServer) {
+        effectiveParams.tuning.readOnlyIntent = true;
+        readIntentString = buildODBCConnectionString(effectiveParams);
+    }
     log<LogLevel::DEBUG>(std::format("[DB] ODBC connection target: {}", effectiveParams.server));
     log<LogLevel::DEBUG>("[DB] Attempting ODBC connection...");
     log_flush();
 
-    return PreparedConnection{std::move(odbcString), std::move(tunnel)};
+    return PreparedConnection{std::move(odbcString), std::move(readIntentString), std::move(tunnel)};
+}
+
+/// Login and server as entered (before SSH redirection), so the identity survives reconnects and restarts
+[[nodiscard]] std::string cacheIdentityFor(const DatabaseConnectionParams& params) {
+    auto identity = std::format("{}@{}", params.useWindowsAuth ? "windows" : params.username, params.server);
+    if (params.ssh.enabled) {
+        identity += std::format(" via {}@{}:{}", params.ssh.username, params.ssh.host, params.ssh.port);
+    }
+    return identity;
+}
+
+/// Factory for lanes logging in with `odbcString` on first use; `role` only names them in the log
+[[nodiscard]] ConnectionRegistry::LaneFactory laneFactoryFor(std::string odbcString, const DatabaseConnectionParams& params, std::string_view role) {
+    return [odbcString = std::move(odbcString), rowsetSize = params.fetchRowsetSize, packetSize = params.tuning.packetSize, role]() -> ConnectionRegistry::DriverPtr {
+        auto lane = std::make_shared<SQLServerDriver>();
+        if (rowsetSize > 0) {
+            lane->setFetchRowsetSize(rowsetSize);
+        }
+        lane->setPacketSize(packetSize);
+        if (!lane->connect(odbcString)) {
+            log<LogLevel::WARNING>(std::format("[DB] {} connection failed: {}", role, lane->getLastError()));
+            return nullptr;
+        }
+        return lane;
+    };
+}
+
+/// Log in once and straight back out
+[[nodiscard]] std::expected<void, std::string> testLogin(const DatabaseConnectionParams& params) {
+    auto prepared = prepareConnection(params);
+    if (!prepared) {
+        return std::unexpected(prepared.error());
+    }
+    SQLServerDriver driver{};
+    driver.setPacketSize(params.tuning.packetSize);
+    if (!driver.connect(prepared->odbcString)) {
+        return std::unexpected(driver.getLastError());
+    }
+    driver.disconnect();
+    return {};
 }
 
 }  // namespace
 
-ConnectionProvider::ConnectionProvider() : m_registry(std::make_unique<ConnectionRegistry>()) {}
+/// Profiles tested or connected by a few workers; each result is published as soon as its login returns
+struct ConnectionProvider::ConnectionBatch {
+    bool connect = false;
+    std::vector<std::string> keys;
+    std::vector<std::expected<DatabaseConnectionParams, std::string>> profiles;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> cancelRequested{false};
+    std::vector<std::future<void>> workers;
 
-ConnectionProvider::~ConnectionProvider() = default;
+    mutable std::mutex mutex;       // guards results and endTime
+    std::vector<std::string> results;  ///< JSON objects in completion order
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point endTime;
+
+    [[nodiscard]] bool done() const {
+        std::lock_guard lock(mutex);
+        return results.size() == profiles.size();
+    }
+};
+
+ConnectionProvider::ConnectionProvider()
+    : m_registry(std::make_unique<ConnectionRegistry>()), m_healthMonitor(std::make_unique<ServerHealthMonitor>([this](const std::string& eventJson) {
+          std::lock_guard lock(m_healthSinkMutex);
+          if (m_healthSink) {
+              m_healthSink(eventJson);
+          }
+      })),
+      m_tailMonitor(std::make_unique<TableTailMonitor>([this](const std::string& eventJson) {
+          std::lock_guard lock(m_tailSinkMutex);
+          if (m_tailSink) {
+              m_tailSink(eventJson);
+          }
+      })) {
+    m_registry->startKeepalive();
+}
+
+ConnectionProvider::~ConnectionProvider() {
+    std::vector<std::shared_ptr<ConnectionBatch>> batches;
+    {
+        std::lock_guard lock(m_batchesMutex);
+        for (auto& [id, batch] : m_batches) {
+            batches.push_back(batch);
+        }
+    }
+    // Logins in flight finish (they cannot be interrupted); queued ones are skipped. Wait WITHOUT holding the mutex.
+    for (auto& batch : batches) {
+        batch->cancelRequested.store(true, std::memory_order_release);
+        for (auto& worker : batch->workers) {
+            worker.wait();
+        }
+    }
+}
 
 std::shared_ptr<SQLServerDriver> ConnectionProvider::getQueryDriver(std::string_view connectionId) {
     return getDriver(*m_registry, connectionId);
@@ -68,64 +182,487 @@ std::shared_ptr<SQLServerDriver> ConnectionProvider::getMetadataDriver(std::stri
     return getMetaDriver(*m_registry, connectionId);
 }
 
-std::string ConnectionProvider::handleConnect(std::string_view params) {
+std::shared_ptr<SQLServerDriver> ConnectionProvider::getSchemaDriver(std::string_view connectionId) {
+    auto driverResult = m_registry->getSchemaDriver(connectionId);
+    if (!driverResult)
+        return nullptr;
+    return std::dynamic_pointer_cast<SQLServerDriver>(*driverResult);
+}
+
+QueryLane ConnectionProvider::acquireQueryLane(std::string_view connectionId, bool sessionIndependent) {
+    return toQueryLane(m_registry->checkoutLane(connectionId, sessionIndependent));
+}
+
+QueryLane ConnectionProvider::acquireLaneFor(std::string_view connectionId, SqlTokens script) {
+    const bool sessionIndependent = SQLParser::isSessionIndependent(script);
+    // Temp tables and session settings live on the primary session, so only reads free of them may move
+    if (sessionIndependent && SQLParser::isReadOnlyQuery(script)) {
+        return toQueryLane(m_registry->checkoutReadLane(connectionId));
+    }
+    return acquireQueryLane(connectionId, sessionIndependent);
+}
+
+std::expected<QueryLane, std::string> ConnectionProvider::openStandaloneLane(const DatabaseConnectionParams& params) {
+    auto prepared = prepareConnection(params);
+    if (!prepared) {
+        return std::unexpected(prepared.error());
+    }
+    auto driver = std::make_shared<SQLServerDriver>();
+    if (params.fetchRowsetSize > 0) {
+        driver->setFetchRowsetSize(params.fetchRowsetSize);
+    }
+    driver->setPacketSize(params.tuning.packetSize);
+    if (!driver->connect(prepared->odbcString)) {
+        return std::unexpected(driver->getLastError());
+    }
+    // The tunnel goes with the release callback, so it closes right after the logout
+    return QueryLane(driver, [driver, tunnel = std::shared_ptr<SshTunnel>(std::move(prepared->tunnel))] { driver->disconnect(); });
+}
+
+void ConnectionProvider::pinSessionLane(std::string_view connectionId, bool pinned) {
+    m_registry->setSessionPinned(connectionId, pinned);
+}
+
+void ConnectionProvider::noteDatabaseChange(std::string_view connectionId, std::string_view database) {
+    m_registry->noteDatabaseChange(connectionId, std::string(database));
+}
+
+void ConnectionProvider::cancelQueries(std::string_view connectionId) {
+    m_registry->cancelAll(connectionId);
+}
+
+std::string ConnectionProvider::getCacheIdentity(std::string_view connectionId) {
+    return m_registry->getCacheIdentity(connectionId);
+}
+
+std::string ConnectionProvider::handleConnect(const IPCParams& params) {
     auto connectionParams = extractConnectionParams(params);
     if (!connectionParams) {
         return JsonUtils::errorResponse(connectionParams.error());
     }
 
-    auto prepared = prepareConnection(*connectionParams);
+    auto connectionId = connectProfile(*connectionParams);
+    if (!connectionId) {
+        return JsonUtils::errorResponse(connectionId.error());
+    }
+    return JsonUtils::successResponse(std::format(R"({{"connectionId":"{}"}})", *connectionId));
+}
+
+std::expected<std::string, std::string> ConnectionProvider::connectProfile(const DatabaseConnectionParams& connectionParams) {
+    auto prepared = prepareConnection(connectionParams);
     if (!prepared) {
-        return JsonUtils::errorResponse(prepared.error());
+        return std::unexpected(prepared.error());
     }
 
     auto queryDriverPtr = std::make_shared<SQLServerDriver>();
-    if (!queryDriverPtr->connect(prepared->odbcString)) {
-        return JsonUtils::errorResponse(std::format("Connection failed: {}", queryDriverPtr->getLastError()));
+    if (connectionParams.fetchRowsetSize > 0) {
+        queryDriverPtr->setFetchRowsetSize(connectionParams.fetchRowsetSize);
     }
+    queryDriverPtr->setPacketSize(connectionParams.tuning.packetSize);
 
+    // Both logins use the same string (and tunnel), so the metadata login runs alongside the query one
     auto metadataDriverPtr = std::make_shared<SQLServerDriver>();
-    if (!metadataDriverPtr->connect(prepared->odbcString)) {
-        queryDriverPtr->disconnect();
-        return JsonUtils::errorResponse(std::format("Metadata connection failed: {}", metadataDriverPtr->getLastError()));
+    metadataDriverPtr->setPacketSize(connectionParams.tuning.packetSize);
+    auto metadataConnect = std::async(std::launch::async, [metadataDriverPtr, &odbcString = prepared->odbcString] { return metadataDriverPtr->connect(odbcString); });
+    // The read-intent login is routed by the listener to a readable secondary; without one, reads stay on the primary
+    std::shared_ptr<SQLServerDriver> schemaDriverPtr;
+    std::future<bool> schemaConnect;
+    if (!prepared->readIntentString.empty()) {
+        schemaDriverPtr = std::make_shared<SQLServerDriver>();
+        schemaDriverPtr->setPacketSize(connectionParams.tuning.packetSize);
+        schemaConnect = std::async(std::launch::async, [schemaDriverPtr, &odbcString = prepared->readIntentString] { return schemaDriverPtr->connect(odbcString); });
+    }
+    bool queryConnected = queryDriverPtr->connect(prepared->odbcString);
+    bool metadataConnected = metadataConnect.get();
+    if (schemaConnect.valid() && !schemaConnect.get()) {
+        log<LogLevel::WARNING>(std::format("[DB] Read-intent connection failed, schema reads stay on the primary: {}", schemaDriverPtr->getLastError()));
+        schemaDriverPtr.reset();
     }
 
-    auto connectionId = m_registry->add(queryDriverPtr, metadataDriverPtr);
+    if (!queryConnected || !metadataConnected) {
+        for (const auto& driver : {queryDriverPtr, metadataDriverPtr, schemaDriverPtr}) {
+            if (driver && driver->isConnected()) {
+                driver->disconnect();
+            }
+        }
+        return std::unexpected(!queryConnected ? std::format("Connection failed: {}", queryDriverPtr->getLastError())
+                                               : std::format("Metadata connection failed: {}", metadataDriverPtr->getLastError()));
+    }
+
+    // Extra query lanes log in on first use with the same string; the tunnel stays registered with the connection
+    auto maxLanes = connectionParams.maxQueryLanes > 0 ? connectionParams.maxQueryLanes : ConnectionRegistry::DEFAULT_MAX_LANES;
+    auto connectionId = m_registry->add(queryDriverPtr, metadataDriverPtr, cacheIdentityFor(connectionParams), laneFactoryFor(prepared->odbcString, connectionParams, "Query lane"), maxLanes);
+    if (!prepared->readIntentString.empty()) {
+        // Read lanes are tried even when the schema login failed; each one falls back to the primary on its own
+        m_registry->attachReadIntent(connectionId, schemaDriverPtr, laneFactoryFor(prepared->readIntentString, connectionParams, "Read-intent lane"));
+    }
     if (prepared->tunnel) {
         m_registry->attachTunnel(connectionId, std::move(prepared->tunnel));
     }
-
-    return JsonUtils::successResponse(std::format(R"({{"connectionId":"{}"}})", connectionId));
+    return connectionId;
 }
 
-std::string ConnectionProvider::handleDisconnect(std::string_view params) {
+std::string ConnectionProvider::handleDisconnect(const IPCParams& params) {
     auto connectionIdResult = extractConnectionId(params);
     if (!connectionIdResult) {
         return JsonUtils::errorResponse(connectionIdResult.error());
     }
 
+    m_healthMonitor->stop(*connectionIdResult);
     m_registry->remove(*connectionIdResult);
     return JsonUtils::successResponse("{}");
 }
 
-std::string ConnectionProvider::handleTestConnection(std::string_view params) {
+std::string ConnectionProvider::handleTestConnection(const IPCParams& params) {
     auto connectionParams = extractConnectionParams(params);
     if (!connectionParams) {
         return JsonUtils::errorResponse(connectionParams.error());
     }
 
-    auto prepared = prepareConnection(*connectionParams);
-    if (!prepared) {
-        return JsonUtils::successResponse(std::format(R"({{"success":false,"message":"{}"}})", JsonUtils::escapeString(prepared.error())));
+    if (auto tested = testLogin(*connectionParams); !tested) {
+        return JsonUtils::successResponse(std::format(R"({{"success":false,"message":"{}"}})", JsonUtils::escapeString(tested.error())));
     }
+    return JsonUtils::successResponse(R"({"success":true,"message":"Connection successful"})");
+}
 
-    SQLServerDriver driver{};
-    if (driver.connect(prepared->odbcString)) {
-        driver.disconnect();
-        return JsonUtils::successResponse(R"({"success":true,"message":"Connection successful"})");
+std::string ConnectionProvider::handleBenchmarkPacketSizes(const IPCParams& params) {
+    try {
+        auto connectionParams = extractConnectionParams(params);
+        if (!connectionParams) {
+            return JsonUtils::errorResponse(connectionParams.error());
+        }
+        std::vector<uint32_t> packetSizes;
+        if (auto sizes = params["packetSizes"].get_array(); !sizes.error()) {
+            for (auto size : sizes.value()) {
+                if (auto bytes = size.get_uint64(); !bytes.error() && bytes.value() > 0) {
+                    packetSizes.push_back(std::clamp(static_cast<uint32_t>((std::min<uint64_t>)(bytes.value(), SQLServerDriver::MAX_PACKET_SIZE)), SQLServerDriver::MIN_PACKET_SIZE,
+                                                     SQLServerDriver::MAX_PACKET_SIZE));
+                }
+            }
+        }
+        if (packetSizes.empty()) {
+            packetSizes.assign(std::begin(BENCHMARK_PACKET_SIZES), std::end(BENCHMARK_PACKET_SIZES));
+        }
+        uint64_t rows = BENCHMARK_ROWS;
+        if (auto rowsOpt = params["rows"].get_uint64(); !rowsOpt.error() && rowsOpt.value() > 0) {
+            rows = (std::min<uint64_t>)(rowsOpt.value(), 1'000'000);
+        }
+
+        // One tunnel for every run, so only the packet size differs between them
+        auto prepared = prepareConnection(*connectionParams);
+        if (!prepared) {
+            return JsonUtils::errorResponse(prepared.error());
+        }
+        // Wide rows built on the server, so the time goes to moving them rather than reading tables
+        const auto sql = std::format("SELECT TOP ({}) o1.object_id, o1.name, REPLICATE(N'x', 200) AS payload FROM sys.all_objects o1 CROSS JOIN sys.all_objects o2", rows);
+
+        std::string results;
+        uint32_t recommended = 0;
+        double bestRowsPerSecond = 0.0;
+        for (const auto packetSize : packetSizes) {
+            if (!results.empty()) {
+                results += ',';
+            }
+            SQLServerDriver driver{};
+            if (connectionParams->fetchRowsetSize > 0) {
+                driver.setFetchRowsetSize(connectionParams->fetchRowsetSize);
+            }
+            driver.setPacketSize(packetSize);
+            if (!driver.connect(prepared->odbcString)) {
+                results += std::format(R"({{"packetSize":{},"error":"{}"}})", packetSize, JsonUtils::escapeString(driver.getLastError()));
+                continue;
+            }
+            try {
+                // Best of BENCHMARK_RUNS: the first run also pays for the plan and cold caches
+                double bestMs = 0.0;
+                size_t fetched = 0;
+                for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+                    CallbackBatchSink discard([](const ResultSet&) { return true; });
+                    const auto started = std::chrono::steady_clock::now();
+                    const auto summary = driver.executeStreaming(sql, discard);
+                    const auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+                    if (run == 0 || elapsedMs < bestMs) {
+                        bestMs = elapsedMs;
+                    }
+                    fetched = summary.totalRows;
+                }
+                const double rowsPerSecond = bestMs > 0.0 ? static_cast<double>(fetched) * 1000.0 / bestMs : 0.0;
+                results += std::format(R"({{"packetSize":{},"rows":{},"elapsedMs":{:.1f},"rowsPerSecond":{:.0f}}})", packetSize, fetched, bestMs, rowsPerSecond);
+                if (rowsPerSecond > bestRowsPerSecond) {
+                    bestRowsPerSecond = rowsPerSecond;
+                    recommended = packetSize;
+                }
+            } catch (const std::exception& e) {
+                results += std::format(R"({{"packetSize":{},"error":"{}"}})", packetSize, JsonUtils::escapeString(e.what()));
+            }
+            driver.disconnect();
+        }
+        return JsonUtils::successResponse(std::format(R"({{"results":[{}],"recommendedPacketSize":{}}})", results, recommended));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
     }
+}
+
+std::string ConnectionProvider::handleStartConnectionBatch(const IPCParams& params) {
+    try {
+        auto profilesResult = params["profiles"].get_array();
+        if (profilesResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: profiles");
+        }
+
+        auto batch = std::make_shared<ConnectionBatch>();
+        if (auto connectOpt = params["connect"].get_bool(); !connectOpt.error()) {
+            batch->connect = connectOpt.value();
+        }
+        // A profile that does not parse still gets its (failed) result, in its turn
+        for (auto profile : profilesResult.value()) {
+            auto key = profile["key"].get_string();
+            batch->keys.emplace_back(key.error() ? std::string_view{} : key.value());
+            batch->profiles.push_back(extractConnectionParams(profile));
+        }
+        size_t parallelism = DEFAULT_BATCH_PARALLELISM;
+        if (auto parallelismOpt = params["parallelism"].get_int64(); !parallelismOpt.error() && parallelismOpt.value() > 0) {
+            parallelism = (std::min)(static_cast<size_t>(parallelismOpt.value()), MAX_BATCH_PARALLELISM);
+        }
+        batch->startTime = std::chrono::steady_clock::now();
+        batch->endTime = batch->startTime;
+
+        // Each worker takes the next profile until none are left, so one login stuck in its timeout holds up only itself.
+        // The batch owns the workers' futures, so they see it through a plain pointer; it stays registered until done.
+        auto work = [this, batch = batch.get()] {
+            for (size_t index = batch->next.fetch_add(1, std::memory_order_relaxed); index < batch->profiles.size(); index = batch->next.fetch_add(1, std::memory_order_relaxed)) {
+                const auto started = std::chrono::steady_clock::now();
+                std::expected<std::string, std::string> outcome;
+                if (batch->cancelRequested.load(std::memory_order_acquire)) {
+                    outcome = std::unexpected("Cancelled");
+                } else if (const auto& profile = batch->profiles[index]; !profile) {
+                    outcome = std::unexpected(profile.error());
+                } else if (batch->connect) {
+                    outcome = connectProfile(*profile);
+                } else if (auto tested = testLogin(*profile); !tested) {
+                    outcome = std::unexpected(tested.error());
+                }
+                const auto finished = std::chrono::steady_clock::now();
+                const auto elapsedMs = std::chrono::duration<double, std::milli>(finished - started).count();
+
+                auto result = std::format(R"({{"index":{},"key":"{}","success":{},"elapsedMs":{:.1f})", index, JsonUtils::escapeString(batch->keys[index]), outcome ? "true" : "false", elapsedMs);
+                if (!outcome) {
+                    result += std::format(R"(,"message":"{}")", JsonUtils::escapeString(outcome.error()));
+                } else if (batch->connect) {
+                    result += std::format(R"(,"connectionId":"{}")", *outcome);
+                }
+                result += '}';
+
+                std::lock_guard lock(batch->mutex);
+                batch->results.push_back(std::move(result));
+                batch->endTime = finished;
+            }
+        };
+        const size_t workers = (std::min)(parallelism, batch->profiles.size());
+        for (size_t i = 0; i < workers; ++i) {
+            batch->workers.push_back(std::async(std::launch::async, work));
+        }
+
+        std::string batchId;
+        {
+            std::lock_guard lock(m_batchesMutex);
+            evictFinishedBatches();
+            batchId = std::format("batch_{}", m_batchIdCounter++);
+            m_batches[batchId] = batch;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"batchId":"{}","total":{}}})", batchId, batch->profiles.size()));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ConnectionProvider::handleGetConnectionBatchProgress(const IPCParams& params) {
+    try {
+        auto batchIdResult = params["batchId"].get_string();
+        if (batchIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: batchId");
+        }
+        auto batchId = std::string(batchIdResult.value());
+        size_t since = 0;
+        if (auto sinceOpt = params["since"].get_int64(); !sinceOpt.error() && sinceOpt.value() > 0) {
+            since = static_cast<size_t>(sinceOpt.value());
+        }
+
+        auto batch = findBatch(batchId);
+        if (!batch) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection batch not found: {}", batchId));
+        }
+
+        // Results since the caller's last poll, so each one is sent once
+        std::lock_guard lock(batch->mutex);
+        const size_t completed = batch->results.size();
+        const bool done = completed == batch->profiles.size();
+        const auto endTime = done ? batch->endTime : std::chrono::steady_clock::now();
+        std::string jsonResponse = std::format(R"({{"batchId":"{}","total":{},"completed":{},"done":{},"elapsedMs":{:.1f},"results":[)", batchId, batch->profiles.size(), completed,
+                                               done ? "true" : "false", std::chrono::duration<double, std::milli>(endTime - batch->startTime).count());
+        for (size_t i = (std::min)(since, completed); i < completed; ++i) {
+            if (i > since) {
+                jsonResponse += ',';
+            }
+            jsonResponse += batch->results[i];
+        }
+        jsonResponse += "]}";
+        return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ConnectionProvider::handleCancelConnectionBatch(const IPCParams& params) {
+    try {
+        auto batchIdResult = params["batchId"].get_string();
+        if (batchIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: batchId");
+        }
+
+        auto batch = findBatch(batchIdResult.value());
+        bool cancelled = false;
+        if (batch && !batch->done()) {
+            // Logins in flight finish; the rest are reported as cancelled without being tried
+            batch->cancelRequested.store(true, std::memory_order_release);
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ConnectionProvider::handleStartServerMonitor(const IPCParams& params) {
+    try {
+        auto connectionIdResult = extractConnectionId(params);
+        if (!connectionIdResult) {
+            return JsonUtils::errorResponse(connectionIdResult.error());
+        }
+        ServerHealthMonitor::Options options;
+        if (auto interval = params["intervalMs"].get_uint64(); !interval.error()) {
+            options.interval = std::chrono::milliseconds((std::min<uint64_t>)(interval.value(), 3'600'000));
+        }
+        if (auto topWaits = params["topWaits"].get_uint64(); !topWaits.error()) {
+            options.topWaits = static_cast<size_t>(topWaits.value());
+        }
+        if (auto history = params["history"].get_uint64(); !history.error()) {
+            options.history = static_cast<size_t>((std::min<uint64_t>)(history.value(), ServerHealthMonitor::MAX_HISTORY));
+        }
+
+        // Its own session, so the monitor neither queues behind a busy lane nor holds one
+        auto driver = m_registry->openDedicatedDriver(*connectionIdResult);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(m_registry->exists(*connectionIdResult) ? "Could not open a monitoring session"
+                                                                                     : std::format("Connection not found: {}", *connectionIdResult));
+        }
+        const auto interval = (std::max)(options.interval, ServerHealthMonitor::MIN_INTERVAL);
+        m_healthMonitor->start(*connectionIdResult, std::move(driver), options);
+        return JsonUtils::successResponse(std::format(R"({{"intervalMs":{}}})", interval.count()));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ConnectionProvider::handleStopServerMonitor(const IPCParams& params) {
+    auto connectionIdResult = extractConnectionId(params);
+    if (!connectionIdResult) {
+        return JsonUtils::errorResponse(connectionIdResult.error());
+    }
+    const bool stopped = m_healthMonitor->stop(*connectionIdResult);
+    return JsonUtils::successResponse(std::format(R"({{"stopped":{}}})", stopped ? "true" : "false"));
+}
+
+std::string ConnectionProvider::handleGetServerHealth(const IPCParams& params) {
+    try {
+        auto connectionIdResult = extractConnectionId(params);
+        if (!connectionIdResult) {
+            return JsonUtils::errorResponse(connectionIdResult.error());
+        }
+        uint64_t since = 0;
+        if (auto sinceResult = params["since"].get_uint64(); !sinceResult.error()) {
+            since = sinceResult.value();
+        }
+        auto history = m_healthMonitor->history(*connectionIdResult, since);
+        if (!history) {
+            return JsonUtils::errorResponse(std::format("No server monitor for connection: {}", *connectionIdResult));
+        }
+        std::string json = std::format(R"({{"running":{},"error":"{}","samples":)", history->running ? "true" : "false", JsonUtils::escapeString(history->error));
+        json += JsonUtils::buildArray(history->samples, [](std::string& out, const ServerHealthSample& sample) { out += ServerHealthMonitor::sampleJson(sample); });
+        json += '}';
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+void ConnectionProvider::setHealthEventSink(EventSink sink) {
+    std::lock_guard lock(m_healthSinkMutex);
+    m_healthSink = std::move(sink);
+}
+
+std::string ConnectionProvider::handleStartTableTail(const IPCParams& params) {
+    try {
+        auto connectionIdResult = extractConnectionId(params);
+        if (!connectionIdResult) {
+            return JsonUtils::errorResponse(connectionIdResult.error());
+        }
+        auto tableResult = params["table"].get_string();
+        if (tableResult.error() || tableResult.value().empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: table");
+        }
+        TableTailMonitor::Options options;
+        if (auto keyColumn = params["keyColumn"].get_string(); !keyColumn.error()) {
+            options.keyColumn = std::string(keyColumn.value());
+        }
+        if (auto snapshotRows = params["snapshotRows"].get_uint64(); !snapshotRows.error()) {
+            options.snapshotRows = static_cast<size_t>((std::min<uint64_t>)(snapshotRows.value(), TableTailMonitor::MAX_SNAPSHOT_ROWS));
+        }
+        if (auto interval = params["intervalMs"].get_uint64(); !interval.error()) {
+            options.interval = std::chrono::milliseconds((std::min<uint64_t>)(interval.value(), 3'600'000));
+        }
+
+        // Its own session, like a server monitor: polling never waits for a busy lane nor holds one
+        auto driver = m_registry->openDedicatedDriver(*connectionIdResult);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(m_registry->exists(*connectionIdResult) ? "Could not open a session for the tail"
+                                                                                     : std::format("Connection not found: {}", *connectionIdResult));
+        }
+        const auto interval = (std::max)(options.interval, TableTailMonitor::MIN_INTERVAL);
+        auto tailId = m_tailMonitor->start(*connectionIdResult, tableResult.value(), std::move(driver), std::move(options));
+        return JsonUtils::successResponse(std::format(R"({{"tailId":"{}","intervalMs":{}}})", tailId, interval.count()));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ConnectionProvider::handleStopTableTail(const IPCParams& params) {
+    auto tailIdResult = params["tailId"].get_string();
+    if (tailIdResult.error()) [[unlikely]] {
+        return JsonUtils::errorResponse("Missing required field: tailId");
+    }
+    const bool stopped = m_tailMonitor->stop(tailIdResult.value());
+    return JsonUtils::successResponse(std::format(R"({{"stopped":{}}})", stopped ? "true" : "false"));
+}
+
+void ConnectionProvider::setTailEventSink(EventSink sink) {
+    std::lock_guard lock(m_tailSinkMutex);
+    m_tailSink = std::move(sink);
+}
+
+std::shared_ptr<ConnectionProvider::ConnectionBatch> ConnectionProvider::findBatch(std::string_view batchId) const {
+    std::lock_guard lock(m_batchesMutex);
+    auto it = m_batches.find(std::string(batchId));
+    return it == m_batches.end() ? nullptr : it->second;
+}
 
-    return JsonUtils::successResponse(std::format(R"({{"success":false,"message":"{}"}})", JsonUtils::escapeString(driver.getLastError())));
+void ConnectionProvider::evictFinishedBatches() {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_batches, [&](const auto& entry) {
+        const auto& batch = *entry.second;
+        std::lock_guard lock(batch.mutex);
+        return batch.results.size() == batch.profiles.size() && now - batch.endTime > FINISHED_BATCH_RETENTION;
+    });
 }
 
 }  // namespace velocitydb
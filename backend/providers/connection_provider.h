@@ -2,13 +2,21 @@
 
 #include "../interfaces/providers/connection_provider.h"
 
+#include <chrono>
+#include <cstdint>
+#include <expected>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace velocitydb {
 
 class ConnectionRegistry;
+class ServerHealthMonitor;
+class TableTailMonitor;
+struct DatabaseConnectionParams;
 
 /// Provider for database connection lifecycle and driver access
 class ConnectionProvider : public IConnectionProvider {
@@ -21,15 +29,65 @@ public:
     ConnectionProvider(ConnectionProvider&&) = delete;
     ConnectionProvider& operator=(ConnectionProvider&&) = delete;
 
-    [[nodiscard]] std::string handleConnect(std::string_view params) override;
-    [[nodiscard]] std::string handleDisconnect(std::string_view params) override;
-    [[nodiscard]] std::string handleTestConnection(std::string_view params) override;
+    [[nodiscard]] std::string handleConnect(const IPCParams& params) override;
+    [[nodiscard]] std::string handleDisconnect(const IPCParams& params) override;
+    [[nodiscard]] std::string handleTestConnection(const IPCParams& params) override;
+    [[nodiscard]] std::string handleBenchmarkPacketSizes(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStartConnectionBatch(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetConnectionBatchProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelConnectionBatch(const IPCParams& params) override;
+    /// Params: connectionId, intervalMs, topWaits, history (samples kept). Restarts a running monitor
+    [[nodiscard]] std::string handleStartServerMonitor(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStopServerMonitor(const IPCParams& params) override;
+    /// Params: connectionId, since (sequence; default 0)
+    [[nodiscard]] std::string handleGetServerHealth(const IPCParams& params) override;
+    void setHealthEventSink(EventSink sink) override;
+    /// Params: connectionId, table, keyColumn, snapshotRows, intervalMs
+    [[nodiscard]] std::string handleStartTableTail(const IPCParams& params) override;
+    /// Params: tailId
+    [[nodiscard]] std::string handleStopTableTail(const IPCParams& params) override;
+    void setTailEventSink(EventSink sink) override;
 
     [[nodiscard]] std::shared_ptr<SQLServerDriver> getQueryDriver(std::string_view connectionId) override;
     [[nodiscard]] std::shared_ptr<SQLServerDriver> getMetadataDriver(std::string_view connectionId) override;
+    [[nodiscard]] std::shared_ptr<SQLServerDriver> getSchemaDriver(std::string_view connectionId) override;
+    [[nodiscard]] QueryLane acquireQueryLane(std::string_view connectionId, bool sessionIndependent) override;
+    [[nodiscard]] QueryLane acquireLaneFor(std::string_view connectionId, SqlTokens script) override;
+    [[nodiscard]] std::expected<QueryLane, std::string> openStandaloneLane(const DatabaseConnectionParams& params) override;
+    void pinSessionLane(std::string_view connectionId, bool pinned) override;
+    void noteDatabaseChange(std::string_view connectionId, std::string_view database) override;
+    void cancelQueries(std::string_view connectionId) override;
+    [[nodiscard]] std::string getCacheIdentity(std::string_view connectionId) override;
+
+    static constexpr size_t DEFAULT_BATCH_PARALLELISM = 8;
+    static constexpr size_t MAX_BATCH_PARALLELISM = 32;
+    /// Packet sizes handleBenchmarkPacketSizes tries when the request names none
+    static constexpr uint32_t BENCHMARK_PACKET_SIZES[] = {4096, 8192, 16384, 32767};
+    static constexpr uint64_t BENCHMARK_ROWS = 50'000;
+    static constexpr int BENCHMARK_RUNS = 2;
 
 private:
+    struct ConnectionBatch;
+
+    /// Log in the query and metadata drivers (plus the read-intent schema driver when reads are routed) and register
+    /// the connection
+    /// @return The new connectionId, or why the login failed
+    [[nodiscard]] std::expected<std::string, std::string> connectProfile(const DatabaseConnectionParams& params);
+    [[nodiscard]] std::shared_ptr<ConnectionBatch> findBatch(std::string_view batchId) const;
+    void evictFinishedBatches();  // Caller holds m_batchesMutex
+
+    static constexpr auto FINISHED_BATCH_RETENTION = std::chrono::minutes{5};
+
     std::unique_ptr<ConnectionRegistry> m_registry;
+    std::mutex m_healthSinkMutex;
+    EventSink m_healthSink;  // guarded by m_healthSinkMutex
+    std::unique_ptr<ServerHealthMonitor> m_healthMonitor;  // Stopped before m_registry closes the SSH tunnels it uses
+    std::mutex m_tailSinkMutex;
+    EventSink m_tailSink;  // guarded by m_tailSinkMutex
+    std::unique_ptr<TableTailMonitor> m_tailMonitor;  // Likewise stopped before m_registry
+    mutable std::mutex m_batchesMutex;
+    std::unordered_map<std::string, std::shared_ptr<ConnectionBatch>> m_batches;
+    size_t m_batchIdCounter = 1;  // guarded by m_batchesMutex
 };
 
 }  // namespace velocitydb
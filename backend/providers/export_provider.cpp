@@ -1,66 +1,291 @@
 #include "export_provider.h"
 
+#include "../database/admission_controller.h"
+#include "../database/pipelined_batch_sink.h"
+#include "../database/range_partitioner.h"
 #include "../database/sqlserver_driver.h"
 #include "../exporters/csv_exporter.h"
 #include "../exporters/data_exporter.h"
 #include "../exporters/excel_exporter.h"
 #include "../exporters/json_exporter.h"
+#include "../exporters/parquet_exporter.h"
+#include "../exporters/sql_insert_exporter.h"
 #include "../interfaces/providers/connection_provider.h"
+#include "../interfaces/providers/query_provider.h"
 #include "../parsers/sql_parser.h"
+#include "../utils/buffered_file_writer.h"
+#include "../utils/cancellation_token.h"
+#include "../utils/encoding.h"
 #include "../utils/json_utils.h"
+#include "../utils/mapped_file.h"
 #include "simdjson.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <format>
+#include <functional>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <thread>
 
 namespace velocitydb {
 
-ExportProvider::ExportProvider(IConnectionProvider& connections) : m_connections(connections) {}
+namespace {
 
-ExportProvider::~ExportProvider() = default;
+/// Feeds streamed batches straight into an exporter so the full result is never materialized. Used behind a
+/// PipelinedBatchSink, so encoding and writing a batch overlap the fetch of the next one. Raising
+/// ExportOptions::cancelRequested stops it at the next batch.
+class ExportSink : public RowBatchSink {
+public:
+    /// `onProgress` runs after every written batch with its row count; returning false stops the export.
+    ExportSink(DataExporter& exporter, const std::string& filepath, const ExportOptions& options, std::function<bool(size_t)> onProgress = {})
+        : m_exporter(exporter), m_filepath(filepath), m_options(options), m_onProgress(std::move(onProgress)) {}
 
-std::vector<std::string> ExportProvider::getSupportedFormats() const {
-    return {"csv", "json", "excel"};
+    void onColumns(const std::vector<ColumnInfo>& columns) override { m_ok = m_exporter.beginExport(columns, m_filepath, m_options); }
+
+    [[nodiscard]] bool onBatch(const ResultSet& batch) override {
+        m_ok = m_ok && m_exporter.writeBatch(batch);
+        return m_ok && !isCancelRequested(m_options.cancelRequested) && (!m_onProgress || m_onProgress(batch.rowCount()));
+    }
+
+    [[nodiscard]] bool finish() { return m_exporter.finishExport() && m_ok; }
+
+private:
+    DataExporter& m_exporter;
+    const std::string& m_filepath;
+    const ExportOptions& m_options;
+    std::function<bool(size_t)> m_onProgress;
+    bool m_ok = false;
+};
+
+void parseCSVOptions(const IPCParams& params, ExportOptions& options) {
+    if (auto delimiter = params["delimiter"].get_string(); !delimiter.error()) {
+        options.delimiter = std::string(delimiter.value());
+    }
+    if (auto includeHeader = params["includeHeader"].get_bool(); !includeHeader.error()) {
+        options.includeHeader = includeHeader.value();
+    }
+    if (auto nullValue = params["nullValue"].get_string(); !nullValue.error()) {
+        options.nullValue = std::string(nullValue.value());
+    }
 }
 
-std::string ExportProvider::exportWithDriver(std::string_view params, std::string_view format) {
-    try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+/// Admission of an export reading from `connectionId`; it waits in line as the caller's tab when one is given
+[[nodiscard]] AdmissionRequest exportAdmission(IConnectionProvider& connections, const IPCParams& params, std::string_view connectionId) {
+    AdmissionRequest request{.server = AdmissionController::serverKey(connections.getCacheIdentity(connectionId)), .owner = "export", .kind = AdmissionClass::Export};
+    if (auto tabId = params["tabId"].get_string(); !tabId.error() && !tabId.value().empty()) {
+        request.owner = tabId.value();
+    }
+    return request;
+}
 
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto filepathResult = doc["filepath"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
-        if (connectionIdResult.error() || filepathResult.error() || sqlQueryResult.error()) [[unlikely]] {
-            return JsonUtils::errorResponse("Missing required fields: connectionId, filepath, or sql");
+/// Block until the server admits `request`; throws once `timeout` passed or `cancelled` returns true
+[[nodiscard]] AdmissionTicket admitExport(const AdmissionRequest& request, std::chrono::milliseconds timeout, const std::function<bool()>& cancelled = {}) {
+    auto ticket = AdmissionController::instance().acquire(request, timeout, cancelled);
+    if (!ticket) [[unlikely]] {
+        throw std::runtime_error(std::format("Export not started: {} is busy with other queries and exports", request.server));
+    }
+    return std::move(*ticket);
+}
+
+constexpr size_t HELD_EXPORT_BATCH_ROWS = 10000;
+
+/// Write a held result in display order, a batch at a time, so a sorted or filtered view is never copied whole
+[[nodiscard]] bool writeHeld(DataExporter& exporter, const HeldResult& held, const std::string& filepath, const ExportOptions& options) {
+    if (!exporter.beginExport(held.result->columns, filepath, options)) {
+        return false;
+    }
+    bool ok = true;
+    if (!held.rows) {
+        ok = exporter.writeBatch(*held.result);
+    }
+    for (size_t begin = 0; ok && held.rows && begin < held.size() && !isCancelRequested(options.cancelRequested); begin += HELD_EXPORT_BATCH_ROWS) {
+        ResultSet batch;
+        batch.columns = held.result->columns;
+        const size_t end = (std::min)(begin + HELD_EXPORT_BATCH_ROWS, held.size());
+        for (size_t position = begin; position < end; ++position) {
+            batch.appendRowFrom(*held.result, held.rowAt(position));
         }
-        auto connectionId = std::string(connectionIdResult.value());
-        auto filepath = std::string(filepathResult.value());
-        auto sqlQuery = std::string(sqlQueryResult.value());
+        ok = exporter.writeBatch(batch);
+    }
+    return exporter.finishExport() && ok && !isCancelRequested(options.cancelRequested);
+}
 
-        if (!SQLParser::isReadOnlyQuery(sqlQuery)) [[unlikely]] {
-            return JsonUtils::errorResponse("Export only supports SELECT queries");
+/// Exporter for one key range of a partitioned export, with a view of the bytes it has written
+struct PartExporter {
+    std::unique_ptr<DataExporter> exporter;
+    std::function<size_t()> bytesWritten;
+};
+
+template <typename Exporter>
+[[nodiscard]] PartExporter partExporter(std::unique_ptr<Exporter> exporter) {
+    auto* raw = exporter.get();
+    return {.exporter = std::move(exporter), .bytesWritten = [raw] { return raw->bytesWritten(); }};
+}
+
+/// csv, ndjson or parquet
+[[nodiscard]] PartExporter makePartExporter(std::string_view format) {
+    if (format == "csv") {
+        return partExporter(std::make_unique<CSVExporter>());
+    }
+    if (format == "ndjson") {
+        auto exporter = std::make_unique<JSONExporter>();
+        exporter->setArrayFormat(false);
+        return partExporter(std::move(exporter));
+    }
+    return partExporter(std::make_unique<ParquetExporter>());
+}
+
+/// `<stem>.partNNN<extension>` beside `filepath`
+[[nodiscard]] std::string partPath(std::string_view filepath, size_t index) {
+    const auto slash = filepath.find_last_of("/\\");
+    auto dot = filepath.rfind('.');
+    if (dot == std::string_view::npos || (slash != std::string_view::npos && dot < slash)) {
+        dot = filepath.size();
+    }
+    return std::format("{}.part{:03}{}", filepath.substr(0, dot), index + 1, filepath.substr(dot));
+}
+
+void removeFiles(const std::vector<std::string>& filepaths) {
+    for (const auto& filepath : filepaths) {
+        std::error_code ec;
+        std::filesystem::remove(std::filesystem::path(utf8ToWide(filepath)), ec);
+    }
+}
+
+/// Write `parts` one after another into `filepath`
+[[nodiscard]] bool concatenateFiles(const std::vector<std::string>& parts, const std::string& filepath) {
+    BufferedFileWriter writer;
+    if (!writer.open(filepath)) [[unlikely]] {
+        return false;
+    }
+    for (const auto& part : parts) {
+        MappedFile mapped;
+        if (!mapped.open(part)) [[unlikely]] {
+            (void)writer.close();
+            return false;
         }
+        writer.append(mapped.view());
+    }
+    return writer.close();
+}
 
-        auto driver = m_connections.getQueryDriver(connectionId);
-        if (!driver) [[unlikely]] {
-            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+[[nodiscard]] std::string_view exportStatusToString(ExportStatus status) noexcept {
+    switch (status) {
+        case ExportStatus::Running:
+            return "running";
+        case ExportStatus::Completed:
+            return "completed";
+        case ExportStatus::Cancelled:
+            return "cancelled";
+        case ExportStatus::Failed:
+            return "failed";
+    }
+    return "unknown";
+}
+
+}  // namespace
+
+struct ExportProvider::ExportJob {
+    std::future<void> future;
+    std::vector<std::shared_ptr<SQLServerDriver>> drivers;  // One per lane the job reads on
+    std::string filepath;
+    std::vector<std::string> partFiles;  // Files a multi-part partitioned export writes
+    size_t parts = 0;                    // Key ranges of a partitioned export
+    std::atomic<size_t> partsDone{0};
+    std::atomic<ExportStatus> status{ExportStatus::Running};
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<size_t> rowsWritten{0};
+    std::atomic<size_t> bytesWritten{0};
+    std::string errorMessage;  // Written before the terminal status is published
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<std::chrono::steady_clock::time_point::rep> endTicks{0};
+};
+
+ExportProvider::ExportProvider(IConnectionProvider& connections, IQueryProvider& queries) : m_connections(connections), m_queries(queries) {}
+
+ExportProvider::~ExportProvider() {
+    std::vector<std::shared_ptr<ExportJob>> jobs;
+    {
+        std::lock_guard lock(m_jobsMutex);
+        for (auto& [id, job] : m_jobs) {
+            jobs.push_back(job);
+        }
+    }
+    // Stop and wait WITHOUT holding the mutex
+    for (auto& job : jobs) {
+        job->cancelRequested.store(true, std::memory_order_release);
+        if (job->future.valid()) {
+            job->future.wait();
         }
+    }
+}
 
-        auto queryResult = driver->execute(sqlQuery);
-        ExportOptions options{};
+std::vector<std::string> ExportProvider::getSupportedFormats() const {
+    return {"csv", "json", "excel", "parquet", "sql"};
+}
 
-        if (format == "csv") {
-            if (auto delimiter = doc["delimiter"].get_string(); !delimiter.error()) {
-                options.delimiter = std::string(delimiter.value());
+std::string ExportProvider::exportWithDriver(const IPCParams& params, std::string_view format) {
+    try {
+        auto filepathResult = params["filepath"].get_string();
+        if (filepathResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: filepath");
+        }
+        auto filepath = std::string(filepathResult.value());
+
+        // A result held under "resultHandle" is written as the grid shows it, without another server round trip
+        std::optional<HeldResult> held;
+        QueryLane lane;
+        std::string sqlQuery;
+        AdmissionRequest admission;
+        if (!params["resultHandle"].error()) {
+            auto found = m_queries.heldResult(params);
+            if (!found) [[unlikely]] {
+                return JsonUtils::errorResponse(found.error());
             }
-            if (auto includeHeader = doc["includeHeader"].get_bool(); !includeHeader.error()) {
-                options.includeHeader = includeHeader.value();
+            held = std::move(*found);
+        } else {
+            auto connectionIdResult = params["connectionId"].get_string();
+            auto sqlQueryResult = params["sql"].get_string();
+            if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
+                return JsonUtils::errorResponse("Missing required fields: connectionId, filepath, or sql");
             }
-            if (auto nullValue = doc["nullValue"].get_string(); !nullValue.error()) {
-                options.nullValue = std::string(nullValue.value());
+            auto connectionId = std::string(connectionIdResult.value());
+            sqlQuery = std::string(sqlQueryResult.value());
+
+            if (!SQLParser::isReadOnlyQuery(sqlQuery)) [[unlikely]] {
+                return JsonUtils::errorResponse("Export only supports SELECT queries");
             }
+
+            lane = m_connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+            if (!lane) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+            }
+            admission = exportAdmission(m_connections, params, connectionId);
+        }
+
+        // cancelQuery on the connection raises the lane's token; a held result has no lane and runs to the end
+        ExportOptions options{.cancelRequested = lane.cancellation().flag()};
+        const auto streamTo = [&](DataExporter& exporter) {
+            if (held) {
+                return writeHeld(exporter, *held, filepath, options);
+            }
+            const auto ticket = admitExport(admission, ADMISSION_TIMEOUT, [&] { return isCancelRequested(options.cancelRequested); });
+            ExportSink sink(exporter, filepath, options);
+            PipelinedBatchSink pipeline(sink);
+            lane.driver()->executeStreaming(sqlQuery, pipeline);
+            const bool delivered = pipeline.finish();
+            const bool finished = sink.finish() && delivered;
+            // Report a cancelled export as such rather than as a failed write
+            throwIfCancelled(options.cancelRequested);
+            return finished;
+        };
+
+        if (format == "csv") {
+            parseCSVOptions(params, options);
             CSVExporter exporter{};
-            if (exporter.exportData(queryResult, filepath, options)) {
+            if (streamTo(exporter)) {
                 return JsonUtils::successResponse(std::format(R"({{"filepath":"{}"}})", JsonUtils::escapeString(filepath)));
             }
             return JsonUtils::errorResponse("Failed to export CSV");
@@ -68,10 +293,16 @@ std::string ExportProvider::exportWithDriver(std::string_view params, std::strin
 
         if (format == "json") {
             JSONExporter exporter{};
-            if (auto prettyPrint = doc["prettyPrint"].get_bool(); !prettyPrint.error()) {
+            if (auto prettyPrint = params["prettyPrint"].get_bool(); !prettyPrint.error()) {
                 exporter.setPrettyPrint(prettyPrint.value());
             }
-            if (exporter.exportData(queryResult, filepath, options)) {
+            if (auto ndjson = params["ndjson"].get_bool(); !ndjson.error()) {
+                exporter.setArrayFormat(!ndjson.value());
+            }
+            if (auto compression = params["compression"].get_string(); !compression.error()) {
+                exporter.setGzip(compression.value() == "gzip");
+            }
+            if (streamTo(exporter)) {
                 return JsonUtils::successResponse(std::format(R"({{"filepath":"{}"}})", JsonUtils::escapeString(filepath)));
             }
             return JsonUtils::errorResponse("Failed to export JSON");
@@ -79,10 +310,38 @@ std::string ExportProvider::exportWithDriver(std::string_view params, std::strin
 
         if (format == "excel") {
             ExcelExporter exporter{};
-            if (exporter.exportData(queryResult, filepath, options)) {
+            if (streamTo(exporter)) {
+                return JsonUtils::successResponse(std::format(R"({{"filepath":"{}"}})", JsonUtils::escapeString(filepath)));
+            }
+            return JsonUtils::errorResponse("Failed to export Excel");
+        }
+
+        if (format == "parquet") {
+            ParquetExporter exporter{};
+            if (auto compression = params["compression"].get_string(); !compression.error()) {
+                exporter.setCompression(compression.value() != "none");
+            }
+            if (streamTo(exporter)) {
+                return JsonUtils::successResponse(std::format(R"({{"filepath":"{}"}})", JsonUtils::escapeString(filepath)));
+            }
+            return JsonUtils::errorResponse("Failed to export Parquet");
+        }
+
+        if (format == "sql") {
+            SqlInsertExporter exporter{};
+            if (auto table = params["table"].get_string(); !table.error() && !table.value().empty()) {
+                exporter.setTable(table.value());
+            }
+            if (auto rows = params["rowsPerStatement"].get_int64(); !rows.error() && rows.value() > 0) {
+                exporter.setRowsPerStatement(static_cast<size_t>(rows.value()));
+            }
+            if (auto goEvery = params["goEvery"].get_int64(); !goEvery.error() && goEvery.value() > 0) {
+                exporter.setGoEvery(static_cast<size_t>(goEvery.value()));
+            }
+            if (streamTo(exporter)) {
                 return JsonUtils::successResponse(std::format(R"({{"filepath":"{}"}})", JsonUtils::escapeString(filepath)));
             }
-            return JsonUtils::errorResponse("Excel export not yet implemented");
+            return JsonUtils::errorResponse("Failed to export SQL script");
         }
 
         return JsonUtils::errorResponse(std::format("Unsupported export format: {}", format));
@@ -91,16 +350,363 @@ std::string ExportProvider::exportWithDriver(std::string_view params, std::strin
     }
 }
 
-std::string ExportProvider::handleExportCSV(std::string_view params) {
+std::string ExportProvider::handleStartCSVExport(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto filepathResult = params["filepath"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
+        if (connectionIdResult.error() || filepathResult.error() || sqlQueryResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId, filepath, or sql");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        auto sqlQuery = std::string(sqlQueryResult.value());
+
+        if (!SQLParser::isReadOnlyQuery(sqlQuery)) [[unlikely]] {
+            return JsonUtils::errorResponse("Export only supports SELECT queries");
+        }
+
+        auto lane = m_connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+        if (!lane) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        ExportOptions options{};
+        parseCSVOptions(params, options);
+
+        auto job = std::make_shared<ExportJob>();
+        options.cancelRequested = &job->cancelRequested;
+        job->drivers = {lane.driver()};
+        job->filepath = std::string(filepathResult.value());
+        job->startTime = std::chrono::steady_clock::now();
+
+        // Capture shared_ptrs by value so the job and driver outlive the IPC call
+        job->future = std::async(std::launch::async, [job, sqlQuery, options, lane = std::move(lane), admission = exportAdmission(m_connections, params, connectionId)]() mutable {
+            auto heldLane = std::move(lane);
+            ExportStatus finalStatus = ExportStatus::Failed;
+            try {
+                const auto ticket = admitExport(admission, ADMISSION_TIMEOUT, [&] { return job->cancelRequested.load(std::memory_order_acquire); });
+                CSVExporter exporter{};
+                ExportSink sink(exporter, job->filepath, options, [&](size_t) {
+                    job->rowsWritten.store(exporter.rowsWritten(), std::memory_order_relaxed);
+                    job->bytesWritten.store(exporter.bytesWritten(), std::memory_order_relaxed);
+                    return !job->cancelRequested.load(std::memory_order_acquire);
+                });
+                PipelinedBatchSink pipeline(sink);
+                auto summary = job->drivers.front()->executeStreaming(sqlQuery, pipeline);
+                const bool delivered = pipeline.finish();
+                const bool finished = sink.finish() && delivered;
+                job->rowsWritten.store(exporter.rowsWritten(), std::memory_order_relaxed);
+                job->bytesWritten.store(exporter.bytesWritten(), std::memory_order_relaxed);
+
+                if (job->cancelRequested.load(std::memory_order_acquire)) {
+                    finalStatus = ExportStatus::Cancelled;
+                } else if (finished && !summary.stopped) {
+                    finalStatus = ExportStatus::Completed;
+                } else {
+                    job->errorMessage = "Failed to write CSV file";
+                }
+            } catch (const std::exception& e) {
+                // driver->cancel() surfaces as an ODBC error ("Operation canceled")
+                if (job->cancelRequested.load(std::memory_order_acquire)) {
+                    finalStatus = ExportStatus::Cancelled;
+                } else {
+                    job->errorMessage = e.what();
+                }
+            }
+            job->endTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            job->status.store(finalStatus, std::memory_order_release);
+        });
+
+        std::string exportId;
+        {
+            std::lock_guard lock(m_jobsMutex);
+            evictFinishedJobs();
+            exportId = std::format("export_{}", m_exportIdCounter++);
+            m_jobs[exportId] = job;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"exportId":"{}"}})", exportId));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ExportProvider::handleStartPartitionedExport(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto tableResult = params["table"].get_string();
+        auto filepathResult = params["filepath"].get_string();
+        if (connectionIdResult.error() || tableResult.error() || filepathResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId, table, or filepath");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+
+        std::string format = "csv";
+        if (auto formatResult = params["format"].get_string(); !formatResult.error()) {
+            format = std::string(formatResult.value());
+        }
+        if (format != "csv" && format != "ndjson" && format != "parquet") [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Unsupported partitioned export format: {}", format));
+        }
+        bool ordered = true;
+        if (auto orderedResult = params["ordered"].get_bool(); !orderedResult.error()) {
+            ordered = orderedResult.value();
+        }
+        if (ordered && format == "parquet") [[unlikely]] {
+            return JsonUtils::errorResponse("Parquet is written as one file per key range; set ordered to false");
+        }
+        size_t partitions = DEFAULT_PARTITIONS;
+        if (auto partitionsResult = params["partitions"].get_uint64(); !partitionsResult.error()) {
+            partitions = std::clamp(static_cast<size_t>(partitionsResult.value()), size_t{1}, MAX_KEY_RANGES);
+        }
+        size_t connections = DEFAULT_PARTITION_CONNECTIONS;
+        if (auto connectionsResult = params["connections"].get_uint64(); !connectionsResult.error()) {
+            connections = (std::max)(static_cast<size_t>(connectionsResult.value()), size_t{1});
+        }
+        std::string keyColumn;
+        if (auto keyColumnResult = params["keyColumn"].get_string(); !keyColumnResult.error()) {
+            keyColumn = std::string(keyColumnResult.value());
+        }
+
+        auto planLane = m_connections.acquireQueryLane(connectionId, true);
+        if (!planLane) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+        auto plan = planKeyRanges(*planLane.driver(), tableResult.value(), keyColumn, partitions);
+
+        // One lane per concurrent range. Once the pool starts handing out lanes already taken, stop: two ranges
+        // on one driver would only queue behind each other.
+        std::vector<QueryLane> lanes;
+        lanes.push_back(std::move(planLane));
+        while (lanes.size() < (std::min)(connections, plan.ranges.size())) {
+            auto lane = m_connections.acquireQueryLane(connectionId, true);
+            if (!lane || std::ranges::any_of(lanes, [&](const QueryLane& held) { return held.driver() == lane.driver(); })) {
+                break;
+            }
+            lanes.push_back(std::move(lane));
+        }
+
+        ExportOptions options{};
+        parseCSVOptions(params, options);
+
+        auto job = std::make_shared<ExportJob>();
+        options.cancelRequested = &job->cancelRequested;
+        for (const auto& lane : lanes) {
+            job->drivers.push_back(lane.driver());
+        }
+        job->filepath = std::string(filepathResult.value());
+        job->parts = plan.ranges.size();
+        job->startTime = std::chrono::steady_clock::now();
+        std::vector<std::string> files;
+        for (size_t range = 0; range < plan.ranges.size(); ++range) {
+            files.push_back(ordered ? partPath(job->filepath, range) + ".tmp" : partPath(job->filepath, range));
+        }
+        if (!ordered) {
+            job->partFiles = files;
+        }
+        const auto response = std::format(R"("parts":{},"connections":{},"keyColumn":"{}")", plan.ranges.size(), lanes.size(), JsonUtils::escapeString(plan.column));
+
+        // Ranges are handed out in key order to whichever lane is free. An ordered export writes each range to
+        // a temporary part and joins the parts once all have finished.
+        job->future = std::async(std::launch::async, [job, plan = std::move(plan), files, format, options, ordered, lanes = std::move(lanes),
+                                                      admission = exportAdmission(m_connections, params, connectionId)]() mutable {
+            auto heldLanes = std::move(lanes);
+            std::atomic<size_t> nextRange{0};
+            std::mutex errorMutex;
+            std::string firstError;
+            std::atomic<bool> failed{false};
+            const auto fail = [&](std::string message) {
+                std::lock_guard lock(errorMutex);
+                if (!failed.exchange(true)) {
+                    firstError = std::move(message);
+                }
+            };
+
+            const auto run = [&](size_t laneIndex) {
+                const auto& driver = job->drivers[laneIndex];
+                // Each lane is admitted on its own (before its first range) and keeps its share until it runs out of ranges
+                std::optional<AdmissionTicket> ticket;
+                for (size_t range = nextRange++; range < plan.ranges.size(); range = nextRange++) {
+                    if (failed.load() || job->cancelRequested.load(std::memory_order_acquire)) {
+                        return;
+                    }
+                    try {
+                        if (!ticket) {
+                            ticket = admitExport(admission, ADMISSION_TIMEOUT, [&] { return job->cancelRequested.load(std::memory_order_acquire) || failed.load(); });
+                        }
+                        auto part = makePartExporter(format);
+                        auto partOptions = options;
+                        if (ordered && range > 0) {
+                            // Only the start of the joined file carries the BOM and the header
+                            partOptions.includeHeader = false;
+                            partOptions.encoding.clear();
+                        }
+                        size_t reportedBytes = 0;
+                        const auto reportBytes = [&] {
+                            const size_t bytes = part.bytesWritten();
+                            job->bytesWritten.fetch_add(bytes - reportedBytes, std::memory_order_relaxed);
+                            reportedBytes = bytes;
+                        };
+                        ExportSink sink(*part.exporter, files[range], partOptions, [&](size_t rows) {
+                            job->rowsWritten.fetch_add(rows, std::memory_order_relaxed);
+                            reportBytes();
+                            return !job->cancelRequested.load(std::memory_order_acquire) && !failed.load();
+                        });
+                        PipelinedBatchSink pipeline(sink);
+                        auto summary = driver->executeStreaming(keyRangeQuery(plan, range, ordered), pipeline);
+                        const bool delivered = pipeline.finish();
+                        const bool finished = sink.finish() && delivered;
+                        reportBytes();
+                        if (!finished || summary.stopped) {
+                            fail(std::format("Failed to write {}", files[range]));
+                            return;
+                        }
+                        job->partsDone.fetch_add(1, std::memory_order_relaxed);
+                    } catch (const std::exception& e) {
+                        fail(e.what());
+                        return;
+                    }
+                }
+            };
+            std::vector<std::thread> workers;
+            for (size_t laneIndex = 1; laneIndex < job->drivers.size(); ++laneIndex) {
+                workers.emplace_back(run, laneIndex);
+            }
+            run(0);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            heldLanes.clear();
+
+            ExportStatus finalStatus = ExportStatus::Failed;
+            if (job->cancelRequested.load(std::memory_order_acquire)) {
+                // driver->cancel() surfaces as an ODBC error ("Operation canceled")
+                finalStatus = ExportStatus::Cancelled;
+            } else if (failed.load()) {
+                job->errorMessage = firstError;
+            } else if (!ordered || concatenateFiles(files, job->filepath)) {
+                finalStatus = ExportStatus::Completed;
+            } else {
+                job->errorMessage = std::format("Failed to write {}", job->filepath);
+            }
+            if (ordered || finalStatus != ExportStatus::Completed) {
+                removeFiles(files);
+            }
+            job->endTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            job->status.store(finalStatus, std::memory_order_release);
+        });
+
+        std::string exportId;
+        {
+            std::lock_guard lock(m_jobsMutex);
+            evictFinishedJobs();
+            exportId = std::format("export_{}", m_exportIdCounter++);
+            m_jobs[exportId] = job;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"exportId":"{}",{}}})", exportId, response));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ExportProvider::handleGetExportProgress(const IPCParams& params) {
+    try {
+        auto exportIdResult = params["exportId"].get_string();
+        if (exportIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: exportId");
+        }
+        auto exportId = std::string(exportIdResult.value());
+
+        auto job = findJob(exportId);
+        if (!job) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Export not found: {}", exportId));
+        }
+
+        const auto status = job->status.load(std::memory_order_acquire);
+        const auto endTicks = job->endTicks.load(std::memory_order_relaxed);
+        const auto endTime = status == ExportStatus::Running ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(endTicks));
+        const auto elapsedMs = std::chrono::duration<double, std::milli>(endTime - job->startTime).count();
+
+        std::string jsonResponse = std::format(R"({{"exportId":"{}","status":"{}","filepath":"{}","rowsWritten":{},"bytesWritten":{},"elapsedMs":{:.1f})", exportId, exportStatusToString(status),
+                                               JsonUtils::escapeString(job->filepath), job->rowsWritten.load(std::memory_order_relaxed), job->bytesWritten.load(std::memory_order_relaxed), elapsedMs);
+        if (job->parts > 0) {
+            jsonResponse += std::format(R"(,"parts":{},"partsDone":{})", job->parts, job->partsDone.load(std::memory_order_relaxed));
+        }
+        if (status == ExportStatus::Completed && !job->partFiles.empty()) {
+            jsonResponse += R"(,"partFiles":[)";
+            for (size_t i = 0; i < job->partFiles.size(); ++i) {
+                jsonResponse += std::format(R"({}"{}")", i > 0 ? "," : "", JsonUtils::escapeString(job->partFiles[i]));
+            }
+            jsonResponse += ']';
+        }
+        if (status == ExportStatus::Failed && !job->errorMessage.empty()) {
+            jsonResponse += std::format(R"(,"error":"{}")", JsonUtils::escapeString(job->errorMessage));
+        }
+        jsonResponse += '}';
+        return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ExportProvider::handleCancelExport(const IPCParams& params) {
+    try {
+        auto exportIdResult = params["exportId"].get_string();
+        if (exportIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: exportId");
+        }
+
+        auto job = findJob(exportIdResult.value());
+        bool cancelled = false;
+        if (job && job->status.load(std::memory_order_acquire) == ExportStatus::Running) {
+            job->cancelRequested.store(true, std::memory_order_release);
+            // Interrupt a long server-side wait; the sink stops at the next batch either way
+            for (const auto& driver : job->drivers) {
+                driver->cancel();
+            }
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::shared_ptr<ExportProvider::ExportJob> ExportProvider::findJob(std::string_view exportId) const {
+    std::lock_guard lock(m_jobsMutex);
+    auto it = m_jobs.find(std::string(exportId));
+    return it == m_jobs.end() ? nullptr : it->second;
+}
+
+void ExportProvider::evictFinishedJobs() {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_jobs, [&](const auto& entry) {
+        const auto& job = entry.second;
+        if (job->status.load(std::memory_order_acquire) == ExportStatus::Running) {
+            return false;
+        }
+        const auto endTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(job->endTicks.load(std::memory_order_relaxed)));
+        return now - endTime > FINISHED_JOB_RETENTION;
+    });
+}
+
+std::string ExportProvider::handleExportCSV(const IPCParams& params) {
     return exportWithDriver(params, "csv");
 }
 
-std::string ExportProvider::handleExportJSON(std::string_view params) {
+std::string ExportProvider::handleExportJSON(const IPCParams& params) {
     return exportWithDriver(params, "json");
 }
 
-std::string ExportProvider::handleExportExcel(std::string_view params) {
+std::string ExportProvider::handleExportExcel(const IPCParams& params) {
     return exportWithDriver(params, "excel");
 }
 
+std::string ExportProvider::handleExportParquet(const IPCParams& params) {
+    return exportWithDriver(params, "parquet");
+}
+
+std::string ExportProvider::handleExportSqlInsert(const IPCParams& params) {
+    return exportWithDriver(params, "sql");
+}
+
 }  // namespace velocitydb
@@ -2,18 +2,24 @@
 
 #include "../interfaces/providers/export_provider.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace velocitydb {
 
 class IConnectionProvider;
+class IQueryProvider;
 
 /// Provider for data export operations
 class ExportProvider : public IExportProvider {
 public:
-    explicit ExportProvider(IConnectionProvider& connections);
+    ExportProvider(IConnectionProvider& connections, IQueryProvider& queries);
     ~ExportProvider() override;
 
     ExportProvider(const ExportProvider&) = delete;
@@ -21,15 +27,35 @@ public:
     ExportProvider(ExportProvider&&) = delete;
     ExportProvider& operator=(ExportProvider&&) = delete;
 
-    [[nodiscard]] std::string handleExportCSV(std::string_view params) override;
-    [[nodiscard]] std::string handleExportJSON(std::string_view params) override;
-    [[nodiscard]] std::string handleExportExcel(std::string_view params) override;
+    [[nodiscard]] std::string handleExportCSV(const IPCParams& params) override;
+    [[nodiscard]] std::string handleExportJSON(const IPCParams& params) override;
+    [[nodiscard]] std::string handleExportExcel(const IPCParams& params) override;
+    [[nodiscard]] std::string handleExportParquet(const IPCParams& params) override;
+    [[nodiscard]] std::string handleExportSqlInsert(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStartCSVExport(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStartPartitionedExport(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetExportProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelExport(const IPCParams& params) override;
     [[nodiscard]] std::vector<std::string> getSupportedFormats() const override;
 
 private:
-    [[nodiscard]] std::string exportWithDriver(std::string_view params, std::string_view format);
+    struct ExportJob;
+
+    [[nodiscard]] std::string exportWithDriver(const IPCParams& params, std::string_view format);
+    [[nodiscard]] std::shared_ptr<ExportJob> findJob(std::string_view exportId) const;
+    void evictFinishedJobs();  // Caller holds m_jobsMutex
+
+    static constexpr auto FINISHED_JOB_RETENTION = std::chrono::minutes{5};
+    static constexpr size_t DEFAULT_PARTITIONS = 8;
+    static constexpr size_t DEFAULT_PARTITION_CONNECTIONS = 4;
+    /// How long an export waits for its server to admit it before giving up
+    static constexpr auto ADMISSION_TIMEOUT = std::chrono::minutes{10};
 
     IConnectionProvider& m_connections;
+    IQueryProvider& m_queries;
+    mutable std::mutex m_jobsMutex;
+    std::unordered_map<std::string, std::shared_ptr<ExportJob>> m_jobs;
+    size_t m_exportIdCounter = 1;  // guarded by m_jobsMutex
 };
 
 }  // namespace velocitydb
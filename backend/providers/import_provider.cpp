@@ -0,0 +1,448 @@
+#include "import_provider.h"
+
+#include "../database/schema_inspector.h"
+#include "../database/sqlserver_driver.h"
+#include "../database/statement_waves.h"
+#include "../importers/bulk_loader.h"
+#include "../importers/csv_importer.h"
+#include "../importers/json_importer.h"
+#include "../importers/script_runner.h"
+#include "../interfaces/providers/connection_provider.h"
+#include "../utils/json_utils.h"
+#include "../utils/logger.h"
+#include "../utils/mapped_file.h"
+#include "simdjson.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <format>
+#include <future>
+#include <vector>
+
+namespace velocitydb {
+
+namespace {
+
+void parseImportOptions(const IPCParams& params, ImportOptions& options) {
+    if (auto delimiter = params["delimiter"].get_string(); !delimiter.error()) {
+        options.delimiter = std::string(delimiter.value());
+    }
+    if (auto hasHeader = params["hasHeader"].get_bool(); !hasHeader.error()) {
+        options.hasHeader = hasHeader.value();
+    }
+    if (auto nullValue = params["nullValue"].get_string(); !nullValue.error()) {
+        options.nullValue = std::string(nullValue.value());
+    }
+}
+
+/// "json" for .json/.jsonl/.ndjson files unless `format` says otherwise, "csv" for everything else
+[[nodiscard]] bool isJsonImport(const IPCParams& params, const std::string& filepath) {
+    if (auto format = params["format"].get_string(); !format.error()) {
+        return format.value() == "json";
+    }
+    auto extension = std::filesystem::path(filepath).extension().string();
+    std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".json" || extension == ".jsonl" || extension == ".ndjson";
+}
+
+[[nodiscard]] std::string_view importStatusToString(ImportStatus status) noexcept {
+    switch (status) {
+        case ImportStatus::Running:
+            return "running";
+        case ImportStatus::Completed:
+            return "completed";
+        case ImportStatus::Cancelled:
+            return "cancelled";
+        case ImportStatus::Failed:
+            return "failed";
+    }
+    return "unknown";
+}
+
+}  // namespace
+
+struct ImportProvider::ImportJob {
+    std::future<void> future;
+    std::vector<QueryLane> lanes;
+    std::string filepath;
+    std::string table;
+    std::atomic<ImportStatus> status{ImportStatus::Running};
+    std::atomic<bool> cancelRequested{false};
+    BulkLoadProgress progress;
+    std::string errorMessage;  // Written before the terminal status is published
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<std::chrono::steady_clock::time_point::rep> endTicks{0};
+};
+
+struct ImportProvider::ScriptRunJob {
+    std::future<void> future;
+    QueryLane lane;
+    MappedFile file;
+    std::string filepath;
+    std::atomic<ImportStatus> status{ImportStatus::Running};
+    std::atomic<bool> cancelRequested{false};
+    ScriptRunProgress progress;
+    std::string errorMessage;  // Written before the terminal status is published
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<std::chrono::steady_clock::time_point::rep> endTicks{0};
+};
+
+ImportProvider::ImportProvider(IConnectionProvider& connections) : m_connections(connections) {}
+
+ImportProvider::~ImportProvider() {
+    std::vector<std::shared_ptr<ImportJob>> jobs;
+    std::vector<std::shared_ptr<ScriptRunJob>> runs;
+    {
+        std::lock_guard lock(m_jobsMutex);
+        for (auto& [id, job] : m_jobs) {
+            jobs.push_back(job);
+        }
+        for (auto& [id, run] : m_scriptRuns) {
+            runs.push_back(run);
+        }
+    }
+    // Stop and wait WITHOUT holding the mutex
+    for (auto& job : jobs) {
+        job->cancelRequested.store(true, std::memory_order_release);
+        if (job->future.valid()) {
+            job->future.wait();
+        }
+    }
+    for (auto& run : runs) {
+        run->cancelRequested.store(true, std::memory_order_release);
+        if (run->status.load(std::memory_order_acquire) == ImportStatus::Running && run->lane) {
+            run->lane.driver()->cancel();
+        }
+        if (run->future.valid()) {
+            run->future.wait();
+        }
+    }
+}
+
+std::string ImportProvider::handleStartImport(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto filepathResult = params["filepath"].get_string();
+        auto tableResult = params["table"].get_string();
+        if (connectionIdResult.error() || filepathResult.error() || tableResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId, filepath, or table");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        auto filepath = std::string(filepathResult.value());
+        auto table = std::string(tableResult.value());
+
+        auto metadataDriver = m_connections.getMetadataDriver(connectionId);
+        if (!metadataDriver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+        SchemaInspector inspector;
+        inspector.setDriver(metadataDriver);
+        const auto columns = inspector.getColumns(table);
+        if (columns.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Table not found: {}", table));
+        }
+
+        // Header and mapping problems are reported now rather than through the job
+        ImportOptions options{};
+        parseImportOptions(params, options);
+        std::unique_ptr<DataImporter> source;
+        if (isJsonImport(params, filepath)) {
+            source = std::make_unique<JSONImporter>();
+        } else {
+            source = std::make_unique<CSVImporter>();
+        }
+        if (!source->open(filepath, options)) [[unlikely]] {
+            return JsonUtils::errorResponse(source->lastError());
+        }
+        auto mapping = ImportPlan::create(table, source->fieldNames(), columns, !options.hasHeader);
+        if (!mapping) [[unlikely]] {
+            return JsonUtils::errorResponse(mapping.error());
+        }
+
+        size_t batchRows = BulkLoader::DEFAULT_BATCH_ROWS;
+        if (auto batchOpt = params["batchRows"].get_int64(); !batchOpt.error() && batchOpt.value() > 0) {
+            batchRows = static_cast<size_t>(batchOpt.value());
+        }
+        size_t connections = MAX_PARALLEL_STATEMENTS;
+        if (auto connectionsOpt = params["connections"].get_int64(); !connectionsOpt.error() && connectionsOpt.value() > 0) {
+            connections = (std::min)(static_cast<size_t>(connectionsOpt.value()), MAX_PARALLEL_STATEMENTS);
+        }
+
+        auto job = std::make_shared<ImportJob>();
+        job->filepath = filepath;
+        job->table = table;
+        job->startTime = std::chrono::steady_clock::now();
+        // Inserts into a permanent table work from any session, so the pooled lanes load in parallel.
+        // A lane handed out twice (fewer lanes than requested) would only serialize, so duplicates are dropped.
+        for (size_t i = 0; i < connections; ++i) {
+            auto lane = m_connections.acquireQueryLane(connectionId, true);
+            if (!lane) [[unlikely]] {
+                break;
+            }
+            if (std::ranges::none_of(job->lanes, [&](const QueryLane& held) { return held.driver() == lane.driver(); })) {
+                job->lanes.push_back(std::move(lane));
+            }
+        }
+        if (job->lanes.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        // Capture shared_ptrs by value so the job and its source outlive the IPC call
+        job->future = std::async(std::launch::async, [job, source = std::shared_ptr<DataImporter>(std::move(source)), plan = std::move(*mapping), batchRows] {
+            std::vector<BatchInserter> inserters;
+            for (const auto& lane : job->lanes) {
+                inserters.emplace_back([driver = lane.driver(), &plan](const ResultSet& batch) { return driver->insertRows(plan.insertStatement(), batch); });
+            }
+            ImportStatus finalStatus = ImportStatus::Failed;
+            try {
+                BulkLoader::load(*source, plan, inserters, job->progress, job->cancelRequested, batchRows);
+                finalStatus = job->cancelRequested.load(std::memory_order_acquire) ? ImportStatus::Cancelled : ImportStatus::Completed;
+            } catch (const std::exception& e) {
+                // driver->cancel() surfaces as an ODBC error ("Operation canceled")
+                if (job->cancelRequested.load(std::memory_order_acquire)) {
+                    finalStatus = ImportStatus::Cancelled;
+                } else {
+                    job->errorMessage = e.what();
+                }
+            }
+            log<LogLevel::INFO>(std::format("Import of {} into {}: {} of {} records inserted", job->filepath, job->table, job->progress.rowsInserted.load(std::memory_order_relaxed),
+                                            job->progress.recordsRead.load(std::memory_order_relaxed)));
+            job->lanes.clear();
+            job->endTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            job->status.store(finalStatus, std::memory_order_release);
+        });
+
+        std::string importId;
+        {
+            std::lock_guard lock(m_jobsMutex);
+            evictFinishedJobs();
+            importId = std::format("import_{}", m_importIdCounter++);
+            m_jobs[importId] = job;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"importId":"{}"}})", importId));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ImportProvider::handleGetImportProgress(const IPCParams& params) {
+    try {
+        auto importIdResult = params["importId"].get_string();
+        if (importIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: importId");
+        }
+        auto importId = std::string(importIdResult.value());
+
+        auto job = findJob(importId);
+        if (!job) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Import not found: {}", importId));
+        }
+
+        const auto status = job->status.load(std::memory_order_acquire);
+        const auto endTicks = job->endTicks.load(std::memory_order_relaxed);
+        const auto endTime = status == ImportStatus::Running ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(endTicks));
+        const auto elapsedMs = std::chrono::duration<double, std::milli>(endTime - job->startTime).count();
+        const auto rowsInserted = job->progress.rowsInserted.load(std::memory_order_relaxed);
+        const double rowsPerSecond = elapsedMs > 0.0 ? static_cast<double>(rowsInserted) * 1000.0 / elapsedMs : 0.0;
+
+        std::string jsonResponse = std::format(R"({{"importId":"{}","status":"{}","table":"{}","recordsRead":{},"rowsInserted":{},"bytesRead":{},)"
+                                               R"("totalBytes":{},"elapsedMs":{:.1f},"rowsPerSecond":{:.0f})",
+                                               importId, importStatusToString(status), JsonUtils::escapeString(job->table), job->progress.recordsRead.load(std::memory_order_relaxed), rowsInserted,
+                                               job->progress.bytesRead.load(std::memory_order_relaxed), job->progress.totalBytes.load(std::memory_order_relaxed), elapsedMs, rowsPerSecond);
+        if (status == ImportStatus::Failed && !job->errorMessage.empty()) {
+            jsonResponse += std::format(R"(,"error":"{}")", JsonUtils::escapeString(job->errorMessage));
+        }
+        jsonResponse += '}';
+        return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ImportProvider::handleCancelImport(const IPCParams& params) {
+    try {
+        auto importIdResult = params["importId"].get_string();
+        if (importIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: importId");
+        }
+
+        auto job = findJob(importIdResult.value());
+        bool cancelled = false;
+        if (job && job->status.load(std::memory_order_acquire) == ImportStatus::Running) {
+            // Batches in flight are small and finish; no new one starts
+            job->cancelRequested.store(true, std::memory_order_release);
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ImportProvider::handleStartScriptRun(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto filepathResult = params["filepath"].get_string();
+        if (connectionIdResult.error() || filepathResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId or filepath");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        bool continueOnError = false;
+        if (auto continueOpt = params["continueOnError"].get_bool(); !continueOpt.error()) {
+            continueOnError = continueOpt.value();
+        }
+
+        auto job = std::make_shared<ScriptRunJob>();
+        job->filepath = std::string(filepathResult.value());
+        if (!job->file.open(job->filepath)) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Failed to open file: {}", job->filepath));
+        }
+        // A script changes session state (USE, SET, #temp tables), so it runs where the editor's queries do
+        job->lane = m_connections.acquireQueryLane(connectionId, false);
+        if (!job->lane) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+        job->startTime = std::chrono::steady_clock::now();
+
+        job->future = std::async(std::launch::async, [this, job, connectionId, continueOnError] {
+            const auto& driver = job->lane.driver();
+            auto execute = [&driver](std::string_view batch) {
+                int64_t rows = 0;
+                for (const auto& result : driver->executeBatch(batch)) {
+                    rows += (std::max)(result.affectedRows, int64_t{0});
+                }
+                return rows;
+            };
+            ImportStatus finalStatus = ImportStatus::Failed;
+            try {
+                const bool completed = ScriptRunner::run(job->file.view(), execute, job->progress, job->cancelRequested, continueOnError);
+                if (job->cancelRequested.load(std::memory_order_acquire)) {
+                    finalStatus = ImportStatus::Cancelled;
+                } else if (completed) {
+                    finalStatus = ImportStatus::Completed;
+                } else {
+                    job->errorMessage = std::format("{} batch(es) failed", job->progress.errorCount());
+                }
+            } catch (const std::exception& e) {
+                job->errorMessage = e.what();
+            }
+            // A USE in the script moved the session lane; the other lanes follow it
+            try {
+                auto current = driver->execute("SELECT DB_NAME()");
+                if (current.rowCount() > 0) {
+                    m_connections.noteDatabaseChange(connectionId, current.cellText(0, 0));
+                }
+            } catch (const std::exception& e) {
+                log<LogLevel::WARNING>(std::format("Script run of {}: could not read the current database: {}", job->filepath, e.what()));
+            }
+            log<LogLevel::INFO>(std::format("Script run of {}: {} batches, {} rows affected, {} errors", job->filepath, job->progress.batchesRun.load(std::memory_order_relaxed),
+                                            job->progress.rowsAffected.load(std::memory_order_relaxed), job->progress.errorCount()));
+            job->lane.release();
+            job->endTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            job->status.store(finalStatus, std::memory_order_release);
+        });
+
+        std::string runId;
+        {
+            std::lock_guard lock(m_jobsMutex);
+            evictFinishedJobs();
+            runId = std::format("script_{}", m_scriptRunIdCounter++);
+            m_scriptRuns[runId] = job;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"runId":"{}"}})", runId));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ImportProvider::handleGetScriptRunProgress(const IPCParams& params) {
+    try {
+        auto runIdResult = params["runId"].get_string();
+        if (runIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: runId");
+        }
+        auto runId = std::string(runIdResult.value());
+        size_t errorsSince = 0;
+        if (auto sinceOpt = params["errorsSince"].get_int64(); !sinceOpt.error() && sinceOpt.value() > 0) {
+            errorsSince = static_cast<size_t>(sinceOpt.value());
+        }
+
+        auto job = findScriptRun(runId);
+        if (!job) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Script run not found: {}", runId));
+        }
+
+        const auto status = job->status.load(std::memory_order_acquire);
+        const auto endTicks = job->endTicks.load(std::memory_order_relaxed);
+        const auto endTime = status == ImportStatus::Running ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(endTicks));
+        const auto elapsedMs = std::chrono::duration<double, std::milli>(endTime - job->startTime).count();
+        const auto& progress = job->progress;
+
+        std::string jsonResponse = std::format(R"({{"runId":"{}","status":"{}","bytesRead":{},"bytesExecuted":{},"totalBytes":{},"batchesRun":{},)"
+                                               R"("rowsAffected":{},"errorCount":{},"elapsedMs":{:.1f},"errors":)",
+                                               runId, importStatusToString(status), progress.bytesRead.load(std::memory_order_relaxed), progress.bytesExecuted.load(std::memory_order_relaxed),
+                                               progress.totalBytes.load(std::memory_order_relaxed), progress.batchesRun.load(std::memory_order_relaxed),
+                                               progress.rowsAffected.load(std::memory_order_relaxed), progress.errorCount(), elapsedMs);
+        jsonResponse += JsonUtils::buildArray(progress.errorsSince(errorsSince), [](std::string& out, const ScriptRunError& error) {
+            out += std::format(R"({{"offset":{},"line":{},"batch":{},"message":"{}"}})", error.offset, error.line, error.batch, JsonUtils::escapeString(error.message));
+        });
+        if (status == ImportStatus::Failed && !job->errorMessage.empty()) {
+            jsonResponse += std::format(R"(,"error":"{}")", JsonUtils::escapeString(job->errorMessage));
+        }
+        jsonResponse += '}';
+        return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string ImportProvider::handleCancelScriptRun(const IPCParams& params) {
+    try {
+        auto runIdResult = params["runId"].get_string();
+        if (runIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: runId");
+        }
+
+        auto job = findScriptRun(runIdResult.value());
+        bool cancelled = false;
+        if (job && job->status.load(std::memory_order_acquire) == ImportStatus::Running) {
+            // A batch may run for minutes: stop it on the server too
+            job->cancelRequested.store(true, std::memory_order_release);
+            job->lane.driver()->cancel();
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::shared_ptr<ImportProvider::ImportJob> ImportProvider::findJob(std::string_view importId) const {
+    std::lock_guard lock(m_jobsMutex);
+    auto it = m_jobs.find(std::string(importId));
+    return it == m_jobs.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<ImportProvider::ScriptRunJob> ImportProvider::findScriptRun(std::string_view runId) const {
+    std::lock_guard lock(m_jobsMutex);
+    auto it = m_scriptRuns.find(std::string(runId));
+    return it == m_scriptRuns.end() ? nullptr : it->second;
+}
+
+void ImportProvider::evictFinishedJobs() {
+    const auto now = std::chrono::steady_clock::now();
+    auto expired = [&](const auto& entry) {
+        const auto& job = entry.second;
+        if (job->status.load(std::memory_order_acquire) == ImportStatus::Running) {
+            return false;
+        }
+        const auto endTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(job->endTicks.load(std::memory_order_relaxed)));
+        return now - endTime > FINISHED_JOB_RETENTION;
+    };
+    std::erase_if(m_jobs, expired);
+    std::erase_if(m_scriptRuns, expired);
+}
+
+}  // namespace velocitydb
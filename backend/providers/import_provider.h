@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../interfaces/providers/import_provider.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace velocitydb {
+
+class IConnectionProvider;
+
+/// Provider for CSV/JSON imports into tables (see BulkLoader) and .sql script runs (see ScriptRunner)
+class ImportProvider : public IImportProvider {
+public:
+    explicit ImportProvider(IConnectionProvider& connections);
+    ~ImportProvider() override;
+
+    ImportProvider(const ImportProvider&) = delete;
+    ImportProvider& operator=(const ImportProvider&) = delete;
+    ImportProvider(ImportProvider&&) = delete;
+    ImportProvider& operator=(ImportProvider&&) = delete;
+
+    [[nodiscard]] std::string handleStartImport(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetImportProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelImport(const IPCParams& params) override;
+
+    [[nodiscard]] std::string handleStartScriptRun(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetScriptRunProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelScriptRun(const IPCParams& params) override;
+
+private:
+    struct ImportJob;
+    struct ScriptRunJob;
+
+    [[nodiscard]] std::shared_ptr<ImportJob> findJob(std::string_view importId) const;
+    [[nodiscard]] std::shared_ptr<ScriptRunJob> findScriptRun(std::string_view runId) const;
+    void evictFinishedJobs();  // Caller holds m_jobsMutex
+
+    static constexpr auto FINISHED_JOB_RETENTION = std::chrono::minutes{5};
+
+    IConnectionProvider& m_connections;
+    mutable std::mutex m_jobsMutex;
+    std::unordered_map<std::string, std::shared_ptr<ImportJob>> m_jobs;
+    size_t m_importIdCounter = 1;  // guarded by m_jobsMutex
+    std::unordered_map<std::string, std::shared_ptr<ScriptRunJob>> m_scriptRuns;  // guarded by m_jobsMutex
+    size_t m_scriptRunIdCounter = 1;                                               // guarded by m_jobsMutex
+};
+
+}  // namespace velocitydb
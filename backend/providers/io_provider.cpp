@@ -1,13 +1,18 @@
 #include "io_provider.h"
 
+#include "../utils/bookmark_store.h"
 #include "../utils/file_dialog.h"
+#include "../utils/encoding.h"
 #include "../utils/json_utils.h"
+#include "../utils/logger.h"
+#include "../utils/mapped_file.h"
 #include "simdjson.h"
 
 #include <algorithm>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <vector>
 
 namespace velocitydb {
 
@@ -16,53 +21,81 @@ namespace {
 constexpr auto kLogPath = "log/frontend.log";
 constexpr auto kBookmarksPath = "data/bookmarks.json";
 
-[[nodiscard]] std::string formatBookmarkJson(std::string_view id, std::string_view name, std::string_view content) {
-    return std::format("{{\"id\":\"{}\",\"name\":\"{}\",\"content\":\"{}\"}}", JsonUtils::escapeString(id), JsonUtils::escapeString(name), JsonUtils::escapeString(content));
-}
-
 }  // namespace
 
-std::string IOProvider::handleWriteFrontendLog(std::string_view params) {
-    try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+IOProvider::IOProvider() : m_bookmarks(std::make_unique<BookmarkStore>(kBookmarksPath)) {}
+
+IOProvider::~IOProvider() = default;
 
-        auto contentResult = doc["content"].get_string();
+AsyncFileLogOutput& IOProvider::frontendLog() {
+    if (!m_frontendLog) {
+        m_frontendLog = std::make_unique<AsyncFileLogOutput>(kLogPath, AsyncFileLogOutput::DEFAULT_CAPACITY, LogOverflowPolicy::DROP, false);
+    }
+    return *m_frontendLog;
+}
+
+std::string IOProvider::handleWriteFrontendLog(const IPCParams& params) {
+    try {
+        auto contentResult = params["content"].get_string();
         if (contentResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: content");
         }
 
         std::lock_guard lock(m_logMutex);
-        std::filesystem::path logPath(kLogPath);
-        std::filesystem::create_directories(logPath.parent_path());
+        frontendLog().write_block(std::string(contentResult.value()));
 
-        auto mode = m_firstLogWrite.exchange(false) ? std::ios::trunc : std::ios::app;
-        std::ofstream logFile(logPath, mode);
-        if (!logFile.is_open()) {
-            return JsonUtils::errorResponse("Failed to open frontend log file");
+        return JsonUtils::successResponse("{}");
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string IOProvider::handleWriteFrontendLogs(const IPCParams& params) {
+    try {
+        auto recordsResult = params["records"].get_array();
+        if (recordsResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: records");
         }
 
-        logFile << contentResult.value();
+        // Views into the request, which outlives this call
+        std::vector<LogRecord> records;
+        for (auto element : recordsResult.value()) {
+            LogRecord record;
+            if (auto timestamp = element["timestamp"].get_string(); !timestamp.error()) {
+                record.timestamp = timestamp.value();
+            }
+            if (auto level = element["level"].get_string(); !level.error()) {
+                record.level = level.value();
+            }
+            if (auto message = element["message"].get_string(); !message.error()) {
+                record.message = message.value();
+            }
+            records.push_back(record);
+        }
 
-        return JsonUtils::successResponse("{}");
+        std::string block;
+        size_t written = 0;
+        {
+            std::lock_guard lock(m_logMutex);
+            written = m_logFilter.append(records, block);
+            frontendLog().write_block(std::move(block));
+        }
+        return JsonUtils::successResponse(std::format(R"({{"received":{},"written":{}}})", records.size(), written));
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string IOProvider::handleSaveQueryToFile(std::string_view params) {
+std::string IOProvider::handleSaveQueryToFile(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto contentResult = doc["content"].get_string();
+        auto contentResult = params["content"].get_string();
         if (contentResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: content");
         }
         auto content = std::string(contentResult.value());
 
         std::string defaultFileName;
-        if (auto name = doc["defaultFileName"].get_string(); !name.error()) {
+        if (auto name = params["defaultFileName"].get_string(); !name.error()) {
             defaultFileName = std::string(name.value());
         }
 
@@ -82,32 +115,38 @@ std::string IOProvider::handleSaveQueryToFile(std::string_view params) {
     }
 }
 
-std::string IOProvider::handleLoadQueryFromFile(std::string_view) {
+std::string IOProvider::handleLoadQueryFromFile(const IPCParams&) {
     try {
         auto result = FileDialog::showOpenDialog("SQL Files (*.sql)\0*.sql\0All Files (*.*)\0*.*\0");
         if (!result) {
             return JsonUtils::errorResponse(result.error());
         }
 
-        auto readResult = FileDialog::readFile(result.value());
-        if (!readResult) {
-            return JsonUtils::errorResponse(readResult.error());
+        // Escape straight from a read-only mapping: large scripts are never copied into an intermediate string
+        const auto& nativePath = result.value().native();
+        MappedFile file;
+        if (!file.open(wideToUtf8(nativePath.c_str(), nativePath.size()))) {
+            return JsonUtils::errorResponse(std::format("Failed to open file: {}", result.value().string()));
         }
+        const auto content = file.view();
 
-        auto json = std::format("{{\"filePath\":\"{}\",\"content\":\"{}\"}}", JsonUtils::escapeString(result.value().string()), JsonUtils::escapeString(readResult.value()));
+        std::string json;
+        json.reserve(content.size() + content.size() / 8 + 64);
+        json += "{\"filePath\":\"";
+        JsonUtils::appendEscaped(json, result.value().string());
+        json += "\",\"content\":\"";
+        JsonUtils::appendEscaped(json, content);
+        json += "\"}";
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string IOProvider::handleBrowseFile(std::string_view params) {
+std::string IOProvider::handleBrowseFile(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
         std::string filter = "All Files (*.*)\0*.*\0";
-        if (auto filterResult = doc["filter"].get_string(); !filterResult.error()) {
+        if (auto filterResult = params["filter"].get_string(); !filterResult.error()) {
             filter = std::string(filterResult.value());
             std::ranges::replace(filter, '|', '\0');
             filter += '\0';
@@ -124,154 +163,36 @@ std::string IOProvider::handleBrowseFile(std::string_view params) {
     }
 }
 
-std::string IOProvider::handleGetBookmarks(std::string_view) {
+std::string IOProvider::handleGetBookmarks(const IPCParams&) {
     try {
-        std::filesystem::path bookmarksPath(kBookmarksPath);
-        if (!std::filesystem::exists(bookmarksPath)) {
-            return JsonUtils::successResponse("[]");
-        }
-
-        auto readResult = FileDialog::readFile(bookmarksPath);
-        if (!readResult) {
-            return JsonUtils::errorResponse(readResult.error());
-        }
-
-        return JsonUtils::successResponse(readResult.value());
+        return JsonUtils::successResponse(m_bookmarks->json());
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string IOProvider::handleSaveBookmark(std::string_view params) {
+std::string IOProvider::handleSaveBookmark(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto idResult = doc["id"].get_string();
-        auto nameResult = doc["name"].get_string();
-        auto contentResult = doc["content"].get_string();
+        auto idResult = params["id"].get_string();
+        auto nameResult = params["name"].get_string();
+        auto contentResult = params["content"].get_string();
         if (idResult.error() || nameResult.error() || contentResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: id, name, or content");
         }
-        auto id = std::string(idResult.value());
-        auto name = std::string(nameResult.value());
-        auto content = std::string(contentResult.value());
-
-        std::filesystem::path bookmarksPath(kBookmarksPath);
-        std::filesystem::create_directories(bookmarksPath.parent_path());
-
-        simdjson::dom::parser existingParser;
-        std::string fileContent;
-        simdjson::dom::array bookmarks;
-        bool hasExisting = false;
-
-        if (std::filesystem::exists(bookmarksPath)) {
-            if (auto readResult = FileDialog::readFile(bookmarksPath); readResult) {
-                fileContent = readResult.value();
-                auto existingDoc = existingParser.parse(fileContent);
-                if (auto arr = existingDoc.get_array(); !arr.error()) {
-                    bookmarks = arr.value();
-                    hasExisting = true;
-                }
-            }
-        }
-
-        std::string json = "[";
-        bool found = false;
-        bool first = true;
-
-        if (hasExisting) {
-            for (auto bookmark : bookmarks) {
-                auto bookmarkIdResult = bookmark["id"].get_string();
-                if (bookmarkIdResult.error())
-                    continue;
-                auto bookmarkId = std::string(bookmarkIdResult.value());
-
-                if (!first)
-                    json += ",";
-
-                if (bookmarkId == id) {
-                    found = true;
-                    json += formatBookmarkJson(id, name, content);
-                } else {
-                    auto eName = bookmark["name"].get_string();
-                    auto eContent = bookmark["content"].get_string();
-                    json += formatBookmarkJson(bookmarkId, eName.error() ? "" : eName.value(), eContent.error() ? "" : eContent.value());
-                }
-                first = false;
-            }
-        }
-
-        if (!found) {
-            if (!first)
-                json += ",";
-            json += formatBookmarkJson(id, name, content);
-        }
-
-        json += "]";
-
-        if (auto writeResult = FileDialog::writeFile(bookmarksPath, json); !writeResult) {
-            return JsonUtils::errorResponse(writeResult.error());
-        }
-
+        m_bookmarks->save({.id = std::string(idResult.value()), .name = std::string(nameResult.value()), .content = std::string(contentResult.value())});
         return JsonUtils::successResponse("{}");
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string IOProvider::handleDeleteBookmark(std::string_view params) {
+std::string IOProvider::handleDeleteBookmark(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto idResult = doc["id"].get_string();
+        auto idResult = params["id"].get_string();
         if (idResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: id");
         }
-        auto id = std::string(idResult.value());
-
-        std::filesystem::path bookmarksPath(kBookmarksPath);
-        if (!std::filesystem::exists(bookmarksPath)) {
-            return JsonUtils::successResponse("{}");
-        }
-
-        auto readResult = FileDialog::readFile(bookmarksPath);
-        if (!readResult) {
-            return JsonUtils::errorResponse(readResult.error());
-        }
-
-        simdjson::dom::parser existingParser;
-        auto existingDoc = existingParser.parse(readResult.value());
-        auto arrResult = existingDoc.get_array();
-        if (arrResult.error()) [[unlikely]] {
-            return JsonUtils::errorResponse("Invalid bookmarks data");
-        }
-
-        std::string json = "[";
-        bool first = true;
-
-        for (auto bookmark : arrResult.value()) {
-            auto bookmarkIdResult = bookmark["id"].get_string();
-            if (bookmarkIdResult.error())
-                continue;
-            auto bookmarkId = std::string(bookmarkIdResult.value());
-            if (bookmarkId != id) {
-                if (!first)
-                    json += ",";
-                auto eName = bookmark["name"].get_string();
-                auto eContent = bookmark["content"].get_string();
-                json += formatBookmarkJson(bookmarkId, eName.error() ? "" : eName.value(), eContent.error() ? "" : eContent.value());
-                first = false;
-            }
-        }
-
-        json += "]";
-
-        if (auto writeResult = FileDialog::writeFile(bookmarksPath, json); !writeResult) {
-            return JsonUtils::errorResponse(writeResult.error());
-        }
-
+        (void)m_bookmarks->remove(idResult.value());
         return JsonUtils::successResponse("{}");
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
@@ -1,36 +1,46 @@
 #pragma once
 
 #include "../interfaces/providers/io_provider.h"
+#include "../utils/log_filter.h"
 
-#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
 
 namespace velocitydb {
 
+class AsyncFileLogOutput;
+class BookmarkStore;
+
 /// Provider for I/O operations (logging, file, bookmarks)
 class IOProvider : public IIOProvider {
 public:
-    IOProvider() = default;
-    ~IOProvider() override = default;
+    IOProvider();
+    ~IOProvider() override;
 
     IOProvider(const IOProvider&) = delete;
     IOProvider& operator=(const IOProvider&) = delete;
     IOProvider(IOProvider&&) = delete;
     IOProvider& operator=(IOProvider&&) = delete;
 
-    [[nodiscard]] std::string handleWriteFrontendLog(std::string_view params) override;
-    [[nodiscard]] std::string handleSaveQueryToFile(std::string_view params) override;
-    [[nodiscard]] std::string handleLoadQueryFromFile(std::string_view params) override;
-    [[nodiscard]] std::string handleBrowseFile(std::string_view params) override;
-    [[nodiscard]] std::string handleGetBookmarks(std::string_view params) override;
-    [[nodiscard]] std::string handleSaveBookmark(std::string_view params) override;
-    [[nodiscard]] std::string handleDeleteBookmark(std::string_view params) override;
+    [[nodiscard]] std::string handleWriteFrontendLog(const IPCParams& params) override;
+    [[nodiscard]] std::string handleWriteFrontendLogs(const IPCParams& params) override;
+    [[nodiscard]] std::string handleSaveQueryToFile(const IPCParams& params) override;
+    [[nodiscard]] std::string handleLoadQueryFromFile(const IPCParams& params) override;
+    [[nodiscard]] std::string handleBrowseFile(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetBookmarks(const IPCParams& params) override;
+    [[nodiscard]] std::string handleSaveBookmark(const IPCParams& params) override;
+    [[nodiscard]] std::string handleDeleteBookmark(const IPCParams& params) override;
 
 private:
-    std::atomic<bool> m_firstLogWrite{true};
-    std::mutex m_logMutex;
+    /// Frontend log, opened (and truncated) on first use
+    [[nodiscard]] AsyncFileLogOutput& frontendLog();
+
+    std::mutex m_logMutex;  // guards m_frontendLog creation and m_logFilter
+    std::unique_ptr<AsyncFileLogOutput> m_frontendLog;
+    LogFilter m_logFilter;
+    std::unique_ptr<BookmarkStore> m_bookmarks;
 };
 
 }  // namespace velocitydb
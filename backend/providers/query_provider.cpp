@@ -1,47 +1,299 @@
 #include "query_provider.h"
 
+#include "../database/admission_controller.h"
+#include "../database/async_query_executor.h"
+#include "../database/broadcast_query.h"
 #include "../database/connection_utils.h"
+#include "../database/disk_result_cache.h"
+#include "../database/paged_result_spill.h"
+#include "../database/plan_estimate.h"
 #include "../database/query_history.h"
+#include "../database/query_scheduler.h"
 #include "../database/result_cache.h"
+#include "../database/result_registry.h"
 #include "../database/sqlserver_driver.h"
+#include "../database/statement_waves.h"
+#include "../database/workload_replay.h"
+#include "../importers/file_datasource.h"
 #include "../interfaces/providers/connection_provider.h"
 #include "../parsers/sql_parser.h"
+#include "../utils/binary_result.h"
+#include "../utils/cancellation_token.h"
+#include "../utils/clipboard.h"
+#include "../utils/filter_expression.h"
+#include "../utils/grid_copy.h"
 #include "../utils/json_utils.h"
 #include "../utils/logger.h"
+#include "../utils/memory_governor.h"
+#include "../utils/metrics.h"
+#include "../utils/query_trace.h"
+#include "../utils/result_aggregator.h"
+#include "../utils/result_comparer.h"
+#include "../utils/result_delta.h"
+#include "../utils/result_joiner.h"
+#include "../utils/result_snapshot.h"
 #include "../utils/simd_filter.h"
 #include "../utils/sql_validation.h"
 #include "simdjson.h"
 
+#include <algorithm>
+#include <bit>
 #include <chrono>
+#include <expected>
 #include <format>
+#include <functional>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <optional>
+#include <span>
+#include <unordered_map>
 
 using namespace std::literals;
 
 namespace velocitydb {
 
-QueryProvider::QueryProvider(IConnectionProvider& connections) : m_connections(connections), m_resultCache(std::make_unique<ResultCache>()), m_queryHistory(std::make_unique<QueryHistory>()) {}
+namespace {
 
-QueryProvider::~QueryProvider() = default;
-
-std::string QueryProvider::handleExecuteQuery(std::string_view params) {
+/// Change marker for `tables` in the session's current database: the change tracking version plus the latest
+/// user write recorded in sys.dm_db_index_usage_stats. nullopt when the server reports neither (or the probe fails,
+/// e.g. without VIEW SERVER STATE), in which case the entry is served on its TTL alone.
+std::optional<std::string> probeFreshness(SQLServerDriver& driver, std::span<const std::string> tables) {
+    if (tables.empty()) {
+        return std::nullopt;
+    }
+    std::string objectIds;
+    for (const auto& table : tables) {
+        std::string quoted;
+        for (char c : table) {
+            if (c == '\'') {
+                quoted += "''";
+            } else if (c == ']') {
+                quoted += "]]";
+            } else {
+                quoted += c;
+            }
+        }
+        objectIds += std::format("{}OBJECT_ID(N'[{}]')", objectIds.empty() ? "" : ",", quoted);
+    }
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+        auto probe = driver.execute(std::format("SELECT CHANGE_TRACKING_CURRENT_VERSION(), CONVERT(varchar(33), MAX(last_user_update), 126) "
+                                                "FROM sys.dm_db_index_usage_stats WHERE database_id = DB_ID() AND object_id IN ({})",
+                                                objectIds));
+        if (probe.empty() || (probe.isNull(0, 0) && probe.isNull(0, 1))) {
+            return std::nullopt;
+        }
+        return std::format("{}|{}", probe.isNull(0, 0) ? std::string{} : probe.cellText(0, 0), probe.isNull(0, 1) ? std::string{} : probe.cellText(0, 1));
+    } catch (const std::exception& e) {
+        log<LogLevel::DEBUG>(std::format("Cache freshness probe failed: {}", e.what()));
+        return std::nullopt;
+    }
+}
+
+/// One side of a data comparison
+struct CompareSide {
+    std::string connectionId;
+    std::string sql;    ///< The query, or SELECT * over `table`
+    std::string table;  ///< Bracket-quoted table name; empty when comparing a query
+};
+
+std::expected<CompareSide, std::string> parseCompareSide(const IPCParams& params, std::string_view name) {
+    auto side = params[name];
+    auto connectionId = side["connectionId"].get_string();
+    if (connectionId.error()) [[unlikely]] {
+        return std::unexpected(std::format("Missing required field: {}.connectionId", name));
+    }
+    CompareSide result{.connectionId = std::string(connectionId.value())};
+    if (auto table = side["table"].get_string(); !table.error()) {
+        result.table = quoteBracketIdentifier(unquoteBracketIdentifier(table.value()));
+        result.sql = std::format("SELECT * FROM {}", result.table);
+    } else if (auto sql = side["sql"].get_string(); !sql.error()) {
+        result.sql = std::string(sql.value());
+        if (!SQLParser::isReadOnlyQuery(result.sql)) [[unlikely]] {
+            return std::unexpected(std::format("{}.sql must be a read-only query", name));
+        }
+    } else [[unlikely]] {
+        return std::unexpected(std::format("{} needs a table or a sql query", name));
+    }
+    return result;
+}
+
+/// Row count and CHECKSUM_AGG(BINARY_CHECKSUM(*)) per chunk of a table
+using ChunkChecksums = std::unordered_map<int64_t, std::pair<int64_t, int64_t>>;
+
+ChunkChecksums readChunkChecksums(SQLServerDriver& driver, const CompareSide& side, std::string_view chunkExpression) {
+    auto result = driver.execute(std::format("SELECT {0}, COUNT_BIG(*), CHECKSUM_AGG(BINARY_CHECKSUM(*)) FROM {1} GROUP BY {0}", chunkExpression, side.table));
+    ChunkChecksums chunks;
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        const int64_t checksum = result.isNull(row, 2) ? 0 : std::stoll(result.cellText(row, 2));
+        chunks.emplace(std::stoll(result.cellText(row, 0)), std::pair{std::stoll(result.cellText(row, 1)), checksum});
+    }
+    return chunks;
+}
+
+void appendDiffRows(std::string& json, const ResultSet& rows) {
+    json += '[';
+    for (size_t row = 0; row < rows.rowCount(); ++row) {
+        if (row > 0)
+            json += ',';
+        JsonUtils::appendRow(json, rows, row);
+    }
+    json += ']';
+}
+
+std::string serializeComparison(const CompareResult& comparison) {
+    std::string json = "{";
+    JsonUtils::appendColumns(json, comparison.columns);
+    json += R"(,"keyColumns":[)";
+    for (size_t i = 0; i < comparison.keyColumns.size(); ++i) {
+        json += std::format("{}{}", i > 0 ? "," : "", comparison.keyColumns[i]);
+    }
+    json += std::format(R"(],"inserted":{{"count":{},"rows":)", comparison.insertedCount);
+    appendDiffRows(json, comparison.inserted);
+    json += std::format(R"(}},"deleted":{{"count":{},"rows":)", comparison.deletedCount);
+    appendDiffRows(json, comparison.deleted);
+    json += std::format(R"(}},"changed":{{"count":{},"rows":[)", comparison.changedCount);
+    for (size_t row = 0; row < comparison.changedColumns.size(); ++row) {
+        if (row > 0)
+            json += ',';
+        json += R"({"before":)";
+        JsonUtils::appendRow(json, comparison.changedBefore, row);
+        json += R"(,"after":)";
+        JsonUtils::appendRow(json, comparison.changedAfter, row);
+        json += R"(,"columns":[)";
+        for (size_t i = 0; i < comparison.changedColumns[row].size(); ++i) {
+            json += std::format("{}{}", i > 0 ? "," : "", comparison.changedColumns[row][i]);
+        }
+        json += "]}";
+    }
+    json += std::format(R"(]}},"unchangedCount":{},"truncated":{})", comparison.unchangedCount, comparison.truncated ? "true" : "false");
+    return json;
+}
+
+/// A checked-out lane as a broadcast session; releasing the session hands the lane and the server share back
+[[nodiscard]] BroadcastSession broadcastSession(QueryLane lane, AdmissionTicket ticket = {}) {
+    struct Held {
+        QueryLane lane;
+        AdmissionTicket ticket;
+    };
+    auto held = std::make_shared<Held>(std::move(lane), std::move(ticket));
+    return BroadcastSession{.driver = held->lane.driver(), .release = [held] {
+                                held->lane.release();
+                                held->ticket.release();
+                            }};
+}
+
+/// Wait up to `timeout` for the server to admit `request`; the error names the busy server
+[[nodiscard]] std::expected<AdmissionTicket, std::string> admit(const AdmissionRequest& request, std::chrono::milliseconds timeout) {
+    auto ticket = AdmissionController::instance().acquire(request, timeout);
+    if (!ticket) [[unlikely]] {
+        return std::unexpected(std::format("Not started: {} is busy with other queries and exports", request.server));
+    }
+    return std::move(*ticket);
+}
 
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
+void appendBroadcastOutcome(std::string& json, const BroadcastServerResult& outcome) {
+    json += std::format(R"({{"index":{},"server":"{}","success":{},"timedOut":{},"truncated":{},"rows":{},"elapsedMs":{:.1f})", outcome.index, JsonUtils::escapeString(outcome.server),
+                        outcome.success ? "true" : "false", outcome.timedOut ? "true" : "false", outcome.truncated ? "true" : "false", outcome.rows, outcome.elapsedMs);
+    if (!outcome.message.empty()) {
+        json += std::format(R"(,"message":"{}")", JsonUtils::escapeString(outcome.message));
+    }
+    json += '}';
+}
+
+/// "name":{count, minMs, meanMs, p50Ms, p95Ms, p99Ms, maxMs}
+void appendLatencySummary(std::string& json, std::string_view name, const LatencySummary& summary) {
+    json += std::format(R"("{}":{{"count":{},"minMs":{:.2f},"meanMs":{:.2f},"p50Ms":{:.2f},"p95Ms":{:.2f},"p99Ms":{:.2f},"maxMs":{:.2f}}})", name, summary.count, summary.minMs, summary.meanMs,
+                        summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+}
+
+/// rowCount, truncated, createdAt, fileBytes and per column its schema, nullCount and min/max
+std::string snapshotInfoJson(const SnapshotInfo& info) {
+    std::string json = std::format(R"("rowCount":{},"truncated":{},"createdAt":{},"fileBytes":{},"columns":[)", info.rowCount, info.truncated ? "true" : "false", info.createdAt,
+                                   info.fileBytes);
+    for (size_t i = 0; i < info.columns.size(); ++i) {
+        const auto& column = info.columns[i];
+        json += std::format(R"({}{{"name":"{}","type":"{}","nullCount":{})", i > 0 ? "," : "", JsonUtils::escapeString(column.info.name), JsonUtils::escapeString(column.info.type),
+                            column.nullCount);
+        if (column.min && column.max) {
+            json += std::format(R"(,"min":"{}","max":"{}")", JsonUtils::escapeString(*column.min), JsonUtils::escapeString(*column.max));
+        }
+        json += '}';
+    }
+    json += ']';
+    return json;
+}
+
+/// "YYYY-MM-DDTHH:MM" of a local wall-clock time
+std::string localTimeText(std::chrono::local_seconds time) {
+    const auto day = std::chrono::floor<std::chrono::days>(time);
+    const std::chrono::year_month_day date{day};
+    const std::chrono::hh_mm_ss clock{time - day};
+    return std::format("{:04}-{:02}-{:02}T{:02}:{:02}", static_cast<int>(date.year()), static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()), clock.hours().count(),
+                       clock.minutes().count());
+}
+
+/// "HH:MM" of minutes after midnight
+std::string minuteOfDayText(int minute) {
+    return std::format("{:02}:{:02}", minute / 60, minute % 60);
+}
+
+}  // namespace
+
+/// A broadcast and, once it has finished, the handle its merged result is held under
+struct QueryProvider::BroadcastJob {
+    std::unique_ptr<BroadcastQuery> query;
+    std::string resultHandle;  // guarded by m_broadcastsMutex
+};
+
+struct QueryProvider::FileSource {
+    std::unique_ptr<FileDatasource> source;
+    std::mutex viewMutex;
+    std::string viewKey;                                  // guarded by viewMutex
+    std::shared_ptr<const std::vector<size_t>> viewRows;  // guarded by viewMutex
+};
+
+QueryProvider::QueryProvider(IConnectionProvider& connections)
+    : m_connections(connections)
+    , m_resultCache(std::make_unique<ResultCache>())
+    , m_pagedSpill(std::make_unique<PagedResultSpill>(*m_resultCache))
+    , m_queryHistory(std::make_unique<QueryHistory>())
+    , m_binaryResults(std::make_unique<BinaryResultStore>())
+    , m_resultRegistry(std::make_unique<ResultRegistry>()) {}
+
+QueryProvider::~QueryProvider() {
+    // A run finishing now must not wake the scheduler while it is being destroyed
+    if (m_scheduledExecutor) {
+        m_scheduledExecutor->setStatusListener({});
+    }
+}
+
+std::string QueryProvider::handleExecuteQuery(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
         if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or sql");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto sqlQuery = std::string(sqlQueryResult.value());
+        // Lexed once: splitting, statement classification and cache table extraction below all read these tokens
+        const SqlTokenStream script(sqlQuery);
 
-        auto driver = m_connections.getQueryDriver(connectionId);
+        auto lane = m_connections.acquireLaneFor(connectionId, script);
+        const auto& driver = lane.driver();
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
+        // Raised by cancelQuery on this connection; fetch, serialization and filtering all stop on it
+        const auto* cancelRequested = lane.cancellation().flag();
 
-        auto statements = SQLParser::splitStatements(sqlQuery);
+        const auto statementTokens = SQLParser::splitStatementTokens(script);
+        std::vector<std::string> statements;
+        statements.reserve(statementTokens.size());
+        for (const auto& tokens : statementTokens) {
+            statements.emplace_back(tokens.source());
+        }
         log<LogLevel::INFO>(std::format("Split SQL into {} statements", statements.size()));
 
         // Multiple statements
@@ -50,57 +302,83 @@ std::string QueryProvider::handleExecuteQuery(std::string_view params) {
                 std::string statement;
                 ResultSet result;
             };
-            std::vector<StatementResult> allResults;
+            std::vector<StatementResult> allResults(statements.size());
 
-            size_t stmtIdx = 0;
-            try {
-                for (const auto& stmt : statements) {
-                    auto stmtStart = std::chrono::high_resolution_clock::now();
-                    ResultSet currentResult;
-                    if (SQLParser::isUseStatement(stmt)) {
-                        std::string dbName = SQLParser::extractDatabaseName(stmt);
-                        [[maybe_unused]] auto _ = driver->execute(stmt);
-                        currentResult.columns.push_back({.name = "Message", .type = "VARCHAR", .size = 255, .nullable = false, .isPrimaryKey = false});
-                        ResultRow messageRow;
-                        messageRow.values.push_back(std::format("Database changed to {}", dbName));
-                        currentResult.rows.push_back(messageRow);
-                        currentResult.affectedRows = 0;
-                    } else {
-                        currentResult = driver->execute(stmt);
+            // Opt-in: runs of independent reads fan out over the connection's lanes; results keep script order
+            bool parallel = false;
+            if (auto parallelOpt = params["parallel"].get_bool(); !parallelOpt.error()) {
+                parallel = parallelOpt.value();
+            }
+            // Opt-in: one round trip for the whole script when nothing in it needs a batch of its own
+            bool batch = false;
+            if (auto batchOpt = params["batch"].get_bool(); !batchOpt.error()) {
+                batch = batchOpt.value();
+            }
+            if (batch && !parallel && SQLParser::fitsSingleBatch(script)) {
+                return executeScriptBatch(connectionId, *driver, statementTokens);
+            }
+            auto runStatement = [&](size_t index, bool concurrent) {
+                const auto& stmt = statements[index];
+                const auto& tokens = statementTokens[index];
+                auto stmtStart = std::chrono::high_resolution_clock::now();
+                ResultSet currentResult;
+                if (concurrent) {
+                    auto readLane = m_connections.acquireQueryLane(connectionId, true);
+                    if (!readLane) [[unlikely]] {
+                        throw std::runtime_error(std::format("Connection not found: {}", connectionId));
                     }
-                    auto stmtEnd = std::chrono::high_resolution_clock::now();
-                    currentResult.executionTimeMs = std::chrono::duration<double, std::milli>(stmtEnd - stmtStart).count();
-                    allResults.push_back({.statement = stmt, .result = std::move(currentResult)});
-                    ++stmtIdx;
+                    currentResult = readLane.driver()->execute(stmt, ExecuteOptions{.cancelRequested = readLane.cancellation().flag()});
+                } else if (SQLParser::isUseStatement(tokens)) {
+                    std::string dbName = SQLParser::extractDatabaseName(tokens);
+                    [[maybe_unused]] auto _ = driver->execute(stmt);
+                    m_connections.noteDatabaseChange(connectionId, dbName);
+                    currentResult.columns.push_back({.name = "Message", .type = "VARCHAR", .size = 255, .nullable = false, .isPrimaryKey = false});
+                    currentResult.appendRow({std::format("Database changed to {}", dbName)});
+                    currentResult.affectedRows = 0;
+                } else {
+                    currentResult = driver->execute(stmt, ExecuteOptions{.cancelRequested = cancelRequested});
+                    invalidateCachedResults(connectionId, tokens);
+                    trackTransactionState(connectionId, *driver, tokens);
                 }
+                auto stmtEnd = std::chrono::high_resolution_clock::now();
+                currentResult.executionTimeMs = std::chrono::duration<double, std::milli>(stmtEnd - stmtStart).count();
+                allResults[index] = {.statement = stmt, .result = std::move(currentResult)};
+            };
+
+            size_t stmtIdx = 0;
+            try {
+                runStatementWaves(statements, parallel ? MAX_PARALLEL_STATEMENTS : 1, runStatement, stmtIdx);
 
                 std::string jsonResponse = R"({"multipleResults":true,"results":[)";
                 for (size_t i = 0; i < allResults.size(); ++i) {
                     if (i > 0)
                         jsonResponse += ",";
                     jsonResponse += R"({"statement":")";
-                    jsonResponse += JsonUtils::escapeString(allResults[i].statement);
+                    JsonUtils::appendEscaped(jsonResponse, allResults[i].statement);
                     jsonResponse += R"(","data":)";
-                    jsonResponse += JsonUtils::serializeResultSet(allResults[i].result, false);
+                    jsonResponse += JsonUtils::serializeResultSet(allResults[i].result, false, cancelRequested);
                     jsonResponse += "}";
                 }
                 jsonResponse += "]}";
                 return JsonUtils::successResponse(jsonResponse);
             } catch (const std::exception& e) {
+                // The failing statement may have partially applied before the error
+                if (stmtIdx < statements.size()) {
+                    invalidateCachedResults(connectionId, statementTokens[stmtIdx]);
+                }
                 return JsonUtils::errorResponse(std::format("Statement {} of {}: {}", stmtIdx + 1, statements.size(), e.what()));
             }
         }
 
         // Single USE statement
-        if (SQLParser::isUseStatement(sqlQuery)) {
-            std::string dbName = SQLParser::extractDatabaseName(sqlQuery);
+        if (SQLParser::isUseStatement(script)) {
+            std::string dbName = SQLParser::extractDatabaseName(script);
             try {
                 [[maybe_unused]] auto _ = driver->execute(sqlQuery);
+                m_connections.noteDatabaseChange(connectionId, dbName);
                 ResultSet useResult;
                 useResult.columns.push_back({.name = "Message", .type = "VARCHAR", .size = 255, .nullable = false, .isPrimaryKey = false});
-                ResultRow messageRow;
-                messageRow.values.push_back(std::format("Database changed to {}", dbName));
-                useResult.rows.push_back(messageRow);
+                useResult.appendRow({std::format("Database changed to {}", dbName)});
                 useResult.affectedRows = 0;
                 useResult.executionTimeMs = 0.0;
                 return JsonUtils::successResponse(JsonUtils::serializeResultSet(useResult, false));
@@ -111,28 +389,159 @@ std::string QueryProvider::handleExecuteQuery(std::string_view params) {
 
         // Cache check
         bool useCache = true;
-        if (auto useCacheOpt = doc["useCache"].get_bool(); !useCacheOpt.error()) {
+        if (auto useCacheOpt = params["useCache"].get_bool(); !useCacheOpt.error()) {
             useCache = useCacheOpt.value();
         }
-        std::string cacheKey;
-        cacheKey.reserve(connectionId.size() + 1 + sqlQuery.size());
-        cacheKey.append(connectionId);
-        cacheKey.push_back('\0');
-        cacheKey.append(sqlQuery);
-        bool selectQuery = SQLParser::isReadOnlyQuery(sqlQuery);
+        bool selectQuery = SQLParser::isReadOnlyQuery(script);
+        // Opt-in row limit for read-only queries: the fetch stops there and the response reports `truncated`
+        ExecuteOptions executeOptions{.cancelRequested = cancelRequested};
+        if (auto maxRowsOpt = params["maxRows"].get_uint64(); !maxRowsOpt.error() && selectQuery) {
+            executeOptions.maxRows = static_cast<size_t>(maxRowsOpt.value());
+        }
+        // Opt-in: hold the result under a handle so the grid sorts, filters, pages and exports it without re-running the query
+        bool keepResult = false;
+        if (auto keepOpt = params["keepResult"].get_bool(); !keepOpt.error()) {
+            keepResult = keepOpt.value() && selectQuery;
+        }
+        // Opt-in delta refresh of a held result: given the previous run's handle, answer with the rows that changed
+        // (matched on "keyColumns", or on whole rows) and release the previous result
+        std::string refreshOf;
+        std::vector<std::string> refreshKeys;
+        if (auto refreshOpt = params["refreshOf"].get_string(); !refreshOpt.error() && keepResult) {
+            refreshOf = std::string(refreshOpt.value());
+            if (auto keys = params["keyColumns"].get_array(); !keys.error()) {
+                for (auto key : keys.value()) {
+                    auto name = key.get_string();
+                    if (name.error()) [[unlikely]] {
+                        return JsonUtils::errorResponse("keyColumns must list column names");
+                    }
+                    refreshKeys.emplace_back(name.value());
+                }
+            }
+        }
+        // A held result can fetch full LOB values later (getCellValue), so by default it only reads their start
+        if (keepResult) {
+            executeOptions.lobPreviewBytes = SQLServerDriver::DEFAULT_LOB_PREVIEW_BYTES;
+        }
+        if (auto previewOpt = params["lobPreviewBytes"].get_uint64(); !previewOpt.error() && selectQuery) {
+            executeOptions.lobPreviewBytes = static_cast<size_t>(previewOpt.value());
+        }
+        // A limited or previewed result is cached apart from the full one
+        std::string keyVariant;
+        if (executeOptions.maxRows > 0) {
+            keyVariant += std::format("maxRows={};", executeOptions.maxRows);
+        }
+        if (executeOptions.lobPreviewBytes > 0) {
+            keyVariant += std::format("lobPreviewBytes={};", executeOptions.lobPreviewBytes);
+        }
+        auto cacheKey = ResultCache::makeKey(connectionId, sqlQuery, keyVariant);
+        bool binaryFormat = false;
+        if (auto formatOpt = params["format"].get_string(); !formatOpt.error()) {
+            binaryFormat = formatOpt.value() == "binary"sv;
+        }
+        auto serialize = [&](const std::shared_ptr<const ResultSet>& result, bool cached) {
+            std::optional<std::string> delta;
+            if (!refreshOf.empty() && !binaryFormat) {
+                delta = serializeDelta(refreshOf, refreshKeys, *result, cached);
+            }
+            auto json = delta ? std::move(*delta) : binaryFormat ? publishBinaryResult(*result, cached) : JsonUtils::serializeResultSet(*result, cached, cancelRequested);
+            if (keepResult) {
+                // Full LOB values are re-read by primary key, which needs the query to read a single table
+                std::string sourceTable;
+                if (!result->lobPreviews.empty()) {
+                    if (auto tables = SQLParser::extractTableReferences(script); tables.size() == 1) {
+                        sourceTable = std::move(tables.front());
+                    }
+                }
+                if (auto handle = m_resultRegistry->put(connectionId, result, std::move(sourceTable)); !handle.empty()) {
+                    json.pop_back();
+                    json += std::format(R"(,"resultHandle":"{}"}})", handle);
+                    if (!refreshOf.empty() && refreshOf != handle) {
+                        (void)m_resultRegistry->release(refreshOf);
+                    }
+                }
+            }
+            return json;
+        };
+        // Opt-in second tier for heavy queries worth keeping across restarts
+        bool persistCache = false;
+        if (auto persistOpt = params["persistCache"].get_bool(); !persistOpt.error()) {
+            persistCache = persistOpt.value();
+        }
+        // Opt-in server-side freshness check: costs one probe round trip per hit
+        bool validateCache = false;
+        if (auto validateOpt = params["validateCache"].get_bool(); !validateOpt.error()) {
+            validateCache = validateOpt.value();
+        }
+        ResultCache::EntryOptions entryOptions;
+        if (auto ttlOpt = params["cacheTtlSeconds"].get_int64(); !ttlOpt.error() && ttlOpt.value() > 0) {
+            entryOptions.ttl = std::chrono::seconds(ttlOpt.value());
+        }
+        std::string diskKey;
+
         if (useCache && selectQuery) {
-            if (auto cachedResult = m_resultCache->get(cacheKey); cachedResult.has_value()) {
-                return JsonUtils::successResponse(JsonUtils::serializeResultSet(*cachedResult, true));
+            entryOptions.tables = SQLParser::extractTableReferences(script);
+            ResultCache::FreshnessProbe probe;
+            if (validateCache) {
+                probe = [&](std::span<const std::string> tables) { return probeFreshness(*driver, tables); };
+            }
+            TraceScope lookupSpan("cache.lookup");
+            auto cached = m_resultCache->lookup(cacheKey, probe);
+            lookupSpan.setDetail(cached ? "hit" : "miss");
+            lookupSpan.end();
+            static auto& resultHits = MetricsRegistry::instance().counter("cache.result.hits");
+            static auto& resultMisses = MetricsRegistry::instance().counter("cache.result.misses");
+            (cached ? resultHits : resultMisses).add();
+            // JSON hits replay the response serialized on the first hit; binary hits re-encode into the one-shot store.
+            // A held result gets a handle of its own, so its response is never replayed.
+            if (cached) {
+                const bool replayable = !binaryFormat && !keepResult;
+                if (replayable && cached.response) {
+                    return *cached.response;
+                }
+                auto response = std::make_shared<const std::string>(JsonUtils::successResponse(serialize(cached.result, true)));
+                if (replayable) {
+                    m_resultCache->putResponse(cacheKey, response);
+                }
+                return *response;
+            }
+            // Taken before the query runs: a write landing in between then fails the next validation instead of going unnoticed
+            if (validateCache) {
+                entryOptions.freshnessToken = probeFreshness(*driver, entryOptions.tables).value_or(std::string{});
+            }
+            if (persistCache) {
+                diskKey = diskCacheKey(connectionId, *driver, sqlQuery, keyVariant);
+            }
+            if (!diskKey.empty()) {
+                TraceScope diskSpan("cache.disk");
+                auto persisted = diskCache().get(diskKey);
+                diskSpan.setDetail(persisted ? "hit" : "miss");
+                diskSpan.end();
+                static auto& diskHits = MetricsRegistry::instance().counter("cache.disk.hits");
+                static auto& diskMisses = MetricsRegistry::instance().counter("cache.disk.misses");
+                (persisted ? diskHits : diskMisses).add();
+                if (persisted) {
+                    m_resultCache->put(cacheKey, persisted, std::move(entryOptions));
+                    return JsonUtils::successResponse(serialize(persisted, true));
+                }
             }
         }
 
-        auto queryResult = driver->execute(sqlQuery);
+        auto sharedResult = std::make_shared<const ResultSet>(driver->execute(sqlQuery, executeOptions));
+        const auto& queryResult = *sharedResult;
 
         if (useCache && selectQuery) {
-            m_resultCache->put(cacheKey, queryResult);
+            // The disk format does not carry LOB previews, so a previewed result stays in memory only
+            if (!diskKey.empty() && queryResult.lobPreviews.empty() && !diskCache().put(diskKey, queryResult, entryOptions.tables)) {
+                log<LogLevel::WARNING>("Failed to persist query result to the disk cache"sv);
+            }
+            m_resultCache->put(cacheKey, sharedResult, std::move(entryOptions));
+        } else if (!selectQuery) {
+            invalidateCachedResults(connectionId, script);
+            trackTransactionState(connectionId, *driver, script);
         }
 
-        std::string jsonResponse = JsonUtils::serializeResultSet(queryResult, false);
+        std::string jsonResponse = serialize(sharedResult, false);
 
         HistoryItem historyEntry{.id = std::format("hist_{}", std::chrono::system_clock::now().time_since_epoch().count()),
                                  .sql = sqlQuery,
@@ -140,21 +549,18 @@ std::string QueryProvider::handleExecuteQuery(std::string_view params) {
                                  .success = true,
                                  .affectedRows = static_cast<int64_t>(queryResult.affectedRows),
                                  .isFavorite = false};
-        m_queryHistory->add(historyEntry);
+        queryHistory().add(historyEntry);
 
         return JsonUtils::successResponse(jsonResponse);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string QueryProvider::handleExecuteQueryPaginated(std::string_view params) {
+std::string QueryProvider::handleExecuteQueryPaginated(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
         if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or sql");
         }
@@ -163,13 +569,13 @@ std::string QueryProvider::handleExecuteQueryPaginated(std::string_view params)
 
         int64_t startRow = 0;
         int64_t endRow = 100;
-        if (auto startRowOpt = doc["startRow"].get_int64(); !startRowOpt.error())
+        if (auto startRowOpt = params["startRow"].get_int64(); !startRowOpt.error())
             startRow = startRowOpt.value();
-        if (auto endRowOpt = doc["endRow"].get_int64(); !endRowOpt.error())
+        if (auto endRowOpt = params["endRow"].get_int64(); !endRowOpt.error())
             endRow = endRowOpt.value();
 
         std::string orderByClause;
-        if (auto sortModel = doc["sortModel"].get_array(); !sortModel.error()) {
+        if (auto sortModel = params["sortModel"].get_array(); !sortModel.error()) {
             std::string sortClauses;
             for (auto item : sortModel.value()) {
                 auto colId = item["colId"].get_string();
@@ -184,11 +590,47 @@ std::string QueryProvider::handleExecuteQueryPaginated(std::string_view params)
                 orderByClause = " ORDER BY " + sortClauses;
         }
 
-        auto driver = m_connections.getQueryDriver(connectionId);
+        auto lane = m_connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+        const auto& driver = lane.driver();
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
 
+        // Too large to materialize: a plan estimate stands in for the COUNT_BIG pass, which would run the query a second time
+        auto includeRowCount = params["includeRowCount"].get_bool();
+        const bool wantsRowCount = !includeRowCount.error() && includeRowCount.value();
+        std::optional<int64_t> estimatedRows;
+
+        // Read-only results are materialized once and paged locally, so page N costs the same as page 1
+        if (SQLParser::isReadOnlyQuery(sqlQuery) && startRow >= 0 && endRow >= startRow) {
+            auto spill = m_pagedSpill->fetch(connectionId, *driver, sqlQuery + orderByClause);
+            estimatedRows = spill.estimatedRows;
+            // A result that outgrew the spill still serves the pages it fetched before stopping, without running again
+            const auto fetched = spill.rows ? static_cast<int64_t>(spill.rows->rowCount()) : 0;
+            if (spill.rows && (spill.complete || endRow <= fetched)) {
+                ResultSet page;
+                page.columns = spill.rows->columns;
+                page.executionTimeMs = spill.rows->executionTimeMs;
+                for (auto row = (std::min)(startRow, fetched); row < (std::min)(endRow, fetched); ++row) {
+                    page.appendRowFrom(*spill.rows, static_cast<size_t>(row));
+                }
+                auto json = JsonUtils::serializeResultSet(page, false);
+                json.pop_back();
+                if (spill.complete) {
+                    json += std::format(R"(,"totalRows":{}}})", fetched);
+                } else if (wantsRowCount && estimatedRows) {
+                    json += std::format(R"(,"estimatedTotalRows":{}}})", (std::max)(*estimatedRows, fetched));
+                } else {
+                    json += '}';
+                }
+                return JsonUtils::successResponse(json);
+            }
+        }
+
+        if (wantsRowCount && !estimatedRows) {
+            estimatedRows = estimateRowCount(*driver, sqlQuery);
+        }
+
         std::string paginatedQuery;
         if (orderByClause.empty()) {
             paginatedQuery = std::format("{} ORDER BY (SELECT NULL) OFFSET {} ROWS FETCH NEXT {} ROWS ONLY", sqlQuery, startRow, endRow - startRow);
@@ -197,140 +639,1812 @@ std::string QueryProvider::handleExecuteQueryPaginated(std::string_view params)
         }
 
         auto queryResult = driver->execute(paginatedQuery);
-        return JsonUtils::successResponse(JsonUtils::serializeResultSet(queryResult, false));
+        auto json = JsonUtils::serializeResultSet(queryResult, false);
+        if (estimatedRows) {
+            json.pop_back();
+            json += std::format(R"(,"estimatedTotalRows":{}}})", *estimatedRows);
+        }
+        return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string QueryProvider::handleGetRowCount(std::string_view params) {
+std::string QueryProvider::handleGetRowCount(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
         if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or sql");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto sqlQuery = std::string(sqlQueryResult.value());
 
-        auto driver = m_connections.getQueryDriver(connectionId);
+        auto lane = m_connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+        const auto& driver = lane.driver();
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
 
+        // A result already materialized for paging (or cached by executeQuery) knows its size
+        if (auto cached = m_resultCache->get(ResultCache::makeKey(connectionId, sqlQuery))) {
+            return JsonUtils::successResponse(std::format("{{\"rowCount\":{}}}", cached->rowCount()));
+        }
+
         auto countQuery = std::format("SELECT COUNT_BIG(*) AS total_rows FROM ({}) AS subquery WITH(NOLOCK)", sqlQuery);
         auto queryResult = driver->execute(countQuery);
 
-        if (queryResult.rows.empty() || queryResult.rows[0].values.empty()) {
+        if (queryResult.empty() || queryResult.columnData.empty()) {
             return JsonUtils::errorResponse("Failed to get row count");
         }
 
-        auto rowCount = queryResult.rows[0].values[0];
+        auto rowCount = queryResult.cellText(0, 0);
         return JsonUtils::successResponse(std::format("{{\"rowCount\":{}}}", rowCount));
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string QueryProvider::handleCancelQuery(std::string_view params) {
+std::string QueryProvider::handleCancelQuery(const IPCParams& params) {
     auto connectionIdResult = extractConnectionId(params);
     if (!connectionIdResult) {
         return JsonUtils::errorResponse(connectionIdResult.error());
     }
-    if (auto driver = m_connections.getQueryDriver(*connectionIdResult)) {
-        driver->cancel();
-    }
+    m_connections.cancelQueries(*connectionIdResult);
     return JsonUtils::successResponse("{}");
 }
 
-std::string QueryProvider::handleFilterResultSet(std::string_view params) {
+std::string QueryProvider::handleFilterResultSet(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
-        auto columnIndexResult = doc["columnIndex"].get_uint64();
-        auto filterTypeResult = doc["filterType"].get_string();
-        auto filterValueResult = doc["filterValue"].get_string();
-        if (connectionIdResult.error() || sqlQueryResult.error() || columnIndexResult.error() || filterTypeResult.error() || filterValueResult.error()) [[unlikely]] {
-            return JsonUtils::errorResponse("Missing required fields: connectionId, sql, columnIndex, filterType, or filterValue");
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
+        if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId or sql");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto sqlQuery = std::string(sqlQueryResult.value());
-        auto columnIndex = columnIndexResult.value();
-        auto filterType = std::string(filterTypeResult.value());
-        auto filterValue = std::string(filterValueResult.value());
+        auto expression = FilterExpression::fromRequest(params);
+        if (!expression) [[unlikely]] {
+            return JsonUtils::errorResponse(expression.error());
+        }
 
-        auto driver = m_connections.getQueryDriver(connectionId);
+        auto lane = m_connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+        const auto& driver = lane.driver();
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
+        const auto* cancelRequested = lane.cancellation().flag();
+
+        std::string matchedRows;
+        size_t filteredRows = 0;
+        auto appendMatches = [&](const ResultSet& rows) {
+            for (size_t index : expression->evaluate(rows, cancelRequested)) {
+                if (filteredRows++ > 0)
+                    matchedRows += ',';
+                JsonUtils::appendRow(matchedRows, rows, index);
+            }
+        };
 
-        auto queryResult = driver->execute(sqlQuery);
-
-        SIMDFilter simdFilter;
-        std::vector<size_t> matchingIndices;
-        if (filterType == "equals") {
-            matchingIndices = simdFilter.filterEquals(queryResult, columnIndex, filterValue);
-        } else if (filterType == "contains") {
-            matchingIndices = simdFilter.filterContains(queryResult, columnIndex, filterValue);
-        } else if (filterType == "range") {
-            std::string minValue = filterValue;
-            std::string maxValue;
-            if (auto maxVal = doc["filterValueMax"].get_string(); !maxVal.error())
-                maxValue = std::string(maxVal.value());
-            matchingIndices = simdFilter.filterRange(queryResult, columnIndex, minValue, maxValue);
+        // (connectionId, sql) is the result handle: the grid's result is filtered where it is already held, so
+        // editing a filter never re-runs the query. Only results too large to keep are streamed through again.
+        std::vector<ColumnInfo> columns;
+        size_t totalRows = 0;
+        auto held = SQLParser::isReadOnlyQuery(sqlQuery) ? spilledResult(connectionId, *driver, sqlQuery) : nullptr;
+        if (held) {
+            appendMatches(*held);
+            columns = held->columns;
+            totalRows = held->rowCount();
         } else {
-            return JsonUtils::errorResponse(std::format("Unknown filter type: {}", filterType));
+            // Filter batch by batch and serialize matches immediately, so only the matching rows are ever held
+            CallbackBatchSink sink([&](const ResultSet& batch) {
+                appendMatches(batch);
+                return !isCancelRequested(cancelRequested);
+            });
+            auto summary = driver->executeStreaming(sqlQuery, sink);
+            throwIfCancelled(cancelRequested);
+            columns = std::move(summary.columns);
+            totalRows = summary.totalRows;
         }
 
         std::string jsonResponse = "{";
-        JsonUtils::appendColumns(jsonResponse, queryResult.columns);
+        JsonUtils::appendColumns(jsonResponse, columns);
         jsonResponse += R"(,"rows":[)";
-        for (size_t i = 0; i < matchingIndices.size(); ++i) {
-            if (i > 0)
-                jsonResponse += ',';
-            jsonResponse += '[';
-            const auto& row = queryResult.rows[matchingIndices[i]];
-            for (size_t colIndex = 0; colIndex < row.values.size(); ++colIndex) {
-                if (colIndex > 0)
-                    jsonResponse += ',';
-                jsonResponse += std::format(R"("{}")", JsonUtils::escapeString(row.values[colIndex]));
-            }
-            jsonResponse += ']';
-        }
+        jsonResponse += matchedRows;
         jsonResponse += "],";
-        jsonResponse += std::format(R"("totalRows":{},"filteredRows":{},"simdAvailable":{}}})", queryResult.rows.size(), matchingIndices.size(), SIMDFilter::isAVX2Available() ? "true" : "false");
+        jsonResponse += std::format(R"("totalRows":{},"filteredRows":{},"cached":{},"simdAvailable":{},"simdLevel":"{}"}})", totalRows, filteredRows, held ? "true" : "false",
+                                    SIMDFilter::isAVX2Available() ? "true" : "false", SIMDFilter::levelName(SIMDFilter::activeLevel()));
         return JsonUtils::successResponse(jsonResponse);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::string QueryProvider::handleAggregateResultSet(const IPCParams& params) {
+    try {
+        auto aggregatesResult = params["aggregates"].get_array();
+        if (aggregatesResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: aggregates");
+        }
+
+        AggregateRequest request;
+        if (auto groupBy = params["groupBy"].get_array(); !groupBy.error()) {
+            for (auto column : groupBy.value()) {
+                auto index = column.get_uint64();
+                if (index.error()) [[unlikely]] {
+                    return JsonUtils::errorResponse("groupBy must list column indices");
+                }
+                request.groupBy.push_back(index.value());
+            }
+        }
+        for (auto item : aggregatesResult.value()) {
+            auto functionName = item["function"].get_string();
+            auto function = functionName.error() ? std::nullopt : ResultAggregator::parseFunction(functionName.value());
+            if (!function) [[unlikely]] {
+                return JsonUtils::errorResponse("Each aggregate needs a function: count, sum, min, max, avg, or countDistinct");
+            }
+            auto column = item["column"].get_uint64();
+            request.aggregates.push_back(AggregateSpec{.function = *function, .column = column.error() ? AggregateSpec::ALL_ROWS : column.value()});
+        }
+        std::optional<FilterExpression> filter;
+        if (auto filterParam = params["filter"]; !filterParam.error()) {
+            auto parsed = FilterExpression::parse(filterParam.value());
+            if (!parsed) [[unlikely]] {
+                return JsonUtils::errorResponse(parsed.error());
+            }
+            filter = std::move(*parsed);
+        }
+        auto respond = [](const ResultSet& groups, bool cached, size_t totalRows) {
+            auto json = JsonUtils::serializeResultSet(groups, cached);
+            json.pop_back();
+            json += std::format(R"(,"totalRows":{},"groupCount":{}}})", totalRows, groups.rowCount());
+            return JsonUtils::successResponse(json);
+        };
+
+        // A file datasource is scanned batch by batch on every core, never held whole
+        if (auto handle = params["resultHandle"].get_string(); !handle.error()) {
+            auto file = findFileSource(params);
+            if (!file) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Result not found or expired: {}", handle.value()));
+            }
+            ResultAggregator aggregator(file->source->columns(), request);
+            file->source->scan([&](const ResultSet& batch, size_t) {
+                if (filter) {
+                    const auto selection = filter->evaluate(batch);
+                    aggregator.add(batch, &selection);
+                } else {
+                    aggregator.add(batch);
+                }
+                return true;
+            });
+            return respond(aggregator.finish(), false, file->source->rowCount());
+        }
+
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
+        if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId and sql, or resultHandle");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        auto sqlQuery = std::string(sqlQueryResult.value());
+
+        auto lane = m_connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+        const auto& driver = lane.driver();
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        // Like filtering, aggregation reads the held result; only results too large to keep are streamed again
+        std::unique_ptr<ResultAggregator> aggregator;
+        auto addRows = [&](const ResultSet& rows) {
+            if (filter) {
+                const auto selection = filter->evaluate(rows);
+                aggregator->add(rows, &selection);
+            } else {
+                aggregator->add(rows);
+            }
+        };
+        size_t totalRows = 0;
+        auto held = SQLParser::isReadOnlyQuery(sqlQuery) ? spilledResult(connectionId, *driver, sqlQuery) : nullptr;
+        if (held) {
+            aggregator = std::make_unique<ResultAggregator>(held->columns, request);
+            addRows(*held);
+            totalRows = held->rowCount();
+        } else {
+            struct AggregateSink final : RowBatchSink {
+                std::function<void(const std::vector<ColumnInfo>&)> columns;
+                std::function<void(const ResultSet&)> rows;
+                void onColumns(const std::vector<ColumnInfo>& info) override { columns(info); }
+                [[nodiscard]] bool onBatch(const ResultSet& batch) override {
+                    rows(batch);
+                    return true;
+                }
+            } sink;
+            sink.columns = [&](const std::vector<ColumnInfo>& info) { aggregator = std::make_unique<ResultAggregator>(info, request); };
+            sink.rows = addRows;
+            totalRows = driver->executeStreaming(sqlQuery, sink, ResultAggregator::PARALLEL_MIN_ROWS).totalRows;
+            if (!aggregator) [[unlikely]] {
+                return JsonUtils::errorResponse("Query returned no result set to aggregate");
+            }
+        }
+
+        return respond(aggregator->finish(), held != nullptr, totalRows);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::expected<HeldResult, std::string> QueryProvider::heldResult(const IPCParams& params) {
+    auto handleResult = params["resultHandle"].get_string();
+    if (handleResult.error()) [[unlikely]] {
+        return std::unexpected("Missing required field: resultHandle"s);
+    }
+
+    // The grid's view: its first sorted column, then its filter. Both go into the key of the remembered row order.
+    std::string sortColumn;
+    bool ascending = true;
+    if (auto sortModel = params["sortModel"].get_array(); !sortModel.error()) {
+        for (auto item : sortModel.value()) {
+            auto colId = item["colId"].get_string();
+            auto sort = item["sort"].get_string();
+            if (!colId.error() && !sort.error()) {
+                sortColumn = std::string(colId.value());
+                ascending = sort.value() != "desc"sv;
+                break;
+            }
+        }
+    }
+    std::optional<FilterExpression> filter;
+    std::string filterJson;
+    if (auto filterParam = params["filter"]; !filterParam.error()) {
+        auto parsed = FilterExpression::parse(filterParam.value());
+        if (!parsed) [[unlikely]] {
+            return std::unexpected(parsed.error());
+        }
+        filter = std::move(*parsed);
+        filterJson = simdjson::minify(filterParam.value());
+    }
+    std::string viewKey;
+    if (!sortColumn.empty() || filter) {
+        viewKey = std::format("{}:{}|{}", sortColumn, ascending ? "asc" : "desc", filterJson);
+    }
+
+    // The sort permutation and the filter selection are cached apart, so toggling either one back merges two cached
+    // row lists in O(n) rather than sorting or filtering again
+    const std::string_view handle = handleResult.value();
+    auto held = m_resultRegistry->view(handle, viewKey, [&](const ResultSet& result) {
+        auto derive = [&](const std::string& key, const std::function<std::vector<size_t>(const ResultSet&)>& compute) {
+            auto rows = m_resultRegistry->derivedRows(handle, key, compute);
+            return rows ? rows : std::make_shared<const std::vector<size_t>>(compute(result));  // Released meanwhile
+        };
+        std::shared_ptr<const std::vector<size_t>> sorted;
+        if (!sortColumn.empty()) {
+            auto column = std::ranges::find(result.columns, sortColumn, &ColumnInfo::name);
+            if (column == result.columns.end()) [[unlikely]] {
+                throw std::invalid_argument(std::format("Unknown sort column: {}", sortColumn));
+            }
+            const auto columnIndex = static_cast<size_t>(column - result.columns.begin());
+            sorted = derive(std::format("sort:{}:{}", columnIndex, ascending ? "asc" : "desc"), [&](const ResultSet& rows) { return SIMDFilter{}.sortByColumn(rows, columnIndex, ascending); });
+        }
+        std::shared_ptr<const std::vector<size_t>> matches;
+        if (filter) {
+            matches = derive(std::format("filter:{}", filterJson), [&](const ResultSet& rows) { return filter->evaluate(rows); });
+        }
+        if (!matches || !sorted) {
+            return matches ? *matches : *sorted;
+        }
+        std::vector<bool> keep(result.rowCount());
+        for (size_t row : *matches) {
+            keep[row] = true;
+        }
+        std::vector<size_t> rows;
+        rows.reserve(matches->size());
+        for (size_t row : *sorted) {
+            if (keep[row]) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    });
+    if (!held.result) [[unlikely]] {
+        return std::unexpected(std::format("Result not found or expired: {}", handleResult.value()));
+    }
+    return held;
+}
+
+std::optional<HeldOrigin> QueryProvider::heldOrigin(std::string_view handle) const {
+    return m_resultRegistry->origin(handle);
+}
+
+bool QueryProvider::patchHeldResult(std::string_view handle, std::span<const RowPatch> patches) {
+    return m_resultRegistry->patch(handle, patches);
+}
+
+std::string QueryProvider::handleGetResultWindow(const IPCParams& params) {
+    try {
+        uint64_t startRow = 0;
+        uint64_t endRow = 100;
+        if (auto startRowOpt = params["startRow"].get_uint64(); !startRowOpt.error()) {
+            startRow = startRowOpt.value();
+        }
+        if (auto endRowOpt = params["endRow"].get_uint64(); !endRowOpt.error()) {
+            endRow = endRowOpt.value();
+        }
+
+        if (auto file = findFileSource(params)) {
+            auto view = fileSourceView(*file, params);
+            if (!view) [[unlikely]] {
+                return JsonUtils::errorResponse(view.error());
+            }
+            const size_t size = *view ? (*view)->size() : file->source->rowCount();
+            const size_t begin = (std::min)(static_cast<size_t>(startRow), size);
+            const size_t end = (std::max)(begin, (std::min)(static_cast<size_t>(endRow), size));
+            return JsonUtils::successResponse(serializeFileWindow(*file->source, view->get(), begin, end - begin, {}, "startRow"));
+        }
+        auto held = heldResult(params);
+        if (!held) [[unlikely]] {
+            return JsonUtils::errorResponse(held.error());
+        }
+        const size_t begin = (std::min)(static_cast<size_t>(startRow), held->size());
+        const size_t end = (std::max)(begin, (std::min)(static_cast<size_t>(endRow), held->size()));
+        return JsonUtils::successResponse(serializeWindow(*held, begin, end - begin, {}, "startRow"));
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string QueryProvider::handleGetCacheStats(std::string_view) {
-    auto currentSize = m_resultCache->getCurrentSize();
-    auto maxSize = m_resultCache->getMaxSize();
-    std::string jsonResponse = std::format(R"({{"currentSizeBytes":{},"maxSizeBytes":{},"usagePercent":{:.1f}}})", currentSize, maxSize,
-                                           maxSize > 0 ? (static_cast<double>(currentSize) / static_cast<double>(maxSize)) * 100.0 : 0.0);
-    return JsonUtils::successResponse(jsonResponse);
+std::string QueryProvider::handleGetRows(const IPCParams& params) {
+    try {
+        uint64_t start = 0;
+        uint64_t count = DEFAULT_ROW_WINDOW;
+        if (auto startOpt = params["start"].get_uint64(); !startOpt.error()) {
+            start = startOpt.value();
+        }
+        if (auto countOpt = params["count"].get_uint64(); !countOpt.error()) {
+            count = (std::min)(countOpt.value(), uint64_t{MAX_ROW_WINDOW});
+        }
+        std::vector<size_t> columns;
+        if (auto columnsOpt = params["columns"].get_array(); !columnsOpt.error()) {
+            for (auto column : columnsOpt.value()) {
+                auto index = column.get_uint64();
+                if (index.error()) [[unlikely]] {
+                    return JsonUtils::errorResponse("columns must list column indices of the result");
+                }
+                columns.push_back(index.value());
+            }
+        }
+        auto columnsInRange = [&](size_t columnCount) { return std::ranges::all_of(columns, [&](size_t column) { return column < columnCount; }); };
+
+        if (auto file = findFileSource(params)) {
+            auto view = fileSourceView(*file, params);
+            if (!view) [[unlikely]] {
+                return JsonUtils::errorResponse(view.error());
+            }
+            if (!columnsInRange(file->source->columns().size())) [[unlikely]] {
+                return JsonUtils::errorResponse("columns must list column indices of the result");
+            }
+            const size_t size = *view ? (*view)->size() : file->source->rowCount();
+            const size_t begin = (std::min)(static_cast<size_t>(start), size);
+            const size_t rows = (std::min)(static_cast<size_t>(count), size - begin);
+            return JsonUtils::successResponse(serializeFileWindow(*file->source, view->get(), begin, rows, columns, "start"));
+        }
+        auto held = heldResult(params);
+        if (!held) [[unlikely]] {
+            return JsonUtils::errorResponse(held.error());
+        }
+        if (!columnsInRange(held->result->columns.size())) [[unlikely]] {
+            return JsonUtils::errorResponse("columns must list column indices of the result");
+        }
+
+        const size_t begin = (std::min)(static_cast<size_t>(start), held->size());
+        const size_t rows = (std::min)(static_cast<size_t>(count), held->size() - begin);
+        return JsonUtils::successResponse(serializeWindow(*held, begin, rows, columns, "start"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
 }
 
-std::string QueryProvider::handleClearCache(std::string_view) {
-    m_resultCache->clear();
-    return JsonUtils::successResponse(R"({"cleared":true})");
+std::string QueryProvider::handleGetCellValue(const IPCParams& params) {
+    try {
+        auto rowOpt = params["row"].get_uint64();
+        auto columnOpt = params["column"].get_uint64();
+        if (rowOpt.error() || columnOpt.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: row or column");
+        }
+        if (auto file = findFileSource(params)) {
+            auto view = fileSourceView(*file, params);
+            if (!view) [[unlikely]] {
+                return JsonUtils::errorResponse(view.error());
+            }
+            const size_t size = *view ? (*view)->size() : file->source->rowCount();
+            if (rowOpt.value() >= size || columnOpt.value() >= file->source->columns().size()) [[unlikely]] {
+                return JsonUtils::errorResponse("row or column is out of range");
+            }
+            const size_t row = *view ? (**view)[rowOpt.value()] : static_cast<size_t>(rowOpt.value());
+            const auto column = static_cast<size_t>(columnOpt.value());
+            auto cell = file->source->rowsAt(std::span(&row, 1));
+            if (cell.isNull(0, column)) {
+                return JsonUtils::successResponse(R"({"value":null})");
+            }
+            return JsonUtils::successResponse(std::format(R"({{"value":"{}"}})", JsonUtils::escapeString(cell.cellText(0, column))));
+        }
+        auto held = heldResult(params);
+        if (!held) [[unlikely]] {
+            return JsonUtils::errorResponse(held.error());
+        }
+        const auto& result = *held->result;
+        if (rowOpt.value() >= held->size() || columnOpt.value() >= result.columns.size()) [[unlikely]] {
+            return JsonUtils::errorResponse("row or column is out of range");
+        }
+        const size_t row = held->rowAt(static_cast<size_t>(rowOpt.value()));
+        const auto column = static_cast<size_t>(columnOpt.value());
+
+        const auto* preview = result.lobPreview(row, column);
+        if (!preview) {
+            if (result.isNull(row, column)) {
+                return JsonUtils::successResponse(R"({"value":null})");
+            }
+            return JsonUtils::successResponse(std::format(R"({{"value":"{}"}})", JsonUtils::escapeString(result.cellText(row, column))));
+        }
+
+        // Only the start of the value was fetched: read it again from its table, by primary key
+        auto origin = m_resultRegistry->origin(params["resultHandle"].get_string().value());
+        if (!origin || origin->sourceTable.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("Only a preview of this value was fetched and the query does not read a single table to fetch the rest from");
+        }
+        auto lane = m_connections.acquireQueryLane(origin->connectionId, true);
+        const auto& driver = lane.driver();
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", origin->connectionId));
+        }
+        const auto table = detail::quoteSinglePart(origin->sourceTable);
+
+        static constexpr std::string_view keyQuery = R"(
+            SELECT c.name
+            FROM sys.indexes i
+            JOIN sys.index_columns ic ON ic.object_id = i.object_id AND ic.index_id = i.index_id
+            JOIN sys.columns c ON c.object_id = ic.object_id AND c.column_id = ic.column_id
+            WHERE i.object_id = OBJECT_ID(?) AND i.is_primary_key = 1
+            ORDER BY ic.key_ordinal
+        )";
+        auto keys = driver->executePrepared(keyQuery, {table});
+        if (keys.rowCount() == 0) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Table {} has no primary key to locate the full value by", origin->sourceTable));
+        }
+
+        auto sql = std::format("SELECT {} FROM {} WHERE ", detail::quoteSinglePart(result.columns[column].name), table);
+        std::vector<SqlParameter> keyValues;
+        for (size_t i = 0; i < keys.rowCount(); ++i) {
+            const auto keyName = keys.cellText(i, 0);
+            auto keyColumn = std::ranges::find(result.columns, keyName, &ColumnInfo::name);
+            if (keyColumn == result.columns.end()) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("The result does not include key column {} of {}", keyName, origin->sourceTable));
+            }
+            const auto keyIndex = static_cast<size_t>(keyColumn - result.columns.begin());
+            const auto& keyData = result.columnData[keyIndex];
+            if (keyData.isNull(row)) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Key column {} is NULL in this row", keyName));
+            }
+            switch (keyData.type()) {
+                case ColumnDataType::Int64:
+                    keyValues.emplace_back(keyData.int64At(row));
+                    break;
+                case ColumnDataType::Double:
+                    keyValues.emplace_back(keyData.doubleAt(row));
+                    break;
+                default:
+                    keyValues.emplace_back(keyData.displayText(row));
+                    break;
+            }
+            sql += std::format("{}{} = ?", i > 0 ? " AND " : "", detail::quoteSinglePart(keyName));
+        }
+
+        auto full = driver->executePrepared(sql, keyValues);
+        if (full.rowCount() == 0) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("The row no longer exists in {}", origin->sourceTable));
+        }
+        if (full.isNull(0, 0)) {
+            return JsonUtils::successResponse(std::format(R"({{"value":null,"totalBytes":{}}})", preview->totalBytes));
+        }
+        return JsonUtils::successResponse(std::format(R"({{"value":"{}","totalBytes":{}}})", JsonUtils::escapeString(full.cellText(0, 0)), preview->totalBytes));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
 }
 
-std::string QueryProvider::handleGetQueryHistory(std::string_view) {
-    auto historyEntries = m_queryHistory->getAll();
-    auto jsonResponse = JsonUtils::buildArray(historyEntries, [](std::string& out, const HistoryItem& e) {
-        out += std::format(R"({{"id":"{}","sql":"{}","executionTimeMs":{},"success":{},"affectedRows":{},"isFavorite":{}}})", e.id, JsonUtils::escapeString(e.sql), e.executionTimeMs,
-                           e.success ? "true" : "false", e.affectedRows, e.isFavorite ? "true" : "false");
-    });
-    return JsonUtils::successResponse(jsonResponse);
+std::string QueryProvider::handleGetColumnStats(const IPCParams& params) {
+    try {
+        if (findFileSource(params)) [[unlikely]] {
+            return JsonUtils::errorResponse("Column statistics are only kept for fetched results");
+        }
+        auto held = heldResult(params);
+        if (!held) [[unlikely]] {
+            return JsonUtils::errorResponse(held.error());
+        }
+        const auto& result = *held->result;
+        std::string json = std::format(R"({{"rowCount":{},"columns":[)", result.rowCount());
+        for (size_t col = 0; col < result.columnData.size() && col < result.columns.size(); ++col) {
+            const auto& column = result.columnData[col];
+            // Folded while fetching; only rows added some other way are read here
+            auto stats = column.stats();
+            stats.update(column);
+            auto appendValue = [&](std::optional<size_t> row) {
+                if (!row) {
+                    json += "null";
+                    return;
+                }
+                json += '"';
+                JsonUtils::appendEscaped(json, column.displayText(*row));
+                json += '"';
+            };
+            json += col > 0 ? "," : "";
+            json += std::format(R"({{"name":"{}","nullCount":{},"distinct":{},"zones":{},"min":)", JsonUtils::escapeString(result.columns[col].name), stats.nullCount(),
+                                stats.distinctEstimate(), stats.zones().size());
+            appendValue(stats.minRow());
+            json += R"(,"max":)";
+            appendValue(stats.maxRow());
+            json += '}';
+        }
+        json += "]}";
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleSearchResult(const IPCParams& params) {
+    try {
+        auto needleResult = params["needle"].get_string();
+        if (needleResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: needle");
+        }
+        bool caseInsensitive = true;
+        if (auto caseOpt = params["caseInsensitive"].get_bool(); !caseOpt.error()) {
+            caseInsensitive = caseOpt.value();
+        }
+        uint64_t startRow = 0;
+        if (auto startRowOpt = params["startRow"].get_uint64(); !startRowOpt.error()) {
+            startRow = startRowOpt.value();
+        }
+        size_t limit = DEFAULT_SEARCH_MATCHES;
+        if (auto limitOpt = params["limit"].get_uint64(); !limitOpt.error()) {
+            limit = static_cast<size_t>(std::clamp(limitOpt.value(), uint64_t{1}, uint64_t{MAX_SEARCH_MATCHES}));
+        }
+        auto held = heldResult(params);
+        if (!held) [[unlikely]] {
+            return JsonUtils::errorResponse(held.error());
+        }
+
+        const auto& result = *held->result;
+        const auto masks = SIMDFilter{}.searchMasks(result, needleResult.value(), caseInsensitive);
+        auto hit = [&](size_t column, size_t row) { return (masks[column][row >> 6] >> (row & 63)) & 1; };
+        // Rows with any matching cell, so rows without one are skipped a word at a time
+        SIMDFilter::RowMask anyColumn((result.rowCount() + 63) / 64, 0);
+        for (const auto& mask : masks) {
+            for (size_t w = 0; w < anyColumn.size() && w < mask.size(); ++w) {
+                anyColumn[w] |= mask[w];
+            }
+        }
+
+        std::string matches;
+        size_t found = 0;
+        size_t totalMatches = 0;
+        std::optional<size_t> nextRow;
+        auto visit = [&](size_t position, size_t row) {
+            for (size_t column = 0; column < masks.size(); ++column) {
+                if (!hit(column, row)) {
+                    continue;
+                }
+                ++totalMatches;
+                if (position < startRow || nextRow) {
+                    continue;
+                }
+                matches += std::format("{}[{},{}]", found++ > 0 ? "," : "", position, column);
+            }
+            if (found >= limit && !nextRow && position >= startRow) {
+                nextRow = position + 1;
+            }
+        };
+        if (!held->rows) {
+            for (size_t w = 0; w < anyColumn.size(); ++w) {
+                for (uint64_t word = anyColumn[w]; word != 0; word &= word - 1) {
+                    const size_t row = (w << 6) + static_cast<size_t>(std::countr_zero(word));
+                    visit(row, row);
+                }
+            }
+        } else {
+            for (size_t position = 0; position < held->size(); ++position) {
+                const size_t row = held->rowAt(position);
+                if ((anyColumn[row >> 6] >> (row & 63)) & 1) {
+                    visit(position, row);
+                }
+            }
+        }
+        if (nextRow && *nextRow >= held->size()) {
+            nextRow.reset();
+        }
+
+        return JsonUtils::successResponse(std::format(R"({{"matches":[{}],"totalMatches":{},"nextRow":{},"simdLevel":"{}"}})", matches, totalMatches, nextRow ? std::to_string(*nextRow) : "null"s,
+                                                      SIMDFilter::levelName(SIMDFilter::activeLevel())));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleCopyResult(const IPCParams& params) {
+    try {
+        auto formatName = params["format"].get_string();
+        auto format = formatName.error() ? std::optional(CopyFormat::Tsv) : GridCopy::parseFormat(formatName.value());
+        if (!format) [[unlikely]] {
+            return JsonUtils::errorResponse("format must be tsv, csv, or markdown");
+        }
+        bool includeHeader = false;
+        if (auto headerOpt = params["includeHeader"].get_bool(); !headerOpt.error()) {
+            includeHeader = headerOpt.value();
+        }
+        std::string nullText;
+        if (auto nullTextOpt = params["nullText"].get_string(); !nullTextOpt.error()) {
+            nullText = std::string(nullTextOpt.value());
+        }
+        auto held = heldResult(params);
+        if (!held) [[unlikely]] {
+            return JsonUtils::errorResponse(held.error());
+        }
+        const auto& result = *held->result;
+
+        std::vector<size_t> columns;
+        if (auto columnsOpt = params["columns"].get_array(); !columnsOpt.error()) {
+            for (auto column : columnsOpt.value()) {
+                auto index = column.get_uint64();
+                if (index.error() || index.value() >= result.columns.size()) [[unlikely]] {
+                    return JsonUtils::errorResponse("columns must list column indices of the result");
+                }
+                columns.push_back(index.value());
+            }
+        } else {
+            columns.resize(result.columns.size());
+            std::iota(columns.begin(), columns.end(), size_t{0});
+        }
+
+        std::vector<size_t> rows;
+        auto appendRange = [&](size_t begin, size_t end) {
+            for (size_t position = begin; position < end; ++position) {
+                rows.push_back(held->rowAt(position));
+            }
+        };
+        if (auto rangesOpt = params["rowRanges"].get_array(); !rangesOpt.error()) {
+            for (auto range : rangesOpt.value()) {
+                std::vector<uint64_t> bounds;
+                if (auto pair = range.get_array(); !pair.error()) {
+                    for (auto bound : pair.value()) {
+                        auto value = bound.get_uint64();
+                        bounds.push_back(value.error() ? UINT64_MAX : value.value());
+                    }
+                }
+                if (bounds.size() != 2 || bounds[0] > bounds[1] || bounds[1] == UINT64_MAX) [[unlikely]] {
+                    return JsonUtils::errorResponse("rowRanges must list [start, end) pairs of display rows");
+                }
+                appendRange((std::min)(static_cast<size_t>(bounds[0]), held->size()), (std::min)(static_cast<size_t>(bounds[1]), held->size()));
+            }
+        } else {
+            rows.reserve(held->size());
+            appendRange(0, held->size());
+        }
+
+        const auto text = GridCopy::render(result, rows, columns, *format, includeHeader, nullText);
+        if (auto copied = Clipboard::setText(text); !copied) [[unlikely]] {
+            return JsonUtils::errorResponse(copied.error());
+        }
+        return JsonUtils::successResponse(std::format(R"({{"rows":{},"columns":{},"bytes":{}}})", rows.size(), columns.size(), text.size()));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleCompareData(const IPCParams& params) {
+    try {
+        auto left = parseCompareSide(params, "left");
+        if (!left) [[unlikely]] {
+            return JsonUtils::errorResponse(left.error());
+        }
+        auto right = parseCompareSide(params, "right");
+        if (!right) [[unlikely]] {
+            return JsonUtils::errorResponse(right.error());
+        }
+        std::vector<std::string> keyColumns;
+        if (auto keys = params["keyColumns"].get_array(); !keys.error()) {
+            for (auto key : keys.value()) {
+                auto name = key.get_string();
+                if (name.error()) [[unlikely]] {
+                    return JsonUtils::errorResponse("keyColumns must list column names");
+                }
+                keyColumns.emplace_back(name.value());
+            }
+        }
+        if (keyColumns.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: keyColumns");
+        }
+        const bool tables = !left->table.empty() && !right->table.empty();
+        bool chunkChecksums = false;
+        if (auto checksumOpt = params["chunkChecksums"].get_bool(); !checksumOpt.error()) {
+            chunkChecksums = checksumOpt.value() && tables;
+        }
+        size_t chunkCount = DEFAULT_COMPARE_CHUNKS;
+        if (auto chunksOpt = params["chunks"].get_uint64(); !chunksOpt.error()) {
+            chunkCount = std::clamp(static_cast<size_t>(chunksOpt.value()), size_t{1}, MAX_COMPARE_CHUNKS);
+        }
+
+        auto leftLane = m_connections.acquireQueryLane(left->connectionId, SQLParser::isSessionIndependent(left->sql));
+        auto rightLane = m_connections.acquireQueryLane(right->connectionId, SQLParser::isSessionIndependent(right->sql));
+        if (!leftLane || !rightLane) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", leftLane ? right->connectionId : left->connectionId));
+        }
+        const auto start = std::chrono::steady_clock::now();
+
+        // Optional first pass on the server: both tables are cut into chunks by a hash of the key, and only the
+        // chunks whose row count or checksum differ are fetched. BINARY_CHECKSUM skips text/ntext/image/xml columns
+        // and CHECKSUM_AGG can miss changes that cancel out within a chunk, so this trades certainty for transfer.
+        size_t mismatchedChunks = 0;
+        size_t unchangedInChunks = 0;
+        if (chunkChecksums) {
+            std::string keys;
+            for (const auto& key : keyColumns) {
+                keys += std::format("{}{}", keys.empty() ? "" : ", ", detail::quoteSinglePart(key));
+            }
+            const auto chunkExpression = std::format("(BINARY_CHECKSUM({}) & 2147483647) % {}", keys, chunkCount);
+            auto rightChunks = std::async(std::launch::async, [&] { return readChunkChecksums(*rightLane.driver(), *right, chunkExpression); });
+            const auto leftChunks = readChunkChecksums(*leftLane.driver(), *left, chunkExpression);
+            const auto rightChecksums = rightChunks.get();
+
+            std::string mismatched;
+            auto addMismatch = [&](int64_t chunk) {
+                mismatched += std::format("{}{}", mismatched.empty() ? "" : ",", chunk);
+                ++mismatchedChunks;
+            };
+            for (const auto& [chunk, summary] : leftChunks) {
+                auto other = rightChecksums.find(chunk);
+                if (other == rightChecksums.end() || other->second != summary) {
+                    addMismatch(chunk);
+                } else {
+                    unchangedInChunks += static_cast<size_t>(summary.first);
+                }
+            }
+            for (const auto& [chunk, summary] : rightChecksums) {
+                if (!leftChunks.contains(chunk)) {
+                    addMismatch(chunk);
+                }
+            }
+            // Past half the chunks a filtered scan saves little over reading everything
+            if (mismatchedChunks * 2 > chunkCount) {
+                unchangedInChunks = 0;
+            } else {
+                const auto filter = mismatched.empty() ? " WHERE 1 = 0"s : std::format(" WHERE {} IN ({})", chunkExpression, mismatched);
+                left->sql += filter;
+                right->sql += filter;
+            }
+        }
+
+        struct CompareSink final : RowBatchSink {
+            std::function<void(const std::vector<ColumnInfo>&)> columns;
+            std::function<void(const ResultSet&)> rows;
+            void onColumns(const std::vector<ColumnInfo>& info) override { columns(info); }
+            [[nodiscard]] bool onBatch(const ResultSet& batch) override {
+                rows(batch);
+                return true;
+            }
+        };
+        std::unique_ptr<ResultComparer> comparer;
+        CompareSink leftSink;
+        leftSink.columns = [&](const std::vector<ColumnInfo>& info) { comparer = std::make_unique<ResultComparer>(info, keyColumns); };
+        leftSink.rows = [&](const ResultSet& batch) { comparer->addLeft(batch); };
+        (void)leftLane.driver()->executeStreaming(left->sql, leftSink, ResultComparer::PARALLEL_MIN_ROWS);
+        if (!comparer) [[unlikely]] {
+            return JsonUtils::errorResponse("The left query returned no result set to compare");
+        }
+        leftLane.release();
+
+        CompareSink rightSink;
+        rightSink.columns = [&](const std::vector<ColumnInfo>& info) { comparer->beginRight(info); };
+        rightSink.rows = [&](const ResultSet& batch) { comparer->addRight(batch); };
+        (void)rightLane.driver()->executeStreaming(right->sql, rightSink, ResultComparer::PARALLEL_MIN_ROWS);
+
+        auto comparison = comparer->finish();
+        comparison.unchangedCount += unchangedInChunks;
+        auto json = serializeComparison(comparison);
+        json.pop_back();
+        if (chunkChecksums) {
+            json += std::format(R"(,"chunks":{{"total":{},"mismatched":{}}})", chunkCount, mismatchedChunks);
+        }
+        json += std::format(R"(,"executionTimeMs":{:.3f}}})", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::string QueryProvider::handleStartBroadcastQuery(const IPCParams& params) {
+    try {
+        auto sqlQueryResult = params["sql"].get_string();
+        auto targetsResult = params["targets"].get_array();
+        if (sqlQueryResult.error() || targetsResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: sql or targets");
+        }
+        auto sqlQuery = std::string(sqlQueryResult.value());
+        // One statement fanned out to many servers is not the place for writes
+        if (!SQLParser::isReadOnlyQuery(sqlQuery)) [[unlikely]] {
+            return JsonUtils::errorResponse("Broadcast only supports read-only queries");
+        }
+        auto timeout = BroadcastQuery::DEFAULT_TIMEOUT;
+        if (auto timeoutOpt = params["timeoutSeconds"].get_double(); !timeoutOpt.error() && timeoutOpt.value() > 0) {
+            timeout = std::chrono::milliseconds(static_cast<int64_t>(timeoutOpt.value() * 1000));
+        }
+
+        // A target that does not parse still gets its (failed) outcome, in its turn
+        std::vector<BroadcastQuery::Target> targets;
+        for (auto target : targetsResult.value()) {
+            auto key = target["key"].get_string();
+            auto server = std::string(key.error() ? std::string_view{} : key.value());
+            if (auto idResult = target["connectionId"].get_string(); !idResult.error()) {
+                auto connectionId = std::string(idResult.value());
+                if (server.empty()) {
+                    server = connectionId;
+                }
+                targets.push_back({std::move(server), [&connections = m_connections, connectionId, sqlQuery, timeout]() -> std::expected<BroadcastSession, std::string> {
+                                       // Admitted before a lane is taken, so a target waiting its turn holds nothing
+                                       auto ticket = admit({.server = AdmissionController::serverKey(connections.getCacheIdentity(connectionId)), .owner = "broadcast", .kind = AdmissionClass::Broadcast},
+                                                           timeout);
+                                       if (!ticket) [[unlikely]] {
+                                           return std::unexpected(ticket.error());
+                                       }
+                                       auto lane = connections.acquireLaneFor(connectionId, SqlTokenStream(sqlQuery));
+                                       if (!lane) [[unlikely]] {
+                                           return std::unexpected(std::format("Connection not found: {}", connectionId));
+                                       }
+                                       return broadcastSession(std::move(lane), std::move(*ticket));
+                                   }});
+                continue;
+            }
+            auto profile = extractConnectionParams(target);
+            if (server.empty() && profile) {
+                server = profile->server;
+            }
+            targets.push_back({std::move(server), [&connections = m_connections, profile = std::move(profile), timeout]() -> std::expected<BroadcastSession, std::string> {
+                                   if (!profile) [[unlikely]] {
+                                       return std::unexpected(profile.error());
+                                   }
+                                   auto ticket = admit({.server = AdmissionController::serverKey(profile->server), .owner = "broadcast", .kind = AdmissionClass::Broadcast}, timeout);
+                                   if (!ticket) [[unlikely]] {
+                                       return std::unexpected(ticket.error());
+                                   }
+                                   auto lane = connections.openStandaloneLane(*profile);
+                                   if (!lane) {
+                                       return std::unexpected(lane.error());
+                                   }
+                                   return broadcastSession(std::move(*lane), std::move(*ticket));
+                               }});
+        }
+
+        size_t parallelism = BroadcastQuery::DEFAULT_PARALLELISM;
+        if (auto parallelismOpt = params["parallelism"].get_int64(); !parallelismOpt.error() && parallelismOpt.value() > 0) {
+            parallelism = static_cast<size_t>(parallelismOpt.value());
+        }
+        size_t maxRows = BroadcastQuery::DEFAULT_MAX_ROWS;
+        if (auto maxRowsOpt = params["maxRows"].get_uint64(); !maxRowsOpt.error() && maxRowsOpt.value() > 0) {
+            maxRows = (std::min)(static_cast<size_t>(maxRowsOpt.value()), BroadcastQuery::DEFAULT_MAX_ROWS);
+        }
+
+        const size_t total = targets.size();
+        auto job = std::make_shared<BroadcastJob>();
+        job->query = std::make_unique<BroadcastQuery>(std::move(sqlQuery), std::move(targets), parallelism, timeout, maxRows);
+
+        std::string broadcastId;
+        {
+            std::lock_guard lock(m_broadcastsMutex);
+            evictFinishedBroadcasts();
+            broadcastId = std::format("broadcast_{}", m_broadcastIdCounter++);
+            m_broadcasts[broadcastId] = std::move(job);
+        }
+        return JsonUtils::successResponse(std::format(R"({{"broadcastId":"{}","total":{}}})", broadcastId, total));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleGetBroadcastProgress(const IPCParams& params) {
+    try {
+        auto broadcastIdResult = params["broadcastId"].get_string();
+        if (broadcastIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: broadcastId");
+        }
+        auto broadcastId = std::string(broadcastIdResult.value());
+        size_t since = 0;
+        if (auto sinceOpt = params["since"].get_int64(); !sinceOpt.error() && sinceOpt.value() > 0) {
+            since = static_cast<size_t>(sinceOpt.value());
+        }
+
+        auto job = findBroadcast(broadcastId);
+        if (!job) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Broadcast not found: {}", broadcastId));
+        }
+
+        // Outcomes since the caller's last poll, so each one is sent once
+        auto progress = job->query->progress(since);
+        std::string json = std::format(R"({{"broadcastId":"{}","total":{},"completed":{},"rows":{},"done":{},"elapsedMs":{:.1f},"results":[)", broadcastId, progress.total, progress.completed,
+                                       progress.rows, progress.done ? "true" : "false", progress.elapsedMs);
+        for (size_t i = 0; i < progress.results.size(); ++i) {
+            if (i > 0) {
+                json += ',';
+            }
+            appendBroadcastOutcome(json, progress.results[i]);
+        }
+        json += ']';
+        if (progress.result) {
+            // Held like a kept query result, so the grid pages, sorts and exports it by handle
+            std::string handle;
+            {
+                std::lock_guard lock(m_broadcastsMutex);
+                if (job->resultHandle.empty()) {
+                    job->resultHandle = m_resultRegistry->put({}, progress.result);
+                }
+                handle = job->resultHandle;
+            }
+            if (!handle.empty()) {
+                json += std::format(R"(,"resultHandle":"{}")", handle);
+            }
+            json += std::format(R"(,"truncated":{})", progress.result->truncated ? "true" : "false");
+        }
+        json += '}';
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleCancelBroadcast(const IPCParams& params) {
+    try {
+        auto broadcastIdResult = params["broadcastId"].get_string();
+        if (broadcastIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: broadcastId");
+        }
+
+        auto job = findBroadcast(broadcastIdResult.value());
+        bool cancelled = false;
+        if (job && !job->query->done()) {
+            job->query->cancel();
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleSaveResultSnapshot(const IPCParams& params) {
+    try {
+        auto handleResult = params["resultHandle"].get_string();
+        auto filepathResult = params["filepath"].get_string();
+        if (handleResult.error() || filepathResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: resultHandle or filepath");
+        }
+        auto result = m_resultRegistry->find(handleResult.value());
+        if (!result) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Result not found or expired: {}", handleResult.value()));
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        auto info = ResultSnapshot::save(*result, std::string(filepathResult.value()));
+        const auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        return JsonUtils::successResponse(std::format(R"({{{},"executionTimeMs":{:.2f}}})", snapshotInfoJson(info), elapsedMs));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleOpenResultSnapshot(const IPCParams& params) {
+    try {
+        auto filepathResult = params["filepath"].get_string();
+        if (filepathResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: filepath");
+        }
+        auto filepath = std::string(filepathResult.value());
+        if (auto statsOnly = params["statsOnly"].get_bool(); !statsOnly.error() && statsOnly.value()) {
+            return JsonUtils::successResponse(std::format("{{{}}}", snapshotInfoJson(ResultSnapshot::inspect(filepath))));
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        auto info = ResultSnapshot::inspect(filepath);
+        auto result = std::make_shared<const ResultSet>(ResultSnapshot::load(filepath));
+        const auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        // Held like a kept query result, so the grid pages, sorts, filters and exports it by handle
+        auto handle = m_resultRegistry->put({}, result);
+        if (handle.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("Snapshot is too large to hold");
+        }
+        return JsonUtils::successResponse(std::format(R"({{"resultHandle":"{}",{},"executionTimeMs":{:.2f}}})", handle, snapshotInfoJson(info), elapsedMs));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleJoinResults(const IPCParams& params) {
+    try {
+        auto leftHandleResult = params["leftHandle"].get_string();
+        auto rightHandleResult = params["rightHandle"].get_string();
+        if (leftHandleResult.error() || rightHandleResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: leftHandle or rightHandle");
+        }
+        auto columnNames = [&](const char* field) -> std::expected<std::vector<std::string>, std::string> {
+            std::vector<std::string> names;
+            auto columns = params[field].get_array();
+            if (columns.error()) [[unlikely]] {
+                return std::unexpected(std::format("Missing required field: {}", field));
+            }
+            for (auto column : columns.value()) {
+                auto name = column.get_string();
+                if (name.error()) [[unlikely]] {
+                    return std::unexpected(std::format("{} must list column names", field));
+                }
+                names.emplace_back(name.value());
+            }
+            return names;
+        };
+        auto leftColumns = columnNames("leftColumns");
+        if (!leftColumns) [[unlikely]] {
+            return JsonUtils::errorResponse(leftColumns.error());
+        }
+        auto rightColumns = columnNames("rightColumns");
+        if (!rightColumns) [[unlikely]] {
+            return JsonUtils::errorResponse(rightColumns.error());
+        }
+        auto type = JoinType::Inner;
+        if (auto joinType = params["joinType"].get_string(); !joinType.error()) {
+            if (joinType.value() == "left") {
+                type = JoinType::Left;
+            } else if (joinType.value() != "inner") [[unlikely]] {
+                return JsonUtils::errorResponse("joinType must be inner or left");
+            }
+        }
+
+        // Held results stay valid while we read them, whichever connection produced them
+        auto left = m_resultRegistry->find(leftHandleResult.value());
+        auto right = m_resultRegistry->find(rightHandleResult.value());
+        if (!left || !right) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Result not found or expired: {}", !left ? leftHandleResult.value() : rightHandleResult.value()));
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        auto joined = ResultJoiner::join(*left, *right, *leftColumns, *rightColumns, type);
+        const auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        auto result = std::make_shared<const ResultSet>(std::move(joined.result));
+        auto handle = m_resultRegistry->put({}, result);
+        if (handle.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("Joined result is too large to hold");
+        }
+
+        std::string json = std::format(R"({{"resultHandle":"{}","rowCount":{},)", handle, result->rowCount());
+        JsonUtils::appendColumns(json, result->columns);
+        json += std::format(R"(,"buildSide":"{}","truncated":{},"executionTimeMs":{:.2f}}})", joined.builtOnLeft ? "left" : "right", result->truncated ? "true" : "false", elapsedMs);
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleOpenFileDatasource(const IPCParams& params) {
+    try {
+        auto filepathResult = params["filepath"].get_string();
+        if (filepathResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: filepath");
+        }
+        ImportOptions options;
+        if (auto delimiter = params["delimiter"].get_string(); !delimiter.error()) {
+            options.delimiter = std::string(delimiter.value());
+        }
+        if (auto hasHeader = params["hasHeader"].get_bool(); !hasHeader.error()) {
+            options.hasHeader = hasHeader.value();
+        }
+        if (auto nullValue = params["nullValue"].get_string(); !nullValue.error()) {
+            options.nullValue = std::string(nullValue.value());
+        }
+
+        auto file = std::make_shared<FileSource>();
+        file->source = std::make_unique<FileDatasource>(std::string(filepathResult.value()), options);
+        std::string json = "{";
+        JsonUtils::appendColumns(json, file->source->columns());
+        std::string handle;
+        {
+            std::lock_guard lock(m_fileSourcesMutex);
+            handle = std::format("fs{}", m_fileSourceIdCounter++);
+            m_fileSources.emplace(handle, file);
+        }
+        json += std::format(R"(,"resultHandle":"{}","format":"{}","totalBytes":{}}})", handle, file->source->isJsonLines() ? "jsonl" : "csv", file->source->totalBytes());
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleGetFileDatasourceProgress(const IPCParams& params) {
+    auto handleResult = params["resultHandle"].get_string();
+    if (handleResult.error()) [[unlikely]] {
+        return JsonUtils::errorResponse("Missing required field: resultHandle");
+    }
+    auto file = findFileSource(params);
+    if (!file) [[unlikely]] {
+        return JsonUtils::errorResponse(std::format("Result not found or expired: {}", handleResult.value()));
+    }
+    const auto progress = file->source->indexProgress();
+    return JsonUtils::successResponse(std::format(R"({{"bytesIndexed":{},"totalBytes":{},"done":{},"rows":{},"error":{}}})", progress.bytesIndexed, progress.totalBytes, progress.done ? "true" : "false",
+                                                  progress.done && progress.error.empty() ? std::to_string(progress.rows) : "null",
+                                                  progress.error.empty() ? "null" : std::format("\"{}\"", JsonUtils::escapeString(progress.error))));
+}
+
+std::shared_ptr<QueryProvider::FileSource> QueryProvider::findFileSource(const IPCParams& params) const {
+    auto handleResult = params["resultHandle"].get_string();
+    if (handleResult.error()) {
+        return nullptr;
+    }
+    std::lock_guard lock(m_fileSourcesMutex);
+    auto it = m_fileSources.find(std::string(handleResult.value()));
+    return it == m_fileSources.end() ? nullptr : it->second;
+}
+
+std::expected<std::shared_ptr<const std::vector<size_t>>, std::string> QueryProvider::fileSourceView(FileSource& file, const IPCParams& params) {
+    if (auto sortModel = params["sortModel"].get_array(); !sortModel.error()) {
+        for (auto item : sortModel.value()) {
+            if (!item["colId"].get_string().error()) [[unlikely]] {
+                return std::unexpected("Sorting a file datasource needs the whole file in memory; import the file to sort it"s);
+            }
+        }
+    }
+    auto filterParam = params["filter"];
+    if (filterParam.error()) {
+        return nullptr;
+    }
+    auto filter = FilterExpression::parse(filterParam.value());
+    if (!filter) [[unlikely]] {
+        return std::unexpected(filter.error());
+    }
+    auto filterJson = simdjson::minify(filterParam.value());
+
+    std::lock_guard lock(file.viewMutex);
+    if (!file.viewRows || file.viewKey != filterJson) {
+        auto rows = std::make_shared<std::vector<size_t>>();
+        file.source->scan([&](const ResultSet& batch, size_t firstRow) {
+            for (size_t row : filter->evaluate(batch)) {
+                rows->push_back(firstRow + row);
+            }
+            return true;
+        });
+        file.viewKey = std::move(filterJson);
+        file.viewRows = std::move(rows);
+    }
+    return file.viewRows;
+}
+
+std::string QueryProvider::serializeFileWindow(const FileDatasource& source, const std::vector<size_t>* view, size_t begin, size_t count, std::span<const size_t> columns, std::string_view startField) {
+    std::vector<size_t> rows(count);
+    for (size_t i = 0; i < count; ++i) {
+        rows[i] = view ? (*view)[begin + i] : begin + i;
+    }
+    const auto parsed = source.rowsAt(rows);
+    std::iota(rows.begin(), rows.end(), size_t{0});
+    const size_t totalRows = source.rowCount();
+    std::string json = "{";
+    JsonUtils::appendRowWindow(json, parsed, rows, columns);
+    json += std::format(R"(,"{}":{},"totalRows":{},"viewRows":{}}})", startField, begin, totalRows, view ? view->size() : totalRows);
+    return json;
+}
+
+std::shared_ptr<QueryProvider::BroadcastJob> QueryProvider::findBroadcast(std::string_view broadcastId) const {
+    std::lock_guard lock(m_broadcastsMutex);
+    auto it = m_broadcasts.find(std::string(broadcastId));
+    return it == m_broadcasts.end() ? nullptr : it->second;
+}
+
+void QueryProvider::evictFinishedBroadcasts() {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_broadcasts, [&](const auto& entry) { return entry.second->query->done() && now - entry.second->query->endTime() > FINISHED_BROADCAST_RETENTION; });
+}
+
+std::shared_ptr<WorkloadReplay> QueryProvider::findReplay(std::string_view replayId) const {
+    std::lock_guard lock(m_replaysMutex);
+    auto it = m_replays.find(std::string(replayId));
+    return it == m_replays.end() ? nullptr : it->second;
+}
+
+void QueryProvider::evictFinishedReplays() {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_replays, [&](const auto& entry) { return entry.second->done() && now - entry.second->endTime() > FINISHED_REPLAY_RETENTION; });
+}
+
+std::string QueryProvider::serializeWindow(const HeldResult& held, size_t begin, size_t count, std::span<const size_t> columns, std::string_view startField) {
+    std::vector<size_t> rows(count);
+    for (size_t i = 0; i < count; ++i) {
+        rows[i] = held.rowAt(begin + i);
+    }
+    std::string json = "{";
+    JsonUtils::appendRowWindow(json, *held.result, rows, columns);
+    json += std::format(R"(,"{}":{},"totalRows":{},"viewRows":{}}})", startField, begin, held.result->rowCount(), held.size());
+    return json;
+}
+
+std::string QueryProvider::handleReleaseResult(const IPCParams& params) {
+    auto handleResult = params["resultHandle"].get_string();
+    if (handleResult.error()) [[unlikely]] {
+        return JsonUtils::errorResponse("Missing required field: resultHandle");
+    }
+    {
+        std::lock_guard lock(m_fileSourcesMutex);
+        if (m_fileSources.erase(std::string(handleResult.value())) > 0) {
+            return JsonUtils::successResponse(R"({"released":true})");
+        }
+    }
+    const bool released = m_resultRegistry->release(handleResult.value());
+    return JsonUtils::successResponse(std::format(R"({{"released":{}}})", released ? "true" : "false"));
+}
+
+void QueryProvider::cleanupConnection(const IPCParams& params) {
+    if (auto idResult = params["connectionId"].get_string(); !idResult.error()) {
+        (void)m_resultRegistry->releaseConnection(idResult.value());
+    }
+}
+
+std::string QueryProvider::handleGetCacheStats(const IPCParams&) {
+    auto currentSize = m_resultCache->getCurrentSize();
+    auto maxSize = m_resultCache->getMaxSize();
+    auto stats = m_resultCache->stats();
+    auto& disk = diskCache();
+    std::string jsonResponse = std::format(R"({{"currentSizeBytes":{},"maxSizeBytes":{},"usagePercent":{:.1f},"entries":{},"hits":{},"misses":{},"staleRejections":{},"bytesSaved":{},"diskSizeBytes":{},"diskEntries":{},"heldResults":{},"heldBytes":{},"spilledResults":{},"spilledBytes":{},"memory":{}}})",
+                                           currentSize, maxSize, maxSize > 0 ? (static_cast<double>(currentSize) / static_cast<double>(maxSize)) * 100.0 : 0.0, m_resultCache->entryCount(), stats.hits,
+                                           stats.misses, stats.staleRejections, stats.bytesSaved, disk.totalBytes(), disk.entryCount(), m_resultRegistry->entryCount(),
+                                           m_resultRegistry->totalBytes(), m_resultRegistry->spilledCount(), m_resultRegistry->spilledBytes(), MemoryGovernor::instance().toJson());
+    return JsonUtils::successResponse(jsonResponse);
+}
+
+std::string QueryProvider::handleClearCache(const IPCParams&) {
+    m_resultCache->clear();
+    diskCache().clear();
+    return JsonUtils::successResponse(R"({"cleared":true})");
+}
+
+std::string QueryProvider::handleScheduleQuery(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlResult = params["sql"].get_string();
+        auto cronResult = params["cron"].get_string();
+        if (connectionIdResult.error() || sqlResult.error() || cronResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId, sql or cron");
+        }
+        std::string sql(sqlResult.value());
+        // A job runs unattended, over and over: writes have no place there, and a script would cache only one of its results
+        if (!SQLParser::isReadOnlyQuery(sql)) [[unlikely]] {
+            return JsonUtils::errorResponse("Only read-only queries can be scheduled");
+        }
+        if (SQLParser::splitStatements(sql).size() > 1) [[unlikely]] {
+            return JsonUtils::errorResponse("Schedule one statement per job");
+        }
+        auto schedule = CronSchedule::parse(cronResult.value());
+        if (!schedule) [[unlikely]] {
+            return JsonUtils::errorResponse(schedule.error());
+        }
+        std::optional<TimeWindow> window;
+        if (auto windowParam = params["window"]; !windowParam.error() && !windowParam.is_null()) {
+            auto start = windowParam["start"].get_string();
+            auto end = windowParam["end"].get_string();
+            if (start.error() || end.error()) [[unlikely]] {
+                return JsonUtils::errorResponse("window needs start and end (HH:MM)");
+            }
+            auto parsed = TimeWindow::parse(start.value(), end.value());
+            if (!parsed) [[unlikely]] {
+                return JsonUtils::errorResponse(parsed.error());
+            }
+            window = *parsed;
+        }
+
+        std::string id;
+        if (auto idOpt = params["id"].get_string(); !idOpt.error() && !idOpt.value().empty()) {
+            id = std::string(idOpt.value());
+        } else {
+            std::lock_guard lock(m_scheduledRunsMutex);
+            id = std::format("job_{}", m_scheduleIdCounter++);
+        }
+        auto next = scheduler().add(ScheduledQuery{.id = id, .connectionId = std::string(connectionIdResult.value()), .sql = std::move(sql), .schedule = std::move(*schedule), .window = window});
+        log<LogLevel::DEBUG>(std::format("Scheduled query {} ({}), next run {}", id, cronResult.value(), next ? localTimeText(*next) : "never"));
+        return JsonUtils::successResponse(std::format(R"({{"id":"{}","nextRun":{}}})", JsonUtils::escapeString(id), next ? std::format(R"("{}")", localTimeText(*next)) : "null"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleListScheduledQueries(const IPCParams&) {
+    auto jobs = scheduler().list();
+    auto json = JsonUtils::buildArray(jobs, [](std::string& out, const ScheduledQueryState& job) {
+        const auto& query = job.query;
+        out += std::format(R"({{"id":"{}","connectionId":"{}","sql":"{}","cron":"{}","window":)", JsonUtils::escapeString(query.id), JsonUtils::escapeString(query.connectionId),
+                           JsonUtils::escapeString(query.sql), JsonUtils::escapeString(query.schedule.text()));
+        out += query.window ? std::format(R"({{"start":"{}","end":"{}"}})", minuteOfDayText(query.window->startMinute), minuteOfDayText(query.window->endMinute)) : "null";
+        out += std::format(R"(,"nextRun":{},"running":{},"runs":{},"skipped":{},"lastStart":{},"lastDurationMs":{:.2f},"lastRun":)",
+                           job.nextRun ? std::format(R"("{}")", localTimeText(*job.nextRun)) : "null", job.running ? "true" : "false", job.runs, job.skipped,
+                           job.lastStart ? std::format(R"("{}")", localTimeText(*job.lastStart)) : "null", job.lastDurationMs);
+        if (job.lastOutcome) {
+            out += std::format(R"({{"success":{},"rows":{},"error":"{}"}}}})", job.lastOutcome->success ? "true" : "false", job.lastOutcome->rows, JsonUtils::escapeString(job.lastOutcome->error));
+        } else {
+            out += "null}";
+        }
+    });
+    return JsonUtils::successResponse(std::format(R"({{"jobs":{}}})", json));
+}
+
+std::string QueryProvider::handleUnscheduleQuery(const IPCParams& params) {
+    auto idResult = params["id"].get_string();
+    if (idResult.error()) [[unlikely]] {
+        return JsonUtils::errorResponse("Missing required field: id");
+    }
+    if (!scheduler().remove(std::string(idResult.value()))) [[unlikely]] {
+        return JsonUtils::errorResponse(std::format("Scheduled query not found: {}", idResult.value()));
+    }
+    return JsonUtils::successResponse(R"({"removed":true})");
+}
+
+std::string QueryProvider::handleRunScheduledQuery(const IPCParams& params) {
+    auto idResult = params["id"].get_string();
+    if (idResult.error()) [[unlikely]] {
+        return JsonUtils::errorResponse("Missing required field: id");
+    }
+    if (!scheduler().runNow(std::string(idResult.value()))) [[unlikely]] {
+        return JsonUtils::errorResponse(std::format("Scheduled query not found: {}", idResult.value()));
+    }
+    return JsonUtils::successResponse(R"({"started":true})");
+}
+
+std::string QueryProvider::handleGetQueryHistory(const IPCParams&) {
+    auto historyEntries = queryHistory().getAll();
+    auto jsonResponse = JsonUtils::buildArray(historyEntries, [](std::string& out, const HistoryItem& e) {
+        out += std::format(R"({{"id":"{}","sql":"{}","executionTimeMs":{},"success":{},"affectedRows":{},"isFavorite":{}}})", e.id, JsonUtils::escapeString(e.sql), e.executionTimeMs,
+                           e.success ? "true" : "false", e.affectedRows, e.isFavorite ? "true" : "false");
+    });
+    return JsonUtils::successResponse(jsonResponse);
+}
+
+std::string QueryProvider::handleGetQueryHistoryStats(const IPCParams& params) {
+    size_t minCount = 1;
+    if (auto minCountOpt = params["minCount"].get_uint64(); !minCountOpt.error()) {
+        minCount = static_cast<size_t>(minCountOpt.value());
+    }
+    auto aggregates = queryHistory().aggregateByFingerprint(minCount);
+    if (auto limitOpt = params["limit"].get_uint64(); !limitOpt.error() && limitOpt.value() < aggregates.size()) {
+        aggregates.resize(static_cast<size_t>(limitOpt.value()));
+    }
+    auto jsonResponse = JsonUtils::buildArray(aggregates, [](std::string& out, const HistoryAggregate& a) {
+        out += std::format(R"({{"fingerprint":"{}","hash":"{:016x}","sql":"{}","count":{},"failures":{},"p50ExecutionTimeMs":{},"p95ExecutionTimeMs":{},"totalExecutionTimeMs":{},"lastRun":{}}})",
+                           JsonUtils::escapeString(a.fingerprint), a.fingerprintHash, JsonUtils::escapeString(a.sql), a.count, a.failures, a.p50ExecutionTimeMs, a.p95ExecutionTimeMs,
+                           a.totalExecutionTimeMs, std::chrono::system_clock::to_time_t(a.lastRun));
+    });
+    return JsonUtils::successResponse(jsonResponse);
+}
+
+std::string QueryProvider::handleStartWorkloadReplay(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        if (connectionIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: connectionId");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        if (!m_connections.getQueryDriver(connectionId)) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        // The slice: keyword search narrows through the history's word index, the rest are plain filters
+        auto keywordOpt = params["keyword"].get_string();
+        auto items = keywordOpt.error() ? queryHistory().getAll() : queryHistory().search(keywordOpt.value());
+        auto from = std::chrono::system_clock::time_point::min();
+        auto to = std::chrono::system_clock::time_point::max();
+        if (auto fromOpt = params["from"].get_int64(); !fromOpt.error()) {
+            from = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(fromOpt.value()));
+        }
+        if (auto toOpt = params["to"].get_int64(); !toOpt.error()) {
+            to = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(toOpt.value()));
+        }
+        auto sourceOpt = params["sourceConnectionId"].get_string();
+        std::erase_if(items, [&](const HistoryItem& item) {
+            return item.timestamp < from || item.timestamp > to || (!sourceOpt.error() && item.connectionId != sourceOpt.value());
+        });
+        size_t limit = DEFAULT_REPLAY_ITEMS;
+        if (auto limitOpt = params["limit"].get_uint64(); !limitOpt.error() && limitOpt.value() > 0) {
+            limit = (std::min)(static_cast<size_t>(limitOpt.value()), MAX_REPLAY_ITEMS);
+        }
+        if (items.size() > limit) {
+            std::ranges::nth_element(items, items.end() - limit, {}, &HistoryItem::timestamp);
+            items.erase(items.begin(), items.end() - limit);
+        }
+
+        WorkloadReplay::Options options;
+        if (auto concurrencyOpt = params["concurrency"].get_uint64(); !concurrencyOpt.error() && concurrencyOpt.value() > 0) {
+            options.concurrency = (std::min)(static_cast<size_t>(concurrencyOpt.value()), WorkloadReplay::MAX_CONCURRENCY);
+        }
+        if (auto speedOpt = params["speedFactor"].get_double(); !speedOpt.error() && speedOpt.value() >= 0) {
+            options.speedFactor = speedOpt.value();
+        }
+        if (auto writesOpt = params["includeWrites"].get_bool(); !writesOpt.error()) {
+            options.includeWrites = writesOpt.value();
+        }
+        if (auto ratioOpt = params["regressionRatio"].get_double(); !ratioOpt.error() && ratioOpt.value() > 0) {
+            options.regressionRatio = ratioOpt.value();
+        }
+        if (auto minMsOpt = params["minRegressionMs"].get_double(); !minMsOpt.error() && minMsOpt.value() >= 0) {
+            options.minRegressionMs = minMsOpt.value();
+        }
+
+        // Each query checks out a pooled lane of the target, so the replay never holds the editor's session
+        auto replay = std::make_shared<WorkloadReplay>(
+            std::move(items),
+            [&connections = m_connections, connectionId,
+             admission = AdmissionRequest{.server = AdmissionController::serverKey(m_connections.getCacheIdentity(connectionId)), .owner = "replay", .kind = AdmissionClass::Background}](
+                std::string_view sql) -> std::expected<BroadcastSession, std::string> {
+                // Replayed load queues behind the user's own queries like any other background work
+                auto ticket = admit(admission, REPLAY_ADMISSION_TIMEOUT);
+                if (!ticket) [[unlikely]] {
+                    return std::unexpected(ticket.error());
+                }
+                auto lane = connections.acquireLaneFor(connectionId, SqlTokenStream(sql));
+                if (!lane) [[unlikely]] {
+                    return std::unexpected(std::format("Connection not found: {}", connectionId));
+                }
+                return broadcastSession(std::move(lane), std::move(*ticket));
+            },
+            options);
+        const auto progress = replay->progress();
+
+        std::string replayId;
+        {
+            std::lock_guard lock(m_replaysMutex);
+            evictFinishedReplays();
+            replayId = std::format("replay_{}", m_replayIdCounter++);
+            m_replays[replayId] = std::move(replay);
+        }
+        return JsonUtils::successResponse(std::format(R"({{"replayId":"{}","total":{},"skipped":{}}})", replayId, progress.total, progress.skipped));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleGetWorkloadReplayProgress(const IPCParams& params) {
+    try {
+        auto replayIdResult = params["replayId"].get_string();
+        if (replayIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: replayId");
+        }
+        auto replayId = std::string(replayIdResult.value());
+        auto replay = findReplay(replayId);
+        if (!replay) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Workload replay not found: {}", replayId));
+        }
+
+        const auto progress = replay->progress();
+        std::string json = std::format(R"({{"replayId":"{}","total":{},"completed":{},"failures":{},"skipped":{},"done":{},"cancelled":{},"elapsedMs":{:.1f},"maxScheduleLagMs":{:.1f},)",
+                                       replayId, progress.total, progress.completed, progress.failures, progress.skipped, progress.done ? "true" : "false",
+                                       progress.cancelled ? "true" : "false", progress.elapsedMs, progress.maxScheduleLagMs);
+        appendLatencySummary(json, "original", progress.original);
+        json += ',';
+        appendLatencySummary(json, "replayed", progress.replayed);
+        json += R"(,"shapes":[)";
+        for (size_t i = 0; i < progress.shapes.size(); ++i) {
+            const auto& shape = progress.shapes[i];
+            json += std::format(R"({}{{"hash":"{:016x}","sql":"{}","failures":{},"p50Ratio":{:.3f},"p95Ratio":{:.3f},"regressed":{},)", i > 0 ? "," : "", shape.fingerprintHash,
+                                JsonUtils::escapeString(shape.sql), shape.failures, shape.p50Ratio, shape.p95Ratio, shape.regressed ? "true" : "false");
+            appendLatencySummary(json, "original", shape.original);
+            json += ',';
+            appendLatencySummary(json, "replayed", shape.replayed);
+            if (!shape.lastError.empty()) {
+                json += std::format(R"(,"lastError":"{}")", JsonUtils::escapeString(shape.lastError));
+            }
+            json += '}';
+        }
+        json += "]}";
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string QueryProvider::handleCancelWorkloadReplay(const IPCParams& params) {
+    try {
+        auto replayIdResult = params["replayId"].get_string();
+        if (replayIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: replayId");
+        }
+
+        auto replay = findReplay(replayIdResult.value());
+        bool cancelled = false;
+        if (replay && !replay->done()) {
+            replay->cancel();
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::vector<size_t> QueryProvider::historyWordUses(std::span<const std::string> folded) {
+    return queryHistory().wordUses(folded);
+}
+
+void QueryProvider::warmUp() {
+    (void)queryHistory();
+}
+
+std::string QueryProvider::handleGetQueryTrace(const IPCParams& params) {
+    auto& tracer = QueryTracer::instance();
+    bool all = false;
+    if (auto allOpt = params["all"].get_bool(); !allOpt.error()) {
+        all = allOpt.value();
+    }
+    uint64_t traceId = 0;
+    if (auto idOpt = params["traceId"].get_uint64(); !idOpt.error()) {
+        traceId = idOpt.value();
+    } else if (!all) {
+        traceId = tracer.latestTraceWith("driver.exec");
+    }
+    if (traceId == 0 && !all) {
+        return JsonUtils::successResponse(QueryTracer::toJson(0, {}));
+    }
+
+    auto spans = tracer.spans(all ? 0 : traceId);
+    if (auto formatOpt = params["format"].get_string(); !formatOpt.error() && formatOpt.value() == "chrome"sv) {
+        return JsonUtils::successResponse(QueryTracer::toChromeTraceJson(spans));
+    }
+    return JsonUtils::successResponse(QueryTracer::toJson(all ? 0 : traceId, spans));
+}
+
+std::optional<std::string> QueryProvider::takeBinaryResult(std::string_view resultId) {
+    return m_binaryResults->take(resultId);
+}
+
+void QueryProvider::invalidateCachedResults(std::string_view connectionId, SqlTokens statement) {
+    if (SQLParser::isReadOnlyQuery(statement)) {
+        return;
+    }
+    auto statementType = SQLParser::parseSQL(statement).type;
+    if (statementType == "USE" || statementType == "BEGIN" || statementType == "COMMIT" || statementType == "EMPTY") {
+        return;
+    }
+
+    // Persisted entries for the same server are stale as well, whichever session cached them
+    auto identity = m_connections.getCacheIdentity(connectionId);
+    auto diskScope = identity.empty() ? std::string{} : identity + '/';
+
+    // Procedures and rollbacks can change any table; so can DDL we could not attribute to a table
+    auto tables = SQLParser::extractTableReferences(statement);
+    if (statementType == "EXECUTE" || statementType == "ROLLBACK" || tables.empty()) {
+        auto dropped = m_resultCache->invalidateConnection(connectionId);
+        if (!diskScope.empty()) {
+            dropped += diskCache().invalidateScope(diskScope);
+        }
+        log<LogLevel::DEBUG>(std::format("Invalidated {} cached results for connection {}", dropped, connectionId));
+        return;
+    }
+    auto dropped = m_resultCache->invalidateTables(connectionId, tables);
+    if (!diskScope.empty()) {
+        dropped += diskCache().invalidateTables(diskScope, tables);
+    }
+    log<LogLevel::DEBUG>(std::format("Invalidated {} cached results depending on {} tables", dropped, tables.size()));
+}
+
+std::string QueryProvider::executeScriptBatch(std::string_view connectionId, SQLServerDriver& driver, const std::vector<SqlTokens>& statements) {
+    std::string script;
+    for (const auto& stmt : statements) {
+        script += stmt.source();
+        script += ";\n";
+    }
+    static auto& batchedStatements = MetricsRegistry::instance().counter("query.batched_statements");
+    batchedStatements.add(statements.size());
+
+    std::vector<ResultSet> results;
+    try {
+        results = driver.executeBatch(script);
+    } catch (const std::exception& e) {
+        // Any statement before the failing one may have applied
+        for (const auto& stmt : statements) {
+            invalidateCachedResults(connectionId, stmt);
+        }
+        return JsonUtils::errorResponse(std::format("Batch of {} statements: {}", statements.size(), e.what()));
+    }
+
+    const SqlTokens* lastTransactionStatement = nullptr;
+    for (const auto& stmt : statements) {
+        if (SQLParser::isUseStatement(stmt)) {
+            m_connections.noteDatabaseChange(connectionId, SQLParser::extractDatabaseName(stmt));
+            continue;
+        }
+        invalidateCachedResults(connectionId, stmt);
+        const auto type = SQLParser::parseSQL(stmt).type;
+        if (type == "BEGIN" || type == "COMMIT" || type == "ROLLBACK") {
+            lastTransactionStatement = &stmt;
+        }
+    }
+    // One @@TRANCOUNT probe covers every BEGIN/COMMIT in the batch
+    if (lastTransactionStatement != nullptr) {
+        trackTransactionState(connectionId, driver, *lastTransactionStatement);
+    }
+
+    // USE, SET and DECLARE produce no result and SET NOCOUNT ON hides DML row counts, so results pair up with
+    // statements only when the counts agree
+    const bool paired = results.size() == statements.size();
+    std::string jsonResponse = R"({"multipleResults":true,"batched":true,"results":[)";
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i > 0)
+            jsonResponse += ",";
+        jsonResponse += R"({"statement":")";
+        JsonUtils::appendEscaped(jsonResponse, paired ? std::string(statements[i].source()) : std::format("Result {} of batch", i + 1));
+        jsonResponse += R"(","data":)";
+        jsonResponse += JsonUtils::serializeResultSet(results[i], false);
+        jsonResponse += "}";
+    }
+    jsonResponse += "]}";
+    return JsonUtils::successResponse(jsonResponse);
+}
+
+void QueryProvider::trackTransactionState(std::string_view connectionId, SQLServerDriver& driver, SqlTokens statement) {
+    auto statementType = SQLParser::parseSQL(statement).type;
+    if (statementType != "BEGIN" && statementType != "COMMIT" && statementType != "ROLLBACK") {
+        return;
+    }
+    // BEGIN may open a block rather than a transaction and nested BEGINs need as many COMMITs, so ask the server
+    try {
+        auto trancount = driver.execute("SELECT @@TRANCOUNT");
+        if (!trancount.empty()) {
+            m_connections.pinSessionLane(connectionId, trancount.cellText(0, 0) != "0");
+        }
+    } catch (const std::exception& e) {
+        log<LogLevel::DEBUG>(std::format("Failed to read @@TRANCOUNT: {}", e.what()));
+    }
+}
+
+std::string QueryProvider::diskCacheKey(std::string_view connectionId, SQLServerDriver& driver, std::string_view sql, std::string_view variant) {
+    auto identity = m_connections.getCacheIdentity(connectionId);
+    if (identity.empty()) {
+        return {};
+    }
+    // The session's current database is part of the scope, since USE changes what the same SQL reads
+    auto database = driver.execute("SELECT DB_NAME()");
+    if (database.empty() || database.isNull(0, 0)) {
+        return {};
+    }
+    return ResultCache::makeKey(std::format("{}/{}", identity, database.cellText(0, 0)), sql, variant);
+}
+
+std::shared_ptr<const ResultSet> QueryProvider::spilledResult(std::string_view connectionId, SQLServerDriver& driver, const std::string& sql) {
+    auto spill = m_pagedSpill->fetch(connectionId, driver, sql);
+    return spill.complete ? std::move(spill.rows) : nullptr;
+}
+
+DiskResultCache& QueryProvider::diskCache() {
+    std::call_once(m_diskCacheOnce, [this] { m_diskCache = std::make_unique<DiskResultCache>(DiskResultCache::defaultDirectory()); });
+    return *m_diskCache;
+}
+
+QueryScheduler& QueryProvider::scheduler() {
+    std::call_once(m_schedulerOnce, [this] {
+        m_scheduledExecutor = std::make_unique<AsyncQueryExecutor>(QueryScheduler::DEFAULT_MAX_CONCURRENT);
+        m_scheduler = std::make_unique<QueryScheduler>([this](const ScheduledQuery& query) { return startScheduledRun(query); },
+                                                       [this](const ScheduledQuery&, const std::string& ticket) { return collectScheduledRun(ticket); });
+        // Collect as soon as a run ends instead of at the next timed check
+        m_scheduledExecutor->setStatusListener([this](std::string_view, QueryStatus status, size_t) {
+            if (status != QueryStatus::Pending && status != QueryStatus::Running) {
+                m_scheduler->wake();
+            }
+        });
+    });
+    return *m_scheduler;
+}
+
+std::string QueryProvider::startScheduledRun(const ScheduledQuery& query) {
+    auto lane = m_connections.acquireQueryLane(query.connectionId, SQLParser::isSessionIndependent(query.sql));
+    auto driver = lane.driver();
+    if (!driver) [[unlikely]] {
+        throw std::runtime_error(std::format("Connection not found: {}", query.connectionId));
+    }
+    // The keys executeQuery looks up for the same SQL, so opening the report hits what the job left behind
+    ScheduledRun run{.cacheKey = ResultCache::makeKey(query.connectionId, query.sql), .diskKey = diskCacheKey(query.connectionId, *driver, query.sql), .tables = SQLParser::extractTableReferences(query.sql)};
+    QuerySubmitOptions options{.connectionId = query.connectionId, .priority = QueryPriority::Background};
+    options.admission = AdmissionRequest{.server = AdmissionController::serverKey(m_connections.getCacheIdentity(query.connectionId)), .owner = "scheduler", .kind = AdmissionClass::Background};
+    auto queryId = m_scheduledExecutor->submitQuery(std::move(driver), query.sql, std::move(lane), std::move(options));
+    std::lock_guard lock(m_scheduledRunsMutex);
+    m_scheduledRuns.insert_or_assign(queryId, std::move(run));
+    return queryId;
+}
+
+std::optional<ScheduledRunOutcome> QueryProvider::collectScheduledRun(const std::string& queryId) {
+    auto outcome = m_scheduledExecutor->getQueryResult(queryId);
+    if (outcome.status == QueryStatus::Pending || outcome.status == QueryStatus::Running) {
+        return std::nullopt;
+    }
+    ScheduledRun run;
+    {
+        std::lock_guard lock(m_scheduledRunsMutex);
+        if (auto node = m_scheduledRuns.extract(queryId)) {
+            run = std::move(node.mapped());
+        }
+    }
+    (void)m_scheduledExecutor->removeQuery(queryId);
+    if (outcome.status != QueryStatus::Completed || !outcome.result || run.cacheKey.empty()) [[unlikely]] {
+        return ScheduledRunOutcome{.error = outcome.errorMessage.empty() ? std::string("Cancelled") : std::move(outcome.errorMessage)};
+    }
+
+    auto result = std::make_shared<const ResultSet>(std::move(*outcome.result));
+    if (!run.diskKey.empty() && result->lobPreviews.empty() && !diskCache().put(run.diskKey, *result, run.tables)) {
+        log<LogLevel::WARNING>("Failed to persist scheduled query result to the disk cache"sv);
+    }
+    m_resultCache->put(run.cacheKey, result, ResultCache::EntryOptions{.tables = std::move(run.tables)});
+    return ScheduledRunOutcome{.success = true, .rows = result->rowCount()};
+}
+
+QueryHistory& QueryProvider::queryHistory() {
+    std::call_once(m_queryHistoryOnce, [this] {
+        if (!m_queryHistory->open(QueryHistory::defaultPath())) {
+            log<LogLevel::WARNING>("Query history log could not be opened; history is kept in memory only"sv);
+        }
+    });
+    return *m_queryHistory;
+}
+
+std::optional<std::string> QueryProvider::serializeDelta(std::string_view previousHandle, std::span<const std::string> keyColumns, const ResultSet& result, bool cached) {
+    auto previous = m_resultRegistry->find(previousHandle);
+    if (!previous) {
+        return std::nullopt;
+    }
+    ResultDelta delta;
+    try {
+        delta = ResultDelta::compute(*previous, result, keyColumns);
+    } catch (const std::exception& e) {
+        log<LogLevel::DEBUG>(std::format("Delta refresh falls back to the full result: {}", e.what()));
+        return std::nullopt;
+    }
+    if (delta.size() * 100 > result.rowCount() * MAX_DELTA_PERCENT) {
+        return std::nullopt;
+    }
+
+    auto appendIndices = [](std::string& json, std::span<const size_t> rows) {
+        for (size_t i = 0; i < rows.size(); ++i) {
+            json += std::format("{}{}", i > 0 ? "," : "", rows[i]);
+        }
+    };
+    std::string json = "{";
+    JsonUtils::appendColumns(json, result.columns);
+    json += std::format(R"(,"delta":{{"refreshOf":"{}","keyed":{},"deleted":[)", JsonUtils::escapeString(previousHandle), delta.keyed ? "true" : "false");
+    appendIndices(json, delta.deleted);
+    json += R"(],"inserted":[)";
+    appendIndices(json, delta.inserted);
+    json += R"(],"insertedRows":[)";
+    for (size_t i = 0; i < delta.inserted.size(); ++i) {
+        if (i > 0)
+            json += ',';
+        JsonUtils::appendRow(json, result, delta.inserted[i]);
+    }
+    json += R"(],"changed":[)";
+    for (size_t i = 0; i < delta.changed.size(); ++i) {
+        json += std::format("{}[{},{}]", i > 0 ? "," : "", delta.changed[i].first, delta.changed[i].second);
+    }
+    json += R"(],"changedRows":[)";
+    for (size_t i = 0; i < delta.changed.size(); ++i) {
+        if (i > 0)
+            json += ',';
+        JsonUtils::appendRow(json, result, delta.changed[i].second);
+    }
+    json += std::format(R"(],"unchanged":{}}},"rowCount":{},"executionTimeMs":{:.2f},"cached":{}}})", delta.unchanged, result.rowCount(), result.executionTimeMs, cached ? "true" : "false");
+    return json;
+}
+
+std::string QueryProvider::publishBinaryResult(const ResultSet& result, bool cached) {
+    auto payload = BinaryResultEncoder::encode(result);
+    const size_t byteLength = payload.size();
+    auto resultId = m_binaryResults->put(std::move(payload));
+    auto json = std::format(R"({{"format":"binary","url":"https://{}/{}","byteLength":{},"rowCount":{},"cached":{})", BINARY_RESULT_HOST, resultId, byteLength, result.rowCount(), cached ? "true" : "false");
+    JsonUtils::appendServerMessages(json, result.messages);
+    JsonUtils::appendLobPreviews(json, result);
+    json += '}';
+    return json;
 }
 
 }  // namespace velocitydb
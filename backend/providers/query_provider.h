@@ -2,15 +2,34 @@
 
 #include "../interfaces/providers/query_provider.h"
 
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace velocitydb {
 
 class IConnectionProvider;
 class ResultCache;
+class PagedResultSpill;
 class QueryHistory;
+class BinaryResultStore;
+class ResultRegistry;
+class DiskResultCache;
+class FileDatasource;
+class AsyncQueryExecutor;
+class QueryScheduler;
+class WorkloadReplay;
+struct ScheduledQuery;
+struct ScheduledRunOutcome;
+class SQLServerDriver;
+struct ResultSet;
+struct SqlTokens;
 
 /// Provider for query execution, cache, history, and filtering
 class QueryProvider : public IQueryProvider {
@@ -23,19 +42,154 @@ public:
     QueryProvider(QueryProvider&&) = delete;
     QueryProvider& operator=(QueryProvider&&) = delete;
 
-    [[nodiscard]] std::string handleExecuteQuery(std::string_view params) override;
-    [[nodiscard]] std::string handleExecuteQueryPaginated(std::string_view params) override;
-    [[nodiscard]] std::string handleGetRowCount(std::string_view params) override;
-    [[nodiscard]] std::string handleCancelQuery(std::string_view params) override;
-    [[nodiscard]] std::string handleFilterResultSet(std::string_view params) override;
-    [[nodiscard]] std::string handleGetCacheStats(std::string_view params) override;
-    [[nodiscard]] std::string handleClearCache(std::string_view params) override;
-    [[nodiscard]] std::string handleGetQueryHistory(std::string_view params) override;
+    [[nodiscard]] std::string handleExecuteQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleExecuteQueryPaginated(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetRowCount(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleFilterResultSet(const IPCParams& params) override;
+    [[nodiscard]] std::string handleAggregateResultSet(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetResultWindow(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetRows(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetCellValue(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetColumnStats(const IPCParams& params) override;
+    [[nodiscard]] std::string handleSearchResult(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCopyResult(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCompareData(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStartBroadcastQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetBroadcastProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelBroadcast(const IPCParams& params) override;
+    [[nodiscard]] std::string handleSaveResultSnapshot(const IPCParams& params) override;
+    [[nodiscard]] std::string handleOpenResultSnapshot(const IPCParams& params) override;
+    [[nodiscard]] std::string handleJoinResults(const IPCParams& params) override;
+    [[nodiscard]] std::string handleOpenFileDatasource(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetFileDatasourceProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleReleaseResult(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetCacheStats(const IPCParams& params) override;
+    [[nodiscard]] std::string handleClearCache(const IPCParams& params) override;
+    [[nodiscard]] std::string handleScheduleQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleListScheduledQueries(const IPCParams& params) override;
+    [[nodiscard]] std::string handleUnscheduleQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleRunScheduledQuery(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetQueryHistory(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetQueryHistoryStats(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStartWorkloadReplay(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetWorkloadReplayProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelWorkloadReplay(const IPCParams& params) override;
+    [[nodiscard]] std::vector<size_t> historyWordUses(std::span<const std::string> folded) override;
+    /// Spans of one request (`traceId`, default: the latest one that ran SQL), as {traceId, spans} or, with
+    /// "format":"chrome", as a Chrome trace; "all":true exports the whole ring
+    [[nodiscard]] std::string handleGetQueryTrace(const IPCParams& params) override;
+    void warmUp() override;
+    [[nodiscard]] std::optional<std::string> takeBinaryResult(std::string_view resultId) override;
+    [[nodiscard]] std::expected<HeldResult, std::string> heldResult(const IPCParams& params) override;
+    [[nodiscard]] std::optional<HeldOrigin> heldOrigin(std::string_view handle) const override;
+    bool patchHeldResult(std::string_view handle, std::span<const RowPatch> patches) override;
+    void cleanupConnection(const IPCParams& params) override;
 
 private:
+    struct BroadcastJob;
+    struct FileSource;
+
+    /// {columns, rows, <startField>, totalRows, viewRows} for `count` rows of `held` from display position `begin`
+    [[nodiscard]] static std::string serializeWindow(const HeldResult& held, size_t begin, size_t count, std::span<const size_t> columns, std::string_view startField);
+
+    /// The file datasource named by "resultHandle", or nullptr
+    [[nodiscard]] std::shared_ptr<FileSource> findFileSource(const IPCParams& params) const;
+    /// Rows of a file datasource under the grid's filter, cached per filter (nullptr: every row). Sorting would need
+    /// the whole file in memory and is refused.
+    [[nodiscard]] static std::expected<std::shared_ptr<const std::vector<size_t>>, std::string> fileSourceView(FileSource& file, const IPCParams& params);
+    /// serializeWindow for a file datasource, parsing only the rows in the window
+    [[nodiscard]] static std::string serializeFileWindow(const FileDatasource& source, const std::vector<size_t>* view, size_t begin, size_t count, std::span<const size_t> columns,
+                                                         std::string_view startField);
+
+    /// Encode `result` into the binary store and return the JSON descriptor pointing at it
+    [[nodiscard]] std::string publishBinaryResult(const ResultSet& result, bool cached);
+
+    /// `{columns, delta, rowCount, executionTimeMs, cached}` for `result` relative to the result held under
+    /// `previousHandle`; nullopt when that is gone, the rows cannot be matched, or the delta is not much smaller
+    /// than the result (MAX_DELTA_PERCENT)
+    [[nodiscard]] std::optional<std::string> serializeDelta(std::string_view previousHandle, std::span<const std::string> keyColumns, const ResultSet& result, bool cached);
+
+    /// Drop cached results on `connectionId` that `statement` may have made stale (no-op for read-only statements)
+    void invalidateCachedResults(std::string_view connectionId, SqlTokens statement);
+
+    /// Send a multi-statement script as one batch and answer with each of its results (SQLMoreResults), so the
+    /// script costs one round trip instead of one per statement
+    [[nodiscard]] std::string executeScriptBatch(std::string_view connectionId, SQLServerDriver& driver, const std::vector<SqlTokens>& statements);
+
+    /// Pin the session lane while a transaction opened from the editor (BEGIN ... COMMIT/ROLLBACK) is open
+    void trackTransactionState(std::string_view connectionId, SQLServerDriver& driver, SqlTokens statement);
+
+    /// Persistent cache key for `sql` (empty when the connection has no stable identity)
+    [[nodiscard]] std::string diskCacheKey(std::string_view connectionId, SQLServerDriver& driver, std::string_view sql, std::string_view variant = {});
+    /// Full result of `sql` held for local filtering and aggregation (PagedResultSpill); nullptr when it is too large
+    [[nodiscard]] std::shared_ptr<const ResultSet> spilledResult(std::string_view connectionId, SQLServerDriver& driver, const std::string& sql);
+
+    /// Disk tier, opened on first use so startup never scans the cache directory
+    [[nodiscard]] DiskResultCache& diskCache();
+    /// History backed by its log in the app data directory, replayed on first use
+    [[nodiscard]] QueryHistory& queryHistory();
+    /// Scheduler for scheduleQuery, started on first use. Its runs go through an executor of their own, so warming
+    /// the caches never takes a worker from the editor's async queries.
+    [[nodiscard]] QueryScheduler& scheduler();
+    /// Submit a scheduled run to the scheduler's executor; returns the async query id
+    [[nodiscard]] std::string startScheduledRun(const ScheduledQuery& query);
+    /// Cache the result of a finished scheduled run; nullopt while it is still going
+    [[nodiscard]] std::optional<ScheduledRunOutcome> collectScheduledRun(const std::string& queryId);
+
+    [[nodiscard]] std::shared_ptr<BroadcastJob> findBroadcast(std::string_view broadcastId) const;
+    void evictFinishedBroadcasts();  // Caller holds m_broadcastsMutex
+    [[nodiscard]] std::shared_ptr<WorkloadReplay> findReplay(std::string_view replayId) const;
+    void evictFinishedReplays();  // Caller holds m_replaysMutex
+
     IConnectionProvider& m_connections;
     std::unique_ptr<ResultCache> m_resultCache;
+    std::unique_ptr<PagedResultSpill> m_pagedSpill;
     std::unique_ptr<QueryHistory> m_queryHistory;
+    std::once_flag m_queryHistoryOnce;
+    std::unique_ptr<BinaryResultStore> m_binaryResults;
+    std::unique_ptr<ResultRegistry> m_resultRegistry;
+    std::unique_ptr<DiskResultCache> m_diskCache;
+    std::once_flag m_diskCacheOnce;
+
+    static constexpr size_t DEFAULT_ROW_WINDOW = 100;
+    static constexpr size_t MAX_ROW_WINDOW = 10000;
+    static constexpr size_t DEFAULT_SEARCH_MATCHES = 1000;
+    static constexpr size_t MAX_SEARCH_MATCHES = 10000;
+    static constexpr size_t MAX_DELTA_PERCENT = 50;
+    static constexpr size_t DEFAULT_COMPARE_CHUNKS = 256;
+    static constexpr size_t MAX_COMPARE_CHUNKS = 65536;
+
+    static constexpr auto FINISHED_BROADCAST_RETENTION = std::chrono::minutes{5};
+    mutable std::mutex m_broadcastsMutex;
+    std::unordered_map<std::string, std::shared_ptr<BroadcastJob>> m_broadcasts;
+    size_t m_broadcastIdCounter = 1;  // guarded by m_broadcastsMutex
+
+    static constexpr auto FINISHED_REPLAY_RETENTION = std::chrono::minutes{30};
+    static constexpr size_t DEFAULT_REPLAY_ITEMS = 1000;
+    static constexpr size_t MAX_REPLAY_ITEMS = 100000;
+    /// How long one replayed query waits for its server to admit it
+    static constexpr auto REPLAY_ADMISSION_TIMEOUT = std::chrono::minutes{2};
+    mutable std::mutex m_replaysMutex;
+    std::unordered_map<std::string, std::shared_ptr<WorkloadReplay>> m_replays;
+    size_t m_replayIdCounter = 1;  // guarded by m_replaysMutex
+
+    mutable std::mutex m_fileSourcesMutex;
+    std::unordered_map<std::string, std::shared_ptr<FileSource>> m_fileSources;
+    size_t m_fileSourceIdCounter = 1;  // guarded by m_fileSourcesMutex
+
+    /// Where the result of a scheduled run goes once it completes
+    struct ScheduledRun {
+        std::string cacheKey;
+        std::string diskKey;  ///< Empty when the connection has no stable identity
+        std::vector<std::string> tables;
+    };
+    std::mutex m_scheduledRunsMutex;
+    std::unordered_map<std::string, ScheduledRun> m_scheduledRuns;  // by async query id, guarded by m_scheduledRunsMutex
+    size_t m_scheduleIdCounter = 1;                                   // guarded by m_scheduledRunsMutex
+    std::unique_ptr<AsyncQueryExecutor> m_scheduledExecutor;
+    std::once_flag m_schedulerOnce;
+    std::unique_ptr<QueryScheduler> m_scheduler;  // Last: its thread stops before the caches it fills go away
 };
 
 }  // namespace velocitydb
@@ -1,17 +1,36 @@
 #include "schema_provider.h"
 
 #include "../database/connection_utils.h"
+#include "../database/index_advisor.h"
+#include "../database/plan_cache.h"
+#include "../database/plan_estimate.h"
+#include "../database/query_store_insights.h"
+#include "../database/schema_cache.h"
+#include "../database/schema_diff.h"
 #include "../database/schema_inspector.h"
 #include "../database/sqlserver_driver.h"
+#include "../database/table_ddl.h"
 #include "../interfaces/providers/connection_provider.h"
+#include "../parsers/er_diagram_parser_factory.h"
+#include "../parsers/plan_diff.h"
+#include "../parsers/showplan_parser.h"
+#include "../utils/buffered_file_writer.h"
+#include "../utils/er_layout.h"
+#include "../utils/file_dialog.h"
 #include "../utils/json_utils.h"
 #include "../utils/logger.h"
+#include "../utils/mapped_file.h"
 #include "../utils/sql_validation.h"
 #include "simdjson.h"
 
+#include <atomic>
 #include <charconv>
+#include <chrono>
+#include <expected>
 #include <format>
+#include <future>
 #include <ranges>
+#include <stdexcept>
 
 namespace velocitydb {
 
@@ -33,13 +52,14 @@ namespace {
 }
 
 struct TableQueryParams {
+    std::string connectionId;
     std::string tableName;
     std::shared_ptr<SQLServerDriver> driver;
 };
 
-[[nodiscard]] std::expected<TableQueryParams, std::string> extractTableQueryParams(const simdjson::dom::element& doc, IConnectionProvider& connections) {
-    auto connectionIdResult = doc["connectionId"].get_string();
-    auto tableNameResult = doc["table"].get_string();
+[[nodiscard]] std::expected<TableQueryParams, std::string> extractTableQueryParams(const simdjson::dom::element& params, IConnectionProvider& connections) {
+    auto connectionIdResult = params["connectionId"].get_string();
+    auto tableNameResult = params["table"].get_string();
     if (connectionIdResult.error() || tableNameResult.error()) [[unlikely]]
         return std::unexpected("Missing required fields: connectionId or table");
 
@@ -48,413 +68,705 @@ struct TableQueryParams {
         return std::unexpected("Invalid table name");
 
     auto connectionId = std::string(connectionIdResult.value());
-    auto driver = connections.getMetadataDriver(connectionId);
+    auto driver = connections.getSchemaDriver(connectionId);
     if (!driver) [[unlikely]]
         return std::unexpected(std::format("Connection not found: {}", connectionId));
 
-    return TableQueryParams{std::move(tableName), std::move(driver)};
+    return TableQueryParams{std::move(connectionId), std::move(tableName), std::move(driver)};
+}
+
+/// "refresh": true bypasses the schema cache (e.g. after editing comments, which leave modify_date alone)
+[[nodiscard]] bool refreshRequested(const simdjson::dom::element& params) {
+    auto refresh = params["refresh"].get_bool();
+    return !refresh.error() && refresh.value();
+}
+
+/// One side of compareSchemas: a live connection, a saved snapshot file or an ER diagram file
+struct SchemaSource {
+    std::shared_ptr<SQLServerDriver> driver;
+    std::string filepath;
+    bool diagram = false;
+};
+
+[[nodiscard]] std::expected<SchemaSource, std::string> parseSchemaSource(const simdjson::dom::element& params, std::string_view side, IConnectionProvider& connections) {
+    auto source = params[side];
+    if (source.error()) [[unlikely]] {
+        return std::unexpected(std::format("Missing {} schema", side));
+    }
+    if (auto connectionId = source["connectionId"].get_string(); !connectionId.error()) {
+        auto driver = connections.getSchemaDriver(connectionId.value());
+        if (!driver) [[unlikely]] {
+            return std::unexpected(std::format("Connection not found: {}", connectionId.value()));
+        }
+        return SchemaSource{.driver = std::move(driver)};
+    }
+    auto snapshotFile = source["snapshotFile"].get_string();
+    auto diagramFile = source["erFile"].get_string();
+    if (snapshotFile.error() && diagramFile.error()) [[unlikely]] {
+        return std::unexpected(std::format("The {} schema needs a connectionId, snapshotFile or erFile", side));
+    }
+    const bool diagram = snapshotFile.error() != simdjson::SUCCESS;
+    auto filepath = std::string(diagram ? diagramFile.value() : snapshotFile.value());
+    if (filepath.find("..") != std::string::npos) [[unlikely]] {
+        return std::unexpected("Invalid file path");
+    }
+    return SchemaSource{.filepath = std::move(filepath), .diagram = diagram};
+}
+
+[[nodiscard]] SchemaSnapshot loadSchemaSource(const SchemaSource& source) {
+    if (source.driver) {
+        return SchemaSnapshot::load(*source.driver);
+    }
+    MappedFile file;
+    if (!file.open(source.filepath)) [[unlikely]] {
+        throw std::runtime_error("Failed to open file: " + source.filepath);
+    }
+    if (!source.diagram) {
+        return SchemaSnapshot::deserialize(file.view());
+    }
+    const auto lastSlash = source.filepath.find_last_of("/\\");
+    const auto filename = lastSlash != std::string::npos ? source.filepath.substr(lastSlash + 1) : source.filepath;
+    return SchemaSnapshot::fromERModel(ERDiagramParserFactory().parse(file.view(), filename));
+}
+
+/// PlanCache::STAMP_QUERY's row joined into one string; empty when the server could not answer, which disables
+/// serving this explain from the cache
+[[nodiscard]] std::string schemaStampOf(SQLServerDriver& driver) {
+    try {
+        const auto result = driver.execute(PlanCache::STAMP_QUERY);
+        if (result.empty())
+            return {};
+        std::string stamp;
+        for (size_t col = 0; col < result.columns.size(); ++col) {
+            stamp += result.cellText(0, col);
+            stamp += '|';
+        }
+        return stamp;
+    } catch (const std::exception& e) {
+        log<LogLevel::DEBUG>(std::format("[Schema] Plan cache stamp failed: {}", e.what()));
+        return {};
+    }
 }
 
 }  // namespace
 
-SchemaProvider::SchemaProvider(IConnectionProvider& connections) : m_connections(connections), m_schemaInspector(std::make_unique<SchemaInspector>()) {}
+struct SchemaProvider::PrefetchJob {
+    std::future<void> future;
+    std::weak_ptr<SQLServerDriver> driver;
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<bool> finished{false};
+};
+
+SchemaProvider::SchemaProvider(IConnectionProvider& connections)
+    : m_connections(connections)
+    , m_schemaInspector(std::make_unique<SchemaInspector>())
+    , m_schemaCache(std::make_unique<SchemaCache>())
+    , m_queryStore(std::make_unique<QueryStoreInsights>())
+    , m_planCache(std::make_unique<PlanCache>()) {}
+
+SchemaProvider::~SchemaProvider() {
+    std::unordered_map<std::string, std::shared_ptr<PrefetchJob>> jobs;
+    {
+        std::lock_guard lock(m_prefetchMutex);
+        jobs.swap(m_prefetchJobs);
+    }
+    // Stop and wait WITHOUT holding the mutex
+    for (auto& [connectionId, job] : jobs) {
+        stopPrefetch(*job);
+    }
+}
+
+void SchemaProvider::stopPrefetch(PrefetchJob& job) {
+    job.cancelRequested.store(true, std::memory_order_release);
+    if (!job.finished.load(std::memory_order_acquire)) {
+        if (auto driver = job.driver.lock()) {
+            driver->cancel();  // Surfaces in the job as an ODBC error, which it ignores
+        }
+    }
+    if (job.future.valid()) {
+        job.future.wait();
+    }
+}
 
-SchemaProvider::~SchemaProvider() = default;
+void SchemaProvider::prefetchSchema(std::string_view connectionId, std::vector<std::string> priorityNodes) {
+    auto driver = m_connections.getSchemaDriver(connectionId);
+    if (!driver) [[unlikely]] {
+        return;
+    }
+    auto job = std::make_shared<PrefetchJob>();
+    job->driver = driver;
+    // The driver is held weakly: a disconnect mid-prefetch fails the next query and ends the job
+    job->future = std::async(std::launch::async, [this, job, connectionId = std::string(connectionId), priorityNodes = std::move(priorityNodes)] {
+        try {
+            if (auto driver = job->driver.lock()) {
+                const auto startTime = std::chrono::steady_clock::now();
+                m_schemaCache->prefetch(connectionId, driver, priorityNodes, [&] { return job->cancelRequested.load(std::memory_order_acquire); });
+                log<LogLevel::DEBUG>(std::format("[Schema] Prefetched {} in {}ms", connectionId,
+                                                 std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count()));
+            }
+        } catch (const std::exception& e) {
+            if (!job->cancelRequested.load(std::memory_order_acquire)) {
+                log<LogLevel::WARNING>(std::format("[Schema] Prefetch of {} failed: {}", connectionId, e.what()));
+            }
+        }
+        job->finished.store(true, std::memory_order_release);
+    });
+
+    std::shared_ptr<PrefetchJob> previous;
+    {
+        std::lock_guard lock(m_prefetchMutex);
+        std::erase_if(m_prefetchJobs, [](const auto& item) { return item.second->finished.load(std::memory_order_acquire); });
+        auto& slot = m_prefetchJobs[std::string(connectionId)];
+        previous = std::exchange(slot, std::move(job));
+    }
+    if (previous) {
+        stopPrefetch(*previous);
+    }
+}
 
-std::string SchemaProvider::handleGetDatabases(std::string_view params) {
+void SchemaProvider::cleanupConnection(const IPCParams& params) {
+    try {
+        auto idResult = params["connectionId"].get_string();
+        if (idResult.error())
+            return;
+        m_queryStore->forget(idResult.value());
+        m_planCache->dropConnection(idResult.value());
+        std::shared_ptr<PrefetchJob> job;
+        {
+            std::lock_guard lock(m_prefetchMutex);
+            if (auto found = m_prefetchJobs.find(std::string(idResult.value())); found != m_prefetchJobs.end()) {
+                job = std::move(found->second);
+                m_prefetchJobs.erase(found);
+            }
+        }
+        if (job) {
+            stopPrefetch(*job);
+        }
+    } catch (...) {
+        // Best-effort cleanup — do not propagate exceptions
+    }
+}
+
+bool SchemaProvider::withObjectNames(std::string_view connectionId, const std::function<void(const ObjectNameIndex&)>& use) {
+    auto driver = m_connections.getSchemaDriver(connectionId);
+    if (!driver) [[unlikely]] {
+        return false;
+    }
+    m_schemaCache->names(connectionId, driver, use);
+    return true;
+}
+
+std::string SchemaProvider::handleGetDatabases(const IPCParams& params) {
     auto connectionIdResult = extractConnectionId(params);
     if (!connectionIdResult) {
         return JsonUtils::errorResponse(connectionIdResult.error());
     }
     try {
-        auto driver = m_connections.getMetadataDriver(*connectionIdResult);
+        auto driver = m_connections.getSchemaDriver(*connectionIdResult);
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", *connectionIdResult));
         }
-        auto queryResult = driver->execute("SELECT name FROM sys.databases ORDER BY name");
-        auto jsonResponse = JsonUtils::buildRowArray(queryResult.rows, 1, [](std::string& out, const ResultRow& row) { out += std::format(R"("{}")", JsonUtils::escapeString(row.values[0])); });
+        return JsonUtils::successResponse(m_schemaCache->databases(*connectionIdResult, driver, refreshRequested(params)));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::string SchemaProvider::handleGetTables(const IPCParams& params) {
+    log<LogLevel::DEBUG>(std::format("SchemaProvider::handleGetTables called with params: {}", simdjson::minify(params)));
+    auto connectionIdResult = extractConnectionId(params);
+    if (!connectionIdResult) {
+        return JsonUtils::errorResponse(connectionIdResult.error());
+    }
+    auto connectionId = *connectionIdResult;
+    try {
+        auto driver = m_connections.getSchemaDriver(connectionId);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+        // Answered from the per-connection cache; the server is only asked what changed since the last look
+        auto jsonResponse = m_schemaCache->tables(connectionId, driver, refreshRequested(params));
         return JsonUtils::successResponse(jsonResponse);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetTables(std::string_view params) {
-    log<LogLevel::DEBUG>(std::format("SchemaProvider::handleGetTables called with params: {}", params));
+std::string SchemaProvider::handleGetSchemaSnapshot(const IPCParams& params) {
     auto connectionIdResult = extractConnectionId(params);
     if (!connectionIdResult) {
         return JsonUtils::errorResponse(connectionIdResult.error());
     }
     auto connectionId = *connectionIdResult;
     try {
-        auto driver = m_connections.getMetadataDriver(connectionId);
+        auto driver = m_connections.getSchemaDriver(connectionId);
         if (!driver) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
-        constexpr auto tableListQuery = R"(
-            SELECT
-                t.TABLE_SCHEMA,
-                t.TABLE_NAME,
-                t.TABLE_TYPE,
-                CAST(ep.value AS NVARCHAR(MAX)) AS comment
-            FROM INFORMATION_SCHEMA.TABLES t
-            LEFT JOIN sys.extended_properties ep ON ep.major_id = OBJECT_ID(t.TABLE_SCHEMA + '.' + t.TABLE_NAME)
-                AND ep.minor_id = 0
-                AND ep.class = 1
-                AND ep.name = 'MS_Description'
-            WHERE t.TABLE_TYPE IN ('BASE TABLE', 'VIEW')
-            ORDER BY t.TABLE_SCHEMA, t.TABLE_NAME
-        )";
-        auto queryResult = driver->execute(tableListQuery);
-        auto jsonResponse = JsonUtils::buildRowArray(queryResult.rows, 3, [](std::string& out, const ResultRow& row) {
-            auto comment = row.values.size() >= 4 ? row.values[3] : std::string{};
-            out += std::format(R"({{"schema":"{}","name":"{}","type":"{}","comment":"{}"}})", JsonUtils::escapeString(row.values[0]), JsonUtils::escapeString(row.values[1]),
-                               JsonUtils::escapeString(row.values[2]), JsonUtils::escapeString(comment));
-        });
+        // Tables and columns of the whole database; uncached tables are read in one multi-result batch
+        auto jsonResponse = m_schemaCache->snapshot(connectionId, driver, refreshRequested(params));
         return JsonUtils::successResponse(jsonResponse);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetColumns(std::string_view params) {
+std::string SchemaProvider::handleSaveSchemaSnapshot(const IPCParams& params) {
+    auto connectionIdResult = extractConnectionId(params);
+    if (!connectionIdResult) {
+        return JsonUtils::errorResponse(connectionIdResult.error());
+    }
+    auto filepathResult = params["filepath"].get_string();
+    if (filepathResult.error()) [[unlikely]] {
+        return JsonUtils::errorResponse("Missing filepath field");
+    }
+    auto filepath = std::string(filepathResult.value());
+    if (filepath.find("..") != std::string::npos) [[unlikely]] {
+        return JsonUtils::errorResponse("Invalid file path");
+    }
+    auto connectionId = *connectionIdResult;
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
+        auto driver = m_connections.getSchemaDriver(connectionId);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+        const auto snapshot = SchemaSnapshot::load(*driver);
+        const auto bytes = snapshot.serialize();
+        if (auto written = FileDialog::writeFile(filepath, bytes); !written) [[unlikely]] {
+            return JsonUtils::errorResponse(written.error());
+        }
+        return JsonUtils::successResponse(std::format(R"({{"tables":{},"columns":{},"bytes":{}}})", snapshot.tables.size(), snapshot.columns.size(), bytes.size()));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
 
-        auto extracted = extractTableQueryParams(doc, m_connections);
-        if (!extracted) [[unlikely]]
-            return JsonUtils::errorResponse(extracted.error());
+std::string SchemaProvider::handleGetERModel(const IPCParams& params) {
+    auto connectionIdResult = extractConnectionId(params);
+    if (!connectionIdResult) {
+        return JsonUtils::errorResponse(connectionIdResult.error());
+    }
+    auto connectionId = *connectionIdResult;
+    try {
+        auto driver = m_connections.getSchemaDriver(connectionId);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+        auto model = SchemaSnapshot::load(*driver).toERModel();
+        if (auto name = params["name"].get_string(); !name.error()) {
+            model.name = std::string(name.value());
+        }
+        if (auto layout = params["layout"].get_bool(); layout.error() || layout.value()) {
+            layoutERModel(model);
+        }
+        return JsonUtils::successResponse(ERDiagramParserFactory::toJson(model));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
 
-        auto& [tableName, driver] = *extracted;
-        auto [schema, tbl] = splitSchemaTable(tableName);
+std::string SchemaProvider::handleCompareSchemas(const IPCParams& params) {
+    auto current = parseSchemaSource(params, "current", m_connections);
+    if (!current) [[unlikely]] {
+        return JsonUtils::errorResponse(current.error());
+    }
+    auto desired = parseSchemaSource(params, "desired", m_connections);
+    if (!desired) [[unlikely]] {
+        return JsonUtils::errorResponse(desired.error());
+    }
+    SchemaDiffOptions options;
+    if (auto drops = params["drops"].get_bool(); !drops.error()) {
+        options.drops = drops.value();
+    }
+    // A diagram has no triggers, so comparing against one must not script them away
+    options.triggers = !current->diagram && !desired->diagram;
 
-        auto columnQuery = std::format(R"(
-            SELECT
-                c.name AS column_name,
-                t.name AS data_type,
-                c.max_length,
-                c.is_nullable,
-                CASE WHEN pk.column_id IS NOT NULL THEN 1 ELSE 0 END AS is_primary_key,
-                CAST(ep.value AS NVARCHAR(MAX)) AS comment
-            FROM sys.columns c
-            INNER JOIN sys.types t ON c.user_type_id = t.user_type_id
-            INNER JOIN sys.objects o ON c.object_id = o.object_id
-            INNER JOIN sys.schemas s ON o.schema_id = s.schema_id
-            LEFT JOIN (
-                SELECT ic.object_id, ic.column_id
-                FROM sys.index_columns ic
-                INNER JOIN sys.indexes i ON ic.object_id = i.object_id AND ic.index_id = i.index_id
-                WHERE i.is_primary_key = 1
-            ) pk ON c.object_id = pk.object_id AND c.column_id = pk.column_id
-            LEFT JOIN sys.extended_properties ep ON ep.major_id = c.object_id
-                AND ep.minor_id = c.column_id
-                AND ep.class = 1
-                AND ep.name = 'MS_Description'
-            WHERE o.name = '{}' AND s.name = '{}'
-            ORDER BY c.column_id
-        )",
-                                       escapeSqlString(tbl), escapeSqlString(schema));
-
-        auto columnResult = driver->execute(columnQuery);
-
-        auto jsonResponse = JsonUtils::buildRowArray(columnResult.rows, 5, [](std::string& out, const ResultRow& row) {
-            std::string_view sizeStr = row.values[2];
-            int colSize = 0;
-            std::from_chars(sizeStr.data(), sizeStr.data() + sizeStr.size(), colSize);
-            auto comment = row.values.size() >= 6 ? row.values[5] : std::string{};
-            auto nullable = row.values[3] == "1" ? "true" : "false";
-            auto isPk = row.values[4] == "1" ? "true" : "false";
-            out += std::format(R"({{"name":"{}","type":"{}","size":{},"nullable":{},"isPrimaryKey":{},"comment":"{}"}})", JsonUtils::escapeString(row.values[0]),
-                               JsonUtils::escapeString(row.values[1]), colSize, nullable, isPk, JsonUtils::escapeString(comment));
-        });
-        return JsonUtils::successResponse(jsonResponse);
+    try {
+        const auto startTime = std::chrono::steady_clock::now();
+        // Each side is one introspection batch on its own metadata driver; run them side by side
+        auto desiredLoad = std::async(std::launch::async, [&source = *desired] { return loadSchemaSource(source); });
+        SchemaSnapshot currentSnapshot;
+        try {
+            currentSnapshot = loadSchemaSource(*current);
+        } catch (...) {
+            desiredLoad.wait();
+            throw;
+        }
+        const auto desiredSnapshot = desiredLoad.get();
+        const auto introspectionMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+        const auto changes = diffSchemas(currentSnapshot, desiredSnapshot, options);
+        std::string json = R"({"changes":[)";
+        for (size_t i = 0; i < changes.size(); ++i) {
+            if (i > 0) {
+                json += ',';
+            }
+            json += std::format(R"({{"kind":"{}","object":"{}","sql":"{}"}})", schemaChangeKindName(changes[i].kind), JsonUtils::escapeString(changes[i].object),
+                                JsonUtils::escapeString(changes[i].sql));
+        }
+        json += std::format(R"(],"script":"{}","currentTables":{},"desiredTables":{},"introspectionMs":{}}})", JsonUtils::escapeString(migrationScript(changes)),
+                            currentSnapshot.tables.size(), desiredSnapshot.tables.size(), introspectionMs);
+        return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetIndexes(std::string_view params) {
+std::string SchemaProvider::handleExportSchemaDDL(const IPCParams& params) {
+    auto source = parseSchemaSource(params, "source", m_connections);
+    if (!source) [[unlikely]] {
+        return JsonUtils::errorResponse(source.error());
+    }
+    std::string filepath;
+    if (auto filepathResult = params["filepath"].get_string(); !filepathResult.error()) {
+        filepath = std::string(filepathResult.value());
+        if (filepath.find("..") != std::string::npos) [[unlikely]] {
+            return JsonUtils::errorResponse("Invalid file path");
+        }
+    }
+    SchemaDiffOptions options;
+    options.triggers = !source->diagram;
+
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
+        const auto snapshot = loadSchemaSource(*source);
+        if (filepath.empty()) {
+            const auto script = schemaScript(snapshot, options);
+            return JsonUtils::successResponse(std::format(R"({{"script":"{}","tables":{},"bytes":{}}})", JsonUtils::escapeString(script), snapshot.tables.size(), script.size()));
+        }
+        BufferedFileWriter writer;
+        if (!writer.open(filepath)) [[unlikely]] {
+            return JsonUtils::errorResponse("Failed to create file: " + filepath);
+        }
+        writeSchemaScript(snapshot, [&writer](std::string_view chunk) { writer.append(chunk); }, options);
+        const auto bytes = writer.bytesWritten();
+        if (!writer.close()) [[unlikely]] {
+            return JsonUtils::errorResponse("Failed to write file: " + filepath);
+        }
+        return JsonUtils::successResponse(std::format(R"({{"tables":{},"bytes":{}}})", snapshot.tables.size(), bytes));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
 
-        auto extracted = extractTableQueryParams(doc, m_connections);
+std::string SchemaProvider::handleGetColumns(const IPCParams& params) {
+    try {
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
-
-        auto indexQuery = std::format(R"(
-            SELECT
-                i.name AS IndexName,
-                i.type_desc AS IndexType,
-                i.is_unique AS IsUnique,
-                i.is_primary_key AS IsPrimaryKey,
-                STUFF((
-                    SELECT ',' + c.name
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto jsonResponse = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::Columns, [&] {
+            auto [schema, tbl] = splitSchemaTable(tableName);
+
+            constexpr std::string_view columnQuery = R"(
+                SELECT
+                    c.name AS column_name,
+                    t.name AS data_type,
+                    c.max_length,
+                    c.is_nullable,
+                    CASE WHEN pk.column_id IS NOT NULL THEN 1 ELSE 0 END AS is_primary_key,
+                    CAST(ep.value AS NVARCHAR(MAX)) AS comment
+                FROM sys.columns c
+                INNER JOIN sys.types t ON c.user_type_id = t.user_type_id
+                INNER JOIN sys.objects o ON c.object_id = o.object_id
+                INNER JOIN sys.schemas s ON o.schema_id = s.schema_id
+                LEFT JOIN (
+                    SELECT ic.object_id, ic.column_id
                     FROM sys.index_columns ic
-                    JOIN sys.columns c ON ic.object_id = c.object_id AND ic.column_id = c.column_id
-                    WHERE ic.object_id = i.object_id AND ic.index_id = i.index_id
-                    ORDER BY ic.key_ordinal
-                    FOR XML PATH('')
-                ), 1, 1, '') AS Columns
-            FROM sys.indexes i
-            WHERE i.object_id = OBJECT_ID('{}')
-              AND i.name IS NOT NULL
-            ORDER BY i.is_primary_key DESC, i.name
-        )",
-                                      escapeSqlString(tableName));
-
-        auto queryResult = driver->execute(indexQuery);
-
-        auto json = JsonUtils::buildRowArray(queryResult.rows, 5, [](std::string& out, const ResultRow& row) {
-            out += "{";
-            out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row.values[0]));
-            out += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row.values[1]));
-            out += std::format("\"isUnique\":{},", row.values[2] == "1" ? "true" : "false");
-            out += std::format("\"isPrimaryKey\":{},", row.values[3] == "1" ? "true" : "false");
-            out += "\"columns\":";
-            out += splitCsvToJsonArray(row.values[4]);
-            out += "}";
-        });
-        return JsonUtils::successResponse(json);
+                    INNER JOIN sys.indexes i ON ic.object_id = i.object_id AND ic.index_id = i.index_id
+                    WHERE i.is_primary_key = 1
+                ) pk ON c.object_id = pk.object_id AND c.column_id = pk.column_id
+                LEFT JOIN sys.extended_properties ep ON ep.major_id = c.object_id
+                    AND ep.minor_id = c.column_id
+                    AND ep.class = 1
+                    AND ep.name = 'MS_Description'
+                WHERE o.name = ? AND s.name = ?
+                ORDER BY c.column_id
+            )";
+
+            auto columnResult = driver->executePrepared(columnQuery, {tbl, schema});
+
+            return JsonUtils::buildRowArray(columnResult, 5, [](std::string& out, const RowView& row) {
+                const auto sizeStr = row[2];
+                int colSize = 0;
+                std::from_chars(sizeStr.data(), sizeStr.data() + sizeStr.size(), colSize);
+                auto comment = row.size() >= 6 ? row[5] : std::string{};
+                auto nullable = row[3] == "1" ? "true" : "false";
+                auto isPk = row[4] == "1" ? "true" : "false";
+                out += std::format(R"({{"name":"{}","type":"{}","size":{},"nullable":{},"isPrimaryKey":{},"comment":"{}"}})", JsonUtils::escapeString(row[0]),
+                                   JsonUtils::escapeString(row[1]), colSize, nullable, isPk, JsonUtils::escapeString(comment));
+            });
+        }, refreshRequested(params));
+        return JsonUtils::successResponse(jsonResponse);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetConstraints(std::string_view params) {
+std::string SchemaProvider::handleGetIndexes(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
-
-        auto extracted = extractTableQueryParams(doc, m_connections);
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
-        auto [cSchema, cTbl] = splitSchemaTable(tableName);
-
-        auto constraintQuery = std::format(R"(
-            SELECT
-                tc.CONSTRAINT_NAME,
-                tc.CONSTRAINT_TYPE,
-                STUFF((
-                    SELECT ',' + kcu.COLUMN_NAME
-                    FROM INFORMATION_SCHEMA.KEY_COLUMN_USAGE kcu
-                    WHERE kcu.CONSTRAINT_NAME = tc.CONSTRAINT_NAME
-                      AND kcu.TABLE_NAME = tc.TABLE_NAME
-                    ORDER BY kcu.ORDINAL_POSITION
-                    FOR XML PATH('')
-                ), 1, 1, '') AS Columns,
-                ISNULL(cc.CHECK_CLAUSE, dc.definition) AS Definition
-            FROM INFORMATION_SCHEMA.TABLE_CONSTRAINTS tc
-            LEFT JOIN INFORMATION_SCHEMA.CHECK_CONSTRAINTS cc
-                ON tc.CONSTRAINT_NAME = cc.CONSTRAINT_NAME
-            LEFT JOIN sys.default_constraints dc
-                ON dc.name = tc.CONSTRAINT_NAME
-            WHERE tc.TABLE_NAME = '{}' AND tc.TABLE_SCHEMA = '{}'
-            ORDER BY tc.CONSTRAINT_TYPE, tc.CONSTRAINT_NAME
-        )",
-                                           escapeSqlString(cTbl), escapeSqlString(cSchema));
-
-        auto queryResult = driver->execute(constraintQuery);
-
-        auto json = JsonUtils::buildRowArray(queryResult.rows, 4, [](std::string& out, const ResultRow& row) {
-            out += "{";
-            out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row.values[0]));
-            out += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row.values[1]));
-            out += "\"columns\":";
-            out += splitCsvToJsonArray(row.values[2]);
-            out += ",";
-            out += std::format("\"definition\":\"{}\"", JsonUtils::escapeString(row.values[3]));
-            out += "}";
-        });
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto json = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::Indexes, [&] {
+            constexpr std::string_view indexQuery = R"(
+                SELECT
+                    i.name AS IndexName,
+                    i.type_desc AS IndexType,
+                    i.is_unique AS IsUnique,
+                    i.is_primary_key AS IsPrimaryKey,
+                    STUFF((
+                        SELECT ',' + c.name
+                        FROM sys.index_columns ic
+                        JOIN sys.columns c ON ic.object_id = c.object_id AND ic.column_id = c.column_id
+                        WHERE ic.object_id = i.object_id AND ic.index_id = i.index_id
+                        ORDER BY ic.key_ordinal
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS Columns
+                FROM sys.indexes i
+                WHERE i.object_id = OBJECT_ID(?)
+                  AND i.name IS NOT NULL
+                ORDER BY i.is_primary_key DESC, i.name
+            )";
+
+            auto queryResult = driver->executePrepared(indexQuery, {tableName});
+
+            return JsonUtils::buildRowArray(queryResult, 5, [](std::string& out, const RowView& row) {
+                out += "{";
+                out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row[0]));
+                out += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row[1]));
+                out += std::format("\"isUnique\":{},", row[2] == "1" ? "true" : "false");
+                out += std::format("\"isPrimaryKey\":{},", row[3] == "1" ? "true" : "false");
+                out += "\"columns\":";
+                out += splitCsvToJsonArray(row[4]);
+                out += "}";
+            });
+        }, refreshRequested(params));
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetForeignKeys(std::string_view params) {
+std::string SchemaProvider::handleGetConstraints(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
-
-        auto extracted = extractTableQueryParams(doc, m_connections);
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
-
-        auto fkQuery = std::format(R"(
-            SELECT
-                fk.name AS FKName,
-                STUFF((
-                    SELECT ',' + COL_NAME(fkc.parent_object_id, fkc.parent_column_id)
-                    FROM sys.foreign_key_columns fkc
-                    WHERE fkc.constraint_object_id = fk.object_id
-                    ORDER BY fkc.constraint_column_id
-                    FOR XML PATH('')
-                ), 1, 1, '') AS Columns,
-                OBJECT_SCHEMA_NAME(fk.referenced_object_id) + '.' + OBJECT_NAME(fk.referenced_object_id) AS ReferencedTable,
-                STUFF((
-                    SELECT ',' + COL_NAME(fkc.referenced_object_id, fkc.referenced_column_id)
-                    FROM sys.foreign_key_columns fkc
-                    WHERE fkc.constraint_object_id = fk.object_id
-                    ORDER BY fkc.constraint_column_id
-                    FOR XML PATH('')
-                ), 1, 1, '') AS ReferencedColumns,
-                fk.delete_referential_action_desc AS OnDelete,
-                fk.update_referential_action_desc AS OnUpdate
-            FROM sys.foreign_keys fk
-            WHERE fk.parent_object_id = OBJECT_ID('{}')
-            ORDER BY fk.name
-        )",
-                                   escapeSqlString(tableName));
-
-        auto queryResult = driver->execute(fkQuery);
-
-        auto json = JsonUtils::buildRowArray(queryResult.rows, 6, [](std::string& out, const ResultRow& row) {
-            out += "{";
-            out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row.values[0]));
-            out += "\"columns\":";
-            out += splitCsvToJsonArray(row.values[1]);
-            out += ",";
-            out += std::format("\"referencedTable\":\"{}\",", JsonUtils::escapeString(row.values[2]));
-            out += "\"referencedColumns\":";
-            out += splitCsvToJsonArray(row.values[3]);
-            out += ",";
-            out += std::format("\"onDelete\":\"{}\",", JsonUtils::escapeString(row.values[4]));
-            out += std::format("\"onUpdate\":\"{}\"", JsonUtils::escapeString(row.values[5]));
-            out += "}";
-        });
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto json = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::Constraints, [&] {
+            auto [cSchema, cTbl] = splitSchemaTable(tableName);
+
+            constexpr std::string_view constraintQuery = R"(
+                SELECT
+                    tc.CONSTRAINT_NAME,
+                    tc.CONSTRAINT_TYPE,
+                    STUFF((
+                        SELECT ',' + kcu.COLUMN_NAME
+                        FROM INFORMATION_SCHEMA.KEY_COLUMN_USAGE kcu
+                        WHERE kcu.CONSTRAINT_NAME = tc.CONSTRAINT_NAME
+                          AND kcu.TABLE_NAME = tc.TABLE_NAME
+                        ORDER BY kcu.ORDINAL_POSITION
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS Columns,
+                    ISNULL(cc.CHECK_CLAUSE, dc.definition) AS Definition
+                FROM INFORMATION_SCHEMA.TABLE_CONSTRAINTS tc
+                LEFT JOIN INFORMATION_SCHEMA.CHECK_CONSTRAINTS cc
+                    ON tc.CONSTRAINT_NAME = cc.CONSTRAINT_NAME
+                LEFT JOIN sys.default_constraints dc
+                    ON dc.name = tc.CONSTRAINT_NAME
+                WHERE tc.TABLE_NAME = ? AND tc.TABLE_SCHEMA = ?
+                ORDER BY tc.CONSTRAINT_TYPE, tc.CONSTRAINT_NAME
+            )";
+
+            auto queryResult = driver->executePrepared(constraintQuery, {cTbl, cSchema});
+
+            return JsonUtils::buildRowArray(queryResult, 4, [](std::string& out, const RowView& row) {
+                out += "{";
+                out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row[0]));
+                out += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row[1]));
+                out += "\"columns\":";
+                out += splitCsvToJsonArray(row[2]);
+                out += ",";
+                out += std::format("\"definition\":\"{}\"", JsonUtils::escapeString(row[3]));
+                out += "}";
+            });
+        }, refreshRequested(params));
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetReferencingForeignKeys(std::string_view params) {
+std::string SchemaProvider::handleGetForeignKeys(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
-
-        auto extracted = extractTableQueryParams(doc, m_connections);
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
-
-        auto refFkQuery = std::format(R"(
-            SELECT
-                fk.name AS FKName,
-                OBJECT_SCHEMA_NAME(fk.parent_object_id) + '.' + OBJECT_NAME(fk.parent_object_id) AS ReferencingTable,
-                STUFF((
-                    SELECT ',' + COL_NAME(fkc.parent_object_id, fkc.parent_column_id)
-                    FROM sys.foreign_key_columns fkc
-                    WHERE fkc.constraint_object_id = fk.object_id
-                    ORDER BY fkc.constraint_column_id
-                    FOR XML PATH('')
-                ), 1, 1, '') AS ReferencingColumns,
-                STUFF((
-                    SELECT ',' + COL_NAME(fkc.referenced_object_id, fkc.referenced_column_id)
-                    FROM sys.foreign_key_columns fkc
-                    WHERE fkc.constraint_object_id = fk.object_id
-                    ORDER BY fkc.constraint_column_id
-                    FOR XML PATH('')
-                ), 1, 1, '') AS Columns,
-                fk.delete_referential_action_desc AS OnDelete,
-                fk.update_referential_action_desc AS OnUpdate
-            FROM sys.foreign_keys fk
-            WHERE fk.referenced_object_id = OBJECT_ID('{}')
-            ORDER BY fk.name
-        )",
-                                      escapeSqlString(tableName));
-
-        auto queryResult = driver->execute(refFkQuery);
-
-        auto json = JsonUtils::buildRowArray(queryResult.rows, 6, [](std::string& out, const ResultRow& row) {
-            out += "{";
-            out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row.values[0]));
-            out += std::format("\"referencingTable\":\"{}\",", JsonUtils::escapeString(row.values[1]));
-            out += "\"referencingColumns\":";
-            out += splitCsvToJsonArray(row.values[2]);
-            out += ",";
-            out += "\"columns\":";
-            out += splitCsvToJsonArray(row.values[3]);
-            out += ",";
-            out += std::format("\"onDelete\":\"{}\",", JsonUtils::escapeString(row.values[4]));
-            out += std::format("\"onUpdate\":\"{}\"", JsonUtils::escapeString(row.values[5]));
-            out += "}";
-        });
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto json = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::ForeignKeys, [&] {
+            constexpr std::string_view fkQuery = R"(
+                SELECT
+                    fk.name AS FKName,
+                    STUFF((
+                        SELECT ',' + COL_NAME(fkc.parent_object_id, fkc.parent_column_id)
+                        FROM sys.foreign_key_columns fkc
+                        WHERE fkc.constraint_object_id = fk.object_id
+                        ORDER BY fkc.constraint_column_id
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS Columns,
+                    OBJECT_SCHEMA_NAME(fk.referenced_object_id) + '.' + OBJECT_NAME(fk.referenced_object_id) AS ReferencedTable,
+                    STUFF((
+                        SELECT ',' + COL_NAME(fkc.referenced_object_id, fkc.referenced_column_id)
+                        FROM sys.foreign_key_columns fkc
+                        WHERE fkc.constraint_object_id = fk.object_id
+                        ORDER BY fkc.constraint_column_id
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS ReferencedColumns,
+                    fk.delete_referential_action_desc AS OnDelete,
+                    fk.update_referential_action_desc AS OnUpdate
+                FROM sys.foreign_keys fk
+                WHERE fk.parent_object_id = OBJECT_ID(?)
+                ORDER BY fk.name
+            )";
+
+            auto queryResult = driver->executePrepared(fkQuery, {tableName});
+
+            return JsonUtils::buildRowArray(queryResult, 6, [](std::string& out, const RowView& row) {
+                out += "{";
+                out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row[0]));
+                out += "\"columns\":";
+                out += splitCsvToJsonArray(row[1]);
+                out += ",";
+                out += std::format("\"referencedTable\":\"{}\",", JsonUtils::escapeString(row[2]));
+                out += "\"referencedColumns\":";
+                out += splitCsvToJsonArray(row[3]);
+                out += ",";
+                out += std::format("\"onDelete\":\"{}\",", JsonUtils::escapeString(row[4]));
+                out += std::format("\"onUpdate\":\"{}\"", JsonUtils::escapeString(row[5]));
+                out += "}";
+            });
+        }, refreshRequested(params));
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetTriggers(std::string_view params) {
+std::string SchemaProvider::handleGetReferencingForeignKeys(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
-
-        auto extracted = extractTableQueryParams(doc, m_connections);
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
-
-        auto triggerQuery = std::format(R"(
-            SELECT
-                t.name AS TriggerName,
-                CASE WHEN t.is_instead_of_trigger = 1 THEN 'INSTEAD OF' ELSE 'AFTER' END AS TriggerType,
-                STUFF((
-                    SELECT ',' + CASE te.type WHEN 1 THEN 'INSERT' WHEN 2 THEN 'UPDATE' WHEN 3 THEN 'DELETE' END
-                    FROM sys.trigger_events te
-                    WHERE te.object_id = t.object_id
-                    FOR XML PATH('')
-                ), 1, 1, '') AS Events,
-                CASE WHEN t.is_disabled = 0 THEN 1 ELSE 0 END AS IsEnabled,
-                OBJECT_DEFINITION(t.object_id) AS Definition
-            FROM sys.triggers t
-            WHERE t.parent_id = OBJECT_ID('{}')
-            ORDER BY t.name
-        )",
-                                        escapeSqlString(tableName));
-
-        auto queryResult = driver->execute(triggerQuery);
-
-        auto json = JsonUtils::buildRowArray(queryResult.rows, 5, [](std::string& out, const ResultRow& row) {
-            out += "{";
-            out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row.values[0]));
-            out += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row.values[1]));
-            out += "\"events\":";
-            out += splitCsvToJsonArray(row.values[2]);
-            out += ",";
-            out += std::format("\"isEnabled\":{},", row.values[3] == "1" ? "true" : "false");
-            out += std::format("\"definition\":\"{}\"", JsonUtils::escapeString(row.values[4]));
-            out += "}";
-        });
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto json = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::ReferencingForeignKeys, [&] {
+            constexpr std::string_view refFkQuery = R"(
+                SELECT
+                    fk.name AS FKName,
+                    OBJECT_SCHEMA_NAME(fk.parent_object_id) + '.' + OBJECT_NAME(fk.parent_object_id) AS ReferencingTable,
+                    STUFF((
+                        SELECT ',' + COL_NAME(fkc.parent_object_id, fkc.parent_column_id)
+                        FROM sys.foreign_key_columns fkc
+                        WHERE fkc.constraint_object_id = fk.object_id
+                        ORDER BY fkc.constraint_column_id
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS ReferencingColumns,
+                    STUFF((
+                        SELECT ',' + COL_NAME(fkc.referenced_object_id, fkc.referenced_column_id)
+                        FROM sys.foreign_key_columns fkc
+                        WHERE fkc.constraint_object_id = fk.object_id
+                        ORDER BY fkc.constraint_column_id
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS Columns,
+                    fk.delete_referential_action_desc AS OnDelete,
+                    fk.update_referential_action_desc AS OnUpdate
+                FROM sys.foreign_keys fk
+                WHERE fk.referenced_object_id = OBJECT_ID(?)
+                ORDER BY fk.name
+            )";
+
+            auto queryResult = driver->executePrepared(refFkQuery, {tableName});
+
+            return JsonUtils::buildRowArray(queryResult, 6, [](std::string& out, const RowView& row) {
+                out += "{";
+                out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row[0]));
+                out += std::format("\"referencingTable\":\"{}\",", JsonUtils::escapeString(row[1]));
+                out += "\"referencingColumns\":";
+                out += splitCsvToJsonArray(row[2]);
+                out += ",";
+                out += "\"columns\":";
+                out += splitCsvToJsonArray(row[3]);
+                out += ",";
+                out += std::format("\"onDelete\":\"{}\",", JsonUtils::escapeString(row[4]));
+                out += std::format("\"onUpdate\":\"{}\"", JsonUtils::escapeString(row[5]));
+                out += "}";
+            });
+        }, refreshRequested(params));
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetTableMetadata(std::string_view params) {
+std::string SchemaProvider::handleGetTriggers(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
+        auto extracted = extractTableQueryParams(params, m_connections);
+        if (!extracted) [[unlikely]]
+            return JsonUtils::errorResponse(extracted.error());
+
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto json = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::Triggers, [&] {
+            constexpr std::string_view triggerQuery = R"(
+                SELECT
+                    t.name AS TriggerName,
+                    CASE WHEN t.is_instead_of_trigger = 1 THEN 'INSTEAD OF' ELSE 'AFTER' END AS TriggerType,
+                    STUFF((
+                        SELECT ',' + CASE te.type WHEN 1 THEN 'INSERT' WHEN 2 THEN 'UPDATE' WHEN 3 THEN 'DELETE' END
+                        FROM sys.trigger_events te
+                        WHERE te.object_id = t.object_id
+                        FOR XML PATH('')
+                    ), 1, 1, '') AS Events,
+                    CASE WHEN t.is_disabled = 0 THEN 1 ELSE 0 END AS IsEnabled,
+                    OBJECT_DEFINITION(t.object_id) AS Definition
+                FROM sys.triggers t
+                WHERE t.parent_id = OBJECT_ID(?)
+                ORDER BY t.name
+            )";
+
+            auto queryResult = driver->executePrepared(triggerQuery, {tableName});
+
+            return JsonUtils::buildRowArray(queryResult, 5, [](std::string& out, const RowView& row) {
+                out += "{";
+                out += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row[0]));
+                out += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row[1]));
+                out += "\"events\":";
+                out += splitCsvToJsonArray(row[2]);
+                out += ",";
+                out += std::format("\"isEnabled\":{},", row[3] == "1" ? "true" : "false");
+                out += std::format("\"definition\":\"{}\"", JsonUtils::escapeString(row[4]));
+                out += "}";
+            });
+        }, refreshRequested(params));
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
 
-        auto extracted = extractTableQueryParams(doc, m_connections);
+std::string SchemaProvider::handleGetTableMetadata(const IPCParams& params) {
+    try {
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
+        auto& [connectionId, tableName, driver] = *extracted;
 
-        auto metadataQuery = std::format(R"(
+        constexpr std::string_view metadataQuery = R"(
             SELECT
                 OBJECT_SCHEMA_NAME(o.object_id) AS SchemaName,
                 o.name AS TableName,
@@ -467,138 +779,63 @@ std::string SchemaProvider::handleGetTableMetadata(std::string_view params) {
             FROM sys.objects o
             LEFT JOIN sys.partitions p ON o.object_id = p.object_id AND p.index_id IN (0, 1)
             LEFT JOIN sys.extended_properties ep ON ep.major_id = o.object_id AND ep.minor_id = 0 AND ep.name = 'MS_Description'
-            WHERE o.object_id = OBJECT_ID('{}')
-        )",
-                                         escapeSqlString(tableName));
+            WHERE o.object_id = OBJECT_ID(?)
+        )";
 
-        auto queryResult = driver->execute(metadataQuery);
+        auto queryResult = driver->executePrepared(metadataQuery, {tableName});
 
-        if (queryResult.rows.empty()) {
+        if (queryResult.empty()) {
             return JsonUtils::errorResponse("Table not found");
         }
 
-        const auto& row = queryResult.rows[0];
-        if (row.values.size() < 8) {
+        const auto row = queryResult.row(0);
+        if (row.size() < 8) {
             return JsonUtils::errorResponse("Unexpected column count in metadata result");
         }
         std::string json = "{";
-        json += std::format("\"schema\":\"{}\",", JsonUtils::escapeString(row.values[0]));
-        json += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row.values[1]));
-        json += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row.values[2]));
-        json += std::format("\"rowCount\":{},", row.values[3]);
-        json += std::format("\"createdAt\":\"{}\",", JsonUtils::escapeString(row.values[4]));
-        json += std::format("\"modifiedAt\":\"{}\",", JsonUtils::escapeString(row.values[5]));
-        json += std::format("\"owner\":\"{}\",", JsonUtils::escapeString(row.values[6]));
-        json += std::format("\"comment\":\"{}\"", JsonUtils::escapeString(row.values[7]));
+        json += std::format("\"schema\":\"{}\",", JsonUtils::escapeString(row[0]));
+        json += std::format("\"name\":\"{}\",", JsonUtils::escapeString(row[1]));
+        json += std::format("\"type\":\"{}\",", JsonUtils::escapeString(row[2]));
+        json += std::format("\"rowCount\":{},", row[3]);
+        json += std::format("\"createdAt\":\"{}\",", JsonUtils::escapeString(row[4]));
+        json += std::format("\"modifiedAt\":\"{}\",", JsonUtils::escapeString(row[5]));
+        json += std::format("\"owner\":\"{}\",", JsonUtils::escapeString(row[6]));
+        json += std::format("\"comment\":\"{}\"", JsonUtils::escapeString(row[7]));
         json += "}";
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetTableDDL(std::string_view params) {
+std::string SchemaProvider::handleGetTableDDL(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params).value();
-
-        auto extracted = extractTableQueryParams(doc, m_connections);
+        auto extracted = extractTableQueryParams(params, m_connections);
         if (!extracted) [[unlikely]]
             return JsonUtils::errorResponse(extracted.error());
 
-        auto& [tableName, driver] = *extracted;
-        auto [ddlSchema, ddlTbl] = splitSchemaTable(tableName);
-
-        auto columnQuery = std::format(R"(
-            SELECT
-                c.COLUMN_NAME,
-                c.DATA_TYPE,
-                c.CHARACTER_MAXIMUM_LENGTH,
-                c.NUMERIC_PRECISION,
-                c.NUMERIC_SCALE,
-                c.IS_NULLABLE,
-                c.COLUMN_DEFAULT
-            FROM INFORMATION_SCHEMA.COLUMNS c
-            WHERE c.TABLE_NAME = '{}' AND c.TABLE_SCHEMA = '{}'
-            ORDER BY c.ORDINAL_POSITION
-        )",
-                                       escapeSqlString(ddlTbl), escapeSqlString(ddlSchema));
-
-        auto columnResult = driver->execute(columnQuery);
-
-        auto sanitizedTable = quoteBracketIdentifier(tableName);
-        std::string ddl = "CREATE TABLE " + sanitizedTable + " (\n";
-        bool first = true;
-        for (const auto& row : columnResult.rows) {
-            if (row.values.size() < 7)
-                continue;
-            if (!first)
-                ddl += ",\n";
-            first = false;
-            ddl += "    " + quoteBracketIdentifier(row.values[0]) + " " + row.values[1];
-            if (!row.values[2].empty() && row.values[2] != "-1") {
-                ddl += "(" + row.values[2] + ")";
-            } else if (!row.values[3].empty() && row.values[3] != "0") {
-                ddl += "(" + row.values[3];
-                if (!row.values[4].empty() && row.values[4] != "0")
-                    ddl += "," + row.values[4];
-                ddl += ")";
-            }
-            if (row.values[5] == "NO")
-                ddl += " NOT NULL";
-            if (!row.values[6].empty())
-                ddl += " DEFAULT " + row.values[6];
-        }
-
-        auto pkQuery = std::format(R"(
-            SELECT COLUMN_NAME
-            FROM INFORMATION_SCHEMA.KEY_COLUMN_USAGE
-            WHERE TABLE_NAME = '{}' AND TABLE_SCHEMA = '{}'
-              AND CONSTRAINT_NAME = (
-                  SELECT CONSTRAINT_NAME
-                  FROM INFORMATION_SCHEMA.TABLE_CONSTRAINTS
-                  WHERE TABLE_NAME = '{}' AND TABLE_SCHEMA = '{}' AND CONSTRAINT_TYPE = 'PRIMARY KEY'
-              )
-            ORDER BY ORDINAL_POSITION
-        )",
-                                   escapeSqlString(ddlTbl), escapeSqlString(ddlSchema), escapeSqlString(ddlTbl), escapeSqlString(ddlSchema));
-
-        auto pkResult = driver->execute(pkQuery);
-        if (!pkResult.rows.empty()) {
-            ddl += ",\n    CONSTRAINT " + quoteBracketIdentifier("PK_" + tableName) + " PRIMARY KEY (";
-            bool pkFirst = true;
-            for (const auto& row : pkResult.rows) {
-                if (row.values.empty())
-                    continue;
-                if (!pkFirst)
-                    ddl += ", ";
-                pkFirst = false;
-                ddl += quoteBracketIdentifier(row.values[0]);
-            }
-            ddl += ")";
-        }
-        ddl += "\n);";
-
-        return JsonUtils::successResponse(std::format("{{\"ddl\":\"{}\"}}", JsonUtils::escapeString(ddl)));
+        auto& [connectionId, tableName, driver] = *extracted;
+        auto json = m_schemaCache->fragment(connectionId, driver, tableName, SchemaCache::Fragment::DDL, [&] {
+            auto [ddlSchema, ddlTbl] = splitSchemaTable(tableName);
+            return std::format("{{\"ddl\":\"{}\"}}", JsonUtils::escapeString(loadTableDDL(*driver, ddlSchema, ddlTbl)));
+        }, refreshRequested(params));
+        return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
-std::string SchemaProvider::handleGetExecutionPlan(std::string_view params) {
+std::string SchemaProvider::handleGetExecutionPlan(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto sqlQueryResult = doc["sql"].get_string();
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlQueryResult = params["sql"].get_string();
         if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or sql");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto sqlQuery = std::string(sqlQueryResult.value());
         bool actualPlan = false;
-        if (auto actual = doc["actual"].get_bool(); !actual.error())
+        if (auto actual = params["actual"].get_bool(); !actual.error())
             actualPlan = actual.value();
 
         auto driver = m_connections.getQueryDriver(connectionId);
@@ -606,29 +843,208 @@ std::string SchemaProvider::handleGetExecutionPlan(std::string_view params) {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
 
-        std::string planQuery;
+        size_t hotspotCount = ShowplanParser::DEFAULT_HOTSPOTS;
+        if (auto top = params["top"].get_uint64(); !top.error())
+            hotspotCount = static_cast<size_t>(top.value());
+
+        // Taken before the plan so a schema change racing the explain makes the next call miss, not this one stick
+        const auto queryHash = PlanCache::queryHash(sqlQuery);
+        const auto schemaStamp = schemaStampOf(*driver);
+        const auto respond = [&](const CachedPlan& cached, bool hit) {
+            return JsonUtils::successResponse(std::format(R"({{"plan":{},"actual":{},"planId":"{}","previousPlanId":"{}","cached":{},"fingerprint":"{:016x}"}})", cached.json,
+                                                          cached.actual ? "true" : "false", cached.id, m_planCache->previousId(cached.id), hit ? "true" : "false", cached.queryHash));
+        };
+        if (!actualPlan && !refreshRequested(params)) {
+            if (auto cached = m_planCache->lookup(connectionId, queryHash, schemaStamp, hotspotCount))
+                return respond(*cached, true);
+        }
+
+        // Both modes return showplan XML, parsed here so the frontend only receives the operator tree
+        std::vector<ResultSet> results;
         if (actualPlan) {
-            planQuery = std::format("SET STATISTICS XML ON;\n{}\nSET STATISTICS XML OFF;", sqlQuery);
+            results = driver->executeMultiple(std::format("SET STATISTICS XML ON;\n{}\nSET STATISTICS XML OFF;", sqlQuery));
         } else {
-            planQuery = std::format("SET SHOWPLAN_TEXT ON;\n{}\nSET SHOWPLAN_TEXT OFF;", sqlQuery);
+            ShowplanSession showplan(*driver);
+            results = driver->executeMultiple(sqlQuery);
+        }
+
+        // STATISTICS XML interleaves the query's own results with one single-column plan result per statement
+        std::vector<std::string_view> documents;
+        for (const auto& result : results) {
+            if (result.columns.size() != 1 || !result.columns.front().name.contains("Showplan"))
+                continue;
+            const auto& column = result.columnData.front();
+            if (column.type() != ColumnDataType::Text)
+                continue;
+            for (size_t row = 0; row < column.size(); ++row) {
+                if (!column.isNull(row))
+                    documents.push_back(column.textAt(row));
+            }
+        }
+        if (documents.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("The server returned no execution plan");
         }
 
-        auto queryResult = driver->execute(planQuery);
+        auto plan = std::make_shared<const ExecutionPlan>(ShowplanParser::parse(documents, hotspotCount));
+        auto planJson = ShowplanParser::toJson(*plan);
+        auto stored = m_planCache->store(CachedPlan{.connectionId = connectionId,
+                                                    .queryHash = queryHash,
+                                                    .sql = std::move(sqlQuery),
+                                                    .actual = actualPlan,
+                                                    .hotspotCount = hotspotCount,
+                                                    .schemaStamp = schemaStamp,
+                                                    .plan = std::move(plan),
+                                                    .json = std::move(planJson)});
+        return respond(*stored, false);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
 
-        std::string planText;
-        for (const auto& row : queryResult.rows) {
-            for (const auto& value : row.values) {
-                if (!planText.empty())
-                    planText += "\n";
-                planText += value;
+std::string SchemaProvider::handleDiffExecutionPlans(const IPCParams& params) {
+    try {
+        std::shared_ptr<const CachedPlan> before;
+        std::shared_ptr<const CachedPlan> after;
+        auto beforeIdResult = params["beforePlanId"].get_string();
+        auto afterIdResult = params["afterPlanId"].get_string();
+        if (!beforeIdResult.error() && !afterIdResult.error()) {
+            before = m_planCache->find(beforeIdResult.value());
+            after = m_planCache->find(afterIdResult.value());
+            if (!before || !after) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Plan not found: {}", before ? afterIdResult.value() : beforeIdResult.value()));
+            }
+        } else {
+            auto connectionIdResult = params["connectionId"].get_string();
+            auto sqlQueryResult = params["sql"].get_string();
+            if (connectionIdResult.error() || sqlQueryResult.error()) [[unlikely]] {
+                return JsonUtils::errorResponse("Missing required fields: beforePlanId and afterPlanId, or connectionId and sql");
+            }
+            auto history = m_planCache->history(connectionIdResult.value(), PlanCache::queryHash(sqlQueryResult.value()));
+            if (history.size() < 2) [[unlikely]] {
+                return JsonUtils::errorResponse("Fewer than two plans of this query were fetched on the connection");
             }
+            after = std::move(history[0]);
+            before = std::move(history[1]);
         }
 
-        auto planJson = std::format(R"({{"plan":"{}","actual":{}}})", JsonUtils::escapeString(planText), actualPlan ? "true" : "false");
-        return JsonUtils::successResponse(planJson);
+        const auto side = [](const CachedPlan& cached) {
+            const auto capturedAt = std::chrono::duration_cast<std::chrono::milliseconds>(cached.capturedAt.time_since_epoch()).count();
+            return std::format(R"({{"planId":"{}","actual":{},"capturedAt":{},"plan":{}}})", cached.id, cached.actual ? "true" : "false", capturedAt, cached.json);
+        };
+        return JsonUtils::successResponse(std::format(R"({{"before":{},"after":{},"diff":{}}})", side(*before), side(*after), PlanDiff::toJson(PlanDiff::compare(*before->plan, *after->plan))));
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
+std::string SchemaProvider::handleGetQueryStoreInsights(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        if (connectionIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: connectionId");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+
+        QueryStoreInsights::Request request;
+        if (auto database = params["database"].get_string(); !database.error())
+            request.database = std::string(database.value());
+        if (auto window = params["windowMinutes"].get_int64(); !window.error())
+            request.windowMinutes = window.value();
+        if (auto top = params["top"].get_uint64(); !top.error())
+            request.top = static_cast<size_t>(top.value());
+        if (auto refresh = params["refresh"].get_string(); !refresh.error())
+            request.fullRefresh = refresh.value() == "full";
+        if (auto rankBy = params["rankBy"].get_string(); !rankBy.error()) {
+            auto ranking = QueryStoreInsights::parseRanking(rankBy.value());
+            if (!ranking) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Unknown rankBy: {}", rankBy.value()));
+            }
+            request.rankBy = *ranking;
+        }
+
+        auto driver = m_connections.getMetadataDriver(connectionId);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto report = m_queryStore->report(connectionId, *driver, request);
+        std::string json = std::format(R"({{"database":"{}","windowMinutes":{},"intervals":{},"trackedQueries":{},"incremental":{},"queries":[)", JsonUtils::escapeString(report.database),
+                                       report.windowMinutes, report.intervals, report.trackedQueries, report.incremental ? "true" : "false");
+        for (size_t i = 0; i < report.queries.size(); ++i) {
+            const auto& query = report.queries[i];
+            if (i > 0)
+                json += ',';
+            json += std::format(R"({{"queryId":{},"text":"{}","objectName":"{}","executions":{},"totalDurationMs":{:.3f},"avgDurationMs":{:.3f},"maxDurationMs":{:.3f},"avgCpuMs":{:.3f},)",
+                                query.queryId, JsonUtils::escapeString(query.text), JsonUtils::escapeString(query.objectName), query.executions, query.totalDurationMs, query.avgDurationMs,
+                                query.maxDurationMs, query.avgCpuMs);
+            json += std::format(R"("avgLogicalReads":{:.1f},"planCount":{},"planId":{},"regressed":{},"previousPlanId":{},"previousAvgDurationMs":{:.3f},"regressionRatio":{:.2f}}})",
+                                query.avgLogicalReads, query.planCount, query.planId, query.regressed ? "true" : "false", query.previousPlanId, query.previousAvgDurationMs,
+                                query.regressionRatio);
+        }
+        json += std::format(R"(],"executionTimeMs":{:.2f}}})", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::string SchemaProvider::handleGetIndexAdvice(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        if (connectionIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: connectionId");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        std::string database;
+        if (auto databaseResult = params["database"].get_string(); !databaseResult.error())
+            database = std::string(databaseResult.value());
+
+        auto driver = m_connections.getMetadataDriver(connectionId);
+        if (!driver) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto advice = IndexAdvisor::advise(*driver, database);
+        const auto columnList = [](const std::vector<std::string>& columns) {
+            std::string list = "[";
+            for (size_t i = 0; i < columns.size(); ++i) {
+                if (i > 0)
+                    list += ',';
+                list += std::format(R"("{}")", JsonUtils::escapeString(columns[i]));
+            }
+            list += ']';
+            return list;
+        };
+
+        std::string json = std::format(R"({{"uptimeHours":{},"suggestions":[)", advice.uptimeHours);
+        for (size_t i = 0; i < advice.suggestions.size(); ++i) {
+            const auto& suggestion = advice.suggestions[i];
+            if (i > 0)
+                json += ',';
+            json += std::format(R"({{"schema":"{}","table":"{}","equalityColumns":{},"inequalityColumns":{},"includedColumns":{},"seeks":{},"scans":{},)",
+                                JsonUtils::escapeString(suggestion.schema), JsonUtils::escapeString(suggestion.table), columnList(suggestion.equalityColumns),
+                                columnList(suggestion.inequalityColumns), columnList(suggestion.includedColumns), suggestion.seeks, suggestion.scans);
+            json += std::format(R"("avgUserImpact":{:.2f},"improvement":{:.2f},"extends":"{}","createStatement":"{}"}})", suggestion.avgUserImpact, suggestion.improvement,
+                                JsonUtils::escapeString(suggestion.extends), JsonUtils::escapeString(suggestion.createStatement));
+        }
+        json += R"(],"findings":[)";
+        for (size_t i = 0; i < advice.findings.size(); ++i) {
+            const auto& finding = advice.findings[i];
+            static constexpr std::string_view KINDS[] = {"duplicate", "redundant", "unused"};
+            if (i > 0)
+                json += ',';
+            json += std::format(R"({{"kind":"{}","schema":"{}","table":"{}","index":"{}","coveredBy":"{}","reads":{},"writes":{},"sizeKb":{},"dropStatement":"{}"}})",
+                                KINDS[static_cast<size_t>(finding.kind)], JsonUtils::escapeString(finding.schema), JsonUtils::escapeString(finding.table),
+                                JsonUtils::escapeString(finding.index), JsonUtils::escapeString(finding.coveredBy), finding.reads, finding.writes, finding.sizeKb,
+                                JsonUtils::escapeString(finding.dropStatement));
+        }
+        json += std::format(R"(],"executionTimeMs":{:.2f}}})", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
 }  // namespace velocitydb
@@ -3,12 +3,18 @@
 #include "../interfaces/providers/schema_provider.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace velocitydb {
 
 class IConnectionProvider;
+class PlanCache;
+class QueryStoreInsights;
+class SchemaCache;
 class SchemaInspector;
 
 /// Provider for database schema inspection
@@ -22,21 +28,50 @@ public:
     SchemaProvider(SchemaProvider&&) = delete;
     SchemaProvider& operator=(SchemaProvider&&) = delete;
 
-    [[nodiscard]] std::string handleGetDatabases(std::string_view params) override;
-    [[nodiscard]] std::string handleGetTables(std::string_view params) override;
-    [[nodiscard]] std::string handleGetColumns(std::string_view params) override;
-    [[nodiscard]] std::string handleGetIndexes(std::string_view params) override;
-    [[nodiscard]] std::string handleGetConstraints(std::string_view params) override;
-    [[nodiscard]] std::string handleGetForeignKeys(std::string_view params) override;
-    [[nodiscard]] std::string handleGetReferencingForeignKeys(std::string_view params) override;
-    [[nodiscard]] std::string handleGetTriggers(std::string_view params) override;
-    [[nodiscard]] std::string handleGetTableMetadata(std::string_view params) override;
-    [[nodiscard]] std::string handleGetTableDDL(std::string_view params) override;
-    [[nodiscard]] std::string handleGetExecutionPlan(std::string_view params) override;
+    [[nodiscard]] std::string handleGetDatabases(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetTables(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetSchemaSnapshot(const IPCParams& params) override;
+    [[nodiscard]] std::string handleSaveSchemaSnapshot(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCompareSchemas(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetERModel(const IPCParams& params) override;
+    [[nodiscard]] std::string handleExportSchemaDDL(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetColumns(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetIndexes(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetConstraints(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetForeignKeys(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetReferencingForeignKeys(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetTriggers(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetTableMetadata(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetTableDDL(const IPCParams& params) override;
+    /// Params: connectionId, sql, actual, top, refresh. Estimated plans are answered from the plan cache while the
+    /// schema stamp is unchanged; every plan fetched is kept for handleDiffExecutionPlans
+    [[nodiscard]] std::string handleGetExecutionPlan(const IPCParams& params) override;
+    /// Params: beforePlanId and afterPlanId, or connectionId and sql for the two newest plans of that query
+    [[nodiscard]] std::string handleDiffExecutionPlans(const IPCParams& params) override;
+    /// Params: connectionId, database (default: current), windowMinutes (default 1440), rankBy
+    /// (duration|cpu|reads|executions|regression), top, refresh:"full". Read on the metadata connection and
+    /// cached per connection and database; later calls only read the newest Query Store intervals
+    [[nodiscard]] std::string handleGetQueryStoreInsights(const IPCParams& params) override;
+    /// Params: connectionId, database (default: current). One batch on the metadata connection
+    [[nodiscard]] std::string handleGetIndexAdvice(const IPCParams& params) override;
+
+    void prefetchSchema(std::string_view connectionId, std::vector<std::string> priorityNodes) override;
+    void cleanupConnection(const IPCParams& params) override;
+    bool withObjectNames(std::string_view connectionId, const std::function<void(const ObjectNameIndex&)>& use) override;
 
 private:
+    struct PrefetchJob;
+
+    /// Cancel and wait for `job` (m_prefetchMutex not held)
+    static void stopPrefetch(PrefetchJob& job);
+
     IConnectionProvider& m_connections;
     std::unique_ptr<SchemaInspector> m_schemaInspector;
+    std::unique_ptr<SchemaCache> m_schemaCache;
+    std::unique_ptr<QueryStoreInsights> m_queryStore;
+    std::unique_ptr<PlanCache> m_planCache;
+    std::mutex m_prefetchMutex;
+    std::unordered_map<std::string, std::shared_ptr<PrefetchJob>> m_prefetchJobs;  // Stopped before m_schemaCache goes
 };
 
 }  // namespace velocitydb
@@ -1,95 +1,284 @@
 #include "search_provider.h"
 
+#include "../database/instance_search.h"
 #include "../database/sqlserver_driver.h"
 #include "../interfaces/providers/connection_provider.h"
+#include "../interfaces/providers/query_provider.h"
+#include "../interfaces/providers/schema_provider.h"
+#include "../parsers/sql_completer.h"
 #include "../utils/global_search.h"
 #include "../utils/json_utils.h"
 #include "simdjson.h"
 
+#include <algorithm>
 #include <format>
+#include <stdexcept>
+#include <vector>
 
 namespace velocitydb {
 
-SearchProvider::SearchProvider(IConnectionProvider& connections) : m_connections(connections), m_globalSearch(std::make_unique<GlobalSearch>()) {}
+namespace {
+
+SearchOptions parseSearchOptions(const IPCParams& params) {
+    SearchOptions options{};
+    if (auto val = params["searchTables"].get_bool(); !val.error())
+        options.searchTables = val.value();
+    if (auto val = params["searchViews"].get_bool(); !val.error())
+        options.searchViews = val.value();
+    if (auto val = params["searchProcedures"].get_bool(); !val.error())
+        options.searchProcedures = val.value();
+    if (auto val = params["searchFunctions"].get_bool(); !val.error())
+        options.searchFunctions = val.value();
+    if (auto val = params["searchColumns"].get_bool(); !val.error())
+        options.searchColumns = val.value();
+    if (auto val = params["searchIndexes"].get_bool(); !val.error())
+        options.searchIndexes = val.value();
+    if (auto val = params["caseSensitive"].get_bool(); !val.error())
+        options.caseSensitive = val.value();
+    if (auto val = params["fuzzy"].get_bool(); !val.error())
+        options.fuzzy = val.value();
+    if (auto val = params["maxResults"].get_int64(); !val.error())
+        options.maxResults = static_cast<int>(val.value());
+    return options;
+}
+
+void appendSearchResult(std::string& out, const SearchResult& r) {
+    out += std::format(R"({{"objectType":"{}","schemaName":"{}","objectName":"{}","parentName":"{}"}})", JsonUtils::escapeString(r.objectType), JsonUtils::escapeString(r.schemaName),
+                       JsonUtils::escapeString(r.objectName), JsonUtils::escapeString(r.parentName));
+}
+
+}  // namespace
+
+SearchProvider::SearchProvider(IConnectionProvider& connections, ISchemaProvider& schema, IQueryProvider& queries)
+    : m_connections(connections), m_schema(schema), m_queries(queries), m_globalSearch(std::make_unique<GlobalSearch>()) {}
 
 SearchProvider::~SearchProvider() = default;
 
-std::string SearchProvider::handleSearchObjects(std::string_view params) {
+std::string SearchProvider::handleSearchObjects(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto patternResult = doc["pattern"].get_string();
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto patternResult = params["pattern"].get_string();
         if (connectionIdResult.error() || patternResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or pattern");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto pattern = std::string(patternResult.value());
+        const auto options = parseSearchOptions(params);
 
-        auto driver = m_connections.getMetadataDriver(connectionId);
-        if (!driver) [[unlikely]] {
+        std::vector<SearchResult> results;
+        if (!m_schema.withObjectNames(connectionId, [&](const ObjectNameIndex& names) { results = m_globalSearch->searchObjects(names, pattern, options); })) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
 
-        SearchOptions options{};
-        if (auto val = doc["searchTables"].get_bool(); !val.error())
-            options.searchTables = val.value();
-        if (auto val = doc["searchViews"].get_bool(); !val.error())
-            options.searchViews = val.value();
-        if (auto val = doc["searchProcedures"].get_bool(); !val.error())
-            options.searchProcedures = val.value();
-        if (auto val = doc["searchFunctions"].get_bool(); !val.error())
-            options.searchFunctions = val.value();
-        if (auto val = doc["searchColumns"].get_bool(); !val.error())
-            options.searchColumns = val.value();
-        if (auto val = doc["caseSensitive"].get_bool(); !val.error())
-            options.caseSensitive = val.value();
-        if (auto val = doc["maxResults"].get_int64(); !val.error())
-            options.maxResults = static_cast<int>(val.value());
-
-        auto results = m_globalSearch->searchObjects(driver.get(), pattern, options);
-
-        auto json = JsonUtils::buildArray(results, [](std::string& out, const SearchResult& r) {
-            out += std::format(R"({{"objectType":"{}","schemaName":"{}","objectName":"{}","parentName":"{}"}})", JsonUtils::escapeString(r.objectType), JsonUtils::escapeString(r.schemaName),
-                               JsonUtils::escapeString(r.objectName), JsonUtils::escapeString(r.parentName));
-        });
+        return JsonUtils::successResponse(JsonUtils::buildArray(results, appendSearchResult));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
 
-        return JsonUtils::successResponse(json);
+std::string SearchProvider::handleStartInstanceSearch(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto patternResult = params["pattern"].get_string();
+        if (connectionIdResult.error() || patternResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId or pattern");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        auto pattern = std::string(patternResult.value());
+        const auto options = parseSearchOptions(params);
+        size_t parallelism = InstanceSearch::DEFAULT_PARALLELISM;
+        if (auto parallelismOpt = params["parallelism"].get_int64(); !parallelismOpt.error() && parallelismOpt.value() > 0) {
+            parallelism = static_cast<size_t>(parallelismOpt.value());
+        }
+
+        ResultSet databases;
+        {
+            auto lane = m_connections.acquireQueryLane(connectionId, true);
+            if (!lane) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+            }
+            databases = lane.driver()->execute(InstanceSearch::databasesQuery());
+        }
+
+        // The current database is answered by the name index (with fuzzy matches); the others read their catalogs
+        std::vector<DatabaseSearchOutcome> answered;
+        std::vector<std::string> remote;
+        for (size_t row = 0; row < databases.rowCount(); ++row) {
+            auto name = databases.cellText(row, 0);
+            if (databases.cellText(row, 1) != "1") {
+                remote.push_back(std::move(name));
+                continue;
+            }
+            DatabaseSearchOutcome outcome{.database = std::move(name), .success = true, .fromIndex = true};
+            if (!m_schema.withObjectNames(connectionId, [&](const ObjectNameIndex& names) { outcome.matches = m_globalSearch->searchObjects(names, pattern, options); })) [[unlikely]] {
+                return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+            }
+            answered.push_back(std::move(outcome));
+        }
+
+        const size_t total = answered.size() + remote.size();
+        auto search = std::make_shared<InstanceSearch>(
+            std::move(answered), std::move(remote),
+            [&connections = m_connections, connectionId, pattern, options](const std::string& database, size_t limit) {
+                const auto sql = InstanceSearch::buildQuery(database, pattern, options, limit);
+                if (sql.empty()) {
+                    return std::vector<SearchResult>{};
+                }
+                // Three-part catalog names: any session-independent lane serves any database
+                auto lane = connections.acquireQueryLane(connectionId, true);
+                if (!lane) [[unlikely]] {
+                    throw std::runtime_error(std::format("Connection not found: {}", connectionId));
+                }
+                return InstanceSearch::parseResults(lane.driver()->execute(sql), pattern, options.caseSensitive);
+            },
+            static_cast<size_t>((std::max)(options.maxResults, 0)), parallelism);
+
+        std::string searchId;
+        {
+            std::lock_guard lock(m_instanceSearchesMutex);
+            evictFinishedInstanceSearches();
+            searchId = std::format("search_{}", m_instanceSearchIdCounter++);
+            m_instanceSearches[searchId] = std::move(search);
+        }
+        return JsonUtils::successResponse(std::format(R"({{"searchId":"{}","total":{}}})", searchId, total));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::string SearchProvider::handleGetInstanceSearchProgress(const IPCParams& params) {
+    try {
+        auto searchIdResult = params["searchId"].get_string();
+        if (searchIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: searchId");
+        }
+        auto searchId = std::string(searchIdResult.value());
+        size_t since = 0;
+        if (auto sinceOpt = params["since"].get_int64(); !sinceOpt.error() && sinceOpt.value() > 0) {
+            since = static_cast<size_t>(sinceOpt.value());
+        }
+
+        auto search = findInstanceSearch(searchId);
+        if (!search) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Search not found: {}", searchId));
+        }
+
+        // Databases completed since the caller's last poll, so each one is sent once
+        auto progress = search->progress(since);
+        auto databases = JsonUtils::buildArray(progress.databases, [](std::string& out, const DatabaseSearchOutcome& outcome) {
+            out += std::format(R"({{"database":"{}","success":{},"fromIndex":{},"elapsedMs":{:.1f})", JsonUtils::escapeString(outcome.database), outcome.success ? "true" : "false",
+                               outcome.fromIndex ? "true" : "false", outcome.elapsedMs);
+            if (!outcome.message.empty()) {
+                out += std::format(R"(,"message":"{}")", JsonUtils::escapeString(outcome.message));
+            }
+            out += R"(,"results":)";
+            out += JsonUtils::buildArray(outcome.matches, appendSearchResult);
+            out += '}';
+        });
+        return JsonUtils::successResponse(std::format(R"({{"searchId":"{}","total":{},"completed":{},"matches":{},"done":{},"truncated":{},"elapsedMs":{:.1f},"databases":{}}})", searchId,
+                                                      progress.total, progress.completed, progress.matches, progress.done ? "true" : "false", progress.truncated ? "true" : "false",
+                                                      progress.elapsedMs, databases));
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string SearchProvider::handleQuickSearch(std::string_view params) {
+std::string SearchProvider::handleCancelInstanceSearch(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+        auto searchIdResult = params["searchId"].get_string();
+        if (searchIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: searchId");
+        }
 
-        auto connectionIdResult = doc["connectionId"].get_string();
-        auto prefixResult = doc["prefix"].get_string();
+        auto search = findInstanceSearch(searchIdResult.value());
+        bool cancelled = false;
+        if (search && !search->done()) {
+            search->cancel();
+            cancelled = true;
+        }
+        return JsonUtils::successResponse(std::format(R"({{"cancelled":{}}})", cancelled ? "true" : "false"));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string SearchProvider::handleQuickSearch(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto prefixResult = params["prefix"].get_string();
         if (connectionIdResult.error() || prefixResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required fields: connectionId or prefix");
         }
         auto connectionId = std::string(connectionIdResult.value());
         auto prefix = std::string(prefixResult.value());
         int limit = 20;
-        if (auto val = doc["limit"].get_int64(); !val.error())
+        if (auto val = params["limit"].get_int64(); !val.error())
             limit = static_cast<int>(val.value());
 
-        auto driver = m_connections.getMetadataDriver(connectionId);
-        if (!driver) [[unlikely]] {
+        std::vector<std::string> results;
+        if (!m_schema.withObjectNames(connectionId, [&](const ObjectNameIndex& names) { results = m_globalSearch->quickSearch(names, prefix, limit); })) [[unlikely]] {
             return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
         }
 
-        auto results = m_globalSearch->quickSearch(driver.get(), prefix, limit);
-
         auto json = JsonUtils::buildArray(results, [](std::string& out, const std::string& r) { out += std::format(R"("{}")", JsonUtils::escapeString(r)); });
 
         return JsonUtils::successResponse(json);
     } catch (const std::exception& e) {
-        return JsonUtils::errorResponse(e.what());
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
     }
 }
 
+std::string SearchProvider::handleComplete(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto sqlResult = params["sql"].get_string();
+        auto lineResult = params["line"].get_uint64();
+        auto columnResult = params["column"].get_uint64();
+        if (connectionIdResult.error() || sqlResult.error() || lineResult.error() || columnResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId, sql, line or column");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        auto sql = sqlResult.value();
+        size_t limit = 50;
+        if (auto val = params["limit"].get_uint64(); !val.error())
+            limit = static_cast<size_t>(val.value());
+
+        const auto scope = SqlCompleter::analyze(sql, SqlCompleter::offsetOf(sql, lineResult.value(), columnResult.value()));
+        std::vector<Completion> completions;
+        if (!m_schema.withObjectNames(connectionId, [&](const ObjectNameIndex& names) { completions = SqlCompleter::candidates(scope, names); })) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
+        }
+
+        std::vector<std::string> labels;
+        labels.reserve(completions.size());
+        for (const auto& completion : completions) {
+            labels.push_back(SqlCompleter::fold(completion.label));
+        }
+        const auto uses = m_queries.historyWordUses(labels);
+        for (size_t i = 0; i < completions.size(); ++i) {
+            completions[i].uses = uses[i];
+        }
+        SqlCompleter::rank(completions, limit);
+
+        auto items = JsonUtils::buildArray(completions, [](std::string& out, const Completion& c) {
+            out += std::format(R"({{"label":"{}","kind":"{}","detail":"{}"}})", JsonUtils::escapeString(c.label), SqlCompleter::kindName(c.kind), JsonUtils::escapeString(c.detail));
+        });
+        return JsonUtils::successResponse(
+            std::format(R"({{"context":"{}","prefix":"{}","items":{}}})", SqlCompleter::contextName(scope.context), JsonUtils::escapeString(scope.prefix), items));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what(), isConnectionLost(e));
+    }
+}
+
+std::shared_ptr<InstanceSearch> SearchProvider::findInstanceSearch(std::string_view searchId) const {
+    std::lock_guard lock(m_instanceSearchesMutex);
+    auto it = m_instanceSearches.find(std::string(searchId));
+    return it == m_instanceSearches.end() ? nullptr : it->second;
+}
+
+void SearchProvider::evictFinishedInstanceSearches() {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_instanceSearches, [&](const auto& entry) { return entry.second->done() && now - entry.second->endTime() > FINISHED_SEARCH_RETENTION; });
+}
+
 }  // namespace velocitydb
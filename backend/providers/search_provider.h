@@ -2,19 +2,25 @@
 
 #include "../interfaces/providers/search_provider.h"
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace velocitydb {
 
-class IConnectionProvider;
 class GlobalSearch;
+class IConnectionProvider;
+class InstanceSearch;
+class IQueryProvider;
+class ISchemaProvider;
 
-/// Provider for database object search operations
+/// Provider for database object search operations, answered from the schema cache's name index
 class SearchProvider : public ISearchProvider {
 public:
-    explicit SearchProvider(IConnectionProvider& connections);
+    SearchProvider(IConnectionProvider& connections, ISchemaProvider& schema, IQueryProvider& queries);
     ~SearchProvider() override;
 
     SearchProvider(const SearchProvider&) = delete;
@@ -22,12 +28,26 @@ public:
     SearchProvider(SearchProvider&&) = delete;
     SearchProvider& operator=(SearchProvider&&) = delete;
 
-    [[nodiscard]] std::string handleSearchObjects(std::string_view params) override;
-    [[nodiscard]] std::string handleQuickSearch(std::string_view params) override;
+    [[nodiscard]] std::string handleSearchObjects(const IPCParams& params) override;
+    [[nodiscard]] std::string handleQuickSearch(const IPCParams& params) override;
+    [[nodiscard]] std::string handleStartInstanceSearch(const IPCParams& params) override;
+    [[nodiscard]] std::string handleGetInstanceSearchProgress(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCancelInstanceSearch(const IPCParams& params) override;
+    [[nodiscard]] std::string handleComplete(const IPCParams& params) override;
 
 private:
+    [[nodiscard]] std::shared_ptr<InstanceSearch> findInstanceSearch(std::string_view searchId) const;
+    void evictFinishedInstanceSearches();  // Caller holds m_instanceSearchesMutex
+
     IConnectionProvider& m_connections;
+    ISchemaProvider& m_schema;
+    IQueryProvider& m_queries;
     std::unique_ptr<GlobalSearch> m_globalSearch;
+
+    static constexpr auto FINISHED_SEARCH_RETENTION = std::chrono::minutes{5};
+    mutable std::mutex m_instanceSearchesMutex;
+    std::unordered_map<std::string, std::shared_ptr<InstanceSearch>> m_instanceSearches;
+    size_t m_instanceSearchIdCounter = 1;  // guarded by m_instanceSearchesMutex
 };
 
 }  // namespace velocitydb
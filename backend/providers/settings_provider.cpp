@@ -50,6 +50,7 @@ struct ConnectionProfileResponse {
     std::string_view environment;
     std::string_view dbType;
     SshConfigResponse ssh;
+    ConnectionTuning tuning;
 };
 
 struct SessionStateResponse {
@@ -90,6 +91,7 @@ struct SessionStateResponse {
                 .privateKeyPath = p.ssh.privateKeyPath,
                 .savePassword = !p.ssh.encryptedPassword.empty() || !p.ssh.encryptedKeyPassphrase.empty(),
             },
+        .tuning = p.tuning,
     };
 }
 
@@ -129,7 +131,8 @@ struct glz::meta<velocitydb::dto::ConnectionProfileResponse> {
     using T = velocitydb::dto::ConnectionProfileResponse;
     static constexpr auto value =
         glz::object("id", &T::id, "name", &T::name, "server", &T::server, "port", &T::port, "database", &T::database, "username", &T::username, "useWindowsAuth", &T::useWindowsAuth, "savePassword",
-                    &T::savePassword, "isProduction", &T::isProduction, "isReadOnly", &T::isReadOnly, "environment", &T::environment, "dbType", &T::dbType, "ssh", &T::ssh);
+                    &T::savePassword, "isProduction", &T::isProduction, "isReadOnly", &T::isReadOnly, "environment", &T::environment, "dbType", &T::dbType, "ssh", &T::ssh,
+                    "tuning", &T::tuning);
 };
 
 template <>
@@ -150,17 +153,38 @@ namespace {
 
 }  // namespace
 
-SettingsProvider::SettingsProvider() : m_settingsManager(std::make_unique<SettingsManager>()), m_sessionManager(std::make_unique<SessionManager>()) {
-    m_settingsManager->load();
-    m_sessionManager->load();
-}
+// Nothing is read from disk here: the files load on first use or in the startup warm-up, off the window's path
+SettingsProvider::SettingsProvider() : m_settingsManager(std::make_unique<SettingsManager>()), m_sessionManager(std::make_unique<SessionManager>()) {}
 
 SettingsProvider::~SettingsProvider() = default;
-SettingsProvider::SettingsProvider(SettingsProvider&&) noexcept = default;
-SettingsProvider& SettingsProvider::operator=(SettingsProvider&&) noexcept = default;
+
+SettingsManager& SettingsProvider::settingsManager() {
+    std::call_once(m_settingsOnce, [this] { m_settingsManager->load(); });
+    return *m_settingsManager;
+}
+
+const SettingsManager& SettingsProvider::settingsManager() const {
+    std::call_once(m_settingsOnce, [this] { m_settingsManager->load(); });
+    return *m_settingsManager;
+}
+
+SessionManager& SettingsProvider::sessionManager() {
+    std::call_once(m_sessionOnce, [this] { m_sessionManager->load(); });
+    return *m_sessionManager;
+}
+
+const SessionManager& SettingsProvider::sessionManager() const {
+    std::call_once(m_sessionOnce, [this] { m_sessionManager->load(); });
+    return *m_sessionManager;
+}
+
+void SettingsProvider::warmUp() {
+    (void)settingsManager();
+    (void)sessionManager();
+}
 
 std::string SettingsProvider::getSettings() {
-    const auto& s = m_settingsManager->getSettings();
+    const auto& s = settingsManager().getSettings();
     dto::SettingsResponse resp{s.general, s.editor, s.grid};
     std::string json;
     if (auto ec = glz::write_json(resp, json); bool(ec)) {
@@ -169,14 +193,11 @@ std::string SettingsProvider::getSettings() {
     return JsonUtils::successResponse(json);
 }
 
-std::string SettingsProvider::updateSettings(std::string_view params) {
+std::string SettingsProvider::updateSettings(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        AppSettings settings = m_settingsManager->getSettings();
+        AppSettings settings = settingsManager().getSettings();
 
-        if (auto general = doc["general"]; !general.error()) {
+        if (auto general = params["general"]; !general.error()) {
             if (auto val = general["autoConnect"].get_bool(); !val.error())
                 settings.general.autoConnect = val.value();
             if (auto val = general["confirmOnExit"].get_bool(); !val.error())
@@ -187,7 +208,7 @@ std::string SettingsProvider::updateSettings(std::string_view params) {
                 settings.general.language = std::string(val.value());
         }
 
-        if (auto editor = doc["editor"]; !editor.error()) {
+        if (auto editor = params["editor"]; !editor.error()) {
             if (auto val = editor["fontSize"].get_int64(); !val.error())
                 settings.editor.fontSize = narrowToInt(val.value());
             if (auto val = editor["fontFamily"].get_string(); !val.error())
@@ -200,7 +221,7 @@ std::string SettingsProvider::updateSettings(std::string_view params) {
                 settings.editor.theme = std::string(val.value());
         }
 
-        if (auto grid = doc["grid"]; !grid.error()) {
+        if (auto grid = params["grid"]; !grid.error()) {
             if (auto val = grid["defaultPageSize"].get_int64(); !val.error())
                 settings.grid.defaultPageSize = narrowToInt(val.value());
             if (auto val = grid["showRowNumbers"].get_bool(); !val.error())
@@ -209,7 +230,7 @@ std::string SettingsProvider::updateSettings(std::string_view params) {
                 settings.grid.nullDisplay = std::string(val.value());
         }
 
-        if (auto window = doc["window"]; !window.error()) {
+        if (auto window = params["window"]; !window.error()) {
             if (auto val = window["width"].get_int64(); !val.error())
                 settings.window.width = narrowToInt(val.value());
             if (auto val = window["height"].get_int64(); !val.error())
@@ -222,8 +243,8 @@ std::string SettingsProvider::updateSettings(std::string_view params) {
                 settings.window.isMaximized = val.value();
         }
 
-        m_settingsManager->updateSettings(settings);
-        m_settingsManager->save();
+        settingsManager().updateSettings(settings);
+        settingsManager().save();
 
         return JsonUtils::successResponse(R"({"saved":true})");
     } catch (const std::exception& e) {
@@ -232,7 +253,7 @@ std::string SettingsProvider::updateSettings(std::string_view params) {
 }
 
 std::string SettingsProvider::getConnectionProfiles() {
-    const auto& profiles = m_settingsManager->getConnectionProfiles();
+    const auto& profiles = settingsManager().getConnectionProfiles();
     auto responses = profiles | std::views::transform(dto::toProfileResponse) | std::ranges::to<std::vector>();
     std::string profilesJson;
     if (auto ec = glz::write_json(responses, profilesJson); bool(ec)) {
@@ -241,38 +262,35 @@ std::string SettingsProvider::getConnectionProfiles() {
     return JsonUtils::successResponse(std::format(R"({{"profiles":{}}})", profilesJson));
 }
 
-std::string SettingsProvider::saveConnectionProfile(std::string_view params) {
+std::string SettingsProvider::saveConnectionProfile(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
         ConnectionProfile profile;
-        if (auto val = doc["id"].get_string(); !val.error())
+        if (auto val = params["id"].get_string(); !val.error())
             profile.id = std::string(val.value());
-        if (auto val = doc["name"].get_string(); !val.error())
+        if (auto val = params["name"].get_string(); !val.error())
             profile.name = std::string(val.value());
-        if (auto val = doc["server"].get_string(); !val.error())
+        if (auto val = params["server"].get_string(); !val.error())
             profile.server = std::string(val.value());
-        if (auto val = doc["port"].get_int64(); !val.error())
+        if (auto val = params["port"].get_int64(); !val.error())
             profile.port = narrowToInt(val.value());
-        if (auto val = doc["database"].get_string(); !val.error())
+        if (auto val = params["database"].get_string(); !val.error())
             profile.database = std::string(val.value());
-        if (auto val = doc["username"].get_string(); !val.error())
+        if (auto val = params["username"].get_string(); !val.error())
             profile.username = std::string(val.value());
-        if (auto val = doc["useWindowsAuth"].get_bool(); !val.error())
+        if (auto val = params["useWindowsAuth"].get_bool(); !val.error())
             profile.useWindowsAuth = val.value();
-        if (auto val = doc["savePassword"].get_bool(); !val.error())
+        if (auto val = params["savePassword"].get_bool(); !val.error())
             profile.savePassword = val.value();
-        if (auto val = doc["isProduction"].get_bool(); !val.error())
+        if (auto val = params["isProduction"].get_bool(); !val.error())
             profile.isProduction = val.value();
-        if (auto val = doc["isReadOnly"].get_bool(); !val.error())
+        if (auto val = params["isReadOnly"].get_bool(); !val.error())
             profile.isReadOnly = val.value();
-        if (auto val = doc["environment"].get_string(); !val.error())
+        if (auto val = params["environment"].get_string(); !val.error())
             profile.environment = std::string(val.value());
-        if (auto val = doc["dbType"].get_string(); !val.error())
+        if (auto val = params["dbType"].get_string(); !val.error())
             profile.dbType = std::string(val.value());
 
-        if (auto ssh = doc["ssh"]; !ssh.error()) {
+        if (auto ssh = params["ssh"]; !ssh.error()) {
             if (auto val = ssh["enabled"].get_bool(); !val.error())
                 profile.ssh.enabled = val.value();
             if (auto val = ssh["host"].get_string(); !val.error())
@@ -287,48 +305,61 @@ std::string SettingsProvider::saveConnectionProfile(std::string_view params) {
                 profile.ssh.privateKeyPath = std::string(val.value());
         }
 
+        if (auto tuning = params["tuning"]; !tuning.error()) {
+            if (auto val = tuning["packetSize"].get_int64(); !val.error())
+                profile.tuning.packetSize = std::clamp(narrowToInt(val.value()), 0, 32767);
+            if (auto val = tuning["mars"].get_bool(); !val.error())
+                profile.tuning.mars = val.value();
+            if (auto val = tuning["multiSubnetFailover"].get_bool(); !val.error())
+                profile.tuning.multiSubnetFailover = val.value();
+            if (auto val = tuning["readOnlyIntent"].get_bool(); !val.error())
+                profile.tuning.readOnlyIntent = val.value();
+            if (auto val = tuning["readRouting"].get_bool(); !val.error())
+                profile.tuning.readRouting = val.value();
+        }
+
         if (profile.id.empty()) {
             profile.id = std::format("profile_{}", std::chrono::system_clock::now().time_since_epoch().count());
         }
 
-        if (m_settingsManager->getConnectionProfile(profile.id).has_value()) {
-            m_settingsManager->updateConnectionProfile(profile);
+        if (settingsManager().getConnectionProfile(profile.id).has_value()) {
+            settingsManager().updateConnectionProfile(profile);
         } else {
-            m_settingsManager->addConnectionProfile(profile);
+            settingsManager().addConnectionProfile(profile);
         }
 
         if (profile.savePassword) {
-            if (auto val = doc["password"].get_string(); !val.error()) {
+            if (auto val = params["password"].get_string(); !val.error()) {
                 auto password = std::string(val.value());
                 if (!password.empty()) {
-                    (void)m_settingsManager->setProfilePassword(profile.id, password);
+                    (void)settingsManager().setProfilePassword(profile.id, password);
                 }
             }
         } else {
-            (void)m_settingsManager->setProfilePassword(profile.id, "");
+            (void)settingsManager().setProfilePassword(profile.id, "");
         }
 
-        if (auto ssh = doc["ssh"]; !ssh.error()) {
+        if (auto ssh = params["ssh"]; !ssh.error()) {
             if (auto savePass = ssh["savePassword"].get_bool(); !savePass.error() && savePass.value()) {
                 if (auto val = ssh["password"].get_string(); !val.error()) {
                     auto sshPassword = std::string(val.value());
                     if (!sshPassword.empty()) {
-                        (void)m_settingsManager->setSshPassword(profile.id, sshPassword);
+                        (void)settingsManager().setSshPassword(profile.id, sshPassword);
                     }
                 }
                 if (auto val = ssh["keyPassphrase"].get_string(); !val.error()) {
                     auto keyPassphrase = std::string(val.value());
                     if (!keyPassphrase.empty()) {
-                        (void)m_settingsManager->setSshKeyPassphrase(profile.id, keyPassphrase);
+                        (void)settingsManager().setSshKeyPassphrase(profile.id, keyPassphrase);
                     }
                 }
             } else {
-                (void)m_settingsManager->setSshPassword(profile.id, "");
-                (void)m_settingsManager->setSshKeyPassphrase(profile.id, "");
+                (void)settingsManager().setSshPassword(profile.id, "");
+                (void)settingsManager().setSshKeyPassphrase(profile.id, "");
             }
         }
 
-        m_settingsManager->save();
+        settingsManager().save();
 
         return JsonUtils::successResponse(std::format(R"({{"id":"{}"}})", JsonUtils::escapeString(profile.id)));
     } catch (const std::exception& e) {
@@ -336,18 +367,15 @@ std::string SettingsProvider::saveConnectionProfile(std::string_view params) {
     }
 }
 
-std::string SettingsProvider::deleteConnectionProfile(std::string_view params) {
+std::string SettingsProvider::deleteConnectionProfile(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto profileIdResult = doc["id"].get_string();
+        auto profileIdResult = params["id"].get_string();
         if (profileIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: id");
         }
         auto profileId = std::string(profileIdResult.value());
-        m_settingsManager->removeConnectionProfile(profileId);
-        m_settingsManager->save();
+        settingsManager().removeConnectionProfile(profileId);
+        settingsManager().save();
 
         return JsonUtils::successResponse(R"({"deleted":true})");
     } catch (const std::exception& e) {
@@ -355,18 +383,15 @@ std::string SettingsProvider::deleteConnectionProfile(std::string_view params) {
     }
 }
 
-std::string SettingsProvider::getProfilePassword(std::string_view params) {
+std::string SettingsProvider::getProfilePassword(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto idResult = doc["id"].get_string();
+        auto idResult = params["id"].get_string();
         if (idResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: id");
         }
         auto profileId = std::string(idResult.value());
 
-        auto passwordResult = m_settingsManager->getProfilePassword(profileId);
+        auto passwordResult = settingsManager().getProfilePassword(profileId);
         if (!passwordResult) {
             return JsonUtils::errorResponse(passwordResult.error());
         }
@@ -377,18 +402,15 @@ std::string SettingsProvider::getProfilePassword(std::string_view params) {
     }
 }
 
-std::string SettingsProvider::getSshPassword(std::string_view params) {
+std::string SettingsProvider::getSshPassword(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto idResult = doc["id"].get_string();
+        auto idResult = params["id"].get_string();
         if (idResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: id");
         }
         auto profileId = std::string(idResult.value());
 
-        auto passwordResult = m_settingsManager->getSshPassword(profileId);
+        auto passwordResult = settingsManager().getSshPassword(profileId);
         if (!passwordResult) {
             return JsonUtils::errorResponse(passwordResult.error());
         }
@@ -399,18 +421,15 @@ std::string SettingsProvider::getSshPassword(std::string_view params) {
     }
 }
 
-std::string SettingsProvider::getSshKeyPassphrase(std::string_view params) {
+std::string SettingsProvider::getSshKeyPassphrase(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto idResult = doc["id"].get_string();
+        auto idResult = params["id"].get_string();
         if (idResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: id");
         }
         auto profileId = std::string(idResult.value());
 
-        auto passphraseResult = m_settingsManager->getSshKeyPassphrase(profileId);
+        auto passphraseResult = settingsManager().getSshKeyPassphrase(profileId);
         if (!passphraseResult) {
             return JsonUtils::errorResponse(passphraseResult.error());
         }
@@ -422,7 +441,7 @@ std::string SettingsProvider::getSshKeyPassphrase(std::string_view params) {
 }
 
 std::string SettingsProvider::getSessionState() {
-    const auto& state = m_sessionManager->getState();
+    const auto& state = sessionManager().getState();
     auto resp = dto::toSessionResponse(state);
     std::string json;
     if (auto ec = glz::write_json(resp, json); bool(ec)) {
@@ -431,42 +450,67 @@ std::string SettingsProvider::getSessionState() {
     return JsonUtils::successResponse(json);
 }
 
-std::string SettingsProvider::saveSessionState(std::string_view params) {
+std::string SettingsProvider::getSessionTabContent(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+        auto tabIdResult = params["tabId"].get_string();
+        if (tabIdResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required field: tabId");
+        }
+        auto tabId = std::string(tabIdResult.value());
+        auto content = sessionManager().loadTabContent(tabId);
+        if (!content) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("Session tab content not found: {}", tabId));
+        }
+        return JsonUtils::successResponse(std::format(R"({{"content":"{}"}})", JsonUtils::escapeString(*content)));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
 
-        SessionState state = m_sessionManager->getState();
+std::vector<std::string> SettingsProvider::getExpandedTreeNodes() {
+    return sessionManager().getExpandedNodes();
+}
 
-        if (auto val = doc["activeConnectionId"].get_string(); !val.error())
+std::string SettingsProvider::saveSessionState(const IPCParams& params) {
+    try {
+        SessionState state = sessionManager().getState();
+
+        if (auto val = params["activeConnectionId"].get_string(); !val.error())
             state.activeConnectionId = std::string(val.value());
-        if (auto val = doc["activeTabId"].get_string(); !val.error())
+        if (auto val = params["activeTabId"].get_string(); !val.error())
             state.activeTabId = std::string(val.value());
-        if (auto val = doc["windowX"].get_int64(); !val.error())
+        if (auto val = params["windowX"].get_int64(); !val.error())
             state.windowX = narrowToInt(val.value());
-        if (auto val = doc["windowY"].get_int64(); !val.error())
+        if (auto val = params["windowY"].get_int64(); !val.error())
             state.windowY = narrowToInt(val.value());
-        if (auto val = doc["windowWidth"].get_int64(); !val.error())
+        if (auto val = params["windowWidth"].get_int64(); !val.error())
             state.windowWidth = narrowToInt(val.value());
-        if (auto val = doc["windowHeight"].get_int64(); !val.error())
+        if (auto val = params["windowHeight"].get_int64(); !val.error())
             state.windowHeight = narrowToInt(val.value());
-        if (auto val = doc["isMaximized"].get_bool(); !val.error())
+        if (auto val = params["isMaximized"].get_bool(); !val.error())
             state.isMaximized = val.value();
-        if (auto val = doc["leftPanelWidth"].get_int64(); !val.error())
+        if (auto val = params["leftPanelWidth"].get_int64(); !val.error())
             state.leftPanelWidth = narrowToInt(val.value());
-        if (auto val = doc["bottomPanelHeight"].get_int64(); !val.error())
+        if (auto val = params["bottomPanelHeight"].get_int64(); !val.error())
             state.bottomPanelHeight = narrowToInt(val.value());
 
+        // A tab sent without "content" was never shown since the restore: it keeps its stored content
+        auto previousTabs = std::move(state.openTabs);
         state.openTabs.clear();
-        if (auto tabs = doc["openTabs"].get_array(); !tabs.error()) {
+        if (auto tabs = params["openTabs"].get_array(); !tabs.error()) {
             for (auto tabEl : tabs.value()) {
                 EditorTab tab;
                 if (auto val = tabEl["id"].get_string(); !val.error())
                     tab.id = std::string(val.value());
                 if (auto val = tabEl["title"].get_string(); !val.error())
                     tab.title = std::string(val.value());
-                if (auto val = tabEl["content"].get_string(); !val.error())
+                if (auto val = tabEl["content"].get_string(); !val.error()) {
                     tab.content = std::string(val.value());
+                } else if (auto previous = std::ranges::find(previousTabs, tab.id, &EditorTab::id); previous != previousTabs.end()) {
+                    tab.content = std::move(previous->content);
+                    tab.contentHash = std::move(previous->contentHash);
+                    tab.contentLoaded = previous->contentLoaded;
+                }
                 if (auto val = tabEl["filePath"].get_string(); !val.error())
                     tab.filePath = std::string(val.value());
                 if (auto val = tabEl["isDirty"].get_bool(); !val.error())
@@ -480,7 +524,7 @@ std::string SettingsProvider::saveSessionState(std::string_view params) {
         }
 
         state.expandedTreeNodes.clear();
-        if (auto nodes = doc["expandedTreeNodes"].get_array(); !nodes.error()) {
+        if (auto nodes = params["expandedTreeNodes"].get_array(); !nodes.error()) {
             for (auto nodeEl : nodes.value()) {
                 if (auto val = nodeEl.get_string(); !val.error()) {
                     state.expandedTreeNodes.push_back(std::string(val.value()));
@@ -488,8 +532,8 @@ std::string SettingsProvider::saveSessionState(std::string_view params) {
             }
         }
 
-        m_sessionManager->updateState(state);
-        m_sessionManager->save();
+        sessionManager().updateState(state);
+        sessionManager().save();
 
         return JsonUtils::successResponse(R"({"saved":true})");
     } catch (const std::exception& e) {
@@ -3,8 +3,10 @@
 #include "../interfaces/providers/settings_provider.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace velocitydb {
 
@@ -19,28 +21,34 @@ public:
 
     SettingsProvider(const SettingsProvider&) = delete;
     SettingsProvider& operator=(const SettingsProvider&) = delete;
-    SettingsProvider(SettingsProvider&&) noexcept;
-    SettingsProvider& operator=(SettingsProvider&&) noexcept;
+    SettingsProvider(SettingsProvider&&) = delete;
+    SettingsProvider& operator=(SettingsProvider&&) = delete;
 
     [[nodiscard]] std::string getSettings() override;
-    [[nodiscard]] std::string updateSettings(std::string_view params) override;
+    [[nodiscard]] std::string updateSettings(const IPCParams& params) override;
     [[nodiscard]] std::string getConnectionProfiles() override;
-    [[nodiscard]] std::string saveConnectionProfile(std::string_view params) override;
-    [[nodiscard]] std::string deleteConnectionProfile(std::string_view params) override;
-    [[nodiscard]] std::string getProfilePassword(std::string_view params) override;
-    [[nodiscard]] std::string getSshPassword(std::string_view params) override;
-    [[nodiscard]] std::string getSshKeyPassphrase(std::string_view params) override;
+    [[nodiscard]] std::string saveConnectionProfile(const IPCParams& params) override;
+    [[nodiscard]] std::string deleteConnectionProfile(const IPCParams& params) override;
+    [[nodiscard]] std::string getProfilePassword(const IPCParams& params) override;
+    [[nodiscard]] std::string getSshPassword(const IPCParams& params) override;
+    [[nodiscard]] std::string getSshKeyPassphrase(const IPCParams& params) override;
     [[nodiscard]] std::string getSessionState() override;
-    [[nodiscard]] std::string saveSessionState(std::string_view params) override;
+    [[nodiscard]] std::string saveSessionState(const IPCParams& params) override;
+    [[nodiscard]] std::string getSessionTabContent(const IPCParams& params) override;
+    [[nodiscard]] std::vector<std::string> getExpandedTreeNodes() override;
+    void warmUp() override;
 
-    [[nodiscard]] SettingsManager& settingsManager() { return *m_settingsManager; }
-    [[nodiscard]] const SettingsManager& settingsManager() const { return *m_settingsManager; }
-    [[nodiscard]] SessionManager& sessionManager() { return *m_sessionManager; }
-    [[nodiscard]] const SessionManager& sessionManager() const { return *m_sessionManager; }
+    /// Loaded from disk on first access
+    [[nodiscard]] SettingsManager& settingsManager();
+    [[nodiscard]] const SettingsManager& settingsManager() const;
+    [[nodiscard]] SessionManager& sessionManager();
+    [[nodiscard]] const SessionManager& sessionManager() const;
 
 private:
     std::unique_ptr<SettingsManager> m_settingsManager;
     std::unique_ptr<SessionManager> m_sessionManager;
+    mutable std::once_flag m_settingsOnce;
+    mutable std::once_flag m_sessionOnce;
 };
 
 }  // namespace velocitydb
@@ -2,22 +2,68 @@
 
 #include "../database/transaction_manager.h"
 #include "../interfaces/providers/connection_provider.h"
+#include "../interfaces/providers/query_provider.h"
 #include "../utils/json_utils.h"
 #include "simdjson.h"
 
+#include <algorithm>
 #include <format>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 namespace velocitydb {
 
-TransactionProvider::TransactionProvider(IConnectionProvider& connections) : m_connections(connections) {}
+namespace {
+
+/// {"column": "value" | null, ...} in document order; nullopt when a value is neither
+std::optional<RowEdit::Cells> parseCells(simdjson::simdjson_result<simdjson::dom::element> element) {
+    RowEdit::Cells cells;
+    auto object = element.get_object();
+    if (object.error()) {
+        return cells;  // Absent: validated per edit kind by TransactionManager::queueEdit
+    }
+    for (auto [column, value] : object.value()) {
+        if (value.is_null()) {
+            cells.emplace_back(std::string(column), std::nullopt);
+        } else if (auto text = value.get_string(); !text.error()) {
+            cells.emplace_back(std::string(column), std::string(text.value()));
+        } else [[unlikely]] {
+            return std::nullopt;
+        }
+    }
+    return cells;
+}
+
+/// Key cells of fetch-order `row` of `result`, read from the columns named `keyColumns`
+RowEdit::Cells keyOf(const ResultSet& result, size_t row, std::span<const std::string> keyColumns, std::string_view table) {
+    RowEdit::Cells key;
+    key.reserve(keyColumns.size());
+    for (const auto& name : keyColumns) {
+        auto column = std::ranges::find(result.columns, name, &ColumnInfo::name);
+        if (column == result.columns.end()) [[unlikely]] {
+            throw std::runtime_error(std::format("The result does not include key column {} of {}", name, table));
+        }
+        const auto index = static_cast<size_t>(column - result.columns.begin());
+        if (result.isNull(row, index)) {
+            key.emplace_back(name, std::nullopt);
+        } else {
+            key.emplace_back(name, result.cellText(row, index));
+        }
+    }
+    return key;
+}
+
+}  // namespace
+
+TransactionProvider::TransactionProvider(IConnectionProvider& connections, IQueryProvider& queries) : m_connections(connections), m_queries(queries) {}
 
 TransactionProvider::~TransactionProvider() = default;
 
-void TransactionProvider::cleanupConnection(std::string_view params) {
+void TransactionProvider::cleanupConnection(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-        auto idResult = doc["connectionId"].get_string();
+        auto idResult = params["connectionId"].get_string();
         if (idResult.error())
             return;
         std::lock_guard lock(m_txMutex);
@@ -27,43 +73,43 @@ void TransactionProvider::cleanupConnection(std::string_view params) {
     }
 }
 
-std::string TransactionProvider::handleBeginTransaction(std::string_view params) {
-    try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+TransactionManager& TransactionProvider::managerFor(const std::string& connectionId) {
+    auto& manager = m_transactionManagers[connectionId];
+    if (!manager) {
+        auto driver = m_connections.getQueryDriver(connectionId);
+        if (!driver) [[unlikely]] {
+            m_transactionManagers.erase(connectionId);
+            throw std::runtime_error(std::format("Connection not found: {}", connectionId));
+        }
+        manager = std::make_unique<TransactionManager>();
+        manager->setDriver(std::move(driver));
+    }
+    return *manager;
+}
 
-        auto connectionIdResult = doc["connectionId"].get_string();
+std::string TransactionProvider::handleBeginTransaction(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
         if (connectionIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: connectionId");
         }
         auto connectionId = std::string(connectionIdResult.value());
 
-        auto driver = m_connections.getQueryDriver(connectionId);
-        if (!driver) [[unlikely]] {
-            return JsonUtils::errorResponse(std::format("Connection not found: {}", connectionId));
-        }
-
         {
             std::lock_guard lock(m_txMutex);
-            if (!m_transactionManagers.contains(connectionId)) {
-                auto txManager = std::make_unique<TransactionManager>();
-                txManager->setDriver(driver);
-                m_transactionManagers[connectionId] = std::move(txManager);
-            }
-            m_transactionManagers[connectionId]->begin();
+            managerFor(connectionId).begin();
         }
+        // Reads must see the transaction's own writes, so they stop spreading over other lanes
+        m_connections.pinSessionLane(connectionId, true);
         return JsonUtils::successResponse("{}");
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string TransactionProvider::handleCommitTransaction(std::string_view params) {
+std::string TransactionProvider::handleCommitTransaction(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
+        auto connectionIdResult = params["connectionId"].get_string();
         if (connectionIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: connectionId");
         }
@@ -77,18 +123,16 @@ std::string TransactionProvider::handleCommitTransaction(std::string_view params
             }
             it->second->commit();
         }
+        m_connections.pinSessionLane(connectionId, false);
         return JsonUtils::successResponse("{}");
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
-std::string TransactionProvider::handleRollbackTransaction(std::string_view params) {
+std::string TransactionProvider::handleRollbackTransaction(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto connectionIdResult = doc["connectionId"].get_string();
+        auto connectionIdResult = params["connectionId"].get_string();
         if (connectionIdResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing required field: connectionId");
         }
@@ -102,10 +146,259 @@ std::string TransactionProvider::handleRollbackTransaction(std::string_view para
             }
             it->second->rollback();
         }
+        m_connections.pinSessionLane(connectionId, false);
+        return JsonUtils::successResponse("{}");
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string TransactionProvider::handleSavepoint(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto nameResult = params["name"].get_string();
+        if (connectionIdResult.error() || nameResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId or name");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+
+        std::lock_guard lock(m_txMutex);
+        auto it = m_transactionManagers.find(connectionId);
+        if (it == m_transactionManagers.end()) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("No transaction manager for connection: {}", connectionId));
+        }
+        it->second->savepoint(nameResult.value());
+        return JsonUtils::successResponse("{}");
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string TransactionProvider::handleRollbackToSavepoint(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto nameResult = params["name"].get_string();
+        if (connectionIdResult.error() || nameResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId or name");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+
+        std::lock_guard lock(m_txMutex);
+        auto it = m_transactionManagers.find(connectionId);
+        if (it == m_transactionManagers.end()) [[unlikely]] {
+            return JsonUtils::errorResponse(std::format("No transaction manager for connection: {}", connectionId));
+        }
+        it->second->rollbackToSavepoint(nameResult.value());
         return JsonUtils::successResponse("{}");
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
+std::string TransactionProvider::handleApplyEdits(const IPCParams& params) {
+    try {
+        auto connectionIdResult = params["connectionId"].get_string();
+        auto tableResult = params["table"].get_string();
+        auto editsResult = params["edits"].get_array();
+        if (connectionIdResult.error() || tableResult.error() || editsResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: connectionId, table, or edits");
+        }
+        auto connectionId = std::string(connectionIdResult.value());
+        auto schemaResult = params["schema"].get_string();
+        auto schema = schemaResult.error() ? std::string{} : std::string(schemaResult.value());
+
+        std::vector<RowEdit> edits;
+        for (auto item : editsResult.value()) {
+            RowEdit edit{.schema = schema, .table = std::string(tableResult.value())};
+            auto kindResult = item["kind"].get_string();
+            const std::string_view kind = kindResult.error() ? std::string_view{} : kindResult.value();
+            if (kind == "insert") {
+                edit.kind = RowEdit::Kind::Insert;
+            } else if (kind == "update") {
+                edit.kind = RowEdit::Kind::Update;
+            } else if (kind == "delete") {
+                edit.kind = RowEdit::Kind::Delete;
+            } else [[unlikely]] {
+                return JsonUtils::errorResponse("Each edit needs a kind: insert, update, or delete");
+            }
+            auto values = parseCells(item["values"]);
+            auto key = parseCells(item["key"]);
+            if (!values || !key) [[unlikely]] {
+                return JsonUtils::errorResponse("Edit values must be strings or null");
+            }
+            edit.values = std::move(*values);
+            edit.key = std::move(*key);
+            edits.push_back(std::move(edit));
+        }
+
+        int64_t affectedRows = 0;
+        bool transactionLost = false;
+        std::string error;
+        {
+            std::lock_guard lock(m_txMutex);
+            auto& manager = managerFor(connectionId);
+            const bool wasActive = manager.isInTransaction();
+            // Each call carries the complete edit set, so nothing is left queued for the next one
+            try {
+                for (auto& edit : edits) {
+                    manager.queueEdit(std::move(edit));
+                }
+                affectedRows = manager.flushEdits();
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            manager.discardEdits();
+            transactionLost = wasActive && !manager.isInTransaction();
+        }
+        // An error that doomed the open transaction ended it on the server too
+        if (transactionLost) [[unlikely]] {
+            m_connections.pinSessionLane(connectionId, false);
+        }
+        if (!error.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse(error);
+        }
+        return JsonUtils::successResponse(std::format(R"({{"affectedRows":{}}})", affectedRows));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string TransactionProvider::handleSaveGridEdits(const IPCParams& params) {
+    try {
+        auto handleResult = params["resultHandle"].get_string();
+        auto editsResult = params["edits"].get_array();
+        if (handleResult.error() || editsResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing required fields: resultHandle or edits");
+        }
+        const std::string_view handle = handleResult.value();
+        auto origin = m_queries.heldOrigin(handle);
+        auto held = m_queries.heldResult(params);
+        if (!origin || !held) [[unlikely]] {
+            return JsonUtils::errorResponse(held ? std::format("Result not found or expired: {}", handle) : held.error());
+        }
+        const ResultSet& result = *held->result;
+
+        auto schemaResult = params["schema"].get_string();
+        auto tableResult = params["table"].get_string();
+        auto schema = schemaResult.error() ? std::string{} : std::string(schemaResult.value());
+        auto table = tableResult.error() ? origin->sourceTable : std::string(tableResult.value());
+        if (table.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse("The query does not read a single table to save edits to; pass table");
+        }
+
+        // Rows come back with the held result's columns, so they can stand in for the ones shown
+        std::vector<std::string> outputColumns;
+        outputColumns.reserve(result.columns.size());
+        std::vector<std::string> keyColumns;
+        for (const auto& column : result.columns) {
+            outputColumns.push_back(column.name);
+            if (column.isPrimaryKey) {
+                keyColumns.push_back(column.name);
+            }
+        }
+
+        std::vector<RowEdit> edits;
+        std::vector<RowPatch> patches;
+        bool needsKey = false;
+        for (auto item : editsResult.value()) {
+            RowEdit edit{.schema = schema, .table = table};
+            RowPatch patch;
+            auto kindResult = item["kind"].get_string();
+            const std::string_view kind = kindResult.error() ? std::string_view{} : kindResult.value();
+            if (kind == "insert") {
+                edit.kind = RowEdit::Kind::Insert;
+                patch.kind = RowPatch::Kind::Append;
+            } else if (kind == "update") {
+                edit.kind = RowEdit::Kind::Update;
+                patch.kind = RowPatch::Kind::Replace;
+            } else if (kind == "delete") {
+                edit.kind = RowEdit::Kind::Delete;
+                patch.kind = RowPatch::Kind::Remove;
+            } else [[unlikely]] {
+                return JsonUtils::errorResponse("Each edit needs a kind: insert, update, or delete");
+            }
+            if (edit.kind != RowEdit::Kind::Insert) {
+                auto rowResult = item["row"].get_uint64();
+                if (rowResult.error() || rowResult.value() >= held->size()) [[unlikely]] {
+                    return JsonUtils::errorResponse("Each update or delete needs the row it changes, within the result");
+                }
+                patch.row = held->rowAt(static_cast<size_t>(rowResult.value()));
+            }
+            auto values = parseCells(item["values"]);
+            auto key = parseCells(item["key"]);
+            if (!values || !key) [[unlikely]] {
+                return JsonUtils::errorResponse("Edit values must be strings or null");
+            }
+            edit.values = std::move(*values);
+            edit.key = std::move(*key);
+            needsKey = needsKey || (edit.kind != RowEdit::Kind::Insert && edit.key.empty());
+            edits.push_back(std::move(edit));
+            patches.push_back(std::move(patch));
+        }
+
+        std::vector<ResultSet> stored;
+        bool transactionLost = false;
+        std::string error;
+        {
+            std::lock_guard lock(m_txMutex);
+            // The session lane: inside an open transaction the edits join it on the pinned connection
+            auto& manager = managerFor(origin->connectionId);
+            const bool wasActive = manager.isInTransaction();
+            try {
+                if (needsKey) {
+                    if (keyColumns.empty()) {
+                        keyColumns = manager.primaryKeyColumns(schema, table);
+                    }
+                    if (keyColumns.empty()) [[unlikely]] {
+                        throw std::runtime_error(std::format("Table {} has no primary key to locate edited rows by", table));
+                    }
+                    for (size_t i = 0; i < edits.size(); ++i) {
+                        if (edits[i].kind != RowEdit::Kind::Insert && edits[i].key.empty()) {
+                            edits[i].key = keyOf(result, patches[i].row, keyColumns, table);
+                        }
+                    }
+                }
+                stored = manager.applyPreparedEdits(edits, outputColumns);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            transactionLost = wasActive && !manager.isInTransaction();
+        }
+        if (transactionLost) [[unlikely]] {
+            m_connections.pinSessionLane(origin->connectionId, false);
+        }
+        if (!error.empty()) [[unlikely]] {
+            return JsonUtils::errorResponse(error);
+        }
+
+        size_t rowCount = result.rowCount();
+        for (size_t i = 0; i < patches.size(); ++i) {
+            if (patches[i].kind == RowPatch::Kind::Remove) {
+                --rowCount;
+            } else {
+                rowCount += patches[i].kind == RowPatch::Kind::Append ? 1 : 0;
+                patches[i].values = std::move(stored[i]);
+            }
+        }
+        // Positions in the grid's view no longer hold after a patch; the grid asks for its window again
+        const bool patched = m_queries.patchHeldResult(handle, patches);
+
+        std::string json = std::format(R"({{"affectedRows":{},"patched":{},"rowCount":{},"rows":[)", edits.size(), patched,
+                                       patched ? rowCount : result.rowCount());
+        for (size_t i = 0; i < patches.size(); ++i) {
+            if (i > 0)
+                json += ',';
+            if (patches[i].values.empty()) {
+                json += "null";
+            } else {
+                JsonUtils::appendRow(json, patches[i].values, 0);
+            }
+        }
+        json += "]}";
+        return JsonUtils::successResponse(json);
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
 }  // namespace velocitydb
@@ -11,12 +11,13 @@
 namespace velocitydb {
 
 class IConnectionProvider;
+class IQueryProvider;
 class TransactionManager;
 
 /// Provider for transaction management
 class TransactionProvider : public ITransactionProvider {
 public:
-    explicit TransactionProvider(IConnectionProvider& connections);
+    TransactionProvider(IConnectionProvider& connections, IQueryProvider& queries);
     ~TransactionProvider() override;
 
     TransactionProvider(const TransactionProvider&) = delete;
@@ -24,13 +25,24 @@ public:
     TransactionProvider(TransactionProvider&&) = delete;
     TransactionProvider& operator=(TransactionProvider&&) = delete;
 
-    [[nodiscard]] std::string handleBeginTransaction(std::string_view params) override;
-    [[nodiscard]] std::string handleCommitTransaction(std::string_view params) override;
-    [[nodiscard]] std::string handleRollbackTransaction(std::string_view params) override;
-    void cleanupConnection(std::string_view params) override;
+    [[nodiscard]] std::string handleBeginTransaction(const IPCParams& params) override;
+    [[nodiscard]] std::string handleCommitTransaction(const IPCParams& params) override;
+    [[nodiscard]] std::string handleRollbackTransaction(const IPCParams& params) override;
+    [[nodiscard]] std::string handleSavepoint(const IPCParams& params) override;
+    [[nodiscard]] std::string handleRollbackToSavepoint(const IPCParams& params) override;
+    [[nodiscard]] std::string handleApplyEdits(const IPCParams& params) override;
+    /// params: resultHandle, edits [{kind, row, values, key?}], and the grid's sortModel/filter that `row`
+    /// positions are in; schema/table when the result's source table is not the one to write. Updates and
+    /// deletes without a key are located by the table's primary key, read from the held row.
+    [[nodiscard]] std::string handleSaveGridEdits(const IPCParams& params) override;
+    void cleanupConnection(const IPCParams& params) override;
 
 private:
+    /// The connection's manager, created on first use. Caller holds m_txMutex.
+    TransactionManager& managerFor(const std::string& connectionId);
+
     IConnectionProvider& m_connections;
+    IQueryProvider& m_queries;
     std::mutex m_txMutex;
     std::unordered_map<std::string, std::unique_ptr<TransactionManager>> m_transactionManagers;
 };
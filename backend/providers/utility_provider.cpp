@@ -1,68 +1,67 @@
 #include "utility_provider.h"
 
 #include "../parsers/er_diagram_parser_factory.h"
+#include "../parsers/er_model_cache.h"
 #include "../parsers/sql_formatter.h"
+#include "../utils/er_layout.h"
 #include "../utils/json_utils.h"
+#include "../utils/metrics.h"
 #include "interfaces/parsers/er_model.h"
 #include "simdjson.h"
 
 #include <format>
-#include <fstream>
+#include <optional>
+#include <utility>
 
 namespace velocitydb {
 
 namespace {
 
-std::string serializeERModelToJson(const ERModel& model, const std::string& ddl = "") {
-    auto tablesJson = JsonUtils::buildArray(model.tables, [](std::string& out, const auto& table) {
-        auto columnsJson = JsonUtils::buildArray(table.columns, [](std::string& out, const auto& col) {
-            out += std::format(R"({{"name":"{}","logicalName":"{}","type":"{}","size":{},"scale":{},"nullable":{},"isPrimaryKey":{},"defaultValue":"{}","comment":"{}","color":"{}"}})",
-                               JsonUtils::escapeString(col.name), JsonUtils::escapeString(col.logicalName), JsonUtils::escapeString(col.type), col.size, col.scale, col.nullable ? "true" : "false",
-                               col.isPrimaryKey ? "true" : "false", JsonUtils::escapeString(col.defaultValue), JsonUtils::escapeString(col.comment), JsonUtils::escapeString(col.color));
-        });
-        auto indexesJson = JsonUtils::buildArray(table.indexes, [](std::string& out, const auto& idx) {
-            auto idxColumnsJson = JsonUtils::buildArray(idx.columns, [](std::string& out, const auto& colName) { out += std::format(R"("{}")", JsonUtils::escapeString(colName)); });
-            out += std::format(R"({{"name":"{}","columns":{},"isUnique":{}}})", JsonUtils::escapeString(idx.name), idxColumnsJson, idx.isUnique ? "true" : "false");
-        });
-        out += std::format(R"({{"name":"{}","logicalName":"{}","comment":"{}","page":"{}","columns":{},"indexes":{},"posX":{},"posY":{},"color":"{}","bkColor":"{}"}})",
-                           JsonUtils::escapeString(table.name), JsonUtils::escapeString(table.logicalName), JsonUtils::escapeString(table.comment), JsonUtils::escapeString(table.page), columnsJson,
-                           indexesJson, table.posX, table.posY, JsonUtils::escapeString(table.color), JsonUtils::escapeString(table.bkColor));
-    });
-
-    auto relationsJson = JsonUtils::buildArray(model.relations, [](std::string& out, const auto& rel) {
-        out += std::format(R"({{"name":"{}","parentTable":"{}","childTable":"{}","parentColumn":"{}","childColumn":"{}","cardinality":"{}"}})", JsonUtils::escapeString(rel.name),
-                           JsonUtils::escapeString(rel.parentTable), JsonUtils::escapeString(rel.childTable), JsonUtils::escapeString(rel.parentColumn), JsonUtils::escapeString(rel.childColumn),
-                           JsonUtils::escapeString(rel.cardinality));
-    });
-
-    auto shapesJson = JsonUtils::buildArray(model.shapes, [](std::string& out, const auto& shape) {
-        out += std::format(R"({{"shapeType":"{}","text":"{}","fillColor":"{}","fontColor":"{}","fillAlpha":{},"fontSize":{},"left":{},"top":{},"width":{},"height":{},"page":"{}"}})",
-                           JsonUtils::escapeString(shape.shapeType), JsonUtils::escapeString(shape.text), JsonUtils::escapeString(shape.fillColor), JsonUtils::escapeString(shape.fontColor),
-                           shape.fillAlpha, shape.fontSize, shape.left, shape.top, shape.width, shape.height, JsonUtils::escapeString(shape.page));
-    });
-
-    return std::format(R"({{"name":"{}","databaseType":"{}","tables":{},"relations":{},"shapes":{},"ddl":"{}"}})", JsonUtils::escapeString(model.name), JsonUtils::escapeString(model.databaseType),
-                       tablesJson, relationsJson, shapesJson, JsonUtils::escapeString(ddl));
+/// Lines [firstLine, lastLine] when both are given
+std::optional<std::pair<size_t, size_t>> lineRange(const IPCParams& params) {
+    auto firstLine = params["firstLine"].get_uint64();
+    auto lastLine = params["lastLine"].get_uint64();
+    if (firstLine.error() || lastLine.error()) {
+        return std::nullopt;
+    }
+    return std::pair{static_cast<size_t>(firstLine.value()), static_cast<size_t>(lastLine.value())};
+}
+
+/// Layout options from "relayout"
+ERLayoutOptions layoutOptions(const IPCParams& params) {
+    ERLayoutOptions options;
+    if (auto relayout = params["relayout"].get_bool(); !relayout.error()) {
+        options.relayoutAll = relayout.value();
+    }
+    return options;
+}
+
+std::string lineEditResponse(const SQLFormatter::LineEdit& edit) {
+    return JsonUtils::successResponse(std::format(R"({{"sql":"{}","firstLine":{},"lastLine":{}}})", JsonUtils::escapeString(edit.text), edit.firstLine, edit.lastLine));
 }
 
 }  // namespace
 
-UtilityProvider::UtilityProvider() : m_sqlFormatter(std::make_unique<SQLFormatter>()), m_parserFactory(std::make_unique<ERDiagramParserFactory>()) {}
+UtilityProvider::UtilityProvider()
+    : m_sqlFormatter(std::make_unique<SQLFormatter>())
+    , m_parserFactory(std::make_unique<ERDiagramParserFactory>())
+    , m_erModelCache(std::make_unique<ERModelCache>(ERModelCache::defaultDirectory())) {}
 
 UtilityProvider::~UtilityProvider() = default;
 UtilityProvider::UtilityProvider(UtilityProvider&&) noexcept = default;
 UtilityProvider& UtilityProvider::operator=(UtilityProvider&&) noexcept = default;
 
-std::string UtilityProvider::uppercaseKeywords(std::string_view params) {
+std::string UtilityProvider::uppercaseKeywords(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
-
-        auto sqlResult = doc["sql"].get_string();
+        auto sqlResult = params["sql"].get_string();
         if (sqlResult.error()) [[unlikely]] {
             return JsonUtils::errorResponse("Missing sql field");
         }
-        std::string sqlQuery = std::string(sqlResult.value());
+        std::string_view sqlQuery = sqlResult.value();
+
+        if (auto range = lineRange(params)) {
+            return lineEditResponse(m_sqlFormatter->uppercaseKeywordsInLines(sqlQuery, range->first, range->second));
+        }
 
         auto uppercasedSQL = m_sqlFormatter->uppercaseKeywords(sqlQuery);
         return JsonUtils::successResponse(std::format(R"({{"sql":"{}"}})", JsonUtils::escapeString(uppercasedSQL)));
@@ -71,24 +70,41 @@ std::string UtilityProvider::uppercaseKeywords(std::string_view params) {
     }
 }
 
-std::string UtilityProvider::parseERDiagram(std::string_view params) {
+std::string UtilityProvider::formatSQL(const IPCParams& params) {
     try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(params);
+        auto sqlResult = params["sql"].get_string();
+        if (sqlResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing sql field");
+        }
+        std::string_view sqlQuery = sqlResult.value();
+
+        const SQLFormatter::FormatOptions options;
+        if (auto range = lineRange(params)) {
+            return lineEditResponse(m_sqlFormatter->formatLines(sqlQuery, range->first, range->second, options));
+        }
 
-        std::string content;
+        auto formattedSQL = m_sqlFormatter->format(sqlQuery, options);
+        return JsonUtils::successResponse(std::format(R"({{"sql":"{}"}})", JsonUtils::escapeString(formattedSQL)));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string UtilityProvider::parseERDiagram(const IPCParams& params) {
+    try {
         std::string filename;
+        ERDiagramParserFactory::ParseResult parsed;
 
         // Support both content-based and filepath-based parsing
-        auto contentResult = doc["content"].get_string();
+        auto contentResult = params["content"].get_string();
         if (!contentResult.error()) {
-            content = std::string(contentResult.value());
-            auto filenameResult = doc["filename"].get_string();
+            auto filenameResult = params["filename"].get_string();
             if (!filenameResult.error()) {
                 filename = std::string(filenameResult.value());
             }
+            parsed = m_parserFactory->parseWithDDL(contentResult.value(), filename);
         } else {
-            auto filepathResult = doc["filepath"].get_string();
+            auto filepathResult = params["filepath"].get_string();
             if (filepathResult.error()) [[unlikely]] {
                 return JsonUtils::errorResponse("Missing content or filepath field");
             }
@@ -103,22 +119,86 @@ std::string UtilityProvider::parseERDiagram(std::string_view params) {
             auto lastSlash = filepath.find_last_of("/\\");
             filename = (lastSlash != std::string::npos) ? filepath.substr(lastSlash + 1) : filepath;
 
-            std::ifstream file(filepath);
-            if (!file.is_open()) {
-                return JsonUtils::errorResponse("Failed to open file: " + filepath);
-            }
-            content = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            auto persistCache = params["persistCache"].get_bool();
+            auto cached = m_erModelCache->get(filepath, [&](std::string_view content) { return m_parserFactory->parseWithDDL(content, filename); },
+                                              !persistCache.error() && persistCache.value());
+            parsed = *cached;  // Copied: naming and layout below must not touch the cached model
         }
 
-        auto [model, ddl] = m_parserFactory->parseWithDDL(content, filename);
+        auto& [model, ddl] = parsed;
         if (model.name.empty() && !filename.empty()) {
             model.name = filename;
         }
+        if (auto layout = params["layout"].get_bool(); layout.error() || layout.value()) {
+            velocitydb::layoutERModel(model, layoutOptions(params));
+        }
+
+        return JsonUtils::successResponse(ERDiagramParserFactory::toJson(model, ddl));
+    } catch (const std::exception& e) {
+        return JsonUtils::errorResponse(e.what());
+    }
+}
+
+std::string UtilityProvider::layoutERModel(const IPCParams& params) {
+    try {
+        auto tablesResult = params["tables"].get_array();
+        if (tablesResult.error()) [[unlikely]] {
+            return JsonUtils::errorResponse("Missing tables field");
+        }
+        ERModel model;
+        for (auto item : tablesResult.value()) {
+            auto name = item["name"].get_string();
+            if (name.error()) [[unlikely]] {
+                return JsonUtils::errorResponse("Every table needs a name");
+            }
+            ERModelTable table{.name = std::string(name.value())};
+            if (auto columns = item["columns"].get_array(); !columns.error()) {
+                for (auto column : columns.value()) {
+                    auto columnName = column["name"].get_string();
+                    auto type = column["type"].get_string();
+                    table.columns.push_back(ERModelColumn{.name = std::string(columnName.error() ? "" : columnName.value()), .type = std::string(type.error() ? "" : type.value())});
+                }
+            }
+            if (auto posX = item["posX"].get_double(); !posX.error()) {
+                table.posX = posX.value();
+            }
+            if (auto posY = item["posY"].get_double(); !posY.error()) {
+                table.posY = posY.value();
+            }
+            model.tables.push_back(std::move(table));
+        }
+        if (auto relations = params["relations"].get_array(); !relations.error()) {
+            for (auto item : relations.value()) {
+                auto parent = item["parentTable"].get_string();
+                auto child = item["childTable"].get_string();
+                if (!parent.error() && !child.error()) {
+                    model.relations.push_back(ERModelRelation{.parentTable = std::string(parent.value()), .childTable = std::string(child.value())});
+                }
+            }
+        }
 
-        return JsonUtils::successResponse(serializeERModelToJson(model, ddl));
+        const auto placed = velocitydb::layoutERModel(model, layoutOptions(params));
+        auto tablesJson = JsonUtils::buildArray(model.tables, [](std::string& out, const ERModelTable& table) {
+            const auto size = erTableSize(table);
+            out += std::format(R"({{"name":"{}","posX":{},"posY":{},"width":{},"height":{}}})", JsonUtils::escapeString(table.name), table.posX, table.posY, size.width, size.height);
+        });
+        return JsonUtils::successResponse(std::format(R"({{"tables":{},"placed":{}}})", tablesJson, placed));
     } catch (const std::exception& e) {
         return JsonUtils::errorResponse(e.what());
     }
 }
 
+void UtilityProvider::warmUp() {
+    m_sqlFormatter->warmUp();
+}
+
+std::string UtilityProvider::getMetrics(const IPCParams& params) {
+    auto& registry = MetricsRegistry::instance();
+    auto json = registry.toJson();
+    if (auto resetOpt = params["reset"].get_bool(); !resetOpt.error() && resetOpt.value()) {
+        registry.reset();
+    }
+    return JsonUtils::successResponse(json);
+}
+
 }  // namespace velocitydb
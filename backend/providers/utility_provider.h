@@ -10,8 +10,9 @@ namespace velocitydb {
 
 class SQLFormatter;
 class ERDiagramParserFactory;
+class ERModelCache;
 
-/// Provider for utility operations (formatting, parsing)
+/// Provider for utility operations (formatting, parsing, metrics)
 class UtilityProvider : public IUtilityProvider {
 public:
     UtilityProvider();
@@ -22,8 +23,18 @@ public:
     UtilityProvider(UtilityProvider&&) noexcept;
     UtilityProvider& operator=(UtilityProvider&&) noexcept;
 
-    [[nodiscard]] std::string uppercaseKeywords(std::string_view params) override;
-    [[nodiscard]] std::string parseERDiagram(std::string_view params) override;
+    /// Whole script, or with "firstLine"/"lastLine" an in-place pass over just those lines (widened as needed);
+    /// ranged responses carry the replaced line range
+    [[nodiscard]] std::string uppercaseKeywords(const IPCParams& params) override;
+    /// Whole script, or with "firstLine"/"lastLine" only the statements on those lines
+    [[nodiscard]] std::string formatSQL(const IPCParams& params) override;
+    /// Tables without a position are laid out (all of them with "relayout"); "layout":false skips that.
+    /// Files are parsed once per content; "persistCache":true also keeps the parse under AppData across sessions
+    [[nodiscard]] std::string parseERDiagram(const IPCParams& params) override;
+    [[nodiscard]] std::string layoutERModel(const IPCParams& params) override;
+    /// Process-wide MetricsRegistry snapshot; "reset":true zeroes counters and histograms after reading
+    [[nodiscard]] std::string getMetrics(const IPCParams& params) override;
+    void warmUp() override;
 
     [[nodiscard]] SQLFormatter& sqlFormatter() { return *m_sqlFormatter; }
     [[nodiscard]] const SQLFormatter& sqlFormatter() const { return *m_sqlFormatter; }
@@ -31,6 +42,7 @@ public:
 private:
     std::unique_ptr<SQLFormatter> m_sqlFormatter;
     std::unique_ptr<ERDiagramParserFactory> m_parserFactory;
+    std::unique_ptr<ERModelCache> m_erModelCache;  ///< Diagrams opened by path
 };
 
 }  // namespace velocitydb
@@ -0,0 +1,442 @@
+#include "binary_result.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "binary result format is little-endian");
+
+constexpr size_t alignUp(size_t value) noexcept {
+    return (value + 7) & ~size_t{7};
+}
+
+class Encoder {
+public:
+    explicit Encoder(std::string& out) : m_out(out) {}
+
+    template <typename T>
+    void put(T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        m_out.append(bytes, sizeof(T));
+    }
+
+    void putBytes(const void* data, size_t size) { m_out.append(static_cast<const char*>(data), size); }
+
+    void pad() { m_out.append(alignUp(m_out.size()) - m_out.size(), '\0'); }
+
+private:
+    std::string& m_out;
+};
+
+size_t columnHeaderBytes(const ColumnInfo& info) noexcept {
+    return alignUp(16 + info.name.size() + info.type.size());
+}
+
+size_t columnBodyBytes(const ColumnData& column, size_t rows) noexcept {
+    size_t bytes = ((rows + 63) / 64) * sizeof(uint64_t);
+    switch (column.type()) {
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary:
+            bytes += alignUp((rows + 1) * sizeof(uint32_t)) + alignUp(column.rowTextBytes());
+            break;
+        case ColumnDataType::Int64:
+        case ColumnDataType::Double:
+            bytes += rows * 8;
+            break;
+        case ColumnDataType::Bit:
+            bytes += alignUp(rows);
+            break;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            bytes += alignUp(rows * BinaryResultEncoder::DATETIME_RECORD_BYTES);
+            break;
+    }
+    return bytes;
+}
+
+void encodeColumnBody(Encoder& enc, const ColumnData& column, size_t rows) {
+    auto nullWords = column.nullWords();
+    enc.putBytes(nullWords.data(), ((rows + 63) / 64) * sizeof(uint64_t));
+
+    switch (column.type()) {
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary: {
+            if (column.isDictionaryEncoded()) {
+                // The wire format is always plain: expand the codes into per-row offsets
+                const size_t total = column.rowTextBytes();
+                if (total > (std::numeric_limits<uint32_t>::max)()) [[unlikely]] {
+                    throw std::length_error("Text column too large for binary result format");
+                }
+                uint32_t offset = 0;
+                enc.put(offset);
+                for (size_t i = 0; i < rows; ++i) {
+                    offset += static_cast<uint32_t>(column.textAt(i).size());
+                    enc.put(offset);
+                }
+                enc.pad();
+                for (size_t i = 0; i < rows; ++i) {
+                    const auto text = column.textAt(i);
+                    enc.putBytes(text.data(), text.size());
+                }
+                enc.pad();
+                break;
+            }
+            auto offsets = column.textOffsets();
+            const size_t base = offsets[0];
+            if (offsets[rows] - base > (std::numeric_limits<uint32_t>::max)()) [[unlikely]] {
+                throw std::length_error("Text column too large for binary result format");
+            }
+            for (size_t i = 0; i <= rows; ++i) {
+                enc.put(static_cast<uint32_t>(offsets[i] - base));
+            }
+            enc.pad();
+            enc.putBytes(column.textChars().data() + base, offsets[rows] - base);
+            enc.pad();
+            break;
+        }
+        case ColumnDataType::Int64:
+            enc.putBytes(column.int64Values().data(), rows * sizeof(int64_t));
+            break;
+        case ColumnDataType::Double:
+            enc.putBytes(column.doubleValues().data(), rows * sizeof(double));
+            break;
+        case ColumnDataType::Bit:
+            for (int64_t value : column.int64Values().first(rows)) {
+                enc.put(static_cast<uint8_t>(value != 0));
+            }
+            enc.pad();
+            break;
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            for (const auto& value : column.dateTimeValues().first(rows)) {
+                enc.put(value.year);
+                enc.put(value.month);
+                enc.put(value.day);
+                enc.put(value.hour);
+                enc.put(value.minute);
+                enc.put(value.second);
+                enc.put(uint8_t{0});
+                enc.put(value.fraction);
+            }
+            enc.pad();
+            break;
+    }
+}
+
+/// Bounds-checked little-endian reader over an encoded payload
+class Decoder {
+public:
+    explicit Decoder(std::string_view data) : m_data(data) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string_view take(size_t size) {
+        if (size > m_data.size() - m_pos) [[unlikely]] {
+            throw std::runtime_error("Truncated binary result");
+        }
+        auto bytes = m_data.substr(m_pos, size);
+        m_pos += size;
+        return bytes;
+    }
+
+    void align() { take(alignUp(m_pos) - m_pos); }
+    [[nodiscard]] size_t position() const noexcept { return m_pos; }
+
+private:
+    std::string_view m_data;
+    size_t m_pos = 0;
+};
+
+ColumnData decodeColumnBody(Decoder& dec, ColumnDataType type, uint8_t fractionDigits, size_t rows) {
+    auto nullBytes = dec.take(((rows + 63) / 64) * sizeof(uint64_t));
+    auto isNull = [&](size_t row) { return (static_cast<uint8_t>(nullBytes[row >> 3]) >> (row & 7)) & 1; };
+
+    ColumnData column(type, fractionDigits);
+    switch (type) {
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary: {
+            auto offsets = dec.take((rows + 1) * sizeof(uint32_t));
+            dec.align();
+            auto offsetAt = [&](size_t i) {
+                uint32_t value;
+                std::memcpy(&value, offsets.data() + i * sizeof(uint32_t), sizeof(value));
+                return value;
+            };
+            auto chars = dec.take(offsetAt(rows));
+            dec.align();
+            column.reserve(rows, chars.size());
+            for (size_t i = 0; i < rows; ++i) {
+                const uint32_t begin = offsetAt(i);
+                const uint32_t end = offsetAt(i + 1);
+                if (begin > end || end > chars.size()) [[unlikely]] {
+                    throw std::runtime_error("Corrupt text offsets in binary result");
+                }
+                if (isNull(i))
+                    column.appendNull();
+                else if (type == ColumnDataType::Binary)
+                    column.appendBinary(chars.substr(begin, end - begin));
+                else
+                    column.appendText(chars.substr(begin, end - begin));
+            }
+            break;
+        }
+        case ColumnDataType::Int64:
+        case ColumnDataType::Double: {
+            auto values = dec.take(rows * 8);
+            column.reserve(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                if (isNull(i)) {
+                    column.appendNull();
+                } else if (type == ColumnDataType::Int64) {
+                    int64_t value;
+                    std::memcpy(&value, values.data() + i * 8, 8);
+                    column.appendInt64(value);
+                } else {
+                    double value;
+                    std::memcpy(&value, values.data() + i * 8, 8);
+                    column.appendDouble(value);
+                }
+            }
+            break;
+        }
+        case ColumnDataType::Bit: {
+            auto values = dec.take(rows);
+            dec.align();
+            column.reserve(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                if (isNull(i))
+                    column.appendNull();
+                else
+                    column.appendBit(values[i] != 0);
+            }
+            break;
+        }
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp: {
+            column.reserve(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                DateTimeValue value;
+                value.year = dec.get<int16_t>();
+                value.month = dec.get<uint8_t>();
+                value.day = dec.get<uint8_t>();
+                value.hour = dec.get<uint8_t>();
+                value.minute = dec.get<uint8_t>();
+                value.second = dec.get<uint8_t>();
+                (void)dec.get<uint8_t>();
+                value.fraction = dec.get<uint32_t>();
+                if (isNull(i))
+                    column.appendNull();
+                else
+                    column.appendDateTime(value);
+            }
+            dec.align();
+            break;
+        }
+        default:
+            throw std::runtime_error(std::format("Unknown binary column type {}", static_cast<int>(type)));
+    }
+    return column;
+}
+
+}  // namespace
+
+size_t BinaryResultEncoder::encodedSize(const ResultSet& result) noexcept {
+    const size_t rows = result.rowCount();
+    size_t bytes = HEADER_BYTES;
+    const ColumnData emptyText;
+    for (size_t col = 0; col < result.columns.size(); ++col) {
+        bytes += columnHeaderBytes(result.columns[col]);
+        bytes += columnBodyBytes(col < result.columnData.size() ? result.columnData[col] : emptyText, rows);
+    }
+    return bytes;
+}
+
+namespace {
+
+/// Header and column descriptors
+void encodePreamble(Encoder& enc, const ResultSet& result) {
+    const size_t rows = result.rowCount();
+    // Column metadata can outnumber storage for empty results (e.g. zero-row SELECT)
+    const size_t columnCount = result.columns.size();
+
+    enc.putBytes("VDBR", 4);
+    enc.put(BinaryResultEncoder::VERSION);
+    enc.put(result.truncated ? BinaryResultEncoder::FLAG_TRUNCATED : uint16_t{0});
+    enc.put(static_cast<uint32_t>(columnCount));
+    enc.put(uint32_t{0});
+    enc.put(static_cast<uint64_t>(rows));
+    enc.put(static_cast<int64_t>(result.affectedRows));
+    enc.put(result.executionTimeMs);
+
+    for (size_t col = 0; col < columnCount; ++col) {
+        const auto& info = result.columns[col];
+        const bool hasData = col < result.columnData.size();
+        enc.put(static_cast<uint8_t>(hasData ? result.columnData[col].type() : ColumnDataType::Text));
+        enc.put(hasData ? result.columnData[col].fractionDigits() : uint8_t{0});
+        enc.put(static_cast<uint8_t>(info.nullable));
+        enc.put(static_cast<uint8_t>(info.isPrimaryKey));
+        enc.put(static_cast<int32_t>(info.size));
+        enc.put(static_cast<uint32_t>(info.name.size()));
+        enc.put(static_cast<uint32_t>(info.type.size()));
+        enc.putBytes(info.name.data(), info.name.size());
+        enc.putBytes(info.type.data(), info.type.size());
+        enc.pad();
+    }
+}
+
+}  // namespace
+
+std::string BinaryResultEncoder::encode(const ResultSet& result) {
+    const size_t rows = result.rowCount();
+    std::string out;
+    out.reserve(encodedSize(result));
+    Encoder enc(out);
+
+    encodePreamble(enc, result);
+    const ColumnData emptyText;
+    for (size_t col = 0; col < result.columns.size(); ++col) {
+        encodeColumnBody(enc, col < result.columnData.size() ? result.columnData[col] : emptyText, rows);
+    }
+    return out;
+}
+
+void BinaryResultEncoder::encode(const ResultSet& result, const std::function<void(std::string_view)>& write) {
+    const size_t rows = result.rowCount();
+    std::string chunk;
+    Encoder enc(chunk);
+
+    // Every section ends on an 8-byte boundary, so padding relative to the chunk matches the whole payload
+    encodePreamble(enc, result);
+    write(chunk);
+    const ColumnData emptyText;
+    for (size_t col = 0; col < result.columns.size(); ++col) {
+        chunk.clear();
+        encodeColumnBody(enc, col < result.columnData.size() ? result.columnData[col] : emptyText, rows);
+        write(chunk);
+    }
+}
+
+void BinaryResultEncoder::encodeColumn(const ColumnData& column, size_t rows, std::string& out) {
+    out.reserve(out.size() + columnBodyBytes(column, rows));
+    Encoder enc(out);
+    encodeColumnBody(enc, column, rows);
+}
+
+ResultSet BinaryResultDecoder::decode(std::string_view payload) {
+    Decoder dec(payload);
+    if (dec.take(4) != "VDBR" || dec.get<uint16_t>() != BinaryResultEncoder::VERSION) [[unlikely]] {
+        throw std::runtime_error("Unsupported binary result format");
+    }
+    const auto flags = dec.get<uint16_t>();
+    const auto columnCount = dec.get<uint32_t>();
+    (void)dec.get<uint32_t>();
+    const auto rows = dec.get<uint64_t>();
+    if (rows > payload.size() * 8) [[unlikely]] {
+        throw std::runtime_error("Corrupt row count in binary result");
+    }
+
+    ResultSet result;
+    result.affectedRows = dec.get<int64_t>();
+    result.executionTimeMs = dec.get<double>();
+    result.truncated = (flags & BinaryResultEncoder::FLAG_TRUNCATED) != 0;
+
+    struct Storage {
+        ColumnDataType type;
+        uint8_t fractionDigits;
+    };
+    std::vector<Storage> storage;
+    storage.reserve(columnCount);
+    result.columns.reserve(columnCount);
+    for (uint32_t col = 0; col < columnCount; ++col) {
+        const auto type = static_cast<ColumnDataType>(dec.get<uint8_t>());
+        const auto fractionDigits = dec.get<uint8_t>();
+        ColumnInfo info;
+        info.nullable = dec.get<uint8_t>() != 0;
+        info.isPrimaryKey = dec.get<uint8_t>() != 0;
+        info.size = dec.get<int32_t>();
+        const auto nameBytes = dec.get<uint32_t>();
+        const auto typeBytes = dec.get<uint32_t>();
+        info.name = dec.take(nameBytes);
+        info.type = dec.take(typeBytes);
+        dec.align();
+        result.columns.push_back(std::move(info));
+        storage.push_back({type, fractionDigits});
+    }
+
+    result.columnData.reserve(columnCount);
+    for (const auto& column : storage) {
+        result.columnData.push_back(decodeColumnBody(dec, column.type, column.fractionDigits, rows));
+    }
+    return result;
+}
+
+ColumnData BinaryResultDecoder::decodeColumn(std::string_view body, ColumnDataType type, uint8_t fractionDigits, size_t rows) {
+    if (rows > body.size() * 8) [[unlikely]] {
+        throw std::runtime_error("Corrupt row count in binary result");
+    }
+    Decoder dec(body);
+    return decodeColumnBody(dec, type, fractionDigits, rows);
+}
+
+std::string BinaryResultStore::put(std::string payload) {
+    std::lock_guard lock(m_mutex);
+    evict(payload.size());
+
+    const uint64_t sequence = m_nextSequence++;
+    auto id = std::format("r{}", sequence);
+    m_totalBytes += payload.size();
+    m_entries.emplace(id, Entry{.payload = std::move(payload), .createdAt = std::chrono::steady_clock::now(), .sequence = sequence});
+    return id;
+}
+
+std::optional<std::string> BinaryResultStore::take(std::string_view id) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(std::string(id));
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    std::string payload = std::move(it->second.payload);
+    m_totalBytes -= payload.size();
+    m_entries.erase(it);
+    return payload;
+}
+
+size_t BinaryResultStore::totalBytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_totalBytes;
+}
+
+void BinaryResultStore::evict(size_t incoming) {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_entries, [&](const auto& item) {
+        if (now - item.second.createdAt < ENTRY_TTL) {
+            return false;
+        }
+        m_totalBytes -= item.second.payload.size();
+        return true;
+    });
+
+    while (!m_entries.empty() && m_totalBytes + incoming > m_maxBytes) {
+        auto oldest = std::ranges::min_element(m_entries, {}, [](const auto& item) { return item.second.sequence; });
+        m_totalBytes -= oldest->second.payload.size();
+        m_entries.erase(oldest);
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace velocitydb {
+
+/// Host name the WebView serves binary results from (https://results.local/<id>).
+inline constexpr std::string_view BINARY_RESULT_HOST = "results.local";
+
+/// Columnar binary encoding of a ResultSet for the WebView, so large grids skip JSON entirely.
+///
+/// Little-endian; every section starts on an 8-byte boundary so the frontend can view the
+/// numeric arrays in place with typed arrays.
+///   header      "VDBR" u16 version, u16 flags (bit 0: truncated), u32 columnCount, u32 reserved,
+///               u64 rowCount, i64 affectedRows, f64 executionTimeMs
+///   columns[]   u8 storageType (ColumnDataType), u8 fractionDigits, u8 nullable, u8 isPrimaryKey,
+///               i32 size, u32 nameBytes, u32 typeBytes, name, type
+///   data[]      u64 nullWords[(rowCount + 63) / 64] (bit set = NULL), then by storage type:
+///               Text      u32 offsets[rowCount + 1], UTF-8 chars
+///               Binary    u32 offsets[rowCount + 1], raw bytes (the frontend shows them as upper-case hex)
+///               Int64     i64[rowCount]
+///               Double    f64[rowCount]
+///               Bit       u8[rowCount]
+///               Date/Time/Timestamp  12-byte records: i16 year, u8 month, day, hour, minute, second, pad, u32 fraction (ns)
+class BinaryResultEncoder {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_BYTES = 40;
+    static constexpr size_t DATETIME_RECORD_BYTES = 12;
+    static constexpr uint16_t FLAG_TRUNCATED = 1;
+
+    /// @throws std::length_error if a text column exceeds the 4 GB offset range
+    [[nodiscard]] static std::string encode(const ResultSet& result);
+    /// Same payload handed to `write` in pieces (header, then one column at a time), for results too large
+    /// to hold twice
+    static void encode(const ResultSet& result, const std::function<void(std::string_view)>& write);
+
+    /// Exact encoded size (used to reserve the output buffer in one allocation)
+    [[nodiscard]] static size_t encodedSize(const ResultSet& result) noexcept;
+
+    /// The data[] section of one column (`rows` rows), appended to `out`
+    /// @throws std::length_error like encode()
+    static void encodeColumn(const ColumnData& column, size_t rows, std::string& out);
+};
+
+/// Rebuilds a ResultSet from the BinaryResultEncoder layout (used by the on-disk result cache).
+class BinaryResultDecoder {
+public:
+    /// @throws std::runtime_error if the payload is truncated or not a supported version
+    [[nodiscard]] static ResultSet decode(std::string_view payload);
+
+    /// One column from a data[] section written by BinaryResultEncoder::encodeColumn
+    /// @throws std::runtime_error if `body` is truncated or corrupt
+    [[nodiscard]] static ColumnData decodeColumn(std::string_view body, ColumnDataType type, uint8_t fractionDigits, size_t rows);
+};
+
+/// Short-lived store of encoded results waiting to be fetched by the WebView.
+/// Each entry is handed out once; unclaimed entries expire and the total size is bounded.
+class BinaryResultStore {
+public:
+    static constexpr auto ENTRY_TTL = std::chrono::minutes(2);
+
+    explicit BinaryResultStore(size_t maxBytes = 512 * 1024 * 1024) : m_maxBytes(maxBytes) {}
+    ~BinaryResultStore() = default;
+
+    BinaryResultStore(const BinaryResultStore&) = delete;
+    BinaryResultStore& operator=(const BinaryResultStore&) = delete;
+    BinaryResultStore(BinaryResultStore&&) = delete;
+    BinaryResultStore& operator=(BinaryResultStore&&) = delete;
+
+    /// Store an encoded result and return its id
+    [[nodiscard]] std::string put(std::string payload);
+
+    /// Remove and return the payload for `id`
+    [[nodiscard]] std::optional<std::string> take(std::string_view id);
+
+    [[nodiscard]] size_t totalBytes() const;
+
+private:
+    struct Entry {
+        std::string payload;
+        std::chrono::steady_clock::time_point createdAt;
+        uint64_t sequence = 0;
+    };
+
+    /// Drop expired entries, then the oldest ones until `incoming` more bytes fit (lock held)
+    void evict(size_t incoming);
+
+    size_t m_maxBytes;
+    size_t m_totalBytes = 0;
+    uint64_t m_nextSequence = 1;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+};
+
+}  // namespace velocitydb
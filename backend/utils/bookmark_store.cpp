@@ -0,0 +1,274 @@
+#include "bookmark_store.h"
+
+#include "debounced_file_writer.h"
+#include "json_utils.h"
+#include "logger.h"
+#include "simdjson.h"
+
+#include <format>
+#include <stdexcept>
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] std::string bookmarkJson(const Bookmark& bookmark) {
+    return std::format(R"({{"id":"{}","name":"{}","content":"{}"}})", JsonUtils::escapeString(bookmark.id), JsonUtils::escapeString(bookmark.name),
+                       JsonUtils::escapeString(bookmark.content));
+}
+
+[[nodiscard]] Bookmark parseBookmark(simdjson::dom::element element) {
+    Bookmark bookmark;
+    if (auto id = element["id"].get_string(); !id.error()) {
+        bookmark.id = std::string(id.value());
+    }
+    if (auto name = element["name"].get_string(); !name.error()) {
+        bookmark.name = std::string(name.value());
+    }
+    if (auto content = element["content"].get_string(); !content.error()) {
+        bookmark.content = std::string(content.value());
+    }
+    return bookmark;
+}
+
+[[nodiscard]] std::filesystem::path withExtension(std::filesystem::path path, std::string_view extension) {
+    return path.replace_extension(extension);
+}
+
+}  // namespace
+
+BookmarkStore::BookmarkStore(std::filesystem::path path)
+    : m_path(std::move(path))
+    , m_journalPath(withExtension(m_path, ".jsonl"))
+    , m_retiredJournalPath(withExtension(m_path, ".jsonl.old")) {}
+
+BookmarkStore::~BookmarkStore() {
+    waitForCompaction();
+}
+
+std::string BookmarkStore::json() {
+    std::lock_guard lock(m_mutex);
+    ensureLoaded();
+    return arrayJson();
+}
+
+void BookmarkStore::save(Bookmark bookmark) {
+    std::lock_guard lock(m_mutex);
+    ensureLoaded();
+    auto record = bookmarkJson(bookmark);
+    record.insert(1, R"("op":"save",)");
+    appendRecord(record);
+    upsert(std::move(bookmark));
+    if (m_journalRecords > MIN_COMPACT_RECORDS && m_journalRecords > 2 * m_byId.size()) {
+        compact();
+    }
+}
+
+bool BookmarkStore::remove(std::string_view id) {
+    std::lock_guard lock(m_mutex);
+    ensureLoaded();
+    if (!m_byId.contains(std::string(id))) {
+        return false;
+    }
+    appendRecord(std::format(R"({{"op":"delete","id":"{}"}})", JsonUtils::escapeString(id)));
+    erase(id);
+    if (m_journalRecords > MIN_COMPACT_RECORDS && m_journalRecords > 2 * m_byId.size()) {
+        compact();
+    }
+    return true;
+}
+
+size_t BookmarkStore::size() {
+    std::lock_guard lock(m_mutex);
+    ensureLoaded();
+    return m_byId.size();
+}
+
+void BookmarkStore::waitForCompaction() {
+    std::thread compactor;
+    {
+        std::lock_guard lock(m_mutex);
+        compactor = std::move(m_compactor);
+    }
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+void BookmarkStore::ensureLoaded() {
+    if (m_loaded) {
+        return;
+    }
+    std::error_code ec;
+    if (std::filesystem::exists(m_path, ec)) {
+        simdjson::dom::parser parser;
+        auto document = parser.load(m_path.string());
+        auto array = document.get_array();
+        if (array.error()) [[unlikely]] {
+            throw std::runtime_error("Invalid bookmarks data");
+        }
+        for (auto element : array.value()) {
+            auto bookmark = parseBookmark(element);
+            if (!bookmark.id.empty()) {
+                upsert(std::move(bookmark));
+            }
+        }
+    }
+    // A retired journal is only left behind when its rewrite did not finish; replaying it again is harmless
+    replayJournal(m_retiredJournalPath);
+    replayJournal(m_journalPath);
+
+    if (m_path.has_parent_path()) {
+        std::filesystem::create_directories(m_path.parent_path(), ec);
+    }
+    m_journal.open(m_journalPath, std::ios::binary | std::ios::app);
+    m_loaded = true;
+}
+
+void BookmarkStore::replayJournal(const std::filesystem::path& journal) {
+    uintmax_t complete = 0;  ///< Bytes up to the end of the last newline-terminated record
+    {
+        std::ifstream in(journal, std::ios::binary);
+        if (!in.is_open()) {
+            return;
+        }
+        simdjson::dom::parser parser;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (in.eof()) {
+                break;  // No newline: an append the process did not finish
+            }
+            complete += line.size() + 1;
+            if (line.empty()) {
+                continue;
+            }
+            auto record = parser.parse(line);
+            auto op = record["op"].get_string();
+            if (record.error() || op.error()) [[unlikely]] {
+                log<LogLevel::WARNING>(std::format("Bookmarks: skipping unreadable journal record in {}", journal.string()));
+                continue;
+            }
+            apply(op.value(), parseBookmark(record.value()));
+            ++m_journalRecords;
+        }
+    }
+    std::error_code ec;
+    if (std::filesystem::file_size(journal, ec) > complete && !ec) {
+        std::filesystem::resize_file(journal, complete, ec);
+    }
+}
+
+void BookmarkStore::apply(std::string_view op, Bookmark bookmark) {
+    if (bookmark.id.empty()) {
+        return;
+    }
+    if (op == "save") {
+        upsert(std::move(bookmark));
+    } else if (op == "delete") {
+        erase(bookmark.id);
+    }
+}
+
+void BookmarkStore::upsert(Bookmark bookmark) {
+    if (auto found = m_byId.find(bookmark.id); found != m_byId.end()) {
+        m_slots[found->second] = std::move(bookmark);
+        return;
+    }
+    m_byId.emplace(bookmark.id, m_slots.size());
+    m_slots.emplace_back(std::move(bookmark));
+}
+
+bool BookmarkStore::erase(std::string_view id) {
+    auto found = m_byId.find(std::string(id));
+    if (found == m_byId.end()) {
+        return false;
+    }
+    m_slots[found->second].reset();
+    m_byId.erase(found);
+    ++m_removed;
+
+    // Repack once removed slots outnumber live ones
+    if (m_removed > m_byId.size()) {
+        std::erase_if(m_slots, [](const auto& slot) { return !slot.has_value(); });
+        for (size_t i = 0; i < m_slots.size(); ++i) {
+            m_byId[m_slots[i]->id] = i;
+        }
+        m_removed = 0;
+    }
+    return true;
+}
+
+std::string BookmarkStore::arrayJson() const {
+    std::string json = "[";
+    for (const auto& slot : m_slots) {
+        if (!slot) {
+            continue;
+        }
+        if (json.size() > 1) {
+            json += ',';
+        }
+        json += bookmarkJson(*slot);
+    }
+    json += ']';
+    return json;
+}
+
+void BookmarkStore::appendRecord(const std::string& record) {
+    if (!m_journal.is_open()) [[unlikely]] {
+        throw std::runtime_error(std::format("Failed to open {}", m_journalPath.string()));
+    }
+    // One write per record; a crash can only tear the last line, which loading drops
+    m_journal << record << '\n';
+    m_journal.flush();
+    if (!m_journal) [[unlikely]] {
+        m_journal.clear();
+        throw std::runtime_error(std::format("Failed to write {}", m_journalPath.string()));
+    }
+    ++m_journalRecords;
+}
+
+void BookmarkStore::compact() {
+    if (m_compacting) {
+        return;
+    }
+    if (m_compactor.joinable()) {
+        m_compactor.join();  // Finished: it clears m_compacting last
+    }
+
+    // Set the journal aside; a retired one still there (its rewrite failed) takes this one's records after its own
+    m_journal.close();
+    std::error_code ec;
+    if (std::filesystem::exists(m_retiredJournalPath, ec)) {
+        {
+            std::ifstream in(m_journalPath, std::ios::binary);
+            std::ofstream out(m_retiredJournalPath, std::ios::binary | std::ios::app);
+            out << in.rdbuf();
+        }
+        std::filesystem::remove(m_journalPath, ec);
+    } else {
+        std::filesystem::rename(m_journalPath, m_retiredJournalPath, ec);
+    }
+    if (ec) [[unlikely]] {
+        // Keep appending to the journal as it is; the next change tries again
+        log<LogLevel::WARNING>(std::format("Bookmarks: could not set the journal aside: {}", ec.message()));
+        m_journal.open(m_journalPath, std::ios::binary | std::ios::app);
+        return;
+    }
+    m_journal.open(m_journalPath, std::ios::binary | std::ios::trunc);
+    m_journalRecords = 0;
+
+    m_compacting = true;
+    m_compactor = std::thread([this, content = arrayJson()] {
+        const bool written = DebouncedFileWriter::writeAtomically(m_path, content);
+        std::lock_guard lock(m_mutex);
+        if (written) {
+            std::error_code removeError;
+            std::filesystem::remove(m_retiredJournalPath, removeError);
+        } else {
+            log<LogLevel::WARNING>(std::format("Bookmarks: could not rewrite {}", m_path.string()));
+        }
+        m_compacting = false;
+    });
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+struct Bookmark {
+    std::string id;
+    std::string name;
+    std::string content;
+};
+
+/// Saved queries, held in memory and indexed by id.
+///
+/// The file at `path` (a JSON array, the format bookmarks always had) is read once, on first use. Each change is
+/// then appended as one flushed JSON Lines record to a journal next to it (bookmarks.jsonl), so a save costs one
+/// short write however many bookmarks exist. Once the journal outgrows the bookmarks it describes, it is set aside
+/// and a background thread rewrites the array from a copy of the current state (temporary file, then rename);
+/// changes made meanwhile go to a fresh journal. Loading replays whatever journals are still there over the
+/// array, and a torn last line left by a crash is dropped.
+class BookmarkStore {
+public:
+    /// Journal records tolerated before a rewrite is considered at all
+    static constexpr size_t MIN_COMPACT_RECORDS = 256;
+
+    explicit BookmarkStore(std::filesystem::path path);
+    /// Waits for a running rewrite
+    ~BookmarkStore();
+
+    BookmarkStore(const BookmarkStore&) = delete;
+    BookmarkStore& operator=(const BookmarkStore&) = delete;
+    BookmarkStore(BookmarkStore&&) = delete;
+    BookmarkStore& operator=(BookmarkStore&&) = delete;
+
+    /// JSON array of {"id","name","content"}, in the order bookmarks were first saved
+    /// @throws std::runtime_error when the bookmarks file cannot be read
+    [[nodiscard]] std::string json();
+
+    /// Add `bookmark`, or replace the one with its id in place
+    /// @throws std::runtime_error when the bookmarks cannot be read or the change cannot be journaled
+    void save(Bookmark bookmark);
+    /// @return Whether a bookmark had that id
+    /// @throws std::runtime_error like save()
+    bool remove(std::string_view id);
+
+    [[nodiscard]] size_t size();
+
+    /// Block until a running rewrite has finished
+    void waitForCompaction();
+
+private:
+    // All with m_mutex held
+    void ensureLoaded();
+    void replayJournal(const std::filesystem::path& journal);
+    void apply(std::string_view op, Bookmark bookmark);
+    void upsert(Bookmark bookmark);
+    bool erase(std::string_view id);
+    [[nodiscard]] std::string arrayJson() const;
+    void appendRecord(const std::string& record);
+    /// Set the journal aside and rewrite the array from a copy on m_compactor
+    void compact();
+
+    const std::filesystem::path m_path;
+    const std::filesystem::path m_journalPath;
+    const std::filesystem::path m_retiredJournalPath;  ///< Journal covered by a rewrite still in progress or failed
+
+    std::mutex m_mutex;  // guards everything below
+    bool m_loaded = false;
+    std::vector<std::optional<Bookmark>> m_slots;  ///< Insertion order; removed ones are empty until repacked
+    std::unordered_map<std::string, size_t> m_byId;
+    size_t m_removed = 0;
+    std::ofstream m_journal;
+    size_t m_journalRecords = 0;
+    bool m_compacting = false;
+    std::thread m_compactor;
+};
+
+}  // namespace velocitydb
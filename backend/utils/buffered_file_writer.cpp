@@ -0,0 +1,90 @@
+#include "buffered_file_writer.h"
+
+#include "encoding.h"
+
+#include <Windows.h>
+
+#include <algorithm>
+
+namespace velocitydb {
+
+BufferedFileWriter::BufferedFileWriter(size_t bufferBytes) : m_buffer(std::make_unique<char[]>(bufferBytes)), m_capacity(bufferBytes) {}
+
+BufferedFileWriter::~BufferedFileWriter() {
+    close();
+}
+
+bool BufferedFileWriter::open(const std::string& filepath) {
+    close();
+    m_used = 0;
+    m_flushedBytes = 0;
+    m_failed = false;
+
+    auto widePath = utf8ToWide(filepath);
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) [[unlikely]] {
+        return false;
+    }
+    m_file = file;
+    return true;
+}
+
+void BufferedFileWriter::appendSlow(std::string_view data) {
+    // Top up the current buffer so writes stay buffer-sized, then bypass it for anything larger
+    const size_t head = m_capacity - m_used;
+    std::char_traits<char>::copy(m_buffer.get() + m_used, data.data(), head);
+    m_used += head;
+    data.remove_prefix(head);
+    flush();
+
+    if (data.size() >= m_capacity) {
+        m_flushedBytes += data.size();
+        writeToFile(data.data(), data.size());
+        return;
+    }
+    std::char_traits<char>::copy(m_buffer.get(), data.data(), data.size());
+    m_used = data.size();
+}
+
+bool BufferedFileWriter::flush() {
+    if (m_used > 0) {
+        m_flushedBytes += m_used;
+        writeToFile(m_buffer.get(), m_used);
+        m_used = 0;
+    }
+    return !m_failed;
+}
+
+bool BufferedFileWriter::close() {
+    if (m_file == nullptr) {
+        return !m_failed;
+    }
+    flush();
+    if (!CloseHandle(static_cast<HANDLE>(m_file))) [[unlikely]] {
+        m_failed = true;
+    }
+    m_file = nullptr;
+    return !m_failed;
+}
+
+bool BufferedFileWriter::writeToFile(const char* data, size_t size) {
+    if (m_file == nullptr || m_failed) [[unlikely]] {
+        m_failed = true;
+        return false;
+    }
+    // WriteFile takes a DWORD length: split writes larger than 1 GB
+    constexpr size_t MAX_WRITE_BYTES = size_t{1} << 30;
+    while (size > 0) {
+        const auto chunk = static_cast<DWORD>((std::min)(size, MAX_WRITE_BYTES));
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(m_file), data, chunk, &written, nullptr) || written != chunk) [[unlikely]] {
+            m_failed = true;
+            return false;
+        }
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+}  // namespace velocitydb
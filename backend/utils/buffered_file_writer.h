@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Append-only file writer that collects output in one large buffer and flushes it with
+/// buffer-sized WriteFile calls. Intended for multi-GB exports where iostream overhead dominates.
+class BufferedFileWriter {
+public:
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 4 * 1024 * 1024;
+
+    explicit BufferedFileWriter(size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+    ~BufferedFileWriter();
+
+    BufferedFileWriter(const BufferedFileWriter&) = delete;
+    BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+    BufferedFileWriter(BufferedFileWriter&&) = delete;
+    BufferedFileWriter& operator=(BufferedFileWriter&&) = delete;
+
+    /// Create (or truncate) the file at a UTF-8 path. Closes any previously open file first.
+    [[nodiscard]] bool open(const std::string& filepath);
+    [[nodiscard]] bool isOpen() const noexcept { return m_file != nullptr; }
+
+    void append(std::string_view data) {
+        if (data.size() <= m_capacity - m_used) [[likely]] {
+            std::char_traits<char>::copy(m_buffer.get() + m_used, data.data(), data.size());
+            m_used += data.size();
+            return;
+        }
+        appendSlow(data);
+    }
+
+    void append(char c) {
+        if (m_used == m_capacity) [[unlikely]] {
+            flush();
+        }
+        m_buffer[m_used++] = c;
+    }
+
+    /// Write the buffered bytes to the file. Returns false once any write has failed.
+    bool flush();
+    /// Flush and close. Returns false if any write failed.
+    bool close();
+
+    /// Bytes accepted so far, including those still buffered
+    [[nodiscard]] size_t bytesWritten() const noexcept { return m_flushedBytes + m_used; }
+    [[nodiscard]] bool failed() const noexcept { return m_failed; }
+
+private:
+    void appendSlow(std::string_view data);
+    bool writeToFile(const char* data, size_t size);
+
+    void* m_file = nullptr;  // HANDLE; nullptr when closed
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_capacity = 0;
+    size_t m_used = 0;
+    size_t m_flushedBytes = 0;
+    bool m_failed = false;
+};
+
+}  // namespace velocitydb
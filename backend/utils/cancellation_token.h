@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace velocitydb {
+
+/// Rows a pipeline stage (serializer, filter, exporter) gets through between two looks at its cancellation flag
+inline constexpr size_t CANCEL_CHECK_ROWS = 4096;
+
+/// Thrown by a stage that saw its flag raised; same message as a statement stopped by SQLCancel
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Operation canceled") {}
+};
+
+[[nodiscard]] inline bool isCancelRequested(const std::atomic<bool>* flag) noexcept {
+    return flag && flag->load(std::memory_order_acquire);
+}
+
+/// Throws OperationCancelled once `flag` is raised (a null flag never is)
+inline void throwIfCancelled(const std::atomic<bool>* flag) {
+    if (isCancelRequested(flag)) [[unlikely]] {
+        throw OperationCancelled();
+    }
+}
+
+/// One request's cancellation flag, shared by every copy and by whoever cancels it.
+///
+/// Stages take the raw flag (`const std::atomic<bool>*`, nullptr = cannot be cancelled), the way
+/// ExecuteOptions::cancelRequested does, so they do not depend on where the token lives. A default-constructed
+/// token is inert: cancel() does nothing and flag() is nullptr.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    [[nodiscard]] static CancellationToken create() { return CancellationToken(std::make_shared<std::atomic<bool>>(false)); }
+
+    void cancel() const noexcept {
+        if (m_flag) {
+            m_flag->store(true, std::memory_order_release);
+        }
+    }
+
+    [[nodiscard]] bool cancelled() const noexcept { return isCancelRequested(m_flag.get()); }
+    [[nodiscard]] const std::atomic<bool>* flag() const noexcept { return m_flag.get(); }
+    [[nodiscard]] explicit operator bool() const noexcept { return m_flag != nullptr; }
+    [[nodiscard]] bool operator==(const CancellationToken& other) const noexcept { return m_flag == other.m_flag; }
+
+private:
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> flag) noexcept : m_flag(std::move(flag)) {}
+
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+}  // namespace velocitydb
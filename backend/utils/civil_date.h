@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstdint>
+
+namespace velocitydb {
+
+/// Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's algorithm)
+[[nodiscard]] constexpr int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) noexcept {
+    year -= month <= 2 ? 1 : 0;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+/// Civil date of a day count since 1970-01-01, the inverse of daysFromCivil; the time fields are left alone
+constexpr void civilFromDays(int64_t days, DateTimeValue& out) noexcept {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto dayOfEra = static_cast<uint64_t>(days - era * 146097);
+    const uint64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const uint64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const uint64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    const auto month = static_cast<uint8_t>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    out.year = static_cast<int16_t>(static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0));
+    out.month = month;
+    out.day = static_cast<uint8_t>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,87 @@
+#include "clipboard.h"
+
+#include <Windows.h>
+
+#include <climits>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+/// Another application may hold the clipboard open for a moment (clipboard managers read every change)
+constexpr int OPEN_ATTEMPTS = 10;
+constexpr DWORD OPEN_RETRY_MS = 10;
+
+/// Hidden message-only window owning the clipboard while it is open. With no owner, EmptyClipboard leaves the
+/// clipboard ownerless and SetClipboardData fails; this thread has no window of its own to use.
+class OwnerWindow {
+public:
+    OwnerWindow() : m_hwnd(CreateWindowExW(0, L"STATIC", nullptr, 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, GetModuleHandleW(nullptr), nullptr)) {}
+    ~OwnerWindow() {
+        if (m_hwnd) {
+            DestroyWindow(m_hwnd);
+        }
+    }
+
+    OwnerWindow(const OwnerWindow&) = delete;
+    OwnerWindow& operator=(const OwnerWindow&) = delete;
+
+    [[nodiscard]] HWND get() const noexcept { return m_hwnd; }
+
+private:
+    HWND m_hwnd;
+};
+
+}  // namespace
+
+std::expected<void, std::string> Clipboard::setText(std::string_view utf8) {
+    if (utf8.size() > static_cast<size_t>(INT_MAX)) [[unlikely]] {
+        return std::unexpected("Selection is too large for the clipboard");
+    }
+    const int length = static_cast<int>(utf8.size());
+    const int units = length == 0 ? 0 : MultiByteToWideChar(CP_UTF8, 0, utf8.data(), length, nullptr, 0);
+    if (length > 0 && units == 0) [[unlikely]] {
+        return std::unexpected(std::format("Failed to convert text for the clipboard (error {})", GetLastError()));
+    }
+
+    HGLOBAL memory = GlobalAlloc(GMEM_MOVEABLE, (static_cast<size_t>(units) + 1) * sizeof(wchar_t));
+    if (!memory) [[unlikely]] {
+        return std::unexpected("Not enough memory to copy the selection");
+    }
+    auto* text = static_cast<wchar_t*>(GlobalLock(memory));
+    if (!text) [[unlikely]] {
+        GlobalFree(memory);
+        return std::unexpected("Not enough memory to copy the selection");
+    }
+    if (units > 0) {
+        MultiByteToWideChar(CP_UTF8, 0, utf8.data(), length, text, units);
+    }
+    text[units] = L'\0';
+    GlobalUnlock(memory);
+
+    OwnerWindow owner;
+    bool opened = false;
+    for (int attempt = 0; attempt < OPEN_ATTEMPTS && !opened; ++attempt) {
+        if (attempt > 0) {
+            Sleep(OPEN_RETRY_MS);
+        }
+        opened = OpenClipboard(owner.get()) != FALSE;
+    }
+    if (!opened) [[unlikely]] {
+        GlobalFree(memory);
+        return std::unexpected("The clipboard is in use by another application");
+    }
+    EmptyClipboard();
+    // On success the clipboard owns the memory; it must not be freed here
+    const bool stored = SetClipboardData(CF_UNICODETEXT, memory) != nullptr;
+    const DWORD error = stored ? 0 : GetLastError();
+    CloseClipboard();
+    if (!stored) [[unlikely]] {
+        GlobalFree(memory);
+        return std::unexpected(std::format("Failed to set clipboard data (error {})", error));
+    }
+    return {};
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Windows clipboard access from any thread
+class Clipboard {
+public:
+    /// Replace the clipboard contents with `utf8` as CF_UNICODETEXT. The text is transcoded straight into the
+    /// global memory block handed to the clipboard, so it is never held twice as UTF-16.
+    [[nodiscard]] static std::expected<void, std::string> setText(std::string_view utf8);
+};
+
+}  // namespace velocitydb
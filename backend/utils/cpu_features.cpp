@@ -0,0 +1,102 @@
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef VELOCITYDB_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace velocitydb {
+
+namespace {
+
+[[nodiscard]] SimdLevel probeCpu() noexcept {
+#if defined(VELOCITYDB_SIMD_X86) && !defined(VELOCITYDB_DISABLE_SIMD)
+    auto cpuid = [](int leaf, int subleaf, int (&regs)[4]) {
+#ifdef _MSC_VER
+        __cpuidex(regs, leaf, subleaf);
+#else
+        unsigned a = 0, b = 0, c = 0, d = 0;
+        __cpuid_count(leaf, subleaf, a, b, c, d);
+        regs[0] = static_cast<int>(a);
+        regs[1] = static_cast<int>(b);
+        regs[2] = static_cast<int>(c);
+        regs[3] = static_cast<int>(d);
+#endif
+    };
+    auto xgetbv = []() -> uint64_t {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned lo = 0, hi = 0;
+        __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+    };
+
+    int regs[4] = {};
+    cpuid(0, 0, regs);
+    const int maxLeaf = regs[0];
+    cpuid(1, 0, regs);
+    const bool sse42 = (regs[2] & (1 << 20)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    if (!sse42) {
+        return SimdLevel::Scalar;
+    }
+    // The OS must save the wide registers on context switch, or using them corrupts state
+    const uint64_t xcr0 = osxsave ? xgetbv() : 0;
+    const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+    if (maxLeaf < 7 || !ymmEnabled) {
+        return SimdLevel::SSE42;
+    }
+    cpuid(7, 0, regs);
+    const bool avx2 = (regs[1] & (1 << 5)) != 0;
+    const bool avx512f = (regs[1] & (1 << 16)) != 0;
+    const bool avx512bw = (regs[1] & (1 << 30)) != 0;
+    if (avx512f && avx512bw && zmmEnabled) {
+        return SimdLevel::AVX512;
+    }
+    return avx2 ? SimdLevel::AVX2 : SimdLevel::SSE42;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const SimdLevel g_detectedLevel = probeCpu();
+std::atomic<SimdLevel> g_activeLevel{g_detectedLevel};
+
+}  // namespace
+
+SimdLevel detectedSimdLevel() noexcept {
+    return g_detectedLevel;
+}
+
+SimdLevel activeSimdLevel() noexcept {
+    return g_activeLevel.load(std::memory_order_relaxed);
+}
+
+void limitSimdLevel(SimdLevel level) noexcept {
+    g_activeLevel.store((std::min)(level, g_detectedLevel), std::memory_order_relaxed);
+}
+
+std::string_view simdLevelName(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::AVX512:
+            return "avx512";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::SSE42:
+            return "sse4.2";
+        case SimdLevel::Scalar:
+            break;
+    }
+    return "scalar";
+}
+
+}  // namespace velocitydb
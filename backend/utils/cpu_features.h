@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VELOCITYDB_SIMD_X86 1
+#endif
+
+// Kernels for every level are compiled into one binary whose baseline stays x64 (SSE2). GCC/Clang only emit
+// wider instructions inside functions that opt in; MSVC accepts the intrinsics anywhere.
+#if defined(VELOCITYDB_SIMD_X86) && !defined(_MSC_VER)
+#define VELOCITYDB_TARGET(isa) __attribute__((target(isa)))
+#else
+#define VELOCITYDB_TARGET(isa)
+#endif
+
+namespace velocitydb {
+
+/// Widest instruction set the SIMD kernels may use, in increasing order
+enum class SimdLevel : uint8_t { Scalar, SSE42, AVX2, AVX512 };
+
+/// Best level this CPU and OS support, probed once through CPUID/XGETBV (AVX-512 means F and BW).
+/// Scalar on other architectures and when the build sets ENABLE_SIMD=OFF.
+[[nodiscard]] SimdLevel detectedSimdLevel() noexcept;
+/// Level the kernels dispatch on: detectedSimdLevel() unless capped
+[[nodiscard]] SimdLevel activeSimdLevel() noexcept;
+/// Cap every kernel at `level` (clamped to detectedSimdLevel()); for tests and per-variant benchmarks
+void limitSimdLevel(SimdLevel level) noexcept;
+[[nodiscard]] std::string_view simdLevelName(SimdLevel level) noexcept;
+
+}  // namespace velocitydb
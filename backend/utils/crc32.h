@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace velocitydb {
+
+/// CRC-32 (IEEE 802.3, reflected, polynomial 0xEDB88320) as used by ZIP and gzip
+inline constexpr std::array<uint32_t, 256> CRC32_TABLE = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+/// Continue `crc` (0 for a fresh checksum) over `data`
+[[nodiscard]] inline uint32_t updateCrc32(uint32_t crc, std::string_view data) noexcept {
+    crc = ~crc;
+    for (unsigned char c : data) {
+        crc = CRC32_TABLE[(crc ^ c) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+}  // namespace velocitydb
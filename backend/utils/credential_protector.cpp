@@ -2,7 +2,11 @@
 
 #include <Windows.h>
 
+#include <algorithm>
 #include <array>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include <wincrypt.h>
@@ -11,6 +15,89 @@
 
 namespace velocitydb {
 
+namespace {
+
+/// A decrypted secret, padded to CRYPTPROTECTMEMORY_BLOCK_SIZE and encrypted with CryptProtectMemory
+struct CachedSecret {
+    std::vector<BYTE> sealed;
+    size_t length = 0;
+    std::chrono::steady_clock::time_point expires;
+};
+
+struct SecretCache {
+    std::mutex mutex;
+    std::unordered_map<std::string, CachedSecret> byCiphertext;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+SecretCache& secretCache() {
+    static SecretCache cache;
+    return cache;
+}
+
+void wipe(CachedSecret& secret) {
+    SecureZeroMemory(secret.sealed.data(), secret.sealed.size());
+}
+
+/// The cached plaintext for `ciphertext`, if it has not expired; caller holds the cache mutex
+std::optional<std::string> lookupSecret(SecretCache& cache, std::string_view ciphertext, std::chrono::steady_clock::time_point now) {
+    auto found = cache.byCiphertext.find(std::string(ciphertext));
+    if (found == cache.byCiphertext.end()) {
+        return std::nullopt;
+    }
+    if (found->second.expires <= now) {
+        wipe(found->second);
+        cache.byCiphertext.erase(found);
+        return std::nullopt;
+    }
+
+    // Unseal a copy; the cached block stays encrypted
+    auto block = found->second.sealed;
+    if (!CryptUnprotectMemory(block.data(), static_cast<DWORD>(block.size()), CRYPTPROTECTMEMORY_SAME_PROCESS)) [[unlikely]] {
+        SecureZeroMemory(block.data(), block.size());
+        return std::nullopt;
+    }
+    std::string plaintext(reinterpret_cast<const char*>(block.data()), found->second.length);
+    SecureZeroMemory(block.data(), block.size());
+    return plaintext;
+}
+
+/// Seal `plaintext` into the cache; caller holds the cache mutex
+void storeSecret(SecretCache& cache, std::string_view ciphertext, std::string_view plaintext, std::chrono::steady_clock::time_point now) {
+    if (cache.byCiphertext.size() >= CredentialProtector::MAX_CACHED_SECRETS) {
+        std::erase_if(cache.byCiphertext, [now](auto& entry) {
+            if (entry.second.expires > now) {
+                return false;
+            }
+            wipe(entry.second);
+            return true;
+        });
+        if (cache.byCiphertext.size() >= CredentialProtector::MAX_CACHED_SECRETS) {
+            return;  // Full of live secrets; this one just isn't cached
+        }
+    }
+
+    CachedSecret secret;
+    const size_t blocks = plaintext.size() / CRYPTPROTECTMEMORY_BLOCK_SIZE + 1;
+    secret.sealed.assign(blocks * CRYPTPROTECTMEMORY_BLOCK_SIZE, 0);
+    std::copy(plaintext.begin(), plaintext.end(), secret.sealed.begin());
+    secret.length = plaintext.size();
+    secret.expires = now + CredentialProtector::CACHE_TTL;
+    if (!CryptProtectMemory(secret.sealed.data(), static_cast<DWORD>(secret.sealed.size()), CRYPTPROTECTMEMORY_SAME_PROCESS)) [[unlikely]] {
+        wipe(secret);
+        return;
+    }
+    if (auto found = cache.byCiphertext.find(std::string(ciphertext)); found != cache.byCiphertext.end()) {
+        wipe(found->second);
+        found->second = std::move(secret);
+    } else {
+        cache.byCiphertext.emplace(std::string(ciphertext), std::move(secret));
+    }
+}
+
+}  // namespace
+
 std::expected<std::string, std::string> CredentialProtector::encrypt(std::string_view plaintext) {
     if (plaintext.empty()) {
         return std::string{};  // Empty password returns empty string
@@ -35,11 +122,21 @@ std::expected<std::string, std::string> CredentialProtector::encrypt(std::string
     return base64Encode(encrypted);
 }
 
-std::expected<std::string, std::string> CredentialProtector::decrypt(std::string_view encryptedBase64) {
+std::expected<std::string, std::string> CredentialProtector::decrypt(std::string_view encryptedBase64, std::chrono::steady_clock::time_point now) {
     if (encryptedBase64.empty()) {
         return std::string{};  // Empty encrypted string returns empty password
     }
 
+    auto& cache = secretCache();
+    {
+        std::lock_guard lock(cache.mutex);
+        if (auto cached = lookupSecret(cache, encryptedBase64, now)) {
+            ++cache.hits;
+            return std::move(*cached);
+        }
+        ++cache.misses;
+    }
+
     auto decodedResult = base64Decode(encryptedBase64);
     if (!decodedResult) {
         return std::unexpected(decodedResult.error());
@@ -63,9 +160,28 @@ std::expected<std::string, std::string> CredentialProtector::decrypt(std::string
     SecureZeroMemory(outputBlob.pbData, outputBlob.cbData);  // Clear sensitive data before freeing
     LocalFree(outputBlob.pbData);
 
+    {
+        std::lock_guard lock(cache.mutex);
+        storeSecret(cache, encryptedBase64, decrypted, now);
+    }
     return decrypted;
 }
 
+void CredentialProtector::clearCache() {
+    auto& cache = secretCache();
+    std::lock_guard lock(cache.mutex);
+    for (auto& [ciphertext, secret] : cache.byCiphertext) {
+        wipe(secret);
+    }
+    cache.byCiphertext.clear();
+}
+
+CredentialProtector::CacheStats CredentialProtector::cacheStats() {
+    auto& cache = secretCache();
+    std::lock_guard lock(cache.mutex);
+    return {.hits = cache.hits, .misses = cache.misses, .entries = cache.byCiphertext.size()};
+}
+
 std::string CredentialProtector::base64Encode(const std::vector<unsigned char>& data) {
     if (data.empty()) {
         return {};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <expected>
 #include <string>
 #include <string_view>
@@ -10,8 +12,20 @@ namespace velocitydb {
 /// Utility class for encrypting/decrypting credentials using Windows DPAPI.
 /// DPAPI binds encryption to the current user, so encrypted data can only
 /// be decrypted by the same user on the same machine.
+///
+/// Decrypted secrets are kept for CACHE_TTL, keyed by their ciphertext and encrypted in place with
+/// CryptProtectMemory (same-process scope), so reconnect bursts skip the DPAPI round trip.
 class CredentialProtector {
 public:
+    static constexpr std::chrono::minutes CACHE_TTL{5};
+    static constexpr size_t MAX_CACHED_SECRETS = 64;
+
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entries = 0;
+    };
+
     /// Encrypt plaintext password using DPAPI
     /// @param plaintext The password to encrypt
     /// @return Base64-encoded encrypted data, or error message
@@ -19,8 +33,14 @@ public:
 
     /// Decrypt password that was encrypted with encrypt()
     /// @param encryptedBase64 Base64-encoded encrypted data from encrypt()
+    /// @param now Compared against the cached entry's expiry
     /// @return Decrypted plaintext password, or error message
-    [[nodiscard]] static std::expected<std::string, std::string> decrypt(std::string_view encryptedBase64);
+    [[nodiscard]] static std::expected<std::string, std::string> decrypt(std::string_view encryptedBase64, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    /// Wipe and forget every cached secret; called when profiles change and at shutdown
+    static void clearCache();
+
+    [[nodiscard]] static CacheStats cacheStats();
 
 private:
     [[nodiscard]] static std::string base64Encode(const std::vector<unsigned char>& data);
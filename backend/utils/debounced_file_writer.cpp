@@ -0,0 +1,143 @@
+#include "debounced_file_writer.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <fstream>
+
+namespace velocitydb {
+
+DebouncedFileWriter::DebouncedFileWriter(std::filesystem::path path, Serializer serializer, std::chrono::milliseconds debounce, std::chrono::milliseconds maxDelay, Written onWritten)
+    : m_path(std::move(path)), m_serializer(std::move(serializer)), m_onWritten(std::move(onWritten)), m_debounce(debounce), m_maxDelay((std::max)(debounce, maxDelay)) {
+    m_thread = std::thread([this] { run(); });
+}
+
+DebouncedFileWriter::~DebouncedFileWriter() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    flush();
+}
+
+void DebouncedFileWriter::schedule() {
+    {
+        std::lock_guard lock(m_mutex);
+        const auto now = std::chrono::steady_clock::now();
+        m_dirty = true;
+        if (!m_firstRequest) {
+            m_firstRequest = now;
+        }
+        m_deadline = (std::min)(now + m_debounce, *m_firstRequest + m_maxDelay);
+    }
+    m_wake.notify_all();
+}
+
+void DebouncedFileWriter::markDirty() {
+    std::lock_guard lock(m_mutex);
+    m_dirty = true;
+}
+
+void DebouncedFileWriter::setPeriod(std::chrono::milliseconds period) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_period = period;
+    }
+    m_wake.notify_all();
+}
+
+bool DebouncedFileWriter::flush() {
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_dirty) {
+            return true;
+        }
+        m_dirty = false;
+        m_firstRequest.reset();
+        m_lastWrite = std::chrono::steady_clock::now();
+    }
+    return write();
+}
+
+void DebouncedFileWriter::run() {
+    std::unique_lock lock(m_mutex);
+    while (!m_stopping) {
+        // Next due write: the debounce deadline, or the periodic one while there are unsaved changes
+        std::optional<std::chrono::steady_clock::time_point> due;
+        if (m_firstRequest) {
+            due = m_deadline;
+        }
+        if (m_dirty && m_period.count() > 0) {
+            due = (std::min)(due.value_or(std::chrono::steady_clock::time_point::max()), m_lastWrite + m_period);
+        }
+
+        if (!due) {
+            m_wake.wait(lock);
+            continue;
+        }
+        if (std::chrono::steady_clock::now() < *due) {
+            // Woken early by a new request or setting: re-evaluate the deadline
+            m_wake.wait_until(lock, *due);
+            continue;
+        }
+
+        m_dirty = false;
+        m_firstRequest.reset();
+        m_lastWrite = std::chrono::steady_clock::now();
+        lock.unlock();
+        write();
+        lock.lock();
+    }
+}
+
+bool DebouncedFileWriter::write() {
+    std::lock_guard writeLock(m_writeMutex);
+    const auto content = m_serializer();
+    if (content.empty()) {
+        return false;  // Serialization failed — preserve existing file
+    }
+    if (!writeAtomically(m_path, content)) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Could not save {}", m_path.string()));
+        // Kept dirty, so the next request or periodic write tries again
+        std::lock_guard lock(m_mutex);
+        m_dirty = true;
+        return false;
+    }
+    if (m_onWritten) {
+        m_onWritten();
+    }
+    return true;
+}
+
+bool DebouncedFileWriter::writeAtomically(const std::filesystem::path& path, std::string_view content) {
+    static std::atomic<uint64_t> tempSequence{0};
+    auto temporary = path;
+    temporary += std::format(".{}.tmp", tempSequence.fetch_add(1, std::memory_order_relaxed));
+    std::error_code ec;
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        out.flush();
+        if (!out) [[unlikely]] {
+            out.close();
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    // Rename over the old file, so a crash leaves one complete file or the other
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) [[unlikely]] {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace velocitydb
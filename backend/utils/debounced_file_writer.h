@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace velocitydb {
+
+/// Persists one small document (settings, session) from a background thread.
+///
+/// Rapid save requests are coalesced: the file is rewritten `debounce` after the last schedule() call, but
+/// no later than `maxDelay` after the first, so a steady stream of updates still reaches the disk. The
+/// document is serialized on the worker, written to a temporary file and renamed over the old copy, so a
+/// crash leaves one complete version or the other.
+class DebouncedFileWriter {
+public:
+    /// Produces the document to write; an empty result skips the write
+    using Serializer = std::function<std::string()>;
+    /// Runs after each successful write, on the writing thread and before the next serialization
+    using Written = std::function<void()>;
+
+    static constexpr auto DEFAULT_DEBOUNCE = std::chrono::milliseconds{500};
+    static constexpr auto DEFAULT_MAX_DELAY = std::chrono::milliseconds{5000};
+
+    DebouncedFileWriter(std::filesystem::path path, Serializer serializer, std::chrono::milliseconds debounce = DEFAULT_DEBOUNCE,
+                        std::chrono::milliseconds maxDelay = DEFAULT_MAX_DELAY, Written onWritten = nullptr);
+    /// Writes any pending change before returning
+    ~DebouncedFileWriter();
+
+    DebouncedFileWriter(const DebouncedFileWriter&) = delete;
+    DebouncedFileWriter& operator=(const DebouncedFileWriter&) = delete;
+    DebouncedFileWriter(DebouncedFileWriter&&) = delete;
+    DebouncedFileWriter& operator=(DebouncedFileWriter&&) = delete;
+
+    /// Request a write; returns immediately
+    void schedule();
+    /// Note a change without requesting a write: it is picked up by the next periodic write, schedule() or flush()
+    void markDirty();
+    /// Write dirty state every `period` (zero disables periodic writes)
+    void setPeriod(std::chrono::milliseconds period);
+
+    /// Write pending changes now on the calling thread. True when nothing was pending or the write succeeded.
+    bool flush();
+
+    [[nodiscard]] const std::filesystem::path& path() const noexcept { return m_path; }
+
+    /// Write `content` to a sibling temporary file and rename it over `path`
+    [[nodiscard]] static bool writeAtomically(const std::filesystem::path& path, std::string_view content);
+
+private:
+    void run();
+    /// Serialize and write; the caller has already cleared the dirty state
+    bool write();
+
+    const std::filesystem::path m_path;
+    const Serializer m_serializer;
+    const Written m_onWritten;
+    const std::chrono::milliseconds m_debounce;
+    const std::chrono::milliseconds m_maxDelay;
+
+    std::mutex m_writeMutex;  // Orders writes, so the last one always carries the newest snapshot
+
+    std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_wake;
+    bool m_dirty = false;
+    std::optional<std::chrono::steady_clock::time_point> m_firstRequest;  ///< Oldest schedule() not yet written
+    std::chrono::steady_clock::time_point m_deadline;                     ///< Valid while m_firstRequest is set
+    std::chrono::milliseconds m_period{0};
+    std::chrono::steady_clock::time_point m_lastWrite = std::chrono::steady_clock::now();
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+}  // namespace velocitydb
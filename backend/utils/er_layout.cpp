@@ -0,0 +1,391 @@
+#include "er_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr double HEADER_HEIGHT = 28.0;
+constexpr double ROW_HEIGHT = 18.0;
+constexpr double GLYPH_WIDTH = 7.0;
+constexpr double PADDING = 16.0;
+constexpr double MIN_WIDTH = 120.0;
+constexpr double MAX_WIDTH = 480.0;
+
+/// Space kept between two boxes
+constexpr double GAP = 40.0;
+/// Margin left above and to the left of a freshly laid out diagram
+constexpr double MARGIN = 40.0;
+/// Pull toward the center per unit of distance. It balances the summed repulsion, keeping unrelated components
+/// together and the diagram at about five times the tables' own area
+constexpr double GRAVITY = 2.0;
+/// Tables moved per iteration before the force computation is split across threads
+constexpr size_t PARALLEL_MIN_TABLES = 256;
+/// Bodies a quadtree leaf holds before it is split
+constexpr uint32_t LEAF_BODIES = 4;
+constexpr int MAX_TREE_DEPTH = 24;
+constexpr int MAX_OVERLAP_PASSES = 200;
+/// pi * (3 - sqrt(5)): successive seeds on it never line up
+constexpr double GOLDEN_ANGLE = 2.399963229728653;
+
+/// Center of a table's box while laying out
+struct Body {
+    double x = 0;
+    double y = 0;
+    double width = 0;
+    double height = 0;
+    bool fixed = false;
+};
+
+/// Barnes-Hut quadtree over the body centers, each body of unit mass
+class QuadTree {
+public:
+    void build(const std::vector<Body>& bodies) {
+        m_cells.clear();
+        m_order.resize(bodies.size());
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        double minX = bodies[0].x, minY = bodies[0].y, maxX = minX, maxY = minY;
+        for (const auto& body : bodies) {
+            minX = (std::min)(minX, body.x);
+            minY = (std::min)(minY, body.y);
+            maxX = (std::max)(maxX, body.x);
+            maxY = (std::max)(maxY, body.y);
+        }
+        m_cells.emplace_back();
+        buildCell(bodies, 0, 0, static_cast<uint32_t>(bodies.size()), minX, minY, (std::max)({maxX - minX, maxY - minY, 1.0}), 0);
+    }
+
+    /// Repulsion on body `self`: k^2 / d away from every other body, cells far enough away taken as one
+    void repulsion(const std::vector<Body>& bodies, uint32_t self, double k2, double theta2, double& fx, double& fy) const {
+        const auto& body = bodies[self];
+        uint32_t stack[4 * MAX_TREE_DEPTH + 4];
+        size_t depth = 0;
+        stack[depth++] = 0;
+        const auto push = [&](double dx, double dy, double mass, uint32_t other) {
+            double d2 = dx * dx + dy * dy;
+            if (d2 < 1e-6) {
+                // Coincident bodies: separate them along a direction fixed by their order
+                dx = self < other ? -1.0 : 1.0;
+                dy = self < other ? -0.5 : 0.5;
+                d2 = 1.25;
+            }
+            const double force = k2 * mass / d2;
+            fx += dx * force;
+            fy += dy * force;
+        };
+        while (depth > 0) {
+            const auto& cell = m_cells[stack[--depth]];
+            if (cell.firstChild < 0) {
+                for (uint32_t i = cell.begin; i < cell.end; ++i) {
+                    if (const auto other = m_order[i]; other != self) {
+                        push(body.x - bodies[other].x, body.y - bodies[other].y, 1.0, other);
+                    }
+                }
+                continue;
+            }
+            const double dx = body.x - cell.massX;
+            const double dy = body.y - cell.massY;
+            const double d2 = dx * dx + dy * dy;
+            if (cell.size * cell.size < theta2 * d2) {
+                push(dx, dy, cell.mass, self);
+                continue;
+            }
+            for (int child = 0; child < 4; ++child) {
+                if (m_cells[static_cast<size_t>(cell.firstChild + child)].mass > 0) {
+                    stack[depth++] = static_cast<uint32_t>(cell.firstChild + child);
+                }
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        double size = 0;
+        double massX = 0;
+        double massY = 0;
+        double mass = 0;
+        int32_t firstChild = -1;  ///< Four consecutive cells; -1 for a leaf
+        uint32_t begin = 0;       ///< A leaf's bodies: m_order[begin, end)
+        uint32_t end = 0;
+    };
+
+    void buildCell(const std::vector<Body>& bodies, size_t index, uint32_t begin, uint32_t end, double x0, double y0, double size, int depth) {
+        double sumX = 0;
+        double sumY = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            sumX += bodies[m_order[i]].x;
+            sumY += bodies[m_order[i]].y;
+        }
+        const double mass = end - begin;
+        m_cells[index] = Cell{.size = size, .massX = mass > 0 ? sumX / mass : 0, .massY = mass > 0 ? sumY / mass : 0, .mass = mass, .begin = begin, .end = end};
+        if (end - begin <= LEAF_BODIES || depth >= MAX_TREE_DEPTH) {
+            return;
+        }
+
+        const double half = size / 2;
+        const auto first = m_order.begin();
+        const auto byX = std::partition(first + begin, first + end, [&](uint32_t id) { return bodies[id].x < x0 + half; });
+        const auto left = std::partition(first + begin, byX, [&](uint32_t id) { return bodies[id].y < y0 + half; });
+        const auto right = std::partition(byX, first + end, [&](uint32_t id) { return bodies[id].y < y0 + half; });
+        const uint32_t bounds[5] = {begin, static_cast<uint32_t>(left - first), static_cast<uint32_t>(byX - first), static_cast<uint32_t>(right - first), end};
+
+        const auto firstChild = m_cells.size();
+        m_cells.resize(firstChild + 4);
+        m_cells[index].firstChild = static_cast<int32_t>(firstChild);
+        for (int child = 0; child < 4; ++child) {
+            buildCell(bodies, firstChild + child, bounds[child], bounds[child + 1], x0 + (child >= 2 ? half : 0), y0 + (child % 2 == 1 ? half : 0), half, depth + 1);
+        }
+    }
+
+    std::vector<Cell> m_cells;
+    std::vector<uint32_t> m_order;
+};
+
+[[nodiscard]] std::string fold(std::string_view text) {
+    std::string folded(text);
+    for (auto& c : folded) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return folded;
+}
+
+/// Undirected, deduplicated foreign key graph by table index
+[[nodiscard]] std::vector<std::vector<uint32_t>> neighborsOf(const ERModel& model) {
+    std::unordered_map<std::string, uint32_t> byName;
+    for (uint32_t i = 0; i < model.tables.size(); ++i) {
+        byName.emplace(fold(model.tables[i].name), i);
+    }
+    std::vector<std::vector<uint32_t>> neighbors(model.tables.size());
+    std::unordered_set<uint64_t> seen;
+    for (const auto& relation : model.relations) {
+        auto parent = byName.find(fold(relation.parentTable));
+        auto child = byName.find(fold(relation.childTable));
+        if (parent == byName.end() || child == byName.end() || parent->second == child->second) {
+            continue;
+        }
+        const auto a = (std::min)(parent->second, child->second);
+        const auto b = (std::max)(parent->second, child->second);
+        if (seen.insert((static_cast<uint64_t>(a) << 32) | b).second) {
+            neighbors[a].push_back(b);
+            neighbors[b].push_back(a);
+        }
+    }
+    return neighbors;
+}
+
+/// First positions of the tables to place, in breadth-first order so related tables start close together: next
+/// to the tables already placed around them, or on a sunflower spiral around `center`
+void seedPositions(std::vector<Body>& bodies, const std::vector<std::vector<uint32_t>>& neighbors, double k, double centerX, double centerY) {
+    std::vector<bool> placed(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        placed[i] = bodies[i].fixed;
+    }
+    std::vector<bool> queued(bodies.size());
+    std::vector<uint32_t> queue;
+    size_t spiral = 0;
+    for (uint32_t root = 0; root < bodies.size(); ++root) {
+        if (queued[root]) {
+            continue;
+        }
+        queue.assign(1, root);
+        queued[root] = true;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const auto id = queue[head];
+            for (const auto next : neighbors[id]) {
+                if (!queued[next]) {
+                    queued[next] = true;
+                    queue.push_back(next);
+                }
+            }
+            if (placed[id]) {
+                continue;
+            }
+            double sumX = 0;
+            double sumY = 0;
+            size_t count = 0;
+            for (const auto next : neighbors[id]) {
+                if (placed[next]) {
+                    sumX += bodies[next].x;
+                    sumY += bodies[next].y;
+                    ++count;
+                }
+            }
+            const double angle = static_cast<double>(id) * GOLDEN_ANGLE;
+            if (count > 0) {
+                bodies[id].x = sumX / static_cast<double>(count) + k * std::cos(angle);
+                bodies[id].y = sumY / static_cast<double>(count) + k * std::sin(angle);
+            } else {
+                const double radius = k * std::sqrt(static_cast<double>(spiral++) + 0.5);
+                bodies[id].x = centerX + radius * std::cos(angle);
+                bodies[id].y = centerY + radius * std::sin(angle);
+            }
+            placed[id] = true;
+        }
+    }
+}
+
+/// Push apart boxes closer than GAP (a fixed box does not move), sweeping over boxes sorted by their left edge
+void removeOverlaps(std::vector<Body>& bodies) {
+    std::vector<uint32_t> order(bodies.size());
+    std::iota(order.begin(), order.end(), 0u);
+    for (int pass = 0; pass < MAX_OVERLAP_PASSES; ++pass) {
+        std::ranges::sort(order, [&](uint32_t a, uint32_t b) { return bodies[a].x - bodies[a].width / 2 < bodies[b].x - bodies[b].width / 2; });
+        bool moved = false;
+        for (size_t a = 0; a < order.size(); ++a) {
+            auto& first = bodies[order[a]];
+            for (size_t b = a + 1; b < order.size(); ++b) {
+                auto& second = bodies[order[b]];
+                if (second.x - second.width / 2 >= first.x + first.width / 2 + GAP) {
+                    break;
+                }
+                if (first.fixed && second.fixed) {
+                    continue;
+                }
+                const double dx = second.x - first.x;
+                const double dy = second.y - first.y;
+                const double overlapX = (first.width + second.width) / 2 + GAP - std::abs(dx);
+                const double overlapY = (first.height + second.height) / 2 + GAP - std::abs(dy);
+                if (overlapX <= 0 || overlapY <= 0) {
+                    continue;
+                }
+                // Along the axis needing the shorter move, split between the boxes that may move
+                const double firstShare = first.fixed ? 0.0 : second.fixed ? 1.0 : 0.5;
+                if (overlapX <= overlapY) {
+                    const double direction = dx > 0 || (dx == 0 && order[a] < order[b]) ? 1.0 : -1.0;
+                    first.x -= direction * overlapX * firstShare;
+                    second.x += direction * overlapX * (1.0 - firstShare);
+                } else {
+                    const double direction = dy > 0 || (dy == 0 && order[a] < order[b]) ? 1.0 : -1.0;
+                    first.y -= direction * overlapY * firstShare;
+                    second.y += direction * overlapY * (1.0 - firstShare);
+                }
+                moved = true;
+            }
+        }
+        if (!moved) {
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+ERTableSize erTableSize(const ERModelTable& table) noexcept {
+    size_t widest = (std::max)(table.name.size(), table.logicalName.size());
+    for (const auto& column : table.columns) {
+        widest = (std::max)(widest, column.name.size() + column.type.size() + 2);
+    }
+    return ERTableSize{.width = std::clamp(static_cast<double>(widest) * GLYPH_WIDTH + PADDING, MIN_WIDTH, MAX_WIDTH),
+                       .height = HEADER_HEIGHT + static_cast<double>(table.columns.size()) * ROW_HEIGHT + PADDING / 2};
+}
+
+size_t layoutERModel(ERModel& model, const ERLayoutOptions& options) {
+    auto& tables = model.tables;
+    std::vector<Body> bodies(tables.size());
+    std::vector<uint32_t> moving;
+    double sizeSum = 0;
+    double fixedX = 0;
+    double fixedY = 0;
+    for (uint32_t i = 0; i < tables.size(); ++i) {
+        const auto size = erTableSize(tables[i]);
+        auto& body = bodies[i];
+        body.width = size.width;
+        body.height = size.height;
+        body.fixed = !options.relayoutAll && (tables[i].posX != 0 || tables[i].posY != 0);
+        if (body.fixed) {
+            body.x = tables[i].posX + size.width / 2;
+            body.y = tables[i].posY + size.height / 2;
+            fixedX += body.x;
+            fixedY += body.y;
+        } else {
+            moving.push_back(i);
+        }
+        sizeSum += (std::max)(size.width, size.height);
+    }
+    if (moving.empty()) {
+        return 0;
+    }
+
+    // Ideal distance between the centers of related tables
+    const double k = sizeSum / static_cast<double>(tables.size()) + GAP;
+    const auto fixedCount = static_cast<double>(tables.size() - moving.size());
+    const double centerX = fixedCount > 0 ? fixedX / fixedCount : 0;
+    const double centerY = fixedCount > 0 ? fixedY / fixedCount : 0;
+    const auto neighbors = neighborsOf(model);
+    seedPositions(bodies, neighbors, k, centerX, centerY);
+
+    QuadTree tree;
+    const double k2 = k * k;
+    const double theta2 = options.theta * options.theta;
+    const double startTemperature = k * std::sqrt(static_cast<double>(moving.size())) / 4;
+    const double endTemperature = k / 50;
+    std::vector<std::pair<double, double>> next(bodies.size());
+    const auto step = [&](uint32_t id, double temperature) {
+        const auto& body = bodies[id];
+        double fx = 0;
+        double fy = 0;
+        tree.repulsion(bodies, id, k2, theta2, fx, fy);
+        for (const auto other : neighbors[id]) {
+            const double dx = bodies[other].x - body.x;
+            const double dy = bodies[other].y - body.y;
+            const double d = std::sqrt(dx * dx + dy * dy);
+            fx += dx * d / k;
+            fy += dy * d / k;
+        }
+        fx += (centerX - body.x) * GRAVITY;
+        fy += (centerY - body.y) * GRAVITY;
+        const double length = std::sqrt(fx * fx + fy * fy);
+        const double scale = length > temperature ? temperature / length : 1.0;
+        next[id] = {body.x + fx * scale, body.y + fy * scale};
+    };
+
+    for (size_t iteration = 0; iteration < options.iterations; ++iteration) {
+        const double progress = static_cast<double>(iteration) / static_cast<double>(options.iterations);
+        const double temperature = startTemperature * (1.0 - progress) + endTemperature;
+        tree.build(bodies);
+        if (moving.size() >= PARALLEL_MIN_TABLES) {
+            std::for_each(std::execution::par, moving.begin(), moving.end(), [&](uint32_t id) { step(id, temperature); });
+        } else {
+            for (const auto id : moving) {
+                step(id, temperature);
+            }
+        }
+        for (const auto id : moving) {
+            bodies[id].x = next[id].first;
+            bodies[id].y = next[id].second;
+        }
+    }
+    removeOverlaps(bodies);
+
+    // A diagram laid out from scratch starts at the top-left corner
+    double shiftX = 0;
+    double shiftY = 0;
+    if (fixedCount == 0) {
+        double minX = bodies[0].x - bodies[0].width / 2;
+        double minY = bodies[0].y - bodies[0].height / 2;
+        for (const auto& body : bodies) {
+            minX = (std::min)(minX, body.x - body.width / 2);
+            minY = (std::min)(minY, body.y - body.height / 2);
+        }
+        shiftX = MARGIN - minX;
+        shiftY = MARGIN - minY;
+    }
+    for (const auto id : moving) {
+        tables[id].posX = std::round(bodies[id].x - bodies[id].width / 2 + shiftX);
+        tables[id].posY = std::round(bodies[id].y - bodies[id].height / 2 + shiftY);
+    }
+    return moving.size();
+}
+
+}  // namespace velocitydb
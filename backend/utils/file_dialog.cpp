@@ -1,9 +1,11 @@
 #include "file_dialog.h"
 
+#include "encoding.h"
+#include "mapped_file.h"
+
 #include <Windows.h>
 
 #include <fstream>
-#include <sstream>
 
 #include <commdlg.h>
 
@@ -72,19 +74,13 @@ std::expected<std::filesystem::path, std::string> FileDialog::showOpenDialog(con
 }
 
 std::expected<std::string, std::string> FileDialog::readFile(const std::filesystem::path& path) {
-    std::ifstream file(path, std::ios::in | std::ios::binary);
-    if (!file) {
+    // One copy out of the mapping instead of stream buffer -> stringstream -> string
+    const auto& nativePath = path.native();
+    MappedFile file;
+    if (!file.open(wideToUtf8(nativePath.c_str(), nativePath.size()))) {
         return std::unexpected(std::format("Failed to open file: {}", path.string()));
     }
-
-    std::ostringstream content;
-    content << file.rdbuf();
-
-    if (!file) {
-        return std::unexpected(std::format("Failed to read file: {}", path.string()));
-    }
-
-    return content.str();
+    return std::string(file.view());
 }
 
 std::expected<void, std::string> FileDialog::writeFile(const std::filesystem::path& path, const std::string& content) {
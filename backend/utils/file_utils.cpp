@@ -1,24 +1,22 @@
 #include "file_utils.h"
 
+#include "mapped_file.h"
+
 #include <Windows.h>
 
 #include <filesystem>
 #include <fstream>
-#include <sstream>
 
 #include <ShlObj.h>
 
 namespace velocitydb {
 
 std::optional<std::string> FileUtils::readFile(const std::string& filepath) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filepath)) {
         return std::nullopt;
     }
-
-    std::ostringstream content;
-    content << file.rdbuf();
-    return content.str();
+    return std::string(file.view());
 }
 
 bool FileUtils::writeFile(const std::string& filepath, const std::string& content) {
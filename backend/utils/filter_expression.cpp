@@ -0,0 +1,298 @@
+#include "filter_expression.h"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <numeric>
+
+namespace velocitydb {
+
+namespace {
+
+/// A stage over at least this fraction of the rows runs the whole-column kernels instead of per-row checks
+constexpr size_t DENSE_DIVISOR = 4;
+
+[[nodiscard]] std::optional<FilterExpression::Op> parseOp(std::string_view name) noexcept {
+    using Op = FilterExpression::Op;
+    if (name == "equals") {
+        return Op::Equals;
+    }
+    if (name == "contains") {
+        return Op::Contains;
+    }
+    if (name == "range") {
+        return Op::Range;
+    }
+    if (name == "isNull") {
+        return Op::IsNull;
+    }
+    if (name == "notNull") {
+        return Op::IsNotNull;
+    }
+    if (name == "regex") {
+        return Op::Regex;
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] std::vector<size_t> allRows(size_t rows) {
+    std::vector<size_t> indices(rows);
+    std::iota(indices.begin(), indices.end(), 0);
+    return indices;
+}
+
+[[nodiscard]] bool isDense(const std::vector<size_t>* candidates, size_t rows) noexcept {
+    return !candidates || candidates->size() >= rows / DENSE_DIVISOR;
+}
+
+/// Rows of `candidates` (every row when nullptr) whose bit is set in `mask`
+[[nodiscard]] std::vector<size_t> intersect(const SIMDFilter::RowMask& mask, const std::vector<size_t>* candidates, size_t rows) {
+    if (!candidates) {
+        return SIMDFilter::maskToIndices(mask, rows);
+    }
+    std::vector<size_t> kept;
+    for (size_t row : *candidates) {
+        if ((mask[row >> 6] >> (row & 63)) & 1) {
+            kept.push_back(row);
+        }
+    }
+    return kept;
+}
+
+/// Rows of `candidates` (every row when nullptr) satisfying `pred`, checking `cancelRequested` every CANCEL_CHECK_ROWS rows
+template <typename Pred>
+[[nodiscard]] std::vector<size_t> keepRows(const std::vector<size_t>* candidates, size_t rows, const std::atomic<bool>* cancelRequested, Pred pred) {
+    std::vector<size_t> kept;
+    if (!candidates) {
+        for (size_t row = 0; row < rows; ++row) {
+            if (row % CANCEL_CHECK_ROWS == 0)
+                throwIfCancelled(cancelRequested);
+            if (pred(row)) {
+                kept.push_back(row);
+            }
+        }
+        return kept;
+    }
+    for (size_t i = 0; i < candidates->size(); ++i) {
+        if (i % CANCEL_CHECK_ROWS == 0)
+            throwIfCancelled(cancelRequested);
+        if (pred((*candidates)[i])) {
+            kept.push_back((*candidates)[i]);
+        }
+    }
+    return kept;
+}
+
+}  // namespace
+
+std::expected<FilterExpression, std::string> FilterExpression::parse(const simdjson::dom::element& json) {
+    FilterExpression expression;
+    auto root = expression.parseNode(json, 0);
+    if (!root) {
+        return std::unexpected(std::move(root.error()));
+    }
+    return expression;
+}
+
+FilterExpression FilterExpression::predicate(size_t column, FilterType type, std::string value, std::string maxValue) {
+    FilterExpression expression;
+    Node node;
+    node.column = column;
+    node.op = type == FilterType::Equals ? Op::Equals : type == FilterType::Contains ? Op::Contains : Op::Range;
+    node.value = std::move(value);
+    node.maxValue = std::move(maxValue);
+    expression.m_nodes.push_back(std::move(node));
+    return expression;
+}
+
+std::expected<FilterExpression, std::string> FilterExpression::fromRequest(const simdjson::dom::element& params) {
+    if (auto filter = params["filter"]; !filter.error()) {
+        return parse(filter.value());
+    }
+    auto columnIndex = params["columnIndex"].get_uint64();
+    auto filterType = params["filterType"].get_string();
+    auto filterValue = params["filterValue"].get_string();
+    if (columnIndex.error() || filterType.error() || filterValue.error()) {
+        return std::unexpected("Missing required fields: filter, or columnIndex, filterType and filterValue");
+    }
+    auto type = SIMDFilter::parseFilterType(filterType.value());
+    if (!type) {
+        return std::unexpected(std::format("Unknown filter type: {}", filterType.value()));
+    }
+    std::string maxValue;
+    if (auto filterValueMax = params["filterValueMax"].get_string(); !filterValueMax.error()) {
+        maxValue = std::string(filterValueMax.value());
+    }
+    return predicate(columnIndex.value(), *type, std::string(filterValue.value()), std::move(maxValue));
+}
+
+std::expected<size_t, std::string> FilterExpression::parseNode(const simdjson::dom::element& json, size_t depth) {
+    if (depth > MAX_DEPTH) {
+        return std::unexpected(std::format("Filter nested deeper than {} levels", MAX_DEPTH));
+    }
+    if (m_nodes.size() >= MAX_NODES) {
+        return std::unexpected(std::format("Filter has more than {} terms", MAX_NODES));
+    }
+    if (!json.is_object()) {
+        return std::unexpected("Filter term must be an object");
+    }
+
+    Node node;
+    auto andTerms = json["and"].get_array();
+    auto orTerms = json["or"].get_array();
+    if (!andTerms.error() || !orTerms.error()) {
+        node.kind = andTerms.error() ? Kind::Or : Kind::And;
+        for (auto child : andTerms.error() ? orTerms.value() : andTerms.value()) {
+            auto index = parseNode(child, depth + 1);
+            if (!index) {
+                return index;
+            }
+            node.children.push_back(*index);
+        }
+        if (node.kind == Kind::And) {
+            // Regexes are the costly stage: give them only what the cheaper predicates let through
+            std::stable_partition(node.children.begin(), node.children.end(), [this](size_t child) { return m_nodes[child].kind != Kind::Predicate || m_nodes[child].op != Op::Regex; });
+        }
+        m_nodes.push_back(std::move(node));
+        return m_nodes.size() - 1;
+    }
+
+    auto column = json["column"].get_uint64();
+    auto op = json["op"].get_string();
+    if (column.error() || op.error()) {
+        return std::unexpected("Filter predicate needs \"column\" and \"op\"");
+    }
+    auto parsedOp = parseOp(op.value());
+    if (!parsedOp) {
+        return std::unexpected(std::format("Unknown filter op: {}", op.value()));
+    }
+    node.column = column.value();
+    node.op = *parsedOp;
+    if (auto value = json["value"].get_string(); !value.error()) {
+        node.value = std::string(value.value());
+    } else if (node.op != Op::IsNull && node.op != Op::IsNotNull) {
+        return std::unexpected(std::format("Filter op {} needs a \"value\"", op.value()));
+    }
+    if (auto maxValue = json["maxValue"].get_string(); !maxValue.error()) {
+        node.maxValue = std::string(maxValue.value());
+    }
+    if (node.op == Op::Regex) {
+        auto flags = std::regex::ECMAScript | std::regex::optimize;
+        if (auto ignoreCase = json["ignoreCase"].get_bool(); !ignoreCase.error() && ignoreCase.value()) {
+            flags |= std::regex::icase;
+        }
+        try {
+            node.regex = std::make_shared<const std::regex>(node.value, flags);
+        } catch (const std::regex_error& e) {
+            return std::unexpected(std::format("Invalid regex '{}': {}", node.value, e.what()));
+        }
+    }
+    m_nodes.push_back(std::move(node));
+    return m_nodes.size() - 1;
+}
+
+std::vector<size_t> FilterExpression::evaluate(const ResultSet& data, const std::atomic<bool>* cancelRequested) const {
+    if (m_nodes.empty()) {
+        return {};
+    }
+    return evaluateNode(m_nodes.size() - 1, data, nullptr, cancelRequested);
+}
+
+std::vector<size_t> FilterExpression::evaluateNode(size_t index, const ResultSet& data, const std::vector<size_t>* candidates, const std::atomic<bool>* cancelRequested) const {
+    const auto& node = m_nodes[index];
+    switch (node.kind) {
+        case Kind::Predicate:
+            return evaluatePredicate(node, data, candidates, cancelRequested);
+        case Kind::And: {
+            if (node.children.empty()) {
+                return candidates ? *candidates : allRows(data.rowCount());
+            }
+            // Each stage narrows the selection the next one reads
+            std::vector<size_t> selection;
+            const std::vector<size_t>* current = candidates;
+            for (size_t child : node.children) {
+                selection = evaluateNode(child, data, current, cancelRequested);
+                current = &selection;
+                if (selection.empty()) {
+                    break;
+                }
+            }
+            return selection;
+        }
+        case Kind::Or: {
+            // Each branch only reads the rows no earlier branch matched
+            std::vector<size_t> matched;
+            std::vector<size_t> remaining;
+            const std::vector<size_t>* current = candidates;
+            for (size_t child : node.children) {
+                auto hits = evaluateNode(child, data, current, cancelRequested);
+                if (hits.empty()) {
+                    continue;
+                }
+                std::vector<size_t> rest;
+                if (!current) {
+                    remaining = allRows(data.rowCount());
+                    current = &remaining;
+                }
+                std::set_difference(current->begin(), current->end(), hits.begin(), hits.end(), std::back_inserter(rest));
+                std::vector<size_t> merged;
+                merged.reserve(matched.size() + hits.size());
+                std::merge(matched.begin(), matched.end(), hits.begin(), hits.end(), std::back_inserter(merged));
+                matched = std::move(merged);
+                remaining = std::move(rest);
+                current = &remaining;
+                if (remaining.empty()) {
+                    break;
+                }
+            }
+            return matched;
+        }
+    }
+    return {};
+}
+
+std::vector<size_t> FilterExpression::evaluatePredicate(const Node& node, const ResultSet& data, const std::vector<size_t>* candidates, const std::atomic<bool>* cancelRequested) const {
+    // Column kernels run a whole pass at a time, so they are checked for between passes
+    throwIfCancelled(cancelRequested);
+    const size_t rows = data.rowCount();
+    if (node.column >= data.columnData.size()) {
+        return {};
+    }
+    const auto& column = data.columnData[node.column];
+    SIMDFilter simdFilter;
+
+    switch (node.op) {
+        case Op::Equals:
+        case Op::Contains:
+        case Op::Range: {
+            const auto type = node.op == Op::Equals ? FilterType::Equals : node.op == Op::Contains ? FilterType::Contains : FilterType::Range;
+            if (isDense(candidates, rows)) {
+                return intersect(simdFilter.mask(data, node.column, type, node.value, node.maxValue), candidates, rows);
+            }
+            return simdFilter.select(data, node.column, type, node.value, node.maxValue, *candidates);
+        }
+        case Op::IsNull:
+        case Op::IsNotNull: {
+            const bool wantNull = node.op == Op::IsNull;
+            return keepRows(candidates, rows, cancelRequested, [&](size_t row) { return column.isNull(row) == wantNull; });
+        }
+        case Op::Regex: {
+            std::string cell;
+            return keepRows(candidates, rows, cancelRequested, [&](size_t row) {
+                if (column.isNull(row)) {
+                    return false;
+                }
+                if (column.type() == ColumnDataType::Text) {
+                    const auto text = column.textAt(row);
+                    return std::regex_search(text.begin(), text.end(), *node.regex);
+                }
+                cell.clear();
+                column.appendDisplayText(cell, row);
+                return std::regex_search(cell, *node.regex);
+            });
+        }
+    }
+    return {};
+}
+
+}  // namespace velocitydb
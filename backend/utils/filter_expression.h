@@ -0,0 +1,68 @@
+#pragma once
+
+#include "cancellation_token.h"
+#include "simd_filter.h"
+#include "simdjson.h"
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Compound grid filter: an AND/OR tree of column predicates.
+///
+/// JSON form: `{"and":[...]}`, `{"or":[...]}`, or a predicate
+/// `{"column":n,"op":"equals|contains|range|isNull|notNull|regex","value":"...","maxValue":"...","ignoreCase":bool}`.
+///
+/// Evaluation is a pipeline of selection vectors: each AND stage only looks at the rows that survived the
+/// previous one, and each OR branch only at rows no earlier branch matched. A stage over most of the rows
+/// runs the SIMDFilter column kernels; a stage over a sparse selection checks just the selected rows.
+/// Regex predicates are moved to the end of their AND group so they see the fewest rows.
+class FilterExpression {
+public:
+    enum class Op : uint8_t { Equals, Contains, Range, IsNull, IsNotNull, Regex };
+
+    static constexpr size_t MAX_NODES = 256;
+    static constexpr size_t MAX_DEPTH = 32;
+
+    /// Parse the JSON form; the error names the offending part
+    [[nodiscard]] static std::expected<FilterExpression, std::string> parse(const simdjson::dom::element& json);
+    /// Single predicate (the legacy columnIndex/filterType/filterValue request)
+    [[nodiscard]] static FilterExpression predicate(size_t column, FilterType type, std::string value, std::string maxValue = {});
+    /// Expression of a filter request: its "filter" object, else the columnIndex/filterType/filterValue[/filterValueMax] predicate
+    [[nodiscard]] static std::expected<FilterExpression, std::string> fromRequest(const simdjson::dom::element& params);
+
+    /// Ascending indices of the rows of `data` the expression keeps. `cancelRequested` is checked between
+    /// predicate passes and every CANCEL_CHECK_ROWS rows of a row-at-a-time one; once raised, throws OperationCancelled
+    [[nodiscard]] std::vector<size_t> evaluate(const ResultSet& data, const std::atomic<bool>* cancelRequested = nullptr) const;
+
+private:
+    enum class Kind : uint8_t { And, Or, Predicate };
+
+    struct Node {
+        Kind kind = Kind::Predicate;
+        std::vector<size_t> children;  ///< Indices into m_nodes (And/Or)
+        size_t column = 0;
+        Op op = Op::Equals;
+        std::string value;
+        std::string maxValue;
+        std::shared_ptr<const std::regex> regex;
+    };
+
+    FilterExpression() = default;
+
+    [[nodiscard]] std::expected<size_t, std::string> parseNode(const simdjson::dom::element& json, size_t depth);
+    /// Rows of `candidates` (every row when nullptr) that satisfy node `index`
+    [[nodiscard]] std::vector<size_t> evaluateNode(size_t index, const ResultSet& data, const std::vector<size_t>* candidates, const std::atomic<bool>* cancelRequested) const;
+    [[nodiscard]] std::vector<size_t> evaluatePredicate(const Node& node, const ResultSet& data, const std::vector<size_t>* candidates, const std::atomic<bool>* cancelRequested) const;
+
+    std::vector<Node> m_nodes;  ///< Root is the last node
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,152 @@
+#include "frontend_asset_pack.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace velocitydb {
+
+namespace {
+
+struct ContentType {
+    std::string_view extension;
+    std::string_view mimeType;
+};
+
+constexpr std::array<ContentType, 14> CONTENT_TYPES = {{
+    {".html", "text/html; charset=utf-8"},
+    {".js", "text/javascript; charset=utf-8"},
+    {".mjs", "text/javascript; charset=utf-8"},
+    {".css", "text/css; charset=utf-8"},
+    {".json", "application/json"},
+    {".map", "application/json"},
+    {".svg", "image/svg+xml"},
+    {".png", "image/png"},
+    {".ico", "image/x-icon"},
+    {".woff2", "font/woff2"},
+    {".woff", "font/woff"},
+    {".ttf", "font/ttf"},
+    {".wasm", "application/wasm"},
+    {".txt", "text/plain; charset=utf-8"},
+}};
+
+// Content-hashed file names never change meaning, so the browser may keep them for good
+constexpr std::string_view IMMUTABLE = "public, max-age=31536000, immutable";
+constexpr std::string_view REVALIDATE = "no-cache";
+
+std::optional<std::string> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+FrontendAssetPack::FrontendAssetPack(std::filesystem::path root) : m_root(std::move(root)) {}
+
+std::string_view FrontendAssetPack::contentTypeFor(std::string_view path) {
+    for (const auto& [extension, mimeType] : CONTENT_TYPES) {
+        if (path.ends_with(extension)) {
+            return mimeType;
+        }
+    }
+    return "application/octet-stream";
+}
+
+std::string_view FrontendAssetPack::cacheControlFor(std::string_view path) {
+    return path.starts_with("assets/") ? IMMUTABLE : REVALIDATE;
+}
+
+std::optional<std::string> FrontendAssetPack::normalize(std::string_view path) {
+    path = path.substr(0, path.find_first_of("?#"));
+    while (path.starts_with('/')) {
+        path.remove_prefix(1);
+    }
+
+    std::string key;
+    key.reserve(path.size() + 10);
+    size_t segmentStart = 0;
+    while (segmentStart <= path.size()) {
+        const auto segmentEnd = (std::min)(path.find('/', segmentStart), path.size());
+        const auto segment = path.substr(segmentStart, segmentEnd - segmentStart);
+        if (segment == ".." || segment.find_first_of("\\:%") != std::string_view::npos) [[unlikely]] {
+            return std::nullopt;
+        }
+        if (!segment.empty() && segment != ".") {
+            if (!key.empty()) {
+                key += '/';
+            }
+            key += segment;
+        }
+        segmentStart = segmentEnd + 1;
+    }
+
+    if (path.empty() || path.ends_with('/')) {
+        if (!key.empty()) {
+            key += '/';
+        }
+        key += "index.html";
+    }
+    return key;
+}
+
+std::shared_ptr<const std::string> FrontendAssetPack::load(const std::string& key) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto it = m_files.find(key); it != m_files.end()) {
+            return it->second;
+        }
+    }
+
+    // Read outside the lock so preload() never stalls a request for a file it already has
+    auto content = readFile(m_root / std::filesystem::path(key));
+    if (!content) {
+        return nullptr;
+    }
+    auto body = std::make_shared<const std::string>(std::move(*content));
+
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_files.try_emplace(key, body);
+    if (inserted) {
+        m_bytes += it->second->size();
+    }
+    return it->second;
+}
+
+size_t FrontendAssetPack::preload() {
+    std::error_code ec;
+    size_t loaded = 0;
+    for (std::filesystem::recursive_directory_iterator it(m_root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().extension() == ".map") {
+            continue;
+        }
+        auto key = std::filesystem::relative(it->path(), m_root, ec).generic_string();
+        if (!ec && load(key)) {
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
+std::optional<FrontendAssetPack::Asset> FrontendAssetPack::find(std::string_view path) {
+    auto key = normalize(path);
+    if (!key) [[unlikely]] {
+        return std::nullopt;
+    }
+    auto body = load(*key);
+    if (!body) {
+        return std::nullopt;
+    }
+    return Asset{.body = std::move(body), .contentType = contentTypeFor(*key), .cacheControl = cacheControlFor(*key)};
+}
+
+size_t FrontendAssetPack::cachedBytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_bytes;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace velocitydb {
+
+/// Virtual host the page is served from (https://app.local/index.html)
+inline constexpr std::string_view FRONTEND_HOST = "app.local";
+
+/// The built frontend (Vite dist folder) held in memory, so the page loads without touching the disk.
+///
+/// Files are read on first request, or all at once by preload() on a background thread while the WebView2
+/// environment starts. Vite names everything under assets/ after its content hash, so those responses are
+/// marked immutable and stay in the browser's caches across launches; index.html and other unhashed files
+/// are revalidated every time so an upgrade takes effect immediately. Thread-safe.
+class FrontendAssetPack {
+public:
+    struct Asset {
+        std::shared_ptr<const std::string> body;
+        std::string_view contentType;
+        std::string_view cacheControl;
+    };
+
+    explicit FrontendAssetPack(std::filesystem::path root);
+    ~FrontendAssetPack() = default;
+
+    FrontendAssetPack(const FrontendAssetPack&) = delete;
+    FrontendAssetPack& operator=(const FrontendAssetPack&) = delete;
+    FrontendAssetPack(FrontendAssetPack&&) = delete;
+    FrontendAssetPack& operator=(FrontendAssetPack&&) = delete;
+
+    /// Read every file except source maps (only DevTools asks for those); returns the number of files read
+    size_t preload();
+
+    /// `path` is the URL path below the host ("assets/index-3f9a1c2b.js"); empty or "/"-terminated paths
+    /// mean index.html. nullopt for missing files and paths that would leave the root.
+    [[nodiscard]] std::optional<Asset> find(std::string_view path);
+
+    [[nodiscard]] size_t cachedBytes() const;
+    [[nodiscard]] const std::filesystem::path& root() const noexcept { return m_root; }
+
+    [[nodiscard]] static std::string_view contentTypeFor(std::string_view path);
+    [[nodiscard]] static std::string_view cacheControlFor(std::string_view path);
+
+private:
+    /// "assets/x.js" for "/assets/x.js?v=1"; nullopt when the path has ".." or other non-relative segments
+    [[nodiscard]] static std::optional<std::string> normalize(std::string_view path);
+    std::shared_ptr<const std::string> load(const std::string& key);
+
+    const std::filesystem::path m_root;
+
+    mutable std::mutex m_mutex;  // guards m_files and m_bytes
+    std::unordered_map<std::string, std::shared_ptr<const std::string>> m_files;
+    size_t m_bytes = 0;
+};
+
+}  // namespace velocitydb
@@ -22,12 +22,19 @@ struct glz::meta<velocitydb::SshConfig> {
                                          "privateKeyPath", &T::privateKeyPath, "encryptedKeyPassphrase", &T::encryptedKeyPassphrase);
 };
 
+template <>
+struct glz::meta<velocitydb::ConnectionTuning> {
+    using T = velocitydb::ConnectionTuning;
+    static constexpr auto value = object("packetSize", &T::packetSize, "mars", &T::mars, "multiSubnetFailover", &T::multiSubnetFailover, "readOnlyIntent", &T::readOnlyIntent,
+                                         "readRouting", &T::readRouting);
+};
+
 template <>
 struct glz::meta<velocitydb::ConnectionProfile> {
     using T = velocitydb::ConnectionProfile;
     static constexpr auto value = object("id", &T::id, "name", &T::name, "server", &T::server, "port", &T::port, "database", &T::database, "username", &T::username, "useWindowsAuth",
                                          &T::useWindowsAuth, "savePassword", &T::savePassword, "encryptedPassword", &T::encryptedPassword, "isProduction", &T::isProduction, "isReadOnly",
-                                         &T::isReadOnly, "environment", &T::environment, "dbType", &T::dbType, "ssh", &T::ssh);
+                                         &T::isReadOnly, "environment", &T::environment, "dbType", &T::dbType, "ssh", &T::ssh, "tuning", &T::tuning);
 };
 
 template <>
@@ -69,7 +76,8 @@ template <>
 struct glz::meta<velocitydb::EditorTab> {
     using T = velocitydb::EditorTab;
     static constexpr auto value =
-        object("id", &T::id, "title", &T::title, "content", &T::content, "filePath", &T::filePath, "isDirty", &T::isDirty, "cursorLine", &T::cursorLine, "cursorColumn", &T::cursorColumn);
+        object("id", &T::id, "title", &T::title, "content", &T::content, "filePath", &T::filePath, "isDirty", &T::isDirty, "cursorLine", &T::cursorLine, "cursorColumn", &T::cursorColumn,
+               "contentHash", &T::contentHash, "contentLoaded", &T::contentLoaded);
 };
 
 template <>
@@ -0,0 +1,130 @@
+#include "grid_copy.h"
+
+#include <cstring>
+
+namespace velocitydb {
+
+namespace {
+
+/// Bytes per cell assumed when reserving the output; it grows by doubling past that
+constexpr size_t ESTIMATED_CELL_BYTES = 12;
+
+[[nodiscard]] bool needsQuoting(std::string_view value, CopyFormat format) noexcept {
+    if (format == CopyFormat::Tsv) {
+        return value.starts_with('"') || value.find_first_of("\t\r\n") != std::string_view::npos;
+    }
+    return value.find_first_of(",\"\r\n") != std::string_view::npos;
+}
+
+/// Append `value` quoted, copying the runs between quotes and doubling each quote
+void appendQuoted(std::string& out, std::string_view value) {
+    out += '"';
+    while (!value.empty()) {
+        const auto* quote = static_cast<const char*>(std::memchr(value.data(), '"', value.size()));
+        if (quote == nullptr) {
+            out += value;
+            break;
+        }
+        const size_t runLength = static_cast<size_t>(quote - value.data()) + 1;
+        out += value.substr(0, runLength);
+        out += '"';
+        value.remove_prefix(runLength);
+    }
+    out += '"';
+}
+
+void appendMarkdown(std::string& out, std::string_view value) {
+    for (size_t i = 0; i < value.size(); ++i) {
+        switch (value[i]) {
+            case '|':
+                out += "\\|";
+                break;
+            case '\r':
+                if (i + 1 < value.size() && value[i + 1] == '\n') {
+                    ++i;
+                }
+                out += "<br>";
+                break;
+            case '\n':
+                out += "<br>";
+                break;
+            default:
+                out += value[i];
+        }
+    }
+}
+
+void appendCell(std::string& out, std::string_view value, CopyFormat format) {
+    if (format == CopyFormat::Markdown) {
+        appendMarkdown(out, value);
+    } else if (needsQuoting(value, format)) {
+        appendQuoted(out, value);
+    } else {
+        out += value;
+    }
+}
+
+}  // namespace
+
+std::optional<CopyFormat> GridCopy::parseFormat(std::string_view name) noexcept {
+    if (name == "tsv") {
+        return CopyFormat::Tsv;
+    }
+    if (name == "csv") {
+        return CopyFormat::Csv;
+    }
+    if (name == "markdown") {
+        return CopyFormat::Markdown;
+    }
+    return std::nullopt;
+}
+
+std::string GridCopy::render(const ResultSet& data, std::span<const size_t> rows, std::span<const size_t> columns, CopyFormat format, bool includeHeader, std::string_view nullText) {
+    const bool markdown = format == CopyFormat::Markdown;
+    const std::string_view separator = markdown ? " | " : format == CopyFormat::Tsv ? "\t" : ",";
+    const std::string_view lineStart = markdown ? "| " : "";
+    const std::string_view lineEnd = markdown ? " |\r\n" : "\r\n";
+
+    std::string out;
+    out.reserve((rows.size() + 2) * (columns.size() * (ESTIMATED_CELL_BYTES + separator.size()) + lineEnd.size()));
+    auto appendLine = [&](auto&& cellAt) {
+        out += lineStart;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) {
+                out += separator;
+            }
+            appendCell(out, cellAt(columns[i]), format);
+        }
+        out += lineEnd;
+    };
+
+    if (includeHeader || markdown) {
+        appendLine([&](size_t column) -> std::string_view { return data.columns[column].name; });
+    }
+    if (markdown) {
+        out += '|';
+        for (size_t i = 0; i < columns.size(); ++i) {
+            out += " --- |";
+        }
+        out += "\r\n";
+    }
+
+    std::string cell;  // Display text of non-text cells
+    for (size_t row : rows) {
+        appendLine([&](size_t column) -> std::string_view {
+            const auto& values = data.columnData[column];
+            if (values.isNull(row)) {
+                return nullText;
+            }
+            if (values.type() == ColumnDataType::Text) {
+                return values.textAt(row);
+            }
+            cell.clear();
+            values.appendDisplayText(cell, row);
+            return cell;
+        });
+    }
+    return out;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Text formats a grid selection is copied as, named "tsv", "csv" and "markdown" on the IPC side
+enum class CopyFormat : uint8_t { Tsv, Csv, Markdown };
+
+/// Renders a selection of a ResultSet as clipboard text in one pass over the columnar storage.
+///
+/// Rows end in CRLF, as Windows applications expect on the clipboard. TSV quotes a cell (doubling its quotes)
+/// only when it holds a tab, a line break or starts with a quote, which is what Excel and Sheets parse back;
+/// CSV quotes cells holding a comma, quote or line break. Markdown always has a header row, escapes `|` and
+/// turns line breaks into `<br>`. NULL cells are written as `nullText` (empty by default).
+class GridCopy {
+public:
+    /// CopyFormat for its IPC name, nullopt when unknown
+    [[nodiscard]] static std::optional<CopyFormat> parseFormat(std::string_view name) noexcept;
+
+    /// `rows` (result row indices) × `columns` (column indices) of `data`, in the given order. `includeHeader`
+    /// adds a line of column names; Markdown has one regardless.
+    [[nodiscard]] static std::string render(const ResultSet& data, std::span<const size_t> rows, std::span<const size_t> columns, CopyFormat format, bool includeHeader,
+                                            std::string_view nullText = {});
+};
+
+}  // namespace velocitydb
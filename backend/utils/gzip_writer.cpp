@@ -0,0 +1,324 @@
+#include "gzip_writer.h"
+
+#include "crc32.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = 258;
+constexpr size_t MAX_CHAIN = 16;  ///< Candidates tried per position; longer chains buy little on export text
+constexpr int HASH_BITS = 15;
+constexpr uint32_t END_OF_BLOCK = 256;
+
+constexpr std::array<uint16_t, 29> LENGTH_BASE = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<uint8_t, 29> LENGTH_EXTRA = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<uint16_t, 30> DISTANCE_BASE = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                                    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<uint8_t, 30> DISTANCE_EXTRA = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+[[nodiscard]] constexpr uint32_t reverseBits(uint32_t code, int length) noexcept {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    return reversed;
+}
+
+/// The fixed literal/length Huffman code (RFC 1951 3.2.6), bit-reversed for LSB-first output
+struct FixedCode {
+    std::array<uint16_t, 288> code{};
+    std::array<uint8_t, 288> length{};
+};
+
+constexpr FixedCode FIXED_LITERALS = [] {
+    FixedCode table;
+    for (uint32_t symbol = 0; symbol < 288; ++symbol) {
+        uint32_t code = 0;
+        int length = 0;
+        if (symbol < 144) {
+            code = 0x30 + symbol, length = 8;
+        } else if (symbol < 256) {
+            code = 0x190 + symbol - 144, length = 9;
+        } else if (symbol < 280) {
+            code = symbol - 256, length = 7;
+        } else {
+            code = 0xC0 + symbol - 280, length = 8;
+        }
+        table.code[symbol] = static_cast<uint16_t>(reverseBits(code, length));
+        table.length[symbol] = static_cast<uint8_t>(length);
+    }
+    return table;
+}();
+
+constexpr std::array<uint8_t, MAX_MATCH + 1> LENGTH_SYMBOL = [] {
+    std::array<uint8_t, MAX_MATCH + 1> table{};
+    for (size_t symbol = 0; symbol < LENGTH_BASE.size(); ++symbol) {
+        for (size_t length = LENGTH_BASE[symbol]; length < LENGTH_BASE[symbol] + (size_t{1} << LENGTH_EXTRA[symbol]) && length <= MAX_MATCH; ++length) {
+            table[length] = static_cast<uint8_t>(symbol);
+        }
+    }
+    return table;
+}();
+
+/// Distance code by distance - 1 below 256, and by 256 + ((distance - 1) >> 7) above (zlib's layout)
+constexpr std::array<uint8_t, 512> DISTANCE_SYMBOL = [] {
+    std::array<uint8_t, 512> table{};
+    for (size_t symbol = 0; symbol < DISTANCE_BASE.size(); ++symbol) {
+        for (size_t distance = DISTANCE_BASE[symbol]; distance < DISTANCE_BASE[symbol] + (size_t{1} << DISTANCE_EXTRA[symbol]); ++distance) {
+            const size_t index = distance - 1 < 256 ? distance - 1 : 256 + ((distance - 1) >> 7);
+            table[index] = static_cast<uint8_t>(symbol);
+        }
+    }
+    return table;
+}();
+
+/// LSB-first bit packer
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : m_out(out) {}
+
+    void put(uint64_t bits, int count) {
+        m_bits |= bits << m_count;
+        m_count += count;
+        if (m_count >= 32) {
+            const std::array<char, 4> bytes = {static_cast<char>(m_bits), static_cast<char>(m_bits >> 8), static_cast<char>(m_bits >> 16), static_cast<char>(m_bits >> 24)};
+            m_out.append(bytes.data(), bytes.size());
+            m_bits >>= 32;
+            m_count -= 32;
+        }
+    }
+
+    /// Flush to a byte boundary, padding with zero bits
+    void align() {
+        while (m_count > 0) {
+            m_out += static_cast<char>(m_bits);
+            m_bits >>= 8;
+            m_count = (std::max)(m_count - 8, 0);
+        }
+        m_bits = 0;
+    }
+
+private:
+    std::string& m_out;
+    uint64_t m_bits = 0;
+    int m_count = 0;
+};
+
+[[nodiscard]] uint32_t hashAt(const char* p) noexcept {
+    uint32_t word = 0;
+    std::memcpy(&word, p, 3);
+    return (word * 2654435761u) >> (32 - HASH_BITS);
+}
+
+[[nodiscard]] size_t matchLength(const char* a, const char* b, size_t limit) noexcept {
+    size_t length = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        while (length + 8 <= limit) {
+            uint64_t x = 0;
+            uint64_t y = 0;
+            std::memcpy(&x, a + length, 8);
+            std::memcpy(&y, b + length, 8);
+            if (x != y) {
+                return length + static_cast<size_t>(std::countr_zero(x ^ y) / 8);
+            }
+            length += 8;
+        }
+    }
+    while (length < limit && a[length] == b[length]) {
+        ++length;
+    }
+    return length;
+}
+
+void putLiteral(BitWriter& bits, unsigned char c) {
+    bits.put(FIXED_LITERALS.code[c], FIXED_LITERALS.length[c]);
+}
+
+void putMatch(BitWriter& bits, size_t length, size_t distance) {
+    const size_t lengthSymbol = LENGTH_SYMBOL[length];
+    const size_t code = 257 + lengthSymbol;
+    bits.put(FIXED_LITERALS.code[code] | (uint64_t{length - LENGTH_BASE[lengthSymbol]} << FIXED_LITERALS.length[code]), FIXED_LITERALS.length[code] + LENGTH_EXTRA[lengthSymbol]);
+
+    const size_t distanceSymbol = DISTANCE_SYMBOL[distance - 1 < 256 ? distance - 1 : 256 + ((distance - 1) >> 7)];
+    bits.put(reverseBits(static_cast<uint32_t>(distanceSymbol), 5) | (uint64_t{distance - DISTANCE_BASE[distanceSymbol]} << 5), 5 + DISTANCE_EXTRA[distanceSymbol]);
+}
+
+}  // namespace
+
+GzipWriter::GzipWriter() : m_batchBytes(BLOCK_BYTES * (std::max)(std::thread::hardware_concurrency(), 1u)) {}
+
+bool GzipWriter::open(const std::string& filepath) {
+    m_pending.clear();
+    m_window.clear();
+    m_crc = 0;
+    m_bytesIn = 0;
+    if (!m_writer.open(filepath)) [[unlikely]] {
+        return false;
+    }
+    // ID1 ID2, CM = deflate, no flags, no mtime, no extra flags, OS unknown
+    static constexpr std::array<char, 10> HEADER = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    m_writer.append(std::string_view(HEADER.data(), HEADER.size()));
+    return true;
+}
+
+void GzipWriter::append(std::string_view data) {
+    m_crc = updateCrc32(m_crc, data);
+    m_bytesIn += data.size();
+    m_pending += data;
+    if (m_pending.size() >= m_batchBytes) {
+        compressPending();
+    }
+}
+
+void GzipWriter::compressPending() {
+    if (m_pending.empty()) {
+        return;
+    }
+    const size_t blocks = (m_pending.size() + BLOCK_BYTES - 1) / BLOCK_BYTES;
+    std::vector<std::string> compressed(blocks);
+    std::vector<std::exception_ptr> errors(blocks);
+    auto run = [&](size_t block) {
+        try {
+            const size_t begin = block * BLOCK_BYTES;
+            const std::string_view input(m_pending);
+            const auto dictionary = block == 0 ? std::string_view(m_window) : input.substr(begin - (std::min)(begin, WINDOW_BYTES), (std::min)(begin, WINDOW_BYTES));
+            deflateBlock(compressed[block], dictionary, input.substr(begin, BLOCK_BYTES));
+        } catch (...) {
+            errors[block] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t block = 1; block < blocks; ++block) {
+        workers.emplace_back(run, block);
+    }
+    run(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    for (const auto& block : compressed) {
+        m_writer.append(block);
+    }
+
+    if (m_pending.size() >= WINDOW_BYTES) {
+        m_window.assign(m_pending, m_pending.size() - WINDOW_BYTES);
+    } else {
+        m_window += m_pending;
+        m_window.erase(0, m_window.size() - (std::min)(m_window.size(), WINDOW_BYTES));
+    }
+    m_pending.clear();
+}
+
+bool GzipWriter::close() {
+    compressPending();
+    // Final block: empty, fixed Huffman (BFINAL=1, BTYPE=01, end-of-block), then CRC-32 and ISIZE
+    std::array<char, 10> trailer = {3, 0};
+    for (int i = 0; i < 4; ++i) {
+        trailer[2 + i] = static_cast<char>(m_crc >> (8 * i));
+        trailer[6 + i] = static_cast<char>(m_bytesIn >> (8 * i));
+    }
+    m_writer.append(std::string_view(trailer.data(), trailer.size()));
+    return m_writer.close();
+}
+
+void GzipWriter::deflateBlock(std::string& out, std::string_view dictionary, std::string_view block) {
+    if (block.empty()) {
+        return;
+    }
+    dictionary = dictionary.substr(dictionary.size() - (std::min)(dictionary.size(), WINDOW_BYTES));
+    std::string buffer;
+    buffer.reserve(dictionary.size() + block.size() + 8);
+    buffer += dictionary;
+    buffer += block;
+    const char* data = buffer.data();
+    const size_t end = buffer.size();
+
+    // Hash chains: head holds the latest position + 1 for each hash, prev links to the one before it
+    std::vector<uint32_t> head(size_t{1} << HASH_BITS, 0);
+    std::vector<uint32_t> prev(end, 0);
+    const auto insert = [&](size_t pos) {
+        const uint32_t hash = hashAt(data + pos);
+        prev[pos] = head[hash];
+        head[hash] = static_cast<uint32_t>(pos + 1);
+    };
+    for (size_t pos = 0; pos + MIN_MATCH <= dictionary.size(); ++pos) {
+        insert(pos);
+    }
+
+    const size_t start = out.size();
+    out.reserve(start + block.size() / 2);
+    BitWriter bits(out);
+    bits.put(0b010, 3);  // BFINAL=0, BTYPE=01 (fixed Huffman)
+
+    size_t pos = dictionary.size();
+    while (pos < end) {
+        size_t bestLength = 0;
+        size_t bestDistance = 0;
+        if (pos + MIN_MATCH <= end) {
+            const size_t limit = (std::min)(MAX_MATCH, end - pos);
+            const size_t windowStart = pos > WINDOW_BYTES ? pos - WINDOW_BYTES : 0;
+            uint32_t candidate = head[hashAt(data + pos)];
+            for (size_t chain = 0; candidate != 0 && candidate - 1 >= windowStart && chain < MAX_CHAIN; ++chain) {
+                const size_t from = candidate - 1;
+                if (data[from + bestLength] == data[pos + bestLength]) {
+                    const size_t length = matchLength(data + from, data + pos, limit);
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = pos - from;
+                        if (length == limit) {
+                            break;
+                        }
+                    }
+                }
+                candidate = prev[from];
+            }
+            insert(pos);
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            putMatch(bits, bestLength, bestDistance);
+            for (size_t next = pos + 1; next < pos + bestLength && next + MIN_MATCH <= end; ++next) {
+                insert(next);
+            }
+            pos += bestLength;
+        } else {
+            putLiteral(bits, static_cast<unsigned char>(data[pos]));
+            ++pos;
+        }
+    }
+
+    bits.put(FIXED_LITERALS.code[END_OF_BLOCK], FIXED_LITERALS.length[END_OF_BLOCK]);
+    // Empty stored block (BFINAL=0, BTYPE=00, LEN=0, NLEN=0xFFFF) to end on a byte boundary
+    bits.put(0, 3);
+    bits.align();
+    out.append("\x00\x00\xff\xff", 4);
+
+    // Incompressible input (already compressed blobs, random bytes) is cheaper as stored blocks
+    if (out.size() - start > block.size() + block.size() / 65535 * 5 + 5) {
+        out.resize(start);
+        for (size_t offset = 0; offset < block.size(); offset += 65535) {
+            const auto stored = block.substr(offset, 65535);
+            const auto length = static_cast<uint16_t>(stored.size());
+            const std::array<char, 5> header = {0, static_cast<char>(length), static_cast<char>(length >> 8), static_cast<char>(~length), static_cast<char>(~length >> 8)};
+            out.append(header.data(), header.size());
+            out += stored;
+        }
+    }
+}
+
+}  // namespace velocitydb
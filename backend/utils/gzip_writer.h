@@ -0,0 +1,60 @@
+#pragma once
+
+#include "buffered_file_writer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Streaming gzip (RFC 1952) file writer. Input is cut into BLOCK_BYTES blocks that are deflated on worker
+/// threads a batch at a time: each block becomes one fixed-Huffman DEFLATE block whose LZ77 matches may reach
+/// back into the 32 KB of input before it, closed by an empty stored block so it ends on a byte boundary. The
+/// compressed blocks therefore simply concatenate into one stream that any gzip reader accepts.
+class GzipWriter {
+public:
+    static constexpr size_t BLOCK_BYTES = 1024 * 1024;
+    static constexpr size_t WINDOW_BYTES = 32 * 1024;
+
+    GzipWriter();
+    ~GzipWriter() = default;
+
+    GzipWriter(const GzipWriter&) = delete;
+    GzipWriter& operator=(const GzipWriter&) = delete;
+    GzipWriter(GzipWriter&&) = delete;
+    GzipWriter& operator=(GzipWriter&&) = delete;
+
+    /// Create (or truncate) the file and write the gzip header
+    [[nodiscard]] bool open(const std::string& filepath);
+
+    void append(std::string_view data);
+    void append(char c) { append(std::string_view(&c, 1)); }
+
+    /// Compress what is pending, write the final block and trailer and close. Returns false if any write failed.
+    bool close();
+
+    /// Uncompressed bytes accepted so far
+    [[nodiscard]] uint64_t bytesIn() const noexcept { return m_bytesIn; }
+    /// Compressed bytes produced so far (pending input not included)
+    [[nodiscard]] size_t bytesWritten() const noexcept { return m_writer.bytesWritten(); }
+    [[nodiscard]] bool failed() const noexcept { return m_writer.failed(); }
+
+    /// Append `block` to `out` as a non-final DEFLATE block plus an empty stored block. `dictionary` is the
+    /// input immediately before `block` (at most WINDOW_BYTES are used).
+    static void deflateBlock(std::string& out, std::string_view dictionary, std::string_view block);
+
+private:
+    /// Deflate all pending input in parallel and write it
+    void compressPending();
+
+    BufferedFileWriter m_writer;
+    std::string m_pending;  ///< Input not yet compressed
+    std::string m_window;   ///< The last WINDOW_BYTES of compressed input
+    size_t m_batchBytes;    ///< Pending bytes that trigger a compression batch
+    uint32_t m_crc = 0;
+    uint64_t m_bytesIn = 0;
+};
+
+}  // namespace velocitydb
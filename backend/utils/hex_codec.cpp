@@ -0,0 +1,127 @@
+#include "hex_codec.h"
+
+#include "cpu_features.h"
+
+#include <cstdint>
+
+#ifdef VELOCITYDB_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace velocitydb {
+
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// Encode whole vectors from bytes[i], leaving the tail (fewer bytes than one vector) to the scalar loop
+using EncodeRun = void (*)(const unsigned char* bytes, size_t size, size_t& i, char*& out) noexcept;
+
+void encodeRunScalar(const unsigned char*, size_t, size_t&, char*&) noexcept {}
+
+#ifdef VELOCITYDB_SIMD_X86
+// Each nibble indexes a 16-entry table of digits with one byte shuffle; the high and low digits are then interleaved
+VELOCITYDB_TARGET("ssse3")
+void encodeRunSsse3(const unsigned char* bytes, size_t size, size_t& i, char*& out) noexcept {
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    for (; i + 16 <= size; i += 16, out += 32) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+        const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(in, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(high, low));
+    }
+}
+
+VELOCITYDB_TARGET("avx2")
+void encodeRunAvx2(const unsigned char* bytes, size_t size, size_t& i, char*& out) noexcept {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    for (; i + 32 <= size; i += 32, out += 64) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+        const __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+        const __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(in, nibble));
+        // unpack interleaves within each 128-bit lane: bytes 0-7 | 16-23 and 8-15 | 24-31; put the lanes back in order
+        const __m256i first = _mm256_unpacklo_epi8(high, low);
+        const __m256i second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+}
+#endif
+
+[[nodiscard]] EncodeRun encodeRunFor(SimdLevel level) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    switch (level) {
+        case SimdLevel::AVX512:
+        case SimdLevel::AVX2:
+            return encodeRunAvx2;
+        case SimdLevel::SSE42:
+            return encodeRunSsse3;
+        case SimdLevel::Scalar:
+            break;
+    }
+#endif
+    (void)level;
+    return encodeRunScalar;
+}
+
+/// Value of a hex digit, or -1
+[[nodiscard]] constexpr int hexValue(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+}  // namespace
+
+void hexEncode(std::string_view bytes, char* dst) noexcept {
+    const auto* data = reinterpret_cast<const unsigned char*>(bytes.data());
+    const size_t size = bytes.size();
+    char* out = dst;
+    size_t i = 0;
+    encodeRunFor(activeSimdLevel())(data, size, i, out);
+    for (; i < size; ++i, out += 2) {
+        out[0] = HEX_DIGITS[data[i] >> 4];
+        out[1] = HEX_DIGITS[data[i] & 0x0F];
+    }
+}
+
+void appendHex(std::string& out, std::string_view bytes) {
+    const size_t start = out.size();
+    const size_t end = start + bytes.size() * 2;
+    out.resize_and_overwrite(end, [&](char* data, size_t) {
+        hexEncode(bytes, data + start);
+        return end;
+    });
+}
+
+bool appendHexDecoded(std::string& out, std::string_view hex) {
+    if (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+        hex.remove_prefix(2);
+    }
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    const size_t start = out.size();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        const int high = hexValue(hex[i]);
+        const int low = hexValue(hex[i + 1]);
+        if (high < 0 || low < 0) [[unlikely]] {
+            out.resize(start);
+            return false;
+        }
+        out += static_cast<char>((high << 4) | low);
+    }
+    return true;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Write the upper-case hex form of `bytes` (2 characters per byte, no prefix) to `dst`, which must hold
+/// 2 * bytes.size() characters. 32 (AVX2) or 16 (SSSE3) bytes are encoded per step, by activeSimdLevel().
+void hexEncode(std::string_view bytes, char* dst) noexcept;
+
+/// Append the upper-case hex form of `bytes` to `out`
+void appendHex(std::string& out, std::string_view bytes);
+
+/// Append the bytes spelled by `hex` (either case, optional "0x" prefix) to `out`; false, leaving `out` as it
+/// was, when `hex` has an odd length or a character that is not a hex digit
+[[nodiscard]] bool appendHexDecoded(std::string& out, std::string_view hex);
+
+}  // namespace velocitydb
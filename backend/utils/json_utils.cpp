@@ -1,13 +1,95 @@
 #include "json_utils.h"
 
-#include "database/sqlserver_driver.h"
+#include "cpu_features.h"
+#include "database/result_set.h"
+#include "query_trace.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <format>
-#include <sstream>
+#include <ranges>
+
+#ifdef VELOCITYDB_SIMD_X86
+#include <immintrin.h>
+#endif
 
 namespace velocitydb {
 
+namespace {
+
+/// Second character of the escape sequence for each byte: 0 = copy as-is, 'u' = \u00XX
+constexpr auto ESCAPE_TABLE = [] {
+    std::array<char, 256> table{};
+    for (int c = 0; c < 0x20; ++c) {
+        table[c] = 'u';
+    }
+    table['"'] = '"';
+    table['\\'] = '\\';
+    table['\b'] = 'b';
+    table['\f'] = 'f';
+    table['\n'] = 'n';
+    table['\r'] = 'r';
+    table['\t'] = 't';
+    return table;
+}();
+
+// Escape scans: call `escapeAt` for each byte of the whole blocks from `i` that needs escaping (a quote, a
+// backslash or a control character) and return where the blocks end. A byte c is a control character when
+// max(c, 0x1F) == 0x1F (unsigned).
+#ifdef VELOCITYDB_SIMD_X86
+template <typename EscapeAt>
+size_t scanEscapesSse2(const char* data, size_t size, size_t i, EscapeAt&& escapeAt) {
+    const __m128i quoteVec = _mm_set1_epi8('"');
+    const __m128i backslashVec = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlMax), controlMax);
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quoteVec), _mm_cmpeq_epi8(chunk, backslashVec)), control);
+        for (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)); mask != 0; mask &= mask - 1) {
+            escapeAt(i + static_cast<size_t>(std::countr_zero(mask)));
+        }
+    }
+    return i;
+}
+
+template <typename EscapeAt>
+VELOCITYDB_TARGET("avx2")
+size_t scanEscapesAvx2(const char* data, size_t size, size_t i, EscapeAt&& escapeAt) {
+    const __m256i quoteVec = _mm256_set1_epi8('"');
+    const __m256i backslashVec = _mm256_set1_epi8('\\');
+    const __m256i controlMax = _mm256_set1_epi8(0x1F);
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, controlMax), controlMax);
+        const __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quoteVec), _mm256_cmpeq_epi8(chunk, backslashVec)), control);
+        for (auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits)); mask != 0; mask &= mask - 1) {
+            escapeAt(i + static_cast<size_t>(std::countr_zero(mask)));
+        }
+    }
+    return i;
+}
+
+template <typename EscapeAt>
+VELOCITYDB_TARGET("avx512f,avx512bw")
+size_t scanEscapesAvx512(const char* data, size_t size, size_t i, EscapeAt&& escapeAt) {
+    const __m512i quoteVec = _mm512_set1_epi8('"');
+    const __m512i backslashVec = _mm512_set1_epi8('\\');
+    const __m512i controlMax = _mm512_set1_epi8(0x1F);
+    for (; i + 64 <= size; i += 64) {
+        const __m512i chunk = _mm512_loadu_si512(data + i);
+        const uint64_t hits = _mm512_cmpeq_epi8_mask(chunk, quoteVec) | _mm512_cmpeq_epi8_mask(chunk, backslashVec) | _mm512_cmple_epu8_mask(chunk, controlMax);
+        for (auto mask = hits; mask != 0; mask &= mask - 1) {
+            escapeAt(i + static_cast<size_t>(std::countr_zero(mask)));
+        }
+    }
+    return i;
+}
+#endif
+
+}  // namespace
+
 std::string JsonUtils::successResponse(std::string_view data) {
     return std::format(R"({{"success":true,"data":{}}})", data);
 }
@@ -16,50 +98,60 @@ std::string JsonUtils::errorResponse(std::string_view message) {
     return std::format(R"({{"success":false,"error":"{}"}})", escapeString(message));
 }
 
-std::string JsonUtils::escapeString(std::string_view str) {
-    // Fast path: check if string needs escaping
-    constexpr auto needsEscaping = [](char c) { return c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || static_cast<unsigned char>(c) < 0x20; };
-    if (!std::ranges::any_of(str, needsEscaping)) {
-        return std::string(str);
+std::string JsonUtils::errorResponse(std::string_view message, bool retriable) {
+    if (!retriable) {
+        return errorResponse(message);
     }
+    return std::format(R"({{"success":false,"error":"{}","retriable":true}})", escapeString(message));
+}
 
-    // Slow path: escape special characters
+std::string JsonUtils::escapeString(std::string_view str) {
     std::string result;
-    result.reserve(str.size() + str.size() / 8);
-
-    for (char c : str) {
-        switch (c) {
-            case '"':
-                result += "\\\"";
-                break;
-            case '\\':
-                result += "\\\\";
-                break;
-            case '\b':
-                result += "\\b";
-                break;
-            case '\f':
-                result += "\\f";
-                break;
-            case '\n':
-                result += "\\n";
-                break;
-            case '\r':
-                result += "\\r";
-                break;
-            case '\t':
-                result += "\\t";
-                break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    result += std::format("\\u{:04x}", static_cast<int>(c));
-                } else {
-                    result += c;
-                }
-                break;
+    result.reserve(str.size());
+    appendEscaped(result, str);
+    return result;
+}
+
+void JsonUtils::appendEscaped(std::string& out, std::string_view str) {
+    const char* data = str.data();
+    const size_t size = str.size();
+    size_t runStart = 0;  // First byte not yet copied to `out`
+    size_t i = 0;
+
+    // Copy the pending clean run, then the escape sequence for data[pos]
+    auto escapeAt = [&](size_t pos) {
+        out.append(data + runStart, pos - runStart);
+        const auto c = static_cast<unsigned char>(data[pos]);
+        if (const char shortForm = ESCAPE_TABLE[c]; shortForm != 'u') {
+            const char sequence[2] = {'\\', shortForm};
+            out.append(sequence, 2);
+        } else {
+            constexpr char hex[] = "0123456789abcdef";
+            const char sequence[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            out.append(sequence, 6);
+        }
+        runStart = pos + 1;
+    };
+
+#ifdef VELOCITYDB_SIMD_X86
+    // Widest blocks first, then narrower ones over what is left
+    const auto level = activeSimdLevel();
+    if (level >= SimdLevel::AVX512) {
+        i = scanEscapesAvx512(data, size, i, escapeAt);
+    }
+    if (level >= SimdLevel::AVX2) {
+        i = scanEscapesAvx2(data, size, i, escapeAt);
+    }
+    if (level >= SimdLevel::SSE42) {
+        i = scanEscapesSse2(data, size, i, escapeAt);
+    }
+#endif
+    for (; i < size; ++i) {
+        if (ESCAPE_TABLE[static_cast<unsigned char>(data[i])] != 0) {
+            escapeAt(i);
         }
     }
-    return result;
+    out.append(data + runStart, size - runStart);
 }
 
 void JsonUtils::appendColumns(std::string& json, const std::vector<ColumnInfo>& columns) {
@@ -68,55 +160,195 @@ void JsonUtils::appendColumns(std::string& json, const std::vector<ColumnInfo>&
         if (i > 0)
             json += ',';
         json += R"({"name":")";
-        json += escapeString(columns[i].name);
+        appendEscaped(json, columns[i].name);
         json += R"(","type":")";
         json += columns[i].type;  // Type names don't need escaping (SQL types are safe)
-        json += R"("})";
+        json += '"';
+        if (columns[i].precision > 0) {
+            json += std::format(R"(,"precision":{},"scale":{})", columns[i].precision, columns[i].scale);
+        }
+        json += '}';
     }
     json += ']';
 }
 
-void JsonUtils::appendResultSetFields(std::string& json, const ResultSet& result) {
-    appendColumns(json, result.columns);
-    json += R"(,"rows":[)";
+namespace {
+
+/// Append one cell as a JSON string (NULL is emitted as "")
+void appendCell(std::string& json, const ColumnData& column, size_t rowIndex) {
+    json += '"';
+    if (column.isNull(rowIndex)) {
+        // NULL is sent as an empty string (frontend convention)
+    } else if (column.type() == ColumnDataType::Text) {
+        // Text cells are escaped straight from the column arena
+        JsonUtils::appendEscaped(json, column.textAt(rowIndex));
+    } else {
+        // Numeric/date text never needs escaping
+        column.appendDisplayText(json, rowIndex);
+    }
+    json += '"';
+}
+
+}  // namespace
+
+void JsonUtils::appendRow(std::string& json, const ResultSet& result, size_t rowIndex) {
+    json += '[';
+    for (size_t colIndex = 0; colIndex < result.columnData.size(); ++colIndex) {
+        if (colIndex > 0)
+            json += ',';
+        appendCell(json, result.columnData[colIndex], rowIndex);
+    }
+    json += ']';
+}
+
+void JsonUtils::appendRowWindow(std::string& json, const ResultSet& result, std::span<const size_t> rows, std::span<const size_t> columns) {
+    if (columns.empty()) {
+        appendColumns(json, result.columns);
+    } else {
+        std::vector<ColumnInfo> selected;
+        selected.reserve(columns.size());
+        for (size_t colIndex : columns) {
+            selected.push_back(result.columns[colIndex]);
+        }
+        appendColumns(json, selected);
+    }
 
-    // Rows array - minimize allocations and function calls
-    for (size_t rowIndex = 0; rowIndex < result.rows.size(); ++rowIndex) {
-        if (rowIndex > 0)
+    json += R"(,"rows":[)";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (i > 0)
             json += ',';
+        if (columns.empty()) {
+            appendRow(json, result, rows[i]);
+            continue;
+        }
         json += '[';
-        const auto& row = result.rows[rowIndex];
-        for (size_t colIndex = 0; colIndex < row.values.size(); ++colIndex) {
-            if (colIndex > 0)
+        for (size_t j = 0; j < columns.size(); ++j) {
+            if (j > 0)
                 json += ',';
-            json += '"';
-            json += escapeString(row.values[colIndex]);
-            json += '"';
+            appendCell(json, result.columnData[columns[j]], rows[i]);
         }
         json += ']';
     }
+    json += ']';
+
+    if (result.lobPreviews.empty()) {
+        return;
+    }
+    bool first = true;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        auto [begin, end] = std::ranges::equal_range(result.lobPreviews, rows[i], {}, &LobPreview::row);
+        for (const auto& preview : std::ranges::subrange(begin, end)) {
+            size_t column = preview.column;
+            if (!columns.empty()) {
+                auto it = std::ranges::find(columns, preview.column);
+                if (it == columns.end()) {
+                    continue;
+                }
+                column = static_cast<size_t>(it - columns.begin());
+            }
+            json += first ? R"(,"lobPreviews":[)" : ",";
+            json += std::format("[{},{},{}]", i, column, preview.totalBytes);
+            first = false;
+        }
+    }
+    if (!first) {
+        json += ']';
+    }
+}
+
+void JsonUtils::appendLobPreviews(std::string& json, const ResultSet& result) {
+    if (result.lobPreviews.empty()) {
+        return;
+    }
+    json += R"(,"lobPreviews":[)";
+    for (size_t i = 0; i < result.lobPreviews.size(); ++i) {
+        const auto& preview = result.lobPreviews[i];
+        if (i > 0)
+            json += ',';
+        json += std::format("[{},{},{}]", preview.row, preview.column, preview.totalBytes);
+    }
+    json += ']';
+}
+
+void JsonUtils::appendServerMessages(std::string& json, const ServerMessages& messages) {
+    if (messages.empty()) {
+        return;
+    }
+    json += R"(,"messages":[)";
+    for (size_t i = 0; i < messages.size(); ++i) {
+        const auto message = messages[i];
+        json += i > 0 ? R"(,{"text":")" : R"({"text":")";
+        appendEscaped(json, message.text);
+        json += std::format(R"(","code":{},"state":"{}"}})", message.nativeError, message.sqlState);
+    }
+    json += ']';
+    if (messages.dropped() > 0) {
+        json += std::format(R"(,"messagesDropped":{})", messages.dropped());
+    }
+
+    const auto& statistics = messages.statistics();
+    if (statistics.empty()) {
+        return;
+    }
+    json += R"(,"statistics":{)";
+    if (statistics.hasTime) {
+        json += std::format(R"("cpuTimeMs":{},"elapsedTimeMs":{},"compileCpuTimeMs":{},"compileElapsedTimeMs":{},)", statistics.cpuTimeMs, statistics.elapsedTimeMs,
+                            statistics.compileCpuTimeMs, statistics.compileElapsedTimeMs);
+    }
+    json += R"("tables":[)";
+    for (size_t i = 0; i < statistics.tables.size(); ++i) {
+        const auto& table = statistics.tables[i];
+        json += i > 0 ? R"(,{"table":")" : R"({"table":")";
+        appendEscaped(json, table.table);
+        json += std::format(R"(","scanCount":{},"logicalReads":{},"physicalReads":{},"readAheadReads":{},"lobLogicalReads":{},"lobPhysicalReads":{}}})", table.scanCount,
+                            table.logicalReads, table.physicalReads, table.readAheadReads, table.lobLogicalReads, table.lobPhysicalReads);
+    }
+    json += "]}";
+}
+
+void JsonUtils::appendResultSetFields(std::string& json, const ResultSet& result, const std::atomic<bool>* cancelRequested) {
+    appendColumns(json, result.columns);
+    json += R"(,"rows":[)";
+
+    // Rows array - walk the column buffers directly, on several cores for large results
+    appendRows(
+        json, result.rowCount(),
+        [&](std::string& out, size_t rowIndex) {
+            if (rowIndex > 0)
+                out += ',';
+            appendRow(out, result, rowIndex);
+        },
+        cancelRequested);
 
     json += R"(],"affectedRows":)";
     json += std::to_string(result.affectedRows);
     json += R"(,"executionTimeMs":)";
     json += std::to_string(result.executionTimeMs);
+    if (result.fetchStats.rowsetSize > 0) {
+        json += std::format(R"(,"fetch":{{"mode":"{}","rowsetSize":{},"fetchTimeMs":{:.3f},"rowsPerSecond":{:.0f}}})", result.fetchStats.bulkFetch ? "bulk" : "row", result.fetchStats.rowsetSize,
+                            result.fetchStats.fetchTimeMs, result.fetchStats.rowsPerSecond);
+    }
+    if (result.truncated) {
+        json += R"(,"truncated":true)";
+    }
+    appendServerMessages(json, result.messages);
+    appendLobPreviews(json, result);
 }
 
-std::string JsonUtils::serializeResultSet(const ResultSet& result, bool cached) {
+std::string JsonUtils::serializeResultSet(const ResultSet& result, bool cached, const std::atomic<bool>* cancelRequested) {
+    TraceScope span("json.serialize");
     // Buffer size estimation: base (~150) + columns (~65 each) + rows (per-cell ~2x + overhead)
     size_t estimatedSize = 150 + result.columns.size() * 65;
-    for (const auto& row : result.rows) {
-        estimatedSize += 10;
-        for (const auto& val : row.values) {
-            estimatedSize += val.size() * 2 + 5;
-        }
+    estimatedSize += result.rowCount() * 10;
+    for (const auto& column : result.columnData) {
+        estimatedSize += column.size() * 5 + (column.type() == ColumnDataType::Text || column.type() == ColumnDataType::Binary ? column.rowTextBytes() * 2 : column.size() * 24);
     }
 
     std::string json;
     json.reserve(estimatedSize);
 
     json += '{';
-    appendResultSetFields(json, result);
+    appendResultSetFields(json, result, cancelRequested);
     json += R"(,"cached":)";
     json += cached ? "true" : "false";
     json += '}';
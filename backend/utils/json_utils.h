@@ -1,35 +1,127 @@
 #pragma once
 
+#include "../database/result_set.h"
+#include "cancellation_token.h"
+
+#include <algorithm>
+#include <exception>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 namespace velocitydb {
 
-// Forward declarations
-struct ColumnInfo;
-struct ResultRow;
-struct ResultSet;
-
 /// JSON utilities with optimized string building for large datasets.
 class JsonUtils {
 public:
+    /// Row counts from which appendRows splits the work across cores, and the smallest slice worth a thread
+    static constexpr size_t PARALLEL_MIN_ROWS = 32768;
+    static constexpr size_t MIN_ROWS_PER_SLICE = 8192;
+
     [[nodiscard]] static std::string successResponse(std::string_view data);
     [[nodiscard]] static std::string errorResponse(std::string_view message);
+    /// `retriable` adds "retriable":true, telling the caller the request may succeed if simply sent again
+    [[nodiscard]] static std::string errorResponse(std::string_view message, bool retriable);
     [[nodiscard]] static std::string escapeString(std::string_view str);
 
+    /// Append `str` JSON-escaped to `out` (no surrounding quotes), without temporaries.
+    /// Scans 64, 32 or 16 bytes per step (AVX-512, AVX2, SSE2 by activeSimdLevel()) and copies clean runs in bulk.
+    static void appendEscaped(std::string& out, std::string_view str);
+
     /// Serialize a ResultSet to JSON with pre-allocated buffer for performance.
     /// @param result The query result to serialize
     /// @param cached Whether the result was from cache
+    /// @param cancelRequested Polled every CANCEL_CHECK_ROWS rows; once raised, throws OperationCancelled
     /// @return JSON string representation
-    [[nodiscard]] static std::string serializeResultSet(const ResultSet& result, bool cached);
+    [[nodiscard]] static std::string serializeResultSet(const ResultSet& result, bool cached, const std::atomic<bool>* cancelRequested = nullptr);
 
-    /// Append column definitions as JSON array field: "columns":[...]
+    /// Append column definitions as JSON array field: "columns":[...] (with "precision" and "scale" when known)
     static void appendColumns(std::string& json, const std::vector<ColumnInfo>& columns);
 
-    /// Append ResultSet columns/rows/affectedRows/executionTimeMs as JSON fields (no outer braces).
+    /// Append one result row as a JSON array of strings: [...] (NULL is emitted as "")
+    static void appendRow(std::string& json, const ResultSet& result, size_t rowIndex);
+
+    /// Append "columns":[...],"rows":[...] for rows `rows` of `result`, restricted to `columns` (all when empty).
+    /// Only the requested cells are read, so a grid window costs the same whatever the size of the result.
+    /// Cells cut to a LOB preview are listed as "lobPreviews":[[row,column,totalBytes],...] in window positions.
+    static void appendRowWindow(std::string& json, const ResultSet& result, std::span<const size_t> rows, std::span<const size_t> columns);
+
+    /// Append ,"lobPreviews":[[row,column,totalBytes],...] for the cells cut to a preview (nothing when there are none)
+    static void appendLobPreviews(std::string& json, const ResultSet& result);
+
+    /// Append ,"messages":[{"text","code","state"},...] for the server's informational output, plus "messagesDropped"
+    /// past ServerMessages::MAX_MESSAGES and "statistics":{...} with the parsed STATISTICS IO/TIME figures (nothing when empty)
+    static void appendServerMessages(std::string& json, const ServerMessages& messages);
+
+    /// Append ResultSet columns/rows/affectedRows/executionTimeMs (and fetch stats and server messages when available) as JSON fields (no outer braces).
     /// Use when embedding ResultSet data into a larger JSON object.
-    static void appendResultSetFields(std::string& json, const ResultSet& result);
+    static void appendResultSetFields(std::string& json, const ResultSet& result, const std::atomic<bool>* cancelRequested = nullptr);
+
+    /// Append rows [0, rowCount) to `json`, `appendRow(out, row)` writing each one (separator included).
+    /// From PARALLEL_MIN_ROWS rows on, contiguous slices are written on separate threads into their own
+    /// buffers, which are then copied into `json` in order after a single reserve. `appendRow` must only
+    /// read shared state. Every slice checks `cancelRequested` each CANCEL_CHECK_ROWS rows and throws
+    /// OperationCancelled once it is raised.
+    template <typename AppendRow>
+    static void appendRows(std::string& json, size_t rowCount, AppendRow&& appendRow, const std::atomic<bool>* cancelRequested = nullptr) {
+        const size_t hardware = (std::max)(std::thread::hardware_concurrency(), 1u);
+        const size_t slices = rowCount >= PARALLEL_MIN_ROWS ? (std::min)(hardware, rowCount / MIN_ROWS_PER_SLICE) : 1;
+        if (slices <= 1) {
+            for (size_t row = 0; row < rowCount; ++row) {
+                if (row % CANCEL_CHECK_ROWS == 0)
+                    throwIfCancelled(cancelRequested);
+                appendRow(json, row);
+            }
+            return;
+        }
+
+        std::vector<std::string> buffers(slices);
+        std::vector<std::exception_ptr> errors(slices);
+        auto runSlice = [&](size_t slice) {
+            try {
+                const size_t begin = rowCount * slice / slices;
+                const size_t end = rowCount * (slice + 1) / slices;
+                // Sized from the slice's first rows, so most slices never reallocate
+                auto& out = buffers[slice];
+                const size_t sample = (std::min)(end - begin, size_t{64});
+                for (size_t row = begin; row < begin + sample; ++row) {
+                    appendRow(out, row);
+                }
+                out.reserve(out.size() / sample * (end - begin) * 9 / 8);
+                for (size_t row = begin + sample; row < end; ++row) {
+                    if ((row - begin) % CANCEL_CHECK_ROWS == 0)
+                        throwIfCancelled(cancelRequested);
+                    appendRow(out, row);
+                }
+            } catch (...) {
+                errors[slice] = std::current_exception();
+            }
+        };
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(slices - 1);
+            for (size_t slice = 1; slice < slices; ++slice) {
+                workers.emplace_back(runSlice, slice);
+            }
+            runSlice(0);
+        }
+        for (auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        size_t total = json.size();
+        for (const auto& buffer : buffers) {
+            total += buffer.size();
+        }
+        json.reserve(total);
+        for (const auto& buffer : buffers) {
+            json += buffer;
+        }
+    }
 
     /// 任意のコレクションから JSON 配列を構築
     template <typename Items, typename Formatter>
@@ -48,11 +140,11 @@ public:
 
     /// ResultSet の行から JSON 配列を構築 (bounds check + カンマ処理を共通化)
     template <typename Formatter>
-    [[nodiscard]] static std::string buildRowArray(const std::vector<ResultRow>& rows, size_t minColumns, Formatter&& fmt) {
+    [[nodiscard]] static std::string buildRowArray(const ResultSet& result, size_t minColumns, Formatter&& fmt) {
         std::string json = "[";
         bool first = true;
-        for (const auto& row : rows) {
-            if (row.values.size() < minColumns)
+        for (const auto& row : result.rows()) {
+            if (row.size() < minColumns)
                 continue;
             if (!first)
                 json += ',';
@@ -0,0 +1,73 @@
+#include "log_filter.h"
+
+#include <algorithm>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+void appendLine(std::string& block, std::string_view timestamp, std::string_view level, std::string_view message) {
+    block += '[';
+    block += timestamp;
+    block += "] [";
+    block += level;
+    block += "] ";
+    block += message;
+    block += '\n';
+}
+
+}  // namespace
+
+LogFilter::LogFilter(double ratePerSecond, double burst)
+    : m_rate(ratePerSecond)
+    , m_burst(burst)
+    , m_tokens(burst)
+    , m_refilled(Clock::now()) {}
+
+size_t LogFilter::append(std::span<const LogRecord> records, std::string& block, Clock::time_point now) {
+    if (now > m_refilled) {
+        const std::chrono::duration<double> elapsed = now - m_refilled;
+        m_tokens = (std::min)(m_burst, m_tokens + elapsed.count() * m_rate);
+        m_refilled = now;
+    }
+
+    size_t written = 0;
+    for (const auto& record : records) {
+        if (m_tokens < 1.0) [[unlikely]] {
+            ++m_pendingDropped;
+            ++m_totalDropped;
+            continue;
+        }
+        m_tokens -= 1.0;
+
+        if (record.level == m_lastLevel && record.message == m_lastMessage) {
+            ++m_repeats;
+            ++m_totalFolded;
+            m_lastTimestamp.assign(record.timestamp);
+            continue;
+        }
+        flushRepeats(block);
+        if (m_pendingDropped > 0) [[unlikely]] {
+            appendLine(block, record.timestamp, "WARNING", std::format("{} frontend log records dropped (rate limit)", m_pendingDropped));
+            m_pendingDropped = 0;
+        }
+        appendLine(block, record.timestamp, record.level, record.message);
+        m_lastLevel.assign(record.level);
+        m_lastMessage.assign(record.message);
+        ++written;
+    }
+    // Report repeats per batch, so a message stuck in a loop still shows up while it loops
+    flushRepeats(block);
+    return written;
+}
+
+void LogFilter::flushRepeats(std::string& block) {
+    if (m_repeats == 0) {
+        return;
+    }
+    appendLine(block, m_lastTimestamp, m_lastLevel, std::format("(previous message repeated {} more times)", m_repeats));
+    m_repeats = 0;
+}
+
+}  // namespace velocitydb
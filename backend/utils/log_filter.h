@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// One log record as another process formatted it
+struct LogRecord {
+    std::string_view timestamp;
+    std::string_view level;
+    std::string_view message;
+};
+
+/// Rate limiting and repeat folding for log records arriving from outside the backend (the frontend).
+///
+/// A token bucket lets RATE records a second through, with bursts of up to BURST; records beyond that are counted
+/// and reported in one WARNING line once records pass again. A run of records with the same level and message is
+/// written once, followed by a line saying how many times it repeated. Not thread-safe.
+class LogFilter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double DEFAULT_RATE = 200.0;
+    static constexpr double DEFAULT_BURST = 1000.0;
+
+    explicit LogFilter(double ratePerSecond = DEFAULT_RATE, double burst = DEFAULT_BURST);
+
+    /// Append `[timestamp] [level] message` lines for the records that pass to `block`
+    /// @return Records written (repeat and drop notices not counted)
+    size_t append(std::span<const LogRecord> records, std::string& block, Clock::time_point now = Clock::now());
+
+    /// Records dropped by the rate limit so far
+    [[nodiscard]] size_t dropped() const noexcept { return m_totalDropped; }
+    /// Records folded into a repeat notice so far
+    [[nodiscard]] size_t folded() const noexcept { return m_totalFolded; }
+
+private:
+    void flushRepeats(std::string& block);
+
+    const double m_rate;
+    const double m_burst;
+    double m_tokens;
+    Clock::time_point m_refilled;
+
+    std::string m_lastLevel;
+    std::string m_lastMessage;
+    std::string m_lastTimestamp;
+    size_t m_repeats = 0;        ///< Copies of the last record folded and not yet reported
+    size_t m_pendingDropped = 0;  ///< Dropped since the last notice
+    size_t m_totalDropped = 0;
+    size_t m_totalFolded = 0;
+};
+
+}  // namespace velocitydb
@@ -1,92 +1,276 @@
 #include "logger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace velocitydb {
 
-/**
- * @brief File log output implementation
- *
- * Concrete class of LogOutput interface.
- * Outputs to file and console with timestamps.
- * Thread-safe.
- */
-class FileLogOutput : public LogOutput {
-private:
-    std::ofstream file_;
-    std::mutex mutex_;
+namespace {
 
-    [[nodiscard]] std::string get_timestamp() const {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+constexpr auto WRITER_POLL_INTERVAL = std::chrono::milliseconds(20);
 
-        std::tm tm{};
+[[nodiscard]] std::string get_timestamp() {
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+
+    std::tm tm{};
 #ifdef _WIN32
-        localtime_s(&tm, &time_t);
+    localtime_s(&tm, &time_t);
 #else
-        localtime_r(&time_t, &tm);
+    localtime_r(&time_t, &tm);
 #endif
 
-        return std::format("{:04d}-{:02d}-{:02d} {:02d}:{:02d}:{:02d}.{:03d}", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms.count()));
-    }
+    return std::format("{:04d}-{:02d}-{:02d} {:02d}:{:02d}:{:02d}.{:03d}", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms.count()));
+}
 
+[[nodiscard]] std::string format_record(LogLevel level, std::string_view message) {
+    return std::format("[{}] [{}] {}\n", get_timestamp(), log_level_to_string(level), message);
+}
+
+/**
+ * @brief Bounded multi-producer / single-consumer ring of formatted records
+ *
+ * Each cell carries a sequence number telling whose turn it is: producers claim a position with one CAS and
+ * publish the cell by advancing its sequence, the consumer takes published cells in order. No locks.
+ */
+class RecordRing {
 public:
-    explicit FileLogOutput(std::string_view filepath) {
+    explicit RecordRing(size_t capacity) : cells_(std::bit_ceil(std::max<size_t>(capacity, 2))), mask_(cells_.size() - 1) {
+        for (size_t i = 0; i < cells_.size(); ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] bool try_push(std::string& record) noexcept {
+        auto position = enqueue_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& cell = cells_[position & mask_];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.record = std::move(record);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                position = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Consumer only
+    [[nodiscard]] bool try_pop(std::string& out) noexcept {
+        auto& cell = cells_[dequeue_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_ + 1) {
+            return false;
+        }
+        out.append(cell.record);
+        cell.record.clear();
+        cell.sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_;
+        return true;
+    }
+
+    /// Positions claimed by producers so far
+    [[nodiscard]] size_t claimed() const noexcept { return enqueue_.load(std::memory_order_acquire); }
+
+    /// Records taken by the consumer so far (consumer only)
+    [[nodiscard]] size_t consumed() const noexcept { return dequeue_; }
+
+    [[nodiscard]] size_t capacity() const noexcept { return cells_.size(); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        std::string record;
+    };
+
+    std::vector<Cell> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_{0};
+    alignas(64) size_t dequeue_ = 0;
+};
+
+}  // namespace
+
+struct AsyncFileLogOutput::Impl {
+    RecordRing ring;
+    LogOverflowPolicy policy;
+    bool echo_to_console;
+    std::ofstream file;
+
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> flush_requested{false};
+    std::atomic<size_t> flushed{0};  ///< Ring positions written and flushed
+    bool stopping = false;           ///< Guarded by mutex
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed_cv;
+    std::thread writer;
+
+    Impl(std::string_view filepath, size_t capacity, LogOverflowPolicy policy, bool echo_to_console) : ring(capacity), policy(policy), echo_to_console(echo_to_console) {
         // Create log directory if it doesn't exist
         std::filesystem::path log_path(filepath);
         if (auto parent_path = log_path.parent_path(); !parent_path.empty()) {
-            std::filesystem::create_directories(parent_path);
+            std::error_code ec;
+            std::filesystem::create_directories(parent_path, ec);
         }
 
         // Open in truncate mode to clear log on startup
-        file_.open(std::string(filepath), std::ios::out | std::ios::trunc);
-        if (!file_.is_open()) {
+        file.open(log_path, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file.is_open()) {
             std::cerr << "Failed to open log file: " << filepath << '\n';
         }
+
+        writer = std::thread([this] { run(); });
     }
 
-    ~FileLogOutput() override {
-        if (file_.is_open()) {
-            file_.close();
+    /// Queue `record` under the overflow policy; false when it was dropped
+    bool push(std::string& record) {
+        while (!ring.try_push(record)) [[unlikely]] {
+            if (policy == LogOverflowPolicy::DROP) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wake.notify_one();
+            std::this_thread::yield();
+        }
+        if (ring.claimed() - flushed.load(std::memory_order_relaxed) > ring.capacity() / 2) {
+            wake.notify_one();  // Filling up; don't wait for the poll interval
         }
+        return true;
     }
 
-    void write(LogLevel level, std::string_view message) override {
-        std::lock_guard lock(mutex_);
-
-        auto timestamp = get_timestamp();
-        auto level_str = log_level_to_string(level);
-        auto log_message = std::format("[{}] [{}] {}\n", timestamp, level_str, message);
+    void request_flush() {
+        flush_requested.store(true, std::memory_order_release);
+        std::lock_guard lock(mutex);
+        wake.notify_one();
+    }
 
-        // Output to both file and console
-        if (file_.is_open()) {
-            file_ << log_message;
+    void wait_flushed(size_t target) {
+        request_flush();
+        std::unique_lock lock(mutex);
+        // Re-ask while waiting: a producer may have claimed a slot below `target` that it had not yet published
+        while (!flushed_cv.wait_for(lock, WRITER_POLL_INTERVAL, [&] { return flushed.load(std::memory_order_acquire) >= target; })) {
+            flush_requested.store(true, std::memory_order_release);
+            wake.notify_one();
         }
-
-        std::cout << log_message;
     }
 
-    void flush() override {
-        std::lock_guard lock(mutex_);
-        if (file_.is_open()) {
-            file_.flush();
+    void run() {
+        std::string batch;
+        uint64_t reported_drops = 0;
+        auto last_flush = std::chrono::steady_clock::now();
+
+        for (;;) {
+            bool stop = false;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait_for(lock, WRITER_POLL_INTERVAL, [&] { return stopping || flush_requested.load(std::memory_order_acquire); });
+                stop = stopping;
+            }
+            const bool flush_now = flush_requested.exchange(false, std::memory_order_acq_rel);
+
+            batch.clear();
+            while (ring.try_pop(batch)) {
+            }
+            if (const auto drops = dropped.load(std::memory_order_relaxed); drops != reported_drops) [[unlikely]] {
+                batch += format_record(LogLevel::WARNING, std::format("{} log records dropped (buffer full)", drops - reported_drops));
+                reported_drops = drops;
+            }
+
+            if (!batch.empty()) {
+                if (file.is_open()) {
+                    file.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                }
+                if (echo_to_console) {
+                    std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                }
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (flush_now || stop || now - last_flush >= FLUSH_INTERVAL) {
+                if (file.is_open()) {
+                    file.flush();
+                }
+                if (echo_to_console) {
+                    std::cout.flush();
+                }
+                last_flush = now;
+                {
+                    std::lock_guard lock(mutex);
+                    flushed.store(ring.consumed(), std::memory_order_release);
+                }
+                flushed_cv.notify_all();
+            }
+
+            // A producer may still be publishing a claimed slot; keep going until it lands
+            if (stop && ring.consumed() == ring.claimed()) {
+                break;
+            }
         }
-        std::cout.flush();
     }
 };
 
-// Global log output instance
-static FileLogOutput global_log_output("log/backend.log");
+AsyncFileLogOutput::AsyncFileLogOutput(std::string_view filepath, size_t capacity, LogOverflowPolicy policy, bool echo_to_console)
+    : impl_(std::make_unique<Impl>(filepath, capacity, policy, echo_to_console)) {}
+
+AsyncFileLogOutput::~AsyncFileLogOutput() {
+    {
+        std::lock_guard lock(impl_->mutex);
+        impl_->stopping = true;
+    }
+    impl_->wake.notify_one();
+    impl_->writer.join();
+}
+
+void AsyncFileLogOutput::write(LogLevel level, std::string_view message) {
+    auto record = format_record(level, message);
+    if (!impl_->push(record)) [[unlikely]] {
+        return;
+    }
+    if (level == LogLevel::CRITICAL) [[unlikely]] {
+        drain();
+    }
+}
+
+void AsyncFileLogOutput::write_block(std::string block) {
+    if (!block.empty()) {
+        (void)impl_->push(block);
+    }
+}
+
+void AsyncFileLogOutput::flush() {
+    impl_->request_flush();
+}
+
+void AsyncFileLogOutput::drain() {
+    impl_->wait_flushed(impl_->ring.claimed());
+}
+
+uint64_t AsyncFileLogOutput::dropped() const noexcept {
+    return impl_->dropped.load(std::memory_order_relaxed);
+}
 
 // Initialization function (call at the beginning of main())
 void initialize_logger() {
+    // Constructed on first use so that binaries which never initialize the logger don't start the writer thread
+    static AsyncFileLogOutput global_log_output("log/backend.log");
     get_logger().set_output(&global_log_output);
     get_logger().set_min_level(LogLevel::DEBUG);
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string_view>
 
 namespace velocitydb {
@@ -41,6 +44,73 @@ public:
     virtual void flush() = 0;
 };
 
+/**
+ * @brief What a full AsyncFileLogOutput queue does with another record
+ */
+enum class LogOverflowPolicy : uint8_t {
+    DROP,   ///< Discard the record and count it (the caller never waits)
+    BLOCK,  ///< Wait until the writer thread makes room
+};
+
+/**
+ * @brief Asynchronous file (and console) log output
+ *
+ * write() formats the record on the calling thread, timestamp included, and pushes it into a bounded
+ * lock-free multi-producer ring. One background thread drains the ring in batches, writes each batch
+ * with a single call per destination and flushes every FLUSH_INTERVAL, or sooner when flush() asks.
+ * flush() only wakes the writer, so frequent log_flush() calls stay off hot paths; drain() waits.
+ * CRITICAL records are drained before write() returns. Dropped records are reported in the log.
+ * Thread-safe.
+ */
+class AsyncFileLogOutput : public LogOutput {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 8192;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{250};
+
+    /**
+     * @param filepath Log file, truncated on open (directories are created)
+     * @param capacity Ring slots, rounded up to a power of two
+     * @param policy What write() does while the ring is full
+     * @param echo_to_console Also write every record to stdout
+     */
+    explicit AsyncFileLogOutput(std::string_view filepath, size_t capacity = DEFAULT_CAPACITY, LogOverflowPolicy policy = LogOverflowPolicy::DROP, bool echo_to_console = true);
+    ~AsyncFileLogOutput() override;
+
+    AsyncFileLogOutput(const AsyncFileLogOutput&) = delete;
+    AsyncFileLogOutput& operator=(const AsyncFileLogOutput&) = delete;
+    AsyncFileLogOutput(AsyncFileLogOutput&&) = delete;
+    AsyncFileLogOutput& operator=(AsyncFileLogOutput&&) = delete;
+
+    void write(LogLevel level, std::string_view message) override;
+
+    /**
+     * @brief Queue lines formatted elsewhere (each ending in a newline) as one ring record
+     *
+     * For records that already carry their own timestamp and level, e.g. the frontend's: a whole batch costs
+     * one ring slot and reaches the file in one piece. Subject to the overflow policy like write().
+     */
+    void write_block(std::string block);
+
+    /**
+     * @brief Ask the writer thread to write and flush what is queued, without waiting for it
+     */
+    void flush() override;
+
+    /**
+     * @brief Block until every record written before the call is on disk
+     */
+    void drain();
+
+    /**
+     * @brief Records discarded under LogOverflowPolicy::DROP so far
+     */
+    [[nodiscard]] uint64_t dropped() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 /**
  * @brief Simple Logger implementation
  *
@@ -172,7 +242,7 @@ public:
  * @par Example
  * @code
  * // During initialization (setup(), etc.)
- * static FileLogOutput log_output("log/backend.log");
+ * static AsyncFileLogOutput log_output("log/backend.log");
  * get_logger().set_output(&log_output);
  * get_logger().set_min_level(LogLevel::DEBUG);
  *
@@ -214,6 +284,8 @@ void log(std::string_view message) {
 
 /**
  * @brief Flush global logger
+ *
+ * With the default AsyncFileLogOutput this only wakes the writer thread.
  */
 inline void log_flush() {
     get_logger().flush();
@@ -0,0 +1,216 @@
+#include "lz4_codec.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;  ///< The block always ends with at least this many literals
+constexpr size_t MATCH_LIMIT = 12;   ///< No match may start within this many bytes of the end
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+
+uint32_t load32(const uint8_t* p) noexcept {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t load64(const uint8_t* p) noexcept {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashSequence(uint32_t sequence) noexcept {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/// Length of the common prefix of `a` and `b`, reading no further than `limit` from `b`
+size_t commonLength(const uint8_t* a, const uint8_t* b, const uint8_t* limit) noexcept {
+    const uint8_t* start = b;
+    while (b + 8 <= limit) {
+        if (uint64_t diff = load64(a) ^ load64(b)) {
+            return static_cast<size_t>(b - start) + (std::countr_zero(diff) >> 3);
+        }
+        a += 8;
+        b += 8;
+    }
+    while (b < limit && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return static_cast<size_t>(b - start);
+}
+
+class BlockWriter {
+public:
+    BlockWriter(char* output, size_t capacity) noexcept : m_out(reinterpret_cast<uint8_t*>(output)), m_end(m_out + capacity), m_begin(m_out) {}
+
+    /// Emit literals followed by a match (matchLength 0 = final literal-only sequence)
+    bool sequence(const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) noexcept {
+        const size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+        const size_t worst = 1 + literalLength / 255 + 1 + literalLength + 2 + matchCode / 255 + 1;
+        if (worst > static_cast<size_t>(m_end - m_out)) [[unlikely]] {
+            return false;
+        }
+
+        uint8_t* token = m_out++;
+        *token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+        if (literalLength >= 15) {
+            writeLength(literalLength - 15);
+        }
+        std::memcpy(m_out, literals, literalLength);
+        m_out += literalLength;
+
+        if (matchLength == 0) {
+            return true;
+        }
+        *m_out++ = static_cast<uint8_t>(offset);
+        *m_out++ = static_cast<uint8_t>(offset >> 8);
+        *token |= static_cast<uint8_t>(matchCode >= 15 ? 15 : matchCode);
+        if (matchCode >= 15) {
+            writeLength(matchCode - 15);
+        }
+        return true;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return static_cast<size_t>(m_out - m_begin); }
+
+private:
+    void writeLength(size_t length) noexcept {
+        while (length >= 255) {
+            *m_out++ = 255;
+            length -= 255;
+        }
+        *m_out++ = static_cast<uint8_t>(length);
+    }
+
+    uint8_t* m_out;
+    uint8_t* m_end;
+    uint8_t* m_begin;
+};
+
+}  // namespace
+
+size_t Lz4Codec::compress(std::string_view input, char* output, size_t capacity) noexcept {
+    if (input.size() > MAX_INPUT_BYTES) [[unlikely]] {
+        return 0;
+    }
+
+    const auto* base = reinterpret_cast<const uint8_t*>(input.data());
+    const size_t n = input.size();
+    BlockWriter writer(output, capacity);
+
+    size_t anchor = 0;
+    if (n > MATCH_LIMIT) {
+        // Positions are stored +1 so zero marks an empty slot
+        auto table = std::make_unique<std::array<uint32_t, size_t{1} << HASH_BITS>>();
+        table->fill(0);
+
+        const size_t matchStartLimit = n - MATCH_LIMIT;
+        const uint8_t* matchEndLimit = base + n - LAST_LITERALS;
+        size_t pos = 0;
+        while (pos < matchStartLimit) {
+            const uint32_t sequence = load32(base + pos);
+            uint32_t& slot = (*table)[hashSequence(sequence)];
+            const size_t candidate = slot;
+            slot = static_cast<uint32_t>(pos + 1);
+
+            if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET || load32(base + candidate - 1) != sequence) {
+                // Skip faster through data that is not compressing
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+
+            const size_t matchPos = candidate - 1;
+            const size_t matchLength = MIN_MATCH + commonLength(base + matchPos + MIN_MATCH, base + pos + MIN_MATCH, matchEndLimit);
+            if (!writer.sequence(base + anchor, pos - anchor, pos - matchPos, matchLength)) {
+                return 0;
+            }
+            pos += matchLength;
+            anchor = pos;
+            if (pos < matchStartLimit) {
+                (*table)[hashSequence(load32(base + pos - 2))] = static_cast<uint32_t>(pos - 1);
+            }
+        }
+    }
+
+    if (!writer.sequence(base + anchor, n - anchor, 0, 0)) {
+        return 0;
+    }
+    return writer.size();
+}
+
+bool Lz4Codec::decompress(std::string_view input, char* output, size_t outputBytes) noexcept {
+    const auto* in = reinterpret_cast<const uint8_t*>(input.data());
+    const auto* inEnd = in + input.size();
+    auto* out = reinterpret_cast<uint8_t*>(output);
+    auto* const outBegin = out;
+    auto* const outEnd = out + outputBytes;
+
+    auto readLength = [&](size_t& length) {
+        uint8_t extra = 255;
+        while (extra == 255) {
+            if (in == inEnd) {
+                return false;
+            }
+            extra = *in++;
+            length += extra;
+        }
+        return true;
+    };
+
+    while (in < inEnd) {
+        const uint8_t token = *in++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(inEnd - in) || literalLength > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        if (in == inEnd) {
+            break;  // final literal-only sequence
+        }
+
+        if (inEnd - in < 2) {
+            return false;
+        }
+        const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(out - outBegin) || matchLength > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+
+        const uint8_t* match = out - offset;
+        if (offset >= matchLength) {
+            std::memcpy(out, match, matchLength);
+            out += matchLength;
+        } else {
+            // Overlapping match repeats the last `offset` bytes
+            for (size_t i = 0; i < matchLength; ++i) {
+                *out++ = match[i];
+            }
+        }
+    }
+    return out == outEnd;
+}
+
+}  // namespace velocitydb
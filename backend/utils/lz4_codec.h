@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace velocitydb {
+
+/// LZ4 block-format codec (the raw block layout of the reference library, without frame headers).
+/// Greedy single-pass matcher: favours throughput over ratio, which suits columnar result data.
+class Lz4Codec {
+public:
+    /// Largest input a single block may hold
+    static constexpr size_t MAX_INPUT_BYTES = 0x7E000000;
+
+    /// Worst-case compressed size for `inputBytes` of incompressible input
+    [[nodiscard]] static constexpr size_t compressBound(size_t inputBytes) noexcept { return inputBytes + inputBytes / 255 + 16; }
+
+    /// Compress `input` into `output`. Returns the compressed size, or 0 if it does not fit in `capacity`
+    [[nodiscard]] static size_t compress(std::string_view input, char* output, size_t capacity) noexcept;
+
+    /// Decompress a block that must expand to exactly `outputBytes`. Returns false on malformed input
+    [[nodiscard]] static bool decompress(std::string_view input, char* output, size_t outputBytes) noexcept;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Read-only memory mapping of a whole file. The file is opened with delete sharing, so it can be
+/// replaced or removed while mapped; the view stays valid until close().
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    /// Map the file at a UTF-8 path. Closes any previous mapping first.
+    [[nodiscard]] bool open(const std::string& filepath);
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const noexcept { return m_file != nullptr; }
+    [[nodiscard]] std::string_view view() const noexcept { return {m_data, m_size}; }
+
+private:
+    void* m_file = nullptr;     // HANDLE; nullptr when closed
+    void* m_mapping = nullptr;  // HANDLE; nullptr for empty files
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,72 @@
+#include "memory_governor.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <exception>
+#include <format>
+
+namespace velocitydb {
+
+MemoryGovernor& MemoryGovernor::instance() {
+    static MemoryGovernor governor;
+    return governor;
+}
+
+size_t MemoryGovernor::used() const noexcept {
+    size_t total = 0;
+    for (const auto& pool : m_used) {
+        total += pool.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t MemoryGovernor::addReclaimer(MemoryPool pool, Reclaimer reclaimer) {
+    std::lock_guard lock(m_reclaimMutex);
+    const uint64_t id = m_nextId++;
+    // Stable by pool, so reclaimers of one pool run in registration order
+    auto pos = std::upper_bound(m_reclaimers.begin(), m_reclaimers.end(), pool, [](MemoryPool p, const Registration& r) { return p < r.pool; });
+    m_reclaimers.insert(pos, Registration{.id = id, .pool = pool, .reclaim = std::move(reclaimer)});
+    return id;
+}
+
+void MemoryGovernor::removeReclaimer(uint64_t id) {
+    std::lock_guard lock(m_reclaimMutex);
+    std::erase_if(m_reclaimers, [id](const Registration& r) { return r.id == id; });
+}
+
+size_t MemoryGovernor::reclaimIfNeeded() {
+    if (!overBudget()) {
+        return 0;
+    }
+    std::unique_lock lock(m_reclaimMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return 0;  // Someone else is already bringing usage down
+    }
+
+    const size_t target = budget() / 100 * LOW_WATER_PERCENT;
+    size_t released = 0;
+    for (auto& registration : m_reclaimers) {
+        const size_t current = used();
+        if (current <= target) {
+            break;
+        }
+        try {
+            released += registration.reclaim(current - target);
+        } catch (const std::exception& e) {
+            log<LogLevel::WARNING>(std::format("Memory reclaimer failed: {}", e.what()));
+        }
+    }
+    m_reclaimed.fetch_add(released, std::memory_order_relaxed);
+    if (used() > budget()) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Result memory still over budget after reclaiming {} bytes: {} of {} bytes in use", released, used(), budget()));
+    }
+    return released;
+}
+
+std::string MemoryGovernor::toJson() const {
+    return std::format(R"({{"budgetBytes":{},"usedBytes":{},"cacheBytes":{},"heldBytes":{},"inFlightBytes":{},"reclaimedBytes":{}}})", budget(), used(), used(MemoryPool::ResultCache),
+                       used(MemoryPool::HeldResults), used(MemoryPool::InFlight), m_reclaimed.load(std::memory_order_relaxed));
+}
+
+}  // namespace velocitydb
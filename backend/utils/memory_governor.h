@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+/// Where result memory is held. Reclaimers run in this order, so the cheapest memory to give up comes first.
+enum class MemoryPool : uint8_t {
+    ResultCache,  ///< Shared query cache: evicting costs a re-run on the next hit
+    HeldResults,  ///< Results held for a grid: spilled to disk and read back on next use
+    InFlight,     ///< Rows buffered by async queries: streaming ones cannot be reclaimed, finished ones are spilled to disk
+};
+
+/// Process-wide budget over the memory held by results.
+///
+/// Each subsystem still bounds itself, but their caps add up to more than the machine may have. Consumers
+/// charge and release the bytes they hold per pool; once the total passes the budget, reclaimIfNeeded()
+/// asks the registered reclaimers to give memory back until usage is down to LOW_WATER_PERCENT of it.
+///
+/// Charging never blocks or reclaims by itself: callers invoke reclaimIfNeeded() once they hold none of
+/// their own locks, since a reclaimer may take them.
+class MemoryGovernor {
+public:
+    static constexpr size_t DEFAULT_BUDGET = size_t{2} * 1024 * 1024 * 1024;
+    static constexpr size_t LOW_WATER_PERCENT = 85;
+    static constexpr size_t POOL_COUNT = 3;
+
+    /// Frees up to `wanted` bytes from one pool; returns the bytes actually released
+    using Reclaimer = std::function<size_t(size_t wanted)>;
+
+    explicit MemoryGovernor(size_t budget = DEFAULT_BUDGET) : m_budget(budget) {}
+
+    MemoryGovernor(const MemoryGovernor&) = delete;
+    MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+    [[nodiscard]] static MemoryGovernor& instance();
+
+    void setBudget(size_t bytes) noexcept { m_budget.store(bytes, std::memory_order_relaxed); }
+    [[nodiscard]] size_t budget() const noexcept { return m_budget.load(std::memory_order_relaxed); }
+
+    void charge(MemoryPool pool, size_t bytes) noexcept { m_used[index(pool)].fetch_add(bytes, std::memory_order_relaxed); }
+    void release(MemoryPool pool, size_t bytes) noexcept { m_used[index(pool)].fetch_sub(bytes, std::memory_order_relaxed); }
+
+    [[nodiscard]] size_t used() const noexcept;
+    [[nodiscard]] size_t used(MemoryPool pool) const noexcept { return m_used[index(pool)].load(std::memory_order_relaxed); }
+    [[nodiscard]] bool overBudget() const noexcept { return used() > budget(); }
+
+    /// Register a reclaimer for `pool`; the returned id removes it again
+    [[nodiscard]] uint64_t addReclaimer(MemoryPool pool, Reclaimer reclaimer);
+    /// Unregister; returns once no call to the reclaimer is in flight
+    void removeReclaimer(uint64_t id);
+
+    /// Over budget: run the reclaimers (pool order) until usage is back under the low-water mark.
+    /// Returns the bytes released; 0 when within budget or another thread is already reclaiming.
+    size_t reclaimIfNeeded();
+
+    /// {"budgetBytes":..,"usedBytes":..,"cacheBytes":..,"heldBytes":..,"inFlightBytes":..,"reclaimedBytes":..}
+    [[nodiscard]] std::string toJson() const;
+
+private:
+    struct Registration {
+        uint64_t id = 0;
+        MemoryPool pool = MemoryPool::ResultCache;
+        Reclaimer reclaim;
+    };
+
+    [[nodiscard]] static constexpr size_t index(MemoryPool pool) noexcept { return static_cast<size_t>(pool); }
+
+    std::atomic<size_t> m_budget;
+    std::array<std::atomic<size_t>, POOL_COUNT> m_used{};
+    std::atomic<uint64_t> m_reclaimed{0};
+
+    std::mutex m_reclaimMutex;  // held while reclaimers run; guards everything below
+    std::vector<Registration> m_reclaimers;
+    uint64_t m_nextId = 1;
+};
+
+/// Bytes one owner holds in a pool, kept in step with the governor: set() charges or releases the
+/// difference, and destruction releases whatever is left.
+class MemoryCharge {
+public:
+    MemoryCharge(MemoryGovernor& governor, MemoryPool pool) noexcept : m_governor(governor), m_pool(pool) {}
+    ~MemoryCharge() { set(0); }
+
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    void set(size_t bytes) noexcept {
+        const size_t previous = m_bytes.exchange(bytes, std::memory_order_relaxed);
+        if (bytes > previous) {
+            m_governor.charge(m_pool, bytes - previous);
+        } else {
+            m_governor.release(m_pool, previous - bytes);
+        }
+    }
+    [[nodiscard]] size_t bytes() const noexcept { return m_bytes.load(std::memory_order_relaxed); }
+    [[nodiscard]] MemoryGovernor& governor() const noexcept { return m_governor; }
+
+private:
+    MemoryGovernor& m_governor;
+    MemoryPool m_pool;
+    std::atomic<size_t> m_bytes{0};
+};
+
+}  // namespace velocitydb
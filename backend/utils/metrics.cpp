@@ -0,0 +1,167 @@
+#include "metrics.h"
+
+#include "json_utils.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <utility>
+
+namespace velocitydb {
+
+size_t MetricHistogram::bucketOf(uint64_t value) noexcept {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    // Shift that brings the value into [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    const auto shift = static_cast<uint32_t>(std::bit_width(value)) - SUB_BUCKET_BITS - 1;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t MetricHistogram::bucketUpperBound(size_t bucket) noexcept {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    const auto shift = static_cast<uint32_t>((bucket - SUB_BUCKETS) / SUB_BUCKETS);
+    const uint64_t mantissa = SUB_BUCKETS + (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    const uint64_t lower = mantissa << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void MetricHistogram::record(uint64_t value) noexcept {
+    m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t MetricHistogram::percentile(double q) const noexcept {
+    // Concurrent records may make the bucket total differ slightly from m_count; rank against what the walk sees
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = (std::max)(uint64_t{1}, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return (std::min)(bucketUpperBound(i), m_max.load(std::memory_order_relaxed));
+        }
+    }
+    return m_max.load(std::memory_order_relaxed);
+}
+
+HistogramSnapshot MetricHistogram::snapshot() const noexcept {
+    return HistogramSnapshot{.count = m_count.load(std::memory_order_relaxed),
+                             .sum = m_sum.load(std::memory_order_relaxed),
+                             .max = m_max.load(std::memory_order_relaxed),
+                             .p50 = percentile(0.5),
+                             .p90 = percentile(0.9),
+                             .p99 = percentile(0.99),
+                             .p999 = percentile(0.999)};
+}
+
+void MetricHistogram::reset() noexcept {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+MetricsRegistry::MetricsRegistry() : m_start(std::chrono::steady_clock::now()) {}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+namespace {
+
+template <typename Metric>
+Metric& findOrCreate(std::map<std::string, std::unique_ptr<Metric>, std::less<>>& metrics, std::string_view name) {
+    if (auto it = metrics.find(name); it != metrics.end()) {
+        return *it->second;
+    }
+    return *metrics.emplace(std::string(name), std::make_unique<Metric>()).first->second;
+}
+
+void appendName(std::string& json, std::string_view name) {
+    json += '"';
+    JsonUtils::appendEscaped(json, name);
+    json += "\":";
+}
+
+}  // namespace
+
+MetricCounter& MetricsRegistry::counter(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    return findOrCreate(m_counters, name);
+}
+
+MetricGauge& MetricsRegistry::gauge(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    return findOrCreate(m_gauges, name);
+}
+
+MetricHistogram& MetricsRegistry::histogram(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    return findOrCreate(m_histograms, name);
+}
+
+std::string MetricsRegistry::toJson() const {
+    const auto uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    std::string json = std::format(R"({{"uptimeSeconds":{:.3f},"counters":{{)", uptime);
+
+    std::lock_guard lock(m_mutex);
+    bool first = true;
+    for (const auto& [name, counter] : m_counters) {
+        if (!std::exchange(first, false)) {
+            json += ',';
+        }
+        appendName(json, name);
+        json += std::to_string(counter->value());
+    }
+    json += R"(},"gauges":{)";
+    first = true;
+    for (const auto& [name, gauge] : m_gauges) {
+        if (!std::exchange(first, false)) {
+            json += ',';
+        }
+        appendName(json, name);
+        json += std::to_string(gauge->value());
+    }
+    json += R"(},"histograms":{)";
+    first = true;
+    for (const auto& [name, histogram] : m_histograms) {
+        if (!std::exchange(first, false)) {
+            json += ',';
+        }
+        appendName(json, name);
+        const auto s = histogram->snapshot();
+        const double mean = s.count > 0 ? static_cast<double>(s.sum) / static_cast<double>(s.count) : 0.0;
+        json += std::format(R"({{"count":{},"sum":{},"mean":{:.1f},"max":{},"p50":{},"p90":{},"p99":{},"p999":{}}})", s.count, s.sum, mean, s.max, s.p50, s.p90, s.p99, s.p999);
+    }
+    json += "}}";
+    return json;
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard lock(m_mutex);
+    for (auto& [name, counter] : m_counters) {
+        counter->reset();
+    }
+    for (auto& [name, histogram] : m_histograms) {
+        histogram->reset();
+    }
+}
+
+}  // namespace velocitydb
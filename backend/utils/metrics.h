@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Monotonic event/volume count
+class MetricCounter {
+public:
+    void add(uint64_t amount = 1) noexcept { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t value() const noexcept { return m_value.load(std::memory_order_relaxed); }
+    void reset() noexcept { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/// Current level (queue depth, open sessions)
+class MetricGauge {
+public:
+    void set(int64_t value) noexcept { m_value.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) noexcept { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    [[nodiscard]] int64_t value() const noexcept { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+};
+
+/// Distribution of non-negative integer samples in HDR-style log-linear buckets: exact below 16, then 16 buckets
+/// per power of two (at most ~6% relative error) up to the full uint64 range. Recording is three relaxed atomic
+/// adds and, for a new maximum, a CAS; nothing allocates. Percentiles report the bucket's upper bound.
+class MetricHistogram {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    void record(uint64_t value) noexcept;
+
+    /// Value at quantile `q` (0..1), 0 when empty
+    [[nodiscard]] uint64_t percentile(double q) const noexcept;
+    [[nodiscard]] HistogramSnapshot snapshot() const noexcept;
+    [[nodiscard]] uint64_t count() const noexcept { return m_count.load(std::memory_order_relaxed); }
+    void reset() noexcept;
+
+    [[nodiscard]] static size_t bucketOf(uint64_t value) noexcept;
+    /// Largest value that falls into `bucket`
+    [[nodiscard]] static uint64_t bucketUpperBound(size_t bucket) noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+/// Process-wide named metrics, created on first use and never removed, so references stay valid for the
+/// process lifetime. Hot paths look a metric up once and keep the reference (a function-local static).
+/// Names are dotted and carry their unit ("ipc.latency_us.executeQuery", "ssh.bytes_sent").
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    [[nodiscard]] static MetricsRegistry& instance();
+
+    [[nodiscard]] MetricCounter& counter(std::string_view name);
+    [[nodiscard]] MetricGauge& gauge(std::string_view name);
+    [[nodiscard]] MetricHistogram& histogram(std::string_view name);
+
+    /// {"uptimeSeconds":..,"counters":{..},"gauges":{..},"histograms":{name:{count,sum,mean,max,p50,p90,p99,p999}}}.
+    /// Rates come from two reads: (counter delta) / (uptime delta).
+    [[nodiscard]] std::string toJson() const;
+
+    /// Zero counters and histograms (gauges keep tracking their level)
+    void reset();
+
+private:
+    const std::chrono::steady_clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<MetricCounter>, std::less<>> m_counters;
+    std::map<std::string, std::unique_ptr<MetricGauge>, std::less<>> m_gauges;
+    std::map<std::string, std::unique_ptr<MetricHistogram>, std::less<>> m_histograms;
+};
+
+/// Records the lifetime of the scope into a histogram, in microseconds
+class ScopedLatency {
+public:
+    explicit ScopedLatency(MetricHistogram& histogram) noexcept : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() { m_histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count())); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    MetricHistogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+}  // namespace velocitydb
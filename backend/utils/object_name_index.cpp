@@ -0,0 +1,332 @@
+#include "object_name_index.h"
+
+#include <algorithm>
+#include <array>
+
+namespace velocitydb {
+
+namespace {
+
+/// Tombstones tolerated before a compaction is considered at all
+constexpr size_t MIN_COMPACT_DEAD = 1024;
+
+[[nodiscard]] std::string fold(std::string_view text) {
+    std::string folded(text);
+    for (auto& c : folded) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return folded;
+}
+
+/// Distinct byte trigrams of `folded`, ascending
+[[nodiscard]] std::vector<uint32_t> trigramsOf(std::string_view folded) {
+    std::vector<uint32_t> trigrams;
+    if (folded.size() < 3) {
+        return trigrams;
+    }
+    trigrams.reserve(folded.size() - 2);
+    for (size_t i = 0; i + 2 < folded.size(); ++i) {
+        trigrams.push_back((static_cast<uint32_t>(static_cast<unsigned char>(folded[i])) << 16) | (static_cast<uint32_t>(static_cast<unsigned char>(folded[i + 1])) << 8) |
+                           static_cast<uint32_t>(static_cast<unsigned char>(folded[i + 2])));
+    }
+    std::ranges::sort(trigrams);
+    auto [first, last] = std::ranges::unique(trigrams);
+    trigrams.erase(first, last);
+    return trigrams;
+}
+
+}  // namespace
+
+std::string_view ObjectNameIndex::kindName(ObjectKind kind) noexcept {
+    switch (kind) {
+        case ObjectKind::Column:
+            return "COLUMN";
+        case ObjectKind::Function:
+            return "FUNCTION";
+        case ObjectKind::Index:
+            return "INDEX";
+        case ObjectKind::Procedure:
+            return "PROCEDURE";
+        case ObjectKind::Table:
+            return "TABLE";
+        case ObjectKind::View:
+            return "VIEW";
+    }
+    return "TABLE";
+}
+
+void ObjectNameIndex::replace(uint64_t owner, std::vector<ObjectName> names) {
+    remove(owner);
+    for (auto& name : names) {
+        add(owner, std::move(name));
+    }
+}
+
+void ObjectNameIndex::add(uint64_t owner, ObjectName name) {
+    const auto id = static_cast<uint32_t>(m_slots.size());
+    auto folded = fold(name.name);
+    for (const auto trigram : trigramsOf(folded)) {
+        m_trigrams[trigram].push_back(id);
+    }
+    if (!name.parent.empty()) {
+        m_children[fold(name.parent)].push_back(id);
+    }
+    m_slots.push_back(Slot{.name = std::move(name), .folded = std::move(folded), .owner = owner});
+    m_owners[owner].push_back(id);
+    m_pending.push_back(id);
+}
+
+void ObjectNameIndex::remove(uint64_t owner) {
+    auto found = m_owners.find(owner);
+    if (found == m_owners.end()) {
+        return;
+    }
+    for (const auto id : found->second) {
+        m_slots[id].alive = false;
+    }
+    m_dead += found->second.size();
+    m_owners.erase(found);
+    if (m_dead > MIN_COMPACT_DEAD && m_dead > size()) {
+        compact();
+    }
+}
+
+void ObjectNameIndex::clear() {
+    m_slots.clear();
+    m_sorted.clear();
+    m_pending.clear();
+    m_trigrams.clear();
+    m_children.clear();
+    m_owners.clear();
+    m_dead = 0;
+}
+
+void ObjectNameIndex::compact() {
+    auto slots = std::move(m_slots);
+    clear();
+    for (auto& slot : slots) {
+        if (slot.alive) {
+            add(slot.owner, std::move(slot.name));
+        }
+    }
+}
+
+bool ObjectNameIndex::lessSlot(uint32_t a, uint32_t b) const noexcept {
+    const auto& x = m_slots[a];
+    const auto& y = m_slots[b];
+    if (x.name.kind != y.name.kind) {
+        return x.name.kind < y.name.kind;
+    }
+    if (x.folded != y.folded) {
+        return x.folded < y.folded;
+    }
+    return x.name.name < y.name.name;
+}
+
+void ObjectNameIndex::mergePending() const {
+    if (m_pending.empty()) {
+        return;
+    }
+    if (m_dead > 0) {
+        std::erase_if(m_sorted, [&](uint32_t id) { return !m_slots[id].alive; });
+    }
+    const auto less = [this](uint32_t a, uint32_t b) { return lessSlot(a, b); };
+    std::ranges::sort(m_pending, less);
+    const auto middle = static_cast<std::ptrdiff_t>(m_sorted.size());
+    m_sorted.insert(m_sorted.end(), m_pending.begin(), m_pending.end());
+    std::inplace_merge(m_sorted.begin(), m_sorted.begin() + middle, m_sorted.end(), less);
+    m_pending.clear();
+}
+
+bool ObjectNameIndex::wanted(ObjectKind kind, const SearchOptions& options) noexcept {
+    switch (kind) {
+        case ObjectKind::Column:
+            return options.searchColumns;
+        case ObjectKind::Function:
+            return options.searchFunctions;
+        case ObjectKind::Index:
+            return options.searchIndexes;
+        case ObjectKind::Procedure:
+            return options.searchProcedures;
+        case ObjectKind::Table:
+            return options.searchTables;
+        case ObjectKind::View:
+            return options.searchViews;
+    }
+    return false;
+}
+
+SearchResult ObjectNameIndex::toResult(uint32_t slot, size_t position) const {
+    const auto& name = m_slots[slot].name;
+    return SearchResult{.objectType = std::string(kindName(name.kind)), .schemaName = name.schema, .objectName = name.name, .parentName = name.parent, .matchedText = name.name,
+                        .matchPosition = static_cast<int>(position)};
+}
+
+std::vector<SearchResult> ObjectNameIndex::search(std::string_view pattern, const SearchOptions& options) const {
+    std::vector<SearchResult> results;
+    const auto limit = static_cast<size_t>((std::max)(options.maxResults, 0));
+    const auto folded = fold(pattern);
+    if (folded.empty() || limit == 0) {
+        return results;
+    }
+    mergePending();
+
+    const auto position = [&](uint32_t id) {
+        const auto& slot = m_slots[id];
+        return options.caseSensitive ? slot.name.name.find(pattern) : slot.folded.find(folded);
+    };
+    const auto live = [&](uint32_t id) { return m_slots[id].alive && wanted(m_slots[id].name.kind, options); };
+
+    // Without a full trigram, walk the ordered names; the first `limit` hits are the answer
+    const auto trigrams = trigramsOf(folded);
+    if (trigrams.empty()) {
+        for (const auto id : m_sorted) {
+            if (live(id)) {
+                if (auto at = position(id); at != std::string::npos) {
+                    results.push_back(toResult(id, at));
+                    if (results.size() == limit) {
+                        break;
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+    // Substring candidates carry every trigram of the pattern: intersect the posting lists, shortest first
+    std::vector<const std::vector<uint32_t>*> postings;
+    postings.reserve(trigrams.size());
+    for (const auto trigram : trigrams) {
+        if (auto found = m_trigrams.find(trigram); found != m_trigrams.end()) {
+            postings.push_back(&found->second);
+        }
+    }
+    std::vector<uint32_t> matches;
+    if (postings.size() == trigrams.size()) {
+        std::ranges::sort(postings, {}, [](const auto* list) { return list->size(); });
+        matches = *postings.front();
+        for (size_t i = 1; i < postings.size() && !matches.empty(); ++i) {
+            std::erase_if(matches, [&](uint32_t id) { return !std::ranges::binary_search(*postings[i], id); });
+        }
+        std::erase_if(matches, [&](uint32_t id) { return !live(id) || position(id) == std::string::npos; });
+        std::ranges::sort(matches, [this](uint32_t a, uint32_t b) { return lessSlot(a, b); });
+        if (matches.size() > limit) {
+            matches.resize(limit);
+        }
+    }
+    results.reserve(matches.size());
+    for (const auto id : matches) {
+        results.push_back(toResult(id, position(id)));
+    }
+
+    if (options.fuzzy && results.size() < limit) {
+        // Similarity = share of the pattern's trigrams the name contains
+        std::unordered_map<uint32_t, uint32_t> shared;
+        for (const auto* list : postings) {
+            for (const auto id : *list) {
+                ++shared[id];
+            }
+        }
+        std::ranges::sort(matches);
+        std::vector<std::pair<double, uint32_t>> similar;
+        for (const auto& [id, count] : shared) {
+            const double similarity = static_cast<double>(count) / static_cast<double>(trigrams.size());
+            if (similarity >= FUZZY_MIN_SIMILARITY && live(id) && !std::ranges::binary_search(matches, id)) {
+                similar.emplace_back(similarity, id);
+            }
+        }
+        std::ranges::sort(similar, [this](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : lessSlot(a.second, b.second); });
+        for (const auto& [similarity, id] : similar) {
+            if (results.size() == limit) {
+                break;
+            }
+            results.push_back(toResult(id, 0));
+        }
+    }
+    return results;
+}
+
+std::vector<const ObjectName*> ObjectNameIndex::withPrefix(ObjectKind kind, std::string_view prefix, size_t limit, bool distinct) const {
+    std::vector<const ObjectName*> names;
+    const auto folded = fold(prefix);
+    mergePending();
+    auto it = std::ranges::lower_bound(m_sorted, std::pair{kind, std::string_view(folded)}, {}, [this](uint32_t id) {
+        const auto& slot = m_slots[id];
+        return std::pair{slot.name.kind, std::string_view(slot.folded)};
+    });
+    const std::string* previous = nullptr;
+    for (; it != m_sorted.end() && names.size() < limit; ++it) {
+        const auto& slot = m_slots[*it];
+        if (slot.name.kind != kind || !slot.folded.starts_with(folded)) {
+            break;
+        }
+        if (!slot.alive || (distinct && previous != nullptr && *previous == slot.folded)) {
+            continue;
+        }
+        previous = &slot.folded;
+        names.push_back(&slot.name);
+    }
+    return names;
+}
+
+std::vector<const ObjectName*> ObjectNameIndex::childrenOf(std::string_view schema, std::string_view parent, ObjectKind kind) const {
+    std::vector<const ObjectName*> names;
+    auto found = m_children.find(fold(parent));
+    if (found == m_children.end()) {
+        return names;
+    }
+    const auto foldedSchema = fold(schema);
+    for (const auto id : found->second) {
+        const auto& slot = m_slots[id];
+        if (slot.alive && slot.name.kind == kind && (foldedSchema.empty() || fold(slot.name.schema) == foldedSchema)) {
+            names.push_back(&slot.name);
+        }
+    }
+    return names;
+}
+
+std::vector<std::string> ObjectNameIndex::complete(std::string_view prefix, size_t limit) const {
+    std::vector<std::string> names;
+    const auto folded = fold(prefix);
+    if (folded.empty() || limit == 0) {
+        return names;
+    }
+    mergePending();
+
+    // Up to `limit` distinct names per kind, then merged like the former UNION ... ORDER BY name
+    std::vector<uint32_t> hits;
+    for (const auto kind : std::array{ObjectKind::Column, ObjectKind::Table, ObjectKind::View}) {
+        auto it = std::ranges::lower_bound(m_sorted, std::pair{kind, std::string_view(folded)}, {}, [this](uint32_t id) {
+            const auto& slot = m_slots[id];
+            return std::pair{slot.name.kind, std::string_view(slot.folded)};
+        });
+        size_t taken = 0;
+        const std::string* previous = nullptr;
+        for (; it != m_sorted.end() && taken < limit; ++it) {
+            const auto& slot = m_slots[*it];
+            if (slot.name.kind != kind || !slot.folded.starts_with(folded)) {
+                break;
+            }
+            if (!slot.alive || (previous != nullptr && *previous == slot.folded)) {
+                continue;
+            }
+            previous = &slot.folded;
+            hits.push_back(*it);
+            ++taken;
+        }
+    }
+    std::ranges::sort(hits, [this](uint32_t a, uint32_t b) { return m_slots[a].folded < m_slots[b].folded; });
+    for (const auto id : hits) {
+        if (names.size() == limit) {
+            break;
+        }
+        if (names.empty() || fold(names.back()) != m_slots[id].folded) {
+            names.push_back(m_slots[id].name.name);
+        }
+    }
+    return names;
+}
+
+}  // namespace velocitydb
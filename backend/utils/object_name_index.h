@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+struct SearchResult {
+    std::string objectType;  // table, view, procedure, function, column, etc.
+    std::string schemaName;
+    std::string objectName;
+    std::string parentName;  // For columns, this is the table name
+    std::string matchedText;
+    int matchPosition = 0;
+};
+
+struct SearchOptions {
+    bool searchTables = true;
+    bool searchViews = true;
+    bool searchProcedures = true;
+    bool searchFunctions = true;
+    bool searchColumns = true;
+    bool searchIndexes = false;
+    bool caseSensitive = false;
+    bool fuzzy = false;  ///< Append names sharing most of the pattern's trigrams after the substring matches
+    int maxResults = 100;
+};
+
+enum class ObjectKind : uint8_t { Column, Function, Index, Procedure, Table, View };  // Alphabetical, like the old ORDER BY object_type
+
+struct ObjectName {
+    ObjectKind kind = ObjectKind::Table;
+    std::string schema;
+    std::string name;
+    std::string parent;  ///< Table of a column or index
+};
+
+/// Local name index over schema objects for search-as-you-type without a server round trip.
+///
+/// Names are ASCII case-folded once. A (kind, folded name) ordered array answers prefix lookups by binary search;
+/// a trigram index narrows substring and fuzzy lookups to the names sharing the pattern's trigrams. Names are
+/// grouped by owner (e.g. a table's columns) and replaced or removed per owner, so schema changes update the
+/// index incrementally: removals leave tombstones that are compacted once they outnumber live names, and
+/// additions are merged into the ordered array on the next lookup. Not thread-safe; callers serialize access.
+class ObjectNameIndex {
+public:
+    static constexpr double FUZZY_MIN_SIMILARITY = 0.5;
+
+    ObjectNameIndex() = default;
+    ~ObjectNameIndex() = default;
+
+    ObjectNameIndex(const ObjectNameIndex&) = delete;
+    ObjectNameIndex& operator=(const ObjectNameIndex&) = delete;
+    ObjectNameIndex(ObjectNameIndex&&) = default;
+    ObjectNameIndex& operator=(ObjectNameIndex&&) = default;
+
+    /// Replace every name `owner` contributed
+    void replace(uint64_t owner, std::vector<ObjectName> names);
+    void remove(uint64_t owner);
+    void clear();
+
+    /// Names containing `pattern`, ordered by kind then name, at most options.maxResults
+    [[nodiscard]] std::vector<SearchResult> search(std::string_view pattern, const SearchOptions& options = {}) const;
+    /// Distinct table, view and column names starting with `prefix`, sorted case-insensitively
+    [[nodiscard]] std::vector<std::string> complete(std::string_view prefix, size_t limit = 20) const;
+    /// Names of `kind` starting with `prefix` (any name when empty), in name order, at most `limit`; with `distinct`,
+    /// only the first of the names equal ignoring case (e.g. the same column of many tables)
+    [[nodiscard]] std::vector<const ObjectName*> withPrefix(ObjectKind kind, std::string_view prefix, size_t limit, bool distinct = false) const;
+    /// Names of `kind` whose parent is `parent` in `schema` (any schema when empty), both matched case-insensitively
+    [[nodiscard]] std::vector<const ObjectName*> childrenOf(std::string_view schema, std::string_view parent, ObjectKind kind) const;
+
+    [[nodiscard]] size_t size() const noexcept { return m_slots.size() - m_dead; }
+
+    [[nodiscard]] static std::string_view kindName(ObjectKind kind) noexcept;
+
+private:
+    struct Slot {
+        ObjectName name;
+        std::string folded;
+        uint64_t owner = 0;
+        bool alive = true;
+    };
+
+    void add(uint64_t owner, ObjectName name);
+    void compact();
+    /// Merge names added since the last lookup into m_sorted
+    void mergePending() const;
+    [[nodiscard]] bool lessSlot(uint32_t a, uint32_t b) const noexcept;
+    [[nodiscard]] static bool wanted(ObjectKind kind, const SearchOptions& options) noexcept;
+    [[nodiscard]] SearchResult toResult(uint32_t slot, size_t position) const;
+
+    std::vector<Slot> m_slots;
+    mutable std::vector<uint32_t> m_sorted;   ///< Live and dead slots by (kind, folded); dead ones are skipped
+    mutable std::vector<uint32_t> m_pending;  ///< Added, not merged yet
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigrams;  ///< Ascending slot ids
+    std::unordered_map<std::string, std::vector<uint32_t>> m_children;  ///< Folded parent name -> its columns and indexes
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_owners;
+    size_t m_dead = 0;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,108 @@
+#include "ordered_render.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <thread>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr size_t WAVE_ITEMS = 2048;
+constexpr size_t PARALLEL_MIN_ITEMS = 128;
+constexpr size_t MIN_ITEMS_PER_SLICE = 32;
+
+}  // namespace
+
+void renderOrdered(size_t count, const std::function<void(size_t index, std::string& out)>& render, const TextSink& sink) {
+    const size_t hardware = (std::max)(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> buffers;
+    for (size_t waveBegin = 0; waveBegin < count; waveBegin += WAVE_ITEMS) {
+        const size_t waveSize = (std::min)(WAVE_ITEMS, count - waveBegin);
+        const size_t slices = waveSize >= PARALLEL_MIN_ITEMS ? (std::min)(hardware, waveSize / MIN_ITEMS_PER_SLICE) : 1;
+        buffers.resize(slices);
+
+        std::vector<std::exception_ptr> errors(slices);
+        auto runSlice = [&](size_t slice) {
+            try {
+                auto& out = buffers[slice];
+                out.clear();
+                const size_t end = waveBegin + waveSize * (slice + 1) / slices;
+                for (size_t i = waveBegin + waveSize * slice / slices; i < end; ++i) {
+                    render(i, out);
+                }
+            } catch (...) {
+                errors[slice] = std::current_exception();
+            }
+        };
+        if (slices == 1) {
+            runSlice(0);
+        } else {
+            std::vector<std::thread> workers;
+            workers.reserve(slices - 1);
+            for (size_t slice = 1; slice < slices; ++slice) {
+                workers.emplace_back(runSlice, slice);
+            }
+            runSlice(0);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        for (const auto& error : errors) {
+            if (error) [[unlikely]] {
+                std::rethrow_exception(error);
+            }
+        }
+        for (size_t slice = 0; slice < slices; ++slice) {
+            sink(buffers[slice]);
+        }
+    }
+}
+
+std::vector<size_t> dependencyOrder(size_t count, std::span<const std::pair<size_t, size_t>> references) {
+    // Referenced items of each item, grouped by item
+    std::vector<size_t> firstEdge(count + 1, 0);
+    for (const auto& [item, referenced] : references) {
+        ++firstEdge[item + 1];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        firstEdge[i + 1] += firstEdge[i];
+    }
+    std::vector<size_t> edges(references.size());
+    std::vector<size_t> filled(firstEdge.begin(), firstEdge.end() - 1);
+    for (const auto& [item, referenced] : references) {
+        edges[filled[item]++] = referenced;
+    }
+
+    // Depth-first, emitting an item once everything it references is out; an item still on the path is a cycle
+    enum class State : uint8_t { Unvisited, OnPath, Done };
+    std::vector<State> states(count, State::Unvisited);
+    std::vector<size_t> order;
+    order.reserve(count);
+    std::vector<std::pair<size_t, size_t>> path;  // (item, next edge)
+    for (size_t root = 0; root < count; ++root) {
+        if (states[root] != State::Unvisited) {
+            continue;
+        }
+        states[root] = State::OnPath;
+        path.emplace_back(root, firstEdge[root]);
+        while (!path.empty()) {
+            auto& [item, next] = path.back();
+            if (next == firstEdge[item + 1]) {
+                states[item] = State::Done;
+                order.push_back(item);
+                path.pop_back();
+                continue;
+            }
+            const size_t referenced = edges[next++];
+            if (states[referenced] == State::Unvisited) {
+                states[referenced] = State::OnPath;
+                path.emplace_back(referenced, firstEdge[referenced]);
+            }
+        }
+    }
+    return order;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace velocitydb {
+
+using TextSink = std::function<void(std::string_view)>;
+
+/// Text of items [0, count) rendered by `render(index, out)` and handed to `sink` in index order.
+///
+/// Items go in waves of WAVE_ITEMS; a large wave is split into slices rendered on their own threads, each into its
+/// own buffer, and the buffers reach `sink` one after another once the wave is done. Only one wave of text is held at
+/// a time, so a script for thousands of tables streams to a file in bounded memory. `render` must only append to
+/// `out` and read shared state.
+/// @throws whatever `render` or `sink` throws; the first failing slice wins and nothing of its wave reaches `sink`
+void renderOrdered(size_t count, const std::function<void(size_t index, std::string& out)>& render, const TextSink& sink);
+
+/// Items [0, count) ordered so each comes after the items it references: `references` holds (item, referenced item)
+/// pairs. Otherwise the original order is kept; items in a reference cycle, or referencing themselves, keep the
+/// order they are first reached in.
+[[nodiscard]] std::vector<size_t> dependencyOrder(size_t count, std::span<const std::pair<size_t, size_t>> references);
+
+}  // namespace velocitydb
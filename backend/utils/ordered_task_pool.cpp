@@ -0,0 +1,115 @@
+#include "ordered_task_pool.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <exception>
+#include <format>
+
+namespace velocitydb {
+
+OrderedTaskPool::OrderedTaskPool(size_t threads) {
+    threads = (std::max)(threads, size_t{1});
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers.emplace_back([this] { run(); });
+    }
+}
+
+OrderedTaskPool::~OrderedTaskPool() {
+    shutdown();
+}
+
+void OrderedTaskPool::post(Task task) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_stopping) [[unlikely]] {
+            return;
+        }
+        m_ready.push_back(Job{.key = std::nullopt, .task = std::move(task)});
+    }
+    m_wake.notify_one();
+}
+
+void OrderedTaskPool::post(std::string key, Task task) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_stopping) [[unlikely]] {
+            return;
+        }
+        if (auto it = m_waiting.find(key); it != m_waiting.end()) {
+            // An earlier task with this key is queued or running: released when it finishes
+            it->second.push_back(std::move(task));
+            ++m_waitingCount;
+            return;
+        }
+        m_waiting.try_emplace(key);
+        m_ready.push_back(Job{.key = std::move(key), .task = std::move(task)});
+    }
+    m_wake.notify_one();
+}
+
+void OrderedTaskPool::shutdown() {
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_stopping) {
+            return;
+        }
+        m_stopping = true;
+        m_ready.clear();
+        m_waiting.clear();
+        m_waitingCount = 0;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t OrderedTaskPool::pending() const {
+    std::lock_guard lock(m_mutex);
+    return m_ready.size() + m_waitingCount;
+}
+
+void OrderedTaskPool::run() {
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_ready.empty(); });
+        if (m_stopping) {
+            return;
+        }
+        auto job = std::move(m_ready.front());
+        m_ready.pop_front();
+
+        lock.unlock();
+        try {
+            job.task();
+        } catch (const std::exception& e) {
+            // The key must still be handed on, or every later task under it would wait forever
+            log<LogLevel::WARNING>(std::format("Task failed on worker pool: {}", e.what()));
+        }
+        job.task = nullptr;  // Release captures outside the lock
+        lock.lock();
+
+        if (!job.key || m_stopping) {
+            continue;
+        }
+        // Hand the key to the next task waiting behind it, or retire it
+        auto it = m_waiting.find(*job.key);
+        if (it == m_waiting.end()) {
+            continue;
+        }
+        if (it->second.empty()) {
+            m_waiting.erase(it);
+            continue;
+        }
+        m_ready.push_back(Job{.key = std::move(job.key), .task = std::move(it->second.front())});
+        it->second.pop_front();
+        --m_waitingCount;
+        m_wake.notify_one();
+    }
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace velocitydb {
+
+/// Fixed pool of worker threads whose tasks may carry an ordering key.
+///
+/// Tasks with the same key run one at a time in submission order; tasks with different keys, and unkeyed
+/// tasks, run in parallel on whichever worker is free. A key only occupies a worker while one of its tasks
+/// runs, so a backlog under one key (a slow connection) never holds back the others.
+class OrderedTaskPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit OrderedTaskPool(size_t threads);
+    /// Same as shutdown()
+    ~OrderedTaskPool();
+
+    OrderedTaskPool(const OrderedTaskPool&) = delete;
+    OrderedTaskPool& operator=(const OrderedTaskPool&) = delete;
+    OrderedTaskPool(OrderedTaskPool&&) = delete;
+    OrderedTaskPool& operator=(OrderedTaskPool&&) = delete;
+
+    /// Run `task` as soon as a worker is free
+    void post(Task task);
+    /// Run `task` after every task posted earlier with the same key has finished
+    void post(std::string key, Task task);
+
+    /// Drop tasks that have not started, wait for running ones and stop the workers. Later posts are ignored.
+    void shutdown();
+
+    /// Tasks posted but not yet started
+    [[nodiscard]] size_t pending() const;
+
+private:
+    struct Job {
+        std::optional<std::string> key;
+        Task task;
+    };
+
+    void run();
+
+    mutable std::mutex m_mutex;  // guards everything below
+    std::condition_variable m_wake;
+    std::deque<Job> m_ready;
+    /// Keys with a task queued in m_ready or running, mapped to the tasks waiting behind it
+    std::unordered_map<std::string, std::deque<Task>> m_waiting;
+    size_t m_waitingCount = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace velocitydb::parallel_slices {
+
+/// Slices smaller than this are not worth a thread
+inline constexpr size_t MIN_ROWS_PER_SLICE = 16384;
+
+[[nodiscard]] inline size_t hardwareThreads() noexcept {
+    return (std::max)(std::thread::hardware_concurrency(), 1u);
+}
+
+/// Partition of a key hash, taken from its high bits so each table still sees well-spread low bits
+[[nodiscard]] inline size_t partitionOf(size_t hash, size_t partitions) noexcept {
+    return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 60) % partitions;
+}
+
+/// Number of slices to split `rows` into: one below `parallelMinRows`, else up to one per core
+[[nodiscard]] inline size_t sliceCount(size_t rows, size_t parallelMinRows) noexcept {
+    return rows >= parallelMinRows ? (std::max)(size_t{1}, (std::min)(hardwareThreads(), rows / MIN_ROWS_PER_SLICE)) : 1;
+}
+
+/// Run `work(slice)` for every slice, the first on the calling thread; rethrows the first failure
+template <typename Work>
+void runSlices(size_t slices, Work&& work) {
+    std::vector<std::exception_ptr> errors(slices);
+    auto run = [&](size_t slice) {
+        try {
+            work(slice);
+        } catch (...) {
+            errors[slice] = std::current_exception();
+        }
+    };
+    if (slices == 1) {
+        run(0);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(slices - 1);
+        for (size_t slice = 1; slice < slices; ++slice) {
+            workers.emplace_back(run, slice);
+        }
+        run(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace velocitydb::parallel_slices
@@ -0,0 +1,172 @@
+#include "query_trace.h"
+
+#include "json_utils.h"
+
+#include <algorithm>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+thread_local uint64_t t_traceId = 0;
+thread_local uint32_t t_depth = 0;
+
+[[nodiscard]] uint32_t currentThreadNumber() noexcept {
+    static std::atomic<uint32_t> nextThread{1};
+    thread_local const uint32_t number = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+}  // namespace
+
+QueryTracer::QueryTracer(size_t capacity) : m_epoch(std::chrono::steady_clock::now()), m_ring((std::max)(capacity, size_t{1})) {}
+
+QueryTracer& QueryTracer::instance() {
+    static QueryTracer tracer;
+    return tracer;
+}
+
+void QueryTracer::record(std::string_view name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration duration, std::string detail) {
+    if (!enabled()) {
+        return;
+    }
+    push(name, start, duration, std::move(detail), t_depth);
+}
+
+void QueryTracer::push(std::string_view name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration duration, std::string detail, uint32_t depth) {
+    TraceSpan span{.traceId = t_traceId,
+                   .name = name,
+                   .detail = std::move(detail),
+                   .threadId = currentThreadNumber(),
+                   .depth = depth,
+                   .startUs = toMicros(start),
+                   .durationUs = std::chrono::duration_cast<std::chrono::microseconds>(duration).count()};
+
+    std::lock_guard lock(m_mutex);
+    m_ring[m_next] = std::move(span);
+    if (++m_next == m_ring.size()) {
+        m_next = 0;
+        m_wrapped = true;
+    }
+}
+
+std::vector<TraceSpan> QueryTracer::spans(uint64_t traceId) const {
+    std::lock_guard lock(m_mutex);
+    std::vector<TraceSpan> out;
+    const size_t count = m_wrapped ? m_ring.size() : m_next;
+    const size_t first = m_wrapped ? m_next : 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& span = m_ring[(first + i) % m_ring.size()];
+        if (traceId == 0 || span.traceId == traceId) {
+            out.push_back(span);
+        }
+    }
+    // Spans land when they close, so a parent follows its children; present them by start time
+    std::ranges::stable_sort(out, {}, &TraceSpan::startUs);
+    return out;
+}
+
+uint64_t QueryTracer::latestTraceWith(std::string_view name) const {
+    std::lock_guard lock(m_mutex);
+    const size_t count = m_wrapped ? m_ring.size() : m_next;
+    for (size_t i = 1; i <= count; ++i) {
+        const auto& span = m_ring[(m_next + m_ring.size() - i) % m_ring.size()];
+        if (span.traceId != 0 && span.name == name) {
+            return span.traceId;
+        }
+    }
+    return 0;
+}
+
+void QueryTracer::clear() {
+    std::lock_guard lock(m_mutex);
+    std::ranges::fill(m_ring, TraceSpan{});
+    m_next = 0;
+    m_wrapped = false;
+}
+
+int64_t QueryTracer::toMicros(std::chrono::steady_clock::time_point time) const noexcept {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - m_epoch).count();
+}
+
+std::string QueryTracer::toJson(uint64_t traceId, std::span<const TraceSpan> spans) {
+    std::string json = std::format(R"({{"traceId":{},"spans":[)", traceId);
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const auto& span = spans[i];
+        if (i > 0) {
+            json += ',';
+        }
+        json += R"({"name":")";
+        JsonUtils::appendEscaped(json, span.name);
+        json += R"(","detail":")";
+        JsonUtils::appendEscaped(json, span.detail);
+        json += std::format(R"(","traceId":{},"thread":{},"depth":{},"startUs":{},"durationUs":{}}})", span.traceId, span.threadId, span.depth, span.startUs, span.durationUs);
+    }
+    json += "]}";
+    return json;
+}
+
+std::string QueryTracer::toChromeTraceJson(std::span<const TraceSpan> spans) {
+    std::string json = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const auto& span = spans[i];
+        if (i > 0) {
+            json += ',';
+        }
+        json += R"({"name":")";
+        JsonUtils::appendEscaped(json, span.name);
+        json += std::format(R"(","cat":"velocitydb","ph":"X","pid":1,"tid":{},"ts":{},"dur":{},"args":{{"traceId":{},"detail":")", span.threadId, span.startUs, span.durationUs, span.traceId);
+        JsonUtils::appendEscaped(json, span.detail);
+        json += "\"}}";
+    }
+    json += "]}";
+    return json;
+}
+
+uint64_t QueryTracer::currentTraceId() noexcept {
+    return t_traceId;
+}
+
+TraceContext::TraceContext(QueryTracer& tracer) : m_previous(t_traceId) {
+    if (t_traceId == 0) {
+        t_traceId = tracer.nextTraceId();
+    }
+}
+
+TraceContext::TraceContext(uint64_t traceId) : m_previous(t_traceId) {
+    if (traceId != 0) {
+        t_traceId = traceId;
+    }
+}
+
+TraceContext::~TraceContext() {
+    t_traceId = m_previous;
+}
+
+uint64_t TraceContext::id() const noexcept {
+    return t_traceId;
+}
+
+TraceScope::TraceScope(std::string_view name, QueryTracer& tracer) noexcept : m_tracer(tracer.enabled() ? &tracer : nullptr), m_name(name) {
+    if (m_tracer != nullptr) {
+        m_depth = t_depth++;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+void TraceScope::end() noexcept {
+    if (m_tracer == nullptr) {
+        return;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - m_start;
+    --t_depth;
+    try {
+        m_tracer->push(m_name, m_start, elapsed, std::move(m_detail), m_depth);
+    } catch (...) {
+        // Tracing never fails the traced work
+    }
+    m_tracer = nullptr;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// One finished, timed phase of a request
+struct TraceSpan {
+    uint64_t traceId = 0;   ///< Request the span belongs to (0 = outside any traced request)
+    std::string_view name;  ///< Phase name; must be a string literal
+    std::string detail;     ///< Optional free text (IPC method, row count, cache outcome)
+    uint32_t threadId = 0;  ///< Small per-process thread number
+    uint32_t depth = 0;     ///< Spans open on the same thread when this one started
+    int64_t startUs = 0;    ///< Microseconds since the tracer was created
+    int64_t durationUs = 0;
+};
+
+/// Process-wide ring of the most recent spans.
+///
+/// A request is traced by opening a TraceContext on the thread that serves it (IPCHandler::dispatchRequest does);
+/// TraceScope objects created below it record their phase into the ring when they close. Work handed to another
+/// thread joins the same trace with TraceContext(traceId). Recording takes one short lock per span, so spans
+/// belong around phases (execute, fetch, serialize), not around rows.
+class QueryTracer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit QueryTracer(size_t capacity = DEFAULT_CAPACITY);
+
+    QueryTracer(const QueryTracer&) = delete;
+    QueryTracer& operator=(const QueryTracer&) = delete;
+
+    [[nodiscard]] static QueryTracer& instance();
+
+    void setEnabled(bool enabled) noexcept { m_enabled.store(enabled, std::memory_order_relaxed); }
+    [[nodiscard]] bool enabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+
+    /// Record a span on the calling thread's current trace, nested under its open scopes.
+    /// Also used for phases measured as a sum of slices (e.g. text conversion across rowsets).
+    void record(std::string_view name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration duration, std::string detail = {});
+
+    /// Spans of `traceId` oldest first; every span in the ring when `traceId` is 0
+    [[nodiscard]] std::vector<TraceSpan> spans(uint64_t traceId = 0) const;
+
+    /// Most recent trace containing a span named `name`, 0 when none is left in the ring
+    [[nodiscard]] uint64_t latestTraceWith(std::string_view name) const;
+
+    void clear();
+
+    [[nodiscard]] int64_t toMicros(std::chrono::steady_clock::time_point time) const noexcept;
+
+    /// {"traceId":..,"spans":[{...}]}
+    [[nodiscard]] static std::string toJson(uint64_t traceId, std::span<const TraceSpan> spans);
+    /// Chrome trace event format (chrome://tracing, Perfetto): complete ("X") events in microseconds
+    [[nodiscard]] static std::string toChromeTraceJson(std::span<const TraceSpan> spans);
+
+    /// Trace of the calling thread (0 outside any TraceContext)
+    [[nodiscard]] static uint64_t currentTraceId() noexcept;
+
+private:
+    friend class TraceContext;
+    friend class TraceScope;
+
+    [[nodiscard]] uint64_t nextTraceId() noexcept { return m_nextTraceId.fetch_add(1, std::memory_order_relaxed); }
+    void push(std::string_view name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration duration, std::string detail, uint32_t depth);
+
+    const std::chrono::steady_clock::time_point m_epoch;
+    std::atomic<bool> m_enabled{true};
+    std::atomic<uint64_t> m_nextTraceId{1};
+
+    mutable std::mutex m_mutex;
+    std::vector<TraceSpan> m_ring;  ///< Guarded by m_mutex
+    size_t m_next = 0;              ///< Slot the next span goes to
+    bool m_wrapped = false;
+};
+
+/// Make the calling thread's spans part of a trace until destruction. Opening one inside another keeps the outer trace.
+class TraceContext {
+public:
+    /// Start a new trace
+    explicit TraceContext(QueryTracer& tracer = QueryTracer::instance());
+    /// Continue `traceId` (e.g. on a worker thread); a no-op for 0
+    explicit TraceContext(uint64_t traceId);
+    ~TraceContext();
+
+    TraceContext(const TraceContext&) = delete;
+    TraceContext& operator=(const TraceContext&) = delete;
+
+    [[nodiscard]] uint64_t id() const noexcept;
+
+private:
+    uint64_t m_previous;
+};
+
+/// Times the enclosing scope (or until end()) as one span
+class TraceScope {
+public:
+    explicit TraceScope(std::string_view name, QueryTracer& tracer = QueryTracer::instance()) noexcept;
+    ~TraceScope() { end(); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void setDetail(std::string detail) { m_detail = std::move(detail); }
+
+    /// Close the span early; later calls do nothing
+    void end() noexcept;
+
+private:
+    QueryTracer* m_tracer;  ///< nullptr when tracing was disabled at construction or after end()
+    std::string_view m_name;
+    std::string m_detail;
+    std::chrono::steady_clock::time_point m_start;
+    uint32_t m_depth = 0;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,500 @@
+#include "result_aggregator.h"
+
+#include "parallel_slices.h"
+#include "string_hash.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <format>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+
+namespace velocitydb {
+
+namespace {
+
+using Extremum = std::variant<std::monostate, int64_t, double, DateTimeValue, std::string>;
+
+struct Accumulator {
+    int64_t count = 0;
+    int64_t intSum = 0;
+    double doubleSum = 0.0;
+    bool overflow = false;  ///< intSum stopped being exact; doubleSum carries the sum
+    Extremum extremum;
+    std::unique_ptr<std::unordered_set<uint64_t>> distinctNumbers;
+    std::unique_ptr<std::unordered_set<std::string, StringHash, std::equal_to<>>> distinctText;
+};
+
+/// Groups of one slice (or of the whole aggregation), in first-appearance order
+struct Groups {
+    std::unordered_map<std::string, size_t, StringHash, std::equal_to<>> index;
+    std::vector<size_t> firstRow;  ///< Batch row each group was first seen at (slices only)
+    std::vector<const std::string*> keys;
+    std::vector<Accumulator> accumulators;  ///< group * aggregate count + aggregate
+};
+
+[[nodiscard]] bool addOverflows(int64_t a, int64_t b) noexcept {
+    return b > 0 ? a > (std::numeric_limits<int64_t>::max)() - b : a < (std::numeric_limits<int64_t>::min)() - b;
+}
+
+[[nodiscard]] auto dateTimeTuple(const DateTimeValue& v) noexcept {
+    return std::tuple(v.year, v.month, v.day, v.hour, v.minute, v.second, v.fraction);
+}
+
+/// Negative when `a` orders before `b`; values of different kinds order by kind
+[[nodiscard]] int compareExtrema(const Extremum& a, const Extremum& b) {
+    if (a.index() != b.index()) {
+        return a.index() < b.index() ? -1 : 1;
+    }
+    return std::visit(
+        [&](const auto& left) -> int {
+            using T = std::decay_t<decltype(left)>;
+            const auto& right = std::get<T>(b);
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                return 0;
+            } else if constexpr (std::is_same_v<T, DateTimeValue>) {
+                const auto l = dateTimeTuple(left);
+                const auto r = dateTimeTuple(right);
+                return l < r ? -1 : (r < l ? 1 : 0);
+            } else {
+                return left < right ? -1 : (right < left ? 1 : 0);
+            }
+        },
+        a);
+}
+
+[[nodiscard]] Extremum cellValue(const ColumnData& column, size_t row) {
+    switch (column.type()) {
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            return column.int64At(row);
+        case ColumnDataType::Double:
+            return column.doubleAt(row);
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            return column.dateTimeAt(row);
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary:
+            break;
+    }
+    return std::string(column.textAt(row));
+}
+
+/// Append the group key of `row` to `key`: per column a NULL marker, then a fixed-width or length-prefixed value
+void appendGroupKey(std::string& key, const ResultSet& batch, std::span<const size_t> groupBy, size_t row) {
+    for (size_t columnIndex : groupBy) {
+        const auto& column = batch.columnData[columnIndex];
+        if (column.isNull(row)) {
+            key.push_back('\0');
+            continue;
+        }
+        key.push_back('\1');
+        auto appendBytes = [&](const auto& value) { key.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        switch (column.type()) {
+            case ColumnDataType::Int64:
+            case ColumnDataType::Bit:
+                appendBytes(column.int64At(row));
+                break;
+            case ColumnDataType::Double:
+                appendBytes(column.doubleAt(row) == 0.0 ? 0.0 : column.doubleAt(row));  // -0.0 groups with 0.0
+                break;
+            case ColumnDataType::Date:
+            case ColumnDataType::Time:
+            case ColumnDataType::Timestamp: {
+                const auto& value = column.dateTimeAt(row);
+                appendBytes(value.year);
+                key.push_back(static_cast<char>(value.month));
+                key.push_back(static_cast<char>(value.day));
+                key.push_back(static_cast<char>(value.hour));
+                key.push_back(static_cast<char>(value.minute));
+                key.push_back(static_cast<char>(value.second));
+                appendBytes(value.fraction);
+                break;
+            }
+            case ColumnDataType::Text:
+            case ColumnDataType::Binary: {
+                const auto text = column.textAt(row);
+                appendBytes(static_cast<uint64_t>(text.size()));
+                key.append(text);
+                break;
+            }
+        }
+    }
+}
+
+[[nodiscard]] double numericValue(const ColumnData& column, size_t row, const ColumnInfo& info) {
+    if (column.isNumeric()) {
+        return column.numericAt(row);
+    }
+    const auto text = column.textAt(row);
+    double value = 0.0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        throw std::invalid_argument(std::format("Column '{}' holds non-numeric value '{}'", info.name, text));
+    }
+    return value;
+}
+
+void accumulate(Accumulator& acc, const AggregateSpec& spec, const ResultSet& batch, size_t row, const std::vector<ColumnInfo>& columns) {
+    if (spec.column == AggregateSpec::ALL_ROWS) {
+        ++acc.count;
+        return;
+    }
+    const auto& column = batch.columnData[spec.column];
+    if (column.isNull(row)) {
+        return;
+    }
+    ++acc.count;
+    switch (spec.function) {
+        case AggregateFunction::Count:
+            break;
+        case AggregateFunction::Sum:
+        case AggregateFunction::Avg:
+            if (column.type() == ColumnDataType::Int64 || column.type() == ColumnDataType::Bit) {
+                const int64_t value = column.int64At(row);
+                acc.doubleSum += static_cast<double>(value);
+                if (!acc.overflow && addOverflows(acc.intSum, value)) {
+                    acc.overflow = true;
+                }
+                acc.intSum += acc.overflow ? 0 : value;
+            } else {
+                acc.doubleSum += numericValue(column, row, columns[spec.column]);
+                acc.overflow = true;
+            }
+            break;
+        case AggregateFunction::Min:
+        case AggregateFunction::Max: {
+            auto value = cellValue(column, row);
+            const int order = compareExtrema(value, acc.extremum);
+            if (std::holds_alternative<std::monostate>(acc.extremum) || (spec.function == AggregateFunction::Min ? order < 0 : order > 0)) {
+                acc.extremum = std::move(value);
+            }
+            break;
+        }
+        case AggregateFunction::CountDistinct:
+            if (column.type() == ColumnDataType::Text) {
+                if (!acc.distinctText) {
+                    acc.distinctText = std::make_unique<std::unordered_set<std::string, StringHash, std::equal_to<>>>();
+                }
+                if (const auto text = column.textAt(row); !acc.distinctText->contains(text)) {
+                    acc.distinctText->emplace(text);
+                }
+            } else if (column.isNumeric()) {
+                if (!acc.distinctNumbers) {
+                    acc.distinctNumbers = std::make_unique<std::unordered_set<uint64_t>>();
+                }
+                if (column.type() == ColumnDataType::Double) {
+                    const double value = column.doubleAt(row);
+                    acc.distinctNumbers->insert(std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value));
+                } else {
+                    acc.distinctNumbers->insert(static_cast<uint64_t>(column.int64At(row)));
+                }
+            } else {
+                if (!acc.distinctText) {
+                    acc.distinctText = std::make_unique<std::unordered_set<std::string, StringHash, std::equal_to<>>>();
+                }
+                acc.distinctText->insert(column.displayText(row));
+            }
+            break;
+    }
+}
+
+void merge(Accumulator& into, Accumulator&& from, AggregateFunction function) {
+    into.count += from.count;
+    into.doubleSum += from.doubleSum;
+    if (into.overflow || from.overflow || addOverflows(into.intSum, from.intSum)) {
+        into.overflow = true;
+    } else {
+        into.intSum += from.intSum;
+    }
+    if (!std::holds_alternative<std::monostate>(from.extremum)) {
+        const int order = compareExtrema(from.extremum, into.extremum);
+        if (std::holds_alternative<std::monostate>(into.extremum) || (function == AggregateFunction::Min ? order < 0 : order > 0)) {
+            into.extremum = std::move(from.extremum);
+        }
+    }
+    auto mergeSet = [](auto& target, auto& source) {
+        if (!source) {
+            return;
+        }
+        if (!target) {
+            target = std::move(source);
+            return;
+        }
+        target->merge(*source);
+    };
+    mergeSet(into.distinctNumbers, from.distinctNumbers);
+    mergeSet(into.distinctText, from.distinctText);
+}
+
+void appendExtremum(ColumnData& out, const Extremum& value) {
+    ColumnData cell;
+    std::visit(
+        [&](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                out.appendNull();
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                if (out.type() == ColumnDataType::Bit) {
+                    out.appendBit(v != 0);
+                } else if (out.type() == ColumnDataType::Int64) {
+                    out.appendInt64(v);
+                } else {
+                    cell = ColumnData(ColumnDataType::Int64);
+                    cell.appendInt64(v);
+                    out.appendFrom(cell, 0);
+                }
+            } else if constexpr (std::is_same_v<T, double>) {
+                cell = ColumnData(ColumnDataType::Double);
+                cell.appendDouble(v);
+                out.appendFrom(cell, 0);
+            } else if constexpr (std::is_same_v<T, DateTimeValue>) {
+                cell = ColumnData(out.type() == ColumnDataType::Text ? ColumnDataType::Timestamp : out.type(), out.fractionDigits());
+                cell.appendDateTime(v);
+                out.appendFrom(cell, 0);
+            } else if (out.type() == ColumnDataType::Binary) {
+                out.appendBinary(v);  // MIN/MAX of a binary column: v holds its raw bytes
+            } else {
+                cell = ColumnData(ColumnDataType::Text);
+                cell.appendText(v);
+                out.appendFrom(cell, 0);
+            }
+        },
+        value);
+}
+
+}  // namespace
+
+struct ResultAggregator::Table {
+    Groups groups;
+    std::vector<ColumnData> keyColumns;   ///< Group key cells, one row per group
+    std::vector<bool> integerSums;        ///< Per aggregate: SUM over an integer column
+    std::vector<ColumnData> sourceShapes; ///< Per aggregate: empty column typed like its source (MIN/MAX output)
+    bool typesKnown = false;
+};
+
+ResultAggregator::ResultAggregator(std::vector<ColumnInfo> columns, AggregateRequest request) : m_columns(std::move(columns)), m_request(std::move(request)), m_table(std::make_unique<Table>()) {
+    for (size_t column : m_request.groupBy) {
+        if (column >= m_columns.size()) {
+            throw std::invalid_argument(std::format("Group column {} does not exist", column));
+        }
+    }
+    for (const auto& spec : m_request.aggregates) {
+        if (spec.column == AggregateSpec::ALL_ROWS) {
+            if (spec.function != AggregateFunction::Count) {
+                throw std::invalid_argument(std::format("{} needs a column", functionName(spec.function)));
+            }
+        } else if (spec.column >= m_columns.size()) {
+            throw std::invalid_argument(std::format("Aggregate column {} does not exist", spec.column));
+        }
+    }
+}
+
+ResultAggregator::~ResultAggregator() = default;
+
+void ResultAggregator::add(const ResultSet& batch, const std::vector<size_t>* selection) {
+    if (batch.columnData.size() < m_columns.size()) [[unlikely]] {
+        throw std::invalid_argument("Batch does not match the aggregated columns");
+    }
+    auto& table = *m_table;
+    const size_t aggregateCount = m_request.aggregates.size();
+    if (!table.typesKnown) {
+        table.typesKnown = true;
+        for (size_t column : m_request.groupBy) {
+            table.keyColumns.emplace_back(batch.columnData[column].type(), batch.columnData[column].fractionDigits());
+        }
+        for (const auto& spec : m_request.aggregates) {
+            const bool summed = spec.function == AggregateFunction::Sum || spec.function == AggregateFunction::Avg;
+            const auto type = spec.column == AggregateSpec::ALL_ROWS ? ColumnDataType::Int64 : batch.columnData[spec.column].type();
+            if (summed && type != ColumnDataType::Int64 && type != ColumnDataType::Bit && type != ColumnDataType::Double && type != ColumnDataType::Text) {
+                throw std::invalid_argument(std::format("{} needs a numeric column, '{}' is not", functionName(spec.function), m_columns[spec.column].name));
+            }
+            table.integerSums.push_back(summed && (type == ColumnDataType::Int64 || type == ColumnDataType::Bit));
+            table.sourceShapes.emplace_back(type, spec.column == AggregateSpec::ALL_ROWS ? uint8_t{0} : batch.columnData[spec.column].fractionDigits());
+        }
+    }
+
+    const size_t rows = selection ? selection->size() : batch.rowCount();
+    if (rows == 0) {
+        return;
+    }
+    const size_t slices = parallel_slices::sliceCount(rows, PARALLEL_MIN_ROWS);
+
+    // Each slice aggregates a contiguous run of rows into private groups
+    std::vector<Groups> partials(slices);
+    parallel_slices::runSlices(slices, [&](size_t slice) {
+        auto& local = partials[slice];
+        std::string key;
+        const size_t begin = rows * slice / slices;
+        const size_t end = rows * (slice + 1) / slices;
+        for (size_t i = begin; i < end; ++i) {
+            const size_t row = selection ? (*selection)[i] : i;
+            key.clear();
+            appendGroupKey(key, batch, m_request.groupBy, row);
+            auto found = local.index.find(std::string_view(key));
+            if (found == local.index.end()) {
+                if (local.keys.size() >= MAX_GROUPS) {
+                    throw std::runtime_error(std::format("More than {} groups", MAX_GROUPS));
+                }
+                found = local.index.emplace(key, local.keys.size()).first;
+                local.keys.push_back(&found->first);
+                local.firstRow.push_back(row);
+                local.accumulators.resize(local.accumulators.size() + aggregateCount);
+            }
+            auto* accumulators = local.accumulators.data() + found->second * aggregateCount;
+            for (size_t a = 0; a < aggregateCount; ++a) {
+                accumulate(accumulators[a], m_request.aggregates[a], batch, row, m_columns);
+            }
+        }
+    });
+
+    // Merging in slice order keeps groups in first-appearance order
+    auto& groups = table.groups;
+    for (auto& local : partials) {
+        for (size_t g = 0; g < local.keys.size(); ++g) {
+            auto found = groups.index.find(std::string_view(*local.keys[g]));
+            if (found == groups.index.end()) {
+                if (groups.keys.size() >= MAX_GROUPS) {
+                    throw std::runtime_error(std::format("More than {} groups", MAX_GROUPS));
+                }
+                found = groups.index.emplace(*local.keys[g], groups.keys.size()).first;
+                groups.keys.push_back(&found->first);
+                for (size_t k = 0; k < m_request.groupBy.size(); ++k) {
+                    table.keyColumns[k].appendFrom(batch.columnData[m_request.groupBy[k]], local.firstRow[g]);
+                }
+                std::move(local.accumulators.begin() + static_cast<ptrdiff_t>(g * aggregateCount), local.accumulators.begin() + static_cast<ptrdiff_t>((g + 1) * aggregateCount),
+                          std::back_inserter(groups.accumulators));
+                continue;
+            }
+            for (size_t a = 0; a < aggregateCount; ++a) {
+                merge(groups.accumulators[found->second * aggregateCount + a], std::move(local.accumulators[g * aggregateCount + a]), m_request.aggregates[a].function);
+            }
+        }
+    }
+}
+
+ResultSet ResultAggregator::finish() {
+    auto& table = *m_table;
+    const auto& groups = table.groups;
+    const size_t aggregateCount = m_request.aggregates.size();
+    ResultSet result;
+
+    for (size_t k = 0; k < m_request.groupBy.size(); ++k) {
+        result.columns.push_back(m_columns[m_request.groupBy[k]]);
+        result.columnData.push_back(table.typesKnown ? std::move(table.keyColumns[k]) : ColumnData(ColumnDataType::Text));
+    }
+    // Without GROUP BY an empty input still yields its one group (COUNT 0, everything else NULL)
+    size_t groupCount = groups.keys.size();
+    std::vector<Accumulator> empty;
+    const auto* accumulators = groups.accumulators.data();
+    if (m_request.groupBy.empty() && groupCount == 0) {
+        groupCount = 1;
+        empty.resize(aggregateCount);
+        accumulators = empty.data();
+    }
+
+    for (size_t a = 0; a < aggregateCount; ++a) {
+        const auto& spec = m_request.aggregates[a];
+        const bool allRows = spec.column == AggregateSpec::ALL_ROWS;
+        auto name = std::format("{}({})", functionName(spec.function), allRows ? "*" : m_columns[spec.column].name);
+
+        bool exactSum = table.typesKnown && table.integerSums[a];
+        for (size_t g = 0; g < groupCount && exactSum; ++g) {
+            exactSum = !accumulators[g * aggregateCount + a].overflow;
+        }
+
+        ColumnData data;
+        std::string sqlType = "BIGINT";
+        switch (spec.function) {
+            case AggregateFunction::Count:
+            case AggregateFunction::CountDistinct:
+                data = ColumnData(ColumnDataType::Int64);
+                break;
+            case AggregateFunction::Sum:
+                data = ColumnData(exactSum ? ColumnDataType::Int64 : ColumnDataType::Double);
+                sqlType = exactSum ? "BIGINT" : "FLOAT";
+                break;
+            case AggregateFunction::Avg:
+                data = ColumnData(ColumnDataType::Double);
+                sqlType = "FLOAT";
+                break;
+            case AggregateFunction::Min:
+            case AggregateFunction::Max:
+                data = table.typesKnown ? ColumnData(table.sourceShapes[a].type(), table.sourceShapes[a].fractionDigits()) : ColumnData(ColumnDataType::Text);
+                sqlType = m_columns[spec.column].type;
+                break;
+        }
+
+        for (size_t g = 0; g < groupCount; ++g) {
+            const auto& acc = accumulators[g * aggregateCount + a];
+            switch (spec.function) {
+                case AggregateFunction::Count:
+                    data.appendInt64(acc.count);
+                    break;
+                case AggregateFunction::CountDistinct:
+                    data.appendInt64(static_cast<int64_t>((acc.distinctNumbers ? acc.distinctNumbers->size() : 0) + (acc.distinctText ? acc.distinctText->size() : 0)));
+                    break;
+                case AggregateFunction::Sum:
+                    if (acc.count == 0) {
+                        data.appendNull();
+                    } else if (exactSum) {
+                        data.appendInt64(acc.intSum);
+                    } else {
+                        data.appendDouble(acc.doubleSum);
+                    }
+                    break;
+                case AggregateFunction::Avg:
+                    if (acc.count == 0) {
+                        data.appendNull();
+                    } else {
+                        data.appendDouble((acc.overflow ? acc.doubleSum : static_cast<double>(acc.intSum)) / static_cast<double>(acc.count));
+                    }
+                    break;
+                case AggregateFunction::Min:
+                case AggregateFunction::Max:
+                    appendExtremum(data, acc.extremum);
+                    break;
+            }
+        }
+        result.columns.push_back(ColumnInfo{.name = std::move(name), .type = std::move(sqlType)});
+        result.columnData.push_back(std::move(data));
+    }
+    result.affectedRows = static_cast<int64_t>(groupCount);
+    return result;
+}
+
+std::optional<AggregateFunction> ResultAggregator::parseFunction(std::string_view name) noexcept {
+    for (auto function : {AggregateFunction::Count, AggregateFunction::Sum, AggregateFunction::Min, AggregateFunction::Max, AggregateFunction::Avg, AggregateFunction::CountDistinct}) {
+        if (functionName(function) == name) {
+            return function;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view ResultAggregator::functionName(AggregateFunction function) noexcept {
+    switch (function) {
+        case AggregateFunction::Count:
+            return "count";
+        case AggregateFunction::Sum:
+            return "sum";
+        case AggregateFunction::Min:
+            return "min";
+        case AggregateFunction::Max:
+            return "max";
+        case AggregateFunction::Avg:
+            return "avg";
+        case AggregateFunction::CountDistinct:
+            return "countDistinct";
+    }
+    return "count";
+}
+
+}  // namespace velocitydb
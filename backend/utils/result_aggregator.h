@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+enum class AggregateFunction : uint8_t { Count, Sum, Min, Max, Avg, CountDistinct };
+
+struct AggregateSpec {
+    static constexpr size_t ALL_ROWS = static_cast<size_t>(-1);
+
+    AggregateFunction function = AggregateFunction::Count;
+    size_t column = ALL_ROWS;  ///< ALL_ROWS only for Count, i.e. COUNT(*)
+};
+
+struct AggregateRequest {
+    std::vector<size_t> groupBy;  ///< Empty = one group over every row
+    std::vector<AggregateSpec> aggregates;
+};
+
+/// Hash GROUP BY over result batches, for pivoting a fetched result without another round trip.
+///
+/// Follows SQL semantics: NULL group keys form one group; COUNT(column), SUM, MIN, MAX, AVG and
+/// COUNT(DISTINCT) skip NULLs, and an aggregate that saw no value is NULL. SUM keeps integer columns exact
+/// (switching to double only if a group overflows int64); text columns holding numbers (DECIMAL) sum as double.
+/// MIN/MAX keep the column type. Groups come out in first-appearance order.
+///
+/// Batches of at least PARALLEL_MIN_ROWS are split across cores: each thread aggregates its slice into a
+/// private table, and the tables are merged in slice order.
+class ResultAggregator {
+public:
+    static constexpr size_t MAX_GROUPS = 1000000;
+    static constexpr size_t PARALLEL_MIN_ROWS = 65536;
+
+    /// @throws std::invalid_argument for unknown columns or an aggregate other than COUNT without a column
+    ResultAggregator(std::vector<ColumnInfo> columns, AggregateRequest request);
+    ~ResultAggregator();
+
+    ResultAggregator(const ResultAggregator&) = delete;
+    ResultAggregator& operator=(const ResultAggregator&) = delete;
+    ResultAggregator(ResultAggregator&&) = delete;
+    ResultAggregator& operator=(ResultAggregator&&) = delete;
+
+    /// Fold `batch` (same columns as the constructor's) into the groups; `selection` limits it to those rows (ascending)
+    /// @throws std::invalid_argument when SUM/AVG meet a non-numeric column or value
+    /// @throws std::runtime_error once more than MAX_GROUPS groups exist
+    void add(const ResultSet& batch, const std::vector<size_t>* selection = nullptr);
+
+    /// Group columns followed by one column per aggregate, named like "sum(amount)"
+    [[nodiscard]] ResultSet finish();
+
+    [[nodiscard]] static std::optional<AggregateFunction> parseFunction(std::string_view name) noexcept;
+    [[nodiscard]] static std::string_view functionName(AggregateFunction function) noexcept;
+
+private:
+    struct Table;
+
+    std::vector<ColumnInfo> m_columns;
+    AggregateRequest m_request;
+    std::unique_ptr<Table> m_table;
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,299 @@
+#include "result_comparer.h"
+
+#include "parallel_slices.h"
+#include "row_key.h"
+#include "string_hash.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <format>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr size_t NO_ROW = static_cast<size_t>(-1);
+
+using parallel_slices::runSlices;
+
+using KeyIndex = std::unordered_map<std::string, size_t, StringHash, std::equal_to<>>;
+
+[[nodiscard]] size_t partitionOf(size_t hash) noexcept {
+    return parallel_slices::partitionOf(hash, ResultComparer::KEY_PARTITIONS);
+}
+
+[[nodiscard]] size_t sliceCount(size_t rows) noexcept {
+    return parallel_slices::sliceCount(rows, ResultComparer::PARALLEL_MIN_ROWS);
+}
+
+[[nodiscard]] bool cellsEqual(const ColumnData& a, size_t rowA, const ColumnData& b, size_t rowB, bool byText) {
+    const bool nullA = a.isNull(rowA);
+    const bool nullB = b.isNull(rowB);
+    if (nullA || nullB) {
+        return nullA == nullB;
+    }
+    if (byText) {
+        return a.displayText(rowA) == b.displayText(rowB);
+    }
+    switch (a.type()) {
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+            return a.int64At(rowA) == b.int64At(rowB);
+        case ColumnDataType::Double:
+            return a.doubleAt(rowA) == b.doubleAt(rowB);
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp: {
+            const auto& x = a.dateTimeAt(rowA);
+            const auto& y = b.dateTimeAt(rowB);
+            return x.year == y.year && x.month == y.month && x.day == y.day && x.hour == y.hour && x.minute == y.minute && x.second == y.second && x.fraction == y.fraction;
+        }
+        case ColumnDataType::Text:
+        case ColumnDataType::Binary:
+            break;
+    }
+    return a.textAt(rowA) == b.textAt(rowB);
+}
+
+/// Append the cells `columns` of `row` as one row of `out` (storage typed like the first source)
+void appendCells(ResultSet& out, const ResultSet& source, size_t row, std::span<const size_t> columns) {
+    if (out.columnData.empty()) {
+        for (size_t columnIndex : columns) {
+            out.columnData.emplace_back(source.columnData[columnIndex].type(), source.columnData[columnIndex].fractionDigits());
+        }
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        out.columnData[i].appendFrom(source.columnData[columns[i]], row);
+    }
+}
+
+/// A right row that did not match unchanged
+struct Finding {
+    size_t row = 0;
+    size_t leftRow = NO_ROW;  ///< NO_ROW: inserted
+    size_t firstChanged = 0;  ///< Range of SliceFindings::changed listing the differing columns
+    size_t changedCount = 0;
+};
+
+struct SliceFindings {
+    std::vector<Finding> rows;
+    std::vector<size_t> changed;
+    size_t unchanged = 0;
+};
+
+}  // namespace
+
+struct ResultComparer::State {
+    std::vector<ColumnInfo> left;
+    std::vector<size_t> leftKeys;
+    ResultSet leftRows;
+    std::array<KeyIndex, KEY_PARTITIONS> partitions;
+
+    bool rightStarted = false;
+    bool typesChecked = false;
+    std::vector<size_t> compared;  ///< Left index of each compared column
+    std::vector<size_t> rightOf;   ///< Right index of each compared column
+    std::vector<size_t> rightKeys;
+    std::vector<bool> byText;      ///< Per compared column: storage types differ between the sides
+    std::unique_ptr<std::atomic<bool>[]> matched;
+    CompareResult result;
+};
+
+ResultComparer::ResultComparer(std::vector<ColumnInfo> left, std::vector<std::string> keyColumns) : m_state(std::make_unique<State>()) {
+    auto& state = *m_state;
+    if (keyColumns.empty()) {
+        throw std::invalid_argument("Comparing rows needs at least one key column");
+    }
+    for (const auto& name : keyColumns) {
+        auto column = std::ranges::find(left, name, &ColumnInfo::name);
+        if (column == left.end()) {
+            throw std::invalid_argument(std::format("Key column '{}' is not in the left result", name));
+        }
+        state.leftKeys.push_back(static_cast<size_t>(column - left.begin()));
+    }
+    state.leftRows.columns = left;
+    state.left = std::move(left);
+}
+
+ResultComparer::~ResultComparer() = default;
+
+void ResultComparer::addLeft(const ResultSet& batch) {
+    auto& state = *m_state;
+    if (state.rightStarted) [[unlikely]] {
+        throw std::logic_error("Left rows must all come before the right side");
+    }
+    if (batch.columnData.size() < state.left.size()) [[unlikely]] {
+        throw std::invalid_argument("Batch does not match the left columns");
+    }
+    const size_t rows = batch.rowCount();
+    if (rows == 0) {
+        return;
+    }
+    const size_t firstRow = state.leftRows.rowCount();
+    state.leftRows.appendBatch(batch);
+
+    // Encode and hash the keys in slices...
+    std::vector<std::string> keys(rows);
+    std::vector<uint8_t> partition(rows);
+    const size_t slices = sliceCount(rows);
+    runSlices(slices, [&](size_t slice) {
+        for (size_t row = rows * slice / slices; row < rows * (slice + 1) / slices; ++row) {
+            appendRowKey(keys[row], batch, state.leftKeys, row);
+            partition[row] = static_cast<uint8_t>(partitionOf(StringHash{}(keys[row])));
+        }
+    });
+
+    // ...then fill the partitions, each table written by one thread only
+    const size_t threads = slices == 1 ? 1 : (std::min)(slices, KEY_PARTITIONS);
+    runSlices(threads, [&](size_t thread) {
+        for (size_t row = 0; row < rows; ++row) {
+            if (partition[row] % threads != thread) {
+                continue;
+            }
+            if (!state.partitions[partition[row]].try_emplace(std::move(keys[row]), firstRow + row).second) {
+                throw std::runtime_error(std::format("Key ({}) occurs more than once in the left result", describeRowKey(batch, state.leftKeys, row)));
+            }
+        }
+    });
+}
+
+void ResultComparer::beginRight(const std::vector<ColumnInfo>& right) {
+    auto& state = *m_state;
+    if (state.rightStarted) [[unlikely]] {
+        throw std::logic_error("The right side has already started");
+    }
+    for (size_t key : state.leftKeys) {
+        auto column = std::ranges::find(right, state.left[key].name, &ColumnInfo::name);
+        if (column == right.end()) {
+            throw std::invalid_argument(std::format("Key column '{}' is not in the right result", state.left[key].name));
+        }
+        state.rightKeys.push_back(static_cast<size_t>(column - right.begin()));
+    }
+
+    auto& result = state.result;
+    for (size_t i = 0; i < state.left.size(); ++i) {
+        auto column = std::ranges::find(right, state.left[i].name, &ColumnInfo::name);
+        if (column == right.end()) {
+            continue;
+        }
+        if (std::ranges::find(state.leftKeys, i) != state.leftKeys.end()) {
+            result.keyColumns.push_back(state.compared.size());
+        }
+        state.compared.push_back(i);
+        state.rightOf.push_back(static_cast<size_t>(column - right.begin()));
+        result.columns.push_back(state.left[i]);
+    }
+    state.byText.assign(state.compared.size(), false);
+    for (auto* set : {&result.inserted, &result.deleted, &result.changedBefore, &result.changedAfter}) {
+        set->columns = result.columns;
+    }
+    state.matched = std::make_unique<std::atomic<bool>[]>(state.leftRows.rowCount());
+    state.rightStarted = true;
+}
+
+void ResultComparer::addRight(const ResultSet& batch) {
+    auto& state = *m_state;
+    if (!state.rightStarted) [[unlikely]] {
+        throw std::logic_error("beginRight() must come before the right rows");
+    }
+    const size_t rows = batch.rowCount();
+    if (rows == 0) {
+        return;
+    }
+    const auto& leftRows = state.leftRows;
+    if (!state.typesChecked && !leftRows.empty()) {
+        for (size_t k = 0; k < state.leftKeys.size(); ++k) {
+            if (leftRows.columnData[state.leftKeys[k]].type() != batch.columnData[state.rightKeys[k]].type()) {
+                throw std::invalid_argument(std::format("Key column '{}' is fetched as different types on the two sides; cast it to one type in both queries", state.left[state.leftKeys[k]].name));
+            }
+        }
+        for (size_t c = 0; c < state.compared.size(); ++c) {
+            state.byText[c] = leftRows.columnData[state.compared[c]].type() != batch.columnData[state.rightOf[c]].type();
+        }
+        state.typesChecked = true;
+    }
+
+    const size_t slices = sliceCount(rows);
+    std::vector<SliceFindings> findings(slices);
+    runSlices(slices, [&](size_t slice) {
+        auto& local = findings[slice];
+        std::string key;
+        for (size_t row = rows * slice / slices; row < rows * (slice + 1) / slices; ++row) {
+            key.clear();
+            appendRowKey(key, batch, state.rightKeys, row);
+            const auto& index = state.partitions[partitionOf(StringHash{}(key))];
+            auto found = index.find(std::string_view(key));
+            if (found == index.end()) {
+                local.rows.push_back(Finding{.row = row});
+                continue;
+            }
+            const size_t leftRow = found->second;
+            if (state.matched[leftRow].exchange(true, std::memory_order_relaxed)) {
+                throw std::runtime_error(std::format("Key ({}) occurs more than once in the right result", describeRowKey(batch, state.rightKeys, row)));
+            }
+            const size_t firstChanged = local.changed.size();
+            for (size_t c = 0; c < state.compared.size(); ++c) {
+                if (!cellsEqual(leftRows.columnData[state.compared[c]], leftRow, batch.columnData[state.rightOf[c]], row, state.byText[c])) {
+                    local.changed.push_back(c);
+                }
+            }
+            if (local.changed.size() == firstChanged) {
+                ++local.unchanged;
+            } else {
+                local.rows.push_back(Finding{.row = row, .leftRow = leftRow, .firstChanged = firstChanged, .changedCount = local.changed.size() - firstChanged});
+            }
+        }
+    });
+
+    // Slice order is row order
+    auto& result = state.result;
+    for (const auto& local : findings) {
+        result.unchangedCount += local.unchanged;
+        for (const auto& finding : local.rows) {
+            if (finding.leftRow == NO_ROW) {
+                if (++result.insertedCount > MAX_DIFF_ROWS) {
+                    result.truncated = true;
+                    continue;
+                }
+                appendCells(result.inserted, batch, finding.row, state.rightOf);
+                continue;
+            }
+            if (++result.changedCount > MAX_DIFF_ROWS) {
+                result.truncated = true;
+                continue;
+            }
+            appendCells(result.changedBefore, leftRows, finding.leftRow, state.compared);
+            appendCells(result.changedAfter, batch, finding.row, state.rightOf);
+            const auto changed = std::span(local.changed).subspan(finding.firstChanged, finding.changedCount);
+            result.changedColumns.emplace_back(changed.begin(), changed.end());
+        }
+    }
+}
+
+CompareResult ResultComparer::finish() {
+    auto& state = *m_state;
+    if (!state.rightStarted) {
+        beginRight(state.left);
+    }
+    auto& result = state.result;
+    const auto& leftRows = state.leftRows;
+    for (size_t row = 0; row < leftRows.rowCount(); ++row) {
+        if (state.matched[row].load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (++result.deletedCount > MAX_DIFF_ROWS) {
+            result.truncated = true;
+            continue;
+        }
+        appendCells(result.deleted, leftRows, row, state.compared);
+    }
+    return std::move(result);
+}
+
+}  // namespace velocitydb
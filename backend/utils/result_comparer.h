@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+/// Row-level differences between an original (left) and a new (right) result
+struct CompareResult {
+    std::vector<ColumnInfo> columns;   ///< Compared columns (named on both sides), in left order
+    std::vector<size_t> keyColumns;    ///< Indices into `columns`
+    ResultSet inserted;                ///< Right-only rows
+    ResultSet deleted;                 ///< Left-only rows
+    ResultSet changedBefore;           ///< Left values of rows whose key matched but some column differs...
+    ResultSet changedAfter;            ///< ...and their right values, in the same order
+    std::vector<std::vector<size_t>> changedColumns;  ///< Per changed row: the differing columns
+    size_t insertedCount = 0;
+    size_t deletedCount = 0;
+    size_t changedCount = 0;
+    size_t unchangedCount = 0;
+    bool truncated = false;  ///< Some set holds fewer rows than its count (MAX_DIFF_ROWS)
+};
+
+/// Hash join of two results on declared key columns, yielding inserted, deleted and changed rows.
+///
+/// Feed every left batch, then beginRight() with the right columns and every right batch; both sides
+/// stream, only the left rows are kept. Columns are matched by name, and columns missing on either side
+/// are left out of the comparison. Keys must be unique on each side. Key columns must be fetched with
+/// the same storage type on both sides; other columns fetched as different types compare by display text.
+///
+/// Batches of at least PARALLEL_MIN_ROWS are spread across cores: keys are encoded and hashed in slices,
+/// left keys go into KEY_PARTITIONS hash tables filled one per thread, and right rows are probed in slices
+/// whose findings are merged in slice order, so output follows input order.
+class ResultComparer {
+public:
+    static constexpr size_t PARALLEL_MIN_ROWS = 65536;
+    static constexpr size_t KEY_PARTITIONS = 16;
+    /// Rows kept per set; counts go on past it
+    static constexpr size_t MAX_DIFF_ROWS = 100000;
+
+    /// @throws std::invalid_argument when no key is given or a key column is not a left column
+    ResultComparer(std::vector<ColumnInfo> left, std::vector<std::string> keyColumns);
+    ~ResultComparer();
+
+    ResultComparer(const ResultComparer&) = delete;
+    ResultComparer& operator=(const ResultComparer&) = delete;
+    ResultComparer(ResultComparer&&) = delete;
+    ResultComparer& operator=(ResultComparer&&) = delete;
+
+    /// Index the rows of `batch` (left columns)
+    /// @throws std::runtime_error when a key occurs twice
+    void addLeft(const ResultSet& batch);
+
+    /// Start on the right side: matches its columns to the left ones by name
+    /// @throws std::invalid_argument when a key column is missing on the right
+    void beginRight(const std::vector<ColumnInfo>& right);
+
+    /// Match the rows of `batch` (right columns) against the left
+    /// @throws std::invalid_argument when a key column has another storage type than on the left
+    /// @throws std::runtime_error when a key occurs twice
+    void addRight(const ResultSet& batch);
+
+    /// Left rows never matched become the deleted set
+    [[nodiscard]] CompareResult finish();
+
+private:
+    struct State;
+
+    std::unique_ptr<State> m_state;
+};
+
+}  // namespace velocitydb
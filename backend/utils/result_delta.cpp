@@ -0,0 +1,94 @@
+#include "result_delta.h"
+
+#include "row_key.h"
+
+#include <algorithm>
+#include <format>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace velocitydb {
+
+ResultDelta ResultDelta::compute(const ResultSet& previous, const ResultSet& current, std::span<const std::string> keyColumns) {
+    const size_t columnCount = current.columns.size();
+    bool sameColumns = previous.columns.size() == columnCount && previous.columnData.size() == current.columnData.size();
+    for (size_t c = 0; sameColumns && c < columnCount; ++c) {
+        sameColumns = previous.columns[c].name == current.columns[c].name && previous.columnData[c].type() == current.columnData[c].type();
+    }
+    if (!sameColumns) [[unlikely]] {
+        throw std::invalid_argument("The query no longer returns the same columns");
+    }
+
+    std::vector<size_t> allColumns(columnCount);
+    std::iota(allColumns.begin(), allColumns.end(), size_t{0});
+    std::vector<size_t> keys;
+    for (const auto& name : keyColumns) {
+        auto column = std::ranges::find(current.columns, name, &ColumnInfo::name);
+        if (column == current.columns.end()) [[unlikely]] {
+            throw std::invalid_argument(std::format("Unknown key column: {}", name));
+        }
+        keys.push_back(static_cast<size_t>(column - current.columns.begin()));
+    }
+
+    ResultDelta delta;
+    delta.keyed = !keys.empty();
+    const std::span<const size_t> matchColumns = delta.keyed ? std::span<const size_t>(keys) : std::span<const size_t>(allColumns);
+
+    // Previous rows by key; whole-row matching keeps every row of a duplicate group and pairs them up in order
+    struct Candidates {
+        std::vector<size_t> rows;
+        size_t next = 0;  ///< First row not matched yet
+    };
+    std::unordered_map<std::string, Candidates> previousRows;
+    previousRows.reserve(previous.rowCount());
+    std::string key;
+    for (size_t row = 0; row < previous.rowCount(); ++row) {
+        key.clear();
+        appendRowKey(key, previous, matchColumns, row);
+        auto& rows = previousRows[key].rows;
+        if (delta.keyed && !rows.empty()) [[unlikely]] {
+            throw std::runtime_error(std::format("Duplicate key in the previous result: {}", describeRowKey(previous, keys, row)));
+        }
+        rows.push_back(row);
+    }
+
+    std::vector<bool> matched(previous.rowCount());
+    std::string before;
+    std::string after;
+    for (size_t row = 0; row < current.rowCount(); ++row) {
+        key.clear();
+        appendRowKey(key, current, matchColumns, row);
+        auto found = previousRows.find(key);
+        if (found == previousRows.end() || found->second.next == found->second.rows.size()) {
+            if (delta.keyed && found != previousRows.end()) [[unlikely]] {
+                throw std::runtime_error(std::format("Duplicate key in the current result: {}", describeRowKey(current, keys, row)));
+            }
+            delta.inserted.push_back(row);
+            continue;
+        }
+        const size_t match = found->second.rows[found->second.next++];
+        matched[match] = true;
+        if (!delta.keyed) {
+            ++delta.unchanged;
+            continue;
+        }
+        before.clear();
+        after.clear();
+        appendRowKey(before, previous, allColumns, match);
+        appendRowKey(after, current, allColumns, row);
+        if (before == after) {
+            ++delta.unchanged;
+        } else {
+            delta.changed.emplace_back(match, row);
+        }
+    }
+    for (size_t row = 0; row < matched.size(); ++row) {
+        if (!matched[row]) {
+            delta.deleted.push_back(row);
+        }
+    }
+    return delta;
+}
+
+}  // namespace velocitydb
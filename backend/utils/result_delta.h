@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace velocitydb {
+
+/// What changed between two runs of the same query, as row indices into either result.
+///
+/// With key columns, rows are matched on their key and a matched row whose other cells differ is "changed".
+/// Without, rows are matched on their whole contents (duplicates pair up one to one), so an edited row shows
+/// up as deleted and inserted. Index lists are ascending.
+struct ResultDelta {
+    bool keyed = false;
+    std::vector<size_t> deleted;                     ///< Rows of the previous result with no match
+    std::vector<size_t> inserted;                    ///< Rows of the current result with no match
+    std::vector<std::pair<size_t, size_t>> changed;  ///< (previous row, current row), by current row; keyed only
+    size_t unchanged = 0;
+
+    /// Rows a client has to touch to apply the delta
+    [[nodiscard]] size_t size() const noexcept { return deleted.size() + inserted.size() + changed.size(); }
+
+    /// Match `current` against `previous` on the columns named in `keyColumns`, or on whole rows when empty
+    /// @throws std::invalid_argument when the two results do not have the same columns, or a key column is unknown
+    /// @throws std::runtime_error when a key occurs twice in either result
+    [[nodiscard]] static ResultDelta compute(const ResultSet& previous, const ResultSet& current, std::span<const std::string> keyColumns);
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,234 @@
+#include "result_joiner.h"
+
+#include "parallel_slices.h"
+#include "row_key.h"
+#include "string_hash.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <format>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr size_t NO_ROW = static_cast<size_t>(-1);
+/// Partition marker of a row whose key has a NULL (never matches)
+constexpr uint8_t NULL_KEY = 0xFF;
+
+using parallel_slices::hardwareThreads;
+using parallel_slices::runSlices;
+
+/// First and last build row of a key; the rows in between are linked through `next`
+struct Chain {
+    size_t head;
+    size_t tail;
+};
+
+using ChainIndex = std::unordered_map<std::string, Chain, StringHash, std::equal_to<>>;
+
+[[nodiscard]] size_t partitionOf(size_t hash) noexcept {
+    return parallel_slices::partitionOf(hash, ResultJoiner::KEY_PARTITIONS);
+}
+
+[[nodiscard]] size_t sliceCount(size_t rows) noexcept {
+    return parallel_slices::sliceCount(rows, ResultJoiner::PARALLEL_MIN_ROWS);
+}
+
+[[nodiscard]] bool keyHasNull(const ResultSet& batch, std::span<const size_t> columns, size_t row) noexcept {
+    return std::ranges::any_of(columns, [&](size_t column) { return batch.columnData[column].isNull(row); });
+}
+
+[[nodiscard]] std::vector<size_t> keyIndices(const ResultSet& result, const std::vector<std::string>& names, std::string_view side) {
+    std::vector<size_t> indices;
+    indices.reserve(names.size());
+    for (const auto& name : names) {
+        auto column = std::ranges::find(result.columns, name, &ColumnInfo::name);
+        if (column == result.columns.end()) [[unlikely]] {
+            throw std::invalid_argument(std::format("Key column '{}' is not in the {} result", name, side));
+        }
+        indices.push_back(static_cast<size_t>(column - result.columns.begin()));
+    }
+    return indices;
+}
+
+}  // namespace
+
+JoinResult ResultJoiner::join(const ResultSet& left, const ResultSet& right, const std::vector<std::string>& leftKeys, const std::vector<std::string>& rightKeys,
+                              JoinType type) {
+    if (leftKeys.empty() || leftKeys.size() != rightKeys.size()) [[unlikely]] {
+        throw std::invalid_argument("Join needs the same number of key columns on both sides, at least one");
+    }
+    const auto leftKeyColumns = keyIndices(left, leftKeys, "left");
+    const auto rightKeyColumns = keyIndices(right, rightKeys, "right");
+
+    // Hash the smaller side; a left join keeps its left rows either way
+    JoinResult joined;
+    joined.builtOnLeft = left.rowCount() < right.rowCount();
+    const auto& build = joined.builtOnLeft ? left : right;
+    const auto& probe = joined.builtOnLeft ? right : left;
+    const auto& buildKeys = joined.builtOnLeft ? leftKeyColumns : rightKeyColumns;
+    const auto& probeKeys = joined.builtOnLeft ? rightKeyColumns : leftKeyColumns;
+    std::vector<bool> asText(buildKeys.size());
+    for (size_t k = 0; k < buildKeys.size(); ++k) {
+        asText[k] = build.columnData[buildKeys[k]].type() != probe.columnData[probeKeys[k]].type();
+    }
+
+    // Encode and hash the build keys in slices...
+    const size_t buildRows = build.rowCount();
+    std::vector<std::string> keys(buildRows);
+    std::vector<uint8_t> partition(buildRows);
+    const size_t buildSlices = sliceCount(buildRows);
+    runSlices(buildSlices, [&](size_t slice) {
+        for (size_t row = buildRows * slice / buildSlices; row < buildRows * (slice + 1) / buildSlices; ++row) {
+            if (keyHasNull(build, buildKeys, row)) {
+                partition[row] = NULL_KEY;
+                continue;
+            }
+            appendRowKey(keys[row], build, buildKeys, row, asText);
+            partition[row] = static_cast<uint8_t>(partitionOf(StringHash{}(keys[row])));
+        }
+    });
+
+    // ...then chain equal keys in the partitions, each table (and its rows' links) written by one thread only
+    std::array<ChainIndex, KEY_PARTITIONS> partitions;
+    std::vector<size_t> next(buildRows, NO_ROW);
+    const size_t buildThreads = buildSlices == 1 ? 1 : (std::min)(buildSlices, KEY_PARTITIONS);
+    runSlices(buildThreads, [&](size_t thread) {
+        for (size_t row = 0; row < buildRows; ++row) {
+            if (partition[row] == NULL_KEY || partition[row] % buildThreads != thread) {
+                continue;
+            }
+            auto [chain, inserted] = partitions[partition[row]].try_emplace(std::move(keys[row]), Chain{.head = row, .tail = row});
+            if (!inserted) {
+                next[chain->second.tail] = row;
+                chain->second.tail = row;
+            }
+        }
+    });
+    keys = {};
+
+    // Probe in slices, each collecting its (probe row, build row) pairs
+    const bool keepUnmatchedProbe = type == JoinType::Left && !joined.builtOnLeft;
+    const bool keepUnmatchedBuild = type == JoinType::Left && joined.builtOnLeft;
+    auto matched = keepUnmatchedBuild ? std::make_unique<std::atomic<bool>[]>(buildRows) : nullptr;
+    const size_t probeRows = probe.rowCount();
+    const size_t probeSlices = sliceCount(probeRows);
+    std::vector<std::vector<std::pair<size_t, size_t>>> pairs(probeSlices);
+    std::atomic<size_t> produced{0};
+    runSlices(probeSlices, [&](size_t slice) {
+        auto& found = pairs[slice];
+        std::string key;
+        for (size_t row = probeRows * slice / probeSlices; row < probeRows * (slice + 1) / probeSlices; ++row) {
+            const size_t before = found.size();
+            if (!keyHasNull(probe, probeKeys, row)) {
+                key.clear();
+                appendRowKey(key, probe, probeKeys, row, asText);
+                const auto& index = partitions[partitionOf(StringHash{}(key))];
+                if (auto chain = index.find(std::string_view(key)); chain != index.end()) {
+                    for (size_t buildRow = chain->second.head; buildRow != NO_ROW; buildRow = next[buildRow]) {
+                        found.emplace_back(row, buildRow);
+                        if (matched) {
+                            matched[buildRow].store(true, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+            if (found.size() == before && keepUnmatchedProbe) {
+                found.emplace_back(row, NO_ROW);
+            }
+            const size_t added = found.size() - before;
+            if (added != 0 && produced.fetch_add(added, std::memory_order_relaxed) + added > MAX_JOIN_ROWS) [[unlikely]] {
+                throw std::runtime_error(std::format("Join produces more than {} rows; narrow the inputs or the key", MAX_JOIN_ROWS));
+            }
+        }
+    });
+
+    // Row sources of the output, in slice order
+    size_t total = 0;
+    for (const auto& found : pairs) {
+        total += found.size();
+    }
+    std::vector<size_t> leftRows;
+    std::vector<size_t> rightRows;
+    leftRows.reserve(total);
+    rightRows.reserve(total);
+    auto& buildRowsOut = joined.builtOnLeft ? leftRows : rightRows;
+    auto& probeRowsOut = joined.builtOnLeft ? rightRows : leftRows;
+    for (auto& found : pairs) {
+        for (auto [probeRow, buildRow] : found) {
+            probeRowsOut.push_back(probeRow);
+            buildRowsOut.push_back(buildRow);
+        }
+        found = {};
+    }
+    if (keepUnmatchedBuild) {
+        for (size_t row = 0; row < buildRows; ++row) {
+            if (!matched[row].load(std::memory_order_relaxed)) {
+                leftRows.push_back(row);
+                rightRows.push_back(NO_ROW);
+            }
+        }
+        if (leftRows.size() > MAX_JOIN_ROWS) [[unlikely]] {
+            throw std::runtime_error(std::format("Join produces more than {} rows; narrow the inputs or the key", MAX_JOIN_ROWS));
+        }
+    }
+
+    // Output columns: every left column, then the right ones that are not keys, renamed where a name repeats
+    struct Source {
+        const ColumnData* column;
+        const std::vector<size_t>* rows;
+    };
+    auto& result = joined.result;
+    std::vector<Source> sources;
+    std::unordered_set<std::string> names;
+    for (size_t i = 0; i < left.columns.size(); ++i) {
+        result.columns.push_back(left.columns[i]);
+        names.insert(left.columns[i].name);
+        sources.push_back(Source{.column = &left.columnData[i], .rows = &leftRows});
+    }
+    for (size_t i = 0; i < right.columns.size(); ++i) {
+        if (std::ranges::find(rightKeyColumns, i) != rightKeyColumns.end()) {
+            continue;
+        }
+        auto column = right.columns[i];
+        for (size_t suffix = 2; names.contains(column.name); ++suffix) {
+            column.name = std::format("{}_{}", right.columns[i].name, suffix);
+        }
+        names.insert(column.name);
+        column.nullable = column.nullable || type == JoinType::Left;
+        result.columns.push_back(std::move(column));
+        sources.push_back(Source{.column = &right.columnData[i], .rows = &rightRows});
+    }
+
+    // Each column is gathered by one thread
+    result.columnData.resize(sources.size());
+    const size_t columnThreads = leftRows.size() >= PARALLEL_MIN_ROWS ? (std::max)(size_t{1}, (std::min)(hardwareThreads(), sources.size())) : 1;
+    runSlices(columnThreads, [&](size_t thread) {
+        for (size_t c = thread; c < sources.size(); c += columnThreads) {
+            const auto& source = *sources[c].column;
+            ColumnData column(source.type(), source.fractionDigits());
+            column.reserve(sources[c].rows->size());
+            for (size_t row : *sources[c].rows) {
+                if (row == NO_ROW) {
+                    column.appendNull();
+                } else {
+                    column.appendFrom(source, row);
+                }
+            }
+            result.columnData[c] = std::move(column);
+        }
+    });
+    result.truncated = left.truncated || right.truncated;
+    return joined;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+enum class JoinType : uint8_t {
+    Inner,
+    Left,  ///< Left rows without a match are kept once, NULL in the right columns
+};
+
+struct JoinResult {
+    ResultSet result;  ///< Left columns, then the right non-key columns (renamed `name_2`, ... where a name repeats)
+    bool builtOnLeft = false;  ///< The left side was the smaller one and was hashed
+};
+
+/// Equi-join of two results already in memory, typically fetched from different connections.
+///
+/// The smaller side is hashed on its key columns and the other side probes it. Key cells of a column fetched as
+/// the same storage type on both sides compare by value, otherwise by display text. A NULL in any key column
+/// never matches. Output follows the probe side's row order, each probe row followed by its matches in build
+/// order; a left join that built on the left appends its unmatched left rows at the end.
+///
+/// From PARALLEL_MIN_ROWS rows on, keys are encoded in slices, the build keys go into KEY_PARTITIONS hash tables
+/// filled one per thread, probe slices run on their own threads, and output columns are materialized in parallel.
+class ResultJoiner {
+public:
+    static constexpr size_t PARALLEL_MIN_ROWS = 65536;
+    static constexpr size_t KEY_PARTITIONS = 16;
+    /// Joined rows at most; a join multiplying past it is refused rather than truncated
+    static constexpr size_t MAX_JOIN_ROWS = 5'000'000;
+
+    /// @throws std::invalid_argument when the key lists are empty, differ in length or name a missing column
+    /// @throws std::runtime_error when the join would produce more than MAX_JOIN_ROWS rows
+    [[nodiscard]] static JoinResult join(const ResultSet& left, const ResultSet& right, const std::vector<std::string>& leftKeys,
+                                         const std::vector<std::string>& rightKeys, JoinType type = JoinType::Inner);
+};
+
+}  // namespace velocitydb
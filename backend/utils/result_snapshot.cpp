@@ -0,0 +1,340 @@
+#include "result_snapshot.h"
+
+#include "binary_result.h"
+#include "buffered_file_writer.h"
+#include "lz4_codec.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <thread>
+
+namespace velocitydb {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "result snapshot format is little-endian");
+
+constexpr std::string_view MAGIC = "VDBF";
+constexpr uint16_t FLAG_TRUNCATED = 1;
+constexpr uint32_t FLAG_HAS_RANGE = 1;
+constexpr size_t COLUMN_FIXED_BYTES = 48;
+constexpr size_t BLOCK_ENTRY_BYTES = 16;
+
+constexpr size_t alignUp(size_t value) noexcept {
+    return (value + 7) & ~size_t{7};
+}
+
+template <typename T>
+void appendLe(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T readLe(std::string_view data, size_t offset) noexcept {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+[[nodiscard]] std::filesystem::path utf8Path(std::string_view utf8) {
+    return std::filesystem::path(std::u8string(utf8.begin(), utf8.end()));
+}
+
+[[noreturn]] void corrupt(const std::string& filepath) {
+    throw std::runtime_error(std::format("Not a readable result snapshot: {}", filepath));
+}
+
+/// Run `work(column)` for every column, spread over the cores; rethrows the first failure
+template <typename Work>
+void forEachColumn(size_t columns, Work&& work) {
+    const size_t threads = (std::min)(columns, size_t{(std::max)(std::thread::hardware_concurrency(), 1u)});
+    std::vector<std::exception_ptr> errors(threads);
+    auto run = [&](size_t thread) {
+        try {
+            for (size_t column = thread; column < columns; column += threads) {
+                work(column);
+            }
+        } catch (...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t thread = 1; thread < threads; ++thread) {
+        workers.emplace_back(run, thread);
+    }
+    if (threads > 0) {
+        run(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/// NULL count and min/max of a column, comparing values as their storage type does
+void collectStats(const ColumnData& column, SnapshotColumn& stats) {
+    // Folded while the result was fetched; only rows added some other way are read here
+    auto folded = column.stats();
+    folded.update(column);
+    stats.nullCount = folded.nullCount();
+    if (!folded.minRow()) {
+        return;
+    }
+    auto min = column.displayText(*folded.minRow());
+    auto max = column.displayText(*folded.maxRow());
+    if (min.size() <= ResultSnapshot::MAX_STAT_TEXT_BYTES && max.size() <= ResultSnapshot::MAX_STAT_TEXT_BYTES) {
+        stats.min = std::move(min);
+        stats.max = std::move(max);
+    }
+}
+
+/// One column ready to write: its stored blocks back to back and their sizes
+struct EncodedColumn {
+    uint8_t fractionDigits = 0;
+    uint64_t dataBytes = 0;
+    std::string stored;
+    std::vector<std::pair<uint32_t, uint32_t>> blocks;  ///< (rawBytes, storedBytes)
+};
+
+[[nodiscard]] EncodedColumn encodeColumn(const ColumnData& column, size_t rows) {
+    std::string body;
+    BinaryResultEncoder::encodeColumn(column, rows, body);
+
+    EncodedColumn encoded{.fractionDigits = column.fractionDigits(), .dataBytes = body.size()};
+    std::string scratch(Lz4Codec::compressBound(ResultSnapshot::BLOCK_BYTES), '\0');
+    for (size_t start = 0; start < body.size(); start += ResultSnapshot::BLOCK_BYTES) {
+        auto raw = std::string_view(body).substr(start, ResultSnapshot::BLOCK_BYTES);
+        const size_t compressed = Lz4Codec::compress(raw, scratch.data(), scratch.size());
+        // Keep incompressible blocks raw so loading can copy them straight out of the mapping
+        const bool storeRaw = compressed == 0 || compressed >= raw.size();
+        const size_t storedBytes = storeRaw ? raw.size() : compressed;
+        encoded.stored.append(storeRaw ? raw.data() : scratch.data(), storedBytes);
+        encoded.blocks.emplace_back(static_cast<uint32_t>(raw.size()), static_cast<uint32_t>(storedBytes));
+    }
+    return encoded;
+}
+
+/// A column as the directory describes it
+struct ColumnEntry {
+    SnapshotColumn column;
+    uint8_t fractionDigits = 0;
+    uint64_t dataBytes = 0;
+    std::string_view blocks;  ///< blockCount * BLOCK_ENTRY_BYTES
+};
+
+[[nodiscard]] std::vector<ColumnEntry> readDirectory(std::string_view data, const std::string& filepath, SnapshotInfo& info) {
+    if (data.size() < ResultSnapshot::HEADER_BYTES || data.substr(0, 4) != MAGIC) [[unlikely]] {
+        corrupt(filepath);
+    }
+    if (readLe<uint16_t>(data, 4) != ResultSnapshot::VERSION) [[unlikely]] {
+        throw std::runtime_error(std::format("Unsupported result snapshot version {}: {}", readLe<uint16_t>(data, 4), filepath));
+    }
+    info.truncated = (readLe<uint16_t>(data, 6) & FLAG_TRUNCATED) != 0;
+    const auto columnCount = readLe<uint32_t>(data, 8);
+    info.rowCount = readLe<uint64_t>(data, 16);
+    info.createdAt = readLe<int64_t>(data, 24);
+    info.fileBytes = data.size();
+
+    std::vector<ColumnEntry> entries;
+    size_t pos = ResultSnapshot::HEADER_BYTES;
+    for (uint32_t i = 0; i < columnCount; ++i) {
+        if (COLUMN_FIXED_BYTES > data.size() - pos) [[unlikely]] {
+            corrupt(filepath);
+        }
+        ColumnEntry entry;
+        auto& column = entry.column;
+        column.storage = static_cast<ColumnDataType>(readLe<uint8_t>(data, pos));
+        entry.fractionDigits = readLe<uint8_t>(data, pos + 1);
+        column.info.nullable = readLe<uint8_t>(data, pos + 2) != 0;
+        column.info.isPrimaryKey = readLe<uint8_t>(data, pos + 3) != 0;
+        column.info.size = readLe<int32_t>(data, pos + 4);
+        const size_t nameBytes = readLe<uint32_t>(data, pos + 8);
+        const size_t typeBytes = readLe<uint32_t>(data, pos + 12);
+        const size_t minBytes = readLe<uint32_t>(data, pos + 16);
+        const size_t maxBytes = readLe<uint32_t>(data, pos + 20);
+        const size_t blockCount = readLe<uint32_t>(data, pos + 24);
+        const auto flags = readLe<uint32_t>(data, pos + 28);
+        column.nullCount = readLe<uint64_t>(data, pos + 32);
+        entry.dataBytes = readLe<uint64_t>(data, pos + 40);
+        pos += COLUMN_FIXED_BYTES;
+
+        const size_t textBytes = nameBytes + typeBytes + minBytes + maxBytes;
+        if (textBytes > data.size() - pos || alignUp(pos + textBytes) + blockCount * BLOCK_ENTRY_BYTES > data.size()) [[unlikely]] {
+            corrupt(filepath);
+        }
+        column.info.name = data.substr(pos, nameBytes);
+        column.info.type = data.substr(pos + nameBytes, typeBytes);
+        if (flags & FLAG_HAS_RANGE) {
+            column.min = std::string(data.substr(pos + nameBytes + typeBytes, minBytes));
+            column.max = std::string(data.substr(pos + nameBytes + typeBytes + minBytes, maxBytes));
+        }
+        pos = alignUp(pos + textBytes);
+        entry.blocks = data.substr(pos, blockCount * BLOCK_ENTRY_BYTES);
+        pos += entry.blocks.size();
+        info.columns.push_back(column);
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+}  // namespace
+
+SnapshotInfo ResultSnapshot::save(const ResultSet& result, const std::string& filepath) {
+    const size_t rows = result.rowCount();
+    const size_t columnCount = result.columns.size();
+    SnapshotInfo info{.rowCount = rows, .truncated = result.truncated};
+    info.createdAt = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    info.columns.resize(columnCount);
+
+    // Column metadata can outnumber storage for empty results (e.g. zero-row SELECT)
+    const ColumnData emptyText;
+    std::vector<EncodedColumn> encoded(columnCount);
+    forEachColumn(columnCount, [&](size_t col) {
+        const auto& data = col < result.columnData.size() ? result.columnData[col] : emptyText;
+        info.columns[col].info = result.columns[col];
+        info.columns[col].storage = data.type();
+        collectStats(data, info.columns[col]);
+        encoded[col] = encodeColumn(data, rows);
+    });
+
+    std::string directory(MAGIC);
+    appendLe(directory, VERSION);
+    appendLe(directory, result.truncated ? FLAG_TRUNCATED : uint16_t{0});
+    appendLe(directory, static_cast<uint32_t>(columnCount));
+    appendLe(directory, uint32_t{0});
+    appendLe(directory, static_cast<uint64_t>(rows));
+    appendLe(directory, static_cast<int64_t>(info.createdAt));
+
+    // Block offsets are only known once the directory's size is: lay it out with zeroed entries, then fill them in
+    std::vector<size_t> blockTables(columnCount);
+    for (size_t col = 0; col < columnCount; ++col) {
+        const auto& column = info.columns[col];
+        const auto& data = encoded[col];
+        const std::string_view min = column.min ? std::string_view(*column.min) : std::string_view{};
+        const std::string_view max = column.max ? std::string_view(*column.max) : std::string_view{};
+        appendLe(directory, static_cast<uint8_t>(column.storage));
+        appendLe(directory, data.fractionDigits);
+        appendLe(directory, static_cast<uint8_t>(column.info.nullable));
+        appendLe(directory, static_cast<uint8_t>(column.info.isPrimaryKey));
+        appendLe(directory, static_cast<int32_t>(column.info.size));
+        appendLe(directory, static_cast<uint32_t>(column.info.name.size()));
+        appendLe(directory, static_cast<uint32_t>(column.info.type.size()));
+        appendLe(directory, static_cast<uint32_t>(min.size()));
+        appendLe(directory, static_cast<uint32_t>(max.size()));
+        appendLe(directory, static_cast<uint32_t>(data.blocks.size()));
+        appendLe(directory, column.min ? FLAG_HAS_RANGE : uint32_t{0});
+        appendLe(directory, static_cast<uint64_t>(column.nullCount));
+        appendLe(directory, data.dataBytes);
+        directory.append(column.info.name);
+        directory.append(column.info.type);
+        directory.append(min);
+        directory.append(max);
+        directory.append(alignUp(directory.size()) - directory.size(), '\0');
+        blockTables[col] = directory.size();
+        directory.append(data.blocks.size() * BLOCK_ENTRY_BYTES, '\0');
+    }
+    uint64_t offset = directory.size();
+    for (size_t col = 0; col < columnCount; ++col) {
+        for (size_t block = 0; block < encoded[col].blocks.size(); ++block) {
+            const auto [rawBytes, storedBytes] = encoded[col].blocks[block];
+            char* entry = directory.data() + blockTables[col] + block * BLOCK_ENTRY_BYTES;
+            std::memcpy(entry, &offset, 8);
+            std::memcpy(entry + 8, &rawBytes, 4);
+            std::memcpy(entry + 12, &storedBytes, 4);
+            offset += storedBytes;
+        }
+    }
+
+    const auto tempPath = filepath + ".tmp";
+    std::error_code ec;
+    {
+        BufferedFileWriter writer;
+        if (!writer.open(tempPath)) [[unlikely]] {
+            throw std::runtime_error(std::format("Cannot create {}", filepath));
+        }
+        writer.append(directory);
+        for (auto& column : encoded) {
+            writer.append(column.stored);
+            column.stored = {};
+        }
+        if (!writer.close()) [[unlikely]] {
+            std::filesystem::remove(utf8Path(tempPath), ec);
+            throw std::runtime_error(std::format("Writing {} failed", filepath));
+        }
+    }
+    std::filesystem::rename(utf8Path(tempPath), utf8Path(filepath), ec);
+    if (ec) [[unlikely]] {
+        std::filesystem::remove(utf8Path(tempPath), ec);
+        throw std::runtime_error(std::format("Cannot replace {}", filepath));
+    }
+    info.fileBytes = offset;
+    return info;
+}
+
+SnapshotInfo ResultSnapshot::inspect(const std::string& filepath) {
+    MappedFile file;
+    if (!file.open(filepath)) [[unlikely]] {
+        throw std::runtime_error(std::format("Cannot open {}", filepath));
+    }
+    SnapshotInfo info;
+    (void)readDirectory(file.view(), filepath, info);
+    return info;
+}
+
+ResultSet ResultSnapshot::load(const std::string& filepath) {
+    MappedFile file;
+    if (!file.open(filepath)) [[unlikely]] {
+        throw std::runtime_error(std::format("Cannot open {}", filepath));
+    }
+    const auto data = file.view();
+    SnapshotInfo info;
+    auto entries = readDirectory(data, filepath, info);
+
+    ResultSet result;
+    result.truncated = info.truncated;
+    result.columns.reserve(entries.size());
+    for (const auto& entry : entries) {
+        result.columns.push_back(entry.column.info);
+    }
+    result.columnData.resize(entries.size());
+    forEachColumn(entries.size(), [&](size_t col) {
+        const auto& entry = entries[col];
+        std::string body(entry.dataBytes, '\0');
+        size_t written = 0;
+        for (size_t pos = 0; pos < entry.blocks.size(); pos += BLOCK_ENTRY_BYTES) {
+            const auto offset = readLe<uint64_t>(entry.blocks, pos);
+            const size_t rawBytes = readLe<uint32_t>(entry.blocks, pos + 8);
+            const size_t storedBytes = readLe<uint32_t>(entry.blocks, pos + 12);
+            if (offset > data.size() || storedBytes > data.size() - offset || rawBytes > body.size() - written) [[unlikely]] {
+                corrupt(filepath);
+            }
+            const auto stored = data.substr(offset, storedBytes);
+            if (storedBytes == rawBytes) {
+                std::memcpy(body.data() + written, stored.data(), rawBytes);
+            } else if (!Lz4Codec::decompress(stored, body.data() + written, rawBytes)) [[unlikely]] {
+                corrupt(filepath);
+            }
+            written += rawBytes;
+        }
+        if (written != body.size()) [[unlikely]] {
+            corrupt(filepath);
+        }
+        result.columnData[col] = BinaryResultDecoder::decodeColumn(body, entry.column.storage, entry.fractionDigits, info.rowCount);
+    });
+    return result;
+}
+
+}  // namespace velocitydb
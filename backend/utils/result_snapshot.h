@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Schema and statistics of one snapshot column, readable without decoding its data
+struct SnapshotColumn {
+    ColumnInfo info;
+    ColumnDataType storage = ColumnDataType::Text;
+    size_t nullCount = 0;
+    std::optional<std::string> min;  ///< Display text of the smallest non-NULL value (absent when all NULL, or text too long to keep)
+    std::optional<std::string> max;
+};
+
+struct SnapshotInfo {
+    std::vector<SnapshotColumn> columns;
+    size_t rowCount = 0;
+    bool truncated = false;
+    int64_t createdAt = 0;  ///< Unix seconds
+    size_t fileBytes = 0;
+};
+
+/// A fetched result saved to a file (.vdbr) that reopens as a result without the query.
+///
+/// Columnar and memory-mapped: a short directory describes every column (schema, NULL count, min/max and where its
+/// blocks are), so inspect() reads the schema and statistics of any size of snapshot without touching the data.
+/// Each column's data is the BinaryResultEncoder column layout, cut into BLOCK_BYTES blocks that are LZ4-compressed
+/// unless that does not shrink them. Columns are encoded and decoded on separate threads.
+///
+/// Layout (little-endian, sections 8-byte aligned):
+///   header     "VDBF" u16 version, u16 flags (bit 0: truncated), u32 columnCount, u32 reserved, u64 rowCount,
+///              i64 createdAt (unix seconds)
+///   columns[]  u8 storageType, u8 fractionDigits, u8 nullable, u8 isPrimaryKey, i32 size, u32 nameBytes,
+///              u32 typeBytes, u32 minBytes, u32 maxBytes, u32 blockCount, u32 flags (bit 0: has min/max),
+///              u64 nullCount, u64 dataBytes, name, type, min, max (display text), padding,
+///              blocks[] u64 fileOffset, u32 rawBytes, u32 storedBytes (stored == raw: not compressed)
+///   data       every column's blocks, back to back
+class ResultSnapshot {
+public:
+    static constexpr std::string_view EXTENSION = ".vdbr";
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_BYTES = 32;
+    static constexpr size_t BLOCK_BYTES = 1024 * 1024;
+    /// Text min/max longer than this is not kept
+    static constexpr size_t MAX_STAT_TEXT_BYTES = 256;
+
+    /// Write `result` to the file at a UTF-8 path, through a temporary file renamed over it
+    /// @throws std::runtime_error when the file cannot be written
+    /// @throws std::length_error if a text column exceeds the 4 GB offset range
+    static SnapshotInfo save(const ResultSet& result, const std::string& filepath);
+
+    /// Schema and statistics only
+    /// @throws std::runtime_error when the file cannot be mapped or is not a snapshot
+    [[nodiscard]] static SnapshotInfo inspect(const std::string& filepath);
+
+    /// The whole result
+    /// @throws std::runtime_error when the file cannot be mapped, is not a snapshot or is corrupt
+    [[nodiscard]] static ResultSet load(const std::string& filepath);
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,64 @@
+#include "row_key.h"
+
+#include <cstdint>
+
+namespace velocitydb {
+
+void appendRowKey(std::string& key, const ResultSet& batch, std::span<const size_t> columns, size_t row, const std::vector<bool>& asText) {
+    auto appendBytes = [&](const auto& value) { key.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    auto appendText = [&](std::string_view text) {
+        appendBytes(static_cast<uint64_t>(text.size()));
+        key.append(text);
+    };
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const auto& column = batch.columnData[columns[i]];
+        if (column.isNull(row)) {
+            key.push_back('\0');
+            continue;
+        }
+        key.push_back('\1');
+        if (i < asText.size() && asText[i]) {
+            appendText(column.displayText(row));
+            continue;
+        }
+        switch (column.type()) {
+            case ColumnDataType::Int64:
+            case ColumnDataType::Bit:
+                appendBytes(column.int64At(row));
+                break;
+            case ColumnDataType::Double:
+                appendBytes(column.doubleAt(row) == 0.0 ? 0.0 : column.doubleAt(row));  // -0.0 matches 0.0
+                break;
+            case ColumnDataType::Date:
+            case ColumnDataType::Time:
+            case ColumnDataType::Timestamp: {
+                const auto& value = column.dateTimeAt(row);
+                appendBytes(value.year);
+                key.push_back(static_cast<char>(value.month));
+                key.push_back(static_cast<char>(value.day));
+                key.push_back(static_cast<char>(value.hour));
+                key.push_back(static_cast<char>(value.minute));
+                key.push_back(static_cast<char>(value.second));
+                appendBytes(value.fraction);
+                break;
+            }
+            case ColumnDataType::Text:
+            case ColumnDataType::Binary:
+                appendText(column.textAt(row));
+                break;
+        }
+    }
+}
+
+std::string describeRowKey(const ResultSet& batch, std::span<const size_t> columns, size_t row) {
+    std::string text;
+    for (size_t columnIndex : columns) {
+        if (!text.empty()) {
+            text += ", ";
+        }
+        text += batch.isNull(row, columnIndex) ? "NULL" : batch.cellText(row, columnIndex);
+    }
+    return text;
+}
+
+}  // namespace velocitydb
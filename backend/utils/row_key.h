@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../database/result_set.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+
+/// Append the key of `row` to `key`: per column a NULL marker, then a fixed-width or length-prefixed value, so equal
+/// keys encode to equal bytes and encoded keys hash and compare as strings. Key column `i` flagged in `asText` is
+/// encoded by its display text instead, for a key fetched as different storage types on two sides.
+void appendRowKey(std::string& key, const ResultSet& batch, std::span<const size_t> columns, size_t row, const std::vector<bool>& asText = {});
+
+/// The key cells of `row` as "a, b" text for messages (NULL spelled out)
+[[nodiscard]] std::string describeRowKey(const ResultSet& batch, std::span<const size_t> columns, size_t row);
+
+}  // namespace velocitydb
@@ -0,0 +1,68 @@
+#include "scratch_arena.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+namespace velocitydb {
+
+namespace {
+
+struct ThreadBlock {
+    std::unique_ptr<std::byte[]> data;
+    size_t size = 0;
+    bool leased = false;
+};
+
+ThreadBlock& threadBlock() {
+    thread_local ThreadBlock block;
+    return block;
+}
+
+/// The calling thread's block, allocated on first use; nullptr when it is already leased
+ThreadBlock* claimBlock() {
+    auto& block = threadBlock();
+    if (block.leased) {
+        return nullptr;
+    }
+    if (!block.data) {
+        block.data = std::make_unique_for_overwrite<std::byte[]>(ScratchArena::INITIAL_BYTES);
+        block.size = ScratchArena::INITIAL_BYTES;
+    }
+    block.leased = true;
+    return &block;
+}
+
+}  // namespace
+
+ScratchArena::Lease::Lease() : m_owner(claimBlock() != nullptr), m_arena(m_owner ? threadBlock().data.get() : nullptr, m_owner ? threadBlock().size : 0, &m_overflow) {}
+
+ScratchArena::Lease::~Lease() {
+    m_arena.release();
+    if (!m_owner) {
+        return;
+    }
+    auto& block = threadBlock();
+    block.leased = false;
+    if (m_overflow.bytes > 0 && block.size < MAX_RETAINED_BYTES) {
+        // Sized for the lease that just ended, so a similar query fits entirely next time
+        const size_t wanted = (std::min)(block.size + m_overflow.bytes, MAX_RETAINED_BYTES);
+        block.data = std::make_unique_for_overwrite<std::byte[]>(wanted);
+        block.size = wanted;
+    }
+}
+
+void* ScratchArena::Lease::Overflow::do_allocate(size_t size, size_t alignment) {
+    bytes += size;
+    return ::operator new(size, std::align_val_t{alignment});
+}
+
+void ScratchArena::Lease::Overflow::do_deallocate(void* pointer, size_t size, size_t alignment) {
+    ::operator delete(pointer, size, std::align_val_t{alignment});
+}
+
+size_t ScratchArena::retainedBytes() noexcept {
+    return threadBlock().size;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace velocitydb {
+
+/// Per-thread memory for the transient buffers of one query execution (bound rowsets, row status arrays,
+/// SQLGetData chunks).
+///
+/// A Lease is a std::pmr::monotonic_buffer_resource laid over a block its thread keeps between leases: everything
+/// allocated from it goes in one step when the lease ends, and the next query on the thread finds the memory
+/// already mapped instead of faulting in fresh pages. What does not fit in the block comes from the heap and makes
+/// the block grow to that size for the next lease, up to MAX_RETAINED_BYTES. Each thread has its own block, so
+/// concurrent queries never share an allocator.
+///
+/// Nothing a lease hands out may outlive it; results that are kept use the heap as before.
+class ScratchArena {
+public:
+    static constexpr size_t INITIAL_BYTES = 64 * 1024;
+    static constexpr size_t MAX_RETAINED_BYTES = 16 * 1024 * 1024;
+
+    class Lease {
+    public:
+        /// The thread's block, or a heap-only arena when a lease is already active on this thread
+        Lease();
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        [[nodiscard]] std::pmr::memory_resource* resource() noexcept { return &m_arena; }
+
+    private:
+        /// Heap fallback that remembers how much the block was short by
+        class Overflow final : public std::pmr::memory_resource {
+        public:
+            size_t bytes = 0;
+
+        private:
+            void* do_allocate(size_t size, size_t alignment) override;
+            void do_deallocate(void* pointer, size_t size, size_t alignment) override;
+            [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+        };
+
+        bool m_owner;  ///< Holds the thread's block (not a nested lease)
+        Overflow m_overflow;
+        std::pmr::monotonic_buffer_resource m_arena;  // after m_overflow, its upstream
+    };
+
+    /// Bytes the calling thread keeps for its next lease
+    [[nodiscard]] static size_t retainedBytes() noexcept;
+};
+
+}  // namespace velocitydb
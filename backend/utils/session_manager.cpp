@@ -1,14 +1,19 @@
 #include "session_manager.h"
 
+#include "debounced_file_writer.h"
 #include "glaze_meta.h"
 #include "logger.h"
 
 #include <Windows.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <format>
 #include <fstream>
+#include <iterator>
 #include <sstream>
+#include <utility>
 
 #include <ShlObj.h>
 
@@ -24,10 +29,16 @@ SessionManager::SessionManager() {
         m_sessionPath = std::filesystem::current_path() / ".velocitydb";
     }
 
-    std::filesystem::create_directories(m_sessionPath);
+    m_tabsPath = m_sessionPath / "session_tabs";
+    std::filesystem::create_directories(m_tabsPath);
     m_sessionPath /= "session.json";
+
+    m_writer = std::make_unique<DebouncedFileWriter>(
+        m_sessionPath, [this] { return serializeIndex(); }, DebouncedFileWriter::DEFAULT_DEBOUNCE, DebouncedFileWriter::DEFAULT_MAX_DELAY, [this] { collectGarbage(); });
 }
 
+SessionManager::~SessionManager() = default;
+
 bool SessionManager::load() {
     std::lock_guard lock(m_mutex);
 
@@ -42,53 +53,111 @@ bool SessionManager::load() {
 
     std::stringstream buffer;
     buffer << file.rdbuf();
-    return deserializeSession(buffer.str());
+    if (!deserializeSession(buffer.str())) {
+        return false;
+    }
+
+    // Index entries name their content file; a session.json from before the split still has the contents inline
+    for (auto& tab : m_state.openTabs) {
+        refreshContentHash(tab, nullptr);
+    }
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_tabsPath, ec)) {
+        if (entry.path().extension() == ".sql") {
+            m_storedContents.insert(entry.path().stem().string());
+        }
+    }
+    return true;
 }
 
 bool SessionManager::save() {
-    std::lock_guard lock(m_mutex);
+    m_writer->schedule();
+    return true;
+}
 
-    m_state.lastSaved = std::chrono::system_clock::now();
+bool SessionManager::flush() {
+    return m_writer->flush();
+}
 
-    auto json = serializeSession();
-    if (json.empty()) {
-        return false;  // Serialization failed — preserve existing file
+void SessionManager::touch() {
+    if (m_autoSaveEnabled) {
+        m_writer->markDirty();
     }
-
-    std::ofstream file(m_sessionPath);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    file << json;
-    return file.good();
 }
 
 void SessionManager::updateState(const SessionState& state) {
     std::lock_guard lock(m_mutex);
+    auto previousTabs = std::move(m_state.openTabs);
     m_state = state;
+    for (auto& tab : m_state.openTabs) {
+        auto previous = std::ranges::find(previousTabs, tab.id, &EditorTab::id);
+        refreshContentHash(tab, previous == previousTabs.end() ? nullptr : &*previous);
+    }
+    touch();
 }
 
 void SessionManager::addTab(const EditorTab& tab) {
     std::lock_guard lock(m_mutex);
-    m_state.openTabs.push_back(tab);
+    refreshContentHash(m_state.openTabs.emplace_back(tab), nullptr);
+    touch();
 }
 
 void SessionManager::updateTab(const EditorTab& tab) {
     std::lock_guard lock(m_mutex);
     if (auto it = std::ranges::find(m_state.openTabs, tab.id, &EditorTab::id); it != m_state.openTabs.end()) {
-        *it = tab;
+        auto previous = std::exchange(*it, tab);
+        refreshContentHash(*it, &previous);
+        touch();
     }
 }
 
 void SessionManager::removeTab(const std::string& tabId) {
     std::lock_guard lock(m_mutex);
     std::erase_if(m_state.openTabs, [&tabId](const EditorTab& t) { return t.id == tabId; });
+    touch();
 }
 
 void SessionManager::setActiveTab(const std::string& tabId) {
     std::lock_guard lock(m_mutex);
     m_state.activeTabId = tabId;
+    touch();
+}
+
+std::optional<std::string> SessionManager::loadTabContent(const std::string& tabId) {
+    std::string hash;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = std::ranges::find(m_state.openTabs, tabId, &EditorTab::id);
+        if (it == m_state.openTabs.end()) [[unlikely]] {
+            return std::nullopt;
+        }
+        if (it->contentLoaded) {
+            return it->content;
+        }
+        hash = it->contentHash;
+    }
+
+    // Read outside the lock; the tab may have been edited or closed meanwhile
+    std::ifstream file(contentPath(hash), std::ios::binary);
+    if (!file.is_open()) [[unlikely]] {
+        log<LogLevel::WARNING>(std::format("Missing content file of session tab {}", tabId));
+        return std::nullopt;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::lock_guard lock(m_mutex);
+    auto it = std::ranges::find(m_state.openTabs, tabId, &EditorTab::id);
+    if (it == m_state.openTabs.end()) {
+        return content;
+    }
+    if (it->contentLoaded) {
+        return it->content;
+    }
+    if (it->contentHash == hash) {
+        it->content = content;
+        it->contentLoaded = true;
+    }
+    return content;
 }
 
 void SessionManager::updateWindowState(int x, int y, int width, int height, bool maximized) {
@@ -98,40 +167,150 @@ void SessionManager::updateWindowState(int x, int y, int width, int height, bool
     m_state.windowWidth = width;
     m_state.windowHeight = height;
     m_state.isMaximized = maximized;
+    touch();
 }
 
 void SessionManager::updatePanelSizes(int leftWidth, int bottomHeight) {
     std::lock_guard lock(m_mutex);
     m_state.leftPanelWidth = leftWidth;
     m_state.bottomPanelHeight = bottomHeight;
+    touch();
 }
 
 void SessionManager::setActiveConnection(const std::string& connectionId) {
     std::lock_guard lock(m_mutex);
     m_state.activeConnectionId = connectionId;
+    touch();
 }
 
 void SessionManager::setExpandedNodes(const std::vector<std::string>& nodeIds) {
     std::lock_guard lock(m_mutex);
     m_state.expandedTreeNodes = nodeIds;
+    touch();
+}
+
+std::vector<std::string> SessionManager::getExpandedNodes() const {
+    std::lock_guard lock(m_mutex);
+    return m_state.expandedTreeNodes;
 }
 
 void SessionManager::enableAutoSave(int intervalSeconds) {
-    m_autoSaveEnabled = true;
-    m_autoSaveInterval = intervalSeconds;
+    const int interval = (std::max)(intervalSeconds, 1);
+    {
+        std::lock_guard lock(m_mutex);
+        m_autoSaveEnabled = true;
+        m_autoSaveInterval = interval;
+    }
+    m_writer->setPeriod(std::chrono::seconds(interval));
 }
 
 void SessionManager::disableAutoSave() {
-    m_autoSaveEnabled = false;
+    {
+        std::lock_guard lock(m_mutex);
+        m_autoSaveEnabled = false;
+    }
+    m_writer->setPeriod(std::chrono::milliseconds{0});
 }
 
 std::filesystem::path SessionManager::getSessionPath() const {
     return m_sessionPath;
 }
 
-std::string SessionManager::serializeSession() const {
+std::string SessionManager::contentHash(std::string_view content) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return std::format("{:016x}", hash);
+}
+
+std::filesystem::path SessionManager::contentPath(std::string_view hash) const {
+    return m_tabsPath / std::format("{}.sql", hash);
+}
+
+void SessionManager::refreshContentHash(EditorTab& tab, const EditorTab* previous) {
+    if (!tab.contentLoaded) {
+        return;  // Still the stored content
+    }
+    if (previous && previous->contentLoaded && previous->content == tab.content) {
+        tab.contentHash = previous->contentHash;
+        return;
+    }
+    tab.contentHash = tab.content.empty() ? std::string() : contentHash(tab.content);
+}
+
+std::string SessionManager::serializeIndex() {
+    SessionState index;
+    std::vector<std::pair<std::string, std::string>> unstored;  // hash, content
+    {
+        std::lock_guard lock(m_mutex);
+        m_state.lastSaved = std::chrono::system_clock::now();
+        // Copy everything but the tab contents; only those not on disk yet are copied, to be written below
+        auto tabs = std::move(m_state.openTabs);
+        index = m_state;
+        m_state.openTabs = std::move(tabs);
+        index.openTabs.reserve(m_state.openTabs.size());
+        for (const auto& tab : m_state.openTabs) {
+            index.openTabs.push_back(EditorTab{.id = tab.id,
+                                               .title = tab.title,
+                                               .filePath = tab.filePath,
+                                               .isDirty = tab.isDirty,
+                                               .cursorLine = tab.cursorLine,
+                                               .cursorColumn = tab.cursorColumn,
+                                               .contentHash = tab.contentHash,
+                                               .contentLoaded = tab.contentHash.empty()});
+            if (tab.contentLoaded && !tab.contentHash.empty() && !m_storedContents.contains(tab.contentHash) &&
+                std::ranges::find(unstored, tab.contentHash, &std::pair<std::string, std::string>::first) == unstored.end()) {
+                unstored.emplace_back(tab.contentHash, tab.content);
+            }
+        }
+    }
+
+    // Contents first, so the index never names a file that is not there
+    for (const auto& [hash, content] : unstored) {
+        if (!DebouncedFileWriter::writeAtomically(contentPath(hash), content)) [[unlikely]] {
+            log<LogLevel::WARNING>(std::format("Could not save session tab content {}", hash));
+            return {};  // Keep the previous index; the next save tries again
+        }
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto& [hash, content] : unstored) {
+            m_storedContents.insert(std::move(hash));
+        }
+    }
+
+    m_pendingIndex.clear();
+    for (const auto& tab : index.openTabs) {
+        if (!tab.contentHash.empty()) {
+            m_pendingIndex.push_back(tab.contentHash);
+        }
+    }
+    return serializeSession(index);
+}
+
+void SessionManager::collectGarbage() {
+    std::vector<std::string> orphans;
+    {
+        std::lock_guard lock(m_mutex);
+        std::erase_if(m_storedContents, [&](const std::string& hash) {
+            const bool live = std::ranges::find(m_pendingIndex, hash) != m_pendingIndex.end() || std::ranges::find(m_state.openTabs, hash, &EditorTab::contentHash) != m_state.openTabs.end();
+            if (!live) {
+                orphans.push_back(hash);
+            }
+            return !live;
+        });
+    }
+    std::error_code ec;
+    for (const auto& hash : orphans) {
+        std::filesystem::remove(contentPath(hash), ec);
+    }
+}
+
+std::string SessionManager::serializeSession(const SessionState& state) {
     std::string buffer;
-    if (auto ec = glz::write<glz::opts{.prettify = true}>(m_state, buffer); bool(ec)) {
+    if (auto ec = glz::write<glz::opts{.prettify = true}>(state, buffer); bool(ec)) {
         log<LogLevel::WARNING>("Failed to serialize session state");
         return {};
     }
@@ -2,12 +2,18 @@
 
 #include <chrono>
 #include <filesystem>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 
 namespace velocitydb {
 
+class DebouncedFileWriter;
+
 struct EditorTab {
     std::string id;
     std::string title;
@@ -16,6 +22,8 @@ struct EditorTab {
     bool isDirty = false;
     int cursorLine = 1;
     int cursorColumn = 1;
+    std::string contentHash;    ///< Names the file holding `content`; empty for an empty tab
+    bool contentLoaded = true;  ///< False for a restored tab until SessionManager::loadTabContent()
 };
 
 struct SessionState {
@@ -37,10 +45,13 @@ struct SessionState {
     [[nodiscard]] int64_t writeLastSavedEpoch() const { return std::chrono::duration_cast<std::chrono::seconds>(lastSaved.time_since_epoch()).count(); }
 };
 
+/// Persists the editor session as a small index (session.json: layout and tab metadata) plus one file per tab
+/// content, named by its hash and written only when that content changes. Restored tabs come back without their
+/// content, which loadTabContent() reads when the tab is first shown.
 class SessionManager {
 public:
     SessionManager();
-    ~SessionManager() = default;
+    ~SessionManager();
 
     SessionManager(const SessionManager&) = delete;
     SessionManager& operator=(const SessionManager&) = delete;
@@ -48,9 +59,12 @@ public:
     /// Load session state from disk
     bool load();
 
-    /// Save session state to disk
+    /// Queue a save; rapid calls are coalesced and written in the background
     bool save();
 
+    /// Write any queued or auto-saved change now
+    bool flush();
+
     /// Get current session state
     [[nodiscard]] const SessionState& getState() const { return m_state; }
 
@@ -62,6 +76,9 @@ public:
     void updateTab(const EditorTab& tab);
     void removeTab(const std::string& tabId);
     void setActiveTab(const std::string& tabId);
+    /// Content of `tabId`, read from its file if the tab was restored without it; nullopt for an unknown tab or
+    /// a missing file
+    [[nodiscard]] std::optional<std::string> loadTabContent(const std::string& tabId);
 
     /// Window state
     void updateWindowState(int x, int y, int width, int height, bool maximized);
@@ -72,23 +89,41 @@ public:
 
     /// Tree state
     void setExpandedNodes(const std::vector<std::string>& nodeIds);
+    [[nodiscard]] std::vector<std::string> getExpandedNodes() const;
 
-    /// Auto-save support
+    /// Auto-save: every change is written within `intervalSeconds`, without an explicit save()
     void enableAutoSave(int intervalSeconds = 30);
     void disableAutoSave();
 
     /// Get session file path
     [[nodiscard]] std::filesystem::path getSessionPath() const;
 
+    /// 64-bit FNV-1a of a tab's content, as 16 hex digits
+    [[nodiscard]] static std::string contentHash(std::string_view content);
+
 private:
-    [[nodiscard]] std::string serializeSession() const;
+    /// Write the tab contents not stored yet, then return the index (writer thread)
+    [[nodiscard]] std::string serializeIndex();
+    /// Remove content files neither the index just written nor the current state refers to (writer thread)
+    void collectGarbage();
+    [[nodiscard]] static std::string serializeSession(const SessionState& state);
     bool deserializeSession(std::string_view json);
+    /// Bring `tab.contentHash` up to date, reusing `previous`'s when the content is unchanged
+    static void refreshContentHash(EditorTab& tab, const EditorTab* previous);
+    [[nodiscard]] std::filesystem::path contentPath(std::string_view hash) const;
+    /// Record a change for auto-save. Caller holds m_mutex.
+    void touch();
 
     SessionState m_state;
     std::filesystem::path m_sessionPath;
+    std::filesystem::path m_tabsPath;
     mutable std::mutex m_mutex;
+    std::unordered_set<std::string> m_storedContents;  ///< Hashes with a content file; guarded by m_mutex
+    std::vector<std::string> m_pendingIndex;           ///< Hashes of the index being written; writer thread only
+
     bool m_autoSaveEnabled = false;
     int m_autoSaveInterval = 30;
+    std::unique_ptr<DebouncedFileWriter> m_writer;  // Last: its final write reads the state above
 };
 
 }  // namespace velocitydb
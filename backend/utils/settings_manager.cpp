@@ -1,6 +1,7 @@
 #include "settings_manager.h"
 
 #include "credential_protector.h"
+#include "debounced_file_writer.h"
 #include "glaze_meta.h"
 #include "logger.h"
 
@@ -29,19 +30,22 @@ SettingsManager::SettingsManager() {
     // Ensure directory exists
     std::filesystem::create_directories(m_settingsPath);
     m_settingsPath /= "settings.json";
+
+    m_writer = std::make_unique<DebouncedFileWriter>(m_settingsPath, [this] {
+        std::lock_guard lock(m_mutex);
+        return serializeSettings();
+    });
 }
 
+SettingsManager::~SettingsManager() = default;
+
 bool SettingsManager::load() {
     std::lock_guard lock(m_mutex);
 
     if (!std::filesystem::exists(m_settingsPath)) {
-        // Create default settings file (without lock - saveInternal handles it)
-        std::ofstream file(m_settingsPath);
-        if (!file.is_open()) {
-            return false;
-        }
-        file << serializeSettings();
-        return file.good();
+        // Create default settings file
+        auto json = serializeSettings();
+        return !json.empty() && DebouncedFileWriter::writeAtomically(m_settingsPath, json);
     }
 
     std::ifstream file(m_settingsPath);
@@ -55,25 +59,18 @@ bool SettingsManager::load() {
 }
 
 bool SettingsManager::save() {
-    std::lock_guard lock(m_mutex);
-
-    auto json = serializeSettings();
-    if (json.empty()) {
-        return false;  // Serialization failed — preserve existing file
-    }
-
-    std::ofstream file(m_settingsPath);
-    if (!file.is_open()) {
-        return false;
-    }
+    m_writer->schedule();
+    return true;
+}
 
-    file << json;
-    return file.good();
+bool SettingsManager::flush() {
+    return m_writer->flush();
 }
 
 void SettingsManager::updateSettings(const AppSettings& settings) {
     std::lock_guard lock(m_mutex);
     m_settings = settings;
+    CredentialProtector::clearCache();
 }
 
 void SettingsManager::addConnectionProfile(const ConnectionProfile& profile) {
@@ -85,12 +82,15 @@ void SettingsManager::updateConnectionProfile(const ConnectionProfile& profile)
     std::lock_guard lock(m_mutex);
     if (auto it = std::ranges::find(m_settings.connectionProfiles, profile.id, &ConnectionProfile::id); it != m_settings.connectionProfiles.end()) {
         *it = profile;
+        CredentialProtector::clearCache();  // The replaced ciphertexts must not stay decryptable from memory
     }
 }
 
 void SettingsManager::removeConnectionProfile(const std::string& id) {
     std::lock_guard lock(m_mutex);
-    std::erase_if(m_settings.connectionProfiles, [&id](const ConnectionProfile& p) { return p.id == id; });
+    if (std::erase_if(m_settings.connectionProfiles, [&id](const ConnectionProfile& p) { return p.id == id; }) > 0) {
+        CredentialProtector::clearCache();
+    }
 }
 
 std::optional<ConnectionProfile> SettingsManager::getConnectionProfile(const std::string& id) const {
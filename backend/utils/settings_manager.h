@@ -2,6 +2,7 @@
 
 #include <expected>
 #include <filesystem>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -11,6 +12,8 @@
 
 namespace velocitydb {
 
+class DebouncedFileWriter;
+
 using SettingValue = std::variant<bool, int, double, std::string>;
 
 enum class SshAuthType { Password, PrivateKey };
@@ -26,6 +29,15 @@ struct SshConfig {
     std::string encryptedKeyPassphrase;  // For encrypted private keys
 };
 
+/// SQL Server network settings sent with the profile's connect (see OdbcTuningParams)
+struct ConnectionTuning {
+    int packetSize = 0;  // TDS packet size in bytes (0 = driver default)
+    bool mars = false;
+    bool multiSubnetFailover = false;
+    bool readOnlyIntent = false;
+    bool readRouting = false;
+};
+
 struct ConnectionProfile {
     std::string id;
     std::string name;
@@ -41,6 +53,7 @@ struct ConnectionProfile {
     std::string environment = "development";  // development, staging, production
     std::string dbType = "sqlserver";         // sqlserver, postgresql, mysql
     SshConfig ssh;                            // SSH tunnel configuration
+    ConnectionTuning tuning;                  // SQL Server network tuning
 };
 
 struct EditorSettings {
@@ -90,7 +103,7 @@ struct AppSettings {
 class SettingsManager {
 public:
     SettingsManager();
-    ~SettingsManager() = default;
+    ~SettingsManager();
 
     SettingsManager(const SettingsManager&) = delete;
     SettingsManager& operator=(const SettingsManager&) = delete;
@@ -98,9 +111,12 @@ public:
     /// Load settings from disk
     bool load();
 
-    /// Save settings to disk
+    /// Queue a save; rapid calls are coalesced and written in the background
     bool save();
 
+    /// Write any queued change now
+    bool flush();
+
     /// Get current settings
     [[nodiscard]] const AppSettings& getSettings() const { return m_settings; }
 
@@ -149,6 +165,7 @@ private:
     AppSettings m_settings;
     std::filesystem::path m_settingsPath;
     mutable std::mutex m_mutex;
+    std::unique_ptr<DebouncedFileWriter> m_writer;  // Last: its final write reads the settings above
 };
 
 }  // namespace velocitydb
@@ -1,10 +1,19 @@
 #include "simd_filter.h"
 
+#include "cpu_features.h"
+
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
 #include <cstring>
+#include <execution>
+#include <limits>
 #include <numeric>
+#include <utility>
 
-#ifdef _MSC_VER
+#ifdef VELOCITYDB_SIMD_X86
 #include <immintrin.h>
 #endif
 
@@ -12,189 +21,1091 @@ namespace velocitydb {
 
 namespace {
 
-// AVX2-optimized string equality check for 32-byte aligned data
-#ifdef _MSC_VER
-[[nodiscard]] bool avx2StringEquals32(const char* a, const char* b) {
-    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
-    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
-    __m256i cmp = _mm256_cmpeq_epi8(va, vb);
-    return _mm256_movemask_epi8(cmp) == -1;  // All 32 bytes equal
+[[nodiscard]] bool parseDouble(std::string_view text, double& out) {
+    const char* last = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), last, out);
+    return ec == std::errc{} && ptr == last && !text.empty();
+}
+
+[[nodiscard]] bool parseInt64(std::string_view text, int64_t& out) {
+    const char* last = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), last, out);
+    return ec == std::errc{} && ptr == last && !text.empty();
+}
+
+[[nodiscard]] size_t maskWords(size_t rows) noexcept {
+    return (rows + 63) / 64;
+}
+
+void setBit(SIMDFilter::RowMask& mask, size_t row) noexcept {
+    mask[row >> 6] |= uint64_t{1} << (row & 63);
+}
+
+/// Clear the bits of NULL rows (and anything past `rows` in the last word)
+void clearNulls(SIMDFilter::RowMask& mask, const ColumnData& column) {
+    const auto nulls = column.nullWords();
+    for (size_t w = 0; w < mask.size() && w < nulls.size(); ++w) {
+        mask[w] &= ~nulls[w];
+    }
+    if (const size_t tail = column.size() & 63; tail != 0 && !mask.empty()) {
+        mask.back() &= (uint64_t{1} << tail) - 1;
+    }
 }
 
-// AVX2-optimized substring search using first character broadcast
-[[nodiscard]] size_t avx2FindFirstChar(const char* haystack, size_t haystackLen, char needle) {
-    if (haystackLen < 32) {
-        // Fall back to standard search for short strings
-        for (size_t i = 0; i < haystackLen; ++i) {
-            if (haystack[i] == needle)
-                return i;
+// ---------------------------------------------------------------------------------------------------------------
+// Substring search: first/last byte broadcast compare, full compare only for candidate positions
+
+constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+/// Next start >= `from` of `needle` in `hay`, or NOT_FOUND (needle is non-empty)
+[[nodiscard]] size_t findScalar(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    auto found = std::string_view(hay, hayLen).find(std::string_view(needle, needleLen), from);
+    return found == std::string_view::npos ? NOT_FOUND : found;
+}
+
+#ifdef VELOCITYDB_SIMD_X86
+VELOCITYDB_TARGET("sse4.2")
+size_t findSse(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+    size_t i = from;
+    for (; i + needleLen - 1 + 16 <= hayLen; i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + needleLen - 1));
+        auto bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+        while (bits != 0) {
+            const size_t pos = i + static_cast<size_t>(std::countr_zero(bits));
+            if (needleLen <= 2 || std::memcmp(hay + pos + 1, needle + 1, needleLen - 2) == 0) {
+                return pos;
+            }
+            bits &= bits - 1;
         }
-        return haystackLen;
     }
+    return i + needleLen <= hayLen ? findScalar(hay, hayLen, needle, needleLen, i) : NOT_FOUND;
+}
 
-    __m256i needleVec = _mm256_set1_epi8(needle);
-    size_t i = 0;
+VELOCITYDB_TARGET("avx2")
+size_t findAvx2(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+    size_t i = from;
+    for (; i + needleLen - 1 + 32 <= hayLen; i += 32) {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + needleLen - 1));
+        auto bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+        while (bits != 0) {
+            const size_t pos = i + static_cast<size_t>(std::countr_zero(bits));
+            if (needleLen <= 2 || std::memcmp(hay + pos + 1, needle + 1, needleLen - 2) == 0) {
+                return pos;
+            }
+            bits &= bits - 1;
+        }
+    }
+    return i + needleLen <= hayLen ? findSse(hay, hayLen, needle, needleLen, i) : NOT_FOUND;
+}
+
+VELOCITYDB_TARGET("avx512f,avx512bw")
+size_t findAvx512(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const __m512i first = _mm512_set1_epi8(needle[0]);
+    const __m512i last = _mm512_set1_epi8(needle[needleLen - 1]);
+    size_t i = from;
+    for (; i + needleLen - 1 + 64 <= hayLen; i += 64) {
+        const __m512i blockFirst = _mm512_loadu_si512(hay + i);
+        const __m512i blockLast = _mm512_loadu_si512(hay + i + needleLen - 1);
+        uint64_t bits = _mm512_cmpeq_epi8_mask(first, blockFirst) & _mm512_cmpeq_epi8_mask(last, blockLast);
+        while (bits != 0) {
+            const size_t pos = i + static_cast<size_t>(std::countr_zero(bits));
+            if (needleLen <= 2 || std::memcmp(hay + pos + 1, needle + 1, needleLen - 2) == 0) {
+                return pos;
+            }
+            bits &= bits - 1;
+        }
+    }
+    return i + needleLen <= hayLen ? findAvx2(hay, hayLen, needle, needleLen, i) : NOT_FOUND;
+}
+#endif
+
+// ASCII case-insensitive variants take a needle lower-cased by asciiLowered(). A haystack byte is OR-ed with
+// 0x20 before it is compared with a letter of the needle: that maps A-Z onto a-z and nothing else into a-z, so
+// the anchors stay exact and only the bytes between them need a folding compare.
+
+[[nodiscard]] std::string asciiLowered(std::string_view text) {
+    std::string lowered(text);
+    for (char& c : lowered) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c + ('a' - 'A'));
+        }
+    }
+    return lowered;
+}
+
+/// Bits to OR into a haystack byte before comparing it with the lower-cased needle byte `c`
+[[nodiscard]] constexpr char foldBits(char c) noexcept {
+    return c >= 'a' && c <= 'z' ? char{0x20} : char{0};
+}
 
-    // Process 32 bytes at a time
-    for (; i + 32 <= haystackLen; i += 32) {
-        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
-        __m256i cmp = _mm256_cmpeq_epi8(chunk, needleVec);
-        int mask = _mm256_movemask_epi8(cmp);
-        if (mask != 0) {
-            // Find position of first set bit
-            unsigned long pos;
-            _BitScanForward(&pos, static_cast<unsigned long>(mask));
-            return i + pos;
+[[nodiscard]] bool equalsFolded(const char* hay, const char* lowered, size_t len) noexcept {
+    for (size_t i = 0; i < len; ++i) {
+        if (static_cast<char>(hay[i] | foldBits(lowered[i])) != lowered[i]) {
+            return false;
         }
     }
+    return true;
+}
 
-    // Handle remaining bytes
-    for (; i < haystackLen; ++i) {
-        if (haystack[i] == needle)
+[[nodiscard]] size_t findFoldedScalar(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const char first = needle[0];
+    const char firstFold = foldBits(first);
+    const char last = needle[needleLen - 1];
+    const char lastFold = foldBits(last);
+    for (size_t i = from; i + needleLen <= hayLen; ++i) {
+        if (static_cast<char>(hay[i] | firstFold) == first && static_cast<char>(hay[i + needleLen - 1] | lastFold) == last &&
+            (needleLen <= 2 || equalsFolded(hay + i + 1, needle + 1, needleLen - 2))) {
             return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+#ifdef VELOCITYDB_SIMD_X86
+VELOCITYDB_TARGET("sse4.2")
+size_t findFoldedSse(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i firstFold = _mm_set1_epi8(foldBits(needle[0]));
+    const __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+    const __m128i lastFold = _mm_set1_epi8(foldBits(needle[needleLen - 1]));
+    size_t i = from;
+    for (; i + needleLen - 1 + 16 <= hayLen; i += 16) {
+        const __m128i blockFirst = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i)), firstFold);
+        const __m128i blockLast = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + needleLen - 1)), lastFold);
+        auto bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+        while (bits != 0) {
+            const size_t pos = i + static_cast<size_t>(std::countr_zero(bits));
+            if (needleLen <= 2 || equalsFolded(hay + pos + 1, needle + 1, needleLen - 2)) {
+                return pos;
+            }
+            bits &= bits - 1;
+        }
+    }
+    return i + needleLen <= hayLen ? findFoldedScalar(hay, hayLen, needle, needleLen, i) : NOT_FOUND;
+}
+
+VELOCITYDB_TARGET("avx2")
+size_t findFoldedAvx2(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i firstFold = _mm256_set1_epi8(foldBits(needle[0]));
+    const __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+    const __m256i lastFold = _mm256_set1_epi8(foldBits(needle[needleLen - 1]));
+    size_t i = from;
+    for (; i + needleLen - 1 + 32 <= hayLen; i += 32) {
+        const __m256i blockFirst = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i)), firstFold);
+        const __m256i blockLast = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + needleLen - 1)), lastFold);
+        auto bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+        while (bits != 0) {
+            const size_t pos = i + static_cast<size_t>(std::countr_zero(bits));
+            if (needleLen <= 2 || equalsFolded(hay + pos + 1, needle + 1, needleLen - 2)) {
+                return pos;
+            }
+            bits &= bits - 1;
+        }
     }
+    return i + needleLen <= hayLen ? findFoldedSse(hay, hayLen, needle, needleLen, i) : NOT_FOUND;
+}
 
-    return haystackLen;
+VELOCITYDB_TARGET("avx512f,avx512bw")
+size_t findFoldedAvx512(const char* hay, size_t hayLen, const char* needle, size_t needleLen, size_t from) noexcept {
+    const __m512i first = _mm512_set1_epi8(needle[0]);
+    const __m512i firstFold = _mm512_set1_epi8(foldBits(needle[0]));
+    const __m512i last = _mm512_set1_epi8(needle[needleLen - 1]);
+    const __m512i lastFold = _mm512_set1_epi8(foldBits(needle[needleLen - 1]));
+    size_t i = from;
+    for (; i + needleLen - 1 + 64 <= hayLen; i += 64) {
+        const __m512i blockFirst = _mm512_or_si512(_mm512_loadu_si512(hay + i), firstFold);
+        const __m512i blockLast = _mm512_or_si512(_mm512_loadu_si512(hay + i + needleLen - 1), lastFold);
+        uint64_t bits = _mm512_cmpeq_epi8_mask(first, blockFirst) & _mm512_cmpeq_epi8_mask(last, blockLast);
+        while (bits != 0) {
+            const size_t pos = i + static_cast<size_t>(std::countr_zero(bits));
+            if (needleLen <= 2 || equalsFolded(hay + pos + 1, needle + 1, needleLen - 2)) {
+                return pos;
+            }
+            bits &= bits - 1;
+        }
+    }
+    return i + needleLen <= hayLen ? findFoldedAvx2(hay, hayLen, needle, needleLen, i) : NOT_FOUND;
 }
 #endif
 
-}  // namespace
+using FindFn = size_t (*)(const char*, size_t, const char*, size_t, size_t) noexcept;
 
-bool SIMDFilter::isAVX2Available() {
-#ifdef _MSC_VER
-    int cpuInfo[4];
-    __cpuid(cpuInfo, 0);
-    int nIds = cpuInfo[0];
+/// Find kernel for `level`; `folded` picks the ASCII case-insensitive one
+[[nodiscard]] FindFn pickFind(SimdLevel level, bool folded = false) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    switch (level) {
+        case SimdLevel::AVX512:
+            return folded ? findFoldedAvx512 : findAvx512;
+        case SimdLevel::AVX2:
+            return folded ? findFoldedAvx2 : findAvx2;
+        case SimdLevel::SSE42:
+            return folded ? findFoldedSse : findSse;
+        case SimdLevel::Scalar:
+            break;
+    }
+#endif
+    (void)level;
+    return folded ? findFoldedScalar : findScalar;
+}
+
+/// Whether `cell` contains `needle` (lower-cased when `find` is a folded kernel)
+[[nodiscard]] bool cellContains(std::string_view cell, std::string_view needle, FindFn find) noexcept {
+    return needle.empty() || find(cell.data(), cell.size(), needle.data(), needle.size(), 0) != NOT_FOUND;
+}
+
+/// Set the bits of rows [begin, end) of a non-dictionary text column containing `needle` (non-empty). One pass
+/// over that part of the arena; each hit is attributed to its row and the rest of that row is skipped.
+void arenaContains(const ColumnData& column, size_t begin, size_t end, std::string_view needle, FindFn find, SIMDFilter::RowMask& mask) {
+    const auto offsets = column.textOffsets();
+    const auto chars = column.textChars();
+    const size_t hayLen = offsets[end];
+    size_t row = begin;
+    size_t pos = offsets[begin];
+    while ((pos = find(chars.data(), hayLen, needle.data(), needle.size(), pos)) != NOT_FOUND) {
+        // offsets[row + 1] > pos: first row ending after the hit
+        row = static_cast<size_t>(std::upper_bound(offsets.begin() + static_cast<ptrdiff_t>(row) + 1, offsets.begin() + static_cast<ptrdiff_t>(end) + 1, pos) - offsets.begin()) - 1;
+        if (row >= end) {
+            break;
+        }
+        // A hit straddling the row boundary means no later start in this row can fit either
+        if (pos + needle.size() <= offsets[row + 1]) {
+            setBit(mask, row);
+        }
+        pos = offsets[row + 1];
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Typed columns: compare whole vectors, deposit 4 (AVX2) or 8 (AVX-512) result bits at a time
+
+/// Rows [begin, end) whose value v satisfies lo <= v <= hi (equality is lo == hi)
+void int64RangeScalar(const int64_t* values, size_t begin, size_t end, int64_t lo, int64_t hi, uint64_t* words) noexcept {
+    for (size_t i = begin; i < end; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(values[i] >= lo && values[i] <= hi) << (i & 63);
+    }
+}
+
+void doubleRangeScalar(const double* values, size_t begin, size_t end, double lo, double hi, uint64_t* words) noexcept {
+    for (size_t i = begin; i < end; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(values[i] >= lo && values[i] <= hi) << (i & 63);
+    }
+}
 
-    if (nIds >= 7) {
-        __cpuidex(cpuInfo, 7, 0);
-        return (cpuInfo[1] & (1 << 5)) != 0;  // AVX2 bit
+#ifdef VELOCITYDB_SIMD_X86
+VELOCITYDB_TARGET("avx2")
+void int64RangeAvx2(const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* words) noexcept {
+    const __m256i vlo = _mm256_set1_epi64x(lo);
+    const __m256i vhi = _mm256_set1_epi64x(hi);
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(vlo, v), _mm256_cmpgt_epi64(v, vhi));
+        const auto bits = static_cast<uint64_t>(~_mm256_movemask_pd(_mm256_castsi256_pd(outside)) & 0xF);
+        words[i >> 6] |= bits << (i & 63);
+    }
+    int64RangeScalar(values, i, rows, lo, hi, words);
+}
+
+VELOCITYDB_TARGET("avx2")
+void doubleRangeAvx2(const double* values, size_t rows, double lo, double hi, uint64_t* words) noexcept {
+    const __m256d vlo = _mm256_set1_pd(lo);
+    const __m256d vhi = _mm256_set1_pd(hi);
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const __m256d v = _mm256_loadu_pd(values + i);
+        const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(v, vlo, _CMP_GE_OQ), _mm256_cmp_pd(v, vhi, _CMP_LE_OQ));
+        words[i >> 6] |= static_cast<uint64_t>(_mm256_movemask_pd(inside)) << (i & 63);
+    }
+    doubleRangeScalar(values, i, rows, lo, hi, words);
+}
+
+VELOCITYDB_TARGET("avx512f")
+void int64RangeAvx512(const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* words) noexcept {
+    const __m512i vlo = _mm512_set1_epi64(lo);
+    const __m512i vhi = _mm512_set1_epi64(hi);
+    size_t i = 0;
+    for (; i + 8 <= rows; i += 8) {
+        const __m512i v = _mm512_loadu_si512(values + i);
+        const __mmask8 inside = _mm512_cmpge_epi64_mask(v, vlo) & _mm512_cmple_epi64_mask(v, vhi);
+        words[i >> 6] |= static_cast<uint64_t>(inside) << (i & 63);
+    }
+    int64RangeScalar(values, i, rows, lo, hi, words);
+}
+
+VELOCITYDB_TARGET("avx512f")
+void doubleRangeAvx512(const double* values, size_t rows, double lo, double hi, uint64_t* words) noexcept {
+    const __m512d vlo = _mm512_set1_pd(lo);
+    const __m512d vhi = _mm512_set1_pd(hi);
+    size_t i = 0;
+    for (; i + 8 <= rows; i += 8) {
+        const __m512d v = _mm512_loadu_pd(values + i);
+        const __mmask8 inside = _mm512_cmp_pd_mask(v, vlo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(v, vhi, _CMP_LE_OQ);
+        words[i >> 6] |= static_cast<uint64_t>(inside) << (i & 63);
+    }
+    doubleRangeScalar(values, i, rows, lo, hi, words);
+}
+
+/// Rows whose text length (offsets[i + 1] - offsets[i]) equals `length`
+VELOCITYDB_TARGET("avx2")
+void lengthEqualsAvx2(const size_t* offsets, size_t rows, size_t length, uint64_t* words) noexcept {
+    static_assert(sizeof(size_t) == 8);
+    const __m256i target = _mm256_set1_epi64x(static_cast<int64_t>(length));
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const __m256i begin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+        const __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i + 1));
+        const __m256i equal = _mm256_cmpeq_epi64(_mm256_sub_epi64(end, begin), target);
+        words[i >> 6] |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(equal))) << (i & 63);
+    }
+    for (; i < rows; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(offsets[i + 1] - offsets[i] == length) << (i & 63);
+    }
+}
+
+VELOCITYDB_TARGET("avx512f")
+void lengthEqualsAvx512(const size_t* offsets, size_t rows, size_t length, uint64_t* words) noexcept {
+    const __m512i target = _mm512_set1_epi64(static_cast<int64_t>(length));
+    size_t i = 0;
+    for (; i + 8 <= rows; i += 8) {
+        const __m512i begin = _mm512_loadu_si512(offsets + i);
+        const __m512i end = _mm512_loadu_si512(offsets + i + 1);
+        words[i >> 6] |= static_cast<uint64_t>(_mm512_cmpeq_epi64_mask(_mm512_sub_epi64(end, begin), target)) << (i & 63);
+    }
+    for (; i < rows; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(offsets[i + 1] - offsets[i] == length) << (i & 63);
+    }
+}
+
+/// Rows of a dictionary-encoded column holding `code`, 8 (AVX2) or 16 (AVX-512) codes per compare
+VELOCITYDB_TARGET("avx2")
+void codeEqualsAvx2(const uint32_t* codes, size_t rows, uint32_t code, uint64_t* words) noexcept {
+    const __m256i target = _mm256_set1_epi32(static_cast<int>(code));
+    size_t i = 0;
+    for (; i + 8 <= rows; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(codes + i));
+        const auto bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, target))));
+        words[i >> 6] |= bits << (i & 63);
+    }
+    for (; i < rows; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(codes[i] == code) << (i & 63);
+    }
+}
+
+VELOCITYDB_TARGET("avx512f")
+void codeEqualsAvx512(const uint32_t* codes, size_t rows, uint32_t code, uint64_t* words) noexcept {
+    const __m512i target = _mm512_set1_epi32(static_cast<int>(code));
+    size_t i = 0;
+    for (; i + 16 <= rows; i += 16) {
+        words[i >> 6] |= static_cast<uint64_t>(_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(codes + i), target)) << (i & 63);
+    }
+    for (; i < rows; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(codes[i] == code) << (i & 63);
+    }
+}
+#endif
+
+void int64Range(SimdLevel level, const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* words) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    if (level == SimdLevel::AVX512) {
+        return int64RangeAvx512(values, rows, lo, hi, words);
+    }
+    if (level == SimdLevel::AVX2) {
+        return int64RangeAvx2(values, rows, lo, hi, words);
     }
 #endif
-    return false;
+    (void)level;
+    int64RangeScalar(values, 0, rows, lo, hi, words);
 }
 
-std::vector<size_t> SIMDFilter::filterEquals(const ResultSet& data, size_t columnIndex, const std::string& value) const {
-    std::vector<size_t> result;
-    result.reserve(data.rows.size() / 4);  // Estimate 25% match rate
+void doubleRange(SimdLevel level, const double* values, size_t rows, double lo, double hi, uint64_t* words) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    if (level == SimdLevel::AVX512) {
+        return doubleRangeAvx512(values, rows, lo, hi, words);
+    }
+    if (level == SimdLevel::AVX2) {
+        return doubleRangeAvx2(values, rows, lo, hi, words);
+    }
+#endif
+    (void)level;
+    doubleRangeScalar(values, 0, rows, lo, hi, words);
+}
 
-    for (size_t i = 0; i < data.rows.size(); ++i) {
-        if (columnIndex < data.rows[i].values.size()) {
-            const auto& cellValue = data.rows[i].values[columnIndex];
-            if (cellValue == value) {
-                result.push_back(i);
+/// Range kernel over the rows that can match: zones whose min/max rule [lo, hi] out are skipped and zones wholly
+/// inside it are set without reading a value. Rows not folded into the column stats yet are scanned.
+template <typename T, typename Kernel>
+void zoneRange(SimdLevel level, const ColumnData& column, const T* values, T lo, T hi, uint64_t* words, Kernel kernel) noexcept {
+    size_t begin = 0;
+    for (const auto& zone : column.stats().zones()) {
+        const size_t end = begin + zone.rows;
+        if (zone.allWithin(lo, hi)) {
+            for (size_t i = begin; i < end; ++i) {
+                words[i >> 6] |= uint64_t{1} << (i & 63);
             }
+        } else if (zone.mayContain(lo, hi)) {
+            kernel(level, values + begin, end - begin, lo, hi, words + (begin >> 6));
         }
+        begin = end;
+    }
+    // Restart the unfolded tail at a mask word boundary; the overlap only sets bits that are already set
+    begin &= ~size_t{63};
+    if (begin < column.size()) {
+        kernel(level, values + begin, column.size() - begin, lo, hi, words + (begin >> 6));
     }
+}
 
-    return result;
+void lengthEquals(SimdLevel level, const size_t* offsets, size_t rows, size_t length, uint64_t* words) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    if (level == SimdLevel::AVX512) {
+        return lengthEqualsAvx512(offsets, rows, length, words);
+    }
+    if (level == SimdLevel::AVX2) {
+        return lengthEqualsAvx2(offsets, rows, length, words);
+    }
+#endif
+    (void)level;
+    for (size_t i = 0; i < rows; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(offsets[i + 1] - offsets[i] == length) << (i & 63);
+    }
 }
 
-std::vector<size_t> SIMDFilter::filterContains(const ResultSet& data, size_t columnIndex, const std::string& substring) const {
-    std::vector<size_t> result;
-    result.reserve(data.rows.size() / 4);
+void codeEquals(SimdLevel level, const uint32_t* codes, size_t rows, uint32_t code, uint64_t* words) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    if (level == SimdLevel::AVX512) {
+        return codeEqualsAvx512(codes, rows, code, words);
+    }
+    if (level == SimdLevel::AVX2) {
+        return codeEqualsAvx2(codes, rows, code, words);
+    }
+#endif
+    (void)level;
+    for (size_t i = 0; i < rows; ++i) {
+        words[i >> 6] |= static_cast<uint64_t>(codes[i] == code) << (i & 63);
+    }
+}
+
+/// Dictionary-encoded text: evaluate `pred` once per distinct value, then map every row through its code
+template <typename Pred>
+SIMDFilter::RowMask dictionaryMask(const ColumnData& column, Pred pred) {
+    std::vector<uint8_t> matches(column.dictionarySize());
+    for (uint32_t code = 0; code < matches.size(); ++code) {
+        matches[code] = pred(column.dictionaryValue(code)) ? 1 : 0;
+    }
+    const auto codes = column.dictionaryCodes();
+    SIMDFilter::RowMask mask(maskWords(codes.size()), 0);
+    for (size_t row = 0; row < codes.size(); ++row) {
+        mask[row >> 6] |= static_cast<uint64_t>(matches[codes[row]]) << (row & 63);
+    }
+    return mask;
+}
+
+/// Closed int64 interval holding exactly the integers in [lo, hi]; false when it is empty
+[[nodiscard]] bool integerBounds(double lo, double hi, int64_t& outLo, int64_t& outHi) noexcept {
+    constexpr double limit = 9223372036854775807.0;  // 2^63, first double past INT64_MAX
+    lo = std::ceil(lo);
+    hi = std::floor(hi);
+    if (std::isnan(lo) || std::isnan(hi) || lo > hi || lo >= limit || hi < -limit) {
+        return false;
+    }
+    outLo = lo <= -limit ? (std::numeric_limits<int64_t>::min)() : static_cast<int64_t>(lo);
+    outHi = hi >= limit ? (std::numeric_limits<int64_t>::max)() : static_cast<int64_t>(hi);
+    return true;
+}
+
+/// Per-row predicate over the display text, for column types without a typed kernel
+template <typename Pred>
+SIMDFilter::RowMask displayTextMask(const ColumnData& column, Pred pred) {
+    SIMDFilter::RowMask mask(maskWords(column.size()), 0);
+    std::string cell;
+    for (size_t i = 0; i < column.size(); ++i) {
+        cell.clear();
+        if (!column.isNull(i)) {
+            column.appendDisplayText(cell, i);
+        }
+        if (pred(column.isNull(i), std::string_view(cell))) {
+            setBit(mask, i);
+        }
+    }
+    return mask;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Sorting: each cell is decoded once into a key whose unsigned order is the column order
+
+constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+/// Below this a comparison sort beats the radix passes and their histogram setup
+constexpr size_t RADIX_MIN_ROWS = 256;
+constexpr size_t PARALLEL_SORT_MIN_ROWS = 65536;
 
-    for (size_t i = 0; i < data.rows.size(); ++i) {
-        if (columnIndex < data.rows[i].values.size()) {
-            const auto& cellValue = data.rows[i].values[columnIndex];
-            if (cellValue.find(substring) != std::string::npos) {
-                result.push_back(i);
+struct KeyedRow {
+    uint64_t key;
+    size_t row;
+};
+
+/// Text cell key: number cells (leading-number prefix) sort before words and compare by value;
+/// words compare by their first eight bytes, then by the full text when those tie
+struct TextKey {
+    uint64_t key;
+    size_t row;
+    bool number;
+};
+
+[[nodiscard]] uint64_t orderedKey(int64_t value) noexcept {
+    return static_cast<uint64_t>(value) ^ SIGN_BIT;
+}
+
+[[nodiscard]] uint64_t orderedKey(double value) noexcept {
+    const auto bits = std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value);  // -0.0 ties with 0.0
+    return (bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT;
+}
+
+/// Fields packed most significant first; the fraction keeps 100 ns resolution (datetime2's finest), so 64 bits suffice
+[[nodiscard]] uint64_t orderedKey(const DateTimeValue& value) noexcept {
+    const auto year = static_cast<uint64_t>(std::clamp<int>(value.year, 0, 16383));
+    return (year << 50) | (uint64_t{value.month} << 46) | (uint64_t{value.day} << 41) | (uint64_t{value.hour} << 36) | (uint64_t{value.minute} << 30) | (uint64_t{value.second} << 24) |
+           ((value.fraction / 100) & 0xFFFFFF);
+}
+
+[[nodiscard]] uint64_t prefixKey(std::string_view text) noexcept {
+    uint64_t key = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        key = (key << 8) | (i < text.size() ? static_cast<unsigned char>(text[i]) : 0u);
+    }
+    return key;
+}
+
+/// Stable LSD radix sort on the key, one byte per pass; passes where every key has the same byte are skipped
+void radixSort(std::vector<KeyedRow>& items) {
+    if (items.size() < RADIX_MIN_ROWS) {
+        std::stable_sort(items.begin(), items.end(), [](const KeyedRow& a, const KeyedRow& b) { return a.key < b.key; });
+        return;
+    }
+    std::vector<std::array<size_t, 256>> counts(8, std::array<size_t, 256>{});
+    for (const auto& item : items) {
+        for (size_t pass = 0; pass < 8; ++pass) {
+            ++counts[pass][(item.key >> (pass * 8)) & 0xFF];
+        }
+    }
+    std::vector<KeyedRow> buffer(items.size());
+    for (size_t pass = 0; pass < 8; ++pass) {
+        auto& count = counts[pass];
+        if (count[(items.front().key >> (pass * 8)) & 0xFF] == items.size()) {
+            continue;
+        }
+        size_t offset = 0;
+        for (auto& bucket : count) {
+            offset += std::exchange(bucket, offset);
+        }
+        for (const auto& item : items) {
+            buffer[count[(item.key >> (pass * 8)) & 0xFF]++] = item;
+        }
+        items.swap(buffer);
+    }
+}
+
+/// Column decoded for sorting. NULLs (and empty text, which always sorted with them) are kept apart:
+/// they lead an ascending order and trail a descending one.
+struct SortKeys {
+    std::vector<size_t> nullRows;
+    std::vector<KeyedRow> keyed;  ///< Exact keys, complemented when descending so the radix sort always runs ascending
+    std::vector<TextKey> text;    ///< Used instead of `keyed` for text columns holding words
+};
+
+[[nodiscard]] SortKeys decodeSortKeys(const ColumnData& column, bool ascending) {
+    SortKeys keys;
+    const size_t rows = column.size();
+    const uint64_t flip = ascending ? 0 : ~uint64_t{0};
+    auto addKeyed = [&](uint64_t key, size_t row) { keys.keyed.push_back(KeyedRow{.key = key ^ flip, .row = row}); };
+
+    switch (column.type()) {
+        case ColumnDataType::Int64:
+        case ColumnDataType::Bit:
+        case ColumnDataType::Double:
+        case ColumnDataType::Date:
+        case ColumnDataType::Time:
+        case ColumnDataType::Timestamp:
+            keys.keyed.reserve(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                if (column.isNull(i)) {
+                    keys.nullRows.push_back(i);
+                } else if (column.type() == ColumnDataType::Double) {
+                    addKeyed(orderedKey(column.doubleAt(i)), i);
+                } else if (column.isNumeric()) {
+                    addKeyed(orderedKey(column.int64At(i)), i);
+                } else {
+                    addKeyed(orderedKey(column.dateTimeAt(i)), i);
+                }
+            }
+            return keys;
+        case ColumnDataType::Binary:
+            // Raw bytes compare like their hex text; never parsed as numbers
+            keys.text.reserve(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                if (column.isNull(i)) {
+                    keys.nullRows.push_back(i);
+                } else {
+                    keys.text.push_back(TextKey{.key = prefixKey(column.textAt(i)), .row = i, .number = false});
+                }
             }
+            return keys;
+        case ColumnDataType::Text:
+            break;
+    }
+
+    keys.text.reserve(rows);
+    bool allNumbers = true;
+    for (size_t i = 0; i < rows; ++i) {
+        const auto cell = column.textAt(i);
+        if (cell.empty()) {
+            keys.nullRows.push_back(i);
+            continue;
+        }
+        double number = 0.0;
+        if (auto [ptr, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), number); ec == std::errc{} && !std::isnan(number)) {
+            keys.text.push_back(TextKey{.key = orderedKey(number), .row = i, .number = true});
+        } else {
+            keys.text.push_back(TextKey{.key = prefixKey(cell), .row = i, .number = false});
+            allNumbers = false;
         }
     }
+    // Numbers stored as text (DECIMAL, or a converted column) have exact keys too
+    if (allNumbers) {
+        keys.keyed.reserve(keys.text.size());
+        for (const auto& key : keys.text) {
+            addKeyed(key.key, key.row);
+        }
+        keys.text = {};
+    }
+    return keys;
+}
 
-    return result;
+/// Order `items` fully (`whole`) or just enough that sorted positions [lo, hi) hold their final items
+template <typename Item, typename Less>
+void orderItems(std::vector<Item>& items, Less less, bool whole, size_t lo, size_t hi) {
+    if (whole) {
+        if (items.size() >= PARALLEL_SORT_MIN_ROWS) {
+            std::stable_sort(std::execution::par, items.begin(), items.end(), less);
+        } else {
+            std::stable_sort(items.begin(), items.end(), less);
+        }
+        return;
+    }
+    if (lo >= hi) {
+        return;
+    }
+    const auto first = items.begin();
+    std::nth_element(first, first + static_cast<ptrdiff_t>(lo), items.end(), less);
+    std::partial_sort(first + static_cast<ptrdiff_t>(lo), first + static_cast<ptrdiff_t>(hi), items.end(), less);
 }
 
-std::vector<size_t> SIMDFilter::filterRange(const ResultSet& data, size_t columnIndex, const std::string& minValue, const std::string& maxValue) const {
-    std::vector<size_t> result;
-    result.reserve(data.rows.size() / 4);
+/// Rows at sorted positions [begin, end) of `column`; ties keep row order
+[[nodiscard]] std::vector<size_t> orderRows(const ColumnData& column, bool ascending, size_t begin, size_t end) {
+    auto keys = decodeSortKeys(column, ascending);
+    const size_t rows = column.size();
+    const size_t nullCount = keys.nullRows.size();
+    const size_t sortedCount = rows - nullCount;
+    const size_t leadingNulls = ascending ? nullCount : 0;
+    const size_t lo = (std::min)(begin - (std::min)(begin, leadingNulls), sortedCount);
+    const size_t hi = (std::min)(end - (std::min)(end, leadingNulls), sortedCount);
+    const bool whole = begin == 0 && end == rows;
 
-    for (size_t i = 0; i < data.rows.size(); ++i) {
-        if (columnIndex < data.rows[i].values.size()) {
-            const auto& cellValue = data.rows[i].values[columnIndex];
-            if (cellValue >= minValue && cellValue <= maxValue) {
-                result.push_back(i);
+    std::vector<size_t> sortedRows;
+    if (keys.text.empty()) {
+        if (whole) {
+            radixSort(keys.keyed);
+        } else {
+            orderItems(keys.keyed, [](const KeyedRow& a, const KeyedRow& b) { return a.key != b.key ? a.key < b.key : a.row < b.row; }, false, lo, hi);
+        }
+        sortedRows.reserve(hi - lo);
+        for (size_t i = lo; i < hi; ++i) {
+            sortedRows.push_back(keys.keyed[i].row);
+        }
+    } else {
+        auto compare = [&](const TextKey& a, const TextKey& b) -> int {
+            if (a.number != b.number) {
+                return a.number ? -1 : 1;
             }
+            if (a.key != b.key) {
+                return a.key < b.key ? -1 : 1;
+            }
+            return a.number ? 0 : column.textAt(a.row).compare(column.textAt(b.row));
+        };
+        auto less = [&](const TextKey& a, const TextKey& b) {
+            const int order = compare(a, b);
+            return order != 0 ? (ascending ? order < 0 : order > 0) : a.row < b.row;
+        };
+        orderItems(keys.text, less, whole, lo, hi);
+        sortedRows.reserve(hi - lo);
+        for (size_t i = lo; i < hi; ++i) {
+            sortedRows.push_back(keys.text[i].row);
         }
     }
 
-    return result;
+    std::vector<size_t> window;
+    window.reserve(end - begin);
+    auto sorted = sortedRows.begin();
+    for (size_t pos = begin; pos < end; ++pos) {
+        const bool isNull = ascending ? pos < nullCount : pos >= sortedCount;
+        window.push_back(isNull ? keys.nullRows[ascending ? pos : pos - sortedCount] : *sorted++);
+    }
+    return window;
 }
 
-std::vector<size_t> SIMDFilter::sortByColumn(const ResultSet& data, size_t columnIndex, bool ascending) const {
-    std::vector<size_t> indices(data.rows.size());
-    std::iota(indices.begin(), indices.end(), 0);
-
-    auto comparator = [&](size_t a, size_t b) {
-        const auto& valA = data.rows[a].values[columnIndex];
-        const auto& valB = data.rows[b].values[columnIndex];
-
-        // Try numeric comparison first
-        try {
-            double numA = std::stod(valA);
-            double numB = std::stod(valB);
-            return ascending ? (numA < numB) : (numA > numB);
-        } catch (...) {
-            // Fall back to string comparison
-            return ascending ? (valA < valB) : (valA > valB);
+}  // namespace
+
+SimdLevel SIMDFilter::detectedLevel() noexcept {
+    return detectedSimdLevel();
+}
+
+SimdLevel SIMDFilter::activeLevel() noexcept {
+    return activeSimdLevel();
+}
+
+void SIMDFilter::limitLevel(SimdLevel level) noexcept {
+    limitSimdLevel(level);
+}
+
+std::string_view SIMDFilter::levelName(SimdLevel level) noexcept {
+    return simdLevelName(level);
+}
+
+bool SIMDFilter::isAVX2Available() {
+    return detectedSimdLevel() >= SimdLevel::AVX2;
+}
+
+std::vector<size_t> SIMDFilter::maskToIndices(const RowMask& mask, size_t rowCount) {
+    size_t matches = 0;
+    for (auto word : mask) {
+        matches += static_cast<size_t>(std::popcount(word));
+    }
+    std::vector<size_t> indices;
+    indices.reserve(matches);
+    for (size_t w = 0; w < mask.size(); ++w) {
+        for (uint64_t word = mask[w]; word != 0; word &= word - 1) {
+            const size_t row = (w << 6) + static_cast<size_t>(std::countr_zero(word));
+            if (row < rowCount) {
+                indices.push_back(row);
+            }
         }
+    }
+    return indices;
+}
+
+std::vector<size_t> SIMDFilter::filterEquals(const ResultSet& data, size_t columnIndex, const std::string& value) const {
+    return maskToIndices(equalsMask(data, columnIndex, value), data.rowCount());
+}
+
+std::vector<size_t> SIMDFilter::filterContains(const ResultSet& data, size_t columnIndex, const std::string& substring) const {
+    return maskToIndices(containsMask(data, columnIndex, substring), data.rowCount());
+}
+
+std::vector<size_t> SIMDFilter::filterRange(const ResultSet& data, size_t columnIndex, const std::string& minValue, const std::string& maxValue) const {
+    return maskToIndices(rangeMask(data, columnIndex, minValue, maxValue), data.rowCount());
+}
+
+std::vector<size_t> SIMDFilter::filter(const ResultSet& data, size_t columnIndex, FilterType type, std::string_view value, std::string_view maxValue) const {
+    return maskToIndices(mask(data, columnIndex, type, value, maxValue), data.rowCount());
+}
+
+SIMDFilter::RowMask SIMDFilter::mask(const ResultSet& data, size_t columnIndex, FilterType type, std::string_view value, std::string_view maxValue) const {
+    switch (type) {
+        case FilterType::Equals:
+            return equalsMask(data, columnIndex, value);
+        case FilterType::Contains:
+            return containsMask(data, columnIndex, value);
+        case FilterType::Range:
+            break;
+    }
+    return rangeMask(data, columnIndex, value, maxValue);
+}
+
+std::vector<size_t> SIMDFilter::select(const ResultSet& data, size_t columnIndex, FilterType type, std::string_view value, std::string_view maxValue, std::span<const size_t> candidates) const {
+    if (columnIndex >= data.columnData.size()) {
+        return {};
+    }
+    const auto& column = data.columnData[columnIndex];
+    std::vector<size_t> kept;
+    auto keepIf = [&](auto pred) {
+        for (size_t row : candidates) {
+            if (pred(row)) {
+                kept.push_back(row);
+            }
+        }
+        return std::move(kept);
     };
+    // Display text of non-text cells (NULL shows as empty), matching the mask kernels' fallback
+    std::string cell;
+    auto displayText = [&](size_t row) -> std::string_view {
+        cell.clear();
+        if (!column.isNull(row)) {
+            column.appendDisplayText(cell, row);
+        }
+        return cell;
+    };
+    const bool isText = column.type() == ColumnDataType::Text;
 
-    std::sort(indices.begin(), indices.end(), comparator);
-    return indices;
+    switch (type) {
+        case FilterType::Equals:
+            if (isText) {
+                return keepIf([&](size_t row) { return column.textAt(row) == value; });
+            }
+            if (column.type() == ColumnDataType::Int64 || column.type() == ColumnDataType::Bit) {
+                if (value.empty()) {
+                    return keepIf([&](size_t row) { return column.isNull(row); });
+                }
+                int64_t target = 0;
+                if (!parseInt64(value, target)) {
+                    return {};
+                }
+                return keepIf([&](size_t row) { return !column.isNull(row) && column.int64At(row) == target; });
+            }
+            return keepIf([&](size_t row) { return column.isNull(row) ? value.empty() : displayText(row) == value; });
+        case FilterType::Contains:
+            if (isText) {
+                return keepIf([&](size_t row) { return column.textAt(row).find(value) != std::string_view::npos; });
+            }
+            return keepIf([&](size_t row) { return displayText(row).find(value) != std::string_view::npos; });
+        case FilterType::Range:
+            break;
+    }
+
+    double minNumber = 0.0;
+    double maxNumber = 0.0;
+    if (column.isNumeric() && parseDouble(value, minNumber) && parseDouble(maxValue, maxNumber)) {
+        if (column.type() == ColumnDataType::Double) {
+            return keepIf([&](size_t row) { return !column.isNull(row) && column.doubleAt(row) >= minNumber && column.doubleAt(row) <= maxNumber; });
+        }
+        int64_t lo = 0;
+        int64_t hi = 0;
+        if (!integerBounds(minNumber, maxNumber, lo, hi)) {
+            return {};
+        }
+        return keepIf([&](size_t row) { return !column.isNull(row) && column.int64At(row) >= lo && column.int64At(row) <= hi; });
+    }
+    if (isText) {
+        return keepIf([&](size_t row) { return column.textAt(row) >= value && column.textAt(row) <= maxValue; });
+    }
+    return keepIf([&](size_t row) {
+        const auto text = displayText(row);
+        return text >= value && text <= maxValue;
+    });
 }
 
-bool SIMDFilter::simdStringEquals(const char* a, const char* b, size_t len) const {
-#ifdef _MSC_VER
-    if (isAVX2Available() && len >= 32) {
-        // Compare 32-byte chunks using AVX2
-        size_t i = 0;
-        for (; i + 32 <= len; i += 32) {
-            if (!avx2StringEquals32(a + i, b + i)) {
-                return false;
+std::optional<FilterType> SIMDFilter::parseFilterType(std::string_view name) noexcept {
+    if (name == "equals") {
+        return FilterType::Equals;
+    }
+    if (name == "contains") {
+        return FilterType::Contains;
+    }
+    if (name == "range") {
+        return FilterType::Range;
+    }
+    return std::nullopt;
+}
+
+SIMDFilter::RowMask SIMDFilter::equalsMask(const ResultSet& data, size_t columnIndex, std::string_view value) const {
+    if (columnIndex >= data.columnData.size()) {
+        return RowMask(maskWords(data.rowCount()), 0);
+    }
+    const auto& column = data.columnData[columnIndex];
+    const size_t rows = column.size();
+    const auto level = activeLevel();
+    RowMask mask(maskWords(rows), 0);
+
+    if (column.isDictionaryEncoded()) {
+        // One lookup turns the value into a code; rows then compare 32-bit codes instead of bytes
+        if (const auto code = column.dictionaryCode(value)) {
+            codeEquals(level, column.dictionaryCodes().data(), rows, *code, mask.data());
+        }
+        return mask;
+    }
+    if (column.type() == ColumnDataType::Text) {
+        // Length check over the offsets first; only rows of the right length compare bytes
+        const auto offsets = column.textOffsets();
+        lengthEquals(level, offsets.data(), rows, value.size(), mask.data());
+        if (value.empty()) {
+            return mask;
+        }
+        const char* chars = column.textChars().data();
+        for (auto& word : mask) {
+            for (uint64_t bits = word; bits != 0; bits &= bits - 1) {
+                const size_t row = (static_cast<size_t>(&word - mask.data()) << 6) + static_cast<size_t>(std::countr_zero(bits));
+                if (std::memcmp(chars + offsets[row], value.data(), value.size()) != 0) {
+                    word &= ~(uint64_t{1} << (row & 63));
+                }
             }
         }
-        // Compare remaining bytes
-        for (; i < len; ++i) {
-            if (a[i] != b[i])
-                return false;
+        return mask;
+    }
+
+    // Typed columns: NULL only matches an empty filter value (NULL is displayed as an empty cell)
+    if (column.type() == ColumnDataType::Int64 || column.type() == ColumnDataType::Bit) {
+        if (value.empty()) {
+            const auto nulls = column.nullWords();
+            std::copy_n(nulls.begin(), (std::min)(nulls.size(), mask.size()), mask.begin());
+            return mask;
+        }
+        if (int64_t target = 0; parseInt64(value, target)) {
+            zoneRange(level, column, column.int64Values().data(), target, target, mask.data(), int64Range);
+            clearNulls(mask, column);
         }
-        return true;
+        return mask;
     }
-#endif
-    return std::memcmp(a, b, len) == 0;
+
+    return displayTextMask(column, [&](bool isNull, std::string_view cell) { return isNull ? value.empty() : cell == value; });
 }
 
-bool SIMDFilter::simdStringContains(const char* haystack, size_t haystackLen, const char* needle, size_t needleLen) const {
-    if (needleLen == 0)
-        return true;
-    if (needleLen > haystackLen)
-        return false;
+SIMDFilter::RowMask SIMDFilter::containsMask(const ResultSet& data, size_t columnIndex, std::string_view substring, bool caseInsensitive) const {
+    if (columnIndex >= data.columnData.size()) {
+        return RowMask(maskWords(data.rowCount()), 0);
+    }
+    const auto& column = data.columnData[columnIndex];
+    const size_t rows = column.size();
+    std::string lowered;
+    if (caseInsensitive) {
+        lowered = asciiLowered(substring);
+        substring = lowered;
+    }
+    const auto find = pickFind(activeLevel(), caseInsensitive);
 
-#ifdef _MSC_VER
-    if (isAVX2Available() && haystackLen >= 32) {
-        // Use AVX2 to find first character matches, then verify full substring
-        char firstChar = needle[0];
-        size_t pos = 0;
+    if (column.type() != ColumnDataType::Text) {
+        return displayTextMask(column, [&](bool, std::string_view cell) { return cellContains(cell, substring, find); });
+    }
 
-        while (pos + needleLen <= haystackLen) {
-            size_t found = avx2FindFirstChar(haystack + pos, haystackLen - pos, firstChar);
-            if (found == haystackLen - pos) {
-                return false;  // First char not found
+    if (column.isDictionaryEncoded() && !substring.empty()) {
+        return dictionaryMask(column, [&](std::string_view cell) { return cellContains(cell, substring, find); });
+    }
+
+    RowMask mask(maskWords(rows), 0);
+    if (substring.empty()) {
+        std::fill(mask.begin(), mask.end(), ~uint64_t{0});
+        if (rows & 63) {
+            mask.back() = (uint64_t{1} << (rows & 63)) - 1;
+        }
+        return mask;
+    }
+
+    arenaContains(column, 0, rows, substring, find, mask);
+    return mask;
+}
+
+std::vector<SIMDFilter::RowMask> SIMDFilter::searchMasks(const ResultSet& data, std::string_view needle, bool caseInsensitive) const {
+    std::vector<RowMask> masks(data.columnData.size());
+    for (size_t c = 0; c < masks.size(); ++c) {
+        masks[c].assign(maskWords(data.columnData[c].size()), 0);
+    }
+    if (needle.empty()) {
+        return masks;
+    }
+    std::string lowered;
+    if (caseInsensitive) {
+        lowered = asciiLowered(needle);
+        needle = lowered;
+    }
+    const auto find = pickFind(activeLevel(), caseInsensitive);
+
+    // Chunks start at multiples of 64 rows, so no two of them write the same mask word
+    struct Chunk {
+        size_t column;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Chunk> chunks;
+    for (size_t c = 0; c < masks.size(); ++c) {
+        const auto& column = data.columnData[c];
+        if (column.isDictionaryEncoded()) {
+            chunks.push_back({c, 0, column.size()});
+            continue;
+        }
+        for (size_t begin = 0; begin < column.size(); begin += SEARCH_CHUNK_ROWS) {
+            chunks.push_back({c, begin, (std::min)(begin + SEARCH_CHUNK_ROWS, column.size())});
+        }
+    }
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const Chunk& chunk) {
+        const auto& column = data.columnData[chunk.column];
+        auto& mask = masks[chunk.column];
+        if (column.isDictionaryEncoded()) {
+            mask = dictionaryMask(column, [&](std::string_view cell) { return cellContains(cell, needle, find); });
+            return;
+        }
+        if (column.type() == ColumnDataType::Text) {
+            arenaContains(column, chunk.begin, chunk.end, needle, find, mask);
+            return;
+        }
+        std::string cell;
+        for (size_t row = chunk.begin; row < chunk.end; ++row) {
+            if (column.isNull(row)) {
+                continue;
             }
-            pos += found;
+            cell.clear();
+            column.appendDisplayText(cell, row);
+            if (cellContains(cell, needle, find)) {
+                setBit(mask, row);
+            }
+        }
+    });
+    return masks;
+}
+
+SIMDFilter::RowMask SIMDFilter::rangeMask(const ResultSet& data, size_t columnIndex, std::string_view minValue, std::string_view maxValue) const {
+    if (columnIndex >= data.columnData.size()) {
+        return RowMask(maskWords(data.rowCount()), 0);
+    }
+    const auto& column = data.columnData[columnIndex];
+    const size_t rows = column.size();
 
-            // Verify full substring match
-            if (pos + needleLen <= haystackLen && std::memcmp(haystack + pos, needle, needleLen) == 0) {
-                return true;
+    // Numeric columns compare by value when both bounds are numbers
+    double minNumber = 0.0;
+    double maxNumber = 0.0;
+    if (column.isNumeric() && parseDouble(minValue, minNumber) && parseDouble(maxValue, maxNumber)) {
+        RowMask mask(maskWords(rows), 0);
+        if (column.type() == ColumnDataType::Double) {
+            zoneRange(activeLevel(), column, column.doubleValues().data(), minNumber, maxNumber, mask.data(), doubleRange);
+        } else if (int64_t lo = 0, hi = 0; integerBounds(minNumber, maxNumber, lo, hi)) {
+            zoneRange(activeLevel(), column, column.int64Values().data(), lo, hi, mask.data(), int64Range);
+        }
+        clearNulls(mask, column);
+        return mask;
+    }
+
+    // Text and date/time columns compare lexicographically (ISO date text orders chronologically)
+    if (column.isDictionaryEncoded()) {
+        return dictionaryMask(column, [&](std::string_view cell) { return cell >= minValue && cell <= maxValue; });
+    }
+    if (column.type() == ColumnDataType::Text) {
+        RowMask mask(maskWords(rows), 0);
+        for (size_t i = 0; i < rows; ++i) {
+            const auto cell = column.textAt(i);
+            if (cell >= minValue && cell <= maxValue) {
+                setBit(mask, i);
             }
-            ++pos;
         }
-        return false;
+        return mask;
     }
-#endif
-    return std::string_view(haystack, haystackLen).find(std::string_view(needle, needleLen)) != std::string_view::npos;
+    return displayTextMask(column, [&](bool, std::string_view cell) { return cell >= minValue && cell <= maxValue; });
+}
+
+std::vector<size_t> SIMDFilter::sortByColumn(const ResultSet& data, size_t columnIndex, bool ascending) const {
+    return sortWindow(data, columnIndex, ascending, 0, data.rowCount());
+}
+
+std::vector<size_t> SIMDFilter::sortWindow(const ResultSet& data, size_t columnIndex, bool ascending, size_t offset, size_t count) const {
+    const size_t rows = data.rowCount();
+    const size_t begin = (std::min)(offset, rows);
+    const size_t end = begin + (std::min)(count, rows - begin);
+    if (columnIndex >= data.columnData.size()) {
+        std::vector<size_t> indices(end - begin);
+        std::iota(indices.begin(), indices.end(), begin);
+        return indices;
+    }
+    return orderRows(data.columnData[columnIndex], ascending, begin, end);
 }
 
 }  // namespace velocitydb
@@ -1,15 +1,36 @@
 #pragma once
 
-#include "../database/sqlserver_driver.h"
+#include "../database/result_set.h"
+#include "cpu_features.h"
 
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace velocitydb {
 
+/// Grid filter predicates, named "equals", "contains" and "range" on the IPC side
+enum class FilterType : uint8_t { Equals, Contains, Range };
+
+/// Column predicates evaluated over the columnar storage of a ResultSet.
+///
+/// Text predicates work on the column's contiguous character arena: `contains` runs one vectorized substring
+/// search over the whole arena and maps hits back to rows through the offsets array, `equals` compares row
+/// lengths four or eight at a time before touching any bytes. Int64/Bit/Double columns are compared as typed
+/// vectors, skipping the zones whose ColumnStats min/max rule the value out. Kernels are picked once per process
+/// from the CPU features (AVX-512BW, AVX2, SSE4.2, portable).
 class SIMDFilter {
 public:
+    /// One bit per row (bit `i % 64` of word `i / 64`), set where the predicate holds
+    using RowMask = std::vector<uint64_t>;
+
+    /// Rows per task of searchMasks(); a multiple of 64 so tasks never share a mask word
+    static constexpr size_t SEARCH_CHUNK_ROWS = 64 * 1024;
+
     SIMDFilter() = default;
     ~SIMDFilter() = default;
 
@@ -20,16 +41,44 @@ public:
 
     std::vector<size_t> filterRange(const ResultSet& data, size_t columnIndex, const std::string& minValue, const std::string& maxValue) const;
 
-    // Sort rows by column
+    /// Dispatch to the filter for `type`; `maxValue` is only read for Range
+    [[nodiscard]] std::vector<size_t> filter(const ResultSet& data, size_t columnIndex, FilterType type, std::string_view value, std::string_view maxValue) const;
+    /// filter() as a bitmask
+    [[nodiscard]] RowMask mask(const ResultSet& data, size_t columnIndex, FilterType type, std::string_view value, std::string_view maxValue) const;
+    /// The rows of `candidates` (ascending) that pass filter(), checking only those rows; for sparse selections
+    [[nodiscard]] std::vector<size_t> select(const ResultSet& data, size_t columnIndex, FilterType type, std::string_view value, std::string_view maxValue, std::span<const size_t> candidates) const;
+    /// FilterType for its IPC name, nullopt when unknown
+    [[nodiscard]] static std::optional<FilterType> parseFilterType(std::string_view name) noexcept;
+
+    /// Bitmask forms of the filters above (an out-of-range column yields an all-zero mask)
+    [[nodiscard]] RowMask equalsMask(const ResultSet& data, size_t columnIndex, std::string_view value) const;
+    [[nodiscard]] RowMask containsMask(const ResultSet& data, size_t columnIndex, std::string_view substring, bool caseInsensitive = false) const;
+    [[nodiscard]] RowMask rangeMask(const ResultSet& data, size_t columnIndex, std::string_view minValue, std::string_view maxValue) const;
+
+    /// Find-in-grid: one containsMask() per column, cells shown as text, NULLs never matching and an empty needle
+    /// matching nothing. Columns are split into SEARCH_CHUNK_ROWS chunks searched in parallel. `caseInsensitive`
+    /// folds ASCII letters only; other bytes must match exactly.
+    [[nodiscard]] std::vector<RowMask> searchMasks(const ResultSet& data, std::string_view needle, bool caseInsensitive) const;
+
+    /// Row indices of the set bits of `mask`, ascending
+    [[nodiscard]] static std::vector<size_t> maskToIndices(const RowMask& mask, size_t rowCount);
+
+    /// Row order sorting the grid by one column. Each cell is decoded once into a typed key: integer, double and
+    /// date/time columns are radix sorted; text sorts numbers (leading-number prefix) by value before words
+    /// (byte order), with a parallel merge sort for large results. NULLs and empty text lead ascending order and
+    /// trail descending order; ties keep row order.
     std::vector<size_t> sortByColumn(const ResultSet& data, size_t columnIndex, bool ascending = true) const;
+    /// sortByColumn(...)[offset, offset + count) without ordering the rows outside the window (top-k for the visible grid page)
+    [[nodiscard]] std::vector<size_t> sortWindow(const ResultSet& data, size_t columnIndex, bool ascending, size_t offset, size_t count) const;
+
+    /// detectedSimdLevel(), activeSimdLevel() and limitSimdLevel(), which every SIMD kernel shares
+    [[nodiscard]] static SimdLevel detectedLevel() noexcept;
+    [[nodiscard]] static SimdLevel activeLevel() noexcept;
+    static void limitLevel(SimdLevel level) noexcept;
+    [[nodiscard]] static std::string_view levelName(SimdLevel level) noexcept;
 
     // Check if AVX2 is available
     static bool isAVX2Available();
-
-private:
-    // SIMD-optimized string comparison (when available)
-    bool simdStringEquals(const char* a, const char* b, size_t len) const;
-    bool simdStringContains(const char* haystack, size_t haystackLen, const char* needle, size_t needleLen) const;
 };
 
 }  // namespace velocitydb
@@ -0,0 +1,69 @@
+#include "startup_profiler.h"
+
+#include "logger.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <format>
+
+namespace velocitydb {
+
+namespace {
+
+double millisecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}  // namespace
+
+StartupProfiler::Phase::Phase(StartupProfiler& profiler, std::string_view name) : m_profiler(profiler), m_name(name), m_begin(std::chrono::steady_clock::now()) {}
+
+StartupProfiler::Phase::~Phase() {
+    m_profiler.record(std::move(m_name), m_begin, std::chrono::steady_clock::now());
+}
+
+StartupProfiler::StartupProfiler() : m_origin(std::chrono::steady_clock::now()) {}
+
+StartupProfiler& StartupProfiler::instance() {
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+void StartupProfiler::record(std::string name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    std::lock_guard lock(m_mutex);
+    m_records.push_back(Record{.name = std::move(name), .beginMs = millisecondsBetween(m_origin, begin), .durationMs = millisecondsBetween(begin, end)});
+}
+
+double StartupProfiler::elapsedMs() const {
+    return millisecondsBetween(m_origin, std::chrono::steady_clock::now());
+}
+
+std::string StartupProfiler::timeline() const {
+    std::vector<Record> records;
+    {
+        std::lock_guard lock(m_mutex);
+        records = m_records;
+    }
+    std::ranges::stable_sort(records, {}, &Record::beginMs);
+
+    std::string text;
+    for (const auto& record : records) {
+        if (!text.empty()) {
+            text += ", ";
+        }
+        text += std::format("{} {:.1f} ms @{:.1f}", record.name, record.durationMs, record.beginMs);
+    }
+    return text;
+}
+
+bool StartupProfiler::reportInteractive() {
+    if (m_reported.exchange(true, std::memory_order_acq_rel)) {
+        return false;
+    }
+    const double interactiveMs = elapsedMs();
+    MetricsRegistry::instance().gauge("startup.interactive_ms").set(static_cast<int64_t>(interactiveMs));
+    log<LogLevel::INFO>(std::format("[Startup] Interactive after {:.1f} ms ({})", interactiveMs, timeline()));
+    return true;
+}
+
+}  // namespace velocitydb
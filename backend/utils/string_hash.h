@@ -0,0 +1,14 @@
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Transparent string hash, so maps keyed by std::string can be probed with a string_view without a copy
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view sv) const noexcept { return std::hash<std::string_view>{}(sv); }
+};
+
+}  // namespace velocitydb
@@ -0,0 +1,143 @@
+#include "utf16_transcode.h"
+
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef VELOCITYDB_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace velocitydb {
+
+namespace {
+
+constexpr char16_t HIGH_SURROGATE_FIRST = 0xD800;
+constexpr char16_t LOW_SURROGATE_FIRST = 0xDC00;
+constexpr char16_t SURROGATE_LAST = 0xDFFF;
+
+// ASCII runs: narrow the run starting at text[i] a whole vector at a time, stopping at the first vector holding
+// a non-ASCII unit (or with fewer units left than one vector)
+using CopyAsciiRun = void (*)(const char16_t* text, size_t size, size_t& i, char*& out) noexcept;
+
+void copyAsciiRunScalar(const char16_t*, size_t, size_t&, char*&) noexcept {}
+
+#ifdef VELOCITYDB_SIMD_X86
+void copyAsciiRunSse2(const char16_t* text, size_t size, size_t& i, char*& out) noexcept {
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= size; i += 8, out += 8) {
+        const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, nonAscii), zero)) != 0xFFFF) {
+            return;
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(units, units));
+    }
+}
+
+VELOCITYDB_TARGET("avx2")
+void copyAsciiRunAvx2(const char16_t* text, size_t size, size_t& i, char*& out) noexcept {
+    const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    for (; i + 16 <= size; i += 16, out += 16) {
+        const __m256i units = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        if (!_mm256_testz_si256(units, nonAscii)) {
+            return;
+        }
+        // packus narrows within each 128-bit lane; gather both lanes' low halves into the low 16 bytes
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(units, units), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+    }
+}
+
+VELOCITYDB_TARGET("avx512f,avx512bw")
+void copyAsciiRunAvx512(const char16_t* text, size_t size, size_t& i, char*& out) noexcept {
+    const __m512i nonAscii = _mm512_set1_epi16(static_cast<short>(0xFF80));
+    for (; i + 32 <= size; i += 32, out += 32) {
+        const __m512i units = _mm512_loadu_si512(text + i);
+        if (_mm512_test_epi16_mask(units, nonAscii) != 0) {
+            return;
+        }
+        _mm512_mask_cvtepi16_storeu_epi8(out, ~__mmask32{0}, units);
+    }
+}
+#endif
+
+[[nodiscard]] CopyAsciiRun copyAsciiRunFor(SimdLevel level) noexcept {
+#ifdef VELOCITYDB_SIMD_X86
+    switch (level) {
+        case SimdLevel::AVX512:
+            return copyAsciiRunAvx512;
+        case SimdLevel::AVX2:
+            return copyAsciiRunAvx2;
+        case SimdLevel::SSE42:
+            return copyAsciiRunSse2;
+        case SimdLevel::Scalar:
+            break;
+    }
+#endif
+    (void)level;
+    return copyAsciiRunScalar;
+}
+
+/// Encode the code point starting at text[i] (one unit, or two for a surrogate pair)
+inline void encodeOne(const char16_t* text, size_t size, size_t& i, char*& out) noexcept {
+    const char16_t unit = text[i++];
+    if (unit < 0x80) {
+        *out++ = static_cast<char>(unit);
+        return;
+    }
+    if (unit < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (unit >> 6));
+        out[1] = static_cast<char>(0x80 | (unit & 0x3F));
+        out += 2;
+        return;
+    }
+    if (unit < HIGH_SURROGATE_FIRST || unit > SURROGATE_LAST) [[likely]] {
+        out[0] = static_cast<char>(0xE0 | (unit >> 12));
+        out[1] = static_cast<char>(0x80 | ((unit >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (unit & 0x3F));
+        out += 3;
+        return;
+    }
+    if (unit < LOW_SURROGATE_FIRST && i < size && text[i] >= LOW_SURROGATE_FIRST && text[i] <= SURROGATE_LAST) {
+        const uint32_t codePoint = 0x10000 + ((static_cast<uint32_t>(unit - HIGH_SURROGATE_FIRST) << 10) | static_cast<uint32_t>(text[i++] - LOW_SURROGATE_FIRST));
+        out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        out += 4;
+        return;
+    }
+    // Unpaired surrogate: U+FFFD REPLACEMENT CHARACTER
+    out[0] = static_cast<char>(0xEF);
+    out[1] = static_cast<char>(0xBF);
+    out[2] = static_cast<char>(0xBD);
+    out += 3;
+}
+
+}  // namespace
+
+size_t utf16ToUtf8(std::u16string_view text, char* dst) noexcept {
+    const char16_t* units = text.data();
+    const size_t size = text.size();
+    const auto copyAsciiRun = copyAsciiRunFor(activeSimdLevel());
+    char* out = dst;
+    size_t i = 0;
+    while (i < size) {
+        copyAsciiRun(units, size, i, out);
+        // Scalar through the vector that stopped the run (or the tail), then try the fast path again
+        const size_t scalarEnd = (std::min)(i + 32, size);
+        while (i < scalarEnd) {
+            encodeOne(units, size, i, out);
+        }
+    }
+    return static_cast<size_t>(out - dst);
+}
+
+void appendUtf16AsUtf8(std::string& out, std::u16string_view text) {
+    const size_t start = out.size();
+    out.resize_and_overwrite(start + utf8CapacityFor(text.size()), [&](char* data, size_t) { return start + utf16ToUtf8(text, data + start); });
+}
+
+}  // namespace velocitydb
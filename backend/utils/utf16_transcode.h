@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace velocitydb {
+
+/// Worst-case UTF-8 size of `units` UTF-16 code units (a surrogate pair is 2 units for 4 bytes)
+[[nodiscard]] constexpr size_t utf8CapacityFor(size_t units) noexcept {
+    return units * 3;
+}
+
+/// Transcode UTF-16 to UTF-8 into `dst`, which must hold utf8CapacityFor(text.size()) bytes; returns the
+/// bytes written. Runs of ASCII are narrowed 32 (AVX-512), 16 (AVX2) or 8 (SSE2) code units at a time, by
+/// activeSimdLevel(). Unpaired surrogates become U+FFFD, as WideCharToMultiByte does.
+size_t utf16ToUtf8(std::u16string_view text, char* dst) noexcept;
+
+/// Append the UTF-8 form of `text` to `out`
+void appendUtf16AsUtf8(std::string& out, std::u16string_view text);
+
+}  // namespace velocitydb
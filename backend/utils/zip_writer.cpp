@@ -0,0 +1,169 @@
+#include "zip_writer.h"
+
+#include "crc32.h"
+
+#include <array>
+
+namespace velocitydb {
+
+namespace {
+
+constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+constexpr uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+constexpr uint32_t END_OF_CENTRAL_SIGNATURE = 0x06054b50;
+constexpr uint32_t ZIP64_END_OF_CENTRAL_SIGNATURE = 0x06064b50;
+constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+
+constexpr uint16_t VERSION_STORED = 20;
+constexpr uint16_t VERSION_ZIP64 = 45;
+constexpr uint16_t FLAG_DATA_DESCRIPTOR = 0x0008;
+constexpr uint16_t FLAG_UTF8_NAMES = 0x0800;
+constexpr uint16_t METHOD_STORED = 0;
+constexpr uint16_t DOS_TIME = 0;       // 00:00:00
+constexpr uint16_t DOS_DATE = 0x0021;  // 1980-01-01
+
+}  // namespace
+
+bool ZipWriter::open(const std::string& filepath) {
+    m_entries.clear();
+    m_inEntry = false;
+    m_failed = false;
+    return m_writer.open(filepath);
+}
+
+void ZipWriter::writeLe16(uint16_t value) {
+    const std::array<char, 2> bytes = {static_cast<char>(value & 0xFF), static_cast<char>(value >> 8)};
+    m_writer.append(std::string_view(bytes.data(), bytes.size()));
+}
+
+void ZipWriter::writeLe32(uint32_t value) {
+    writeLe16(static_cast<uint16_t>(value & 0xFFFF));
+    writeLe16(static_cast<uint16_t>(value >> 16));
+}
+
+void ZipWriter::writeLe64(uint64_t value) {
+    writeLe32(static_cast<uint32_t>(value & 0xFFFFFFFFu));
+    writeLe32(static_cast<uint32_t>(value >> 32));
+}
+
+void ZipWriter::beginEntry(std::string_view name) {
+    if (m_inEntry) {
+        endEntry();
+    }
+    m_entries.push_back({.name = std::string(name), .localHeaderOffset = m_writer.bytesWritten()});
+    m_inEntry = true;
+    m_crc = 0;
+    m_entrySize = 0;
+
+    // CRC and sizes are zero here and follow the data in a descriptor
+    writeLe32(LOCAL_HEADER_SIGNATURE);
+    writeLe16(VERSION_STORED);
+    writeLe16(FLAG_DATA_DESCRIPTOR | FLAG_UTF8_NAMES);
+    writeLe16(METHOD_STORED);
+    writeLe16(DOS_TIME);
+    writeLe16(DOS_DATE);
+    writeLe32(0);
+    writeLe32(0);
+    writeLe32(0);
+    writeLe16(static_cast<uint16_t>(name.size()));
+    writeLe16(0);
+    m_writer.append(name);
+}
+
+void ZipWriter::write(std::string_view data) {
+    m_crc = updateCrc32(m_crc, data);
+    m_entrySize += data.size();
+    m_writer.append(data);
+}
+
+bool ZipWriter::endEntry() {
+    if (!m_inEntry) {
+        return !failed();
+    }
+    m_inEntry = false;
+    if (m_entrySize > MAX_ENTRY_BYTES) [[unlikely]] {
+        m_failed = true;
+        return false;
+    }
+    auto& entry = m_entries.back();
+    entry.crc = m_crc;
+    entry.size = static_cast<uint32_t>(m_entrySize);
+
+    writeLe32(DATA_DESCRIPTOR_SIGNATURE);
+    writeLe32(entry.crc);
+    writeLe32(entry.size);  // compressed size (stored)
+    writeLe32(entry.size);
+    return !failed();
+}
+
+bool ZipWriter::close() {
+    if (!m_writer.isOpen()) {
+        return !failed();
+    }
+    endEntry();
+
+    const uint64_t centralOffset = m_writer.bytesWritten();
+    for (const auto& entry : m_entries) {
+        const bool zip64Offset = entry.localHeaderOffset >= 0xFFFFFFFFull;
+        writeLe32(CENTRAL_HEADER_SIGNATURE);
+        writeLe16(zip64Offset ? VERSION_ZIP64 : VERSION_STORED);  // made by (MS-DOS attributes)
+        writeLe16(zip64Offset ? VERSION_ZIP64 : VERSION_STORED);
+        writeLe16(FLAG_DATA_DESCRIPTOR | FLAG_UTF8_NAMES);
+        writeLe16(METHOD_STORED);
+        writeLe16(DOS_TIME);
+        writeLe16(DOS_DATE);
+        writeLe32(entry.crc);
+        writeLe32(entry.size);
+        writeLe32(entry.size);
+        writeLe16(static_cast<uint16_t>(entry.name.size()));
+        writeLe16(zip64Offset ? 12 : 0);  // extra field length
+        writeLe16(0);                     // comment length
+        writeLe16(0);                     // disk number
+        writeLe16(0);                     // internal attributes
+        writeLe32(0);                     // external attributes
+        writeLe32(zip64Offset ? 0xFFFFFFFFu : static_cast<uint32_t>(entry.localHeaderOffset));
+        m_writer.append(entry.name);
+        if (zip64Offset) {
+            writeLe16(0x0001);  // ZIP64 extended information
+            writeLe16(8);
+            writeLe64(entry.localHeaderOffset);
+        }
+    }
+    const uint64_t centralEnd = m_writer.bytesWritten();
+    const uint64_t centralSize = centralEnd - centralOffset;
+
+    const bool zip64 = centralOffset >= 0xFFFFFFFFull || m_entries.size() >= 0xFFFF;
+    if (zip64) {
+        writeLe32(ZIP64_END_OF_CENTRAL_SIGNATURE);
+        writeLe64(44);  // size of the remaining record
+        writeLe16(VERSION_ZIP64);
+        writeLe16(VERSION_ZIP64);
+        writeLe32(0);
+        writeLe32(0);
+        writeLe64(m_entries.size());
+        writeLe64(m_entries.size());
+        writeLe64(centralSize);
+        writeLe64(centralOffset);
+
+        writeLe32(ZIP64_LOCATOR_SIGNATURE);
+        writeLe32(0);
+        writeLe64(centralEnd);
+        writeLe32(1);
+    }
+
+    const auto entryCount = static_cast<uint16_t>(zip64 ? 0xFFFF : m_entries.size());
+    writeLe32(END_OF_CENTRAL_SIGNATURE);
+    writeLe16(0);
+    writeLe16(0);
+    writeLe16(entryCount);
+    writeLe16(entryCount);
+    writeLe32(zip64 ? 0xFFFFFFFFu : static_cast<uint32_t>(centralSize));
+    writeLe32(zip64 ? 0xFFFFFFFFu : static_cast<uint32_t>(centralOffset));
+    writeLe16(0);
+
+    const bool closed = m_writer.close();
+    return closed && !m_failed;
+}
+
+}  // namespace velocitydb
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "buffered_file_writer.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+
+/// Streaming ZIP archive writer. Entries are stored (no compression) and written sequentially
+/// with trailing data descriptors, so entry sizes never need to be known up front.
+/// Archives past 4 GB get ZIP64 central directory records; a single entry must stay below 4 GB.
+class ZipWriter {
+public:
+    static constexpr uint64_t MAX_ENTRY_BYTES = 0xFFFFFFFFull;
+
+    ZipWriter() = default;
+    ~ZipWriter() = default;
+
+    ZipWriter(const ZipWriter&) = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+    ZipWriter(ZipWriter&&) = delete;
+    ZipWriter& operator=(ZipWriter&&) = delete;
+
+    [[nodiscard]] bool open(const std::string& filepath);
+
+    /// Start a new entry (ends the current one, if any)
+    void beginEntry(std::string_view name);
+    void write(std::string_view data);
+    bool endEntry();
+
+    /// Bytes written to the current entry so far
+    [[nodiscard]] uint64_t entryBytes() const noexcept { return m_entrySize; }
+    [[nodiscard]] bool failed() const noexcept { return m_failed || m_writer.failed(); }
+
+    /// Write the central directory and close the file. Returns false if anything failed.
+    bool close();
+
+private:
+    struct EntryRecord {
+        std::string name;
+        uint32_t crc = 0;
+        uint32_t size = 0;
+        uint64_t localHeaderOffset = 0;
+    };
+
+    void writeLe16(uint16_t value);
+    void writeLe32(uint32_t value);
+    void writeLe64(uint64_t value);
+
+    BufferedFileWriter m_writer;
+    std::vector<EntryRecord> m_entries;
+    bool m_inEntry = false;
+    bool m_failed = false;
+    uint32_t m_crc = 0;
+    uint64_t m_entrySize = 0;
+};
+
+}  // namespace velocitydb
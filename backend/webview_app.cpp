@@ -1,10 +1,15 @@
 #include "webview_app.h"
 
 #include "contexts/system_context.h"
+#include "interfaces/providers/async_query_provider.h"
+#include "interfaces/providers/connection_provider.h"
+#include "interfaces/providers/query_provider.h"
 #include "ipc_handler.h"
-#include "simdjson.h"
+#include "utils/binary_result.h"
+#include "utils/frontend_asset_pack.h"
 #include "utils/logger.h"
 #include "utils/settings_manager.h"
+#include "utils/startup_profiler.h"
 #include "webview.h"
 
 #include <array>
@@ -15,29 +20,13 @@ namespace velocitydb {
 
 namespace {
 
-// Extract the first string argument from a JSON array
-// webview's bind passes arguments as a JSON array, e.g., ["arg1", "arg2"]
-std::string extractFirstArgument(const std::string& jsonArray) {
-    try {
-        simdjson::dom::parser parser;
-        auto doc = parser.parse(jsonArray);
-        auto arr = doc.get_array();
-        if (arr.error()) {
-            return jsonArray;  // Fallback: treat as raw string
-        }
-        auto firstElem = arr.at(0);
-        if (firstElem.error()) {
-            return "";
-        }
-        auto strValue = firstElem.get_string();
-        if (strValue.error()) {
-            return "";
-        }
-        return std::string(strValue.value());
-    } catch (...) {
-        return jsonArray;  // Fallback: treat as raw string
-    }
-}
+// Release builds serve the page from memory and let the browser cache the content-hashed bundles;
+// debug builds reload everything from disk so a rebuilt frontend shows up immediately
+#ifdef _DEBUG
+constexpr bool SERVE_FROM_ASSET_PACK = false;
+#else
+constexpr bool SERVE_FROM_ASSET_PACK = true;
+#endif
 
 }  // namespace
 
@@ -47,14 +36,44 @@ WebViewApp::WebViewApp(HINSTANCE hInstance)
     , m_ipcHandler(std::make_unique<IPCHandler>(*m_systemContext))
     , m_webview(nullptr)
     , m_settingsManager(std::make_unique<SettingsManager>()) {
-    // Load settings
+    // Launch the WebView2 browser process first; it comes up while the rest of startup runs
+    {
+        auto timer = StartupProfiler::instance().phase("webview.environment");
+        m_webview = std::make_unique<webview::webview>(false, nullptr);
+        m_webview->prewarm();
+    }
+
+    if (SERVE_FROM_ASSET_PACK) {
+        if (auto frontendPath = locateFrontendDirectory()) {
+            m_assets = std::make_unique<FrontendAssetPack>(std::filesystem::absolute(*frontendPath).parent_path());
+            m_assetPreload = std::jthread([this] {
+                auto timer = StartupProfiler::instance().phase("frontend.preload");
+                const auto files = m_assets->preload();
+                log<LogLevel::INFO>(std::format("[WebView] Preloaded {} frontend files ({} KB)", files, m_assets->cachedBytes() / 1024));
+            });
+        }
+    }
+
+    // Window placement is needed before the window exists; everything else loads in SystemContext::warmUp
+    auto timer = StartupProfiler::instance().phase("settings.window");
     m_settingsManager->load();
 }
 
-WebViewApp::~WebViewApp() = default;
+WebViewApp::~WebViewApp() {
+    // In-flight requests answer through the webview, so finish them while it still exists
+    m_ipcHandler->shutdown();
+    // Async query workers outlive the webview, so stop them from pushing events into it first
+    m_systemContext->async_queries().setEventSink(nullptr);
+    m_systemContext->connections().setHealthEventSink(nullptr);
+    m_systemContext->connections().setTailEventSink(nullptr);
+}
 
 int WebViewApp::run() {
-    createAndConfigureWebView();
+    m_systemContext->warmUp();
+    {
+        auto timer = StartupProfiler::instance().phase("webview.create");
+        createAndConfigureWebView();
+    }
     m_webview->run();
     return 0;
 }
@@ -113,25 +132,43 @@ void WebViewApp::saveWindowSettings() {
 }
 
 void WebViewApp::createAndConfigureWebView() {
-    m_webview = std::make_unique<webview::webview>(false, nullptr);
-
     m_webview->set_title("Velocity-DB");
 
     // Calculate and set window size
     const auto windowSize = calculateWindowSize();
     m_webview->set_size(windowSize.width, windowSize.height, WEBVIEW_HINT_NONE);
 
-    // Disable browser cache to always load fresh content
-    m_webview->set_disable_cache(true);
-
-    m_webview->bind("invoke", [this](const std::string& request) -> std::string {
-        // webview passes arguments as a JSON array, extract the first string argument
-        auto actualRequest = extractFirstArgument(request);
-        auto result = m_ipcHandler->dispatchRequest(actualRequest);
-        return result;
-    });
+    // Without the asset pack the page comes from disk or the dev server: disable the cache to always load fresh content
+    m_webview->set_disable_cache(!m_assets);
+
+    // Requests are queued on the IPC handler's lanes and answered from there, so a slow server round trip
+    // never holds up the UI thread or requests of another kind
+    m_webview->bind_async("invoke", [this](std::string request, IPCHandler::Responder respond) { m_ipcHandler->dispatchAsync(std::move(request), std::move(respond)); });
+
+    // Async query state changes are pushed to the page as "backend:asyncQuery" events instead of being polled for
+    m_systemContext->async_queries().setEventSink([this](const std::string& eventJson) { m_webview->emit("asyncQuery", eventJson); });
+    // Server monitors push only what changed per sample, as "backend:serverHealth" events
+    m_systemContext->connections().setHealthEventSink([this](const std::string& eventJson) { m_webview->emit("serverHealth", eventJson); });
+    // Table tails push their snapshot, then only new or changed rows, as "backend:tableTail" events
+    m_systemContext->connections().setTailEventSink([this](const std::string& eventJson) { m_webview->emit("tableTail", eventJson); });
+
+    // Binary query results ("format":"binary") are fetched by the page from this host
+    m_webview->serve_resources(std::string(BINARY_RESULT_HOST), [this](const std::string& resultId) { return m_systemContext->queries().takeBinaryResult(resultId); });
+
+    if (m_assets) {
+        m_webview->serve_assets(std::string(FRONTEND_HOST), [this](const std::string& path) -> std::optional<webview::resource> {
+            auto asset = m_assets->find(path);
+            if (!asset) {
+                return std::nullopt;
+            }
+            return webview::resource{std::move(asset->body), std::string(asset->contentType), std::string(asset->cacheControl)};
+        });
+
+        log<LogLevel::INFO>(std::format("[WebView] Serving frontend from memory: {}", m_assets->root().string()));
+        log_flush();
 
-    if (auto frontendPath = locateFrontendDirectory()) {
+        m_webview->navigate(std::format("https://{}/index.html", FRONTEND_HOST));
+    } else if (auto frontendPath = locateFrontendDirectory()) {
         // Get the directory containing index.html
         auto frontendDir = std::filesystem::absolute(*frontendPath).parent_path();
         auto pathStr = frontendDir.string();
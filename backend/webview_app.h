@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <thread>
 
 namespace webview {
 class webview;
@@ -16,6 +17,7 @@ namespace velocitydb {
 class IPCHandler;
 class SystemContext;
 class SettingsManager;
+class FrontendAssetPack;
 
 class WebViewApp {
 public:
@@ -47,6 +49,9 @@ private:
     // Order matters: m_systemContext must outlive m_ipcHandler (holds reference to it)
     std::unique_ptr<SystemContext> m_systemContext;
     std::unique_ptr<IPCHandler> m_ipcHandler;
+    // Order matters: the webview serves from m_assets, which m_assetPreload fills
+    std::unique_ptr<FrontendAssetPack> m_assets;
+    std::jthread m_assetPreload;
     std::unique_ptr<webview::webview> m_webview;
     std::unique_ptr<SettingsManager> m_settingsManager;
 };
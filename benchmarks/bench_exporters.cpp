@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include "exporters/csv_exporter.h"
+#include "exporters/json_exporter.h"
+#include "synthetic_result.h"
+
+#include <filesystem>
+
+namespace velocitydb::bench {
+
+namespace {
+
+[[nodiscard]] std::string scratchFile(std::string_view name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void BM_CSVExport(benchmark::State& state) {
+    const auto result = makeResultSet({.rows = static_cast<size_t>(state.range(0))});
+    const auto path = scratchFile("velocitydb_bench.csv");
+    for (auto _ : state) {
+        CSVExporter exporter;
+        benchmark::DoNotOptimize(exporter.exportData(result, path));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_CSVExport)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/// range(1): pretty print
+void BM_JSONExport(benchmark::State& state) {
+    const auto result = makeResultSet({.rows = static_cast<size_t>(state.range(0))});
+    const auto path = scratchFile("velocitydb_bench.json");
+    for (auto _ : state) {
+        JSONExporter exporter;
+        exporter.setPrettyPrint(state.range(1) != 0);
+        benchmark::DoNotOptimize(exporter.exportData(result, path));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_JSONExport)->Args({100000, 0})->Args({100000, 1})->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace velocitydb::bench
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include "simd_levels.h"
+#include "synthetic_result.h"
+#include "utils/json_utils.h"
+#include "utils/utf16_transcode.h"
+
+namespace velocitydb::bench {
+
+namespace {
+
+void BM_SerializeResultSet(benchmark::State& state) {
+    const auto result = makeResultSet({.rows = static_cast<size_t>(state.range(0))});
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto json = JsonUtils::serializeResultSet(result, false);
+        bytes = json.size();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_SerializeResultSet)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/// range(0): SimdLevel; range(1): 0 = clean ASCII, 1 = every word needs escaping or is multi-byte
+void BM_EscapeString(benchmark::State& state) {
+    LevelScope level(state);
+    std::string input;
+    while (input.size() < 64 * 1024) {
+        input += state.range(1) == 0 ? "plain ascii text without specials " : "say \"hi\"\n\tback\\slash 東京 ";
+    }
+    for (auto _ : state) {
+        auto escaped = JsonUtils::escapeString(input);
+        benchmark::DoNotOptimize(escaped);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_EscapeString)->ArgsProduct({supportedLevels(), {0, 1}});
+
+/// range(0): SimdLevel. Grid-like text appended to a reused buffer: mostly clean cells with an occasional quote or newline
+void BM_AppendEscapedGridText(benchmark::State& state) {
+    LevelScope level(state);
+    const std::string_view cell = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+    std::string input;
+    for (size_t i = 0; input.size() < (4 << 20); ++i) {
+        input += cell;
+        input += (i % 16 == 0) ? '"' : (i % 16 == 8 ? '\n' : ' ');
+    }
+    std::string out;
+    out.reserve(input.size() + input.size() / 8);
+    for (auto _ : state) {
+        out.clear();
+        JsonUtils::appendEscaped(out, input);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_AppendEscapedGridText)->Apply(forEachLevel);
+
+/// range(0): SimdLevel; range(1): 0 = clean ASCII, 1 = one non-ASCII unit every 40
+void BM_Utf16ToUtf8(benchmark::State& state) {
+    LevelScope level(state);
+    std::u16string input;
+    while (input.size() < 64 * 1024) {
+        input += state.range(1) == 0 ? u"plain ascii text without specials, forty" : u"mixed text with one non-ASCII unit: 東京 ";
+    }
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        appendUtf16AsUtf8(out, input);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size() * sizeof(char16_t)));
+}
+BENCHMARK(BM_Utf16ToUtf8)->ArgsProduct({supportedLevels(), {0, 1}});
+
+}  // namespace
+
+}  // namespace velocitydb::bench
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include "parsers/a5er_parser.h"
+#include "parsers/sql_formatter.h"
+#include "parsers/sql_lexer.h"
+#include "parsers/sql_parser.h"
+#include "synthetic_result.h"
+
+#include <algorithm>
+
+namespace velocitydb::bench {
+
+namespace {
+
+void BM_SQLFormatterFormat(benchmark::State& state) {
+    const auto script = makeSqlScript(static_cast<size_t>(state.range(0)));
+    SQLFormatter formatter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(formatter.format(script));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(script.size()));
+}
+BENCHMARK(BM_SQLFormatterFormat)->Arg(10)->Arg(1000);
+
+/// Tokenizer alone, reported as tokens/s
+void BM_SQLFormatterTokenize(benchmark::State& state) {
+    const auto script = makeSqlScript(static_cast<size_t>(state.range(0)));
+    SQLFormatter formatter;
+    const auto tokens = formatter.countTokens(script);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(formatter.countTokens(script));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(tokens));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(script.size()));
+}
+BENCHMARK(BM_SQLFormatterTokenize)->Arg(10)->Arg(1000);
+
+/// Editor keyword-case pass over the last line only, against the whole-script uppercaseKeywords
+void BM_SQLFormatterUppercaseLastLine(benchmark::State& state) {
+    const auto script = makeSqlScript(static_cast<size_t>(state.range(0)));
+    const auto lastLine = static_cast<size_t>(std::ranges::count(script, '\n'));
+    SQLFormatter formatter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(formatter.uppercaseKeywordsInLines(script, lastLine, lastLine));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(script.size()));
+}
+BENCHMARK(BM_SQLFormatterUppercaseLastLine)->Arg(10)->Arg(1000);
+
+void BM_SQLParserSplitStatements(benchmark::State& state) {
+    const auto script = makeSqlScript(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SQLParser::splitStatements(script));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(script.size()));
+}
+BENCHMARK(BM_SQLParserSplitStatements)->Arg(10)->Arg(1000);
+
+/// The shared lexer alone; the parser and formatter entry points above pay this once per script
+void BM_SqlLexer(benchmark::State& state) {
+    const auto script = makeSqlScript(static_cast<size_t>(state.range(0)));
+    const auto tokens = SqlTokenStream(script).size();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SqlTokenStream(script).size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(tokens));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(script.size()));
+}
+BENCHMARK(BM_SqlLexer)->Arg(10)->Arg(1000);
+
+/// range(0): entities, 30 fields each
+void BM_A5ERParserParse(benchmark::State& state) {
+    const auto document = makeA5erDocument(static_cast<size_t>(state.range(0)), 30);
+    A5ERParser parser;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parse(document));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(document.size()));
+}
+BENCHMARK(BM_A5ERParserParse)->Arg(10)->Arg(500)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace velocitydb::bench
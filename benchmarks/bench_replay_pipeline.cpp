@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include "database/replay_driver.h"
+#include "utils/json_utils.h"
+
+#include <format>
+#include <memory>
+#include <stdexcept>
+
+namespace velocitydb::bench {
+
+namespace {
+
+/// A connected replay driver serving `rows` synthetic rows with no added latency
+std::unique_ptr<IDatabaseDriver> makeDriver(int64_t rows) {
+    auto driver = DriverFactory::createDriver(DriverType::Replay);
+    if (!driver->connect(std::format("SyntheticRows={}", rows))) {
+        throw std::runtime_error(driver->getLastError());
+    }
+    return driver;
+}
+
+/// Execute through the driver interface and serialize the grid, as executeQuery does
+void BM_ReplayExecuteToJson(benchmark::State& state) {
+    auto driver = makeDriver(state.range(0));
+    for (auto _ : state) {
+        auto json = JsonUtils::serializeResultSet(driver->execute("SELECT * FROM bench"), false);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReplayExecuteToJson)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/// range(1): rows per streamed batch
+void BM_ReplayStreaming(benchmark::State& state) {
+    auto driver = makeDriver(state.range(0));
+    for (auto _ : state) {
+        size_t bytes = 0;
+        CallbackBatchSink sink([&](const ResultSet& batch) {
+            bytes += batch.memoryBytes();
+            return true;
+        });
+        auto summary = driver->executeStreaming("SELECT * FROM bench", sink, static_cast<size_t>(state.range(1)));
+        benchmark::DoNotOptimize(bytes);
+        benchmark::DoNotOptimize(summary);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReplayStreaming)->Args({100000, 1024})->Args({100000, 16384})->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace velocitydb::bench
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include "database/result_cache.h"
+#include "synthetic_result.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace velocitydb::bench {
+
+namespace {
+
+constexpr size_t CACHE_KEYS = 1024;
+
+[[nodiscard]] std::vector<std::string> cacheKeys() {
+    std::vector<std::string> keys;
+    keys.reserve(CACHE_KEYS);
+    for (size_t i = 0; i < CACHE_KEYS; ++i) {
+        keys.push_back(ResultCache::makeKey("conn_1", std::format("SELECT * FROM dbo.orders WHERE id = {}", i)));
+    }
+    return keys;
+}
+
+[[nodiscard]] std::shared_ptr<const ResultSet> smallResult() {
+    return std::make_shared<const ResultSet>(makeResultSet({.rows = 100}));
+}
+
+/// Budget large enough for every key: pure insert/replace cost
+void BM_ResultCachePut(benchmark::State& state) {
+    ResultCache cache(1024 * 1024 * 1024);
+    const auto keys = cacheKeys();
+    const auto result = smallResult();
+    size_t i = 0;
+    for (auto _ : state) {
+        cache.put(keys[i++ % keys.size()], result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResultCachePut);
+
+void BM_ResultCacheGetHit(benchmark::State& state) {
+    ResultCache cache(1024 * 1024 * 1024);
+    const auto keys = cacheKeys();
+    const auto result = smallResult();
+    for (const auto& key : keys) {
+        cache.put(key, result);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResultCacheGetHit)->Threads(1)->Threads(4);
+
+void BM_ResultCacheGetMiss(benchmark::State& state) {
+    ResultCache cache;
+    const auto key = ResultCache::makeKey("conn_1", "SELECT 1");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(key));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResultCacheGetMiss);
+
+/// Budget of about 16 results: nearly every put evicts the least recently used entry
+void BM_ResultCachePutEvict(benchmark::State& state) {
+    const auto keys = cacheKeys();
+    const auto result = smallResult();
+    ResultCache sizing;
+    sizing.put(keys[0], result);
+    ResultCache cache(sizing.getCurrentSize() * 16);
+    size_t i = 0;
+    for (auto _ : state) {
+        cache.put(keys[i++ % keys.size()], result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResultCachePutEvict);
+
+}  // namespace
+
+}  // namespace velocitydb::bench
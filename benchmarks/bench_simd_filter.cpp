@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include "simd_levels.h"
+#include "synthetic_result.h"
+#include "utils/simd_filter.h"
+
+namespace velocitydb::bench {
+
+namespace {
+
+constexpr size_t FILTER_ROWS = 1'000'000;
+
+/// Generated once: a million rows take a while to build
+const ResultSet& filterData() {
+    static const ResultSet data = makeResultSet({.rows = FILTER_ROWS, .textColumns = 1, .intColumns = 2, .doubleColumns = 1});
+    return data;
+}
+
+void BM_FilterContainsText(benchmark::State& state) {
+    LevelScope level(state);
+    SIMDFilter filter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.filterContains(filterData(), 0, "東京"));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(FILTER_ROWS));
+}
+BENCHMARK(BM_FilterContainsText)->Apply(forEachLevel)->Unit(benchmark::kMillisecond);
+
+void BM_FilterEqualsText(benchmark::State& state) {
+    LevelScope level(state);
+    SIMDFilter filter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.filterEquals(filterData(), 0, "alpha 123"));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(FILTER_ROWS));
+}
+BENCHMARK(BM_FilterEqualsText)->Apply(forEachLevel)->Unit(benchmark::kMillisecond);
+
+void BM_FilterRangeInt(benchmark::State& state) {
+    LevelScope level(state);
+    SIMDFilter filter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.filterRange(filterData(), 2, "-1000", "250000"));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(FILTER_ROWS));
+}
+BENCHMARK(BM_FilterRangeInt)->Apply(forEachLevel)->Unit(benchmark::kMillisecond);
+
+void BM_FilterRangeDouble(benchmark::State& state) {
+    LevelScope level(state);
+    SIMDFilter filter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.filterRange(filterData(), 3, "0", "1000"));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(FILTER_ROWS));
+}
+BENCHMARK(BM_FilterRangeDouble)->Apply(forEachLevel)->Unit(benchmark::kMillisecond);
+
+/// An identity-like key filtered to 1% of its range; range(0): 0 = full scan, 1 = zone maps folded in
+void BM_FilterRangeClusteredKey(benchmark::State& state) {
+    ResultSet data;
+    data.columns.push_back({.name = "id"});
+    auto& column = data.columnData.emplace_back(ColumnDataType::Int64);
+    for (size_t row = 0; row < FILTER_ROWS; ++row) {
+        column.appendInt64(static_cast<int64_t>(row));
+    }
+    if (state.range(0) == 1) {
+        data.updateStats();
+    }
+    SIMDFilter filter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.filterRange(data, 0, "500000", "509999"));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(FILTER_ROWS));
+}
+BENCHMARK(BM_FilterRangeClusteredKey)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+/// range(0): column (0 = text, 2 = int)
+void BM_SortByColumn(benchmark::State& state) {
+    SIMDFilter filter;
+    const auto column = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.sortByColumn(filterData(), column, true));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(FILTER_ROWS));
+}
+BENCHMARK(BM_SortByColumn)->Arg(0)->Arg(2)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace velocitydb::bench
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "utils/cpu_features.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace velocitydb::bench {
+
+/// Every kernel variant the CPU supports, for ArgsProduct()
+inline std::vector<int64_t> supportedLevels() {
+    std::vector<int64_t> levels;
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectedSimdLevel()) {
+            levels.push_back(static_cast<int64_t>(level));
+        }
+    }
+    return levels;
+}
+
+/// Every kernel variant the CPU supports, as range(0)
+inline void forEachLevel(benchmark::internal::Benchmark* bench) {
+    for (const auto level : supportedLevels()) {
+        bench->Arg(level);
+    }
+}
+
+/// Caps the kernels at the level in range(0), restored to the detected level afterwards
+class LevelScope {
+public:
+    explicit LevelScope(benchmark::State& state) {
+        const auto level = static_cast<SimdLevel>(state.range(0));
+        limitSimdLevel(level);
+        state.SetLabel(std::string(simdLevelName(level)));
+    }
+    ~LevelScope() { limitSimdLevel(detectedSimdLevel()); }
+
+    LevelScope(const LevelScope&) = delete;
+    LevelScope& operator=(const LevelScope&) = delete;
+};
+
+}  // namespace velocitydb::bench
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "database/result_set.h"
+
+#include <array>
+#include <cstdint>
+#include <format>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace velocitydb::bench {
+
+/// Column mix of a generated result. The same shape and seed always produce the same cells.
+struct SyntheticShape {
+    size_t rows = 10000;
+    size_t textColumns = 4;
+    size_t intColumns = 2;
+    size_t doubleColumns = 1;
+    size_t nullEvery = 17;  ///< Every Nth cell of a column is NULL (0 = never)
+    uint32_t seed = 42;
+};
+
+/// Words mixing plain ASCII, characters JSON/CSV must escape and multi-byte UTF-8, roughly like real grids
+inline constexpr std::array<std::string_view, 16> SYNTHETIC_WORDS = {
+    "alpha", "bravo", "charlie", "delta", "東京", "大阪", "say \"hi\"", "comma,separated",
+    "line\nbreak", "tab\there", "O'Brien", "back\\slash", "customer", "order", "invoice", "ünïcödé",
+};
+
+/// Text columns hold one to four words plus a row number, so values repeat but are rarely identical
+[[nodiscard]] inline ResultSet makeResultSet(const SyntheticShape& shape) {
+    ResultSet result;
+    std::mt19937 rng(shape.seed);
+    std::uniform_int_distribution<size_t> wordPick(0, SYNTHETIC_WORDS.size() - 1);
+    std::uniform_int_distribution<size_t> wordCount(1, 4);
+    std::uniform_int_distribution<int64_t> intValue(-1'000'000, 1'000'000);
+    std::uniform_real_distribution<double> doubleValue(-1e6, 1e6);
+
+    const auto isNull = [&](size_t row, size_t col) { return shape.nullEvery != 0 && (row + col) % shape.nullEvery == 0; };
+
+    for (size_t c = 0; c < shape.textColumns; ++c) {
+        result.columns.push_back({.name = std::format("text_{}", c), .type = "NVARCHAR", .size = 200, .nullable = true, .isPrimaryKey = false});
+        result.columnData.emplace_back(ColumnDataType::Text);
+    }
+    for (size_t c = 0; c < shape.intColumns; ++c) {
+        result.columns.push_back({.name = std::format("int_{}", c), .type = "BIGINT", .size = 19, .nullable = true, .isPrimaryKey = c == 0});
+        result.columnData.emplace_back(ColumnDataType::Int64);
+    }
+    for (size_t c = 0; c < shape.doubleColumns; ++c) {
+        result.columns.push_back({.name = std::format("double_{}", c), .type = "FLOAT", .size = 53, .nullable = true, .isPrimaryKey = false});
+        result.columnData.emplace_back(ColumnDataType::Double);
+    }
+
+    std::string text;
+    for (size_t row = 0; row < shape.rows; ++row) {
+        size_t col = 0;
+        for (size_t c = 0; c < shape.textColumns; ++c, ++col) {
+            if (isNull(row, col)) {
+                result.columnData[col].appendNull();
+                continue;
+            }
+            text.clear();
+            for (size_t w = wordCount(rng); w > 0; --w) {
+                text += SYNTHETIC_WORDS[wordPick(rng)];
+                text += ' ';
+            }
+            text += std::to_string(row);
+            result.columnData[col].appendText(text);
+        }
+        for (size_t c = 0; c < shape.intColumns; ++c, ++col) {
+            if (isNull(row, col)) {
+                result.columnData[col].appendNull();
+            } else {
+                result.columnData[col].appendInt64(c == 0 ? static_cast<int64_t>(row) : intValue(rng));
+            }
+        }
+        for (size_t c = 0; c < shape.doubleColumns; ++c, ++col) {
+            if (isNull(row, col)) {
+                result.columnData[col].appendNull();
+            } else {
+                result.columnData[col].appendDouble(doubleValue(rng));
+            }
+        }
+    }
+    return result;
+}
+
+/// A `statements`-long T-SQL script with comments, string literals containing semicolons, and GO-free batches
+[[nodiscard]] inline std::string makeSqlScript(size_t statements) {
+    std::string script;
+    for (size_t i = 0; i < statements; ++i) {
+        switch (i % 4) {
+            case 0:
+                script += std::format("SELECT c.id, c.name, o.total FROM dbo.customers c JOIN dbo.orders o ON o.customer_id = c.id WHERE c.region = N'east;{}' ORDER BY o.total DESC;\n", i);
+                break;
+            case 1:
+                script += std::format("-- update batch {}; not a statement boundary\nUPDATE dbo.orders SET status = 'shipped' WHERE id = {};\n", i, i);
+                break;
+            case 2:
+                script += std::format("/* block; comment */ INSERT INTO dbo.audit (event, at) VALUES ('row {}', SYSDATETIME());\n", i);
+                break;
+            default:
+                script += std::format("SELECT COUNT(*) AS n, [weird;name] FROM dbo.[table {}] GROUP BY [weird;name] HAVING COUNT(*) > {};\n", i, i % 7);
+                break;
+        }
+    }
+    return script;
+}
+
+/// A5:ER text-format document with `entities` entities of `fields` fields each
+[[nodiscard]] inline std::string makeA5erDocument(size_t entities, size_t fields) {
+    std::string doc = "# A5:ER FORMAT:19\n# A5:ER ENCODING:UTF8\n\n[Manager]\nProjectName=bench\n\n";
+    for (size_t e = 0; e < entities; ++e) {
+        doc += std::format("[Entity]\nPName=table_{0}\nLName=テーブル{0}\nComment=generated\nPage=MAIN\nLeft={1}\nTop={2}\n", e, (e % 10) * 300, (e / 10) * 200);
+        for (size_t f = 0; f < fields; ++f) {
+            doc += std::format("Field=\"col_{0}\",\"カラム{0}\",\"{1}\",{2},{3},\"\",\"comment {0}\"\n", f, f % 3 == 0 ? "INT" : "NVARCHAR(100)", f == 0 ? "\"NOT NULL\"" : "", f == 0 ? "0" : "");
+        }
+        doc += std::format("Index=IX_table_{0}_col_1=0,col_1\nDEL\n\n", e);
+    }
+    return doc;
+}
+
+}  // namespace velocitydb::bench
@@ -1,4 +1,41 @@
-import type { AsyncQueryResultResponse, IPCRequest, IPCResponse } from '../types';
+import type {
+  AdmissionLimits,
+  AdmissionStatsResponse,
+  AggregateSpec,
+  AsyncQueryEvent,
+  AsyncQueryResultResponse,
+  AsyncQueryRowsPage,
+  BroadcastProgressResponse,
+  Column,
+  ColumnStatsResponse,
+  ConnectionBatchProgressResponse,
+  ConnectionTuning,
+  ExecutionPlanResponse,
+  ExportProgressResponse,
+  FileDatasourceProgress,
+  FilterExpression,
+  ImportProgressResponse,
+  IndexAdvice,
+  InstanceSearchProgressResponse,
+  OpenTableResult,
+  IPCRequest,
+  PacketSizeBenchmarkResult,
+  PlanDiffResponse,
+  IPCResponse,
+  ObjectSearchResult,
+  QueryStoreRanking,
+  QueryStoreReport,
+  ResultSnapshotInfo,
+  ServerHealthEvent,
+  ServerHealthHistory,
+  TableTailEvent,
+  RowEditRequest,
+  ScriptRunProgressResponse,
+  SqlLineEdit,
+  SqlLineRange,
+  WorkloadReplayProgress,
+} from '../types';
+import { decodeBinaryResult, isBinaryResultDescriptor, type BinaryResultDescriptor } from '../utils/binaryResult';
 import { DEFAULT_PAGE } from '../utils/erDiagramConstants';
 import type { ERDiagramModel } from '../utils/erDiagramParser';
 import { log } from '../utils/logger';
@@ -120,27 +157,188 @@ export function toERDiagramModel(
   };
 }
 
+interface ExecuteQueryResponse {
+  columns: { name: string; type: string; comment?: string }[];
+  rows: string[][];
+  affectedRows: number;
+  executionTimeMs: number;
+  cached: boolean;
+  /** Present when keepResult was set: the result stays on the backend for getResultWindow and export */
+  resultHandle?: string;
+  /** Set when the fetch stopped at maxRows with more rows left on the server */
+  truncated?: boolean;
+  /** Cells holding only the start of a long value, as [row, column, totalBytes]; getCellValue reads the rest */
+  lobPreviews?: LobPreview[];
+}
+
+/** Answer to refreshQuery when the change is small: the rows to patch into the previous result */
+interface DeltaRefreshResponse {
+  columns: { name: string; type: string; comment?: string }[];
+  delta: {
+    refreshOf: string;
+    /** Matched on keyColumns; otherwise on whole rows, so an edited row is deleted and inserted */
+    keyed: boolean;
+    /** Row indices of the previous result */
+    deleted: number[];
+    /** Row indices of the new result, and their cells */
+    inserted: number[];
+    insertedRows: string[][];
+    /** [previous row, new row] pairs whose key matched but whose cells differ, and the new cells */
+    changed: [number, number][];
+    changedRows: string[][];
+    unchanged: number;
+  };
+  rowCount: number;
+  executionTimeMs: number;
+  cached: boolean;
+  resultHandle: string;
+}
+
+/** A cell cut to a preview: [row, column, full length in bytes (-1 when unknown)] */
+export type LobPreview = [number, number, number];
+
+/** One side of compareData: a query, or a whole table */
+type CompareSide = { connectionId: string } & ({ sql: string } | { table: string });
+
+/** One side of compareSchemas: a live connection, a saved snapshot or an ER diagram file */
+type SchemaSource = { connectionId: string } | { snapshotFile: string } | { erFile: string };
+
+/** Daily window of local time, "HH:MM" bounds; it spans midnight when end is before start */
+interface ScheduleWindow {
+  start: string;
+  end: string;
+}
+
+/** A scheduled background query; times are local, "YYYY-MM-DDTHH:MM" */
+interface ScheduledQueryJob {
+  id: string;
+  connectionId: string;
+  sql: string;
+  cron: string;
+  window: ScheduleWindow | null;
+  /** null when the schedule never matches again */
+  nextRun: string | null;
+  running: boolean;
+  runs: number;
+  /** Runs not started because the previous one was still going */
+  skipped: number;
+  lastStart: string | null;
+  lastDurationMs: number;
+  lastRun: { success: boolean; rows: number; error: string } | null;
+}
+
+/** Grid view over a held result: the first sorted column, then the filter */
+interface ResultView {
+  sortModel?: Array<{ colId: string; sort: 'asc' | 'desc' }>;
+  filter?: FilterExpression;
+}
+
 function isIPCResponse(obj: unknown): obj is IPCResponse {
   return typeof obj === 'object' && obj !== null && 'success' in obj;
 }
 
+/**
+ * Calls that run user SQL, open dialogs or cancel work cross the bridge on their own:
+ * a batch answers only once its slowest entry is done.
+ */
+const UNBATCHED_METHODS = new Set([
+  'executeQuery',
+  'executeQueryPaginated',
+  'executeAsyncQuery',
+  'getRowCount',
+  'getResultWindow',
+  'getCellValue',
+  'searchResult',
+  'compareData',
+  'joinResults',
+  'saveResultSnapshot',
+  'openResultSnapshot',
+  'openFileDatasource',
+  'compareSchemas',
+  'benchmarkPacketSizes',
+  'getERModel',
+  'exportSchemaDDL',
+  'getExecutionPlan',
+  'getQueryStoreInsights',
+  'getIndexAdvice',
+  'openTable',
+  'startServerMonitor',
+  'stopServerMonitor',
+  'startTableTail',
+  'stopTableTail',
+  'applyEdits',
+  'saveGridEdits',
+  'commit',
+  'cancelQuery',
+  'cancelAsyncQuery',
+  'browseFile',
+  'exportCSV',
+  'exportJSON',
+  'exportExcel',
+  'exportParquet',
+  'exportSqlInsert',
+]);
+
+interface QueuedCall {
+  request: IPCRequest;
+  resolve: (response: unknown) => void;
+  reject: (error: unknown) => void;
+}
+
 class Bridge {
+  private queuedCalls: QueuedCall[] = [];
+
+  /** Send one request; calls made in the same task share one {"batch":[...]} round trip */
+  private send(invoke: (request: string) => Promise<unknown>, request: IPCRequest): Promise<unknown> {
+    if (UNBATCHED_METHODS.has(request.method)) {
+      return invoke(JSON.stringify(request));
+    }
+    return new Promise((resolve, reject) => {
+      this.queuedCalls.push({ request, resolve, reject });
+      if (this.queuedCalls.length === 1) {
+        queueMicrotask(() => void this.flushQueuedCalls(invoke));
+      }
+    });
+  }
+
+  private async flushQueuedCalls(invoke: (request: string) => Promise<unknown>): Promise<void> {
+    const calls = this.queuedCalls;
+    this.queuedCalls = [];
+    try {
+      if (calls.length === 1) {
+        calls[0].resolve(await invoke(JSON.stringify(calls[0].request)));
+        return;
+      }
+      const raw = await invoke(JSON.stringify({ batch: calls.map((call) => call.request) }));
+      const combined: unknown = typeof raw === 'string' ? JSON.parse(raw) : raw;
+      const responses =
+        isIPCResponse(combined) && combined.success && Array.isArray(combined.data)
+          ? (combined.data as unknown[])
+          : null;
+      if (!responses || responses.length !== calls.length) {
+        throw new Error('Invalid batch response');
+      }
+      calls.forEach((call, i) => call.resolve(responses[i]));
+    } catch (error) {
+      for (const call of calls) {
+        call.reject(error);
+      }
+    }
+  }
+
   private async call<T>(method: string, params: Record<string, unknown> = {}): Promise<T> {
-    const request: IPCRequest = {
-      method,
-      params: JSON.stringify(params),
-    };
+    // params travel as a nested object so the backend parses the whole request once
+    const request: IPCRequest = { method, params };
 
     if (window.invoke) {
-      const requestStr = JSON.stringify(request);
-      // Skip logging for writeFrontendLog to prevent infinite loop
-      const shouldLog = method !== 'writeFrontendLog';
+      // Skip logging for writeFrontendLog(s) to prevent infinite loop
+      const shouldLog = !method.startsWith('writeFrontendLog');
 
       if (shouldLog) {
         log.debug(`[Bridge] Sending request: ${method}`);
       }
 
-      const responseRaw = await window.invoke(requestStr);
+      const responseRaw = await this.send(window.invoke, request);
 
       if (shouldLog) {
         log.debug(`[Bridge] Received response for ${method} (type: ${typeof responseRaw})`);
@@ -164,7 +362,7 @@ class Bridge {
 
       if (!response.success) {
         log.error(`[Bridge] Error response for ${method}: ${response.error}`);
-        throw new Error(response.error || 'Unknown error');
+        throw Object.assign(new Error(response.error || 'Unknown error'), { retriable: response.retriable === true });
       }
 
       if (shouldLog) {
@@ -210,7 +408,11 @@ class Bridge {
       password?: string;
       privateKeyPath?: string;
       keyPassphrase?: string;
+      channelWindowKb?: number;
+      compression?: boolean;
+      ciphers?: string;
     };
+    tuning?: ConnectionTuning;
   }): Promise<{ connectionId: string }> {
     // Build server string with port if provided
     const defaultPort =
@@ -247,7 +449,11 @@ class Bridge {
       password?: string;
       privateKeyPath?: string;
       keyPassphrase?: string;
+      channelWindowKb?: number;
+      compression?: boolean;
+      ciphers?: string;
     };
+    tuning?: ConnectionTuning;
   }): Promise<{ success: boolean; message: string }> {
     // Build server string with port if provided
     const defaultPort =
@@ -266,19 +472,176 @@ class Bridge {
     });
   }
 
+  /**
+   * Time the same fetch over one login per TDS packet size (default 4096/8192/16384/32767) and
+   * recommend the fastest. `connectionInfo` is testConnection's, server already carrying its port.
+   */
+  async benchmarkPacketSizes(
+    connectionInfo: Record<string, unknown>,
+    packetSizes?: number[],
+    rows?: number
+  ): Promise<{ results: PacketSizeBenchmarkResult[]; recommendedPacketSize: number }> {
+    return this.call('benchmarkPacketSizes', { ...connectionInfo, packetSizes, rows });
+  }
+
+  /**
+   * Test (or, with connect, open) many profiles at once; up to `parallelism` logins run concurrently.
+   * Each profile takes the same fields as testConnection (server already carrying its port) plus a
+   * `key` echoed in its result. Poll getConnectionBatchProgress with `since` = results seen so far.
+   */
+  async startConnectionBatch(
+    profiles: Array<Record<string, unknown> & { key?: string }>,
+    connect = false,
+    parallelism?: number
+  ): Promise<{ batchId: string; total: number }> {
+    return this.call('startConnectionBatch', { profiles, connect, parallelism });
+  }
+
+  async getConnectionBatchProgress(
+    batchId: string,
+    since = 0
+  ): Promise<ConnectionBatchProgressResponse> {
+    return this.call('getConnectionBatchProgress', { batchId, since });
+  }
+
+  async cancelConnectionBatch(batchId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelConnectionBatch', { batchId });
+  }
+
+  // Server health monitor
+  async startServerMonitor(params: {
+    connectionId: string;
+    intervalMs?: number;
+    topWaits?: number;
+    history?: number;
+  }): Promise<{ intervalMs: number }> {
+    return this.call('startServerMonitor', params);
+  }
+
+  async stopServerMonitor(connectionId: string): Promise<{ stopped: boolean }> {
+    return this.call('stopServerMonitor', { connectionId });
+  }
+
+  async getServerHealth(connectionId: string, since = 0): Promise<ServerHealthHistory> {
+    return this.call('getServerHealth', { connectionId, since });
+  }
+
+  /**
+   * Subscribe to the per-sample changes a server monitor pushes for one connection.
+   * Returns the unsubscribe function, or null when no backend is attached (dev mock).
+   */
+  onServerHealthEvent(connectionId: string, listener: (event: ServerHealthEvent) => void): (() => void) | null {
+    if (!window.invoke) {
+      return null;
+    }
+    const handler = (e: Event) => {
+      const detail = (e as CustomEvent<ServerHealthEvent>).detail;
+      if (detail?.connectionId === connectionId) {
+        listener(detail);
+      }
+    };
+    window.addEventListener('backend:serverHealth', handler);
+    return () => window.removeEventListener('backend:serverHealth', handler);
+  }
+
+  // Table tail
+  /**
+   * Follow new and changed rows of a table without re-running the query: Change Tracking when the
+   * table has it, otherwise rows past the highest key seen (keyColumn, or a detected monotonic key).
+   */
+  async startTableTail(params: {
+    connectionId: string;
+    table: string;
+    keyColumn?: string;
+    snapshotRows?: number;
+    intervalMs?: number;
+  }): Promise<{ tailId: string; intervalMs: number }> {
+    return this.call('startTableTail', params);
+  }
+
+  async stopTableTail(tailId: string): Promise<{ stopped: boolean }> {
+    return this.call('stopTableTail', { tailId });
+  }
+
+  /**
+   * Subscribe to one tail's events: the snapshot first, then only the rows that changed.
+   * Returns the unsubscribe function, or null when no backend is attached (dev mock).
+   */
+  onTableTailEvent(tailId: string, listener: (event: TableTailEvent) => void): (() => void) | null {
+    if (!window.invoke) {
+      return null;
+    }
+    const handler = (e: Event) => {
+      const detail = (e as CustomEvent<TableTailEvent>).detail;
+      if (detail?.tailId === tailId) {
+        listener(detail);
+      }
+    };
+    window.addEventListener('backend:tableTail', handler);
+    return () => window.removeEventListener('backend:tableTail', handler);
+  }
+
   // Query methods
+  /**
+   * @param format 'binary' fetches rows as a columnar buffer instead of JSON (large grids).
+   *               Multi-statement batches are still answered as JSON.
+   */
   async executeQuery(
     connectionId: string,
     sql: string,
-    useCache = true
-  ): Promise<{
-    columns: { name: string; type: string; comment?: string }[];
-    rows: string[][];
-    affectedRows: number;
-    executionTimeMs: number;
-    cached: boolean;
-  }> {
-    return this.call('executeQuery', { connectionId, sql, useCache });
+    useCache = true,
+    format: 'json' | 'binary' = 'json',
+    persistCache = false,
+    parallel = false,
+    batch = false,
+    keepResult = false,
+    maxRows = 0
+  ): Promise<ExecuteQueryResponse> {
+    const params: Record<string, unknown> = { connectionId, sql, useCache };
+    if (format === 'binary') params.format = format;
+    // Also keep the result in the on-disk cache tier so it survives restarts
+    if (persistCache) params.persistCache = true;
+    // Scripts: independent SELECTs run concurrently on pooled connections; USE and DML stay in order
+    if (parallel) params.parallel = true;
+    // Scripts: send every statement in one round trip and read the results back in order (ignored with parallel)
+    if (batch) params.batch = true;
+    // Hold the result on the backend so sorting, filtering, paging and export skip the server
+    if (keepResult) params.keepResult = true;
+    // Stop fetching after this many rows; the response says whether more were left (read-only queries)
+    if (maxRows > 0) params.maxRows = maxRows;
+    const data = await this.call<ExecuteQueryResponse | BinaryResultDescriptor>('executeQuery', params);
+    if (!isBinaryResultDescriptor(data)) {
+      return data;
+    }
+    const response = await fetch(data.url);
+    if (!response.ok) {
+      throw new Error(`Failed to fetch binary result (HTTP ${response.status})`);
+    }
+    return {
+      ...decodeBinaryResult(await response.arrayBuffer()),
+      cached: data.cached,
+      resultHandle: data.resultHandle,
+    };
+  }
+
+  /**
+   * Re-run a held query and get only what changed since the run held under previousHandle, which is
+   * released. Falls back to the full result when the change is large or the rows cannot be matched.
+   */
+  async refreshQuery(
+    connectionId: string,
+    sql: string,
+    previousHandle: string,
+    keyColumns?: string[]
+  ): Promise<ExecuteQueryResponse | DeltaRefreshResponse> {
+    return this.call('executeQuery', {
+      connectionId,
+      sql,
+      useCache: false,
+      keepResult: true,
+      refreshOf: previousHandle,
+      ...(keyColumns && { keyColumns }),
+    });
   }
 
   async executeQueryPaginated(
@@ -286,12 +649,17 @@ class Bridge {
     sql: string,
     startRow: number,
     endRow: number,
-    sortModel?: Array<{ colId: string; sort: 'asc' | 'desc' }>
+    sortModel?: Array<{ colId: string; sort: 'asc' | 'desc' }>,
+    includeRowCount = false
   ): Promise<{
     columns: { name: string; type: string }[];
     rows: string[][];
     affectedRows: number;
     executionTimeMs: number;
+    /** Exact count, present when the page came from a locally materialized result */
+    totalRows?: number;
+    /** Optimizer estimate, present for server-paged results when includeRowCount is set */
+    estimatedTotalRows?: number;
   }> {
     return this.call('executeQueryPaginated', {
       connectionId,
@@ -299,6 +667,7 @@ class Bridge {
       startRow,
       endRow,
       sortModel,
+      includeRowCount,
     });
   }
 
@@ -348,6 +717,63 @@ class Bridge {
     };
   }
 
+  /** Tables with their columns for the whole database, read server-side in one batch */
+  async getSchemaSnapshot(
+    connectionId: string,
+    refresh = false
+  ): Promise<
+    {
+      schema: string;
+      name: string;
+      type: string;
+      comment?: string;
+      columns: Column[];
+    }[]
+  > {
+    return this.call('getSchemaSnapshot', { connectionId, refresh });
+  }
+
+  // Whole-database schema written to `filepath` for a later compareSchemas
+  async saveSchemaSnapshot(
+    connectionId: string,
+    filepath: string
+  ): Promise<{ tables: number; columns: number; bytes: number }> {
+    return this.call('saveSchemaSnapshot', { connectionId, filepath });
+  }
+
+  // Ordered DDL turning `current` into `desired`; drops = false keeps objects missing from `desired`
+  async compareSchemas(
+    current: SchemaSource,
+    desired: SchemaSource,
+    drops = true
+  ): Promise<{
+    changes: { kind: string; object: string; sql: string }[];
+    script: string;
+    currentTables: number;
+    desiredTables: number;
+    introspectionMs: number;
+  }> {
+    return this.call('compareSchemas', { current, desired, drops });
+  }
+
+  // ER diagram of the connection's tables and foreign keys, read in one introspection batch; layout = false
+  // leaves every table at (0, 0)
+  async getERModel(
+    connectionId: string,
+    name?: string,
+    layout = true
+  ): Promise<ERDiagramParseResult> {
+    return this.call('getERModel', { connectionId, name, layout });
+  }
+
+  // CREATE script of a whole schema, referenced tables first; with `filepath` it is streamed there instead of returned
+  async exportSchemaDDL(
+    source: SchemaSource,
+    filepath?: string
+  ): Promise<{ script?: string; tables: number; bytes: number }> {
+    return this.call('exportSchemaDDL', { source, filepath });
+  }
+
   async getColumns(
     connectionId: string,
     table: string
@@ -377,6 +803,34 @@ class Bridge {
     return this.call('rollback', { connectionId });
   }
 
+  async savepoint(connectionId: string, name: string): Promise<void> {
+    return this.call('savepoint', { connectionId, name });
+  }
+
+  async rollbackToSavepoint(connectionId: string, name: string): Promise<void> {
+    return this.call('rollbackToSavepoint', { connectionId, name });
+  }
+
+  // All edits go to the server in one batch and apply all-or-nothing
+  async applyEdits(
+    connectionId: string,
+    schema: string | null,
+    table: string,
+    edits: RowEditRequest[]
+  ): Promise<{ affectedRows: number }> {
+    return this.call('applyEdits', { connectionId, ...(schema && { schema }), table, edits });
+  }
+
+  // Save edits to the table a held result reads, one prepared statement per row, and patch the held result
+  // with the rows as stored instead of re-running the query. `view` is the grid view `row` positions are in.
+  async saveGridEdits(
+    resultHandle: string,
+    edits: RowEditRequest[],
+    view: ResultView = {}
+  ): Promise<{ affectedRows: number; patched: boolean; rowCount: number; rows: (string[] | null)[] }> {
+    return this.call('saveGridEdits', { resultHandle, edits, ...view });
+  }
+
   // Export methods
   async exportCSV(data: unknown, filepath: string): Promise<void> {
     return this.call('exportCSV', { data, filepath });
@@ -386,13 +840,134 @@ class Bridge {
     return this.call('exportJSON', { data, filepath });
   }
 
+  // Streams a query into JSON: an array (pretty unless prettyPrint is false) or NDJSON, optionally gzip-compressed
+  async exportQueryJSON(params: {
+    connectionId: string;
+    sql: string;
+    filepath: string;
+    prettyPrint?: boolean;
+    ndjson?: boolean;
+    compression?: 'gzip' | 'none';
+  }): Promise<{ filepath: string }> {
+    return this.call('exportJSON', params);
+  }
+
   async exportExcel(data: unknown, filepath: string): Promise<void> {
     return this.call('exportExcel', { data, filepath });
   }
 
+  // Streams a query into a Parquet file with typed columns (LZ4 pages unless compression is 'none')
+  async exportParquet(params: {
+    connectionId: string;
+    sql: string;
+    filepath: string;
+    compression?: 'lz4' | 'none';
+  }): Promise<{ filepath: string }> {
+    return this.call('exportParquet', params);
+  }
+
+  // Streams a query into a seed script of multi-row INSERT statements (1000 rows each unless
+  // rowsPerStatement is lower), with a GO line after every goEvery statements when set
+  async exportSqlInsert(params: {
+    connectionId: string;
+    sql: string;
+    filepath: string;
+    table: string;
+    rowsPerStatement?: number;
+    goEvery?: number;
+  }): Promise<{ filepath: string }> {
+    return this.call('exportSqlInsert', params);
+  }
+
+  async startCSVExport(params: {
+    connectionId: string;
+    sql: string;
+    filepath: string;
+    delimiter?: string;
+    includeHeader?: boolean;
+    nullValue?: string;
+  }): Promise<{ exportId: string }> {
+    return this.call('startCSVExport', params);
+  }
+
+  // Exports a whole table as key ranges (from its statistics histogram) read concurrently on pooled lanes:
+  // one key-ordered file, or one file per range when ordered is false (required for parquet)
+  async startPartitionedExport(params: {
+    connectionId: string;
+    table: string;
+    filepath: string;
+    keyColumn?: string;
+    format?: 'csv' | 'ndjson' | 'parquet';
+    partitions?: number;
+    connections?: number;
+    ordered?: boolean;
+    delimiter?: string;
+    includeHeader?: boolean;
+    nullValue?: string;
+  }): Promise<{ exportId: string; parts: number; connections: number; keyColumn: string }> {
+    return this.call('startPartitionedExport', params);
+  }
+
+  async getExportProgress(exportId: string): Promise<ExportProgressResponse> {
+    return this.call('getExportProgress', { exportId });
+  }
+
+  async cancelExport(exportId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelExport', { exportId });
+  }
+
+  // Import methods
+  async startImport(params: {
+    connectionId: string;
+    filepath: string;
+    table: string;
+    format?: 'csv' | 'json';
+    delimiter?: string;
+    hasHeader?: boolean;
+    nullValue?: string;
+    batchRows?: number;
+    connections?: number;
+  }): Promise<{ importId: string }> {
+    return this.call('startImport', params);
+  }
+
+  async getImportProgress(importId: string): Promise<ImportProgressResponse> {
+    return this.call('getImportProgress', { importId });
+  }
+
+  async cancelImport(importId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelImport', { importId });
+  }
+
+  // Runs a .sql file on the session lane without loading it into the editor
+  async startScriptRun(params: {
+    connectionId: string;
+    filepath: string;
+    continueOnError?: boolean;
+  }): Promise<{ runId: string }> {
+    return this.call('startScriptRun', params);
+  }
+
+  // Errors are returned from the errorsSince-th one on, so a poll only gets the new ones
+  async getScriptRunProgress(runId: string, errorsSince = 0): Promise<ScriptRunProgressResponse> {
+    return this.call('getScriptRunProgress', { runId, errorsSince });
+  }
+
+  async cancelScriptRun(runId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelScriptRun', { runId });
+  }
+
   // SQL methods
-  async uppercaseKeywords(sql: string): Promise<{ sql: string }> {
-    return this.call('uppercaseKeywords', { sql });
+  async uppercaseKeywords(sql: string): Promise<{ sql: string }>;
+  async uppercaseKeywords(sql: string, lines: SqlLineRange): Promise<SqlLineEdit>;
+  async uppercaseKeywords(sql: string, lines?: SqlLineRange): Promise<{ sql: string } | SqlLineEdit> {
+    return this.call('uppercaseKeywords', { sql, ...lines });
+  }
+
+  async formatSQL(sql: string): Promise<{ sql: string }>;
+  async formatSQL(sql: string, lines: SqlLineRange): Promise<SqlLineEdit>;
+  async formatSQL(sql: string, lines?: SqlLineRange): Promise<{ sql: string } | SqlLineEdit> {
+    return this.call('formatSQL', { sql, ...lines });
   }
 
   // History methods
@@ -408,22 +983,116 @@ class Bridge {
     return this.call('getQueryHistory', {});
   }
 
+  // History grouped by query shape (literals parameterized), slowest p95 first; lastRun is in epoch seconds
+  async getQueryHistoryStats(
+    options: { minCount?: number; limit?: number } = {}
+  ): Promise<
+    {
+      fingerprint: string;
+      hash: string;
+      sql: string;
+      count: number;
+      failures: number;
+      p50ExecutionTimeMs: number;
+      p95ExecutionTimeMs: number;
+      totalExecutionTimeMs: number;
+      lastRun: number;
+    }[]
+  > {
+    return this.call('getQueryHistoryStats', options);
+  }
+
+  /**
+   * Replay a slice of the history (from/to in epoch seconds) on connectionId and compare latencies with the recorded ones.
+   * speedFactor 0 runs the queries back to back; writes are replayed only with includeWrites.
+   */
+  async startWorkloadReplay(
+    connectionId: string,
+    options: {
+      from?: number;
+      to?: number;
+      keyword?: string;
+      sourceConnectionId?: string;
+      limit?: number;
+      concurrency?: number;
+      speedFactor?: number;
+      includeWrites?: boolean;
+      regressionRatio?: number;
+      minRegressionMs?: number;
+    } = {}
+  ): Promise<{ replayId: string; total: number; skipped: number }> {
+    return this.call('startWorkloadReplay', { connectionId, ...options });
+  }
+
+  async getWorkloadReplayProgress(replayId: string): Promise<WorkloadReplayProgress> {
+    return this.call('getWorkloadReplayProgress', { replayId });
+  }
+
+  async cancelWorkloadReplay(replayId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelWorkloadReplay', { replayId });
+  }
+
   // ER diagram methods
   async parseERDiagram(params: {
     content?: string;
     filename?: string;
     filepath?: string;
+    layout?: boolean;
+    relayout?: boolean;
+    /** With filepath: also keep the parse on disk so the diagram reopens without parsing next session */
+    persistCache?: boolean;
   }): Promise<ERDiagramParseResult> {
     return this.call('parseERDiagram', params);
   }
 
+  /** Positions for tables at (0, 0), or for every table with relayout; the others keep theirs */
+  async layoutERModel(params: {
+    tables: {
+      name: string;
+      columns?: { name: string; type?: string }[];
+      posX?: number;
+      posY?: number;
+    }[];
+    relations?: { parentTable: string; childTable: string }[];
+    relayout?: boolean;
+  }): Promise<{
+    tables: { name: string; posX: number; posY: number; width: number; height: number }[];
+    placed: number;
+  }> {
+    return this.call('layoutERModel', params);
+  }
+
   // Execution plan methods
   async getExecutionPlan(
     connectionId: string,
     sql: string,
-    actual = false
-  ): Promise<{ plan: string; actual: boolean }> {
-    return this.call('getExecutionPlan', { connectionId, sql, actual });
+    actual = false,
+    top?: number,
+    refresh = false
+  ): Promise<ExecutionPlanResponse> {
+    return this.call('getExecutionPlan', { connectionId, sql, actual, top, refresh });
+  }
+
+  /** Compare two plans by id, or the two newest plans fetched for `sql` on `connectionId` */
+  async diffExecutionPlans(
+    params: { beforePlanId: string; afterPlanId: string } | { connectionId: string; sql: string }
+  ): Promise<PlanDiffResponse> {
+    return this.call('diffExecutionPlans', params);
+  }
+
+  async getQueryStoreInsights(params: {
+    connectionId: string;
+    database?: string;
+    windowMinutes?: number;
+    rankBy?: QueryStoreRanking;
+    top?: number;
+    refresh?: 'full';
+  }): Promise<QueryStoreReport> {
+    return this.call('getQueryStoreInsights', params);
+  }
+
+  async getIndexAdvice(connectionId: string, database?: string): Promise<IndexAdvice> {
+    return this.call('getIndexAdvice', { connectionId, database });
   }
 
   // Cache methods
@@ -431,6 +1100,26 @@ class Bridge {
     currentSizeBytes: number;
     maxSizeBytes: number;
     usagePercent: number;
+    entries: number;
+    hits: number;
+    misses: number;
+    staleRejections: number;
+    bytesSaved: number;
+    diskSizeBytes: number;
+    diskEntries: number;
+    heldResults: number;
+    heldBytes: number;
+    spilledResults: number;
+    spilledBytes: number;
+    /** Process-wide result memory budget and what each pool holds against it */
+    memory: {
+      budgetBytes: number;
+      usedBytes: number;
+      cacheBytes: number;
+      heldBytes: number;
+      inFlightBytes: number;
+      reclaimedBytes: number;
+    };
   }> {
     return this.call('getCacheStats', {});
   }
@@ -439,15 +1128,145 @@ class Bridge {
     return this.call('clearCache', {});
   }
 
+  /**
+   * Run a read-only query on a five-field cron schedule (local time) so its result is cached
+   * before anyone opens it. Passing an existing id replaces that job.
+   */
+  async scheduleQuery(request: {
+    connectionId: string;
+    sql: string;
+    cron: string;
+    window?: ScheduleWindow;
+    id?: string;
+  }): Promise<{ id: string; nextRun: string | null }> {
+    return this.call('scheduleQuery', request);
+  }
+
+  async listScheduledQueries(): Promise<{ jobs: ScheduledQueryJob[] }> {
+    return this.call('listScheduledQueries', {});
+  }
+
+  async unscheduleQuery(id: string): Promise<{ removed: boolean }> {
+    return this.call('unscheduleQuery', { id });
+  }
+
+  /** Start a job now, outside its window if need be */
+  async runScheduledQuery(id: string): Promise<{ started: boolean }> {
+    return this.call('runScheduledQuery', { id });
+  }
+
+  // Metrics methods
+  /** Counters/gauges are raw totals; rates are deltas between two calls divided by the uptimeSeconds delta */
+  async getMetrics(reset = false): Promise<{
+    uptimeSeconds: number;
+    counters: Record<string, number>;
+    gauges: Record<string, number>;
+    histograms: Record<
+      string,
+      { count: number; sum: number; mean: number; max: number; p50: number; p90: number; p99: number; p999: number }
+    >;
+  }> {
+    return this.call('getMetrics', reset ? { reset } : {});
+  }
+
+  // Tracing methods
+  async getQueryTrace(traceId?: number): Promise<{
+    traceId: number;
+    spans: {
+      name: string;
+      detail: string;
+      traceId: number;
+      thread: number;
+      depth: number;
+      startUs: number;
+      durationUs: number;
+    }[];
+  }> {
+    return this.call('getQueryTrace', traceId === undefined ? {} : { traceId });
+  }
+
+  /** Chrome trace event JSON (chrome://tracing, Perfetto) of one trace or, with `all`, of every recorded span */
+  async getQueryTraceChrome(options: { traceId?: number; all?: boolean } = {}): Promise<{
+    traceEvents: unknown[];
+  }> {
+    return this.call('getQueryTrace', { ...options, format: 'chrome' });
+  }
+
   // Async query methods
-  async executeAsyncQuery(connectionId: string, sql: string): Promise<{ queryId: string }> {
-    return this.call('executeAsyncQuery', { connectionId, sql });
+  async executeAsyncQuery(
+    connectionId: string,
+    sql: string,
+    priority?: 'interactive' | 'background',
+    parallel = false,
+    liveStats = false,
+    maxRows = 0,
+    tabId?: string
+  ): Promise<{ queryId: string }> {
+    return this.call('executeAsyncQuery', {
+      connectionId,
+      sql,
+      priority,
+      ...(parallel && { parallel }),
+      ...(liveStats && { liveStats }),
+      ...(maxRows > 0 && { maxRows }),
+      ...(tabId && { tabId }),
+    });
   }
 
   async getAsyncQueryResult(queryId: string): Promise<AsyncQueryResultResponse> {
     return this.call('getAsyncQueryResult', { queryId });
   }
 
+  async getAsyncQueryRows(
+    queryId: string,
+    offset: number,
+    limit: number,
+    statementIndex = 0
+  ): Promise<AsyncQueryRowsPage> {
+    return this.call('getAsyncQueryRows', { queryId, offset, limit, statementIndex });
+  }
+
+  // Filters the rows an async query has buffered; the query is never re-run
+  async filterAsyncQueryRows(
+    queryId: string,
+    columnIndex: number,
+    filterType: 'equals' | 'contains' | 'range',
+    filterValue: string,
+    filterValueMax?: string,
+    offset = 0,
+    limit = 1000,
+    statementIndex = 0
+  ): Promise<AsyncQueryRowsPage & { filteredRows: number }> {
+    return this.call('filterAsyncQueryRows', {
+      queryId,
+      columnIndex,
+      filterType,
+      filterValue,
+      filterValueMax,
+      offset,
+      limit,
+      statementIndex,
+    });
+  }
+
+  /**
+   * Subscribe to state changes the backend pushes for one async query.
+   * Returns the unsubscribe function, or null when no backend is attached (dev mock) and callers must poll.
+   */
+  onAsyncQueryEvent(queryId: string, listener: (event: AsyncQueryEvent) => void): (() => void) | null {
+    if (!window.invoke) {
+      return null;
+    }
+    const handler = (e: Event) => {
+      const detail = (e as CustomEvent<AsyncQueryEvent>).detail;
+      if (detail?.queryId === queryId) {
+        listener(detail);
+      }
+    };
+    window.addEventListener('backend:asyncQuery', handler);
+    return () => window.removeEventListener('backend:asyncQuery', handler);
+  }
+
   async cancelAsyncQuery(queryId: string): Promise<{ cancelled: boolean }> {
     return this.call('cancelAsyncQuery', { queryId });
   }
@@ -456,10 +1275,43 @@ class Bridge {
     return this.call('removeAsyncQuery', { queryId });
   }
 
-  async getActiveQueries(): Promise<string[]> {
+  /**
+   * First screen of a table from the catalog row estimate and a TOP (n) preview, without a full scan.
+   * The exact count, unless disabled, runs as a background async query reported under countQueryId.
+   */
+  async openTable(params: {
+    connectionId: string;
+    table: string;
+    rows?: number;
+    samplePercent?: number;
+    exactCount?: boolean;
+  }): Promise<OpenTableResult> {
+    return this.call('openTable', params);
+  }
+
+  async getActiveQueries(): Promise<{
+    queries: string[];
+    workers: number;
+    busyWorkers: number;
+    queuedInteractive: number;
+    queuedBackground: number;
+    peakQueueDepth: number;
+    submitted: number;
+    rejected: number;
+  }> {
     return this.call('getActiveQueries', {});
   }
 
+  // Admission control: per-server concurrency and weighted budget in front of queries, exports and broadcasts
+  async getAdmissionStats(connectionId?: string): Promise<AdmissionStatsResponse> {
+    return this.call('getAdmissionStats', connectionId ? { connectionId } : {});
+  }
+
+  /** Limits for the connection's server, or the default for every server when no connection is given */
+  async setAdmissionLimits(limits: Partial<AdmissionLimits>, connectionId?: string): Promise<AdmissionLimits> {
+    return this.call('setAdmissionLimits', { ...limits, ...(connectionId && { connectionId }) });
+  }
+
   // SIMD filter methods
   async filterResultSet(
     connectionId: string,
@@ -473,7 +1325,9 @@ class Bridge {
     rows: string[][];
     totalRows: number;
     filteredRows: number;
+    cached?: boolean;
     simdAvailable: boolean;
+    simdLevel?: string;
   }> {
     return this.call('filterResultSet', {
       connectionId,
@@ -485,6 +1339,257 @@ class Bridge {
     });
   }
 
+  // Same as filterResultSet, for a compound expression across columns
+  async filterResultSetWhere(
+    connectionId: string,
+    sql: string,
+    filter: FilterExpression
+  ): Promise<{
+    columns: { name: string; type: string }[];
+    rows: string[][];
+    totalRows: number;
+    filteredRows: number;
+    cached?: boolean;
+    simdAvailable: boolean;
+    simdLevel?: string;
+  }> {
+    return this.call('filterResultSet', { connectionId, sql, filter });
+  }
+
+  // GROUP BY over the held result: group columns followed by one column per aggregate
+  async aggregateResultSet(
+    connectionId: string,
+    sql: string,
+    groupBy: number[],
+    aggregates: AggregateSpec[],
+    filter?: FilterExpression
+  ): Promise<{
+    columns: { name: string; type: string }[];
+    rows: string[][];
+    totalRows: number;
+    groupCount: number;
+    cached?: boolean;
+  }> {
+    return this.call('aggregateResultSet', { connectionId, sql, groupBy, aggregates, ...(filter && { filter }) });
+  }
+
+  // Aggregate a file datasource by scanning the file in parallel batches
+  async aggregateFileDatasource(
+    resultHandle: string,
+    groupBy: number[],
+    aggregates: AggregateSpec[],
+    filter?: FilterExpression
+  ): Promise<{ columns: { name: string; type: string }[]; rows: string[][]; totalRows: number; groupCount: number }> {
+    return this.call('aggregateResultSet', { resultHandle, groupBy, aggregates, ...(filter && { filter }) });
+  }
+
+  // Rows inserted, deleted and changed from `left` to `right`, matched on `keyColumns`.
+  // Two tables with chunkChecksums only transfer the key-hash chunks whose server-side checksums differ.
+  async compareData(
+    left: CompareSide,
+    right: CompareSide,
+    keyColumns: string[],
+    options: { chunkChecksums?: boolean; chunks?: number } = {}
+  ): Promise<{
+    columns: { name: string; type: string }[];
+    keyColumns: number[];
+    inserted: { count: number; rows: string[][] };
+    deleted: { count: number; rows: string[][] };
+    changed: { count: number; rows: { before: string[]; after: string[]; columns: number[] }[] };
+    unchangedCount: number;
+    truncated: boolean;
+    chunks?: { total: number; mismatched: number };
+    executionTimeMs: number;
+  }> {
+    return this.call('compareData', { left, right, keyColumns, ...options });
+  }
+
+  /**
+   * Run one read-only query on many servers at once: each target is an open connection or a profile
+   * (testConnection fields), with an optional `key` naming its server in the merged `server` column.
+   * Poll getBroadcastProgress with `since` = results seen so far; once done it carries a resultHandle.
+   */
+  async startBroadcastQuery(
+    sql: string,
+    targets: Array<({ connectionId: string } | Record<string, unknown>) & { key?: string }>,
+    options: { parallelism?: number; timeoutSeconds?: number; maxRows?: number } = {}
+  ): Promise<{ broadcastId: string; total: number }> {
+    return this.call('startBroadcastQuery', { sql, targets, ...options });
+  }
+
+  async getBroadcastProgress(broadcastId: string, since = 0): Promise<BroadcastProgressResponse> {
+    return this.call('getBroadcastProgress', { broadcastId, since });
+  }
+
+  async cancelBroadcast(broadcastId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelBroadcast', { broadcastId });
+  }
+
+  // Save a held result (fetch order) as a .vdbr snapshot that reopens without the query
+  async saveResultSnapshot(resultHandle: string, filepath: string): Promise<ResultSnapshotInfo & { executionTimeMs: number }> {
+    return this.call('saveResultSnapshot', { resultHandle, filepath });
+  }
+
+  // Reopen a snapshot as a held result for a grid tab
+  async openResultSnapshot(filepath: string): Promise<ResultSnapshotInfo & { resultHandle: string; executionTimeMs: number }> {
+    return this.call('openResultSnapshot', { filepath });
+  }
+
+  // Schema and column statistics of a snapshot, without reading its rows
+  async inspectResultSnapshot(filepath: string): Promise<ResultSnapshotInfo> {
+    return this.call('openResultSnapshot', { filepath, statsOnly: true });
+  }
+
+  /**
+   * Query a CSV or JSON Lines file in place. The handle works with getRows, getResultWindow (filter, no sort),
+   * getCellValue and aggregateFileDatasource; the row count arrives once background indexing is done.
+   */
+  async openFileDatasource(
+    filepath: string,
+    options: { delimiter?: string; hasHeader?: boolean; nullValue?: string } = {}
+  ): Promise<{ resultHandle: string; columns: { name: string; type: string }[]; format: 'csv' | 'jsonl'; totalBytes: number }> {
+    return this.call('openFileDatasource', { filepath, ...options });
+  }
+
+  async getFileDatasourceProgress(resultHandle: string): Promise<FileDatasourceProgress> {
+    return this.call('getFileDatasourceProgress', { resultHandle });
+  }
+
+  /**
+   * Join two held results (any connections) on pairs of columns, hashing the smaller one.
+   * The output is left columns then right non-key columns, held under a new resultHandle.
+   */
+  async joinResults(
+    leftHandle: string,
+    rightHandle: string,
+    leftColumns: string[],
+    rightColumns: string[],
+    joinType: 'inner' | 'left' = 'inner'
+  ): Promise<{
+    resultHandle: string;
+    rowCount: number;
+    columns: { name: string; type: string }[];
+    buildSide: 'left' | 'right';
+    truncated: boolean;
+    executionTimeMs: number;
+  }> {
+    return this.call('joinResults', { leftHandle, rightHandle, leftColumns, rightColumns, joinType });
+  }
+
+  // Rows [startRow, endRow) of a result held by executeQuery(keepResult), sorted and filtered on the backend
+  async getResultWindow(
+    resultHandle: string,
+    startRow: number,
+    endRow: number,
+    view: ResultView = {}
+  ): Promise<{
+    columns: { name: string; type: string }[];
+    rows: string[][];
+    startRow: number;
+    totalRows: number;
+    viewRows: number;
+  }> {
+    return this.call('getResultWindow', { resultHandle, startRow, endRow, ...view });
+  }
+
+  // Just the visible slice of a held result: `count` rows from `start`, limited to `columns` (indices; all when omitted)
+  async getRows(
+    resultHandle: string,
+    start: number,
+    count: number,
+    columns?: number[],
+    view: ResultView = {}
+  ): Promise<{
+    columns: { name: string; type: string }[];
+    rows: string[][];
+    start: number;
+    totalRows: number;
+    viewRows: number;
+    lobPreviews?: LobPreview[];
+  }> {
+    return this.call('getRows', { resultHandle, start, count, ...(columns && { columns }), ...view });
+  }
+
+  // Full value of one cell of a held result; a LOB preview is read again from its table
+  async getCellValue(
+    resultHandle: string,
+    row: number,
+    column: number,
+    view: ResultView = {}
+  ): Promise<{ value: string | null; totalBytes?: number }> {
+    return this.call('getCellValue', { resultHandle, row, column, ...view });
+  }
+
+  // Header tooltip figures of every column of a held result, from the statistics kept while fetching
+  async getColumnStats(resultHandle: string): Promise<ColumnStatsResponse> {
+    return this.call('getColumnStats', { resultHandle });
+  }
+
+  // Find-in-grid on the backend: [display row, column] of matching cells from startRow;
+  // pass nextRow back for the next page
+  async searchResult(
+    resultHandle: string,
+    needle: string,
+    caseInsensitive = true,
+    startRow = 0,
+    limit?: number,
+    view: ResultView = {}
+  ): Promise<{
+    matches: [number, number][];
+    totalMatches: number;
+    nextRow: number | null;
+    simdLevel: string;
+  }> {
+    return this.call('searchResult', {
+      resultHandle,
+      needle,
+      caseInsensitive,
+      startRow,
+      ...(limit !== undefined && { limit }),
+      ...view,
+    });
+  }
+
+  // Puts a selection of a held result on the clipboard without sending its rows to the WebView;
+  // rowRanges are [start, end) display rows, all rows and columns when omitted
+  async copyResult(
+    resultHandle: string,
+    selection: {
+      format?: 'tsv' | 'csv' | 'markdown';
+      rowRanges?: [number, number][];
+      columns?: number[];
+      includeHeader?: boolean;
+      nullText?: string;
+    } = {},
+    view: ResultView = {}
+  ): Promise<{ rows: number; columns: number; bytes: number }> {
+    return this.call('copyResult', { resultHandle, ...selection, ...view });
+  }
+
+  // Writes a held result as the grid shows it, without running the query again.
+  // An 'sql' export inserts into `table` (dbo.ExportedRows when omitted).
+  async exportHeldResult(
+    format: 'csv' | 'json' | 'excel' | 'parquet' | 'sql',
+    resultHandle: string,
+    filepath: string,
+    view: ResultView = {},
+    table?: string
+  ): Promise<{ filepath: string }> {
+    const methods = {
+      csv: 'exportCSV',
+      json: 'exportJSON',
+      excel: 'exportExcel',
+      parquet: 'exportParquet',
+      sql: 'exportSqlInsert',
+    } as const;
+    const method = methods[format];
+    return this.call(method, { resultHandle, filepath, ...view, ...(table ? { table } : {}) });
+  }
+
+  async releaseResult(resultHandle: string): Promise<{ released: boolean }> {
+    return this.call('releaseResult', { resultHandle });
+  }
+
   // Settings methods
   async getSettings(): Promise<{
     general: {
@@ -621,6 +1726,7 @@ class Bridge {
   }
 
   // Session methods
+  /** Restored tabs come back with `contentLoaded: false`: fetch their content with getSessionTabContent. */
   async getSessionState(): Promise<{
     activeConnectionId: string;
     activeTabId: string;
@@ -639,12 +1745,20 @@ class Bridge {
       isDirty: boolean;
       cursorLine: number;
       cursorColumn: number;
+      contentHash: string;
+      contentLoaded: boolean;
     }[];
     expandedTreeNodes: string[];
   }> {
     return this.call('getSessionState', {});
   }
 
+  async getSessionTabContent(tabId: string): Promise<{ content: string }> {
+    return this.call('getSessionTabContent', { tabId });
+  }
+
+  /** Omit `content` for a restored tab not loaded yet: it keeps its stored content. */
+
   async saveSessionState(state: {
     activeConnectionId?: string;
     activeTabId?: string;
@@ -658,7 +1772,7 @@ class Bridge {
     openTabs?: {
       id: string;
       title: string;
-      content: string;
+      content?: string;
       filePath: string;
       isDirty: boolean;
       cursorLine: number;
@@ -679,24 +1793,72 @@ class Bridge {
       searchProcedures?: boolean;
       searchFunctions?: boolean;
       searchColumns?: boolean;
+      searchIndexes?: boolean;
       caseSensitive?: boolean;
+      fuzzy?: boolean;
       maxResults?: number;
     }
-  ): Promise<
-    {
-      objectType: string;
-      schemaName: string;
-      objectName: string;
-      parentName: string;
-    }[]
-  > {
+  ): Promise<ObjectSearchResult[]> {
     return this.call('searchObjects', { connectionId, pattern, ...options });
   }
 
+  /**
+   * searchObjects across every database of the instance, a few databases at a time; the current one is
+   * answered from the schema cache. Poll getInstanceSearchProgress with `since` = databases seen so far.
+   */
+  async startInstanceSearch(
+    connectionId: string,
+    pattern: string,
+    options?: {
+      searchTables?: boolean;
+      searchViews?: boolean;
+      searchProcedures?: boolean;
+      searchFunctions?: boolean;
+      searchColumns?: boolean;
+      searchIndexes?: boolean;
+      caseSensitive?: boolean;
+      fuzzy?: boolean;
+      maxResults?: number;
+      parallelism?: number;
+    }
+  ): Promise<{ searchId: string; total: number }> {
+    return this.call('startInstanceSearch', { connectionId, pattern, ...options });
+  }
+
+  async getInstanceSearchProgress(
+    searchId: string,
+    since = 0
+  ): Promise<InstanceSearchProgressResponse> {
+    return this.call('getInstanceSearchProgress', { searchId, since });
+  }
+
+  async cancelInstanceSearch(searchId: string): Promise<{ cancelled: boolean }> {
+    return this.call('cancelInstanceSearch', { searchId });
+  }
+
   async quickSearch(connectionId: string, prefix: string, limit = 20): Promise<string[]> {
     return this.call('quickSearch', { connectionId, prefix, limit });
   }
 
+  /** Completions at a 1-based editor position (column in UTF-16 units), ranked by the statement's tables and history */
+  async complete(
+    connectionId: string,
+    sql: string,
+    line: number,
+    column: number,
+    limit = 50
+  ): Promise<{
+    context: 'none' | 'keyword' | 'table' | 'column' | 'member' | 'procedure';
+    prefix: string;
+    items: {
+      label: string;
+      kind: 'keyword' | 'table' | 'view' | 'column' | 'alias' | 'procedure';
+      detail: string;
+    }[];
+  }> {
+    return this.call('complete', { connectionId, sql, line, column, limit });
+  }
+
   // Table metadata methods
   async getIndexes(
     connectionId: string,
@@ -798,6 +1960,13 @@ class Bridge {
     return this.call('writeFrontendLog', { content });
   }
 
+  // The backend rate-limits these and folds repeated messages
+  async writeFrontendLogs(
+    records: { timestamp: string; level: string; message: string }[]
+  ): Promise<{ received: number; written: number }> {
+    return this.call('writeFrontendLogs', { records });
+  }
+
   // File operations
   async saveQueryToFile(content: string, defaultFileName?: string): Promise<{ filePath: string }> {
     return this.call('saveQueryToFile', { content, defaultFileName });
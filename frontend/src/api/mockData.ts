@@ -22,8 +22,29 @@ export const mockData: Record<string, unknown> = {
     currentSizeBytes: 0,
     maxSizeBytes: 104857600,
     usagePercent: 0,
+    entries: 0,
+    hits: 0,
+    misses: 0,
+    staleRejections: 0,
+    bytesSaved: 0,
+    diskSizeBytes: 0,
+    diskEntries: 0,
+    heldResults: 0,
+    heldBytes: 0,
+    spilledResults: 0,
+    spilledBytes: 0,
+    memory: {
+      budgetBytes: 2147483648,
+      usedBytes: 0,
+      cacheBytes: 0,
+      heldBytes: 0,
+      inFlightBytes: 0,
+      reclaimedBytes: 0,
+    },
   },
   clearCache: { cleared: true },
+  applyEdits: { affectedRows: 0 },
+  saveGridEdits: { affectedRows: 0, patched: true, rowCount: 0, rows: [] },
   executeAsyncQuery: { queryId: 'mock-query-1' },
   getAsyncQueryResult: {
     queryId: 'mock-query-1',
@@ -39,8 +60,61 @@ export const mockData: Record<string, unknown> = {
     affectedRows: 0,
     executionTimeMs: 50,
   },
+  getAsyncQueryRows: {
+    queryId: 'mock-query-1',
+    status: 'completed',
+    statementCount: 1,
+    statementComplete: true,
+    offset: 0,
+    totalRows: 2,
+    columns: [
+      { name: 'id', type: 'int' },
+      { name: 'name', type: 'nvarchar' },
+    ],
+    rows: [
+      ['1', 'Test Item 1'],
+      ['2', 'Test Item 2'],
+    ],
+    affectedRows: 0,
+    executionTimeMs: 50,
+  },
+  filterAsyncQueryRows: {
+    queryId: 'mock-query-1',
+    status: 'completed',
+    statementCount: 1,
+    statementComplete: true,
+    offset: 0,
+    totalRows: 2,
+    filteredRows: 1,
+    columns: [
+      { name: 'id', type: 'int' },
+      { name: 'name', type: 'nvarchar' },
+    ],
+    rows: [['1', 'Test Item 1']],
+    affectedRows: 0,
+    executionTimeMs: 50,
+  },
   cancelAsyncQuery: { cancelled: true },
-  getActiveQueries: [],
+  startCSVExport: { exportId: 'export_1' },
+  getExportProgress: {
+    exportId: 'export_1',
+    status: 'completed',
+    filepath: 'C:\\export.csv',
+    rowsWritten: 2,
+    bytesWritten: 42,
+    elapsedMs: 5,
+  },
+  cancelExport: { cancelled: true },
+  getActiveQueries: {
+    queries: [],
+    workers: 0,
+    busyWorkers: 0,
+    queuedInteractive: 0,
+    queuedBackground: 0,
+    peakQueueDepth: 0,
+    submitted: 0,
+    rejected: 0,
+  },
   filterResultSet: {
     columns: [
       { name: 'id', type: 'int' },
@@ -49,7 +123,22 @@ export const mockData: Record<string, unknown> = {
     rows: [['1', 'Test Item 1']],
     totalRows: 3,
     filteredRows: 1,
+    cached: true,
     simdAvailable: true,
+    simdLevel: 'avx2',
+  },
+  aggregateResultSet: {
+    columns: [
+      { name: 'name', type: 'nvarchar' },
+      { name: 'count(*)', type: 'BIGINT' },
+    ],
+    rows: [
+      ['Test Item 1', '2'],
+      ['Test Item 2', '1'],
+    ],
+    totalRows: 3,
+    groupCount: 2,
+    cached: true,
   },
   getDatabases: ['master', 'tempdb', 'model', 'msdb'],
   getTables: [
@@ -57,6 +146,23 @@ export const mockData: Record<string, unknown> = {
     { schema: 'dbo', name: 'Orders', type: 'TABLE' },
     { schema: 'dbo', name: 'Products', type: 'TABLE' },
   ],
+  getSchemaSnapshot: [
+    {
+      schema: 'dbo',
+      name: 'Users',
+      type: 'TABLE',
+      columns: [
+        { name: 'id', type: 'int', size: 4, nullable: false, isPrimaryKey: true },
+        { name: 'name', type: 'nvarchar', size: 255, nullable: false, isPrimaryKey: false },
+      ],
+    },
+    {
+      schema: 'dbo',
+      name: 'Orders',
+      type: 'TABLE',
+      columns: [{ name: 'id', type: 'int', size: 4, nullable: false, isPrimaryKey: true }],
+    },
+  ],
   getColumns: [
     { name: 'id', type: 'int', size: 4, nullable: false, isPrimaryKey: true },
     {
@@ -76,7 +182,31 @@ export const mockData: Record<string, unknown> = {
   ],
   getQueryHistory: [],
   parseERDiagram: { name: '', databaseType: '', tables: [], relations: [], shapes: [], ddl: '' },
-  getExecutionPlan: { plan: 'Mock execution plan text', actual: false },
+  getExecutionPlan: {
+    plan: {
+      statements: [{ text: 'SELECT * FROM users', cost: 0.0033, warnings: [] }],
+      operators: [
+        {
+          id: 0,
+          parent: -1,
+          statement: 0,
+          physicalOp: 'Clustered Index Scan',
+          logicalOp: 'Clustered Index Scan',
+          object: '[dbo].[users].[PK_users]',
+          estimatedRows: 3,
+          subtreeCost: 0.0033,
+          cost: 0.0033,
+        },
+      ],
+      missingIndexes: [],
+      hotspots: [0],
+    },
+    actual: false,
+    planId: 'plan_1',
+    previousPlanId: '',
+    cached: false,
+    fingerprint: '0000000000000000',
+  },
   getSettings: {
     general: {
       autoConnect: false,
@@ -122,6 +252,7 @@ export const mockData: Record<string, unknown> = {
     expandedTreeNodes: [],
   },
   saveSessionState: { saved: true },
+  getSessionTabContent: { content: '' },
   searchObjects: [],
   quickSearch: [],
 };
@@ -1,6 +1,7 @@
-import { useCallback, useState } from 'react';
+import { useCallback, useMemo, useState } from 'react';
 import { bridge } from '../../api/bridge';
 import { useConnectionStore } from '../../store/connectionStore';
+import type { ExecutionPlan, MissingIndexHint, PlanOperator } from '../../types';
 import styles from './ExecutionPlanDialog.module.css';
 
 interface ExecutionPlanDialogProps {
@@ -9,9 +10,32 @@ interface ExecutionPlanDialogProps {
   sql: string;
 }
 
+function formatCost(cost: number, total: number): string {
+  return total > 0 ? `${((cost / total) * 100).toFixed(1)}%` : '-';
+}
+
+function operatorLabel(op: PlanOperator): string {
+  return op.logicalOp && op.logicalOp !== op.physicalOp ? `${op.physicalOp} (${op.logicalOp})` : op.physicalOp;
+}
+
+function missingIndexDdl(hint: MissingIndexHint): string {
+  const keys = [...hint.equality, ...hint.inequality].join(', ');
+  const include = hint.include.length > 0 ? ` INCLUDE (${hint.include.join(', ')})` : '';
+  return `CREATE INDEX [IX_missing] ON ${hint.table} (${keys})${include};`;
+}
+
+// Operators arrive in pre-order with parent indices, so depth is one pass
+function operatorDepths(operators: PlanOperator[]): number[] {
+  const depths: number[] = [];
+  for (const op of operators) {
+    depths.push(op.parent >= 0 ? depths[op.parent] + 1 : 0);
+  }
+  return depths;
+}
+
 export function ExecutionPlanDialog({ isOpen, onClose, sql }: ExecutionPlanDialogProps) {
   const { activeConnectionId } = useConnectionStore();
-  const [planText, setPlanText] = useState<string>('');
+  const [plan, setPlan] = useState<ExecutionPlan | null>(null);
   const [isLoading, setIsLoading] = useState(false);
   const [error, setError] = useState<string | null>(null);
   const [showActual, setShowActual] = useState(false);
@@ -24,20 +48,8 @@ export function ExecutionPlanDialog({ isOpen, onClose, sql }: ExecutionPlanDialo
       setError(null);
 
       try {
-        // SQL Server execution plan query
-        const planQuery = includeActual
-          ? `SET STATISTICS XML ON;\n${sql}\nSET STATISTICS XML OFF;`
-          : `SET SHOWPLAN_TEXT ON;\n${sql}\nSET SHOWPLAN_TEXT OFF;`;
-
-        const result = await bridge.executeQuery(activeConnectionId, planQuery);
-
-        if (result.rows.length > 0) {
-          // Combine all plan text rows
-          const plan = result.rows.map((row) => row.join(' ')).join('\n');
-          setPlanText(plan);
-        } else {
-          setPlanText('実行計画を取得できません');
-        }
+        const result = await bridge.getExecutionPlan(activeConnectionId, sql, includeActual);
+        setPlan(result.plan);
       } catch (err) {
         setError(err instanceof Error ? err.message : '実行計画の取得に失敗しました');
       } finally {
@@ -57,6 +69,12 @@ export function ExecutionPlanDialog({ isOpen, onClose, sql }: ExecutionPlanDialo
     fetchPlan(true);
   }, [fetchPlan]);
 
+  const depths = useMemo(() => (plan ? operatorDepths(plan.operators) : []), [plan]);
+  const totalCost = useMemo(
+    () => (plan ? plan.statements.reduce((sum, statement) => sum + statement.cost, 0) : 0),
+    [plan]
+  );
+
   if (!isOpen) return null;
 
   return (
@@ -98,8 +116,77 @@ export function ExecutionPlanDialog({ isOpen, onClose, sql }: ExecutionPlanDialo
               <div className={styles.loading}>実行計画を読み込み中...</div>
             ) : error ? (
               <div className={styles.error}>{error}</div>
-            ) : planText ? (
-              <pre className={styles.planText}>{planText}</pre>
+            ) : plan ? (
+              <div className={styles.planText}>
+                {plan.hotspots.length > 0 && (
+                  <section className={styles.planSection}>
+                    <h3>コストの高い演算子</h3>
+                    <ol>
+                      {plan.hotspots.map((index) => {
+                        const op = plan.operators[index];
+                        return (
+                          <li key={index}>
+                            {formatCost(op.cost, totalCost)} {operatorLabel(op)}
+                            {op.object ? ` ${op.object}` : ''}
+                          </li>
+                        );
+                      })}
+                    </ol>
+                  </section>
+                )}
+                {plan.missingIndexes.length > 0 && (
+                  <section className={styles.planSection}>
+                    <h3>不足しているインデックス</h3>
+                    {plan.missingIndexes.map((hint, i) => (
+                      <div key={i}>
+                        <span className={styles.impact}>{hint.impact.toFixed(1)}%</span>
+                        <code>{missingIndexDdl(hint)}</code>
+                      </div>
+                    ))}
+                  </section>
+                )}
+                {plan.statements.map((statement, statementIndex) => (
+                  <section key={statementIndex} className={styles.planSection}>
+                    <h3>{statement.text}</h3>
+                    {statement.warnings.map((warning) => (
+                      <div key={warning} className={styles.warning}>
+                        {warning}
+                      </div>
+                    ))}
+                    <table className={styles.operatorTable}>
+                      <thead>
+                        <tr>
+                          <th>演算子</th>
+                          <th>オブジェクト</th>
+                          <th>推定行数</th>
+                          <th>実際の行数</th>
+                          <th>コスト</th>
+                        </tr>
+                      </thead>
+                      <tbody>
+                        {plan.operators.map((op, index) =>
+                          op.statement !== statementIndex ? null : (
+                            <tr key={index} className={plan.hotspots.includes(index) ? styles.hotspot : ''}>
+                              <td style={{ paddingLeft: `${depths[index] * 16 + 4}px` }}>
+                                {operatorLabel(op)}
+                                {op.warnings?.map((warning) => (
+                                  <div key={warning} className={styles.warning}>
+                                    {warning}
+                                  </div>
+                                ))}
+                              </td>
+                              <td>{op.object ?? ''}</td>
+                              <td>{op.estimatedRows}</td>
+                              <td>{op.actualRows ?? ''}</td>
+                              <td>{formatCost(op.cost, totalCost)}</td>
+                            </tr>
+                          )
+                        )}
+                      </tbody>
+                    </table>
+                  </section>
+                ))}
+              </div>
             ) : (
               <div className={styles.placeholder}>
                 「推定プラン」または「実際のプラン」をクリックして実行計画を生成
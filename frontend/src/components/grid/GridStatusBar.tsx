@@ -1,5 +1,5 @@
 import { memo } from 'react';
-import type { ResultSet } from '../../types';
+import type { ExecutionStatistics, ResultSet } from '../../types';
 import styles from './ResultGrid.module.css';
 
 interface GridStatusBarProps {
@@ -10,6 +10,17 @@ interface GridStatusBarProps {
   connectionLabel?: string;
 }
 
+// Per-table STATISTICS IO lines for the tooltip
+function describeTableIo(statistics: ExecutionStatistics): string {
+  return statistics.tables
+    .map(
+      (t) =>
+        `${t.table}: スキャン ${t.scanCount}, 論理読み取り ${t.logicalReads}, 物理読み取り ${t.physicalReads}, 先読み ${t.readAheadReads}` +
+        (t.lobLogicalReads > 0 || t.lobPhysicalReads > 0 ? `, LOB 論理 ${t.lobLogicalReads}, LOB 物理 ${t.lobPhysicalReads}` : '')
+    )
+    .join('\n');
+}
+
 function GridStatusBarInner({
   resultSet,
   filteredRowCount,
@@ -17,6 +28,7 @@ function GridStatusBarInner({
   isEditMode,
   connectionLabel,
 }: GridStatusBarProps) {
+  const { statistics, messages } = resultSet;
   return (
     <div className={styles.statusBar}>
       {connectionLabel && (
@@ -36,6 +48,31 @@ function GridStatusBarInner({
       </span>
       <span>|</span>
       <span>{resultSet.executionTimeMs.toFixed(2)} ms</span>
+      {statistics?.cpuTimeMs !== undefined && (
+        <>
+          <span>|</span>
+          <span title={`コンパイル CPU ${statistics.compileCpuTimeMs ?? 0} ms / 経過 ${statistics.compileElapsedTimeMs ?? 0} ms`}>
+            CPU {statistics.cpuTimeMs} ms / 経過 {statistics.elapsedTimeMs} ms
+          </span>
+        </>
+      )}
+      {statistics && statistics.tables.length > 0 && (
+        <>
+          <span>|</span>
+          <span title={describeTableIo(statistics)}>
+            論理読み取り {statistics.tables.reduce((sum, t) => sum + t.logicalReads, 0).toLocaleString()} / 物理{' '}
+            {statistics.tables.reduce((sum, t) => sum + t.physicalReads, 0).toLocaleString()}
+          </span>
+        </>
+      )}
+      {messages && messages.length > 0 && (
+        <>
+          <span>|</span>
+          <span title={messages.map((m) => m.text).join('\n')}>
+            メッセージ {messages.length + (resultSet.messagesDropped ?? 0)} 件
+          </span>
+        </>
+      )}
       {resultSet.affectedRows > 0 && (
         <>
           <span>|</span>
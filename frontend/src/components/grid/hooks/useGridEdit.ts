@@ -55,9 +55,7 @@ export function useGridEdit({
     markRowDeleted,
     unmarkRowDeleted,
     addNewRow,
-    generateUpdateSQL,
-    generateInsertSQL,
-    generateDeleteSQL,
+    buildRowEdits,
     setTableContext,
     clearTableContext,
     primaryKeyColumns,
@@ -117,12 +115,14 @@ export function useGridEdit({
     setApplyError(null);
 
     try {
-      const updateSQL = generateUpdateSQL();
-      const insertSQL = generateInsertSQL();
-      const deleteSQL = generateDeleteSQL();
-
-      for (const sql of [...updateSQL, ...insertSQL, ...deleteSQL]) {
-        await bridge.executeQuery(activeConnectionId, sql);
+      // One round trip and one transaction however many cells changed
+      const { schema, table } = parseTableName(currentQuery.sourceTable);
+      const edits = buildRowEdits();
+      if (edits.length > 0 && resultSet?.resultHandle) {
+        // Rows are positions in the held result's own order; the grid sorts and filters locally
+        await bridge.saveGridEdits(resultSet.resultHandle, edits);
+      } else if (edits.length > 0) {
+        await bridge.applyEdits(activeConnectionId, schema, table, edits);
       }
 
       revertAll();
@@ -135,9 +135,8 @@ export function useGridEdit({
   }, [
     activeConnectionId,
     currentQuery,
-    generateUpdateSQL,
-    generateInsertSQL,
-    generateDeleteSQL,
+    resultSet,
+    buildRowEdits,
     revertAll,
     setEditMode,
   ]);
@@ -74,7 +74,7 @@ export function TableViewer({ tableName, schemaName = 'dbo' }: TableViewerProps)
         sql += ` WHERE ${whereClause}`;
       }
 
-      const result = await bridge.executeQuery(activeConnectionId, sql, false);
+      const result = await bridge.executeQuery(activeConnectionId, sql, false, 'binary');
       setResultSet({
         columns: result.columns.map((c) => ({
           ...c,
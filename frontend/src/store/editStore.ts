@@ -1,4 +1,5 @@
 import { create } from 'zustand';
+import type { RowEditRequest } from '../types';
 
 export interface CellChange {
   rowIndex: number;
@@ -58,6 +59,9 @@ interface EditState {
   isRowDeleted: (rowIndex: number) => boolean;
   isRowInserted: (rowIndex: number) => boolean;
 
+  // Pending changes as applyEdits / saveGridEdits requests: updates, then inserts, then deletes
+  buildRowEdits: () => RowEditRequest[];
+
   // Generate SQL
   generateUpdateSQL: () => string[];
   generateInsertSQL: () => string[];
@@ -246,6 +250,55 @@ export const useEditStore = create<EditState>((set, get) => ({
     return get().insertedRows.has(rowIndex);
   },
 
+  buildRowEdits: () => {
+    const { primaryKeyColumns, pendingChanges, insertedRows, deletedRows } = get();
+    const edits: RowEditRequest[] = [];
+
+    // Rows are identified by their primary key, or by every original column when there is none
+    const keyOf = (
+      row: Record<string, string | null>,
+      original: (col: string) => string | null
+    ) => {
+      const columns =
+        primaryKeyColumns.length > 0
+          ? primaryKeyColumns
+          : Object.keys(row).filter((k) => !k.startsWith('__'));
+      return Object.fromEntries(columns.map((col) => [col, original(col)]));
+    };
+
+    pendingChanges.forEach((rowChange) => {
+      const changes = Object.values(rowChange.changes);
+      if (changes.length === 0) return;
+      edits.push({
+        kind: 'update',
+        row: rowChange.rowIndex,
+        values: Object.fromEntries(changes.map((change) => [change.columnName, change.newValue])),
+        key: keyOf(
+          rowChange.originalData,
+          (col) => rowChange.changes[col]?.originalValue ?? rowChange.originalData[col] ?? null
+        ),
+      });
+    });
+
+    insertedRows.forEach((rowData) => {
+      const columns = Object.keys(rowData).filter((k) => !k.startsWith('__'));
+      edits.push({
+        kind: 'insert',
+        values: Object.fromEntries(columns.map((col) => [col, rowData[col]])),
+      });
+    });
+
+    deletedRows.forEach((rowData, rowIndex) => {
+      edits.push({
+        kind: 'delete',
+        row: rowIndex,
+        key: keyOf(rowData, (col) => rowData[col] ?? null),
+      });
+    });
+
+    return edits;
+  },
+
   generateUpdateSQL: () => {
     const { tableName, schemaName, primaryKeyColumns, pendingChanges } = get();
     if (!tableName) return [];
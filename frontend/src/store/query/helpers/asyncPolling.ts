@@ -1,4 +1,4 @@
-import type { AsyncColumn, AsyncPollResult, Column, QueryResult } from '../../../types';
+import type { AsyncColumn, AsyncPollResult, Column, LiveQueryStats, QueryResult, ServerOutput } from '../../../types';
 import type { QueryBridgeable } from '../interfaces/QueryBridgeable';
 
 function mapAsyncColumn(c: AsyncColumn): Column {
@@ -14,14 +14,85 @@ function mapAsyncColumn(c: AsyncColumn): Column {
 
 const DEFAULT_QUERY_TIMEOUT_MS = 5 * 60 * 1000;
 const POLL_INTERVAL_MS = 100;
+// With push events the result is fetched when the backend reports a change; this slow poll only covers lost events
+const PUSH_FALLBACK_POLL_MS = 2000;
+
+/** Resolves after `ms`, or earlier when `wake` is called or `signal` aborts */
+function createWaiter(signal?: AbortSignal) {
+  let wake: (() => void) | null = null;
+  let woken = false;
+  return {
+    wake() {
+      woken = true;
+      wake?.();
+    },
+    wait(ms: number): Promise<void> {
+      if (woken) {
+        woken = false;
+        return Promise.resolve();
+      }
+      return new Promise((resolve) => {
+        const done = () => {
+          clearTimeout(timer);
+          signal?.removeEventListener('abort', done);
+          wake = null;
+          woken = false;
+          resolve();
+        };
+        const timer = setTimeout(done, ms);
+        signal?.addEventListener('abort', done);
+        wake = done;
+      });
+    },
+  };
+}
+
+// Rows fetched for the preview shown while a query is still streaming
+const FIRST_PAGE_ROWS = 1000;
 
 export async function executeAsyncWithPolling(
   bridge: QueryBridgeable,
   connectionId: string,
   sql: string,
-  signal?: AbortSignal
+  signal?: AbortSignal,
+  onFirstRows?: (preview: AsyncPollResult) => void,
+  onLiveStats?: (stats: LiveQueryStats) => void,
+  tabId?: string
 ): Promise<AsyncPollResult> {
-  const { queryId } = await bridge.executeAsyncQuery(connectionId, sql);
+  // The tab id lets the backend take turns between tabs when the server is saturated
+  const { queryId } = await bridge.executeAsyncQuery(connectionId, sql, undefined, false, onLiveStats !== undefined, 0, tabId);
+
+  // State changes wake the loop; the first progress event with rows triggers one preview fetch
+  let previewRequested = false;
+  const fetchPreview = () => {
+    previewRequested = true;
+    bridge
+      .getAsyncQueryRows?.(queryId, 0, FIRST_PAGE_ROWS)
+      .then((page) => {
+        if (page.status === 'running' && !signal?.aborted) {
+          onFirstRows?.({
+            columns: page.columns,
+            rows: page.rows,
+            affectedRows: page.affectedRows,
+            executionTimeMs: page.executionTimeMs,
+          });
+        }
+      })
+      .catch(() => {});
+  };
+  const waiter = createWaiter(signal);
+  const unsubscribe =
+    bridge.onAsyncQueryEvent?.(queryId, (event) => {
+      if (event.live) {
+        onLiveStats?.(event.live);
+      }
+      if (event.status !== 'pending' && event.status !== 'running') {
+        waiter.wake();
+      } else if (onFirstRows && !previewRequested && event.rowsFetched > 0) {
+        fetchPreview();
+      }
+    }) ?? null;
+  const pollIntervalMs = unsubscribe ? PUSH_FALLBACK_POLL_MS : POLL_INTERVAL_MS;
 
   try {
     const startTime = Date.now();
@@ -54,6 +125,7 @@ export async function executeAsyncWithPolling(
           rows: result.rows,
           affectedRows: result.affectedRows,
           executionTimeMs: result.executionTimeMs,
+          ...serverOutput(result),
         };
       } else if (result.status === 'failed') {
         throw new Error(result.error);
@@ -61,9 +133,10 @@ export async function executeAsyncWithPolling(
         throw new Error('Query was cancelled');
       }
 
-      await new Promise((resolve) => setTimeout(resolve, POLL_INTERVAL_MS));
+      await waiter.wait(pollIntervalMs);
     }
   } finally {
+    unsubscribe?.();
     // Release backend memory for this query (single cleanup point).
     // Runs on all exit paths: success, failure, timeout, and abort.
     bridge.removeAsyncQuery(queryId).catch(() => {});
@@ -72,6 +145,21 @@ export async function executeAsyncWithPolling(
 
 const QUERY_ROW_LIMIT = 10_000;
 
+// PRINT / STATISTICS output rides along with the rows only when the server sent some
+function serverOutput({ messages, messagesDropped, statistics }: ServerOutput): ServerOutput {
+  const output: ServerOutput = {};
+  if (messages) {
+    output.messages = messages;
+  }
+  if (messagesDropped) {
+    output.messagesDropped = messagesDropped;
+  }
+  if (statistics) {
+    output.statistics = statistics;
+  }
+  return output;
+}
+
 function truncateRows(rows: string[][]): { rows: string[][]; truncated: boolean } {
   if (rows.length > QUERY_ROW_LIMIT) {
     return { rows: rows.slice(0, QUERY_ROW_LIMIT), truncated: true };
@@ -97,7 +185,8 @@ export function toQueryResult(result: AsyncPollResult): {
               rows,
               affectedRows: r.data.affectedRows,
               executionTimeMs: r.data.executionTimeMs,
-              truncated,
+              truncated: truncated || r.data.truncated === true,
+              ...serverOutput(r.data),
             },
           };
         }),
@@ -114,7 +203,8 @@ export function toQueryResult(result: AsyncPollResult): {
       rows,
       affectedRows: result.affectedRows,
       executionTimeMs: result.executionTimeMs,
-      truncated,
+      truncated: truncated || result.truncated === true,
+      ...serverOutput(result),
     },
     totalAffectedRows: result.affectedRows,
     totalExecutionTimeMs: result.executionTimeMs,
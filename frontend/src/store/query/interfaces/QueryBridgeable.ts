@@ -1,8 +1,18 @@
-import type { AsyncQueryResultResponse } from '../../../types';
+import type { AsyncQueryEvent, AsyncQueryResultResponse, AsyncQueryRowsPage } from '../../../types';
 
 export interface QueryBridgeable {
-  executeAsyncQuery(connectionId: string, sql: string): Promise<{ queryId: string }>;
+  executeAsyncQuery(
+    connectionId: string,
+    sql: string,
+    priority?: 'interactive' | 'background',
+    parallel?: boolean,
+    liveStats?: boolean,
+    maxRows?: number,
+    tabId?: string
+  ): Promise<{ queryId: string }>;
   getAsyncQueryResult(queryId: string): Promise<AsyncQueryResultResponse>;
+  getAsyncQueryRows?(queryId: string, offset: number, limit: number, statementIndex?: number): Promise<AsyncQueryRowsPage>;
+  onAsyncQueryEvent?(queryId: string, listener: (event: AsyncQueryEvent) => void): (() => void) | null;
   cancelAsyncQuery(queryId: string): Promise<{ cancelled: boolean }>;
   removeAsyncQuery(queryId: string): Promise<{ removed: boolean }>;
   cancelQuery(connectionId: string): Promise<void>;
@@ -1,3 +1,4 @@
+import type { AsyncPollResult } from '../../../types';
 import { executeAsyncWithPolling, toQueryResult } from '../helpers/asyncPolling';
 import { endExecution, failExecution, startExecution } from '../helpers/executionState';
 import type { AbortRegistrable } from '../interfaces/AbortRegistrable';
@@ -27,7 +28,12 @@ export function createExecuteSlice(
     set((state) => startExecution(state, id));
 
     try {
-      const result = await executeAsyncWithPolling(bridge, connectionId, sql, controller.signal);
+      // Show the first streamed rows while the rest of the result is still being fetched
+      const showFirstRows = (preview: AsyncPollResult) => {
+        const { queryResult } = toQueryResult(preview);
+        set((state) => (state.executingQueryIds.has(id) ? { results: { ...state.results, [id]: queryResult } } : {}));
+      };
+      const result = await executeAsyncWithPolling(bridge, connectionId, sql, controller.signal, showFirstRows, undefined, id);
       const { queryResult, totalAffectedRows, totalExecutionTimeMs } = toQueryResult(result);
 
       set((state) => ({
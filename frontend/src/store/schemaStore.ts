@@ -50,14 +50,16 @@ export const useSchemaStore = create<SchemaState>((set, get) => ({
     });
 
     try {
-      const { tables } = await bridge.getTables(connectionId, '');
+      // Columns come along, so autocomplete needs no per-table round trips
+      const tables = await bridge.getSchemaSnapshot(connectionId);
       log.debug(`[SchemaStore] Loaded ${tables.length} tables for ${connectionId}`);
 
       const tableSchemas: TableSchema[] = tables.map((t) => ({
         name: t.name,
         schema: t.schema,
         type: t.type as 'TABLE' | 'VIEW',
-        columnsLoaded: false,
+        columns: t.columns,
+        columnsLoaded: true,
       }));
 
       set((state) => {
@@ -1,5 +1,6 @@
-import { beforeEach, describe, expect, it } from 'vitest';
-import { toQueryResult } from '../../store/query/helpers/asyncPolling';
+import { beforeEach, describe, expect, it, vi } from 'vitest';
+import { executeAsyncWithPolling, toQueryResult } from '../../store/query/helpers/asyncPolling';
+import type { QueryBridgeable } from '../../store/query/interfaces/QueryBridgeable';
 import {
   endExecution,
   failExecution,
@@ -9,7 +10,7 @@ import {
   startExecution,
 } from '../../store/query/helpers/executionState';
 import type { QueryState } from '../../store/query/types';
-import type { AsyncPollResult } from '../../types';
+import type { AsyncPollResult, AsyncQueryEvent } from '../../types';
 
 /** helpers under test only use data fields — action stubs are unnecessary */
 function makeState(overrides?: Partial<QueryState>): QueryState {
@@ -160,3 +161,41 @@ describe('toQueryResult', () => {
     expect(col?.isPrimaryKey).toBe(false);
   });
 });
+
+describe('executeAsyncWithPolling', () => {
+  it('should fetch the result as soon as a completion event is pushed', async () => {
+    let push: ((event: AsyncQueryEvent) => void) | null = null;
+    const unsubscribe = vi.fn();
+    const bridge: QueryBridgeable = {
+      executeAsyncQuery: vi.fn().mockResolvedValue({ queryId: 'q1' }),
+      getAsyncQueryResult: vi
+        .fn()
+        .mockResolvedValueOnce({ queryId: 'q1', status: 'running' })
+        .mockResolvedValueOnce({
+          queryId: 'q1',
+          status: 'completed',
+          columns: [{ name: 'id', type: 'int' }],
+          rows: [['1']],
+          affectedRows: 0,
+          executionTimeMs: 1,
+        }),
+      onAsyncQueryEvent: vi.fn((_queryId, listener) => {
+        push = listener;
+        return unsubscribe;
+      }),
+      cancelAsyncQuery: vi.fn(),
+      removeAsyncQuery: vi.fn().mockResolvedValue({ removed: true }),
+      cancelQuery: vi.fn(),
+    };
+
+    const pending = executeAsyncWithPolling(bridge, 'conn_1', 'SELECT 1');
+    await vi.waitFor(() => expect(bridge.getAsyncQueryResult).toHaveBeenCalledTimes(1));
+    push!({ queryId: 'q1', status: 'completed', rowsFetched: 1 });
+
+    // Resolves long before the fallback poll interval would have elapsed
+    const result = await pending;
+    expect(result.multipleResults).toBeFalsy();
+    expect(bridge.getAsyncQueryResult).toHaveBeenCalledTimes(2);
+    expect(unsubscribe).toHaveBeenCalled();
+  });
+});
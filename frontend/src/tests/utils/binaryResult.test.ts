@@ -0,0 +1,72 @@
+import { describe, expect, it } from 'vitest';
+import { decodeBinaryResult, isBinaryResultDescriptor } from '../../utils/binaryResult';
+
+/** Builds the buffer BinaryResultEncoder emits for (id INT, name NVARCHAR) = [(7, 'seven'), (NULL, '')] */
+function buildSample(): ArrayBuffer {
+  const buffer = new ArrayBuffer(40 + 24 + 32 + 24 + 32);
+  const view = new DataView(buffer);
+  const bytes = new Uint8Array(buffer);
+  const ascii = (offset: number, text: string) => bytes.set(new TextEncoder().encode(text), offset);
+
+  ascii(0, 'VDBR');
+  view.setUint16(4, 1, true);
+  view.setUint32(8, 2, true);
+  view.setBigUint64(16, 2n, true);
+  view.setBigInt64(24, 2n, true);
+  view.setFloat64(32, 1.5, true);
+
+  // Column descriptors
+  view.setUint8(40, 1); // Int64
+  view.setUint8(42, 1);
+  view.setUint32(48, 2, true);
+  view.setUint32(52, 3, true);
+  ascii(56, 'idINT');
+  view.setUint8(64, 0); // Text
+  view.setUint8(66, 1);
+  view.setUint32(72, 4, true);
+  view.setUint32(76, 8, true);
+  ascii(80, 'nameNVARCHAR');
+
+  // Int64 column: null word (row 1 NULL), values
+  view.setBigUint64(96, 0b10n, true);
+  view.setBigInt64(104, 7n, true);
+  // Text column: null word, offsets [0, 5, 5], chars
+  view.setUint32(132, 5, true);
+  view.setUint32(136, 5, true);
+  ascii(144, 'seven');
+  return buffer;
+}
+
+describe('decodeBinaryResult', () => {
+  it('列指向バッファを行配列に変換', () => {
+    const result = decodeBinaryResult(buildSample());
+    expect(result.columns.map((c) => [c.name, c.type])).toEqual([
+      ['id', 'INT'],
+      ['name', 'NVARCHAR'],
+    ]);
+    expect(result.rows).toEqual([
+      ['7', 'seven'],
+      ['', ''],
+    ]);
+    expect(result.affectedRows).toBe(2);
+    expect(result.executionTimeMs).toBe(1.5);
+  });
+
+  it('バイナリ列を大文字の16進で表示', () => {
+    const buffer = buildSample();
+    new DataView(buffer).setUint8(64, 7); // Binary: same layout as Text
+    expect(decodeBinaryResult(buffer).rows).toEqual([
+      ['7', '736576656E'],
+      ['', ''],
+    ]);
+  });
+
+  it('不正なヘッダーを拒否', () => {
+    expect(() => decodeBinaryResult(new ArrayBuffer(40))).toThrow();
+  });
+
+  it('バイナリ結果ディスクリプタを判定', () => {
+    expect(isBinaryResultDescriptor({ format: 'binary', url: 'https://results.local/r1' })).toBe(true);
+    expect(isBinaryResultDescriptor({ columns: [], rows: [] })).toBe(false);
+  });
+});
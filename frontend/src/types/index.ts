@@ -17,6 +17,9 @@ export interface SshConfig {
   password?: string;
   privateKeyPath?: string;
   keyPassphrase?: string;
+  channelWindowKb?: number; // SSH receive window per DB connection (default 16 MB)
+  compression?: boolean; // zlib, for text-heavy results over slow links
+  ciphers?: string; // Cipher preference order
 }
 
 // SSH configuration for saved profiles (no secrets in memory)
@@ -30,6 +33,24 @@ export interface SavedSshConfig {
   savePassword: boolean;
 }
 
+// SQL Server network tuning (saved with the profile and sent with connect)
+export interface ConnectionTuning {
+  packetSize?: number; // TDS packet size in bytes (0 = driver default, 512-32767)
+  mars?: boolean; // MARS_Connection
+  multiSubnetFailover?: boolean; // Availability Group listeners
+  readOnlyIntent?: boolean; // ApplicationIntent=ReadOnly
+  readRouting?: boolean; // Reads, schema and export on a read-intent login; writes stay on the primary
+}
+
+// One packet size's run from benchmarkPacketSizes
+export interface PacketSizeBenchmarkResult {
+  packetSize: number;
+  rows?: number;
+  elapsedMs?: number;
+  rowsPerSecond?: number;
+  error?: string;
+}
+
 // Saved connection profile (persistent storage)
 export interface SavedConnectionProfile {
   id: string;
@@ -45,6 +66,7 @@ export interface SavedConnectionProfile {
   environment?: EnvironmentType;
   dbType?: DatabaseType;
   ssh?: SavedSshConfig;
+  tuning?: ConnectionTuning;
 }
 
 // Connection types
@@ -65,6 +87,7 @@ export interface Connection {
   tableListLoadTimeMs?: number; // Time taken to load table list
   tableOpenTimeMs?: number; // Time taken to open a table (click to display)
   ssh?: SshConfig;
+  tuning?: ConnectionTuning;
 }
 
 // Query types
@@ -98,6 +121,9 @@ export interface Column {
   nullable: boolean;
   isPrimaryKey: boolean;
   comment?: string;
+  /** DECIMAL/NUMERIC result columns only */
+  precision?: number;
+  scale?: number;
 }
 
 /** ER図表示用の拡張カラム型（Column + ER固有属性） */
@@ -108,12 +134,55 @@ export interface ERColumn extends Omit<Column, 'type'> {
   color?: string; // CSS #RRGGBB
 }
 
-export interface ResultSet {
+// One informational record of a statement (PRINT, RAISERROR below severity 11, warnings)
+export interface ServerMessage {
+  text: string;
+  code: number; // Native error number (3612/3613/3615 for STATISTICS TIME/IO)
+  state: string; // SQLSTATE
+}
+
+// SET STATISTICS IO figures for one table, summed over the batch
+export interface TableIoStatistics {
+  table: string;
+  scanCount: number;
+  logicalReads: number;
+  physicalReads: number;
+  readAheadReads: number;
+  lobLogicalReads: number;
+  lobPhysicalReads: number;
+}
+
+// SET STATISTICS IO/TIME output parsed by the backend; times are absent unless STATISTICS TIME was on
+export interface ExecutionStatistics {
+  cpuTimeMs?: number;
+  elapsedTimeMs?: number;
+  compileCpuTimeMs?: number;
+  compileElapsedTimeMs?: number;
+  tables: TableIoStatistics[];
+}
+
+// Server output reported next to executionTimeMs; every field is absent when the statement produced none
+export interface ServerOutput {
+  messages?: ServerMessage[];
+  messagesDropped?: number;
+  statistics?: ExecutionStatistics;
+}
+
+export interface ResultSet extends ServerOutput {
   columns: Column[];
   rows: string[][];
   affectedRows: number;
   executionTimeMs: number;
   truncated?: boolean;
+  resultHandle?: string; // Held on the backend (keepResult): grid edits save through saveGridEdits
+}
+
+// Result of openTable: a preview plus what is known about the table's size without scanning it
+export interface OpenTableResult extends ResultSet {
+  estimatedRows: number | null; // sys.partitions estimate; null for views
+  orderedBy: string; // Clustered key the preview follows; empty for heaps, views and samples
+  sampled: boolean; // Rows come from TABLESAMPLE
+  countQueryId?: string; // Background async query computing COUNT_BIG(*)
 }
 
 export interface MultipleResultSet {
@@ -134,13 +203,14 @@ export interface AsyncColumn {
 }
 
 export type AsyncPollResult =
-  | {
+  | ({
       multipleResults?: false;
       columns: AsyncColumn[];
       rows: string[][];
       affectedRows: number;
       executionTimeMs: number;
-    }
+      truncated?: boolean;
+    } & ServerOutput)
   | {
       multipleResults: true;
       results: Array<{
@@ -150,10 +220,102 @@ export type AsyncPollResult =
           rows: string[][];
           affectedRows: number;
           executionTimeMs: number;
-        };
+          truncated?: boolean;
+        } & ServerOutput;
       }>;
     };
 
+// One grid row edit for applyEdits and saveGridEdits; the backend builds the statements
+export interface RowEditRequest {
+  kind: 'insert' | 'update' | 'delete';
+  values?: Record<string, string | null>; // Columns written (insert, update)
+  key?: Record<string, string | null>; // Columns identifying the row (update, delete); saveGridEdits reads the primary key from the row when omitted
+  row?: number; // saveGridEdits: position of the row in the grid's view of the held result (update, delete)
+}
+
+// Pushed by the backend ("backend:asyncQuery" window event) when an async query changes state or streams rows
+export interface AsyncQueryEvent {
+  queryId: string;
+  status: 'pending' | 'running' | 'completed' | 'failed' | 'cancelled';
+  rowsFetched: number;
+  live?: LiveQueryStats; // Present on the periodic samples of queries started with liveStats
+}
+
+// Rows one plan operator has produced so far (summed over its threads)
+export interface LiveOperatorStats {
+  id: number;
+  physicalOp: string;
+  rows: number;
+  estimatedRows: number;
+}
+
+// Server-side progress of a running query, sampled about once a second
+export interface LiveQueryStats {
+  sessionId: number;
+  percentComplete: number; // Only reported by some commands (index builds, backups, DBCC, ...)
+  elapsedMs: number;
+  cpuMs: number;
+  logicalReads: number;
+  waitType: string;
+  operators: LiveOperatorStats[]; // Empty unless the server profiles the session
+}
+
+// One page of the rows an async query has buffered so far (readable while it is still running)
+export interface AsyncQueryRowsPage {
+  queryId: string;
+  status: 'pending' | 'running' | 'completed' | 'failed' | 'cancelled';
+  statementCount: number;
+  statementComplete: boolean;
+  offset: number;
+  totalRows: number;
+  columns: AsyncColumn[];
+  rows: string[][];
+  affectedRows: number;
+  executionTimeMs: number;
+  error?: string;
+}
+
+// Per-server admission limits: requests running at once and the sum of their weights
+export interface AdmissionLimits {
+  maxConcurrent: number;
+  budget: number;
+}
+
+// One server's load behind the admission throttle
+export interface AdmissionServerStats extends AdmissionLimits {
+  server: string;
+  running: number;
+  weightInUse: number;
+  queued: number;
+  queuedOwners: number; // Tabs (or export and broadcast jobs) with queued requests
+  admitted: number;
+  delayed: number; // Admissions that had to queue first
+  maxWaitMs: number;
+}
+
+export interface AdmissionStatsResponse {
+  servers: AdmissionServerStats[];
+  weights: { interactive: number; background: number; broadcast: number; export: number };
+}
+
+// Compound grid filter (AND/OR tree of column predicates) evaluated on the backend's held result
+export type FilterExpression =
+  | { and: FilterExpression[] }
+  | { or: FilterExpression[] }
+  | {
+      column: number;
+      op: 'equals' | 'contains' | 'range' | 'isNull' | 'notNull' | 'regex';
+      value?: string;
+      maxValue?: string;
+      ignoreCase?: boolean;
+    };
+
+// One aggregate of a client-side GROUP BY; omit column for count(*)
+export interface AggregateSpec {
+  function: 'count' | 'sum' | 'min' | 'max' | 'avg' | 'countDistinct';
+  column?: number;
+}
+
 // Async query result response (from backend polling API) - discriminated union by status
 export type AsyncQueryResultResponse =
   | { queryId: string; status: 'pending' | 'running' }
@@ -168,10 +330,11 @@ export type AsyncQueryResultResponse =
           rows: string[][];
           affectedRows: number;
           executionTimeMs: number;
-        };
+          truncated?: boolean;
+        } & ServerOutput;
       }>;
     }
-  | {
+  | ({
       queryId: string;
       status: 'completed';
       multipleResults?: false;
@@ -179,10 +342,467 @@ export type AsyncQueryResultResponse =
       rows: string[][];
       affectedRows: number;
       executionTimeMs: number;
-    }
+      truncated?: boolean;
+    } & ServerOutput)
   | { queryId: string; status: 'failed'; error: string }
   | { queryId: string; status: 'cancelled' };
 
+// Background export progress (from startCSVExport / startPartitionedExport / getExportProgress)
+export interface ExportProgressResponse {
+  exportId: string;
+  status: 'running' | 'completed' | 'cancelled' | 'failed';
+  filepath: string;
+  rowsWritten: number;
+  bytesWritten: number;
+  elapsedMs: number;
+  parts?: number;
+  partsDone?: number;
+  partFiles?: string[];
+  error?: string;
+}
+
+// Background table import progress (from startImport / getImportProgress)
+export interface ImportProgressResponse {
+  importId: string;
+  status: 'running' | 'completed' | 'cancelled' | 'failed';
+  table: string;
+  recordsRead: number;
+  rowsInserted: number;
+  bytesRead: number;
+  totalBytes: number;
+  elapsedMs: number;
+  rowsPerSecond: number;
+  error?: string;
+}
+
+// A failed batch of a script run, located in the file
+export interface ScriptRunError {
+  offset: number;
+  line: number;
+  batch: number;
+  message: string;
+}
+
+// Streamed .sql file run progress (from startScriptRun / getScriptRunProgress)
+export interface ScriptRunProgressResponse {
+  runId: string;
+  status: 'running' | 'completed' | 'cancelled' | 'failed';
+  bytesRead: number;
+  bytesExecuted: number;
+  totalBytes: number;
+  batchesRun: number;
+  rowsAffected: number;
+  errorCount: number;
+  elapsedMs: number;
+  errors: ScriptRunError[];
+  error?: string;
+}
+
+// One profile's outcome in a connection batch (startConnectionBatch), in completion order
+export interface ConnectionBatchResult {
+  index: number;
+  key: string;
+  success: boolean;
+  elapsedMs: number;
+  message?: string;
+  connectionId?: string;
+}
+
+// Results completed since the `since` passed to getConnectionBatchProgress
+export interface ConnectionBatchProgressResponse {
+  batchId: string;
+  total: number;
+  completed: number;
+  done: boolean;
+  elapsedMs: number;
+  results: ConnectionBatchResult[];
+}
+
+// One server's outcome in a broadcast query (startBroadcastQuery), in completion order
+export interface BroadcastServerResult {
+  index: number;
+  server: string;
+  success: boolean;
+  timedOut: boolean;
+  truncated: boolean; // Stopped at the broadcast's row limit
+  rows: number;
+  elapsedMs: number;
+  message?: string;
+}
+
+// Servers completed since the `since` passed to getBroadcastProgress; resultHandle once done
+export interface BroadcastProgressResponse {
+  broadcastId: string;
+  total: number;
+  completed: number;
+  rows: number;
+  done: boolean;
+  elapsedMs: number;
+  results: BroadcastServerResult[];
+  resultHandle?: string;
+  truncated?: boolean;
+}
+
+// Latency distribution of a workload replay, in milliseconds
+export interface LatencySummary {
+  count: number;
+  minMs: number;
+  meanMs: number;
+  p50Ms: number;
+  p95Ms: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+// One query shape of a replay: recorded timings next to the ones measured on the target
+export interface ReplayShapeReport {
+  hash: string;
+  sql: string;
+  failures: number;
+  p50Ratio: number;
+  p95Ratio: number;
+  regressed: boolean;
+  original: LatencySummary;
+  replayed: LatencySummary;
+  lastError?: string;
+}
+
+// shapes is filled once done, regressions first
+export interface WorkloadReplayProgress {
+  replayId: string;
+  total: number;
+  completed: number;
+  failures: number;
+  skipped: number;
+  done: boolean;
+  cancelled: boolean;
+  elapsedMs: number;
+  maxScheduleLagMs: number;
+  original: LatencySummary;
+  replayed: LatencySummary;
+  shapes: ReplayShapeReport[];
+}
+
+// One match of searchObjects or startInstanceSearch
+export interface ObjectSearchResult {
+  objectType: string;
+  schemaName: string;
+  objectName: string;
+  parentName: string;
+}
+
+// One database's outcome in an instance-wide object search, in completion order
+export interface DatabaseSearchOutcome {
+  database: string;
+  success: boolean;
+  fromIndex: boolean; // Answered from the schema cache instead of the server
+  elapsedMs: number;
+  message?: string; // Why it failed, was cancelled or was skipped at the result limit
+  results: ObjectSearchResult[];
+}
+
+// Databases completed since the `since` passed to getInstanceSearchProgress
+export interface InstanceSearchProgressResponse {
+  searchId: string;
+  total: number;
+  completed: number;
+  matches: number;
+  done: boolean;
+  truncated: boolean;
+  elapsedMs: number;
+  databases: DatabaseSearchOutcome[];
+}
+
+// Schema and column statistics of a saved .vdbr result snapshot
+// Per-column figures of a held result for the grid's header tooltips (getColumnStats)
+export interface ColumnStatsResponse {
+  rowCount: number;
+  columns: {
+    name: string;
+    nullCount: number;
+    distinct: number; // HyperLogLog estimate, within a few percent
+    zones: number;
+    min: string | null;
+    max: string | null;
+  }[];
+}
+
+export interface ResultSnapshotInfo {
+  rowCount: number;
+  truncated: boolean;
+  createdAt: number;
+  fileBytes: number;
+  columns: { name: string; type: string; nullCount: number; min?: string; max?: string }[];
+}
+
+// Background indexing of a file opened with openFileDatasource; rows is known once done
+export interface FileDatasourceProgress {
+  bytesIndexed: number;
+  totalBytes: number;
+  done: boolean;
+  rows: number | null;
+  error: string | null;
+}
+
+// Editor line range (0-based, inclusive) for ranged formatSQL / uppercaseKeywords
+export interface SqlLineRange {
+  firstLine: number;
+  lastLine: number;
+}
+
+// Replacement for whole lines; the backend may widen the requested range
+export interface SqlLineEdit extends SqlLineRange {
+  sql: string;
+}
+
+// Execution plan types (showplan XML parsed by the backend)
+export interface PlanStatement {
+  text: string;
+  cost: number;
+  warnings: string[];
+}
+
+export interface PlanOperator {
+  id: number;
+  parent: number; // Index into ExecutionPlan.operators, -1 for a statement root
+  statement: number;
+  physicalOp: string;
+  logicalOp: string;
+  object?: string;
+  estimatedRows: number;
+  subtreeCost: number;
+  cost: number; // Own cost: subtreeCost minus the children's
+  actualRows?: number;
+  actualExecutions?: number;
+  warnings?: string[];
+}
+
+export interface MissingIndexHint {
+  statement: number;
+  impact: number;
+  table: string;
+  equality: string[];
+  inequality: string[];
+  include: string[];
+}
+
+export interface ExecutionPlan {
+  statements: PlanStatement[];
+  operators: PlanOperator[]; // Pre-order
+  missingIndexes: MissingIndexHint[];
+  hotspots: number[]; // Indices into operators, costliest first
+}
+
+export interface ExecutionPlanResponse {
+  plan: ExecutionPlan;
+  actual: boolean;
+  planId: string; // Handle for diffExecutionPlans
+  previousPlanId: string; // Plan of the same query fetched just before, '' when none
+  cached: boolean; // Served from the plan cache: same query, unchanged schema
+  fingerprint: string; // Hex hash of the query's fingerprint
+}
+
+export type PlanChange = 'unchanged' | 'changed' | 'added' | 'removed';
+
+export interface PlanOperatorDiff {
+  change: PlanChange;
+  before: number; // Index into the older plan's operators, -1 when added
+  after: number; // Index into the newer plan's operators, -1 when removed
+  statement: number;
+  rowsRatio: number; // Newer over older estimated rows, 0 when not comparable
+  costDelta: number;
+  estimateShift: boolean;
+  costShift: boolean;
+}
+
+export interface PlanDiff {
+  statements: {
+    statement: number;
+    beforeCost: number;
+    afterCost: number;
+    addedWarnings: string[];
+    removedWarnings: string[];
+  }[];
+  operators: PlanOperatorDiff[]; // Aligned tree in pre-order
+  summary: {
+    unchanged: number;
+    changed: number;
+    added: number;
+    removed: number;
+    estimateShifts: number;
+    costShifts: number;
+  };
+}
+
+export interface PlanDiffSide {
+  planId: string;
+  actual: boolean;
+  capturedAt: number; // Unix ms
+  plan: ExecutionPlan;
+}
+
+export interface PlanDiffResponse {
+  before: PlanDiffSide;
+  after: PlanDiffSide;
+  diff: PlanDiff;
+}
+
+// Query Store insights
+export type QueryStoreRanking = 'duration' | 'cpu' | 'reads' | 'executions' | 'regression';
+
+export interface QueryStoreQuery {
+  queryId: number;
+  text: string;
+  objectName: string;
+  executions: number;
+  totalDurationMs: number;
+  avgDurationMs: number;
+  maxDurationMs: number;
+  avgCpuMs: number;
+  avgLogicalReads: number;
+  planCount: number;
+  planId: number; // Most recently used plan
+  regressed: boolean; // Latest plan replaced previousPlanId and is at least 1.5x slower
+  previousPlanId: number;
+  previousAvgDurationMs: number;
+  regressionRatio: number;
+}
+
+export interface QueryStoreReport {
+  database: string;
+  windowMinutes: number;
+  intervals: number;
+  trackedQueries: number;
+  incremental: boolean; // Only the newest intervals were read
+  queries: QueryStoreQuery[];
+  executionTimeMs: number;
+}
+
+// Server health monitor
+export interface ActiveRequest {
+  sessionId: number;
+  blockedBy: number; // 0 when not blocked
+  startTime: string;
+  status: string;
+  command: string;
+  waitType: string;
+  waitTimeMs: number;
+  elapsedMs: number;
+  cpuMs: number;
+  logicalReads: number;
+  openTransactions: number;
+  database: string;
+  loginName: string;
+  hostName: string;
+  programName: string;
+  statement: string;
+}
+
+// The fields of a running request that change between samples
+export type ActiveRequestUpdate = Pick<
+  ActiveRequest,
+  'sessionId' | 'blockedBy' | 'status' | 'waitType' | 'waitTimeMs' | 'elapsedMs' | 'cpuMs' | 'logicalReads' | 'openTransactions'
+>;
+
+export interface WaitDelta {
+  waitType: string;
+  waitingTasks: number;
+  waitTimeMs: number; // Since the previous sample
+  signalWaitMs: number;
+}
+
+export interface HeadBlocker {
+  sessionId: number;
+  idle: boolean; // No running request, e.g. an uncommitted transaction
+  loginName: string;
+  hostName: string;
+  programName: string;
+  openTransactions: number;
+  blockedSessions: number;
+}
+
+export interface ServerHealthSample {
+  sequence: number;
+  timestamp: number; // Unix ms
+  intervalMs: number;
+  pollMs: number;
+  requests: ActiveRequest[];
+  waits: WaitDelta[];
+  blockers: HeadBlocker[];
+}
+
+export interface ServerHealthHistory {
+  running: boolean;
+  error: string; // Why the monitor stopped by itself
+  samples: ServerHealthSample[];
+}
+
+// Pushed by the backend ("backend:serverHealth" window event) after every sample, or once with `error` when a monitor fails
+export interface ServerHealthEvent {
+  connectionId: string;
+  error?: string;
+  sequence?: number;
+  timestamp?: number;
+  intervalMs?: number;
+  pollMs?: number;
+  added?: ActiveRequest[]; // New requests; replaces any earlier request of the same session
+  updated?: ActiveRequestUpdate[];
+  removed?: number[]; // Session ids
+  waits?: WaitDelta[];
+  blockers?: HeadBlocker[]; // Only when the blocking chains changed
+}
+
+// Pushed by the backend ("backend:tableTail" window event): a snapshot of the newest rows first (again whenever
+// too much changed at once), then only the rows that changed; once with `error` when the tail fails
+export interface TableTailEvent {
+  tailId: string;
+  connectionId: string;
+  error?: string;
+  sequence?: number;
+  snapshot?: boolean;
+  mode?: 'changeTracking' | 'key';
+  keyColumns?: string[]; // Rows are matched on these
+  columns?: { name: string; type: string; comment?: string }[];
+  rows?: string[][]; // Snapshot, newest first
+  inserted?: string[][];
+  updated?: string[][]; // Change Tracking only
+  deleted?: string[][]; // Key values, in keyColumns order; Change Tracking only
+}
+
+// Index advisor
+export interface MissingIndexSuggestion {
+  schema: string;
+  table: string;
+  equalityColumns: string[]; // Bracket-quoted
+  inequalityColumns: string[];
+  includedColumns: string[];
+  seeks: number;
+  scans: number;
+  avgUserImpact: number; // Percent of query cost saved
+  improvement: number; // Ranking score: cost * impact * (seeks + scans)
+  extends: string; // Existing index whose keys overlap; empty if none
+  createStatement: string;
+}
+
+export interface IndexFinding {
+  kind: 'duplicate' | 'redundant' | 'unused';
+  schema: string;
+  table: string;
+  index: string;
+  coveredBy: string; // Empty for unused indexes
+  reads: number;
+  writes: number;
+  sizeKb: number;
+  dropStatement: string;
+}
+
+export interface IndexAdvice {
+  uptimeHours: number; // Usage statistics only cover this long
+  suggestions: MissingIndexSuggestion[];
+  findings: IndexFinding[];
+  executionTimeMs: number;
+}
+
 // History types
 export interface HistoryItem {
   id: string;
@@ -315,11 +935,13 @@ export interface ERRelationEdge {
 // IPC types
 export interface IPCRequest {
   method: string;
-  params: string;
+  params: Record<string, unknown>;
 }
 
 export interface IPCResponse<T = unknown> {
   success: boolean;
   data?: T;
   error?: string;
+  /** The request failed only because the database connection dropped; sending it again may succeed */
+  retriable?: boolean;
 }
@@ -0,0 +1,193 @@
+/**
+ * Decoder for the backend's columnar binary result format (executeQuery with format: 'binary').
+ * Layout is documented in backend/utils/binary_result.h; all sections are 8-byte aligned.
+ */
+
+export interface BinaryResultColumn {
+  name: string;
+  type: string;
+  size: number;
+  nullable: boolean;
+  isPrimaryKey: boolean;
+}
+
+export interface DecodedBinaryResult {
+  columns: BinaryResultColumn[];
+  rows: string[][];
+  affectedRows: number;
+  executionTimeMs: number;
+  /** The backend stopped at maxRows with more rows left on the server */
+  truncated: boolean;
+}
+
+/** Descriptor returned by executeQuery in place of rows when the binary format is requested */
+export interface BinaryResultDescriptor {
+  format: 'binary';
+  url: string;
+  byteLength: number;
+  rowCount: number;
+  cached: boolean;
+  resultHandle?: string;
+}
+
+const MAGIC = 'VDBR';
+const VERSION = 1;
+const HEADER_BYTES = 40;
+const DATETIME_RECORD_BYTES = 12;
+const FLAG_TRUNCATED = 1;
+
+// Mirrors ColumnDataType in backend/database/result_set.h
+enum StorageType {
+  Text = 0,
+  Int64 = 1,
+  Double = 2,
+  Bit = 3,
+  Date = 4,
+  Time = 5,
+  Timestamp = 6,
+  Binary = 7,
+}
+
+const alignUp = (value: number) => (value + 7) & ~7;
+const pad2 = (value: number) => (value < 10 ? '0' : '') + value;
+const HEX_BYTES = Array.from({ length: 256 }, (_, b) => b.toString(16).toUpperCase().padStart(2, '0'));
+
+export function isBinaryResultDescriptor(value: unknown): value is BinaryResultDescriptor {
+  return (
+    typeof value === 'object' &&
+    value !== null &&
+    (value as { format?: unknown }).format === 'binary' &&
+    typeof (value as { url?: unknown }).url === 'string'
+  );
+}
+
+export function decodeBinaryResult(buffer: ArrayBuffer): DecodedBinaryResult {
+  const view = new DataView(buffer);
+  const bytes = new Uint8Array(buffer);
+  const utf8 = new TextDecoder();
+
+  if (utf8.decode(bytes.subarray(0, 4)) !== MAGIC || view.getUint16(4, true) !== VERSION) {
+    throw new Error('Unsupported binary result format');
+  }
+  const truncated = (view.getUint16(6, true) & FLAG_TRUNCATED) !== 0;
+  const columnCount = view.getUint32(8, true);
+  const rowCount = Number(view.getBigUint64(16, true));
+  const affectedRows = Number(view.getBigInt64(24, true));
+  const executionTimeMs = view.getFloat64(32, true);
+
+  let pos = HEADER_BYTES;
+  const columns: BinaryResultColumn[] = [];
+  const storage: { type: StorageType; fractionDigits: number }[] = [];
+  for (let c = 0; c < columnCount; c++) {
+    const type = view.getUint8(pos) as StorageType;
+    const fractionDigits = view.getUint8(pos + 1);
+    const nullable = view.getUint8(pos + 2) !== 0;
+    const isPrimaryKey = view.getUint8(pos + 3) !== 0;
+    const size = view.getInt32(pos + 4, true);
+    const nameBytes = view.getUint32(pos + 8, true);
+    const typeBytes = view.getUint32(pos + 12, true);
+    const nameStart = pos + 16;
+    columns.push({
+      name: utf8.decode(bytes.subarray(nameStart, nameStart + nameBytes)),
+      type: utf8.decode(bytes.subarray(nameStart + nameBytes, nameStart + nameBytes + typeBytes)),
+      size,
+      nullable,
+      isPrimaryKey,
+    });
+    storage.push({ type, fractionDigits });
+    pos = alignUp(nameStart + nameBytes + typeBytes);
+  }
+
+  const rows: string[][] = new Array(rowCount);
+  for (let r = 0; r < rowCount; r++) {
+    rows[r] = new Array(columnCount);
+  }
+
+  const nullWordBytes = Math.ceil(rowCount / 64) * 8;
+  for (let c = 0; c < columnCount; c++) {
+    const nullBase = pos;
+    const isNull = (row: number) => (bytes[nullBase + (row >> 3)] >> (row & 7)) & 1;
+    pos += nullWordBytes;
+
+    const { type, fractionDigits } = storage[c];
+    switch (type) {
+      case StorageType.Text: {
+        const offsets = new Uint32Array(buffer, pos, rowCount + 1);
+        const charsStart = alignUp(pos + (rowCount + 1) * 4);
+        for (let r = 0; r < rowCount; r++) {
+          rows[r][c] = isNull(r)
+            ? ''
+            : utf8.decode(bytes.subarray(charsStart + offsets[r], charsStart + offsets[r + 1]));
+        }
+        pos = alignUp(charsStart + offsets[rowCount]);
+        break;
+      }
+      case StorageType.Binary: {
+        // Same layout as Text; the raw bytes are shown as upper-case hex, like the backend's display text
+        const offsets = new Uint32Array(buffer, pos, rowCount + 1);
+        const bytesStart = alignUp(pos + (rowCount + 1) * 4);
+        for (let r = 0; r < rowCount; r++) {
+          if (isNull(r)) {
+            rows[r][c] = '';
+            continue;
+          }
+          let hex = '';
+          for (let i = bytesStart + offsets[r]; i < bytesStart + offsets[r + 1]; i++) hex += HEX_BYTES[bytes[i]];
+          rows[r][c] = hex;
+        }
+        pos = alignUp(bytesStart + offsets[rowCount]);
+        break;
+      }
+      case StorageType.Int64: {
+        const values = new BigInt64Array(buffer, pos, rowCount);
+        for (let r = 0; r < rowCount; r++) rows[r][c] = isNull(r) ? '' : values[r].toString();
+        pos += rowCount * 8;
+        break;
+      }
+      case StorageType.Double: {
+        const values = new Float64Array(buffer, pos, rowCount);
+        for (let r = 0; r < rowCount; r++) rows[r][c] = isNull(r) ? '' : String(values[r]);
+        pos += rowCount * 8;
+        break;
+      }
+      case StorageType.Bit: {
+        for (let r = 0; r < rowCount; r++) rows[r][c] = isNull(r) ? '' : bytes[pos + r] ? '1' : '0';
+        pos = alignUp(pos + rowCount);
+        break;
+      }
+      case StorageType.Date:
+      case StorageType.Time:
+      case StorageType.Timestamp: {
+        for (let r = 0; r < rowCount; r++) {
+          rows[r][c] = isNull(r)
+            ? ''
+            : formatDateTime(view, pos + r * DATETIME_RECORD_BYTES, type, fractionDigits);
+        }
+        pos = alignUp(pos + rowCount * DATETIME_RECORD_BYTES);
+        break;
+      }
+      default:
+        throw new Error(`Unknown binary column type: ${type as number}`);
+    }
+  }
+
+  return { columns, rows, affectedRows, executionTimeMs, truncated };
+}
+
+function formatDateTime(
+  view: DataView,
+  offset: number,
+  type: StorageType,
+  fractionDigits: number
+): string {
+  const year = String(view.getInt16(offset, true)).padStart(4, '0');
+  const date = `${year}-${pad2(view.getUint8(offset + 2))}-${pad2(view.getUint8(offset + 3))}`;
+  if (type === StorageType.Date) return date;
+
+  let time = `${pad2(view.getUint8(offset + 4))}:${pad2(view.getUint8(offset + 5))}:${pad2(view.getUint8(offset + 6))}`;
+  if (fractionDigits > 0) {
+    const fraction = Math.floor(view.getUint32(offset + 8, true) / 10 ** (9 - fractionDigits));
+    time += '.' + String(fraction).padStart(fractionDigits, '0');
+  }
+  return type === StorageType.Time ? time : `${date} ${time}`;
+}
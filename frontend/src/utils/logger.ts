@@ -7,9 +7,15 @@ export enum LogLevel {
   ERROR = 'ERROR',
 }
 
+interface LogRecord {
+  timestamp: string;
+  level: string;
+  message: string;
+}
+
 class Logger {
   private minLevel: LogLevel;
-  private logQueue: string[] = [];
+  private logQueue: LogRecord[] = [];
   private flushTimer: number | null = null;
 
   constructor() {
@@ -79,14 +85,7 @@ class Logger {
     }
 
     // Add to queue for file output
-    this.logQueue.push(logMessage);
-
-    // Periodically flush to file (buffering)
-    if (this.flushTimer === null) {
-      this.flushTimer = setTimeout(() => {
-        this.flush();
-      }, 1000); // Flush every 1 second
-    }
+    this.addToQueue(timestamp, level, message);
   }
 
   private async flush(): Promise<void> {
@@ -94,7 +93,8 @@ class Logger {
       return;
     }
 
-    const logs = `${this.logQueue.join('\n')}\n`;
+    const records = this.logQueue;
+    const logs = `${records.map((r) => `[${r.timestamp}] [${r.level}] ${r.message}`).join('\n')}\n`;
     this.logQueue = [];
     this.flushTimer = null;
 
@@ -116,23 +116,23 @@ class Logger {
         }
       }
 
-      // Write to backend file (log/frontend.log)
-      await bridge.writeFrontendLog(logs);
+      // Write to backend file (log/frontend.log) as one batch of records
+      await bridge.writeFrontendLogs(records);
     } catch (_error) {
       // Ignore log write errors (to avoid infinite loops)
       // Note: Does not error even in environments without localStorage
     }
   }
 
-  // Add message directly to queue (for console override)
-  addToQueue(message: string): void {
-    this.logQueue.push(message);
+  // Add record directly to queue (for console override)
+  addToQueue(timestamp: string, level: string, message: string): void {
+    this.logQueue.push({ timestamp, level, message });
 
-    // Schedule flush
+    // Periodically flush to file (buffering)
     if (this.flushTimer === null) {
       this.flushTimer = setTimeout(() => {
         this.flush();
-      }, 1000);
+      }, 1000); // Flush every 1 second
     }
   }
 
@@ -200,8 +200,7 @@ if (typeof window !== 'undefined') {
     const message = args.map((arg) => String(arg)).join(' ');
     // Don't call logger.debug() to avoid infinite recursion
     const timestamp = new Date().toISOString().replace('T', ' ').substring(0, 23);
-    const logMessage = `[${timestamp}] [DEBUG] [Console] ${message}`;
-    logger.addToQueue(logMessage);
+    logger.addToQueue(timestamp, 'DEBUG', `[Console] ${message}`);
   };
 
   console.info = (...args: unknown[]) => {
@@ -209,8 +208,7 @@ if (typeof window !== 'undefined') {
     const message = args.map((arg) => String(arg)).join(' ');
     // Don't call logger.info() to avoid infinite recursion
     const timestamp = new Date().toISOString().replace('T', ' ').substring(0, 23);
-    const logMessage = `[${timestamp}] [INFO] [Console] ${message}`;
-    logger.addToQueue(logMessage);
+    logger.addToQueue(timestamp, 'INFO', `[Console] ${message}`);
   };
 
   console.warn = (...args: unknown[]) => {
@@ -218,8 +216,7 @@ if (typeof window !== 'undefined') {
     const message = args.map((arg) => String(arg)).join(' ');
     // Don't call logger.warning() to avoid infinite recursion
     const timestamp = new Date().toISOString().replace('T', ' ').substring(0, 23);
-    const logMessage = `[${timestamp}] [WARNING] [Console] ${message}`;
-    logger.addToQueue(logMessage);
+    logger.addToQueue(timestamp, 'WARNING', `[Console] ${message}`);
   };
 
   console.error = (...args: unknown[]) => {
@@ -228,7 +225,6 @@ if (typeof window !== 'undefined') {
     // Don't call logger.error() to avoid infinite recursion
     // Instead, directly format and add to queue
     const timestamp = new Date().toISOString().replace('T', ' ').substring(0, 23);
-    const logMessage = `[${timestamp}] [ERROR] [Console] ${message}`;
-    logger.addToQueue(logMessage);
+    logger.addToQueue(timestamp, 'ERROR', `[Console] ${message}`);
   };
 }
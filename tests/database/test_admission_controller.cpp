@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "database/admission_controller.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+/// Records the order in which queued requests are admitted and keeps their tickets until told to release
+struct GrantLog {
+    std::vector<std::string> order;
+    std::deque<AdmissionTicket> tickets;
+
+    AdmissionController::Grant grant(std::string name) {
+        return [this, name = std::move(name)](AdmissionTicket ticket) {
+            order.push_back(name);
+            tickets.push_back(std::move(ticket));
+        };
+    }
+
+    /// Give back the oldest ticket still held
+    void releaseOldest() {
+        auto ticket = std::move(tickets.front());
+        tickets.pop_front();
+        ticket.release();
+    }
+
+    void releaseAll() {
+        while (!tickets.empty()) {
+            releaseOldest();
+        }
+    }
+};
+
+}  // namespace
+
+TEST(AdmissionControllerTest, ServerKeyIgnoresTheLogin) {
+    EXPECT_EQ(AdmissionController::serverKey("sa@DB01,1433"), "db01,1433");
+    EXPECT_EQ(AdmissionController::serverKey("windows@db01,1433"), AdmissionController::serverKey("app@corp@db01,1433"));
+    EXPECT_EQ(AdmissionController::serverKey("sa@localhost via ops@Bastion:22"), "localhost via bastion:22");
+    EXPECT_EQ(AdmissionController::serverKey("db01"), "db01");
+}
+
+TEST(AdmissionControllerTest, EnforcesConcurrencyAndWeightedBudget) {
+    AdmissionController controller;
+    controller.setLimits("db01", {.maxConcurrent = 3, .budget = 6});
+    GrantLog log;
+
+    // A second export would need 8 of the 6
+    EXPECT_EQ(controller.enqueue({.server = "db01", .owner = "a", .kind = AdmissionClass::Export}, log.grant("export1")), 0);
+    EXPECT_NE(controller.enqueue({.server = "db01", .owner = "a", .kind = AdmissionClass::Export}, log.grant("export2")), 0);
+    // Nothing overtakes the queued export, not even a query that would fit
+    EXPECT_NE(controller.enqueue({.server = "db01", .owner = "b", .kind = AdmissionClass::Interactive}, log.grant("query")), 0);
+    EXPECT_EQ(log.order, (std::vector<std::string>{"export1"}));
+
+    auto stats = controller.stats("db01");
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats->running, 1);
+    EXPECT_EQ(stats->weightInUse, 4);
+    EXPECT_EQ(stats->queued, 2);
+    EXPECT_EQ(stats->queuedOwners, 2);
+
+    log.releaseOldest();
+    EXPECT_EQ(log.order, (std::vector<std::string>{"export1", "export2", "query"}));
+    stats = controller.stats("db01");
+    EXPECT_EQ(stats->running, 2);
+    EXPECT_EQ(stats->weightInUse, 5);
+    EXPECT_EQ(stats->delayed, 2);
+
+    // Light requests still stop at the concurrency limit
+    controller.setLimits("db01", {.maxConcurrent = 2, .budget = 100});
+    EXPECT_NE(controller.enqueue({.server = "db01", .owner = "b"}, log.grant("query2")), 0);
+    log.releaseOldest();
+    EXPECT_EQ(log.order.back(), "query2");
+    log.releaseAll();
+    EXPECT_EQ(controller.stats("db01")->running, 0);
+    EXPECT_EQ(controller.stats("db01")->weightInUse, 0);
+}
+
+TEST(AdmissionControllerTest, OwnersTakeTurnsWhileQueued) {
+    AdmissionController controller;
+    controller.setLimits("db01", {.maxConcurrent = 1, .budget = 16});
+    GrantLog log;
+
+    (void)controller.enqueue({.server = "db01", .owner = "tab1"}, log.grant("running"));
+    for (int i = 1; i <= 3; ++i) {
+        (void)controller.enqueue({.server = "db01", .owner = "tab1"}, log.grant("tab1-" + std::to_string(i)));
+    }
+    (void)controller.enqueue({.server = "db01", .owner = "tab2"}, log.grant("tab2-1"));
+    (void)controller.enqueue({.server = "db01", .owner = "tab3"}, log.grant("tab3-1"));
+    (void)controller.enqueue({.server = "db01", .owner = "tab2"}, log.grant("tab2-2"));
+
+    while (log.order.size() < 7) {
+        log.releaseOldest();
+    }
+    // A tab queueing many queries gets one turn per round, not the whole server
+    EXPECT_EQ(log.order, (std::vector<std::string>{"running", "tab1-1", "tab2-1", "tab3-1", "tab1-2", "tab2-2", "tab1-3"}));
+}
+
+TEST(AdmissionControllerTest, WithdrawnRequestsAreNeverGranted) {
+    AdmissionController controller;
+    controller.setLimits("db01", {.maxConcurrent = 1, .budget = 1});
+    GrantLog log;
+
+    (void)controller.enqueue({.server = "db01", .owner = "a"}, log.grant("running"));
+    const auto export1 = controller.enqueue({.server = "db01", .owner = "a", .kind = AdmissionClass::Export}, log.grant("export"));
+    (void)controller.enqueue({.server = "db01", .owner = "b"}, log.grant("query"));
+
+    EXPECT_TRUE(controller.withdraw("db01", export1));
+    EXPECT_FALSE(controller.withdraw("db01", export1));
+    log.releaseOldest();
+    EXPECT_EQ(log.order, (std::vector<std::string>{"running", "query"}));
+
+    // Unthrottled requests are admitted on the spot with a ticket that holds nothing
+    EXPECT_EQ(controller.enqueue({.server = "", .owner = "a", .kind = AdmissionClass::Export}, log.grant("local")), 0);
+    EXPECT_EQ(log.order.back(), "local");
+    EXPECT_EQ(log.tickets.back().weight(), 0);
+}
+
+TEST(AdmissionControllerTest, AcquireBlocksUntilAdmittedOrGivenUp) {
+    AdmissionController controller;
+    controller.setLimits("db01", {.maxConcurrent = 1, .budget = 16});
+    auto first = controller.acquire({.server = "db01", .owner = "a"}, 1s);
+    ASSERT_TRUE(first);
+
+    // Timed out while the server is busy
+    EXPECT_FALSE(controller.acquire({.server = "db01", .owner = "b"}, 20ms));
+
+    std::atomic<bool> cancelled{false};
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(20ms);
+        cancelled = true;
+    });
+    EXPECT_FALSE(controller.acquire({.server = "db01", .owner = "b"}, 10s, [&] { return cancelled.load(); }));
+    canceller.join();
+    EXPECT_EQ(controller.stats("db01")->queued, 0);
+
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(20ms);
+        first->release();
+    });
+    auto second = controller.acquire({.server = "db01", .owner = "b"}, 10s);
+    releaser.join();
+    EXPECT_TRUE(second);
+    EXPECT_EQ(controller.stats("db01")->running, 1);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include "database/async_query_executor.h"
+#include "database/replay_driver.h"
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+constexpr std::string_view SQL = "SELECT id, name FROM t";
+constexpr auto TIMEOUT = std::chrono::seconds{10};
+
+ResultSet numbers(size_t count) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "BIGINT"});
+    result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (size_t i = 0; i < count; ++i) {
+        result.columnData[0].appendInt64(static_cast<int64_t>(i));
+        result.columnData[1].appendText("row " + std::to_string(i));
+    }
+    return result;
+}
+
+/// A connected replay driver serving `rows` rows of (id, name) for SQL
+std::shared_ptr<ReplayDriver> makeDriver(size_t rows = 1, ReplayTiming timing = {}) {
+    auto driver = std::make_shared<ReplayDriver>(timing);
+    EXPECT_TRUE(driver->connect(""));
+    driver->addResult(SQL, numbers(rows));
+    return driver;
+}
+
+/// Polls `done` until it holds or TIMEOUT passes
+template <typename Predicate>
+bool eventually(Predicate done) {
+    const auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return true;
+}
+
+}  // namespace
+
+class AsyncQueryExecutorTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        release();
+        m_executor.reset();
+    }
+
+    AsyncQueryExecutor& make(size_t workers, size_t perConnectionLimit = AsyncQueryExecutor::DEFAULT_PER_CONNECTION_LIMIT) {
+        m_executor = std::make_unique<AsyncQueryExecutor>(workers, perConnectionLimit, AdmissionController::instance(), std::filesystem::temp_directory_path());
+        return *m_executor;
+    }
+
+    /// Options whose onRunningChange records the order in which queries start
+    QuerySubmitOptions recorded(QueryPriority priority = QueryPriority::Interactive, std::string connectionId = {}) {
+        QuerySubmitOptions options;
+        options.priority = priority;
+        options.connectionId = std::move(connectionId);
+        options.onRunningChange = [this](std::string_view queryId, IDatabaseDriver&, bool running) {
+            if (running) {
+                std::lock_guard lock(m_startedMutex);
+                m_started.emplace_back(queryId);
+            }
+        };
+        return options;
+    }
+
+    std::string submit(std::shared_ptr<IDatabaseDriver> driver, QueryPriority priority = QueryPriority::Interactive, std::string connectionId = {}) {
+        return m_executor->submitQuery(std::move(driver), SQL, {}, recorded(priority, std::move(connectionId)));
+    }
+
+    /// Submits a query that holds its worker until release(); returns once it is running
+    std::string submitBlocker(std::string connectionId = {}) {
+        auto options = recorded(QueryPriority::Interactive, std::move(connectionId));
+        auto started = std::make_shared<std::promise<void>>();
+        auto running = started->get_future();
+        options.onRunningChange = [started, released = m_released, record = std::move(options.onRunningChange)](std::string_view queryId, IDatabaseDriver& driver, bool isRunning) {
+            record(queryId, driver, isRunning);
+            if (isRunning) {
+                started->set_value();
+                released.wait();
+            }
+        };
+        auto id = m_executor->submitQuery(makeDriver(), SQL, {}, std::move(options));
+        EXPECT_EQ(running.wait_for(TIMEOUT), std::future_status::ready);
+        return id;
+    }
+
+    void release() {
+        if (!m_releasedOnce) {
+            m_releaseSignal.set_value();
+            m_releasedOnce = true;
+        }
+    }
+
+    QueryStatus status(const std::string& queryId) { return m_executor->getQueryResult(queryId).status; }
+
+    /// Terminal status of `queryId`, or Running if it did not finish within TIMEOUT
+    QueryStatus waitForEnd(const std::string& queryId) {
+        QueryStatus current = QueryStatus::Running;
+        eventually([&] {
+            current = status(queryId);
+            return current != QueryStatus::Pending && current != QueryStatus::Running;
+        });
+        return current;
+    }
+
+    std::vector<std::string> started() {
+        std::lock_guard lock(m_startedMutex);
+        return m_started;
+    }
+
+    std::unique_ptr<AsyncQueryExecutor> m_executor;
+
+private:
+    std::promise<void> m_releaseSignal;
+    std::shared_future<void> m_released = m_releaseSignal.get_future().share();
+    bool m_releasedOnce = false;
+    std::mutex m_startedMutex;
+    std::vector<std::string> m_started;
+};
+
+TEST_F(AsyncQueryExecutorTest, InteractiveQueriesRunBeforeBackgroundOnes) {
+    auto& executor = make(1);
+    const auto blocker = submitBlocker();
+    const auto background = submit(makeDriver(), QueryPriority::Background);
+    const auto interactive = submit(makeDriver(), QueryPriority::Interactive);
+
+    const auto stats = executor.queueStats();
+    EXPECT_EQ(stats.queuedInteractive, 1u);
+    EXPECT_EQ(stats.queuedBackground, 1u);
+
+    release();
+    EXPECT_EQ(waitForEnd(background), QueryStatus::Completed);
+    EXPECT_EQ(waitForEnd(interactive), QueryStatus::Completed);
+    EXPECT_EQ(started(), (std::vector<std::string>{blocker, interactive, background}));
+}
+
+TEST_F(AsyncQueryExecutorTest, PerConnectionLimitHoldsBackOnlyThatConnection) {
+    make(4, 1);
+    const auto blocker = submitBlocker("a");
+    const auto sameConnection = submit(makeDriver(), QueryPriority::Interactive, "a");
+    const auto otherConnection = submit(makeDriver(), QueryPriority::Interactive, "b");
+
+    // A free worker skips the query held back by "a" and runs the one behind it
+    EXPECT_EQ(waitForEnd(otherConnection), QueryStatus::Completed);
+    EXPECT_EQ(status(sameConnection), QueryStatus::Pending);
+
+    release();
+    EXPECT_EQ(waitForEnd(blocker), QueryStatus::Completed);
+    EXPECT_EQ(waitForEnd(sameConnection), QueryStatus::Completed);
+}
+
+TEST_F(AsyncQueryExecutorTest, RejectsSubmissionsPastMaxQueuedQueries) {
+    auto& executor = make(1);
+    submitBlocker();
+
+    const auto driver = makeDriver();
+    for (size_t i = 0; i < AsyncQueryExecutor::MAX_QUEUED_QUERIES; ++i) {
+        submit(driver, QueryPriority::Background);
+    }
+    EXPECT_THROW(submit(driver), std::runtime_error);
+
+    const auto stats = executor.queueStats();
+    EXPECT_EQ(stats.queuedBackground, AsyncQueryExecutor::MAX_QUEUED_QUERIES);
+    EXPECT_EQ(stats.queuedInteractive, 0u);
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.submitted, AsyncQueryExecutor::MAX_QUEUED_QUERIES + 1);
+}
+
+TEST_F(AsyncQueryExecutorTest, QueryCancelledWhileQueuedNeverRuns) {
+    auto& executor = make(1);
+    const auto blocker = submitBlocker();
+    const auto driver = makeDriver();
+    const auto queued = submit(driver);
+
+    EXPECT_TRUE(executor.cancelQuery(queued));
+    EXPECT_EQ(status(queued), QueryStatus::Cancelled);
+
+    release();
+    EXPECT_EQ(waitForEnd(blocker), QueryStatus::Completed);
+    // The worker still dequeues the cancelled job, then drops it
+    ASSERT_TRUE(eventually([&] {
+        const auto stats = executor.queueStats();
+        return stats.queuedInteractive == 0 && stats.busyWorkers == 0;
+    }));
+    EXPECT_EQ(status(queued), QueryStatus::Cancelled);
+    EXPECT_EQ(driver->executeCount(), 0u);
+    EXPECT_EQ(started(), std::vector<std::string>{blocker});
+}
+
+TEST_F(AsyncQueryExecutorTest, CancelStopsARunningQueryButNotAFinishedOne) {
+    make(2);
+    const auto running = submit(makeDriver(4096, ReplayTiming{.rowsPerSecond = 1024.0}));
+    const auto finished = submit(makeDriver());
+    ASSERT_EQ(waitForEnd(finished), QueryStatus::Completed);
+    ASSERT_TRUE(eventually([&] { return m_executor->getQueryRows(running, 0, 0, 0).totalRows > 0; }));
+
+    EXPECT_TRUE(m_executor->cancelQuery(running));
+    EXPECT_EQ(waitForEnd(running), QueryStatus::Cancelled);
+
+    EXPECT_FALSE(m_executor->cancelQuery(finished));
+    EXPECT_EQ(status(finished), QueryStatus::Completed);
+}
+
+TEST_F(AsyncQueryExecutorTest, MaxRowsCutsOffDriversWithoutServerSideLimits) {
+    make(1);
+    QuerySubmitOptions options;
+    options.maxRows = 1000;
+    const auto id = m_executor->submitQuery(makeDriver(4096), SQL, {}, std::move(options));
+
+    ASSERT_EQ(waitForEnd(id), QueryStatus::Completed);
+    const auto result = m_executor->getQueryResult(id);
+    ASSERT_TRUE(result.result.has_value());
+    EXPECT_EQ(result.result->rowCount(), 1000u);
+    EXPECT_TRUE(result.result->truncated);
+    EXPECT_EQ(result.result->cellText(999, 1), "row 999");
+    EXPECT_EQ(result.rowsFetched, 1000u);
+}
+
+TEST_F(AsyncQueryExecutorTest, PagesRowsWhileTheQueryIsStillRunning) {
+    make(1);
+    // ~2 s of streaming, so the first batches are readable well before the last one arrives
+    const auto id = submit(makeDriver(4096, ReplayTiming{.rowsPerSecond = 2048.0}));
+
+    AsyncQueryRows page;
+    ASSERT_TRUE(eventually([&] {
+        page = m_executor->getQueryRows(id, 0, 0, 10);
+        return page.totalRows >= AsyncQueryExecutor::STREAM_BATCH_ROWS;
+    }));
+    ASSERT_EQ(page.status, QueryStatus::Running);
+    EXPECT_FALSE(page.statementComplete);
+    EXPECT_EQ(page.statementCount, 1u);
+    EXPECT_LT(page.totalRows, 4096u);
+
+    page = m_executor->getQueryRows(id, 0, 100, 10);
+    ASSERT_EQ(page.rows.rowCount(), 10u);
+    EXPECT_EQ(page.offset, 100u);
+    EXPECT_EQ(page.rows.cellText(0, 1), "row 100");
+    EXPECT_EQ(page.rows.cellText(9, 0), "109");
+
+    ASSERT_EQ(waitForEnd(id), QueryStatus::Completed);
+    page = m_executor->getQueryRows(id, 0, 4090, 10);
+    EXPECT_TRUE(page.statementComplete);
+    EXPECT_EQ(page.totalRows, 4096u);
+    ASSERT_EQ(page.rows.rowCount(), 6u);
+    EXPECT_EQ(page.rows.cellText(5, 1), "row 4095");
+}
+
+}  // namespace test
+}  // namespace velocitydb
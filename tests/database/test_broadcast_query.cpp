@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "database/broadcast_query.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet serverRows(std::vector<ColumnInfo> columns, std::initializer_list<std::vector<std::string>> rows) {
+    ResultSet result;
+    result.columns = std::move(columns);
+    for (const auto& row : rows) {
+        result.appendRow(row);
+    }
+    return result;
+}
+
+/// Streams a fixed result, fails, or hangs until cancelled
+class FakeDriver final : public IDatabaseDriver {
+public:
+    explicit FakeDriver(ResultSet rows) : m_rows(std::move(rows)) {}
+
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view) override { return m_rows; }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink& sink, size_t) override {
+        sink.onColumns(m_rows.columns);
+        if (fail) {
+            throw std::runtime_error("Login failed for user 'sa'");
+        }
+        while (hang && !m_cancelled) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (m_cancelled) {
+            throw std::runtime_error("Operation canceled");
+        }
+        (void)sink.onBatch(m_rows);
+        return StreamSummary{.columns = m_rows.columns, .totalRows = m_rows.rowCount()};
+    }
+    void cancel() override { m_cancelled = true; }
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    bool fail = false;
+    bool hang = false;
+
+private:
+    ResultSet m_rows;
+    std::atomic<bool> m_cancelled{false};
+};
+
+BroadcastQuery::Target target(std::string server, std::shared_ptr<FakeDriver> driver) {
+    return {std::move(server), [driver]() -> std::expected<BroadcastSession, std::string> { return BroadcastSession{.driver = driver, .release = {}}; }};
+}
+
+}  // namespace
+
+TEST(ResultMergerTest, MatchesColumnsByNameAndPadsMissingOnes) {
+    ResultMerger merger;
+    merger.append("alpha", serverRows({{.name = "db"}, {.name = "size"}}, {{"master", "10"}, {"model", "20"}}));
+    merger.append("beta", serverRows({{.name = "size"}, {.name = "db"}, {.name = "owner"}}, {{"30", "tempdb", "sa"}}));
+
+    const auto& result = merger.result();
+    ASSERT_EQ(result.columns.size(), 4);
+    EXPECT_EQ(result.columns[0].name, "server");
+    EXPECT_EQ(result.columns[1].name, "db");
+    EXPECT_EQ(result.columns[3].name, "owner");
+    ASSERT_EQ(result.rowCount(), 3);
+    EXPECT_EQ(result.cellText(2, 0), "beta");
+    EXPECT_EQ(result.cellText(2, 1), "tempdb");
+    EXPECT_EQ(result.cellText(2, 2), "30");
+    EXPECT_TRUE(result.isNull(0, 3));
+    EXPECT_EQ(result.cellText(2, 3), "sa");
+}
+
+TEST(BroadcastQueryTest, MergesEveryServerAndReportsFailuresPerServer) {
+    auto columns = std::vector<ColumnInfo>{{.name = "version"}};
+    auto alpha = std::make_shared<FakeDriver>(serverRows(columns, {{"16.0"}}));
+    auto beta = std::make_shared<FakeDriver>(serverRows(columns, {{"15.0"}}));
+    auto broken = std::make_shared<FakeDriver>(serverRows(columns, {}));
+    broken->fail = true;
+
+    std::vector<BroadcastQuery::Target> targets{target("alpha", alpha), target("broken", broken), target("beta", beta)};
+    targets.push_back({"unreachable", []() -> std::expected<BroadcastSession, std::string> { return std::unexpected("Server not found"); }});
+    BroadcastQuery broadcast("SELECT @@VERSION AS version", std::move(targets), 2);
+    broadcast.wait();
+
+    auto progress = broadcast.progress();
+    EXPECT_TRUE(progress.done);
+    ASSERT_EQ(progress.results.size(), 4);
+    ASSERT_TRUE(progress.result);
+    EXPECT_EQ(progress.result->rowCount(), 2);
+    size_t failed = 0;
+    for (const auto& outcome : progress.results) {
+        if (!outcome.success) {
+            ++failed;
+            EXPECT_TRUE(outcome.server == "broken" || outcome.server == "unreachable");
+            EXPECT_FALSE(outcome.message.empty());
+        }
+    }
+    EXPECT_EQ(failed, 2);
+    EXPECT_EQ(broadcast.progress(3).results.size(), 1);
+}
+
+TEST(BroadcastQueryTest, SlowServersTimeOutWithoutHoldingUpTheRest) {
+    auto columns = std::vector<ColumnInfo>{{.name = "n"}};
+    auto slow = std::make_shared<FakeDriver>(serverRows(columns, {{"1"}}));
+    slow->hang = true;
+    auto fast = std::make_shared<FakeDriver>(serverRows(columns, {{"2"}}));
+
+    BroadcastQuery broadcast("SELECT 1 AS n", {target("slow", slow), target("fast", fast)}, 2, std::chrono::milliseconds(50));
+    broadcast.wait();
+
+    auto progress = broadcast.progress();
+    ASSERT_EQ(progress.results.size(), 2);
+    for (const auto& outcome : progress.results) {
+        EXPECT_EQ(outcome.timedOut, outcome.server == "slow");
+        EXPECT_EQ(outcome.success, outcome.server == "fast");
+    }
+    EXPECT_EQ(progress.result->rowCount(), 1);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "database/result_set.h"
+
+#include <cmath>
+#include <format>
+#include <limits>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// 0, 1, ... with every 7th row NULL
+ColumnData makeInts(size_t rows) {
+    ColumnData column(ColumnDataType::Int64);
+    for (size_t row = 0; row < rows; ++row) {
+        if (row % 7 == 0) {
+            column.appendNull();
+        } else {
+            column.appendInt64(static_cast<int64_t>(row));
+        }
+    }
+    return column;
+}
+
+}  // namespace
+
+TEST(ColumnStatsTest, FoldsZonesIncrementally) {
+    auto column = makeInts(3000);
+    column.updateStats();
+    EXPECT_EQ(column.stats().rows(), 3000);
+    for (size_t row = 3000; row < 10000; ++row) {
+        column.appendInt64(-static_cast<int64_t>(row));
+    }
+    column.updateStats();
+
+    auto oneShot = makeInts(3000);
+    for (size_t row = 3000; row < 10000; ++row) {
+        oneShot.appendInt64(-static_cast<int64_t>(row));
+    }
+    oneShot.updateStats();
+
+    const auto& stats = column.stats();
+    ASSERT_EQ(stats.zones().size(), 3);
+    EXPECT_EQ(stats.zones()[0].rows, ColumnStats::ZONE_ROWS);
+    EXPECT_EQ(stats.zones()[2].rows, 10000 - 2 * ColumnStats::ZONE_ROWS);
+    // Rows 0..2999 step 7 are NULL: 429 of them, all in the first zone
+    EXPECT_EQ(stats.nullCount(), 429);
+    EXPECT_EQ(stats.zones()[0].nullCount, 429);
+    EXPECT_EQ(stats.zones()[0].minInt, -4095);
+    EXPECT_EQ(stats.zones()[0].maxInt, 2999);
+    EXPECT_EQ(stats.zones()[2].maxInt, -8192);
+    EXPECT_EQ(stats.minRow(), 9999);
+    EXPECT_EQ(stats.maxRow(), 2999);
+    for (size_t zone = 0; zone < stats.zones().size(); ++zone) {
+        EXPECT_EQ(stats.zones()[zone].minInt, oneShot.stats().zones()[zone].minInt);
+        EXPECT_EQ(stats.zones()[zone].nullCount, oneShot.stats().zones()[zone].nullCount);
+    }
+    EXPECT_EQ(stats.distinctEstimate(), oneShot.stats().distinctEstimate());
+
+    EXPECT_TRUE(stats.zones()[1].mayContain(int64_t{-5000}, int64_t{-5000}));
+    EXPECT_FALSE(stats.zones()[1].mayContain(int64_t{0}, int64_t{100}));
+    EXPECT_TRUE(stats.zones()[1].allWithin(int64_t{-9000}, int64_t{0}));
+    EXPECT_FALSE(stats.zones()[0].allWithin(int64_t{-9000}, int64_t{9000}));  // holds NULLs
+}
+
+TEST(ColumnStatsTest, EstimatesDistinctValues) {
+    ColumnData small(ColumnDataType::Text);
+    for (size_t row = 0; row < 1000; ++row) {
+        small.appendText(std::format("status {}", row % 10));
+    }
+    small.updateStats();
+    EXPECT_EQ(small.stats().distinctEstimate(), 10);
+
+    ColumnData large(ColumnDataType::Text);
+    for (size_t row = 0; row < 60000; ++row) {
+        large.appendText(std::format("customer-{}", row % 20000));
+    }
+    large.updateStats();
+    EXPECT_NEAR(static_cast<double>(large.stats().distinctEstimate()), 20000.0, 20000.0 * 0.06);
+    EXPECT_EQ(large.stats().minRow(), 0);  // "customer-0"
+    EXPECT_EQ(large.displayText(*large.stats().maxRow()), "customer-9999");
+}
+
+TEST(ColumnStatsTest, OrdersDoublesAndDatesAndStartsOverOnRewrite) {
+    ColumnData doubles(ColumnDataType::Double);
+    doubles.appendDouble(std::numeric_limits<double>::quiet_NaN());
+    doubles.appendDouble(2.5);
+    doubles.appendNull();
+    doubles.appendDouble(-1.0);
+    doubles.updateStats();
+    EXPECT_EQ(doubles.stats().minRow(), 3);
+    EXPECT_EQ(doubles.stats().maxRow(), 1);
+    EXPECT_EQ(doubles.stats().zones()[0].minDouble, -1.0);
+    EXPECT_EQ(doubles.stats().zones()[0].maxDouble, 2.5);
+    EXPECT_EQ(doubles.stats().nullCount(), 1);
+
+    ColumnData dates(ColumnDataType::Date);
+    dates.appendDateTime({.year = 2024, .month = 3, .day = 1});
+    dates.appendDateTime({.year = 2023, .month = 12, .day = 31});
+    dates.appendDateTime({.year = 2024, .month = 2, .day = 29});
+    dates.updateStats();
+    EXPECT_EQ(dates.stats().minRow(), 1);
+    EXPECT_EQ(dates.stats().maxRow(), 0);
+    EXPECT_EQ(dates.stats().distinctEstimate(), 3);
+
+    // A value that does not parse turns the column into text: its stats are folded again from the first row
+    ColumnData ints(ColumnDataType::Int64);
+    ints.appendFromText("10");
+    ints.appendFromText("9");
+    ints.updateStats();
+    EXPECT_EQ(ints.stats().minRow(), 1);
+    ints.appendFromText("n/a");
+    EXPECT_EQ(ints.stats().rows(), 0);
+    ints.updateStats();
+    EXPECT_EQ(ints.stats().minRow(), 0);  // "10" < "9" < "n/a" as text
+    EXPECT_EQ(ints.stats().maxRow(), 2);
+
+    ints.clear();
+    EXPECT_EQ(ints.stats().rows(), 0);
+    EXPECT_TRUE(ints.stats().zones().empty());
+    EXPECT_FALSE(ints.stats().minRow());
+}
+
+TEST(ColumnStatsTest, AppendBatchFoldsTheBatch) {
+    ResultSet batch;
+    batch.columns.push_back({.name = "n"});
+    batch.columnData.emplace_back(ColumnDataType::Int64);
+    for (int64_t value = 0; value < 100; ++value) {
+        batch.columnData[0].appendInt64(value);
+    }
+    ResultSet result;
+    result.appendBatch(batch);
+    result.appendBatch(batch);
+    const auto& stats = result.columnData[0].stats();
+    EXPECT_EQ(stats.rows(), 200);
+    EXPECT_NEAR(static_cast<double>(stats.distinctEstimate()), 100.0, 3.0);
+    EXPECT_EQ(stats.zones()[0].maxInt, 99);
+}
+
+}  // namespace test
+}  // namespace velocitydb
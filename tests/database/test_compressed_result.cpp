@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "database/compressed_result.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Int64, repetitive text and a sparse NULL column over `rows` rows
+ResultSet makeResult(size_t rows) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "BIGINT"});
+    result.columns.push_back({.name = "status", .type = "VARCHAR"});
+    result.columns.push_back({.name = "note", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (size_t i = 0; i < rows; ++i) {
+        result.columnData[0].appendInt64(static_cast<int64_t>(i));
+        result.columnData[1].appendText(i % 3 == 0 ? "open" : "closed");
+        if (i % 7 == 0) {
+            result.columnData[2].appendNull();
+        } else {
+            result.columnData[2].appendText(std::format("note {}", i));
+        }
+    }
+    result.affectedRows = -1;
+    result.executionTimeMs = 12.5;
+    result.truncated = true;
+    result.lobPreviews.push_back({.row = 5, .column = 2, .totalBytes = 100});
+    result.lobPreviews.push_back({.row = CompressedResult::WINDOW_ROWS + 1, .column = 2, .totalBytes = 200});
+    result.updateStats();
+    return result;
+}
+
+void expectSameRows(const ResultSet& actual, const ResultSet& expected, size_t offset) {
+    ASSERT_EQ(actual.columnData.size(), expected.columnData.size());
+    for (size_t row = 0; row < actual.rowCount(); ++row) {
+        for (size_t col = 0; col < actual.columnData.size(); ++col) {
+            ASSERT_EQ(actual.isNull(row, col), expected.isNull(offset + row, col)) << "row " << offset + row;
+            ASSERT_EQ(actual.columnData[col].displayText(row), expected.columnData[col].displayText(offset + row)) << "row " << offset + row;
+        }
+    }
+}
+
+}  // namespace
+
+TEST(CompressedResultTest, WindowsMatchTheOriginalAcrossBlockEdges) {
+    const auto original = makeResult(CompressedResult::WINDOW_ROWS * 2 + 100);
+    const auto compressed = CompressedResult::compress(original);
+    EXPECT_EQ(compressed.rowCount(), original.rowCount());
+    EXPECT_LT(compressed.memoryBytes(), original.memoryBytes() / 2);
+
+    for (size_t offset : {size_t{0}, CompressedResult::WINDOW_ROWS - 10, CompressedResult::WINDOW_ROWS * 2 + 90}) {
+        const auto window = compressed.window(offset, 50);
+        EXPECT_EQ(window.rowCount(), (std::min)(size_t{50}, original.rowCount() - offset));
+        EXPECT_EQ(window.columnData[0].type(), ColumnDataType::Int64);
+        expectSameRows(window, original, offset);
+    }
+    EXPECT_TRUE(compressed.window(original.rowCount(), 50).empty());
+
+    const auto whole = compressed.decompress();
+    ASSERT_EQ(whole.rowCount(), original.rowCount());
+    expectSameRows(whole, original, 0);
+    EXPECT_EQ(whole.executionTimeMs, 12.5);
+    EXPECT_TRUE(whole.truncated);
+    EXPECT_EQ(whole.columns[1].name, "status");
+}
+
+TEST(CompressedResultTest, LobPreviewsFollowTheirWindow) {
+    const auto compressed = CompressedResult::compress(makeResult(CompressedResult::WINDOW_ROWS + 10));
+    const auto window = compressed.window(CompressedResult::WINDOW_ROWS, 5);
+    ASSERT_EQ(window.lobPreviews.size(), 1u);
+    EXPECT_EQ(window.lobPreviews[0].row, 1u);
+    EXPECT_EQ(window.lobPreviews[0].totalBytes, 200);
+    EXPECT_EQ(compressed.decompress().lobPreviews.size(), 2u);
+}
+
+TEST(CompressedResultTest, SpilledBlocksAreReadFromDiskAndRemovedWithTheResult) {
+    const auto directory = std::filesystem::temp_directory_path() / "velocitydb_compressed_result_test";
+    const auto path = directory / "spill.bin";
+    const auto original = makeResult(CompressedResult::WINDOW_ROWS + 500);
+    {
+        auto compressed = CompressedResult::compress(original);
+        const size_t resident = compressed.memoryBytes();
+        ASSERT_TRUE(compressed.spill(path));
+        EXPECT_TRUE(compressed.spilled());
+        EXPECT_TRUE(std::filesystem::exists(path));
+        EXPECT_EQ(std::filesystem::file_size(path), compressed.storedBytes());
+        EXPECT_LT(compressed.memoryBytes(), resident);
+
+        expectSameRows(compressed.window(CompressedResult::WINDOW_ROWS - 3, 10), original, CompressedResult::WINDOW_ROWS - 3);
+
+        // Moving keeps the file; only the last owner removes it
+        auto moved = std::move(compressed);
+        EXPECT_TRUE(std::filesystem::exists(path));
+        EXPECT_EQ(moved.decompress().rowCount(), original.rowCount());
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+    std::filesystem::remove_all(directory);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "database/connection_pool.h"
+#include "database/sqlserver_driver.h"
+
+namespace velocitydb {
+namespace test {
+
+TEST(ConnectionPoolTest, UnknownConnectionReturnsNull) {
+    ConnectionPool pool;
+    EXPECT_EQ(pool.acquire("missing", std::chrono::milliseconds(0)), nullptr);
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.checkouts, 0);
+    EXPECT_EQ(stats.waits, 0);
+    EXPECT_EQ(stats.idle, 0);
+    EXPECT_EQ(stats.inUse, 0);
+}
+
+TEST(ConnectionPoolTest, ReleaseOfForeignDriverJustDisconnects) {
+    ConnectionPool pool;
+    EXPECT_NO_THROW(pool.release(nullptr));
+
+    auto driver = std::make_shared<SQLServerDriver>();
+    EXPECT_FALSE(driver->isAlive());
+    pool.release(driver);
+    EXPECT_FALSE(driver->isConnected());
+    EXPECT_EQ(pool.stats().idle, 0);
+}
+
+TEST(ConnectionPoolTest, EvictIdleOnEmptyPool) {
+    ConnectionPool pool(2, 1, std::chrono::seconds(0));
+    EXPECT_EQ(pool.evictIdle(), 0);
+}
+
+// Integration tests (require actual database)
+
+TEST(ConnectionPoolTest, DISABLED_ReusesReleasedDriver) {
+    ConnectionPool pool(1);
+    ConnectionInfo info{.id = "local", .name = "local", .server = "localhost", .database = "master"};
+    ASSERT_TRUE(pool.addConnection(info));
+
+    auto first = pool.acquire("local");
+    ASSERT_NE(first, nullptr);
+    auto* raw = first.get();
+    // The pool is exhausted until the driver comes back
+    EXPECT_EQ(pool.acquire("local", std::chrono::milliseconds(10)), nullptr);
+    pool.release(std::move(first));
+
+    auto second = pool.acquire("local");
+    EXPECT_EQ(second.get(), raw);
+    pool.release(std::move(second));
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.created, 1);
+    EXPECT_EQ(stats.reused, 2);
+    EXPECT_EQ(stats.waits, 1);
+    EXPECT_EQ(stats.waitTimeouts, 1);
+    EXPECT_EQ(stats.idle, 1);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include "database/connection_registry.h"
+#include "database/driver_interface.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Records executed statements instead of talking to a server
+class FakeDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return m_connected = true; }
+    void disconnect() override { m_connected = false; }
+    bool isConnected() const noexcept override { return m_connected; }
+    ResultSet execute(std::string_view sql) override {
+        if (broken) {
+            throw std::runtime_error("Communication link failure");
+        }
+        executed.emplace_back(sql);
+        return {};
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override { ++cancels; }
+    bool reconnect() override {
+        ++reconnects;
+        broken = false;
+        return m_connected = true;
+    }
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::vector<std::string> executed;
+    int cancels = 0;
+    bool broken = false;  ///< Every execute fails until reconnect()
+    int reconnects = 0;
+
+private:
+    bool m_connected = true;
+};
+
+}  // namespace
+
+class ConnectionRegistryLaneTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        session = std::make_shared<FakeDriver>();
+        metadata = std::make_shared<FakeDriver>();
+        id = registry.add(session, metadata, {}, [this]() -> ConnectionRegistry::DriverPtr {
+            if (failOpen) {
+                return nullptr;
+            }
+            opened.push_back(std::make_shared<FakeDriver>());
+            return opened.back();
+        }, 3);
+    }
+
+    ConnectionRegistry registry;
+    std::shared_ptr<FakeDriver> session;
+    std::shared_ptr<FakeDriver> metadata;
+    std::vector<std::shared_ptr<FakeDriver>> opened;
+    bool failOpen = false;
+    std::string id;
+};
+
+TEST_F(ConnectionRegistryLaneTest, SessionDependentWorkStaysOnSessionLane) {
+    auto first = registry.checkoutLane(id, false);
+    auto second = registry.checkoutLane(id, false);
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(first->driver, session);
+    EXPECT_EQ(second->driver, session);
+    EXPECT_TRUE(opened.empty());
+    first->release();
+    second->release();
+}
+
+TEST_F(ConnectionRegistryLaneTest, BusySessionLaneOpensBoundedExtraLanes) {
+    auto a = registry.checkoutLane(id, true);
+    auto b = registry.checkoutLane(id, true);
+    auto c = registry.checkoutLane(id, true);
+    auto d = registry.checkoutLane(id, true);
+    ASSERT_TRUE(a && b && c && d);
+    EXPECT_EQ(a->driver, session);
+    EXPECT_NE(b->driver, session);
+    EXPECT_NE(c->driver, b->driver);
+    EXPECT_EQ(opened.size(), 2);
+    EXPECT_EQ(registry.laneCount(id), 3);
+    // At the limit the least busy lane is shared
+    EXPECT_EQ(d->driver, session);
+
+    // A freed lane is reused before anything new is opened
+    b->release();
+    auto e = registry.checkoutLane(id, true);
+    EXPECT_EQ(e->driver, b->driver);
+    EXPECT_EQ(opened.size(), 2);
+
+    a->release();
+    c->release();
+    d->release();
+    e->release();
+}
+
+TEST_F(ConnectionRegistryLaneTest, PinnedSessionAndFailedOpensFallBackToSessionLane) {
+    auto busy = registry.checkoutLane(id, false);
+    registry.setSessionPinned(id, true);
+    auto pinned = registry.checkoutLane(id, true);
+    EXPECT_EQ(pinned->driver, session);
+    pinned->release();
+
+    registry.setSessionPinned(id, false);
+    failOpen = true;
+    auto fallback = registry.checkoutLane(id, true);
+    EXPECT_EQ(fallback->driver, session);
+    EXPECT_EQ(registry.laneCount(id), 1);
+    fallback->release();
+    busy->release();
+}
+
+TEST_F(ConnectionRegistryLaneTest, ExtraLanesFollowDatabaseChanges) {
+    auto busy = registry.checkoutLane(id, false);
+    registry.noteDatabaseChange(id, "Sales]DB");
+    auto lane = registry.checkoutLane(id, true);
+    ASSERT_EQ(opened.size(), 1);
+    EXPECT_EQ(opened[0]->executed, (std::vector<std::string>{"USE [Sales]]DB]"}));
+    lane->release();
+
+    // Already in sync: no second USE
+    auto again = registry.checkoutLane(id, true);
+    EXPECT_EQ(opened[0]->executed.size(), 1);
+    EXPECT_TRUE(session->executed.empty());
+    again->release();
+    busy->release();
+}
+
+TEST_F(ConnectionRegistryLaneTest, CancelAllReachesBusyLanesAndUnknownIdsFail) {
+    auto a = registry.checkoutLane(id, true);
+    auto b = registry.checkoutLane(id, true);
+    registry.cancelAll(id);
+    EXPECT_EQ(session->cancels, 1);
+    EXPECT_EQ(opened[0]->cancels, 1);
+    // Work past the driver (serialization, export writes) stops on the checkout's token
+    EXPECT_TRUE(a->cancellation.cancelled());
+    EXPECT_TRUE(b->cancellation.cancelled());
+    a->release();
+    b->release();
+
+    // A fresh checkout starts with a fresh token, and a released one is no longer reached
+    auto c = registry.checkoutLane(id, true);
+    EXPECT_FALSE(c->cancellation.cancelled());
+    c->release();
+    registry.cancelAll(id);
+    EXPECT_FALSE(c->cancellation.cancelled());
+
+    EXPECT_FALSE(registry.checkoutLane("missing", true));
+    registry.remove(id);
+    EXPECT_FALSE(opened[0]->isConnected());
+    EXPECT_EQ(registry.laneCount(id), 0);
+}
+
+TEST_F(ConnectionRegistryLaneTest, DedicatedDriversStayOutOfTheLanePool) {
+    auto dedicated = registry.openDedicatedDriver(id);
+    ASSERT_TRUE(dedicated);
+    EXPECT_EQ(opened.size(), 1);
+    EXPECT_EQ(registry.laneCount(id), 1);
+
+    auto busy = registry.checkoutLane(id, false);
+    auto lane = registry.checkoutLane(id, true);
+    EXPECT_NE(lane->driver, dedicated);
+    lane->release();
+    busy->release();
+
+    EXPECT_FALSE(registry.openDedicatedDriver("missing"));
+}
+
+TEST_F(ConnectionRegistryLaneTest, KeepAliveReconnectsBrokenIdleDrivers) {
+    registry.noteDatabaseChange(id, "Sales");
+    session->broken = true;
+
+    // Just added counts as used
+    EXPECT_EQ(registry.keepAlive(std::chrono::hours(1)), 0u);
+    EXPECT_EQ(session->reconnects, 0);
+    EXPECT_TRUE(metadata->executed.empty());
+
+    EXPECT_EQ(registry.keepAlive(std::chrono::seconds(0)), 1u);
+    EXPECT_EQ(session->reconnects, 1);
+    EXPECT_EQ(session->executed, (std::vector<std::string>{"USE [Sales]"}));
+    EXPECT_EQ(metadata->executed, (std::vector<std::string>{"SELECT 1"}));
+    EXPECT_EQ(metadata->reconnects, 0);
+}
+
+TEST_F(ConnectionRegistryLaneTest, KeepAliveSkipsBusyLanesAndPinnedSessions) {
+    auto busy = registry.checkoutLane(id, false);
+    EXPECT_EQ(registry.keepAlive(std::chrono::seconds(0)), 0u);
+    EXPECT_TRUE(session->executed.empty());
+    busy->release();
+
+    registry.setSessionPinned(id, true);
+    session->broken = true;
+    metadata->executed.clear();
+    EXPECT_EQ(registry.keepAlive(std::chrono::seconds(0)), 0u);
+    EXPECT_EQ(session->reconnects, 0);
+    EXPECT_TRUE(metadata->executed.empty());
+}
+
+TEST_F(ConnectionRegistryLaneTest, ReadLanesServeReadsAndFollowDatabaseChanges) {
+    // Without read intent, reads share the session-independent lanes
+    auto plain = registry.checkoutReadLane(id);
+    ASSERT_TRUE(plain);
+    EXPECT_EQ(plain->driver, session);
+    plain->release();
+    EXPECT_EQ(registry.getSchemaDriver(id).value(), metadata);
+
+    auto schema = std::make_shared<FakeDriver>();
+    std::vector<std::shared_ptr<FakeDriver>> secondaries;
+    registry.attachReadIntent(id, schema, [&secondaries]() -> ConnectionRegistry::DriverPtr {
+        secondaries.push_back(std::make_shared<FakeDriver>());
+        return secondaries.back();
+    });
+    EXPECT_EQ(registry.getSchemaDriver(id).value(), schema);
+    EXPECT_EQ(registry.getMetadataDriver(id).value(), metadata);
+
+    registry.noteDatabaseChange(id, "sales");
+    auto read = registry.checkoutReadLane(id);
+    ASSERT_TRUE(read);
+    ASSERT_EQ(secondaries.size(), 1);
+    EXPECT_EQ(read->driver, secondaries[0]);
+    EXPECT_EQ(secondaries[0]->executed, (std::vector<std::string>{"USE [sales]"}));
+    EXPECT_EQ(registry.readLaneCount(id), 1);
+    EXPECT_EQ(registry.laneCount(id), 1);
+    read->release();
+
+    // A transaction keeps its reads on the primary session
+    registry.setSessionPinned(id, true);
+    auto pinned = registry.checkoutReadLane(id);
+    EXPECT_EQ(pinned->driver, session);
+    pinned->release();
+}
+
+TEST_F(ConnectionRegistryLaneTest, ReadLanesFallBackToPrimaryWhenSecondaryFails) {
+    registry.attachReadIntent(id, nullptr, []() -> ConnectionRegistry::DriverPtr { return nullptr; });
+    EXPECT_EQ(registry.getSchemaDriver(id).value(), metadata);
+    auto read = registry.checkoutReadLane(id);
+    ASSERT_TRUE(read);
+    EXPECT_EQ(read->driver, session);
+    EXPECT_EQ(registry.readLaneCount(id), 0);
+    read->release();
+    EXPECT_FALSE(registry.checkoutReadLane("missing"));
+}
+
+}  // namespace test
+}  // namespace velocitydb
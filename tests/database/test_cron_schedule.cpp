@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "database/cron_schedule.h"
+
+#include <chrono>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+using namespace std::chrono;
+
+local_seconds at(int y, unsigned m, unsigned d, int hour, int minute) {
+    return local_seconds{local_days{year{y} / month{m} / day{d}}} + hours{hour} + minutes{minute};
+}
+
+}  // namespace
+
+TEST(CronScheduleTest, NextFindsTheFollowingMatchingMinute) {
+    auto weekdayMornings = CronSchedule::parse("30 6 * * 1-5");
+    ASSERT_TRUE(weekdayMornings.has_value());
+    // Friday 2026-10-16 06:30 is the next run after Thursday noon; after it comes Monday
+    EXPECT_EQ(weekdayMornings->next(at(2026, 10, 15, 12, 0)), at(2026, 10, 16, 6, 30));
+    EXPECT_EQ(weekdayMornings->next(at(2026, 10, 16, 6, 30)), at(2026, 10, 19, 6, 30));
+
+    auto quarterHours = CronSchedule::parse("*/15 22-23 * * *");
+    ASSERT_TRUE(quarterHours.has_value());
+    EXPECT_EQ(quarterHours->next(at(2026, 10, 15, 22, 14)), at(2026, 10, 15, 22, 15));
+    EXPECT_EQ(quarterHours->next(at(2026, 10, 15, 23, 45)), at(2026, 10, 16, 22, 0));
+
+    auto daily = CronSchedule::parse("@daily");
+    ASSERT_TRUE(daily.has_value());
+    EXPECT_EQ(daily->next(at(2026, 12, 31, 0, 0)), at(2027, 1, 1, 0, 0));
+}
+
+TEST(CronScheduleTest, RestrictedDayFieldsMatchEitherDay) {
+    // The 1st of the month or any Sunday (7 spelled as Sunday)
+    auto schedule = CronSchedule::parse("0 8 1 * 7");
+    ASSERT_TRUE(schedule.has_value());
+    EXPECT_EQ(schedule->next(at(2026, 10, 15, 0, 0)), at(2026, 10, 18, 8, 0));
+    EXPECT_EQ(schedule->next(at(2026, 10, 25, 9, 0)), at(2026, 11, 1, 8, 0));
+
+    auto leapDay = CronSchedule::parse("0 0 29 2 *");
+    ASSERT_TRUE(leapDay.has_value());
+    EXPECT_EQ(leapDay->next(at(2026, 3, 1, 0, 0)), at(2028, 2, 29, 0, 0));
+    EXPECT_FALSE(CronSchedule::parse("0 0 30 2 *")->next(at(2026, 1, 1, 0, 0)).has_value());
+}
+
+TEST(CronScheduleTest, RejectsMalformedExpressions) {
+    for (const char* expression : {"", "* * * *", "60 * * * *", "* 24 * * *", "* * 0 * *", "* * * 13 *", "* * * * 8", "5-1 * * * *", "*/0 * * * *", "1,,2 * * * *", "a * * * *"}) {
+        EXPECT_FALSE(CronSchedule::parse(expression).has_value()) << expression;
+    }
+}
+
+TEST(CronScheduleTest, WindowsMayWrapPastMidnight) {
+    auto night = TimeWindow::parse("22:00", "06:00");
+    ASSERT_TRUE(night.has_value());
+    EXPECT_TRUE(night->contains(at(2026, 10, 15, 23, 30)));
+    EXPECT_TRUE(night->contains(at(2026, 10, 16, 5, 59)));
+    EXPECT_FALSE(night->contains(at(2026, 10, 16, 6, 0)));
+    EXPECT_EQ(night->nextOpening(at(2026, 10, 16, 9, 0)), at(2026, 10, 16, 22, 0));
+    EXPECT_EQ(night->nextOpening(at(2026, 10, 16, 1, 0)), at(2026, 10, 16, 1, 0));
+
+    auto lunch = TimeWindow::parse("12:00", "13:00");
+    ASSERT_TRUE(lunch.has_value());
+    EXPECT_EQ(lunch->nextOpening(at(2026, 10, 16, 13, 0)), at(2026, 10, 17, 12, 0));
+    EXPECT_FALSE(TimeWindow::parse("25:00", "06:00").has_value());
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "database/disk_result_cache.h"
+#include "database/result_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class DiskResultCacheTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "velocitydb_disk_cache_test";
+
+    void SetUp() override { std::filesystem::remove_all(directory); }
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    static ResultSet makeResult(int rows) {
+        ResultSet result;
+        result.columns.push_back({.name = "id", .type = "INT"});
+        result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+        result.columnData.emplace_back(ColumnDataType::Int64);
+        result.columnData.emplace_back(ColumnDataType::Text);
+        for (int i = 0; i < rows; ++i) {
+            result.columnData[0].appendInt64(i);
+            result.columnData[1].appendText("customer " + std::to_string(i % 10));
+        }
+        result.affectedRows = rows;
+        return result;
+    }
+
+    static size_t segmentFiles(const std::filesystem::path& dir) {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            count += entry.path().extension() == ".vdbs";
+        }
+        return count;
+    }
+};
+
+TEST_F(DiskResultCacheTest, PersistsAcrossInstances) {
+    const auto key = ResultCache::makeKey("sa@db01/Sales", "SELECT * FROM customers");
+    const std::vector<std::string> tables{"customers"};
+    {
+        DiskResultCache cache(directory);
+        ASSERT_TRUE(cache.put(key, makeResult(50000), tables));
+        EXPECT_EQ(cache.entryCount(), 1);
+        // Repetitive columnar data compresses well below its in-memory size
+        EXPECT_LT(cache.totalBytes(), makeResult(50000).memoryBytes() / 2);
+    }
+
+    DiskResultCache reopened(directory);
+    ASSERT_EQ(reopened.entryCount(), 1);
+    auto result = reopened.get(key);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->rowCount(), 50000);
+    EXPECT_EQ(result->cellText(49999, 0), "49999");
+    EXPECT_EQ(result->cellText(12, 1), "customer 2");
+    EXPECT_EQ(reopened.get(ResultCache::makeKey("sa@db01/Sales", "SELECT 1")), nullptr);
+}
+
+TEST_F(DiskResultCacheTest, InvalidatesByScopeAndTable) {
+    DiskResultCache cache(directory);
+    const std::vector<std::string> orders{"orders"};
+    const std::vector<std::string> users{"users"};
+    const auto ordersKey = ResultCache::makeKey("sa@db01/Sales", "SELECT * FROM orders");
+    const auto usersKey = ResultCache::makeKey("sa@db01/Sales", "SELECT * FROM users");
+    const auto otherServerKey = ResultCache::makeKey("sa@db02/Sales", "SELECT * FROM orders");
+    ASSERT_TRUE(cache.put(ordersKey, makeResult(10), orders));
+    ASSERT_TRUE(cache.put(usersKey, makeResult(10), users));
+    ASSERT_TRUE(cache.put(otherServerKey, makeResult(10), orders));
+
+    EXPECT_EQ(cache.invalidateTables("sa@db01/", orders), 1);
+    EXPECT_EQ(cache.get(ordersKey), nullptr);
+    EXPECT_NE(cache.get(usersKey), nullptr);
+    EXPECT_NE(cache.get(otherServerKey), nullptr);
+
+    EXPECT_EQ(cache.invalidateScope("sa@db02/"), 1);
+    EXPECT_EQ(cache.entryCount(), 1);
+    EXPECT_EQ(segmentFiles(directory), 1);
+
+    cache.clear();
+    EXPECT_EQ(cache.totalBytes(), 0);
+    EXPECT_EQ(segmentFiles(directory), 0);
+}
+
+TEST_F(DiskResultCacheTest, EvictsOldestAndDropsExpired) {
+    const auto firstKey = ResultCache::makeKey("s/db", "SELECT * FROM a");
+    const auto secondKey = ResultCache::makeKey("s/db", "SELECT * FROM b");
+    size_t segmentBytes = 0;
+    {
+        DiskResultCache probe(directory);
+        ASSERT_TRUE(probe.put(firstKey, makeResult(100), {}));
+        segmentBytes = probe.totalBytes();
+        probe.clear();
+    }
+
+    DiskResultCache capped(directory, segmentBytes + segmentBytes / 2);
+    ASSERT_TRUE(capped.put(firstKey, makeResult(100), {}));
+    ASSERT_TRUE(capped.put(secondKey, makeResult(100), {}));
+    EXPECT_EQ(capped.entryCount(), 1);
+    EXPECT_EQ(capped.get(firstKey), nullptr);
+    EXPECT_NE(capped.get(secondKey), nullptr);
+
+    // A zero TTL expires everything on reopen
+    DiskResultCache expired(directory, DiskResultCache::DEFAULT_MAX_BYTES, std::chrono::seconds(0));
+    EXPECT_EQ(expired.entryCount(), 0);
+    EXPECT_EQ(segmentFiles(directory), 0);
+}
+
+TEST_F(DiskResultCacheTest, DiscardsCorruptSegments) {
+    const auto key = ResultCache::makeKey("s/db", "SELECT * FROM a");
+    {
+        DiskResultCache cache(directory);
+        ASSERT_TRUE(cache.put(key, makeResult(1000), {}));
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) - 16);
+    }
+    std::ofstream(directory / "junk.vdbs") << "not a segment";
+
+    DiskResultCache reopened(directory);
+    EXPECT_EQ(reopened.entryCount(), 1);
+    EXPECT_EQ(reopened.get(key), nullptr);
+    EXPECT_EQ(reopened.entryCount(), 0);
+    EXPECT_EQ(segmentFiles(directory), 0);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "database/index_advisor.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet rows(size_t columnCount, std::initializer_list<std::vector<std::string>> values) {
+    ResultSet result;
+    for (size_t i = 0; i < columnCount; ++i) {
+        result.columns.push_back({.name = "c" + std::to_string(i)});
+    }
+    for (const auto& row : values) {
+        result.appendRow(row);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(IndexAdvisorTest, SplitsBracketedColumnLists) {
+    EXPECT_EQ(IndexAdvisor::splitColumnList("[a], [b, c], [d]]e] DESC"), (std::vector<std::string>{"[a]", "[b, c]", "[d]]e] DESC"}));
+    EXPECT_TRUE(IndexAdvisor::splitColumnList("").empty());
+}
+
+TEST(IndexAdvisorTest, MergesMissingIndexesAndFlagsUnneededOnes) {
+    std::vector<ResultSet> results;
+    results.push_back(rows(1, {{"72"}}));
+    results.push_back(rows(9, {{"dbo", "Orders", "[CustomerId]", "", "[Total]", "100", "0", "2.0", "50"},
+                               {"dbo", "Orders", "[CustomerId]", "", "[Status], [Total]", "20", "10", "1.0", "80"},
+                               {"dbo", "Lines", "[OrderId]", "[Qty]", "", "5", "0", "1.0", "10"}}));
+    results.push_back(rows(11, {{"dbo", "Orders", "1", "PK_Orders", "1", "", "[Id]", "", "900", "10", "100"},
+                                {"dbo", "Orders", "2", "IX_Customer", "0", "", "[CustomerId]", "", "40", "5", "16"},
+                                {"dbo", "Orders", "3", "IX_Customer_Date", "0", "", "[CustomerId], [OrderDate] DESC", "", "30", "5", "32"},
+                                {"dbo", "Orders", "4", "IX_Date", "0", "", "[OrderDate] DESC", "", "10", "5", "8"},
+                                {"dbo", "Orders", "5", "IX_Date_Copy", "0", "", "[OrderDate] DESC", "", "0", "5", "8"},
+                                {"dbo", "Orders", "6", "IX_Status", "0", "", "[Status]", "[Total]", "0", "50", "4"},
+                                {"dbo", "Orders", "7", "UQ_Number", "1", "", "[Number]", "", "0", "5", "4"}}));
+
+    auto advice = IndexAdvisor::analyze(results);
+    EXPECT_EQ(advice.uptimeHours, 72);
+
+    ASSERT_EQ(advice.suggestions.size(), 2);
+    const auto& orders = advice.suggestions[0];
+    EXPECT_EQ(orders.table, "Orders");
+    EXPECT_EQ(orders.seeks, 120);
+    EXPECT_EQ(orders.scans, 10);
+    EXPECT_DOUBLE_EQ(orders.improvement, 100.0 + 24.0);
+    EXPECT_DOUBLE_EQ(orders.avgUserImpact, 80.0);
+    EXPECT_EQ(orders.includedColumns, (std::vector<std::string>{"[Total]", "[Status]"}));
+    EXPECT_EQ(orders.extends, "IX_Customer");
+    EXPECT_EQ(orders.createStatement, "CREATE NONCLUSTERED INDEX [IX_Orders_CustomerId] ON [dbo].[Orders] ([CustomerId]) INCLUDE ([Total], [Status]);");
+    EXPECT_EQ(advice.suggestions[1].createStatement, "CREATE NONCLUSTERED INDEX [IX_Lines_OrderId_Qty] ON [dbo].[Lines] ([OrderId], [Qty]);");
+    EXPECT_TRUE(advice.suggestions[1].extends.empty());
+
+    ASSERT_EQ(advice.findings.size(), 3);
+    EXPECT_EQ(advice.findings[0].kind, IndexFinding::Kind::Duplicate);
+    EXPECT_EQ(advice.findings[0].index, "IX_Date_Copy");
+    EXPECT_EQ(advice.findings[0].coveredBy, "IX_Date");
+    EXPECT_EQ(advice.findings[0].dropStatement, "DROP INDEX [IX_Date_Copy] ON [dbo].[Orders];");
+    EXPECT_EQ(advice.findings[1].kind, IndexFinding::Kind::Redundant);
+    EXPECT_EQ(advice.findings[1].index, "IX_Customer");
+    EXPECT_EQ(advice.findings[1].coveredBy, "IX_Customer_Date");
+    EXPECT_EQ(advice.findings[1].sizeKb, 128);
+    EXPECT_EQ(advice.findings[2].kind, IndexFinding::Kind::Unused);
+    EXPECT_EQ(advice.findings[2].index, "IX_Status");
+    EXPECT_EQ(advice.findings[2].writes, 50);
+}
+
+TEST(IndexAdvisorTest, RejectsIncompleteBatches) {
+    EXPECT_THROW(IndexAdvisor::analyze(std::vector<ResultSet>(2)), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "database/instance_search.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::vector<SearchResult> tables(std::string_view prefix, size_t count) {
+    std::vector<SearchResult> results;
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back({.objectType = "TABLE", .schemaName = "dbo", .objectName = std::format("{}{}", prefix, i)});
+    }
+    return results;
+}
+
+}  // namespace
+
+TEST(InstanceSearchTest, BuildsOneCatalogQueryPerDatabase) {
+    const SearchOptions options{.searchViews = false, .searchProcedures = false, .searchIndexes = true, .caseSensitive = true};
+    const auto sql = InstanceSearch::buildQuery("Sales]2", "50%_[x]'", options, 25);
+    EXPECT_NE(sql.find("SELECT TOP (25)"), std::string::npos);
+    EXPECT_NE(sql.find("FROM [Sales]]2].sys.objects o"), std::string::npos);
+    EXPECT_NE(sql.find("o.type IN ('U','FN','IF','TF','FS','FT')"), std::string::npos);
+    EXPECT_NE(sql.find("[Sales]]2].sys.columns"), std::string::npos);
+    EXPECT_NE(sql.find("[Sales]]2].sys.indexes"), std::string::npos);
+    EXPECT_NE(sql.find("COLLATE Latin1_General_CS_AS LIKE N'%50[%][_][[]x]''%'"), std::string::npos);
+    EXPECT_NE(sql.find("ORDER BY kind, object_name"), std::string::npos);
+
+    EXPECT_TRUE(InstanceSearch::buildQuery("Sales", "", options, 25).empty());
+    const SearchOptions nothing{.searchTables = false, .searchViews = false, .searchProcedures = false, .searchFunctions = false, .searchColumns = false};
+    EXPECT_TRUE(InstanceSearch::buildQuery("Sales", "order", nothing, 25).empty());
+}
+
+TEST(InstanceSearchTest, ParsesMatchesWithTheirPosition) {
+    ResultSet result;
+    for (const char* name : {"kind", "schema_name", "object_name", "parent_name"}) {
+        result.columns.push_back({.name = name});
+    }
+    result.appendRow({"COLUMN", "dbo", "CustomerOrderId", "Orders"});
+    const auto matches = InstanceSearch::parseResults(result, "order", false);
+    ASSERT_EQ(matches.size(), 1);
+    EXPECT_EQ(matches[0].objectType, "COLUMN");
+    EXPECT_EQ(matches[0].parentName, "Orders");
+    EXPECT_EQ(matches[0].matchPosition, 8);
+}
+
+TEST(InstanceSearchTest, StreamsDatabasesAndStopsAtTheLimit) {
+    std::vector<DatabaseSearchOutcome> answered;
+    answered.push_back({.database = "current", .success = true, .fromIndex = true, .matches = tables("c", 3)});
+    std::atomic<int> searched = 0;
+    InstanceSearch search(
+        std::move(answered), {"a", "broken", "b", "d", "e"},
+        [&](const std::string& database, size_t limit) {
+            ++searched;
+            if (database == "broken") {
+                throw std::runtime_error("The server principal is not able to access the database");
+            }
+            return tables(database, (std::min<size_t>)(limit, 4));
+        },
+        10, 1);
+    search.wait();
+
+    const auto progress = search.progress();
+    EXPECT_TRUE(progress.done);
+    EXPECT_TRUE(progress.truncated);
+    EXPECT_EQ(progress.total, 6);
+    EXPECT_EQ(progress.matches, 10);
+    ASSERT_EQ(progress.databases.size(), 6);
+    EXPECT_TRUE(progress.databases[0].fromIndex);
+    EXPECT_EQ(progress.databases[1].matches.size(), 4);
+    EXPECT_FALSE(progress.databases[2].success);
+    EXPECT_NE(progress.databases[2].message.find("not able to access"), std::string::npos);
+    EXPECT_EQ(progress.databases[3].matches.size(), 3);  // given only what was left of the limit
+    // With one worker, nothing is searched once the limit is reached
+    EXPECT_EQ(searched, 3);
+    EXPECT_EQ(progress.databases[5].message, "Skipped: result limit reached");
+
+    // A poll only returns what completed since the last one
+    EXPECT_EQ(search.progress(4).databases.size(), 2);
+    EXPECT_TRUE(search.progress(6).databases.empty());
+}
+
+}  // namespace test
+}  // namespace velocitydb
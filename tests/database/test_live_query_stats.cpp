@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "database/live_query_stats.h"
+#include "database/replay_driver.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// sys.dm_exec_requests joined to per-operator profile rows, as buildQuery() returns them
+ResultSet samples() {
+    ResultSet result;
+    for (const char* name : {"session_id", "percent_complete", "total_elapsed_time", "cpu_time", "logical_reads", "wait_type", "node_id", "physical_operator_name", "row_count",
+                             "estimate_row_count"}) {
+        result.columns.push_back({.name = name, .type = "BIGINT"});
+    }
+    result.columns[1].type = "REAL";
+    result.columns[5].type = "NVARCHAR";
+    result.columns[7].type = "NVARCHAR";
+    result.columnData = {ColumnData(ColumnDataType::Int64), ColumnData(ColumnDataType::Double), ColumnData(ColumnDataType::Int64), ColumnData(ColumnDataType::Int64),
+                         ColumnData(ColumnDataType::Int64), ColumnData(ColumnDataType::Text),   ColumnData(ColumnDataType::Int64), ColumnData(ColumnDataType::Text),
+                         ColumnData(ColumnDataType::Int64), ColumnData(ColumnDataType::Int64)};
+
+    auto request = [&](int64_t session, double percent, int64_t elapsed, const char* wait) {
+        result.columnData[0].appendInt64(session);
+        result.columnData[1].appendDouble(percent);
+        result.columnData[2].appendInt64(elapsed);
+        result.columnData[3].appendInt64(elapsed / 2);
+        result.columnData[4].appendInt64(900);
+        if (wait) {
+            result.columnData[5].appendText(wait);
+        } else {
+            result.columnData[5].appendNull();
+        }
+    };
+    auto profile = [&](int64_t node, const char* op, int64_t rows, int64_t estimate) {
+        result.columnData[6].appendInt64(node);
+        result.columnData[7].appendText(op);
+        result.columnData[8].appendInt64(rows);
+        result.columnData[9].appendInt64(estimate);
+    };
+    auto noProfile = [&] {
+        for (size_t col = 6; col < 10; ++col) {
+            result.columnData[col].appendNull();
+        }
+    };
+
+    request(52, 0, 8000, "CXPACKET");
+    profile(0, "Hash Match", 10, 500);
+    request(52, 0, 8000, "CXPACKET");
+    profile(1, "Clustered Index Scan", 4000, 10000);
+    request(61, 37.5, 120000, nullptr);
+    noProfile();
+    return result;
+}
+
+}  // namespace
+
+TEST(LiveQueryStatsTest, GroupsOperatorRowsBySession) {
+    const auto parsed = LiveQueryStatsPoller::parseSamples(samples());
+
+    ASSERT_EQ(parsed.size(), 2u);
+    EXPECT_EQ(parsed[0].sessionId, 52);
+    EXPECT_EQ(parsed[0].elapsedMs, 8000);
+    EXPECT_EQ(parsed[0].cpuMs, 4000);
+    EXPECT_EQ(parsed[0].waitType, "CXPACKET");
+    ASSERT_EQ(parsed[0].operators.size(), 2u);
+    EXPECT_EQ(parsed[0].operators[1].nodeId, 1);
+    EXPECT_EQ(parsed[0].operators[1].physicalOp, "Clustered Index Scan");
+    EXPECT_EQ(parsed[0].operators[1].rows, 4000);
+    EXPECT_EQ(parsed[0].operators[1].estimatedRows, 10000);
+
+    EXPECT_EQ(parsed[1].sessionId, 61);
+    EXPECT_DOUBLE_EQ(parsed[1].percentComplete, 37.5);
+    EXPECT_TRUE(parsed[1].waitType.empty());
+    EXPECT_TRUE(parsed[1].operators.empty());  // Session not profiled
+}
+
+TEST(LiveQueryStatsTest, PollsAllWatchedSessionsWithOneQueryPerMonitor) {
+    auto monitor = std::make_shared<ReplayDriver>();
+    ASSERT_TRUE(monitor->connect(""));
+    const std::vector<int> sessions{52, 61};
+    monitor->addResult(LiveQueryStatsPoller::buildQuery(sessions), samples());
+
+    std::mutex mutex;
+    std::condition_variable received;
+    std::vector<std::string> queryIds;
+    LiveQueryStatsPoller poller(
+        [&](const LiveQueryStats& stats) {
+            std::lock_guard lock(mutex);
+            queryIds.push_back(std::format("{}@{}", stats.queryId, stats.sessionId));
+            received.notify_all();
+        },
+        std::chrono::milliseconds{10});
+    poller.watch("query_2", 61, monitor);
+    poller.watch("query_1", 52, monitor);
+
+    {
+        std::unique_lock lock(mutex);
+        ASSERT_TRUE(received.wait_for(lock, std::chrono::seconds{5}, [&] { return queryIds.size() >= 2; }));
+        EXPECT_EQ(queryIds[0], "query_1@52");
+        EXPECT_EQ(queryIds[1], "query_2@61");
+    }
+    EXPECT_GE(monitor->executeCount(), 1u);
+
+    poller.unwatch("query_1");
+    poller.unwatch("query_2");
+    EXPECT_EQ(poller.watchedCount(), 0u);
+}
+
+TEST(LiveQueryStatsTest, StopsSamplingThroughAFailingMonitor) {
+    auto monitor = std::make_shared<ReplayDriver>();
+    ASSERT_TRUE(monitor->connect(""));  // No canned result: every DMV query fails
+
+    LiveQueryStatsPoller poller([](const LiveQueryStats&) { FAIL() << "no sample expected"; }, std::chrono::milliseconds{5});
+    poller.watch("query_1", 52, monitor);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (poller.watchedCount() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    EXPECT_EQ(poller.watchedCount(), 0u);
+    EXPECT_GE(monitor->executeCount(), 1u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
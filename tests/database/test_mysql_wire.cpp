@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "database/mysql_wire.h"
+
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::string decoded(const MySqlField& field, std::string_view value) {
+    const auto type = mysqlColumnType(field);
+    ColumnData column(type.storage, type.fractionDigits);
+    appendMySqlText(column, field, value);
+    return column.displayText(0);
+}
+
+}  // namespace
+
+TEST(MySqlWireTest, MapsColumnTypes) {
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::LONG}).name, "int");
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::LONG, .flags = mysql_type::UNSIGNED_FLAG}).name, "bigint");
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::LONGLONG, .flags = mysql_type::UNSIGNED_FLAG}).storage, ColumnDataType::Text);
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::NEWDECIMAL}).storage, ColumnDataType::Text);
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::BIT, .length = 1}).storage, ColumnDataType::Bit);
+    const auto datetime = mysqlColumnType({.type = mysql_type::DATETIME, .decimals = 3});
+    EXPECT_EQ(datetime.storage, ColumnDataType::Timestamp);
+    EXPECT_EQ(datetime.fractionDigits, 3);
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::BLOB, .charset = mysql_type::BINARY_CHARSET}).name, "varbinary");
+    EXPECT_EQ(mysqlColumnType({.type = mysql_type::BLOB, .charset = 255}).name, "text");
+}
+
+TEST(MySqlWireTest, DecodesTextProtocolValues) {
+    EXPECT_EQ(decoded({.type = mysql_type::LONGLONG}, "-42"), "-42");
+    EXPECT_EQ(decoded({.type = mysql_type::DATETIME, .decimals = 3}, "2024-01-01 12:34:56.500"), "2024-01-01 12:34:56.500");
+    EXPECT_EQ(decoded({.type = mysql_type::DATE}, "0000-00-00"), "0000-00-00");
+    EXPECT_EQ(decoded({.type = mysql_type::TIME}, "838:59:59"), "838:59:59");
+    EXPECT_EQ(decoded({.type = mysql_type::BIT, .length = 1}, std::string_view("\x01", 1)), "1");
+    EXPECT_EQ(decoded({.type = mysql_type::BIT, .length = 12}, std::string_view("\x0f\xff", 2)), "4095");
+    EXPECT_EQ(decoded({.type = mysql_type::VAR_STRING, .charset = mysql_type::BINARY_CHARSET}, std::string_view("\x00\xab", 2)), "0x00AB");
+    EXPECT_EQ(decoded({.type = mysql_type::NEWDECIMAL}, "12345678901234567890.12"), "12345678901234567890.12");
+}
+
+TEST(MySqlWireTest, ReadsConnectionParameters) {
+    const auto params = mysqlConnectParams("Driver={MySQL ODBC 8.0 Unicode Driver};Server=db.local;Port=3307;Database=shop;Uid=app;Pwd={p;w}}d};");
+    EXPECT_EQ(params.host, "db.local");
+    EXPECT_EQ(params.port, 3307);
+    EXPECT_EQ(params.database, "shop");
+    EXPECT_EQ(params.user, "app");
+    EXPECT_EQ(params.password, "p;w}d");
+
+    const auto defaults = mysqlConnectParams("Uid=root;Port=notaport");
+    EXPECT_EQ(defaults.host, "localhost");
+    EXPECT_EQ(defaults.port, 3306);
+}
+
+}  // namespace test
+}  // namespace velocitydb
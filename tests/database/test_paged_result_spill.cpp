@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "database/paged_result_spill.h"
+#include "database/replay_driver.h"
+
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet numbers(size_t count) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "BIGINT"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    for (size_t i = 0; i < count; ++i) {
+        result.columnData[0].appendInt64(static_cast<int64_t>(i));
+    }
+    return result;
+}
+
+const std::string SMALL = "SELECT id FROM dbo.Small";
+const std::string LARGE = "SELECT id FROM dbo.Large";
+
+class PagedResultSpillTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(driver.connect(""));
+        driver.addResult(SMALL, numbers(50));
+        driver.addResult(LARGE, numbers(10000));
+    }
+
+    ReplayDriver driver;
+    ResultCache cache;
+    PagedResultSpill spill{cache, 100};
+};
+
+}  // namespace
+
+TEST_F(PagedResultSpillTest, SmallResultIsFetchedOnceAndCached) {
+    auto first = spill.fetch("conn1", driver, SMALL);
+    ASSERT_TRUE(first.complete);
+    ASSERT_NE(first.rows, nullptr);
+    EXPECT_EQ(first.rows->rowCount(), 50u);
+    EXPECT_EQ(first.rows->columns.size(), 1u);
+
+    const auto served = driver.executeCount();
+    auto again = spill.fetch("conn1", driver, SMALL);
+    EXPECT_TRUE(again.complete);
+    EXPECT_EQ(again.rows.get(), first.rows.get());
+    EXPECT_EQ(driver.executeCount(), served);  // From the cache, no second execution
+    EXPECT_NE(cache.get(ResultCache::makeKey("conn1", SMALL)), nullptr);
+}
+
+TEST_F(PagedResultSpillTest, EstimateIsTakenOncePerQuery) {
+    ASSERT_TRUE(spill.fetch("conn1", driver, SMALL).complete);
+    const auto first = driver.executeCount();
+
+    // Dropped from the cache (as a write to dbo.Small would), so the rows are fetched again but not re-estimated
+    cache.clear();
+    const auto before = driver.executeCount();
+    ASSERT_TRUE(spill.fetch("conn1", driver, SMALL).complete);
+    EXPECT_EQ(driver.executeCount() - before, 1u);
+    EXPECT_GT(first, 1u);  // The first fetch did try the estimate
+}
+
+TEST_F(PagedResultSpillTest, OversizedResultHandsBackTheRowsItFetched) {
+    auto outcome = spill.fetch("conn1", driver, LARGE);
+    EXPECT_FALSE(outcome.complete);
+    ASSERT_NE(outcome.rows, nullptr);
+    EXPECT_GT(outcome.rows->rowCount(), 100u);  // Stopped at the first batch past the limit: enough for the first pages
+    EXPECT_LT(outcome.rows->rowCount(), 10000u);
+    EXPECT_EQ(outcome.rows->columnData[0].int64At(99), 99);
+    EXPECT_EQ(outcome.rows->columns.size(), 1u);
+    EXPECT_EQ(cache.get(ResultCache::makeKey("conn1", LARGE)), nullptr);
+}
+
+TEST_F(PagedResultSpillTest, OversizedQueriesAreRememberedPerConnection) {
+    EXPECT_FALSE(spill.isUnspillable("conn1", LARGE));
+    (void)spill.fetch("conn1", driver, LARGE);
+    EXPECT_TRUE(spill.isUnspillable("conn1", LARGE));
+    EXPECT_TRUE(spill.isUnspillable("conn1", "select  id from dbo.Large"));  // Same fingerprint
+    EXPECT_FALSE(spill.isUnspillable("conn2", LARGE));
+
+    const auto served = driver.executeCount();
+    auto remembered = spill.fetch("conn1", driver, LARGE);
+    EXPECT_FALSE(remembered.complete);
+    EXPECT_EQ(remembered.rows, nullptr);
+    EXPECT_EQ(driver.executeCount(), served);  // Not streamed again just to be dropped
+}
+
+}  // namespace test
+}  // namespace velocitydb
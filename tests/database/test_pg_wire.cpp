@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "database/pg_wire.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::string bigEndian(uint64_t value, size_t bytes) {
+    std::string out;
+    for (size_t i = bytes; i-- > 0;) {
+        out += static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+    return out;
+}
+
+std::string decoded(uint32_t oid, const std::string& value) {
+    const auto type = pgColumnType(oid);
+    ColumnData column(type.storage, type.fractionDigits);
+    appendPgBinary(column, oid, value);
+    return column.displayText(0);
+}
+
+}  // namespace
+
+TEST(PgWireTest, DecodesBinaryValues) {
+    EXPECT_EQ(decoded(pg_oid::INT4, bigEndian(static_cast<uint32_t>(-42), 4)), "-42");
+    EXPECT_EQ(decoded(pg_oid::INT8, bigEndian(9000000000, 8)), "9000000000");
+    EXPECT_EQ(decoded(pg_oid::FLOAT8, bigEndian(0x3FF8000000000000, 8)), "1.5");
+    EXPECT_EQ(decoded(pg_oid::DATE, bigEndian(8766, 4)), "2024-01-01");
+    // 2024-01-01 12:34:56.5 is 8766 days and 45296.5 seconds after 2000-01-01
+    EXPECT_EQ(decoded(pg_oid::TIMESTAMP, bigEndian(8766 * 86400000000ULL + 45296500000ULL, 8)), "2024-01-01 12:34:56.500000");
+    EXPECT_EQ(decoded(pg_oid::DATE, bigEndian(0x7FFFFFFF, 4)), "infinity");
+    // numeric -1234.5670: 2 digit groups (1234, 5670), weight 0, negative, scale 4
+    EXPECT_EQ(decoded(pg_oid::NUMERIC, bigEndian(2, 2) + bigEndian(0, 2) + bigEndian(0x4000, 2) + bigEndian(4, 2) + bigEndian(1234, 2) + bigEndian(5670, 2)), "-1234.5670");
+    // numeric 0.05: one group (500) at weight -1, scale 2
+    EXPECT_EQ(decoded(pg_oid::NUMERIC, bigEndian(1, 2) + bigEndian(0xFFFF, 2) + bigEndian(0, 2) + bigEndian(2, 2) + bigEndian(500, 2)), "0.05");
+    EXPECT_EQ(decoded(pg_oid::MONEY, bigEndian(static_cast<uint64_t>(-1999), 8)), "-19.99");
+    EXPECT_EQ(decoded(pg_oid::UUID, std::string("\x12\x34\x56\x78\x9a\xbc\xde\xf0\x01\x23\x45\x67\x89\xab\xcd\xef", 16)), "12345678-9abc-def0-0123-456789abcdef");
+    EXPECT_EQ(decoded(pg_oid::JSONB, "\x01{\"a\":1}"), "{\"a\":1}");
+    EXPECT_EQ(decoded(pg_oid::BYTEA, std::string("\x00\xff", 2)), "\\x00ff");
+    EXPECT_EQ(decoded(pg_oid::INTERVAL, bigEndian(3723000000, 8) + bigEndian(2, 4) + bigEndian(14, 4)), "1 year 2 mons 2 days 01:02:03");
+}
+
+TEST(PgWireTest, ParsesCopyBinaryAcrossChunkBoundaries) {
+    std::string stream("PGCOPY\n\xff\r\n\0", 11);
+    stream += bigEndian(0, 4) + bigEndian(0, 4);
+    const auto tuple = [](int64_t id, const std::string* name) {
+        std::string out = bigEndian(2, 2) + bigEndian(8, 4) + bigEndian(static_cast<uint64_t>(id), 8);
+        out += name ? bigEndian(name->size(), 4) + *name : bigEndian(0xFFFFFFFF, 4);
+        return out;
+    };
+    const std::string alpha = "alpha";
+    stream += tuple(1, &alpha) + tuple(2, nullptr) + tuple(3, &alpha) + bigEndian(0xFFFF, 2);
+
+    ResultSet batch;
+    batch.columnData.emplace_back(ColumnDataType::Int64);
+    batch.columnData.emplace_back(ColumnDataType::Text);
+    PgCopyBinaryParser parser({pg_oid::INT8, pg_oid::TEXT});
+    for (size_t pos = 0; pos < stream.size(); pos += 7) {
+        ASSERT_TRUE(parser.feed(std::string_view(stream).substr(pos, 7), batch));
+    }
+    EXPECT_TRUE(parser.finished());
+    ASSERT_EQ(batch.rowCount(), 3);
+    EXPECT_EQ(batch.cellText(2, 0), "3");
+    EXPECT_EQ(batch.cellText(0, 1), "alpha");
+    EXPECT_TRUE(batch.isNull(1, 1));
+
+    PgCopyBinaryParser wrongHeader({pg_oid::INT8});
+    EXPECT_FALSE(wrongHeader.feed("NOTCOPY-and-some-more-bytes", batch));
+}
+
+TEST(PgWireTest, TranslatesOdbcConnectionStrings) {
+    EXPECT_EQ(pgConninfo("Driver={PostgreSQL Unicode};Server=db.local;Port=5433;Database=sales;Uid=app;Pwd={it's;}}x};"),
+              "host='db.local' port='5433' dbname='sales' user='app' password='it\\'s;}x'");
+    EXPECT_EQ(pgConninfo("host=localhost dbname=postgres"), "host=localhost dbname=postgres");
+    EXPECT_EQ(pgConninfo("postgresql://app@localhost/sales"), "postgresql://app@localhost/sales");
+}
+
+}  // namespace test
+}  // namespace velocitydb
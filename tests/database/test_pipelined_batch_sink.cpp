@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "database/pipelined_batch_sink.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Records what reaches it, on whichever thread calls it
+struct RecordingSink final : RowBatchSink {
+    std::vector<std::string> events;
+    std::thread::id thread;
+    size_t batches = 0;
+    size_t stopAfter = 0;  ///< Batches to accept before declining one; 0 = all
+    bool throwOnBatch = false;
+
+    void onColumns(const std::vector<ColumnInfo>& columns) override {
+        thread = std::this_thread::get_id();
+        events.push_back("columns:" + std::to_string(columns.size()));
+    }
+
+    bool onBatch(const ResultSet& batch) override {
+        if (throwOnBatch) {
+            throw std::runtime_error("disk full");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        events.push_back(batch.cellText(0, 0));
+        return stopAfter == 0 || ++batches <= stopAfter;
+    }
+};
+
+/// Pushes `count` one-row batches through the same buffer, the way drivers reuse theirs
+size_t produce(RowBatchSink& sink, size_t count) {
+    ResultSet batch;
+    batch.columns.push_back({.name = "n"});
+    sink.onColumns(batch.columns);
+    for (size_t i = 0; i < count; ++i) {
+        batch.columnData.clear();
+        batch.appendRow({std::to_string(i)});
+        if (!sink.onBatch(batch)) {
+            return i;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST(PipelinedBatchSinkTest, DeliversBatchesInOrderOnAnotherThread) {
+    RecordingSink downstream;
+    PipelinedBatchSink pipeline(downstream, 2);
+    EXPECT_EQ(produce(pipeline, 50), 50U);
+    EXPECT_TRUE(pipeline.finish());
+
+    ASSERT_EQ(downstream.events.size(), 51U);
+    EXPECT_EQ(downstream.events.front(), "columns:1");
+    for (size_t i = 0; i < 50; ++i) {
+        EXPECT_EQ(downstream.events[i + 1], std::to_string(i));
+    }
+    EXPECT_NE(downstream.thread, std::this_thread::get_id());
+    // The slow consumer held the producer back instead of letting batches pile up
+    EXPECT_GT(pipeline.producerStalls(), 0U);
+}
+
+TEST(PipelinedBatchSinkTest, StopsTheProducerWhenDownstreamDeclines) {
+    RecordingSink downstream;
+    downstream.stopAfter = 3;
+    PipelinedBatchSink pipeline(downstream, 2);
+    const size_t accepted = produce(pipeline, 1000);
+    EXPECT_FALSE(pipeline.finish());
+
+    // At most `depth` batches beyond the declined one were in flight
+    EXPECT_LE(accepted, 3U + 1 + 2);
+    EXPECT_EQ(downstream.events.size(), 1U + 3 + 1);
+}
+
+TEST(PipelinedBatchSinkTest, RethrowsDownstreamErrorsFromFinish) {
+    RecordingSink downstream;
+    downstream.throwOnBatch = true;
+    PipelinedBatchSink pipeline(downstream);
+    EXPECT_LT(produce(pipeline, 100), 100U);
+    EXPECT_THROW((void)pipeline.finish(), std::runtime_error);
+}
+
+TEST(PipelinedBatchSinkTest, DestructorWithoutFinishDropsQueuedBatches) {
+    RecordingSink downstream;
+    {
+        PipelinedBatchSink pipeline(downstream, 4);
+        (void)produce(pipeline, 4);
+    }
+    EXPECT_LE(downstream.events.size(), 5U);
+}
+
+}  // namespace test
+}  // namespace velocitydb
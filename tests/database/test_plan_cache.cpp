@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "database/plan_cache.h"
+
+#include <memory>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+[[nodiscard]] CachedPlan planFor(std::string connectionId, std::string sql, std::string stamp, bool actual = false) {
+    CachedPlan cached{.connectionId = std::move(connectionId),
+                      .queryHash = PlanCache::queryHash(sql),
+                      .sql = std::move(sql),
+                      .actual = actual,
+                      .hotspotCount = 5,
+                      .schemaStamp = std::move(stamp),
+                      .plan = std::make_shared<const ExecutionPlan>()};
+    cached.json = "{}";
+    return cached;
+}
+
+}  // namespace
+
+TEST(PlanCacheTest, ServesEstimatedPlansWhileTheSchemaIsUnchanged) {
+    PlanCache cache;
+    const auto stored = cache.store(planFor("conn1", "SELECT * FROM Users WHERE Id = 1", "shop|10|4|2026-01-01"));
+    EXPECT_EQ(stored->id, "plan_1");
+
+    // Same fingerprint despite spacing and keyword case
+    const auto hash = PlanCache::queryHash("select *\n  from Users where Id = 1");
+    EXPECT_EQ(cache.lookup("conn1", hash, "shop|10|4|2026-01-01", 5), stored);
+    // A new index moves the stamp; another connection or hotspot count is another entry
+    EXPECT_EQ(cache.lookup("conn1", hash, "shop|10|5|2026-01-02", 5), nullptr);
+    EXPECT_EQ(cache.lookup("conn2", hash, "shop|10|4|2026-01-01", 5), nullptr);
+    EXPECT_EQ(cache.lookup("conn1", hash, "shop|10|4|2026-01-01", 10), nullptr);
+    // Literals are kept: another value is another query
+    EXPECT_EQ(cache.lookup("conn1", PlanCache::queryHash("SELECT * FROM Users WHERE Id = 2"), "shop|10|4|2026-01-01", 5), nullptr);
+    // No stamp, no cache
+    EXPECT_EQ(cache.lookup("conn1", hash, "", 5), nullptr);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 5);
+}
+
+TEST(PlanCacheTest, ActualPlansAreKeptInTheHistoryButNeverServed) {
+    PlanCache cache;
+    const auto estimated = cache.store(planFor("conn1", "SELECT 1", "a"));
+    const auto actual = cache.store(planFor("conn1", "SELECT 1", "a", true));
+    const auto hash = PlanCache::queryHash("SELECT 1");
+
+    EXPECT_EQ(cache.lookup("conn1", hash, "a", 5), estimated);
+    const auto history = cache.history("conn1", hash);
+    ASSERT_EQ(history.size(), 2);
+    EXPECT_EQ(history[0], actual);
+    EXPECT_EQ(history[1], estimated);
+    EXPECT_EQ(cache.previousId(actual->id), estimated->id);
+    EXPECT_EQ(cache.previousId(estimated->id), "");
+    EXPECT_EQ(cache.find(actual->id), actual);
+}
+
+TEST(PlanCacheTest, BoundsHistoryAndQueries) {
+    PlanCache cache(2);
+    std::string firstId;
+    for (size_t i = 0; i < PlanCache::HISTORY_PER_QUERY + 2; ++i) {
+        auto stored = cache.store(planFor("conn1", "SELECT 1", std::to_string(i)));
+        if (i == 0)
+            firstId = stored->id;
+    }
+    EXPECT_EQ(cache.history("conn1", PlanCache::queryHash("SELECT 1")).size(), PlanCache::HISTORY_PER_QUERY);
+    EXPECT_EQ(cache.find(firstId), nullptr);
+
+    (void)cache.store(planFor("conn1", "SELECT 2", "x"));
+    (void)cache.lookup("conn1", PlanCache::queryHash("SELECT 1"), "9", 5);  // Keeps SELECT 1 the most recently used
+    (void)cache.store(planFor("conn2", "SELECT 3", "x"));
+    EXPECT_TRUE(cache.history("conn1", PlanCache::queryHash("SELECT 2")).empty());
+    EXPECT_FALSE(cache.history("conn1", PlanCache::queryHash("SELECT 1")).empty());
+
+    cache.dropConnection("conn1");
+    EXPECT_TRUE(cache.history("conn1", PlanCache::queryHash("SELECT 1")).empty());
+    EXPECT_EQ(cache.stats().queries, 1);
+    EXPECT_EQ(cache.stats().plans, 1);
+}
+
+}  // namespace test
+}  // namespace velocitydb
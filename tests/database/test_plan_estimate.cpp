@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "database/plan_estimate.h"
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+constexpr std::string_view PLAN = R"xml(<ShowPlanXML xmlns="http://schemas.microsoft.com/sqlserver/2004/07/showplan">
+  <BatchSequence><Batch><Statements>
+    <StmtSimple StatementText="SELECT * FROM dbo.Orders" StatementSubTreeCost="2.5" StatementEstRows="41999.6">
+      <QueryPlan>
+        <RelOp NodeId="0" PhysicalOp="Clustered Index Scan" LogicalOp="Clustered Index Scan" EstimateRows="41999.6" EstimatedTotalSubtreeCost="2.5" />
+      </QueryPlan>
+    </StmtSimple>
+  </Statements></Batch></BatchSequence>
+</ShowPlanXML>)xml";
+
+/// Records every batch; batches in `failing` throw, and the query itself answers with PLAN
+class ShowplanDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return connected = true; }
+    void disconnect() override { connected = false; }
+    bool isConnected() const noexcept override { return connected; }
+    ResultSet execute(std::string_view sql) override {
+        executed.emplace_back(sql);
+        if (failing.contains(std::string(sql))) {
+            throw std::runtime_error("failed: " + std::string(sql));
+        }
+        ResultSet result;
+        if (!sql.starts_with("SET ")) {
+            result.columns.push_back({.name = "Microsoft SQL Server 2005 XML Showplan", .type = "NVARCHAR"});
+            result.columnData.emplace_back(ColumnDataType::Text);
+            result.columnData[0].appendText(PLAN);
+        }
+        return result;
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    bool reconnect() override {
+        ++reconnects;
+        return canReconnect;
+    }
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::vector<std::string> executed;
+    std::set<std::string> failing;
+    bool connected = true;
+    bool canReconnect = true;
+    int reconnects = 0;
+};
+
+const std::string QUERY = "SELECT * FROM dbo.Orders";
+
+}  // namespace
+
+TEST(PlanEstimateTest, ReadsStatementEstimateAndTurnsShowplanOff) {
+    ShowplanDriver driver;
+    EXPECT_EQ(estimateRowCount(driver, QUERY), 42000);
+    EXPECT_EQ(driver.executed, (std::vector<std::string>{"SET SHOWPLAN_XML ON", QUERY, "SET SHOWPLAN_XML OFF"}));
+}
+
+TEST(PlanEstimateTest, FailedPlanStillTurnsShowplanOff) {
+    ShowplanDriver driver;
+    driver.failing = {QUERY};
+    EXPECT_EQ(estimateRowCount(driver, QUERY), std::nullopt);
+    EXPECT_EQ(driver.executed.back(), "SET SHOWPLAN_XML OFF");
+    EXPECT_EQ(driver.reconnects, 0);
+}
+
+TEST(PlanEstimateTest, WithoutShowplanPermissionNothingRuns) {
+    ShowplanDriver driver;
+    driver.failing = {"SET SHOWPLAN_XML ON"};
+    EXPECT_EQ(estimateRowCount(driver, QUERY), std::nullopt);
+    EXPECT_EQ(driver.executed, (std::vector<std::string>{"SET SHOWPLAN_XML ON"}));
+}
+
+TEST(PlanEstimateTest, FailedResetReplacesOrClosesTheSession) {
+    ShowplanDriver driver;
+    driver.failing = {QUERY, "SET SHOWPLAN_XML OFF"};
+    EXPECT_EQ(estimateRowCount(driver, QUERY), std::nullopt);
+    EXPECT_EQ(driver.reconnects, 1);
+    EXPECT_TRUE(driver.isConnected());
+
+    driver.canReconnect = false;
+    EXPECT_EQ(estimateRowCount(driver, QUERY), std::nullopt);
+    EXPECT_EQ(driver.reconnects, 2);
+    EXPECT_FALSE(driver.isConnected());  // Later queries fail instead of returning plan XML
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "database/query_handle_table.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+struct Task {
+    explicit Task(uint64_t h) : handle(h) {}
+    uint64_t handle;
+    bool live = true;
+};
+
+using Table = QueryHandleTable<Task, 8>;
+
+uint64_t add(Table& table, std::vector<std::shared_ptr<Task>>* out = nullptr) {
+    return table.insert(
+        [&](uint64_t handle) {
+            auto task = std::make_shared<Task>(handle);
+            if (out) {
+                out->push_back(task);
+            }
+            return task;
+        },
+        [](const Task& task) { return task.live; });
+}
+
+}  // namespace
+
+TEST(QueryHandleTableTest, FormatsAndParsesIds) {
+    EXPECT_EQ(Table::formatId(42), "query_42");
+    EXPECT_EQ(Table::parseId("query_42"), 42U);
+    EXPECT_FALSE(Table::parseId("query_"));
+    EXPECT_FALSE(Table::parseId("query_0"));
+    EXPECT_FALSE(Table::parseId("query_4x"));
+    EXPECT_FALSE(Table::parseId("job_4"));
+}
+
+TEST(QueryHandleTableTest, SkipsSlotsOfLiveTasksAndReplacesFinishedOnes) {
+    Table table;
+    std::vector<std::shared_ptr<Task>> tasks;
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(add(table, &tasks), static_cast<uint64_t>(i + 1));
+    }
+    // Every slot is live: nothing can be displaced
+    EXPECT_EQ(add(table), 0U);
+
+    tasks[2]->live = false;  // handle 3
+    const uint64_t next = add(table);
+    EXPECT_EQ(next % 8, 3U);
+    EXPECT_EQ(table.find(3), nullptr);
+    ASSERT_NE(table.find(next), nullptr);
+    EXPECT_EQ(table.find(next)->handle, next);
+    EXPECT_EQ(table.find(1)->handle, 1U);
+}
+
+TEST(QueryHandleTableTest, EraseHonoursTheGuardAndStaleHandles) {
+    Table table;
+    std::vector<std::shared_ptr<Task>> tasks;
+    const uint64_t handle = add(table, &tasks);
+    const auto finished = [](const Task& task) { return !task.live; };
+
+    EXPECT_FALSE(table.erase(handle, finished));
+    tasks[0]->live = false;
+    EXPECT_FALSE(table.erase(handle + 8, finished));  // Same slot, other handle
+    EXPECT_TRUE(table.erase(handle, finished));
+    EXPECT_FALSE(table.erase(handle, finished));
+
+    size_t visited = 0;
+    table.forEach([&](uint64_t, const std::shared_ptr<Task>&) { ++visited; });
+    EXPECT_EQ(visited, 0U);
+}
+
+TEST(QueryHandleTableTest, ReadersRunAlongsideWriters) {
+    QueryHandleTable<Task> table;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                for (uint64_t handle = 1; handle < 200; ++handle) {
+                    if (auto task = table.find(handle); task && task->handle != handle) {
+                        ++mismatches;
+                    }
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20000; ++i) {
+        const uint64_t handle = table.insert([](uint64_t h) { return std::make_shared<Task>(h); }, [](const Task&) { return false; });
+        (void)table.erase(handle, [i](const Task&) { return i % 2 == 0; });
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0U);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include "database/query_history.h"
 
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <vector>
+
 namespace velocitydb {
 namespace test {
 
@@ -120,5 +126,179 @@ TEST_F(QueryHistoryTest, RespectsMaxItems) {
     EXPECT_LE(all.size(), 5);
 }
 
+TEST_F(QueryHistoryTest, SearchMatchesSubstringsAcrossTokens) {
+    for (const auto* sql : {"SELECT * FROM Users u JOIN Orders o ON o.user_id = u.id", "SELECT COUNT(*) FROM OrderLines", "UPDATE Users SET name = 'x'", "select 1+1"}) {
+        history.add(HistoryItem{.sql = sql});
+    }
+
+    EXPECT_EQ(history.search("rders o").size(), 1u);   // End of one token, start of the next
+    EXPECT_EQ(history.search("order").size(), 2u);     // Inside tokens
+    EXPECT_EQ(history.search("USERS SET").size(), 1u);
+    EXPECT_EQ(history.search("ers SET n").size(), 1u);
+    EXPECT_EQ(history.search("1+1").size(), 1u);
+    EXPECT_EQ(history.search("(*)").size(), 1u);       // No word at all: every item is checked
+    EXPECT_TRUE(history.search("users join").empty());
+
+    auto newestFirst = history.search("select");
+    ASSERT_EQ(newestFirst.size(), 3u);
+    EXPECT_EQ(newestFirst[0].sql, "select 1+1");
+}
+
+TEST_F(QueryHistoryTest, GetByDateUsesTheTimestampRange) {
+    const auto base = std::chrono::system_clock::now();
+    for (int i = 0; i < 5; ++i) {
+        history.add(HistoryItem{.sql = "SELECT " + std::to_string(i), .timestamp = base + std::chrono::minutes(i)});
+    }
+
+    auto items = history.getByDate(base + std::chrono::minutes(1), base + std::chrono::minutes(3));
+    ASSERT_EQ(items.size(), 3u);
+    EXPECT_EQ(items[0].sql, "SELECT 3");
+    EXPECT_EQ(items[2].sql, "SELECT 1");
+    EXPECT_TRUE(history.getByDate(base + std::chrono::minutes(3), base).empty());
+}
+
+TEST_F(QueryHistoryTest, RemoveAndReAddById) {
+    history.add(HistoryItem{.id = "a", .sql = "SELECT 1"});
+    history.add(HistoryItem{.id = "b", .sql = "SELECT 2"});
+    history.add(HistoryItem{.id = "a", .sql = "SELECT 3"});
+    EXPECT_EQ(history.size(), 2u);
+    EXPECT_TRUE(history.search("SELECT 1").empty());
+
+    history.remove("b");
+    auto all = history.getAll();
+    ASSERT_EQ(all.size(), 1u);
+    EXPECT_EQ(all[0].sql, "SELECT 3");
+}
+
+TEST_F(QueryHistoryTest, AggregatesExecutionsPerFingerprint) {
+    const auto base = std::chrono::system_clock::now();
+    for (int i = 1; i <= 20; ++i) {
+        const auto sql = std::format("select * from Orders where id = {} -- run {}", i, i);
+        history.add(HistoryItem{.sql = sql, .timestamp = base + std::chrono::seconds(i), .executionTimeMs = static_cast<double>(i * 10), .success = i != 7});
+    }
+    history.add(HistoryItem{.sql = "SELECT name FROM Users", .timestamp = base, .executionTimeMs = 5.0});
+
+    auto aggregates = history.aggregateByFingerprint();
+    ASSERT_EQ(aggregates.size(), 2u);
+    const auto& orders = aggregates[0];
+    EXPECT_EQ(orders.fingerprint, "SELECT * FROM Orders WHERE id = ?");
+    EXPECT_EQ(orders.sql, "select * from Orders where id = 20 -- run 20");
+    EXPECT_EQ(orders.count, 20u);
+    EXPECT_EQ(orders.failures, 1u);
+    EXPECT_DOUBLE_EQ(orders.p50ExecutionTimeMs, 100.0);
+    EXPECT_DOUBLE_EQ(orders.p95ExecutionTimeMs, 190.0);
+    EXPECT_DOUBLE_EQ(orders.totalExecutionTimeMs, 2100.0);
+    EXPECT_EQ(orders.lastRun, base + std::chrono::seconds(20));
+    EXPECT_EQ(aggregates[1].count, 1u);
+
+    EXPECT_EQ(history.aggregateByFingerprint(2).size(), 1u);
+}
+
+TEST_F(QueryHistoryTest, CountsItemsUsingEachWord) {
+    history.add(HistoryItem{.id = "1", .sql = "SELECT name FROM Users"});
+    history.add(HistoryItem{.id = "2", .sql = "SELECT u.Name, u.name FROM [Users] u"});
+    history.add(HistoryItem{.id = "3", .sql = "SELECT id FROM Orders"});
+
+    const std::vector<std::string> words{"name", "users", "orders", "missing"};
+    EXPECT_EQ(history.wordUses(words), (std::vector<size_t>{2, 2, 1, 0}));
+
+    history.remove("2");
+    EXPECT_EQ(history.wordUses(words), (std::vector<size_t>{1, 1, 1, 0}));
+}
+
+class QueryHistoryLogTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "velocitydb_query_history_test";
+    std::filesystem::path logPath = directory / "history.jsonl";
+
+    void SetUp() override { std::filesystem::remove_all(directory); }
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    [[nodiscard]] size_t logLines() const {
+        std::ifstream in(logPath);
+        size_t lines = 0;
+        for (std::string line; std::getline(in, line);) {
+            ++lines;
+        }
+        return lines;
+    }
+};
+
+TEST_F(QueryHistoryLogTest, ReopeningReplaysEveryChange) {
+    {
+        QueryHistory history;
+        ASSERT_TRUE(history.open(logPath));
+        history.add(HistoryItem{.id = "1", .sql = "SELECT \"quoted\"\nFROM t", .executionTimeMs = 1.5});
+        history.add(HistoryItem{.id = "2", .sql = "SELECT 2"});
+        history.add(HistoryItem{.id = "3", .sql = "SELECT 3"});
+        history.setFavorite("1", true);
+        history.remove("2");
+        history.clear();
+    }
+    EXPECT_EQ(logLines(), 6u);
+
+    QueryHistory reopened;
+    ASSERT_TRUE(reopened.open(logPath));
+    auto all = reopened.getAll();
+    ASSERT_EQ(all.size(), 1u);
+    EXPECT_EQ(all[0].sql, "SELECT \"quoted\"\nFROM t");
+    EXPECT_TRUE(all[0].isFavorite);
+    EXPECT_DOUBLE_EQ(all[0].executionTimeMs, 1.5);
+    EXPECT_EQ(reopened.search("quoted").size(), 1u);
+}
+
+TEST_F(QueryHistoryLogTest, TornTailIsDropped) {
+    {
+        QueryHistory history;
+        ASSERT_TRUE(history.open(logPath));
+        history.add(HistoryItem{.id = "1", .sql = "SELECT 1"});
+    }
+    {
+        std::ofstream out(logPath, std::ios::binary | std::ios::app);
+        out << R"({"op":"add","id":"2","sql":"SELE)";  // Crashed mid-append
+    }
+
+    QueryHistory reopened;
+    ASSERT_TRUE(reopened.open(logPath));
+    EXPECT_EQ(reopened.size(), 1u);
+    reopened.add(HistoryItem{.id = "3", .sql = "SELECT 3"});
+
+    QueryHistory again;
+    ASSERT_TRUE(again.open(logPath));
+    EXPECT_EQ(again.size(), 2u);
+    EXPECT_EQ(logLines(), 2u);
+}
+
+TEST_F(QueryHistoryLogTest, LogIsRewrittenOnceMostlySuperseded) {
+    QueryHistory history{10};
+    ASSERT_TRUE(history.open(logPath));
+    for (size_t i = 0; i < QueryHistory::MIN_LOG_COMPACT_RECORDS + 10; ++i) {
+        history.add(HistoryItem{.id = std::to_string(i), .sql = "SELECT " + std::to_string(i)});
+    }
+    EXPECT_LT(logLines(), 100u);
+
+    QueryHistory reopened{10};
+    ASSERT_TRUE(reopened.open(logPath));
+    auto all = reopened.getAll();
+    ASSERT_EQ(all.size(), 10u);
+    EXPECT_EQ(all.front().sql, history.getAll().front().sql);
+}
+
+TEST_F(QueryHistoryLogTest, SaveEscapesAndLoadRestoresOrder) {
+    QueryHistory history;
+    history.add(HistoryItem{.id = "1", .sql = "SELECT 'a\\b'"});
+    history.add(HistoryItem{.id = "2", .sql = "SELECT \"x\""});
+    std::filesystem::create_directories(directory);
+    const auto path = (directory / "export.json").string();
+    ASSERT_TRUE(history.save(path));
+
+    QueryHistory loaded;
+    ASSERT_TRUE(loaded.load(path));
+    auto all = loaded.getAll();
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[0].sql, "SELECT \"x\"");
+    EXPECT_EQ(all[1].sql, "SELECT 'a\\b'");
+}
+
 }  // namespace test
 }  // namespace velocitydb
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "database/query_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+using namespace std::chrono;
+
+/// Local clock the test moves by hand
+struct FakeClock {
+    std::atomic<int64_t> seconds{local_seconds{local_days{year{2026} / 10 / 15}}.time_since_epoch().count()};
+
+    QueryScheduler::LocalClock function() {
+        return [this] { return local_seconds{std::chrono::seconds{seconds.load()}}; };
+    }
+    void advance(std::chrono::seconds by) { seconds += by.count(); }
+};
+
+/// Runs that finish only when the test says so
+struct FakeExecutor {
+    std::mutex mutex;
+    std::set<std::string> started;
+    std::set<std::string> finished;
+    int nextTicket = 0;
+
+    QueryScheduler::Start start() {
+        return [this](const ScheduledQuery& query) {
+            std::lock_guard lock(mutex);
+            auto ticket = query.id + "#" + std::to_string(++nextTicket);
+            started.insert(ticket);
+            return ticket;
+        };
+    }
+    QueryScheduler::Collect collect() {
+        return [this](const ScheduledQuery&, const std::string& ticket) -> std::optional<ScheduledRunOutcome> {
+            std::lock_guard lock(mutex);
+            if (!finished.contains(ticket)) {
+                return std::nullopt;
+            }
+            return ScheduledRunOutcome{.success = true, .rows = 7};
+        };
+    }
+    size_t startedCount() {
+        std::lock_guard lock(mutex);
+        return started.size();
+    }
+    void finishAll() {
+        std::lock_guard lock(mutex);
+        finished = started;
+    }
+};
+
+template <typename Pred>
+bool eventually(Pred pred) {
+    for (int i = 0; i < 400; ++i) {
+        if (pred()) {
+            return true;
+        }
+        std::this_thread::sleep_for(milliseconds{5});
+    }
+    return false;
+}
+
+ScheduledQuery everyMinute(std::string id) {
+    return ScheduledQuery{.id = std::move(id), .connectionId = "conn", .sql = "SELECT 1", .schedule = *CronSchedule::parse("* * * * *")};
+}
+
+}  // namespace
+
+TEST(QuerySchedulerTest, StartsDueRunsWithinTheConcurrencyLimit) {
+    FakeClock clock;
+    FakeExecutor executor;
+    QueryScheduler scheduler(executor.start(), executor.collect(), 2, clock.function());
+    for (const char* id : {"a", "b", "c"}) {
+        auto next = scheduler.add(everyMinute(id));
+        ASSERT_TRUE(next.has_value());
+    }
+
+    clock.advance(minutes{1});
+    scheduler.wake();
+    ASSERT_TRUE(eventually([&] { return executor.startedCount() == 2; }));
+    std::this_thread::sleep_for(milliseconds{20});
+    EXPECT_EQ(executor.startedCount(), 2u);
+
+    // A finished run frees its slot for the one still due
+    executor.finishAll();
+    scheduler.wake();
+    ASSERT_TRUE(eventually([&] { return executor.startedCount() == 3; }));
+    ASSERT_TRUE(eventually([&] {
+        auto states = scheduler.list();
+        return states[0].lastOutcome.has_value() && states[1].lastOutcome.has_value();
+    }));
+    auto states = scheduler.list();
+    EXPECT_TRUE(states[0].lastOutcome->success);
+    EXPECT_EQ(states[0].lastOutcome->rows, 7u);
+    EXPECT_EQ(states[0].runs, 1u);
+}
+
+TEST(QuerySchedulerTest, SkipsRunsDueWhileThePreviousOneIsGoing) {
+    FakeClock clock;
+    FakeExecutor executor;
+    QueryScheduler scheduler(executor.start(), executor.collect(), 2, clock.function());
+    (void)scheduler.add(everyMinute("report"));
+    ASSERT_TRUE(scheduler.runNow("report"));
+    ASSERT_TRUE(eventually([&] { return executor.startedCount() == 1; }));
+
+    clock.advance(minutes{2});
+    scheduler.wake();
+    ASSERT_TRUE(eventually([&] { return scheduler.list()[0].skipped == 1; }));
+    EXPECT_EQ(executor.startedCount(), 1u);
+    EXPECT_TRUE(scheduler.list()[0].running);
+
+    EXPECT_TRUE(scheduler.remove("report"));
+    EXPECT_FALSE(scheduler.runNow("report"));
+    EXPECT_TRUE(scheduler.list().empty());
+}
+
+}  // namespace test
+}  // namespace velocitydb
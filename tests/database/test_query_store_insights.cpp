@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "database/query_store_insights.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Serves canned Query Store rows; `stats` is what the next stats query returns
+class QueryStoreDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view sql) override {
+        statements.emplace_back(sql);
+        ResultSet texts;
+        texts.columns = {{.name = "query_id"}, {.name = "query_text"}, {.name = "object_name"}};
+        for (const auto* id : {"1", "2", "3"}) {
+            if (sql.find(id) != std::string_view::npos) {
+                texts.appendRow({id, std::string("SELECT ") + id, ""});
+            }
+        }
+        return texts;
+    }
+    std::vector<ResultSet> executeMultiple(std::string_view sql) override {
+        statements.emplace_back(sql);
+        ResultSet options;
+        options.columns = {{.name = "actual_state_desc"}, {.name = "now_minute"}};
+        options.appendRow({state, std::to_string(nowMinute)});
+        ResultSet result;
+        result.columns = {{.name = "query_id"}, {.name = "plan_id"}, {.name = "interval"}, {.name = "end_minute"}, {.name = "executions"},
+                          {.name = "duration_us"}, {.name = "max_duration_us"}, {.name = "cpu_us"}, {.name = "logical_reads"}};
+        for (const auto& row : stats) {
+            result.appendRow(row);
+        }
+        return {options, result};
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::string state = "READ_WRITE";
+    int64_t nowMinute = 10000;
+    std::vector<std::vector<std::string>> stats;
+    std::vector<std::string> statements;
+};
+
+}  // namespace
+
+TEST(QueryStoreInsightsTest, RanksQueriesAndFlagsPlanRegressions) {
+    QueryStoreDriver driver;
+    // Query 1 switched from plan 10 (1 ms per run) to plan 11 (4 ms); query 2 is steady but runs often
+    driver.stats = {{"1", "10", "100", "9900", "10", "10000", "2000", "5000", "100"},
+                    {"1", "11", "101", "9960", "10", "40000", "9000", "20000", "400"},
+                    {"2", "20", "101", "9960", "1000", "100000", "300", "50000", "1000"}};
+
+    QueryStoreInsights insights;
+    auto report = insights.report("c1", driver, {.database = "Sales"});
+    EXPECT_FALSE(report.incremental);
+    EXPECT_EQ(report.intervals, 2);
+    ASSERT_EQ(report.queries.size(), 2);
+    EXPECT_EQ(report.queries[0].queryId, 2);
+    EXPECT_DOUBLE_EQ(report.queries[0].totalDurationMs, 100.0);
+    EXPECT_EQ(report.queries[0].text, "SELECT 2");
+
+    const auto& regressed = report.queries[1];
+    EXPECT_EQ(regressed.planCount, 2);
+    EXPECT_EQ(regressed.planId, 11);
+    EXPECT_EQ(regressed.previousPlanId, 10);
+    EXPECT_TRUE(regressed.regressed);
+    EXPECT_DOUBLE_EQ(regressed.regressionRatio, 4.0);
+    EXPECT_NE(driver.statements.front().find("[Sales].sys.query_store_runtime_stats"), std::string::npos);
+
+    report = insights.report("c1", driver, {.database = "Sales", .rankBy = QueryStoreRanking::Regression});
+    ASSERT_EQ(report.queries.size(), 1);
+    EXPECT_EQ(report.queries[0].queryId, 1);
+}
+
+TEST(QueryStoreInsightsTest, RefreshesIncrementallyAndExpiresOldIntervals) {
+    QueryStoreDriver driver;
+    driver.stats = {{"1", "10", "100", "9000", "5", "5000", "1000", "0", "0"}, {"2", "20", "101", "9960", "5", "5000", "1000", "0", "0"}};
+    QueryStoreInsights insights;
+    (void)insights.report("c1", driver, {.windowMinutes = 24 * 60});
+
+    // The next read starts at the newest interval already held; interval 100 has left the window by then
+    driver.nowMinute = 10500;
+    driver.stats = {{"2", "20", "101", "9960", "8", "8000", "1000", "0", "0"}, {"3", "30", "102", "10020", "1", "1000", "1000", "0", "0"}};
+    const auto statementsBefore = driver.statements.size();
+    auto report = insights.report("c1", driver, {.windowMinutes = 24 * 60});
+    EXPECT_TRUE(report.incremental);
+    EXPECT_NE(driver.statements[statementsBefore].find("runtime_stats_interval_id >= 101"), std::string::npos);
+    ASSERT_EQ(report.queries.size(), 2);
+    EXPECT_EQ(report.queries[0].queryId, 2);
+    EXPECT_EQ(report.queries[0].executions, 8);  // Re-read interval replaces the partial one
+    // Only query 3 needed its text
+    EXPECT_NE(driver.statements.back().find("IN (3)"), std::string::npos);
+
+    EXPECT_FALSE(insights.report("c1", driver, {.windowMinutes = 48 * 60}).incremental);
+    insights.forget("c1");
+    EXPECT_FALSE(insights.report("c1", driver, {.windowMinutes = 24 * 60}).incremental);
+
+    driver.state = "OFF";
+    EXPECT_THROW((void)insights.report("c2", driver, {}), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
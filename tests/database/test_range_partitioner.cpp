@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "database/range_partitioner.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Answers the key column lookup and the histogram query with canned rows
+class CatalogDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view sql) override {
+        statements.emplace_back(sql);
+        ResultSet result;
+        if (sql.find("sys.index_columns") != std::string_view::npos) {
+            result.columns = {{.name = "name"}, {.name = "type"}};
+            if (!keyType.empty()) {
+                result.appendRow({keyName, keyType});
+            }
+        } else if (sql.find("dm_db_stats_histogram") != std::string_view::npos) {
+            result.columns = {{.name = "key"}, {.name = "rows"}};
+            for (const auto& step : histogram) {
+                result.appendRow({step.highKey, std::to_string(step.rows)});
+            }
+        } else {
+            result.columns = {{.name = "low"}, {.name = "high"}};
+            result.appendRow({"1", "1000"});
+        }
+        return result;
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::string keyName = "OrderId";
+    std::string keyType = "int";
+    std::vector<HistogramStep> histogram;
+    std::vector<std::string> statements;
+};
+
+}  // namespace
+
+TEST(RangePartitionerTest, SplitsHistogramIntoEvenRowCounts) {
+    std::vector<HistogramStep> steps;
+    for (int key = 100; key <= 1000; key += 100) {
+        steps.push_back({.highKey = std::to_string(key), .rows = 10.0});
+    }
+
+    auto ranges = splitHistogram(steps, 4);
+    ASSERT_EQ(ranges.size(), 4);
+    EXPECT_FALSE(ranges[0].low);
+    EXPECT_EQ(ranges[0].high, "300");
+    EXPECT_EQ(ranges[1].low, "300");
+    EXPECT_EQ(ranges[1].high, "500");
+    EXPECT_EQ(ranges[2].high, "800");
+    EXPECT_EQ(ranges[3].low, "800");
+    EXPECT_FALSE(ranges[3].high);
+
+    EXPECT_EQ(splitHistogram({}, 8).size(), 1);
+    // One step holding nearly every row cannot be split further
+    EXPECT_EQ(splitHistogram({{.highKey = "1", .rows = 1000.0}, {.highKey = "2", .rows = 1.0}}, 8).size(), 2);
+}
+
+TEST(RangePartitionerTest, PlansOnTheClusteredKeyAndBuildsRangeQueries) {
+    CatalogDriver driver;
+    driver.histogram = {{.highKey = "250", .rows = 50.0}, {.highKey = "500", .rows = 50.0}, {.highKey = "750", .rows = 50.0}, {.highKey = "1000", .rows = 50.0}};
+
+    auto plan = planKeyRanges(driver, "sales.[Order]", "", 2);
+    EXPECT_EQ(plan.table, "[sales].[Order]");
+    EXPECT_EQ(plan.column, "[OrderId]");
+    ASSERT_EQ(plan.ranges.size(), 2);
+    EXPECT_NE(driver.statements[0].find("OBJECT_ID(N'[sales].[Order]')"), std::string::npos);
+
+    EXPECT_EQ(keyRangeQuery(plan, 0, true), "SELECT * FROM [sales].[Order] WHERE [OrderId] <= 500 OR [OrderId] IS NULL ORDER BY [OrderId]");
+    EXPECT_EQ(keyRangeQuery(plan, 1, false), "SELECT * FROM [sales].[Order] WHERE [OrderId] > 500");
+
+    plan = planKeyRanges(driver, "sales.[Order]", "", 4);
+    ASSERT_EQ(plan.ranges.size(), 4);
+    EXPECT_EQ(keyRangeQuery(plan, 1, false), "SELECT * FROM [sales].[Order] WHERE [OrderId] > 250 AND [OrderId] <= 500");
+}
+
+TEST(RangePartitionerTest, FallsBackToMinMaxAndRejectsOtherTypes) {
+    CatalogDriver driver;
+    auto plan = planKeyRanges(driver, "dbo.Orders", "OrderId", 4);
+    ASSERT_EQ(plan.ranges.size(), 4);
+    EXPECT_EQ(plan.ranges[0].high, "250");
+    EXPECT_EQ(plan.ranges[3].low, "750");
+
+    driver.keyName = "OrderDate";
+    driver.keyType = "datetime2";
+    driver.histogram = {{.highKey = "2024-01-01T00:00:00", .rows = 5.0}, {.highKey = "2024-06-01T00:00:00", .rows = 5.0}};
+    plan = planKeyRanges(driver, "dbo.Orders", "OrderDate", 2);
+    EXPECT_EQ(keyRangeQuery(plan, 1, false), "SELECT * FROM [dbo].[Orders] WHERE [OrderDate] > '2024-01-01T00:00:00'");
+
+    driver.keyType = "nvarchar";
+    EXPECT_THROW((void)planKeyRanges(driver, "dbo.Orders", "", 4), std::runtime_error);
+    driver.keyType.clear();
+    EXPECT_THROW((void)planKeyRanges(driver, "dbo.Orders", "", 4), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "database/replay_driver.h"
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet numbers(size_t count) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "BIGINT"});
+    result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (size_t i = 0; i < count; ++i) {
+        result.columnData[0].appendInt64(static_cast<int64_t>(i));
+        result.columnData[1].appendText("row " + std::to_string(i));
+    }
+    return result;
+}
+
+/// Stands in for a live server while recording
+class SourceDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view) override { return numbers(3); }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+};
+
+}  // namespace
+
+TEST(ReplayDriverTest, ServesCannedResultsAndStreamsThemInBatches) {
+    ReplayDriver driver;
+    ASSERT_TRUE(driver.connect(""));
+    driver.addResult("SELECT * FROM t", numbers(10));
+
+    const auto result = driver.execute("  SELECT * FROM t;\n");
+    EXPECT_EQ(result.rowCount(), 10u);
+    EXPECT_EQ(result.cellText(9, 1), "row 9");
+
+    std::vector<size_t> batches;
+    CallbackBatchSink sink([&](const ResultSet& batch) {
+        batches.push_back(batch.rowCount());
+        return true;
+    });
+    const auto summary = driver.executeStreaming("SELECT * FROM t", sink, 4);
+    EXPECT_EQ(summary.totalRows, 10u);
+    EXPECT_EQ(summary.columns.size(), 2u);
+    EXPECT_EQ(batches, (std::vector<size_t>{4, 4, 2}));
+    EXPECT_EQ(driver.executeCount(), 2u);
+
+    EXPECT_THROW((void)driver.execute("SELECT 1"), std::runtime_error);
+    EXPECT_NE(driver.getLastError().find("No replay recording"), std::string::npos);
+}
+
+TEST(ReplayDriverTest, SyntheticFallbackIsStablePerQuery) {
+    ReplayDriver driver;
+    ASSERT_TRUE(driver.connect("SyntheticRows=500"));
+
+    const auto first = driver.execute("SELECT * FROM big");
+    const auto again = ReplayDriver::makeSyntheticResult({.rows = 500}, 0);
+    EXPECT_EQ(first.rowCount(), 500u);
+    EXPECT_EQ(first.columns.size(), 7u);
+    EXPECT_EQ(first.columnData[4].int64At(0), 1);  // Primary key column counts from 1
+    EXPECT_EQ(driver.execute("SELECT * FROM big").cellText(42, 0), first.cellText(42, 0));
+    EXPECT_NE(again.cellText(42, 0), first.cellText(42, 0));  // Seeded by the SQL text
+}
+
+TEST(ReplayDriverTest, LatencyAndThroughputArePacedAndCancellable) {
+    ReplayDriver driver(ReplayTiming{.executeLatency = std::chrono::milliseconds(20), .rowsPerSecond = 2000.0});
+    ASSERT_TRUE(driver.connect(""));
+    driver.addResult("SELECT * FROM t", numbers(100));
+
+    auto start = std::chrono::steady_clock::now();
+    const auto result = driver.execute("SELECT * FROM t");
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(70));  // 20 ms latency + 100 rows at 2000/s
+    EXPECT_GE(result.executionTimeMs, 70.0);
+
+    driver.setTiming({.executeLatency = std::chrono::seconds(30)});
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        driver.cancel();
+    });
+    start = std::chrono::steady_clock::now();
+    EXPECT_THROW((void)driver.execute("SELECT * FROM t"), std::runtime_error);
+    canceller.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(ReplayDriverTest, RecordingRoundTripsThroughAFile) {
+    const auto path = std::filesystem::temp_directory_path() / "velocitydb_replay_test.vdbp";
+
+    ReplayDriver recorder;
+    ASSERT_TRUE(recorder.connect(""));
+    recorder.recordFrom(std::make_shared<SourceDriver>());
+    EXPECT_EQ(recorder.execute("SELECT name FROM users").rowCount(), 3u);
+    recorder.recordFrom(nullptr);
+    ASSERT_TRUE(recorder.save(path));
+
+    ReplayDriver replay;
+    ASSERT_TRUE(replay.connect("File=" + path.string() + ";LatencyMs=0"));
+    EXPECT_EQ(replay.entryCount(), 1u);
+    const auto result = replay.execute("SELECT name FROM users");
+    ASSERT_EQ(result.rowCount(), 3u);
+    EXPECT_EQ(result.columnData[0].type(), ColumnDataType::Int64);
+    EXPECT_EQ(result.cellText(2, 1), "row 2");
+
+    std::filesystem::remove(path);
+    ReplayDriver missing;
+    EXPECT_FALSE(missing.connect("File=" + path.string()));
+    EXPECT_FALSE(missing.connect("LatencyMs=abc"));
+}
+
+TEST(ReplayDriverTest, FactoryCreatesReplayDrivers) {
+    auto driver = DriverFactory::createDriver(DriverType::Replay);
+    ASSERT_NE(driver, nullptr);
+    EXPECT_EQ(driver->getType(), DriverType::Replay);
+    EXPECT_EQ(driverTypeToString(DriverType::Replay), "Replay");
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "database/result_cache.h"
+
+#include <chrono>
+#include <format>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::shared_ptr<const ResultSet> makeResult(std::string_view text) {
+    auto result = std::make_shared<ResultSet>();
+    result->columns.push_back({.name = "value", .type = "VARCHAR"});
+    result->appendRow({std::string(text)});
+    return result;
+}
+
+/// Keys that hash to the same shard, so recency order between them is exact
+std::vector<std::string> sameShardKeys(size_t count) {
+    std::vector<std::string> keys;
+    const size_t target = std::hash<std::string_view>{}("q0") % ResultCache::SHARD_COUNT;
+    for (int i = 0; keys.size() < count; ++i) {
+        auto key = std::format("q{}", i);
+        if (std::hash<std::string_view>{}(key) % ResultCache::SHARD_COUNT == target) {
+            keys.push_back(std::move(key));
+        }
+    }
+    return keys;
+}
+
+}  // namespace
+
+TEST(ResultCacheTest, HitReturnsSharedResultWithoutCopy) {
+    ResultCache cache;
+    auto result = makeResult("alpha");
+    cache.put("k", result);
+
+    auto hit = cache.get("k");
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit.get(), result.get());
+    EXPECT_EQ(hit->cellText(0, 0), "alpha");
+    EXPECT_EQ(cache.get("missing"), nullptr);
+}
+
+TEST(ResultCacheTest, ReplacingKeyKeepsSizeAccurate) {
+    ResultCache cache;
+    cache.put("k", makeResult("short"));
+    cache.put("k", makeResult("a considerably longer value"));
+
+    EXPECT_EQ(cache.entryCount(), 1);
+    EXPECT_EQ(cache.getCurrentSize(), cache.get("k")->memoryBytes());
+
+    cache.invalidate("k");
+    EXPECT_EQ(cache.entryCount(), 0);
+    EXPECT_EQ(cache.getCurrentSize(), 0);
+}
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsedWithinBudget) {
+    const size_t entryBytes = makeResult("0")->memoryBytes();
+    ResultCache cache(entryBytes * 3);
+
+    for (int i = 0; i < 64; ++i) {
+        cache.put(std::format("q{}", i), makeResult("0"));
+        EXPECT_LE(cache.getCurrentSize(), cache.getMaxSize());
+    }
+    EXPECT_EQ(cache.entryCount(), 3);
+    // The most recent insert always survives
+    EXPECT_NE(cache.get("q63"), nullptr);
+
+    cache.clear();
+    EXPECT_EQ(cache.entryCount(), 0);
+    EXPECT_EQ(cache.getCurrentSize(), 0);
+}
+
+TEST(ResultCacheTest, GetPromotesEntryInShard) {
+    const size_t entryBytes = makeResult("0")->memoryBytes();
+    ResultCache cache(entryBytes * 2);
+    auto keys = sameShardKeys(3);
+
+    cache.put(keys[0], makeResult("0"));
+    cache.put(keys[1], makeResult("0"));
+    ASSERT_NE(cache.get(keys[0]), nullptr);
+    cache.put(keys[2], makeResult("0"));
+
+    EXPECT_NE(cache.get(keys[0]), nullptr);
+    EXPECT_EQ(cache.get(keys[1]), nullptr);
+    EXPECT_NE(cache.get(keys[2]), nullptr);
+}
+
+TEST(ResultCacheTest, StoresSerializedResponseWithEntry) {
+    ResultCache cache;
+    auto result = makeResult("alpha");
+    cache.put("k", result);
+    EXPECT_EQ(cache.lookup("k").response, nullptr);
+
+    auto response = std::make_shared<const std::string>(R"({"success":true})");
+    cache.putResponse("k", response);
+    EXPECT_EQ(cache.lookup("k").response.get(), response.get());
+    EXPECT_EQ(cache.getCurrentSize(), result->memoryBytes() + response->size());
+
+    // Unknown keys are ignored and replacing the result drops the stale response
+    cache.putResponse("missing", response);
+    EXPECT_EQ(cache.lookup("missing").response, nullptr);
+    cache.put("k", makeResult("beta"));
+    EXPECT_EQ(cache.lookup("k").response, nullptr);
+    EXPECT_EQ(cache.getCurrentSize(), cache.get("k")->memoryBytes());
+}
+
+TEST(ResultCacheTest, InvalidatesDependentEntriesPerConnection) {
+    ResultCache cache;
+    const auto usersA = ResultCache::makeKey("connA", "SELECT * FROM users");
+    const auto joinA = ResultCache::makeKey("connA", "SELECT * FROM orders JOIN users");
+    const auto ordersA = ResultCache::makeKey("connA", "SELECT * FROM orders");
+    const auto usersB = ResultCache::makeKey("connB", "SELECT * FROM users");
+    cache.put(usersA, makeResult("0"), {.tables = {"users"}});
+    cache.put(joinA, makeResult("0"), {.tables = {"orders", "users"}});
+    cache.put(ordersA, makeResult("0"), {.tables = {"orders"}});
+    cache.put(usersB, makeResult("0"), {.tables = {"users"}});
+
+    const std::vector<std::string> written{"users"};
+    EXPECT_EQ(cache.invalidateTables("connA", written), 2);
+    EXPECT_EQ(cache.get(usersA), nullptr);
+    EXPECT_EQ(cache.get(joinA), nullptr);
+    EXPECT_NE(cache.get(ordersA), nullptr);
+    EXPECT_NE(cache.get(usersB), nullptr);
+
+    // A connection id that is a prefix of another must not match it
+    EXPECT_EQ(cache.invalidateConnection("conn"), 0);
+    EXPECT_EQ(cache.invalidateConnection("connA"), 1);
+    EXPECT_EQ(cache.entryCount(), 1);
+    EXPECT_EQ(cache.getCurrentSize(), cache.get(usersB)->memoryBytes());
+}
+
+TEST(ResultCacheTest, KeysIgnoreLayoutButKeepVariants) {
+    EXPECT_EQ(ResultCache::makeKey("c", "SELECT * FROM users"), ResultCache::makeKey("c", "select *\n  from users -- latest\n;"));
+    EXPECT_NE(ResultCache::makeKey("c", "SELECT * FROM users WHERE id = 1"), ResultCache::makeKey("c", "SELECT * FROM users WHERE id = 2"));
+    EXPECT_NE(ResultCache::makeKey("c", "SELECT * FROM users"), ResultCache::makeKey("c", "SELECT * FROM users", "maxRows=10;"));
+}
+
+TEST(ResultCacheTest, ExpiredEntriesAreDroppedOnLookup) {
+    ResultCache cache(1024 * 1024, std::chrono::seconds(3600));
+    cache.put("fresh", makeResult("a"));
+    cache.put("expired", makeResult("b"), {.ttl = std::chrono::seconds(-1)});
+
+    EXPECT_NE(cache.get("fresh"), nullptr);
+    EXPECT_NE(cache.get("expired"), nullptr);  // negative TTL falls back to the cache default
+
+    ResultCache zeroTtl(1024 * 1024, std::chrono::seconds(0));
+    zeroTtl.put("k", makeResult("a"));
+    EXPECT_EQ(zeroTtl.get("k"), nullptr);
+    EXPECT_EQ(zeroTtl.entryCount(), 0);
+    EXPECT_EQ(zeroTtl.getCurrentSize(), 0);
+    EXPECT_EQ(zeroTtl.stats().staleRejections, 1);
+    EXPECT_EQ(zeroTtl.stats().misses, 1);
+}
+
+TEST(ResultCacheTest, FreshnessProbeRejectsChangedTables) {
+    ResultCache cache;
+    cache.put("k", makeResult("a"), {.tables = {"users"}, .freshnessToken = "v1"});
+    cache.put("untracked", makeResult("b"), {.tables = {"users"}});
+
+    std::string current = "v1";
+    int probes = 0;
+    ResultCache::FreshnessProbe probe = [&](std::span<const std::string> tables) -> std::optional<std::string> {
+        ++probes;
+        EXPECT_EQ(tables.size(), 1);
+        return current;
+    };
+
+    EXPECT_TRUE(cache.lookup("k", probe));
+    EXPECT_TRUE(cache.lookup("untracked", probe));  // no token, nothing to compare
+    EXPECT_EQ(probes, 1);
+
+    // A probe that cannot tell keeps the entry
+    EXPECT_TRUE(cache.lookup("k", [](std::span<const std::string>) { return std::optional<std::string>{}; }));
+
+    current = "v2";
+    EXPECT_FALSE(cache.lookup("k", probe));
+    EXPECT_EQ(cache.get("k"), nullptr);
+    EXPECT_EQ(cache.getCurrentSize(), cache.get("untracked")->memoryBytes());
+    EXPECT_EQ(cache.stats().staleRejections, 1);
+}
+
+TEST(ResultCacheTest, StatsCountHitsMissesAndBytesSaved) {
+    ResultCache cache;
+    auto result = makeResult("alpha");
+    cache.put("k", result);
+
+    EXPECT_NE(cache.get("k"), nullptr);
+    EXPECT_NE(cache.get("k"), nullptr);
+    EXPECT_EQ(cache.get("missing"), nullptr);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.staleRejections, 0);
+    EXPECT_EQ(stats.bytesSaved, 2 * result->memoryBytes());
+}
+
+TEST(ResultCacheTest, SkipsResultsLargerThanBudget) {
+    ResultCache cache(1);
+    cache.put("k", makeResult("too big"));
+    EXPECT_EQ(cache.get("k"), nullptr);
+    EXPECT_EQ(cache.getCurrentSize(), 0);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "database/result_registry.h"
+
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::shared_ptr<const ResultSet> makeResult(size_t rows) {
+    auto result = std::make_shared<ResultSet>();
+    result->columns.push_back({.name = "value", .type = "VARCHAR"});
+    for (size_t i = 0; i < rows; ++i) {
+        result->appendRow({std::to_string(i)});
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(ResultRegistryTest, HandleFindsTheHeldResult) {
+    ResultRegistry registry;
+    auto result = makeResult(3);
+    auto handle = registry.put("conn1", result);
+    ASSERT_FALSE(handle.empty());
+
+    EXPECT_EQ(registry.find(handle).get(), result.get());
+    EXPECT_EQ(registry.find("missing"), nullptr);
+    EXPECT_EQ(registry.entryCount(), 1u);
+    EXPECT_EQ(registry.totalBytes(), result->memoryBytes());
+}
+
+TEST(ResultRegistryTest, ViewIsComputedOnceAndReplacedByTheNextKey) {
+    ResultRegistry registry;
+    auto handle = registry.put("conn1", makeResult(4));
+    int computed = 0;
+    auto reversed = [&](const ResultSet&) {
+        ++computed;
+        return std::vector<size_t>{3, 2, 1, 0};
+    };
+
+    auto first = registry.view(handle, "desc", reversed);
+    auto again = registry.view(handle, "desc", reversed);
+    ASSERT_NE(first.rows, nullptr);
+    EXPECT_EQ(again.rows.get(), first.rows.get());
+    EXPECT_EQ(computed, 1);
+    EXPECT_EQ(first.size(), 4u);
+    EXPECT_EQ(first.rowAt(0), 3u);
+
+    auto other = registry.view(handle, "odd", [](const ResultSet&) { return std::vector<size_t>{1, 3}; });
+    EXPECT_EQ(other.size(), 2u);
+    EXPECT_EQ(registry.totalBytes(), registry.find(handle)->memoryBytes() + 2 * sizeof(size_t));
+
+    auto plain = registry.view(handle, "", reversed);
+    EXPECT_EQ(plain.rows, nullptr);
+    EXPECT_EQ(plain.rowAt(2), 2u);
+    EXPECT_EQ(computed, 1);
+
+    EXPECT_EQ(registry.view("missing", "desc", reversed).result, nullptr);
+}
+
+TEST(ResultRegistryTest, DerivedRowsAreCachedPerKeyAndCharged) {
+    const auto spillRoot = std::filesystem::temp_directory_path() / "velocitydb_spill_test";
+    MemoryGovernor governor;
+    {
+        ResultRegistry registry(1024 * 1024 * 1024, ResultRegistry::DEFAULT_IDLE_TTL, spillRoot, governor);
+        auto handle = registry.put("conn1", makeResult(4));
+        const size_t resultBytes = registry.totalBytes();
+        int computed = 0;
+        auto keyed = [&](size_t first) {
+            return [&computed, first](const ResultSet&) {
+                ++computed;
+                return std::vector<size_t>{first, 0};
+            };
+        };
+
+        auto sorted = registry.derivedRows(handle, "sort:0:desc", keyed(3));
+        auto filtered = registry.derivedRows(handle, "filter:{}", keyed(2));
+        // Toggling back to either one is a cache hit
+        EXPECT_EQ(registry.derivedRows(handle, "sort:0:desc", keyed(3)).get(), sorted.get());
+        EXPECT_EQ(registry.derivedRows(handle, "filter:{}", keyed(2)).get(), filtered.get());
+        EXPECT_EQ(computed, 2);
+        EXPECT_EQ(registry.totalBytes(), resultBytes + 4 * sizeof(size_t));
+        EXPECT_EQ(governor.used(MemoryPool::HeldResults), registry.totalBytes());
+
+        // Beyond the per-result limit the least recently used list goes
+        for (size_t i = 0; i < ResultRegistry::MAX_DERIVED_ROWS - 1; ++i) {
+            (void)registry.derivedRows(handle, std::format("sort:{}:asc", i), keyed(1));
+        }
+        EXPECT_EQ(registry.totalBytes(), resultBytes + ResultRegistry::MAX_DERIVED_ROWS * 2 * sizeof(size_t));
+        (void)registry.derivedRows(handle, "filter:{}", keyed(2));
+        (void)registry.derivedRows(handle, "sort:0:desc", keyed(3));
+        EXPECT_EQ(computed, 2 + static_cast<int>(ResultRegistry::MAX_DERIVED_ROWS));
+
+        // Spilling the result lets its derived lists go too
+        EXPECT_GT(registry.spill(1), 0u);
+        EXPECT_EQ(registry.totalBytes(), 0u);
+        EXPECT_EQ(registry.derivedRows("missing", "sort:0:desc", keyed(3)), nullptr);
+    }
+    EXPECT_EQ(governor.used(), 0u);
+    std::filesystem::remove_all(spillRoot);
+}
+
+TEST(ResultRegistryTest, PatchReplacesRemovesAndAppendsRows) {
+    ResultRegistry registry;
+    auto handle = registry.put("conn1", makeResult(4));
+    auto old = registry.find(handle);
+    auto reversed = registry.view(handle, "desc", [](const ResultSet&) { return std::vector<size_t>{3, 2, 1, 0}; });
+    ASSERT_EQ(reversed.size(), 4u);
+
+    auto row = [](std::string_view value) {
+        ResultSet values;
+        values.columns.push_back({.name = "value", .type = "VARCHAR"});
+        values.appendRow({value});
+        return values;
+    };
+    std::vector<RowPatch> patches;
+    patches.push_back({.kind = RowPatch::Kind::Append, .values = row("new")});
+    patches.push_back({.kind = RowPatch::Kind::Replace, .row = 1, .values = row("one")});
+    patches.push_back({.kind = RowPatch::Kind::Remove, .row = 2});
+    patches.push_back({.kind = RowPatch::Kind::Replace, .row = 3, .values = ResultSet{}});  // No row: the stored one stays
+    ASSERT_TRUE(registry.patch(handle, patches));
+
+    auto patched = registry.find(handle);
+    ASSERT_EQ(patched->rowCount(), 4u);
+    EXPECT_EQ(patched->cellText(0, 0), "0");
+    EXPECT_EQ(patched->cellText(1, 0), "one");
+    EXPECT_EQ(patched->cellText(2, 0), "3");
+    EXPECT_EQ(patched->cellText(3, 0), "new");
+    EXPECT_EQ(old->rowCount(), 4u);  // Readers holding the old result still see it
+    EXPECT_EQ(old->cellText(1, 0), "1");
+    EXPECT_EQ(registry.totalBytes(), patched->memoryBytes());  // The view went with the old row numbers
+
+    EXPECT_FALSE(registry.patch("missing", patches));
+}
+
+TEST(ResultRegistryTest, FailedViewLeavesEntryUsable) {
+    ResultRegistry registry;
+    auto handle = registry.put("conn1", makeResult(2));
+    EXPECT_THROW((void)registry.view(handle, "bad", [](const ResultSet&) -> std::vector<size_t> { throw std::invalid_argument("bad column"); }), std::invalid_argument);
+    EXPECT_NE(registry.find(handle), nullptr);
+}
+
+TEST(ResultRegistryTest, BudgetEvictsLeastRecentlyUsed) {
+    auto sample = makeResult(100);
+    ResultRegistry registry(sample->memoryBytes() * 2 + sample->memoryBytes() / 2);
+    auto first = registry.put("conn1", makeResult(100));
+    auto second = registry.put("conn1", makeResult(100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    (void)registry.find(first);  // second is now the least recently used
+
+    auto third = registry.put("conn1", makeResult(100));
+    EXPECT_NE(registry.find(first), nullptr);
+    EXPECT_EQ(registry.find(second), nullptr);
+    EXPECT_NE(registry.find(third), nullptr);
+
+    ResultRegistry tiny(16);
+    EXPECT_TRUE(tiny.put("conn1", makeResult(100)).empty());
+}
+
+TEST(ResultRegistryTest, IdleEntriesExpire) {
+    ResultRegistry registry(1024 * 1024, std::chrono::seconds(0));
+    auto handle = registry.put("conn1", makeResult(1));
+    EXPECT_EQ(registry.find(handle), nullptr);
+    EXPECT_EQ(registry.entryCount(), 0u);
+    EXPECT_EQ(registry.totalBytes(), 0u);
+}
+
+TEST(ResultRegistryTest, ReleaseDropsOneHandleOrAConnection) {
+    ResultRegistry registry;
+    auto a = registry.put("conn1", makeResult(1));
+    auto b = registry.put("conn1", makeResult(1));
+    auto c = registry.put("conn2", makeResult(1));
+
+    EXPECT_TRUE(registry.release(a));
+    EXPECT_FALSE(registry.release(a));
+    EXPECT_EQ(registry.releaseConnection("conn1"), 1u);
+    EXPECT_EQ(registry.find(b), nullptr);
+    EXPECT_NE(registry.find(c), nullptr);
+    EXPECT_EQ(registry.totalBytes(), registry.find(c)->memoryBytes());
+}
+
+TEST(ResultRegistryTest, SpilledResultIsReadBackOnNextUse) {
+    const auto spillRoot = std::filesystem::temp_directory_path() / "velocitydb_spill_test";
+    MemoryGovernor governor;
+    {
+        ResultRegistry registry(1024 * 1024 * 1024, ResultRegistry::DEFAULT_IDLE_TTL, spillRoot, governor);
+        auto previewed = std::make_shared<ResultSet>(*makeResult(500));
+        previewed->lobPreviews.push_back({.row = 7, .column = 0, .totalBytes = 123456});
+        auto older = registry.put("conn1", previewed, "documents");
+        auto newer = registry.put("conn1", makeResult(500));
+        const size_t heldBefore = governor.used(MemoryPool::HeldResults);
+
+        // Least recently used goes first, and only as much as was asked for
+        EXPECT_GT(registry.spill(1), 0u);
+        EXPECT_EQ(registry.spilledCount(), 1u);
+        EXPECT_GT(registry.spilledBytes(), 0u);
+        EXPECT_LT(governor.used(MemoryPool::HeldResults), heldBefore);
+
+        auto restored = registry.find(older);
+        ASSERT_NE(restored, nullptr);
+        ASSERT_EQ(restored->rowCount(), 500u);
+        EXPECT_EQ(restored->columns[0].name, "value");
+        EXPECT_EQ(restored->cellText(499, 0), "499");
+        ASSERT_NE(restored->lobPreview(7, 0), nullptr);
+        EXPECT_EQ(restored->lobPreview(7, 0)->totalBytes, 123456);
+        EXPECT_EQ(registry.origin(older)->sourceTable, "documents");
+        EXPECT_EQ(registry.spilledCount(), 0u);
+        EXPECT_EQ(governor.used(MemoryPool::HeldResults), registry.totalBytes());
+        EXPECT_NE(registry.find(newer), nullptr);
+    }
+    EXPECT_EQ(governor.used(), 0u);
+    std::filesystem::remove_all(spillRoot);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+#include "database/result_set.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(ColumnDataTest, StoresTextInArena) {
+    ColumnData column(ColumnDataType::Text);
+    column.appendText("alpha");
+    column.appendText("");
+    column.appendNull();
+    column.appendText("gamma");
+
+    ASSERT_EQ(column.size(), 4);
+    EXPECT_EQ(column.textAt(0), "alpha");
+    EXPECT_EQ(column.textAt(1), "");
+    EXPECT_FALSE(column.isNull(1));
+    EXPECT_TRUE(column.isNull(2));
+    EXPECT_EQ(column.textAt(3), "gamma");
+    EXPECT_EQ(column.textBytes(), 10);
+}
+
+TEST(ColumnDataTest, ParsesTypedValuesFromText) {
+    ColumnData ints(ColumnDataType::Int64);
+    ints.appendFromText("-42");
+    ints.appendNull();
+    EXPECT_EQ(ints.type(), ColumnDataType::Int64);
+    EXPECT_EQ(ints.int64At(0), -42);
+    EXPECT_TRUE(ints.isNull(1));
+    EXPECT_EQ(ints.displayText(0), "-42");
+    EXPECT_EQ(ints.displayText(1), "");
+
+    ColumnData bits(ColumnDataType::Bit);
+    bits.appendFromText("1");
+    bits.appendFromText("0");
+    EXPECT_EQ(bits.displayText(0), "1");
+    EXPECT_EQ(bits.displayText(1), "0");
+
+    ColumnData doubles(ColumnDataType::Double);
+    doubles.appendFromText("1.5");
+    EXPECT_DOUBLE_EQ(doubles.doubleAt(0), 1.5);
+    EXPECT_EQ(doubles.displayText(0), "1.5");
+}
+
+TEST(ColumnDataTest, RoundTripsDateTimeText) {
+    ColumnData timestamps(ColumnDataType::Timestamp, 3);
+    timestamps.appendFromText("2024-02-29 23:59:58.123");
+    ASSERT_EQ(timestamps.type(), ColumnDataType::Timestamp);
+    EXPECT_EQ(timestamps.dateTimeAt(0).year, 2024);
+    EXPECT_EQ(timestamps.dateTimeAt(0).fraction, 123000000u);
+    EXPECT_EQ(timestamps.displayText(0), "2024-02-29 23:59:58.123");
+
+    ColumnData dates(ColumnDataType::Date);
+    dates.appendFromText("1999-12-31");
+    EXPECT_EQ(dates.displayText(0), "1999-12-31");
+
+    ColumnData times(ColumnDataType::Time, 7);
+    times.appendFromText("08:30:00.1234567");
+    EXPECT_EQ(times.displayText(0), "08:30:00.1234567");
+}
+
+TEST(ColumnDataTest, FallsBackToTextOnUnparsableValue) {
+    ColumnData column(ColumnDataType::Int64);
+    column.appendFromText("7");
+    column.appendNull();
+    column.appendFromText("not a number");
+
+    EXPECT_EQ(column.type(), ColumnDataType::Text);
+    EXPECT_EQ(column.textAt(0), "7");
+    EXPECT_TRUE(column.isNull(1));
+    EXPECT_EQ(column.textAt(2), "not a number");
+}
+
+TEST(ColumnDataTest, AppendsUtf16IntoArenaOrParsesIt) {
+    ColumnData text(ColumnDataType::Text);
+    EXPECT_EQ(text.appendUtf16(u"caf\u00e9"), 5u);
+    EXPECT_EQ(text.appendUtf16(u""), 0u);
+    EXPECT_EQ(text.textAt(0), "caf\xc3\xa9");
+    EXPECT_EQ(text.textAt(1), "");
+    EXPECT_FALSE(text.isNull(1));
+    EXPECT_EQ(text.textBytes(), 5u);
+
+    ColumnData numbers(ColumnDataType::Int64);
+    EXPECT_EQ(numbers.appendUtf16(u"-42"), 3u);
+    EXPECT_EQ(numbers.type(), ColumnDataType::Int64);
+    EXPECT_EQ(numbers.int64At(0), -42);
+}
+
+TEST(ColumnDataTest, NullBitmapSpansWords) {
+    ColumnData column(ColumnDataType::Int64);
+    for (int i = 0; i < 130; ++i) {
+        if (i % 3 == 0)
+            column.appendNull();
+        else
+            column.appendInt64(i);
+    }
+
+    for (size_t i = 0; i < 130; ++i) {
+        EXPECT_EQ(column.isNull(i), i % 3 == 0) << "row " << i;
+    }
+    EXPECT_EQ(column.int64At(129), 0);
+    EXPECT_EQ(column.int64At(128), 128);
+}
+
+TEST(ColumnDataTest, DictionaryEncodesRepeatedText) {
+    const std::vector<std::string> statuses = {"active", "pending", "closed"};
+    ColumnData column(ColumnDataType::Text);
+    size_t plainBytes = 0;
+    for (size_t i = 0; i < 5000; ++i) {
+        if (i % 11 == 0) {
+            column.appendNull();
+            continue;
+        }
+        column.appendUtf16(i % 2 == 0 ? u"active" : u"pending");
+        column.appendText(statuses[i % 3]);
+        plainBytes += (i % 2 == 0 ? 6 : 7) + statuses[i % 3].size();
+    }
+
+    ASSERT_TRUE(column.isDictionaryEncoded());
+    EXPECT_EQ(column.dictionarySize(), 4u);  // Three statuses plus the empty string NULL rows point at
+    EXPECT_EQ(column.textBytes(), 19u);
+    EXPECT_EQ(column.rowTextBytes(), plainBytes);
+    EXPECT_TRUE(column.isNull(0));
+    EXPECT_EQ(column.textAt(0), "");
+    EXPECT_EQ(column.textAt(1), "pending");
+    EXPECT_EQ(column.textAt(3), "active");
+    EXPECT_EQ(column.dictionaryCode("closed"), column.dictionaryCodes()[4]);
+    EXPECT_FALSE(column.dictionaryCode("missing").has_value());
+    // Codes take 4 bytes a row where plain offsets alone would take 8
+    EXPECT_LT(column.memoryBytes(), column.size() * sizeof(size_t));
+}
+
+TEST(ColumnDataTest, FallsBackToPlainTextForDistinctValues) {
+    ColumnData column(ColumnDataType::Text);
+    for (size_t i = 0; i < ColumnData::DICTIONARY_PROBE_ROWS * 2; ++i) {
+        column.appendText(std::to_string(i * 7919));
+    }
+    EXPECT_FALSE(column.isDictionaryEncoded());
+    EXPECT_EQ(column.textAt(0), "0");
+    EXPECT_EQ(column.textAt(1500), std::to_string(1500 * 7919));
+    EXPECT_EQ(column.textBytes(), column.rowTextBytes());
+
+    // The decision sticks across batch reuse
+    column.clear();
+    column.appendText("again");
+    EXPECT_FALSE(column.isDictionaryEncoded());
+    EXPECT_EQ(column.textAt(0), "again");
+}
+
+TEST(ColumnDataTest, AppendAllMergesDictionaries) {
+    ColumnData total(ColumnDataType::Text);
+    ColumnData batch(ColumnDataType::Text);
+    batch.appendText("red");
+    batch.appendText("green");
+    batch.appendNull();
+    total.appendAll(batch);
+
+    batch.clear();
+    batch.appendText("blue");
+    batch.appendText("red");
+    total.appendAll(batch);
+
+    ASSERT_EQ(total.size(), 5u);
+    ASSERT_TRUE(total.isDictionaryEncoded());
+    EXPECT_EQ(total.dictionarySize(), 4u);
+    EXPECT_EQ(total.textAt(0), "red");
+    EXPECT_TRUE(total.isNull(2));
+    EXPECT_EQ(total.textAt(3), "blue");
+    EXPECT_EQ(total.dictionaryCodes()[4], total.dictionaryCodes()[0]);
+
+    // A plain source turns the target plain too
+    ColumnData converted(ColumnDataType::Int64);
+    converted.appendFromText("not a number");
+    total.appendAll(converted);
+    EXPECT_FALSE(total.isDictionaryEncoded());
+    EXPECT_EQ(total.textAt(4), "red");
+    EXPECT_EQ(total.textAt(5), "not a number");
+}
+
+TEST(ColumnDataTest, BinaryKeepsRawBytesAndShowsHex) {
+    ColumnData column(ColumnDataType::Binary);
+    column.appendBinary(std::string_view("\x00\xab\x10", 3));
+    column.appendNull();
+    column.appendBinary("");
+    column.appendFromText("0xFF01");
+    for (int i = 0; i < 3000; ++i) {
+        column.appendBinary("\x01");  // Repeated values never switch a binary column to a dictionary
+    }
+
+    EXPECT_EQ(column.type(), ColumnDataType::Binary);
+    EXPECT_FALSE(column.isDictionaryEncoded());
+    EXPECT_EQ(column.textAt(0), std::string_view("\x00\xab\x10", 3));
+    EXPECT_EQ(column.displayText(0), "00AB10");
+    EXPECT_TRUE(column.isNull(1));
+    EXPECT_FALSE(column.isNull(2));
+    EXPECT_EQ(column.displayText(2), "");
+    EXPECT_EQ(column.displayText(3), "FF01");
+
+    ColumnData copy(ColumnDataType::Binary);
+    copy.appendFrom(column, 0);
+    copy.appendAll(column);
+    EXPECT_EQ(copy.size(), column.size() + 1);
+    EXPECT_EQ(copy.textAt(4), "\xff\x01");
+
+    // Text that is not hex turns the column into text, keeping earlier cells as their hex
+    column.appendFromText("not hex");
+    EXPECT_EQ(column.type(), ColumnDataType::Text);
+    EXPECT_EQ(column.textAt(0), "00AB10");
+    EXPECT_EQ(column.textAt(column.size() - 1), "not hex");
+
+    ColumnData text(ColumnDataType::Text);
+    text.appendBinary("\xca\xfe");
+    EXPECT_EQ(text.textAt(0), "CAFE");
+}
+
+TEST(ResultSetTest, AppendRowCreatesTextColumns) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "INT"});
+    result.columns.push_back({.name = "name", .type = "VARCHAR"});
+
+    result.appendRow({"1", "Alice"});
+    result.appendRow({"2"});
+
+    ASSERT_EQ(result.rowCount(), 2);
+    ASSERT_EQ(result.columnData.size(), 2);
+    EXPECT_EQ(result.cellText(0, 1), "Alice");
+    EXPECT_TRUE(result.isNull(1, 1));
+
+    std::vector<std::string> ids;
+    for (const auto& row : result.rows()) {
+        ids.push_back(row[0]);
+    }
+    EXPECT_EQ(ids, (std::vector<std::string>{"1", "2"}));
+}
+
+TEST(ResultSetTest, AppendBatchAndClearRowsReuseStorage) {
+    ResultSet batch;
+    batch.columnData.emplace_back(ColumnDataType::Int64);
+    batch.columnData.emplace_back(ColumnDataType::Text);
+    batch.columnData[0].appendInt64(1);
+    batch.columnData[1].appendText("one");
+    batch.columnData[0].appendNull();
+    batch.columnData[1].appendText("two");
+
+    ResultSet total;
+    total.appendBatch(batch);
+    batch.clearRows();
+    EXPECT_EQ(batch.rowCount(), 0);
+    EXPECT_EQ(batch.columnData[0].type(), ColumnDataType::Int64);
+
+    batch.columnData[0].appendInt64(3);
+    batch.columnData[1].appendText("three");
+    total.appendBatch(batch);
+    total.appendRowFrom(batch, 0);
+
+    ASSERT_EQ(total.rowCount(), 4);
+    EXPECT_EQ(total.columnData[0].type(), ColumnDataType::Int64);
+    EXPECT_TRUE(total.isNull(1, 0));
+    EXPECT_EQ(total.columnData[0].int64At(2), 3);
+    EXPECT_EQ(total.cellText(0, 1), "one");
+    EXPECT_EQ(total.cellText(2, 1), "three");
+    EXPECT_EQ(total.cellText(3, 1), "three");
+}
+
+TEST(ResultSetTest, LobPreviewsFollowTheirRowsAcrossBatches) {
+    ResultSet batch;
+    batch.appendRow({"1", "short"});
+    batch.appendRow({"2", "long value cut"});
+    batch.lobPreviews.push_back({.row = 1, .column = 1, .totalBytes = 200000});
+
+    ResultSet total;
+    total.appendBatch(batch);
+    total.appendBatch(batch);
+    batch.clearRows();
+    EXPECT_TRUE(batch.lobPreviews.empty());
+
+    ASSERT_EQ(total.lobPreviews.size(), 2u);
+    EXPECT_EQ(total.lobPreview(0, 1), nullptr);
+    EXPECT_EQ(total.lobPreview(1, 0), nullptr);
+    ASSERT_NE(total.lobPreview(3, 1), nullptr);
+    EXPECT_EQ(total.lobPreview(3, 1)->totalBytes, 200000);
+    EXPECT_EQ(total.cellText(3, 1), "long value cut");
+}
+
+TEST(ResultSetTest, SqlTypeNamesRoundTripAndAliasesResolve) {
+    for (auto type : {SqlType::NVarChar, SqlType::UniqueIdentifier, SqlType::VarBinary, SqlType::DateTimeOffset, SqlType::DateTime2, SqlType::Money}) {
+        EXPECT_EQ(sqlTypeFromName(sqlTypeName(type)), type) << sqlTypeName(type);
+    }
+    EXPECT_EQ(sqlTypeName(SqlType::Unknown), "UNKNOWN");
+    EXPECT_EQ(sqlTypeFromName("numeric(18, 4)"), SqlType::Decimal);
+    EXPECT_EQ(sqlTypeFromName("int unsigned"), SqlType::Int);
+    EXPECT_EQ(sqlTypeFromName("double precision"), SqlType::Float);
+    EXPECT_EQ(sqlTypeFromName("smallmoney"), SqlType::Money);
+    EXPECT_EQ(sqlTypeFromName("geography"), SqlType::Unknown);
+
+    ColumnInfo described{.name = "id", .type = "INT", .sqlType = SqlType::BigInt};
+    EXPECT_EQ(described.typeCode(), SqlType::BigInt);
+    ColumnInfo named{.name = "id", .type = "integer"};
+    EXPECT_EQ(named.typeCode(), SqlType::Int);
+    EXPECT_TRUE(isNumericType(SqlType::Decimal));
+    EXPECT_FALSE(isNumericType(SqlType::Bit));
+}
+
+}  // namespace test
+}  // namespace velocitydb
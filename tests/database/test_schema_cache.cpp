@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+#include "database/schema_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Answers the cache's sys.objects queries from an in-memory catalog
+class CatalogDriver final : public IDatabaseDriver {
+public:
+    struct Object {
+        int64_t id;
+        std::string schema;
+        std::string name;
+        std::string type;  ///< U, V, TR, F, ...
+        int64_t parent = 0;
+        int64_t referenced = 0;
+        int modified = 0;  ///< Stand-in for modify_date: seconds since 2024-01-01 00:00:00
+    };
+
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view sql) override {
+        executed.emplace_back(sql);
+        ResultSet result;
+        if (sql.starts_with("SELECT DB_NAME()")) {
+            int newest = 0;
+            for (const auto& object : objects) {
+                newest = (std::max)(newest, object.modified);
+            }
+            result.appendRow({database, std::to_string(objects.size()), timestamp(newest)});
+        } else if (sql.starts_with("SELECT name FROM sys.databases")) {
+            result.appendRow({"master"});
+            result.appendRow({database});
+        } else if (sql.find("o.type IN ('P', 'FN'") != std::string_view::npos) {
+            for (const auto& object : objects) {
+                if (object.type == "P" || object.type == "FN") {
+                    result.appendRow({std::to_string(object.id), object.schema, object.name, object.type});
+                }
+            }
+        } else if (sql.find("RTRIM(o.type)") != std::string_view::npos) {
+            const auto since = sql.substr(sql.find("CONVERT(datetime2, '") + 20, 23);
+            for (const auto& object : objects) {
+                if (timestamp(object.modified) >= since) {
+                    result.appendRow({std::to_string(object.id), object.type, std::to_string(object.parent), std::to_string(object.referenced)});
+                }
+            }
+        } else if (sql.find("CASE o.type WHEN 'U'") != std::string_view::npos) {
+            const auto in = sql.find("IN (", sql.find("o.object_id IN"));
+            for (const auto& object : objects) {
+                const bool listed = in == std::string_view::npos || std::string(sql.substr(in)).find(std::to_string(object.id)) != std::string::npos;
+                if ((object.type == "U" || object.type == "V") && listed) {
+                    result.appendRow({std::to_string(object.id), object.schema, object.name, object.type == "U" ? "BASE TABLE" : "VIEW", ""});
+                }
+            }
+        }
+        return result;
+    }
+    /// The SchemaSnapshot batch: one "id" column per listed table, no indexes, keys or triggers
+    std::vector<ResultSet> executeMultiple(std::string_view sql) override {
+        executed.emplace_back(sql);
+        const auto in = sql.find("o.object_id IN (");
+        const auto scope = in == std::string_view::npos ? std::string{} : std::string(sql.substr(in, sql.find(')', in) - in));
+        std::vector<ResultSet> results(7);
+        for (const auto& object : objects) {
+            if ((object.type == "U" || object.type == "V") && (scope.empty() || scope.find(std::to_string(object.id)) != std::string::npos)) {
+                results[0].appendRow({std::to_string(object.id), object.schema, object.name, object.type == "U" ? "BASE TABLE" : "VIEW", ""});
+                results[1].appendRow({std::to_string(object.id), "id", "int", "4", "0", "1", ""});
+            }
+        }
+        return results;
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    [[nodiscard]] size_t count(std::string_view prefix) const {
+        return static_cast<size_t>(std::ranges::count_if(executed, [&](const std::string& sql) { return sql.find(prefix) != std::string::npos; }));
+    }
+
+    static std::string timestamp(int seconds) { return std::format("2024-01-01 {:02}:{:02}:{:02}.000", seconds / 3600, seconds / 60 % 60, seconds % 60); }
+
+    std::string database = "Sales";
+    std::vector<Object> objects;
+    std::vector<std::string> executed;
+};
+
+}  // namespace
+
+class SchemaCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        driver->objects = {
+            {.id = 1, .schema = "dbo", .name = "Users", .type = "U", .modified = 5},
+            {.id = 2, .schema = "dbo", .name = "Orders", .type = "U", .modified = 6},
+            {.id = 3, .schema = "report", .name = "Daily", .type = "V", .modified = 10},  // Newest: re-read by every diff (>=)
+            {.id = 4, .schema = "dbo", .name = "trg_orders", .type = "TR", .parent = 2, .modified = 8},
+        };
+    }
+
+    /// Cached fragment of `table`, counting the loads
+    std::string columns(std::string_view table) {
+        return cache.fragment("c1", driver, table, SchemaCache::Fragment::Columns, [&] {
+            ++loads;
+            return std::format("[\"{}#{}\"]", table, loads);
+        });
+    }
+
+    std::shared_ptr<CatalogDriver> driver = std::make_shared<CatalogDriver>();
+    SchemaCache cache{std::chrono::milliseconds{0}};
+    int loads = 0;
+};
+
+TEST_F(SchemaCacheTest, ServesTheTableListFromMemory) {
+    const auto first = cache.tables("c1", driver);
+    EXPECT_EQ(first, R"([{"schema":"dbo","name":"Orders","type":"BASE TABLE","comment":""},{"schema":"dbo","name":"Users","type":"BASE TABLE","comment":""},)"
+                     R"({"schema":"report","name":"Daily","type":"VIEW","comment":""}])");
+    EXPECT_EQ(cache.tables("c1", driver), first);
+    EXPECT_EQ(driver->count("CASE o.type WHEN 'U'"), 1u);  // Unchanged probe: no second list query
+    EXPECT_EQ(driver->count("SELECT DB_NAME()"), 2u);
+}
+
+TEST_F(SchemaCacheTest, FragmentsLoadOncePerTableRegardlessOfSpelling) {
+    EXPECT_EQ(columns("dbo.Users"), R"(["dbo.Users#1"])");
+    EXPECT_EQ(columns("Users"), R"(["dbo.Users#1"])");
+    EXPECT_EQ(columns("[dbo].[users]"), R"(["dbo.Users#1"])");
+    EXPECT_EQ(columns("report.Daily"), R"(["report.Daily#2"])");
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(cache.stats().hits, 2u);
+}
+
+TEST_F(SchemaCacheTest, OnlyChangedObjectsAreReloaded) {
+    (void)columns("dbo.Users");
+    (void)columns("dbo.Orders");
+    (void)cache.tables("c1", driver);
+
+    // ALTER TABLE Users, and a trigger on Orders changed: both tables' fragments go, nothing else is re-read in full
+    driver->objects[0].modified = 20;
+    driver->objects[0].name = "Customers";
+    driver->objects[3].modified = 20;
+    EXPECT_EQ(columns("dbo.Customers"), R"(["dbo.Customers#3"])");
+    EXPECT_EQ(columns("dbo.Orders"), R"(["dbo.Orders#4"])");
+    EXPECT_EQ(cache.tables("c1", driver).find("Users"), std::string::npos);
+    EXPECT_EQ(driver->count("o.object_id IN (1,3)"), 1u);  // Daily sat on the previous probe's tick
+    EXPECT_EQ(cache.stats().fullReloads, 1u);
+
+    // Untouched since: served from memory again
+    EXPECT_EQ(columns("dbo.Orders"), R"(["dbo.Orders#4"])");
+    EXPECT_EQ(loads, 4);
+}
+
+TEST_F(SchemaCacheTest, DropsReloadTheList) {
+    (void)columns("dbo.Users");
+    (void)columns("dbo.Orders");
+    driver->objects.erase(driver->objects.begin());  // DROP TABLE Users
+
+    (void)columns("dbo.Orders");
+    EXPECT_EQ(cache.tables("c1", driver).find("Users"), std::string::npos);
+    EXPECT_EQ(cache.stats().fullReloads, 2u);
+    EXPECT_EQ(loads, 2);  // Orders kept its columns
+}
+
+TEST_F(SchemaCacheTest, RefreshAndDatabaseSwitchStartOver) {
+    (void)columns("dbo.Users");
+    (void)columns("dbo.Users");
+    EXPECT_EQ(loads, 1);
+
+    (void)cache.fragment("c1", driver, "dbo.Users", SchemaCache::Fragment::Columns, [&] { return std::to_string(++loads); }, true);
+    EXPECT_EQ(loads, 2);
+
+    driver->database = "Archive";
+    (void)columns("dbo.Users");
+    EXPECT_EQ(loads, 3);
+}
+
+TEST_F(SchemaCacheTest, SnapshotSeedsFragmentsInOneBatch) {
+    const auto snapshot = cache.snapshot("c1", driver);
+    EXPECT_NE(snapshot.find(R"("name":"Users","type":"BASE TABLE","comment":"","columns":[{"name":"id","type":"int","size":4)"), std::string::npos);
+    EXPECT_EQ(driver->count("SET NOCOUNT ON"), 1u);
+
+    // Every table's columns and indexes are already there
+    (void)columns("dbo.Users");
+    (void)columns("report.Daily");
+    EXPECT_EQ(cache.fragment("c1", driver, "dbo.Orders", SchemaCache::Fragment::Indexes, [] { return std::string("loaded"); }), "[]");
+    EXPECT_EQ(loads, 0);
+    EXPECT_EQ(cache.snapshot("c1", driver), snapshot);
+    EXPECT_EQ(driver->count("SET NOCOUNT ON"), 1u);
+
+    // After an ALTER only the changed tables are read again
+    driver->objects[1].modified = 20;
+    (void)cache.snapshot("c1", driver);
+    EXPECT_EQ(driver->count("SET NOCOUNT ON"), 2u);
+    EXPECT_NE(driver->executed.back().find("o.object_id IN (2,3)"), std::string::npos);
+    EXPECT_EQ(cache.stats().bulkLoads, 2u);
+}
+
+TEST_F(SchemaCacheTest, PrefetchWarmsExpandedTablesFirst) {
+    cache.prefetch("c1", driver, {"conn_7-dbo-Orders", "conn_7-tables"}, [] { return false; });
+
+    // Databases, the table list, the expanded table alone, then everything else
+    std::vector<std::string> steps;
+    for (const auto& sql : driver->executed) {
+        if (sql.starts_with("SELECT name FROM sys.databases")) {
+            steps.emplace_back("databases");
+        } else if (sql.find("CASE o.type WHEN 'U'") != std::string::npos && sql.find("SET NOCOUNT ON") == std::string::npos) {
+            steps.emplace_back("tables");
+        } else if (sql.find("SET NOCOUNT ON") != std::string::npos) {
+            steps.emplace_back(sql.find("o.object_id IN (2)") != std::string::npos ? "expanded" : sql.find("o.object_id IN (1,3)") != std::string::npos ? "rest" : "other");
+        }
+    }
+    EXPECT_EQ(steps, (std::vector<std::string>{"databases", "tables", "expanded", "rest"}));
+    EXPECT_EQ(cache.databases("c1", driver), R"(["master","Sales"])");
+
+    (void)columns("dbo.Users");
+    (void)columns("dbo.Orders");
+    EXPECT_EQ(loads, 0);
+    EXPECT_EQ(driver->count("SELECT name FROM sys.databases"), 1u);
+}
+
+TEST_F(SchemaCacheTest, PrefetchStopsBetweenSteps) {
+    int polls = 0;
+    cache.prefetch("c1", driver, {}, [&] { return ++polls > 1; });
+    EXPECT_EQ(driver->count("SET NOCOUNT ON"), 0u);
+    (void)columns("dbo.Users");
+    EXPECT_EQ(loads, 1);
+}
+
+TEST_F(SchemaCacheTest, NameIndexFollowsChanges) {
+    const auto find = [&](std::string_view pattern) {
+        std::vector<std::string> found;
+        cache.names("c1", driver, [&](const ObjectNameIndex& names) {
+            for (const auto& result : names.search(pattern)) {
+                found.push_back(std::format("{}:{}", result.objectType, result.objectName));
+            }
+        });
+        return found;
+    };
+
+    EXPECT_EQ(find("user"), std::vector<std::string>{"TABLE:Users"});
+    EXPECT_EQ(find("dai"), std::vector<std::string>{"VIEW:Daily"});
+    EXPECT_EQ(find("id").size(), 3u);  // Every table's "id" column
+    EXPECT_EQ(driver->count("SET NOCOUNT ON"), 1u);
+
+    // Renamed: only the changed tables are read again
+    driver->objects[0].modified = 20;
+    driver->objects[0].name = "Customers";
+    EXPECT_TRUE(find("user").empty());
+    EXPECT_EQ(find("customer"), std::vector<std::string>{"TABLE:Customers"});
+    EXPECT_EQ(driver->count("SET NOCOUNT ON"), 2u);
+
+    // Dropped, then a procedure created
+    driver->objects.erase(driver->objects.begin() + 1);
+    EXPECT_TRUE(find("orders").empty());
+    driver->objects.push_back({.id = 5, .schema = "dbo", .name = "usp_Orders", .type = "P", .modified = 30});
+    EXPECT_EQ(find("orders"), std::vector<std::string>{"PROCEDURE:usp_Orders"});
+    EXPECT_EQ(find("id").size(), 2u);
+}
+
+TEST_F(SchemaCacheTest, UnknownTablesBypassTheCache) {
+    (void)columns("dbo.Missing");
+    (void)columns("dbo.Missing");
+    EXPECT_EQ(loads, 2);
+}
+
+TEST_F(SchemaCacheTest, EntryDiesWithItsDriver) {
+    (void)columns("dbo.Users");
+    driver = std::make_shared<CatalogDriver>();  // Reconnected under the same id
+    SetUp();
+    (void)columns("dbo.Users");
+    EXPECT_EQ(loads, 2);
+}
+
+}  // namespace test
+}  // namespace velocitydb
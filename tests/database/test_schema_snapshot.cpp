@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "database/schema_snapshot.h"
+#include "interfaces/parsers/er_model.h"
+
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet rows(std::vector<std::vector<std::string>> values) {
+    ResultSet result;
+    const size_t width = values.empty() ? 1 : values.front().size();
+    for (size_t col = 0; col < width; ++col) {
+        result.columns.push_back({.name = std::format("c{}", col), .type = "NVARCHAR"});
+        result.columnData.emplace_back(ColumnDataType::Text);
+    }
+    for (auto& row : values) {
+        result.appendRow(std::move(row));
+    }
+    return result;
+}
+
+/// Replays the seven result sets of the introspection batch
+class BatchDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view) override { return {}; }
+    std::vector<ResultSet> executeMultiple(std::string_view sql) override {
+        ++batches;
+        lastSql = sql;
+        return results;
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::vector<ResultSet> results;
+    std::string lastSql;
+    int batches = 0;
+};
+
+}  // namespace
+
+class SchemaSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        driver.results.push_back(rows({{"10", "dbo", "Users", "BASE TABLE", "People"}, {"20", "dbo", "Orders", "BASE TABLE", ""}, {"30", "dbo", "ActiveUsers", "VIEW", ""}}));
+        driver.results.push_back(rows({{"10", "id", "int", "4", "0", "1", "", "10", "0"},
+                                       {"10", "name", "nvarchar", "200", "1", "0", "Display \"name\"", "0", "0"},
+                                       {"20", "id", "int", "4", "0", "1", "", "10", "0"},
+                                       {"20", "user_id", "int", "4", "0", "0", "", "10", "0"},
+                                       {"30", "id", "int", "4", "0", "0", "", "10", "0"},
+                                       {"99", "orphan", "int", "4", "0", "0", "", "10", "0"}}));  // Not a listed table: dropped
+        driver.results.push_back(rows({{"10", "1", "PK_Users", "CLUSTERED", "1", "1"}, {"20", "1", "PK_Orders", "CLUSTERED", "1", "1"}, {"20", "2", "IX_Orders_User", "NONCLUSTERED", "0", "0"}}));
+        driver.results.push_back(rows({{"10", "1", "id"}, {"20", "1", "id"}, {"20", "2", "user_id"}, {"20", "2", "id"}}));
+        driver.results.push_back(rows({{"500", "20", "10", "FK_Orders_Users", "dbo.Orders", "dbo.Users", "CASCADE", "NO_ACTION"}}));
+        driver.results.push_back(rows({{"500", "user_id", "id"}}));
+        driver.results.push_back(rows({{"20", "trg_orders", "AFTER", "INSERT,UPDATE", "1", "CREATE TRIGGER trg_orders ..."}}));
+    }
+
+    BatchDriver driver;
+};
+
+TEST_F(SchemaSnapshotTest, OneBatchFillsEveryTable) {
+    auto snapshot = SchemaSnapshot::load(driver);
+    EXPECT_EQ(driver.batches, 1);
+    EXPECT_EQ(driver.lastSql.find("{scope}"), std::string::npos);
+    EXPECT_EQ(driver.lastSql.find("object_id IN ("), std::string::npos);
+
+    ASSERT_EQ(snapshot.tables.size(), 3u);
+    EXPECT_EQ(snapshot.columns.size(), 5u);
+    const auto& users = snapshot.tables[0];
+    const auto& orders = snapshot.tables[1];
+    const auto& view = snapshot.tables[2];
+
+    // Same payloads as the per-table getColumns/getIndexes/... handlers
+    EXPECT_EQ(snapshot.columnsJson(users), R"([{"name":"id","type":"int","size":4,"nullable":false,"isPrimaryKey":true,"comment":""},)"
+                                           R"({"name":"name","type":"nvarchar","size":200,"nullable":true,"isPrimaryKey":false,"comment":"Display \"name\""}])");
+    EXPECT_EQ(snapshot.indexesJson(orders), R"([{"name":"PK_Orders","type":"CLUSTERED","isUnique":true,"isPrimaryKey":true,"columns":["id"]},)"
+                                            R"({"name":"IX_Orders_User","type":"NONCLUSTERED","isUnique":false,"isPrimaryKey":false,"columns":["user_id","id"]}])");
+    EXPECT_EQ(snapshot.foreignKeysJson(orders), R"([{"name":"FK_Orders_Users","columns":["user_id"],"referencedTable":"dbo.Users","referencedColumns":["id"],"onDelete":"CASCADE","onUpdate":"NO_ACTION"}])");
+    EXPECT_EQ(snapshot.referencingForeignKeysJson(users),
+              R"([{"name":"FK_Orders_Users","referencingTable":"dbo.Orders","referencingColumns":["user_id"],"columns":["id"],"onDelete":"CASCADE","onUpdate":"NO_ACTION"}])");
+    EXPECT_EQ(snapshot.triggersJson(orders), R"([{"name":"trg_orders","type":"AFTER","events":["INSERT","UPDATE"],"isEnabled":true,"definition":"CREATE TRIGGER trg_orders ..."}])");
+
+    EXPECT_EQ(snapshot.columnsJson(view), R"([{"name":"id","type":"int","size":4,"nullable":false,"isPrimaryKey":false,"comment":""}])");
+    EXPECT_EQ(snapshot.indexesJson(view), "[]");
+    EXPECT_EQ(snapshot.foreignKeysJson(users), "[]");
+    EXPECT_EQ(snapshot.triggersJson(users), "[]");
+}
+
+TEST_F(SchemaSnapshotTest, ScopesEveryQueryToTheRequestedObjects) {
+    const std::vector<int64_t> ids = {10, 20};
+    (void)SchemaSnapshot::load(driver, &ids);
+    EXPECT_EQ(driver.lastSql.find("{"), std::string::npos);
+
+    size_t scoped = 0;
+    for (auto at = driver.lastSql.find("o.object_id IN (10,20)"); at != std::string::npos; at = driver.lastSql.find("o.object_id IN (10,20)", at + 1)) {
+        ++scoped;
+    }
+    EXPECT_EQ(scoped, 5u);  // Tables, columns, indexes, index columns, triggers
+    EXPECT_NE(driver.lastSql.find("fk.referenced_object_id IN (10,20)"), std::string::npos);
+}
+
+TEST_F(SchemaSnapshotTest, RejectsAnIncompleteBatch) {
+    driver.results.pop_back();
+    EXPECT_THROW((void)SchemaSnapshot::load(driver), std::runtime_error);
+}
+
+TEST_F(SchemaSnapshotTest, SerializedSnapshotReadsBackIdentically) {
+    auto snapshot = SchemaSnapshot::load(driver);
+    auto restored = SchemaSnapshot::deserialize(snapshot.serialize());
+
+    ASSERT_EQ(restored.tables.size(), snapshot.tables.size());
+    for (size_t i = 0; i < snapshot.tables.size(); ++i) {
+        const auto& table = restored.tables[i];
+        EXPECT_EQ(table.objectId, snapshot.tables[i].objectId);
+        EXPECT_EQ(table.name, snapshot.tables[i].name);
+        EXPECT_EQ(restored.columnsJson(table), snapshot.columnsJson(snapshot.tables[i]));
+        EXPECT_EQ(restored.indexesJson(table), snapshot.indexesJson(snapshot.tables[i]));
+        EXPECT_EQ(restored.foreignKeysJson(table), snapshot.foreignKeysJson(snapshot.tables[i]));
+        EXPECT_EQ(restored.referencingForeignKeysJson(table), snapshot.referencingForeignKeysJson(snapshot.tables[i]));
+        EXPECT_EQ(restored.triggersJson(table), snapshot.triggersJson(snapshot.tables[i]));
+    }
+    EXPECT_EQ(restored.columns[0].precision, 10);
+}
+
+TEST_F(SchemaSnapshotTest, RejectsDamagedSerializedSnapshots) {
+    const auto bytes = SchemaSnapshot::load(driver).serialize();
+    EXPECT_THROW((void)SchemaSnapshot::deserialize("not a snapshot"), std::runtime_error);
+    EXPECT_THROW((void)SchemaSnapshot::deserialize(std::string_view(bytes).substr(0, bytes.size() - 1)), std::runtime_error);
+
+    auto flipped = bytes;
+    flipped[flipped.size() / 2] = static_cast<char>(~flipped[flipped.size() / 2]);
+    try {
+        auto restored = SchemaSnapshot::deserialize(flipped);
+        // A flip inside a string survives; every range must still be inside its array
+        for (const auto& table : restored.tables) {
+            EXPECT_LE(table.columns.end, restored.columns.size());
+        }
+    } catch (const std::runtime_error&) {
+    }
+}
+
+TEST_F(SchemaSnapshotTest, BaseTablesBecomeAnERModel) {
+    const auto snapshot = SchemaSnapshot::load(driver);
+    const auto model = snapshot.toERModel();
+
+    ASSERT_EQ(model.tables.size(), 2u);  // The view is left out
+    const auto& users = model.tables[0];
+    const auto& orders = model.tables[1];
+    EXPECT_EQ(users.name, "Users");
+    EXPECT_EQ(users.comment, "People");
+    ASSERT_EQ(users.columns.size(), 2u);
+    EXPECT_EQ(users.columns[0].type, "INT");
+    EXPECT_TRUE(users.columns[0].isPrimaryKey);
+    EXPECT_EQ(users.columns[1].type, "NVARCHAR(100)");
+    EXPECT_EQ(users.columns[1].size, 100);
+    EXPECT_TRUE(users.indexes.empty());  // The primary key is a column flag, not a diagram index
+    ASSERT_EQ(orders.indexes.size(), 1u);
+    EXPECT_EQ(orders.indexes[0].columns, (std::vector<std::string>{"user_id", "id"}));
+
+    ASSERT_EQ(model.relations.size(), 1u);
+    EXPECT_EQ(model.relations[0].name, "FK_Orders_Users");
+    EXPECT_EQ(model.relations[0].parentTable, "Users");
+    EXPECT_EQ(model.relations[0].childTable, "Orders");
+    EXPECT_EQ(model.relations[0].parentColumn, "id");
+    EXPECT_EQ(model.relations[0].childColumn, "user_id");
+    EXPECT_EQ(model.relations[0].cardinality, "1:N");
+
+    // Read back as a diagram, every column declares the same type
+    const auto roundTrip = SchemaSnapshot::fromERModel(model);
+    ASSERT_EQ(roundTrip.columns.size(), 4u);
+    for (size_t i = 0; i < roundTrip.columns.size(); ++i) {
+        EXPECT_EQ(SchemaSnapshot::declaredType(roundTrip.columns[i]), SchemaSnapshot::declaredType(snapshot.columns[i]));
+        EXPECT_EQ(roundTrip.columns[i].nullable, snapshot.columns[i].nullable);
+    }
+    EXPECT_EQ(roundTrip.foreignKeys.size(), 1u);
+}
+
+TEST_F(SchemaSnapshotTest, KeyOverAUniqueIndexIsOneToOne) {
+    driver.results[2] = rows({{"10", "1", "PK_Users", "CLUSTERED", "1", "1"}, {"20", "1", "PK_Orders", "CLUSTERED", "1", "1"}, {"20", "2", "UX_Orders_User", "NONCLUSTERED", "1", "0"}});
+    driver.results[3] = rows({{"10", "1", "id"}, {"20", "1", "id"}, {"20", "2", "user_id"}});
+    const auto model = SchemaSnapshot::load(driver).toERModel();
+    ASSERT_EQ(model.relations.size(), 1u);
+    EXPECT_EQ(model.relations[0].cardinality, "1:1");
+}
+
+TEST(SchemaSnapshotERModelTest, DiagramBecomesTablesKeysAndIndexes) {
+    ERModel model;
+    model.tables.push_back({.name = "Users",
+                            .columns = {{.name = "id", .type = "INT", .nullable = false, .isPrimaryKey = true}, {.name = "name", .type = "VARCHAR", .size = 50}},
+                            .indexes = {{.name = "IX_Users_Name", .columns = {"name"}, .isUnique = true}}});
+    model.tables.push_back({.name = "sales.Orders",
+                            .columns = {{.name = "id", .type = "BIGINT", .isPrimaryKey = true}, {.name = "user_id", .type = "INT"}, {.name = "total", .type = "DECIMAL", .size = 10, .scale = 2}}});
+    model.relations.push_back({.parentTable = "Users", .childTable = "sales.Orders", .parentColumn = "id", .childColumn = "user_id"});
+
+    auto snapshot = SchemaSnapshot::fromERModel(model);
+    ASSERT_EQ(snapshot.tables.size(), 2u);
+    EXPECT_EQ(snapshot.tables[0].schema, "dbo");
+    EXPECT_EQ(snapshot.tables[1].schema, "sales");
+    EXPECT_EQ(snapshot.columnsJson(snapshot.tables[0]), R"([{"name":"id","type":"int","size":0,"nullable":false,"isPrimaryKey":true,"comment":""},)"
+                                                        R"({"name":"name","type":"nvarchar","size":100,"nullable":true,"isPrimaryKey":false,"comment":""}])");
+    EXPECT_EQ(snapshot.indexesJson(snapshot.tables[0]), R"([{"name":"PK_Users","type":"CLUSTERED","isUnique":true,"isPrimaryKey":true,"columns":["id"]},)"
+                                                        R"({"name":"IX_Users_Name","type":"NONCLUSTERED","isUnique":true,"isPrimaryKey":false,"columns":["name"]}])");
+    EXPECT_EQ(snapshot.foreignKeysJson(snapshot.tables[1]),
+              R"([{"name":"FK_Orders_Users","columns":["user_id"],"referencedTable":"dbo.Users","referencedColumns":["id"],"onDelete":"NO_ACTION","onUpdate":"NO_ACTION"}])");
+    EXPECT_EQ(snapshot.tables[0].referencedBy.size(), 1u);
+
+    const auto& total = snapshot.columns[snapshot.tables[1].columns.begin + 2];
+    EXPECT_EQ(total.type, "decimal");
+    EXPECT_EQ(total.precision, 10);
+    EXPECT_EQ(total.scale, 2);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include "database/server_health_monitor.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet rows(size_t columnCount, std::initializer_list<std::vector<std::string>> values) {
+    ResultSet result;
+    for (size_t i = 0; i < columnCount; ++i) {
+        result.columns.push_back({.name = "c" + std::to_string(i)});
+    }
+    for (const auto& row : values) {
+        result.appendRow(row);
+    }
+    return result;
+}
+
+std::vector<std::string> request(std::string session, std::string blockedBy, std::string start, std::string waitType, std::string elapsed) {
+    return {std::move(session), std::move(blockedBy), std::move(start), "suspended", "SELECT", std::move(waitType), "100", std::move(elapsed), "5", "10", "0",
+            "Sales", "app", "web01", "api", "SELECT * FROM Orders"};
+}
+
+std::vector<ResultSet> batch(std::initializer_list<std::vector<std::string>> requests, std::initializer_list<std::vector<std::string>> idle,
+                             std::initializer_list<std::vector<std::string>> waits) {
+    std::vector<ResultSet> results;
+    results.push_back(rows(16, requests));
+    results.push_back(rows(5, idle));
+    results.push_back(rows(4, waits));
+    return results;
+}
+
+/// Answers every batch with the same DMV rows, or fails once told to
+class FakeDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override { disconnected = true; }
+    bool isConnected() const noexcept override { return !disconnected; }
+    ResultSet execute(std::string_view sql) override {
+        std::lock_guard lock(mutex);
+        statements.emplace_back(sql);
+        return {};
+    }
+    std::vector<ResultSet> executeMultiple(std::string_view) override {
+        if (fail) {
+            throw std::runtime_error("VIEW SERVER STATE permission was denied");
+        }
+        ++polls;
+        return batch({request("52", "0", "2026-01-01 10:00:00.000", "", "10")}, {}, {{"LCK_M_X", "1", "50", "1"}});
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::atomic<bool> fail = false;
+    std::atomic<bool> disconnected = false;
+    std::atomic<int> polls = 0;
+    std::mutex mutex;
+    std::vector<std::string> statements;
+};
+
+template <typename Predicate>
+bool eventually(Predicate predicate) {
+    for (int i = 0; i < 400 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return predicate();
+}
+
+}  // namespace
+
+TEST(ServerHealthMonitorTest, FollowsBlockingChainsAndDiffsWaitCounters) {
+    ServerHealthMonitor::WaitTotals totals;
+    auto first = ServerHealthMonitor::parseSample(batch({}, {}, {{"LCK_M_X", "4", "1000", "10"}, {"PAGEIOLATCH_SH", "10", "200", "5"}}), totals, 10);
+    EXPECT_TRUE(first.waits.empty());
+    EXPECT_EQ(totals.size(), 2);
+
+    // 60 is blocked by 55, which is blocked by idle session 51; 61 waits on 60 through the same chain
+    auto second = ServerHealthMonitor::parseSample(batch({request("55", "51", "t1", "LCK_M_X", "900"), request("60", "55", "t2", "LCK_M_S", "800"),
+                                                          request("60", "55", "t2", "LCK_M_S", "800"), request("61", "60", "t3", "LCK_M_S", "700")},
+                                                         {{"51", "etl", "batch01", "loader", "1"}},
+                                                         {{"LCK_M_X", "6", "1600", "12"}, {"PAGEIOLATCH_SH", "12", "150", "6"}, {"CXPACKET", "1", "30", "0"}}),
+                                                   totals, 1);
+    ASSERT_EQ(second.requests.size(), 3);
+    ASSERT_EQ(second.blockers.size(), 1);
+    EXPECT_EQ(second.blockers[0].sessionId, 51);
+    EXPECT_TRUE(second.blockers[0].idle);
+    EXPECT_EQ(second.blockers[0].loginName, "etl");
+    EXPECT_EQ(second.blockers[0].openTransactions, 1);
+    EXPECT_EQ(second.blockers[0].blockedSessions, 3);
+
+    // The PAGEIOLATCH counters went down (cleared), so they count from zero; only the top wait is kept
+    ASSERT_EQ(second.waits.size(), 1);
+    EXPECT_EQ(second.waits[0].waitType, "LCK_M_X");
+    EXPECT_EQ(second.waits[0].waitTimeMs, 600);
+    EXPECT_EQ(second.waits[0].waitingTasks, 2);
+    EXPECT_EQ(second.waits[0].signalWaitMs, 2);
+    EXPECT_EQ(totals.at("CXPACKET").waitTimeMs, 30);
+}
+
+TEST(ServerHealthMonitorTest, DeltasCarryOnlyWhatChanged) {
+    ServerHealthMonitor::WaitTotals totals;
+    auto previous = ServerHealthMonitor::parseSample(batch({request("52", "0", "t1", "", "10"), request("53", "0", "t1", "", "10"), request("54", "0", "t1", "", "10")}, {}, {}),
+                                                     totals, 10);
+    auto current = ServerHealthMonitor::parseSample(batch({request("52", "0", "t1", "", "10"), request("53", "0", "t1", "", "20"), request("54", "0", "t2", "", "10"),
+                                                           request("56", "0", "t1", "", "10")},
+                                                          {}, {}),
+                                                    totals, 10);
+    current.sequence = 2;
+
+    const auto delta = ServerHealthMonitor::deltaJson("c1", &previous, current);
+    EXPECT_NE(delta.find(R"("updated":[{"sessionId":53,)"), std::string::npos);
+    EXPECT_NE(delta.find(R"("removed":[])"), std::string::npos);
+    EXPECT_EQ(delta.find(R"("sessionId":52)"), std::string::npos);
+    EXPECT_NE(delta.find(R"({"sessionId":54,"blockedBy":0,"startTime":"t2")"), std::string::npos);
+    EXPECT_NE(delta.find(R"({"sessionId":56,)"), std::string::npos);
+    EXPECT_EQ(delta.find("\"blockers\""), std::string::npos);
+
+    const auto gone = ServerHealthMonitor::deltaJson("c1", &current, previous);
+    EXPECT_NE(gone.find(R"("removed":[56])"), std::string::npos);
+    EXPECT_NE(ServerHealthMonitor::deltaJson("c1", nullptr, current).find(R"("blockers":[])"), std::string::npos);
+}
+
+TEST(ServerHealthMonitorTest, SamplesIntoTheRingBufferUntilStopped) {
+    std::mutex mutex;
+    std::vector<std::string> events;
+    ServerHealthMonitor monitor([&](const std::string& event) {
+        std::lock_guard lock(mutex);
+        events.push_back(event);
+    });
+    auto driver = std::make_shared<FakeDriver>();
+    monitor.start("c1", driver, {.interval = std::chrono::milliseconds(1), .topWaits = 5, .history = 2});
+
+    ASSERT_TRUE(eventually([&] { return driver->polls >= 3; }));
+    auto history = monitor.history("c1", 0);
+    ASSERT_TRUE(history);
+    EXPECT_TRUE(history->running);
+    ASSERT_EQ(history->samples.size(), 2);
+    EXPECT_GE(history->samples[0].sequence, 2);
+    EXPECT_EQ(history->samples[1].requests.size(), 1);
+    EXPECT_EQ(monitor.history("c1", history->samples[1].sequence)->samples.size(), 0);
+    {
+        std::lock_guard lock(driver->mutex);
+        ASSERT_FALSE(driver->statements.empty());
+        EXPECT_EQ(driver->statements[0], ServerHealthMonitor::sessionSetup());
+    }
+
+    driver->fail = true;
+    ASSERT_TRUE(eventually([&] { return !monitor.history("c1", 0)->running; }));
+    EXPECT_NE(monitor.history("c1", 0)->error.find("VIEW SERVER STATE"), std::string::npos);
+    EXPECT_TRUE(driver->disconnected);
+    {
+        std::lock_guard lock(mutex);
+        EXPECT_NE(events.back().find(R"("error":)"), std::string::npos);
+    }
+
+    EXPECT_TRUE(monitor.stop("c1"));
+    EXPECT_FALSE(monitor.history("c1", 0));
+    EXPECT_FALSE(monitor.stop("c1"));
+}
+
+}  // namespace test
+}  // namespace velocitydb
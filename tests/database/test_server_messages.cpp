@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "database/server_messages.h"
+#include "utils/json_utils.h"
+
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+TEST(ServerMessagesTest, KeepsEveryRecordInArrivalOrder) {
+    ServerMessages messages;
+    messages.add(u"[Microsoft][ODBC Driver 18 for SQL Server][SQL Server]Rows staged: 42", 0, u"01000");
+    messages.add("[Microsoft][ODBC Driver 18 for SQL Server][SQL Server]Warning: Null value is eliminated by an aggregate or other SET operation.", 8153, "01003");
+    messages.add(std::u16string(u"日本語のメッセージ"), 50000, u"01000");
+
+    ASSERT_EQ(messages.size(), 3);
+    EXPECT_EQ(messages[0].text, "Rows staged: 42");
+    EXPECT_EQ(messages[0].sqlState, "01000");
+    EXPECT_EQ(messages[1].nativeError, 8153);
+    EXPECT_EQ(messages[1].text.substr(0, 8), "Warning:");
+    EXPECT_EQ(messages[2].text, "日本語のメッセージ");
+    EXPECT_TRUE(messages.statistics().empty());
+
+    // clear() keeps the arena for the next statement
+    const size_t bytes = messages.memoryBytes();
+    messages.clear();
+    EXPECT_TRUE(messages.empty());
+    EXPECT_EQ(messages.memoryBytes(), bytes);
+}
+
+TEST(ServerMessagesTest, ParsesStatisticsIoAndTime) {
+    ServerMessages messages;
+    messages.add("SQL Server parse and compile time: \n   CPU time = 3 ms, elapsed time = 5 ms.", 3613, "01000");
+    messages.add("Table 'Orders'. Scan count 1, logical reads 120, physical reads 2, page server reads 0, read-ahead reads 96, page server read-ahead reads 0, "
+                 "lob logical reads 4, lob physical reads 1, lob page server reads 0, lob page server read-ahead reads 0.",
+                 3615, "01000");
+    messages.add("Table 'Worktable'. Scan count 0, logical reads 0, physical reads 0, read-ahead reads 0, lob logical reads 0, lob physical reads 0, lob read-ahead reads 0.", 3615,
+                 "01000");
+    messages.add("Table 'Sales.Fact'. Segment reads 4, segment skipped 2.", 3615, "01000");
+    messages.add("\n SQL Server Execution Times:\n   CPU time = 16 ms,  elapsed time = 21 ms.", 3612, "01000");
+    messages.add("Table 'Orders'. Scan count 2, logical reads 30, physical reads 0, read-ahead reads 0, lob logical reads 0, lob physical reads 0, lob read-ahead reads 0.", 3615,
+                 "01000");
+    messages.add("\n SQL Server Execution Times:\n   CPU time = 4 ms,  elapsed time = 4 ms.", 3612, "01000");
+    messages.add("Table 'Orders' is not a statistics line", 0, "01000");
+
+    EXPECT_EQ(messages.size(), 8);
+    const auto& statistics = messages.statistics();
+    ASSERT_EQ(statistics.tables.size(), 2);
+    const auto& orders = statistics.tables[0];
+    EXPECT_EQ(orders.table, "Orders");
+    EXPECT_EQ(orders.scanCount, 3);
+    EXPECT_EQ(orders.logicalReads, 150);
+    EXPECT_EQ(orders.physicalReads, 2);
+    EXPECT_EQ(orders.readAheadReads, 96);
+    EXPECT_EQ(orders.lobLogicalReads, 4);
+    EXPECT_EQ(orders.lobPhysicalReads, 1);
+    EXPECT_EQ(statistics.tables[1].table, "Worktable");
+    EXPECT_TRUE(statistics.hasTime);
+    EXPECT_DOUBLE_EQ(statistics.cpuTimeMs, 20.0);
+    EXPECT_DOUBLE_EQ(statistics.elapsedTimeMs, 25.0);
+    EXPECT_DOUBLE_EQ(statistics.compileCpuTimeMs, 3.0);
+    EXPECT_DOUBLE_EQ(statistics.compileElapsedTimeMs, 5.0);
+}
+
+TEST(ServerMessagesTest, CapsRecordsButStillCountsStatistics) {
+    ServerMessages messages;
+    for (size_t i = 0; i < ServerMessages::MAX_MESSAGES + 2; ++i) {
+        messages.add("Table 't'. Scan count 1, logical reads 1, physical reads 0.", 3615, "01000");
+    }
+    EXPECT_EQ(messages.size(), ServerMessages::MAX_MESSAGES);
+    EXPECT_EQ(messages.dropped(), 2);
+    ASSERT_EQ(messages.statistics().tables.size(), 1);
+    EXPECT_EQ(messages.statistics().tables[0].logicalReads, ServerMessages::MAX_MESSAGES + 2);
+
+    // Appending carries records, the dropped count and the statistics
+    ServerMessages combined;
+    combined.add("before", 0, "01000");
+    combined.append(messages);
+    EXPECT_EQ(combined.size(), ServerMessages::MAX_MESSAGES);
+    EXPECT_EQ(combined.dropped(), 3);
+    EXPECT_EQ(combined[1].text, messages[0].text);
+    EXPECT_EQ(combined.statistics().tables[0].logicalReads, ServerMessages::MAX_MESSAGES + 2);
+}
+
+TEST(ServerMessagesTest, SerializesNextToExecutionTime) {
+    ResultSet result;
+    result.executionTimeMs = 12.5;
+    EXPECT_EQ(JsonUtils::serializeResultSet(result, false).find("\"messages\""), std::string::npos);
+
+    result.messages.add("say \"hi\"", 0, "01000");
+    result.messages.add("Table 'Orders'. Scan count 1, logical reads 7, physical reads 0, read-ahead reads 0, lob logical reads 0, lob physical reads 0.", 3615, "01000");
+    const auto json = JsonUtils::serializeResultSet(result, false);
+    EXPECT_NE(json.find(R"("messages":[{"text":"say \"hi\"","code":0,"state":"01000"},)"), std::string::npos);
+    EXPECT_NE(json.find(R"("statistics":{"tables":[{"table":"Orders","scanCount":1,"logicalReads":7,)"), std::string::npos);
+    EXPECT_EQ(json.find("cpuTimeMs"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace velocitydb
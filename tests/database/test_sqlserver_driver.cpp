@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include "database/sqlserver_driver.h"
 
+#include <atomic>
+#include <format>
+#include <stdexcept>
+#include <string>
+
 namespace velocitydb {
 namespace test {
 
@@ -58,8 +63,72 @@ TEST_F(SQLServerDriverTest, DISABLED_ExecutesSimpleQuery) {
 
     EXPECT_EQ(result.columns.size(), 1);
     EXPECT_EQ(result.columns[0].name, "Value");
-    EXPECT_EQ(result.rows.size(), 1);
-    EXPECT_EQ(result.rows[0].values[0], "1");
+    EXPECT_EQ(result.rowCount(), 1);
+    EXPECT_EQ(result.cellText(0, 0), "1");
+
+    driver.disconnect();
+}
+
+TEST_F(SQLServerDriverTest, PreparedWithoutConnectionThrows) {
+    SQLServerDriver driver;
+    EXPECT_THROW((void)driver.executePrepared("SELECT ?", {int64_t{1}}), std::runtime_error);
+    EXPECT_EQ(driver.preparedStatementCount(), 0u);
+}
+
+TEST_F(SQLServerDriverTest, DISABLED_ExecutesPreparedQueriesFromCache) {
+    SQLServerDriver driver;
+    std::string connectionString =
+        "Driver={ODBC Driver 17 for SQL Server};"
+        "Server=localhost;"
+        "Database=master;"
+        "Trusted_Connection=yes;";
+
+    ASSERT_TRUE(driver.connect(connectionString));
+
+    constexpr std::string_view sql = "SELECT ? AS Name, ? AS Number, ? AS Missing";
+    for (int64_t i = 0; i < 3; ++i) {
+        auto result = driver.executePrepared(sql, {std::string("O'Brien"), i, std::monostate{}});
+        ASSERT_EQ(result.rowCount(), 1);
+        EXPECT_EQ(result.cellText(0, 0), "O'Brien");
+        EXPECT_EQ(result.cellText(0, 1), std::to_string(i));
+        EXPECT_TRUE(result.isNull(0, 2));
+    }
+    EXPECT_EQ(driver.preparedStatementCount(), 1u);
+
+    for (size_t i = 0; i <= SQLServerDriver::PREPARED_CACHE_CAPACITY; ++i) {
+        [[maybe_unused]] auto _ = driver.executePrepared(std::format("SELECT {}", i));
+    }
+    EXPECT_EQ(driver.preparedStatementCount(), SQLServerDriver::PREPARED_CACHE_CAPACITY);
+
+    driver.disconnect();
+    EXPECT_EQ(driver.preparedStatementCount(), 0u);
+}
+
+TEST_F(SQLServerDriverTest, DISABLED_StopsAtMaxRowsAndOnCancelToken) {
+    SQLServerDriver driver;
+    std::string connectionString =
+        "Driver={ODBC Driver 17 for SQL Server};"
+        "Server=localhost;"
+        "Database=master;"
+        "Trusted_Connection=yes;";
+
+    ASSERT_TRUE(driver.connect(connectionString));
+
+    constexpr std::string_view sql = "SELECT TOP (50) object_id FROM sys.all_objects";
+    auto limited = driver.execute(sql, {.maxRows = 10});
+    EXPECT_EQ(limited.rowCount(), 10u);
+    EXPECT_TRUE(limited.truncated);
+
+    auto whole = driver.execute(sql, {.maxRows = 50});
+    EXPECT_EQ(whole.rowCount(), 50u);
+    EXPECT_FALSE(whole.truncated);
+
+    // The limit stays with the call: the reused statement handle fetches everything again
+    EXPECT_EQ(driver.execute(sql).rowCount(), 50u);
+
+    std::atomic<bool> cancelRequested{true};
+    EXPECT_THROW((void)driver.execute(sql, {.cancelRequested = &cancelRequested}), std::runtime_error);
+    EXPECT_EQ(driver.execute("SELECT 1").rowCount(), 1u);
 
     driver.disconnect();
 }
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "database/statement_waves.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Records when each statement started and ended, and how many ran at once
+struct WaveRecorder {
+    std::mutex mutex;
+    std::vector<std::string> events;
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+
+    void run(size_t index, bool concurrent) {
+        int now = ++running;
+        for (int seen = peak.load(); now > seen && !peak.compare_exchange_weak(seen, now);) {
+        }
+        {
+            std::lock_guard lock(mutex);
+            events.push_back(std::format("start {}{}", index, concurrent ? " concurrent" : ""));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        {
+            std::lock_guard lock(mutex);
+            events.push_back(std::format("end {}", index));
+        }
+        --running;
+    }
+
+    [[nodiscard]] size_t position(const std::string& event) const {
+        return static_cast<size_t>(std::ranges::find(events, event) - events.begin());
+    }
+};
+
+}  // namespace
+
+TEST(StatementWavesTest, ReadsRunConcurrentlyBetweenBarriers) {
+    const std::vector<std::string> statements = {"SELECT 1", "SELECT 2", "SELECT 3", "USE tempdb", "SELECT 4", "SELECT 5", "UPDATE t SET a = 1", "SELECT 6"};
+    WaveRecorder recorder;
+    size_t failedIndex = 0;
+    runStatementWaves(statements, 4, [&](size_t index, bool concurrent) { recorder.run(index, concurrent); }, failedIndex);
+
+    ASSERT_EQ(recorder.events.size(), statements.size() * 2);
+    EXPECT_EQ(recorder.peak.load(), 3);
+    // Barriers wait for every earlier statement and hold back every later one
+    for (size_t before : {0, 1, 2}) {
+        EXPECT_LT(recorder.position(std::format("end {}", before)), recorder.position("start 3"));
+    }
+    EXPECT_LT(recorder.position("end 3"), recorder.position("start 4 concurrent"));
+    EXPECT_LT(recorder.position("end 5"), recorder.position("start 6"));
+    EXPECT_LT(recorder.position("end 6"), recorder.position("start 7"));
+    // A lone read after the last barrier has nothing to overlap with, so it stays on the calling thread
+    EXPECT_LT(recorder.position("start 7"), recorder.events.size());
+}
+
+TEST(StatementWavesTest, SerialWhenParallelismIsOne) {
+    const std::vector<std::string> statements = {"SELECT 1", "SELECT 2", "SELECT 3"};
+    WaveRecorder recorder;
+    size_t failedIndex = 0;
+    runStatementWaves(statements, 1, [&](size_t index, bool concurrent) { recorder.run(index, concurrent); }, failedIndex);
+
+    EXPECT_EQ(recorder.peak.load(), 1);
+    EXPECT_EQ(recorder.events, (std::vector<std::string>{"start 0", "end 0", "start 1", "end 1", "start 2", "end 2"}));
+}
+
+TEST(StatementWavesTest, TempTableReadsAreBarriers) {
+    const std::vector<std::string> statements = {"SELECT * FROM #work", "SELECT * FROM #work"};
+    WaveRecorder recorder;
+    size_t failedIndex = 0;
+    runStatementWaves(statements, 4, [&](size_t index, bool concurrent) { recorder.run(index, concurrent); }, failedIndex);
+
+    EXPECT_EQ(recorder.peak.load(), 1);
+}
+
+TEST(StatementWavesTest, EarliestFailureIsReportedAndStopsTheScript) {
+    const std::vector<std::string> statements = {"SELECT 1", "SELECT 2", "SELECT 3", "SELECT 4", "DELETE FROM t"};
+    std::atomic<bool> barrierRan{false};
+    size_t failedIndex = 0;
+    auto run = [&](size_t index, bool) {
+        if (index == 4) {
+            barrierRan = true;
+        }
+        if (index == 1 || index == 2) {
+            // The later failure finishes first; the earlier statement's error still wins
+            std::this_thread::sleep_for(std::chrono::milliseconds(index == 1 ? 30 : 0));
+            throw std::runtime_error(std::format("failed {}", index));
+        }
+    };
+
+    try {
+        runStatementWaves(statements, 4, run, failedIndex);
+        FAIL() << "expected the failure to propagate";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "failed 1");
+    }
+    EXPECT_EQ(failedIndex, 1u);
+    EXPECT_FALSE(barrierRan.load());
+}
+
+TEST(StatementWavesTest, BarrierFailureNamesItsIndex) {
+    const std::vector<std::string> statements = {"SELECT 1", "INSERT INTO t VALUES (1)", "SELECT 2"};
+    size_t failedIndex = 0;
+    auto run = [](size_t index, bool) {
+        if (index == 1) {
+            throw std::runtime_error("constraint");
+        }
+    };
+
+    EXPECT_THROW(runStatementWaves(statements, 4, run, failedIndex), std::runtime_error);
+    EXPECT_EQ(failedIndex, 1u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
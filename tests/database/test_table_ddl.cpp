@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "database/table_ddl.h"
+
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet rows(size_t width, std::vector<std::vector<std::string>> values) {
+    ResultSet result;
+    for (size_t col = 0; col < width; ++col) {
+        result.columns.push_back({.name = std::format("c{}", col), .type = "NVARCHAR"});
+        result.columnData.emplace_back(ColumnDataType::Text);
+    }
+    for (auto& row : values) {
+        result.appendRow(std::move(row));
+    }
+    return result;
+}
+
+/// Replays the three result sets of the DDL batch
+class BatchDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view) override { return {}; }
+    std::vector<ResultSet> executeMultiple(std::string_view sql) override {
+        ++batches;
+        lastSql = sql;
+        return results;
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::vector<ResultSet> results;
+    std::string lastSql;
+    int batches = 0;
+};
+
+}  // namespace
+
+TEST(TableDDLTest, OneBatchAssemblesEveryPart) {
+    BatchDriver driver;
+    driver.results.push_back(rows(11, {{"id", "int", "4", "10", "0", "0", "", "1", "1", "1", ""},
+                                       {"code", "nvarchar", "40", "0", "0", "0", "(N'x')", "0", "", "", ""},
+                                       {"user_id", "int", "4", "10", "0", "1", "", "0", "", "", ""},
+                                       {"total", "decimal", "9", "10", "2", "1", "", "0", "", "", ""},
+                                       {"doubled", "decimal", "9", "10", "2", "1", "", "0", "", "", "([total]*(2))"}}));
+    driver.results.push_back(rows(10, {{"1", "PK_Orders", "CLUSTERED", "1", "1", "0", "", "id", "0", "0"},
+                                       {"2", "UQ_Orders_Code", "NONCLUSTERED", "0", "1", "1", "", "code", "0", "0"},
+                                       {"3", "IX_Orders_User", "NONCLUSTERED", "0", "0", "0", "([user_id] IS NOT NULL)", "user_id", "0", "0"},
+                                       {"3", "IX_Orders_User", "NONCLUSTERED", "0", "0", "0", "([user_id] IS NOT NULL)", "total", "1", "0"},
+                                       {"3", "IX_Orders_User", "NONCLUSTERED", "0", "0", "0", "([user_id] IS NOT NULL)", "code", "0", "1"}}));
+    driver.results.push_back(rows(7, {{"FK_Orders_Users", "dbo", "Users", "user_id", "id", "CASCADE", "NO_ACTION"}}));
+
+    const auto ddl = loadTableDDL(driver, "sales", "Or'ders");
+    EXPECT_EQ(driver.batches, 1);
+    EXPECT_NE(driver.lastSql.find("OBJECT_ID(N'[sales].[Or''ders]')"), std::string::npos);
+    EXPECT_EQ(ddl,
+              "CREATE TABLE [sales].[Or'ders] (\n"
+              "    [id] INT IDENTITY(1,1) NOT NULL,\n"
+              "    [code] NVARCHAR(20) NOT NULL DEFAULT (N'x'),\n"
+              "    [user_id] INT NULL,\n"
+              "    [total] DECIMAL(10,2) NULL,\n"
+              "    [doubled] AS ([total]*(2)),\n"
+              "    CONSTRAINT [PK_Orders] PRIMARY KEY CLUSTERED ([id]),\n"
+              "    CONSTRAINT [UQ_Orders_Code] UNIQUE NONCLUSTERED ([code])\n"
+              ");\n\n"
+              "CREATE NONCLUSTERED INDEX [IX_Orders_User] ON [sales].[Or'ders] ([user_id], [total] DESC) INCLUDE ([code]) WHERE ([user_id] IS NOT NULL);\n\n"
+              "ALTER TABLE [sales].[Or'ders] ADD CONSTRAINT [FK_Orders_Users] FOREIGN KEY ([user_id]) REFERENCES [dbo].[Users] ([id]) ON DELETE CASCADE;");
+}
+
+TEST(TableDDLTest, MissingTableThrows) {
+    BatchDriver driver;
+    driver.results = {rows(11, {}), rows(10, {}), rows(7, {})};
+    EXPECT_THROW((void)loadTableDDL(driver, "dbo", "Nope"), std::runtime_error);
+
+    driver.results.pop_back();
+    EXPECT_THROW((void)loadTableDDL(driver, "dbo", "Nope"), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include "database/table_tail_monitor.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet rows(std::vector<std::string> names, std::initializer_list<std::vector<std::string>> values) {
+    ResultSet result;
+    for (auto& name : names) {
+        result.columns.push_back({.name = std::move(name)});
+    }
+    for (const auto& row : values) {
+        result.appendRow(row);
+    }
+    return result;
+}
+
+std::vector<ResultSet> detect(std::string tracked, std::initializer_list<std::vector<std::string>> primaryKey, std::initializer_list<std::vector<std::string>> identity) {
+    std::vector<ResultSet> results;
+    results.push_back(rows({"object_id", "tracked"}, {{"1234", std::move(tracked)}}));
+    results.push_back(rows({"name", "type_name"}, primaryKey));
+    results.push_back(rows({"name"}, identity));
+    return results;
+}
+
+/// A table with an identity key that gains one row after the snapshot
+class FakeDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override { disconnected = true; }
+    bool isConnected() const noexcept override { return !disconnected; }
+    ResultSet execute(std::string_view) override { return {}; }
+    std::vector<ResultSet> executeMultiple(std::string_view sql) override {
+        std::lock_guard lock(mutex);
+        statements.emplace_back(sql);
+        if (sql.find("sys.change_tracking_tables") != std::string_view::npos) {
+            return detect("0", {{"id", "int"}}, {{"id"}});
+        }
+        std::vector<ResultSet> results;
+        if (sql.find("DESC") != std::string_view::npos) {
+            results.push_back(rows({"id", "name", "__tail_key"}, {{"2", "b", "2"}, {"1", "a", "1"}}));
+        } else if (++polls == 1) {
+            results.push_back(rows({"id", "name", "__tail_key"}, {{"3", "c", "3"}}));
+        } else {
+            results.push_back(rows({"id", "name", "__tail_key"}, {}));
+        }
+        return results;
+    }
+    StreamSummary executeStreaming(std::string_view, RowBatchSink&, size_t) override { return {}; }
+    void cancel() override {}
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    std::atomic<bool> disconnected = false;
+    std::atomic<int> polls = 0;
+    std::mutex mutex;
+    std::vector<std::string> statements;
+};
+
+template <typename Predicate>
+bool eventually(Predicate predicate) {
+    for (int i = 0; i < 400 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return predicate();
+}
+
+}  // namespace
+
+TEST(TableTailMonitorTest, PrefersChangeTrackingThenAMonotonicKey) {
+    auto tracked = TableTailMonitor::makePlan(detect("1", {{"region", "char"}, {"id", "uniqueidentifier"}}, {}), "[dbo].[Orders]", "");
+    ASSERT_TRUE(tracked);
+    EXPECT_EQ(tracked->mode, TableTailMonitor::Mode::ChangeTracking);
+    EXPECT_EQ(tracked->keyColumns, (std::vector<std::string>{"region", "id"}));
+
+    auto identity = TableTailMonitor::makePlan(detect("0", {{"code", "nvarchar"}}, {{"seq"}}), "[dbo].[Orders]", "");
+    ASSERT_TRUE(identity);
+    EXPECT_EQ(identity->mode, TableTailMonitor::Mode::Key);
+    EXPECT_EQ(identity->keyColumns, (std::vector<std::string>{"seq"}));
+
+    auto datedKey = TableTailMonitor::makePlan(detect("0", {{"logged_at", "datetime2"}}, {}), "[dbo].[Log]", "");
+    ASSERT_TRUE(datedKey);
+    EXPECT_EQ(datedKey->keyColumns, (std::vector<std::string>{"logged_at"}));
+
+    // An explicit key wins over Change Tracking
+    auto explicitKey = TableTailMonitor::makePlan(detect("1", {{"id", "int"}}, {}), "[dbo].[Orders]", "[created_at]");
+    ASSERT_TRUE(explicitKey);
+    EXPECT_EQ(explicitKey->mode, TableTailMonitor::Mode::Key);
+    EXPECT_EQ(explicitKey->keyColumns, (std::vector<std::string>{"created_at"}));
+
+    EXPECT_FALSE(TableTailMonitor::makePlan(detect("0", {{"id", "uniqueidentifier"}}, {}), "[dbo].[Orders]", ""));
+    auto missing = detect("0", {}, {});
+    missing[0] = rows({"object_id", "tracked"}, {});
+    EXPECT_FALSE(TableTailMonitor::makePlan(missing, "[dbo].[Nope]", ""));
+}
+
+TEST(TableTailMonitorTest, KeyModeReadsPastTheHighestKeySeen) {
+    const TableTailMonitor::Plan plan{.mode = TableTailMonitor::Mode::Key, .table = "[dbo].[Log]", .keyColumns = {"logged_at"}};
+    EXPECT_NE(TableTailMonitor::buildSnapshotQuery(plan, 50).find("TOP (50)"), std::string::npos);
+
+    TableTailMonitor::Cursor cursor;
+    std::vector<ResultSet> snapshot;
+    snapshot.push_back(rows({"logged_at", "message", "__tail_key"}, {{"2026-01-02 10:00:00", "b", "2026-01-02T10:00:00"}, {"2026-01-01 09:00:00", "a", "2026-01-01T09:00:00"}}));
+    auto shown = TableTailMonitor::parseSnapshot(snapshot, plan, cursor);
+    EXPECT_EQ(shown.columns.size(), 2);
+    EXPECT_EQ(shown.rowCount(), 2);
+    EXPECT_EQ(cursor.lastKey, "2026-01-02T10:00:00");
+
+    const auto query = TableTailMonitor::buildChangesQuery(plan, cursor, 10);
+    EXPECT_NE(query.find("WHERE [logged_at] > N'2026-01-02T10:00:00'"), std::string::npos);
+    EXPECT_NE(query.find("TOP (11)"), std::string::npos);
+    EXPECT_NE(query.find("ORDER BY [logged_at] ASC"), std::string::npos);
+
+    std::vector<ResultSet> polled;
+    polled.push_back(rows({"logged_at", "message", "__tail_key"}, {{"x", "c", "2026-01-03T08:00:00"}, {"y", "d", "2026-01-03T09:00:00"}}));
+    auto changes = TableTailMonitor::parseChanges(polled, plan, cursor, 10);
+    EXPECT_FALSE(changes.reset);
+    EXPECT_EQ(changes.inserted.rowCount(), 2);
+    EXPECT_EQ(changes.inserted.columns.size(), 2);
+    EXPECT_EQ(cursor.lastKey, "2026-01-03T09:00:00");
+
+    // More rows than a poll takes: start over from a snapshot, cursor untouched
+    EXPECT_TRUE(TableTailMonitor::parseChanges(polled, plan, cursor, 1).reset);
+    EXPECT_EQ(cursor.lastKey, "2026-01-03T09:00:00");
+}
+
+TEST(TableTailMonitorTest, ChangeTrackingSplitsOperationsAndAdvancesTheVersion) {
+    const TableTailMonitor::Plan plan{.mode = TableTailMonitor::Mode::ChangeTracking, .table = "[dbo].[Orders]", .keyColumns = {"id"}};
+    TableTailMonitor::Cursor cursor{.version = 40};
+    const auto query = TableTailMonitor::buildChangesQuery(plan, cursor, 100);
+    EXPECT_NE(query.find("CHANGETABLE(CHANGES [dbo].[Orders], 40)"), std::string::npos);
+    EXPECT_NE(query.find("t.[id] = ct.[id]"), std::string::npos);
+
+    std::vector<ResultSet> results;
+    results.push_back(rows({"version", "valid"}, {{"45", "1"}}));
+    results.push_back(rows({"id", "status", "__tail_operation", "__tail_key1"}, {{"7", "new", "I", "7"}, {"3", "paid", "U", "3"}, {"", "", "D", "5"}}));
+    auto changes = TableTailMonitor::parseChanges(results, plan, cursor, 100);
+    ASSERT_FALSE(changes.reset);
+    EXPECT_EQ(cursor.version, 45);
+    ASSERT_EQ(changes.inserted.rowCount(), 1);
+    EXPECT_EQ(changes.inserted.cellText(0, 1), "new");
+    ASSERT_EQ(changes.updated.rowCount(), 1);
+    EXPECT_EQ(changes.updated.cellText(0, 0), "3");
+    ASSERT_EQ(changes.deleted.rowCount(), 1);
+    ASSERT_EQ(changes.deleted.columns.size(), 1);
+    EXPECT_EQ(changes.deleted.columns[0].name, "id");
+    EXPECT_EQ(changes.deleted.cellText(0, 0), "5");
+
+    const auto json = TableTailMonitor::changesJson("tail_1", "c1", 2, changes);
+    EXPECT_NE(json.find(R"("tailId":"tail_1","connectionId":"c1","sequence":2)"), std::string::npos);
+    EXPECT_NE(json.find(R"("deleted":[["5"]])"), std::string::npos);
+
+    // The version fell out of retention: only the version row comes back
+    std::vector<ResultSet> expired;
+    expired.push_back(rows({"version", "valid"}, {{"90", "0"}}));
+    EXPECT_TRUE(TableTailMonitor::parseChanges(expired, plan, cursor, 100).reset);
+    EXPECT_EQ(cursor.version, 45);
+}
+
+TEST(TableTailMonitorTest, PushesTheSnapshotThenOnlyNewRows) {
+    std::mutex mutex;
+    std::vector<std::string> events;
+    TableTailMonitor monitor([&](const std::string& event) {
+        std::lock_guard lock(mutex);
+        events.push_back(event);
+    });
+    auto driver = std::make_shared<FakeDriver>();
+    const auto tailId = monitor.start("c1", "dbo.Events", driver, {.interval = std::chrono::milliseconds(1)});
+    EXPECT_EQ(tailId, "tail_1");
+
+    ASSERT_TRUE(eventually([&] { return driver->polls >= 3; }));
+    {
+        std::lock_guard lock(mutex);
+        ASSERT_EQ(events.size(), 2);
+        EXPECT_NE(events[0].find(R"("snapshot":true,"mode":"key","keyColumns":["id"])"), std::string::npos);
+        EXPECT_NE(events[0].find(R"("rows":[["2","b"],["1","a"]])"), std::string::npos);
+        EXPECT_NE(events[1].find(R"("inserted":[["3","c"]],"updated":[],"deleted":[])"), std::string::npos);
+    }
+    {
+        std::lock_guard lock(driver->mutex);
+        EXPECT_NE(driver->statements[0].find("OBJECT_ID(N'[dbo].[Events]')"), std::string::npos);
+        EXPECT_NE(driver->statements.back().find("WHERE [id] > N'3'"), std::string::npos);
+    }
+
+    EXPECT_TRUE(monitor.stop(tailId));
+    EXPECT_TRUE(driver->disconnected);
+    EXPECT_FALSE(monitor.stop(tailId));
+}
+
+}  // namespace test
+}  // namespace velocitydb
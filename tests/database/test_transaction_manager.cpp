@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "database/transaction_manager.h"
 
+#include <string>
+#include <vector>
+
 namespace velocitydb {
 namespace test {
 
@@ -38,5 +41,73 @@ TEST_F(TransactionManagerTest, RollbackWithoutTransactionThrows) {
     EXPECT_THROW(txManager.rollback(), std::runtime_error);
 }
 
+TEST_F(TransactionManagerTest, SavepointNeedsValidName) {
+    EXPECT_THROW(txManager.savepoint("bad name; DROP TABLE x"), std::runtime_error);
+    EXPECT_THROW(txManager.rollbackToSavepoint(""), std::runtime_error);
+    EXPECT_THROW(txManager.savepoint("before_import"), std::runtime_error);  // No driver
+}
+
+TEST_F(TransactionManagerTest, QueueRejectsEditsWithoutKeyOrValues) {
+    EXPECT_THROW(txManager.queueEdit({.kind = RowEdit::Kind::Update, .table = "Users", .values = {{"Name", "x"}}}), std::runtime_error);
+    EXPECT_THROW(txManager.queueEdit({.kind = RowEdit::Kind::Delete, .table = "Users"}), std::runtime_error);
+    EXPECT_THROW(txManager.queueEdit({.kind = RowEdit::Kind::Insert, .table = "Users"}), std::runtime_error);
+
+    txManager.queueEdit({.kind = RowEdit::Kind::Delete, .table = "Users", .key = {{"Id", "1"}}});
+    EXPECT_EQ(txManager.pendingEditCount(), 1u);
+    txManager.discardEdits();
+    EXPECT_EQ(txManager.pendingEditCount(), 0u);
+}
+
+TEST_F(TransactionManagerTest, EditBatchMergesConsecutiveInserts) {
+    std::vector<RowEdit> edits;
+    for (const char* name : {"Ann", "Bob", "O'Neil"}) {
+        edits.push_back({.kind = RowEdit::Kind::Insert, .schema = "dbo", .table = "Users", .values = {{"Name", name}, {"Note", std::nullopt}}});
+    }
+    edits.push_back({.kind = RowEdit::Kind::Update, .table = "Odd]Name", .values = {{"Name", "Cy"}}, .key = {{"Id", "7"}, {"Tag", std::nullopt}}});
+    edits.push_back({.kind = RowEdit::Kind::Delete, .schema = "dbo", .table = "Users", .key = {{"Id", "9"}}});
+
+    const auto sql = TransactionManager::buildEditBatch(edits, "");
+    EXPECT_NE(sql.find("BEGIN TRANSACTION;"), std::string::npos);
+    EXPECT_NE(sql.find("INSERT INTO [dbo].[Users] ([Name], [Note]) VALUES (N'Ann', NULL),\n(N'Bob', NULL),\n(N'O''Neil', NULL);"), std::string::npos);
+    EXPECT_NE(sql.find("UPDATE [Odd]]Name] SET [Name] = N'Cy' WHERE [Id] = N'7' AND [Tag] IS NULL;"), std::string::npos);
+    EXPECT_NE(sql.find("DELETE FROM [dbo].[Users] WHERE [Id] = N'9';"), std::string::npos);
+    EXPECT_NE(sql.find("COMMIT TRANSACTION;"), std::string::npos);
+    EXPECT_EQ(sql.find("INSERT INTO", sql.find("INSERT INTO") + 1), std::string::npos);  // One statement for all three rows
+    EXPECT_TRUE(sql.ends_with("SELECT @affected AS affected_rows;"));
+}
+
+TEST_F(TransactionManagerTest, EditBatchInsideTransactionUsesSavepoint) {
+    const std::vector<RowEdit> edits{{.kind = RowEdit::Kind::Delete, .table = "T", .key = {{"Id", "1"}}}};
+    const auto sql = TransactionManager::buildEditBatch(edits, "sp1");
+
+    EXPECT_NE(sql.find("SAVE TRANSACTION sp1;"), std::string::npos);
+    EXPECT_NE(sql.find("IF XACT_STATE() = 1 ROLLBACK TRANSACTION sp1;"), std::string::npos);
+    EXPECT_EQ(sql.find("BEGIN TRANSACTION"), std::string::npos);
+    EXPECT_EQ(sql.find("COMMIT"), std::string::npos);
+}
+
+TEST_F(TransactionManagerTest, PreparedEditsBindValuesThenKeyAndOutputTheStoredRow) {
+    const std::vector<std::string> columns{"Id", "Name"};
+
+    const RowEdit update{.kind = RowEdit::Kind::Update, .schema = "dbo", .table = "Users", .values = {{"Name", "Cy"}}, .key = {{"Id", "7"}, {"Tag", std::nullopt}}};
+    EXPECT_EQ(TransactionManager::buildPreparedEdit(update, columns),
+              "UPDATE [dbo].[Users] SET [Name] = ? OUTPUT inserted.[Id], inserted.[Name] WHERE [Id] = ? AND [Tag] IS NULL");
+
+    const RowEdit insert{.kind = RowEdit::Kind::Insert, .table = "Odd]Name", .values = {{"Name", "Ann"}, {"Note", std::nullopt}}};
+    EXPECT_EQ(TransactionManager::buildPreparedEdit(insert, {}), "INSERT INTO [Odd]]Name] ([Name], [Note]) OUTPUT inserted.* VALUES (?, ?)");
+
+    const RowEdit remove{.kind = RowEdit::Kind::Delete, .table = "T", .key = {{"A", "1"}, {"B", "2"}}};
+    EXPECT_EQ(TransactionManager::buildPreparedEdit(remove, columns), "DELETE FROM [T] OUTPUT deleted.[A], deleted.[B] WHERE [A] = ? AND [B] = ?");
+}
+
+TEST_F(TransactionManagerTest, EditBatchSplitsValuesListsAtServerLimit) {
+    std::vector<RowEdit> edits(1001, RowEdit{.kind = RowEdit::Kind::Insert, .table = "T", .values = {{"A", "1"}}});
+    const auto sql = TransactionManager::buildEditBatch(edits, "");
+
+    const auto second = sql.find("INSERT INTO", sql.find("INSERT INTO") + 1);
+    ASSERT_NE(second, std::string::npos);
+    EXPECT_EQ(sql.find("INSERT INTO", second + 1), std::string::npos);
+}
+
 }  // namespace test
 }  // namespace velocitydb
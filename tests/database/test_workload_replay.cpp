@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "database/workload_replay.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+/// Reports a fixed execution time per statement, fails on request, or hangs until cancelled
+class TimedDriver final : public IDatabaseDriver {
+public:
+    bool connect(std::string_view) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const noexcept override { return true; }
+    ResultSet execute(std::string_view) override { return {}; }
+    StreamSummary executeStreaming(std::string_view sql, RowBatchSink&, size_t) override {
+        {
+            std::lock_guard lock(m_mutex);
+            executed.emplace_back(sql);
+        }
+        if (sql.find("broken") != std::string_view::npos) {
+            throw std::runtime_error("Invalid object name 'broken'");
+        }
+        while (sql.find("hang") != std::string_view::npos && !m_cancelled) {
+            std::this_thread::sleep_for(5ms);
+        }
+        if (m_cancelled) {
+            throw std::runtime_error("Operation canceled");
+        }
+        return StreamSummary{.executionTimeMs = sql.find("Orders") != std::string_view::npos ? ordersMs : 10.0};
+    }
+    void cancel() override { m_cancelled = true; }
+    std::string getLastError() const override { return {}; }
+    DriverType getType() const noexcept override { return DriverType::SQLServer; }
+
+    double ordersMs = 10.0;
+    std::vector<std::string> executed;
+
+private:
+    std::mutex m_mutex;
+    std::atomic<bool> m_cancelled{false};
+};
+
+WorkloadReplay::Opener opener(std::shared_ptr<TimedDriver> driver) {
+    return [driver](std::string_view) -> std::expected<BroadcastSession, std::string> { return BroadcastSession{.driver = driver, .release = {}}; };
+}
+
+HistoryItem item(std::string sql, double executionTimeMs, std::chrono::system_clock::time_point timestamp, bool success = true) {
+    return HistoryItem{.sql = std::move(sql), .timestamp = timestamp, .executionTimeMs = executionTimeMs, .success = success};
+}
+
+}  // namespace
+
+TEST(LatencySummaryTest, UsesNearestRankPercentiles) {
+    std::vector<double> latencies{5, 1, 4, 2, 3, 6, 7, 8, 9, 10};
+    const auto summary = LatencySummary::of(latencies);
+    EXPECT_EQ(summary.count, 10);
+    EXPECT_DOUBLE_EQ(summary.minMs, 1);
+    EXPECT_DOUBLE_EQ(summary.meanMs, 5.5);
+    EXPECT_DOUBLE_EQ(summary.p50Ms, 5);
+    EXPECT_DOUBLE_EQ(summary.p95Ms, 10);
+    EXPECT_DOUBLE_EQ(summary.maxMs, 10);
+
+    std::vector<double> none;
+    EXPECT_EQ(LatencySummary::of(none).count, 0);
+}
+
+TEST(WorkloadReplayTest, SkipsWritesAndFailuresAndFlagsRegressedShapes) {
+    auto driver = std::make_shared<TimedDriver>();
+    driver->ordersMs = 40.0;
+    const auto t0 = std::chrono::system_clock::now();
+    std::vector<HistoryItem> items{
+        item("SELECT * FROM Orders WHERE id = 1", 10.0, t0),
+        item("SELECT name FROM Customers WHERE id = 7", 12.0, t0 + 1ms),
+        item("UPDATE Orders SET shipped = 1 WHERE id = 1", 3.0, t0 + 2ms),
+        item("SELECT * FROM Orders WHERE id = 2", 11.0, t0 + 3ms),
+        item("SELECT * FROM Missing", 1.0, t0 + 4ms, false),
+        item("SELECT * FROM broken", 2.0, t0 + 5ms),
+    };
+    WorkloadReplay replay(std::move(items), opener(driver), {.concurrency = 2, .speedFactor = 0.0});
+    replay.wait();
+
+    const auto progress = replay.progress();
+    EXPECT_TRUE(progress.done);
+    EXPECT_EQ(progress.total, 4);
+    EXPECT_EQ(progress.skipped, 2);
+    EXPECT_EQ(progress.completed, 4);
+    EXPECT_EQ(progress.failures, 1);
+    EXPECT_EQ(progress.replayed.count, 3);
+    EXPECT_EQ(driver->executed.size(), 4);
+
+    ASSERT_EQ(progress.shapes.size(), 3);
+    // Both Orders lookups share a shape and ran four times slower than recorded
+    const auto& orders = progress.shapes[0];
+    EXPECT_TRUE(orders.regressed);
+    EXPECT_EQ(orders.replayed.count, 2);
+    EXPECT_DOUBLE_EQ(orders.original.p95Ms, 11.0);
+    EXPECT_DOUBLE_EQ(orders.replayed.p95Ms, 40.0);
+    EXPECT_NEAR(orders.p95Ratio, 40.0 / 11.0, 1e-9);
+    for (size_t i = 1; i < progress.shapes.size(); ++i) {
+        EXPECT_FALSE(progress.shapes[i].regressed);
+    }
+    const auto broken = std::ranges::find_if(progress.shapes, [](const auto& shape) { return shape.failures > 0; });
+    ASSERT_NE(broken, progress.shapes.end());
+    EXPECT_NE(broken->lastError.find("broken"), std::string::npos);
+}
+
+TEST(WorkloadReplayTest, KeepsTheRecordedArrivalPatternScaledBySpeed) {
+    auto driver = std::make_shared<TimedDriver>();
+    const auto t0 = std::chrono::system_clock::now();
+    std::vector<HistoryItem> items{item("SELECT 2", 1.0, t0 + 400ms), item("SELECT 1", 1.0, t0)};
+    WorkloadReplay replay(std::move(items), opener(driver), {.concurrency = 2, .speedFactor = 4.0});
+    const auto started = std::chrono::steady_clock::now();
+    replay.wait();
+
+    // 400ms apart in the history, 100ms apart at four times the speed
+    EXPECT_GE(replay.endTime() - started, 90ms);
+    ASSERT_EQ(driver->executed.size(), 2);
+    EXPECT_EQ(driver->executed[0], "SELECT 1");
+}
+
+TEST(WorkloadReplayTest, CancelStopsRunningAndPendingQueries) {
+    auto driver = std::make_shared<TimedDriver>();
+    const auto t0 = std::chrono::system_clock::now();
+    std::vector<HistoryItem> items{item("SELECT * FROM hang", 1.0, t0), item("SELECT 1", 1.0, t0 + 5s)};
+    WorkloadReplay replay(std::move(items), opener(driver), {.concurrency = 2, .speedFactor = 1.0, .maxIdle = 10s});
+    std::this_thread::sleep_for(20ms);
+    replay.cancel();
+    replay.wait();
+
+    const auto progress = replay.progress();
+    EXPECT_TRUE(progress.cancelled);
+    EXPECT_EQ(progress.completed, 1);
+    EXPECT_EQ(progress.failures, 1);
+    EXPECT_EQ(driver->executed.size(), 1);
+}
+
+}  // namespace test
+}  // namespace velocitydb
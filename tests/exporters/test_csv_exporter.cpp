@@ -2,6 +2,7 @@
 #include "exporters/csv_exporter.h"
 #include <fstream>
 #include <filesystem>
+#include <iterator>
 
 namespace velocitydb {
 namespace test {
@@ -28,13 +29,8 @@ protected:
         col2.type = "VARCHAR";
         result.columns.push_back(col2);
 
-        ResultRow row1;
-        row1.values = {"1", "Alice"};
-        result.rows.push_back(row1);
-
-        ResultRow row2;
-        row2.values = {"2", "Bob"};
-        result.rows.push_back(row2);
+        result.appendRow({"1", "Alice"});
+        result.appendRow({"2", "Bob"});
 
         return result;
     }
@@ -109,9 +105,7 @@ TEST_F(CSVExporterTest, EscapesQuotes) {
     col.name = "text";
     data.columns.push_back(col);
 
-    ResultRow row;
-    row.values = {"He said \"Hello\""};
-    data.rows.push_back(row);
+    data.appendRow({"He said \"Hello\""});
 
     exporter.exportData(data, testFilePath);
 
@@ -131,9 +125,8 @@ TEST_F(CSVExporterTest, HandlesNullValues) {
     col.name = "value";
     data.columns.push_back(col);
 
-    ResultRow row;
-    row.values = {""};  // Empty string represents NULL
-    data.rows.push_back(row);
+    data.columnData.emplace_back(ColumnDataType::Text);
+    data.columnData[0].appendNull();
 
     ExportOptions options;
     options.nullValue = "NULL";
@@ -175,5 +168,71 @@ TEST_F(CSVExporterTest, HandlesCustomDelimiter) {
     file.close();
 }
 
+TEST_F(CSVExporterTest, WritesBatchesIncrementally) {
+    auto first = createTestResultSet();
+    ResultSet second;
+    second.columns = first.columns;
+    second.appendRow({"3", "Carol"});
+
+    ExportOptions options;
+    options.encoding = "";
+    options.quoteStrings = false;
+    options.lineEnding = "\n";
+
+    ASSERT_TRUE(exporter.beginExport(first.columns, testFilePath, options));
+    EXPECT_TRUE(exporter.writeBatch(first));
+    EXPECT_TRUE(exporter.writeBatch(second));
+    EXPECT_EQ(exporter.rowsWritten(), 3);
+    EXPECT_EQ(exporter.bytesWritten(), 30);
+    EXPECT_TRUE(exporter.finishExport());
+
+    std::ifstream file(testFilePath, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "id,name\n1,Alice\n2,Bob\n3,Carol\n");
+}
+
+TEST_F(CSVExporterTest, QuotesOnlyFieldsThatNeedIt) {
+    ResultSet data;
+    data.columns.push_back({.name = "a"});
+    data.columns.push_back({.name = "b"});
+    // Values longer than 16 bytes exercise the vectorized scan
+    data.appendRow({"plain value without specials", "comma inside, a long field value"});
+    data.appendRow({"line one\nline two of the field", "a \"quoted\" word in a long field"});
+    data.appendRow({"semi;colon", "x"});
+
+    ExportOptions options;
+    options.encoding = "";
+    options.quoteStrings = false;
+    options.lineEnding = "\n";
+    ASSERT_TRUE(exporter.exportData(data, testFilePath, options));
+
+    std::ifstream file(testFilePath, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content,
+              "a,b\n"
+              "plain value without specials,\"comma inside, a long field value\"\n"
+              "\"line one\nline two of the field\",\"a \"\"quoted\"\" word in a long field\"\n"
+              "semi;colon,x\n");
+}
+
+TEST_F(CSVExporterTest, QuotesMultiCharacterDelimiter) {
+    ResultSet data;
+    data.columns.push_back({.name = "a"});
+    data.columns.push_back({.name = "b"});
+    data.appendRow({"a|b", "a||b"});
+
+    ExportOptions options;
+    options.encoding = "";
+    options.includeHeader = false;
+    options.quoteStrings = false;
+    options.delimiter = "||";
+    options.lineEnding = "\n";
+    ASSERT_TRUE(exporter.exportData(data, testFilePath, options));
+
+    std::ifstream file(testFilePath, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "a|b||\"a||b\"\n");
+}
+
 }  // namespace test
 }  // namespace velocitydb
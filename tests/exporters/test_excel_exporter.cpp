@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "exporters/excel_exporter.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace velocitydb {
+namespace test {
+
+class ExcelExporterTest : public ::testing::Test {
+protected:
+    ExcelExporter exporter;
+    std::string testFilePath = "test_export.xlsx";
+
+    void TearDown() override {
+        std::filesystem::remove(testFilePath);
+    }
+
+    std::string readFile() {
+        std::ifstream file(testFilePath, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+};
+
+TEST_F(ExcelExporterTest, ConvertsDatesToExcelSerials) {
+    EXPECT_DOUBLE_EQ(*ExcelExporter::toExcelSerial({.year = 2024, .month = 2, .day = 29}, true), 45351.0);
+    EXPECT_DOUBLE_EQ(*ExcelExporter::toExcelSerial({.year = 1900, .month = 3, .day = 1, .hour = 12}, true), 61.5);
+    EXPECT_DOUBLE_EQ(*ExcelExporter::toExcelSerial({.hour = 6}, false), 0.25);
+    EXPECT_FALSE(ExcelExporter::toExcelSerial({.year = 1899, .month = 1, .day = 1}, true).has_value());
+}
+
+TEST_F(ExcelExporterTest, WritesZipPackageWithSharedStrings) {
+    ResultSet data;
+    data.columns.push_back({.name = "id", .type = "INT"});
+    data.columns.push_back({.name = "name", .type = "NVARCHAR"});
+    data.appendRow({"1", "same"});
+    data.appendRow({"2", "same"});
+
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    EXPECT_EQ(exporter.rowsWritten(), 2);
+
+    // Entries are stored uncompressed, so the part contents are searchable in the archive
+    auto content = readFile();
+    EXPECT_EQ(content.substr(0, 2), "PK");
+    EXPECT_NE(content.find(R"(<c r="A2"><v>1</v></c><c r="B2" t="s"><v>0</v></c>)"), std::string::npos);
+    EXPECT_NE(content.find(R"(<c r="B3" t="s"><v>0</v></c>)"), std::string::npos);
+    EXPECT_NE(content.find(R"(count="2" uniqueCount="1")"), std::string::npos);
+    EXPECT_NE(content.find("[Content_Types].xml"), std::string::npos);
+}
+
+TEST_F(ExcelExporterTest, RollsOverToNewSheetAtRowLimit) {
+    ResultSet data;
+    data.columns.push_back({.name = "n", .type = "INT"});
+    data.columnData.emplace_back(ColumnDataType::Int64);
+    // With the header row, the last data row no longer fits on the first sheet
+    for (size_t i = 0; i < ExcelExporter::MAX_SHEET_ROWS; ++i) {
+        data.columnData[0].appendInt64(static_cast<int64_t>(i));
+    }
+
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    EXPECT_EQ(exporter.sheetCount(), 2);
+    EXPECT_NE(readFile().find(R"(<sheet name="Sheet1_2" sheetId="2" r:id="rId2"/>)"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include "headless_export.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(HeadlessExportOptionsTest, OnlyTheExportFlagSkipsTheWindow) {
+    EXPECT_FALSE(HeadlessExportOptions::requested(std::vector<std::string>{}));
+    EXPECT_FALSE(HeadlessExportOptions::requested(std::vector<std::string>{"--profile", "nightly"}));
+    EXPECT_TRUE(HeadlessExportOptions::requested(std::vector<std::string>{"--profile", "nightly", "--export"}));
+}
+
+TEST(HeadlessExportOptionsTest, InfersTheFormatFromTheOutputPath) {
+    std::vector<std::string> args{"--export", "--profile", "nightly", "--query-file", "orders.sql", "--out", "C:\\exports\\orders.jsonl.gz"};
+    auto options = HeadlessExportOptions::parse(args);
+    ASSERT_TRUE(options) << options.error();
+    EXPECT_EQ(options->profile, "nightly");
+    EXPECT_EQ(options->queryFile, "orders.sql");
+    EXPECT_EQ(options->format, "ndjson");
+    EXPECT_EQ(options->compression, "gzip");
+
+    args = {"--export", "--server", "db01,1433", "--database", "Sales", "--sql", "SELECT 1", "--out", "a.parquet", "--no-header"};
+    options = HeadlessExportOptions::parse(args);
+    ASSERT_TRUE(options) << options.error();
+    EXPECT_EQ(options->format, "parquet");
+    EXPECT_TRUE(options->compression.empty());
+    EXPECT_FALSE(options->includeHeader);
+
+    // An explicit format wins over the extension
+    args = {"--export", "--profile", "p", "--sql", "SELECT 1", "--out", "rows.txt", "--format", "csv", "--delimiter", "\t"};
+    options = HeadlessExportOptions::parse(args);
+    ASSERT_TRUE(options) << options.error();
+    EXPECT_EQ(options->format, "csv");
+    EXPECT_EQ(options->delimiter, "\t");
+}
+
+TEST(HeadlessExportOptionsTest, RejectsIncompleteCommandLines) {
+    const std::vector<std::vector<std::string>> invalid{
+        {"--export", "--profile", "p", "--sql", "SELECT 1"},                                       // No output
+        {"--export", "--profile", "p", "--out", "a.csv"},                                          // No query
+        {"--export", "--profile", "p", "--sql", "SELECT 1", "--query-file", "q.sql", "--out", "a.csv"},  // Two queries
+        {"--export", "--server", "db01", "--sql", "SELECT 1", "--out", "a.csv"},                   // No database
+        {"--export", "--profile", "p", "--sql", "SELECT 1", "--out", "a.txt"},                     // Unknown format
+        {"--export", "--profile", "p", "--sql", "SELECT 1", "--out", "a.csv", "--verbose"},        // Unknown option
+        {"--export", "--profile", "p", "--sql", "SELECT 1", "--out"},                              // Missing value
+    };
+    for (const auto& args : invalid) {
+        auto options = HeadlessExportOptions::parse(args);
+        EXPECT_FALSE(options) << args.back();
+        if (!options) {
+            EXPECT_FALSE(options.error().empty());
+        }
+    }
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "exporters/json_exporter.h"
+#include "utils/crc32.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class JSONExporterTest : public ::testing::Test {
+protected:
+    JSONExporter exporter;
+    std::string testFilePath = "test_export.json";
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    ResultSet createTestResultSet() {
+        ResultSet result;
+        result.columns = {{.name = "id", .type = "INT"}, {.name = "price", .type = "money"}, {.name = "active", .type = "BIT"}, {.name = "code", .type = "VARCHAR"}};
+        result.appendRow({"1", ".5000", "1", "007"});
+        result.appendRow({"2", "-12.25", "0", "say \"hi\""});
+        return result;
+    }
+
+    std::string readFile() const {
+        std::ifstream file(testFilePath, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+};
+
+TEST_F(JSONExporterTest, WritesValuesByColumnType) {
+    exporter.setPrettyPrint(false);
+    ASSERT_TRUE(exporter.exportData(createTestResultSet(), testFilePath));
+
+    EXPECT_EQ(readFile(), R"([{"id":1,"price":0.5000,"active":true,"code":"007"},{"id":2,"price":-12.25,"active":false,"code":"say \"hi\""}])");
+}
+
+TEST_F(JSONExporterTest, WritesNDJSONAcrossBatches) {
+    auto data = createTestResultSet();
+    exporter.setArrayFormat(false);
+    ASSERT_TRUE(exporter.beginExport(data.columns, testFilePath, ExportOptions()));
+    ASSERT_TRUE(exporter.writeBatch(data));
+    ASSERT_TRUE(exporter.writeBatch(data));
+    ASSERT_TRUE(exporter.finishExport());
+
+    const auto text = readFile();
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), 4);
+    EXPECT_TRUE(text.starts_with(R"({"id":1,"price":0.5000,"active":true,"code":"007"})"
+                                 "\n"));
+}
+
+TEST_F(JSONExporterTest, GzipOutputCarriesChecksumOfTheJSON) {
+    ResultSet data;
+    data.columns = {{.name = "id", .type = "INT"}, {.name = "name", .type = "NVARCHAR"}};
+    for (int i = 0; i < 20000; ++i) {
+        data.appendRow({std::to_string(i), "customer " + std::to_string(i % 100)});
+    }
+
+    exporter.setArrayFormat(false);
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    const auto plain = readFile();
+
+    exporter.setGzip(true);
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    const auto compressed = readFile();
+
+    ASSERT_GT(compressed.size(), 18u);
+    EXPECT_EQ(compressed.substr(0, 3), "\x1f\x8b\x08");
+    EXPECT_LT(compressed.size(), plain.size() / 3);
+    auto le32 = [&](size_t offset) {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i) {
+            value = (value << 8) | static_cast<unsigned char>(compressed[offset + i]);
+        }
+        return value;
+    };
+    EXPECT_EQ(le32(compressed.size() - 8), updateCrc32(0, plain));
+    EXPECT_EQ(le32(compressed.size() - 4), plain.size());
+}
+
+TEST(GzipWriterTest, StoresIncompressibleBlocks) {
+    std::string block;
+    uint32_t state = 1;
+    for (int i = 0; i < 100000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        block += static_cast<char>(state >> 24);
+    }
+    std::string out;
+    GzipWriter::deflateBlock(out, {}, block);
+    EXPECT_LE(out.size(), block.size() + 16);
+}
+
+}  // namespace test
+}  // namespace velocitydb
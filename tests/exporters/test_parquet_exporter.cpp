@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "exporters/parquet_exporter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class ParquetExporterTest : public ::testing::Test {
+protected:
+    ParquetExporter exporter;
+    std::string testFilePath = "test_export.parquet";
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    std::string readFile() {
+        std::ifstream file(testFilePath, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+};
+
+TEST_F(ParquetExporterTest, MapsSqlTypesToParquetTypes) {
+    using Type = ParquetExporter::Type;
+    using Logical = ParquetExporter::Logical;
+    EXPECT_EQ(ParquetExporter::columnSpecFor("INT").type, Type::Int32);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("bigint").type, Type::Int64);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("TINYINT").logical, Logical::UInt8);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("REAL").type, Type::Float);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("FLOAT").type, Type::Double);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("BIT").type, Type::Boolean);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("DATE").logical, Logical::Date);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("DATETIME2").logical, Logical::TimestampMicros);
+    // Exact decimals stay text rather than going through double
+    EXPECT_EQ(ParquetExporter::columnSpecFor("DECIMAL").type, Type::ByteArray);
+    EXPECT_EQ(ParquetExporter::columnSpecFor("NVARCHAR").logical, Logical::String);
+}
+
+TEST_F(ParquetExporterTest, WritesFramedFileWithDictionaryPages) {
+    ResultSet data;
+    data.columns.push_back({.name = "id", .type = "BIGINT"});
+    data.columns.push_back({.name = "city", .type = "NVARCHAR"});
+    data.columns.push_back({.name = "price", .type = "FLOAT"});
+    data.columnData.emplace_back(ColumnDataType::Int64);
+    data.columnData.emplace_back(ColumnDataType::Text);
+    data.columnData.emplace_back(ColumnDataType::Double);
+    for (int64_t i = 0; i < 1000; ++i) {
+        data.columnData[0].appendInt64(i);
+        data.columnData[1].appendText(i % 2 == 0 ? "Osaka" : "Sapporo");
+        if (i % 10 == 0) {
+            data.columnData[2].appendNull();
+        } else {
+            data.columnData[2].appendDouble(static_cast<double>(i) / 4);
+        }
+    }
+    exporter.setCompression(false);
+
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    EXPECT_EQ(exporter.rowsWritten(), 1000);
+    EXPECT_EQ(exporter.rowGroupCount(), 1);
+
+    auto content = readFile();
+    ASSERT_GT(content.size(), 12);
+    EXPECT_EQ(content.substr(0, 4), "PAR1");
+    EXPECT_EQ(content.substr(content.size() - 4), "PAR1");
+    uint32_t footerBytes = 0;
+    std::memcpy(&footerBytes, content.data() + content.size() - 8, sizeof(footerBytes));
+    ASSERT_LT(footerBytes, content.size() - 12);
+    const auto footer = std::string_view(content).substr(content.size() - 8 - footerBytes, footerBytes);
+    EXPECT_NE(footer.find("city"), std::string_view::npos);
+    EXPECT_NE(footer.find("VelocityDB"), std::string_view::npos);
+    // Two distinct cities: each is stored once, in the dictionary page
+    const auto pages = std::string_view(content).substr(0, content.size() - 8 - footerBytes);
+    EXPECT_EQ(pages.find("Osaka"), pages.rfind("Osaka"));
+}
+
+TEST_F(ParquetExporterTest, SplitsStreamedBatchesIntoRowGroups) {
+    exporter.setRowGroupRows(1000);
+    std::vector<ColumnInfo> columns{{.name = "n", .type = "INT"}, {.name = "at", .type = "DATETIME"}};
+    ASSERT_TRUE(exporter.beginExport(columns, testFilePath, {}));
+    for (int batchIndex = 0; batchIndex < 5; ++batchIndex) {
+        ResultSet batch;
+        batch.columns = columns;
+        batch.columnData.emplace_back(ColumnDataType::Int64);
+        batch.columnData.emplace_back(ColumnDataType::Timestamp);
+        for (int i = 0; i < 500; ++i) {
+            batch.columnData[0].appendInt64(batchIndex * 500 + i);
+            batch.columnData[1].appendDateTime({.year = 2024, .month = 1, .day = 2, .hour = 3});
+        }
+        ASSERT_TRUE(exporter.writeBatch(batch));
+    }
+    ASSERT_TRUE(exporter.finishExport());
+    EXPECT_EQ(exporter.rowsWritten(), 2500);
+    EXPECT_EQ(exporter.rowGroupCount(), 3);
+}
+
+}  // namespace test
+}  // namespace velocitydb
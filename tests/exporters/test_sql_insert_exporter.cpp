@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "exporters/sql_insert_exporter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class SqlInsertExporterTest : public ::testing::Test {
+protected:
+    SqlInsertExporter exporter;
+    std::string testFilePath = "test_export.sql";
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    std::string readFile() const {
+        std::ifstream file(testFilePath, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+};
+
+TEST_F(SqlInsertExporterTest, WritesLiteralsByColumnType) {
+    ResultSet data;
+    data.columns = {{.name = "id", .type = "INT"},      {.name = "price", .type = "money"},     {.name = "active", .type = "BIT"},
+                    {.name = "note", .type = "NVARCHAR"}, {.name = "hash", .type = "VARBINARY"}, {.name = "day]", .type = "DATE"}};
+    data.appendRow({"1", ".5000", "1", "it's", "0A0B", "2024-03-05"});
+    data.appendRow({"2", "n/a", "0", "", "", "2024-03-06"});
+
+    exporter.setTable("Sales.Orders");
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    EXPECT_EQ(readFile(),
+              "INSERT INTO [Sales].[Orders] ([id], [price], [active], [note], [hash], [day]]]) VALUES\r\n"
+              "(1, .5000, 1, N'it''s', 0x0A0B, '20240305'),\r\n"
+              "(2, N'n/a', 0, N'', 0x, '20240306');\r\n");
+}
+
+TEST_F(SqlInsertExporterTest, WritesBinaryStorageAsHexLiterals) {
+    ResultSet data;
+    data.columns = {{.name = "hash", .type = "VARBINARY"}};
+    data.columnData.emplace_back(ColumnDataType::Binary);
+    data.columnData[0].appendBinary("\x0a\xff");
+    data.columnData[0].appendNull();
+
+    exporter.setTable("Blobs");
+    ASSERT_TRUE(exporter.exportData(data, testFilePath));
+    EXPECT_EQ(readFile(),
+              "INSERT INTO [Blobs] ([hash]) VALUES\r\n"
+              "(0x0AFF),\r\n"
+              "(NULL);\r\n");
+}
+
+TEST_F(SqlInsertExporterTest, SplitsStatementsAcrossBatchesWithGo) {
+    std::vector<ColumnInfo> columns{{.name = "n", .type = "INT"}, {.name = "at", .type = "DATETIME"}, {.name = "ratio", .type = "FLOAT"}};
+    exporter.setRowsPerStatement(4);
+    exporter.setGoEvery(2);
+    ExportOptions options;
+    options.lineEnding = "\n";
+    ASSERT_TRUE(exporter.beginExport(columns, testFilePath, options));
+    for (int batchIndex = 0; batchIndex < 3; ++batchIndex) {
+        ResultSet batch;
+        batch.columns = columns;
+        batch.columnData.emplace_back(ColumnDataType::Int64);
+        batch.columnData.emplace_back(ColumnDataType::Timestamp, 3);
+        batch.columnData.emplace_back(ColumnDataType::Double);
+        for (int i = 0; i < 3; ++i) {
+            batch.columnData[0].appendInt64(batchIndex * 3 + i);
+            batch.columnData[1].appendDateTime({.year = 2024, .month = 1, .day = 2, .hour = 3, .fraction = 250000000});
+            if (i == 2) {
+                batch.columnData[2].appendDouble(std::numeric_limits<double>::infinity());
+            } else {
+                batch.columnData[2].appendDouble(0.25);
+            }
+        }
+        ASSERT_TRUE(exporter.writeBatch(batch));
+    }
+    ASSERT_TRUE(exporter.finishExport());
+    EXPECT_EQ(exporter.rowsWritten(), 9);
+
+    const auto text = readFile();
+    EXPECT_EQ(std::count(text.begin(), text.end(), ';'), 3);  // 4 + 4 + 1 rows
+    EXPECT_NE(text.find("(0, '2024-01-02T03:00:00.250', 0.25),\n(1, "), std::string::npos);
+    EXPECT_NE(text.find("(2, '2024-01-02T03:00:00.250', NULL)"), std::string::npos);
+    EXPECT_NE(text.find("(7, '2024-01-02T03:00:00.250', 0.25);\nGO\nINSERT INTO [dbo].[ExportedRows]"), std::string::npos);
+    EXPECT_TRUE(text.ends_with("(8, '2024-01-02T03:00:00.250', NULL);\nGO\n"));
+}
+
+}  // namespace test
+}  // namespace velocitydb
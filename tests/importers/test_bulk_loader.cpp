@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "importers/bulk_loader.h"
+#include "importers/csv_importer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::vector<ColumnInfo> tableColumns() {
+    return {{.name = "Id", .type = "int"}, {.name = "Name", .type = "nvarchar"}, {.name = "Price", .type = "decimal"}, {.name = "Active", .type = "bit"}, {.name = "CreatedAt", .type = "datetime2"}};
+}
+
+}  // namespace
+
+TEST(ImportPlanTest, MapsFieldsByNameOrPosition) {
+    const auto columns = tableColumns();
+    const std::vector<std::string> fields{"name", "id", "unknown"};
+    auto plan = ImportPlan::create("dbo.Items", fields, columns, false);
+    ASSERT_TRUE(plan.has_value()) << plan.error();
+    ASSERT_EQ(plan->columns().size(), 2u);
+    EXPECT_EQ(plan->columns()[0].column.name, "Id");
+    EXPECT_EQ(plan->columns()[0].field, 1u);
+    EXPECT_EQ(plan->columns()[0].storage, ColumnDataType::Int64);
+    EXPECT_EQ(plan->insertStatement(), "INSERT INTO [dbo].[Items] ([Id], [Name]) VALUES (?, ?)");
+
+    const std::vector<std::string> positional{"a", "b", "c"};
+    plan = ImportPlan::create("Items", positional, columns, true);
+    ASSERT_TRUE(plan.has_value());
+    EXPECT_EQ(plan->columns().size(), 3u);
+    EXPECT_TRUE(plan->columns()[2].numericText);
+
+    const std::vector<std::string> nothing{"x"};
+    EXPECT_FALSE(ImportPlan::create("Items", nothing, columns, false).has_value());
+    const std::vector<ColumnInfo> binary{{.name = "Blob", .type = "varbinary"}};
+    const std::vector<std::string> blob{"Blob"};
+    EXPECT_FALSE(ImportPlan::create("Items", blob, binary, false).has_value());
+}
+
+TEST(ImportPlanTest, CoercesTextIntoColumnTypes) {
+    const auto columns = tableColumns();
+    const std::vector<std::string> fields{"Id", "Name", "Price", "Active", "CreatedAt"};
+    const auto plan = ImportPlan::create("Items", fields, columns, false);
+    ASSERT_TRUE(plan.has_value());
+
+    auto batch = plan->makeBatch();
+    using Fields = std::vector<std::optional<std::string_view>>;
+    EXPECT_EQ(plan->append(Fields{" +42 ", "Widget", "12.50", "yes", "2024-01-31"}, batch), std::nullopt);
+    EXPECT_FALSE(plan->append(Fields{"7", std::nullopt, "", "0", "2024-01-31T12:30:00Z"}, batch).has_value());
+    ASSERT_EQ(batch.rowCount(), 2u);
+    EXPECT_EQ(batch.columnData[0].int64At(0), 42);
+    EXPECT_EQ(batch.columnData[2].textAt(0), "12.50");
+    EXPECT_EQ(batch.columnData[3].int64At(0), 1);
+    EXPECT_EQ(batch.cellText(0, 4), "2024-01-31 00:00:00.0000000");
+    EXPECT_TRUE(batch.isNull(1, 1));
+    EXPECT_TRUE(batch.isNull(1, 2));  // Empty cell of a non-text column
+    EXPECT_EQ(batch.cellText(1, 4), "2024-01-31 12:30:00.0000000");
+
+    auto bad = plan->makeBatch();
+    const auto error = plan->append(Fields{"abc", "x", "1", "1", "2024-01-01"}, bad);
+    ASSERT_TRUE(error.has_value());
+    EXPECT_NE(error->find("Id"), std::string::npos);
+    EXPECT_TRUE(plan->append(Fields{"1", "x", "1.2.3", "1", "2024-01-01"}, bad).has_value());
+    EXPECT_TRUE(plan->append(Fields{"1", "x", "1", "maybe", "2024-01-01"}, bad).has_value());
+}
+
+class BulkLoaderTest : public ::testing::Test {
+protected:
+    std::string testFilePath = (std::filesystem::temp_directory_path() / "velocitydb_bulk_load_test.csv").string();
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    void writeRows(size_t count) {
+        std::ofstream file(testFilePath, std::ios::binary);
+        file << "Id,Name\n";
+        for (size_t i = 0; i < count; ++i) {
+            file << i << ",name " << i << '\n';
+        }
+    }
+
+    ImportPlan plan() const {
+        const auto columns = tableColumns();
+        const std::vector<std::string> fields{"Id", "Name"};
+        return *ImportPlan::create("Items", fields, columns, false);
+    }
+};
+
+TEST_F(BulkLoaderTest, SpreadsBatchesOverInserters) {
+    writeRows(2500);
+    CSVImporter source;
+    ASSERT_TRUE(source.open(testFilePath, {}));
+
+    std::mutex mutex;
+    std::vector<int64_t> ids;
+    std::atomic<int> batches{0};
+    const BatchInserter insert = [&](const ResultSet& batch) {
+        std::lock_guard lock(mutex);
+        for (size_t row = 0; row < batch.rowCount(); ++row) {
+            ids.push_back(batch.columnData[0].int64At(row));
+        }
+        ++batches;
+        return static_cast<int64_t>(batch.rowCount());
+    };
+    const std::vector<BatchInserter> inserters{insert, insert, insert};
+
+    BulkLoadProgress progress;
+    std::atomic<bool> cancel{false};
+    BulkLoader::load(source, plan(), inserters, progress, cancel, 1000);
+
+    EXPECT_EQ(batches.load(), 3);
+    EXPECT_EQ(progress.recordsRead.load(), 2500u);
+    EXPECT_EQ(progress.rowsInserted.load(), 2500u);
+    EXPECT_EQ(progress.bytesRead.load(), progress.totalBytes.load());
+    std::ranges::sort(ids);
+    ASSERT_EQ(ids.size(), 2500u);
+    EXPECT_EQ(ids.front(), 0);
+    EXPECT_EQ(ids.back(), 2499);
+}
+
+TEST_F(BulkLoaderTest, StopsAtTheFirstError) {
+    writeRows(5000);
+    CSVImporter source;
+    ASSERT_TRUE(source.open(testFilePath, {}));
+
+    std::atomic<int> calls{0};
+    const std::vector<BatchInserter> inserters{[&](const ResultSet&) -> int64_t {
+        if (++calls == 2) {
+            throw std::runtime_error("constraint violation");
+        }
+        return 100;
+    }};
+
+    BulkLoadProgress progress;
+    std::atomic<bool> cancel{false};
+    EXPECT_THROW(BulkLoader::load(source, plan(), inserters, progress, cancel, 100), std::runtime_error);
+    EXPECT_LT(calls.load(), 50);
+    EXPECT_EQ(progress.rowsInserted.load(), 100u);
+}
+
+TEST_F(BulkLoaderTest, ReportsCoercionErrorsAndHonoursCancel) {
+    {
+        std::ofstream file(testFilePath, std::ios::binary);
+        file << "Id,Name\n1,a\nx,b\n";
+    }
+    CSVImporter source;
+    ASSERT_TRUE(source.open(testFilePath, {}));
+    const std::vector<BatchInserter> inserters{[](const ResultSet& batch) { return static_cast<int64_t>(batch.rowCount()); }};
+    BulkLoadProgress progress;
+    std::atomic<bool> cancel{false};
+    try {
+        BulkLoader::load(source, plan(), inserters, progress, cancel);
+        FAIL() << "expected a coercion error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("Record 2"), std::string::npos) << e.what();
+    }
+
+    writeRows(100);
+    ASSERT_TRUE(source.open(testFilePath, {}));
+    BulkLoadProgress cancelled;
+    cancel = true;
+    EXPECT_NO_THROW(BulkLoader::load(source, plan(), inserters, cancelled, cancel, 10));
+    EXPECT_EQ(cancelled.rowsInserted.load(), 0u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "importers/csv_importer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class CSVImporterTest : public ::testing::Test {
+protected:
+    using Fields = std::vector<std::optional<std::string_view>>;
+
+    std::string testFilePath = (std::filesystem::temp_directory_path() / "velocitydb_import_test.csv").string();
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    void writeFile(std::string_view content) {
+        std::ofstream file(testFilePath, std::ios::binary);
+        file << content;
+    }
+};
+
+TEST_F(CSVImporterTest, ReadsHeaderAndRecords) {
+    writeFile("\xEF\xBB\xBFid,name,note\r\n1,Alice,first\r\n2,Bob,\r\n");
+    CSVImporter importer;
+    ASSERT_TRUE(importer.open(testFilePath, {}));
+    EXPECT_EQ(importer.fieldNames(), (std::vector<std::string>{"id", "name", "note"}));
+
+    Fields fields;
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"1", "Alice", "first"}));
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"2", "Bob", std::nullopt}));  // Empty unquoted cell is NULL
+    EXPECT_FALSE(importer.nextRecord(fields));
+    EXPECT_TRUE(importer.lastError().empty());
+    EXPECT_EQ(importer.bytesRead(), importer.totalBytes());
+}
+
+TEST_F(CSVImporterTest, HandlesQuotedFields) {
+    writeFile("a;b\n\"x;y\";\"He said \"\"hi\"\"\"\n\"multi\nline\";\"\"\n");
+    CSVImporter importer;
+    ImportOptions options;
+    options.delimiter = ";";
+    ASSERT_TRUE(importer.open(testFilePath, options));
+
+    Fields fields;
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"x;y", "He said \"hi\""}));
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"multi\nline", ""}));  // A quoted empty cell is an empty string
+    EXPECT_FALSE(importer.nextRecord(fields));
+}
+
+TEST_F(CSVImporterTest, LongFieldsCrossTheVectorScan) {
+    const std::string longText(100, 'x');
+    writeFile("v,w\n" + longText + "," + longText + "y\n");
+    CSVImporter importer;
+    ASSERT_TRUE(importer.open(testFilePath, {}));
+
+    Fields fields;
+    ASSERT_TRUE(importer.nextRecord(fields));
+    ASSERT_EQ(fields.size(), 2u);
+    EXPECT_EQ(*fields[0], longText);
+    EXPECT_EQ(*fields[1], longText + "y");
+}
+
+TEST_F(CSVImporterTest, WithoutHeaderNamesFieldsByPosition) {
+    writeFile("1,NULL\n2,x");
+    CSVImporter importer;
+    ImportOptions options;
+    options.hasHeader = false;
+    options.nullValue = "NULL";
+    ASSERT_TRUE(importer.open(testFilePath, options));
+    EXPECT_EQ(importer.fieldNames(), (std::vector<std::string>{"Column1", "Column2"}));
+
+    Fields fields;
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"1", std::nullopt}));
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"2", "x"}));
+    EXPECT_FALSE(importer.nextRecord(fields));
+}
+
+TEST_F(CSVImporterTest, ReportsMalformedRecords) {
+    writeFile("a,b\n1,2,3\n");
+    CSVImporter importer;
+    ASSERT_TRUE(importer.open(testFilePath, {}));
+    Fields fields;
+    EXPECT_FALSE(importer.nextRecord(fields));
+    EXPECT_NE(importer.lastError().find("Record 2 has 3 fields"), std::string::npos);
+
+    writeFile("a\n\"open\n");
+    ASSERT_TRUE(importer.open(testFilePath, {}));
+    EXPECT_FALSE(importer.nextRecord(fields));
+    EXPECT_NE(importer.lastError().find("unterminated"), std::string::npos);
+
+    EXPECT_FALSE(importer.open(testFilePath + ".missing", {}));
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "importers/file_datasource.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class FileDatasourceTest : public ::testing::Test {
+protected:
+    std::string testFilePath = (std::filesystem::temp_directory_path() / "velocitydb_datasource_test.csv").string();
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    void writeFile(std::string_view content) {
+        std::ofstream file(testFilePath, std::ios::binary);
+        file << content;
+    }
+};
+
+TEST_F(FileDatasourceTest, ReadsWindowsOfCsvWithQuotedLineBreaks) {
+    writeFile("id,name,score\r\n1,Alice,1.5\r\n2,\"multi\nline\",\r\n\r\n3,\"say \"\"hi\"\"\",2\r\n");
+    FileDatasource source(testFilePath, {});
+    EXPECT_FALSE(source.isJsonLines());
+    ASSERT_EQ(source.columns().size(), 3);
+    EXPECT_EQ(source.columns()[0].type, "bigint");
+    EXPECT_EQ(source.columns()[1].type, "nvarchar");
+    EXPECT_EQ(source.columns()[2].type, "float");
+    ASSERT_EQ(source.rowCount(), 3);
+
+    auto window = source.rows(1, 10);
+    ASSERT_EQ(window.rowCount(), 2);
+    EXPECT_EQ(window.cellText(0, 1), "multi\nline");
+    EXPECT_TRUE(window.isNull(0, 2));
+    EXPECT_EQ(window.cellText(1, 1), "say \"hi\"");
+
+    const std::vector<size_t> picked{0, 2};
+    auto rows = source.rowsAt(picked);
+    ASSERT_EQ(rows.rowCount(), 2);
+    EXPECT_EQ(rows.cellText(0, 0), "1");
+    EXPECT_EQ(rows.cellText(1, 0), "3");
+    EXPECT_TRUE(source.indexProgress().done);
+}
+
+TEST_F(FileDatasourceTest, ScansLargeFilesInOrderAcrossCheckpoints) {
+    constexpr size_t ROWS = 100'000;
+    std::string content = "n,label\n";
+    for (size_t i = 0; i < ROWS; ++i) {
+        content += std::to_string(i) + (i % 7 == 0 ? ",\"a\nb\"\n" : ",x\n");
+    }
+    writeFile(content);
+    FileDatasource source(testFilePath, {});
+    ASSERT_EQ(source.rowCount(), ROWS);
+
+    const std::vector<size_t> picked{5, 4095, 4096, 70'000, ROWS - 1};
+    auto rows = source.rowsAt(picked);
+    for (size_t i = 0; i < picked.size(); ++i) {
+        EXPECT_EQ(rows.cellText(i, 0), std::to_string(picked[i]));
+    }
+
+    size_t expected = 0;
+    size_t batches = 0;
+    source.scan([&](const ResultSet& batch, size_t firstRow) {
+        EXPECT_EQ(firstRow, expected);
+        for (size_t row = 0; row < batch.rowCount(); ++row) {
+            EXPECT_EQ(batch.cellText(row, 0), std::to_string(expected + row));
+        }
+        expected += batch.rowCount();
+        ++batches;
+        return true;
+    });
+    EXPECT_EQ(expected, ROWS);
+    EXPECT_GT(batches, 1);
+
+    size_t visited = 0;
+    source.scan([&](const ResultSet&, size_t) { return ++visited < 2; });
+    EXPECT_EQ(visited, 2);
+}
+
+TEST_F(FileDatasourceTest, ReadsJsonLines) {
+    writeFile("{\"id\": 1, \"name\": \"Alice\"}\n{\"name\": \"Bob\", \"id\": 2, \"extra\": true}\n\n{\"id\": 3}\n");
+    FileDatasource source(testFilePath, {});
+    EXPECT_TRUE(source.isJsonLines());
+    ASSERT_EQ(source.columns().size(), 2);
+    EXPECT_EQ(source.columns()[0].type, "bigint");
+    ASSERT_EQ(source.rowCount(), 3);
+
+    auto rows = source.rows(0, 3);
+    EXPECT_EQ(rows.cellText(1, 0), "2");
+    EXPECT_EQ(rows.cellText(1, 1), "Bob");
+    EXPECT_TRUE(rows.isNull(2, 1));
+}
+
+TEST_F(FileDatasourceTest, RejectsJsonArraysAndEmptyFiles) {
+    writeFile("[{\"id\": 1}]");
+    EXPECT_THROW(FileDatasource(testFilePath, {}), std::runtime_error);
+    writeFile("\r\n");
+    EXPECT_THROW(FileDatasource(testFilePath, {}), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "importers/json_importer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class JSONImporterTest : public ::testing::Test {
+protected:
+    using Fields = std::vector<std::optional<std::string_view>>;
+
+    std::string testFilePath = (std::filesystem::temp_directory_path() / "velocitydb_import_test.json").string();
+
+    void TearDown() override { std::filesystem::remove(testFilePath); }
+
+    void writeFile(std::string_view content) {
+        std::ofstream file(testFilePath, std::ios::binary);
+        file << content;
+    }
+};
+
+TEST_F(JSONImporterTest, ReadsArrayOfObjects) {
+    writeFile(R"([
+        {"id": 1, "name": "Alice", "price": 12.50, "active": true, "tags": ["a", "b"]},
+        {"name": "Bob\n2", "id": 2, "price": null, "extra": 1}
+    ])");
+    JSONImporter importer;
+    ASSERT_TRUE(importer.open(testFilePath, {}));
+    EXPECT_EQ(importer.fieldNames(), (std::vector<std::string>{"id", "name", "price", "active", "tags"}));
+
+    Fields fields;
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"1", "Alice", "12.50", "true", R"(["a", "b"])"}));  // Numbers keep their source text
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"2", "Bob\n2", std::nullopt, std::nullopt, std::nullopt}));  // Keys in any order; extras ignored
+    EXPECT_FALSE(importer.nextRecord(fields));
+    EXPECT_TRUE(importer.lastError().empty());
+    EXPECT_EQ(importer.bytesRead(), importer.totalBytes());
+}
+
+TEST_F(JSONImporterTest, ReadsJsonLines) {
+    writeFile("{\"a\": \"x\", \"b\": -3}\n{\"a\": \"y\", \"b\": 4e2}\n");
+    JSONImporter importer;
+    ASSERT_TRUE(importer.open(testFilePath, {}));
+    EXPECT_EQ(importer.fieldNames(), (std::vector<std::string>{"a", "b"}));
+
+    Fields fields;
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"x", "-3"}));
+    ASSERT_TRUE(importer.nextRecord(fields));
+    EXPECT_EQ(fields, (Fields{"y", "4e2"}));
+    EXPECT_FALSE(importer.nextRecord(fields));
+}
+
+TEST_F(JSONImporterTest, RejectsFilesWithoutObjects) {
+    writeFile("[]");
+    JSONImporter importer;
+    EXPECT_FALSE(importer.open(testFilePath, {}));
+    EXPECT_FALSE(importer.lastError().empty());
+
+    writeFile("[1, 2]");
+    EXPECT_FALSE(importer.open(testFilePath, {}));
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "importers/script_runner.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(ScriptRunnerTest, RunsBatchesInOrderWithTheirRepeatCounts) {
+    const std::string script = "CREATE TABLE t (id int)\nGO\nINSERT t VALUES (1)\nGO 3\nSELECT COUNT(*) FROM t\n";
+    std::vector<std::string> executed;
+    ScriptRunProgress progress;
+    std::atomic<bool> cancel{false};
+    const bool completed = ScriptRunner::run(
+        script,
+        [&](std::string_view batch) {
+            executed.emplace_back(batch);
+            return batch.starts_with("INSERT") ? int64_t{1} : int64_t{-1};
+        },
+        progress, cancel, false);
+
+    EXPECT_TRUE(completed);
+    EXPECT_EQ(executed, (std::vector<std::string>{"CREATE TABLE t (id int)", "INSERT t VALUES (1)", "INSERT t VALUES (1)", "INSERT t VALUES (1)", "SELECT COUNT(*) FROM t"}));
+    EXPECT_EQ(progress.batchesRun, 3);
+    EXPECT_EQ(progress.rowsAffected, 3);
+    EXPECT_EQ(progress.totalBytes, script.size());
+    EXPECT_EQ(progress.bytesRead, script.size());
+    EXPECT_EQ(progress.bytesExecuted, script.size() - 1);
+    EXPECT_EQ(progress.errorCount(), 0);
+}
+
+TEST(ScriptRunnerTest, ReportsFailedBatchesAtTheirFileOffset) {
+    const std::string script = "SELECT 1\nGO\n\nSELECT broken\nGO\nSELECT 3\n";
+    std::atomic<bool> cancel{false};
+    auto execute = [](std::string_view batch) -> int64_t {
+        if (batch.find("broken") != std::string_view::npos) {
+            throw std::runtime_error("Invalid column name 'broken'.");
+        }
+        return 0;
+    };
+
+    ScriptRunProgress stopped;
+    EXPECT_FALSE(ScriptRunner::run(script, execute, stopped, cancel, false));
+    EXPECT_EQ(stopped.batchesRun, 1);
+    const auto errors = stopped.errorsSince(0);
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_EQ(errors[0].offset, script.find("SELECT broken"));
+    EXPECT_EQ(errors[0].line, 4);
+    EXPECT_EQ(errors[0].batch, 1);
+    EXPECT_EQ(errors[0].message, "Invalid column name 'broken'.");
+
+    ScriptRunProgress continued;
+    EXPECT_FALSE(ScriptRunner::run(script, execute, continued, cancel, true));
+    EXPECT_EQ(continued.batchesRun, 3);
+    EXPECT_EQ(continued.errorCount(), 1);
+    EXPECT_TRUE(continued.errorsSince(1).empty());
+}
+
+TEST(ScriptRunnerTest, StopsWhenCancelled) {
+    std::string script;
+    for (int i = 0; i < 100; ++i) {
+        script += "SELECT " + std::to_string(i) + "\nGO\n";
+    }
+    std::atomic<bool> cancel{false};
+    ScriptRunProgress progress;
+    EXPECT_FALSE(ScriptRunner::run(
+        script,
+        [&](std::string_view) {
+            if (progress.batchesRun == 4) {
+                cancel = true;
+            }
+            return int64_t{0};
+        },
+        progress, cancel, false));
+    EXPECT_EQ(progress.batchesRun, 5);
+    EXPECT_LT(progress.bytesExecuted, script.size());
+}
+
+}  // namespace test
+}  // namespace velocitydb
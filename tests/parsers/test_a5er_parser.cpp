@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
 #include "parsers/a5er_parser.h"
+#include "parsers/a5er_utils.h"
 #include "parsers/er_diagram_parser_factory.h"
 #include "interfaces/parsers/er_model.h"
 
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+
 namespace velocitydb {
 namespace test {
 
@@ -265,6 +270,18 @@ TEST_F(ERDiagramParserTest, XmlFormatRelation) {
     EXPECT_EQ(rel.cardinality, "1:N");
 }
 
+TEST_F(ERDiagramParserTest, XmlFormatDecodesAttributeValues) {
+    constexpr auto input = R"(<?xml version="1.0" encoding="UTF-8"?>
+<A5ER Name="M" DatabaseType="SQLServer">
+  <Entity Name="a&amp;b" Comment="line&#10;break	tab"><![CDATA[ignored]]><Attribute Name="id" Type="INT"/></Entity>
+</A5ER>)";
+    ERModel model = parser.parse(input);
+    ASSERT_EQ(model.tables.size(), 1u);
+    EXPECT_EQ(model.tables[0].name, "a&b");
+    EXPECT_EQ(model.tables[0].comment, "line\nbreak tab");  // Escaped newline kept, literal whitespace normalized
+    ASSERT_EQ(model.tables[0].columns.size(), 1u);
+}
+
 // --- DDL generation via ERModel ---
 
 TEST_F(ERDiagramParserTest, GenerateDDLFromERModel) {
@@ -325,6 +342,37 @@ TEST_F(ERDiagramParserTest, GenerateDDLIndexes) {
     EXPECT_NE(ddl.find("[IX_Users_Email]"), std::string::npos);
 }
 
+TEST_F(ERDiagramParserTest, GenerateDDLCreatesReferencedTablesFirst) {
+    // A chain t0 → t1 → ... listed children first, large enough to render in parallel
+    ERModel model;
+    constexpr size_t count = 3000;
+    for (size_t i = 0; i < count; ++i) {
+        ERModelTable table;
+        table.name = "t" + std::to_string(i);
+        table.columns.push_back({.name = "id", .type = "INT", .isPrimaryKey = true});
+        model.tables.push_back(std::move(table));
+        if (i > 0) {
+            model.relations.push_back({.parentTable = "t" + std::to_string(i), .childTable = "t" + std::to_string(i - 1), .parentColumn = "id", .childColumn = "id"});
+        }
+    }
+
+    std::string ddl = parser.generateDDL(model);
+    size_t previous = std::string::npos;
+    for (size_t i = count; i-- > 0;) {
+        const auto at = ddl.find("CREATE TABLE [t" + std::to_string(i) + "] (");
+        ASSERT_NE(at, std::string::npos);
+        if (previous != std::string::npos) {
+            EXPECT_GT(at, previous);
+        }
+        previous = at;
+    }
+    EXPECT_GT(ddl.find("FOREIGN KEY"), previous);
+
+    std::string streamed;
+    parser.writeDDL(model, TargetDatabase::SQLServer, [&](std::string_view chunk) { streamed += chunk; });
+    EXPECT_EQ(streamed, ddl);
+}
+
 // ============================================================
 // Text format edge cases
 // ============================================================
@@ -454,6 +502,44 @@ DEL
     EXPECT_EQ(model.tables[0].columns[0].type, "DECIMAL(10,2)");
 }
 
+TEST_F(ERDiagramParserTest, TextFormatQuotedFieldsKeepEscapedQuotes) {
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector<std::string_view> fields;
+    const std::string raw = R"("a ""quoted"" name", plain,"",""""x)";
+    a5er::splitQuotedFields(raw, fields, arena);
+
+    ASSERT_EQ(fields.size(), 5);
+    EXPECT_EQ(fields[0], R"(a "quoted" name)");
+    EXPECT_EQ(fields[1], "plain");
+    EXPECT_EQ(fields[2], "");
+    EXPECT_EQ(fields[3], "\"");
+    EXPECT_EQ(fields[4], "x");
+    EXPECT_EQ(fields[1].data(), raw.data() + 21);  // Unescaped fields are views into the line
+}
+
+TEST_F(ERDiagramParserTest, TextFormatLargeModelKeepsEntityOrder) {
+    // Enough entities to take the parallel conversion path
+    std::string input = "# A5:ER FORMAT:19\n";
+    for (int i = 0; i < 1000; ++i) {
+        const auto n = std::to_string(i);
+        input += "[Entity]\nPName=t" + n + "\nLName=Table " + n + "\nLeft=" + n + "\nField=\"id" + n + "\",\"ID\",\"INT\",\"NOT NULL\",0,\"\",\"\"\nIndex=IX_" + n + "=1,id" + n + "\nDEL\n";
+    }
+    input += "[Relation]\nEntity1=t0\nEntity2=t1\nRelationType1=2\nRelationType2=3\nDEL\n";
+
+    const auto model = parser.parseFromString(input);
+    ASSERT_EQ(model.tables.size(), 1000);
+    for (int i = 0; i < 1000; i += 111) {
+        EXPECT_EQ(model.tables[i].name, "t" + std::to_string(i));
+        EXPECT_EQ(model.tables[i].posX, i);
+        ASSERT_EQ(model.tables[i].columns.size(), 1);
+        EXPECT_EQ(model.tables[i].columns[0].name, "id" + std::to_string(i));
+        ASSERT_EQ(model.tables[i].indexes.size(), 1);
+        EXPECT_TRUE(model.tables[i].indexes[0].isUnique);
+    }
+    ASSERT_EQ(model.relations.size(), 1);
+    EXPECT_EQ(model.relations[0].name, "t0_t1");
+}
+
 TEST_F(ERDiagramParserTest, TextFormatEmptyEntity) {
     ERModel model = parser.parse("# A5:ER FORMAT:19\n\n[Entity]\nPName=empty\nLName=Empty\nDEL\n");
 
@@ -773,6 +859,22 @@ TEST_F(ERDiagramParserTest, ParseFileNotFound) {
     EXPECT_THROW(parser.parseFile("nonexistent_path.a5er"), std::runtime_error);
 }
 
+TEST_F(ERDiagramParserTest, ParseFileReadsMappedContent) {
+    const auto path = std::filesystem::temp_directory_path() / "velocitydb_parse_file_test.a5er";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "\xEF\xBB\xBF" << BASIC_TEXT_INPUT;
+    }
+    const auto model = parser.parseFile(path.string());
+    std::filesystem::remove(path);
+
+    // Strings outlive the mapping they were parsed from
+    ASSERT_EQ(model.tables.size(), 2);
+    EXPECT_EQ(model.tables[0].name, "users");
+    EXPECT_EQ(model.tables[0].columns[1].logicalName, "display_name");
+    EXPECT_EQ(model.tables[0].bkColor, "$99FFFF");
+}
+
 TEST_F(ERDiagramParserTest, XmlFormatInvalidXmlThrows) {
     EXPECT_THROW(static_cast<void>(parser.parse("<?xml version=\"1.0\"?><A5ER><broken")), std::runtime_error);
 }
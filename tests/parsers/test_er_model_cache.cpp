@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "parsers/er_model_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class ERModelCacheTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "velocitydb_er_cache_test";
+    std::filesystem::path diagram = std::filesystem::temp_directory_path() / "velocitydb_er_cache_test.a5er";
+    int parses = 0;
+
+    void SetUp() override {
+        std::filesystem::remove_all(directory);
+        write("first");
+    }
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+        std::filesystem::remove(diagram);
+    }
+
+    void write(const std::string& content) {
+        std::ofstream(diagram, std::ios::binary) << content;
+    }
+
+    /// Stands in for the A5:ER parser: one table named after the content
+    ERModelCache::Parser parser() {
+        return [this](std::string_view content) {
+            ++parses;
+            ERModelCache::ParseResult result;
+            result.model.tables.push_back({.name = std::string(content), .columns = {{.name = "id", .type = "INT", .isPrimaryKey = true}}});
+            result.ddl = "CREATE TABLE ...";
+            return result;
+        };
+    }
+
+    std::string tableName(ERModelCache& cache, bool persist = true) { return cache.get(diagram.string(), parser(), persist)->model.tables.at(0).name; }
+};
+
+TEST_F(ERModelCacheTest, ReopeningAnUnchangedFileSkipsParsing) {
+    ERModelCache cache;
+    EXPECT_EQ(tableName(cache), "first");
+    EXPECT_EQ(tableName(cache), "first");
+    EXPECT_EQ(parses, 1);
+
+    // Touched but unchanged: the hash still matches
+    std::filesystem::last_write_time(diagram, std::filesystem::last_write_time(diagram) + std::chrono::seconds(5));
+    EXPECT_EQ(tableName(cache), "first");
+    EXPECT_EQ(parses, 1);
+
+    write("second");
+    EXPECT_EQ(tableName(cache), "second");
+    EXPECT_EQ(parses, 2);
+}
+
+TEST_F(ERModelCacheTest, PersistedEntriesOutliveTheCache) {
+    {
+        ERModelCache cache(directory);
+        EXPECT_EQ(tableName(cache), "first");
+    }
+    ERModelCache cache(directory);
+    EXPECT_EQ(tableName(cache), "first");
+    EXPECT_EQ(parses, 1);
+
+    // Not persisting: nothing is read from or written to the directory
+    ERModelCache memoryOnly(directory);
+    EXPECT_EQ(tableName(memoryOnly, false), "first");
+    EXPECT_EQ(parses, 2);
+
+    cache.clear();
+    EXPECT_EQ(cache.entryCount(), 0u);
+    EXPECT_EQ(tableName(cache), "first");
+    EXPECT_EQ(parses, 3);
+}
+
+TEST_F(ERModelCacheTest, EvictsTheLeastRecentlyUsedEntry) {
+    ERModelCache cache({}, 1);
+    const auto other = std::filesystem::temp_directory_path() / "velocitydb_er_cache_test_other.a5er";
+    std::ofstream(other, std::ios::binary) << "other";
+    (void)cache.get(other.string(), parser());
+    EXPECT_EQ(tableName(cache), "first");
+    EXPECT_EQ(cache.entryCount(), 1u);
+    (void)cache.get(other.string(), parser());
+    EXPECT_EQ(parses, 3);
+    std::filesystem::remove(other);
+}
+
+TEST_F(ERModelCacheTest, SerializedModelReadsBackIdentically) {
+    ERModelCache::ParseResult result;
+    result.model.name = "Sales";
+    result.model.databaseType = "SQLServer";
+    result.model.tables.push_back({.name = "Users",
+                                   .logicalName = "ユーザー",
+                                   .page = "Main",
+                                   .columns = {{.name = "id", .type = "INT", .nullable = false, .isPrimaryKey = true}, {.name = "name", .type = "VARCHAR", .size = 50, .color = "#FF0000"}},
+                                   .indexes = {{.name = "IX_Users_Name", .columns = {"name"}, .isUnique = true}},
+                                   .posX = 120.5,
+                                   .posY = 40});
+    result.model.relations.push_back({.name = "FK", .parentTable = "Users", .childTable = "Orders", .parentColumn = "id", .childColumn = "user_id", .cardinality = "1:N"});
+    result.model.shapes.push_back({.shapeType = "rectangle", .text = "memo", .fillAlpha = 128, .left = 1, .top = 2, .width = 3, .height = 4});
+    result.ddl = "CREATE TABLE [Users] (...);";
+
+    const auto bytes = ERModelCache::serialize(result, 42, 1000, 7);
+    const auto stamp = ERModelCache::stampOf(bytes);
+    ASSERT_TRUE(stamp.has_value());
+    EXPECT_EQ(stamp->contentHash, 42u);
+    EXPECT_EQ(stamp->fileSize, 1000u);
+    EXPECT_EQ(stamp->modifiedAt, 7);
+
+    const auto restored = ERModelCache::deserialize(bytes);
+    EXPECT_EQ(ERDiagramParserFactory::toJson(restored.model, restored.ddl), ERDiagramParserFactory::toJson(result.model, result.ddl));
+
+    EXPECT_THROW((void)ERModelCache::deserialize(std::string_view(bytes).substr(0, bytes.size() - 1)), std::runtime_error);
+    EXPECT_FALSE(ERModelCache::stampOf("not an entry").has_value());
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "parsers/plan_diff.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Builds a plan one operator at a time, in pre-order
+struct PlanBuilder {
+    ExecutionPlan plan;
+
+    PlanBuilder& statement(double cost, std::vector<std::string> warnings = {}) {
+        plan.statements.push_back(PlanStatement{.text = "SELECT ...", .subtreeCost = cost, .warnings = std::move(warnings)});
+        return *this;
+    }
+
+    PlanBuilder& op(int32_t parent, std::string physicalOp, std::string object, double rows, double cost) {
+        plan.operators.push_back(PlanOperator{.nodeId = static_cast<uint32_t>(plan.operators.size()),
+                                              .parent = parent,
+                                              .statement = static_cast<uint32_t>(plan.statements.size() - 1),
+                                              .physicalOp = physicalOp,
+                                              .logicalOp = physicalOp,
+                                              .object = std::move(object),
+                                              .estimatedRows = rows,
+                                              .subtreeCost = cost,
+                                              .cost = cost});
+        return *this;
+    }
+};
+
+[[nodiscard]] ExecutionPlan joinWithScan() {
+    return PlanBuilder{}
+        .statement(1.0)
+        .op(-1, "Hash Match", "", 120, 0.2)
+        .op(0, "Clustered Index Scan", "[dbo].[Users].[PK_Users]", 1000, 0.1)
+        .op(0, "Table Scan", "[dbo].[Orders]", 50000, 0.7)
+        .plan;
+}
+
+}  // namespace
+
+TEST(PlanDiffTest, IdenticalPlansAreUnchanged) {
+    const auto plan = joinWithScan();
+    const auto diff = PlanDiff::compare(plan, plan);
+
+    ASSERT_EQ(diff.operators.size(), 3);
+    EXPECT_EQ(diff.unchanged, 3);
+    EXPECT_EQ(diff.changed + diff.added + diff.removed + diff.estimateShifts + diff.costShifts, 0);
+    for (size_t i = 0; i < diff.operators.size(); ++i) {
+        EXPECT_EQ(diff.operators[i].before, static_cast<int32_t>(i));
+        EXPECT_EQ(diff.operators[i].after, static_cast<int32_t>(i));
+        EXPECT_DOUBLE_EQ(diff.operators[i].rowsRatio, 1.0);
+    }
+}
+
+TEST(PlanDiffTest, ScanTurningIntoSeekIsAChangedOperator) {
+    const auto after = PlanBuilder{}
+                           .statement(0.3)
+                           .op(-1, "Nested Loops", "", 120, 0.05)
+                           .op(0, "Clustered Index Scan", "[dbo].[Users].[PK_Users]", 1000, 0.1)
+                           .op(0, "Index Seek", "[dbo].[Orders].[IX_Orders_UserId]", 0.12, 0.15)
+                           .plan;
+    const auto diff = PlanDiff::compare(joinWithScan(), after);
+
+    ASSERT_EQ(diff.operators.size(), 3);
+    EXPECT_EQ(diff.operators[0].change, PlanChange::Changed);
+    EXPECT_EQ(diff.operators[1].change, PlanChange::Unchanged);
+    const auto& seek = diff.operators[2];
+    EXPECT_EQ(seek.change, PlanChange::Changed);
+    EXPECT_EQ(seek.before, 2);
+    EXPECT_EQ(seek.after, 2);
+    EXPECT_TRUE(seek.estimateShift);
+    EXPECT_TRUE(seek.costShift);
+    EXPECT_NEAR(seek.costDelta, -0.55, 1e-9);
+    // The unchanged scan kept its estimate and cost
+    EXPECT_FALSE(diff.operators[1].estimateShift);
+    EXPECT_FALSE(diff.operators[1].costShift);
+    EXPECT_EQ(diff.estimateShifts, 1);
+    ASSERT_EQ(diff.statements.size(), 1);
+    EXPECT_DOUBLE_EQ(diff.statements[0].beforeCost, 1.0);
+    EXPECT_DOUBLE_EQ(diff.statements[0].afterCost, 0.3);
+}
+
+TEST(PlanDiffTest, InsertedOperatorDoesNotShiftItsSiblings) {
+    const auto after = PlanBuilder{}
+                           .statement(1.0)
+                           .op(-1, "Hash Match", "", 120, 0.2)
+                           .op(0, "Sort", "", 1000, 0.05)
+                           .op(1, "Compute Scalar", "", 1000, 0.01)
+                           .op(0, "Clustered Index Scan", "[dbo].[Users].[PK_Users]", 1000, 0.1)
+                           .op(0, "Table Scan", "[dbo].[Orders]", 50000, 0.7)
+                           .plan;
+    const auto diff = PlanDiff::compare(joinWithScan(), after);
+
+    EXPECT_EQ(diff.unchanged, 3);
+    EXPECT_EQ(diff.added, 2);  // The Sort and the Compute Scalar under it
+    EXPECT_EQ(diff.changed + diff.removed, 0);
+    ASSERT_EQ(diff.operators.size(), 5);
+    EXPECT_EQ(diff.operators[1].change, PlanChange::Added);
+    EXPECT_EQ(diff.operators[1].before, -1);
+    EXPECT_EQ(diff.operators[1].after, 1);
+    EXPECT_EQ(diff.operators[2].after, 2);
+
+    // And the other way round
+    const auto reverse = PlanDiff::compare(after, joinWithScan());
+    EXPECT_EQ(reverse.removed, 2);
+    EXPECT_EQ(reverse.unchanged, 3);
+}
+
+TEST(PlanDiffTest, ComparesStatementWarningsAndExtraStatements) {
+    auto before = joinWithScan();
+    before.statements[0].warnings = {"Implicit conversion of [Code]", "No join predicate"};
+    auto after = joinWithScan();
+    after.statements[0].warnings = {"No join predicate", "Spill to tempdb"};
+    after.statements.push_back(PlanStatement{.text = "SELECT 1", .subtreeCost = 0.01});
+    after.operators.push_back(PlanOperator{.statement = 1, .physicalOp = "Constant Scan", .logicalOp = "Constant Scan", .estimatedRows = 1, .cost = 0.01});
+
+    const auto diff = PlanDiff::compare(before, after);
+    ASSERT_EQ(diff.statements.size(), 2);
+    EXPECT_EQ(diff.statements[0].addedWarnings, (std::vector<std::string>{"Spill to tempdb"}));
+    EXPECT_EQ(diff.statements[0].removedWarnings, (std::vector<std::string>{"Implicit conversion of [Code]"}));
+    EXPECT_EQ(diff.added, 1);
+    EXPECT_EQ(diff.operators.back().statement, 1);
+    EXPECT_TRUE(diff.operators.back().costShift);  // The whole of a statement that did not exist before
+
+    const auto json = PlanDiff::toJson(diff);
+    EXPECT_NE(json.find(R"("addedWarnings":["Spill to tempdb"])"), std::string::npos);
+    EXPECT_NE(json.find(R"("change":"added","before":-1,"after":3,"statement":1)"), std::string::npos);
+    EXPECT_NE(json.find(R"("summary":{"unchanged":3,"changed":0,"added":1,"removed":0,)"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "parsers/showplan_parser.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+constexpr std::string_view ESTIMATED_PLAN = R"xml(<?xml version="1.0" encoding="utf-16"?>
+<ShowPlanXML xmlns="http://schemas.microsoft.com/sqlserver/2004/07/showplan" Version="1.564" Build="16.0.1000.6">
+  <BatchSequence><Batch><Statements>
+    <StmtSimple StatementText="SELECT u.Name FROM dbo.Users u JOIN dbo.Orders o ON o.UserId = u.Id WHERE o.Total &gt; 10" StatementSubTreeCost="1.5" StatementEstRows="119.6">
+      <QueryPlan>
+        <Warnings><PlanAffectingConvert ConvertIssue="Seek Plan" Expression="CONVERT_IMPLICIT(int,[o].[Code],0)" /></Warnings>
+        <MissingIndexes>
+          <MissingIndexGroup Impact="87.5">
+            <MissingIndex Database="[Shop]" Schema="[dbo]" Table="[Orders]">
+              <ColumnGroup Usage="INEQUALITY"><Column Name="[Total]" ColumnId="3" /></ColumnGroup>
+              <ColumnGroup Usage="INCLUDE"><Column Name="[UserId]" ColumnId="2" /></ColumnGroup>
+            </MissingIndex>
+          </MissingIndexGroup>
+        </MissingIndexes>
+        <RelOp NodeId="0" PhysicalOp="Hash Match" LogicalOp="Inner Join" EstimateRows="120" EstimatedTotalSubtreeCost="1.5">
+          <OutputList><ColumnReference Column="Name" /></OutputList>
+          <Hash>
+            <RelOp NodeId="1" PhysicalOp="Clustered Index Scan" LogicalOp="Clustered Index Scan" EstimateRows="1000" EstimatedTotalSubtreeCost="0.25">
+              <IndexScan><Object Database="[Shop]" Schema="[dbo]" Table="[Users]" Index="[PK_Users]" /></IndexScan>
+            </RelOp>
+            <RelOp NodeId="2" PhysicalOp="Table Scan" LogicalOp="Table Scan" EstimateRows="120" EstimatedTotalSubtreeCost="0.9">
+              <Warnings NoJoinPredicate="true"><ColumnsWithNoStatistics><ColumnReference Column="Total" /></ColumnsWithNoStatistics></Warnings>
+              <TableScan><Object Database="[Shop]" Schema="[dbo]" Table="[Orders]" /></TableScan>
+            </RelOp>
+          </Hash>
+        </RelOp>
+      </QueryPlan>
+    </StmtSimple>
+  </Statements></Batch></BatchSequence>
+</ShowPlanXML>)xml";
+
+constexpr std::string_view ACTUAL_PLAN = R"xml(<ShowPlanXML xmlns="http://schemas.microsoft.com/sqlserver/2004/07/showplan">
+  <BatchSequence><Batch><Statements>
+    <StmtSimple StatementText="SELECT COUNT(*) FROM dbo.Users" StatementSubTreeCost="1">
+      <QueryPlan>
+        <RelOp NodeId="0" PhysicalOp="Stream Aggregate" LogicalOp="Aggregate" EstimateRows="1" EstimatedTotalSubtreeCost="1">
+          <RunTimeInformation>
+            <RunTimeCountersPerThread Thread="0" ActualRows="1" ActualExecutions="1" />
+          </RunTimeInformation>
+          <StreamAggregate>
+            <RelOp NodeId="1" PhysicalOp="Index Scan" LogicalOp="Index Scan" EstimateRows="1000" EstimatedTotalSubtreeCost="0.75">
+              <RunTimeInformation>
+                <RunTimeCountersPerThread Thread="1" ActualRows="600" ActualExecutions="1" />
+                <RunTimeCountersPerThread Thread="2" ActualRows="400" ActualExecutions="1" />
+              </RunTimeInformation>
+              <IndexScan><Object Schema="[dbo]" Table="[Users]" Index="[IX_Users_Name]" /></IndexScan>
+            </RelOp>
+          </StreamAggregate>
+        </RelOp>
+      </QueryPlan>
+    </StmtSimple>
+  </Statements></Batch></BatchSequence>
+</ShowPlanXML>)xml";
+
+}  // namespace
+
+TEST(ShowplanParserTest, BuildsOperatorTreeWithOwnCosts) {
+    const auto plan = ShowplanParser::parse(ESTIMATED_PLAN);
+
+    ASSERT_EQ(plan.statements.size(), 1u);
+    EXPECT_DOUBLE_EQ(plan.statements[0].subtreeCost, 1.5);
+    EXPECT_EQ(plan.statements[0].estimatedRows, 119.6);
+    ASSERT_EQ(plan.statements[0].warnings.size(), 1u);
+    EXPECT_EQ(plan.statements[0].warnings[0], "PlanAffectingConvert (ConvertIssue=Seek Plan, Expression=CONVERT_IMPLICIT(int,[o].[Code],0))");
+
+    ASSERT_EQ(plan.operators.size(), 3u);
+    EXPECT_EQ(plan.operators[0].physicalOp, "Hash Match");
+    EXPECT_EQ(plan.operators[0].parent, -1);
+    EXPECT_TRUE(plan.operators[0].object.empty());  // The children's objects are not the join's
+    EXPECT_NEAR(plan.operators[0].cost, 0.35, 1e-9);
+    EXPECT_EQ(plan.operators[1].object, "[dbo].[Users].[PK_Users]");
+    EXPECT_EQ(plan.operators[1].parent, 0);
+    EXPECT_EQ(plan.operators[2].nodeId, 2u);
+    EXPECT_EQ(plan.operators[2].parent, 0);
+    EXPECT_EQ(plan.operators[2].warnings, (std::vector<std::string>{"NoJoinPredicate", "ColumnsWithNoStatistics (Total)"}));
+    EXPECT_FALSE(plan.operators[2].actualRows.has_value());
+
+    EXPECT_EQ(plan.hotspots, (std::vector<uint32_t>{2, 0, 1}));
+    EXPECT_EQ(ShowplanParser::parse(ESTIMATED_PLAN, 1).hotspots, (std::vector<uint32_t>{2}));
+
+    ASSERT_EQ(plan.missingIndexes.size(), 1u);
+    EXPECT_DOUBLE_EQ(plan.missingIndexes[0].impact, 87.5);
+    EXPECT_EQ(plan.missingIndexes[0].table, "[Shop].[dbo].[Orders]");
+    EXPECT_TRUE(plan.missingIndexes[0].equalityColumns.empty());
+    EXPECT_EQ(plan.missingIndexes[0].inequalityColumns, (std::vector<std::string>{"[Total]"}));
+    EXPECT_EQ(plan.missingIndexes[0].includeColumns, (std::vector<std::string>{"[UserId]"}));
+}
+
+TEST(ShowplanParserTest, MergesActualPlanDocumentsAndSumsThreadCounters) {
+    const std::vector<std::string_view> documents{ACTUAL_PLAN, ESTIMATED_PLAN};
+    const auto plan = ShowplanParser::parse(documents);
+
+    ASSERT_EQ(plan.statements.size(), 2u);
+    ASSERT_EQ(plan.operators.size(), 5u);
+    EXPECT_EQ(plan.operators[1].actualRows, 1000.0);
+    EXPECT_EQ(plan.operators[1].actualExecutions, 2u);
+    EXPECT_EQ(plan.operators[2].statement, 1u);
+    EXPECT_EQ(plan.operators[3].parent, 2);  // Parents index the merged operator list
+    EXPECT_EQ(plan.missingIndexes[0].statement, 1u);
+}
+
+TEST(ShowplanParserTest, SerializesCompactJson) {
+    const auto json = ShowplanParser::toJson(ShowplanParser::parse(ACTUAL_PLAN));
+    EXPECT_EQ(json,
+              R"({"statements":[{"text":"SELECT COUNT(*) FROM dbo.Users","cost":1,"warnings":[]}],"operators":[)"
+              R"({"id":0,"parent":-1,"statement":0,"physicalOp":"Stream Aggregate","logicalOp":"Aggregate","estimatedRows":1,"subtreeCost":1,"cost":0.25,"actualRows":1,"actualExecutions":1},)"
+              R"({"id":1,"parent":0,"statement":0,"physicalOp":"Index Scan","logicalOp":"Index Scan","object":"[dbo].[Users].[IX_Users_Name]","estimatedRows":1000,"subtreeCost":0.75,"cost":0.75,"actualRows":1000,"actualExecutions":2}],)"
+              R"("missingIndexes":[],"hotspots":[1,0]})");
+}
+
+TEST(ShowplanParserTest, RejectsNonShowplanInput) {
+    EXPECT_THROW((void)ShowplanParser::parse("<ShowPlanXML><unclosed>"), std::runtime_error);
+    EXPECT_THROW((void)ShowplanParser::parse("<Plan />"), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "parsers/sql_formatter.h"
 
+#include <filesystem>
+#include <fstream>
+
 namespace velocitydb {
 namespace test {
 
@@ -409,5 +412,94 @@ TEST_F(SQLFormatterTest, FormatsVeryComplexQuery) {
     EXPECT_NE(formatted.find("CASE"), std::string::npos);
 }
 
+TEST_F(SQLFormatterTest, TokenizesBracketsVariablesAndNonAsciiNames) {
+    // Each of these used to stall the tokenizer
+    std::string sql = "select [order;id], @limit, #tmp.x, \xE5\x90\x8D\xE5\x89\x8D from [dbo].[t] where a % 2 = 0";
+    std::string formatted = formatter.format(sql);
+
+    EXPECT_NE(formatted.find("[order;id]"), std::string::npos);
+    EXPECT_NE(formatted.find("@limit"), std::string::npos);
+    EXPECT_NE(formatted.find("#tmp.x"), std::string::npos);
+    EXPECT_NE(formatted.find("\xE5\x90\x8D\xE5\x89\x8D"), std::string::npos);
+    EXPECT_NE(formatted.find("FROM [dbo].[t]"), std::string::npos);
+
+    // select [order;id] , @limit , #tmp.x , name from [dbo].[t] where a % 2 = 0
+    EXPECT_EQ(formatter.countTokens(sql), 16u);
+    EXPECT_EQ(formatter.countTokens(""), 0u);
+}
+
+TEST_F(SQLFormatterTest, FormatLinesWidensToWholeStatements) {
+    std::string sql =
+        "select a from t;\n"
+        "select b,\n"
+        "c from u where x=1;\n"
+        "select d from v; select e\n"
+        "from w;\n";
+    SQLFormatter::FormatOptions options;
+
+    auto edit = formatter.formatLines(sql, 2, 2, options);
+    EXPECT_EQ(edit.firstLine, 1u);
+    EXPECT_EQ(edit.lastLine, 2u);
+    EXPECT_EQ(edit.text, formatter.format("select b,\nc from u where x=1;", options));
+
+    // Line 3 ends inside the statement that continues on line 4
+    edit = formatter.formatLines(sql, 3, 3, options);
+    EXPECT_EQ(edit.firstLine, 3u);
+    EXPECT_EQ(edit.lastLine, 4u);
+    EXPECT_NE(edit.text.find("FROM w"), std::string::npos);
+
+    edit = formatter.formatLines(sql, 0, 0, options);
+    EXPECT_EQ(edit.lastLine, 0u);
+    EXPECT_EQ(edit.text, "SELECT a\nFROM t ;");
+}
+
+TEST_F(SQLFormatterTest, UppercaseKeywordsInLinesKeepsLayoutAndSkipsMultiLineStrings) {
+    std::string sql =
+        "select a\n"
+        "from t where b = 'one\n"
+        "select two'\n"
+        "  and c   is null\n"
+        "order by a";
+
+    auto edit = formatter.uppercaseKeywordsInLines(sql, 3, 3);
+    EXPECT_EQ(edit.firstLine, 3u);
+    EXPECT_EQ(edit.lastLine, 3u);
+    EXPECT_EQ(edit.text, "  AND c   IS NULL");
+
+    // Line 2 starts inside the string literal, so the pass restarts at line 1
+    edit = formatter.uppercaseKeywordsInLines(sql, 2, 2);
+    EXPECT_EQ(edit.firstLine, 1u);
+    EXPECT_EQ(edit.lastLine, 2u);
+    EXPECT_EQ(edit.text, "FROM t WHERE b = 'one\nselect two'");
+
+    // Out-of-range lines clamp to the end of the script
+    edit = formatter.uppercaseKeywordsInLines(sql, 7, 9);
+    EXPECT_EQ(edit.firstLine, 4u);
+    EXPECT_EQ(edit.lastLine, 4u);
+    EXPECT_EQ(edit.text, "ORDER BY a");
+}
+
+TEST_F(SQLFormatterTest, CustomKeywordFileReplacesBuiltInKeywords) {
+    const auto path = std::filesystem::temp_directory_path() / "velocitydb_formatter_keywords.txt";
+    {
+        std::ofstream file(path);
+        file << "# custom list\nselect\nfrom\nmerge\n";
+    }
+
+    ASSERT_TRUE(formatter.loadKeywordsFromFile(path.string()));
+    EXPECT_EQ(formatter.uppercaseKeywords("merge into t using s where x"), "MERGE into t using s where x");
+    EXPECT_FALSE(formatter.loadKeywordsFromFile((path.parent_path() / "velocitydb_missing_keywords.txt").string()));
+    EXPECT_EQ(formatter.uppercaseKeywords("select a from t"), "SELECT a FROM t");
+
+    std::filesystem::remove(path);
+}
+
+TEST_F(SQLFormatterTest, KeepsCommentsWithoutSwallowingCode) {
+    // A line comment moved onto a shared line becomes a block comment so the code after it survives
+    EXPECT_EQ(formatter.format("select a, -- first\n b from t"), "SELECT a,\n    /* first */ b\nFROM t");
+    EXPECT_EQ(formatter.format("select 1 -- has */ inside\nfrom t"), "SELECT 1 -- has */ inside\nFROM t");
+    EXPECT_EQ(formatter.uppercaseKeywords("select a, -- from here\n b from t"), "SELECT a, -- from here\nb FROM t");
+}
+
 }  // namespace test
 }  // namespace velocitydb
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "parsers/sql_lexer.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::vector<std::string_view> texts(const SqlTokenStream& stream) {
+    const SqlTokens view = stream;
+    std::vector<std::string_view> result;
+    for (const auto& token : view.tokens) {
+        result.push_back(view.text(token));
+    }
+    return result;
+}
+
+}  // namespace
+
+using Texts = std::vector<std::string_view>;
+
+TEST(SqlLexerTest, ClassifiesTokens) {
+    const SqlTokenStream stream("SELECT @id, 1.5, N'it''s', [a]]b], \"c\" FROM #t WHERE x <> 2 -- note\n/* a /* b */ c */");
+    EXPECT_EQ(texts(stream), (Texts{"SELECT", "@id", ",", "1.5", ",", "N'it''s'", ",", "[a]]b]", ",", "\"c\"", "FROM", "#t", "WHERE", "x", "<>", "2", "-- note",
+                                    "/* a /* b */ c */"}));
+
+    const auto tokens = stream.view().tokens;
+    EXPECT_EQ(tokens[0].kind, SqlTokenKind::Word);
+    EXPECT_EQ(tokens[1].kind, SqlTokenKind::Word);
+    EXPECT_EQ(tokens[3].kind, SqlTokenKind::Number);
+    EXPECT_EQ(tokens[5].kind, SqlTokenKind::String);
+    EXPECT_EQ(tokens[7].kind, SqlTokenKind::QuotedIdentifier);
+    EXPECT_EQ(tokens[9].kind, SqlTokenKind::QuotedIdentifier);
+    EXPECT_EQ(tokens[14].kind, SqlTokenKind::Symbol);
+    EXPECT_EQ(tokens[16].kind, SqlTokenKind::LineComment);
+    EXPECT_EQ(tokens[17].kind, SqlTokenKind::BlockComment);
+    EXPECT_EQ(stream.view().name(tokens[7]), "a]]b");
+    EXPECT_TRUE(stream.view().isKeyword(tokens[10], "FROM"));
+    EXPECT_FALSE(stream.view().isKeyword(tokens[9], "C"));
+}
+
+TEST(SqlLexerTest, TracksLinesAndLineStarts) {
+    const SqlTokenStream stream("SELECT 'a\nb'\n  FROM t /* x\ny */ WHERE\nGO");
+    const auto tokens = stream.view().tokens;
+    ASSERT_EQ(tokens.size(), 7u);
+    EXPECT_EQ(tokens[0].line, 1u);
+    EXPECT_TRUE(tokens[0].lineStart);
+    EXPECT_FALSE(tokens[1].lineStart);
+    EXPECT_EQ(tokens[2].line, 3u);  // FROM, after the two-line string
+    EXPECT_TRUE(tokens[2].lineStart);
+    EXPECT_EQ(tokens[5].line, 4u);  // WHERE, after the two-line comment
+    EXPECT_FALSE(tokens[5].lineStart);
+    EXPECT_EQ(tokens[6].line, 5u);
+    EXPECT_TRUE(tokens[6].lineStart);
+}
+
+TEST(SqlLexerTest, UnterminatedTokensRunToTheEnd) {
+    EXPECT_EQ(texts(SqlTokenStream("SELECT 'abc")), (Texts{"SELECT", "'abc"}));
+    EXPECT_EQ(texts(SqlTokenStream("SELECT [abc")), (Texts{"SELECT", "[abc"}));
+    EXPECT_EQ(texts(SqlTokenStream("SELECT /* /* */ x")), (Texts{"SELECT", "/* /* */ x"}));
+    EXPECT_TRUE(texts(SqlTokenStream(" \r\n\t")).empty());
+}
+
+TEST(SqlLexerTest, SourceSpansFirstToLastToken) {
+    const SqlTokenStream stream("  SELECT a  ,  b  ");
+    EXPECT_EQ(stream.view().source(), "SELECT a  ,  b");
+    EXPECT_EQ(stream.view().subspan(1, 3).source(), "a  ,  b");
+    EXPECT_TRUE(stream.view().subspan(0, 0).source().empty());
+}
+
+}  // namespace test
+}  // namespace velocitydb
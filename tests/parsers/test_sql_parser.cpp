@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "parsers/sql_parser.h"
+
+namespace velocitydb {
+namespace test {
+
+using Tables = std::vector<std::string>;
+
+TEST(SQLParserTest, ExtractsTablesFromSelect) {
+    EXPECT_EQ(SQLParser::extractTableReferences("SELECT * FROM dbo.Users u INNER JOIN [Sales].[Orders] AS o ON o.UserId = u.Id"), (Tables{"orders", "users"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("select a.x from Alpha a, Beta, Gamma as g where 1 = 1"), (Tables{"alpha", "beta", "gamma"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("SELECT * FROM Reporting..Daily"), (Tables{"daily"}));
+    EXPECT_TRUE(SQLParser::extractTableReferences("SELECT 1").empty());
+}
+
+TEST(SQLParserTest, ExtractsDmlAndDdlTargets) {
+    EXPECT_EQ(SQLParser::extractTableReferences("INSERT INTO Logs (msg) SELECT msg FROM Staging"), (Tables{"logs", "staging"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("UPDATE Users SET name = 'x' WHERE id = 1"), (Tables{"users"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("DELETE Users WHERE id = 1"), (Tables{"users"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("DELETE FROM Users"), (Tables{"users"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("MERGE INTO Target t USING Source s ON t.id = s.id WHEN MATCHED THEN DELETE;"), (Tables{"source", "target"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("TRUNCATE TABLE dbo.Events"), (Tables{"events"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("DROP TABLE [My Table]"), (Tables{"my table"}));
+}
+
+TEST(SQLParserTest, IgnoresCommentsLiteralsAndVariables) {
+    EXPECT_EQ(SQLParser::extractTableReferences("SELECT 'from fake' AS s, N'join other' FROM Real -- from comment\n/* join hidden */"), (Tables{"real"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("SELECT 'it''s from x' FROM Real"), (Tables{"real"}));
+    EXPECT_EQ(SQLParser::extractTableReferences("SELECT * FROM @rows r JOIN (SELECT id FROM Inner1) d ON d.id = r.id"), (Tables{"inner1"}));
+}
+
+TEST(SQLParserTest, DetectsSessionIndependentReads) {
+    EXPECT_TRUE(SQLParser::isSessionIndependent("SELECT * FROM Users"));
+    EXPECT_TRUE(SQLParser::isSessionIndependent("SELECT 1; WITH c AS (SELECT 2 AS n) SELECT n FROM c"));
+    EXPECT_TRUE(SQLParser::isSessionIndependent("SELECT 'into #x' AS s FROM [Users]"));
+    EXPECT_FALSE(SQLParser::isSessionIndependent("SELECT * FROM #work"));
+    EXPECT_FALSE(SQLParser::isSessionIndependent("SELECT * INTO Backup FROM Users"));
+    EXPECT_FALSE(SQLParser::isSessionIndependent("SELECT 1; DELETE FROM Users"));
+    EXPECT_FALSE(SQLParser::isSessionIndependent("BEGIN TRANSACTION"));
+    EXPECT_FALSE(SQLParser::isSessionIndependent(""));
+}
+
+using Statements = std::vector<std::string>;
+
+TEST(SQLParserTest, SplitsOnTopLevelSemicolonsOnly) {
+    EXPECT_EQ(SQLParser::splitStatements("SELECT 1;  SELECT 2 ;"), (Statements{"SELECT 1", "SELECT 2"}));
+    EXPECT_EQ(SQLParser::splitStatements("SELECT 'a;b', N'it''s;' AS [x;y]; SELECT \"c;d\""), (Statements{"SELECT 'a;b', N'it''s;' AS [x;y]", "SELECT \"c;d\""}));
+    EXPECT_EQ(SQLParser::splitStatements("SELECT 1 -- one; two\n; /* a; /* nested; */ b; */ SELECT 2"), (Statements{"SELECT 1 -- one; two", "SELECT 2"}));
+    EXPECT_EQ(SQLParser::splitStatements("IF 1 = 1 BEGIN SELECT 1; SELECT CASE WHEN 1 = 1 THEN 2 END; END; SELECT 3"),
+              (Statements{"IF 1 = 1 BEGIN SELECT 1; SELECT CASE WHEN 1 = 1 THEN 2 END; END", "SELECT 3"}));
+    EXPECT_EQ(SQLParser::splitStatements("BEGIN TRAN; UPDATE t SET a = 1; COMMIT"), (Statements{"BEGIN TRAN", "UPDATE t SET a = 1", "COMMIT"}));
+    EXPECT_EQ(SQLParser::splitStatements("SELECT 1; -- trailing note only"), (Statements{"SELECT 1"}));
+}
+
+TEST(SQLParserTest, SplitsGoBatches) {
+    EXPECT_EQ(SQLParser::splitStatements("SELECT 1\nGO\nSELECT 2\r\ngo -- done\r\nSELECT 3"), (Statements{"SELECT 1", "SELECT 2", "SELECT 3"}));
+    EXPECT_EQ(SQLParser::splitStatements("INSERT INTO t DEFAULT VALUES; SELECT 1\nGO 3\nSELECT 2"),
+              (Statements{"INSERT INTO t DEFAULT VALUES", "SELECT 1", "INSERT INTO t DEFAULT VALUES", "SELECT 1", "INSERT INTO t DEFAULT VALUES", "SELECT 1", "SELECT 2"}));
+    // GO inside a literal, a word starting with GO, and GO followed by code are not separators
+    EXPECT_EQ(SQLParser::splitStatements("SELECT '\nGO\n'\nGOTO done\nGO x"), (Statements{"SELECT '\nGO\n'\nGOTO done\nGO x"}));
+}
+
+TEST(SQLParserTest, ModuleBodiesRunToTheEndOfTheBatch) {
+    const std::string script = "CREATE OR ALTER PROCEDURE dbo.p AS\nSELECT 1;\nSELECT 2;\nGO\nEXEC dbo.p;\nALTER VIEW v AS SELECT 1 AS a;\n";
+    EXPECT_EQ(SQLParser::splitStatements(script), (Statements{"CREATE OR ALTER PROCEDURE dbo.p AS\nSELECT 1;\nSELECT 2;", "EXEC dbo.p", "ALTER VIEW v AS SELECT 1 AS a;"}));
+    EXPECT_EQ(SQLParser::splitStatements("CREATE TABLE t (a INT); SELECT 1"), (Statements{"CREATE TABLE t (a INT)", "SELECT 1"}));
+}
+
+TEST(SQLParserTest, DetectsScriptsThatFitOneBatch) {
+    EXPECT_TRUE(SQLParser::fitsSingleBatch("USE db; SELECT 1; UPDATE t SET a = 1; SELECT 2"));
+    EXPECT_TRUE(SQLParser::fitsSingleBatch("CREATE PROCEDURE p AS SELECT 1; SELECT 2"));  // The body takes the batch
+    EXPECT_TRUE(SQLParser::fitsSingleBatch("CREATE TABLE t (a INT); INSERT INTO t VALUES (1)\nGO"));
+    EXPECT_FALSE(SQLParser::fitsSingleBatch("SELECT 1\nGO\nSELECT 2"));
+    EXPECT_FALSE(SQLParser::fitsSingleBatch("INSERT INTO t DEFAULT VALUES\nGO 5"));
+    EXPECT_FALSE(SQLParser::fitsSingleBatch("DROP VIEW v; CREATE OR ALTER VIEW v AS SELECT 1 AS a"));
+    EXPECT_FALSE(SQLParser::fitsSingleBatch("SELECT 1; CREATE SCHEMA s"));
+}
+
+TEST(SQLParserTest, SplitScriptReportsPositionsIntoTheScript) {
+    const std::string script = "-- header\nSELECT 1;\n/* two\nlines */ SELECT\n  2\nGO 2\nSELECT 3";
+    const auto spans = SQLParser::splitScript(script);
+
+    ASSERT_EQ(spans.size(), 3u);
+    EXPECT_EQ(spans[0].text, "SELECT 1");
+    EXPECT_EQ(spans[0].line, 2u);
+    EXPECT_EQ(spans[1].text, "SELECT\n  2");
+    EXPECT_EQ(spans[1].line, 4u);
+    EXPECT_EQ(spans[1].batch, 0u);
+    EXPECT_EQ(spans[1].repeat, 2u);
+    EXPECT_EQ(spans[2].line, 7u);
+    EXPECT_EQ(spans[2].batch, 1u);
+    EXPECT_EQ(spans[2].repeat, 1u);
+    for (const auto& span : spans) {
+        // Views into the caller's buffer, not copies
+        EXPECT_EQ(span.text.data(), script.data() + span.offset);
+    }
+}
+
+TEST(SQLParserTest, ClassifiesStatementsAfterLeadingComments) {
+    EXPECT_TRUE(SQLParser::isReadOnlyQuery("-- report\n/* v2 */ SELECT * FROM Users"));
+    EXPECT_FALSE(SQLParser::isReadOnlyQuery("/* SELECT */ DELETE FROM Users"));
+    EXPECT_EQ(SQLParser::parseSQL("-- note\nupdate Users set a = 1").type, "UPDATE");
+    EXPECT_TRUE(SQLParser::isUseStatement("/* switch */ USE [Sales]"));
+    EXPECT_EQ(SQLParser::extractDatabaseName("/* switch */ USE [Sales]"), "Sales");
+}
+
+TEST(SQLParserTest, TokenOverloadsShareOneLexedScript) {
+    const std::string script = "USE db; SELECT a FROM Users -- x\n; DELETE FROM Logs";
+    const SqlTokenStream stream(script);
+    const auto statements = SQLParser::splitStatementTokens(stream);
+
+    ASSERT_EQ(statements.size(), 3u);
+    EXPECT_EQ(statements[0].source(), "USE db");
+    EXPECT_EQ(statements[1].source(), "SELECT a FROM Users -- x");
+    EXPECT_EQ(statements[2].source(), "DELETE FROM Logs");
+    EXPECT_TRUE(SQLParser::isUseStatement(statements[0]));
+    EXPECT_EQ(SQLParser::extractDatabaseName(statements[0]), "db");
+    EXPECT_TRUE(SQLParser::isReadOnlyQuery(statements[1]));
+    EXPECT_EQ(SQLParser::extractTableReferences(statements[1]), (Tables{"users"}));
+    EXPECT_EQ(SQLParser::parseSQL(statements[2]).type, "DELETE");
+    for (const auto& statement : statements) {
+        EXPECT_EQ(statement.sql.data(), script.data());
+    }
+}
+
+TEST(SQLParserTest, FingerprintIgnoresLayoutCommentsAndKeywordCase) {
+    const auto expected = "SELECT id , Name FROM dbo . Users WHERE id = 5 AND Name = 'x  y'";
+    EXPECT_EQ(SQLParser::fingerprint("select id,Name\n  from dbo.Users /* all */ where id=5 and Name = 'x  y';"), expected);
+    EXPECT_EQ(SQLParser::fingerprint("SELECT id, Name FROM dbo.Users -- note\nWHERE id = 5 AND Name = 'x  y'"), expected);
+    // Identifiers keep their case: a case-sensitive collation tells them apart
+    EXPECT_NE(SQLParser::fingerprint("SELECT ID FROM users"), SQLParser::fingerprint("SELECT id FROM users"));
+    EXPECT_NE(SQLParser::fingerprint("SELECT 1"), SQLParser::fingerprint("SELECT 2"));
+}
+
+TEST(SQLParserTest, ParameterizedFingerprintFoldsLiteralsAndLists) {
+    EXPECT_EQ(SQLParser::fingerprint("SELECT * FROM t WHERE id IN (1, 2, 3) AND name = N'a'", true), "SELECT * FROM t WHERE id IN ( ? ) AND name = ?");
+    EXPECT_EQ(SQLParser::fingerprint("select * from t where id in (7) and name = 'b'", true), "SELECT * FROM t WHERE id IN ( ? ) AND name = ?");
+    EXPECT_EQ(SQLParser::fingerprintHash(SQLParser::fingerprint("SELECT 1", true)), SQLParser::fingerprintHash(SQLParser::fingerprint("select 42;", true)));
+    EXPECT_EQ(SQLParser::fingerprint("-- only a comment"), "");
+}
+
+}  // namespace test
+}  // namespace velocitydb
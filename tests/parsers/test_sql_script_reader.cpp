@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "parsers/sql_script_reader.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::vector<ScriptBatch> readAll(std::string_view script, size_t maxBatchTokens = SqlScriptReader::DEFAULT_MAX_BATCH_TOKENS) {
+    SqlScriptReader reader(script, maxBatchTokens);
+    std::vector<ScriptBatch> batches;
+    while (auto batch = reader.next()) {
+        batches.push_back(*batch);
+    }
+    return batches;
+}
+
+}  // namespace
+
+TEST(SqlScriptReaderTest, SplitsAtGoLinesWithTheirCounts) {
+    const std::string script = "-- header\nCREATE TABLE t (id int)\ngo\n\nINSERT t VALUES (1); SELECT 'GO'\nGO 3 -- thrice\n/* only a comment */\nGO\nSELECT 1\n  GO x\nSELECT 2";
+    const auto batches = readAll(script);
+    ASSERT_EQ(batches.size(), 3);
+    EXPECT_EQ(batches[0].text, "CREATE TABLE t (id int)");
+    EXPECT_EQ(batches[0].line, 2);
+    EXPECT_EQ(batches[0].offset, script.find("CREATE"));
+    EXPECT_EQ(batches[1].text, "INSERT t VALUES (1); SELECT 'GO'");
+    EXPECT_EQ(batches[1].repeat, 3);
+    EXPECT_EQ(batches[1].index, 1);
+    // `GO x` is not a separator; the comment-only batch is skipped
+    EXPECT_EQ(batches[2].text, "SELECT 1\n  GO x\nSELECT 2");
+    EXPECT_EQ(batches[2].index, 2);
+    EXPECT_FALSE(batches[2].partial);
+    EXPECT_TRUE(readAll("  -- nothing\n GO\n").empty());
+}
+
+TEST(SqlScriptReaderTest, CutsALargeBatchAtStatementBoundaries) {
+    std::string script;
+    for (int i = 0; i < 50; ++i) {
+        script += "INSERT t VALUES (" + std::to_string(i) + ");\n";
+    }
+    script += "GO 2\nSELECT 1";
+    const auto batches = readAll(script, 16);
+    ASSERT_GT(batches.size(), 3);
+    std::string joined;
+    for (size_t i = 0; i + 1 < batches.size(); ++i) {
+        EXPECT_TRUE(batches[i].partial);
+        EXPECT_EQ(batches[i].repeat, 1);
+        EXPECT_EQ(batches[i].index, 0);
+        EXPECT_EQ(batches[i].text.substr(0, 6), "INSERT");
+        EXPECT_EQ(script.substr(batches[i].offset, batches[i].text.size()), batches[i].text);
+        joined += batches[i].text;
+    }
+    // Every statement appears once, in order
+    EXPECT_NE(joined.find("VALUES (0)"), std::string::npos);
+    EXPECT_NE(joined.find("VALUES (49)"), std::string::npos);
+    EXPECT_LT(joined.find("VALUES (48)"), joined.find("VALUES (49)"));
+    EXPECT_EQ(batches.back().text, "SELECT 1");
+    EXPECT_EQ(batches.back().index, 1);
+    EXPECT_FALSE(batches.back().partial);
+}
+
+TEST(SqlScriptReaderTest, KeepsAModuleBodyWholeUpToTheLimit) {
+    std::string body = "CREATE PROCEDURE p AS BEGIN\n";
+    for (int i = 0; i < 20; ++i) {
+        body += "SET NOCOUNT ON;\n";
+    }
+    body += "END";
+    const std::string script = body + "\nGO\nEXEC p";
+    const auto batches = readAll(script, 16);
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0].text, body);
+    EXPECT_FALSE(batches[0].partial);
+
+    EXPECT_THROW(readAll(body, 2), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <simdjson.h>
 
 #include "providers/settings_provider.h"
 #include "utils/settings_manager.h"
@@ -10,6 +11,10 @@ namespace {
 class SettingsProviderTest : public ::testing::Test {
 protected:
     SettingsProvider provider;
+    simdjson::dom::parser parser;
+
+    /// Parse a params literal the way IPCHandler hands it to providers
+    simdjson::dom::element params(std::string_view json) { return parser.parse(json).value(); }
 };
 
 TEST_F(SettingsProviderTest, AccessSettingsManager) {
@@ -34,21 +39,21 @@ TEST_F(SettingsProviderTest, AccessSessionManager) {
 
 TEST_F(SettingsProviderTest, GetProfilePasswordNotFound) {
     // Non-existent profile should return error JSON
-    auto result = provider.getProfilePassword(R"({"id":"non_existent_profile_id"})");
+    auto result = provider.getProfilePassword(params(R"({"id":"non_existent_profile_id"})"));
     EXPECT_FALSE(result.empty());
     EXPECT_NE(result.find("error"), std::string::npos);
 }
 
 TEST_F(SettingsProviderTest, GetSshPasswordNotFound) {
     // Non-existent profile should return error JSON
-    auto result = provider.getSshPassword(R"({"id":"non_existent_profile_id"})");
+    auto result = provider.getSshPassword(params(R"({"id":"non_existent_profile_id"})"));
     EXPECT_FALSE(result.empty());
     EXPECT_NE(result.find("error"), std::string::npos);
 }
 
 TEST_F(SettingsProviderTest, DeleteNonExistentProfile) {
     // Deleting non-existent profile should succeed (idempotent)
-    auto result = provider.deleteConnectionProfile(R"({"id":"non_existent_profile_id"})");
+    auto result = provider.deleteConnectionProfile(params(R"({"id":"non_existent_profile_id"})"));
     EXPECT_FALSE(result.empty());
 }
 
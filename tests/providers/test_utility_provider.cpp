@@ -2,6 +2,7 @@
 #include <simdjson.h>
 
 #include "providers/utility_provider.h"
+#include "utils/metrics.h"
 
 namespace velocitydb {
 namespace test {
@@ -9,28 +10,49 @@ namespace test {
 class UtilityProviderTest : public ::testing::Test {
 protected:
     UtilityProvider provider;
+    simdjson::dom::parser parser;
+
+    /// Parse a params literal the way IPCHandler hands it to providers
+    simdjson::dom::element params(std::string_view json) { return parser.parse(json).value(); }
 };
 
 // --- uppercaseKeywords ---
 
 TEST_F(UtilityProviderTest, UppercaseKeywords) {
-    auto result = provider.uppercaseKeywords(R"({"sql":"select * from users"})");
+    auto result = provider.uppercaseKeywords(params(R"({"sql":"select * from users"})"));
     EXPECT_NE(result.find("SELECT"), std::string::npos);
     EXPECT_NE(result.find("FROM"), std::string::npos);
 }
 
 TEST_F(UtilityProviderTest, UppercaseKeywordsMissingSql) {
-    auto result = provider.uppercaseKeywords(R"({"query":"select"})");
+    auto result = provider.uppercaseKeywords(params(R"({"query":"select"})"));
     EXPECT_NE(result.find("error"), std::string::npos);
 }
 
+TEST_F(UtilityProviderTest, UppercaseKeywordsInLineRange) {
+    auto result = provider.uppercaseKeywords(params(R"({"sql":"select a\nfrom  t\nwhere b = 1","firstLine":1,"lastLine":1})"));
+    EXPECT_NE(result.find(R"("sql":"FROM  t","firstLine":1,"lastLine":1)"), std::string::npos);
+}
+
+// --- formatSQL ---
+
+TEST_F(UtilityProviderTest, FormatSQL) {
+    auto result = provider.formatSQL(params(R"({"sql":"select a from t"})"));
+    EXPECT_NE(result.find(R"("sql":"SELECT a\nFROM t")"), std::string::npos);
+}
+
+TEST_F(UtilityProviderTest, FormatSQLLineRange) {
+    auto result = provider.formatSQL(params(R"({"sql":"select a from t;\nselect b from u;","firstLine":1,"lastLine":1})"));
+    EXPECT_NE(result.find(R"("sql":"SELECT b\nFROM u ;","firstLine":1,"lastLine":1)"), std::string::npos);
+}
+
 // --- parseERDiagram ---
 
 TEST_F(UtilityProviderTest, ParseERDiagramWithContent) {
-    auto result = provider.parseERDiagram(R"({
+    auto result = provider.parseERDiagram(params(R"({
         "content": "# A5:ER FORMAT:19\n\n[Entity]\nPName=users\nLName=User\nField=\"id\",\"id\",\"INT\",\"NOT NULL\",0,\"\",\"\"\nDEL\n",
         "filename": "test.a5er"
-    })");
+    })"));
 
     EXPECT_NE(result.find("\"success\":true"), std::string::npos);
     EXPECT_NE(result.find("\"name\":\"users\""), std::string::npos);
@@ -38,10 +60,10 @@ TEST_F(UtilityProviderTest, ParseERDiagramWithContent) {
 }
 
 TEST_F(UtilityProviderTest, ParseERDiagramJsonStructure) {
-    auto result = provider.parseERDiagram(R"({
+    auto result = provider.parseERDiagram(params(R"({
         "content": "# A5:ER FORMAT:19\n\n[Entity]\nPName=users\nLName=User\nColor=$00FF00\nField=\"id\",\"id\",\"INT\",\"NOT NULL\",0,\"\",\"\"\nField=\"name\",\"name\",\"VARCHAR\",\"\",,,\"\",\"$FF008040\"\nDEL\n\n[Shape]\nShapeType=Rectangle\nText=memo\nBrushColor=$00FF00\nLeft=100\nTop=200\nWidth=300\nHeight=150\nPage=Main\nDEL\n",
         "filename": "test.a5er"
-    })");
+    })"));
 
     simdjson::dom::parser parser;
     auto doc = parser.parse(result);
@@ -81,34 +103,72 @@ TEST_F(UtilityProviderTest, ParseERDiagramJsonStructure) {
 
 TEST_F(UtilityProviderTest, ParseERDiagramMissingContent) {
     simdjson::dom::parser p;
-    auto result = provider.parseERDiagram(R"({})");
+    auto result = provider.parseERDiagram(params(R"({})"));
     auto doc = p.parse(result);
     EXPECT_FALSE(doc["success"].get_bool().value());
     EXPECT_FALSE(doc["error"].get_string().error());
 }
 
+TEST_F(UtilityProviderTest, LayoutERModelPlacesOnlyUnpositionedTables) {
+    simdjson::dom::parser p;
+    auto result = provider.layoutERModel(params(R"({
+        "tables": [
+            {"name":"users","columns":[{"name":"id","type":"INT"}],"posX":400,"posY":300},
+            {"name":"orders","columns":[{"name":"id","type":"INT"},{"name":"user_id","type":"INT"}]}
+        ],
+        "relations": [{"parentTable":"users","childTable":"orders"}]
+    })"));
+    auto doc = p.parse(result);
+    ASSERT_TRUE(doc["success"].get_bool().value());
+    EXPECT_EQ(doc["data"]["placed"].get_uint64().value(), 1u);
+
+    auto tables = doc["data"]["tables"].get_array().value();
+    ASSERT_EQ(tables.size(), 2);
+    EXPECT_EQ(tables.at(0)["posX"].get_double().value(), 400);
+    EXPECT_EQ(tables.at(0)["posY"].get_double().value(), 300);
+    EXPECT_GT(tables.at(1)["width"].get_double().value(), 0);
+}
+
+TEST_F(UtilityProviderTest, LayoutERModelMissingTables) {
+    simdjson::dom::parser p;
+    auto doc = p.parse(provider.layoutERModel(params(R"({})")));
+    EXPECT_FALSE(doc["success"].get_bool().value());
+}
+
 // --- filepath branch ---
 
 TEST_F(UtilityProviderTest, ParseERDiagramPathTraversal) {
     simdjson::dom::parser p;
-    auto result = provider.parseERDiagram(R"({"filepath":"../etc/passwd"})");
+    auto result = provider.parseERDiagram(params(R"({"filepath":"../etc/passwd"})"));
     auto doc = p.parse(result);
     EXPECT_FALSE(doc["success"].get_bool().value());
 }
 
 TEST_F(UtilityProviderTest, ParseERDiagramFileNotFound) {
     simdjson::dom::parser p;
-    auto result = provider.parseERDiagram(R"({"filepath":"C:/nonexistent_dir/test.a5er"})");
+    auto result = provider.parseERDiagram(params(R"({"filepath":"C:/nonexistent_dir/test.a5er"})"));
     auto doc = p.parse(result);
     EXPECT_FALSE(doc["success"].get_bool().value());
 }
 
 TEST_F(UtilityProviderTest, ParseERDiagramUnrecognisedFormat) {
     simdjson::dom::parser p;
-    auto result = provider.parseERDiagram(R"({"content":"not an ER format","filename":"test.txt"})");
+    auto result = provider.parseERDiagram(params(R"({"content":"not an ER format","filename":"test.txt"})"));
     auto doc = p.parse(result);
     EXPECT_FALSE(doc["success"].get_bool().value());
 }
 
+// --- getMetrics ---
+
+TEST_F(UtilityProviderTest, GetMetricsReturnsRegistrySnapshot) {
+    MetricsRegistry::instance().counter("test.utility_provider").add(5);
+    auto result = provider.getMetrics(params("{}"));
+
+    simdjson::dom::parser parser;
+    auto doc = parser.parse(result);
+    EXPECT_TRUE(doc["success"].get_bool().value());
+    EXPECT_EQ(doc["data"]["counters"]["test.utility_provider"].get_uint64().value(), 5u);
+}
+
 }  // namespace test
 }  // namespace velocitydb
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "utils/logger.h"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class AsyncFileLogOutputTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "velocitydb_async_log_test";
+    std::filesystem::path logPath = directory / "nested" / "backend.log";
+
+    void SetUp() override { std::filesystem::remove_all(directory); }
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    [[nodiscard]] std::vector<std::string> lines() const {
+        std::ifstream in(logPath);
+        std::vector<std::string> out;
+        for (std::string line; std::getline(in, line);) {
+            out.push_back(line);
+        }
+        return out;
+    }
+};
+
+TEST_F(AsyncFileLogOutputTest, DrainWritesEveryRecordInOrderPerThread) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 2000;
+    AsyncFileLogOutput output(logPath.string(), 64, LogOverflowPolicy::BLOCK, false);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t) {
+        writers.emplace_back([&output, t] {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                output.write(LogLevel::INFO, std::format("t{} n{}", t, i));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    output.drain();
+
+    const auto written = lines();
+    ASSERT_EQ(written.size(), static_cast<size_t>(THREADS * PER_THREAD));
+    std::vector<int> next(THREADS, 0);
+    for (const auto& line : written) {
+        EXPECT_NE(line.find("] [INFO] t"), std::string::npos) << line;
+        const auto pos = line.rfind(" t");
+        const int thread = std::stoi(line.substr(pos + 2));
+        const int n = std::stoi(line.substr(line.rfind('n') + 1));
+        EXPECT_EQ(n, next[thread]++);
+    }
+    EXPECT_EQ(output.dropped(), 0u);
+}
+
+TEST_F(AsyncFileLogOutputTest, DropPolicyCountsWhatDidNotFit) {
+    constexpr int TOTAL = 20000;
+    uint64_t dropped = 0;
+    {
+        AsyncFileLogOutput output(logPath.string(), 8, LogOverflowPolicy::DROP, false);
+        for (int i = 0; i < TOTAL; ++i) {
+            output.write(LogLevel::DEBUG, std::format("record {}", i));
+        }
+        output.drain();
+        dropped = output.dropped();
+    }
+
+    size_t records = 0;
+    size_t reported = 0;
+    for (const auto& line : lines()) {
+        if (line.find("[DEBUG] record ") != std::string::npos) {
+            ++records;
+        } else if (const auto pos = line.find("[WARN] "); pos != std::string::npos) {
+            reported += std::stoul(line.substr(pos + 7));
+        }
+    }
+    EXPECT_EQ(records + dropped, static_cast<uint64_t>(TOTAL));
+    EXPECT_EQ(reported, dropped);
+}
+
+TEST_F(AsyncFileLogOutputTest, CriticalIsOnDiskWhenWriteReturns) {
+    AsyncFileLogOutput output(logPath.string(), AsyncFileLogOutput::DEFAULT_CAPACITY, LogOverflowPolicy::DROP, false);
+    output.write(LogLevel::INFO, "before");
+    output.write(LogLevel::CRITICAL, "fatal");
+
+    const auto written = lines();
+    ASSERT_EQ(written.size(), 2u);
+    EXPECT_NE(written[1].find("[CRIT] fatal"), std::string::npos);
+}
+
+TEST_F(AsyncFileLogOutputTest, WriteBlockKeepsPreformattedLines) {
+    AsyncFileLogOutput output(logPath.string(), AsyncFileLogOutput::DEFAULT_CAPACITY, LogOverflowPolicy::DROP, false);
+    output.write_block("[ts1] [INFO] first\n[ts2] [ERROR] second\n");
+    output.write_block("");
+    output.drain();
+
+    const auto written = lines();
+    ASSERT_EQ(written.size(), 2u);
+    EXPECT_EQ(written[0], "[ts1] [INFO] first");
+    EXPECT_EQ(written[1], "[ts2] [ERROR] second");
+}
+
+TEST_F(AsyncFileLogOutputTest, DestructorWritesPendingRecords) {
+    {
+        AsyncFileLogOutput output(logPath.string(), AsyncFileLogOutput::DEFAULT_CAPACITY, LogOverflowPolicy::DROP, false);
+        output.write(LogLevel::WARNING, "pending");
+        output.flush();  // Does not wait
+    }
+    ASSERT_EQ(lines().size(), 1u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
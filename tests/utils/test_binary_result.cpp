@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "utils/binary_result.h"
+
+#include <cstring>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+template <typename T>
+T readAt(const std::string& data, size_t offset) {
+    T value{};
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+TEST(BinaryResultEncoderTest, EncodesColumnarLayout) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "INT"});
+    result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData[0].appendInt64(7);
+    result.columnData[1].appendText("seven");
+    result.columnData[0].appendNull();
+    result.columnData[1].appendText("");
+    result.affectedRows = 2;
+    result.executionTimeMs = 1.5;
+
+    auto data = BinaryResultEncoder::encode(result);
+    ASSERT_EQ(data.size(), BinaryResultEncoder::encodedSize(result));
+    ASSERT_EQ(data.size() % 8, 0u);
+
+    EXPECT_EQ(data.substr(0, 4), "VDBR");
+    EXPECT_EQ(readAt<uint16_t>(data, 4), BinaryResultEncoder::VERSION);
+    EXPECT_EQ(readAt<uint32_t>(data, 8), 2u);
+    EXPECT_EQ(readAt<uint64_t>(data, 16), 2u);
+    EXPECT_EQ(readAt<int64_t>(data, 24), 2);
+    EXPECT_DOUBLE_EQ(readAt<double>(data, 32), 1.5);
+
+    // Column descriptors: 16 fixed bytes + name + type, padded to 8
+    size_t pos = BinaryResultEncoder::HEADER_BYTES;
+    EXPECT_EQ(readAt<uint8_t>(data, pos), static_cast<uint8_t>(ColumnDataType::Int64));
+    EXPECT_EQ(readAt<uint32_t>(data, pos + 8), 2u);
+    EXPECT_EQ(data.substr(pos + 16, 2), "id");
+    pos += 24;
+    EXPECT_EQ(readAt<uint8_t>(data, pos), static_cast<uint8_t>(ColumnDataType::Text));
+    EXPECT_EQ(data.substr(pos + 16, 4), "name");
+    pos += 32;
+
+    // Int64 column: null word, then values
+    EXPECT_EQ(readAt<uint64_t>(data, pos), 0b10u);
+    EXPECT_EQ(readAt<int64_t>(data, pos + 8), 7);
+    pos += 24;
+
+    // Text column: null word, u32 offsets (padded), chars (padded)
+    EXPECT_EQ(readAt<uint64_t>(data, pos), 0u);
+    EXPECT_EQ(readAt<uint32_t>(data, pos + 8), 0u);
+    EXPECT_EQ(readAt<uint32_t>(data, pos + 12), 5u);
+    EXPECT_EQ(readAt<uint32_t>(data, pos + 16), 5u);
+    EXPECT_EQ(data.substr(pos + 24, 5), "seven");
+    EXPECT_EQ(pos + 32, data.size());
+}
+
+TEST(BinaryResultEncoderTest, EncodesColumnsWithoutRows) {
+    ResultSet result;
+    result.columns.push_back({.name = "d", .type = "DATE"});
+
+    auto data = BinaryResultEncoder::encode(result);
+    EXPECT_EQ(readAt<uint32_t>(data, 8), 1u);
+    EXPECT_EQ(readAt<uint64_t>(data, 16), 0u);
+    EXPECT_EQ(data.size(), BinaryResultEncoder::encodedSize(result));
+}
+
+TEST(BinaryResultDecoderTest, RoundTripsEveryStorageType) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "BIGINT", .size = 8, .nullable = false, .isPrimaryKey = true});
+    result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+    result.columns.push_back({.name = "price", .type = "FLOAT"});
+    result.columns.push_back({.name = "active", .type = "BIT"});
+    result.columns.push_back({.name = "created", .type = "DATETIME2"});
+    result.columns.push_back({.name = "hash", .type = "VARBINARY"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData.emplace_back(ColumnDataType::Double);
+    result.columnData.emplace_back(ColumnDataType::Bit);
+    result.columnData.emplace_back(ColumnDataType::Timestamp, 3);
+    result.columnData.emplace_back(ColumnDataType::Binary);
+    for (int row = 0; row < 70; ++row) {
+        result.columnData[0].appendInt64(row * 1000);
+        if (row % 5 == 0)
+            result.columnData[1].appendNull();
+        else
+            result.columnData[1].appendText(std::string(row % 7, 'x'));
+        result.columnData[2].appendDouble(row / 4.0);
+        result.columnData[3].appendBit(row % 2 == 0);
+        result.columnData[4].appendFromText("2024-02-29 23:59:58.123");
+        if (row % 9 == 0)
+            result.columnData[5].appendNull();
+        else
+            result.columnData[5].appendBinary(std::string(row % 4, static_cast<char>(row * 29)));
+    }
+    result.affectedRows = 70;
+    result.executionTimeMs = 12.5;
+    result.truncated = true;
+
+    auto decoded = BinaryResultDecoder::decode(BinaryResultEncoder::encode(result));
+    ASSERT_EQ(decoded.rowCount(), result.rowCount());
+    ASSERT_EQ(decoded.columns.size(), result.columns.size());
+    EXPECT_EQ(decoded.affectedRows, 70);
+    EXPECT_DOUBLE_EQ(decoded.executionTimeMs, 12.5);
+    EXPECT_TRUE(decoded.truncated);
+    EXPECT_TRUE(decoded.columns[0].isPrimaryKey);
+    EXPECT_FALSE(decoded.columns[0].nullable);
+    EXPECT_EQ(decoded.columns[4].type, "DATETIME2");
+    for (size_t col = 0; col < result.columns.size(); ++col) {
+        EXPECT_EQ(decoded.columnData[col].type(), result.columnData[col].type());
+        for (size_t row = 0; row < result.rowCount(); ++row) {
+            EXPECT_EQ(decoded.isNull(row, col), result.isNull(row, col)) << col << "," << row;
+            EXPECT_EQ(decoded.cellText(row, col), result.cellText(row, col)) << col << "," << row;
+        }
+    }
+}
+
+TEST(BinaryResultDecoderTest, RejectsTruncatedPayload) {
+    ResultSet result;
+    result.appendRow({"value"});
+    auto data = BinaryResultEncoder::encode(result);
+    EXPECT_THROW((void)BinaryResultDecoder::decode(std::string_view(data).substr(0, data.size() - 9)), std::runtime_error);
+    EXPECT_THROW((void)BinaryResultDecoder::decode("not a result"), std::runtime_error);
+}
+
+TEST(BinaryResultStoreTest, HandsOutEachEntryOnce) {
+    BinaryResultStore store(16);
+    auto first = store.put("0123456789");
+    EXPECT_EQ(store.totalBytes(), 10u);
+
+    // Exceeding the budget evicts the oldest entry
+    auto second = store.put("abcdefghij");
+    EXPECT_FALSE(store.take(first).has_value());
+
+    auto payload = store.take(second);
+    ASSERT_TRUE(payload.has_value());
+    EXPECT_EQ(*payload, "abcdefghij");
+    EXPECT_FALSE(store.take(second).has_value());
+    EXPECT_EQ(store.totalBytes(), 0u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "utils/bookmark_store.h"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class BookmarkStoreTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "velocitydb_bookmark_store_test";
+    std::filesystem::path path = directory / "bookmarks.json";
+
+    void SetUp() override { std::filesystem::remove_all(directory); }
+    void TearDown() override { std::filesystem::remove_all(directory); }
+};
+
+TEST_F(BookmarkStoreTest, ChangesSurviveReopening) {
+    {
+        BookmarkStore store(path);
+        EXPECT_EQ(store.json(), "[]");
+        store.save({.id = "a", .name = "First", .content = "SELECT 1"});
+        store.save({.id = "b", .name = "Second", .content = "SELECT \"2\""});
+        store.save({.id = "a", .name = "Renamed", .content = "SELECT 1"});
+        EXPECT_TRUE(store.remove("b"));
+        EXPECT_FALSE(store.remove("missing"));
+        store.save({.id = "c", .name = "Third", .content = ""});
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));  // Only the journal so far
+
+    BookmarkStore reopened(path);
+    EXPECT_EQ(reopened.json(), R"([{"id":"a","name":"Renamed","content":"SELECT 1"},{"id":"c","name":"Third","content":""}])");
+}
+
+TEST_F(BookmarkStoreTest, ReadsTheLegacyArrayAndDropsATornRecord) {
+    std::filesystem::create_directories(directory);
+    std::ofstream(path) << R"([{"id":"a","name":"A","content":"x"},{"id":"b","name":"B","content":"y"}])";
+    std::ofstream(directory / "bookmarks.jsonl", std::ios::binary) << R"({"op":"delete","id":"a"})" << '\n' << R"({"op":"save","id":"c","na)";
+
+    {
+        BookmarkStore store(path);
+        EXPECT_EQ(store.json(), R"([{"id":"b","name":"B","content":"y"}])");
+        store.save({.id = "d", .name = "D", .content = "z"});
+    }
+    BookmarkStore reopened(path);
+    EXPECT_EQ(reopened.json(), R"([{"id":"b","name":"B","content":"y"},{"id":"d","name":"D","content":"z"}])");
+}
+
+TEST_F(BookmarkStoreTest, RewritesTheArrayOnceTheJournalOutgrowsIt) {
+    {
+        BookmarkStore store(path);
+        for (size_t i = 0; i <= 2 * BookmarkStore::MIN_COMPACT_RECORDS; ++i) {
+            store.save({.id = std::format("id{}", i % 4), .name = std::format("v{}", i), .content = "SELECT 1"});
+        }
+        store.waitForCompaction();
+        EXPECT_TRUE(std::filesystem::exists(path));
+        EXPECT_FALSE(std::filesystem::exists(directory / "bookmarks.jsonl.old"));
+        std::ifstream journal(directory / "bookmarks.jsonl");
+        size_t records = 0;
+        for (std::string line; std::getline(journal, line);) {
+            ++records;
+        }
+        EXPECT_LE(records, BookmarkStore::MIN_COMPACT_RECORDS);
+        EXPECT_EQ(store.size(), 4u);
+    }
+    BookmarkStore reopened(path);
+    EXPECT_EQ(reopened.size(), 4u);
+    EXPECT_NE(reopened.json().find(std::format(R"("name":"v{}")", 2 * BookmarkStore::MIN_COMPACT_RECORDS)), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace velocitydb
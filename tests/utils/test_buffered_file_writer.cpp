@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "utils/buffered_file_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace velocitydb {
+namespace test {
+
+class BufferedFileWriterTest : public ::testing::Test {
+protected:
+    std::string testFilePath = "test_buffered_writer.bin";
+
+    void TearDown() override {
+        std::filesystem::remove(testFilePath);
+    }
+
+    std::string readBack() {
+        std::ifstream file(testFilePath, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+};
+
+TEST_F(BufferedFileWriterTest, WritesAcrossBufferBoundaries) {
+    BufferedFileWriter writer(8);
+    ASSERT_TRUE(writer.open(testFilePath));
+
+    writer.append("abc");
+    writer.append('d');
+    // Crosses the 8-byte buffer, then a payload larger than the buffer is written directly
+    writer.append("efghij");
+    writer.append(std::string(20, 'x'));
+    writer.append('!');
+    EXPECT_EQ(writer.bytesWritten(), 31);
+    ASSERT_TRUE(writer.close());
+
+    EXPECT_EQ(readBack(), "abcdefghij" + std::string(20, 'x') + "!");
+}
+
+TEST_F(BufferedFileWriterTest, FailsWithoutOpenFile) {
+    BufferedFileWriter writer(4);
+    writer.append("more than four");
+    EXPECT_TRUE(writer.failed());
+    EXPECT_FALSE(writer.close());
+}
+
+}  // namespace test
+}  // namespace velocitydb
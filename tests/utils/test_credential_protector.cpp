@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "utils/credential_protector.h"
+
+#include <chrono>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class CredentialProtectorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CredentialProtector::clearCache();
+        auto encrypted = CredentialProtector::encrypt("s3cr3t-password");
+        ASSERT_TRUE(encrypted.has_value()) << encrypted.error();
+        m_ciphertext = std::move(*encrypted);
+    }
+
+    void TearDown() override { CredentialProtector::clearCache(); }
+
+    std::string m_ciphertext;
+};
+
+TEST_F(CredentialProtectorTest, RoundTripsThroughDpapi) {
+    auto decrypted = CredentialProtector::decrypt(m_ciphertext);
+    ASSERT_TRUE(decrypted.has_value()) << decrypted.error();
+    EXPECT_EQ(*decrypted, "s3cr3t-password");
+}
+
+TEST_F(CredentialProtectorTest, SecondDecryptHitsCache) {
+    const auto before = CredentialProtector::cacheStats();
+
+    auto first = CredentialProtector::decrypt(m_ciphertext);
+    auto second = CredentialProtector::decrypt(m_ciphertext);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(*second, "s3cr3t-password");
+
+    const auto after = CredentialProtector::cacheStats();
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.hits - before.hits, 1u);
+    EXPECT_EQ(after.entries, 1u);
+}
+
+TEST_F(CredentialProtectorTest, ClearCacheForgetsEntries) {
+    ASSERT_TRUE(CredentialProtector::decrypt(m_ciphertext).has_value());
+    EXPECT_EQ(CredentialProtector::cacheStats().entries, 1u);
+
+    CredentialProtector::clearCache();
+    EXPECT_EQ(CredentialProtector::cacheStats().entries, 0u);
+
+    const auto before = CredentialProtector::cacheStats();
+    auto decrypted = CredentialProtector::decrypt(m_ciphertext);
+    ASSERT_TRUE(decrypted.has_value());
+    EXPECT_EQ(*decrypted, "s3cr3t-password");
+
+    const auto after = CredentialProtector::cacheStats();
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.hits, before.hits);
+}
+
+TEST_F(CredentialProtectorTest, ExpiredEntryIsDecryptedAgain) {
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(CredentialProtector::decrypt(m_ciphertext, start).has_value());
+
+    const auto before = CredentialProtector::cacheStats();
+    auto decrypted = CredentialProtector::decrypt(m_ciphertext, start + CredentialProtector::CACHE_TTL + std::chrono::seconds(1));
+    ASSERT_TRUE(decrypted.has_value());
+    EXPECT_EQ(*decrypted, "s3cr3t-password");
+
+    const auto after = CredentialProtector::cacheStats();
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.hits, before.hits);
+    EXPECT_EQ(after.entries, 1u);  // Re-cached with a fresh expiry
+}
+
+TEST_F(CredentialProtectorTest, EntryWithinTtlIsServedFromCache) {
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(CredentialProtector::decrypt(m_ciphertext, start).has_value());
+
+    const auto before = CredentialProtector::cacheStats();
+    ASSERT_TRUE(CredentialProtector::decrypt(m_ciphertext, start + CredentialProtector::CACHE_TTL - std::chrono::seconds(1)).has_value());
+    EXPECT_EQ(CredentialProtector::cacheStats().hits - before.hits, 1u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "utils/debounced_file_writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace velocitydb {
+namespace test {
+
+using namespace std::chrono_literals;
+
+class DebouncedFileWriterTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "velocitydb_debounced_writer_test";
+    std::filesystem::path path = directory / "state.json";
+    std::atomic<int> serializations{0};
+    std::atomic<int> version{0};
+
+    void SetUp() override {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+    }
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    DebouncedFileWriter::Serializer serializer() {
+        return [this] {
+            ++serializations;
+            return std::format("v{}", version.load());
+        };
+    }
+
+    std::string readBack() const {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    /// Poll until the file holds `expected` (the worker writes asynchronously)
+    bool waitForContent(const std::string& expected) const {
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (readBack() == expected) {
+                return true;
+            }
+            std::this_thread::sleep_for(5ms);
+        }
+        return false;
+    }
+
+    size_t fileCount() const {
+        return static_cast<size_t>(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()));
+    }
+};
+
+TEST_F(DebouncedFileWriterTest, CoalescesRapidSaves) {
+    DebouncedFileWriter writer(path, serializer(), 50ms, 5s);
+    for (int i = 1; i <= 20; ++i) {
+        version = i;
+        writer.schedule();
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));  // Nothing written on the caller's thread
+
+    ASSERT_TRUE(waitForContent("v20"));
+    EXPECT_EQ(serializations.load(), 1);
+    EXPECT_EQ(fileCount(), 1u);  // The temporary file was renamed away
+}
+
+TEST_F(DebouncedFileWriterTest, MaxDelayBoundsAContinuousStream) {
+    DebouncedFileWriter writer(path, serializer(), 200ms, 200ms);
+    const auto stop = std::chrono::steady_clock::now() + 3s;
+    while (!std::filesystem::exists(path) && std::chrono::steady_clock::now() < stop) {
+        ++version;
+        writer.schedule();  // Every call would push a pure debounce further out
+        std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_TRUE(std::filesystem::exists(path));
+}
+
+TEST_F(DebouncedFileWriterTest, FlushAndDestructorWritePendingChanges) {
+    {
+        DebouncedFileWriter writer(path, serializer(), 1h, 1h);
+        EXPECT_TRUE(writer.flush());  // Nothing pending
+        EXPECT_EQ(serializations.load(), 0);
+
+        version = 1;
+        writer.schedule();
+        EXPECT_TRUE(writer.flush());
+        EXPECT_EQ(readBack(), "v1");
+
+        version = 2;
+        writer.schedule();
+    }
+    EXPECT_EQ(readBack(), "v2");
+    EXPECT_EQ(serializations.load(), 2);
+}
+
+TEST_F(DebouncedFileWriterTest, PeriodicWritesPickUpDirtyState) {
+    DebouncedFileWriter writer(path, serializer(), 1h, 1h);
+    version = 1;
+    writer.markDirty();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(std::filesystem::exists(path));  // Dirty alone is not a save request
+
+    writer.setPeriod(20ms);
+    EXPECT_TRUE(waitForContent("v1"));
+}
+
+TEST_F(DebouncedFileWriterTest, OnWrittenFollowsEachSuccessfulWrite) {
+    std::atomic<int> written{0};
+    DebouncedFileWriter writer(path, serializer(), 1h, 1h, [&] {
+        EXPECT_EQ(readBack(), std::format("v{}", version.load()));  // Already on disk
+        ++written;
+    });
+    version = 1;
+    writer.schedule();
+    EXPECT_TRUE(writer.flush());
+    EXPECT_EQ(written.load(), 1);
+
+    DebouncedFileWriter failing(directory / "missing" / "state.json", serializer(), 1h, 1h, [&] { ++written; });
+    failing.schedule();
+    EXPECT_FALSE(failing.flush());
+    EXPECT_EQ(written.load(), 1);
+}
+
+TEST_F(DebouncedFileWriterTest, WriteAtomicallyReplacesExistingFile) {
+    ASSERT_TRUE(DebouncedFileWriter::writeAtomically(path, "old"));
+    ASSERT_TRUE(DebouncedFileWriter::writeAtomically(path, "new"));
+    EXPECT_EQ(readBack(), "new");
+    EXPECT_EQ(fileCount(), 1u);
+
+    EXPECT_FALSE(DebouncedFileWriter::writeAtomically(directory / "missing" / "state.json", "x"));
+}
+
+}  // namespace test
+}  // namespace velocitydb
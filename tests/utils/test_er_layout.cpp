@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "utils/er_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ERModelTable table(std::string name, size_t columnCount = 3) {
+    ERModelTable result{.name = std::move(name)};
+    for (size_t i = 0; i < columnCount; ++i) {
+        result.columns.push_back({.name = std::format("column_{}", i), .type = "INT"});
+    }
+    return result;
+}
+
+void relate(ERModel& model, const std::string& parent, const std::string& child) {
+    model.relations.push_back({.parentTable = parent, .childTable = child});
+}
+
+/// Star schemas of `count` tables: every table references the hub of its group of ten
+ERModel starModel(size_t count) {
+    ERModel model;
+    for (size_t i = 0; i < count; ++i) {
+        model.tables.push_back(table(std::format("t{}", i), 2 + i % 9));
+        if (i % 10 != 0) {
+            relate(model, std::format("t{}", i - i % 10), std::format("t{}", i));
+        }
+    }
+    return model;
+}
+
+size_t overlappingPairs(const ERModel& model) {
+    size_t count = 0;
+    for (size_t i = 0; i < model.tables.size(); ++i) {
+        const auto& a = model.tables[i];
+        const auto sizeA = erTableSize(a);
+        for (size_t j = i + 1; j < model.tables.size(); ++j) {
+            const auto& b = model.tables[j];
+            const auto sizeB = erTableSize(b);
+            if (a.posX < b.posX + sizeB.width && b.posX < a.posX + sizeA.width && a.posY < b.posY + sizeB.height && b.posY < a.posY + sizeA.height) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+double centerDistance(const ERModelTable& a, const ERModelTable& b) {
+    const auto sizeA = erTableSize(a);
+    const auto sizeB = erTableSize(b);
+    return std::hypot(a.posX + sizeA.width / 2 - b.posX - sizeB.width / 2, a.posY + sizeA.height / 2 - b.posY - sizeB.height / 2);
+}
+
+const ERModelTable& find(const ERModel& model, std::string_view name) {
+    return *std::ranges::find(model.tables, name, &ERModelTable::name);
+}
+
+}  // namespace
+
+TEST(ERLayoutTest, SizesTablesByTheirColumns) {
+    const auto narrow = erTableSize(table("t", 1));
+    const auto tall = erTableSize(table("t", 20));
+    EXPECT_GT(tall.height, narrow.height);
+    EXPECT_EQ(tall.width, narrow.width);
+
+    auto wide = table("t", 1);
+    wide.columns[0].name = std::string(200, 'x');
+    EXPECT_GT(erTableSize(wide).width, narrow.width);
+    EXPECT_LE(erTableSize(wide).width, 480);
+}
+
+TEST(ERLayoutTest, PlacesUnpositionedTablesWithoutOverlaps) {
+    auto model = starModel(40);
+    EXPECT_EQ(layoutERModel(model), 40u);
+    EXPECT_EQ(overlappingPairs(model), 0u);
+    for (const auto& placed : model.tables) {
+        EXPECT_GE(placed.posX, 0);
+        EXPECT_GE(placed.posY, 0);
+    }
+
+    // A spoke sits nearer its own hub than the other hubs
+    EXPECT_LT(centerDistance(find(model, "t15"), find(model, "t10")), centerDistance(find(model, "t15"), find(model, "t30")));
+}
+
+TEST(ERLayoutTest, KeepsPlacedTablesAndSettlesNewOnesNearTheirReferences) {
+    auto model = starModel(20);
+    (void)layoutERModel(model);
+    const auto before = model.tables;
+
+    model.tables.push_back(table("added"));
+    relate(model, "t10", "added");
+    EXPECT_EQ(layoutERModel(model), 1u);
+
+    for (size_t i = 0; i < before.size(); ++i) {
+        EXPECT_EQ(model.tables[i].posX, before[i].posX);
+        EXPECT_EQ(model.tables[i].posY, before[i].posY);
+    }
+    EXPECT_EQ(overlappingPairs(model), 0u);
+    EXPECT_LT(centerDistance(find(model, "added"), find(model, "t10")), centerDistance(find(model, "added"), find(model, "t0")));
+}
+
+TEST(ERLayoutTest, RelayoutMovesEveryTable) {
+    auto model = starModel(10);
+    for (auto& placed : model.tables) {
+        placed.posX = 5000;
+        placed.posY = 5000;
+    }
+    EXPECT_EQ(layoutERModel(model, {.relayoutAll = true}), 10u);
+    EXPECT_EQ(overlappingPairs(model), 0u);
+}
+
+TEST(ERLayoutTest, IsDeterministic) {
+    auto first = starModel(300);
+    auto second = starModel(300);
+    (void)layoutERModel(first);
+    (void)layoutERModel(second);
+    for (size_t i = 0; i < first.tables.size(); ++i) {
+        EXPECT_EQ(first.tables[i].posX, second.tables[i].posX);
+        EXPECT_EQ(first.tables[i].posY, second.tables[i].posY);
+    }
+}
+
+TEST(ERLayoutTest, LaysOutThousandsOfTables) {
+    auto model = starModel(2000);
+    EXPECT_EQ(layoutERModel(model), 2000u);
+    EXPECT_EQ(overlappingPairs(model), 0u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
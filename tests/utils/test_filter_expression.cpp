@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <simdjson.h>
+
+#include "utils/filter_expression.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class FilterExpressionTest : public ::testing::Test {
+protected:
+    simdjson::dom::parser parser;
+
+    void SetUp() override {
+        // id: 0..n-1, name: "user<id % 10>" (NULL every 7th row), score: id / 4.0
+        result.columns.push_back({.name = "id", .type = "INT"});
+        result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+        result.columns.push_back({.name = "score", .type = "FLOAT"});
+        result.columnData.emplace_back(ColumnDataType::Int64);
+        result.columnData.emplace_back(ColumnDataType::Text);
+        result.columnData.emplace_back(ColumnDataType::Double);
+        for (int64_t i = 0; i < ROWS; ++i) {
+            result.columnData[0].appendInt64(i);
+            if (i % 7 == 0) {
+                result.columnData[1].appendNull();
+            } else {
+                result.columnData[1].appendText("user" + std::to_string(i % 10));
+            }
+            result.columnData[2].appendDouble(static_cast<double>(i) / 4.0);
+        }
+    }
+
+    FilterExpression compile(std::string_view json) {
+        auto expression = FilterExpression::parse(parser.parse(json).value());
+        EXPECT_TRUE(expression.has_value()) << (expression ? "" : expression.error());
+        return std::move(expression.value());
+    }
+
+    template <typename Pred>
+    std::vector<size_t> rowsWhere(Pred pred) const {
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < static_cast<size_t>(ROWS); ++i) {
+            if (pred(i)) {
+                rows.push_back(i);
+            }
+        }
+        return rows;
+    }
+
+    static constexpr int64_t ROWS = 1000;
+    ResultSet result;
+};
+
+TEST_F(FilterExpressionTest, AndNarrowsAcrossColumns) {
+    auto expression = compile(R"({"and":[{"column":1,"op":"contains","value":"3"},{"column":0,"op":"range","value":"100","maxValue":"500"}]})");
+    EXPECT_EQ(expression.evaluate(result), rowsWhere([](size_t i) { return i % 7 != 0 && i % 10 == 3 && i >= 100 && i <= 500; }));
+}
+
+TEST_F(FilterExpressionTest, OrUnionsBranchesInRowOrder) {
+    auto expression = compile(R"({"or":[{"column":0,"op":"range","value":"900","maxValue":"999"},{"column":1,"op":"isNull"},{"column":0,"op":"equals","value":"5"}]})");
+    EXPECT_EQ(expression.evaluate(result), rowsWhere([](size_t i) { return i >= 900 || i % 7 == 0 || i == 5; }));
+}
+
+TEST_F(FilterExpressionTest, SparseStagesAgreeWithWholeColumnKernels) {
+    // The first stage leaves few rows, so the later ones take the per-row path
+    auto expression = compile(R"({"and":[{"column":0,"op":"range","value":"10","maxValue":"40"},
+        {"or":[{"column":1,"op":"equals","value":"user2"},{"column":2,"op":"range","value":"8.5","maxValue":"9"},{"column":1,"op":"contains","value":"9"}]}]})");
+    EXPECT_EQ(expression.evaluate(result), rowsWhere([](size_t i) {
+                  const bool name = i % 7 != 0 && (i % 10 == 2 || i % 10 == 9);
+                  return i >= 10 && i <= 40 && (name || (i >= 34 && i <= 36));
+              }));
+}
+
+TEST_F(FilterExpressionTest, RegexAndNotNull) {
+    auto expression = compile(R"({"and":[{"column":1,"op":"regex","value":"^USER[13]$","ignoreCase":true},{"column":1,"op":"notNull"},{"column":0,"op":"range","value":"0","maxValue":"99"}]})");
+    EXPECT_EQ(expression.evaluate(result), rowsWhere([](size_t i) { return i < 100 && i % 7 != 0 && (i % 10 == 1 || i % 10 == 3); }));
+}
+
+TEST_F(FilterExpressionTest, LegacyRequestBuildsSinglePredicate) {
+    auto expression = FilterExpression::fromRequest(parser.parse(std::string_view(R"({"columnIndex":0,"filterType":"range","filterValue":"3","filterValueMax":"6"})")).value());
+    ASSERT_TRUE(expression.has_value());
+    EXPECT_EQ(expression->evaluate(result), (std::vector<size_t>{3, 4, 5, 6}));
+}
+
+TEST_F(FilterExpressionTest, EvaluationStopsOnceCancelled) {
+    auto expression = compile(R"({"and":[{"column":1,"op":"notNull"},{"column":0,"op":"range","value":"0","maxValue":"9"}]})");
+    std::atomic<bool> cancelRequested{false};
+    EXPECT_EQ(expression.evaluate(result, &cancelRequested).size(), 8);
+    cancelRequested = true;
+    EXPECT_THROW((void)expression.evaluate(result, &cancelRequested), OperationCancelled);
+}
+
+TEST_F(FilterExpressionTest, RejectsMalformedExpressions) {
+    EXPECT_FALSE(FilterExpression::parse(parser.parse(std::string_view(R"({"column":0,"op":"between","value":"1"})")).value()).has_value());
+    EXPECT_FALSE(FilterExpression::parse(parser.parse(std::string_view(R"({"column":0,"op":"equals"})")).value()).has_value());
+    EXPECT_FALSE(FilterExpression::parse(parser.parse(std::string_view(R"({"column":1,"op":"regex","value":"(unclosed"})")).value()).has_value());
+    EXPECT_FALSE(FilterExpression::parse(parser.parse(std::string_view(R"({"and":[1]})")).value()).has_value());
+    EXPECT_FALSE(FilterExpression::fromRequest(parser.parse(std::string_view(R"({"columnIndex":0})")).value()).has_value());
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "utils/frontend_asset_pack.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+class FrontendAssetPackTest : public ::testing::Test {
+protected:
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "velocitydb_asset_pack_test";
+
+    void SetUp() override {
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "assets");
+        write("index.html", "<html></html>");
+        write("assets/index-3f9a1c2b.js", "console.log(1);");
+        write("assets/index-3f9a1c2b.js.map", "{}");
+        write("assets/index-77aa01fe.css", "body{}");
+        write("../velocitydb_asset_pack_secret.txt", "secret");
+    }
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+        std::filesystem::remove(root.parent_path() / "velocitydb_asset_pack_secret.txt");
+    }
+
+    void write(const std::string& relative, const std::string& content) {
+        std::ofstream(root / relative, std::ios::binary) << content;
+    }
+};
+
+TEST_F(FrontendAssetPackTest, ServesFilesWithTypeAndCachePolicy) {
+    FrontendAssetPack pack(root);
+
+    auto script = pack.find("assets/index-3f9a1c2b.js");
+    ASSERT_TRUE(script.has_value());
+    EXPECT_EQ(*script->body, "console.log(1);");
+    EXPECT_EQ(script->contentType, "text/javascript; charset=utf-8");
+    EXPECT_EQ(script->cacheControl, "public, max-age=31536000, immutable");
+
+    // Unhashed entry point is revalidated, so an upgrade picks up the new asset names
+    auto index = pack.find("index.html?v=2");
+    ASSERT_TRUE(index.has_value());
+    EXPECT_EQ(index->contentType, "text/html; charset=utf-8");
+    EXPECT_EQ(index->cacheControl, "no-cache");
+
+    EXPECT_EQ(*pack.find("")->body, "<html></html>");
+    EXPECT_EQ(*pack.find("/./index.html")->body, "<html></html>");
+    EXPECT_FALSE(pack.find("assets/missing-00000000.js").has_value());
+}
+
+TEST_F(FrontendAssetPackTest, RejectsPathsOutsideTheRoot) {
+    FrontendAssetPack pack(root);
+    EXPECT_FALSE(pack.find("../velocitydb_asset_pack_secret.txt").has_value());
+    EXPECT_FALSE(pack.find("assets/../../velocitydb_asset_pack_secret.txt").has_value());
+    EXPECT_FALSE(pack.find("assets\\..\\..\\velocitydb_asset_pack_secret.txt").has_value());
+    EXPECT_FALSE(pack.find("%2e%2e/velocitydb_asset_pack_secret.txt").has_value());
+    EXPECT_FALSE(pack.find("C:/Windows/win.ini").has_value());
+}
+
+TEST_F(FrontendAssetPackTest, PreloadReadsEverythingButSourceMapsOnce) {
+    FrontendAssetPack pack(root);
+    EXPECT_EQ(pack.preload(), 3u);
+    const auto bytes = pack.cachedBytes();
+    EXPECT_EQ(bytes, std::string("<html></html>console.log(1);body{}").size());
+
+    // Served from memory: later changes on disk are not seen, and nothing is counted twice
+    write("index.html", "changed");
+    EXPECT_EQ(*pack.find("index.html")->body, "<html></html>");
+    EXPECT_EQ(pack.preload(), 3u);
+    EXPECT_EQ(pack.cachedBytes(), bytes);
+
+    // Source maps still load on demand
+    EXPECT_EQ(*pack.find("assets/index-3f9a1c2b.js.map")->body, "{}");
+}
+
+}  // namespace test
+}  // namespace velocitydb
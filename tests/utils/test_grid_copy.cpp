@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "utils/grid_copy.h"
+
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet makeResult() {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "INT"});
+    result.columns.push_back({.name = "note", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData[0].appendInt64(1);
+    result.columnData[1].appendText("plain");
+    result.columnData[0].appendInt64(2);
+    result.columnData[1].appendText("tab\there, \"quoted\"");
+    result.columnData[0].appendNull();
+    result.columnData[1].appendText("a|b\r\nc");
+    return result;
+}
+
+}  // namespace
+
+TEST(GridCopyTest, ParsesFormatNames) {
+    EXPECT_EQ(GridCopy::parseFormat("tsv"), CopyFormat::Tsv);
+    EXPECT_EQ(GridCopy::parseFormat("csv"), CopyFormat::Csv);
+    EXPECT_EQ(GridCopy::parseFormat("markdown"), CopyFormat::Markdown);
+    EXPECT_FALSE(GridCopy::parseFormat("html").has_value());
+}
+
+TEST(GridCopyTest, TsvQuotesOnlyCellsExcelWouldMisread) {
+    auto result = makeResult();
+    const std::vector<size_t> rows = {0, 1, 2};
+    const std::vector<size_t> columns = {0, 1};
+    EXPECT_EQ(GridCopy::render(result, rows, columns, CopyFormat::Tsv, true),
+              "id\tnote\r\n"
+              "1\tplain\r\n"
+              "2\t\"tab\there, \"\"quoted\"\"\"\r\n"
+              "\t\"a|b\r\nc\"\r\n");
+}
+
+TEST(GridCopyTest, CsvFollowsSelectionOrder) {
+    auto result = makeResult();
+    const std::vector<size_t> rows = {2, 0};
+    const std::vector<size_t> columns = {1, 0};
+    EXPECT_EQ(GridCopy::render(result, rows, columns, CopyFormat::Csv, false, "NULL"),
+              "\"a|b\r\nc\",NULL\r\n"
+              "plain,1\r\n");
+}
+
+TEST(GridCopyTest, MarkdownAlwaysHasHeaderAndEscapesPipes) {
+    auto result = makeResult();
+    const std::vector<size_t> rows = {0, 2};
+    const std::vector<size_t> columns = {0, 1};
+    EXPECT_EQ(GridCopy::render(result, rows, columns, CopyFormat::Markdown, false),
+              "| id | note |\r\n"
+              "| --- | --- |\r\n"
+              "| 1 | plain |\r\n"
+              "|  | a\\|b<br>c |\r\n");
+}
+
+}  // namespace test
+}  // namespace velocitydb
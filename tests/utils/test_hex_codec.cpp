@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "utils/cpu_features.h"
+#include "utils/hex_codec.h"
+
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::string encode(std::string_view bytes) {
+    std::string out;
+    appendHex(out, bytes);
+    return out;
+}
+
+/// Reference encoder: one byte at a time
+std::string reference(std::string_view bytes) {
+    constexpr char digits[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char byte : bytes) {
+        out += digits[byte >> 4];
+        out += digits[byte & 0x0F];
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(HexCodecTest, EncodesUpperCaseWithoutPrefix) {
+    EXPECT_EQ(encode(""), "");
+    EXPECT_EQ(encode(std::string_view("\x00\x01\x7f\x80\xff", 5)), "00017F80FF");
+    EXPECT_EQ(encode("\xde\xad\xbe\xef"), "DEADBEEF");
+}
+
+TEST(HexCodecTest, MatchesReferenceAcrossVectorBoundaries) {
+    // Every byte value, at lengths around the 16/32-byte vector edges, for every kernel the CPU can run
+    std::string bytes;
+    for (size_t i = 0; i < 300; ++i) {
+        bytes += static_cast<char>((i * 37 + 11) & 0xFF);
+    }
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        limitSimdLevel(level);
+        for (size_t length : {1u, 15u, 16u, 17u, 31u, 32u, 33u, 63u, 64u, 65u, 256u, 300u}) {
+            const std::string_view input(bytes.data(), length);
+            ASSERT_EQ(encode(input), reference(input)) << simdLevelName(level) << " length " << length;
+        }
+    }
+    limitSimdLevel(detectedSimdLevel());
+}
+
+TEST(HexCodecTest, AppendsAfterExistingContent) {
+    std::string out = "0x";
+    appendHex(out, "\x12\xab");
+    EXPECT_EQ(out, "0x12AB");
+}
+
+TEST(HexCodecTest, DecodesEitherCaseWithOptionalPrefix) {
+    std::string out = "a";
+    ASSERT_TRUE(appendHexDecoded(out, "0xDEad"));
+    EXPECT_EQ(out, "a\xde\xad");
+    ASSERT_TRUE(appendHexDecoded(out, ""));
+    EXPECT_EQ(out, "a\xde\xad");
+
+    // Rejected input leaves the output as it was
+    EXPECT_FALSE(appendHexDecoded(out, "ABC"));
+    EXPECT_FALSE(appendHexDecoded(out, "ABCG"));
+    EXPECT_EQ(out, "a\xde\xad");
+
+    std::string roundTrip;
+    ASSERT_TRUE(appendHexDecoded(roundTrip, encode(std::string_view("\x00\xff\x10", 3))));
+    EXPECT_EQ(roundTrip, std::string_view("\x00\xff\x10", 3));
+}
+
+}  // namespace test
+}  // namespace velocitydb
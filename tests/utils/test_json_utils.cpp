@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "utils/cpu_features.h"
+#include "utils/json_utils.h"
+
+#include <format>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+/// Byte-at-a-time reference escaper (the pre-SIMD implementation)
+std::string referenceEscape(std::string_view str) {
+    std::string result;
+    for (char c : str) {
+        switch (c) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\b':
+                result += "\\b";
+                break;
+            case '\f':
+                result += "\\f";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += std::format("\\u{:04x}", static_cast<int>(c));
+                } else {
+                    result += c;
+                }
+                break;
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(JsonUtilsTest, EscapesSpecialCharacters) {
+    EXPECT_EQ(JsonUtils::escapeString(R"(say "hi" \ bye)"), R"(say \"hi\" \\ bye)");
+    EXPECT_EQ(JsonUtils::escapeString("a\nb\tc\r\b\f"), R"(a\nb\tc\r\b\f)");
+    EXPECT_EQ(JsonUtils::escapeString(std::string_view("\x01\x1f\0", 3)), R"(\u0001\u001f\u0000)");
+    EXPECT_EQ(JsonUtils::escapeString("日本語 \x7f"), "日本語 \x7f");
+    EXPECT_EQ(JsonUtils::escapeString(""), "");
+}
+
+TEST(JsonUtilsTest, ErrorResponseFlagsRetriableFailures) {
+    EXPECT_EQ(JsonUtils::errorResponse("boom", false), R"({"success":false,"error":"boom"})");
+    EXPECT_EQ(JsonUtils::errorResponse("link \"down\"", true), R"({"success":false,"error":"link \"down\"","retriable":true})");
+}
+
+TEST(JsonUtilsTest, AppendEscapedMatchesReferenceAcrossChunkBoundaries) {
+    // Specials at every offset around the 16/32/64-byte block edges, including the scalar tail, for every
+    // kernel the CPU can run
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        limitSimdLevel(level);
+        for (size_t length = 0; length < 140; ++length) {
+            for (size_t pos = 0; pos < length; ++pos) {
+                for (char special : {'"', '\\', '\n', '\x01'}) {
+                    std::string input(length, 'x');
+                    input[(pos + 7) % length] = '\xe3';  // High bytes must not be mistaken for control characters
+                    input[pos] = special;
+                    std::string out = "prefix:";
+                    JsonUtils::appendEscaped(out, input);
+                    ASSERT_EQ(out, "prefix:" + referenceEscape(input)) << simdLevelName(level) << " length " << length << " pos " << pos;
+                }
+            }
+        }
+    }
+    limitSimdLevel(detectedSimdLevel());
+}
+
+TEST(JsonUtilsTest, AppendRowEscapesTextCellsInPlace) {
+    ResultSet result;
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData[0].appendText("a\"b");
+    result.columnData[1].appendInt64(5);
+
+    std::string json;
+    JsonUtils::appendRow(json, result, 0);
+    EXPECT_EQ(json, R"(["a\"b","5"])");
+}
+
+TEST(JsonUtilsTest, DecimalColumnsCarryPrecisionAndScale) {
+    std::string json;
+    JsonUtils::appendColumns(json, {{.name = "price", .type = "DECIMAL", .sqlType = SqlType::Decimal, .precision = 10, .scale = 2}, {.name = "id", .type = "INT", .sqlType = SqlType::Int}});
+    EXPECT_EQ(json, R"("columns":[{"name":"price","type":"DECIMAL","precision":10,"scale":2},{"name":"id","type":"INT"}])");
+}
+
+TEST(JsonUtilsTest, ParallelRowsMatchSerialOutput) {
+    ResultSet result;
+    result.columns = {{.name = "name", .type = "VARCHAR"}, {.name = "id", .type = "INT"}};
+    const size_t rows = JsonUtils::PARALLEL_MIN_ROWS * 3 + 17;
+    for (size_t i = 0; i < rows; ++i) {
+        result.appendRow({std::format("row \"{}\"\n", i), std::to_string(i)});
+    }
+
+    std::string expected = R"("columns":[{"name":"name","type":"VARCHAR"},{"name":"id","type":"INT"}],"rows":[)";
+    for (size_t i = 0; i < rows; ++i) {
+        if (i > 0)
+            expected += ',';
+        JsonUtils::appendRow(expected, result, i);
+    }
+    expected += "]";
+
+    std::string json;
+    JsonUtils::appendResultSetFields(json, result);
+    EXPECT_EQ(json.substr(0, expected.size()), expected);
+    EXPECT_TRUE(json.substr(expected.size()).starts_with(R"(,"affectedRows":)"));
+}
+
+TEST(JsonUtilsTest, SerializationStopsOnceCancelled) {
+    ResultSet result;
+    result.columns = {{.name = "id", .type = "INT"}};
+    for (size_t i = 0; i < JsonUtils::PARALLEL_MIN_ROWS * 2; ++i) {
+        result.appendRow({std::to_string(i)});
+    }
+    ResultSet small;
+    small.columns = result.columns;
+    small.appendRow({"1"});
+
+    std::atomic<bool> cancelRequested{false};
+    EXPECT_NE(JsonUtils::serializeResultSet(small, false, &cancelRequested).find(R"("rows":[["1"]])"), std::string::npos);
+    cancelRequested = true;
+    EXPECT_THROW((void)JsonUtils::serializeResultSet(small, false, &cancelRequested), OperationCancelled);
+    EXPECT_THROW((void)JsonUtils::serializeResultSet(result, false, &cancelRequested), OperationCancelled);
+}
+
+TEST(JsonUtilsTest, AppendRowWindowReadsOnlyRequestedRowsAndColumns) {
+    ResultSet result;
+    result.columns = {{.name = "name", .type = "VARCHAR"}, {.name = "id", .type = "INT"}, {.name = "note", .type = "VARCHAR"}};
+    for (int i = 0; i < 5; ++i) {
+        result.appendRow({std::format("n{}", i), std::to_string(i), "x"});
+    }
+
+    const std::vector<size_t> rows = {3, 1};
+    const std::vector<size_t> columns = {1, 0};
+    std::string json;
+    JsonUtils::appendRowWindow(json, result, rows, columns);
+    EXPECT_EQ(json, R"("columns":[{"name":"id","type":"INT"},{"name":"name","type":"VARCHAR"}],"rows":[["3","n3"],["1","n1"]])");
+
+    json.clear();
+    JsonUtils::appendRowWindow(json, result, std::span<const size_t>(rows).first(1), {});
+    EXPECT_EQ(json, R"("columns":[{"name":"name","type":"VARCHAR"},{"name":"id","type":"INT"},{"name":"note","type":"VARCHAR"}],"rows":[["n3","3","x"]])");
+}
+
+TEST(JsonUtilsTest, LobPreviewsAreListedInWindowPositions) {
+    ResultSet result;
+    result.columns = {{.name = "id", .type = "INT"}, {.name = "body", .type = "NVARCHAR"}};
+    for (int i = 0; i < 4; ++i) {
+        result.appendRow({std::to_string(i), "start of"});
+    }
+    result.lobPreviews = {{.row = 1, .column = 1, .totalBytes = 9000}, {.row = 3, .column = 1, .totalBytes = -1}};
+
+    std::string json;
+    JsonUtils::appendLobPreviews(json, result);
+    EXPECT_EQ(json, R"(,"lobPreviews":[[1,1,9000],[3,1,-1]])");
+
+    const std::vector<size_t> rows = {3, 2, 1};
+    const std::vector<size_t> columns = {1};
+    json.clear();
+    JsonUtils::appendRowWindow(json, result, rows, columns);
+    EXPECT_TRUE(json.ends_with(R"(,"lobPreviews":[[0,0,-1],[2,0,9000]])"));
+
+    const std::vector<size_t> idOnly = {0};
+    json.clear();
+    JsonUtils::appendRowWindow(json, result, rows, idOnly);
+    EXPECT_EQ(json.find("lobPreviews"), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace velocitydb
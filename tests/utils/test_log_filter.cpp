@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "utils/log_filter.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(LogFilterTest, FoldsRepeatedMessages) {
+    LogFilter filter;
+    const std::vector<LogRecord> records{
+        {"t1", "INFO", "loading"},
+        {"t2", "ERROR", "retry failed"},
+        {"t3", "ERROR", "retry failed"},
+        {"t4", "ERROR", "retry failed"},
+        {"t5", "INFO", "done"},
+    };
+    std::string block;
+    EXPECT_EQ(filter.append(records, block), 3u);
+    EXPECT_EQ(block,
+              "[t1] [INFO] loading\n"
+              "[t2] [ERROR] retry failed\n"
+              "[t4] [ERROR] (previous message repeated 2 more times)\n"
+              "[t5] [INFO] done\n");
+    EXPECT_EQ(filter.folded(), 2u);
+}
+
+TEST(LogFilterTest, ReportsRepeatsAtTheEndOfEachBatch) {
+    LogFilter filter;
+    const std::vector<LogRecord> records{{"t1", "WARNING", "slow"}, {"t2", "WARNING", "slow"}};
+    std::string block;
+    filter.append(records, block);
+    EXPECT_EQ(block, "[t1] [WARNING] slow\n[t2] [WARNING] (previous message repeated 1 more times)\n");
+}
+
+TEST(LogFilterTest, RateLimitDropsAndReportsOnRecovery) {
+    const auto start = LogFilter::Clock::now();
+    LogFilter filter(10.0, 2.0);
+    const std::vector<LogRecord> burst{{"t1", "INFO", "a"}, {"t2", "INFO", "b"}, {"t3", "INFO", "c"}, {"t4", "INFO", "d"}};
+    std::string block;
+    EXPECT_EQ(filter.append(burst, block, start), 2u);
+    EXPECT_EQ(filter.dropped(), 2u);
+    EXPECT_EQ(block, "[t1] [INFO] a\n[t2] [INFO] b\n");
+
+    // A second refills ten tokens, capped at the burst of two
+    block.clear();
+    const std::vector<LogRecord> later{{"t5", "INFO", "e"}};
+    EXPECT_EQ(filter.append(later, block, start + std::chrono::seconds(1)), 1u);
+    EXPECT_EQ(block, "[t5] [WARNING] 2 frontend log records dropped (rate limit)\n[t5] [INFO] e\n");
+}
+
+}  // namespace test
+}  // namespace velocitydb
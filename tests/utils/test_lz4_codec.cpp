@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "utils/lz4_codec.h"
+
+#include <random>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::string roundTrip(const std::string& input) {
+    std::string compressed(Lz4Codec::compressBound(input.size()), '\0');
+    const size_t size = Lz4Codec::compress(input, compressed.data(), compressed.size());
+    EXPECT_GT(size, 0u);
+    std::string output(input.size(), '\0');
+    EXPECT_TRUE(Lz4Codec::decompress(std::string_view(compressed).substr(0, size), output.data(), output.size()));
+    return output;
+}
+
+}  // namespace
+
+TEST(Lz4CodecTest, RoundTripsShortAndEmptyInput) {
+    EXPECT_EQ(roundTrip(""), "");
+    EXPECT_EQ(roundTrip("a"), "a");
+    EXPECT_EQ(roundTrip("abcdefghijkl"), "abcdefghijkl");
+}
+
+TEST(Lz4CodecTest, CompressesRepetitiveData) {
+    std::string input;
+    for (int i = 0; i < 20000; ++i) {
+        input += "2024-01-01,Customer " + std::to_string(i % 50) + ",ACTIVE\n";
+    }
+    std::string compressed(Lz4Codec::compressBound(input.size()), '\0');
+    const size_t size = Lz4Codec::compress(input, compressed.data(), compressed.size());
+    ASSERT_GT(size, 0u);
+    EXPECT_LT(size, input.size() / 4);
+
+    std::string output(input.size(), '\0');
+    ASSERT_TRUE(Lz4Codec::decompress(std::string_view(compressed).substr(0, size), output.data(), output.size()));
+    EXPECT_EQ(output, input);
+}
+
+TEST(Lz4CodecTest, RoundTripsRandomAndOverlappingData) {
+    std::mt19937 rng(42);
+    for (int trial = 0; trial < 200; ++trial) {
+        std::string input(rng() % 5000, '\0');
+        for (size_t i = 0; i < input.size(); ++i) {
+            // Mix noise with short back-references so matches overlap their own output
+            input[i] = (i > 8 && rng() % 3) ? input[i - 1 - rng() % 8] : static_cast<char>(rng());
+        }
+        EXPECT_EQ(roundTrip(input), input) << "trial " << trial;
+    }
+}
+
+TEST(Lz4CodecTest, RejectsMalformedInput) {
+    const std::string input(1000, 'z');
+    std::string compressed(Lz4Codec::compressBound(input.size()), '\0');
+    const size_t size = Lz4Codec::compress(input, compressed.data(), compressed.size());
+    std::string output(input.size(), '\0');
+
+    EXPECT_FALSE(Lz4Codec::decompress(std::string_view(compressed).substr(0, size - 1), output.data(), output.size()));
+    EXPECT_FALSE(Lz4Codec::decompress(std::string_view(compressed).substr(0, size), output.data(), output.size() - 1));
+    // A match offset pointing before the start of the output
+    EXPECT_FALSE(Lz4Codec::decompress(std::string_view("\x10" "a" "\x05\x00", 4), output.data(), 5));
+    // Compression into a buffer that is too small fails cleanly
+    EXPECT_EQ(Lz4Codec::compress(input, compressed.data(), 4), 0u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
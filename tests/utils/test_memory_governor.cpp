@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "database/result_cache.h"
+#include "utils/memory_governor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::shared_ptr<const ResultSet> makeResult(size_t rows) {
+    auto result = std::make_shared<ResultSet>();
+    result->columns.push_back({.name = "value", .type = "VARCHAR"});
+    for (size_t i = 0; i < rows; ++i) {
+        result->appendRow({std::to_string(i)});
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(MemoryGovernorTest, ChargesAddUpAcrossPools) {
+    MemoryGovernor governor(1000);
+    governor.charge(MemoryPool::ResultCache, 300);
+    governor.charge(MemoryPool::InFlight, 500);
+    EXPECT_EQ(governor.used(), 800u);
+    EXPECT_FALSE(governor.overBudget());
+
+    {
+        MemoryCharge charge(governor, MemoryPool::HeldResults);
+        charge.set(400);
+        EXPECT_TRUE(governor.overBudget());
+        charge.set(100);
+        EXPECT_EQ(governor.used(MemoryPool::HeldResults), 100u);
+    }
+    EXPECT_EQ(governor.used(MemoryPool::HeldResults), 0u);
+    governor.release(MemoryPool::InFlight, 500);
+    EXPECT_EQ(governor.used(), 300u);
+}
+
+TEST(MemoryGovernorTest, ReclaimsInPoolOrderDownToLowWater) {
+    MemoryGovernor governor(1000);
+    std::vector<MemoryPool> calls;
+    auto reclaimFrom = [&](MemoryPool pool) {
+        return [&, pool](size_t wanted) {
+            calls.push_back(pool);
+            const size_t freed = (std::min)(wanted, governor.used(pool));
+            governor.release(pool, freed);
+            return freed;
+        };
+    };
+    const auto held = governor.addReclaimer(MemoryPool::HeldResults, reclaimFrom(MemoryPool::HeldResults));
+    const auto cache = governor.addReclaimer(MemoryPool::ResultCache, reclaimFrom(MemoryPool::ResultCache));
+
+    EXPECT_EQ(governor.reclaimIfNeeded(), 0u);
+    EXPECT_TRUE(calls.empty());
+
+    governor.charge(MemoryPool::ResultCache, 200);
+    governor.charge(MemoryPool::HeldResults, 600);
+    governor.charge(MemoryPool::InFlight, 400);
+    EXPECT_EQ(governor.reclaimIfNeeded(), 1200u - 850u);
+    EXPECT_EQ(calls, (std::vector<MemoryPool>{MemoryPool::ResultCache, MemoryPool::HeldResults}));
+    EXPECT_EQ(governor.used(MemoryPool::ResultCache), 0u);
+    EXPECT_EQ(governor.used(), 850u);
+
+    governor.removeReclaimer(cache);
+    governor.removeReclaimer(held);
+    governor.charge(MemoryPool::InFlight, 1000);
+    calls.clear();
+    EXPECT_EQ(governor.reclaimIfNeeded(), 0u);
+    EXPECT_TRUE(calls.empty());
+}
+
+TEST(MemoryGovernorTest, ResultCacheShedsBeyondItsOwnCap) {
+    const size_t entryBytes = makeResult(50)->memoryBytes();
+    MemoryGovernor governor(entryBytes * 10);
+    ResultCache cache(entryBytes * 100, ResultCache::DEFAULT_TTL, governor);
+    for (int i = 0; i < 5; ++i) {
+        cache.put(std::to_string(i), makeResult(50));
+    }
+    EXPECT_EQ(governor.used(MemoryPool::ResultCache), cache.getCurrentSize());
+    EXPECT_EQ(cache.entryCount(), 5u);
+
+    // Another subsystem takes most of the budget: the cache gives its entries back
+    governor.charge(MemoryPool::InFlight, entryBytes * 7);
+    cache.put("5", makeResult(50));
+    EXPECT_LE(governor.used(), governor.budget());
+    EXPECT_LT(cache.entryCount(), 6u);
+    EXPECT_EQ(governor.used(MemoryPool::ResultCache), cache.getCurrentSize());
+    governor.release(MemoryPool::InFlight, entryBytes * 7);
+
+    cache.clear();
+    EXPECT_EQ(governor.used(MemoryPool::ResultCache), 0u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
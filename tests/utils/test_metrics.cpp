@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "simdjson.h"
+#include "utils/metrics.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(MetricHistogramTest, BucketsAreExactThenLogLinear) {
+    for (uint64_t value = 0; value < MetricHistogram::SUB_BUCKETS; ++value) {
+        EXPECT_EQ(MetricHistogram::bucketOf(value), value);
+        EXPECT_EQ(MetricHistogram::bucketUpperBound(value), value);
+    }
+    const uint64_t samples[] = {16, 17, 31, 32, 33, 1000, 123456789, UINT64_MAX};
+    for (uint64_t value : samples) {
+        const auto bucket = MetricHistogram::bucketOf(value);
+        ASSERT_LT(bucket, MetricHistogram::BUCKET_COUNT);
+        const auto upper = MetricHistogram::bucketUpperBound(bucket);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(static_cast<double>(upper - value), static_cast<double>(value) / 16.0 + 1.0) << value;
+        if (bucket > 0) {
+            EXPECT_LT(MetricHistogram::bucketUpperBound(bucket - 1), value);
+        }
+    }
+}
+
+TEST(MetricHistogramTest, PercentilesStayWithinBucketPrecision) {
+    MetricHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.99), 0u);
+    for (uint64_t value = 1; value <= 10000; ++value) {
+        histogram.record(value);
+    }
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 10000u);
+    EXPECT_EQ(snapshot.sum, 10000u * 10001u / 2);
+    EXPECT_EQ(snapshot.max, 10000u);
+    EXPECT_NEAR(static_cast<double>(snapshot.p50), 5000.0, 5000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(snapshot.p99), 9900.0, 9900.0 / 16);
+    EXPECT_EQ(histogram.percentile(1.0), 10000u);  // Capped at the recorded maximum
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+}
+
+TEST(MetricsRegistryTest, MetricsAreSharedByNameAndThreadSafe) {
+    MetricsRegistry registry;
+    auto& counter = registry.counter("test.events");
+    EXPECT_EQ(&counter, &registry.counter("test.events"));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&registry] {
+            auto& events = registry.counter("test.events");
+            auto& latency = registry.histogram("test.latency_us");
+            for (int i = 0; i < 10000; ++i) {
+                events.add();
+                latency.record(static_cast<uint64_t>(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.value(), 40000u);
+    EXPECT_EQ(registry.histogram("test.latency_us").count(), 40000u);
+}
+
+TEST(MetricsRegistryTest, JsonSnapshotAndReset) {
+    MetricsRegistry registry;
+    registry.counter("rows").add(42);
+    registry.gauge("queue_depth").set(3);
+    registry.histogram("latency_us").record(250);
+
+    simdjson::dom::parser parser;
+    auto doc = parser.parse(registry.toJson());
+    ASSERT_FALSE(doc.error());
+    EXPECT_GE(doc["uptimeSeconds"].get_double().value(), 0.0);
+    EXPECT_EQ(doc["counters"]["rows"].get_uint64().value(), 42u);
+    EXPECT_EQ(doc["gauges"]["queue_depth"].get_int64().value(), 3);
+    EXPECT_EQ(doc["histograms"]["latency_us"]["p99"].get_uint64().value(), 250u);
+
+    registry.reset();
+    EXPECT_EQ(registry.counter("rows").value(), 0u);
+    EXPECT_EQ(registry.gauge("queue_depth").value(), 3);
+    EXPECT_EQ(registry.histogram("latency_us").count(), 0u);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "utils/object_name_index.h"
+
+#include <chrono>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class ObjectNameIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        index.replace(1, {{.kind = ObjectKind::Table, .schema = "dbo", .name = "Customers"}, {.kind = ObjectKind::Table, .schema = "dbo", .name = "CustomerOrders"}});
+        index.replace(2, {{.kind = ObjectKind::Column, .schema = "dbo", .name = "CustomerId", .parent = "CustomerOrders"},
+                          {.kind = ObjectKind::Column, .schema = "dbo", .name = "OrderDate", .parent = "CustomerOrders"}});
+        index.replace(3, {{.kind = ObjectKind::View, .schema = "report", .name = "vw_customer_sales"}, {.kind = ObjectKind::Procedure, .schema = "dbo", .name = "usp_LoadOrders"}});
+    }
+
+    static std::vector<std::string> names(const std::vector<SearchResult>& results) {
+        std::vector<std::string> out;
+        for (const auto& result : results) {
+            out.push_back(result.objectType + ":" + result.objectName);
+        }
+        return out;
+    }
+
+    ObjectNameIndex index;
+};
+
+TEST_F(ObjectNameIndexTest, SubstringSearchIsCaseInsensitiveAndOrderedByKind) {
+    EXPECT_EQ(names(index.search("CUSTOMER")), (std::vector<std::string>{"COLUMN:CustomerId", "TABLE:CustomerOrders", "TABLE:Customers", "VIEW:vw_customer_sales"}));
+    EXPECT_EQ(names(index.search("orders")), (std::vector<std::string>{"PROCEDURE:usp_LoadOrders", "TABLE:CustomerOrders"}));
+
+    const auto results = index.search("date");
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].parentName, "CustomerOrders");
+    EXPECT_EQ(results[0].matchPosition, 5);
+}
+
+TEST_F(ObjectNameIndexTest, ShortPatternsAndOptions) {
+    EXPECT_EQ(names(index.search("Id")), (std::vector<std::string>{"COLUMN:CustomerId"}));
+    EXPECT_EQ(names(index.search("customer", {.searchColumns = false, .caseSensitive = true})), (std::vector<std::string>{"VIEW:vw_customer_sales"}));
+    EXPECT_EQ(index.search("customer", {.maxResults = 2}).size(), 2u);
+    EXPECT_TRUE(index.search("").empty());
+}
+
+TEST_F(ObjectNameIndexTest, FuzzyAppendsSimilarNames) {
+    EXPECT_TRUE(index.search("custmers").empty());
+    // Most shared trigrams first, then the usual order
+    EXPECT_EQ(names(index.search("custmers", {.fuzzy = true})), (std::vector<std::string>{"TABLE:CustomerOrders", "TABLE:Customers", "COLUMN:CustomerId", "VIEW:vw_customer_sales"}));
+    EXPECT_EQ(names(index.search("custmers", {.fuzzy = true, .maxResults = 2})), (std::vector<std::string>{"TABLE:CustomerOrders", "TABLE:Customers"}));
+}
+
+TEST_F(ObjectNameIndexTest, CompleteMergesTablesViewsAndColumns) {
+    EXPECT_EQ(index.complete("cust"), (std::vector<std::string>{"CustomerId", "CustomerOrders", "Customers"}));
+    EXPECT_EQ(index.complete("cust", 2), (std::vector<std::string>{"CustomerId", "CustomerOrders"}));
+    EXPECT_TRUE(index.complete("usp").empty());  // Routines are not completed
+}
+
+TEST_F(ObjectNameIndexTest, ReplaceAndRemoveAreIncremental) {
+    index.replace(1, {{.kind = ObjectKind::Table, .schema = "dbo", .name = "Clients"}});
+    EXPECT_EQ(names(index.search("customers")), std::vector<std::string>{});
+    EXPECT_EQ(index.complete("cl"), (std::vector<std::string>{"Clients"}));
+
+    index.remove(2);
+    EXPECT_TRUE(index.search("OrderDate").empty());
+    EXPECT_EQ(index.size(), 3u);
+
+    index.clear();
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_TRUE(index.complete("c").empty());
+}
+
+TEST_F(ObjectNameIndexTest, CompactsAfterManyRemovals) {
+    for (uint64_t owner = 10; owner < 3000; ++owner) {
+        index.replace(owner, {{.kind = ObjectKind::Table, .schema = "dbo", .name = std::format("Table{}", owner)}});
+    }
+    for (uint64_t owner = 10; owner < 3000; ++owner) {
+        index.remove(owner);
+    }
+    EXPECT_EQ(index.size(), 6u);
+    EXPECT_EQ(names(index.search("Table")), std::vector<std::string>{});
+    EXPECT_EQ(index.complete("customers"), (std::vector<std::string>{"Customers"}));
+}
+
+TEST_F(ObjectNameIndexTest, LargeCatalogAnswersFromMemory) {
+    for (uint64_t table = 0; table < 2000; ++table) {
+        std::vector<ObjectName> columns;
+        for (int column = 0; column < 25; ++column) {
+            columns.push_back({.kind = ObjectKind::Column, .schema = "dbo", .name = std::format("col_{}_{}", column, table), .parent = std::format("T{}", table)});
+        }
+        index.replace(100 + table, std::move(columns));
+    }
+    (void)index.search("warm");  // Merges the additions
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto results = index.search("_1999");
+    const auto completions = index.complete("col_24_199");
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(results.size(), 25u);
+    EXPECT_EQ(completions.size(), 11u);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(50));  // Generous for debug builds; sub-millisecond in release
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "utils/ordered_render.h"
+
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(OrderedRenderTest, KeepsIndexOrderAcrossSlicesAndWaves) {
+    std::string expected;
+    for (size_t i = 0; i < 5000; ++i) {
+        expected += std::format("{};", i);
+    }
+    std::string text;
+    size_t chunks = 0;
+    renderOrdered(
+        5000, [](size_t i, std::string& out) { out += std::format("{};", i); },
+        [&](std::string_view chunk) {
+            text += chunk;
+            ++chunks;
+        });
+    EXPECT_EQ(text, expected);
+    EXPECT_GE(chunks, 3u);  // Streamed a wave at a time, not gathered whole
+}
+
+TEST(OrderedRenderTest, RethrowsARenderFailure) {
+    EXPECT_THROW(renderOrdered(
+                     1000,
+                     [](size_t i, std::string&) {
+                         if (i == 700) {
+                             throw std::runtime_error("broken");
+                         }
+                     },
+                     [](std::string_view) {}),
+                 std::runtime_error);
+}
+
+TEST(OrderedRenderTest, OrdersReferencedItemsFirst) {
+    // 0 → 2, 2 → 3, 1 unrelated
+    const std::vector<std::pair<size_t, size_t>> chain{{0, 2}, {2, 3}};
+    EXPECT_EQ(dependencyOrder(4, chain), (std::vector<size_t>{3, 2, 0, 1}));
+
+    // No references: unchanged
+    EXPECT_EQ(dependencyOrder(3, {}), (std::vector<size_t>{0, 1, 2}));
+
+    // A cycle and a self-reference still yield every item once
+    const std::vector<std::pair<size_t, size_t>> cycle{{0, 1}, {1, 0}, {2, 2}, {3, 1}};
+    EXPECT_EQ(dependencyOrder(4, cycle), (std::vector<size_t>{1, 0, 2, 3}));
+}
+
+}  // namespace test
+}  // namespace velocitydb
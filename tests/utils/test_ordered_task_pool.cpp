@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "utils/ordered_task_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+using namespace std::chrono_literals;
+
+TEST(OrderedTaskPoolTest, TasksWithOneKeyRunInOrderAndNeverOverlap) {
+    OrderedTaskPool pool(4);
+    std::mutex mutex;
+    std::vector<int> order;
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    std::promise<void> done;
+
+    for (int i = 0; i < 50; ++i) {
+        pool.post("conn-1", [&, i] {
+            if (running.fetch_add(1) != 0) {
+                overlapped = true;
+            }
+            std::this_thread::sleep_for(100us);
+            {
+                std::lock_guard lock(mutex);
+                order.push_back(i);
+            }
+            running.fetch_sub(1);
+            if (i == 49) {
+                done.set_value();
+            }
+        });
+    }
+    ASSERT_EQ(done.get_future().wait_for(10s), std::future_status::ready);
+
+    EXPECT_FALSE(overlapped.load());
+    ASSERT_EQ(order.size(), 50u);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(OrderedTaskPoolTest, SlowKeyDoesNotHoldBackOthers) {
+    OrderedTaskPool pool(2);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> otherRan;
+
+    pool.post("slow", [released] { released.wait(); });
+    pool.post("slow", [] {});  // Queued behind the blocked task
+    pool.post("fast", [&] { otherRan.set_value(); });
+
+    EXPECT_EQ(otherRan.get_future().wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(pool.pending(), 1u);
+    release.set_value();
+}
+
+TEST(OrderedTaskPoolTest, FailingTaskReleasesItsKey) {
+    OrderedTaskPool pool(1);
+    std::promise<void> next;
+    pool.post("key", [] { throw std::runtime_error("boom"); });
+    pool.post("key", [&] { next.set_value(); });
+    EXPECT_EQ(next.get_future().wait_for(5s), std::future_status::ready);
+}
+
+TEST(OrderedTaskPoolTest, ShutdownDropsQueuedTasks) {
+    std::atomic<int> ran{0};
+    {
+        OrderedTaskPool pool(1);
+        std::promise<void> started;
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        pool.post([&, released] {
+            started.set_value();
+            released.wait();
+            ++ran;
+        });
+        pool.post([&] { ++ran; });
+        pool.post("key", [&] { ++ran; });
+        started.get_future().wait();
+
+        std::thread stopper([&] { pool.shutdown(); });
+        std::this_thread::sleep_for(20ms);
+        release.set_value();
+        stopper.join();
+
+        pool.post([&] { ++ran; });  // Ignored after shutdown
+        EXPECT_EQ(pool.pending(), 0u);
+    }
+    EXPECT_EQ(ran.load(), 1);
+}
+
+}  // namespace test
+}  // namespace velocitydb
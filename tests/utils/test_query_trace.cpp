@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "simdjson.h"
+#include "utils/query_trace.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace velocitydb {
+namespace test {
+
+TEST(QueryTracerTest, ScopesNestUnderTheirContext) {
+    QueryTracer tracer;
+    uint64_t traceId = 0;
+    {
+        TraceContext trace(tracer);
+        traceId = trace.id();
+        TraceScope outer("ipc.dispatch", tracer);
+        outer.setDetail("executeQuery");
+        {
+            TraceScope inner("driver.exec", tracer);
+        }
+        tracer.record("driver.convert", std::chrono::steady_clock::now(), std::chrono::microseconds(1500));
+    }
+    EXPECT_EQ(QueryTracer::currentTraceId(), 0u);
+
+    const auto spans = tracer.spans(traceId);
+    ASSERT_EQ(spans.size(), 3u);
+    EXPECT_EQ(spans[0].name, "ipc.dispatch");  // Ordered by start, not by completion
+    EXPECT_EQ(spans[0].detail, "executeQuery");
+    EXPECT_EQ(spans[0].depth, 0u);
+    EXPECT_EQ(spans[1].name, "driver.exec");
+    EXPECT_EQ(spans[1].depth, 1u);
+    EXPECT_EQ(spans[2].depth, 1u);
+    EXPECT_EQ(spans[2].durationUs, 1500);
+    EXPECT_EQ(tracer.latestTraceWith("driver.exec"), traceId);
+    EXPECT_EQ(tracer.latestTraceWith("json.serialize"), 0u);
+}
+
+TEST(QueryTracerTest, NestedContextKeepsOuterTraceAndWorkersCanJoin) {
+    QueryTracer tracer;
+    TraceContext outer(tracer);
+    {
+        TraceContext inner(tracer);
+        EXPECT_EQ(inner.id(), outer.id());
+    }
+
+    const auto traceId = outer.id();
+    std::thread worker([&] {
+        TraceContext joined(traceId);
+        TraceScope span("async.run", tracer);
+    });
+    worker.join();
+
+    const auto spans = tracer.spans(traceId);
+    ASSERT_EQ(spans.size(), 1u);
+    EXPECT_EQ(spans[0].name, "async.run");
+}
+
+TEST(QueryTracerTest, RingKeepsTheNewestSpans) {
+    QueryTracer tracer(4);
+    for (int i = 0; i < 10; ++i) {
+        TraceContext trace(tracer);
+        TraceScope span("driver.exec", tracer);
+        span.setDetail(std::to_string(i));
+    }
+    const auto spans = tracer.spans();
+    ASSERT_EQ(spans.size(), 4u);
+    EXPECT_EQ(spans.front().detail, "6");
+    EXPECT_EQ(spans.back().detail, "9");
+
+    tracer.clear();
+    EXPECT_TRUE(tracer.spans().empty());
+}
+
+TEST(QueryTracerTest, DisabledTracerRecordsNothing) {
+    QueryTracer tracer;
+    tracer.setEnabled(false);
+    {
+        TraceScope span("driver.exec", tracer);
+    }
+    tracer.record("driver.convert", std::chrono::steady_clock::now(), std::chrono::milliseconds(1));
+    EXPECT_TRUE(tracer.spans().empty());
+}
+
+TEST(QueryTracerTest, JsonExportsParse) {
+    QueryTracer tracer;
+    {
+        TraceContext trace(tracer);
+        TraceScope span("ipc.dispatch", tracer);
+        span.setDetail("say \"hi\"");
+    }
+    const auto spans = tracer.spans();
+
+    simdjson::dom::parser parser;
+    auto plain = parser.parse(QueryTracer::toJson(7, spans));
+    ASSERT_FALSE(plain.error());
+    EXPECT_EQ(plain["traceId"].get_uint64().value(), 7u);
+    EXPECT_EQ(plain["spans"].at(0)["detail"].get_string().value(), "say \"hi\"");
+
+    auto chrome = parser.parse(QueryTracer::toChromeTraceJson(spans));
+    ASSERT_FALSE(chrome.error());
+    auto event = chrome["traceEvents"].at(0);
+    EXPECT_EQ(event["ph"].get_string().value(), "X");
+    EXPECT_EQ(event["name"].get_string().value(), "ipc.dispatch");
+    EXPECT_GE(event["dur"].get_int64().value(), 0);
+}
+
+}  // namespace test
+}  // namespace velocitydb
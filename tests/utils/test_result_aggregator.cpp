@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "utils/result_aggregator.h"
+
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+class ResultAggregatorTest : public ::testing::Test {
+protected:
+    // region: "north|south|east" (NULL every 11th row), amount: i % 50 (NULL every 13th row), price: i / 8.0, note: text
+    static ResultSet makeSales(int64_t rows) {
+        ResultSet result;
+        result.columns.push_back({.name = "region", .type = "NVARCHAR"});
+        result.columns.push_back({.name = "amount", .type = "INT"});
+        result.columns.push_back({.name = "price", .type = "FLOAT"});
+        result.columns.push_back({.name = "note", .type = "NVARCHAR"});
+        result.columnData.emplace_back(ColumnDataType::Text);
+        result.columnData.emplace_back(ColumnDataType::Int64);
+        result.columnData.emplace_back(ColumnDataType::Double);
+        result.columnData.emplace_back(ColumnDataType::Text);
+        static constexpr const char* REGIONS[] = {"north", "south", "east"};
+        for (int64_t i = 0; i < rows; ++i) {
+            if (i % 11 == 0) {
+                result.columnData[0].appendNull();
+            } else {
+                result.columnData[0].appendText(REGIONS[i % 3]);
+            }
+            if (i % 13 == 0) {
+                result.columnData[1].appendNull();
+            } else {
+                result.columnData[1].appendInt64(i % 50);
+            }
+            result.columnData[2].appendDouble(static_cast<double>(i) / 8.0);
+            result.columnData[3].appendText("note" + std::to_string(i % 4));
+        }
+        return result;
+    }
+
+    static ResultSet aggregate(const ResultSet& data, AggregateRequest request, const std::vector<size_t>* selection = nullptr) {
+        ResultAggregator aggregator(data.columns, std::move(request));
+        aggregator.add(data, selection);
+        return aggregator.finish();
+    }
+
+    /// Row of group `key` (first column rendered as text, "" for NULL)
+    static size_t groupRow(const ResultSet& groups, std::string_view key) {
+        for (size_t row = 0; row < groups.rowCount(); ++row) {
+            const auto& column = groups.columnData[0];
+            if ((column.isNull(row) && key.empty()) || (!column.isNull(row) && column.textAt(row) == key)) {
+                return row;
+            }
+        }
+        ADD_FAILURE() << "no group " << key;
+        return 0;
+    }
+};
+
+TEST_F(ResultAggregatorTest, GroupsWithSqlNullSemantics) {
+    const auto data = makeSales(1000);
+    auto groups = aggregate(data, {.groupBy = {0}, .aggregates = {{AggregateFunction::Count}, {AggregateFunction::Count, 1}, {AggregateFunction::Sum, 1}, {AggregateFunction::Min, 1}, {AggregateFunction::Max, 2}}});
+
+    ASSERT_EQ(groups.rowCount(), 4u);  // north, south, east, NULL
+    EXPECT_EQ(groups.columns[1].name, "count(*)");
+    EXPECT_EQ(groups.columns[3].name, "sum(amount)");
+    EXPECT_EQ(groups.columns[5].name, "max(price)");
+
+    std::map<std::string, int64_t> rows, counted, sums, mins;
+    std::map<std::string, double> maxes;
+    static constexpr const char* REGIONS[] = {"north", "south", "east"};
+    for (int64_t i = 0; i < 1000; ++i) {
+        const std::string key = i % 11 == 0 ? "" : REGIONS[i % 3];
+        ++rows[key];
+        maxes[key] = static_cast<double>(i) / 8.0;
+        if (i % 13 != 0) {
+            ++counted[key];
+            sums[key] += i % 50;
+            mins[key] = mins.contains(key) ? (std::min)(mins[key], i % 50) : i % 50;
+        }
+    }
+    for (const auto& [key, count] : rows) {
+        const size_t row = groupRow(groups, key);
+        EXPECT_EQ(groups.columnData[1].int64At(row), count) << key;
+        EXPECT_EQ(groups.columnData[2].int64At(row), counted[key]) << key;
+        EXPECT_EQ(groups.columnData[3].int64At(row), sums[key]) << key;
+        EXPECT_EQ(groups.columnData[4].int64At(row), mins[key]) << key;
+        EXPECT_DOUBLE_EQ(groups.columnData[5].doubleAt(row), maxes[key]) << key;
+    }
+    EXPECT_TRUE(groups.columnData[0].isNull(groupRow(groups, "")));
+}
+
+TEST_F(ResultAggregatorTest, AverageAndDistinct) {
+    const auto data = makeSales(600);
+    auto groups = aggregate(data, {.groupBy = {3}, .aggregates = {{AggregateFunction::Avg, 2}, {AggregateFunction::CountDistinct, 0}}});
+
+    ASSERT_EQ(groups.rowCount(), 4u);
+    for (int note = 0; note < 4; ++note) {
+        double sum = 0;
+        int64_t count = 0;
+        std::set<std::string> regions;
+        for (int64_t i = note; i < 600; i += 4) {
+            sum += static_cast<double>(i) / 8.0;
+            ++count;
+            if (i % 11 != 0) {
+                regions.insert(std::to_string(i % 3));
+            }
+        }
+        const size_t row = groupRow(groups, "note" + std::to_string(note));
+        EXPECT_DOUBLE_EQ(groups.columnData[1].doubleAt(row), sum / static_cast<double>(count));
+        EXPECT_EQ(groups.columnData[2].int64At(row), static_cast<int64_t>(regions.size()));
+    }
+}
+
+TEST_F(ResultAggregatorTest, NoGroupByYieldsOneRowEvenWhenEmpty) {
+    const auto empty = makeSales(0);
+    auto groups = aggregate(empty, {.aggregates = {{AggregateFunction::Count}, {AggregateFunction::Sum, 1}}});
+
+    ASSERT_EQ(groups.rowCount(), 1u);
+    EXPECT_EQ(groups.columnData[0].int64At(0), 0);
+    EXPECT_TRUE(groups.columnData[1].isNull(0));
+}
+
+TEST_F(ResultAggregatorTest, SelectionLimitsRows) {
+    const auto data = makeSales(100);
+    const std::vector<size_t> selection = {1, 2, 4, 5};
+    auto groups = aggregate(data, {.aggregates = {{AggregateFunction::Count}, {AggregateFunction::Sum, 1}}}, &selection);
+
+    ASSERT_EQ(groups.rowCount(), 1u);
+    EXPECT_EQ(groups.columnData[0].int64At(0), 4);
+    EXPECT_EQ(groups.columnData[1].int64At(0), 12);
+}
+
+TEST_F(ResultAggregatorTest, ParallelMatchesBatchedSequential) {
+    const auto data = makeSales(static_cast<int64_t>(ResultAggregator::PARALLEL_MIN_ROWS) * 3);
+    const AggregateRequest request{.groupBy = {0, 3}, .aggregates = {{AggregateFunction::Count}, {AggregateFunction::Sum, 1}, {AggregateFunction::Min, 2}, {AggregateFunction::CountDistinct, 1}}};
+    auto parallel = aggregate(data, request);
+
+    // Small batches stay below the parallel threshold, so they are folded sequentially
+    ResultAggregator sequential(data.columns, request);
+    constexpr size_t STEP = 1000;
+    for (size_t start = 0; start < data.rowCount(); start += STEP) {
+        std::vector<size_t> selection;
+        for (size_t row = start; row < (std::min)(start + STEP, data.rowCount()); ++row) {
+            selection.push_back(row);
+        }
+        sequential.add(data, &selection);
+    }
+    auto expected = sequential.finish();
+
+    ASSERT_EQ(parallel.rowCount(), expected.rowCount());
+    for (size_t row = 0; row < expected.rowCount(); ++row) {
+        for (size_t column = 0; column < expected.columnData.size(); ++column) {
+            std::string want, got;
+            expected.columnData[column].appendDisplayText(want, row);
+            parallel.columnData[column].appendDisplayText(got, row);
+            EXPECT_EQ(got, want) << "row " << row << " column " << column;
+        }
+    }
+}
+
+TEST_F(ResultAggregatorTest, RejectsInvalidRequests) {
+    const auto data = makeSales(10);
+    EXPECT_THROW(aggregate(data, {.aggregates = {{AggregateFunction::Sum, 3}}}), std::invalid_argument);  // "note0" is not a number
+    EXPECT_THROW(ResultAggregator(data.columns, {.aggregates = {{AggregateFunction::Sum, 9}}}), std::invalid_argument);
+    EXPECT_THROW(ResultAggregator(data.columns, {.groupBy = {7}, .aggregates = {{AggregateFunction::Count}}}), std::invalid_argument);
+    EXPECT_THROW(ResultAggregator(data.columns, {.aggregates = {{AggregateFunction::CountDistinct}}}), std::invalid_argument);
+
+    EXPECT_EQ(ResultAggregator::parseFunction("countDistinct"), AggregateFunction::CountDistinct);
+    EXPECT_FALSE(ResultAggregator::parseFunction("median").has_value());
+    EXPECT_EQ(ResultAggregator::functionName(AggregateFunction::Avg), "avg");
+}
+
+}  // namespace test
+}  // namespace velocitydb
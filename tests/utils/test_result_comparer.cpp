@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "utils/result_comparer.h"
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::vector<ColumnInfo> orderColumns() {
+    return {{.name = "id", .type = "INT"}, {.name = "status", .type = "NVARCHAR"}, {.name = "amount", .type = "FLOAT"}};
+}
+
+// id: i, status: "open" / "closed" (NULL every 7th row), amount: i * 1.5
+ResultSet makeOrders(int64_t first, int64_t count) {
+    ResultSet result;
+    result.columns = orderColumns();
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData.emplace_back(ColumnDataType::Double);
+    for (int64_t i = first; i < first + count; ++i) {
+        result.columnData[0].appendInt64(i);
+        if (i % 7 == 0) {
+            result.columnData[1].appendNull();
+        } else {
+            result.columnData[1].appendText(i % 2 == 0 ? "open" : "closed");
+        }
+        result.columnData[2].appendDouble(static_cast<double>(i) * 1.5);
+    }
+    return result;
+}
+
+CompareResult compare(const ResultSet& left, const ResultSet& right) {
+    ResultComparer comparer(left.columns, {"id"});
+    comparer.addLeft(left);
+    comparer.beginRight(right.columns);
+    comparer.addRight(right);
+    return comparer.finish();
+}
+
+}  // namespace
+
+TEST(ResultComparerTest, FindsInsertedDeletedAndChangedRows) {
+    auto left = makeOrders(0, 10);
+    // Rows 0-1 deleted, 2-11 present with row 5 changed, 10-11 inserted
+    auto right = makeOrders(2, 3);
+    right.columnData[0].appendInt64(5);
+    right.columnData[1].appendText("refunded");
+    right.columnData[2].appendDouble(7.5);
+    auto tail = makeOrders(6, 6);
+    right.appendBatch(tail);
+
+    auto result = compare(left, right);
+    EXPECT_EQ(result.insertedCount, 2u);
+    EXPECT_EQ(result.deletedCount, 2u);
+    EXPECT_EQ(result.changedCount, 1u);
+    EXPECT_EQ(result.unchangedCount, 7u);
+    EXPECT_FALSE(result.truncated);
+    EXPECT_EQ(result.keyColumns, std::vector<size_t>{0});
+
+    ASSERT_EQ(result.deleted.rowCount(), 2u);
+    EXPECT_EQ(result.deleted.cellText(0, 0), "0");
+    EXPECT_EQ(result.deleted.cellText(1, 0), "1");
+    ASSERT_EQ(result.inserted.rowCount(), 2u);
+    EXPECT_EQ(result.inserted.cellText(0, 0), "10");
+    ASSERT_EQ(result.changedColumns.size(), 1u);
+    EXPECT_EQ(result.changedColumns[0], std::vector<size_t>{1});
+    EXPECT_EQ(result.changedBefore.cellText(0, 1), "closed");
+    EXPECT_EQ(result.changedAfter.cellText(0, 1), "refunded");
+}
+
+TEST(ResultComparerTest, MatchesColumnsByNameAndIgnoresOneSidedColumns) {
+    auto left = makeOrders(0, 3);
+    ResultSet right;
+    right.columns = {{.name = "note", .type = "NVARCHAR"}, {.name = "amount", .type = "FLOAT"}, {.name = "id", .type = "INT"}};
+    right.columnData.emplace_back(ColumnDataType::Text);
+    right.columnData.emplace_back(ColumnDataType::Double);
+    right.columnData.emplace_back(ColumnDataType::Int64);
+    for (auto [note, amount, id] : {std::tuple{"x", 0.0, 0}, std::tuple{"y", 1.5, 1}, std::tuple{"z", 4.0, 2}}) {
+        right.columnData[0].appendText(note);
+        right.columnData[1].appendDouble(amount);
+        right.columnData[2].appendInt64(id);
+    }
+
+    auto result = compare(left, right);
+    ASSERT_EQ(result.columns.size(), 2u);
+    EXPECT_EQ(result.columns[0].name, "id");
+    EXPECT_EQ(result.columns[1].name, "amount");
+    EXPECT_EQ(result.unchangedCount, 2u);
+    ASSERT_EQ(result.changedCount, 1u);
+    EXPECT_EQ(result.changedColumns[0], std::vector<size_t>{1});
+}
+
+TEST(ResultComparerTest, ParallelBatchesMatchSerialCounts) {
+    const int64_t rows = static_cast<int64_t>(ResultComparer::PARALLEL_MIN_ROWS) * 2;
+    auto left = makeOrders(0, rows);
+    auto right = makeOrders(100, rows);
+
+    ResultComparer comparer(left.columns, {"id"});
+    comparer.addLeft(left);
+    comparer.beginRight(right.columns);
+    comparer.addRight(right);
+    auto result = comparer.finish();
+    EXPECT_EQ(result.insertedCount, 100u);
+    EXPECT_EQ(result.deletedCount, 100u);
+    EXPECT_EQ(result.changedCount, 0u);
+    EXPECT_EQ(result.unchangedCount, static_cast<size_t>(rows - 100));
+    EXPECT_EQ(result.inserted.cellText(0, 0), std::to_string(rows));
+    EXPECT_EQ(result.deleted.cellText(99, 0), "99");
+}
+
+TEST(ResultComparerTest, RejectsDuplicateAndMissingKeys) {
+    EXPECT_THROW(ResultComparer(orderColumns(), {"missing"}), std::invalid_argument);
+    EXPECT_THROW(ResultComparer(orderColumns(), {}), std::invalid_argument);
+
+    auto left = makeOrders(0, 3);
+    left.appendBatch(makeOrders(1, 1));
+    ResultComparer duplicates(left.columns, {"id"});
+    EXPECT_THROW(duplicates.addLeft(left), std::runtime_error);
+
+    ResultComparer noKeyOnRight(orderColumns(), {"id"});
+    EXPECT_THROW(noKeyOnRight.beginRight({{.name = "status", .type = "NVARCHAR"}}), std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "utils/result_delta.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+ResultSet makeResult(const std::vector<std::pair<int64_t, std::string>>& rows) {
+    ResultSet result;
+    result.columns.push_back({.name = "id", .type = "INT"});
+    result.columns.push_back({.name = "status", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (const auto& [id, status] : rows) {
+        result.columnData[0].appendInt64(id);
+        result.columnData[1].appendText(status);
+    }
+    return result;
+}
+
+const std::vector<std::string> ID_KEY = {"id"};
+
+}  // namespace
+
+TEST(ResultDeltaTest, KeyedDeltaReportsInsertedDeletedAndChangedRows) {
+    auto previous = makeResult({{1, "new"}, {2, "paid"}, {3, "shipped"}});
+    auto current = makeResult({{2, "refunded"}, {3, "shipped"}, {4, "new"}});
+
+    auto delta = ResultDelta::compute(previous, current, ID_KEY);
+    EXPECT_TRUE(delta.keyed);
+    EXPECT_EQ(delta.deleted, std::vector<size_t>{0});
+    EXPECT_EQ(delta.inserted, std::vector<size_t>{2});
+    EXPECT_EQ(delta.changed, (std::vector<std::pair<size_t, size_t>>{{1, 0}}));
+    EXPECT_EQ(delta.unchanged, 1u);
+    EXPECT_EQ(delta.size(), 3u);
+}
+
+TEST(ResultDeltaTest, RowHashDeltaPairsDuplicatesOneToOne) {
+    auto previous = makeResult({{1, "a"}, {1, "a"}, {2, "b"}});
+    auto current = makeResult({{1, "a"}, {2, "c"}});
+
+    auto delta = ResultDelta::compute(previous, current, {});
+    EXPECT_FALSE(delta.keyed);
+    EXPECT_EQ(delta.deleted, (std::vector<size_t>{1, 2}));
+    EXPECT_EQ(delta.inserted, std::vector<size_t>{1});
+    EXPECT_TRUE(delta.changed.empty());
+    EXPECT_EQ(delta.unchanged, 1u);
+}
+
+TEST(ResultDeltaTest, RejectsChangedColumnsAndDuplicateKeys) {
+    auto previous = makeResult({{1, "a"}});
+    ResultSet other;
+    other.columns.push_back({.name = "id", .type = "INT"});
+    other.columnData.emplace_back(ColumnDataType::Int64);
+    other.columnData[0].appendInt64(1);
+    EXPECT_THROW((void)ResultDelta::compute(previous, other, ID_KEY), std::invalid_argument);
+
+    const std::vector<std::string> unknown = {"missing"};
+    EXPECT_THROW((void)ResultDelta::compute(previous, previous, unknown), std::invalid_argument);
+
+    auto duplicated = makeResult({{1, "a"}, {1, "b"}});
+    EXPECT_THROW((void)ResultDelta::compute(previous, duplicated, ID_KEY), std::runtime_error);
+    EXPECT_THROW((void)ResultDelta::compute(duplicated, previous, ID_KEY), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "utils/result_joiner.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+// Orders from one server: id i, customer i % customers (NULL every 11th row)
+ResultSet makeOrders(int64_t count, int64_t customers) {
+    ResultSet result;
+    result.columns = {{.name = "id", .type = "INT"}, {.name = "customer", .type = "INT"}};
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    for (int64_t i = 0; i < count; ++i) {
+        result.columnData[0].appendInt64(i);
+        if (i % 11 == 10) {
+            result.columnData[1].appendNull();
+        } else {
+            result.columnData[1].appendInt64(i % customers);
+        }
+    }
+    return result;
+}
+
+// Customers from another server, their id fetched as text: id, name "c<id>"
+ResultSet makeCustomers(int64_t count) {
+    ResultSet result;
+    result.columns = {{.name = "id", .type = "VARCHAR"}, {.name = "name", .type = "NVARCHAR"}};
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (int64_t i = 0; i < count; ++i) {
+        result.columnData[0].appendText(std::to_string(i));
+        result.columnData[1].appendText("c" + std::to_string(i));
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(ResultJoinerTest, InnerJoinMatchesAcrossStorageTypesAndSkipsNullKeys) {
+    auto orders = makeOrders(22, 4);
+    auto customers = makeCustomers(3);  // Customer 3 is missing
+
+    auto joined = ResultJoiner::join(orders, customers, {"customer"}, {"id"});
+    EXPECT_FALSE(joined.builtOnLeft);
+    const auto& result = joined.result;
+    ASSERT_EQ(result.columns.size(), 3u);
+    EXPECT_EQ(result.columns[2].name, "name");
+    // 20 non-NULL customers, of which ids 3, 7, 11, 15, 19 have customer 3
+    ASSERT_EQ(result.rowCount(), 15u);
+    for (size_t row = 0; row < result.rowCount(); ++row) {
+        EXPECT_EQ(result.cellText(row, 2), "c" + result.cellText(row, 1));
+    }
+    EXPECT_EQ(result.cellText(0, 0), "0");
+    EXPECT_EQ(result.cellText(14, 0), "20");
+}
+
+TEST(ResultJoinerTest, LeftJoinKeepsUnmatchedRowsWhicheverSideIsHashed) {
+    auto orders = makeOrders(6, 4);
+    auto customers = makeCustomers(3);
+
+    auto smallRight = ResultJoiner::join(orders, customers, {"customer"}, {"id"}, JoinType::Left);
+    EXPECT_FALSE(smallRight.builtOnLeft);
+    ASSERT_EQ(smallRight.result.rowCount(), 6u);
+    EXPECT_TRUE(smallRight.result.isNull(3, 2));  // Customer 3
+    EXPECT_EQ(smallRight.result.cellText(4, 2), "c0");
+
+    auto manyCustomers = makeCustomers(100);
+    auto smallLeft = ResultJoiner::join(orders, manyCustomers, {"customer"}, {"id"}, JoinType::Left);
+    EXPECT_TRUE(smallLeft.builtOnLeft);
+    ASSERT_EQ(smallLeft.result.rowCount(), 6u);
+    for (size_t row = 0; row < 6; ++row) {
+        EXPECT_FALSE(smallLeft.result.isNull(row, 2));
+    }
+}
+
+TEST(ResultJoinerTest, RepeatedKeysMultiplyAndClashingNamesAreRenamed) {
+    auto left = makeCustomers(2);
+    auto right = makeCustomers(2);
+    right.appendBatch(makeCustomers(2));
+
+    auto joined = ResultJoiner::join(left, right, {"id"}, {"id"});
+    const auto& result = joined.result;
+    ASSERT_EQ(result.columns.size(), 3u);
+    EXPECT_EQ(result.columns[2].name, "name_2");
+    EXPECT_EQ(result.rowCount(), 4u);
+}
+
+TEST(ResultJoinerTest, ParallelJoinMatchesEveryRow) {
+    const int64_t rows = static_cast<int64_t>(ResultJoiner::PARALLEL_MIN_ROWS) * 2;
+    auto orders = makeOrders(rows, rows);
+    auto customers = makeCustomers(rows);
+
+    auto joined = ResultJoiner::join(orders, customers, {"customer"}, {"id"});
+    const auto& result = joined.result;
+    ASSERT_EQ(result.rowCount(), static_cast<size_t>(rows - rows / 11));
+    for (size_t row = 0; row < result.rowCount(); row += 997) {
+        EXPECT_EQ(result.cellText(row, 0), result.cellText(row, 1));
+        EXPECT_EQ(result.cellText(row, 2), "c" + result.cellText(row, 0));
+    }
+}
+
+TEST(ResultJoinerTest, RejectsUnknownKeys) {
+    auto orders = makeOrders(3, 3);
+    auto customers = makeCustomers(3);
+    EXPECT_THROW((void)ResultJoiner::join(orders, customers, {"customer"}, {"missing"}), std::invalid_argument);
+    EXPECT_THROW((void)ResultJoiner::join(orders, customers, {}, {}), std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "utils/result_snapshot.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+class ResultSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_dir = std::filesystem::temp_directory_path() / "velocitydb_snapshot_test";
+        std::filesystem::create_directories(m_dir);
+        m_path = (m_dir / "result.vdbr").string();
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+
+    std::filesystem::path m_dir;
+    std::string m_path;
+};
+
+// id: i, name: "item<i % 50>" (NULL every 9th row), price: i * 0.25, shipped: 2024-01-(i % 28 + 1)
+ResultSet makeItems(int64_t count) {
+    ResultSet result;
+    result.columns = {{.name = "id", .type = "INT", .nullable = false, .isPrimaryKey = true},
+                      {.name = "name", .type = "NVARCHAR", .size = 40},
+                      {.name = "price", .type = "FLOAT"},
+                      {.name = "shipped", .type = "DATE"}};
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Text);
+    result.columnData.emplace_back(ColumnDataType::Double);
+    result.columnData.emplace_back(ColumnDataType::Date);
+    for (int64_t i = 0; i < count; ++i) {
+        result.columnData[0].appendInt64(i);
+        if (i % 9 == 0) {
+            result.columnData[1].appendNull();
+        } else {
+            result.columnData[1].appendText("item" + std::to_string(i % 50));
+        }
+        result.columnData[2].appendDouble(static_cast<double>(i) * 0.25);
+        result.columnData[3].appendDateTime(DateTimeValue{.year = 2024, .month = 1, .day = static_cast<uint8_t>(i % 28 + 1)});
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_F(ResultSnapshotTest, SavedResultLoadsBackCellForCell) {
+    // Large enough for several blocks per column
+    auto original = makeItems(300000);
+    original.truncated = true;
+    (void)ResultSnapshot::save(original, m_path);
+
+    auto loaded = ResultSnapshot::load(m_path);
+    ASSERT_EQ(loaded.rowCount(), original.rowCount());
+    ASSERT_EQ(loaded.columns.size(), 4u);
+    EXPECT_TRUE(loaded.truncated);
+    EXPECT_EQ(loaded.columns[1].name, "name");
+    EXPECT_EQ(loaded.columns[1].size, 40);
+    EXPECT_TRUE(loaded.columns[0].isPrimaryKey);
+    for (size_t col = 0; col < 4; ++col) {
+        EXPECT_EQ(loaded.columnData[col].type(), original.columnData[col].type());
+    }
+    for (size_t row = 0; row < original.rowCount(); row += 1237) {
+        for (size_t col = 0; col < 4; ++col) {
+            EXPECT_EQ(loaded.isNull(row, col), original.isNull(row, col));
+            EXPECT_EQ(loaded.cellText(row, col), original.cellText(row, col));
+        }
+    }
+}
+
+TEST_F(ResultSnapshotTest, InspectReadsSchemaAndStatsWithoutTheData) {
+    auto saved = ResultSnapshot::save(makeItems(100), m_path);
+    auto info = ResultSnapshot::inspect(m_path);
+    EXPECT_EQ(info.rowCount, 100u);
+    EXPECT_EQ(info.fileBytes, saved.fileBytes);
+    ASSERT_EQ(info.columns.size(), 4u);
+    EXPECT_EQ(info.columns[0].min, "0");
+    EXPECT_EQ(info.columns[0].max, "99");
+    EXPECT_EQ(info.columns[1].nullCount, 12u);
+    EXPECT_EQ(info.columns[1].min, "item0");
+    EXPECT_EQ(info.columns[1].max, "item9");
+    EXPECT_EQ(info.columns[3].storage, ColumnDataType::Date);
+    EXPECT_EQ(info.columns[3].max, saved.columns[3].max);
+}
+
+TEST_F(ResultSnapshotTest, EmptyResultKeepsItsColumns) {
+    ResultSet empty;
+    empty.columns = {{.name = "a"}, {.name = "b"}};
+    (void)ResultSnapshot::save(empty, m_path);
+
+    auto loaded = ResultSnapshot::load(m_path);
+    EXPECT_EQ(loaded.columns.size(), 2u);
+    EXPECT_EQ(loaded.rowCount(), 0u);
+    EXPECT_FALSE(ResultSnapshot::inspect(m_path).columns[0].min);
+}
+
+TEST_F(ResultSnapshotTest, RejectsOtherFiles) {
+    std::ofstream(m_path, std::ios::binary) << "id,name\n1,a\n";
+    EXPECT_THROW((void)ResultSnapshot::inspect(m_path), std::runtime_error);
+    EXPECT_THROW((void)ResultSnapshot::load((m_dir / "missing.vdbr").string()), std::runtime_error);
+}
+
+}  // namespace test
+}  // namespace velocitydb
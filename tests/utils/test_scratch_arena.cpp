@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "utils/scratch_arena.h"
+
+#include <thread>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+TEST(ScratchArenaTest, LeasesOnOneThreadReuseTheSameBlock) {
+    std::thread([] {
+        const void* first = nullptr;
+        {
+            ScratchArena::Lease lease;
+            std::pmr::vector<char> buffer(1024, lease.resource());
+            first = buffer.data();
+        }
+        ScratchArena::Lease lease;
+        std::pmr::vector<char> buffer(1024, lease.resource());
+        EXPECT_EQ(buffer.data(), first);
+        EXPECT_EQ(ScratchArena::retainedBytes(), ScratchArena::INITIAL_BYTES);
+    }).join();
+}
+
+TEST(ScratchArenaTest, BlockGrowsToTheLargestLeaseUpToTheCap) {
+    std::thread([] {
+        {
+            ScratchArena::Lease lease;
+            std::pmr::vector<char> buffer(ScratchArena::INITIAL_BYTES * 4, lease.resource());
+        }
+        const size_t grown = ScratchArena::retainedBytes();
+        EXPECT_GE(grown, ScratchArena::INITIAL_BYTES * 4);
+        EXPECT_LE(grown, ScratchArena::MAX_RETAINED_BYTES);
+        {
+            // Fits now, so the block stays as it is
+            ScratchArena::Lease lease;
+            std::pmr::vector<char> buffer(ScratchArena::INITIAL_BYTES * 4, lease.resource());
+        }
+        EXPECT_EQ(ScratchArena::retainedBytes(), grown);
+        {
+            ScratchArena::Lease lease;
+            std::pmr::vector<char> buffer(ScratchArena::MAX_RETAINED_BYTES * 2, lease.resource());
+        }
+        EXPECT_EQ(ScratchArena::retainedBytes(), ScratchArena::MAX_RETAINED_BYTES);
+    }).join();
+}
+
+TEST(ScratchArenaTest, NestedLeaseDoesNotShareTheBlock) {
+    std::thread([] {
+        ScratchArena::Lease outer;
+        std::pmr::vector<int> kept(16, 7, outer.resource());
+        {
+            ScratchArena::Lease inner;
+            std::pmr::vector<int> temporary(4096, 1, inner.resource());
+        }
+        EXPECT_EQ(kept, std::pmr::vector<int>(16, 7));
+        std::pmr::vector<int> more(16, 9, outer.resource());
+        EXPECT_NE(more.data(), kept.data());
+        EXPECT_EQ(kept.front(), 7);
+    }).join();
+}
+
+}  // namespace test
+}  // namespace velocitydb
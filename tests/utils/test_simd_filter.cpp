@@ -0,0 +1,386 @@
+#include <gtest/gtest.h>
+#include "utils/simd_filter.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+constexpr SimdLevel ALL_LEVELS[] = {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512};
+
+/// Restores the detected level so one test's cap does not leak into the next
+class SIMDFilterTest : public ::testing::Test {
+protected:
+    void TearDown() override { SIMDFilter::limitLevel(SIMDFilter::detectedLevel()); }
+
+    /// Mixed-length text rows (every 13th NULL) that put needles across row boundaries and vector blocks
+    static ResultSet makeTextResult(size_t rows) {
+        ResultSet result;
+        result.columns.push_back({.name = "name", .type = "NVARCHAR"});
+        result.columnData.emplace_back(ColumnDataType::Text);
+        std::mt19937 rng(42);
+        const std::string alphabet = "abcxyz";
+        for (size_t i = 0; i < rows; ++i) {
+            if (i % 13 == 0) {
+                result.columnData[0].appendNull();
+                continue;
+            }
+            std::string value(rng() % 90, 'a');
+            for (auto& c : value) {
+                c = alphabet[rng() % alphabet.size()];
+            }
+            result.columnData[0].appendText(value);
+        }
+        return result;
+    }
+
+    static ResultSet makeNumericResult(size_t rows) {
+        ResultSet result;
+        result.columns.push_back({.name = "n", .type = "BIGINT"});
+        result.columns.push_back({.name = "d", .type = "FLOAT"});
+        result.columnData.emplace_back(ColumnDataType::Int64);
+        result.columnData.emplace_back(ColumnDataType::Double);
+        for (size_t i = 0; i < rows; ++i) {
+            if (i % 7 == 3) {
+                result.columnData[0].appendNull();
+                result.columnData[1].appendNull();
+                continue;
+            }
+            result.columnData[0].appendInt64(static_cast<int64_t>(i % 50) - 25);
+            result.columnData[1].appendDouble(static_cast<double>(i) * 0.5 - 40.0);
+        }
+        return result;
+    }
+};
+
+}  // namespace
+
+TEST_F(SIMDFilterTest, LevelIsClampedToDetected) {
+    SIMDFilter::limitLevel(SimdLevel::AVX512);
+    EXPECT_EQ(SIMDFilter::activeLevel(), SIMDFilter::detectedLevel());
+    SIMDFilter::limitLevel(SimdLevel::Scalar);
+    EXPECT_EQ(SIMDFilter::activeLevel(), SimdLevel::Scalar);
+    EXPECT_EQ(SIMDFilter::levelName(SimdLevel::AVX2), "avx2");
+}
+
+TEST_F(SIMDFilterTest, ContainsMatchesScalarReferenceAtEveryLevel) {
+    auto result = makeTextResult(700);
+    const auto& column = result.columnData[0];
+    SIMDFilter filter;
+    const std::vector<std::string> needles = {"a", "xy", "abc", "zzz", "cabxa", "xyzxyzxyzxyzxyzx", std::string(40, 'q')};
+    for (const auto& needle : needles) {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < column.size(); ++i) {
+            if (column.textAt(i).find(needle) != std::string_view::npos) {
+                expected.push_back(i);
+            }
+        }
+        for (auto level : ALL_LEVELS) {
+            SIMDFilter::limitLevel(level);
+            EXPECT_EQ(filter.filterContains(result, 0, needle), expected) << needle << " at " << SIMDFilter::levelName(SIMDFilter::activeLevel());
+        }
+    }
+}
+
+TEST_F(SIMDFilterTest, ContainsDoesNotMatchAcrossRowBoundary) {
+    ResultSet result;
+    result.columns.push_back({.name = "s", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (int i = 0; i < 40; ++i) {
+        result.columnData[0].appendText("xxab");
+        result.columnData[0].appendText("cdxx");
+    }
+    result.columnData[0].appendText("abcd");
+
+    SIMDFilter filter;
+    for (auto level : ALL_LEVELS) {
+        SIMDFilter::limitLevel(level);
+        EXPECT_EQ(filter.filterContains(result, 0, "abcd"), std::vector<size_t>{80});
+        EXPECT_EQ(filter.filterContains(result, 0, "").size(), 81u);
+    }
+}
+
+TEST_F(SIMDFilterTest, CaseInsensitiveContainsFoldsAsciiLettersOnly) {
+    ResultSet result;
+    result.columns.push_back({.name = "s", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Text);
+    std::mt19937 rng(7);
+    // '@' and '`' differ from 'A' and 'a' only in the bit that folds letters
+    const std::string alphabet = "aAbBzZ@`[{";
+    for (size_t i = 0; i < 500; ++i) {
+        std::string value(rng() % 70, 'a');
+        for (auto& c : value) {
+            c = alphabet[rng() % alphabet.size()];
+        }
+        result.columnData[0].appendText(value);
+    }
+    auto lower = [](std::string_view text) {
+        std::string lowered(text);
+        std::ranges::transform(lowered, lowered.begin(), [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : c; });
+        return lowered;
+    };
+
+    SIMDFilter filter;
+    for (const std::string needle : {"A", "zB", "@a", "`Z[", "ab{BA", "AbAbAbAbAbAbAbAbAb"}) {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < 500; ++i) {
+            if (lower(result.columnData[0].textAt(i)).find(lower(needle)) != std::string::npos) {
+                expected.push_back(i);
+            }
+        }
+        for (auto level : ALL_LEVELS) {
+            SIMDFilter::limitLevel(level);
+            auto mask = filter.containsMask(result, 0, needle, true);
+            EXPECT_EQ(SIMDFilter::maskToIndices(mask, 500), expected) << needle << " at " << SIMDFilter::levelName(SIMDFilter::activeLevel());
+        }
+    }
+}
+
+TEST_F(SIMDFilterTest, SearchMasksMatchPerColumnContainsAcrossChunks) {
+    constexpr size_t rows = SIMDFilter::SEARCH_CHUNK_ROWS * 2 + 77;
+    auto result = makeTextResult(rows);
+    result.columns.push_back({.name = "n", .type = "BIGINT"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    for (size_t i = 0; i < rows; ++i) {
+        result.columnData[1].appendInt64(static_cast<int64_t>(i));
+    }
+
+    SIMDFilter filter;
+    auto masks = filter.searchMasks(result, "Cab", true);
+    ASSERT_EQ(masks.size(), 2u);
+    EXPECT_EQ(masks[0], filter.containsMask(result, 0, "cab"));
+    EXPECT_TRUE(std::ranges::all_of(masks[1], [](uint64_t word) { return word == 0; }));
+
+    masks = filter.searchMasks(result, "1234", false);
+    EXPECT_EQ(masks[0], filter.containsMask(result, 0, "1234"));
+    EXPECT_EQ(masks[1], filter.containsMask(result, 1, "1234"));
+    EXPECT_EQ(SIMDFilter::maskToIndices(masks[1], rows).front(), 1234u);
+
+    masks = filter.searchMasks(result, "", false);
+    EXPECT_TRUE(std::ranges::all_of(masks[0], [](uint64_t word) { return word == 0; }));
+}
+
+TEST_F(SIMDFilterTest, EqualsComparesWholeTextValue) {
+    auto result = makeTextResult(300);
+    const auto& column = result.columnData[0];
+    const std::string target(column.textAt(5));
+    std::vector<size_t> expected;
+    std::vector<size_t> expectedEmpty;
+    for (size_t i = 0; i < column.size(); ++i) {
+        if (column.textAt(i) == target) {
+            expected.push_back(i);
+        }
+        if (column.textAt(i).empty()) {
+            expectedEmpty.push_back(i);
+        }
+    }
+
+    SIMDFilter filter;
+    for (auto level : ALL_LEVELS) {
+        SIMDFilter::limitLevel(level);
+        EXPECT_EQ(filter.filterEquals(result, 0, target), expected);
+        EXPECT_EQ(filter.filterEquals(result, 0, ""), expectedEmpty);
+    }
+}
+
+TEST_F(SIMDFilterTest, DictionaryColumnFiltersLikePlainText) {
+    // Same values twice: a low-cardinality column stays dictionary-encoded, one converted from a typed
+    // column is plain
+    const std::vector<std::string> values = {"tokyo", "osaka", "", "kyoto", "tokyo-east"};
+    ResultSet dictionary;
+    ResultSet plain;
+    for (auto* result : {&dictionary, &plain}) {
+        result->columns.push_back({.name = "city", .type = "NVARCHAR"});
+    }
+    dictionary.columnData.emplace_back(ColumnDataType::Text);
+    plain.columnData.emplace_back(ColumnDataType::Int64);
+    for (size_t i = 0; i < 3000; ++i) {
+        if (i % 17 == 0) {
+            dictionary.columnData[0].appendNull();
+            plain.columnData[0].appendNull();
+            continue;
+        }
+        dictionary.columnData[0].appendText(values[(i * 7) % values.size()]);
+        plain.columnData[0].appendFromText(values[(i * 7) % values.size()]);
+    }
+    ASSERT_TRUE(dictionary.columnData[0].isDictionaryEncoded());
+    ASSERT_FALSE(plain.columnData[0].isDictionaryEncoded());
+
+    SIMDFilter filter;
+    for (auto level : ALL_LEVELS) {
+        SIMDFilter::limitLevel(level);
+        for (const std::string value : {"tokyo", "", "nagoya"}) {
+            EXPECT_EQ(filter.filterEquals(dictionary, 0, value), filter.filterEquals(plain, 0, value)) << value;
+        }
+        EXPECT_EQ(filter.filterContains(dictionary, 0, "to"), filter.filterContains(plain, 0, "to"));
+        EXPECT_EQ(filter.filterRange(dictionary, 0, "k", "p"), filter.filterRange(plain, 0, "k", "p"));
+    }
+    EXPECT_FALSE(filter.filterEquals(dictionary, 0, "tokyo").empty());
+}
+
+TEST_F(SIMDFilterTest, NumericEqualsAndRangeSkipNulls) {
+    auto result = makeNumericResult(203);
+    const auto& ints = result.columnData[0];
+    const auto& doubles = result.columnData[1];
+    std::vector<size_t> expectedEquals;
+    std::vector<size_t> expectedIntRange;
+    std::vector<size_t> expectedDoubleRange;
+    std::vector<size_t> expectedNulls;
+    for (size_t i = 0; i < ints.size(); ++i) {
+        if (ints.isNull(i)) {
+            expectedNulls.push_back(i);
+            continue;
+        }
+        if (ints.int64At(i) == -7) {
+            expectedEquals.push_back(i);
+        }
+        if (ints.int64At(i) >= -2 && ints.int64At(i) <= 10) {
+            expectedIntRange.push_back(i);
+        }
+        if (doubles.doubleAt(i) >= -3.25 && doubles.doubleAt(i) <= 12.5) {
+            expectedDoubleRange.push_back(i);
+        }
+    }
+
+    SIMDFilter filter;
+    for (auto level : ALL_LEVELS) {
+        SIMDFilter::limitLevel(level);
+        EXPECT_EQ(filter.filterEquals(result, 0, "-7"), expectedEquals);
+        EXPECT_EQ(filter.filterEquals(result, 0, ""), expectedNulls);
+        EXPECT_TRUE(filter.filterEquals(result, 0, "-7x").empty());
+        // Fractional bounds on an integer column round inwards
+        EXPECT_EQ(filter.filterRange(result, 0, "-2.5", "10.9"), expectedIntRange);
+        EXPECT_EQ(filter.filterRange(result, 1, "-3.25", "12.5"), expectedDoubleRange);
+        EXPECT_TRUE(filter.filterRange(result, 0, "5", "4").empty());
+    }
+}
+
+TEST_F(SIMDFilterTest, ZoneMapsSkipBlocksWithoutChangingMatches) {
+    // Ascending keys (NULLs only early on), folded into zones except for an unaligned tail
+    ResultSet result;
+    result.columns.push_back({.name = "n", .type = "BIGINT"});
+    result.columns.push_back({.name = "d", .type = "FLOAT"});
+    result.columnData.emplace_back(ColumnDataType::Int64);
+    result.columnData.emplace_back(ColumnDataType::Double);
+    auto append = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) {
+            if (i < 1000 && i % 9 == 0) {
+                result.columnData[0].appendNull();
+                result.columnData[1].appendNull();
+                continue;
+            }
+            result.columnData[0].appendInt64(static_cast<int64_t>(i / 10));
+            result.columnData[1].appendDouble(static_cast<double>(i) * 0.25);
+        }
+    };
+    append(0, 15000);
+    result.updateStats();
+    append(15000, 20011);
+    ASSERT_EQ(result.columnData[0].stats().zones().size(), 4);
+
+    auto expected = [&](size_t col, double lo, double hi) {
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < result.rowCount(); ++i) {
+            if (!result.isNull(i, col) && result.columnData[col].numericAt(i) >= lo && result.columnData[col].numericAt(i) <= hi) {
+                rows.push_back(i);
+            }
+        }
+        return rows;
+    };
+    SIMDFilter filter;
+    for (auto level : ALL_LEVELS) {
+        SIMDFilter::limitLevel(level);
+        EXPECT_EQ(filter.filterRange(result, 0, "500", "520"), expected(0, 500, 520));
+        EXPECT_EQ(filter.filterRange(result, 0, "1490", "1510"), expected(0, 1490, 1510));  // across the tail
+        EXPECT_EQ(filter.filterRange(result, 0, "-5", "100000"), expected(0, -5, 100000));   // whole zones set
+        EXPECT_EQ(filter.filterEquals(result, 0, "1234"), expected(0, 1234, 1234));
+        EXPECT_EQ(filter.filterRange(result, 1, "1000", "1024.5"), expected(1, 1000, 1024.5));
+        EXPECT_TRUE(filter.filterRange(result, 0, "-10", "-1").empty());
+    }
+}
+
+TEST_F(SIMDFilterTest, FilterDispatchesOnParsedType) {
+    auto result = makeNumericResult(60);
+    SIMDFilter filter;
+    ASSERT_EQ(SIMDFilter::parseFilterType("range"), FilterType::Range);
+    EXPECT_EQ(SIMDFilter::parseFilterType("contains"), FilterType::Contains);
+    EXPECT_EQ(SIMDFilter::parseFilterType("equals"), FilterType::Equals);
+    EXPECT_FALSE(SIMDFilter::parseFilterType("like").has_value());
+    EXPECT_EQ(filter.filter(result, 0, FilterType::Range, "0", "5"), filter.filterRange(result, 0, "0", "5"));
+    EXPECT_EQ(filter.filter(result, 0, FilterType::Equals, "4", "ignored"), filter.filterEquals(result, 0, "4"));
+}
+
+TEST_F(SIMDFilterTest, SortsTypedColumnsWithNullsAtTheLowEnd) {
+    auto result = makeNumericResult(1000);
+    SIMDFilter filter;
+    for (size_t column = 0; column < 2; ++column) {
+        const auto& data = result.columnData[column];
+        std::vector<size_t> expected(data.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) { return !data.isNull(b) && (data.isNull(a) || data.numericAt(a) < data.numericAt(b)); });
+        EXPECT_EQ(filter.sortByColumn(result, column, true), expected);
+
+        std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) { return !data.isNull(a) && (data.isNull(b) || data.numericAt(a) > data.numericAt(b)); });
+        EXPECT_EQ(filter.sortByColumn(result, column, false), expected);
+    }
+}
+
+TEST_F(SIMDFilterTest, SortsDatesChronologically) {
+    ResultSet result;
+    result.columns.push_back({.name = "at", .type = "DATETIME2"});
+    result.columnData.emplace_back(ColumnDataType::Timestamp);
+    result.columnData[0].appendDateTime({.year = 2024, .month = 3, .day = 1, .hour = 0, .minute = 0, .second = 0, .fraction = 0});
+    result.columnData[0].appendDateTime({.year = 2023, .month = 12, .day = 31, .hour = 23, .minute = 59, .second = 59, .fraction = 0});
+    result.columnData[0].appendNull();
+    result.columnData[0].appendDateTime({.year = 2024, .month = 3, .day = 1, .hour = 0, .minute = 0, .second = 0, .fraction = 500});
+
+    SIMDFilter filter;
+    EXPECT_EQ(filter.sortByColumn(result, 0, true), (std::vector<size_t>{2, 1, 0, 3}));
+    EXPECT_EQ(filter.sortByColumn(result, 0, false), (std::vector<size_t>{3, 0, 1, 2}));
+}
+
+TEST_F(SIMDFilterTest, SortsTextNumbersBeforeWords) {
+    ResultSet result;
+    result.columns.push_back({.name = "v", .type = "NVARCHAR"});
+    result.columnData.emplace_back(ColumnDataType::Text);
+    for (const char* value : {"banana", "10", "", "9.5", "apple", "applesauce", "-3", "apple"}) {
+        result.columnData[0].appendText(value);
+    }
+
+    SIMDFilter filter;
+    EXPECT_EQ(filter.sortByColumn(result, 0, true), (std::vector<size_t>{2, 6, 3, 1, 4, 7, 5, 0}));
+    EXPECT_EQ(filter.sortByColumn(result, 0, false), (std::vector<size_t>{0, 5, 4, 7, 1, 3, 6, 2}));
+}
+
+TEST_F(SIMDFilterTest, SortWindowMatchesFullSort) {
+    auto text = makeTextResult(5000);
+    auto numbers = makeNumericResult(5000);
+    SIMDFilter filter;
+    for (const auto* result : {&text, &numbers}) {
+        for (bool ascending : {true, false}) {
+            const auto full = filter.sortByColumn(*result, 0, ascending);
+            for (auto [offset, count] : {std::pair<size_t, size_t>{0, 50}, {300, 100}, {4990, 100}, {6000, 10}}) {
+                const size_t begin = (std::min)(offset, full.size());
+                const size_t end = (std::min)(offset + count, full.size());
+                EXPECT_EQ(filter.sortWindow(*result, 0, ascending, offset, count), std::vector<size_t>(full.begin() + begin, full.begin() + end));
+            }
+        }
+    }
+}
+
+TEST_F(SIMDFilterTest, OutOfRangeColumnMatchesNothing) {
+    auto result = makeNumericResult(10);
+    SIMDFilter filter;
+    EXPECT_TRUE(filter.filterEquals(result, 5, "1").empty());
+    EXPECT_TRUE(filter.filterContains(result, 5, "1").empty());
+    EXPECT_TRUE(filter.filterRange(result, 5, "1", "2").empty());
+}
+
+}  // namespace test
+}  // namespace velocitydb
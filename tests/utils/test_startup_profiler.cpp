@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "utils/metrics.h"
+#include "utils/startup_profiler.h"
+
+#include <chrono>
+#include <thread>
+
+namespace velocitydb {
+namespace test {
+
+using namespace std::chrono_literals;
+
+TEST(StartupProfilerTest, TimelineListsPhasesInStartOrder) {
+    StartupProfiler profiler;
+    EXPECT_EQ(profiler.timeline(), "");
+
+    {
+        auto outer = profiler.phase("window");
+        std::this_thread::sleep_for(2ms);
+        {
+            auto inner = profiler.phase("settings");  // Ends first, but started second
+        }
+    }
+    std::jthread([&] { auto timer = profiler.phase("history"); }).join();
+
+    const auto timeline = profiler.timeline();
+    const auto window = timeline.find("window ");
+    const auto settings = timeline.find("settings ");
+    const auto history = timeline.find("history ");
+    ASSERT_NE(window, std::string::npos) << timeline;
+    ASSERT_NE(settings, std::string::npos) << timeline;
+    ASSERT_NE(history, std::string::npos) << timeline;
+    EXPECT_LT(window, settings);
+    EXPECT_LT(settings, history);
+}
+
+TEST(StartupProfilerTest, ReportsInteractiveOnlyOnce) {
+    StartupProfiler profiler;
+    std::this_thread::sleep_for(1ms);
+    EXPECT_GT(profiler.elapsedMs(), 0.0);
+
+    EXPECT_TRUE(profiler.reportInteractive());
+    EXPECT_FALSE(profiler.reportInteractive());
+    EXPECT_GE(MetricsRegistry::instance().gauge("startup.interactive_ms").value(), 0);
+}
+
+}  // namespace test
+}  // namespace velocitydb
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "utils/cpu_features.h"
+#include "utils/utf16_transcode.h"
+
+#include <string>
+
+namespace velocitydb {
+namespace test {
+
+namespace {
+
+std::string transcode(std::u16string_view text) {
+    std::string out;
+    appendUtf16AsUtf8(out, text);
+    return out;
+}
+
+/// Reference encoder: one code point at a time, no fast paths
+std::string reference(std::u16string_view text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        uint32_t cp = text[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (text[++i] - 0xDC00);
+        } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+            cp = 0xFFFD;
+        }
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(Utf16TranscodeTest, EncodesEachUtf8Length) {
+    EXPECT_EQ(transcode(u""), "");
+    EXPECT_EQ(transcode(u"SELECT 1"), "SELECT 1");
+    EXPECT_EQ(transcode(u"éЖ"), "\xc3\xa9\xd0\x96");
+    EXPECT_EQ(transcode(u"日本語"), "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e");
+    EXPECT_EQ(transcode(u"\U0001F600"), "\xf0\x9f\x98\x80");
+}
+
+TEST(Utf16TranscodeTest, ReplacesUnpairedSurrogates) {
+    const std::u16string lone = {u'a', char16_t(0xD800), u'b', char16_t(0xDC00)};
+    EXPECT_EQ(transcode(lone), "a\xef\xbf\xbd" "b\xef\xbf\xbd");
+    const std::u16string trailingHigh = {u'x', char16_t(0xDBFF)};
+    EXPECT_EQ(transcode(trailingHigh), "x\xef\xbf\xbd");
+}
+
+TEST(Utf16TranscodeTest, MatchesReferenceAcrossVectorBoundaries) {
+    // Non-ASCII units and surrogate pairs at every offset around the 8/16/32-unit vector edges, for every
+    // kernel the CPU can run
+    const std::u16string inserts[] = {u"é", u"日", u"\U0001F600", std::u16string{char16_t(0xD800)}};
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        limitSimdLevel(level);
+        for (size_t length : {1u, 7u, 8u, 15u, 16u, 17u, 31u, 32u, 33u, 63u, 65u, 100u}) {
+            const std::u16string ascii(length, u'a');
+            EXPECT_EQ(transcode(ascii), std::string(length, 'a'));
+            for (const auto& insert : inserts) {
+                for (size_t at = 0; at <= length; ++at) {
+                    auto text = ascii;
+                    text.insert(at, insert);
+                    ASSERT_EQ(transcode(text), reference(text)) << simdLevelName(level) << " length " << length << " at " << at;
+                }
+            }
+        }
+    }
+    limitSimdLevel(detectedSimdLevel());
+}
+
+TEST(Utf16TranscodeTest, AppendsAfterExistingContent) {
+    std::string out = "prefix:";
+    appendUtf16AsUtf8(out, u"été");
+    EXPECT_EQ(out, "prefix:\xc3\xa9t\xc3\xa9");
+}
+
+}  // namespace test
+}  // namespace velocitydb
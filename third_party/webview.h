@@ -8,16 +8,18 @@
 #define WEBVIEW_H
 
 #include <atomic>
+#include <charconv>
 #include <condition_variable>
 #include <cstdio>
 #include <format>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 #include <thread>
-#include "simdjson.h"
 
 #define WEBVIEW_HINT_NONE 0
 #define WEBVIEW_HINT_MIN 1
@@ -67,6 +69,21 @@ struct IPCResponse {
     std::string response;
 };
 
+// Custom Windows message for backend-initiated events
+constexpr UINT WM_IPC_EVENT = WM_USER + 2;
+
+struct IPCEvent {
+    std::string name;
+    std::string payload;  // JSON
+};
+
+// Response body and headers for a request answered from a serve_assets handler
+struct resource {
+    std::shared_ptr<const std::string> body;
+    std::string content_type = "application/octet-stream";
+    std::string cache_control = "no-store";
+};
+
 class webview {
 public:
     webview(bool debug = false, void* window = nullptr)
@@ -123,12 +140,74 @@ public:
         m_bindings[name] = fn;
     }
 
+    // Bind a handler that answers later: it gets the request and a callback resolving the page's promise.
+    // The handler runs on the UI thread and must only queue the work; the callback may run on any thread.
+    // Takes precedence over bind() for the same name.
+    void bind_async(const std::string& name, std::function<void(std::string, std::function<void(std::string)>)> fn) {
+        m_asyncBindings[name] = std::move(fn);
+    }
+
+    // Resolve the page's pending invoke() call `id` with a JSON response. Safe to call from any thread.
+    void resolve(int64_t id, std::string response) {
+        HWND hwnd = m_hwnd;
+        if (!hwnd) {
+            return;
+        }
+        auto* resp = new IPCResponse{id, std::move(response)};
+        if (!PostMessage(hwnd, WM_IPC_RESPONSE, 0, reinterpret_cast<LPARAM>(resp))) {
+            delete resp;
+        }
+    }
+
+    // Serve https://<host>/<path> from a callback (binary payloads the page fetches directly).
+    // The handler runs on the UI thread; returning nullopt answers 404.
+    void serve_resources(const std::string& host, std::function<std::optional<std::string>(const std::string&)> handler) {
+        m_resourceHandlers[host] = [handler = std::move(handler)](const std::string& path) -> std::optional<resource> {
+            auto body = handler(path);
+            if (!body) return std::nullopt;
+            return resource{std::make_shared<const std::string>(std::move(*body))};
+        };
+    }
+
+    // Serve https://<host>/<path> with the handler's content type and caching policy (the page itself).
+    // Takes precedence over set_frontend_path for the same host; the handler runs on the UI thread.
+    void serve_assets(const std::string& host, std::function<std::optional<resource>(const std::string&)> handler) {
+        m_resourceHandlers[host] = std::move(handler);
+    }
+
+    // Start creating the WebView2 environment now instead of in run(). The browser process launches while
+    // the caller finishes its own startup work; run() then only has to create the window and controller.
+    // Call on the thread that will call run(), after COM is initialized.
+    void prewarm() {
+        if (!m_environmentRequested) {
+            initWebView2();
+        }
+    }
+
+    // Raise a "backend:<name>" CustomEvent in the page with the JSON payload as its detail.
+    // Safe to call from any thread; events sent before the window exists are dropped.
+    void emit(const std::string& name, const std::string& payloadJson) {
+        HWND hwnd = m_hwnd;
+        if (!hwnd) {
+            return;
+        }
+        auto* evt = new IPCEvent{name, payloadJson};
+        if (!PostMessage(hwnd, WM_IPC_EVENT, 0, reinterpret_cast<LPARAM>(evt))) {
+            delete evt;
+        }
+    }
+
     void run() {
         if (!m_hwnd) {
             createWindow();
         }
 
-        initWebView2();
+        if (!m_environmentRequested) {
+            initWebView2();
+        } else if (m_environment && !m_webviewController) {
+            // The prewarmed environment completed before the window existed
+            createController();
+        }
 
         MSG msg;
         while (GetMessage(&msg, nullptr, 0, 0)) {
@@ -221,6 +300,7 @@ private:
         }
         LPCWSTR userDataFolderPtr = wUserDataFolder.empty() ? nullptr : wUserDataFolder.c_str();
 
+        m_environmentRequested = true;
         HRESULT hr = CreateCoreWebView2EnvironmentWithOptions(
             nullptr, userDataFolderPtr, nullptr,
             Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
@@ -248,7 +328,17 @@ private:
             return result;
         }
 
-        env->CreateCoreWebView2Controller(
+        m_environment = env;
+
+        // Prewarmed: the controller is created by run() once the window exists
+        if (!m_hwnd) {
+            return S_OK;
+        }
+        return createController();
+    }
+
+    HRESULT createController() {
+        m_environment->CreateCoreWebView2Controller(
             m_hwnd,
             Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
                 [this](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT {
@@ -281,6 +371,9 @@ private:
                     // Setup virtual host mapping for local files (fixes CORS)
                     setupVirtualHostMapping();
 
+                    // Serve callback-backed resources (binary query results)
+                    setupResourceHandlers();
+
                     // Setup bindings
                     setupBindings();
 
@@ -393,6 +486,55 @@ private:
         }
     }
 
+    void setupResourceHandlers() {
+        if (!m_webviewWindow || !m_environment || m_resourceHandlers.empty()) return;
+
+        for (const auto& [host, handler] : m_resourceHandlers) {
+            std::wstring filter = utf8_to_utf16("https://" + host + "/*");
+            m_webviewWindow->AddWebResourceRequestedFilter(filter.c_str(), COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
+        }
+
+        m_webviewWindow->add_WebResourceRequested(
+            Callback<ICoreWebView2WebResourceRequestedEventHandler>(
+                [this](ICoreWebView2* /*sender*/, ICoreWebView2WebResourceRequestedEventArgs* args) -> HRESULT {
+                    ComPtr<ICoreWebView2WebResourceRequest> request;
+                    args->get_Request(&request);
+                    LPWSTR uriRaw = nullptr;
+                    if (!request || FAILED(request->get_Uri(&uriRaw)) || !uriRaw) {
+                        return S_OK;
+                    }
+                    std::string uri = utf16_to_utf8(uriRaw);
+                    CoTaskMemFree(uriRaw);
+
+                    // https://<host>/<path>[?query]
+                    constexpr std::string_view scheme = "https://";
+                    if (uri.compare(0, scheme.size(), scheme) != 0) return S_OK;
+                    size_t hostEnd = uri.find('/', scheme.size());
+                    if (hostEnd == std::string::npos) return S_OK;
+                    auto it = m_resourceHandlers.find(uri.substr(scheme.size(), hostEnd - scheme.size()));
+                    if (it == m_resourceHandlers.end()) return S_OK;
+                    std::string path = uri.substr(hostEnd + 1, uri.find_first_of("?#", hostEnd) - hostEnd - 1);
+
+                    auto found = it->second(path);
+                    ComPtr<IStream> stream;
+                    if (found && found->body) {
+                        stream.Attach(SHCreateMemStream(reinterpret_cast<const BYTE*>(found->body->data()), static_cast<UINT>(found->body->size())));
+                    } else {
+                        found.reset();
+                    }
+                    std::wstring headers = L"Access-Control-Allow-Origin: *\r\nContent-Type: " +
+                        utf8_to_utf16(found ? found->content_type : "text/plain") + L"\r\nCache-Control: " +
+                        utf8_to_utf16(found ? found->cache_control : "no-store");
+                    ComPtr<ICoreWebView2WebResourceResponse> response;
+                    m_environment->CreateWebResourceResponse(stream.Get(), found ? 200 : 404, found ? L"OK" : L"Not Found", headers.c_str(), &response);
+                    args->put_Response(response.Get());
+                    return S_OK;
+                }
+            ).Get(),
+            nullptr
+        );
+    }
+
     void setupBindings() {
         if (!m_webviewWindow) return;
 
@@ -405,9 +547,9 @@ private:
     window.invoke = function(request) {
         return new Promise((resolve, reject) => {
             const id = ++requestId;
-            const wrappedRequest = JSON.stringify({ __id: id, __data: request });
             pendingRequests.set(id, { resolve, reject });
-            window.chrome.webview.postMessage(wrappedRequest);
+            // "<id>\n<request>": the request JSON is forwarded untouched and parsed once by the handler
+            window.chrome.webview.postMessage(id + '\n' + request);
         });
     };
 
@@ -418,12 +560,18 @@ private:
             pending.resolve(response);
         }
     };
+
+    window.__webview_event__ = function(name, detail) {
+        window.dispatchEvent(new CustomEvent('backend:' + name, { detail: detail }));
+    };
 })();
 )";
         m_webviewWindow->AddScriptToExecuteOnDocumentCreated(script.c_str(), nullptr);
 
-        // Start worker thread pool for async IPC processing
-        startWorkerPool();
+        // Start worker thread pool for synchronous bindings (async ones bring their own workers)
+        if (!m_bindings.empty()) {
+            startWorkerPool();
+        }
 
         // Handle messages from JavaScript - dispatch to worker thread
         m_webviewWindow->add_WebMessageReceived(
@@ -437,22 +585,17 @@ private:
                         std::string message = utf16_to_utf8(wmessage);
                         CoTaskMemFree(messageRaw);
 
-                        // Parse wrapped request to extract id and data
-                        simdjson::dom::parser parser;
-                        auto doc_result = parser.parse(message);
-                        if (!doc_result.error()) {
-                            auto doc = doc_result.value();
-                            int64_t id = 0;
-                            std::string data;
-
-                            auto id_result = doc["__id"].get_int64();
-                            if (!id_result.error()) {
-                                id = id_result.value();
-                            }
+                        // Split "<id>\n<request>" framing; the request itself is not parsed here
+                        size_t separator = message.find('\n');
+                        int64_t id = 0;
+                        if (separator != std::string::npos) {
+                            std::from_chars(message.data(), message.data() + separator, id);
+                            message.erase(0, separator + 1);
 
-                            auto data_result = doc["__data"].get_string();
-                            if (!data_result.error()) {
-                                data = std::string(data_result.value());
+                            // Async binding: the handler queues the request and resolves it when done
+                            if (auto async = m_asyncBindings.find("invoke"); async != m_asyncBindings.end()) {
+                                async->second(std::move(message), [this, id](std::string response) { resolve(id, std::move(response)); });
+                                return S_OK;
                             }
 
                             // Dispatch to worker thread to keep UI responsive
@@ -460,7 +603,7 @@ private:
                             if (it != m_bindings.end()) {
                                 auto fn = it->second;
                                 auto hwnd = m_hwnd;
-                                dispatchToWorker([fn, data = std::move(data), id, hwnd]() {
+                                dispatchToWorker([fn, data = std::move(message), id, hwnd]() {
                                     std::string response = fn(data);
                                     auto* resp = new IPCResponse{id, std::move(response)};
                                     PostMessage(hwnd, WM_IPC_RESPONSE, 0, reinterpret_cast<LPARAM>(resp));
@@ -507,6 +650,17 @@ private:
             return 0;
         }
 
+        case WM_IPC_EVENT: {
+            auto* evt = reinterpret_cast<IPCEvent*>(lParam);
+            if (self && self->m_webviewWindow && evt) {
+                std::wstring script = L"window.__webview_event__ && window.__webview_event__(\"" + utf8_to_utf16(evt->name) + L"\", " +
+                    utf8_to_utf16(evt->payload) + L");";
+                self->m_webviewWindow->ExecuteScript(script.c_str(), nullptr);
+            }
+            delete evt;
+            return 0;
+        }
+
         case WM_DESTROY:
             if (self) {
                 self->stopWorkerPool();
@@ -563,6 +717,7 @@ private:
     bool m_debug;
     bool m_externalWindow = true;
     bool m_disableCache;
+    bool m_environmentRequested = false;
     HWND m_hwnd;
     std::string m_title;
     std::string m_url;
@@ -572,6 +727,8 @@ private:
     int m_height = 600;
     int m_hints = WEBVIEW_HINT_NONE;
     std::map<std::string, std::function<std::string(const std::string&)>> m_bindings;
+    std::map<std::string, std::function<void(std::string, std::function<void(std::string)>)>> m_asyncBindings;
+    std::map<std::string, std::function<std::optional<resource>(const std::string&)>, std::less<>> m_resourceHandlers;
 
     // Worker thread pool for async IPC processing
     std::vector<std::thread> m_workerThreads;
@@ -580,6 +737,7 @@ private:
     std::condition_variable m_taskCv;
     std::atomic<bool> m_workerRunning{false};
 
+    ComPtr<ICoreWebView2Environment> m_environment;
     ComPtr<ICoreWebView2Controller> m_webviewController;
     ComPtr<ICoreWebView2> m_webviewWindow;
     EventRegistrationToken m_newWindowRequestedToken{};